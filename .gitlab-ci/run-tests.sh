@@ -19,7 +19,8 @@ case "${backend}" in
                 --print-errorlogs \
                 --setup=${backend} \
                 --suite=gtk \
-                --no-suite=gsk-compare-broadway
+                --no-suite=gsk-compare-broadway \
+                --no-suite=performance
 
     # Store the exit code for the CI run, but always
     # generate the reports
@@ -38,7 +39,8 @@ case "${backend}" in
                 --print-errorlogs \
                 --setup=${backend} \
                 --suite=gtk \
-                --no-suite=gsk-compare-broadway
+                --no-suite=gsk-compare-broadway \
+                --no-suite=performance
 
     exit_code=$?
     kill ${compositor}
@@ -56,7 +58,8 @@ case "${backend}" in
                 --print-errorlogs \
                 --setup=${backend} \
                 --suite=gtk \
-                --no-suite=gsk-compare-broadway
+                --no-suite=gsk-compare-broadway \
+                --no-suite=performance
 
     exit_code=$?
     kill ${compositor}
@@ -74,7 +77,8 @@ case "${backend}" in
                 --print-errorlogs \
                 --setup=${backend} \
                 --suite=gtk \
-                --no-suite=gsk-compare-opengl
+                --no-suite=gsk-compare-opengl \
+                --no-suite=performance
 
     # don't let Broadway failures fail the run, for now
     exit_code=0
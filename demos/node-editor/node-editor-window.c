@@ -366,6 +366,24 @@ static gboolean
 load_bytes (NodeEditorWindow *self,
             GBytes           *bytes)
 {
+  /* Binary recordings, see node-format.md */
+  if (g_bytes_get_size (bytes) >= 4 &&
+      memcmp (g_bytes_get_data (bytes, NULL), "GSKB", 4) == 0)
+    {
+      GskRenderNode *node;
+
+      node = gsk_render_node_deserialize (bytes, NULL, NULL);
+      g_bytes_unref (bytes);
+      if (node == NULL)
+        {
+          load_error (self, "Invalid binary node file");
+          return FALSE;
+        }
+
+      bytes = gsk_render_node_serialize (node);
+      gsk_render_node_unref (node);
+    }
+
   if (!g_utf8_validate (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), NULL))
     {
       load_error (self, "Invalid UTF-8");
@@ -10,6 +10,11 @@
 //#define DEBUG_NODE_SENDING
 //#define DEBUG_NODE_SENDING_REMOVE
 
+/* A client that falls this far behind reading its output is dropped,
+ * and has to reconnect to get a fresh copy of the state.
+ */
+#define MAX_PENDING_OUTPUT (64 * 1024 * 1024)
+
 /************************************************************************
  *                Basic I/O primitives                                  *
  ************************************************************************/
@@ -19,22 +24,135 @@ struct BroadwayOutput {
   GString *buf;
   int error;
   guint32 serial;
+  GConverter *deflater; /* permessage-deflate, NULL if not negotiated */
+  gboolean deflate_reset;
+  GByteArray *deflated;
+  GByteArray *pending; /* Framed data the socket didn't take yet */
+  GSource *pending_source;
 };
 
+static gboolean
+broadway_output_write_pending (BroadwayOutput *output)
+{
+  GError *error = NULL;
+  gssize res;
+
+  while (output->pending->len > 0)
+    {
+      res = g_pollable_output_stream_write_nonblocking (G_POLLABLE_OUTPUT_STREAM (output->out),
+                                                        output->pending->data,
+                                                        output->pending->len,
+                                                        NULL, &error);
+      if (res < 0)
+        {
+          if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            {
+              g_error_free (error);
+              return TRUE;
+            }
+
+          g_error_free (error);
+          output->error = TRUE;
+          g_byte_array_set_size (output->pending, 0);
+          return FALSE;
+        }
+
+      g_byte_array_remove_range (output->pending, 0, res);
+    }
+
+  return TRUE;
+}
+
+static gboolean
+pending_output_cb (GObject        *stream,
+                   BroadwayOutput *output)
+{
+  broadway_output_write_pending (output);
+
+  if (output->pending->len > 0)
+    return G_SOURCE_CONTINUE;
+
+  g_clear_pointer (&output->pending_source, g_source_unref);
+  return G_SOURCE_REMOVE;
+}
+
+/* Writes without blocking the main loop on a slow client. Whatever the
+ * socket doesn't take right away is kept in order and written when the
+ * socket becomes writable again. The frame clocks of the applications
+ * wait for the roundtrip at the end of each frame, so they don't get
+ * ahead of the client by more than a frame, and the amount kept only
+ * grows with a client that stopped reading altogether.
+ */
+static void
+broadway_output_write (BroadwayOutput *output,
+                       GOutputVector  *vectors,
+                       gsize           n_vectors)
+{
+  GError *error = NULL;
+  gsize written = 0;
+  gsize i;
+
+  if (output->error)
+    return;
+
+  if (output->pending->len == 0)
+    {
+      if (g_pollable_output_stream_writev_nonblocking (G_POLLABLE_OUTPUT_STREAM (output->out),
+                                                       vectors, n_vectors,
+                                                       &written, NULL, &error) == G_POLLABLE_RETURN_FAILED)
+        {
+          g_error_free (error);
+          output->error = TRUE;
+          return;
+        }
+    }
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      if (written >= vectors[i].size)
+        {
+          written -= vectors[i].size;
+          continue;
+        }
+
+      g_byte_array_append (output->pending,
+                           (const guint8 *) vectors[i].buffer + written,
+                           vectors[i].size - written);
+      written = 0;
+    }
+
+  if (output->pending->len > MAX_PENDING_OUTPUT)
+    {
+      g_warning ("Client is not reading its output, disconnecting");
+      output->error = TRUE;
+      g_byte_array_set_size (output->pending, 0);
+      return;
+    }
+
+  if (output->pending->len > 0 && output->pending_source == NULL)
+    {
+      output->pending_source = g_pollable_output_stream_create_source (G_POLLABLE_OUTPUT_STREAM (output->out), NULL);
+      g_source_set_callback (output->pending_source, (GSourceFunc) pending_output_cb, output, NULL);
+      g_source_attach (output->pending_source, NULL);
+    }
+}
+
 static void
 broadway_output_send_cmd (BroadwayOutput *output,
-                          gboolean fin, BroadwayWSOpCode code,
+                          gboolean fin, gboolean compressed,
+                          BroadwayWSOpCode code,
                           const void *buf, gsize count)
 {
   gboolean mask = FALSE;
   guchar header[16];
   size_t p;
+  GOutputVector vectors[2];
 
   gboolean mid_header = count > 125 && count <= 65535;
   gboolean long_header = count > 65535;
 
   /* NB. big-endian spec => bit 0 == MSB */
-  header[0] = ( (fin ? 0x80 : 0) | (code & 0x0f) );
+  header[0] = ( (fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | (code & 0x0f) );
   header[1] = ( (mask ? 0x80 : 0) |
                 (mid_header ? 126 : long_header ? 127 : count) );
   p = 2;
@@ -49,14 +167,78 @@ broadway_output_send_cmd (BroadwayOutput *output,
       p += 8;
     }
   // FIXME: if we are paranoid we should 'mask' the data
-  // FIXME: we should really emit these as a single write
-  g_output_stream_write_all (output->out, header, p, NULL, NULL, NULL);
-  g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
+
+  /* The socket has TCP_NODELAY set, so writing the header on its own
+   * would put it into a separate packet.
+   */
+  vectors[0].buffer = header;
+  vectors[0].size = p;
+  vectors[1].buffer = buf;
+  vectors[1].size = count;
+  broadway_output_write (output, vectors, count > 0 ? 2 : 1);
 }
 
 void broadway_output_pong (BroadwayOutput *output)
 {
-  broadway_output_send_cmd (output, TRUE, BROADWAY_WS_CNX_PONG, NULL, 0);
+  broadway_output_send_cmd (output, TRUE, FALSE, BROADWAY_WS_CNX_PONG, NULL, 0);
+}
+
+/* Compresses the pending commands as a single permessage-deflate
+ * message (RFC 7692). Each message ends with a sync flush whose
+ * trailing 0x00 0x00 0xff 0xff is implied by the protocol.
+ */
+static gboolean
+broadway_output_deflate (BroadwayOutput *output)
+{
+  const guint8 *in = (const guint8 *) output->buf->str;
+  gsize in_len = output->buf->len;
+  GError *error = NULL;
+
+  g_byte_array_set_size (output->deflated, 0);
+
+  while (TRUE)
+    {
+      GConverterResult result;
+      gsize used, bytes_read, bytes_written;
+
+      used = output->deflated->len;
+      g_byte_array_set_size (output->deflated, used + MAX (in_len, 4096));
+
+      result = g_converter_convert (output->deflater,
+                                    in, in_len,
+                                    output->deflated->data + used,
+                                    output->deflated->len - used,
+                                    G_CONVERTER_FLUSH,
+                                    &bytes_read, &bytes_written, &error);
+      if (result == G_CONVERTER_ERROR)
+        {
+          g_warning ("Failed to compress output: %s", error->message);
+          g_error_free (error);
+          /* Start over, the client never sees the partial data */
+          g_converter_reset (output->deflater);
+          return FALSE;
+        }
+
+      g_byte_array_set_size (output->deflated, used + bytes_written);
+      in += bytes_read;
+      in_len -= bytes_read;
+
+      if (result == G_CONVERTER_FLUSHED)
+        break;
+    }
+
+  if (output->deflated->len < 4)
+    {
+      g_converter_reset (output->deflater);
+      return FALSE;
+    }
+
+  g_byte_array_set_size (output->deflated, output->deflated->len - 4);
+
+  if (output->deflate_reset)
+    g_converter_reset (output->deflater);
+
+  return TRUE;
 }
 
 int
@@ -65,8 +247,12 @@ broadway_output_flush (BroadwayOutput *output)
   if (output->buf->len == 0)
     return TRUE;
 
-  broadway_output_send_cmd (output, TRUE, BROADWAY_WS_BINARY,
-                            output->buf->str, output->buf->len);
+  if (output->deflater && broadway_output_deflate (output))
+    broadway_output_send_cmd (output, TRUE, TRUE, BROADWAY_WS_BINARY,
+                              output->deflated->data, output->deflated->len);
+  else
+    broadway_output_send_cmd (output, TRUE, FALSE, BROADWAY_WS_BINARY,
+                              output->buf->str, output->buf->len);
 
   g_string_set_size (output->buf, 0);
 
@@ -83,15 +269,42 @@ broadway_output_new (GOutputStream *out, guint32 serial)
 
   output->out = g_object_ref (out);
   output->buf = g_string_new ("");
+  output->pending = g_byte_array_new ();
   output->serial = serial;
 
   return output;
 }
 
+/* Called once permessage-deflate has been negotiated with the client.
+ * @no_context_takeover is set when the client asked for
+ * server_no_context_takeover, and each message is then compressed
+ * on its own.
+ */
+void
+broadway_output_enable_deflate (BroadwayOutput *output,
+                                gboolean        no_context_takeover)
+{
+  /* Much of the output is image data which compresses badly,
+   * so favour speed over ratio.
+   */
+  output->deflater = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, 1));
+  output->deflate_reset = no_context_takeover;
+  output->deflated = g_byte_array_new ();
+}
+
 void
 broadway_output_free (BroadwayOutput *output)
 {
+  if (output->pending_source)
+    {
+      g_source_destroy (output->pending_source);
+      g_source_unref (output->pending_source);
+    }
+  g_byte_array_unref (output->pending);
   g_object_unref (output->out);
+  g_clear_object (&output->deflater);
+  if (output->deflated)
+    g_byte_array_unref (output->deflated);
   free (output);
 }
 
@@ -112,6 +112,8 @@ struct BroadwayInput {
   BroadwayOutput *output;
   GIOStream *connection;
   GByteArray *buffer;
+  GConverter *inflater; /* permessage-deflate, NULL if not negotiated */
+  GByteArray *inflated;
   GSource *source;
   gboolean seen_time;
   gint64 time_base;
@@ -339,6 +341,9 @@ broadway_input_free (BroadwayInput *input)
 {
   g_object_unref (input->connection);
   g_byte_array_free (input->buffer, FALSE);
+  g_clear_object (&input->inflater);
+  if (input->inflated)
+    g_byte_array_unref (input->inflated);
   g_source_destroy (input->source);
   g_free (input);
 }
@@ -767,6 +772,61 @@ hex_dump (guchar *data, gsize len)
 #endif
 }
 
+/* Decompresses a permessage-deflate message (RFC 7692) into
+ * input->inflated. The sender strips the trailing 0x00 0x00 0xff 0xff
+ * of the sync flush, so feed it back in after the payload.
+ */
+static gboolean
+inflate_message (BroadwayInput *input,
+                 const guchar  *data,
+                 gsize          len)
+{
+  static const guchar tail[4] = { 0x00, 0x00, 0xff, 0xff };
+  const guchar *chunks[2] = { data, tail };
+  gsize sizes[2] = { len, sizeof (tail) };
+  GError *error = NULL;
+  int i;
+
+  g_byte_array_set_size (input->inflated, 0);
+
+  for (i = 0; i < 2; i++)
+    {
+      const guchar *in = chunks[i];
+      gsize in_len = sizes[i];
+
+      while (TRUE)
+        {
+          GConverterResult result;
+          gsize used, bytes_read, bytes_written;
+
+          used = input->inflated->len;
+          g_byte_array_set_size (input->inflated, used + MAX (4 * in_len, 1024));
+
+          result = g_converter_convert (input->inflater,
+                                        in, in_len,
+                                        input->inflated->data + used,
+                                        input->inflated->len - used,
+                                        G_CONVERTER_FLUSH,
+                                        &bytes_read, &bytes_written, &error);
+          if (result == G_CONVERTER_ERROR)
+            {
+              g_warning ("Failed to decompress input: %s", error->message);
+              g_error_free (error);
+              return FALSE;
+            }
+
+          g_byte_array_set_size (input->inflated, used + bytes_written);
+          in += bytes_read;
+          in_len -= bytes_read;
+
+          if (result == G_CONVERTER_FLUSHED)
+            break;
+        }
+    }
+
+  return TRUE;
+}
+
 static void
 parse_input (BroadwayInput *input)
 {
@@ -779,7 +839,7 @@ parse_input (BroadwayInput *input)
     {
       gsize len, payload_len;
       BroadwayWSOpCode code;
-      gboolean is_mask, fin;
+      gboolean is_mask, fin, compressed;
       guchar *buf, *data, *mask;
 
       buf = input->buffer->data;
@@ -790,6 +850,7 @@ parse_input (BroadwayInput *input)
 #endif
 
       fin = buf[0] & 0x80;
+      compressed = buf[0] & 0x40;
       code = buf[0] & 0x0f;
       payload_len = buf[1] & 0x7f;
       is_mask = buf[1] & 0x80;
@@ -839,6 +900,11 @@ parse_input (BroadwayInput *input)
             g_warning ("can't yet accept fragmented input");
 #endif
           }
+        else if (compressed && input->inflater)
+          {
+            if (inflate_message (input, data, payload_len))
+              parse_input_message (input, input->inflated->data);
+          }
         else
           {
             parse_input_message (input, data);
@@ -1000,6 +1066,12 @@ broadway_server_flush (BroadwayServer *server)
       broadway_output_free (server->output);
       server->output = NULL;
       send_outstanding_roundtrips (server);
+
+      /* Close the connection, so the client knows to reconnect. The
+       * input is freed when its source notices, we may be parsing it.
+       */
+      if (server->input)
+        g_io_stream_close (server->input->connection, NULL, NULL);
     }
 }
 
@@ -1038,6 +1110,45 @@ parse_line (const char *line, const char *key)
   return p;
 }
 
+/* Looks for an acceptable permessage-deflate offer in a
+ * Sec-WebSocket-Extensions header. We always use a full window,
+ * so offers that restrict server_max_window_bits are skipped.
+ */
+static gboolean
+parse_deflate_offer (const char *extensions,
+                     gboolean   *no_context_takeover)
+{
+  char **offers;
+  gboolean found = FALSE;
+  int i, j;
+
+  offers = g_strsplit (extensions, ",", 0);
+  for (i = 0; offers[i] != NULL && !found; i++)
+    {
+      char **params = g_strsplit (offers[i], ";", 0);
+      gboolean acceptable;
+
+      g_strstrip (params[0]);
+      acceptable = strcmp (params[0], "permessage-deflate") == 0;
+      *no_context_takeover = FALSE;
+
+      for (j = 1; acceptable && params[j] != NULL; j++)
+        {
+          g_strstrip (params[j]);
+          if (strcmp (params[j], "server_no_context_takeover") == 0)
+            *no_context_takeover = TRUE;
+          else if (g_str_has_prefix (params[j], "server_max_window_bits"))
+            acceptable = FALSE;
+        }
+
+      found = acceptable;
+      g_strfreev (params);
+    }
+  g_strfreev (offers);
+
+  return found;
+}
+
 static void
 send_error (HttpRequest *request,
             int error_code,
@@ -1093,7 +1204,8 @@ start_input (HttpRequest *request)
   const char *p;
   int i;
   char *res;
-  const char *origin, *host;
+  const char *origin, *host, *extensions;
+  gboolean deflate, no_context_takeover = FALSE;
   BroadwayInput *input;
   const void *data_buffer;
   gsize data_buffer_size;
@@ -1110,6 +1222,7 @@ start_input (HttpRequest *request)
   key = NULL;
   origin = NULL;
   host = NULL;
+  extensions = NULL;
   for (i = 0; lines[i] != NULL; i++)
     {
       if ((p = parse_line (lines[i], "Sec-WebSocket-Key")))
@@ -1120,8 +1233,13 @@ start_input (HttpRequest *request)
         host = p;
       else if ((p = parse_line (lines[i], "Sec-WebSocket-Origin")))
         origin = p;
+      else if ((p = parse_line (lines[i], "Sec-WebSocket-Extensions")))
+        extensions = p;
     }
 
+  deflate = extensions != NULL &&
+            parse_deflate_offer (extensions, &no_context_takeover);
+
   if (host == NULL)
     {
       g_strfreev (lines);
@@ -1139,9 +1257,13 @@ start_input (HttpRequest *request)
                              "%s%s%s"
                              "Sec-WebSocket-Location: ws://%s/socket\r\n"
                              "Sec-WebSocket-Protocol: broadway\r\n"
+                             "%s"
                              "\r\n", accept,
                              origin?"Sec-WebSocket-Origin: ":"", origin?origin:"", origin?"\r\n":"",
-                             host);
+                             host,
+                             !deflate ? "" :
+                             no_context_takeover ? "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover\r\n" :
+                             "Sec-WebSocket-Extensions: permessage-deflate\r\n");
       g_free (accept);
 
 #ifdef DEBUG_WEBSOCKETS
@@ -1174,6 +1296,13 @@ start_input (HttpRequest *request)
   input->output =
     broadway_output_new (g_io_stream_get_output_stream (request->connection), 0);
 
+  if (deflate)
+    {
+      broadway_output_enable_deflate (input->output, no_context_takeover);
+      input->inflater = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW));
+      input->inflated = g_byte_array_new ();
+    }
+
   /* This will free and close the data input stream, but we got all the buffered content already */
   http_request_free (request);
 
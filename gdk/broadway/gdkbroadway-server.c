@@ -16,11 +16,13 @@
 #include "gdk-private.h"
 
 #include <gdk/gdktextureprivate.h>
+#include <gdk/loaders/gdkpngprivate.h>
 
 #include <glib.h>
 #include <glib/gprintf.h>
 #include <gio/gunixsocketaddress.h>
 #include <gio/gunixfdmessage.h>
+#include <gio/gunixoutputstream.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
@@ -615,14 +617,12 @@ gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
 {
   guint32 id;
   BroadwayRequestUploadTexture msg;
-  GBytes *bytes;
-  const guchar *data;
-  gsize size;
+  GOutputStream *stream;
+  GError *error = NULL;
+  off_t size;
   int fd;
 
-  bytes = gdk_texture_save_to_png_bytes (texture);
   fd = open_shared_memory ();
-  data = g_bytes_get_data (bytes, &size);
 
   id = server->next_texture_id++;
 
@@ -630,21 +630,21 @@ gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
   msg.offset = 0;
   msg.size = 0;
 
-  while (msg.size < size)
+  /* Encode straight into the shared memory file. The PNG only
+   * travels to broadwayd and the browser, not to disk, so use a
+   * fast compression level; encoding dominates the upload cost.
+   */
+  stream = g_unix_output_stream_new (fd, FALSE);
+  if (!gdk_save_png_to_stream (texture, stream, 1, NULL, &error))
     {
-      gssize ret = write (fd, data + msg.size, size - msg.size);
-
-      if (ret <= 0)
-        {
-          if (errno == EINTR)
-            continue;
-          break;
-        }
-
-      msg.size += ret;
+      g_warning ("Failed to encode texture: %s", error->message);
+      g_error_free (error);
     }
+  g_object_unref (stream);
 
-  g_bytes_unref (bytes);
+  size = lseek (fd, 0, SEEK_CUR);
+  if (size > 0)
+    msg.size = size;
 
   /* This passes ownership of fd */
   gdk_broadway_server_send_fd_message (server, msg,
@@ -44,8 +44,11 @@
 #endif
 #include <sys/types.h>
 
+typedef struct _BroadwayTextureData BroadwayTextureData;
+
 static void   gdk_broadway_display_dispose            (GObject            *object);
 static void   gdk_broadway_display_finalize           (GObject            *object);
+static void   broadway_texture_data_free              (BroadwayTextureData *data);
 
 #if 0
 #define DEBUG_WEBSOCKETS 1
@@ -59,6 +62,7 @@ gdk_broadway_display_init (GdkBroadwayDisplay *display)
   gdk_display_set_input_shapes (GDK_DISPLAY (display), FALSE);
 
   display->id_ht = g_hash_table_new (NULL, NULL);
+  display->texture_cache = g_hash_table_new (g_str_hash, g_str_equal);
 
   display->monitor = g_object_new (GDK_TYPE_BROADWAY_MONITOR,
                                    "display", display,
@@ -294,6 +298,12 @@ gdk_broadway_display_finalize (GObject *object)
 
   _gdk_broadway_cursor_display_finalize (GDK_DISPLAY(broadway_display));
 
+  /* Textures that are in use keep the display alive, so only
+   * the unused ones are left here */
+  while (!g_queue_is_empty (&broadway_display->unused_textures))
+    broadway_texture_data_free (g_queue_pop_head (&broadway_display->unused_textures));
+  g_hash_table_unref (broadway_display->texture_cache);
+
   g_object_unref (broadway_display->monitor);
 
   G_OBJECT_CLASS (gdk_broadway_display_parent_class)->finalize (object);
@@ -406,11 +416,20 @@ gdk_broadway_display_get_setting (GdkDisplay *display,
   return FALSE;
 }
 
-typedef struct {
+/* Uploaded textures are shared between all GdkTextures with the same
+ * contents, so identical images only go over the wire once. Textures
+ * that are no longer used stay on the server for a while, as the same
+ * image is often uploaded again soon.
+ */
+#define MAX_UNUSED_TEXTURES 64
+
+struct _BroadwayTextureData {
   int id;
-  GdkDisplay *display;
-  GList *textures;
-} BroadwayTextureData;
+  int ref_count;
+  char *checksum;
+  GdkDisplay *display; /* Owning ref while ref_count > 0 */
+  GList *unused_link;
+};
 
 static void
 broadway_texture_data_free (BroadwayTextureData *data)
@@ -418,10 +437,54 @@ broadway_texture_data_free (BroadwayTextureData *data)
   GdkBroadwayDisplay *broadway_display = GDK_BROADWAY_DISPLAY (data->display);
 
   gdk_broadway_server_release_texture (broadway_display->server, data->id);
-  g_object_unref (data->display);
+  g_hash_table_remove (broadway_display->texture_cache, data->checksum);
+  g_free (data->checksum);
   g_free (data);
 }
 
+static void
+broadway_texture_data_unref (BroadwayTextureData *data)
+{
+  GdkBroadwayDisplay *broadway_display = GDK_BROADWAY_DISPLAY (data->display);
+
+  data->ref_count--;
+  if (data->ref_count > 0)
+    return;
+
+  g_queue_push_head (&broadway_display->unused_textures, data);
+  data->unused_link = broadway_display->unused_textures.head;
+
+  if (broadway_display->unused_textures.length > MAX_UNUSED_TEXTURES)
+    broadway_texture_data_free (g_queue_pop_tail (&broadway_display->unused_textures));
+
+  g_object_unref (data->display);
+}
+
+static char *
+compute_texture_checksum (GdkTexture *texture)
+{
+  int width = gdk_texture_get_width (texture);
+  int height = gdk_texture_get_height (texture);
+  gsize stride = width * 4;
+  GChecksum *checksum;
+  guchar *pixels;
+  char *result;
+
+  pixels = g_malloc (stride * height);
+  gdk_texture_download (texture, pixels, stride);
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) &width, sizeof (width));
+  g_checksum_update (checksum, (const guchar *) &height, sizeof (height));
+  g_checksum_update (checksum, pixels, stride * height);
+  result = g_strdup (g_checksum_get_string (checksum));
+
+  g_checksum_free (checksum);
+  g_free (pixels);
+
+  return result;
+}
+
 guint32
 gdk_broadway_display_ensure_texture (GdkDisplay *display,
                                      GdkTexture *texture)
@@ -432,12 +495,31 @@ gdk_broadway_display_ensure_texture (GdkDisplay *display,
   data = g_object_get_data (G_OBJECT (texture), "broadway-data");
   if (data == NULL)
     {
-      guint32 id = gdk_broadway_server_upload_texture (broadway_display->server, texture);
-
-      data = g_new0 (BroadwayTextureData, 1);
-      data->id = id;
-      data->display = g_object_ref (display);
-     g_object_set_data_full (G_OBJECT (texture), "broadway-data", data, (GDestroyNotify)broadway_texture_data_free);
+      char *checksum = compute_texture_checksum (texture);
+
+      data = g_hash_table_lookup (broadway_display->texture_cache, checksum);
+      if (data != NULL)
+        {
+          g_free (checksum);
+          if (data->unused_link)
+            {
+              g_queue_delete_link (&broadway_display->unused_textures, data->unused_link);
+              data->unused_link = NULL;
+            }
+        }
+      else
+        {
+          data = g_new0 (BroadwayTextureData, 1);
+          data->id = gdk_broadway_server_upload_texture (broadway_display->server, texture);
+          data->checksum = checksum;
+          data->display = display;
+          g_hash_table_insert (broadway_display->texture_cache, data->checksum, data);
+        }
+
+      if (data->ref_count++ == 0)
+        g_object_ref (display);
+
+      g_object_set_data_full (G_OBJECT (texture), "broadway-data", data, (GDestroyNotify)broadway_texture_data_unref);
     }
 
   return data->id;
@@ -58,7 +58,8 @@ struct _GdkBroadwayDisplay
   int scale_factor;
   gboolean fixed_scale;
 
-  GHashTable *texture_cache;
+  GHashTable *texture_cache; /* checksum => BroadwayTextureData */
+  GQueue unused_textures;
 
   guint idle_flush_id;
 };
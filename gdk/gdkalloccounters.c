@@ -0,0 +1,127 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkalloccountersprivate.h"
+
+#include "gdkprofilerprivate.h"
+
+/* Allocations are counted between two frames and reported as
+ * profiler counters at the end of each frame, so a frame that
+ * doesn't allocate anything shows up as zeros in the capture.
+ *
+ * Nodes and arrays can be created in other threads, so the
+ * counters are atomic. This only costs anything while the
+ * profiler is running.
+ */
+
+gboolean gdk_alloc_counters_enabled = FALSE;
+
+static guint counts[GDK_ALLOC_N_TAGS];
+static gsize bytes[GDK_ALLOC_N_TAGS];
+
+#ifdef HAVE_SYSPROF
+static const struct {
+  const char *count_name;
+  const char *count_description;
+  const char *bytes_name;
+  const char *bytes_description;
+} tag_names[GDK_ALLOC_N_TAGS] = {
+  [GDK_ALLOC_RENDER_NODES] = {
+    "allocs-render-nodes", "Number of render nodes created in a frame",
+    "alloc-bytes-render-nodes", "Bytes of render nodes created in a frame"
+  },
+  [GDK_ALLOC_CSS_VALUES] = {
+    "allocs-css-values", "Number of CSS values created in a frame",
+    "alloc-bytes-css-values", "Bytes of CSS values created in a frame"
+  },
+  [GDK_ALLOC_ARRAYS] = {
+    "allocs-arrays", "Number of times arrays grew in a frame",
+    "alloc-bytes-arrays", "Bytes allocated by growing arrays in a frame"
+  },
+  [GDK_ALLOC_GL_COMMANDS] = {
+    "allocs-gl-commands", "Number of times GL command arrays grew in a frame",
+    "alloc-bytes-gl-commands", "Bytes allocated by growing GL command arrays in a frame"
+  },
+};
+
+static guint count_counters[GDK_ALLOC_N_TAGS];
+static guint bytes_counters[GDK_ALLOC_N_TAGS];
+static gboolean counters_defined = FALSE;
+#endif
+
+void
+gdk_alloc_counters_record (GdkAllocTag tag,
+                           gsize       n_bytes)
+{
+  g_atomic_int_inc (&counts[tag]);
+  g_atomic_pointer_add (&bytes[tag], n_bytes);
+}
+
+/*<private>
+ * gdk_alloc_counters_end_frame:
+ *
+ * Reports the allocations since the previous frame to the
+ * profiler and starts counting anew.
+ *
+ * Counting is only enabled while the profiler is running.
+ */
+void
+gdk_alloc_counters_end_frame (void)
+{
+#ifdef HAVE_SYSPROF
+  int i;
+
+  if (!GDK_PROFILER_IS_RUNNING)
+    {
+      gdk_alloc_counters_enabled = FALSE;
+      return;
+    }
+
+  if (!counters_defined)
+    {
+      for (i = 0; i < GDK_ALLOC_N_TAGS; i++)
+        {
+          count_counters[i] = gdk_profiler_define_int_counter (tag_names[i].count_name,
+                                                               tag_names[i].count_description);
+          bytes_counters[i] = gdk_profiler_define_int_counter (tag_names[i].bytes_name,
+                                                               tag_names[i].bytes_description);
+        }
+      counters_defined = TRUE;
+    }
+
+  /* The first frame only starts counting */
+  if (gdk_alloc_counters_enabled)
+    {
+      for (i = 0; i < GDK_ALLOC_N_TAGS; i++)
+        {
+          gdk_profiler_set_int_counter (count_counters[i], g_atomic_int_and (&counts[i], 0));
+          gdk_profiler_set_int_counter (bytes_counters[i], (gsize) g_atomic_pointer_and (&bytes[i], 0));
+        }
+    }
+  else
+    {
+      for (i = 0; i < GDK_ALLOC_N_TAGS; i++)
+        {
+          g_atomic_int_set (&counts[i], 0);
+          g_atomic_pointer_set (&bytes[i], 0);
+        }
+      gdk_alloc_counters_enabled = TRUE;
+    }
+#endif
+}
@@ -0,0 +1,55 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GDK_ALLOC_COUNTERS_PRIVATE_H__
+#define __GDK_ALLOC_COUNTERS_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Subsystems whose allocations are counted while profiling,
+ * to find out what allocates memory in every frame.
+ */
+typedef enum {
+  GDK_ALLOC_RENDER_NODES,
+  GDK_ALLOC_CSS_VALUES,
+  GDK_ALLOC_ARRAYS,
+  GDK_ALLOC_GL_COMMANDS,
+  GDK_ALLOC_N_TAGS
+} GdkAllocTag;
+
+extern gboolean gdk_alloc_counters_enabled;
+
+void      gdk_alloc_counters_record     (GdkAllocTag  tag,
+                                         gsize        bytes);
+void      gdk_alloc_counters_end_frame  (void);
+
+/* This is called from hot paths, so keep it cheap
+ * when the profiler is not running.
+ */
+static inline void
+gdk_alloc_counters_add (GdkAllocTag tag,
+                        gsize       bytes)
+{
+  if G_UNLIKELY (gdk_alloc_counters_enabled)
+    gdk_alloc_counters_record (tag, bytes);
+}
+
+G_END_DECLS
+
+#endif /* __GDK_ALLOC_COUNTERS_PRIVATE_H__ */
@@ -19,6 +19,10 @@
 
 #include <glib.h>
 
+#ifdef GTK_COMPILATION
+#include "gdkalloccountersprivate.h"
+#endif
+
 G_BEGIN_DECLS
 
 #ifndef GDK_ARRAY_TYPE_NAME
@@ -153,6 +157,10 @@ gdk_array(reserve) (GdkArray *self,
   size = gdk_array(get_size) (self);
   new_size = 1 << g_bit_storage (MAX (GDK_ARRAY_REAL_SIZE (n), 16) - 1);
 
+#ifdef GTK_COMPILATION
+  gdk_alloc_counters_add (GDK_ALLOC_ARRAYS, sizeof (_T_) * new_size);
+#endif
+
 #ifdef GDK_ARRAY_PREALLOC
   if (self->start == self->preallocated)
     {
@@ -692,8 +692,21 @@ serialize_texture_in_thread (GTask        *task,
   texture = g_value_get_object (value);
 
   if (strcmp (gdk_content_serializer_get_mime_type (serializer), "image/png") == 0)
-    bytes = gdk_save_png (texture);
-  else if (strcmp (gdk_content_serializer_get_mime_type (serializer), "image/tiff") == 0)
+    {
+      /* Stream the png, so the reader can start right away, and use
+       * the same fast compression level as for pixbufs */
+      if (gdk_save_png_to_stream (texture,
+                                  gdk_content_serializer_get_output_stream (serializer),
+                                  2,
+                                  gdk_content_serializer_get_cancellable (serializer),
+                                  &error))
+        g_task_return_boolean (task, TRUE);
+      else
+        g_task_return_error (task, error);
+      return;
+    }
+
+  if (strcmp (gdk_content_serializer_get_mime_type (serializer), "image/tiff") == 0)
     bytes = gdk_save_tiff (texture);
   else if (strcmp (gdk_content_serializer_get_mime_type (serializer), "image/jpeg") == 0)
     bytes = gdk_save_jpeg (texture);
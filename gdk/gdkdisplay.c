@@ -95,6 +95,7 @@ struct _GdkDisplayPrivate {
   EGLDisplay egl_display;
   EGLConfig egl_config;
   EGLConfig egl_config_high_depth;
+  GThread *egl_probe_thread;
 #endif
 
   guint rgba : 1;
@@ -384,6 +385,14 @@ gdk_display_dispose (GObject *object)
 
   g_clear_object (&priv->gl_context);
 #ifdef HAVE_EGL
+  if (priv->egl_probe_thread)
+    {
+      EGLDisplay egl_display = g_thread_join (priv->egl_probe_thread);
+
+      priv->egl_probe_thread = NULL;
+      if (priv->egl_display == NULL && egl_display != NULL)
+        eglTerminate (egl_display);
+    }
   g_clear_pointer (&priv->egl_display, eglTerminate);
 #endif
   g_clear_error (&priv->gl_error);
@@ -1458,7 +1467,6 @@ static EGLDisplay
 gdk_display_create_egl_display (EGLenum  platform,
                                 gpointer native_display)
 {
-  G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;
   EGLDisplay egl_display = NULL;
 
   if (epoxy_has_egl_extension (NULL, "EGL_KHR_platform_base"))
@@ -1486,8 +1494,6 @@ gdk_display_create_egl_display (EGLenum  platform,
   egl_display = eglGetDisplay ((EGLNativeDisplayType) native_display);
 
 out:
-  gdk_profiler_end_mark (start_time, "Create EGL display", NULL);
-
   return egl_display;
 }
 
@@ -1640,6 +1646,67 @@ gdk_display_check_egl_extensions (EGLDisplay   egl_display,
   return TRUE;
 }
 
+typedef struct {
+  EGLenum platform;
+  gpointer native_display;
+} GdkEGLProbe;
+
+static gpointer
+gdk_display_egl_probe_thread (gpointer data)
+{
+  GdkEGLProbe *probe = data;
+  EGLDisplay egl_display;
+
+  /* No profiler marks here, the profiler is not thread-safe */
+  egl_display = gdk_display_create_egl_display (probe->platform, probe->native_display);
+  if (egl_display != NULL && !eglInitialize (egl_display, NULL, NULL))
+    egl_display = NULL;
+
+  g_free (probe);
+
+  return egl_display;
+}
+
+/*<private>
+ * gdk_display_start_egl_probe:
+ * @self: a display
+ * @platform: the EGL platform of @native_display
+ * @native_display: the native display
+ *
+ * Starts initializing EGL for @native_display on a worker thread.
+ *
+ * Loading the driver in eglInitialize() can take a long time, and
+ * nothing needs it before the first surface is realized. Backends
+ * that don't need GL to open the display can call this, so that the
+ * driver is loaded while the application builds its UI.
+ *
+ * EGL hands out the same EGLDisplay for the same native display, so
+ * gdk_display_init_egl() joins the thread and then finds the display
+ * already initialized.
+ */
+void
+gdk_display_start_egl_probe (GdkDisplay *self,
+                             int         platform,
+                             gpointer    native_display)
+{
+  GdkDisplayPrivate *priv = gdk_display_get_instance_private (self);
+  GdkEGLProbe *probe;
+
+  if (priv->egl_probe_thread || priv->egl_display)
+    return;
+
+  if (GDK_DISPLAY_DEBUG_CHECK (self, GL_DISABLE) ||
+      !gdk_gl_backend_can_be_used (GDK_GL_EGL, NULL) ||
+      !epoxy_has_egl ())
+    return;
+
+  probe = g_new (GdkEGLProbe, 1);
+  probe->platform = platform;
+  probe->native_display = native_display;
+
+  priv->egl_probe_thread = g_thread_new ("gdk-egl-probe", gdk_display_egl_probe_thread, probe);
+}
+
 gboolean
 gdk_display_init_egl (GdkDisplay  *self,
                       int          platform,
@@ -1650,8 +1717,17 @@ gdk_display_init_egl (GdkDisplay  *self,
   GdkDisplayPrivate *priv = gdk_display_get_instance_private (self);
   G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;
   G_GNUC_UNUSED gint64 start_time2;
+  EGLDisplay probed_display = NULL;
   int major, minor;
 
+  if (priv->egl_probe_thread)
+    {
+      start_time2 = GDK_PROFILER_CURRENT_TIME;
+      probed_display = g_thread_join (priv->egl_probe_thread);
+      priv->egl_probe_thread = NULL;
+      gdk_profiler_end_mark (start_time2, "join EGL probe", NULL);
+    }
+
   if (!gdk_gl_backend_can_be_used (GDK_GL_EGL, error))
     return FALSE;
 
@@ -1666,7 +1742,12 @@ gdk_display_init_egl (GdkDisplay  *self,
       return FALSE;
     }
 
+  start_time2 = GDK_PROFILER_CURRENT_TIME;
   priv->egl_display = gdk_display_create_egl_display (platform, native_display);
+  gdk_profiler_end_mark (start_time2, "Create EGL display", NULL);
+
+  if (probed_display != NULL && probed_display != priv->egl_display)
+    eglTerminate (probed_display);
 
   if (priv->egl_display == NULL)
     {
@@ -1723,12 +1804,20 @@ gdk_display_init_egl (GdkDisplay  *self,
     epoxy_has_egl_extension (priv->egl_display, "EGL_EXT_buffer_age");
   self->have_egl_swap_buffers_with_damage =
     epoxy_has_egl_extension (priv->egl_display, "EGL_EXT_swap_buffers_with_damage");
+  self->have_egl_khr_swap_buffers_with_damage =
+    epoxy_has_egl_extension (priv->egl_display, "EGL_KHR_swap_buffers_with_damage");
+  self->have_egl_partial_update =
+    epoxy_has_egl_extension (priv->egl_display, "EGL_KHR_partial_update");
   self->have_egl_no_config_context =
     epoxy_has_egl_extension (priv->egl_display, "EGL_KHR_no_config_context");
   self->have_egl_pixel_format_float =
     epoxy_has_egl_extension (priv->egl_display, "EGL_EXT_pixel_format_float");
   self->have_egl_win32_libangle =
     epoxy_has_egl_extension (priv->egl_display, "EGL_ANGLE_d3d_share_handle_client_buffer");
+  self->have_egl_post_sub_buffer =
+    epoxy_has_egl_extension (priv->egl_display, "EGL_NV_post_sub_buffer");
+  self->have_egl_angle_direct_composition =
+    epoxy_has_egl_extension (priv->egl_display, "EGL_ANGLE_direct_composition");
 
   if (self->have_egl_no_config_context)
     priv->egl_config_high_depth = gdk_display_create_egl_config (self,
@@ -101,6 +101,9 @@ struct _GdkDisplay
   VkDevice vk_device;
   VkQueue vk_queue;
   uint32_t vk_queue_family_index;
+  /* Same as vk_queue if there is no dedicated transfer queue */
+  VkQueue vk_transfer_queue;
+  uint32_t vk_transfer_queue_family_index;
 
   guint vulkan_refcount;
 #endif /* GDK_RENDERING_VULKAN */
@@ -108,9 +111,13 @@ struct _GdkDisplay
   /* egl info */
   guint have_egl_buffer_age : 1;
   guint have_egl_swap_buffers_with_damage : 1;
+  guint have_egl_khr_swap_buffers_with_damage : 1;
+  guint have_egl_partial_update : 1;
   guint have_egl_no_config_context : 1;
   guint have_egl_pixel_format_float : 1;
   guint have_egl_win32_libangle : 1;
+  guint have_egl_post_sub_buffer : 1;
+  guint have_egl_angle_direct_composition : 1;
 };
 
 struct _GdkDisplayClass
@@ -225,6 +232,9 @@ gboolean            gdk_display_init_egl              (GdkDisplay       *display
                                                        gpointer          native_display,
                                                        gboolean          allow_any,
                                                        GError          **error);
+void                gdk_display_start_egl_probe       (GdkDisplay       *display,
+                                                       int /*EGLenum*/   platform,
+                                                       gpointer          native_display);
 gpointer            gdk_display_get_egl_display       (GdkDisplay       *display);
 gpointer            gdk_display_get_egl_config        (GdkDisplay       *display);
 gpointer            gdk_display_get_egl_config_high_depth
@@ -0,0 +1,494 @@
+/* gdkdmabuftexture.c
+ *
+ * Copyright 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkdmabuftextureprivate.h"
+
+#include "gdkdisplayprivate.h"
+#include "gdkglcontextprivate.h"
+#include "gdkgltexture.h"
+#include "gdkintl.h"
+#include "gdkmemoryformatprivate.h"
+#include "gdktextureprivate.h"
+
+#include <epoxy/gl.h>
+#include <string.h>
+
+#ifdef HAVE_EGL
+#include <epoxy/egl.h>
+#endif
+
+/**
+ * GdkDmabufTexture:
+ *
+ * A `GdkTexture` representing a DMA buffer.
+ *
+ * The buffer is imported by the GL renderer without copying it
+ * through system memory, which makes it the preferred way to show
+ * frames from video decoders or cameras.
+ *
+ * Since: 4.6
+ */
+
+/* From drm_fourcc.h, which we don't want to depend on */
+#define fourcc_code(a, b, c, d) ((guint32)(a) | ((guint32)(b) << 8) | \
+                                 ((guint32)(c) << 16) | ((guint32)(d) << 24))
+
+#define DRM_FORMAT_XRGB8888     fourcc_code ('X', 'R', '2', '4')
+#define DRM_FORMAT_XBGR8888     fourcc_code ('X', 'B', '2', '4')
+#define DRM_FORMAT_ARGB8888     fourcc_code ('A', 'R', '2', '4')
+#define DRM_FORMAT_ABGR8888     fourcc_code ('A', 'B', '2', '4')
+
+#define DRM_FORMAT_MOD_INVALID  ((G_GUINT64_CONSTANT (1) << 56) - 1)
+
+struct _GdkDmabufTexture {
+  GdkTexture parent_instance;
+
+  GdkDisplay *display;
+
+  guint32 fourcc;
+  guint64 modifier;
+  guint n_planes;
+  int fds[GDK_DMABUF_MAX_PLANES];
+  guint strides[GDK_DMABUF_MAX_PLANES];
+  guint offsets[GDK_DMABUF_MAX_PLANES];
+
+  /* Imported into the display's GL context, for downloads */
+  GdkTexture *gl_texture;
+
+  GDestroyNotify destroy;
+  gpointer data;
+};
+
+struct _GdkDmabufTextureClass {
+  GdkTextureClass parent_class;
+};
+
+G_DEFINE_TYPE (GdkDmabufTexture, gdk_dmabuf_texture, GDK_TYPE_TEXTURE)
+
+static void
+gdk_dmabuf_texture_dispose (GObject *object)
+{
+  GdkDmabufTexture *self = GDK_DMABUF_TEXTURE (object);
+
+  g_clear_object (&self->gl_texture);
+
+  if (self->destroy)
+    {
+      self->destroy (self->data);
+      self->destroy = NULL;
+      self->data = NULL;
+    }
+
+  g_clear_object (&self->display);
+
+  G_OBJECT_CLASS (gdk_dmabuf_texture_parent_class)->dispose (object);
+}
+
+typedef struct _ImportedTexture
+{
+  GdkGLContext *context;
+  guint id;
+} ImportedTexture;
+
+static void
+imported_texture_free (gpointer data)
+{
+  ImportedTexture *imported = data;
+
+  gdk_gl_context_make_current (imported->context);
+  glDeleteTextures (1, &imported->id);
+
+  g_object_unref (imported->context);
+  g_slice_free (ImportedTexture, imported);
+}
+
+typedef struct _InvokeData
+{
+  GdkDmabufTexture *self;
+  volatile int spinlock;
+} InvokeData;
+
+/* GL may only be used from the main thread, so downloads import the
+ * buffer there, just like GdkGLTexture does for its downloads.
+ */
+static gboolean
+gdk_dmabuf_texture_ensure_gl_texture_callback (gpointer data)
+{
+  InvokeData *invoke = data;
+  GdkDmabufTexture *self = invoke->self;
+  GdkTexture *texture = GDK_TEXTURE (self);
+  GdkGLContext *context;
+  GError *error = NULL;
+  guint id;
+
+  if (self->gl_texture != NULL)
+    goto out;
+
+  if (!gdk_display_prepare_gl (self->display, &error))
+    {
+      g_warning ("Failed to download dmabuf texture: %s", error->message);
+      g_error_free (error);
+      goto out;
+    }
+
+  context = gdk_display_get_gl_context (self->display);
+  gdk_gl_context_make_current (context);
+
+  id = gdk_dmabuf_texture_import (self, context);
+  if (id != 0)
+    {
+      ImportedTexture *imported = g_slice_new (ImportedTexture);
+
+      imported->context = g_object_ref (context);
+      imported->id = id;
+
+      self->gl_texture = gdk_gl_texture_new (context, id,
+                                             texture->width, texture->height,
+                                             imported_texture_free, imported);
+    }
+  else
+    g_warning ("Failed to import dmabuf texture into GL");
+
+out:
+  g_atomic_int_set (&invoke->spinlock, 1);
+
+  return FALSE;
+}
+
+static void
+gdk_dmabuf_texture_download (GdkTexture      *texture,
+                             GdkMemoryFormat  format,
+                             guchar          *data,
+                             gsize            stride)
+{
+  GdkDmabufTexture *self = GDK_DMABUF_TEXTURE (texture);
+  InvokeData invoke = { self, 0 };
+
+  g_main_context_invoke (NULL, gdk_dmabuf_texture_ensure_gl_texture_callback, &invoke);
+
+  while (g_atomic_int_get (&invoke.spinlock) == 0);
+
+  if (self->gl_texture)
+    {
+      gdk_texture_do_download (self->gl_texture, format, data, stride);
+    }
+  else
+    {
+      gsize y;
+
+      for (y = 0; y < texture->height; y++)
+        memset (data + y * stride, 0, texture->width * gdk_memory_format_bytes_per_pixel (format));
+    }
+}
+
+static void
+gdk_dmabuf_texture_class_init (GdkDmabufTextureClass *klass)
+{
+  GdkTextureClass *texture_class = GDK_TEXTURE_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  texture_class->download = gdk_dmabuf_texture_download;
+
+  gobject_class->dispose = gdk_dmabuf_texture_dispose;
+}
+
+static void
+gdk_dmabuf_texture_init (GdkDmabufTexture *self)
+{
+}
+
+static gboolean
+gdk_dmabuf_texture_get_memory_format (guint32          fourcc,
+                                      GdkMemoryFormat *out_format)
+{
+  switch (fourcc)
+    {
+    case DRM_FORMAT_ARGB8888:
+      *out_format = GDK_MEMORY_B8G8R8A8_PREMULTIPLIED;
+      return TRUE;
+
+    case DRM_FORMAT_ABGR8888:
+      *out_format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED;
+      return TRUE;
+
+    /* The padding byte is read as opaque alpha by GL */
+    case DRM_FORMAT_XRGB8888:
+      *out_format = GDK_MEMORY_B8G8R8;
+      return TRUE;
+
+    case DRM_FORMAT_XBGR8888:
+      *out_format = GDK_MEMORY_R8G8B8;
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+/*<private>
+ * gdk_dmabuf_texture_import:
+ * @self: a `GdkDmabufTexture`
+ * @context: the current `GdkGLContext`
+ *
+ * Imports the buffer as a GL texture into @context, using
+ * EGL_EXT_image_dma_buf_import. The caller owns the returned
+ * texture.
+ *
+ * Returns: the GL texture id, or 0 if the buffer can't be imported
+ */
+guint
+gdk_dmabuf_texture_import (GdkDmabufTexture *self,
+                           GdkGLContext     *context)
+{
+#ifdef HAVE_EGL
+  static const EGLint plane_attribs[GDK_DMABUF_MAX_PLANES][5] = {
+    {
+      EGL_DMA_BUF_PLANE0_FD_EXT,
+      EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+      EGL_DMA_BUF_PLANE0_PITCH_EXT,
+      EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT,
+      EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT
+    }, {
+      EGL_DMA_BUF_PLANE1_FD_EXT,
+      EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+      EGL_DMA_BUF_PLANE1_PITCH_EXT,
+      EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+      EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT
+    }, {
+      EGL_DMA_BUF_PLANE2_FD_EXT,
+      EGL_DMA_BUF_PLANE2_OFFSET_EXT,
+      EGL_DMA_BUF_PLANE2_PITCH_EXT,
+      EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT,
+      EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT
+    }, {
+      EGL_DMA_BUF_PLANE3_FD_EXT,
+      EGL_DMA_BUF_PLANE3_OFFSET_EXT,
+      EGL_DMA_BUF_PLANE3_PITCH_EXT,
+      EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT,
+      EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT
+    }
+  };
+  GdkTexture *texture = GDK_TEXTURE (self);
+  EGLint attribs[6 + 10 * GDK_DMABUF_MAX_PLANES + 1];
+  EGLDisplay egl_display;
+  EGLImage image;
+  gboolean use_modifier;
+  guint id, j;
+  int i;
+
+  g_return_val_if_fail (GDK_IS_DMABUF_TEXTURE (self), 0);
+  g_return_val_if_fail (GDK_IS_GL_CONTEXT (context), 0);
+
+  egl_display = gdk_display_get_egl_display (gdk_gl_context_get_display (context));
+  if (egl_display == NULL ||
+      !epoxy_has_egl_extension (egl_display, "EGL_EXT_image_dma_buf_import") ||
+      !epoxy_has_gl_extension ("GL_OES_EGL_image"))
+    return 0;
+
+  use_modifier = self->modifier != DRM_FORMAT_MOD_INVALID;
+  if (use_modifier &&
+      !epoxy_has_egl_extension (egl_display, "EGL_EXT_image_dma_buf_import_modifiers"))
+    return 0;
+
+  i = 0;
+  attribs[i++] = EGL_WIDTH;
+  attribs[i++] = texture->width;
+  attribs[i++] = EGL_HEIGHT;
+  attribs[i++] = texture->height;
+  attribs[i++] = EGL_LINUX_DRM_FOURCC_EXT;
+  attribs[i++] = self->fourcc;
+
+  for (j = 0; j < self->n_planes; j++)
+    {
+      attribs[i++] = plane_attribs[j][0];
+      attribs[i++] = self->fds[j];
+      attribs[i++] = plane_attribs[j][1];
+      attribs[i++] = self->offsets[j];
+      attribs[i++] = plane_attribs[j][2];
+      attribs[i++] = self->strides[j];
+      if (use_modifier)
+        {
+          attribs[i++] = plane_attribs[j][3];
+          attribs[i++] = self->modifier & 0xFFFFFFFF;
+          attribs[i++] = plane_attribs[j][4];
+          attribs[i++] = self->modifier >> 32;
+        }
+    }
+
+  attribs[i++] = EGL_NONE;
+
+  image = eglCreateImageKHR (egl_display,
+                             EGL_NO_CONTEXT,
+                             EGL_LINUX_DMA_BUF_EXT,
+                             (EGLClientBuffer) NULL,
+                             attribs);
+  if (image == EGL_NO_IMAGE_KHR)
+    return 0;
+
+  glGenTextures (1, &id);
+  glBindTexture (GL_TEXTURE_2D, id);
+  glEGLImageTargetTexture2DOES (GL_TEXTURE_2D, image);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  /* The texture keeps the buffer alive on its own */
+  eglDestroyImageKHR (egl_display, image);
+
+  return id;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * gdk_dmabuf_texture_new:
+ * @display: the `GdkDisplay` the buffer belongs to
+ * @width: the width of the texture
+ * @height: the height of the texture
+ * @fourcc: the DRM fourcc code of the buffer format
+ * @modifier: the DRM format modifier, or `DRM_FORMAT_MOD_INVALID`
+ *   to let the driver pick the layout
+ * @n_planes: the number of planes, at most %GDK_DMABUF_MAX_PLANES
+ * @fds: (array length=n_planes): the file descriptors of the planes
+ * @strides: (array length=n_planes): the stride of each plane in bytes
+ * @offsets: (array length=n_planes): the offset of each plane in bytes
+ * @destroy: (nullable): a destroy notify that will be called when the
+ *   buffer is no longer needed
+ * @data: data that gets passed to @destroy
+ * @error: return location for an error
+ *
+ * Creates a new texture for a DMA buffer.
+ *
+ * The file descriptors stay owned by the caller and must stay valid
+ * until @destroy is called. Only the 8-bit RGB formats
+ * `DRM_FORMAT_ARGB8888`, `DRM_FORMAT_ABGR8888`, `DRM_FORMAT_XRGB8888`
+ * and `DRM_FORMAT_XBGR8888` are supported. Colors in formats with
+ * alpha must be premultiplied.
+ *
+ * The buffer is not read when the texture is created. Use a fence
+ * or the dmabuf's implicit synchronization to make sure the producer
+ * has finished writing it before the texture is drawn.
+ *
+ * Returns: (transfer full) (type GdkDmabufTexture) (nullable): A newly-created
+ *   `GdkTexture`, or %NULL if the buffer can't be used
+ *
+ * Since: 4.6
+ */
+GdkTexture *
+gdk_dmabuf_texture_new (GdkDisplay     *display,
+                        int             width,
+                        int             height,
+                        guint32         fourcc,
+                        guint64         modifier,
+                        guint           n_planes,
+                        const int      *fds,
+                        const guint    *strides,
+                        const guint    *offsets,
+                        GDestroyNotify  destroy,
+                        gpointer        data,
+                        GError        **error)
+{
+  GdkDmabufTexture *self;
+  GdkMemoryFormat format;
+  guint i;
+
+  g_return_val_if_fail (GDK_IS_DISPLAY (display), NULL);
+  g_return_val_if_fail (width > 0, NULL);
+  g_return_val_if_fail (height > 0, NULL);
+  g_return_val_if_fail (n_planes > 0 && n_planes <= GDK_DMABUF_MAX_PLANES, NULL);
+  g_return_val_if_fail (fds != NULL, NULL);
+  g_return_val_if_fail (strides != NULL, NULL);
+  g_return_val_if_fail (offsets != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+#ifndef HAVE_EGL
+  g_set_error_literal (error,
+                       GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
+                       _("dmabufs are not supported on this platform"));
+  return NULL;
+#else
+  if (!gdk_dmabuf_texture_get_memory_format (fourcc, &format))
+    {
+      g_set_error (error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_FORMAT,
+                   _("Unsupported dmabuf format %.4s"), (const char *) &fourcc);
+      return NULL;
+    }
+
+  self = g_object_new (GDK_TYPE_DMABUF_TEXTURE,
+                       "width", width,
+                       "height", height,
+                       NULL);
+
+  GDK_TEXTURE (self)->format = format;
+  self->display = g_object_ref (display);
+  self->fourcc = fourcc;
+  self->modifier = modifier;
+  self->n_planes = n_planes;
+  for (i = 0; i < n_planes; i++)
+    {
+      self->fds[i] = fds[i];
+      self->strides[i] = strides[i];
+      self->offsets[i] = offsets[i];
+    }
+  self->destroy = destroy;
+  self->data = data;
+
+  return GDK_TEXTURE (self);
+#endif
+}
+
+/**
+ * gdk_dmabuf_texture_get_fourcc:
+ * @self: a `GdkDmabufTexture`
+ *
+ * Gets the DRM fourcc code of the buffer format.
+ *
+ * Returns: the fourcc code
+ *
+ * Since: 4.6
+ */
+guint32
+gdk_dmabuf_texture_get_fourcc (GdkDmabufTexture *self)
+{
+  g_return_val_if_fail (GDK_IS_DMABUF_TEXTURE (self), 0);
+
+  return self->fourcc;
+}
+
+/**
+ * gdk_dmabuf_texture_get_modifier:
+ * @self: a `GdkDmabufTexture`
+ *
+ * Gets the DRM format modifier of the buffer.
+ *
+ * Returns: the modifier
+ *
+ * Since: 4.6
+ */
+guint64
+gdk_dmabuf_texture_get_modifier (GdkDmabufTexture *self)
+{
+  g_return_val_if_fail (GDK_IS_DMABUF_TEXTURE (self), 0);
+
+  return self->modifier;
+}
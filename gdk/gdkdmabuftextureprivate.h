@@ -0,0 +1,15 @@
+#ifndef __GDK_DMABUF_TEXTURE_PRIVATE_H__
+#define __GDK_DMABUF_TEXTURE_PRIVATE_H__
+
+#include "gdkdmabuftexture.h"
+
+#include "gdktextureprivate.h"
+
+G_BEGIN_DECLS
+
+guint                   gdk_dmabuf_texture_import       (GdkDmabufTexture       *self,
+                                                         GdkGLContext           *context);
+
+G_END_DECLS
+
+#endif /* __GDK_DMABUF_TEXTURE_PRIVATE_H__ */
@@ -826,6 +826,192 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
     }
 }
 
+static void
+gdk_touch_event_push_history (GdkEvent *event,
+                              GdkEvent *history_event)
+{
+  GdkTouchEvent *self = (GdkTouchEvent *) event;
+  GdkTouchEvent *other = (GdkTouchEvent *) history_event;
+  GdkTimeCoord hist;
+
+  if (G_UNLIKELY (!self->history))
+    self->history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
+
+  if (other->history)
+    g_array_append_vals (self->history, other->history->data, other->history->len);
+
+  memset (&hist, 0, sizeof (GdkTimeCoord));
+  hist.time = gdk_event_get_time (history_event);
+  hist.flags = GDK_AXIS_FLAG_X | GDK_AXIS_FLAG_Y;
+  hist.axes[GDK_AXIS_X] = other->x;
+  hist.axes[GDK_AXIS_Y] = other->y;
+
+  g_array_append_val (self->history, hist);
+}
+
+/* If the last N events in the event queue are touch updates for
+ * the same surface and device, drop all but the last update of
+ * each sequence.
+ *
+ * The remaining events get a history containing the dropped
+ * updates of their sequence.
+ */
+void
+gdk_event_queue_handle_touch_compression (GdkDisplay *display)
+{
+  GList *l;
+  GList *updates = NULL;
+  GdkSurface *surface = NULL;
+  GdkDevice *device = NULL;
+
+  l = g_queue_peek_tail_link (&display->queued_events);
+
+  while (l)
+    {
+      GdkEvent *event = l->data;
+
+      if (event->flags & GDK_EVENT_PENDING)
+        break;
+
+      if (event->event_type != GDK_TOUCH_UPDATE)
+        break;
+
+      if (surface != NULL &&
+          surface != event->surface)
+        break;
+
+      if (device != NULL &&
+          device != event->device)
+        break;
+
+      surface = event->surface;
+      device = event->device;
+      updates = l;
+
+      l = l->prev;
+    }
+
+  while (updates && updates->next != NULL)
+    {
+      GdkEvent *event = updates->data;
+      GList *next = updates->next;
+
+      /* Sequences are interleaved, find the next update of this one */
+      for (l = next; l; l = l->next)
+        {
+          if (((GdkTouchEvent *) l->data)->sequence == ((GdkTouchEvent *) event)->sequence)
+            break;
+        }
+
+      if (l)
+        {
+          gdk_touch_event_push_history (l->data, event);
+          gdk_event_unref (event);
+          g_queue_delete_link (&display->queued_events, updates);
+        }
+
+      updates = next;
+    }
+}
+
+static void
+gdk_touchpad_event_push_history (GdkEvent *event,
+                                 GdkEvent *history_event)
+{
+  GdkTouchpadEvent *self = (GdkTouchpadEvent *) event;
+  GdkTouchpadEvent *other = (GdkTouchpadEvent *) history_event;
+  GdkTimeCoord hist;
+
+  g_assert (self->history == NULL);
+
+  /* The history of the other event already ends with its own deltas */
+  if (other->history)
+    {
+      self->history = other->history;
+      other->history = NULL;
+    }
+  else
+    {
+      self->history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
+
+      memset (&hist, 0, sizeof (GdkTimeCoord));
+      hist.time = gdk_event_get_time (history_event);
+      hist.flags = GDK_AXIS_FLAG_DELTA_X | GDK_AXIS_FLAG_DELTA_Y;
+      hist.axes[GDK_AXIS_DELTA_X] = other->dx;
+      hist.axes[GDK_AXIS_DELTA_Y] = other->dy;
+      g_array_append_val (self->history, hist);
+    }
+
+  memset (&hist, 0, sizeof (GdkTimeCoord));
+  hist.time = gdk_event_get_time (event);
+  hist.flags = GDK_AXIS_FLAG_DELTA_X | GDK_AXIS_FLAG_DELTA_Y;
+  hist.axes[GDK_AXIS_DELTA_X] = self->dx;
+  hist.axes[GDK_AXIS_DELTA_Y] = self->dy;
+  g_array_append_val (self->history, hist);
+
+  /* Deltas are relative to the previous update, the scale is
+   * relative to the start of the gesture. */
+  self->dx += other->dx;
+  self->dy += other->dy;
+  self->angle_delta += other->angle_delta;
+}
+
+/* If the last N events in the event queue are updates of the same
+ * touchpad gesture, combine them into one.
+ *
+ * Like for scroll events, the remaining event gets a history with
+ * N items, and deltas that are the sum over the history entries.
+ */
+void
+gdk_event_queue_handle_touchpad_compression (GdkDisplay *display)
+{
+  GList *l;
+  GList *updates = NULL;
+  GdkEvent *last_event = NULL;
+
+  l = g_queue_peek_tail_link (&display->queued_events);
+
+  while (l)
+    {
+      GdkEvent *event = l->data;
+
+      if (event->flags & GDK_EVENT_PENDING)
+        break;
+
+      if (event->event_type != GDK_TOUCHPAD_SWIPE &&
+          event->event_type != GDK_TOUCHPAD_PINCH)
+        break;
+
+      if (((GdkTouchpadEvent *) event)->phase != GDK_TOUCHPAD_GESTURE_PHASE_UPDATE)
+        break;
+
+      if (last_event != NULL &&
+          (last_event->event_type != event->event_type ||
+           last_event->surface != event->surface ||
+           last_event->device != event->device ||
+           ((GdkTouchpadEvent *) last_event)->n_fingers != ((GdkTouchpadEvent *) event)->n_fingers))
+        break;
+
+      if (!last_event)
+        last_event = event;
+
+      updates = l;
+
+      l = l->prev;
+    }
+
+  while (updates && updates->next != NULL)
+    {
+      GList *next = updates->next;
+
+      gdk_touchpad_event_push_history (next->data, updates->data);
+
+      gdk_event_unref (updates->data);
+      g_queue_delete_link (&display->queued_events, updates);
+      updates = next;
+    }
+}
+
 void
 _gdk_event_queue_flush (GdkDisplay *display)
 {
@@ -1920,6 +2106,8 @@ gdk_touch_event_finalize (GdkEvent *event)
   GdkTouchEvent *self = (GdkTouchEvent *) event;
 
   g_clear_pointer (&self->axes, g_free);
+  if (self->history)
+    g_array_free (self->history, TRUE);
 
   GDK_EVENT_SUPER (event)->finalize (event);
 }
@@ -2453,6 +2641,17 @@ gdk_scroll_event_is_stop (GdkEvent *event)
  * processed by the system, resulting in these events.
  */
 
+static void
+gdk_touchpad_event_finalize (GdkEvent *event)
+{
+  GdkTouchpadEvent *self = (GdkTouchpadEvent *) event;
+
+  if (self->history)
+    g_array_free (self->history, TRUE);
+
+  GDK_EVENT_SUPER (event)->finalize (event);
+}
+
 static GdkModifierType
 gdk_touchpad_event_get_state (GdkEvent *event)
 {
@@ -2485,7 +2684,7 @@ gdk_touchpad_event_get_position (GdkEvent *event,
 static const GdkEventTypeInfo gdk_touchpad_event_info = {
   sizeof (GdkTouchpadEvent),
   NULL,
-  NULL,
+  gdk_touchpad_event_finalize,
   gdk_touchpad_event_get_state,
   gdk_touchpad_event_get_position,
   gdk_touchpad_event_get_sequence,
@@ -2977,7 +3176,7 @@ gdk_motion_event_new (GdkSurface      *surface,
 
 /**
  * gdk_event_get_history:
- * @event: a motion or scroll event
+ * @event: a motion, scroll, touch or touchpad event
  * @out_n_coords: (out): Return location for the length of the returned array
  *
  * Retrieves the history of the device that @event is for, as a list of
@@ -2986,9 +3185,9 @@ gdk_motion_event_new (GdkSurface      *surface,
  * The history includes positions that are not delivered as separate events
  * to the application because they occurred in the same frame as @event.
  *
- * Note that only motion and scroll events record history, and motion
- * events do it only if one of the mouse buttons is down, or the device
- * has a tool.
+ * Note that only motion, scroll, touch update and touchpad gesture update
+ * events record history, and motion events do it only if one of the mouse
+ * buttons is down, or the device has a tool.
  *
  * Returns: (transfer container) (array length=out_n_coords) (nullable): an
  *   array of time and coordinates
@@ -3001,7 +3200,14 @@ gdk_event_get_history (GdkEvent *event,
 
   g_return_val_if_fail (GDK_IS_EVENT (event), NULL);
   g_return_val_if_fail (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY) ||
-                        GDK_IS_EVENT_TYPE (event, GDK_SCROLL), NULL);
+                        GDK_IS_EVENT_TYPE (event, GDK_SCROLL) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCH_BEGIN) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCH_UPDATE) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCH_END) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCH_CANCEL) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCHPAD_SWIPE) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCHPAD_PINCH) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCHPAD_HOLD), NULL);
   g_return_val_if_fail (out_n_coords != NULL, NULL);
 
   if (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY))
@@ -3009,11 +3215,23 @@ gdk_event_get_history (GdkEvent *event,
       GdkMotionEvent *self = (GdkMotionEvent *) event;
       history = self->history;
     }
-  else
+  else if (GDK_IS_EVENT_TYPE (event, GDK_SCROLL))
     {
       GdkScrollEvent *self = (GdkScrollEvent *) event;
       history = self->history;
     }
+  else if (GDK_IS_EVENT_TYPE (event, GDK_TOUCHPAD_SWIPE) ||
+           GDK_IS_EVENT_TYPE (event, GDK_TOUCHPAD_PINCH) ||
+           GDK_IS_EVENT_TYPE (event, GDK_TOUCHPAD_HOLD))
+    {
+      GdkTouchpadEvent *self = (GdkTouchpadEvent *) event;
+      history = self->history;
+    }
+  else
+    {
+      GdkTouchEvent *self = (GdkTouchEvent *) event;
+      history = self->history;
+    }
 
   if (history && history->len > 0)
     {
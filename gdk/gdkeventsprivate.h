@@ -169,6 +169,9 @@ struct _GdkButtonEvent
  *   if @device is the mouse
  * @sequence: the event sequence that the event belongs to
  * @emulated: whether the event is the result of a pointer emulation
+ * @history: (element-type GdkTimeCoord): array of times and positions
+ *   for other touch updates of the same sequence that were compressed
+ *   before delivering the current event
  *
  * Used for touch events.
  * @type field will be one of %GDK_TOUCH_BEGIN, %GDK_TOUCH_UPDATE,
@@ -192,6 +195,7 @@ struct _GdkTouchEvent
   GdkEventSequence *sequence;
   gboolean touch_emulating;
   gboolean pointer_emulated;
+  GArray *history; /* <GdkTimeCoord> */
 };
 
 /*
@@ -395,6 +399,9 @@ struct _GdkDNDEvent
  *   denote counter-clockwise movements
  * @scale: For pinch events, the current scale, relative to that at the time of
  *   the corresponding %GDK_TOUCHPAD_GESTURE_PHASE_BEGIN event
+ * @history: (element-type GdkTimeCoord): array of times and deltas
+ *   for other updates of the gesture that were compressed before
+ *   delivering the current event
  *
  * Generated during touchpad gestures.
  */
@@ -412,6 +419,7 @@ struct _GdkTouchpadEvent
   double dy;
   double angle_delta;
   double scale;
+  GArray *history; /* <GdkTimeCoord> */
 };
 
 struct _GdkPadEvent
@@ -613,6 +621,8 @@ GList* _gdk_event_queue_append       (GdkDisplay *display,
 
 void    _gdk_event_queue_handle_motion_compression (GdkDisplay *display);
 void    gdk_event_queue_handle_scroll_compression  (GdkDisplay *display);
+void    gdk_event_queue_handle_touch_compression   (GdkDisplay *display);
+void    gdk_event_queue_handle_touchpad_compression (GdkDisplay *display);
 void    _gdk_event_queue_flush                     (GdkDisplay       *display);
 
 double * gdk_event_dup_axes (GdkEvent *event);
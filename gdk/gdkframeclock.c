@@ -78,6 +78,9 @@ enum {
 static guint signals[LAST_SIGNAL];
 
 static guint fps_counter;
+static guint span_counters[GDK_FRAME_N_SPANS];
+
+static int spans_enabled;
 
 #define FRAME_HISTORY_MAX_LENGTH 16
 
@@ -258,7 +261,16 @@ gdk_frame_clock_init (GdkFrameClock *clock)
   priv->current = FRAME_HISTORY_MAX_LENGTH - 1;
 
   if (fps_counter == 0)
-    fps_counter = gdk_profiler_define_counter ("fps", "Frames per Second");
+    {
+      fps_counter = gdk_profiler_define_counter ("fps", "Frames per Second");
+
+      span_counters[GDK_FRAME_SPAN_STYLE] = gdk_profiler_define_int_counter ("frame-style", "Time spent in style updates per frame, in µs");
+      span_counters[GDK_FRAME_SPAN_LAYOUT] = gdk_profiler_define_int_counter ("frame-layout", "Time spent in layout per frame, in µs");
+      span_counters[GDK_FRAME_SPAN_SNAPSHOT] = gdk_profiler_define_int_counter ("frame-snapshot", "Time spent in snapshot per frame, in µs");
+      span_counters[GDK_FRAME_SPAN_DIFF] = gdk_profiler_define_int_counter ("frame-diff", "Time spent diffing render nodes per frame, in µs");
+      span_counters[GDK_FRAME_SPAN_RENDER] = gdk_profiler_define_int_counter ("frame-render", "Time spent rendering per frame, in µs");
+      span_counters[GDK_FRAME_SPAN_SUBMIT] = gdk_profiler_define_int_counter ("frame-submit", "Time spent submitting per frame, in µs");
+    }
 }
 
 /**
@@ -801,6 +813,97 @@ gdk_frame_clock_get_fps (GdkFrameClock *frame_clock)
   return ((double) end_counter - start_counter) * G_USEC_PER_SEC / (end_timestamp - start_timestamp);
 }
 
+/*
+ * _gdk_frame_clock_enable_spans:
+ * @enable: whether to enable or disable span timing
+ *
+ * Turns on recording of the time spent in the different parts
+ * of a frame into the `GdkFrameTimings` of all frame clocks.
+ *
+ * Spans are also recorded while the profiler is running, and
+ * reported as counters.
+ *
+ * Calls nest, the spans are recorded as long as there was an
+ * enabling call that was not matched by a disabling one.
+ */
+void
+_gdk_frame_clock_enable_spans (gboolean enable)
+{
+  if (enable)
+    spans_enabled++;
+  else
+    {
+      g_return_if_fail (spans_enabled > 0);
+      spans_enabled--;
+    }
+}
+
+/*
+ * _gdk_frame_clock_begin_span:
+ * @clock: (nullable): a `GdkFrameClock`
+ *
+ * Returns the time to pass to _gdk_frame_clock_end_span()
+ * when the timed work is done, or 0 if spans are not recorded.
+ */
+gint64
+_gdk_frame_clock_begin_span (GdkFrameClock *clock)
+{
+  if ((!spans_enabled && !GDK_PROFILER_IS_RUNNING) || clock == NULL)
+    return 0;
+
+  return g_get_monotonic_time ();
+}
+
+void
+_gdk_frame_clock_end_span (GdkFrameClock *clock,
+                           GdkFrameSpan   span,
+                           gint64         begin_time)
+{
+  GdkFrameTimings *timings;
+
+  if (begin_time == 0)
+    return;
+
+  timings = gdk_frame_clock_get_current_timings (clock);
+  if (timings)
+    timings->spans[span] += g_get_monotonic_time () - begin_time;
+}
+
+const char *
+_gdk_frame_span_get_name (GdkFrameSpan span)
+{
+  const char *names[GDK_FRAME_N_SPANS] = {
+    [GDK_FRAME_SPAN_STYLE] = "style",
+    [GDK_FRAME_SPAN_LAYOUT] = "layout",
+    [GDK_FRAME_SPAN_SNAPSHOT] = "snapshot",
+    [GDK_FRAME_SPAN_DIFF] = "diff",
+    [GDK_FRAME_SPAN_RENDER] = "render",
+    [GDK_FRAME_SPAN_SUBMIT] = "submit",
+  };
+
+  g_return_val_if_fail (span < GDK_FRAME_N_SPANS, NULL);
+
+  return names[span];
+}
+
+/*
+ * _gdk_frame_timings_get_busy_time:
+ * @timings: a `GdkFrameTimings`
+ *
+ * Returns: the total time spent in the recorded spans of the frame
+ */
+gint64
+_gdk_frame_timings_get_busy_time (GdkFrameTimings *timings)
+{
+  gint64 total = 0;
+  int i;
+
+  for (i = 0; i < GDK_FRAME_N_SPANS; i++)
+    total += timings->spans[i];
+
+  return total;
+}
+
 void
 _gdk_frame_clock_add_timings_to_profiler (GdkFrameClock   *clock,
                                           GdkFrameTimings *timings)
@@ -816,4 +919,7 @@ _gdk_frame_clock_add_timings_to_profiler (GdkFrameClock   *clock,
     }
 
   gdk_profiler_set_counter (fps_counter, gdk_frame_clock_get_fps (clock));
+
+  for (int i = 0; i < GDK_FRAME_N_SPANS; i++)
+    gdk_profiler_set_int_counter (span_counters[i], timings->spans[i]);
 }
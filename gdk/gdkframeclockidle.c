@@ -30,6 +30,7 @@
 #include "gdkframeclockprivate.h"
 #include "gdk-private.h"
 #include "gdkprofilerprivate.h"
+#include "gdkalloccountersprivate.h"
 
 #ifdef G_OS_WIN32
 #include <windows.h>
@@ -37,6 +38,10 @@
 
 #define FRAME_INTERVAL 16667 /* microseconds */
 
+/* In low-latency mode, how long before the vblank we want to be done,
+ * to give the compositor time to pick up the frame */
+#define LOW_LATENCY_MARGIN 2000 /* microseconds */
+
 typedef enum {
   SMOOTH_PHASE_STATE_VALID = 0,    /* explicit, since we count on zero-init */
   SMOOTH_PHASE_STATE_AWAIT_FIRST,
@@ -59,6 +64,9 @@ struct _GdkFrameClockIdlePrivate
   gint64 sleep_serial;
   gint64 freeze_time; /* in microseconds */
 
+  gint64 frame_duration_avg;           /* Moving average of how long our update+layout+paint takes */
+  gint64 frame_duration_dev;           /* Moving mean deviation of the same, to stay on the safe side */
+
   guint flush_idle_id;
   guint paint_idle_id;
   guint freeze_count;
@@ -69,6 +77,7 @@ struct _GdkFrameClockIdlePrivate
 
   guint in_paint_idle : 1;
   guint paint_is_thaw : 1;
+  guint low_latency : 1;
 #ifdef G_OS_WIN32
   guint begin_period : 1;
 #endif
@@ -288,6 +297,111 @@ gdk_frame_clock_idle_get_frame_time (GdkFrameClock *clock)
    (((priv)->requested & ~GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS) != 0 ||   \
     (priv)->updating_count > 0))
 
+/* Finds the next vblank from the most recent presentation time we
+ * know of, or returns 0 if we don't know any.
+ */
+static gint64
+predict_next_vblank (GdkFrameClock *clock,
+                     gint64         now)
+{
+  gint64 counter, start;
+
+  counter = gdk_frame_clock_get_frame_counter (clock);
+  start = MAX (gdk_frame_clock_get_history_start (clock), counter - 4);
+
+  for (; counter >= start; counter--)
+    {
+      GdkFrameTimings *timings = gdk_frame_clock_get_timings (clock, counter);
+      gint64 presentation_time, refresh_interval;
+
+      if (timings == NULL)
+        break;
+
+      presentation_time = gdk_frame_timings_get_presentation_time (timings);
+      refresh_interval = gdk_frame_timings_get_refresh_interval (timings);
+      if (presentation_time == 0 || refresh_interval == 0)
+        continue;
+
+      if (presentation_time > now)
+        return presentation_time;
+
+      return presentation_time + ((now - presentation_time) / refresh_interval + 1) * refresh_interval;
+    }
+
+  return 0;
+}
+
+/* In low-latency mode, we don't start the cycle right after the
+ * previous frame was presented, but as late as we can while still
+ * making the next vblank, so that we pick up as much input as
+ * possible.
+ */
+static gint64
+compute_low_latency_delay (GdkFrameClockIdle *clock_idle)
+{
+  GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+  gint64 now, next_vblank, start;
+
+  /* Need to know how long our frames take first */
+  if (priv->frame_duration_avg == 0)
+    return 0;
+
+  now = g_get_monotonic_time ();
+  next_vblank = predict_next_vblank (GDK_FRAME_CLOCK (clock_idle), now);
+  if (next_vblank == 0)
+    return 0;
+
+  start = next_vblank - LOW_LATENCY_MARGIN -
+          (priv->frame_duration_avg + 2 * priv->frame_duration_dev);
+
+  return CLAMP (start - now, 0, priv->smoothed_frame_time_period);
+}
+
+/* In low-latency mode, a frame that was requested while handling
+ * input is started right away instead of waiting for the paint idle,
+ * which would let other sources run first. We only do this when the
+ * frame could start anyway: the clock must not be frozen waiting for
+ * the previous frame to be presented, and we must not be ahead of
+ * the frame rate when the backend does not throttle us.
+ */
+static gboolean
+should_paint_immediately (GdkFrameClockIdle *clock_idle)
+{
+  GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+
+  if (priv->in_paint_idle || !RUN_PAINT_IDLE (priv))
+    return FALSE;
+
+  if (priv->phase != GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT)
+    return FALSE;
+
+  if (priv->min_next_frame_time != 0 &&
+      priv->min_next_frame_time > g_get_monotonic_time ())
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+update_frame_duration (GdkFrameClockIdle *clock_idle,
+                       gint64             duration)
+{
+  GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+  gint64 error;
+
+  if (priv->frame_duration_avg == 0)
+    {
+      priv->frame_duration_avg = MAX (duration, 1);
+      priv->frame_duration_dev = duration / 2;
+      return;
+    }
+
+  /* Same smoothing as TCP uses for round trip times */
+  error = duration - priv->frame_duration_avg;
+  priv->frame_duration_avg = MAX (priv->frame_duration_avg + error / 8, 1);
+  priv->frame_duration_dev += (ABS (error) - priv->frame_duration_dev) / 4;
+}
+
 static void
 maybe_start_idle (GdkFrameClockIdle *clock_idle,
                   gboolean caused_by_thaw)
@@ -297,6 +411,7 @@ maybe_start_idle (GdkFrameClockIdle *clock_idle,
   if (RUN_FLUSH_IDLE (priv) || RUN_PAINT_IDLE (priv))
     {
       guint min_interval = 0;
+      guint paint_interval;
 
       if (priv->min_next_frame_time != 0)
         {
@@ -305,6 +420,10 @@ maybe_start_idle (GdkFrameClockIdle *clock_idle,
           min_interval = (min_interval_us + 500) / 1000;
         }
 
+      paint_interval = min_interval;
+      if (caused_by_thaw && priv->low_latency)
+        paint_interval = MAX (paint_interval, compute_low_latency_delay (clock_idle) / 1000);
+
       if (priv->flush_idle_id == 0 && RUN_FLUSH_IDLE (priv))
         {
           GSource *source;
@@ -323,7 +442,7 @@ maybe_start_idle (GdkFrameClockIdle *clock_idle,
         {
           priv->paint_is_thaw = caused_by_thaw;
           priv->paint_idle_id = g_timeout_add_full (GDK_PRIORITY_REDRAW,
-                                                    min_interval,
+                                                    paint_interval,
                                                     gdk_frame_clock_paint_idle,
                                                     g_object_ref (clock_idle),
                                                     (GDestroyNotify) g_object_unref);
@@ -373,6 +492,18 @@ gdk_frame_clock_flush_idle (void *data)
   else
     priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
 
+  if (priv->low_latency && should_paint_immediately (clock_idle))
+    {
+      if (priv->paint_idle_id != 0)
+        {
+          g_source_remove (priv->paint_idle_id);
+          priv->paint_idle_id = 0;
+        }
+
+      priv->paint_is_thaw = FALSE;
+      gdk_frame_clock_paint_idle (clock);
+    }
+
   return FALSE;
 }
 
@@ -403,6 +534,7 @@ gdk_frame_clock_paint_idle (void *data)
   GdkFrameClockIdlePrivate *priv = clock_idle->priv;
   gboolean skip_to_resume_events;
   GdkFrameTimings *timings = NULL;
+  gboolean started_frame = FALSE;
   gint64 before G_GNUC_UNUSED;
 
   before = GDK_PROFILER_CURRENT_TIME;
@@ -437,6 +569,7 @@ gdk_frame_clock_paint_idle (void *data)
                 frame_interval = prev_timings->refresh_interval;
 
               priv->frame_time = g_get_monotonic_time ();
+              started_frame = TRUE;
 
               /*
                * The first clock cycle of an animation might have been triggered by some external event. An external
@@ -612,6 +745,8 @@ gdk_frame_clock_paint_idle (void *data)
             {
               priv->requested &= ~GDK_FRAME_CLOCK_PHASE_AFTER_PAINT;
               _gdk_frame_clock_emit_after_paint (clock);
+              if (started_frame)
+                update_frame_duration (clock_idle, g_get_monotonic_time () - priv->frame_time);
               /* the ::after-paint phase doesn't get repeated on freeze/thaw,
                */
               priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
@@ -664,6 +799,8 @@ gdk_frame_clock_paint_idle (void *data)
   if (priv->freeze_count == 0)
     priv->sleep_serial = get_sleep_serial ();
 
+  gdk_alloc_counters_end_frame ();
+
   gdk_profiler_end_mark (before, "frameclock cycle", NULL);
 
   return FALSE;
@@ -802,3 +939,16 @@ _gdk_frame_clock_idle_new (void)
 
   return GDK_FRAME_CLOCK (clock);
 }
+
+void
+gdk_frame_clock_idle_set_low_latency (GdkFrameClockIdle *clock_idle,
+                                      gboolean           low_latency)
+{
+  clock_idle->priv->low_latency = !!low_latency;
+}
+
+gboolean
+gdk_frame_clock_idle_get_low_latency (GdkFrameClockIdle *clock_idle)
+{
+  return clock_idle->priv->low_latency;
+}
@@ -60,6 +60,10 @@ GType           gdk_frame_clock_idle_get_type       (void) G_GNUC_CONST;
 
 GdkFrameClock *_gdk_frame_clock_idle_new            (void);
 
+void            gdk_frame_clock_idle_set_low_latency (GdkFrameClockIdle *clock_idle,
+                                                      gboolean           low_latency);
+gboolean        gdk_frame_clock_idle_get_low_latency (GdkFrameClockIdle *clock_idle);
+
 G_END_DECLS
 
 #endif /* __GDK_FRAME_CLOCK_IDLE_H__ */
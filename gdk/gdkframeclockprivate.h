@@ -82,6 +82,20 @@ struct _GdkFrameClockClass
   /* void (* resume_events)      (GdkFrameClock *clock); */
 };
 
+/* Parts of the work for a frame that can be timed with
+ * _gdk_frame_clock_begin_span() and _gdk_frame_clock_end_span().
+ */
+typedef enum
+{
+  GDK_FRAME_SPAN_STYLE,
+  GDK_FRAME_SPAN_LAYOUT,
+  GDK_FRAME_SPAN_SNAPSHOT,
+  GDK_FRAME_SPAN_DIFF,
+  GDK_FRAME_SPAN_RENDER,
+  GDK_FRAME_SPAN_SUBMIT,
+  GDK_FRAME_N_SPANS
+} GdkFrameSpan;
+
 struct _GdkFrameTimings
 {
   /*< private >*/
@@ -96,6 +110,9 @@ struct _GdkFrameTimings
   gint64 refresh_interval;
   gint64 predicted_presentation_time;
 
+  /* Time spent in each GdkFrameSpan, in µs */
+  gint64 spans[GDK_FRAME_N_SPANS];
+
 #ifdef G_ENABLE_DEBUG
   gint64 layout_start_time;
   gint64 paint_start_time;
@@ -115,6 +132,14 @@ void _gdk_frame_clock_debug_print_timings (GdkFrameClock   *clock,
 void _gdk_frame_clock_add_timings_to_profiler (GdkFrameClock *frame_clock,
                                                GdkFrameTimings *timings);
 
+void        _gdk_frame_clock_enable_spans   (gboolean         enable);
+gint64      _gdk_frame_clock_begin_span     (GdkFrameClock   *clock);
+void        _gdk_frame_clock_end_span       (GdkFrameClock   *clock,
+                                             GdkFrameSpan     span,
+                                             gint64           begin_time);
+const char *_gdk_frame_span_get_name        (GdkFrameSpan     span);
+gint64      _gdk_frame_timings_get_busy_time (GdkFrameTimings *timings);
+
 GdkFrameTimings *_gdk_frame_timings_new   (gint64           frame_counter);
 gboolean         _gdk_frame_timings_steal (GdkFrameTimings *timings,
                                            gint64           frame_counter);
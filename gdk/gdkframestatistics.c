@@ -0,0 +1,492 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "gdkframestatisticsprivate.h"
+#include "gdkframeclockprivate.h"
+
+/**
+ * GdkFrameStatistics:
+ *
+ * A `GdkFrameStatistics` object collects statistics about the frames
+ * that were presented for a surface.
+ *
+ * It keeps histograms of the time between presented frames and of the
+ * latency from input events to the presentation of the frame that
+ * handled them, counts the vblanks that were missed and measures how
+ * much frames deviate from the refresh rate of the monitor.
+ *
+ * Collecting statistics is started for a surface by calling
+ * [method@Gdk.Surface.get_frame_statistics]. The information is
+ * taken from the [struct@Gdk.FrameTimings] of each frame, so it is
+ * only as precise as the presentation times reported by the backend.
+ *
+ * Since: 4.6
+ */
+
+/* Histograms have buckets of 1ms from 0 to N_BUCKETS ms,
+ * and one more bucket for everything that takes longer.
+ */
+#define N_BUCKETS 100
+#define BUCKET_SIZE 1000
+
+/* Used when the backend does not report the refresh interval */
+#define DEFAULT_REFRESH_INTERVAL 16667
+
+typedef struct
+{
+  guint buckets[N_BUCKETS + 1];
+  guint count;
+  gint64 max;
+} Histogram;
+
+typedef struct
+{
+  gint64 frame_counter;
+  gint64 input_time;
+} PendingInput;
+
+struct _GdkFrameStatistics
+{
+  guint ref_count;
+
+  Histogram frame_times;
+  Histogram latencies;
+
+  guint n_frames;
+  guint n_missed_frames;
+  gint64 jitter_sum;
+  guint jitter_count;
+
+  /* Where we are in the history of the frame clock */
+  GdkFrameClock *clock; /* unowned, only compared */
+  gint64 last_handled_frame;
+  gint64 last_presentation_time;
+
+  /* The earliest input that was not painted yet */
+  gint64 input_time;
+  /* Input belonging to frames that are not complete yet */
+  GArray *pending_inputs;
+};
+
+G_DEFINE_BOXED_TYPE (GdkFrameStatistics, gdk_frame_statistics,
+                     gdk_frame_statistics_ref,
+                     gdk_frame_statistics_unref)
+
+static void
+histogram_add (Histogram *histogram,
+               gint64     value)
+{
+  gint64 bucket = value / BUCKET_SIZE;
+
+  histogram->buckets[CLAMP (bucket, 0, N_BUCKETS)]++;
+  histogram->count++;
+  histogram->max = MAX (histogram->max, value);
+}
+
+static gint64
+histogram_get_percentile (const Histogram *histogram,
+                          double           percentile)
+{
+  guint needed, seen;
+  guint i;
+
+  if (histogram->count == 0)
+    return 0;
+
+  needed = MAX (1, (guint) ceil (CLAMP (percentile, 0.0, 1.0) * histogram->count));
+  seen = 0;
+
+  for (i = 0; i < N_BUCKETS; i++)
+    {
+      seen += histogram->buckets[i];
+      if (seen >= needed)
+        return MIN ((i + 1) * BUCKET_SIZE, histogram->max);
+    }
+
+  return histogram->max;
+}
+
+GdkFrameStatistics *
+gdk_frame_statistics_new (void)
+{
+  GdkFrameStatistics *statistics;
+
+  statistics = g_slice_new0 (GdkFrameStatistics);
+  statistics->ref_count = 1;
+  statistics->pending_inputs = g_array_new (FALSE, FALSE, sizeof (PendingInput));
+
+  return statistics;
+}
+
+/**
+ * gdk_frame_statistics_ref:
+ * @statistics: a `GdkFrameStatistics`
+ *
+ * Increases the reference count of @statistics.
+ *
+ * Returns: @statistics
+ *
+ * Since: 4.6
+ */
+GdkFrameStatistics *
+gdk_frame_statistics_ref (GdkFrameStatistics *statistics)
+{
+  g_return_val_if_fail (statistics != NULL, NULL);
+
+  statistics->ref_count++;
+
+  return statistics;
+}
+
+/**
+ * gdk_frame_statistics_unref:
+ * @statistics: a `GdkFrameStatistics`
+ *
+ * Decreases the reference count of @statistics.
+ *
+ * If @statistics is no longer referenced, it will be freed.
+ *
+ * Since: 4.6
+ */
+void
+gdk_frame_statistics_unref (GdkFrameStatistics *statistics)
+{
+  g_return_if_fail (statistics != NULL);
+  g_return_if_fail (statistics->ref_count > 0);
+
+  statistics->ref_count--;
+  if (statistics->ref_count == 0)
+    {
+      g_array_unref (statistics->pending_inputs);
+      g_slice_free (GdkFrameStatistics, statistics);
+    }
+}
+
+/**
+ * gdk_frame_statistics_reset:
+ * @statistics: a `GdkFrameStatistics`
+ *
+ * Forgets all the frames that were collected so far.
+ *
+ * This is useful to measure a specific interaction, like
+ * a scroll or an animation.
+ *
+ * Since: 4.6
+ */
+void
+gdk_frame_statistics_reset (GdkFrameStatistics *statistics)
+{
+  g_return_if_fail (statistics != NULL);
+
+  memset (&statistics->frame_times, 0, sizeof (Histogram));
+  memset (&statistics->latencies, 0, sizeof (Histogram));
+  statistics->n_frames = 0;
+  statistics->n_missed_frames = 0;
+  statistics->jitter_sum = 0;
+  statistics->jitter_count = 0;
+}
+
+/*<private>
+ * gdk_frame_statistics_add_input:
+ * @statistics: a `GdkFrameStatistics`
+ * @time: the monotonic time when the input was handled
+ *
+ * Records that an input event was handled. The latency is measured
+ * for the first input that arrives before each frame.
+ */
+void
+gdk_frame_statistics_add_input (GdkFrameStatistics *statistics,
+                                gint64              time)
+{
+  if (statistics->input_time == 0)
+    statistics->input_time = time;
+}
+
+static void
+gdk_frame_statistics_add_frame (GdkFrameStatistics *statistics,
+                                GdkFrameTimings    *timings)
+{
+  gint64 presentation_time = timings->presentation_time;
+  gint64 refresh_interval = timings->refresh_interval;
+  gint64 interval, vblanks;
+  guint i;
+
+  for (i = 0; i < statistics->pending_inputs->len; i++)
+    {
+      PendingInput *input = &g_array_index (statistics->pending_inputs, PendingInput, i);
+
+      if (input->frame_counter > timings->frame_counter)
+        break;
+
+      if (input->frame_counter == timings->frame_counter && presentation_time != 0)
+        histogram_add (&statistics->latencies, MAX (0, presentation_time - input->input_time));
+    }
+  g_array_remove_range (statistics->pending_inputs, 0, i);
+
+  if (presentation_time == 0)
+    {
+      statistics->last_presentation_time = 0;
+      return;
+    }
+
+  statistics->n_frames++;
+
+  if (refresh_interval <= 0)
+    refresh_interval = DEFAULT_REFRESH_INTERVAL;
+
+  /* A frame that was started well after the previous one was shown
+   * follows a period where nothing needed to be drawn. The gap is not
+   * a frame time, and not a missed frame either.
+   */
+  if (statistics->last_presentation_time == 0 ||
+      timings->frame_time - statistics->last_presentation_time >= refresh_interval)
+    {
+      statistics->last_presentation_time = presentation_time;
+      return;
+    }
+
+  interval = presentation_time - statistics->last_presentation_time;
+  statistics->last_presentation_time = presentation_time;
+
+  histogram_add (&statistics->frame_times, interval);
+
+  vblanks = MAX (1, (interval + refresh_interval / 2) / refresh_interval);
+  statistics->n_missed_frames += vblanks - 1;
+  statistics->jitter_sum += ABS (interval - vblanks * refresh_interval);
+  statistics->jitter_count++;
+}
+
+/*<private>
+ * gdk_frame_statistics_after_paint:
+ * @statistics: a `GdkFrameStatistics`
+ * @clock: the frame clock of the surface
+ *
+ * Collects the frames of @clock that were completed since the last
+ * call, and attaches pending input to the frame that was just painted.
+ */
+void
+gdk_frame_statistics_after_paint (GdkFrameStatistics *statistics,
+                                  GdkFrameClock      *clock)
+{
+  gint64 frame_counter, history_start;
+
+  frame_counter = gdk_frame_clock_get_frame_counter (clock);
+
+  if (statistics->clock != clock)
+    {
+      statistics->clock = clock;
+      statistics->last_handled_frame = frame_counter;
+      statistics->last_presentation_time = 0;
+      g_array_set_size (statistics->pending_inputs, 0);
+    }
+
+  if (statistics->input_time != 0)
+    {
+      PendingInput input = { frame_counter, statistics->input_time };
+
+      g_array_append_val (statistics->pending_inputs, input);
+      statistics->input_time = 0;
+    }
+
+  history_start = gdk_frame_clock_get_history_start (clock);
+  if (statistics->last_handled_frame < history_start)
+    {
+      statistics->last_handled_frame = history_start;
+      statistics->last_presentation_time = 0;
+    }
+
+  for (; statistics->last_handled_frame < frame_counter; statistics->last_handled_frame++)
+    {
+      GdkFrameTimings *timings;
+
+      timings = gdk_frame_clock_get_timings (clock, statistics->last_handled_frame);
+      if (timings == NULL)
+        continue;
+
+      if (!timings->complete)
+        break;
+
+      gdk_frame_statistics_add_frame (statistics, timings);
+    }
+}
+
+/**
+ * gdk_frame_statistics_get_n_frames:
+ * @statistics: a `GdkFrameStatistics`
+ *
+ * Gets the number of frames that were presented.
+ *
+ * Returns: the number of frames
+ *
+ * Since: 4.6
+ */
+guint
+gdk_frame_statistics_get_n_frames (GdkFrameStatistics *statistics)
+{
+  g_return_val_if_fail (statistics != NULL, 0);
+
+  return statistics->n_frames;
+}
+
+/**
+ * gdk_frame_statistics_get_n_missed_frames:
+ * @statistics: a `GdkFrameStatistics`
+ *
+ * Gets the number of vblanks that passed without a new frame
+ * while frames were drawn continuously.
+ *
+ * Returns: the number of missed frames
+ *
+ * Since: 4.6
+ */
+guint
+gdk_frame_statistics_get_n_missed_frames (GdkFrameStatistics *statistics)
+{
+  g_return_val_if_fail (statistics != NULL, 0);
+
+  return statistics->n_missed_frames;
+}
+
+/**
+ * gdk_frame_statistics_get_jitter:
+ * @statistics: a `GdkFrameStatistics`
+ *
+ * Gets the mean deviation of the presentation times from the vblanks
+ * of the monitor, in microseconds.
+ *
+ * With precise presentation times, this is close to 0 even if
+ * frames were missed.
+ *
+ * Returns: the jitter, in microseconds
+ *
+ * Since: 4.6
+ */
+gint64
+gdk_frame_statistics_get_jitter (GdkFrameStatistics *statistics)
+{
+  g_return_val_if_fail (statistics != NULL, 0);
+
+  if (statistics->jitter_count == 0)
+    return 0;
+
+  return statistics->jitter_sum / statistics->jitter_count;
+}
+
+/**
+ * gdk_frame_statistics_get_frame_time_percentile:
+ * @statistics: a `GdkFrameStatistics`
+ * @percentile: the percentile to get, between 0 and 1
+ *
+ * Gets a percentile of the time between presented frames, in
+ * microseconds.
+ *
+ * The value is rounded up to the next millisecond, unless it is
+ * longer than any frame time that has been seen at all.
+ *
+ * Returns: the frame time, or 0 if no frames were collected
+ *
+ * Since: 4.6
+ */
+gint64
+gdk_frame_statistics_get_frame_time_percentile (GdkFrameStatistics *statistics,
+                                                double              percentile)
+{
+  g_return_val_if_fail (statistics != NULL, 0);
+
+  return histogram_get_percentile (&statistics->frame_times, percentile);
+}
+
+/**
+ * gdk_frame_statistics_get_latency_percentile:
+ * @statistics: a `GdkFrameStatistics`
+ * @percentile: the percentile to get, between 0 and 1
+ *
+ * Gets a percentile of the time from handling an input event to
+ * the presentation of the next frame, in microseconds.
+ *
+ * The time it took to deliver the event to the application is not
+ * included.
+ *
+ * Returns: the latency, or 0 if no input was collected
+ *
+ * Since: 4.6
+ */
+gint64
+gdk_frame_statistics_get_latency_percentile (GdkFrameStatistics *statistics,
+                                             double              percentile)
+{
+  g_return_val_if_fail (statistics != NULL, 0);
+
+  return histogram_get_percentile (&statistics->latencies, percentile);
+}
+
+/**
+ * gdk_frame_statistics_get_frame_time_histogram:
+ * @statistics: a `GdkFrameStatistics`
+ * @n_buckets: (out): return location for the number of buckets
+ *
+ * Gets the histogram of the time between presented frames.
+ *
+ * Bucket i counts the frame times from i to i + 1 milliseconds.
+ * The last bucket counts all frame times that were longer.
+ *
+ * Returns: (array length=n_buckets) (transfer none): the histogram
+ *
+ * Since: 4.6
+ */
+const guint *
+gdk_frame_statistics_get_frame_time_histogram (GdkFrameStatistics *statistics,
+                                               gsize              *n_buckets)
+{
+  g_return_val_if_fail (statistics != NULL, NULL);
+  g_return_val_if_fail (n_buckets != NULL, NULL);
+
+  *n_buckets = G_N_ELEMENTS (statistics->frame_times.buckets);
+
+  return statistics->frame_times.buckets;
+}
+
+/**
+ * gdk_frame_statistics_get_latency_histogram:
+ * @statistics: a `GdkFrameStatistics`
+ * @n_buckets: (out): return location for the number of buckets
+ *
+ * Gets the histogram of the input latency.
+ *
+ * The buckets are the same as for
+ * [method@Gdk.FrameStatistics.get_frame_time_histogram].
+ *
+ * Returns: (array length=n_buckets) (transfer none): the histogram
+ *
+ * Since: 4.6
+ */
+const guint *
+gdk_frame_statistics_get_latency_histogram (GdkFrameStatistics *statistics,
+                                            gsize              *n_buckets)
+{
+  g_return_val_if_fail (statistics != NULL, NULL);
+  g_return_val_if_fail (n_buckets != NULL, NULL);
+
+  *n_buckets = G_N_ELEMENTS (statistics->latencies.buckets);
+
+  return statistics->latencies.buckets;
+}
@@ -0,0 +1,68 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GDK_FRAME_STATISTICS_H__
+#define __GDK_FRAME_STATISTICS_H__
+
+#if !defined (__GDK_H_INSIDE__) && !defined (GTK_COMPILATION)
+#error "Only <gdk/gdk.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gdk/gdkversionmacros.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GdkFrameStatistics GdkFrameStatistics;
+
+#define GDK_TYPE_FRAME_STATISTICS (gdk_frame_statistics_get_type ())
+
+GDK_AVAILABLE_IN_4_6
+GType               gdk_frame_statistics_get_type   (void) G_GNUC_CONST;
+
+GDK_AVAILABLE_IN_4_6
+GdkFrameStatistics *gdk_frame_statistics_ref        (GdkFrameStatistics *statistics);
+GDK_AVAILABLE_IN_4_6
+void                gdk_frame_statistics_unref      (GdkFrameStatistics *statistics);
+
+GDK_AVAILABLE_IN_4_6
+void                gdk_frame_statistics_reset      (GdkFrameStatistics *statistics);
+
+GDK_AVAILABLE_IN_4_6
+guint               gdk_frame_statistics_get_n_frames        (GdkFrameStatistics *statistics);
+GDK_AVAILABLE_IN_4_6
+guint               gdk_frame_statistics_get_n_missed_frames (GdkFrameStatistics *statistics);
+GDK_AVAILABLE_IN_4_6
+gint64              gdk_frame_statistics_get_jitter          (GdkFrameStatistics *statistics);
+
+GDK_AVAILABLE_IN_4_6
+gint64              gdk_frame_statistics_get_frame_time_percentile (GdkFrameStatistics *statistics,
+                                                                    double              percentile);
+GDK_AVAILABLE_IN_4_6
+gint64              gdk_frame_statistics_get_latency_percentile    (GdkFrameStatistics *statistics,
+                                                                    double              percentile);
+
+GDK_AVAILABLE_IN_4_6
+const guint *       gdk_frame_statistics_get_frame_time_histogram  (GdkFrameStatistics *statistics,
+                                                                    gsize              *n_buckets);
+GDK_AVAILABLE_IN_4_6
+const guint *       gdk_frame_statistics_get_latency_histogram     (GdkFrameStatistics *statistics,
+                                                                    gsize              *n_buckets);
+
+G_END_DECLS
+
+#endif /* __GDK_FRAME_STATISTICS_H__ */
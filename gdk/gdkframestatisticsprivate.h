@@ -0,0 +1,35 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GDK_FRAME_STATISTICS_PRIVATE_H__
+#define __GDK_FRAME_STATISTICS_PRIVATE_H__
+
+#include "gdkframestatistics.h"
+#include "gdkframeclock.h"
+
+G_BEGIN_DECLS
+
+GdkFrameStatistics *gdk_frame_statistics_new          (void);
+
+void                gdk_frame_statistics_add_input    (GdkFrameStatistics *statistics,
+                                                       gint64              time);
+void                gdk_frame_statistics_after_paint  (GdkFrameStatistics *statistics,
+                                                       GdkFrameClock      *clock);
+
+G_END_DECLS
+
+#endif /* __GDK_FRAME_STATISTICS_PRIVATE_H__ */
@@ -94,6 +94,8 @@
 #include <epoxy/egl.h>
 #endif
 
+#include <math.h>
+
 #define DEFAULT_ALLOWED_APIS GDK_GL_API_GL | GDK_GL_API_GLES
 
 typedef struct {
@@ -545,6 +547,56 @@ gdk_gl_context_real_make_current (GdkGLContext *context,
 #endif
 }
 
+#ifdef HAVE_EGL
+/* Converts @region to EGL rectangles, which have their origin at the
+ * bottom left and are in device pixels. The result is either
+ * @stack_rects or must be freed with g_free().
+ */
+static EGLint *
+gdk_gl_context_get_egl_rects (GdkSurface           *surface,
+                              const cairo_region_t *region,
+                              EGLint               *stack_rects,
+                              int                   n_stack_rects,
+                              int                  *n_rects)
+{
+  double scale = gdk_surface_get_scale (surface);
+  int buffer_width, buffer_height;
+  EGLint *rects;
+  int i, j;
+
+  gdk_surface_get_buffer_size (surface, &buffer_width, &buffer_height);
+
+  *n_rects = cairo_region_num_rectangles (region);
+
+  if (*n_rects <= n_stack_rects)
+    rects = stack_rects;
+  else
+    rects = g_new (EGLint, *n_rects * 4);
+
+  for (i = 0, j = 0; i < *n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      int x0, y0, x1, y1;
+
+      cairo_region_get_rectangle (region, i, &rect);
+
+      /* With fractional scales, round outwards to cover all touched pixels */
+      x0 = floor (rect.x * scale);
+      y0 = floor (rect.y * scale);
+      x1 = MIN (ceil ((rect.x + rect.width) * scale), buffer_width);
+      y1 = MIN (ceil ((rect.y + rect.height) * scale), buffer_height);
+
+      rects[j++] = x0;
+      rects[j++] = buffer_height - y1;
+      rects[j++] = x1 - x0;
+      rects[j++] = y1 - y0;
+    }
+
+  return rects;
+}
+#endif
+
 static void
 gdk_gl_context_real_begin_frame (GdkDrawContext *draw_context,
                                  gboolean        prefers_high_depth,
@@ -573,8 +625,32 @@ gdk_gl_context_real_begin_frame (GdkDrawContext *draw_context,
   cairo_region_union (region, damage);
   cairo_region_destroy (damage);
 
-  ww = gdk_surface_get_width (surface) * gdk_surface_get_scale_factor (surface);
-  wh = gdk_surface_get_height (surface) * gdk_surface_get_scale_factor (surface);
+#ifdef HAVE_EGL
+  /* Tell the driver which parts of the buffer we are going to touch,
+   * so that tiled renderers do not need to load the rest. This has to
+   * happen after querying the buffer age and before drawing.
+   */
+  if (priv->egl_context)
+    {
+      GdkDisplay *display = gdk_draw_context_get_display (draw_context);
+
+      if (display->have_egl_buffer_age && display->have_egl_partial_update)
+        {
+          EGLint stack_rects[4 * 4]; /* 4 rects */
+          EGLint *rects;
+          int n_rects;
+
+          rects = gdk_gl_context_get_egl_rects (surface, region, stack_rects, 4, &n_rects);
+          eglSetDamageRegionKHR (gdk_display_get_egl_display (display),
+                                 gdk_surface_get_egl_surface (surface),
+                                 rects, n_rects);
+          if (rects != stack_rects)
+            g_free (rects);
+        }
+    }
+#endif
+
+  gdk_surface_get_buffer_size (surface, &ww, &wh);
 
   gdk_gl_context_make_current (context);
 
@@ -612,32 +688,20 @@ gdk_gl_context_real_end_frame (GdkDrawContext *draw_context,
 
   gdk_profiler_add_mark (GDK_PROFILER_CURRENT_TIME, 0, "EGL", "swap buffers");
 
-  if (display->have_egl_swap_buffers_with_damage)
+  if (display->have_egl_swap_buffers_with_damage ||
+      display->have_egl_khr_swap_buffers_with_damage)
     {
       EGLint stack_rects[4 * 4]; /* 4 rects */
-      EGLint *heap_rects = NULL;
-      int i, j, n_rects = cairo_region_num_rectangles (painted);
-      int surface_height = gdk_surface_get_height (surface);
-      int scale = gdk_surface_get_scale_factor (surface);
       EGLint *rects;
+      int n_rects;
 
-      if (n_rects < G_N_ELEMENTS (stack_rects) / 4)
-        rects = (EGLint *)&stack_rects;
+      rects = gdk_gl_context_get_egl_rects (surface, painted, stack_rects, 4, &n_rects);
+      if (display->have_egl_swap_buffers_with_damage)
+        eglSwapBuffersWithDamageEXT (gdk_display_get_egl_display (display), egl_surface, rects, n_rects);
       else
-        heap_rects = rects = g_new (EGLint, n_rects * 4);
-
-      for (i = 0, j = 0; i < n_rects; i++)
-        {
-          cairo_rectangle_int_t rect;
-
-          cairo_region_get_rectangle (painted, i, &rect);
-          rects[j++] = rect.x * scale;
-          rects[j++] = (surface_height - rect.height - rect.y) * scale;
-          rects[j++] = rect.width * scale;
-          rects[j++] = rect.height * scale;
-        }
-      eglSwapBuffersWithDamageEXT (gdk_display_get_egl_display (display), egl_surface, rects, n_rects);
-      g_free (heap_rects);
+        eglSwapBuffersWithDamageKHR (gdk_display_get_egl_display (display), egl_surface, rects, n_rects);
+      if (rects != stack_rects)
+        g_free (rects);
     }
   else
     eglSwapBuffers (gdk_display_get_egl_display (display), egl_surface);
@@ -846,6 +910,28 @@ gdk_gl_context_has_unpack_subimage (GdkGLContext *context)
   return priv->has_unpack_subimage;
 }
 
+/*<private>
+ * gdk_gl_context_get_default_framebuffer:
+ * @self: a `GdkGLContext`
+ *
+ * Gets the framebuffer that draws to the surface of @self.
+ *
+ * This is 0 unless the backend renders into a framebuffer object
+ * of its own, like the macOS backend does.
+ *
+ * Returns: the framebuffer to draw the surface contents to
+ */
+guint
+gdk_gl_context_get_default_framebuffer (GdkGLContext *self)
+{
+  GdkGLContextClass *klass = GDK_GL_CONTEXT_GET_CLASS (self);
+
+  if (klass->get_default_framebuffer)
+    return klass->get_default_framebuffer (self);
+
+  return 0;
+}
+
 static gboolean
 gdk_gl_context_is_realized (GdkGLContext *context)
 {
@@ -1182,6 +1268,54 @@ gdk_gl_context_is_shared (GdkGLContext *self,
   return GDK_GL_CONTEXT_GET_CLASS (self)->is_shared (self, other);
 }
 
+/**
+ * gdk_gl_context_create_shared:
+ * @self: a realized `GdkGLContext`
+ * @error: return location for an error
+ *
+ * Creates a new `GdkGLContext` that is not connected to any surface
+ * and shares textures and other GL objects with @self.
+ *
+ * The new context uses the same API, required version and flags as
+ * @self and is realized before it is returned. Unlike @self, it may
+ * be made current in a different thread, which makes it useful for
+ * uploading textures in the background. Use fence sync objects to
+ * find out when the results can be used in @self.
+ *
+ * Returns: (transfer full) (nullable): the newly created `GdkGLContext`,
+ *   or %NULL on error
+ *
+ * Since: 4.6
+ */
+GdkGLContext *
+gdk_gl_context_create_shared (GdkGLContext  *self,
+                              GError       **error)
+{
+  GdkGLContextPrivate *priv = gdk_gl_context_get_instance_private (self);
+  GdkGLContext *context;
+  int major, minor;
+
+  g_return_val_if_fail (GDK_IS_GL_CONTEXT (self), NULL);
+  g_return_val_if_fail (gdk_gl_context_is_realized (self), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  context = gdk_gl_context_new (gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self)), NULL);
+
+  gdk_gl_context_get_required_version (self, &major, &minor);
+  gdk_gl_context_set_required_version (context, major, minor);
+  gdk_gl_context_set_debug_enabled (context, gdk_gl_context_get_debug_enabled (self));
+  gdk_gl_context_set_forward_compatible (context, gdk_gl_context_get_forward_compatible (self));
+  gdk_gl_context_set_allowed_apis (context, priv->api);
+
+  if (!gdk_gl_context_realize (context, error))
+    {
+      g_object_unref (context);
+      return NULL;
+    }
+
+  return context;
+}
+
 /**
  * gdk_gl_context_set_allowed_apis: (attributes org.gtk.Method.set_property=allowed-apis)
  * @self: a GL context
@@ -71,6 +71,9 @@ gboolean                gdk_gl_context_is_legacy                (GdkGLContext  *
 GDK_AVAILABLE_IN_4_4
 gboolean                gdk_gl_context_is_shared                (GdkGLContext  *self,
                                                                  GdkGLContext  *other);
+GDK_AVAILABLE_IN_4_6
+GdkGLContext *          gdk_gl_context_create_shared            (GdkGLContext  *self,
+                                                                 GError       **error);
 
 GDK_AVAILABLE_IN_ALL
 void                    gdk_gl_context_set_required_version     (GdkGLContext  *context,
@@ -71,6 +71,8 @@ struct _GdkGLContextClass
 
   gboolean              (* is_shared)                           (GdkGLContext          *self,
                                                                  GdkGLContext          *other);
+
+  guint                 (* get_default_framebuffer)             (GdkGLContext          *self);
 };
 
 typedef struct {
@@ -117,6 +119,7 @@ gboolean                gdk_gl_context_check_version            (GdkGLContext
                                                                  int              required_gles_minor);
 
 gboolean                gdk_gl_context_has_unpack_subimage      (GdkGLContext    *context);
+guint                   gdk_gl_context_get_default_framebuffer  (GdkGLContext    *self);
 void                    gdk_gl_context_push_debug_group         (GdkGLContext    *context,
                                                                  const char      *message);
 void                    gdk_gl_context_push_debug_group_printf  (GdkGLContext    *context,
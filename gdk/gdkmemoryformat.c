@@ -25,6 +25,18 @@
 
 #include <epoxy/gl.h>
 
+#include <string.h>
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_CONVERT_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HAVE_CONVERT_NEON 1
+#endif
+#endif
+
 typedef struct _GdkMemoryFormatDescription GdkMemoryFormatDescription;
 
 #define TYPED_FUNCS(name, T, R, G, B, A, bpp, scale) \
@@ -77,10 +89,20 @@ r16g16b16_float_to_float (float        *dest,
                           const guchar *src_data,
                           gsize         n)
 {
-  guint16 *src = (guint16 *) src_data;
+  float *src = dest + n;
+
+  /* Convert the whole row at once into the end of dest, and then
+   * spread it out to 4 channels. Reads stay ahead of the writes.
+   */
+  half_to_float ((const guint16 *) src_data, src, 3 * n);
+
   for (gsize i = 0; i < n; i++)
     {
-      half_to_float (src, dest, 3);
+      float r = src[0], g = src[1], b = src[2];
+
+      dest[0] = r;
+      dest[1] = g;
+      dest[2] = b;
       dest[3] = 1.0;
       dest += 4;
       src += 3;
@@ -93,11 +115,23 @@ r16g16b16_float_from_float (guchar      *dest_data,
                             gsize        n)
 {
   guint16 *dest = (guint16 *) dest_data;
-  for (gsize i = 0; i < n; i++)
+  float chunk[3 * 64];
+
+  while (n > 0)
     {
-      float_to_half (src, dest, 3);
-      dest += 3;
-      src += 4;
+      gsize len = MIN (n, 64);
+
+      for (gsize i = 0; i < len; i++)
+        {
+          chunk[3 * i + 0] = src[0];
+          chunk[3 * i + 1] = src[1];
+          chunk[3 * i + 2] = src[2];
+          src += 4;
+        }
+
+      float_to_half (chunk, dest, 3 * len);
+      dest += 3 * len;
+      n -= len;
     }
 }
 
@@ -461,32 +495,288 @@ unpremultiply (float *rgba,
     }
 }
 
-void
-gdk_memory_convert (guchar              *dest_data,
-                    gsize                dest_stride,
-                    GdkMemoryFormat      dest_format,
-                    const guchar        *src_data,
-                    gsize                src_stride,
-                    GdkMemoryFormat      src_format,
-                    gsize                width,
-                    gsize                height)
+typedef enum {
+  ALPHA_CONVERSION_NONE,
+  ALPHA_CONVERSION_PREMULTIPLY,
+  ALPHA_CONVERSION_UNPREMULTIPLY
+} AlphaConversion;
+
+/* Byte positions of the channels in the formats with 8 bits per
+ * channel, a is -1 for opaque formats. Conversions between these
+ * formats don't need the detour through floats.
+ */
+typedef struct
+{
+  gsize bpp;
+  int r, g, b, a;
+} ByteOrder;
+
+static const ByteOrder byte_orders[GDK_MEMORY_N_FORMATS] = {
+  [GDK_MEMORY_B8G8R8A8_PREMULTIPLIED] = { 4, 2, 1, 0, 3 },
+  [GDK_MEMORY_A8R8G8B8_PREMULTIPLIED] = { 4, 1, 2, 3, 0 },
+  [GDK_MEMORY_R8G8B8A8_PREMULTIPLIED] = { 4, 0, 1, 2, 3 },
+  [GDK_MEMORY_B8G8R8A8] = { 4, 2, 1, 0, 3 },
+  [GDK_MEMORY_A8R8G8B8] = { 4, 1, 2, 3, 0 },
+  [GDK_MEMORY_R8G8B8A8] = { 4, 0, 1, 2, 3 },
+  [GDK_MEMORY_A8B8G8R8] = { 4, 3, 2, 1, 0 },
+  [GDK_MEMORY_R8G8B8] = { 3, 0, 1, 2, -1 },
+  [GDK_MEMORY_B8G8R8] = { 3, 2, 1, 0, -1 },
+};
+
+/* Rounds c * a / 255 to nearest, exactly for all 8 bit values */
+static inline guint
+mul_div_255 (guint c,
+             guint a)
+{
+  guint t = c * a + 128;
+
+  return (t + (t >> 8)) >> 8;
+}
+
+/* Indexed by [alpha][color]. The entries are computed with the float
+ * code below, so both paths give identical results.
+ */
+static guchar unpremultiply_table[256][256];
+
+static void
+ensure_unpremultiply_table (void)
+{
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      float rgba[256 * 4];
+      guchar pixels[256 * 4];
+
+      for (guint a = 0; a < 256; a++)
+        {
+          for (guint c = 0; c < 256; c++)
+            {
+              pixels[4 * c + 0] = c;
+              pixels[4 * c + 1] = c;
+              pixels[4 * c + 2] = c;
+              pixels[4 * c + 3] = a;
+            }
+
+          r8g8b8a8_premultiplied_to_float (rgba, pixels, 256);
+          unpremultiply (rgba, 256);
+          r8g8b8a8_from_float (pixels, rgba, 256);
+
+          for (guint c = 0; c < 256; c++)
+            unpremultiply_table[a][c] = pixels[4 * c];
+        }
+
+      g_once_init_leave (&initialized, 1);
+    }
+}
+
+#if defined(HAVE_CONVERT_SSE2) || defined(HAVE_CONVERT_NEON)
+/* Handles 4 pixels at a time for conversions between the formats
+ * with 4 bytes per pixel. Every pixel is loaded into a 32 bit lane
+ * and the channels are moved with shifts by their byte positions.
+ *
+ * Returns the number of pixels that were converted.
+ */
+static gsize
+convert_rgba8_simd (guchar          *dest,
+                    const ByteOrder *dest_order,
+                    const guchar    *src,
+                    const ByteOrder *src_order,
+                    gboolean         premultiply,
+                    gsize            width)
+{
+  gsize i;
+
+#ifdef HAVE_CONVERT_SSE2
+  const __m128i mask = _mm_set1_epi32 (0xff);
+  const __m128i round = _mm_set1_epi32 (128);
+  const __m128i src_r = _mm_cvtsi32_si128 (8 * src_order->r);
+  const __m128i src_g = _mm_cvtsi32_si128 (8 * src_order->g);
+  const __m128i src_b = _mm_cvtsi32_si128 (8 * src_order->b);
+  const __m128i src_a = _mm_cvtsi32_si128 (8 * src_order->a);
+  const __m128i dest_r = _mm_cvtsi32_si128 (8 * dest_order->r);
+  const __m128i dest_g = _mm_cvtsi32_si128 (8 * dest_order->g);
+  const __m128i dest_b = _mm_cvtsi32_si128 (8 * dest_order->b);
+  const __m128i dest_a = _mm_cvtsi32_si128 (8 * dest_order->a);
+
+  for (i = 0; i + 4 <= width; i += 4)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *) (src + 4 * i));
+      __m128i r = _mm_and_si128 (_mm_srl_epi32 (v, src_r), mask);
+      __m128i g = _mm_and_si128 (_mm_srl_epi32 (v, src_g), mask);
+      __m128i b = _mm_and_si128 (_mm_srl_epi32 (v, src_b), mask);
+      __m128i a = _mm_and_si128 (_mm_srl_epi32 (v, src_a), mask);
+
+      if (premultiply)
+        {
+          /* The products fit into the low 16 bits of each lane */
+          r = _mm_add_epi32 (_mm_mullo_epi16 (r, a), round);
+          g = _mm_add_epi32 (_mm_mullo_epi16 (g, a), round);
+          b = _mm_add_epi32 (_mm_mullo_epi16 (b, a), round);
+          r = _mm_srli_epi32 (_mm_add_epi32 (r, _mm_srli_epi32 (r, 8)), 8);
+          g = _mm_srli_epi32 (_mm_add_epi32 (g, _mm_srli_epi32 (g, 8)), 8);
+          b = _mm_srli_epi32 (_mm_add_epi32 (b, _mm_srli_epi32 (b, 8)), 8);
+        }
+
+      v = _mm_or_si128 (_mm_or_si128 (_mm_sll_epi32 (r, dest_r),
+                                      _mm_sll_epi32 (g, dest_g)),
+                        _mm_or_si128 (_mm_sll_epi32 (b, dest_b),
+                                      _mm_sll_epi32 (a, dest_a)));
+      _mm_storeu_si128 ((__m128i *) (dest + 4 * i), v);
+    }
+#else /* HAVE_CONVERT_NEON */
+  const uint32x4_t mask = vdupq_n_u32 (0xff);
+  const uint32x4_t round = vdupq_n_u32 (128);
+  const int32x4_t src_r = vdupq_n_s32 (-8 * src_order->r);
+  const int32x4_t src_g = vdupq_n_s32 (-8 * src_order->g);
+  const int32x4_t src_b = vdupq_n_s32 (-8 * src_order->b);
+  const int32x4_t src_a = vdupq_n_s32 (-8 * src_order->a);
+  const int32x4_t dest_r = vdupq_n_s32 (8 * dest_order->r);
+  const int32x4_t dest_g = vdupq_n_s32 (8 * dest_order->g);
+  const int32x4_t dest_b = vdupq_n_s32 (8 * dest_order->b);
+  const int32x4_t dest_a = vdupq_n_s32 (8 * dest_order->a);
+
+  for (i = 0; i + 4 <= width; i += 4)
+    {
+      uint32x4_t v = vreinterpretq_u32_u8 (vld1q_u8 (src + 4 * i));
+      uint32x4_t r = vandq_u32 (vshlq_u32 (v, src_r), mask);
+      uint32x4_t g = vandq_u32 (vshlq_u32 (v, src_g), mask);
+      uint32x4_t b = vandq_u32 (vshlq_u32 (v, src_b), mask);
+      uint32x4_t a = vandq_u32 (vshlq_u32 (v, src_a), mask);
+
+      if (premultiply)
+        {
+          r = vmlaq_u32 (round, r, a);
+          g = vmlaq_u32 (round, g, a);
+          b = vmlaq_u32 (round, b, a);
+          r = vshrq_n_u32 (vsraq_n_u32 (r, r, 8), 8);
+          g = vshrq_n_u32 (vsraq_n_u32 (g, g, 8), 8);
+          b = vshrq_n_u32 (vsraq_n_u32 (b, b, 8), 8);
+        }
+
+      v = vorrq_u32 (vorrq_u32 (vshlq_u32 (r, dest_r), vshlq_u32 (g, dest_g)),
+                     vorrq_u32 (vshlq_u32 (b, dest_b), vshlq_u32 (a, dest_a)));
+      vst1q_u8 (dest + 4 * i, vreinterpretq_u8_u32 (v));
+    }
+#endif
+
+  return i;
+}
+#endif
+
+static void
+convert_8bit (guchar          *dest,
+              const ByteOrder *dest_order,
+              const guchar    *src,
+              const ByteOrder *src_order,
+              AlphaConversion  conversion,
+              gsize            width)
+{
+  gsize i = 0;
+
+#if defined(HAVE_CONVERT_SSE2) || defined(HAVE_CONVERT_NEON)
+  if (src_order->bpp == 4 && dest_order->bpp == 4 &&
+      conversion != ALPHA_CONVERSION_UNPREMULTIPLY)
+    i = convert_rgba8_simd (dest, dest_order,
+                            src, src_order,
+                            conversion == ALPHA_CONVERSION_PREMULTIPLY,
+                            width);
+#endif
+
+  for (; i < width; i++)
+    {
+      const guchar *s = src + i * src_order->bpp;
+      guchar *d = dest + i * dest_order->bpp;
+      guint r = s[src_order->r];
+      guint g = s[src_order->g];
+      guint b = s[src_order->b];
+      guint a = src_order->a >= 0 ? s[src_order->a] : 255;
+
+      if (conversion == ALPHA_CONVERSION_PREMULTIPLY)
+        {
+          r = mul_div_255 (r, a);
+          g = mul_div_255 (g, a);
+          b = mul_div_255 (b, a);
+        }
+      else if (conversion == ALPHA_CONVERSION_UNPREMULTIPLY)
+        {
+          r = unpremultiply_table[a][r];
+          g = unpremultiply_table[a][g];
+          b = unpremultiply_table[a][b];
+        }
+
+      d[dest_order->r] = r;
+      d[dest_order->g] = g;
+      d[dest_order->b] = b;
+      if (dest_order->a >= 0)
+        d[dest_order->a] = a;
+    }
+}
+
+static void
+gdk_memory_convert_rows (guchar          *dest_data,
+                         gsize            dest_stride,
+                         GdkMemoryFormat  dest_format,
+                         const guchar    *src_data,
+                         gsize            src_stride,
+                         GdkMemoryFormat  src_format,
+                         gsize            width,
+                         gsize            height)
 {
   const GdkMemoryFormatDescription *dest_desc = &memory_formats[dest_format];
   const GdkMemoryFormatDescription *src_desc = &memory_formats[src_format];
+  AlphaConversion conversion;
   float *tmp;
   gsize y;
 
   g_assert (dest_format < GDK_MEMORY_N_FORMATS);
   g_assert (src_format < GDK_MEMORY_N_FORMATS);
 
+  if (src_desc->alpha == GDK_MEMORY_ALPHA_PREMULTIPLIED && dest_desc->alpha == GDK_MEMORY_ALPHA_STRAIGHT)
+    conversion = ALPHA_CONVERSION_UNPREMULTIPLY;
+  else if (src_desc->alpha == GDK_MEMORY_ALPHA_STRAIGHT && dest_desc->alpha != GDK_MEMORY_ALPHA_STRAIGHT)
+    conversion = ALPHA_CONVERSION_PREMULTIPLY;
+  else
+    conversion = ALPHA_CONVERSION_NONE;
+
+  if (src_format == dest_format)
+    {
+      gsize bytes = width * src_desc->bytes_per_pixel;
+
+      for (y = 0; y < height; y++)
+        {
+          memcpy (dest_data, src_data, bytes);
+          src_data += src_stride;
+          dest_data += dest_stride;
+        }
+      return;
+    }
+
+  if (byte_orders[src_format].bpp != 0 && byte_orders[dest_format].bpp != 0)
+    {
+      if (conversion == ALPHA_CONVERSION_UNPREMULTIPLY)
+        ensure_unpremultiply_table ();
+
+      for (y = 0; y < height; y++)
+        {
+          convert_8bit (dest_data, &byte_orders[dest_format],
+                        src_data, &byte_orders[src_format],
+                        conversion,
+                        width);
+          src_data += src_stride;
+          dest_data += dest_stride;
+        }
+      return;
+    }
+
   tmp = g_new (float, width * 4);
 
   for (y = 0; y < height; y++)
     {
       src_desc->to_float (tmp, src_data, width);
-      if (src_desc->alpha == GDK_MEMORY_ALPHA_PREMULTIPLIED && dest_desc->alpha == GDK_MEMORY_ALPHA_STRAIGHT)
+      if (conversion == ALPHA_CONVERSION_UNPREMULTIPLY)
         unpremultiply (tmp, width);
-      else if (src_desc->alpha == GDK_MEMORY_ALPHA_STRAIGHT && dest_desc->alpha != GDK_MEMORY_ALPHA_STRAIGHT)
+      else if (conversion == ALPHA_CONVERSION_PREMULTIPLY)
         premultiply (tmp, width);
       dest_desc->from_float (dest_data, tmp, width);
       src_data += src_stride;
@@ -495,3 +785,154 @@ gdk_memory_convert (guchar              *dest_data,
 
   g_free (tmp);
 }
+
+/* Conversions are mostly limited by memory bandwidth, so only really
+ * large images are worth splitting up.
+ */
+#define MIN_THREADED_PIXELS (1024 * 1024)
+#define MAX_CONVERT_THREADS 8
+
+typedef struct
+{
+  guchar *dest_data;
+  gsize dest_stride;
+  GdkMemoryFormat dest_format;
+  const guchar *src_data;
+  gsize src_stride;
+  GdkMemoryFormat src_format;
+  gsize width;
+
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+} ConvertTask;
+
+typedef struct
+{
+  ConvertTask *task;
+  gsize first_row;
+  gsize last_row;
+} ConvertJob;
+
+static void
+convert_job_run (ConvertJob *job)
+{
+  ConvertTask *task = job->task;
+
+  gdk_memory_convert_rows (task->dest_data + job->first_row * task->dest_stride,
+                           task->dest_stride,
+                           task->dest_format,
+                           task->src_data + job->first_row * task->src_stride,
+                           task->src_stride,
+                           task->src_format,
+                           task->width,
+                           job->last_row - job->first_row);
+}
+
+static void
+convert_job_thread (gpointer data,
+                    gpointer user_data)
+{
+  ConvertJob *job = data;
+  ConvertTask *task = job->task;
+
+  convert_job_run (job);
+
+  g_mutex_lock (&task->lock);
+  task->n_pending--;
+  if (task->n_pending == 0)
+    g_cond_signal (&task->cond);
+  g_mutex_unlock (&task->lock);
+}
+
+static guint
+get_n_convert_threads (void)
+{
+  static gsize n_threads;
+
+  if (g_once_init_enter (&n_threads))
+    g_once_init_leave (&n_threads, CLAMP (g_get_num_processors (), 1, MAX_CONVERT_THREADS));
+
+  return n_threads;
+}
+
+static GThreadPool *
+get_convert_pool (void)
+{
+  static GThreadPool *convert_pool;
+
+  if (g_once_init_enter (&convert_pool))
+    {
+      GThreadPool *pool;
+
+      pool = g_thread_pool_new (convert_job_thread,
+                                NULL,
+                                get_n_convert_threads () - 1,
+                                FALSE,
+                                NULL);
+      g_once_init_leave (&convert_pool, pool);
+    }
+
+  return convert_pool;
+}
+
+/* Large images are split into bands of rows that are converted in
+ * parallel, with the calling thread taking the first band. This is
+ * used by texture downloads, and so by PNG saving and GL uploads of
+ * textures in formats that GL can't take directly.
+ */
+void
+gdk_memory_convert (guchar              *dest_data,
+                    gsize                dest_stride,
+                    GdkMemoryFormat      dest_format,
+                    const guchar        *src_data,
+                    gsize                src_stride,
+                    GdkMemoryFormat      src_format,
+                    gsize                width,
+                    gsize                height)
+{
+  ConvertTask task = {
+    dest_data, dest_stride, dest_format,
+    src_data, src_stride, src_format,
+    width,
+  };
+  ConvertJob jobs[MAX_CONVERT_THREADS];
+  guint n_jobs, i;
+
+  if (width * height >= MIN_THREADED_PIXELS)
+    n_jobs = MIN (get_n_convert_threads (), height);
+  else
+    n_jobs = 1;
+
+  if (n_jobs <= 1)
+    {
+      gdk_memory_convert_rows (dest_data, dest_stride, dest_format,
+                               src_data, src_stride, src_format,
+                               width, height);
+      return;
+    }
+
+  for (i = 0; i < n_jobs; i++)
+    {
+      jobs[i].task = &task;
+      jobs[i].first_row = height * i / n_jobs;
+      jobs[i].last_row = height * (i + 1) / n_jobs;
+    }
+
+  g_mutex_init (&task.lock);
+  g_cond_init (&task.cond);
+  task.n_pending = n_jobs - 1;
+
+  for (i = 1; i < n_jobs; i++)
+    g_thread_pool_push (get_convert_pool (), &jobs[i], NULL);
+
+  convert_job_run (&jobs[0]);
+
+  g_mutex_lock (&task.lock);
+  while (task.n_pending > 0)
+    g_cond_wait (&task.cond, &task.lock);
+  g_mutex_unlock (&task.lock);
+
+  g_mutex_clear (&task.lock);
+  g_cond_clear (&task.cond);
+}
@@ -166,6 +166,54 @@ gdk_memory_texture_new (int              width,
   return GDK_TEXTURE (self);
 }
 
+/**
+ * gdk_memory_texture_new_with_update:
+ * @width: the width of the texture
+ * @height: the height of the texture
+ * @format: the format of the data
+ * @bytes: the `GBytes` containing the pixel data
+ * @stride: rowstride for the data
+ * @previous: the texture this one replaces
+ * @update_region: the area, in pixels, where the new texture
+ *   differs from @previous
+ *
+ * Creates a new texture like [ctor@Gdk.MemoryTexture.new] that
+ * is an update of @previous.
+ *
+ * When a paintable replaces @previous with the new texture and
+ * invalidates its contents, renderers only redraw the parts of
+ * the screen that show @update_region, instead of everywhere the
+ * texture is displayed. This makes small changes to large images,
+ * such as a blinking cursor in a canvas, much cheaper.
+ *
+ * If the size of @previous doesn't match, this is the same as
+ * [ctor@Gdk.MemoryTexture.new].
+ *
+ * Returns: (type GdkMemoryTexture): A newly-created `GdkTexture`
+ *
+ * Since: 4.6
+ */
+GdkTexture *
+gdk_memory_texture_new_with_update (int                   width,
+                                    int                   height,
+                                    GdkMemoryFormat       format,
+                                    GBytes               *bytes,
+                                    gsize                 stride,
+                                    GdkTexture           *previous,
+                                    const cairo_region_t *update_region)
+{
+  GdkTexture *texture;
+
+  g_return_val_if_fail (GDK_IS_TEXTURE (previous), NULL);
+  g_return_val_if_fail (update_region != NULL, NULL);
+
+  texture = gdk_memory_texture_new (width, height, format, bytes, stride);
+  if (texture)
+    gdk_texture_set_diff (texture, previous, update_region);
+
+  return texture;
+}
+
 GdkTexture *
 gdk_memory_texture_new_subtexture (GdkMemoryTexture  *source,
                                    int                x,
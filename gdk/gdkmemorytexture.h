@@ -68,6 +68,14 @@ GdkTexture *            gdk_memory_texture_new              (int
                                                              GdkMemoryFormat    format,
                                                              GBytes            *bytes,
                                                              gsize              stride);
+GDK_AVAILABLE_IN_4_6
+GdkTexture *            gdk_memory_texture_new_with_update  (int                   width,
+                                                             int                   height,
+                                                             GdkMemoryFormat       format,
+                                                             GBytes               *bytes,
+                                                             gsize                 stride,
+                                                             GdkTexture           *previous,
+                                                             const cairo_region_t *update_region);
 
 
 G_END_DECLS
@@ -32,7 +32,24 @@
 #include "gdkversionmacros.h"
 #include "gdkframeclockprivate.h"
 
-
+/**
+ * gdk_profiler_is_running:
+ *
+ * Returns whether the application is being profiled.
+ *
+ * GTK adds marks and counters to the capture of the
+ * [Sysprof](https://wiki.gnome.org/Apps/Sysprof) profiler, and these
+ * functions let applications add their own into the same capture, so
+ * their work can be compared with what GTK does in the same frame.
+ *
+ * Marks and counters that are added while the application is not
+ * being profiled are dropped, so it is worth checking this before
+ * doing any work to collect them.
+ *
+ * Returns: %TRUE if marks and counters are recorded
+ *
+ * Since: 4.6
+ */
 gboolean
 gdk_profiler_is_running (void)
 {
@@ -43,6 +60,43 @@ gdk_profiler_is_running (void)
 #endif
 }
 
+/**
+ * gdk_profiler_get_current_time:
+ *
+ * Returns the current time, for use as the begin time of marks.
+ *
+ * Note that the times of the profiler are in nanoseconds, while
+ * g_get_monotonic_time() and the times of `GdkFrameClock` are in
+ * microseconds, so these need to be multiplied by 1000.
+ *
+ * Returns: the current monotonic time, in nanoseconds
+ *
+ * Since: 4.6
+ */
+gint64
+gdk_profiler_get_current_time (void)
+{
+#ifdef HAVE_SYSPROF
+  return SYSPROF_CAPTURE_CURRENT_TIME;
+#else
+  return g_get_monotonic_time () * 1000;
+#endif
+}
+
+/**
+ * gdk_profiler_add_mark:
+ * @begin_time: the start of the mark, in nanoseconds
+ * @duration: the duration of the mark, in nanoseconds
+ * @name: the name of the mark
+ * @message: (nullable): a message to show with the mark
+ *
+ * Adds a mark for a span of time to the profiler capture.
+ *
+ * Marks are added to the "gtk" category, next to the ones
+ * of GTK itself.
+ *
+ * Since: 4.6
+ */
 void
 (gdk_profiler_add_mark) (gint64      begin_time,
                          gint64      duration,
@@ -54,6 +108,17 @@ void
 #endif
 }
 
+/**
+ * gdk_profiler_end_mark:
+ * @begin_time: the start of the mark, in nanoseconds
+ * @name: the name of the mark
+ * @message: (nullable): a message to show with the mark
+ *
+ * Adds a mark that lasts from @begin_time until now to the
+ * profiler capture.
+ *
+ * Since: 4.6
+ */
 void
 (gdk_profiler_end_mark) (gint64      begin_time,
                          const char *name,
@@ -64,6 +129,18 @@ void
 #endif
 }
 
+/**
+ * gdk_profiler_add_markf:
+ * @begin_time: the start of the mark, in nanoseconds
+ * @duration: the duration of the mark, in nanoseconds
+ * @name: the name of the mark
+ * @message_format: printf()-style format for the message
+ * @...: arguments for @message_format
+ *
+ * Like [func@Gdk.profiler_add_mark], with a formatted message.
+ *
+ * Since: 4.6
+ */
 void
 (gdk_profiler_add_markf) (gint64       begin_time,
                           gint64       duration,
@@ -79,6 +156,17 @@ void
 #endif  /* HAVE_SYSPROF */
 }
 
+/**
+ * gdk_profiler_end_markf:
+ * @begin_time: the start of the mark, in nanoseconds
+ * @name: the name of the mark
+ * @message_format: printf()-style format for the message
+ * @...: arguments for @message_format
+ *
+ * Like [func@Gdk.profiler_end_mark], with a formatted message.
+ *
+ * Since: 4.6
+ */
 void
 (gdk_profiler_end_markf) (gint64       begin_time,
                           const gchar *name,
@@ -93,6 +181,21 @@ void
 #endif  /* HAVE_SYSPROF */
 }
 
+/**
+ * gdk_profiler_define_counter:
+ * @name: the name of the counter
+ * @description: a description of the counter
+ *
+ * Defines a new counter of floating point values.
+ *
+ * Counters are usually set once per frame, to the value
+ * collected since the previous frame.
+ *
+ * Returns: the ID of the counter, or 0 if counters can't
+ *   be recorded
+ *
+ * Since: 4.6
+ */
 guint
 (gdk_profiler_define_counter) (const char *name,
                                const char *description)
@@ -105,7 +208,7 @@ guint
   counter.value.vdbl = 0.0;
   g_strlcpy (counter.category, "gtk", sizeof counter.category);
   g_strlcpy (counter.name, name, sizeof counter.name);
-  g_strlcpy (counter.description, description, sizeof counter.name);
+  g_strlcpy (counter.description, description, sizeof counter.description);
 
   sysprof_collector_define_counters (&counter, 1);
 
@@ -115,6 +218,18 @@ guint
 #endif
 }
 
+/**
+ * gdk_profiler_define_int_counter:
+ * @name: the name of the counter
+ * @description: a description of the counter
+ *
+ * Defines a new counter of integer values.
+ *
+ * Returns: the ID of the counter, or 0 if counters can't
+ *   be recorded
+ *
+ * Since: 4.6
+ */
 guint
 (gdk_profiler_define_int_counter) (const char *name,
                                    const char *description)
@@ -127,7 +242,7 @@ guint
   counter.value.v64 = 0;
   g_strlcpy (counter.category, "gtk", sizeof counter.category);
   g_strlcpy (counter.name, name, sizeof counter.name);
-  g_strlcpy (counter.description, description, sizeof counter.name);
+  g_strlcpy (counter.description, description, sizeof counter.description);
 
   sysprof_collector_define_counters (&counter, 1);
 
@@ -137,6 +252,15 @@ guint
 #endif
 }
 
+/**
+ * gdk_profiler_set_counter:
+ * @id: the ID of a counter from [func@Gdk.profiler_define_counter]
+ * @value: the new value
+ *
+ * Sets the value of a counter.
+ *
+ * Since: 4.6
+ */
 void
 (gdk_profiler_set_counter) (guint  id,
                             double val)
@@ -149,6 +273,15 @@ void
 #endif
 }
 
+/**
+ * gdk_profiler_set_int_counter:
+ * @id: the ID of a counter from [func@Gdk.profiler_define_int_counter]
+ * @value: the new value
+ *
+ * Sets the value of an integer counter.
+ *
+ * Since: 4.6
+ */
 void
 (gdk_profiler_set_int_counter) (guint  id,
                                 gint64 val)
@@ -0,0 +1,70 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GDK_PROFILER_H__
+#define __GDK_PROFILER_H__
+
+#if !defined (__GDK_H_INSIDE__) && !defined (GTK_COMPILATION)
+#error "Only <gdk/gdk.h> can be included directly."
+#endif
+
+#include <gdk/gdkversionmacros.h>
+
+G_BEGIN_DECLS
+
+GDK_AVAILABLE_IN_4_6
+gboolean        gdk_profiler_is_running         (void);
+GDK_AVAILABLE_IN_4_6
+gint64          gdk_profiler_get_current_time   (void);
+
+GDK_AVAILABLE_IN_4_6
+void            gdk_profiler_add_mark           (gint64      begin_time,
+                                                 gint64      duration,
+                                                 const char *name,
+                                                 const char *message);
+GDK_AVAILABLE_IN_4_6
+void            gdk_profiler_add_markf          (gint64      begin_time,
+                                                 gint64      duration,
+                                                 const char *name,
+                                                 const char *message_format,
+                                                 ...) G_GNUC_PRINTF (4, 5);
+GDK_AVAILABLE_IN_4_6
+void            gdk_profiler_end_mark           (gint64      begin_time,
+                                                 const char *name,
+                                                 const char *message);
+GDK_AVAILABLE_IN_4_6
+void            gdk_profiler_end_markf          (gint64      begin_time,
+                                                 const char *name,
+                                                 const char *message_format,
+                                                 ...) G_GNUC_PRINTF (3, 4);
+
+GDK_AVAILABLE_IN_4_6
+guint           gdk_profiler_define_counter     (const char *name,
+                                                 const char *description);
+GDK_AVAILABLE_IN_4_6
+guint           gdk_profiler_define_int_counter (const char *name,
+                                                 const char *description);
+GDK_AVAILABLE_IN_4_6
+void            gdk_profiler_set_counter        (guint       id,
+                                                 double      value);
+GDK_AVAILABLE_IN_4_6
+void            gdk_profiler_set_int_counter    (guint       id,
+                                                 gint64      value);
+
+G_END_DECLS
+
+#endif  /* __GDK_PROFILER_H__ */
@@ -20,6 +20,7 @@
 
 #include "gdk/gdkframeclock.h"
 #include "gdk/gdkdisplay.h"
+#include "gdk/gdkprofiler.h"
 
 /* Ensure we included config.h as needed for the below HAVE_SYSPROF_CAPTURE check */
 #ifndef GETTEXT_PACKAGE
@@ -40,37 +41,13 @@ G_BEGIN_DECLS
 #define GDK_PROFILER_CURRENT_TIME 0
 #endif
 
-gboolean gdk_profiler_is_running (void);
-
-/* Note: Times and durations are in nanoseconds;
+/* The functions are declared in gdkprofiler.h. Inside GTK,
+ * the calls are compiled out when building without sysprof.
+ *
+ * Note: Times and durations are in nanoseconds;
  * g_get_monotonic_time(), and GdkFrameClock times
  * are in microseconds, so multiply by 1000.
  */
-void   gdk_profiler_add_mark  (gint64       begin_time,
-                               gint64       duration,
-                               const gchar *name,
-                               const gchar *message);
-void   gdk_profiler_add_markf (gint64       begin_time,
-                               gint64       duration,
-                               const gchar *name,
-                               const gchar *message_format,
-                               ...) G_GNUC_PRINTF (4, 5);
-void   gdk_profiler_end_mark  (gint64       begin_time,
-                               const gchar *name,
-                               const gchar *message);
-void   gdk_profiler_end_markf (gint64       begin_time,
-                               const gchar *name,
-                               const gchar *message_format,
-                               ...) G_GNUC_PRINTF (3, 4);
-
-guint   gdk_profiler_define_counter     (const char *name,
-                                         const char *description);
-guint   gdk_profiler_define_int_counter (const char *name,
-                                         const char *description);
-void    gdk_profiler_set_counter        (guint  id,
-                                         double value);
-void    gdk_profiler_set_int_counter    (guint  id,
-                                         gint64 value);
 
 #ifndef HAVE_SYSPROF
 #define gdk_profiler_add_mark(b, d, n, m) G_STMT_START {} G_STMT_END
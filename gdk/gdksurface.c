@@ -36,6 +36,7 @@
 #include "gdkdragsurfaceprivate.h"
 #include "gdkeventsprivate.h"
 #include "gdkframeclockidleprivate.h"
+#include "gdkframestatisticsprivate.h"
 #include "gdkglcontextprivate.h"
 #include "gdkintl.h"
 #include "gdkmarshalers.h"
@@ -48,6 +49,10 @@
 
 #ifdef HAVE_EGL
 #include <epoxy/egl.h>
+
+#ifndef EGL_DIRECT_COMPOSITION_ANGLE
+#define EGL_DIRECT_COMPOSITION_ANGLE 0x33A5
+#endif
 #endif
 
 /**
@@ -736,6 +741,7 @@ gdk_surface_finalize (GObject *object)
   g_clear_object (&surface->display);
 
   g_clear_pointer (&surface->opaque_region, cairo_region_destroy);
+  g_clear_pointer (&surface->frame_statistics, gdk_frame_statistics_unref);
 
   if (surface->parent)
     surface->parent->children = g_list_remove (surface->parent->children, surface);
@@ -1131,11 +1137,31 @@ gdk_surface_ensure_egl_surface (GdkSurface *self,
 
   if (priv->egl_surface == NULL)
     {
+      EGLint attribs[5];
+      int i = 0;
+
+      /* With ANGLE, this gets us a flip model swapchain that is presented
+       * through DirectComposition, and partial presents with Present1() */
+      if (display->have_egl_win32_libangle)
+        {
+          if (display->have_egl_angle_direct_composition)
+            {
+              attribs[i++] = EGL_DIRECT_COMPOSITION_ANGLE;
+              attribs[i++] = EGL_TRUE;
+            }
+          if (display->have_egl_post_sub_buffer)
+            {
+              attribs[i++] = EGL_POST_SUB_BUFFER_SUPPORTED_NV;
+              attribs[i++] = EGL_TRUE;
+            }
+        }
+      attribs[i++] = EGL_NONE;
+
       priv->egl_surface = eglCreateWindowSurface (gdk_display_get_egl_display (display),
                                                   high_depth ? gdk_display_get_egl_config_high_depth (display)
                                                              : gdk_display_get_egl_config (display),
                                                   (EGLNativeWindowType) priv->egl_native_window,
-                                                  NULL);
+                                                  attribs);
       priv->egl_surface_high_depth = high_depth;
     }
 #endif
@@ -1440,6 +1466,16 @@ gdk_surface_paint_on_clock (GdkFrameClock *clock,
   g_object_unref (surface);
 }
 
+static void
+gdk_surface_after_paint_on_clock (GdkFrameClock *clock,
+                                  void          *data)
+{
+  GdkSurface *surface = GDK_SURFACE (data);
+
+  if (surface->frame_statistics)
+    gdk_frame_statistics_after_paint (surface->frame_statistics, clock);
+}
+
 /*
  * gdk_surface_invalidate_rect:
  * @surface: a `GdkSurface`
@@ -2336,6 +2372,8 @@ _gdk_windowing_got_event (GdkDisplay *display,
    */
   _gdk_event_queue_handle_motion_compression (display);
   gdk_event_queue_handle_scroll_compression (display);
+  gdk_event_queue_handle_touch_compression (display);
+  gdk_event_queue_handle_touchpad_compression (display);
 
   if (event_surface)
     {
@@ -2545,6 +2583,11 @@ gdk_surface_set_frame_clock (GdkSurface     *surface,
                         "paint",
                         G_CALLBACK (gdk_surface_paint_on_clock),
                         surface);
+      if (surface->frame_statistics)
+        g_signal_connect (G_OBJECT (clock),
+                          "after-paint",
+                          G_CALLBACK (gdk_surface_after_paint_on_clock),
+                          surface);
 
       if (surface->update_freeze_count == 0)
         _gdk_frame_clock_inhibit_freeze (clock);
@@ -2567,6 +2610,9 @@ gdk_surface_set_frame_clock (GdkSurface     *surface,
       g_signal_handlers_disconnect_by_func (G_OBJECT (surface->frame_clock),
                                             G_CALLBACK (gdk_surface_paint_on_clock),
                                             surface);
+      g_signal_handlers_disconnect_by_func (G_OBJECT (surface->frame_clock),
+                                            G_CALLBACK (gdk_surface_after_paint_on_clock),
+                                            surface);
 
       if (surface->update_freeze_count == 0)
         _gdk_frame_clock_uninhibit_freeze (surface->frame_clock);
@@ -2596,6 +2642,98 @@ gdk_surface_get_frame_clock (GdkSurface *surface)
   return surface->frame_clock;
 }
 
+/**
+ * gdk_surface_get_frame_statistics:
+ * @surface: a `GdkSurface`
+ *
+ * Gets the statistics about the frames presented for @surface.
+ *
+ * Statistics are only collected once this function has been called
+ * for the first time, so the returned object starts out empty. It
+ * keeps collecting for as long as the surface exists.
+ *
+ * Returns: (transfer none): the frame statistics
+ *
+ * Since: 4.6
+ */
+GdkFrameStatistics *
+gdk_surface_get_frame_statistics (GdkSurface *surface)
+{
+  g_return_val_if_fail (GDK_IS_SURFACE (surface), NULL);
+
+  if (surface->frame_statistics == NULL)
+    {
+      surface->frame_statistics = gdk_frame_statistics_new ();
+
+      if (surface->frame_clock)
+        g_signal_connect (G_OBJECT (surface->frame_clock),
+                          "after-paint",
+                          G_CALLBACK (gdk_surface_after_paint_on_clock),
+                          surface);
+    }
+
+  return surface->frame_statistics;
+}
+
+/**
+ * gdk_surface_set_low_latency:
+ * @surface: a `GdkSurface`
+ * @low_latency: whether to schedule frames for low latency
+ *
+ * Sets whether the frame clock of @surface should start each frame
+ * as late as possible.
+ *
+ * Normally, a frame is started as soon as the previous one has been
+ * presented, so input that arrives later has to wait for the frame
+ * after that. In low-latency mode, GDK estimates how long frames take
+ * and delays the start of each frame until just before it is needed
+ * to make the next vblank. Frames that are requested while handling
+ * input, such as a redraw after a motion event, are started right
+ * after the events have been processed instead, as long as the
+ * previous frame has been presented.
+ *
+ * This is meant for applications like drawing programs that need to
+ * respond to input as quickly as possible. If frame times vary a lot,
+ * it can cause missed frames.
+ *
+ * The setting affects all surfaces sharing the frame clock of @surface.
+ *
+ * Since: 4.6
+ */
+void
+gdk_surface_set_low_latency (GdkSurface *surface,
+                             gboolean    low_latency)
+{
+  g_return_if_fail (GDK_IS_SURFACE (surface));
+
+  if (GDK_IS_FRAME_CLOCK_IDLE (surface->frame_clock))
+    gdk_frame_clock_idle_set_low_latency (GDK_FRAME_CLOCK_IDLE (surface->frame_clock), low_latency);
+}
+
+/**
+ * gdk_surface_get_low_latency:
+ * @surface: a `GdkSurface`
+ *
+ * Returns whether the frame clock of @surface schedules frames for
+ * low latency.
+ *
+ * See [method@Gdk.Surface.set_low_latency].
+ *
+ * Returns: %TRUE if low latency scheduling is used
+ *
+ * Since: 4.6
+ */
+gboolean
+gdk_surface_get_low_latency (GdkSurface *surface)
+{
+  g_return_val_if_fail (GDK_IS_SURFACE (surface), FALSE);
+
+  if (GDK_IS_FRAME_CLOCK_IDLE (surface->frame_clock))
+    return gdk_frame_clock_idle_get_low_latency (GDK_FRAME_CLOCK_IDLE (surface->frame_clock));
+
+  return FALSE;
+}
+
 /**
  * gdk_surface_get_scale_factor: (attributes org.gtk.Method.get_property=scale-factor)
  * @surface: surface to get scale factor for
@@ -2631,6 +2769,57 @@ gdk_surface_get_scale_factor (GdkSurface *surface)
   return 1;
 }
 
+/*<private>
+ * gdk_surface_get_scale:
+ * @surface: surface to get the scale for
+ *
+ * Returns the scale that maps from surface coordinates to the
+ * pixels of the buffers that are presented for @surface.
+ *
+ * Unlike gdk_surface_get_scale_factor(), this can be fractional if
+ * the windowing system supports it. The scale factor is then the
+ * scale rounded up.
+ *
+ * Returns: the scale
+ */
+double
+gdk_surface_get_scale (GdkSurface *surface)
+{
+  GdkSurfaceClass *class;
+
+  g_return_val_if_fail (GDK_IS_SURFACE (surface), 1.0);
+
+  if (GDK_SURFACE_DESTROYED (surface))
+    return 1.0;
+
+  class = GDK_SURFACE_GET_CLASS (surface);
+  if (class->get_scale)
+    return class->get_scale (surface);
+
+  return gdk_surface_get_scale_factor (surface);
+}
+
+/*<private>
+ * gdk_surface_get_buffer_size:
+ * @surface: a `GdkSurface`
+ * @width: (out): return location for the width in pixels
+ * @height: (out): return location for the height in pixels
+ *
+ * Gets the size of the buffers to render @surface into, using
+ * the scale from gdk_surface_get_scale().
+ */
+void
+gdk_surface_get_buffer_size (GdkSurface *surface,
+                             int        *width,
+                             int        *height)
+{
+  double scale = gdk_surface_get_scale (surface);
+
+  /* Round like wp_fractional_scale_v1 asks us to */
+  *width = MAX (1, (int) round (surface->width * scale));
+  *height = MAX (1, (int) round (surface->height * scale));
+}
+
 /**
  * gdk_surface_set_opaque_region:
  * @surface: a top-level `GdkSurface`
@@ -2958,6 +3147,29 @@ gdk_surface_handle_event (GdkEvent *event)
   if (gdk_event_get_event_type (event) == GDK_MOTION_NOTIFY)
     surface->request_motion = FALSE;
 
+  if (surface->frame_statistics)
+    {
+      switch ((guint) gdk_event_get_event_type (event))
+        {
+        case GDK_MOTION_NOTIFY:
+        case GDK_BUTTON_PRESS:
+        case GDK_BUTTON_RELEASE:
+        case GDK_KEY_PRESS:
+        case GDK_KEY_RELEASE:
+        case GDK_SCROLL:
+        case GDK_TOUCH_BEGIN:
+        case GDK_TOUCH_UPDATE:
+        case GDK_TOUCH_END:
+        case GDK_TOUCHPAD_SWIPE:
+        case GDK_TOUCHPAD_PINCH:
+        case GDK_TOUCHPAD_HOLD:
+          gdk_frame_statistics_add_input (surface->frame_statistics, g_get_monotonic_time ());
+          break;
+        default:
+          break;
+        }
+    }
+
   g_signal_emit (surface, signals[EVENT], 0, event, &handled);
 
   if (GDK_PROFILER_IS_RUNNING)
@@ -33,6 +33,7 @@
 #include <gdk/gdktypes.h>
 #include <gdk/gdkevents.h>
 #include <gdk/gdkframeclock.h>
+#include <gdk/gdkframestatistics.h>
 #include <gdk/gdkmonitor.h>
 #include <gdk/gdkpopuplayout.h>
 
@@ -123,6 +124,14 @@ void       gdk_surface_request_layout     (GdkSurface       *surface);
 
 GDK_AVAILABLE_IN_ALL
 GdkFrameClock* gdk_surface_get_frame_clock      (GdkSurface     *surface);
+GDK_AVAILABLE_IN_4_6
+void           gdk_surface_set_low_latency      (GdkSurface     *surface,
+                                                 gboolean        low_latency);
+GDK_AVAILABLE_IN_4_6
+gboolean       gdk_surface_get_low_latency      (GdkSurface     *surface);
+
+GDK_AVAILABLE_IN_4_6
+GdkFrameStatistics *gdk_surface_get_frame_statistics (GdkSurface *surface);
 
 GDK_AVAILABLE_IN_ALL
 void       gdk_surface_set_opaque_region        (GdkSurface      *surface,
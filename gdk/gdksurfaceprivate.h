@@ -97,6 +97,7 @@ struct _GdkSurface
   GList *devices_inside;
 
   GdkFrameClock *frame_clock; /* NULL to use from parent or default */
+  GdkFrameStatistics *frame_statistics; /* NULL until requested */
 
   GSList *draw_contexts;
   GdkDrawContext *paint_context;
@@ -155,6 +156,7 @@ struct _GdkSurfaceClass
                                          double              dy);
 
   int          (* get_scale_factor)       (GdkSurface      *surface);
+  double       (* get_scale)              (GdkSurface      *surface);
 
   void         (* set_opaque_region)      (GdkSurface      *surface,
                                            cairo_region_t *region);
@@ -292,6 +294,11 @@ void gdk_surface_get_geometry (GdkSurface *surface,
                                int        *width,
                                int        *height);
 
+double                  gdk_surface_get_scale                   (GdkSurface             *self);
+void                    gdk_surface_get_buffer_size             (GdkSurface             *self,
+                                                                 int                    *width,
+                                                                 int                    *height);
+
 void                    gdk_surface_set_egl_native_window       (GdkSurface             *self,
                                                                  gpointer                native_window);
 void                    gdk_surface_ensure_egl_surface          (GdkSurface             *self,
@@ -48,6 +48,7 @@
 #include "loaders/gdkpngprivate.h"
 #include "loaders/gdktiffprivate.h"
 #include "loaders/gdkjpegprivate.h"
+#include "loaders/gdkrawprivate.h"
 
 G_DEFINE_QUARK (gdk-texture-error-quark, gdk_texture_error)
 
@@ -284,6 +285,9 @@ gdk_texture_dispose (GObject *object)
 
   gdk_texture_clear_render_data (self);
 
+  g_weak_ref_set (&self->diff_to, NULL);
+  g_clear_pointer (&self->diff, cairo_region_destroy);
+
   G_OBJECT_CLASS (gdk_texture_parent_class)->dispose (object);
 }
 
@@ -469,6 +473,12 @@ gdk_texture_new_from_resource (const char *resource_path)
  * The file format is detected automatically. The supported formats
  * are PNG and JPEG, though more formats might be available.
  *
+ * Files written by `gtk4-texture-tool` hold the pixels in their
+ * in-memory format. When they are local, they are mapped into memory
+ * and the texture uses the mapping directly, without decoding or
+ * copying the data. Such a file must not be truncated or modified in
+ * place while the texture exists.
+ *
  * If %NULL is returned, then @error will be set.
  *
  * This function is threadsafe, so that you can e.g. use GTask
@@ -487,7 +497,7 @@ gdk_texture_new_from_file (GFile   *file,
   g_return_val_if_fail (G_IS_FILE (file), NULL);
   g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-  bytes = g_file_load_bytes (file, NULL, NULL, error);
+  bytes = gdk_texture_load_file_bytes (file, error);
   if (bytes == NULL)
     return NULL;
 
@@ -498,12 +508,63 @@ gdk_texture_new_from_file (GFile   *file,
   return texture;
 }
 
+/*<private>
+ * gdk_texture_load_file_bytes:
+ * @file: the `GFile` to load
+ * @error: Return location for an error
+ *
+ * Loads the contents of @file for decoding.
+ *
+ * Local raw texture files are mapped, so that the texture can use
+ * the data in place and the page cache is shared with other processes.
+ * Such a file must not be truncated or rewritten in place while the
+ * texture is alive. Truncating it makes accessing the pixels crash
+ * with SIGBUS, and rewriting it changes the pixels of the texture.
+ * Replace it with a new file instead, like installing does.
+ *
+ * All other files are read into memory, so that they can safely be
+ * modified while they are being decoded.
+ *
+ * Returns: (transfer full): the contents of @file
+ */
+GBytes *
+gdk_texture_load_file_bytes (GFile   *file,
+                             GError **error)
+{
+  const char *path;
+
+  path = g_file_peek_path (file);
+  if (path)
+    {
+      GMappedFile *mapped;
+
+      mapped = g_mapped_file_new (path, FALSE, NULL);
+      if (mapped)
+        {
+          GBytes *bytes = g_mapped_file_get_bytes (mapped);
+
+          g_mapped_file_unref (mapped);
+
+          /* Only the header has been touched so far */
+          if (gdk_is_raw (bytes))
+            return bytes;
+
+          g_bytes_unref (bytes);
+        }
+
+      /* Empty files can't be mapped, let GIO handle those and the errors */
+    }
+
+  return g_file_load_bytes (file, NULL, NULL, error);
+}
+
 gboolean
 gdk_texture_can_load (GBytes *bytes)
 {
   return gdk_is_png (bytes) ||
          gdk_is_jpeg (bytes) ||
-         gdk_is_tiff (bytes);
+         gdk_is_tiff (bytes) ||
+         gdk_is_raw (bytes);
 }
 
 static GdkTexture *
@@ -522,6 +583,10 @@ gdk_texture_new_from_bytes_internal (GBytes  *bytes,
     {
       return gdk_load_tiff (bytes, error);
     }
+  else if (gdk_is_raw (bytes))
+    {
+      return gdk_load_raw (bytes, error);
+    }
   else
     {
       g_set_error_literal (error,
@@ -598,6 +663,55 @@ gdk_texture_new_from_bytes (GBytes  *bytes,
   return gdk_texture_new_from_bytes_pixbuf (bytes, error);
 }
 
+/*<private>
+ * gdk_texture_new_from_bytes_at_size:
+ * @bytes: a `GBytes` containing the data to load
+ * @width: the width the image will be shown at, or -1
+ * @height: the height the image will be shown at, or -1
+ * @out_downscale: (out): return location for the factor that
+ *   the image was scaled down by
+ * @error: Return location for an error
+ *
+ * Like gdk_texture_new_from_bytes(), but allows the loader to
+ * decode a smaller image if it is only going to be shown at
+ * @width x @height pixels. The result will still be at least
+ * that large.
+ *
+ * Currently, only JPEG images are decoded at reduced size.
+ */
+GdkTexture *
+gdk_texture_new_from_bytes_at_size (GBytes  *bytes,
+                                    int      width,
+                                    int      height,
+                                    int     *out_downscale,
+                                    GError **error)
+{
+  GdkTexture *texture;
+  GError *internal_error = NULL;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  *out_downscale = 1;
+
+  if (!gdk_is_jpeg (bytes))
+    return gdk_texture_new_from_bytes (bytes, error);
+
+  texture = gdk_load_jpeg_at_size (bytes, width, height, out_downscale, &internal_error);
+  if (texture)
+    return texture;
+
+  if (!g_error_matches (internal_error, GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT))
+    {
+      g_propagate_error (error, internal_error);
+      return NULL;
+    }
+
+  g_clear_error (&internal_error);
+
+  return gdk_texture_new_from_bytes_pixbuf (bytes, error);
+}
+
 /**
  * gdk_texture_new_from_filename:
  * @path: (type filename): the filename to load
@@ -787,6 +901,83 @@ gdk_texture_get_render_data (GdkTexture  *self,
   return self->render_data;
 }
 
+/*<private>
+ * gdk_texture_set_diff:
+ * @self: a newly created texture
+ * @previous: the texture @self is an update of
+ * @diff: the area, in pixels, where @self differs from @previous
+ *
+ * Records that @self only differs from @previous in @diff, so that
+ * renderers can limit their damage when one replaces the other.
+ *
+ * A texture is immutable once it has been handed out, so this must
+ * be called right after creating it.
+ */
+void
+gdk_texture_set_diff (GdkTexture           *self,
+                      GdkTexture           *previous,
+                      const cairo_region_t *diff)
+{
+  g_assert (self->diff == NULL);
+
+  if (self->width != previous->width ||
+      self->height != previous->height)
+    return;
+
+  g_weak_ref_set (&self->diff_to, previous);
+  self->diff = cairo_region_copy (diff);
+}
+
+/*<private>
+ * gdk_texture_diff:
+ * @self: a texture
+ * @other: another texture
+ * @region: the region to add the difference to
+ *
+ * If one of the textures is known to be an update of the other,
+ * adds the area where they differ to @region.
+ *
+ * Returns: %FALSE if the difference is unknown and the whole
+ *   texture must be assumed to differ
+ */
+gboolean
+gdk_texture_diff (GdkTexture     *self,
+                  GdkTexture     *other,
+                  cairo_region_t *region)
+{
+  GdkTexture *diff_to;
+
+  if (self->width != other->width ||
+      self->height != other->height)
+    return FALSE;
+
+  if (other->diff)
+    {
+      diff_to = g_weak_ref_get (&other->diff_to);
+      if (diff_to)
+        g_object_unref (diff_to);
+      if (diff_to == self)
+        {
+          cairo_region_union (region, other->diff);
+          return TRUE;
+        }
+    }
+
+  if (self->diff)
+    {
+      diff_to = g_weak_ref_get (&self->diff_to);
+      if (diff_to)
+        g_object_unref (diff_to);
+      if (diff_to == other)
+        {
+          cairo_region_union (region, self->diff);
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
 /**
  * gdk_texture_save_to_png:
  * @texture: a `GdkTexture`
@@ -0,0 +1,532 @@
+/* gdktextureloader.c
+ *
+ * Copyright 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdktextureloader.h"
+
+#include "gdkintl.h"
+#include "gdkpaintable.h"
+#include "gdksnapshot.h"
+#include "gdktextureprivate.h"
+#include "loaders/gdkpngprivate.h"
+
+#include <string.h>
+
+/* HACK: So we don't need to include any (not-yet-created) GSK or GTK headers */
+void
+gtk_snapshot_append_texture (GdkSnapshot            *snapshot,
+                             GdkTexture             *texture,
+                             const graphene_rect_t  *bounds);
+
+/**
+ * GdkTextureLoader:
+ *
+ * `GdkTextureLoader` loads an image from a `GInputStream` in a
+ * thread and shows it while it arrives.
+ *
+ * It is a [iface@Gdk.Paintable] that draws the part of the image
+ * that has been decoded so far, and emits
+ * [signal@Gdk.Paintable::invalidate-contents] as more of it becomes
+ * available. This is useful for large images from slow sources, such
+ * as the network.
+ *
+ * Only PNG images are decoded progressively. Other formats are shown
+ * once they are completely loaded.
+ *
+ * Since: 4.6
+ */
+
+/* Creating a partial texture copies the image, so don't do it for
+ * every few rows.
+ */
+#define UPDATE_INTERVAL (50 * G_TIME_SPAN_MILLISECOND)
+#define CHUNK_SIZE 65536
+
+typedef struct
+{
+  GMutex lock;
+  GWeakRef loader;
+
+  GdkPngLoader *png;
+  GByteArray *other;
+  guint64 shown_serial;
+  gint64 last_update;
+  gboolean update_pending;
+
+  GdkTexture *texture;
+  GError *error;
+  gboolean done;
+} LoadState;
+
+struct _GdkTextureLoader
+{
+  GObject parent_instance;
+
+  GCancellable *cancellable;
+  LoadState *state;
+
+  GdkTexture *texture;
+  GError *error;
+  gboolean loaded;
+};
+
+enum {
+  PROP_0,
+  PROP_TEXTURE,
+  PROP_LOADED,
+
+  N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS] = { NULL, };
+
+static void
+load_state_clear (gpointer data)
+{
+  LoadState *state = data;
+
+  g_mutex_clear (&state->lock);
+  g_weak_ref_clear (&state->loader);
+  g_clear_pointer (&state->png, gdk_png_loader_free);
+  g_clear_pointer (&state->other, g_byte_array_unref);
+  g_clear_object (&state->texture);
+  g_clear_error (&state->error);
+}
+
+static void
+load_state_unref (gpointer data)
+{
+  g_atomic_rc_box_release_full (data, load_state_clear);
+}
+
+static void
+gdk_texture_loader_paintable_snapshot (GdkPaintable *paintable,
+                                       GdkSnapshot  *snapshot,
+                                       double        width,
+                                       double        height)
+{
+  GdkTextureLoader *self = GDK_TEXTURE_LOADER (paintable);
+
+  if (self->texture)
+    gtk_snapshot_append_texture (snapshot,
+                                 self->texture,
+                                 &GRAPHENE_RECT_INIT (0, 0, width, height));
+}
+
+static GdkPaintableFlags
+gdk_texture_loader_paintable_get_flags (GdkPaintable *paintable)
+{
+  GdkTextureLoader *self = GDK_TEXTURE_LOADER (paintable);
+
+  if (self->loaded)
+    return GDK_PAINTABLE_STATIC_SIZE | GDK_PAINTABLE_STATIC_CONTENTS;
+
+  return 0;
+}
+
+static int
+gdk_texture_loader_paintable_get_intrinsic_width (GdkPaintable *paintable)
+{
+  GdkTextureLoader *self = GDK_TEXTURE_LOADER (paintable);
+
+  return self->texture ? gdk_texture_get_width (self->texture) : 0;
+}
+
+static int
+gdk_texture_loader_paintable_get_intrinsic_height (GdkPaintable *paintable)
+{
+  GdkTextureLoader *self = GDK_TEXTURE_LOADER (paintable);
+
+  return self->texture ? gdk_texture_get_height (self->texture) : 0;
+}
+
+static void
+gdk_texture_loader_paintable_init (GdkPaintableInterface *iface)
+{
+  iface->snapshot = gdk_texture_loader_paintable_snapshot;
+  iface->get_flags = gdk_texture_loader_paintable_get_flags;
+  iface->get_intrinsic_width = gdk_texture_loader_paintable_get_intrinsic_width;
+  iface->get_intrinsic_height = gdk_texture_loader_paintable_get_intrinsic_height;
+}
+
+G_DEFINE_TYPE_EXTENDED (GdkTextureLoader, gdk_texture_loader, G_TYPE_OBJECT, 0,
+                        G_IMPLEMENT_INTERFACE (GDK_TYPE_PAINTABLE,
+                                               gdk_texture_loader_paintable_init))
+
+static void
+gdk_texture_loader_dispose (GObject *object)
+{
+  GdkTextureLoader *self = GDK_TEXTURE_LOADER (object);
+
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+  g_clear_pointer (&self->state, load_state_unref);
+  g_clear_object (&self->texture);
+  g_clear_error (&self->error);
+
+  G_OBJECT_CLASS (gdk_texture_loader_parent_class)->dispose (object);
+}
+
+static void
+gdk_texture_loader_get_property (GObject    *object,
+                                 guint       property_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+  GdkTextureLoader *self = GDK_TEXTURE_LOADER (object);
+
+  switch (property_id)
+    {
+    case PROP_TEXTURE:
+      g_value_set_object (value, self->texture);
+      break;
+
+    case PROP_LOADED:
+      g_value_set_boolean (value, self->loaded);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+    }
+}
+
+static void
+gdk_texture_loader_class_init (GdkTextureLoaderClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->dispose = gdk_texture_loader_dispose;
+  gobject_class->get_property = gdk_texture_loader_get_property;
+
+  /**
+   * GdkTextureLoader:texture: (attributes org.gtk.Property.get=gdk_texture_loader_get_texture)
+   *
+   * The part of the image that has been loaded so far.
+   *
+   * Since: 4.6
+   */
+  properties[PROP_TEXTURE] =
+    g_param_spec_object ("texture",
+                         P_("Texture"),
+                         P_("The part of the image that has been loaded"),
+                         GDK_TYPE_TEXTURE,
+                         G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  /**
+   * GdkTextureLoader:loaded: (attributes org.gtk.Property.get=gdk_texture_loader_is_loaded)
+   *
+   * Whether loading has finished, either successfully or with an error.
+   *
+   * Since: 4.6
+   */
+  properties[PROP_LOADED] =
+    g_param_spec_boolean ("loaded",
+                          P_("Loaded"),
+                          P_("Whether loading has finished"),
+                          FALSE,
+                          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (gobject_class, N_PROPS, properties);
+}
+
+static void
+gdk_texture_loader_init (GdkTextureLoader *self)
+{
+  self->cancellable = g_cancellable_new ();
+}
+
+/* Runs in the main thread and hands whatever the worker has decoded
+ * to the loader.
+ */
+static gboolean
+gdk_texture_loader_update (gpointer data)
+{
+  LoadState *state = data;
+  GdkTextureLoader *self;
+  GdkTexture *texture = NULL;
+  GError *error = NULL;
+  gboolean done;
+
+  g_mutex_lock (&state->lock);
+
+  state->update_pending = FALSE;
+  state->last_update = g_get_monotonic_time ();
+  done = state->done;
+
+  if (state->texture)
+    texture = g_object_ref (state->texture);
+  else if (state->png && gdk_png_loader_get_serial (state->png) != state->shown_serial)
+    {
+      state->shown_serial = gdk_png_loader_get_serial (state->png);
+      texture = gdk_png_loader_get_texture (state->png);
+    }
+
+  if (state->error)
+    error = g_error_copy (state->error);
+
+  g_mutex_unlock (&state->lock);
+
+  self = g_weak_ref_get (&state->loader);
+  if (self == NULL || self->loaded)
+    goto out;
+
+  if (texture && texture != self->texture)
+    {
+      gboolean size_changed = self->texture == NULL;
+
+      g_set_object (&self->texture, texture);
+
+      if (size_changed)
+        gdk_paintable_invalidate_size (GDK_PAINTABLE (self));
+      gdk_paintable_invalidate_contents (GDK_PAINTABLE (self));
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TEXTURE]);
+    }
+
+  if (done)
+    {
+      self->error = g_steal_pointer (&error);
+      self->loaded = TRUE;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADED]);
+    }
+
+out:
+  g_clear_object (&self);
+  g_clear_object (&texture);
+  g_clear_error (&error);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Must be called with the lock held */
+static void
+load_state_queue_update (LoadState *state,
+                         gboolean   force)
+{
+  if (state->update_pending)
+    return;
+
+  if (!force && g_get_monotonic_time () - state->last_update < UPDATE_INTERVAL)
+    return;
+
+  state->update_pending = TRUE;
+  g_idle_add_full (G_PRIORITY_DEFAULT,
+                   gdk_texture_loader_update,
+                   g_atomic_rc_box_acquire (state),
+                   load_state_unref);
+}
+
+static void
+gdk_texture_loader_thread (GTask        *task,
+                           gpointer      source_object,
+                           gpointer      task_data,
+                           GCancellable *cancellable)
+{
+  GInputStream *stream = source_object;
+  LoadState *state = task_data;
+  guchar *buffer;
+  GError *error = NULL;
+
+  buffer = g_malloc (CHUNK_SIZE);
+
+  while (TRUE)
+    {
+      gssize size;
+
+      size = g_input_stream_read (stream, buffer, CHUNK_SIZE, cancellable, &error);
+      if (size <= 0)
+        break;
+
+      g_mutex_lock (&state->lock);
+
+      if (state->png == NULL && state->other == NULL)
+        {
+          if ((gsize) size >= strlen (PNG_SIGNATURE) &&
+              memcmp (buffer, PNG_SIGNATURE, strlen (PNG_SIGNATURE)) == 0)
+            state->png = gdk_png_loader_new ();
+          else
+            state->other = g_byte_array_new ();
+        }
+
+      if (state->png)
+        {
+          if (!gdk_png_loader_feed (state->png, buffer, size, &error))
+            {
+              g_mutex_unlock (&state->lock);
+              break;
+            }
+
+          if (gdk_png_loader_get_serial (state->png) != state->shown_serial)
+            load_state_queue_update (state, FALSE);
+        }
+      else
+        g_byte_array_append (state->other, buffer, size);
+
+      g_mutex_unlock (&state->lock);
+    }
+
+  g_free (buffer);
+
+  g_mutex_lock (&state->lock);
+
+  if (error == NULL)
+    {
+      if (state->png)
+        {
+          if (gdk_png_loader_is_done (state->png))
+            state->texture = gdk_png_loader_get_texture (state->png);
+          else
+            g_set_error_literal (&error,
+                                 GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                                 _("Premature end of image data"));
+        }
+      else if (state->other)
+        {
+          GBytes *bytes = g_byte_array_free_to_bytes (g_steal_pointer (&state->other));
+
+          state->texture = gdk_texture_new_from_bytes (bytes, &error);
+          g_bytes_unref (bytes);
+        }
+      else
+        g_set_error_literal (&error,
+                             GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                             _("The stream is empty"));
+    }
+
+  state->error = error;
+  state->done = TRUE;
+  load_state_queue_update (state, TRUE);
+
+  g_mutex_unlock (&state->lock);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * gdk_texture_loader_new:
+ * @stream: the `GInputStream` to read the image from
+ *
+ * Creates a new `GdkTextureLoader` and starts loading the image
+ * from @stream in a thread.
+ *
+ * The stream is read until its end, but it isn't closed.
+ *
+ * Returns: (transfer full): a new `GdkTextureLoader`
+ *
+ * Since: 4.6
+ */
+GdkTextureLoader *
+gdk_texture_loader_new (GInputStream *stream)
+{
+  GdkTextureLoader *self;
+  LoadState *state;
+  GTask *task;
+
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
+
+  self = g_object_new (GDK_TYPE_TEXTURE_LOADER, NULL);
+
+  state = g_atomic_rc_box_new0 (LoadState);
+  g_mutex_init (&state->lock);
+  g_weak_ref_init (&state->loader, self);
+  self->state = state;
+
+  task = g_task_new (stream, self->cancellable, NULL, NULL);
+  g_task_set_source_tag (task, gdk_texture_loader_new);
+  g_task_set_task_data (task, g_atomic_rc_box_acquire (state), load_state_unref);
+  g_task_run_in_thread (task, gdk_texture_loader_thread);
+  g_object_unref (task);
+
+  return self;
+}
+
+/**
+ * gdk_texture_loader_get_texture: (attributes org.gtk.Method.get_property=texture)
+ * @self: a `GdkTextureLoader`
+ *
+ * Gets the part of the image that has been loaded so far.
+ *
+ * While loading is in progress, the returned texture is replaced
+ * by a new one whenever more of the image is available.
+ *
+ * Returns: (transfer none) (nullable): the current texture
+ *
+ * Since: 4.6
+ */
+GdkTexture *
+gdk_texture_loader_get_texture (GdkTextureLoader *self)
+{
+  g_return_val_if_fail (GDK_IS_TEXTURE_LOADER (self), NULL);
+
+  return self->texture;
+}
+
+/**
+ * gdk_texture_loader_is_loaded: (attributes org.gtk.Method.get_property=loaded)
+ * @self: a `GdkTextureLoader`
+ *
+ * Returns whether loading has finished, either successfully
+ * or with an error.
+ *
+ * Returns: %TRUE if loading has finished
+ *
+ * Since: 4.6
+ */
+gboolean
+gdk_texture_loader_is_loaded (GdkTextureLoader *self)
+{
+  g_return_val_if_fail (GDK_IS_TEXTURE_LOADER (self), FALSE);
+
+  return self->loaded;
+}
+
+/**
+ * gdk_texture_loader_get_error:
+ * @self: a `GdkTextureLoader`
+ *
+ * Gets the error that happened while loading, if any.
+ *
+ * Returns: (nullable): the error
+ *
+ * Since: 4.6
+ */
+const GError *
+gdk_texture_loader_get_error (GdkTextureLoader *self)
+{
+  g_return_val_if_fail (GDK_IS_TEXTURE_LOADER (self), NULL);
+
+  return self->error;
+}
+
+/**
+ * gdk_texture_loader_cancel:
+ * @self: a `GdkTextureLoader`
+ *
+ * Stops loading. The loader will finish with an error of
+ * %G_IO_ERROR_CANCELLED, unless loading was already done.
+ *
+ * Since: 4.6
+ */
+void
+gdk_texture_loader_cancel (GdkTextureLoader *self)
+{
+  g_return_if_fail (GDK_IS_TEXTURE_LOADER (self));
+
+  g_cancellable_cancel (self->cancellable);
+}
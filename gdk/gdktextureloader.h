@@ -0,0 +1,50 @@
+/* gdktextureloader.h
+ *
+ * Copyright 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GDK_TEXTURE_LOADER_H__
+#define __GDK_TEXTURE_LOADER_H__
+
+#if !defined (__GDK_H_INSIDE__) && !defined (GTK_COMPILATION)
+#error "Only <gdk/gdk.h> can be included directly."
+#endif
+
+#include <gdk/gdktexture.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GDK_TYPE_TEXTURE_LOADER (gdk_texture_loader_get_type ())
+
+GDK_AVAILABLE_IN_4_6
+G_DECLARE_FINAL_TYPE (GdkTextureLoader, gdk_texture_loader, GDK, TEXTURE_LOADER, GObject)
+
+GDK_AVAILABLE_IN_4_6
+GdkTextureLoader *      gdk_texture_loader_new                  (GInputStream           *stream);
+
+GDK_AVAILABLE_IN_4_6
+GdkTexture *            gdk_texture_loader_get_texture          (GdkTextureLoader       *self);
+GDK_AVAILABLE_IN_4_6
+gboolean                gdk_texture_loader_is_loaded            (GdkTextureLoader       *self);
+GDK_AVAILABLE_IN_4_6
+const GError *          gdk_texture_loader_get_error            (GdkTextureLoader       *self);
+GDK_AVAILABLE_IN_4_6
+void                    gdk_texture_loader_cancel               (GdkTextureLoader       *self);
+
+G_END_DECLS
+
+#endif /* __GDK_TEXTURE_LOADER_H__ */
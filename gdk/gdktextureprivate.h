@@ -22,6 +22,11 @@ struct _GdkTexture
   gpointer render_key;
   gpointer render_data;
   GDestroyNotify render_notify;
+
+  /* The texture this one is an update of, and the area that
+   * differs from it, see gdk_texture_diff() */
+  GWeakRef diff_to;
+  cairo_region_t *diff;
 };
 
 struct _GdkTextureClass {
@@ -35,6 +40,14 @@ struct _GdkTextureClass {
 };
 
 gboolean                gdk_texture_can_load            (GBytes                 *bytes);
+GBytes *                gdk_texture_load_file_bytes     (GFile                  *file,
+                                                         GError                **error);
+GdkTexture *            gdk_texture_new_from_bytes_at_size
+                                                        (GBytes                 *bytes,
+                                                         int                     width,
+                                                         int                     height,
+                                                         int                    *out_downscale,
+                                                         GError                **error);
 
 GdkTexture *            gdk_texture_new_for_surface     (cairo_surface_t        *surface);
 cairo_surface_t *       gdk_texture_download_surface    (GdkTexture             *texture);
@@ -52,6 +65,13 @@ void                    gdk_texture_clear_render_data   (GdkTexture
 gpointer                gdk_texture_get_render_data     (GdkTexture             *self,
                                                          gpointer                key);
 
+void                    gdk_texture_set_diff            (GdkTexture             *self,
+                                                         GdkTexture             *previous,
+                                                         const cairo_region_t   *diff);
+gboolean                gdk_texture_diff                (GdkTexture             *self,
+                                                         GdkTexture             *other,
+                                                         cairo_region_t         *region);
+
 G_END_DECLS
 
 #endif /* __GDK_TEXTURE_PRIVATE_H__ */
@@ -704,6 +704,41 @@ gdk_vulkan_context_get_queue (GdkVulkanContext *context)
   return gdk_draw_context_get_display (GDK_DRAW_CONTEXT (context))->vk_queue;
 }
 
+/*<private>
+ * gdk_vulkan_context_get_transfer_queue:
+ * @context: a `GdkVulkanContext`
+ *
+ * Gets a queue that can be used for copies that should not wait for
+ * rendering. This is the same queue as gdk_vulkan_context_get_queue()
+ * if the device has no dedicated transfer queue.
+ *
+ * Returns: (transfer none): the VkQueue
+ */
+VkQueue
+gdk_vulkan_context_get_transfer_queue (GdkVulkanContext *context)
+{
+  g_return_val_if_fail (GDK_IS_VULKAN_CONTEXT (context), NULL);
+
+  return gdk_draw_context_get_display (GDK_DRAW_CONTEXT (context))->vk_transfer_queue;
+}
+
+/*<private>
+ * gdk_vulkan_context_get_transfer_queue_family_index:
+ * @context: a `GdkVulkanContext`
+ *
+ * Gets the family index for the queue returned by
+ * gdk_vulkan_context_get_transfer_queue().
+ *
+ * Returns: the index
+ */
+uint32_t
+gdk_vulkan_context_get_transfer_queue_family_index (GdkVulkanContext *context)
+{
+  g_return_val_if_fail (GDK_IS_VULKAN_CONTEXT (context), 0);
+
+  return gdk_draw_context_get_display (GDK_DRAW_CONTEXT (context))->vk_transfer_queue_family_index;
+}
+
 /**
  * gdk_vulkan_context_get_queue_family_index:
  * @context: a `GdkVulkanContext`
@@ -942,6 +977,21 @@ gdk_display_create_vulkan_device (GdkDisplay  *display,
             {
               GPtrArray *device_extensions;
               gboolean has_incremental_present;
+              uint32_t transfer_family = j;
+              uint32_t k;
+
+              /* A transfer-only family usually maps to a DMA engine that
+               * can copy data while the graphics queue is busy.
+               */
+              for (k = 0; k < n_queue_props; k++)
+                {
+                  if ((queue_props[k].queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+                      !(queue_props[k].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+                    {
+                      transfer_family = k;
+                      break;
+                    }
+                }
 
               has_incremental_present = device_supports_incremental_present (devices[i]);
 
@@ -950,18 +1000,26 @@ gdk_display_create_vulkan_device (GdkDisplay  *display,
               if (has_incremental_present)
                 g_ptr_array_add (device_extensions, (gpointer) VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
 
-              GDK_DISPLAY_NOTE (display, VULKAN, g_print ("Using Vulkan device %u, queue %u\n", i, j));
+              GDK_DISPLAY_NOTE (display, VULKAN, g_print ("Using Vulkan device %u, queue %u, transfer queue %u\n", i, j, transfer_family));
               if (GDK_VK_CHECK (vkCreateDevice, devices[i],
                                                 &(VkDeviceCreateInfo) {
                                                     VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
                                                     NULL,
                                                     0,
-                                                    1,
-                                                    &(VkDeviceQueueCreateInfo) {
-                                                        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-                                                        .queueFamilyIndex = j,
-                                                        .queueCount = 1,
-                                                        .pQueuePriorities = (float []) { 1.0f },
+                                                    transfer_family != j ? 2 : 1,
+                                                    (VkDeviceQueueCreateInfo[2]) {
+                                                        {
+                                                            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                                                            .queueFamilyIndex = j,
+                                                            .queueCount = 1,
+                                                            .pQueuePriorities = (float []) { 1.0f },
+                                                        },
+                                                        {
+                                                            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                                                            .queueFamilyIndex = transfer_family,
+                                                            .queueCount = 1,
+                                                            .pQueuePriorities = (float []) { 1.0f },
+                                                        },
                                                     },
                                                     0,
                                                     NULL,
@@ -980,6 +1038,8 @@ gdk_display_create_vulkan_device (GdkDisplay  *display,
               display->vk_physical_device = devices[i];
               vkGetDeviceQueue(display->vk_device, j, 0, &display->vk_queue);
               display->vk_queue_family_index = j;
+              vkGetDeviceQueue(display->vk_device, transfer_family, 0, &display->vk_transfer_queue);
+              display->vk_transfer_queue_family_index = transfer_family;
               return TRUE;
             }
         }
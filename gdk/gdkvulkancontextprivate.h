@@ -74,6 +74,9 @@ gboolean        gdk_display_ref_vulkan                          (GdkDisplay
                                                                  GError         **error);
 void            gdk_display_unref_vulkan                        (GdkDisplay      *display);
 
+VkQueue         gdk_vulkan_context_get_transfer_queue           (GdkVulkanContext *context);
+uint32_t        gdk_vulkan_context_get_transfer_queue_family_index (GdkVulkanContext *context);
+
 #else /* !GDK_RENDERING_VULKAN */
 
 
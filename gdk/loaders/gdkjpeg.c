@@ -135,6 +135,41 @@ convert_cmyk_to_rgba (guchar *data,
 GdkTexture *
 gdk_load_jpeg (GBytes  *input_bytes,
                GError **error)
+{
+  return gdk_load_jpeg_at_size (input_bytes, -1, -1, NULL, error);
+}
+
+/* libjpeg can scale by 1/2, 1/4 and 1/8 while decoding, by skipping
+ * the higher frequencies of the DCT. Pick the largest of these that
+ * still yields at least @width x @height pixels.
+ */
+static int
+find_downscale (guint image_width,
+                guint image_height,
+                int   width,
+                int   height)
+{
+  int downscale;
+
+  if (width <= 0 || height <= 0)
+    return 1;
+
+  for (downscale = 8; downscale > 1; downscale /= 2)
+    {
+      if (image_width >= (guint) width * downscale &&
+          image_height >= (guint) height * downscale)
+        break;
+    }
+
+  return downscale;
+}
+
+GdkTexture *
+gdk_load_jpeg_at_size (GBytes  *input_bytes,
+                       int      width_hint,
+                       int      height_hint,
+                       int     *out_downscale,
+                       GError **error)
 {
   struct jpeg_decompress_struct info;
   struct error_handler_data jerr;
@@ -144,6 +179,7 @@ gdk_load_jpeg (GBytes  *input_bytes,
   GBytes *bytes;
   GdkTexture *texture;
   GdkMemoryFormat format;
+  int downscale;
   G_GNUC_UNUSED guint64 before = GDK_PROFILER_CURRENT_TIME;
 
   info.err = jpeg_std_error (&jerr.pub);
@@ -164,6 +200,11 @@ gdk_load_jpeg (GBytes  *input_bytes,
                 g_bytes_get_size (input_bytes));
 
   jpeg_read_header (&info, TRUE);
+
+  downscale = find_downscale (info.image_width, info.image_height, width_hint, height_hint);
+  info.scale_num = 1;
+  info.scale_denom = downscale;
+
   jpeg_start_decompress (&info);
 
   width = info.output_width;
@@ -231,6 +272,9 @@ gdk_load_jpeg (GBytes  *input_bytes,
 
   g_bytes_unref (bytes);
 
+  if (out_downscale)
+    *out_downscale = downscale;
+
   gdk_profiler_end_mark (before, "jpeg load", NULL);
  
   return texture;
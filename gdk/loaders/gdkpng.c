@@ -128,54 +128,21 @@ png_simple_warning_callback (png_structp     png,
 }
 
 /* }}} */
-/* {{{ Public API */ 
+/* {{{ Format setup */
 
-GdkTexture *
-gdk_load_png (GBytes  *bytes,
-              GError **error)
+/* Sets up the transformations to one of our memory formats, after
+ * the header has been read. Shared by the one-shot and progressive
+ * loaders.
+ */
+static gboolean
+png_setup_read (png_struct      *png,
+                png_info        *info,
+                GdkMemoryFormat *out_format,
+                GError         **error)
 {
-  png_io io;
-  png_struct *png = NULL;
-  png_info *info;
   guint width, height;
   int depth, color_type;
-  int interlace, stride;
-  GdkMemoryFormat format;
-  guchar *buffer = NULL;
-  guchar **row_pointers = NULL;
-  GBytes *out_bytes;
-  GdkTexture *texture;
-  int bpp;
-  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
-
-  io.data = (guchar *)g_bytes_get_data (bytes, &io.size);
-  io.position = 0;
-
-  png = png_create_read_struct_2 (PNG_LIBPNG_VER_STRING,
-                                  error,
-                                  png_simple_error_callback,
-                                  png_simple_warning_callback,
-                                  NULL,
-                                  png_malloc_callback,
-                                  png_free_callback);
-  if (png == NULL)
-    g_error ("Out of memory");
-
-  info = png_create_info_struct (png);
-  if (info == NULL)
-    g_error ("Out of memory");
-
-  png_set_read_fn (png, &io, png_read_func);
-
-  if (sigsetjmp (png_jmpbuf (png), 1))
-    {
-      g_free (buffer);
-      g_free (row_pointers);
-      png_destroy_read_struct (&png, &info, NULL);
-      return NULL;
-    }
-
-  png_read_info (png, info);
+  int interlace;
 
   png_get_IHDR (png, info,
                 &width, &height, &depth,
@@ -210,11 +177,10 @@ gdk_load_png (GBytes  *bytes,
                 &color_type, &interlace, NULL, NULL);
   if (depth != 8 && depth != 16)
     {
-      png_destroy_read_struct (&png, &info, NULL);
       g_set_error (error,
                    GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
                    _("Unsupported depth %u in png image"), depth);
-      return NULL;
+      return FALSE;
     }
 
   switch (color_type)
@@ -222,36 +188,104 @@ gdk_load_png (GBytes  *bytes,
     case PNG_COLOR_TYPE_RGB_ALPHA:
       if (depth == 8)
         {
-          format = GDK_MEMORY_R8G8B8A8;
+          *out_format = GDK_MEMORY_R8G8B8A8;
         }
       else
         {
-          format = GDK_MEMORY_R16G16B16A16;
+          *out_format = GDK_MEMORY_R16G16B16A16;
         }
       break;
     case PNG_COLOR_TYPE_RGB:
       if (depth == 8)
         {
-          format = GDK_MEMORY_R8G8B8;
+          *out_format = GDK_MEMORY_R8G8B8;
         }
-      else if (depth == 16)
+      else
         {
-          format = GDK_MEMORY_R16G16B16;
+          *out_format = GDK_MEMORY_R16G16B16;
         }
       break;
     default:
-      png_destroy_read_struct (&png, &info, NULL);
       g_set_error (error,
                    GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
                    _("Unsupported color type %u in png image"), color_type);
-      return NULL;
+      return FALSE;
     }
 
-  bpp = gdk_memory_format_bytes_per_pixel (format);
-  stride = width * bpp;
+  return TRUE;
+}
+
+static gsize
+png_get_stride (guint           width,
+                GdkMemoryFormat format)
+{
+  gsize stride;
+
+  stride = width * gdk_memory_format_bytes_per_pixel (format);
   if (stride % 8)
     stride += 8 - stride % 8;
 
+  return stride;
+}
+
+/* }}} */
+/* {{{ Public API */ 
+
+GdkTexture *
+gdk_load_png (GBytes  *bytes,
+              GError **error)
+{
+  png_io io;
+  png_struct *png = NULL;
+  png_info *info;
+  guint width, height;
+  gsize stride;
+  GdkMemoryFormat format;
+  guchar *buffer = NULL;
+  guchar **row_pointers = NULL;
+  GBytes *out_bytes;
+  GdkTexture *texture;
+  G_GNUC_UNUSED gint64 before = GDK_PROFILER_CURRENT_TIME;
+
+  io.data = (guchar *)g_bytes_get_data (bytes, &io.size);
+  io.position = 0;
+
+  png = png_create_read_struct_2 (PNG_LIBPNG_VER_STRING,
+                                  error,
+                                  png_simple_error_callback,
+                                  png_simple_warning_callback,
+                                  NULL,
+                                  png_malloc_callback,
+                                  png_free_callback);
+  if (png == NULL)
+    g_error ("Out of memory");
+
+  info = png_create_info_struct (png);
+  if (info == NULL)
+    g_error ("Out of memory");
+
+  png_set_read_fn (png, &io, png_read_func);
+
+  if (sigsetjmp (png_jmpbuf (png), 1))
+    {
+      g_free (buffer);
+      g_free (row_pointers);
+      png_destroy_read_struct (&png, &info, NULL);
+      return NULL;
+    }
+
+  png_read_info (png, info);
+
+  if (!png_setup_read (png, info, &format, error))
+    {
+      png_destroy_read_struct (&png, &info, NULL);
+      return NULL;
+    }
+
+  width = png_get_image_width (png, info);
+  height = png_get_image_height (png, info);
+  stride = png_get_stride (width, format);
+
   buffer = g_try_malloc_n (height, stride);
   row_pointers = g_try_malloc_n (height, sizeof (char *));
 
@@ -289,26 +323,35 @@ gdk_load_png (GBytes  *bytes,
   return texture;
 }
 
-GBytes *
-gdk_save_png (GdkTexture *texture)
+/* Rows are converted in bands of this many, so that we never
+ * hold a second copy of the whole image
+ */
+#define SAVE_BAND_ROWS 64
+
+static gboolean
+png_save (GdkTexture  *texture,
+          png_rw_ptr   write_func,
+          gpointer     io_ptr,
+          int          compression_level,
+          GError     **error)
 {
   png_struct *png = NULL;
   png_info *info;
-  png_io io = { NULL, 0, 0 };
   int width, height;
-  gsize stride;
+  gsize stride, band_stride;
   const guchar *data;
+  guchar *band = NULL;
   int y;
   GdkMemoryTexture *memtex;
-  GdkMemoryFormat format;
+  GdkMemoryFormat format, src_format;
   int png_format;
   int depth;
 
   width = gdk_texture_get_width (texture);
   height = gdk_texture_get_height (texture);
-  format = gdk_texture_get_format (texture);
+  src_format = gdk_texture_get_format (texture);
 
-  switch (format)
+  switch (src_format)
     {
     case GDK_MEMORY_B8G8R8A8_PREMULTIPLIED:
     case GDK_MEMORY_A8R8G8B8_PREMULTIPLIED:
@@ -353,33 +396,49 @@ gdk_save_png (GdkTexture *texture)
       g_assert_not_reached ();
     }
 
-  png = png_create_write_struct_2 (PNG_LIBPNG_VER_STRING, NULL,
+  png = png_create_write_struct_2 (PNG_LIBPNG_VER_STRING, error,
                                    png_simple_error_callback,
                                    png_simple_warning_callback,
                                    NULL,
                                    png_malloc_callback,
                                    png_free_callback);
   if (!png)
-    return NULL;
+    return FALSE;
 
   info = png_create_info_struct (png);
   if (!info)
     {
-      png_destroy_read_struct (&png, NULL, NULL);
-      return NULL;
+      png_destroy_write_struct (&png, NULL);
+      return FALSE;
     }
 
-  memtex = gdk_memory_texture_from_texture (texture, format);
+  /* Memory textures are used in place, and converted band by band */
+  memtex = gdk_memory_texture_from_texture (texture, src_format);
+  data = gdk_memory_texture_get_data (memtex);
+  stride = gdk_memory_texture_get_stride (memtex);
+
+  band_stride = width * gdk_memory_format_bytes_per_pixel (format);
+  if (src_format != format)
+    band = g_malloc_n (band_stride, MIN (height, SAVE_BAND_ROWS));
 
   if (sigsetjmp (png_jmpbuf (png), 1))
     {
       g_object_unref (memtex);
-      g_free (io.data);
-      png_destroy_read_struct (&png, &info, NULL);
-      return NULL;
+      g_free (band);
+      png_destroy_write_struct (&png, &info);
+      return FALSE;
     }
 
-  png_set_write_fn (png, &io, png_write_func, png_flush_func);
+  png_set_write_fn (png, io_ptr, write_func, png_flush_func);
+
+  if (compression_level >= 0)
+    {
+      png_set_compression_level (png, compression_level);
+      /* The adaptive filter heuristics cost more than they gain
+       * at low compression levels */
+      if (compression_level <= 3)
+        png_set_filter (png, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+    }
 
   png_set_IHDR (png, info, width, height, depth,
                 png_format,
@@ -393,20 +452,328 @@ gdk_save_png (GdkTexture *texture)
   png_set_swap (png);
 #endif
 
-  data = gdk_memory_texture_get_data (memtex);
-  stride = gdk_memory_texture_get_stride (memtex);
-  for (y = 0; y < height; y++)
-    png_write_row (png, data + y * stride);
+  if (band == NULL)
+    {
+      for (y = 0; y < height; y++)
+        png_write_row (png, data + y * stride);
+    }
+  else
+    {
+      for (y = 0; y < height; y += SAVE_BAND_ROWS)
+        {
+          int n_rows = MIN (height - y, SAVE_BAND_ROWS);
+
+          gdk_memory_convert (band, band_stride, format,
+                              data + y * stride, stride, src_format,
+                              width, n_rows);
+
+          for (int i = 0; i < n_rows; i++)
+            png_write_row (png, band + i * band_stride);
+        }
+    }
 
   png_write_end (png, info);
 
   png_destroy_write_struct (&png, &info);
 
+  g_free (band);
   g_object_unref (memtex);
 
+  return TRUE;
+}
+
+GBytes *
+gdk_save_png (GdkTexture *texture)
+{
+  png_io io = { NULL, 0, 0 };
+
+  if (!png_save (texture, png_write_func, &io, -1, NULL))
+    {
+      g_free (io.data);
+      return NULL;
+    }
+
   return g_bytes_new_take (io.data, io.size);
 }
 
+typedef struct
+{
+  GOutputStream *stream;
+  GCancellable *cancellable;
+  GError *error;
+} png_stream_io;
+
+static void
+png_stream_write_func (png_structp png,
+                       png_bytep   data,
+                       png_size_t  size)
+{
+  png_stream_io *io = png_get_io_ptr (png);
+
+  if (!g_output_stream_write_all (io->stream, data, size, NULL, io->cancellable, &io->error))
+    png_error (png, "Write failed");
+}
+
+/*<private>
+ * gdk_save_png_to_stream:
+ * @texture: the texture to save
+ * @stream: the stream to write to
+ * @compression_level: the zlib compression level from 0 to 9,
+ *   or -1 for the default
+ * @cancellable: (nullable): a `GCancellable`
+ * @error: Return location for an error
+ *
+ * Encodes @texture as PNG and writes it to @stream as the data is
+ * produced, so readers get the first bytes right away and the
+ * image is never held in memory twice.
+ *
+ * Returns: %TRUE on success
+ */
+gboolean
+gdk_save_png_to_stream (GdkTexture     *texture,
+                        GOutputStream  *stream,
+                        int             compression_level,
+                        GCancellable   *cancellable,
+                        GError        **error)
+{
+  png_stream_io io = { stream, cancellable, NULL };
+  GError *local_error = NULL;
+
+  if (!png_save (texture, png_stream_write_func, &io, compression_level, &local_error))
+    {
+      /* Prefer the error from the stream, like a cancellation */
+      if (io.error)
+        {
+          g_propagate_error (error, io.error);
+          g_clear_error (&local_error);
+        }
+      else if (local_error)
+        g_propagate_error (error, local_error);
+      else
+        g_set_error_literal (error,
+                             GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
+                             _("Not enough memory to save the image"));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* }}} */
+/* {{{ Progressive loading */
+
+struct _GdkPngLoader
+{
+  png_struct *png;
+  png_info *info;
+  GError *error;
+
+  GdkMemoryFormat format;
+  guint width;
+  guint height;
+  gsize stride;
+  guchar *buffer;
+
+  guint64 serial;
+  gboolean done;
+  GdkTexture *texture;
+};
+
+static void
+png_loader_info_callback (png_structp png,
+                          png_infop   info)
+{
+  GdkPngLoader *self = png_get_progressive_ptr (png);
+
+  if (!png_setup_read (png, info, &self->format, &self->error))
+    png_error (png, "Unsupported image");
+
+  self->width = png_get_image_width (png, info);
+  self->height = png_get_image_height (png, info);
+  self->stride = png_get_stride (self->width, self->format);
+
+  /* Rows that haven't arrived yet stay transparent */
+  self->buffer = g_try_malloc0_n (self->height, self->stride);
+  if (self->buffer == NULL)
+    {
+      g_set_error (&self->error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_TOO_LARGE,
+                   _("Not enough memory for image size %ux%u"), self->width, self->height);
+      png_error (png, "Out of memory");
+    }
+
+  self->serial++;
+}
+
+static void
+png_loader_row_callback (png_structp png,
+                         png_bytep   new_row,
+                         png_uint_32 row_num,
+                         int         pass)
+{
+  GdkPngLoader *self = png_get_progressive_ptr (png);
+
+  /* Interlaced images send NULL for rows without pixels in this pass */
+  if (new_row == NULL)
+    return;
+
+  png_progressive_combine_row (png, self->buffer + row_num * self->stride, new_row);
+  self->serial++;
+}
+
+static void
+png_loader_end_callback (png_structp png,
+                         png_infop   info)
+{
+  GdkPngLoader *self = png_get_progressive_ptr (png);
+
+  self->done = TRUE;
+  self->serial++;
+}
+
+/*<private>
+ * gdk_png_loader_new:
+ *
+ * Creates a loader that decodes a png image from data that is fed
+ * to it piecewise with gdk_png_loader_feed(), and that can produce
+ * textures of the partially decoded image at any point.
+ *
+ * The loader is not thread-safe, but it can be used from any thread.
+ *
+ * Returns: (transfer full): a new `GdkPngLoader`
+ */
+GdkPngLoader *
+gdk_png_loader_new (void)
+{
+  GdkPngLoader *self;
+
+  self = g_new0 (GdkPngLoader, 1);
+
+  self->png = png_create_read_struct_2 (PNG_LIBPNG_VER_STRING,
+                                        &self->error,
+                                        png_simple_error_callback,
+                                        png_simple_warning_callback,
+                                        NULL,
+                                        png_malloc_callback,
+                                        png_free_callback);
+  if (self->png == NULL)
+    g_error ("Out of memory");
+
+  self->info = png_create_info_struct (self->png);
+  if (self->info == NULL)
+    g_error ("Out of memory");
+
+  png_set_progressive_read_fn (self->png, self,
+                               png_loader_info_callback,
+                               png_loader_row_callback,
+                               png_loader_end_callback);
+
+  return self;
+}
+
+void
+gdk_png_loader_free (GdkPngLoader *self)
+{
+  png_destroy_read_struct (&self->png, &self->info, NULL);
+  g_clear_error (&self->error);
+  g_clear_object (&self->texture);
+  g_free (self->buffer);
+  g_free (self);
+}
+
+/*<private>
+ * gdk_png_loader_feed:
+ * @self: a `GdkPngLoader`
+ * @data: (array length=size): the next chunk of the file
+ * @size: the size of @data
+ * @error: return location for an error
+ *
+ * Decodes as much of the image as the data allows.
+ *
+ * Returns: %FALSE if the data is not a valid png image
+ */
+gboolean
+gdk_png_loader_feed (GdkPngLoader  *self,
+                     const guchar  *data,
+                     gsize          size,
+                     GError       **error)
+{
+  if (self->error == NULL)
+    {
+      if (sigsetjmp (png_jmpbuf (self->png), 1) == 0)
+        png_process_data (self->png, self->info, (png_bytep) data, size);
+    }
+
+  if (self->error)
+    {
+      if (error)
+        *error = g_error_copy (self->error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+gboolean
+gdk_png_loader_is_done (GdkPngLoader *self)
+{
+  return self->done;
+}
+
+/*<private>
+ * gdk_png_loader_get_serial:
+ * @self: a `GdkPngLoader`
+ *
+ * Gets a number that changes whenever rows were decoded, so that
+ * callers can tell if a new texture is worth creating.
+ *
+ * Returns: the serial
+ */
+guint64
+gdk_png_loader_get_serial (GdkPngLoader *self)
+{
+  return self->serial;
+}
+
+/*<private>
+ * gdk_png_loader_get_texture:
+ * @self: a `GdkPngLoader`
+ *
+ * Creates a texture with the rows that have been decoded so far.
+ * For interlaced images, the pixels of later passes are missing.
+ *
+ * Partial textures are copies of the image data. Once the image
+ * is complete, the data is shared with the texture.
+ *
+ * Returns: (transfer full) (nullable): a texture, or %NULL if the
+ *   image header hasn't been decoded yet
+ */
+GdkTexture *
+gdk_png_loader_get_texture (GdkPngLoader *self)
+{
+  GBytes *bytes;
+  GdkTexture *texture;
+
+  if (self->texture)
+    return g_object_ref (self->texture);
+
+  if (self->buffer == NULL)
+    return NULL;
+
+  if (self->done)
+    bytes = g_bytes_new_take (g_steal_pointer (&self->buffer), self->height * self->stride);
+  else
+    bytes = g_bytes_new (self->buffer, self->height * self->stride);
+
+  texture = gdk_memory_texture_new (self->width, self->height, self->format, bytes, self->stride);
+  g_bytes_unref (bytes);
+
+  if (self->done)
+    self->texture = g_object_ref (texture);
+
+  return texture;
+}
+
 /* }}} */
 
 /* vim:set foldmethod=marker expandtab: */
@@ -27,6 +27,24 @@ GdkTexture *gdk_load_png        (GBytes         *bytes,
                                  GError        **error);
 
 GBytes     *gdk_save_png        (GdkTexture     *texture);
+gboolean    gdk_save_png_to_stream
+                                (GdkTexture     *texture,
+                                 GOutputStream  *stream,
+                                 int             compression_level,
+                                 GCancellable   *cancellable,
+                                 GError        **error);
+
+typedef struct _GdkPngLoader GdkPngLoader;
+
+GdkPngLoader *  gdk_png_loader_new              (void);
+void            gdk_png_loader_free             (GdkPngLoader   *self);
+gboolean        gdk_png_loader_feed             (GdkPngLoader   *self,
+                                                 const guchar   *data,
+                                                 gsize           size,
+                                                 GError        **error);
+gboolean        gdk_png_loader_is_done          (GdkPngLoader   *self);
+guint64         gdk_png_loader_get_serial       (GdkPngLoader   *self);
+GdkTexture *    gdk_png_loader_get_texture      (GdkPngLoader   *self);
 
 static inline gboolean
 gdk_is_png (GBytes *bytes)
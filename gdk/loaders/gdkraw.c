@@ -0,0 +1,175 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkrawprivate.h"
+
+#include "gdkintl.h"
+#include "gdkmemoryformatprivate.h"
+#include "gdkmemorytextureprivate.h"
+#include "gdkprofilerprivate.h"
+
+#include <string.h>
+
+/* A trivial format that stores the pixels of a GdkMemoryTexture as
+ * they are in memory, so that a mapped file can be used as texture
+ * data without decoding or copying it:
+ *
+ *   char    magic[8]        RAW_SIGNATURE
+ *   guint32 byte_order      RAW_BYTE_ORDER
+ *   guint32 format          the GdkMemoryFormat
+ *   guint32 width
+ *   guint32 height
+ *   guint32 stride
+ *   guint32 offset          of the first row, from the start of the file
+ *
+ * All values are in the byte order of the machine that wrote the
+ * file, and files from machines with a different byte order are
+ * refused. Rows are aligned to 4 bytes.
+ */
+
+#define RAW_BYTE_ORDER 0x01020304
+#define RAW_DATA_OFFSET 64
+
+typedef struct
+{
+  char magic[8];
+  guint32 byte_order;
+  guint32 format;
+  guint32 width;
+  guint32 height;
+  guint32 stride;
+  guint32 offset;
+} RawHeader;
+
+/* {{{ Public API */
+
+GdkTexture *
+gdk_load_raw (GBytes  *bytes,
+              GError **error)
+{
+  RawHeader header;
+  const guchar *data;
+  gsize size;
+  GBytes *pixels;
+  GdkTexture *texture;
+  G_GNUC_UNUSED guint64 before = GDK_PROFILER_CURRENT_TIME;
+
+  data = g_bytes_get_data (bytes, &size);
+
+  if (size < sizeof (RawHeader))
+    {
+      g_set_error_literal (error,
+                           GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                           _("Raw image header is truncated"));
+      return NULL;
+    }
+
+  memcpy (&header, data, sizeof (RawHeader));
+
+  if (header.byte_order != RAW_BYTE_ORDER)
+    {
+      g_set_error_literal (error,
+                           GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
+                           _("Raw image was written with a different byte order"));
+      return NULL;
+    }
+
+  if (header.format >= GDK_MEMORY_N_FORMATS)
+    {
+      g_set_error (error,
+                   GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_UNSUPPORTED_CONTENT,
+                   _("Unsupported raw image format (%u)"), header.format);
+      return NULL;
+    }
+
+  if (header.width == 0 || header.height == 0 ||
+      header.width > G_MAXINT || header.height > G_MAXINT ||
+      header.stride % 4 != 0 ||
+      header.stride < (guint64) header.width * gdk_memory_format_bytes_per_pixel (header.format) ||
+      header.offset < sizeof (RawHeader) ||
+      header.offset % 4 != 0 ||
+      header.offset + (guint64) header.stride * header.height > size)
+    {
+      g_set_error_literal (error,
+                           GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                           _("Raw image header is invalid"));
+      return NULL;
+    }
+
+  /* Mapped files are page-aligned, so this only copies if the
+   * data comes from somewhere unusual */
+  if (GPOINTER_TO_SIZE (data + header.offset) % 4 == 0)
+    pixels = g_bytes_new_from_bytes (bytes, header.offset, (gsize) header.stride * header.height);
+  else
+    pixels = g_bytes_new (data + header.offset, (gsize) header.stride * header.height);
+
+  texture = gdk_memory_texture_new (header.width, header.height,
+                                    header.format,
+                                    pixels, header.stride);
+  g_bytes_unref (pixels);
+
+  gdk_profiler_end_mark (before, "raw load", NULL);
+
+  return texture;
+}
+
+GBytes *
+gdk_save_raw (GdkTexture      *texture,
+              GdkMemoryFormat  format)
+{
+  RawHeader header = { { 0, }, };
+  GdkMemoryTexture *memtex;
+  const guchar *data;
+  gsize stride, row_size;
+  guchar *result;
+  gsize size;
+  int width, height;
+
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+
+  memtex = gdk_memory_texture_from_texture (texture, format);
+  data = gdk_memory_texture_get_data (memtex);
+  stride = gdk_memory_texture_get_stride (memtex);
+
+  row_size = width * gdk_memory_format_bytes_per_pixel (format);
+
+  memcpy (header.magic, RAW_SIGNATURE, sizeof (header.magic));
+  header.byte_order = RAW_BYTE_ORDER;
+  header.format = format;
+  header.width = width;
+  header.height = height;
+  header.stride = (row_size + 3) & ~3;
+  header.offset = RAW_DATA_OFFSET;
+
+  size = RAW_DATA_OFFSET + header.stride * height;
+  result = g_malloc0 (size);
+  memcpy (result, &header, sizeof (RawHeader));
+
+  for (int y = 0; y < height; y++)
+    memcpy (result + RAW_DATA_OFFSET + y * header.stride, data + y * stride, row_size);
+
+  g_object_unref (memtex);
+
+  return g_bytes_new_take (result, size);
+}
+
+/* }}} */
+
+/* vim:set foldmethod=marker expandtab: */
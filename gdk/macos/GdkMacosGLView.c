@@ -21,7 +21,7 @@
 #include "config.h"
 
 #include <CoreGraphics/CoreGraphics.h>
-#include <OpenGL/gl.h>
+#include <QuartzCore/QuartzCore.h>
 
 #include "gdkmacossurface-private.h"
 
@@ -29,54 +29,73 @@
 
 @implementation GdkMacosGLView
 
-G_GNUC_BEGIN_IGNORE_DEPRECATIONS
-
--(void)lockFocus
+-(id)initWithFrame:(NSRect)frame
 {
-  NSOpenGLContext *context;
+  if ((self = [super initWithFrame:frame]))
+    {
+      [self setWantsLayer:YES];
+      [self setLayerContentsRedrawPolicy:NSViewLayerContentsRedrawNever];
+      [self.layer setContentsGravity:kCAGravityBottomLeft];
+
+      /* GL renders bottom-up, IOSurface contents are shown top-down */
+      [self.layer setAffineTransform:CGAffineTransformMakeScale (1.0, -1.0)];
+    }
 
-  [super lockFocus];
+  return self;
+}
 
-  context = [self openGLContext];
+-(void)dealloc
+{
+  if (_contents != NULL)
+    CFRelease (_contents);
+  _contents = NULL;
 
-  if ([context view] != self)
-    [context setView: self];
+  [super dealloc];
 }
 
--(void)drawRect:(NSRect)rect
+-(BOOL)wantsUpdateLayer
 {
+  /* The layer contents are provided by the GL context, AppKit must
+   * not draw into a backing store of its own over them.
+   */
+  return YES;
 }
 
--(void)clearGLContext
+-(void)updateLayer
 {
-  if (_openGLContext != nil)
-    [_openGLContext clearDrawable];
+}
 
-  _openGLContext = nil;
+-(void)drawRect:(NSRect)rect
+{
 }
 
--(void)setOpenGLContext:(NSOpenGLContext*)context
+-(void)setContents:(IOSurfaceRef)contents scale:(double)scale opaque:(BOOL)opaque
 {
-  if (_openGLContext != context)
-    {
-      if (_openGLContext != nil)
-        [_openGLContext clearDrawable];
+  CALayer *layer = [self layer];
 
-      _openGLContext = context;
+  [CATransaction begin];
+  [CATransaction setDisableActions:YES];
 
-      if (_openGLContext != nil)
-        {
-          [_openGLContext setView:self];
-          [self setWantsLayer:YES];
-          [self.layer setContentsGravity:kCAGravityBottomLeft];
-          [_openGLContext update];
-        }
+  if (contents == _contents)
+    {
+      /* Same IOSurface, so only tell Core Animation that it changed */
+      [layer setContentsChanged];
     }
-}
+  else
+    {
+      if (contents != NULL)
+        CFRetain (contents);
+      if (_contents != NULL)
+        CFRelease (_contents);
+      _contents = contents;
 
--(NSOpenGLContext *)openGLContext
-{
-  return _openGLContext;
+      [layer setContents:(id)contents];
+    }
+
+  [layer setContentsScale:scale];
+  [layer setOpaque:opaque];
+
+  [CATransaction commit];
 }
 
 -(BOOL)isOpaque
@@ -120,6 +139,4 @@ G_GNUC_BEGIN_IGNORE_DEPRECATIONS
     }
 }
 
-G_GNUC_END_IGNORE_DEPRECATIONS
-
 @end
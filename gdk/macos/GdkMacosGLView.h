@@ -20,22 +20,18 @@
  */
 
 #include <cairo.h>
+#include <IOSurface/IOSurface.h>
 
 #import "GdkMacosBaseView.h"
 
 #define GDK_IS_MACOS_GL_VIEW(obj) ((obj) && [obj isKindOfClass:[GdkMacosGLView class]])
 
-G_GNUC_BEGIN_IGNORE_DEPRECATIONS
-
 @interface GdkMacosGLView : GdkMacosBaseView
 {
-  NSOpenGLContext *_openGLContext;
+  IOSurfaceRef _contents;
 }
 
--(void)setOpenGLContext:(NSOpenGLContext*)context;
--(NSOpenGLContext *)openGLContext;
+-(void)setContents:(IOSurfaceRef)contents scale:(double)scale opaque:(BOOL)opaque;
 -(void)invalidateRegion:(const cairo_region_t *)region;
 
-G_GNUC_END_IGNORE_DEPRECATIONS
-
 @end
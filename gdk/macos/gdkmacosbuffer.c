@@ -0,0 +1,214 @@
+/*
+ * Copyright © 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#include "gdkmacosbuffer-private.h"
+
+/* A GdkMacosBuffer wraps an IOSurface that GL renders into and that is
+ * then handed to Core Animation as the contents of a layer, so that the
+ * rendered pixels are never copied on their way to the compositor.
+ */
+struct _GdkMacosBuffer
+{
+  GObject         parent_instance;
+  cairo_region_t *damage;
+  IOSurfaceRef    surface;
+  guint           width;
+  guint           height;
+  double          device_scale;
+};
+
+G_DEFINE_TYPE (GdkMacosBuffer, gdk_macos_buffer, G_TYPE_OBJECT)
+
+static void
+gdk_macos_buffer_dispose (GObject *object)
+{
+  GdkMacosBuffer *self = (GdkMacosBuffer *)object;
+
+  g_clear_pointer (&self->damage, cairo_region_destroy);
+
+  if (self->surface != NULL)
+    {
+      IOSurfaceRef surface = g_steal_pointer (&self->surface);
+      CFRelease (surface);
+    }
+
+  G_OBJECT_CLASS (gdk_macos_buffer_parent_class)->dispose (object);
+}
+
+static void
+gdk_macos_buffer_class_init (GdkMacosBufferClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = gdk_macos_buffer_dispose;
+}
+
+static void
+gdk_macos_buffer_init (GdkMacosBuffer *self)
+{
+}
+
+static void
+add_int (CFMutableDictionaryRef dict,
+         const CFStringRef      key,
+         int                    value)
+{
+  CFNumberRef number = CFNumberCreate (NULL, kCFNumberIntType, &value);
+  CFDictionaryAddValue (dict, key, number);
+  CFRelease (number);
+}
+
+static IOSurfaceRef
+create_surface (int width,
+                int height,
+                int bytes_per_element)
+{
+  CFMutableDictionaryRef props;
+  IOSurfaceRef ret;
+  size_t bytes_per_row;
+  size_t total_bytes;
+
+  props = CFDictionaryCreateMutable (kCFAllocatorDefault,
+                                     16,
+                                     &kCFTypeDictionaryKeyCallBacks,
+                                     &kCFTypeDictionaryValueCallBacks);
+  if (props == NULL)
+    return NULL;
+
+  bytes_per_row = IOSurfaceAlignProperty (kIOSurfaceBytesPerRow, width * bytes_per_element);
+  total_bytes = IOSurfaceAlignProperty (kIOSurfaceAllocSize, height * bytes_per_row);
+
+  add_int (props, kIOSurfaceAllocSize, total_bytes);
+  add_int (props, kIOSurfaceBytesPerElement, bytes_per_element);
+  add_int (props, kIOSurfaceBytesPerRow, bytes_per_row);
+  add_int (props, kIOSurfaceHeight, height);
+  add_int (props, kIOSurfacePixelFormat, (int)'BGRA');
+  add_int (props, kIOSurfaceWidth, width);
+
+  ret = IOSurfaceCreate (props);
+
+  CFRelease (props);
+
+  return ret;
+}
+
+GdkMacosBuffer *
+_gdk_macos_buffer_new (int    width,
+                       int    height,
+                       double device_scale,
+                       int    bytes_per_element)
+{
+  GdkMacosBuffer *self;
+
+  g_return_val_if_fail (width > 0, NULL);
+  g_return_val_if_fail (height > 0, NULL);
+
+  self = g_object_new (GDK_TYPE_MACOS_BUFFER, NULL);
+  self->width = width;
+  self->height = height;
+  self->device_scale = device_scale;
+  self->surface = create_surface (width, height, bytes_per_element);
+
+  if (self->surface == NULL)
+    g_clear_object (&self);
+
+  return self;
+}
+
+IOSurfaceRef
+_gdk_macos_buffer_get_native (GdkMacosBuffer *self)
+{
+  g_return_val_if_fail (GDK_IS_MACOS_BUFFER (self), NULL);
+
+  return self->surface;
+}
+
+guint
+_gdk_macos_buffer_get_width (GdkMacosBuffer *self)
+{
+  g_return_val_if_fail (GDK_IS_MACOS_BUFFER (self), 0);
+
+  return self->width;
+}
+
+guint
+_gdk_macos_buffer_get_height (GdkMacosBuffer *self)
+{
+  g_return_val_if_fail (GDK_IS_MACOS_BUFFER (self), 0);
+
+  return self->height;
+}
+
+double
+_gdk_macos_buffer_get_device_scale (GdkMacosBuffer *self)
+{
+  g_return_val_if_fail (GDK_IS_MACOS_BUFFER (self), 1.0);
+
+  return self->device_scale;
+}
+
+/* Whether the window server still displays the buffer, in which case
+ * drawing into it would tear.
+ */
+gboolean
+_gdk_macos_buffer_get_in_use (GdkMacosBuffer *self)
+{
+  g_return_val_if_fail (GDK_IS_MACOS_BUFFER (self), FALSE);
+
+  return IOSurfaceIsInUse (self->surface);
+}
+
+/* The area, in surface coordinates, that changed since the buffer was
+ * last drawn to. %NULL means that the buffer has no valid contents.
+ */
+const cairo_region_t *
+_gdk_macos_buffer_get_damage (GdkMacosBuffer *self)
+{
+  g_return_val_if_fail (GDK_IS_MACOS_BUFFER (self), NULL);
+
+  return self->damage;
+}
+
+void
+_gdk_macos_buffer_set_damage (GdkMacosBuffer *self,
+                              cairo_region_t *damage)
+{
+  g_return_if_fail (GDK_IS_MACOS_BUFFER (self));
+
+  if (damage == self->damage)
+    return;
+
+  g_clear_pointer (&self->damage, cairo_region_destroy);
+  self->damage = damage ? cairo_region_reference (damage) : NULL;
+}
+
+void
+_gdk_macos_buffer_add_damage (GdkMacosBuffer       *self,
+                              const cairo_region_t *damage)
+{
+  g_return_if_fail (GDK_IS_MACOS_BUFFER (self));
+
+  /* Buffers without contents are fully repainted anyway */
+  if (self->damage != NULL)
+    cairo_region_union (self->damage, damage);
+}
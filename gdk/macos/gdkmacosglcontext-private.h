@@ -25,6 +25,7 @@
 #include "gdkdisplayprivate.h"
 #include "gdksurface.h"
 
+#include "gdkmacosbuffer-private.h"
 #include "gdkmacosdisplay.h"
 #include "gdkmacossurface.h"
 
@@ -34,6 +35,8 @@
 
 G_BEGIN_DECLS
 
+#define GDK_MACOS_GL_N_BUFFERS 3
+
 struct _GdkMacosGLContext
 {
   GdkGLContext parent_instance;
@@ -45,9 +48,15 @@ struct _GdkMacosGLContext
   NSWindow *dummy_window;
   NSView *dummy_view;
 
-  cairo_region_t *damage;
+  /* A ring of IOSurfaces that are rendered to through a texture and
+   * framebuffer each, and then become the contents of the view's layer.
+   */
+  GdkMacosBuffer *buffers[GDK_MACOS_GL_N_BUFFERS];
+  GLuint textures[GDK_MACOS_GL_N_BUFFERS];
+  GLuint framebuffers[GDK_MACOS_GL_N_BUFFERS];
+  int current_buffer;
 
-  guint is_attached : 1;
+  guint is_opaque : 1;
   guint needs_resize : 1;
 };
 
@@ -26,6 +26,7 @@
 #include "gdkintl.h"
 
 #include <OpenGL/gl.h>
+#include <OpenGL/CGLIOSurface.h>
 
 #import "GdkMacosGLView.h"
 
@@ -146,18 +147,6 @@ ensure_gl_view (GdkMacosGLContext *self)
       [nswindow setContentView:nsview];
       [nswindow makeFirstResponder:nsview];
       [nsview release];
-
-      if (self->dummy_view != NULL)
-        {
-          NSView *dummy_view = g_steal_pointer (&self->dummy_view);
-          [dummy_view release];
-        }
-
-      if (self->dummy_window != NULL)
-        {
-          NSWindow *dummy_window = g_steal_pointer (&self->dummy_window);
-          [dummy_window release];
-        }
     }
 
   return [nswindow contentView];
@@ -168,7 +157,6 @@ gdk_macos_gl_context_real_realize (GdkGLContext  *context,
                                    GError       **error)
 {
   GdkMacosGLContext *self = (GdkMacosGLContext *)context;
-  GdkSurface *surface;
   GdkDisplay *display;
   NSOpenGLContext *shared_gl_context = nil;
   NSOpenGLContext *gl_context;
@@ -176,9 +164,7 @@ gdk_macos_gl_context_real_realize (GdkGLContext  *context,
   CGLContextObj cgl_context;
   GdkGLContext *shared;
   NSOpenGLContext *existing;
-  GLint sync_to_framerate = 1;
   GLint validate = 0;
-  GLint swapRect[4];
   int major, minor;
 
   g_assert (GDK_IS_MACOS_GL_CONTEXT (self));
@@ -193,7 +179,6 @@ gdk_macos_gl_context_real_realize (GdkGLContext  *context,
 
   gdk_gl_context_get_required_version (context, &major, &minor);
 
-  surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (context));
   display = gdk_gl_context_get_display (context);
   shared = gdk_display_get_gl_context (display);
 
@@ -227,18 +212,12 @@ gdk_macos_gl_context_real_realize (GdkGLContext  *context,
 
   cgl_context = [gl_context CGLContextObj];
 
-  swapRect[0] = 0;
-  swapRect[1] = 0;
-  swapRect[2] = surface ? surface->width : 0;
-  swapRect[3] = surface ? surface->height : 0;
-
-  CGLSetParameter (cgl_context, kCGLCPSwapRectangle, swapRect);
-  CGLSetParameter (cgl_context, kCGLCPSwapInterval, &sync_to_framerate);
-
-  CGLEnable (cgl_context, kCGLCESwapRectangle);
   if (validate)
     CGLEnable (cgl_context, kCGLCEStateValidation);
 
+  /* We never draw to the default framebuffer, but the context needs
+   * a drawable to be made current.
+   */
   self->dummy_window = [[NSWindow alloc] initWithContentRect:NSZeroRect
                                                    styleMask:0
                                                      backing:NSBackingStoreBuffered
@@ -292,6 +271,117 @@ opaque_region_covers_surface (GdkMacosGLContext *self)
   return FALSE;
 }
 
+static void
+gdk_macos_gl_context_clear_buffers (GdkMacosGLContext *self)
+{
+  g_assert (GDK_IS_MACOS_GL_CONTEXT (self));
+
+  if (self->gl_context != nil)
+    {
+      gdk_gl_context_make_current (GDK_GL_CONTEXT (self));
+
+      glDeleteFramebuffers (GDK_MACOS_GL_N_BUFFERS, self->framebuffers);
+      glDeleteTextures (GDK_MACOS_GL_N_BUFFERS, self->textures);
+    }
+
+  for (guint i = 0; i < GDK_MACOS_GL_N_BUFFERS; i++)
+    {
+      g_clear_object (&self->buffers[i]);
+      self->framebuffers[i] = 0;
+      self->textures[i] = 0;
+    }
+
+  self->current_buffer = -1;
+}
+
+static gboolean
+gdk_macos_gl_context_create_buffer (GdkMacosGLContext *self,
+                                    guint              index)
+{
+  GdkSurface *surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self));
+  CGLContextObj cgl_context = [self->gl_context CGLContextObj];
+  GdkMacosBuffer *buffer;
+  int scale = gdk_surface_get_scale_factor (surface);
+  int width = surface->width * scale;
+  int height = surface->height * scale;
+  GLuint texture_id, framebuffer_id;
+  CGLError error;
+
+  if (!(buffer = _gdk_macos_buffer_new (width, height, scale, 4)))
+    return FALSE;
+
+  glGenTextures (1, &texture_id);
+  glBindTexture (GL_TEXTURE_RECTANGLE_ARB, texture_id);
+  error = CGLTexImageIOSurface2D (cgl_context,
+                                  GL_TEXTURE_RECTANGLE_ARB,
+                                  GL_RGBA,
+                                  width, height,
+                                  GL_BGRA,
+                                  GL_UNSIGNED_INT_8_8_8_8_REV,
+                                  _gdk_macos_buffer_get_native (buffer),
+                                  0);
+  glTexParameteri (GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri (GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glBindTexture (GL_TEXTURE_RECTANGLE_ARB, 0);
+
+  glGenFramebuffers (1, &framebuffer_id);
+  glBindFramebuffer (GL_FRAMEBUFFER, framebuffer_id);
+  glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                          GL_TEXTURE_RECTANGLE_ARB, texture_id, 0);
+
+  if (error != kCGLNoError ||
+      glCheckFramebufferStatus (GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      GDK_DISPLAY_NOTE (gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self)),
+                        OPENGL,
+                        g_message ("Failed to render to IOSurface of size %dx%d",
+                                   width, height));
+      glBindFramebuffer (GL_FRAMEBUFFER, 0);
+      glDeleteFramebuffers (1, &framebuffer_id);
+      glDeleteTextures (1, &texture_id);
+      g_object_unref (buffer);
+      return FALSE;
+    }
+
+  glBindFramebuffer (GL_FRAMEBUFFER, 0);
+
+  self->buffers[index] = buffer;
+  self->textures[index] = texture_id;
+  self->framebuffers[index] = framebuffer_id;
+
+  return TRUE;
+}
+
+/* Picks the buffer to draw the next frame into. Buffers that the window
+ * server still shows are skipped so that we never draw into what is on
+ * screen, and new buffers are only allocated when all of them are busy.
+ */
+static int
+gdk_macos_gl_context_acquire_buffer (GdkMacosGLContext *self)
+{
+  guint first = self->current_buffer + 1;
+
+  for (guint i = 0; i < GDK_MACOS_GL_N_BUFFERS; i++)
+    {
+      guint index = (first + i) % GDK_MACOS_GL_N_BUFFERS;
+
+      if (self->buffers[index] != NULL &&
+          !_gdk_macos_buffer_get_in_use (self->buffers[index]))
+        return index;
+    }
+
+  for (guint i = 0; i < GDK_MACOS_GL_N_BUFFERS; i++)
+    {
+      guint index = (first + i) % GDK_MACOS_GL_N_BUFFERS;
+
+      if (self->buffers[index] == NULL)
+        return gdk_macos_gl_context_create_buffer (self, index) ? index : -1;
+    }
+
+  /* Everything is still in use, so draw into the oldest buffer */
+  return first % GDK_MACOS_GL_N_BUFFERS;
+}
+
 static void
 gdk_macos_gl_context_begin_frame (GdkDrawContext *context,
                                   gboolean        prefers_high_depth,
@@ -304,61 +394,37 @@ gdk_macos_gl_context_begin_frame (GdkDrawContext *context,
 
   surface = gdk_draw_context_get_surface (context);
 
-  g_clear_pointer (&self->damage, cairo_region_destroy);
-  self->damage = cairo_region_copy (painted);
-
   /* If begin frame is called, that means we are trying to draw to
    * the NSWindow using our view. That might be a GdkMacosCairoView
-   * but we need it to be a GL view. Also, only in this case do we
-   * want to replace our damage region for the next frame (to avoid
-   * doing it multiple times).
+   * but we need it to be a GL view.
    */
   ensure_gl_view (self);
 
   if (self->needs_resize)
     {
-      CGLContextObj cgl_context = [self->gl_context CGLContextObj];
-      GLint opaque;
-
       self->needs_resize = FALSE;
 
-      if (self->dummy_view != NULL)
-        {
-          NSRect frame = NSMakeRect (0, 0, surface->width, surface->height);
-
-          [self->dummy_window setFrame:frame display:NO];
-          [self->dummy_view setFrame:frame];
-        }
+      /* Buffers of the old size are of no use anymore */
+      gdk_macos_gl_context_clear_buffers (self);
 
       /* Possibly update our opaque setting depending on a resize. We can
        * rely on getting a resize if decoarated is changed, so this reduces
        * how much we adjust the parameter.
        */
       if (GDK_IS_MACOS_TOPLEVEL_SURFACE (surface))
-        opaque = GDK_MACOS_TOPLEVEL_SURFACE (surface)->decorated;
+        self->is_opaque = GDK_MACOS_TOPLEVEL_SURFACE (surface)->decorated;
       else
-        opaque = FALSE;
+        self->is_opaque = FALSE;
 
       /* If we are maximized, we might be able to make it opaque */
-      if (opaque == FALSE)
-        opaque = opaque_region_covers_surface (self);
-
-      CGLSetParameter (cgl_context, kCGLCPSurfaceOpacity, &opaque);
-
-      [self->gl_context update];
+      if (!self->is_opaque)
+        self->is_opaque = opaque_region_covers_surface (self);
     }
 
-  GDK_DRAW_CONTEXT_CLASS (gdk_macos_gl_context_parent_class)->begin_frame (context, prefers_high_depth, painted);
+  gdk_gl_context_make_current (GDK_GL_CONTEXT (self));
+  self->current_buffer = gdk_macos_gl_context_acquire_buffer (self);
 
-  if (!self->is_attached)
-    {
-      NSView *nsview = _gdk_macos_surface_get_view (GDK_MACOS_SURFACE (surface));
-
-      g_assert (self->gl_context != NULL);
-      g_assert (GDK_IS_MACOS_GL_VIEW (nsview));
-
-      [(GdkMacosGLView *)nsview setOpenGLContext:self->gl_context];
-    }
+  GDK_DRAW_CONTEXT_CLASS (gdk_macos_gl_context_parent_class)->begin_frame (context, prefers_high_depth, painted);
 }
 
 static void
@@ -366,32 +432,42 @@ gdk_macos_gl_context_end_frame (GdkDrawContext *context,
                                 cairo_region_t *painted)
 {
   GdkMacosGLContext *self = GDK_MACOS_GL_CONTEXT (context);
+  GdkMacosBuffer *buffer;
+  cairo_region_t *damage;
+  NSView *nsview;
 
   g_assert (GDK_IS_MACOS_GL_CONTEXT (self));
   g_assert (self->gl_context != nil);
 
   GDK_DRAW_CONTEXT_CLASS (gdk_macos_gl_context_parent_class)->end_frame (context, painted);
 
-  if (!self->is_attached)
+  if (self->current_buffer < 0)
+    return;
+
+  buffer = self->buffers[self->current_buffer];
+
+  /* Submit the drawing commands, Core Animation waits for the
+   * GPU before it samples from the IOSurface.
+   */
+  gdk_gl_context_make_current (GDK_GL_CONTEXT (self));
+  glFlush ();
+
+  /* The other buffers are now missing what was painted to this one */
+  for (guint i = 0; i < GDK_MACOS_GL_N_BUFFERS; i++)
     {
-      GdkSurface *surface = gdk_draw_context_get_surface (context);
-      CGLContextObj glctx = [self->gl_context CGLContextObj];
-      cairo_rectangle_int_t flush_rect;
-      GLint swapRect[4];
-
-      /* Coordinates are in display coordinates, where as flush_rect is
-       * in GDK coordinates. Must flip Y to match display coordinates where
-       * 0,0 is the bottom-left corner.
-       */
-      cairo_region_get_extents (painted, &flush_rect);
-      swapRect[0] = flush_rect.x;                   /* left */
-      swapRect[1] = surface->height - flush_rect.y; /* bottom */
-      swapRect[2] = flush_rect.width;               /* width */
-      swapRect[3] = flush_rect.height;              /* height */
-      CGLSetParameter (glctx, kCGLCPSwapRectangle, swapRect);
-
-      [self->gl_context flushBuffer];
+      if (self->buffers[i] != NULL && self->buffers[i] != buffer)
+        _gdk_macos_buffer_add_damage (self->buffers[i], painted);
     }
+
+  damage = cairo_region_create ();
+  _gdk_macos_buffer_set_damage (buffer, damage);
+  cairo_region_destroy (damage);
+
+  nsview = _gdk_macos_surface_get_view (GDK_MACOS_SURFACE (gdk_draw_context_get_surface (context)));
+  if (GDK_IS_MACOS_GL_VIEW (nsview))
+    [(GdkMacosGLView *)nsview setContents:_gdk_macos_buffer_get_native (buffer)
+                                    scale:_gdk_macos_buffer_get_device_scale (buffer)
+                                   opaque:self->is_opaque];
 }
 
 static void
@@ -402,8 +478,6 @@ gdk_macos_gl_context_surface_resized (GdkDrawContext *draw_context)
   g_assert (GDK_IS_MACOS_GL_CONTEXT (self));
 
   self->needs_resize = TRUE;
-
-  g_clear_pointer (&self->damage, cairo_region_destroy);
 }
 
 static gboolean
@@ -464,17 +538,41 @@ gdk_macos_gl_context_get_damage (GdkGLContext *context)
 
   g_assert (GDK_IS_MACOS_GL_CONTEXT (self));
 
-  if (self->damage != NULL)
-    return cairo_region_copy (self->damage);
+  /* The buffer keeps its contents until we draw into it again, so only
+   * the parts that were painted to other buffers in the meantime need
+   * to be redrawn.
+   */
+  if (self->current_buffer >= 0)
+    {
+      const cairo_region_t *damage = _gdk_macos_buffer_get_damage (self->buffers[self->current_buffer]);
+
+      if (damage != NULL)
+        return cairo_region_copy (damage);
+    }
 
   return GDK_GL_CONTEXT_CLASS (gdk_macos_gl_context_parent_class)->get_damage (context);
 }
 
+static guint
+gdk_macos_gl_context_get_default_framebuffer (GdkGLContext *context)
+{
+  GdkMacosGLContext *self = (GdkMacosGLContext *)context;
+
+  g_assert (GDK_IS_MACOS_GL_CONTEXT (self));
+
+  if (self->current_buffer >= 0)
+    return self->framebuffers[self->current_buffer];
+
+  return 0;
+}
+
 static void
 gdk_macos_gl_context_dispose (GObject *gobject)
 {
   GdkMacosGLContext *self = GDK_MACOS_GL_CONTEXT (gobject);
 
+  gdk_macos_gl_context_clear_buffers (self);
+
   if (self->dummy_view != nil)
     {
       NSView *nsview = g_steal_pointer (&self->dummy_view);
@@ -498,8 +596,6 @@ gdk_macos_gl_context_dispose (GObject *gobject)
       [gl_context release];
     }
 
-  g_clear_pointer (&self->damage, cairo_region_destroy);
-
   G_OBJECT_CLASS (gdk_macos_gl_context_parent_class)->dispose (gobject);
 }
 
@@ -517,6 +613,7 @@ gdk_macos_gl_context_class_init (GdkMacosGLContextClass *klass)
   draw_context_class->surface_resized = gdk_macos_gl_context_surface_resized;
 
   gl_class->get_damage = gdk_macos_gl_context_get_damage;
+  gl_class->get_default_framebuffer = gdk_macos_gl_context_get_default_framebuffer;
   gl_class->clear_current = gdk_macos_gl_context_clear_current;
   gl_class->make_current = gdk_macos_gl_context_make_current;
   gl_class->realize = gdk_macos_gl_context_real_realize;
@@ -527,6 +624,8 @@ gdk_macos_gl_context_class_init (GdkMacosGLContextClass *klass)
 static void
 gdk_macos_gl_context_init (GdkMacosGLContext *self)
 {
+  self->current_buffer = -1;
+  self->needs_resize = TRUE;
 }
 
 G_GNUC_END_IGNORE_DEPRECATIONS
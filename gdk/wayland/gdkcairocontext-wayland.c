@@ -24,11 +24,21 @@
 
 #include "gdkprofilerprivate.h"
 
+#include <math.h>
+
+/* How many buffers the compositor has given back we hold on to. Two
+ * are needed when it holds on to the current one, and one is spare
+ * for the memory to be reused when resizing.
+ */
+#define MAX_RELEASED_SURFACES 3
+/* Number of frames after which an unused released buffer is dropped */
+#define MAX_BUFFER_AGE 60
+
 static const cairo_user_data_key_t gdk_wayland_cairo_context_key;
 static const cairo_user_data_key_t gdk_wayland_cairo_region_key;
+static const cairo_user_data_key_t gdk_wayland_cairo_age_key;
 
 G_DEFINE_TYPE (GdkWaylandCairoContext, gdk_wayland_cairo_context, GDK_TYPE_CAIRO_CONTEXT)
-
 static void
 gdk_wayland_cairo_context_surface_add_region (cairo_surface_t      *surface,
                                               const cairo_region_t *region)
@@ -88,6 +98,19 @@ gdk_wayland_cairo_context_remove_surface (GdkWaylandCairoContext *self,
   cairo_surface_destroy (surface);
 }
 
+static void
+gdk_wayland_cairo_context_drop_released_surface (GdkWaylandCairoContext *self,
+                                                 cairo_surface_t        *surface)
+{
+  self->released_surfaces = g_slist_remove (self->released_surfaces, surface);
+  if (self->committed_surface == surface)
+    self->committed_surface = NULL;
+
+  gdk_wayland_cairo_context_remove_surface (self, surface);
+  /* Release the reference the compositor held to this surface */
+  cairo_surface_destroy (surface);
+}
+
 static void
 gdk_wayland_cairo_context_buffer_release (void             *_data,
                                           struct wl_buffer *wl_buffer)
@@ -97,40 +120,73 @@ gdk_wayland_cairo_context_buffer_release (void             *_data,
 
   /* context was destroyed before compositor released this buffer */
   if (self == NULL)
-    return;
-
-  /* Cache one surface for reuse when drawing */
-  if (self->cached_surface == NULL)
     {
-      self->cached_surface = cairo_surface;
+      cairo_surface_destroy (cairo_surface);
       return;
     }
 
+  cairo_surface_set_user_data (cairo_surface,
+                               &gdk_wayland_cairo_age_key,
+                               GUINT_TO_POINTER (self->frame_count),
+                               NULL);
+  self->released_surfaces = g_slist_prepend (self->released_surfaces, cairo_surface);
+
   /* Get rid of all the extra ones */
-  gdk_wayland_cairo_context_remove_surface (self, cairo_surface);
-  /* Release the reference the compositor held to this surface */
-  cairo_surface_destroy (cairo_surface);
+  while (g_slist_length (self->released_surfaces) > MAX_RELEASED_SURFACES)
+    gdk_wayland_cairo_context_drop_released_surface (self, g_slist_last (self->released_surfaces)->data);
 }
 
 static const struct wl_buffer_listener buffer_listener = {
   gdk_wayland_cairo_context_buffer_release
 };
 
+static gboolean
+surface_has_size (cairo_surface_t *surface,
+                  int              width,
+                  int              height,
+                  int              scale)
+{
+  double x_scale, y_scale;
+
+  cairo_surface_get_device_scale (surface, &x_scale, &y_scale);
+
+  return cairo_image_surface_get_width (surface) == width * scale &&
+         cairo_image_surface_get_height (surface) == height * scale &&
+         x_scale == scale;
+}
+
 static cairo_surface_t *
 gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self)
 {
   GdkWaylandDisplay *display_wayland = GDK_WAYLAND_DISPLAY (gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self)));
   GdkSurface *surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self));
-  cairo_surface_t *cairo_surface;
+  cairo_surface_t *cairo_surface = NULL;
   struct wl_buffer *buffer;
   cairo_region_t *region;
-  int width, height;
+  int width, height, scale;
+  GSList *l;
 
   width = gdk_surface_get_width (surface);
   height = gdk_surface_get_height (surface);
-  cairo_surface = _gdk_wayland_display_create_shm_surface (display_wayland,
-                                                           width, height,
-                                                           gdk_surface_get_scale_factor (surface));
+  scale = gdk_surface_get_scale_factor (surface);
+
+  /* After a resize, the memory of buffers with the old size can often
+   * be reused for the new size, which is a lot cheaper than getting
+   * new shared memory from the kernel and the compositor. */
+  for (l = self->released_surfaces; l; l = l->next)
+    {
+      cairo_surface = _gdk_wayland_shm_surface_reuse (l->data, width, height, scale);
+      if (cairo_surface)
+        {
+          gdk_wayland_cairo_context_drop_released_surface (self, l->data);
+          break;
+        }
+    }
+
+  if (cairo_surface == NULL)
+    cairo_surface = _gdk_wayland_display_create_shm_surface (display_wayland,
+                                                             width, height,
+                                                             scale);
   buffer = _gdk_wayland_shm_surface_get_wl_buffer (cairo_surface);
   wl_buffer_add_listener (buffer, &buffer_listener, cairo_surface);
   gdk_wayland_cairo_context_add_surface (self, cairo_surface);
@@ -142,24 +198,96 @@ gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self)
   return cairo_surface;
 }
 
+static cairo_surface_t *
+gdk_wayland_cairo_context_get_surface (GdkWaylandCairoContext *self)
+{
+  GdkSurface *surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self));
+  int width, height, scale;
+  GSList *l;
+
+  width = gdk_surface_get_width (surface);
+  height = gdk_surface_get_height (surface);
+  scale = gdk_surface_get_scale_factor (surface);
+
+  for (l = self->released_surfaces; l; l = l->next)
+    {
+      cairo_surface_t *cairo_surface = l->data;
+
+      if (surface_has_size (cairo_surface, width, height, scale))
+        {
+          self->released_surfaces = g_slist_delete_link (self->released_surfaces, l);
+          return cairo_surface;
+        }
+    }
+
+  return gdk_wayland_cairo_context_create_surface (self);
+}
+
+static void
+gdk_wayland_cairo_context_drop_old_surfaces (GdkWaylandCairoContext *self)
+{
+  GSList *l, *next;
+
+  for (l = self->released_surfaces; l; l = next)
+    {
+      cairo_surface_t *cairo_surface = l->data;
+      guint released;
+
+      next = l->next;
+      released = GPOINTER_TO_UINT (cairo_surface_get_user_data (cairo_surface, &gdk_wayland_cairo_age_key));
+      if (self->frame_count - released > MAX_BUFFER_AGE)
+        gdk_wayland_cairo_context_drop_released_surface (self, cairo_surface);
+    }
+}
+
 static void
 gdk_wayland_cairo_context_begin_frame (GdkDrawContext *draw_context,
                                        gboolean        prefers_high_depth,
                                        cairo_region_t *region)
 {
   GdkWaylandCairoContext *self = GDK_WAYLAND_CAIRO_CONTEXT (draw_context);
+  GdkSurface *surface = gdk_draw_context_get_surface (draw_context);
   const cairo_region_t *surface_region;
   GSList *l;
   cairo_t *cr;
 
-  if (self->cached_surface)
-    self->paint_surface = g_steal_pointer (&self->cached_surface);
-  else
-    self->paint_surface = gdk_wayland_cairo_context_create_surface (self);
+  self->frame_count++;
+  self->paint_surface = gdk_wayland_cairo_context_get_surface (self);
+  gdk_wayland_cairo_context_drop_old_surfaces (self);
 
   surface_region = gdk_wayland_cairo_context_surface_get_region (self->paint_surface);
-  if (surface_region)
-    cairo_region_union (region, surface_region);
+  if (surface_region &&
+      self->committed_surface &&
+      self->committed_surface != self->paint_surface &&
+      surface_has_size (self->committed_surface,
+                        gdk_surface_get_width (surface),
+                        gdk_surface_get_height (surface),
+                        gdk_surface_get_scale_factor (surface)))
+    {
+      cairo_region_t *stale;
+
+      /* The last committed buffer is up to date everywhere but in @region,
+       * so copying from it is cheaper than having everything that changed
+       * since this buffer was last used painted again. */
+      stale = cairo_region_copy (surface_region);
+      cairo_region_subtract (stale, region);
+
+      if (!cairo_region_is_empty (stale))
+        {
+          cr = cairo_create (self->paint_surface);
+          cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+          cairo_set_source_surface (cr, self->committed_surface, 0, 0);
+          gdk_cairo_region (cr, stale);
+          cairo_fill (cr);
+          cairo_destroy (cr);
+        }
+
+      cairo_region_destroy (stale);
+    }
+  else if (surface_region)
+    {
+      cairo_region_union (region, surface_region);
+    }
 
   for (l = self->surfaces; l; l = l->next)
     {
@@ -190,23 +318,45 @@ gdk_wayland_cairo_context_end_frame (GdkDrawContext *draw_context,
   gdk_wayland_surface_notify_committed (surface);
 
   gdk_wayland_cairo_context_surface_clear_region (self->paint_surface);
+  self->committed_surface = self->paint_surface;
   self->paint_surface = NULL;
 }
 
 static void
 gdk_wayland_cairo_context_clear_all_cairo_surfaces (GdkWaylandCairoContext *self)
 {
-  g_clear_pointer (&self->cached_surface, cairo_surface_destroy);
+  while (self->released_surfaces)
+    gdk_wayland_cairo_context_drop_released_surface (self, self->released_surfaces->data);
   while (self->surfaces)
     gdk_wayland_cairo_context_remove_surface (self, self->surfaces->data);
+  self->committed_surface = NULL;
 }
 
 static void
 gdk_wayland_cairo_context_surface_resized (GdkDrawContext *draw_context)
 {
   GdkWaylandCairoContext *self = GDK_WAYLAND_CAIRO_CONTEXT (draw_context);
+  GSList *l;
 
-  gdk_wayland_cairo_context_clear_all_cairo_surfaces (self);
+  /* Keep the buffers around, so their memory can be reused for the
+   * new size, but nothing in them can be trusted anymore. */
+  for (l = self->surfaces; l; l = l->next)
+    {
+      cairo_surface_t *cairo_surface = l->data;
+      cairo_region_t *region;
+      double x_scale, y_scale;
+
+      cairo_surface_get_device_scale (cairo_surface, &x_scale, &y_scale);
+      region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                                                0, 0,
+                                                ceil (cairo_image_surface_get_width (cairo_surface) / x_scale),
+                                                ceil (cairo_image_surface_get_height (cairo_surface) / y_scale)
+                                              });
+      gdk_wayland_cairo_context_surface_add_region (cairo_surface, region);
+      cairo_region_destroy (region);
+    }
+
+  self->committed_surface = NULL;
 }
 
 static cairo_t *
@@ -223,7 +373,7 @@ gdk_wayland_cairo_context_dispose (GObject *object)
   GdkWaylandCairoContext *self = GDK_WAYLAND_CAIRO_CONTEXT (object);
 
   gdk_wayland_cairo_context_clear_all_cairo_surfaces (self);
-  g_assert (self->cached_surface == NULL);
+  g_assert (self->released_surfaces == NULL);
   g_assert (self->paint_surface == NULL);
 
   G_OBJECT_CLASS (gdk_wayland_cairo_context_parent_class)->dispose (object);
@@ -40,8 +40,10 @@ struct _GdkWaylandCairoContext
   GdkCairoContext parent_instance;
 
   GSList *surfaces;
-  cairo_surface_t *cached_surface;
+  GSList *released_surfaces; /* most recently released first */
   cairo_surface_t *paint_surface;
+  cairo_surface_t *committed_surface;
+  guint frame_count;
 };
 
 struct _GdkWaylandCairoContextClass
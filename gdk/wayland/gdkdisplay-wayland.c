@@ -31,6 +31,7 @@
 
 #include <sys/mman.h>
 #include <sys/syscall.h>
+#include <time.h>
 
 #include <glib.h>
 #include <gio/gio.h>
@@ -340,6 +341,41 @@ gdk_wayland_display_prefers_ssd (GdkDisplay *display)
   return FALSE;
 }
 
+static void
+presentation_clock_id (void                   *data,
+                       struct wp_presentation *presentation,
+                       uint32_t                clk_id)
+{
+  GdkWaylandDisplay *display_wayland = data;
+
+  GDK_DISPLAY_NOTE (GDK_DISPLAY (data), FRAMES,
+            g_message ("presentation clock: %u%s", clk_id,
+                       clk_id == CLOCK_MONOTONIC ? " (monotonic)" : ""));
+
+  display_wayland->presentation_clock_id = clk_id;
+}
+
+static const struct wp_presentation_listener presentation_listener = {
+  presentation_clock_id
+};
+
+/*<private>
+ * gdk_wayland_display_has_presentation_feedback:
+ * @display_wayland: a `GdkWaylandDisplay`
+ *
+ * Checks whether presentation feedback can be used for frame timings.
+ * That requires the compositor to report times on the same clock as
+ * g_get_monotonic_time().
+ *
+ * Returns: %TRUE if wp_presentation feedback is usable
+ */
+gboolean
+gdk_wayland_display_has_presentation_feedback (GdkWaylandDisplay *display_wayland)
+{
+  return display_wayland->presentation != NULL &&
+         display_wayland->presentation_clock_id == CLOCK_MONOTONIC;
+}
+
 static void gdk_wayland_display_set_has_gtk_shell (GdkWaylandDisplay *display_wayland);
 static void gdk_wayland_display_add_output        (GdkWaylandDisplay *display_wayland,
                                                    guint32            id,
@@ -494,6 +530,32 @@ gdk_registry_handle_global (void               *data,
         wl_registry_bind (display_wayland->wl_registry, id,
                           &zwp_idle_inhibit_manager_v1_interface, 1);
     }
+  else if (strcmp (interface, "wp_presentation") == 0)
+    {
+      /* Until we know better */
+      display_wayland->presentation_clock_id = G_MAXUINT32;
+      display_wayland->presentation =
+        wl_registry_bind (display_wayland->wl_registry, id,
+                          &wp_presentation_interface, 1);
+      wp_presentation_add_listener (display_wayland->presentation,
+                                    &presentation_listener,
+                                    display_wayland);
+      _gdk_wayland_display_async_roundtrip (display_wayland);
+    }
+  else if (strcmp (interface, "wp_viewporter") == 0)
+    {
+      display_wayland->viewporter =
+        wl_registry_bind (display_wayland->wl_registry, id,
+                          &wp_viewporter_interface, 1);
+    }
+#ifdef HAVE_WAYLAND_FRACTIONAL_SCALE
+  else if (strcmp (interface, "wp_fractional_scale_manager_v1") == 0)
+    {
+      display_wayland->fractional_scale =
+        wl_registry_bind (display_wayland->wl_registry, id,
+                          &wp_fractional_scale_manager_v1_interface, 1);
+    }
+#endif
   else if (strcmp (interface, "xdg_activation_v1") == 0)
     {
       display_wayland->xdg_activation_version =
@@ -648,6 +710,9 @@ _gdk_wayland_display_open (const char *display_name)
       return NULL;
     }
 
+  /* GL is only needed once the first surface is realized */
+  gdk_display_start_egl_probe (display, EGL_PLATFORM_WAYLAND_EXT, display_wayland->wl_display);
+
   gdk_display_emit_opened (display);
 
   return display;
@@ -1167,10 +1232,19 @@ gdk_wayland_display_get_wl_compositor (GdkDisplay *display)
 
 static const cairo_user_data_key_t gdk_wayland_shm_surface_cairo_key;
 
-typedef struct _GdkWaylandCairoSurfaceData {
+/* The shared memory backing one or more surfaces. It outlives a
+ * surface so that its memory can be reused for a surface of a
+ * different size.
+ */
+typedef struct _GdkWaylandShmMemory {
+  int ref_count;
   gpointer buf;
   size_t buf_length;
   struct wl_shm_pool *pool;
+} GdkWaylandShmMemory;
+
+typedef struct _GdkWaylandCairoSurfaceData {
+  GdkWaylandShmMemory *memory;
   struct wl_buffer *buffer;
   GdkWaylandDisplay *display;
   uint32_t scale;
@@ -1282,6 +1356,59 @@ fail:
   return NULL;
 }
 
+/* Rounds up to a size class, with at most 25% overhead, so that the
+ * memory can be reused while a surface is interactively resized.
+ */
+static size_t
+get_shm_memory_size (size_t size)
+{
+  size_t step;
+
+  step = MAX ((size_t) 1 << (g_bit_storage (size) - 1), 4 * 4096) / 4;
+
+  return (size + step - 1) / step * step;
+}
+
+static GdkWaylandShmMemory *
+gdk_wayland_shm_memory_new (GdkWaylandDisplay *display,
+                            size_t             size)
+{
+  GdkWaylandShmMemory *memory;
+
+  memory = g_new (GdkWaylandShmMemory, 1);
+  memory->ref_count = 1;
+  memory->pool = create_shm_pool (display->shm,
+                                  get_shm_memory_size (size),
+                                  &memory->buf_length,
+                                  &memory->buf);
+  if (G_UNLIKELY (memory->pool == NULL))
+    g_error ("Unable to create shared memory pool");
+
+  return memory;
+}
+
+static GdkWaylandShmMemory *
+gdk_wayland_shm_memory_ref (GdkWaylandShmMemory *memory)
+{
+  memory->ref_count++;
+
+  return memory;
+}
+
+static void
+gdk_wayland_shm_memory_unref (GdkWaylandShmMemory *memory)
+{
+  memory->ref_count--;
+  if (memory->ref_count > 0)
+    return;
+
+  if (memory->pool)
+    wl_shm_pool_destroy (memory->pool);
+
+  munmap (memory->buf, memory->buf_length);
+  g_free (memory);
+}
+
 static void
 gdk_wayland_cairo_surface_destroy (void *p)
 {
@@ -1290,45 +1417,38 @@ gdk_wayland_cairo_surface_destroy (void *p)
   if (data->buffer)
     wl_buffer_destroy (data->buffer);
 
-  if (data->pool)
-    wl_shm_pool_destroy (data->pool);
-
-  munmap (data->buf, data->buf_length);
+  gdk_wayland_shm_memory_unref (data->memory);
   g_free (data);
 }
 
-cairo_surface_t *
-_gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *display,
-                                         int                width,
-                                         int                height,
-                                         guint              scale)
+static cairo_surface_t *
+create_shm_surface_for_memory (GdkWaylandDisplay   *display,
+                               GdkWaylandShmMemory *memory,
+                               int                  width,
+                               int                  height,
+                               guint                scale)
 {
   GdkWaylandCairoSurfaceData *data;
   cairo_surface_t *surface = NULL;
   cairo_status_t status;
   int stride;
 
+  stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width * scale);
+  g_assert ((size_t) height * scale * stride <= memory->buf_length);
+
   data = g_new (GdkWaylandCairoSurfaceData, 1);
   data->display = display;
+  data->memory = memory;
   data->buffer = NULL;
   data->scale = scale;
 
-  stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width * scale);
-
-  data->pool = create_shm_pool (display->shm,
-                                height * scale * stride,
-                                &data->buf_length,
-                                &data->buf);
-  if (G_UNLIKELY (data->pool == NULL))
-    g_error ("Unable to create shared memory pool");
-
-  surface = cairo_image_surface_create_for_data (data->buf,
+  surface = cairo_image_surface_create_for_data (memory->buf,
                                                  CAIRO_FORMAT_ARGB32,
                                                  width * scale,
                                                  height * scale,
                                                  stride);
 
-  data->buffer = wl_shm_pool_create_buffer (data->pool, 0,
+  data->buffer = wl_shm_pool_create_buffer (memory->pool, 0,
                                             width * scale, height * scale,
                                             stride, WL_SHM_FORMAT_ARGB8888);
 
@@ -1347,6 +1467,58 @@ _gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *display,
   return surface;
 }
 
+cairo_surface_t *
+_gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *display,
+                                         int                width,
+                                         int                height,
+                                         guint              scale)
+{
+  GdkWaylandShmMemory *memory;
+  int stride;
+
+  stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width * scale);
+  memory = gdk_wayland_shm_memory_new (display, (size_t) height * scale * stride);
+
+  return create_shm_surface_for_memory (display, memory, width, height, scale);
+}
+
+/*<private>
+ * _gdk_wayland_shm_surface_reuse:
+ * @surface: a shm surface that is no longer used by the compositor
+ * @width: the width of the new surface
+ * @height: the height of the new surface
+ * @scale: the scale of the new surface
+ *
+ * Creates a new shm surface that shares the memory of @surface, if
+ * that memory is big enough, but not much bigger than needed.
+ *
+ * The contents of the new surface are undefined, and @surface must
+ * not be used anymore, since both surfaces share the same memory.
+ *
+ * Returns: (nullable) (transfer full): a new surface or %NULL
+ */
+cairo_surface_t *
+_gdk_wayland_shm_surface_reuse (cairo_surface_t *surface,
+                                int              width,
+                                int              height,
+                                guint            scale)
+{
+  GdkWaylandCairoSurfaceData *data = cairo_surface_get_user_data (surface, &gdk_wayland_shm_surface_cairo_key);
+  size_t size;
+  int stride;
+
+  stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width * scale);
+  size = (size_t) height * scale * stride;
+
+  if (size > data->memory->buf_length ||
+      get_shm_memory_size (size) * 2 < data->memory->buf_length)
+    return NULL;
+
+  return create_shm_surface_for_memory (data->display,
+                                        gdk_wayland_shm_memory_ref (data->memory),
+                                        width, height, scale);
+}
+
 struct wl_buffer *
 _gdk_wayland_shm_surface_get_wl_buffer (cairo_surface_t *surface)
 {
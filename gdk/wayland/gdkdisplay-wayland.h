@@ -38,6 +38,11 @@
 #include <gdk/wayland/idle-inhibit-unstable-v1-client-protocol.h>
 #include <gdk/wayland/primary-selection-unstable-v1-client-protocol.h>
 #include <gdk/wayland/xdg-activation-v1-client-protocol.h>
+#include <gdk/wayland/presentation-time-client-protocol.h>
+#include <gdk/wayland/viewporter-client-protocol.h>
+#ifdef HAVE_WAYLAND_FRACTIONAL_SCALE
+#include <gdk/wayland/fractional-scale-v1-client-protocol.h>
+#endif
 
 #include <glib.h>
 #include <gdk/gdkkeys.h>
@@ -113,6 +118,11 @@ struct _GdkWaylandDisplay
   struct zxdg_output_manager_v1 *xdg_output_manager;
   struct zwp_idle_inhibit_manager_v1 *idle_inhibit_manager;
   struct xdg_activation_v1 *xdg_activation;
+  struct wp_presentation *presentation;
+  struct wp_viewporter *viewporter;
+#ifdef HAVE_WAYLAND_FRACTIONAL_SCALE
+  struct wp_fractional_scale_manager_v1 *fractional_scale;
+#endif
 
   GList *async_roundtrips;
 
@@ -144,6 +154,7 @@ struct _GdkWaylandDisplay
   int xdg_activation_version;
 
   uint32_t server_decoration_mode;
+  uint32_t presentation_clock_id;
 
   struct xkb_context *xkb_context;
 
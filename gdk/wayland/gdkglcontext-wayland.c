@@ -69,6 +69,26 @@ gdk_wayland_gl_context_end_frame (GdkDrawContext *draw_context,
   gdk_wayland_surface_notify_committed (surface);
 }
 
+static gboolean
+gdk_wayland_gl_context_make_current (GdkGLContext *context,
+                                     gboolean      surfaceless)
+{
+  GdkDisplay *display = gdk_gl_context_get_display (context);
+
+  if (!GDK_GL_CONTEXT_CLASS (gdk_wayland_gl_context_parent_class)->make_current (context, surfaceless))
+    return FALSE;
+
+  /* The frame clock already waits for frame callbacks before drawing.
+   * With the default swap interval of 1, eglSwapBuffers() waits for
+   * one as well and blocks the main thread, so windows on different
+   * outputs end up taking turns instead of drawing in the same cycle.
+   */
+  if (!surfaceless)
+    eglSwapInterval (gdk_display_get_egl_display (display), 0);
+
+  return TRUE;
+}
+
 static void
 gdk_wayland_gl_context_class_init (GdkWaylandGLContextClass *klass)
 {
@@ -79,6 +99,8 @@ gdk_wayland_gl_context_class_init (GdkWaylandGLContextClass *klass)
   draw_context_class->end_frame = gdk_wayland_gl_context_end_frame;
 
   context_class->backend_type = GDK_GL_EGL;
+
+  context_class->make_current = gdk_wayland_gl_context_make_current;
 }
 
 static void
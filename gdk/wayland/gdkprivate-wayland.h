@@ -76,6 +76,8 @@ gboolean   _gdk_wayland_display_supports_cursor_color (GdkDisplay *display);
 void       gdk_wayland_display_system_bell (GdkDisplay *display,
                                             GdkSurface  *surface);
 
+gboolean   gdk_wayland_display_has_presentation_feedback (GdkWaylandDisplay *display_wayland);
+
 struct wl_buffer *_gdk_wayland_cursor_get_buffer (GdkWaylandDisplay *display,
                                                   GdkCursor         *cursor,
                                                   guint              desired_scale,
@@ -178,6 +180,10 @@ cairo_surface_t * _gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *di
                                                            int                width,
                                                            int                height,
                                                            guint              scale);
+cairo_surface_t * _gdk_wayland_shm_surface_reuse (cairo_surface_t *surface,
+                                                  int              width,
+                                                  int              height,
+                                                  guint            scale);
 struct wl_buffer *_gdk_wayland_shm_surface_get_wl_buffer (cairo_surface_t *surface);
 gboolean _gdk_wayland_is_shm_surface (cairo_surface_t *surface);
 
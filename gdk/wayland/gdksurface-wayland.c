@@ -104,6 +104,11 @@ struct _GdkWaylandSurface
 
     struct gtk_surface1  *gtk_surface;
     struct wl_egl_window *egl_window;
+
+    struct wp_viewport *viewport;
+#ifdef HAVE_WAYLAND_FRACTIONAL_SCALE
+    struct wp_fractional_scale_v1 *fractional_scale;
+#endif
   } display_server;
 
   struct wl_event_queue *event_queue;
@@ -118,6 +123,9 @@ struct _GdkWaylandSurface
   unsigned int mapped : 1;
   unsigned int awaiting_frame : 1;
   unsigned int awaiting_frame_frozen : 1;
+  unsigned int pending_frame_has_feedback : 1;
+
+  GList *presentation_feedbacks;
 
   int pending_buffer_offset_x;
   int pending_buffer_offset_y;
@@ -142,6 +150,9 @@ struct _GdkWaylandSurface
 
   gint64 pending_frame_counter;
   guint32 scale;
+  /* The preferred scale from wp_fractional_scale_v1 in 120ths,
+   * or 0 if we don't have one */
+  guint32 preferred_scale;
 
   int shadow_left;
   int shadow_right;
@@ -398,6 +409,50 @@ _gdk_wayland_surface_clear_saved_size (GdkSurface *surface)
   impl->saved_height = -1;
 }
 
+/* With a viewport, the buffers have the exact size for the fractional
+ * scale and the compositor maps them onto the surface. Otherwise we
+ * use the integer buffer scale.
+ */
+static void
+gdk_wayland_surface_sync_buffer_scale (GdkSurface *surface)
+{
+  GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (surface);
+  GdkWaylandDisplay *display_wayland = GDK_WAYLAND_DISPLAY (gdk_surface_get_display (surface));
+
+  if (!impl->display_server.wl_surface)
+    return;
+
+  if (impl->display_server.viewport)
+    {
+      if (display_wayland->compositor_version >= WL_SURFACE_HAS_BUFFER_SCALE)
+        wl_surface_set_buffer_scale (impl->display_server.wl_surface, 1);
+
+      if (surface->width > 0 && surface->height > 0)
+        wp_viewport_set_destination (impl->display_server.viewport,
+                                     surface->width, surface->height);
+    }
+  else if (display_wayland->compositor_version >= WL_SURFACE_HAS_BUFFER_SCALE)
+    {
+      wl_surface_set_buffer_scale (impl->display_server.wl_surface, impl->scale);
+    }
+}
+
+static void
+gdk_wayland_surface_resize_buffers (GdkSurface *surface)
+{
+  GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (surface);
+
+  if (impl->display_server.egl_window)
+    {
+      int buffer_width, buffer_height;
+
+      gdk_surface_get_buffer_size (surface, &buffer_width, &buffer_height);
+      wl_egl_window_resize (impl->display_server.egl_window, buffer_width, buffer_height, 0, 0);
+    }
+
+  gdk_wayland_surface_sync_buffer_scale (surface);
+}
+
 static void
 gdk_wayland_surface_update_size (GdkSurface *surface,
                                  int32_t     width,
@@ -418,10 +473,7 @@ gdk_wayland_surface_update_size (GdkSurface *surface,
   surface->height = height;
   impl->scale = scale;
 
-  if (impl->display_server.egl_window)
-    wl_egl_window_resize (impl->display_server.egl_window, width * scale, height * scale, 0, 0);
-  if (impl->display_server.wl_surface)
-    wl_surface_set_buffer_scale (impl->display_server.wl_surface, scale);
+  gdk_wayland_surface_resize_buffers (surface);
 
   gdk_surface_invalidate_rect (surface, NULL);
 
@@ -531,6 +583,132 @@ finish_pending_relayout (GdkSurface *surface)
   thaw_popup_toplevel_state (surface);
 }
 
+static gint64
+get_refresh_interval (GdkSurface *surface)
+{
+  GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (surface);
+  GdkWaylandDisplay *display_wayland = GDK_WAYLAND_DISPLAY (gdk_surface_get_display (surface));
+
+  if (impl->display_server.outputs)
+    {
+      /* We pick a random output out of the outputs that the surface touches
+       * The rate here is in milli-hertz */
+      int refresh_rate =
+        gdk_wayland_display_get_output_refresh_rate (display_wayland,
+                                                     impl->display_server.outputs->data);
+      if (refresh_rate != 0)
+        return G_GINT64_CONSTANT(1000000000) / refresh_rate;
+    }
+
+  return 16667; /* default to 1/60th of a second */
+}
+
+static void
+complete_frame_timings (GdkSurface      *surface,
+                        GdkFrameTimings *timings)
+{
+  GdkFrameClock *clock = gdk_surface_get_frame_clock (surface);
+
+  timings->complete = TRUE;
+
+#ifdef G_ENABLE_DEBUG
+  if ((_gdk_debug_flags & GDK_DEBUG_FRAMES) != 0)
+    _gdk_frame_clock_debug_print_timings (clock, timings);
+#endif
+
+  if (GDK_PROFILER_IS_RUNNING)
+    _gdk_frame_clock_add_timings_to_profiler (clock, timings);
+}
+
+typedef struct
+{
+  GdkSurface *surface;
+  struct wp_presentation_feedback *feedback;
+  gint64 frame_counter;
+} GdkWaylandPresentationFeedback;
+
+static void
+presentation_feedback_free (GdkWaylandPresentationFeedback *pf)
+{
+  GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (pf->surface);
+
+  impl->presentation_feedbacks = g_list_remove (impl->presentation_feedbacks, pf);
+  wp_presentation_feedback_destroy (pf->feedback);
+  g_slice_free (GdkWaylandPresentationFeedback, pf);
+}
+
+static void
+presentation_feedback_sync_output (void                            *data,
+                                   struct wp_presentation_feedback *feedback,
+                                   struct wl_output                *output)
+{
+}
+
+static void
+presentation_feedback_presented (void                            *data,
+                                 struct wp_presentation_feedback *feedback,
+                                 uint32_t                         tv_sec_hi,
+                                 uint32_t                         tv_sec_lo,
+                                 uint32_t                         tv_nsec,
+                                 uint32_t                         refresh,
+                                 uint32_t                         seq_hi,
+                                 uint32_t                         seq_lo,
+                                 uint32_t                         flags)
+{
+  GdkWaylandPresentationFeedback *pf = data;
+  GdkSurface *surface = pf->surface;
+  GdkFrameTimings *timings;
+
+  timings = gdk_frame_clock_get_timings (gdk_surface_get_frame_clock (surface),
+                                         pf->frame_counter);
+  gdk_profiler_add_mark (GDK_PROFILER_CURRENT_TIME, 0, "wayland", "presented");
+
+  if (timings != NULL)
+    {
+      /* Unlike the frame callback time, this is the actual time the
+       * frame turned into light, on the same clock we use */
+      timings->presentation_time = (((gint64) tv_sec_hi << 32) + tv_sec_lo) * G_USEC_PER_SEC +
+                                   tv_nsec / 1000;
+
+      /* Without vsync, the refresh is only an estimate of the
+       * compositor's repaint rate */
+      if (refresh != 0 && (flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC))
+        timings->refresh_interval = refresh / 1000;
+      else
+        timings->refresh_interval = get_refresh_interval (surface);
+
+      complete_frame_timings (surface, timings);
+    }
+
+  presentation_feedback_free (pf);
+}
+
+static void
+presentation_feedback_discarded (void                            *data,
+                                 struct wp_presentation_feedback *feedback)
+{
+  GdkWaylandPresentationFeedback *pf = data;
+  GdkSurface *surface = pf->surface;
+  GdkFrameTimings *timings;
+
+  timings = gdk_frame_clock_get_timings (gdk_surface_get_frame_clock (surface),
+                                         pf->frame_counter);
+  if (timings != NULL)
+    {
+      /* Never shown, so there is no presentation time */
+      timings->refresh_interval = get_refresh_interval (surface);
+      complete_frame_timings (surface, timings);
+    }
+
+  presentation_feedback_free (pf);
+}
+
+static const struct wp_presentation_feedback_listener presentation_feedback_listener = {
+  presentation_feedback_sync_output,
+  presentation_feedback_presented,
+  presentation_feedback_discarded
+};
+
 static void
 frame_callback (void               *data,
                 struct wl_callback *callback,
@@ -577,32 +755,17 @@ frame_callback (void               *data,
   timings = gdk_frame_clock_get_timings (clock, impl->pending_frame_counter);
   impl->pending_frame_counter = 0;
 
-  if (timings == NULL)
+  /* The presentation feedback will fill in the timings */
+  if (impl->pending_frame_has_feedback)
     return;
 
-  timings->refresh_interval = 16667; /* default to 1/60th of a second */
-  if (impl->display_server.outputs)
-    {
-      /* We pick a random output out of the outputs that the surface touches
-       * The rate here is in milli-hertz */
-      int refresh_rate =
-        gdk_wayland_display_get_output_refresh_rate (display_wayland,
-                                                     impl->display_server.outputs->data);
-      if (refresh_rate != 0)
-        timings->refresh_interval = G_GINT64_CONSTANT(1000000000) / refresh_rate;
-    }
+  if (timings == NULL)
+    return;
 
+  timings->refresh_interval = get_refresh_interval (surface);
   fill_presentation_time_from_frame_time (timings, time);
 
-  timings->complete = TRUE;
-
-#ifdef G_ENABLE_DEBUG
-  if ((_gdk_debug_flags & GDK_DEBUG_FRAMES) != 0)
-    _gdk_frame_clock_debug_print_timings (clock, timings);
-#endif
-
-  if (GDK_PROFILER_IS_RUNNING)
-    _gdk_frame_clock_add_timings_to_profiler (clock, timings);
+  complete_frame_timings (surface, timings);
 }
 
 static const struct wl_callback_listener frame_listener = {
@@ -706,6 +869,7 @@ void
 gdk_wayland_surface_request_frame (GdkSurface *surface)
 {
   GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (surface);
+  GdkWaylandDisplay *display_wayland;
   struct wl_callback *callback;
   GdkFrameClock *clock;
 
@@ -719,6 +883,22 @@ gdk_wayland_surface_request_frame (GdkSurface *surface)
   wl_callback_add_listener (callback, &frame_listener, surface);
   impl->pending_frame_counter = gdk_frame_clock_get_frame_counter (clock);
   impl->awaiting_frame = TRUE;
+
+  display_wayland = GDK_WAYLAND_DISPLAY (gdk_surface_get_display (surface));
+  impl->pending_frame_has_feedback = gdk_wayland_display_has_presentation_feedback (display_wayland);
+  if (impl->pending_frame_has_feedback)
+    {
+      GdkWaylandPresentationFeedback *pf;
+
+      pf = g_slice_new (GdkWaylandPresentationFeedback);
+      pf->surface = surface;
+      pf->frame_counter = impl->pending_frame_counter;
+      pf->feedback = wp_presentation_feedback (display_wayland->presentation,
+                                               impl->display_server.wl_surface);
+      wl_proxy_set_queue ((struct wl_proxy *) pf->feedback, NULL);
+      wp_presentation_feedback_add_listener (pf->feedback, &presentation_feedback_listener, pf);
+      impl->presentation_feedbacks = g_list_prepend (impl->presentation_feedbacks, pf);
+    }
 }
 
 gboolean
@@ -779,6 +959,10 @@ gdk_wayland_surface_update_scale (GdkSurface *surface)
       return;
     }
 
+  /* The compositor tells us the exact scale it wants */
+  if (impl->preferred_scale != 0)
+    return;
+
   if (!impl->display_server.outputs)
     {
       scale = impl->scale;
@@ -905,7 +1089,6 @@ gdk_wayland_surface_attach_image (GdkSurface           *surface,
                                   const cairo_region_t *damage)
 {
   GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (surface);
-  GdkWaylandDisplay *display;
   cairo_rectangle_int_t rect;
   int i, n;
 
@@ -922,10 +1105,7 @@ gdk_wayland_surface_attach_image (GdkSurface           *surface,
   impl->pending_buffer_offset_x = 0;
   impl->pending_buffer_offset_y = 0;
 
-  /* Only set the buffer scale if supported by the compositor */
-  display = GDK_WAYLAND_DISPLAY (gdk_surface_get_display (surface));
-  if (display->compositor_version >= WL_SURFACE_HAS_BUFFER_SCALE)
-    wl_surface_set_buffer_scale (impl->display_server.wl_surface, impl->scale);
+  gdk_wayland_surface_sync_buffer_scale (surface);
 
   n = cairo_region_num_rectangles (damage);
   for (i = 0; i < n; i++)
@@ -1374,6 +1554,45 @@ static const struct wl_surface_listener surface_listener = {
   surface_leave
 };
 
+#ifdef HAVE_WAYLAND_FRACTIONAL_SCALE
+static void
+fractional_scale_preferred_scale (void                          *data,
+                                  struct wp_fractional_scale_v1 *fractional_scale,
+                                  uint32_t                       scale)
+{
+  GdkSurface *surface = GDK_SURFACE (data);
+  GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (surface);
+  guint32 scale_factor;
+
+  if (impl->preferred_scale == scale)
+    return;
+
+  GDK_DISPLAY_NOTE (gdk_surface_get_display (surface), EVENTS,
+            g_message ("preferred fractional scale %.3f, surface %p", scale / 120.0, surface));
+
+  impl->preferred_scale = scale;
+  scale_factor = MAX (1, (scale + 119) / 120);
+
+  if (scale_factor != impl->scale)
+    {
+      gdk_wayland_surface_maybe_resize (surface,
+                                        surface->width, surface->height,
+                                        scale_factor);
+    }
+  else
+    {
+      /* Only the size of the buffers changes */
+      gdk_wayland_surface_resize_buffers (surface);
+      gdk_surface_invalidate_rect (surface, NULL);
+      _gdk_surface_update_size (surface);
+    }
+}
+
+static const struct wp_fractional_scale_v1_listener fractional_scale_listener = {
+  fractional_scale_preferred_scale
+};
+#endif
+
 static void
 gdk_wayland_surface_create_surface (GdkSurface *surface)
 {
@@ -1386,6 +1605,22 @@ gdk_wayland_surface_create_surface (GdkSurface *surface)
   wl_surface_add_listener (wl_surface, &surface_listener, surface);
 
   impl->display_server.wl_surface = wl_surface;
+
+#ifdef HAVE_WAYLAND_FRACTIONAL_SCALE
+  /* We need both to render at fractional scales */
+  if (display_wayland->viewporter && display_wayland->fractional_scale)
+    {
+      impl->display_server.viewport =
+        wp_viewporter_get_viewport (display_wayland->viewporter, wl_surface);
+      impl->display_server.fractional_scale =
+        wp_fractional_scale_manager_v1_get_fractional_scale (display_wayland->fractional_scale,
+                                                              wl_surface);
+      wl_proxy_set_queue ((struct wl_proxy *) impl->display_server.fractional_scale, impl->event_queue);
+      wp_fractional_scale_v1_add_listener (impl->display_server.fractional_scale,
+                                           &fractional_scale_listener,
+                                           surface);
+    }
+#endif
 }
 
 static void
@@ -3013,6 +3248,15 @@ gdk_wayland_surface_hide_surface (GdkSurface *surface)
           impl->application.was_set = FALSE;
         }
 
+      while (impl->presentation_feedbacks)
+        presentation_feedback_free (impl->presentation_feedbacks->data);
+
+#ifdef HAVE_WAYLAND_FRACTIONAL_SCALE
+      g_clear_pointer (&impl->display_server.fractional_scale, wp_fractional_scale_v1_destroy);
+#endif
+      g_clear_pointer (&impl->display_server.viewport, wp_viewport_destroy);
+      impl->preferred_scale = 0;
+
       wl_surface_destroy (impl->display_server.wl_surface);
       impl->display_server.wl_surface = NULL;
 
@@ -4143,6 +4387,20 @@ gdk_wayland_surface_get_scale_factor (GdkSurface *surface)
   return impl->scale;
 }
 
+static double
+gdk_wayland_surface_get_scale (GdkSurface *surface)
+{
+  GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (surface);
+
+  if (GDK_SURFACE_DESTROYED (surface))
+    return 1.0;
+
+  if (impl->preferred_scale != 0)
+    return impl->preferred_scale / 120.0;
+
+  return impl->scale;
+}
+
 static void
 gdk_wayland_surface_set_opaque_region (GdkSurface     *surface,
                                        cairo_region_t *region)
@@ -4299,6 +4557,7 @@ gdk_wayland_surface_class_init (GdkWaylandSurfaceClass *klass)
   impl_class->destroy_notify = gdk_wayland_surface_destroy_notify;
   impl_class->drag_begin = _gdk_wayland_surface_drag_begin;
   impl_class->get_scale_factor = gdk_wayland_surface_get_scale_factor;
+  impl_class->get_scale = gdk_wayland_surface_get_scale;
   impl_class->set_opaque_region = gdk_wayland_surface_set_opaque_region;
   impl_class->request_layout = gdk_wayland_surface_request_layout;
   impl_class->compute_size = gdk_wayland_surface_compute_size;
@@ -4354,11 +4613,14 @@ gdk_wayland_surface_ensure_wl_egl_window (GdkSurface *surface)
 
   if (impl->display_server.egl_window == NULL)
     {
+      int buffer_width, buffer_height;
+
+      gdk_surface_get_buffer_size (surface, &buffer_width, &buffer_height);
       impl->display_server.egl_window =
         wl_egl_window_create (impl->display_server.wl_surface,
-                              surface->width * impl->scale,
-                              surface->height * impl->scale);
-      wl_surface_set_buffer_scale (impl->display_server.wl_surface, impl->scale);
+                              buffer_width,
+                              buffer_height);
+      gdk_wayland_surface_sync_buffer_scale (surface);
 
       gdk_surface_set_egl_native_window (surface, impl->display_server.egl_window);
     }
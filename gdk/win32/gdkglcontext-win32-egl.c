@@ -78,27 +78,63 @@ reset_egl_force_redraw (GdkSurface *surface)
     }
 }
 
+/* With a flip model swapchain, eglPostSubBufferNV() is a Present1()
+ * with a dirty rectangle, so DWM only has to update that part */
+static gboolean
+gdk_win32_gl_context_egl_post_sub_buffer (GdkGLContext   *context,
+                                          cairo_region_t *painted)
+{
+  GdkSurface *surface = gdk_gl_context_get_surface (context);
+  GdkDisplay *display = gdk_gl_context_get_display (context);
+  cairo_rectangle_int_t extents;
+  int scale, buffer_width, buffer_height;
+
+  if (!display->have_egl_post_sub_buffer || cairo_region_is_empty (painted))
+    return FALSE;
+
+  scale = gdk_surface_get_scale_factor (surface);
+  gdk_surface_get_buffer_size (surface, &buffer_width, &buffer_height);
+  cairo_region_get_extents (painted, &extents);
+
+  /* The origin is in the bottom left corner */
+  return eglPostSubBufferNV (gdk_display_get_egl_display (display),
+                             gdk_surface_get_egl_surface (surface),
+                             extents.x * scale,
+                             buffer_height - (extents.y + extents.height) * scale,
+                             extents.width * scale,
+                             extents.height * scale);
+}
+
+/* ANGLE renders into an offscreen texture that keeps its contents
+ * between frames, so only the newly invalidated area needs repainting */
+static cairo_region_t *
+gdk_win32_gl_context_egl_get_damage (GdkGLContext *context)
+{
+  GdkSurface *surface = gdk_gl_context_get_surface (context);
+  GdkDisplay *display = gdk_gl_context_get_display (context);
+  EGLint swap_behavior;
+
+  if (display->have_egl_win32_libangle &&
+      display->have_egl_post_sub_buffer &&
+      !is_egl_force_redraw (surface) &&
+      eglQuerySurface (gdk_display_get_egl_display (display),
+                       gdk_surface_get_egl_surface (surface),
+                       EGL_SWAP_BEHAVIOR,
+                       &swap_behavior) &&
+      swap_behavior == EGL_BUFFER_PRESERVED)
+    return cairo_region_create ();
+
+  return GDK_GL_CONTEXT_CLASS (gdk_win32_gl_context_egl_parent_class)->get_damage (context);
+}
+
 static void
 gdk_win32_gl_context_egl_end_frame (GdkDrawContext *draw_context,
                                     cairo_region_t *painted)
 {
   GdkGLContext *context = GDK_GL_CONTEXT (draw_context);
-  GdkWin32GLContextEGL *context_egl = GDK_WIN32_GL_CONTEXT_EGL (context);
   GdkSurface *surface = gdk_gl_context_get_surface (context);
-  GdkDisplay *display = gdk_gl_context_get_display (context);
-  cairo_rectangle_int_t whole_window;
-  EGLSurface egl_surface;
-
-  GDK_DRAW_CONTEXT_CLASS (gdk_win32_gl_context_egl_parent_class)->end_frame (draw_context, painted);
 
   gdk_gl_context_make_current (context);
-  whole_window =
-    (GdkRectangle) { 0, 0,
-	                 gdk_surface_get_width (surface),
-					 gdk_surface_get_height (surface)
-                   };
-
-  egl_surface = gdk_surface_get_egl_surface (surface);
 
   if (is_egl_force_redraw (surface))
     {
@@ -110,8 +146,13 @@ gdk_win32_gl_context_egl_end_frame (GdkDrawContext *draw_context,
       gdk_surface_invalidate_rect (surface, &rect);
       reset_egl_force_redraw (surface);
     }
+  else if (gdk_win32_gl_context_egl_post_sub_buffer (context, painted))
+    {
+      return;
+    }
 
-  eglSwapBuffers (gdk_display_get_egl_display (display), egl_surface);
+  /* Swaps the whole buffer */
+  GDK_DRAW_CONTEXT_CLASS (gdk_win32_gl_context_egl_parent_class)->end_frame (draw_context, painted);
 }
 
 static void
@@ -131,6 +172,7 @@ gdk_win32_gl_context_egl_class_init (GdkWin32GLContextClass *klass)
   GdkDrawContextClass *draw_context_class = GDK_DRAW_CONTEXT_CLASS(klass);
 
   context_class->backend_type = GDK_GL_EGL;
+  context_class->get_damage = gdk_win32_gl_context_egl_get_damage;
 
   draw_context_class->begin_frame = gdk_win32_gl_context_egl_begin_frame;
   draw_context_class->end_frame = gdk_win32_gl_context_egl_end_frame;
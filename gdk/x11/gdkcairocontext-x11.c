@@ -29,8 +29,254 @@
 
 #include <X11/Xlib.h>
 
+#ifdef HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
 G_DEFINE_TYPE (GdkX11CairoContext, gdk_x11_cairo_context, GDK_TYPE_CAIRO_CONTEXT)
 
+#ifdef HAVE_XSHM
+
+struct _GdkX11ShmBuffer
+{
+  XShmSegmentInfo shm_info;
+  XImage *image;
+  cairo_surface_t *cairo_surface;
+  /* Serial of the last XShmPutImage() reading from the buffer */
+  gulong serial;
+};
+
+static gboolean
+can_use_shm (GdkX11Display *display_x11)
+{
+  Visual *visual;
+  int depth;
+
+  if (!display_x11->have_shm)
+    return FALSE;
+
+  /* We hand the image data to cairo directly, so it must be in a
+   * format cairo knows about */
+  visual = gdk_x11_display_get_window_visual (display_x11);
+  depth = gdk_x11_display_get_window_depth (display_x11);
+  if ((depth != 24 && depth != 32) ||
+      visual->red_mask != 0xff0000 ||
+      visual->green_mask != 0xff00 ||
+      visual->blue_mask != 0xff)
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+gdk_x11_shm_buffer_free (Display         *xdisplay,
+                         GdkX11ShmBuffer *buffer)
+{
+  cairo_surface_destroy (buffer->cairo_surface);
+  XShmDetach (xdisplay, &buffer->shm_info);
+  XDestroyImage (buffer->image);
+  shmdt (buffer->shm_info.shmaddr);
+  g_free (buffer);
+}
+
+static GdkX11ShmBuffer *
+gdk_x11_shm_buffer_new (GdkSurface *surface)
+{
+  GdkDisplay *display = gdk_surface_get_display (surface);
+  GdkX11Display *display_x11 = GDK_X11_DISPLAY (display);
+  Display *xdisplay = display_x11->xdisplay;
+  GdkX11ShmBuffer *buffer;
+  int scale, depth;
+
+  scale = gdk_surface_get_scale_factor (surface);
+  depth = gdk_x11_display_get_window_depth (display_x11);
+
+  buffer = g_new0 (GdkX11ShmBuffer, 1);
+  buffer->image = XShmCreateImage (xdisplay,
+                                   gdk_x11_display_get_window_visual (display_x11),
+                                   depth,
+                                   ZPixmap,
+                                   NULL,
+                                   &buffer->shm_info,
+                                   MAX (gdk_surface_get_width (surface) * scale, 1),
+                                   MAX (gdk_surface_get_height (surface) * scale, 1));
+  if (buffer->image == NULL)
+    goto fail;
+
+  if (buffer->image->bits_per_pixel != 32 ||
+      buffer->image->byte_order != (G_BYTE_ORDER == G_LITTLE_ENDIAN ? LSBFirst : MSBFirst))
+    goto fail_image;
+
+  buffer->shm_info.shmid = shmget (IPC_PRIVATE,
+                                   buffer->image->bytes_per_line * buffer->image->height,
+                                   IPC_CREAT | 0600);
+  if (buffer->shm_info.shmid == -1)
+    goto fail_image;
+
+  buffer->shm_info.shmaddr = shmat (buffer->shm_info.shmid, NULL, 0);
+  if (buffer->shm_info.shmaddr == (char *) -1)
+    {
+      shmctl (buffer->shm_info.shmid, IPC_RMID, NULL);
+      goto fail_image;
+    }
+
+  buffer->image->data = buffer->shm_info.shmaddr;
+  buffer->shm_info.readOnly = True;
+
+  gdk_x11_display_error_trap_push (display);
+  XShmAttach (xdisplay, &buffer->shm_info);
+  XSync (xdisplay, False);
+  if (gdk_x11_display_error_trap_pop (display))
+    {
+      /* Probably a remote connection. Don't try again. */
+      GDK_DISPLAY_NOTE (display, MISC, g_message ("Attaching shared memory failed, disabling MIT-SHM"));
+      display_x11->have_shm = FALSE;
+      shmdt (buffer->shm_info.shmaddr);
+      shmctl (buffer->shm_info.shmid, IPC_RMID, NULL);
+      goto fail_image;
+    }
+
+  /* The segment stays around until both of us have detached */
+  shmctl (buffer->shm_info.shmid, IPC_RMID, NULL);
+
+  buffer->cairo_surface = cairo_image_surface_create_for_data ((guchar *) buffer->image->data,
+                                                               depth == 32 ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24,
+                                                               buffer->image->width,
+                                                               buffer->image->height,
+                                                               buffer->image->bytes_per_line);
+  cairo_surface_set_device_scale (buffer->cairo_surface, scale, scale);
+
+  return buffer;
+
+fail_image:
+  XDestroyImage (buffer->image);
+fail:
+  g_free (buffer);
+  return NULL;
+}
+
+static void
+gdk_x11_cairo_context_clear_shm_buffers (GdkX11CairoContext *self)
+{
+  GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+  Display *xdisplay = gdk_x11_display_get_xdisplay (display);
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (self->shm_buffers); i++)
+    {
+      if (self->shm_buffers[i] == NULL)
+        continue;
+
+      /* Make sure the server is done reading before we take the memory away */
+      if (XLastKnownRequestProcessed (xdisplay) < self->shm_buffers[i]->serial)
+        XSync (xdisplay, False);
+
+      g_clear_pointer (&self->shm_buffers[i], gdk_x11_shm_buffer_free);
+    }
+}
+
+static gboolean
+gdk_x11_cairo_context_begin_shm_frame (GdkX11CairoContext *self,
+                                       GdkSurface         *surface,
+                                       cairo_region_t     *region)
+{
+  GdkDisplay *display = gdk_surface_get_display (surface);
+  Display *xdisplay = gdk_x11_display_get_xdisplay (display);
+  GdkX11ShmBuffer *buffer;
+  cairo_t *cr;
+  int scale;
+
+  if (!can_use_shm (GDK_X11_DISPLAY (display)))
+    return FALSE;
+
+  /* The scale can change without a resize */
+  scale = gdk_surface_get_scale_factor (surface);
+  buffer = self->shm_buffers[0];
+  if (buffer != NULL &&
+      (buffer->image->width != MAX (gdk_surface_get_width (surface) * scale, 1) ||
+       buffer->image->height != MAX (gdk_surface_get_height (surface) * scale, 1)))
+    gdk_x11_cairo_context_clear_shm_buffers (self);
+
+  buffer = self->shm_buffers[self->next_shm_buffer];
+  if (buffer == NULL)
+    {
+      buffer = gdk_x11_shm_buffer_new (surface);
+      if (buffer == NULL)
+        return FALSE;
+      self->shm_buffers[self->next_shm_buffer] = buffer;
+    }
+  else if (XLastKnownRequestProcessed (xdisplay) < buffer->serial)
+    {
+      /* The server may still be reading from the last frame we put
+       * into this buffer */
+      XSync (xdisplay, False);
+    }
+
+  if (self->shm_gc == NULL)
+    self->shm_gc = XCreateGC (xdisplay, GDK_SURFACE_XID (surface), 0, NULL);
+
+  self->next_shm_buffer = (self->next_shm_buffer + 1) % G_N_ELEMENTS (self->shm_buffers);
+  self->paint_buffer = buffer;
+  self->paint_surface = cairo_surface_reference (buffer->cairo_surface);
+
+  /* Match the fresh surface the fallback path hands out */
+  cr = cairo_create (self->paint_surface);
+  gdk_cairo_region (cr, region);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  return TRUE;
+}
+
+static void
+gdk_x11_cairo_context_end_shm_frame (GdkX11CairoContext *self,
+                                     GdkSurface         *surface,
+                                     cairo_region_t     *painted)
+{
+  GdkDisplay *display = gdk_surface_get_display (surface);
+  Display *xdisplay = gdk_x11_display_get_xdisplay (display);
+  GdkX11ShmBuffer *buffer = self->paint_buffer;
+  int i, n_rects, scale;
+
+  cairo_surface_flush (buffer->cairo_surface);
+  scale = gdk_surface_get_scale_factor (surface);
+
+  n_rects = cairo_region_num_rectangles (painted);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+      int x, y, width, height;
+
+      cairo_region_get_rectangle (painted, i, &rect);
+      x = rect.x * scale;
+      y = rect.y * scale;
+      width = MIN (rect.width * scale, buffer->image->width - x);
+      height = MIN (rect.height * scale, buffer->image->height - y);
+      if (width <= 0 || height <= 0)
+        continue;
+
+      buffer->serial = NextRequest (xdisplay);
+      XShmPutImage (xdisplay,
+                    GDK_SURFACE_XID (surface),
+                    self->shm_gc,
+                    buffer->image,
+                    x, y,
+                    x, y,
+                    width, height,
+                    False);
+    }
+
+  XFlush (xdisplay);
+
+  self->paint_buffer = NULL;
+  g_clear_pointer (&self->paint_surface, cairo_surface_destroy);
+}
+
+#endif /* HAVE_XSHM */
+
 static cairo_surface_t *
 create_cairo_surface_for_surface (GdkSurface *surface)
 {
@@ -64,6 +310,12 @@ gdk_x11_cairo_context_begin_frame (GdkDrawContext *draw_context,
   double sx, sy;
 
   surface = gdk_draw_context_get_surface (draw_context);
+
+#ifdef HAVE_XSHM
+  if (gdk_x11_cairo_context_begin_shm_frame (self, surface, region))
+    return;
+#endif
+
   cairo_region_get_extents (region, &clip_box);
 
   self->window_surface = create_cairo_surface_for_surface (surface);
@@ -84,6 +336,16 @@ gdk_x11_cairo_context_end_frame (GdkDrawContext *draw_context,
   GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (draw_context);
   cairo_t *cr;
 
+#ifdef HAVE_XSHM
+  if (self->paint_buffer)
+    {
+      gdk_x11_cairo_context_end_shm_frame (self,
+                                           gdk_draw_context_get_surface (draw_context),
+                                           painted);
+      return;
+    }
+#endif
+
   cr = cairo_create (self->window_surface);
 
   cairo_set_source_surface (cr, self->paint_surface, 0, 0);
@@ -109,14 +371,47 @@ gdk_x11_cairo_context_cairo_create (GdkCairoContext *context)
   return cairo_create (self->paint_surface);
 }
 
+static void
+gdk_x11_cairo_context_surface_resized (GdkDrawContext *draw_context)
+{
+#ifdef HAVE_XSHM
+  GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (draw_context);
+
+  gdk_x11_cairo_context_clear_shm_buffers (self);
+#endif
+}
+
+static void
+gdk_x11_cairo_context_dispose (GObject *object)
+{
+#ifdef HAVE_XSHM
+  GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (object);
+
+  gdk_x11_cairo_context_clear_shm_buffers (self);
+  if (self->shm_gc)
+    {
+      GdkDisplay *display = gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self));
+
+      XFreeGC (gdk_x11_display_get_xdisplay (display), self->shm_gc);
+      self->shm_gc = NULL;
+    }
+#endif
+
+  G_OBJECT_CLASS (gdk_x11_cairo_context_parent_class)->dispose (object);
+}
+
 static void
 gdk_x11_cairo_context_class_init (GdkX11CairoContextClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GdkDrawContextClass *draw_context_class = GDK_DRAW_CONTEXT_CLASS (klass);
   GdkCairoContextClass *cairo_context_class = GDK_CAIRO_CONTEXT_CLASS (klass);
 
+  gobject_class->dispose = gdk_x11_cairo_context_dispose;
+
   draw_context_class->begin_frame = gdk_x11_cairo_context_begin_frame;
   draw_context_class->end_frame = gdk_x11_cairo_context_end_frame;
+  draw_context_class->surface_resized = gdk_x11_cairo_context_surface_resized;
 
   cairo_context_class->cairo_create = gdk_x11_cairo_context_cairo_create;
 }
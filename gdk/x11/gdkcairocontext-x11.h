@@ -36,6 +36,7 @@ G_BEGIN_DECLS
 
 typedef struct _GdkX11CairoContext GdkX11CairoContext;
 typedef struct _GdkX11CairoContextClass GdkX11CairoContextClass;
+typedef struct _GdkX11ShmBuffer GdkX11ShmBuffer;
 
 struct _GdkX11CairoContext
 {
@@ -43,6 +44,13 @@ struct _GdkX11CairoContext
 
   cairo_surface_t *window_surface;
   cairo_surface_t *paint_surface;
+
+  /* With MIT-SHM, we draw into one of two shared memory images and
+   * upload damaged areas from there */
+  GdkX11ShmBuffer *shm_buffers[2];
+  GdkX11ShmBuffer *paint_buffer;
+  guint next_shm_buffer;
+  gpointer shm_gc;
 };
 
 struct _GdkX11CairoContextClass
@@ -776,6 +776,23 @@ _gdk_x11_device_xi2_get_scroll_delta (GdkX11DeviceXI2    *device,
   return FALSE;
 }
 
+gboolean
+_gdk_x11_device_xi2_is_scroll_valuator (GdkX11DeviceXI2 *device,
+                                        guint            n_valuator)
+{
+  guint i;
+
+  g_return_val_if_fail (GDK_IS_X11_DEVICE_XI2 (device), FALSE);
+
+  for (i = 0; i < device->scroll_valuators->len; i++)
+    {
+      if (g_array_index (device->scroll_valuators, ScrollValuator, i).n_valuator == n_valuator)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 void
 _gdk_device_xi2_reset_scroll_valuators (GdkX11DeviceXI2 *device)
 {
@@ -2183,3 +2183,84 @@ _gdk_x11_device_manager_xi2_lookup (GdkX11DeviceManagerXI2 *device_manager_xi2,
   return g_hash_table_lookup (device_manager_xi2->id_table,
                               GINT_TO_POINTER (device_id));
 }
+
+static gboolean
+is_xi2_motion (GdkX11DeviceManagerXI2 *device_manager,
+               const XEvent           *xevent)
+{
+  return xevent->type == GenericEvent &&
+         xevent->xcookie.extension == device_manager->opcode &&
+         xevent->xcookie.evtype == XI_Motion &&
+         xevent->xcookie.data != NULL;
+}
+
+static gboolean
+has_buttons_pressed (const XIButtonState *buttons)
+{
+  for (int i = 0; i < buttons->mask_len; i++)
+    {
+      if (buttons->mask[i] != 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+has_scroll_valuators (GdkX11DeviceXI2       *device,
+                      const XIValuatorState *valuators)
+{
+  for (int i = 0; i < valuators->mask_len * 8; i++)
+    {
+      if (XIMaskIsSet (valuators->mask, i) &&
+          _gdk_x11_device_xi2_is_scroll_valuator (device, i))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * Whether @xevent is a plain pointer motion that @next, the event
+ * following it, makes obsolete.
+ *
+ * Motion compression would drop such a motion before it is delivered
+ * anyway, since it has no buttons pressed and no tool to keep a history
+ * for, so the event source does not need to translate it at all. Motions
+ * that carry scroll valuators are never superseded, as they turn into
+ * scroll events.
+ */
+gboolean
+_gdk_x11_device_manager_xi2_motion_is_superseded (GdkX11DeviceManagerXI2 *device_manager,
+                                                  const XEvent           *xevent,
+                                                  const XEvent           *next)
+{
+  const XIDeviceEvent *xev, *next_xev;
+  GdkDevice *source_device;
+
+  if (!is_xi2_motion (device_manager, xevent) ||
+      !is_xi2_motion (device_manager, next))
+    return FALSE;
+
+  xev = xevent->xcookie.data;
+  next_xev = next->xcookie.data;
+
+  if (xev->deviceid != next_xev->deviceid ||
+      xev->sourceid != next_xev->sourceid ||
+      xev->event != next_xev->event ||
+      xev->flags != next_xev->flags ||
+      xev->mods.effective != next_xev->mods.effective ||
+      xev->group.effective != next_xev->group.effective)
+    return FALSE;
+
+  if (has_buttons_pressed (&xev->buttons) ||
+      has_buttons_pressed (&next_xev->buttons))
+    return FALSE;
+
+  source_device = g_hash_table_lookup (device_manager->id_table,
+                                       GINT_TO_POINTER (xev->sourceid));
+  if (source_device == NULL || source_device->last_tool != NULL)
+    return FALSE;
+
+  return !has_scroll_valuators (GDK_X11_DEVICE_XI2 (source_device), &xev->valuators);
+}
@@ -71,6 +71,10 @@
 
 #include <X11/extensions/shape.h>
 
+#ifdef HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#endif
+
 #ifdef HAVE_RANDR
 #include <X11/extensions/Xrandr.h>
 #endif
@@ -1616,6 +1620,10 @@ gdk_x11_display_open (const char *display_name)
   }
 #endif
 
+#ifdef HAVE_XSHM
+  display_x11->have_shm = XShmQueryExtension (display_x11->xdisplay);
+#endif
+
 #ifdef HAVE_XDAMAGE
   display_x11->have_damage = FALSE;
   if (XDamageQueryExtension (display_x11->xdisplay,
@@ -3066,6 +3074,10 @@ gdk_x11_display_class_init (GdkX11DisplayClass * class)
    * The ::xevent signal is a low level signal that is emitted
    * whenever an XEvent has been received.
    *
+   * XI2 motion events that are immediately followed by another motion
+   * of the same device, without any change in buttons or modifiers, are
+   * skipped, as they would be compressed away anyway.
+   *
    * When handlers to this signal return %TRUE, no other handlers will be
    * invoked. In particular, the default handler for this function is
    * GDK's own event handling mechanism, so by returning %TRUE for an event
@@ -118,6 +118,10 @@ struct _GdkX11Display
   guint have_input_shapes : 1;
   int shape_event_base;
 
+  /* Set if MIT-SHM is supported and attaching segments worked, which
+   * it doesn't for remote connections */
+  guint have_shm : 1;
+
   GSList *error_traps;
 
   int wm_moveresize_button;
@@ -372,6 +372,39 @@ gdk_event_source_check (GSource *source)
   return retval;
 }
 
+#ifdef HAVE_XGENERICEVENTS
+/* High frequency pointing devices send motions faster than we can draw.
+ * Check whether the next event that was already read from the connection
+ * replaces @xevent, so that translating @xevent can be skipped.
+ */
+static gboolean
+gdk_event_source_is_superseded (GdkDisplay   *display,
+                                const XEvent *xevent)
+{
+  GdkX11Display *x11_display = GDK_X11_DISPLAY (display);
+  Display *xdisplay = x11_display->xdisplay;
+  XEvent next;
+  gboolean superseded;
+
+  if (xevent->type != GenericEvent ||
+      x11_display->device_manager == NULL ||
+      XEventsQueued (xdisplay, QueuedAlready) == 0)
+    return FALSE;
+
+  XPeekEvent (xdisplay, &next);
+
+  if (next.type != GenericEvent)
+    return FALSE;
+
+  XGetEventData (xdisplay, &next.xcookie);
+  superseded = _gdk_x11_device_manager_xi2_motion_is_superseded (x11_display->device_manager,
+                                                                 xevent, &next);
+  XFreeEventData (xdisplay, &next.xcookie);
+
+  return superseded;
+}
+#endif
+
 void
 _gdk_x11_display_queue_events (GdkDisplay *display)
 {
@@ -399,6 +432,13 @@ _gdk_x11_display_queue_events (GdkDisplay *display)
        */
       if (xevent.type == GenericEvent)
         XGetEventData (xdisplay, &xevent.xcookie);
+
+      /* Drain bursts of motion in one go, only translating the last */
+      if (gdk_event_source_is_superseded (display, &xevent))
+        {
+          XFreeEventData (xdisplay, &xevent.xcookie);
+          continue;
+        }
 #endif
 
       g_signal_emit_by_name (display, "xevent", &xevent, &unused);
@@ -147,6 +147,9 @@ void     _gdk_device_xi2_unset_scroll_valuators   (GdkX11DeviceXI2 *device);
 
 GdkDevice * _gdk_x11_device_manager_xi2_lookup    (GdkX11DeviceManagerXI2 *device_manager_xi2,
                                                    int                     device_id);
+gboolean _gdk_x11_device_manager_xi2_motion_is_superseded (GdkX11DeviceManagerXI2 *device_manager_xi2,
+                                                           const XEvent           *xevent,
+                                                           const XEvent           *next);
 void     _gdk_x11_device_xi2_add_scroll_valuator  (GdkX11DeviceXI2    *device,
                                                    guint               n_valuator,
                                                    GdkScrollDirection  direction,
@@ -156,6 +159,8 @@ gboolean  _gdk_x11_device_xi2_get_scroll_delta    (GdkX11DeviceXI2    *device,
                                                    double              valuator_value,
                                                    GdkScrollDirection *direction_ret,
                                                    double             *delta_ret);
+gboolean  _gdk_x11_device_xi2_is_scroll_valuator (GdkX11DeviceXI2    *device,
+                                                   guint               n_valuator);
 void     _gdk_device_xi2_reset_scroll_valuators   (GdkX11DeviceXI2    *device);
 
 double   gdk_x11_device_xi2_get_last_axis_value (GdkX11DeviceXI2 *device,
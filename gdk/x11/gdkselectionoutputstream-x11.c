@@ -54,9 +54,22 @@ struct _GdkX11SelectionOutputStreamPrivate {
   GByteArray *data;
   guint flush_requested : 1;
 
+  /* Size of the next INCR chunk. We start out with the size used for
+   * the property buffer and double it for every full chunk the
+   * requestor picked up, up to what the server accepts in a single
+   * request. This keeps small transfers snappy and large ones from
+   * spending all their time in round trips. */
+  gsize chunk_size;
+  gsize max_chunk_size;
+
   GTask *pending_task;
+  /* The caller's buffer of pending_task, if it is written without
+   * copying it into data first */
+  const guchar *pending_buffer;
+  gsize pending_buffer_size;
 
   guint incr : 1;
+  guint last_chunk_full : 1;
   guint sent_end_of_stream : 1;
   guint delete_pending : 1; /* owns a reference */
 };
@@ -180,6 +193,9 @@ gdk_x11_selection_output_stream_needs_flush_unlocked (GdkX11SelectionOutputStrea
   if (priv->sent_end_of_stream)
     return FALSE;
 
+  if (priv->pending_buffer)
+    return TRUE;
+
   if (g_output_stream_is_closing (G_OUTPUT_STREAM (stream)) ||
       g_output_stream_is_closed (G_OUTPUT_STREAM (stream)))
     return TRUE;
@@ -190,7 +206,26 @@ gdk_x11_selection_output_stream_needs_flush_unlocked (GdkX11SelectionOutputStrea
   if (priv->flush_requested)
     return TRUE;
 
-  return priv->data->len >= gdk_x11_display_get_max_request_size (priv->display);
+  return priv->data->len >= priv->chunk_size;
+}
+
+/* Writers may fill up the next chunk while the requestor is still
+ * fetching the current one. They only block once that is done, too.
+ */
+static gboolean
+gdk_x11_selection_output_stream_is_full_unlocked (GdkX11SelectionOutputStream *stream)
+{
+  GdkX11SelectionOutputStreamPrivate *priv = gdk_x11_selection_output_stream_get_instance_private (stream);
+
+  if (!gdk_x11_selection_output_stream_needs_flush_unlocked (stream))
+    return FALSE;
+
+  if (g_output_stream_is_closing (G_OUTPUT_STREAM (stream)) ||
+      g_output_stream_is_closed (G_OUTPUT_STREAM (stream)) ||
+      priv->flush_requested)
+    return TRUE;
+
+  return priv->data->len >= 2 * priv->chunk_size;
 }
 
 static gboolean
@@ -229,12 +264,29 @@ get_element_size (int format)
     }
 }
 
+static gsize
+get_max_chunk_size (GdkDisplay *display)
+{
+  Display *xdisplay = GDK_DISPLAY_XDISPLAY (display);
+  gsize size;
+
+  /* in units of 4 bytes */
+  size = XExtendedMaxRequestSize (xdisplay);
+  if (size <= 0)
+    size = XMaxRequestSize (xdisplay);
+
+  size = MIN (16 * 1024 * 1024, size * 4 - 100);
+
+  return MAX (size, gdk_x11_display_get_max_request_size (display));
+}
+
 static void
 gdk_x11_selection_output_stream_perform_flush (GdkX11SelectionOutputStream *stream)
 {
   GdkX11SelectionOutputStreamPrivate *priv = gdk_x11_selection_output_stream_get_instance_private (stream);
   Display *xdisplay;
-  gsize element_size, n_elements;
+  const guchar *data;
+  gsize element_size, n_elements, len;
   int error;
 
   g_assert (!priv->delete_pending);
@@ -246,10 +298,28 @@ gdk_x11_selection_output_stream_perform_flush (GdkX11SelectionOutputStream *stre
 
   g_mutex_lock (&priv->mutex);
 
+  if (priv->last_chunk_full)
+    {
+      priv->chunk_size = MIN (2 * priv->chunk_size, priv->max_chunk_size);
+      priv->last_chunk_full = FALSE;
+    }
+
+  if (priv->data->len == 0 && priv->pending_buffer)
+    {
+      data = priv->pending_buffer;
+      len = priv->pending_buffer_size;
+    }
+  else
+    {
+      data = priv->data->data;
+      len = priv->data->len;
+    }
+
   element_size = get_element_size (priv->format);
-  n_elements = priv->data->len / element_size;
+  n_elements = len / element_size;
 
-  if (priv->notify && !g_output_stream_is_closing (G_OUTPUT_STREAM (stream)))
+  if (priv->notify &&
+      (!g_output_stream_is_closing (G_OUTPUT_STREAM (stream)) || len > priv->chunk_size))
     {
       XWindowAttributes attrs;
 
@@ -276,17 +346,33 @@ gdk_x11_selection_output_stream_perform_flush (GdkX11SelectionOutputStream *stre
     }
   else
     {
+      if (priv->incr)
+        {
+          n_elements = MIN (n_elements, priv->chunk_size / element_size);
+          priv->last_chunk_full = n_elements == priv->chunk_size / element_size;
+        }
+
       XChangeProperty (GDK_DISPLAY_XDISPLAY (priv->display),
                        priv->xwindow,
                        priv->xproperty, 
                        priv->xtype,
                        priv->format,
                        PropModeReplace,
-                       priv->data->data,
+                       data,
                        n_elements);
-      GDK_DISPLAY_NOTE (priv->display, SELECTION, g_printerr ("%s:%s: wrote %zu/%u bytes\n",
-                                      priv->selection, priv->target, n_elements * element_size, priv->data->len));
-      g_byte_array_remove_range (priv->data, 0, n_elements * element_size);
+      GDK_DISPLAY_NOTE (priv->display, SELECTION, g_printerr ("%s:%s: wrote %zu/%zu bytes%s\n",
+                                      priv->selection, priv->target, n_elements * element_size, len,
+                                      data == priv->pending_buffer ? " without copying" : ""));
+      if (data == priv->pending_buffer)
+        {
+          g_task_set_task_data (priv->pending_task, GSIZE_TO_POINTER (n_elements * element_size), NULL);
+          priv->pending_buffer = NULL;
+          priv->pending_buffer_size = 0;
+        }
+      else
+        {
+          g_byte_array_remove_range (priv->data, 0, n_elements * element_size);
+        }
       if (priv->data->len < element_size)
         priv->flush_requested = FALSE;
       if (!priv->incr || n_elements == 0)
@@ -312,7 +398,9 @@ gdk_x11_selection_output_stream_perform_flush (GdkX11SelectionOutputStream *stre
                                       priv->selection, priv->target, error));
     }
 
-  if (priv->pending_task)
+  /* A zero-copy write that only got the INCR header out needs to wait
+   * for the next round */
+  if (priv->pending_task && priv->pending_buffer == NULL)
     {
       g_task_return_int (priv->pending_task, GPOINTER_TO_SIZE (g_task_get_task_data (priv->pending_task)));
       g_object_unref (priv->pending_task);
@@ -351,7 +439,7 @@ gdk_x11_selection_output_stream_write (GOutputStream  *output_stream,
   g_main_context_invoke (NULL, gdk_x11_selection_output_stream_invoke_flush, stream);
 
   g_mutex_lock (&priv->mutex);
-  if (gdk_x11_selection_output_stream_needs_flush_unlocked (stream))
+  if (gdk_x11_selection_output_stream_is_full_unlocked (stream))
     g_cond_wait (&priv->cond, &priv->mutex);
   g_mutex_unlock (&priv->mutex);
 
@@ -370,15 +458,37 @@ gdk_x11_selection_output_stream_write_async (GOutputStream        *output_stream
   GdkX11SelectionOutputStream *stream = GDK_X11_SELECTION_OUTPUT_STREAM (output_stream);
   GdkX11SelectionOutputStreamPrivate *priv = gdk_x11_selection_output_stream_get_instance_private (stream);
   GTask *task;
+  gboolean is_full;
   
   task = g_task_new (stream, cancellable, callback, user_data);
   g_task_set_source_tag (task, gdk_x11_selection_output_stream_write_async);
   g_task_set_priority (task, io_priority);
 
   g_mutex_lock (&priv->mutex);
+  if (priv->data->len == 0 && count >= priv->chunk_size)
+    {
+      /* Large writes, like the ones for GBytes contents, are put
+       * into the property straight from the caller's buffer, which
+       * stays valid until we return a result. We write one chunk
+       * and report a short write, so write_all() comes back for
+       * the rest. */
+      g_assert (priv->pending_task == NULL);
+      priv->pending_task = task;
+      priv->pending_buffer = buffer;
+      priv->pending_buffer_size = count;
+      g_mutex_unlock (&priv->mutex);
+
+      GDK_NOTE (SELECTION, g_printerr ("%s:%s: async writing %zu bytes without copying\n",
+                                      priv->selection, priv->target, count));
+
+      if (gdk_x11_selection_output_stream_can_flush (stream))
+        gdk_x11_selection_output_stream_perform_flush (stream);
+      return;
+    }
   g_byte_array_append (priv->data, buffer, count);
   GDK_NOTE (SELECTION, g_printerr ("%s:%s: async wrote %zu bytes, %u total now\n",
                                   priv->selection, priv->target, count, priv->data->len));
+  is_full = gdk_x11_selection_output_stream_is_full_unlocked (stream);
   g_mutex_unlock (&priv->mutex);
 
   if (!gdk_x11_selection_output_stream_needs_flush (stream))
@@ -389,6 +499,14 @@ gdk_x11_selection_output_stream_write_async (GOutputStream        *output_stream
     }
   else if (!gdk_x11_selection_output_stream_can_flush (stream))
     {
+      if (!is_full)
+        {
+          /* Keep the producer going while the requestor reads */
+          g_task_return_int (task, count);
+          g_object_unref (task);
+          return;
+        }
+
       g_assert (priv->pending_task == NULL);
       priv->pending_task = task;
       g_task_set_task_data (task, GSIZE_TO_POINTER (count), NULL);
@@ -625,6 +743,8 @@ gdk_x11_selection_output_stream_new (GdkDisplay                   *display,
   priv->xtype = gdk_x11_get_xatom_by_name_for_display (display, priv->type);
   priv->format = format;
   priv->timestamp = timestamp;
+  priv->chunk_size = gdk_x11_display_get_max_request_size (display);
+  priv->max_chunk_size = get_max_chunk_size (display);
 
   g_signal_connect (display,
                     "xevent",
@@ -20,9 +20,12 @@ struct _GskBroadwayRenderer
   GArray *nodes;              /* Owned by draw_contex */
   GPtrArray *node_textures;   /* Owned by draw_contex */
   GHashTable *node_lookup;
+  GHashTable *content_lookup; /* Set of the nodes in node_lookup, by fingerprint */
+  GHashTable *used_ids;       /* Ids of the last frame that were reused */
 
   /* Kept from last frame */
   GHashTable *last_node_lookup;
+  GHashTable *last_content_lookup;
   GskRenderNode *last_root; /* Owning refs to the things in last_node_lookup */
 };
 
@@ -220,6 +223,47 @@ static void
 collect_reused_child_nodes (GskRenderer *renderer,
                             GskRenderNode *node);
 
+/* Nodes that were sent in the last frame are also found by their
+ * fingerprint, so subtrees that were snapshotted again but did not
+ * change do not have to be sent again.
+ */
+static guint
+node_content_hash (gconstpointer key)
+{
+  guint64 hash = gsk_render_node_get_hash ((GskRenderNode *) key);
+
+  return (guint) (hash ^ (hash >> 32));
+}
+
+static gboolean
+node_content_equal (gconstpointer a,
+                    gconstpointer b)
+{
+  return gsk_render_node_get_hash ((GskRenderNode *) a) ==
+         gsk_render_node_get_hash ((GskRenderNode *) b);
+}
+
+static void
+remember_node (GskBroadwayRenderer *self,
+               GskRenderNode       *node,
+               guint32              id)
+{
+  g_hash_table_insert (self->node_lookup, node, GINT_TO_POINTER (id));
+
+  if (gsk_render_node_get_hash (node) != 0)
+    g_hash_table_add (self->content_lookup, node);
+}
+
+/* Every old id may only be reused once per frame, the same node
+ * can not be in two places of the tree.
+ */
+static gboolean
+claim_old_id (GskBroadwayRenderer *self,
+              guint32              old_id)
+{
+  return g_hash_table_add (self->used_ids, GINT_TO_POINTER (old_id));
+}
+
 static void
 collect_reused_node (GskRenderer *renderer,
                      GskRenderNode *node)
@@ -229,11 +273,75 @@ collect_reused_node (GskRenderer *renderer,
 
   if (self->last_node_lookup &&
       (old_id = GPOINTER_TO_INT(g_hash_table_lookup (self->last_node_lookup, node))) != 0)
-    g_hash_table_insert (self->node_lookup, node, GINT_TO_POINTER (old_id));
+    {
+      claim_old_id (self, old_id);
+      remember_node (self, node, old_id);
+    }
 
   collect_reused_child_nodes (renderer, node);
 }
 
+static GskRenderNode *
+get_child (GskRenderNode *node,
+           guint          i)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_SHADOW_NODE:
+      return gsk_shadow_node_get_child (node);
+    case GSK_OPACITY_NODE:
+      return gsk_opacity_node_get_child (node);
+    case GSK_ROUNDED_CLIP_NODE:
+      return gsk_rounded_clip_node_get_child (node);
+    case GSK_CLIP_NODE:
+      return gsk_clip_node_get_child (node);
+    case GSK_TRANSFORM_NODE:
+      return gsk_transform_node_get_child (node);
+    case GSK_DEBUG_NODE:
+      return gsk_debug_node_get_child (node);
+    case GSK_CONTAINER_NODE:
+      if (i < gsk_container_node_get_n_children (node))
+        return gsk_container_node_get_child (node, i);
+      return NULL;
+    default:
+      return NULL;
+    }
+}
+
+/* Like collect_reused_node(), for a node that reuses @old_node
+ * because it has the same contents. The old ids of the children
+ * are found by walking both trees at once.
+ */
+static void
+collect_reused_content_node (GskRenderer   *renderer,
+                             GskRenderNode *node,
+                             GskRenderNode *old_node)
+{
+  GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (renderer);
+  GskRenderNode *child, *old_child;
+  guint32 old_id;
+  guint i;
+
+  old_id = GPOINTER_TO_INT (g_hash_table_lookup (self->last_node_lookup, old_node));
+  if (old_id != 0)
+    {
+      claim_old_id (self, old_id);
+      remember_node (self, node, old_id);
+    }
+
+  for (i = 0; (child = get_child (node, i)) != NULL; i++)
+    {
+      old_child = get_child (old_node, i);
+      if (old_child == NULL)
+        break;
+
+      collect_reused_content_node (renderer, child, old_child);
+
+      if (gsk_render_node_get_node_type (node) != GSK_CONTAINER_NODE)
+        break;
+    }
+}
+
 
 static void
 collect_reused_child_nodes (GskRenderer *renderer,
@@ -360,20 +468,37 @@ add_new_node (GskRenderer *renderer,
               graphene_rect_t *clip_bounds)
 {
   GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (renderer);
+  GskRenderNode *old_node;
   guint32 id, old_id;
 
   if (self->last_node_lookup &&
-      (old_id = GPOINTER_TO_INT (g_hash_table_lookup (self->last_node_lookup, node))) != 0)
+      (old_id = GPOINTER_TO_INT (g_hash_table_lookup (self->last_node_lookup, node))) != 0 &&
+      claim_old_id (self, old_id))
     {
       add_uint32 (self->nodes, BROADWAY_NODE_REUSE);
       add_uint32 (self->nodes, old_id);
 
-      g_hash_table_insert (self->node_lookup, node, GINT_TO_POINTER(old_id));
+      remember_node (self, node, old_id);
       collect_reused_child_nodes (renderer, node);
 
       return FALSE;
     }
 
+  if (self->last_content_lookup &&
+      gsk_render_node_get_hash (node) != 0 &&
+      g_hash_table_lookup_extended (self->last_content_lookup, node, (gpointer *) &old_node, NULL) &&
+      (old_id = GPOINTER_TO_INT (g_hash_table_lookup (self->last_node_lookup, old_node))) != 0 &&
+      !g_hash_table_contains (self->used_ids, GINT_TO_POINTER (old_id)))
+    {
+      add_uint32 (self->nodes, BROADWAY_NODE_REUSE);
+      add_uint32 (self->nodes, old_id);
+
+      g_hash_table_remove (self->last_content_lookup, old_node);
+      collect_reused_content_node (renderer, node, old_node);
+
+      return FALSE;
+    }
+
   id = ++self->next_node_id;
 
   /* Never try to reuse partially visible container types the next
@@ -389,7 +514,7 @@ add_new_node (GskRenderer *renderer,
    */
   if (!node_type_is_container (type) ||
       node_is_fully_visible (node, clip_bounds))
-    g_hash_table_insert (self->node_lookup, node, GINT_TO_POINTER(id));
+    remember_node (self, node, id);
 
   add_uint32 (self->nodes, type);
   add_uint32 (self->nodes, id);
@@ -905,6 +1030,8 @@ gsk_broadway_renderer_render (GskRenderer          *renderer,
   GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (renderer);
 
   self->node_lookup = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->content_lookup = g_hash_table_new (node_content_hash, node_content_equal);
+  self->used_ids = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   gdk_draw_context_begin_frame (GDK_DRAW_CONTEXT (self->draw_context), update_area);
 
@@ -925,6 +1052,13 @@ gsk_broadway_renderer_render (GskRenderer          *renderer,
   self->last_node_lookup = self->node_lookup;
   self->node_lookup = NULL;
 
+  if (self->last_content_lookup)
+    g_hash_table_unref (self->last_content_lookup);
+  self->last_content_lookup = self->content_lookup;
+  self->content_lookup = NULL;
+
+  g_clear_pointer (&self->used_ids, g_hash_table_unref);
+
   if (self->last_root)
     gsk_render_node_unref (self->last_root);
   self->last_root = gsk_render_node_ref (root);
@@ -936,6 +1070,7 @@ gsk_broadway_renderer_render (GskRenderer          *renderer,
        * without risk of any old nodes sticking around and conflicting. */
 
       g_hash_table_remove_all (self->last_node_lookup);
+      g_hash_table_remove_all (self->last_content_lookup);
       self->next_node_id = 0;
     }
 }
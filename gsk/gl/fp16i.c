@@ -46,10 +46,12 @@ half_to_float4_f16c (const guint16 h[4],
   __m128i i = _mm_loadl_epi64 (CAST_M128I_P (h));
   __m128 s = _mm_cvtph_ps (i);
 
-  _mm_store_ps (f, s);
+  _mm_storeu_ps (f, s);
 }
 
-#define ALIGNED(p, n) (GPOINTER_TO_UINT(p) % n == 0)
+/* The loads and stores are unaligned, the float and half arrays
+ * are rarely aligned to 16 bytes at the same index.
+ */
 void
 float_to_half_f16c (const float *f,
                     guint16     *h,
@@ -58,30 +60,16 @@ float_to_half_f16c (const float *f,
   __m128 s;
   __m128i i;
   int j;
-  const float *ff = f;
-  guint16 *hh = h;
-
-  for (j = 0; j < n; j++)
-    {
-      if (ALIGNED (ff, 16) && ALIGNED (hh, 16))
-        break;
-      ff++;
-      hh++;
-    }
-
-  float_to_half_c (f, h, j);
 
-  for (; j + 4 < n; j += 4)
+  for (j = 0; j + 4 <= n; j += 4)
     {
-      s = _mm_loadu_ps (ff);
+      s = _mm_loadu_ps (f + j);
       i = _mm_cvtps_ph (s, 0);
-      _mm_storel_epi64 ((__m128i*)hh, i);
-      ff += 4;
-      hh += 4;
+      _mm_storel_epi64 ((__m128i*)(h + j), i);
     }
 
   if (j < n)
-    float_to_half_c (ff, hh, n - j);
+    float_to_half_c (f + j, h + j, n - j);
 }
 
 void
@@ -92,30 +80,16 @@ half_to_float_f16c (const guint16 *h,
   __m128i i;
   __m128 s;
   int j;
-  const guint16 *hh = h;
-  float *ff = f;
-
-  for (j = 0; j < n; j++)
-    {
-      if (ALIGNED (ff, 16) && ALIGNED (hh, 16))
-        break;
-      ff++;
-      hh++;
-    }
-
-  half_to_float_c (h, f, j);
 
-  for (; j + 4 < n; j += 4)
+  for (j = 0; j + 4 <= n; j += 4)
     {
-      i = _mm_loadl_epi64 (CAST_M128I_P (hh));
+      i = _mm_loadl_epi64 (CAST_M128I_P (&h[j]));
       s = _mm_cvtph_ps (i);
-      _mm_store_ps (ff, s);
-      hh += 4;
-      ff += 4;
+      _mm_storeu_ps (f + j, s);
     }
 
   if (j < n)
-    half_to_float_c (hh, ff, n - j);
+    half_to_float_c (h + j, f + j, n - j);
 }
 
 #endif  /* HAVE_F16C */
@@ -47,14 +47,217 @@ gsk_gl_buffer_init (GskGLBuffer *self,
   self->element_size = element_size;
 }
 
+#define PERSISTENT_MAP_FLAGS (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT)
+
+static gboolean
+gsk_gl_buffer_slot_alloc (GskGLBuffer     *self,
+                          GskGLBufferSlot *slot,
+                          gsize            size)
+{
+  g_assert (slot->id == 0);
+  g_assert (slot->fence == NULL);
+
+  glGenBuffers (1, &slot->id);
+  glBindBuffer (self->target, slot->id);
+  glBufferStorage (self->target, size, NULL, PERSISTENT_MAP_FLAGS);
+  slot->mapped = glMapBufferRange (self->target, 0, size, PERSISTENT_MAP_FLAGS);
+  slot->size = size;
+
+  if (slot->mapped == NULL)
+    {
+      glDeleteBuffers (1, &slot->id);
+      slot->id = 0;
+      slot->size = 0;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+gsk_gl_buffer_slot_free (GskGLBuffer     *self,
+                         GskGLBufferSlot *slot)
+{
+  if (slot->fence != NULL)
+    {
+      glDeleteSync (slot->fence);
+      slot->fence = NULL;
+    }
+
+  if (slot->id != 0)
+    {
+      glBindBuffer (self->target, slot->id);
+      glUnmapBuffer (self->target);
+      glDeleteBuffers (1, &slot->id);
+      slot->id = 0;
+    }
+
+  slot->mapped = NULL;
+  slot->size = 0;
+}
+
+static void
+gsk_gl_buffer_slot_wait (GskGLBufferSlot *slot)
+{
+  GLenum status;
+
+  if (slot->fence == NULL)
+    return;
+
+  do
+    status = glClientWaitSync (slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, G_TIME_SPAN_SECOND * 1000);
+  while (status == GL_TIMEOUT_EXPIRED);
+
+  glDeleteSync (slot->fence);
+  slot->fence = NULL;
+}
+
+/* Drops the persistent mappings and continues with a heap allocated
+ * buffer, preserving any content that was already written.
+ */
+static void
+gsk_gl_buffer_disable_persistent (GskGLBuffer *self)
+{
+  guint8 *buffer;
+
+  buffer = g_malloc (self->buffer_len);
+  if (self->buffer_pos > 0)
+    memcpy (buffer, self->buffer, self->buffer_pos);
+
+  for (guint i = 0; i < GSK_GL_BUFFER_N_SLOTS; i++)
+    {
+      gsk_gl_buffer_slot_wait (&self->slots[i]);
+      gsk_gl_buffer_slot_free (self, &self->slots[i]);
+    }
+
+  self->buffer = buffer;
+  self->persistent = FALSE;
+}
+
+/**
+ * gsk_gl_buffer_enable_persistent:
+ * @self: a `GskGLBuffer`
+ *
+ * Switches @self to write directly into persistently mapped GL buffers.
+ *
+ * A ring of %GSK_GL_BUFFER_N_SLOTS buffers is used so that writing the
+ * next frame doesn't have to wait for the GPU to finish reading the
+ * previous one. This avoids the copy into, and orphaning of, a fresh
+ * buffer object for every call to gsk_gl_buffer_submit().
+ *
+ * The GL context must be current and support `GL_ARB_buffer_storage`.
+ * This fails if anything has been written to @self since the last
+ * submit.
+ *
+ * Returns: %TRUE if persistent mapping is in use
+ */
+gboolean
+gsk_gl_buffer_enable_persistent (GskGLBuffer *self)
+{
+  GskGLBufferSlot *slot;
+
+  if (self->persistent)
+    return TRUE;
+
+  /* The contents written so far live in the heap buffer */
+  if (self->buffer_pos > 0)
+    return FALSE;
+
+  slot = &self->slots[0];
+
+  if (!gsk_gl_buffer_slot_alloc (self, slot, self->buffer_len))
+    return FALSE;
+
+  g_clear_pointer (&self->buffer, g_free);
+
+  self->persistent = TRUE;
+  self->current_slot = 0;
+  self->buffer = slot->mapped;
+  self->buffer_len = slot->size;
+
+  return TRUE;
+}
+
+/**
+ * gsk_gl_buffer_grow:
+ * @buffer: a `GskGLBuffer`
+ * @min_len: the minimum number of bytes needed
+ *
+ * Grows @buffer so that at least @min_len bytes may be written,
+ * keeping the contents written so far.
+ *
+ * For persistently mapped buffers the GL context must be current.
+ */
+void
+gsk_gl_buffer_grow (GskGLBuffer *buffer,
+                    gsize        min_len)
+{
+  gsize buffer_len = buffer->buffer_len;
+
+  while (min_len > buffer_len)
+    buffer_len *= 2;
+
+  if (buffer->persistent)
+    {
+      GskGLBufferSlot *slot = &buffer->slots[buffer->current_slot];
+      GskGLBufferSlot old = *slot;
+
+      /* The current slot is never in use by the GPU while we write
+       * to it, so we can replace its storage right away.
+       */
+      *slot = (GskGLBufferSlot) {0};
+
+      if (gsk_gl_buffer_slot_alloc (buffer, slot, buffer_len))
+        {
+          if (buffer->buffer_pos > 0)
+            memcpy (slot->mapped, old.mapped, buffer->buffer_pos);
+          gsk_gl_buffer_slot_free (buffer, &old);
+
+          buffer->buffer = slot->mapped;
+          buffer->buffer_len = slot->size;
+
+          return;
+        }
+
+      *slot = old;
+      gsk_gl_buffer_disable_persistent (buffer);
+    }
+
+  buffer->buffer_len = buffer_len;
+  buffer->buffer = g_realloc (buffer->buffer, buffer->buffer_len);
+}
+
+/**
+ * gsk_gl_buffer_submit:
+ * @buffer: a `GskGLBuffer`
+ *
+ * Makes the contents of @buffer available to the GPU and binds the
+ * resulting buffer object to the target of @buffer.
+ *
+ * Once the draws using the buffer have been issued, the buffer object
+ * must be passed to gsk_gl_buffer_retire().
+ *
+ * Returns: the GL buffer object
+ */
 GLuint
 gsk_gl_buffer_submit (GskGLBuffer *buffer)
 {
   GLuint id;
 
-  glGenBuffers (1, &id);
-  glBindBuffer (buffer->target, id);
-  glBufferData (buffer->target, buffer->buffer_pos, buffer->buffer, GL_STATIC_DRAW);
+  if (buffer->persistent)
+    {
+      /* Writes to a coherent mapping are visible to the GPU without
+       * any further flushing, so there is nothing to copy.
+       */
+      id = buffer->slots[buffer->current_slot].id;
+      glBindBuffer (buffer->target, id);
+    }
+  else
+    {
+      glGenBuffers (1, &id);
+      glBindBuffer (buffer->target, id);
+      glBufferData (buffer->target, buffer->buffer_pos, buffer->buffer, GL_STATIC_DRAW);
+    }
 
   buffer->buffer_pos = 0;
   buffer->count = 0;
@@ -62,8 +265,65 @@ gsk_gl_buffer_submit (GskGLBuffer *buffer)
   return id;
 }
 
+/**
+ * gsk_gl_buffer_retire:
+ * @buffer: a `GskGLBuffer`
+ * @id: the buffer object returned from gsk_gl_buffer_submit()
+ *
+ * Notes that all draws using @id have been issued.
+ *
+ * For persistently mapped buffers a fence is inserted and writing
+ * continues in the next slot of the ring, waiting for the GPU to be
+ * done with it if necessary. Otherwise the buffer object is deleted.
+ */
+void
+gsk_gl_buffer_retire (GskGLBuffer *buffer,
+                      GLuint       id)
+{
+  GskGLBufferSlot *slot;
+  gsize size;
+
+  if (!buffer->persistent)
+    {
+      glDeleteBuffers (1, &id);
+      return;
+    }
+
+  slot = &buffer->slots[buffer->current_slot];
+  g_assert (slot->id == id);
+  g_assert (slot->fence == NULL);
+
+  slot->fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  size = slot->size;
+
+  buffer->current_slot = (buffer->current_slot + 1) % GSK_GL_BUFFER_N_SLOTS;
+  slot = &buffer->slots[buffer->current_slot];
+
+  gsk_gl_buffer_slot_wait (slot);
+
+  if (slot->id == 0 && !gsk_gl_buffer_slot_alloc (buffer, slot, size))
+    {
+      /* Go back to the slot we just used, it is still the right size */
+      buffer->current_slot = (buffer->current_slot + GSK_GL_BUFFER_N_SLOTS - 1) % GSK_GL_BUFFER_N_SLOTS;
+      buffer->buffer = buffer->slots[buffer->current_slot].mapped;
+      gsk_gl_buffer_disable_persistent (buffer);
+      return;
+    }
+
+  buffer->buffer = slot->mapped;
+  buffer->buffer_len = slot->size;
+}
+
 void
 gsk_gl_buffer_destroy (GskGLBuffer *buffer)
 {
+  if (buffer->persistent)
+    {
+      for (guint i = 0; i < GSK_GL_BUFFER_N_SLOTS; i++)
+        gsk_gl_buffer_slot_free (buffer, &buffer->slots[i]);
+      buffer->buffer = NULL;
+      buffer->persistent = FALSE;
+    }
+
   g_clear_pointer (&buffer->buffer, g_free);
 }
@@ -25,6 +25,16 @@
 
 G_BEGIN_DECLS
 
+#define GSK_GL_BUFFER_N_SLOTS 3
+
+typedef struct _GskGLBufferSlot
+{
+  GLuint  id;
+  GLsync  fence;
+  guint8 *mapped;
+  gsize   size;
+} GskGLBufferSlot;
+
 typedef struct _GskGLBuffer
 {
   guint8 *buffer;
@@ -33,13 +43,26 @@ typedef struct _GskGLBuffer
   guint   count;
   GLenum  target;
   gsize   element_size;
+
+  /* Persistently mapped storage, used instead of @buffer being a heap
+   * allocation when the GL implementation supports buffer storage.
+   * @buffer then points into the mapping of the current slot.
+   */
+  GskGLBufferSlot slots[GSK_GL_BUFFER_N_SLOTS];
+  guint           current_slot : 2;
+  guint           persistent : 1;
 } GskGLBuffer;
 
-void   gsk_gl_buffer_init    (GskGLBuffer *self,
-                              GLenum       target,
-                              guint        element_size);
-void   gsk_gl_buffer_destroy (GskGLBuffer *buffer);
-GLuint gsk_gl_buffer_submit  (GskGLBuffer *buffer);
+void     gsk_gl_buffer_init              (GskGLBuffer *self,
+                                          GLenum       target,
+                                          guint        element_size);
+gboolean gsk_gl_buffer_enable_persistent (GskGLBuffer *self);
+void     gsk_gl_buffer_destroy           (GskGLBuffer *buffer);
+void     gsk_gl_buffer_grow              (GskGLBuffer *buffer,
+                                          gsize        min_len);
+GLuint   gsk_gl_buffer_submit            (GskGLBuffer *buffer);
+void     gsk_gl_buffer_retire            (GskGLBuffer *buffer,
+                                          GLuint       id);
 
 static inline gpointer
 gsk_gl_buffer_advance (GskGLBuffer *buffer,
@@ -49,11 +72,7 @@ gsk_gl_buffer_advance (GskGLBuffer *buffer,
   gsize to_alloc = count * buffer->element_size;
 
   if G_UNLIKELY (buffer->buffer_pos + to_alloc > buffer->buffer_len)
-    {
-      while (buffer->buffer_pos + to_alloc > buffer->buffer_len)
-        buffer->buffer_len *= 2;
-      buffer->buffer = g_realloc (buffer->buffer, buffer->buffer_len);
-    }
+    gsk_gl_buffer_grow (buffer, buffer->buffer_pos + to_alloc);
 
   ret = buffer->buffer + buffer->buffer_pos;
 
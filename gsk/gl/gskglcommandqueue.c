@@ -23,6 +23,7 @@
 
 #include "config.h"
 
+#include <math.h>
 #include <string.h>
 
 #include <gdk/gdkglcontextprivate.h>
@@ -30,6 +31,7 @@
 #include <gdk/gdkmemorytextureprivate.h>
 #include <gdk/gdkprofilerprivate.h>
 #include <gsk/gskdebugprivate.h>
+#include <gsk/gskenumtypes.h>
 #include <gsk/gskroundedrectprivate.h>
 
 #include "gskglattachmentstateprivate.h"
@@ -39,6 +41,8 @@
 
 #include "inlinearray.h"
 
+#define MAX_MERGED_DRAWS 64
+
 G_DEFINE_TYPE (GskGLCommandQueue, gsk_gl_command_queue, G_TYPE_OBJECT)
 
 G_GNUC_UNUSED static inline void
@@ -387,6 +391,35 @@ snapshots_equal (GskGLCommandQueue *self,
   return TRUE;
 }
 
+static inline guint8
+get_batch_tag (GskGLCommandQueue       *self,
+               const GskGLCommandBatch *batch)
+{
+  return self->batch_tags->data[batch - self->batches.items];
+}
+
+static inline gboolean
+batch_tags_equal (GskGLCommandQueue       *self,
+                  const GskGLCommandBatch *batch,
+                  const GskGLCommandBatch *next)
+{
+  return get_batch_tag (self, batch) == get_batch_tag (self, next);
+}
+
+static inline gboolean
+can_merge_draws (GskGLCommandQueue       *self,
+                 const GskGLCommandBatch *batch,
+                 const GskGLCommandBatch *next)
+{
+  return next->any.kind == GSK_GL_COMMAND_KIND_DRAW &&
+         next->any.program == batch->any.program &&
+         next->any.viewport.width == batch->any.viewport.width &&
+         next->any.viewport.height == batch->any.viewport.height &&
+         next->draw.framebuffer == batch->draw.framebuffer &&
+         (!self->gpu_timing || batch_tags_equal (self, batch, next)) &&
+         snapshots_equal (self, (GskGLCommandBatch *)batch, (GskGLCommandBatch *)next);
+}
+
 static void
 gsk_gl_command_queue_dispose (GObject *object)
 {
@@ -394,6 +427,11 @@ gsk_gl_command_queue_dispose (GObject *object)
 
   g_assert (GSK_IS_GL_COMMAND_QUEUE (self));
 
+  /* Persistently mapped vertex buffers need the context to be released */
+  if (self->vertices.persistent && self->context != NULL)
+    gdk_gl_context_make_current (self->context);
+  gsk_gl_buffer_destroy (&self->vertices);
+
   g_clear_object (&self->profiler);
   g_clear_object (&self->gl_profiler);
   g_clear_object (&self->context);
@@ -404,7 +442,16 @@ gsk_gl_command_queue_dispose (GObject *object)
   gsk_gl_command_binds_clear (&self->batch_binds);
   gsk_gl_command_uniforms_clear (&self->batch_uniforms);
 
-  gsk_gl_buffer_destroy (&self->vertices);
+  g_clear_pointer (&self->batch_tags, g_byte_array_unref);
+  g_clear_pointer (&self->gpu_spans, g_array_unref);
+  g_clear_pointer (&self->metrics.gpu_time_by_tag, g_free);
+
+  if (self->metrics.gpu_time_names != NULL)
+    {
+      for (guint i = 0; i < 256; i++)
+        g_free (self->metrics.gpu_time_names[i]);
+      g_clear_pointer (&self->metrics.gpu_time_names, g_free);
+    }
 
   G_OBJECT_CLASS (gsk_gl_command_queue_parent_class)->dispose (object);
 }
@@ -426,6 +473,8 @@ gsk_gl_command_queue_init (GskGLCommandQueue *self)
   gsk_gl_command_binds_init (&self->batch_binds, 1024);
   gsk_gl_command_uniforms_init (&self->batch_uniforms, 2048);
 
+  self->batch_tags = g_byte_array_new ();
+
   gsk_gl_buffer_init (&self->vertices, GL_ARRAY_BUFFER, sizeof (GskGLDrawVertex));
 }
 
@@ -451,6 +500,16 @@ gsk_gl_command_queue_new (GdkGLContext      *context,
   gdk_gl_context_make_current (context);
   glGetIntegerv (GL_MAX_TEXTURE_SIZE, &self->max_texture_size);
 
+  /* Write vertices straight into GPU visible memory when we can, which
+   * saves a copy and a buffer allocation for every execution.
+   */
+  if (epoxy_is_desktop_gl () &&
+      (epoxy_gl_version () >= 44 || epoxy_has_gl_extension ("GL_ARB_buffer_storage")))
+    gsk_gl_buffer_enable_persistent (&self->vertices);
+
+  self->has_multi_draw = epoxy_is_desktop_gl () ||
+                         epoxy_has_gl_extension ("GL_EXT_multi_draw_arrays");
+
   return g_steal_pointer (&self);
 }
 
@@ -478,6 +537,12 @@ begin_next_batch (GskGLCommandQueue *self)
   batch->any.next_batch_index = -1;
   batch->any.prev_batch_index = self->tail_batch_index;
 
+  if G_UNLIKELY (self->gpu_timing)
+    {
+      g_byte_array_set_size (self->batch_tags, self->batches.len);
+      self->batch_tags->data[self->batches.len - 1] = self->current_tag;
+    }
+
   return batch;
 }
 
@@ -621,6 +686,7 @@ gsk_gl_command_queue_end_draw (GskGLCommandQueue *self)
       last_batch->draw.framebuffer == batch->draw.framebuffer &&
       last_batch->draw.vbo_offset + last_batch->draw.vbo_count == batch->draw.vbo_offset &&
       last_batch->draw.vbo_count + batch->draw.vbo_count <= 0xffff &&
+      (!self->gpu_timing || batch_tags_equal (self, last_batch, batch)) &&
       snapshots_equal (self, last_batch, batch))
     {
       last_batch->draw.vbo_count += batch->draw.vbo_count;
@@ -749,12 +815,13 @@ apply_viewport (guint *current_width,
 static inline void
 apply_scissor (gboolean              *state,
                guint                  framebuffer,
+               guint                  default_framebuffer,
                const graphene_rect_t *scissor,
                gboolean               has_scissor)
 {
   g_assert (framebuffer != (guint)-1);
 
-  if (framebuffer != 0 || !has_scissor)
+  if (framebuffer != default_framebuffer || !has_scissor)
     {
       if (*state != FALSE)
         {
@@ -930,25 +997,117 @@ gsk_gl_command_queue_sort_batches (GskGLCommandQueue *self)
   g_free (seen_free);
 }
 
+static guint
+get_gpu_time_counter (GskGLCommandQueue  *self,
+                      guint               tag,
+                      const char        **out_name)
+{
+  if (self->metrics.gpu_time_by_tag == NULL)
+    {
+      self->metrics.gpu_time_by_tag = g_new0 (guint, 256);
+      self->metrics.gpu_time_names = g_new0 (char *, 256);
+    }
+
+  if (self->metrics.gpu_time_by_tag[tag] == 0)
+    {
+      GEnumClass *enum_class = g_type_class_ref (GSK_TYPE_RENDER_NODE_TYPE);
+      GEnumValue *value = g_enum_get_value (enum_class, tag & ~GSK_GL_COMMAND_TAG_OFFSCREEN);
+      gboolean offscreen = (tag & GSK_GL_COMMAND_TAG_OFFSCREEN) != 0;
+      char *nick;
+      char *name;
+      char *description;
+
+      if (value != NULL && value->value != GSK_NOT_A_RENDER_NODE)
+        {
+          nick = g_strdup (value->value_nick);
+          if (g_str_has_suffix (nick, "-node"))
+            nick[strlen (nick) - strlen ("-node")] = 0;
+        }
+      else
+        nick = g_strdup ("other");
+
+      name = g_strdup_printf ("gpu-%s%s", offscreen ? "ofs-" : "", nick);
+      description = g_strdup_printf ("GPU time in µs for %s nodes%s",
+                                     nick, offscreen ? " in offscreens" : "");
+
+      self->metrics.gpu_time_by_tag[tag] = gdk_profiler_define_int_counter (name, description);
+      self->metrics.gpu_time_names[tag] = name;
+
+      g_free (description);
+      g_free (nick);
+      g_type_class_unref (enum_class);
+    }
+
+  if (out_name != NULL)
+    *out_name = self->metrics.gpu_time_names[tag];
+
+  return self->metrics.gpu_time_by_tag[tag];
+}
+
+static void
+gsk_gl_command_queue_report_gpu_spans (GskGLCommandQueue *self)
+{
+  gint64 totals[256] = { 0, };
+
+  if (self->gpu_spans == NULL)
+    self->gpu_spans = g_array_new (FALSE, FALSE, sizeof (GskGLProfilerSpan));
+
+  g_array_set_size (self->gpu_spans, 0);
+
+  /* Results are only available a few frames later, so what we report
+   * here belongs to an earlier frame.
+   */
+  if (!gsk_gl_profiler_end_timestamps (self->gl_profiler, self->gpu_spans))
+    return;
+
+  for (guint i = 0; i < self->gpu_spans->len; i++)
+    {
+      const GskGLProfilerSpan *span = &g_array_index (self->gpu_spans, GskGLProfilerSpan, i);
+      guint tag = span->tag & 0xff;
+      const char *name;
+
+      get_gpu_time_counter (self, tag, &name);
+      totals[tag] += span->duration;
+
+      gdk_profiler_add_mark (span->begin_time, span->duration, "GPU", name);
+    }
+
+  /* Also reset the counters of node types that are gone from the frame */
+  for (guint tag = 0; tag < G_N_ELEMENTS (totals); tag++)
+    {
+      if (self->metrics.gpu_time_by_tag[tag] != 0)
+        gdk_profiler_set_int_counter (self->metrics.gpu_time_by_tag[tag], totals[tag] / 1000);
+    }
+}
+
 /**
  * gsk_gl_command_queue_execute:
  * @self: a `GskGLCommandQueue`
  * @surface_height: the height of the backing surface
  * @scale_factor: the scale factor of the backing surface
+ * @default_framebuffer: the framebuffer of the backing surface
  * #scissor: (nullable): the scissor clip if any
  *
  * Executes all of the batches in the command queue.
+ *
+ * If @scissor contains more than one rectangle, the batches are replayed
+ * once per rectangle with the scissor set to it. Draws into offscreen
+ * framebuffers only happen in the first pass as their results can be
+ * reused, but their state changes are still applied so that the following
+ * draws see the same state.
  */
 void
 gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
                               guint                 surface_height,
-                              guint                 scale_factor,
+                              float                 scale_factor,
+                              guint                 default_framebuffer,
                               const cairo_region_t *scissor)
 {
   G_GNUC_UNUSED guint count = 0;
   graphene_rect_t scissor_test;
   gboolean has_scissor = scissor != NULL;
   gboolean scissor_state = -1;
+  guint n_passes = 1;
   guint program = 0;
   guint width = 0;
   guint height = 0;
@@ -956,12 +1115,15 @@ gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
   guint n_fbos = 0;
   G_GNUC_UNUSED guint n_uniforms = 0;
   guint n_programs = 0;
+  G_GNUC_UNUSED guint n_draws = 0;
+  G_GNUC_UNUSED guint n_draw_calls = 0;
   guint vao_id;
   guint vbo_id;
   int textures[4];
   int framebuffer = -1;
   int next_batch_index;
   int active = -1;
+  int tag = -1;
 
   g_assert (GSK_IS_GL_COMMAND_QUEUE (self));
   g_assert (self->in_draw == FALSE);
@@ -1018,134 +1180,215 @@ gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
                          sizeof (GskGLDrawVertex),
                          (void *) G_STRUCT_OFFSET (GskGLDrawVertex, color2));
 
-  /* Setup initial scissor clip */
   if (scissor != NULL)
     {
-      cairo_rectangle_int_t r;
-
-      g_assert (cairo_region_num_rectangles (scissor) == 1);
-      cairo_region_get_rectangle (scissor, 0, &r);
-
-      scissor_test.origin.x = r.x * scale_factor;
-      scissor_test.origin.y = surface_height - (r.height * scale_factor) - (r.y * scale_factor);
-      scissor_test.size.width = r.width * scale_factor;
-      scissor_test.size.height = r.height * scale_factor;
+      n_passes = cairo_region_num_rectangles (scissor);
+      g_assert (n_passes > 0);
     }
 
-  next_batch_index = self->head_batch_index;
+  if G_UNLIKELY (self->gpu_timing)
+    gsk_gl_profiler_begin_timestamps (self->gl_profiler);
 
-  while (next_batch_index >= 0)
+  for (guint pass = 0; pass < n_passes; pass++)
     {
-      const GskGLCommandBatch *batch = &self->batches.items[next_batch_index];
+      /* Setup scissor clip for this pass */
+      if (scissor != NULL)
+        {
+          cairo_rectangle_int_t r;
+          float x0, y0, x1, y1;
 
-      g_assert (next_batch_index >= 0);
-      g_assert (next_batch_index < self->batches.len);
-      g_assert (batch->any.next_batch_index != next_batch_index);
+          cairo_region_get_rectangle (scissor, pass, &r);
 
-      count++;
+          /* Round outwards for fractional scales */
+          x0 = floorf (r.x * scale_factor);
+          y0 = floorf (r.y * scale_factor);
+          x1 = ceilf ((r.x + r.width) * scale_factor);
+          y1 = ceilf ((r.y + r.height) * scale_factor);
 
-      switch (batch->any.kind)
+          scissor_test.origin.x = x0;
+          scissor_test.origin.y = surface_height - y1;
+          scissor_test.size.width = x1 - x0;
+          scissor_test.size.height = y1 - y0;
+
+          /* Force the scissor to be applied again with the first batch */
+          scissor_state = -1;
+          framebuffer = -1;
+        }
+
+      next_batch_index = self->head_batch_index;
+
+      while (next_batch_index >= 0)
         {
-        case GSK_GL_COMMAND_KIND_CLEAR:
-          if (apply_framebuffer (&framebuffer, batch->clear.framebuffer))
-            {
-              apply_scissor (&scissor_state, framebuffer, &scissor_test, has_scissor);
-              n_fbos++;
-            }
+          const GskGLCommandBatch *batch = &self->batches.items[next_batch_index];
 
-          apply_viewport (&width,
-                          &height,
-                          batch->any.viewport.width,
-                          batch->any.viewport.height);
+          g_assert (next_batch_index >= 0);
+          g_assert (next_batch_index < self->batches.len);
+          g_assert (batch->any.next_batch_index != next_batch_index);
 
-          glClearColor (0, 0, 0, 0);
-          glClear (batch->clear.bits);
-        break;
+          count++;
 
-        case GSK_GL_COMMAND_KIND_DRAW:
-          if (batch->any.program != program)
+          /* Start a new GPU time span whenever the node type changes */
+          if G_UNLIKELY (self->gpu_timing && get_batch_tag (self, batch) != tag)
             {
-              program = batch->any.program;
-              glUseProgram (program);
-
-              n_programs++;
+              tag = get_batch_tag (self, batch);
+              gsk_gl_profiler_add_timestamp (self->gl_profiler, tag);
             }
 
-          if (apply_framebuffer (&framebuffer, batch->draw.framebuffer))
+          switch (batch->any.kind)
             {
-              apply_scissor (&scissor_state, framebuffer, &scissor_test, has_scissor);
-              n_fbos++;
-            }
+            case GSK_GL_COMMAND_KIND_CLEAR:
+              if (apply_framebuffer (&framebuffer, batch->clear.framebuffer))
+                {
+                  apply_scissor (&scissor_state, framebuffer, default_framebuffer, &scissor_test, has_scissor);
+                  n_fbos++;
+                }
 
-          apply_viewport (&width,
-                          &height,
-                          batch->any.viewport.width,
-                          batch->any.viewport.height);
+              apply_viewport (&width,
+                              &height,
+                              batch->any.viewport.width,
+                              batch->any.viewport.height);
 
-          if G_UNLIKELY (batch->draw.bind_count > 0)
-            {
-              const GskGLCommandBind *bind = &self->batch_binds.items[batch->draw.bind_offset];
+              if (pass == 0 || framebuffer == default_framebuffer)
+                {
+                  glClearColor (0, 0, 0, 0);
+                  glClear (batch->clear.bits);
+                }
+            break;
+
+            case GSK_GL_COMMAND_KIND_DRAW:
+              if (batch->any.program != program)
+                {
+                  program = batch->any.program;
+                  glUseProgram (program);
 
-              for (guint i = 0; i < batch->draw.bind_count; i++)
+                  n_programs++;
+                }
+
+              if (apply_framebuffer (&framebuffer, batch->draw.framebuffer))
                 {
-                  if (textures[bind->texture] != bind->id)
+                  apply_scissor (&scissor_state, framebuffer, default_framebuffer, &scissor_test, has_scissor);
+                  n_fbos++;
+                }
+
+              apply_viewport (&width,
+                              &height,
+                              batch->any.viewport.width,
+                              batch->any.viewport.height);
+
+              if G_UNLIKELY (batch->draw.bind_count > 0)
+                {
+                  const GskGLCommandBind *bind = &self->batch_binds.items[batch->draw.bind_offset];
+
+                  for (guint i = 0; i < batch->draw.bind_count; i++)
                     {
-                      if (active != bind->texture)
+                      if (textures[bind->texture] != bind->id)
                         {
-                          active = bind->texture;
-                          glActiveTexture (GL_TEXTURE0 + bind->texture);
+                          if (active != bind->texture)
+                            {
+                              active = bind->texture;
+                              glActiveTexture (GL_TEXTURE0 + bind->texture);
+                            }
+
+                          glBindTexture (GL_TEXTURE_2D, bind->id);
+                          textures[bind->texture] = bind->id;
                         }
 
-                      glBindTexture (GL_TEXTURE_2D, bind->id);
-                      textures[bind->texture] = bind->id;
+                      bind++;
                     }
 
-                  bind++;
+                  n_binds += batch->draw.bind_count;
                 }
 
-              n_binds += batch->draw.bind_count;
-            }
+              if (batch->draw.uniform_count > 0)
+                {
+                  const GskGLCommandUniform *u = &self->batch_uniforms.items[batch->draw.uniform_offset];
 
-          if (batch->draw.uniform_count > 0)
-            {
-              const GskGLCommandUniform *u = &self->batch_uniforms.items[batch->draw.uniform_offset];
+                  for (guint i = 0; i < batch->draw.uniform_count; i++, u++)
+                    gsk_gl_uniform_state_apply (self->uniforms, program, u->location, u->info);
 
-              for (guint i = 0; i < batch->draw.uniform_count; i++, u++)
-                gsk_gl_uniform_state_apply (self->uniforms, program, u->location, u->info);
+                  n_uniforms += batch->draw.uniform_count;
+                }
 
-              n_uniforms += batch->draw.uniform_count;
+              {
+                GLint firsts[MAX_MERGED_DRAWS];
+                GLsizei counts[MAX_MERGED_DRAWS];
+                guint n_merged = 1;
+
+                firsts[0] = batch->draw.vbo_offset;
+                counts[0] = batch->draw.vbo_count;
+                n_draws++;
+
+                /* Sorting brings together batches which only differ in their
+                 * vertices. Their state has already been applied, so collect
+                 * them into a single draw call.
+                 */
+                while (batch->any.next_batch_index >= 0)
+                  {
+                    const GskGLCommandBatch *next = &self->batches.items[batch->any.next_batch_index];
+
+                    if (!can_merge_draws (self, batch, next))
+                      break;
+
+                    if (firsts[n_merged - 1] + counts[n_merged - 1] == next->draw.vbo_offset)
+                      counts[n_merged - 1] += next->draw.vbo_count;
+                    else if (n_merged < G_N_ELEMENTS (firsts) && self->has_multi_draw)
+                      {
+                        firsts[n_merged] = next->draw.vbo_offset;
+                        counts[n_merged] = next->draw.vbo_count;
+                        n_merged++;
+                      }
+                    else
+                      break;
+
+                    next_batch_index = batch->any.next_batch_index;
+                    batch = next;
+                    n_draws++;
+                    count++;
+                  }
+
+                if (pass == 0 || framebuffer == default_framebuffer)
+                  {
+                    if (n_merged == 1)
+                      glDrawArrays (GL_TRIANGLES, firsts[0], counts[0]);
+                    else
+                      glMultiDrawArrays (GL_TRIANGLES, firsts, counts, n_merged);
+
+                    n_draw_calls++;
+                  }
+              }
+
+            break;
+
+            default:
+              g_assert_not_reached ();
             }
 
-          glDrawArrays (GL_TRIANGLES, batch->draw.vbo_offset, batch->draw.vbo_count);
-
-        break;
-
-        default:
-          g_assert_not_reached ();
-        }
-
 #if 0
-      if (batch->any.kind == GSK_GL_COMMAND_KIND_DRAW ||
-          batch->any.kind == GSK_GL_COMMAND_KIND_CLEAR)
-        {
-          char filename[128];
-          g_snprintf (filename, sizeof filename,
-                      "capture%03u_batch%03d_kind%u_program%u_u%u_b%u_fb%u_ctx%p.png",
-                      count, next_batch_index,
-                      batch->any.kind, batch->any.program,
-                      batch->any.kind == GSK_GL_COMMAND_KIND_DRAW ? batch->draw.uniform_count : 0,
-                      batch->any.kind == GSK_GL_COMMAND_KIND_DRAW ? batch->draw.bind_count : 0,
-                      framebuffer,
-                      gdk_gl_context_get_current ());
-          gsk_gl_command_queue_capture_png (self, filename, width, height, TRUE);
-          gsk_gl_command_queue_print_batch (self, batch);
-        }
+          if (batch->any.kind == GSK_GL_COMMAND_KIND_DRAW ||
+              batch->any.kind == GSK_GL_COMMAND_KIND_CLEAR)
+            {
+              char filename[128];
+              g_snprintf (filename, sizeof filename,
+                          "capture%03u_batch%03d_kind%u_program%u_u%u_b%u_fb%u_ctx%p.png",
+                          count, next_batch_index,
+                          batch->any.kind, batch->any.program,
+                          batch->any.kind == GSK_GL_COMMAND_KIND_DRAW ? batch->draw.uniform_count : 0,
+                          batch->any.kind == GSK_GL_COMMAND_KIND_DRAW ? batch->draw.bind_count : 0,
+                          framebuffer,
+                          gdk_gl_context_get_current ());
+              gsk_gl_command_queue_capture_png (self, filename, width, height, TRUE);
+              gsk_gl_command_queue_print_batch (self, batch);
+            }
 #endif
 
-      next_batch_index = batch->any.next_batch_index;
+          next_batch_index = batch->any.next_batch_index;
+        }
     }
 
-  glDeleteBuffers (1, &vbo_id);
+  if G_UNLIKELY (self->gpu_timing)
+    gsk_gl_command_queue_report_gpu_spans (self);
+
+  gsk_gl_buffer_retire (&self->vertices, vbo_id);
   glDeleteVertexArrays (1, &vao_id);
 
   gdk_profiler_set_int_counter (self->metrics.n_binds, n_binds);
@@ -1153,7 +1396,10 @@ gsk_gl_command_queue_execute (GskGLCommandQueue    *self,
   gdk_profiler_set_int_counter (self->metrics.n_fbos, n_fbos);
   gdk_profiler_set_int_counter (self->metrics.n_programs, n_programs);
   gdk_profiler_set_int_counter (self->metrics.n_uploads, self->n_uploads);
+  gdk_profiler_set_int_counter (self->metrics.upload_bytes, self->n_upload_bytes);
   gdk_profiler_set_int_counter (self->metrics.queue_depth, self->batches.len);
+  gdk_profiler_set_int_counter (self->metrics.n_draws, n_draws);
+  gdk_profiler_set_int_counter (self->metrics.n_draw_calls, n_draw_calls);
 
 #ifdef G_ENABLE_DEBUG
   {
@@ -1182,6 +1428,19 @@ gsk_gl_command_queue_begin_frame (GskGLCommandQueue *self)
   self->tail_batch_index = -1;
   self->head_batch_index = -1;
   self->in_frame = TRUE;
+
+  /* Batches are only tagged and timed while sysprof is recording, as
+   * timestamp queries after every change of node type are not free.
+   */
+  self->gpu_timing = FALSE;
+  self->current_tag = 0;
+  if G_UNLIKELY (GDK_PROFILER_IS_RUNNING)
+    {
+      if (self->gl_profiler == NULL)
+        self->gl_profiler = gsk_gl_profiler_new (self->context);
+
+      self->gpu_timing = gsk_gl_profiler_has_timestamps (self->gl_profiler);
+    }
 }
 
 /**
@@ -1224,6 +1483,7 @@ gsk_gl_command_queue_end_frame (GskGLCommandQueue *self)
   self->batch_binds.len = 0;
   self->batch_uniforms.len = 0;
   self->n_uploads = 0;
+  self->n_upload_bytes = 0;
   self->tail_batch_index = -1;
   self->in_frame = FALSE;
 }
@@ -1339,6 +1599,36 @@ gsk_gl_command_queue_create_framebuffer (GskGLCommandQueue *self)
   return fbo_id;
 }
 
+static GdkMemoryFormat
+get_upload_format (GdkMemoryFormat  data_format,
+                   gboolean         use_es,
+                   GLenum          *gl_internalformat,
+                   GLenum          *gl_format,
+                   GLenum          *gl_type)
+{
+  if (!gdk_memory_format_gl_format (data_format,
+                                    use_es,
+                                    gl_internalformat,
+                                    gl_format,
+                                    gl_type))
+    {
+      if (gdk_memory_format_prefers_high_depth (data_format))
+        data_format = GDK_MEMORY_R32G32B32A32_FLOAT_PREMULTIPLIED;
+      else
+        data_format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED;
+      if (!gdk_memory_format_gl_format (data_format,
+                                        use_es,
+                                        gl_internalformat,
+                                        gl_format,
+                                        gl_type))
+        {
+          g_assert_not_reached ();
+        }
+    }
+
+  return data_format;
+}
+
 static void
 gsk_gl_command_queue_do_upload_texture (GskGLCommandQueue *self,
                                         GdkTexture        *texture)
@@ -1357,29 +1647,13 @@ gsk_gl_command_queue_do_upload_texture (GskGLCommandQueue *self,
 
   context = gdk_gl_context_get_current ();
   use_es = gdk_gl_context_get_use_es (context);
-  data_format = gdk_texture_get_format (texture);
   width = gdk_texture_get_width (texture);
   height = gdk_texture_get_height (texture);
-
-  if (!gdk_memory_format_gl_format (data_format,
-                                    use_es,
-                                    &gl_internalformat,
-                                    &gl_format,
-                                    &gl_type))
-    {
-      if (gdk_memory_format_prefers_high_depth (data_format))
-        data_format = GDK_MEMORY_R32G32B32A32_FLOAT_PREMULTIPLIED;
-      else
-        data_format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED;
-      if (!gdk_memory_format_gl_format (data_format,
-                                        use_es,
-                                        &gl_internalformat,
-                                        &gl_format,
-                                        &gl_type))
-        {
-          g_assert_not_reached ();
-        }
-    }
+  data_format = get_upload_format (gdk_texture_get_format (texture),
+                                   use_es,
+                                   &gl_internalformat,
+                                   &gl_format,
+                                   &gl_type);
 
   memtex = gdk_memory_texture_from_texture (texture, data_format);
   data = gdk_memory_texture_get_data (memtex);
@@ -1447,6 +1721,7 @@ gsk_gl_command_queue_upload_texture (GskGLCommandQueue *self,
     return texture_id;
 
   self->n_uploads++;
+  self->n_upload_bytes += (gsize) width * height * 4;
 
   /* Switch to texture0 as 2D. We'll restore it later. */
   glActiveTexture (GL_TEXTURE0);
@@ -1469,6 +1744,246 @@ gsk_gl_command_queue_upload_texture (GskGLCommandQueue *self,
   return texture_id;
 }
 
+/**
+ * gsk_gl_command_queue_upload_texture_async:
+ * @self: a `GskGLCommandQueue`
+ * @texture: a `GdkTexture` that is not a `GdkGLTexture`
+ * @min_filter: GL_NEAREST or GL_LINEAR
+ * @mag_filter: GL_NEAREST or GL_LINEAR
+ * @out_buffer_id: (out): location for the pixel buffer object
+ * @out_fence: (out): location for a fence signaled when the upload is done
+ *
+ * Like gsk_gl_command_queue_upload_texture() but streams the pixels
+ * through a pixel buffer object, so that the transfer to the texture
+ * can happen asynchronously instead of stalling in glTexImage2D().
+ *
+ * Once @out_fence has been signaled, the caller should delete both the
+ * fence and @out_buffer_id.
+ *
+ * Returns: the texture identifier, or -1 if the texture cannot be
+ *   uploaded asynchronously
+ */
+int
+gsk_gl_command_queue_upload_texture_async (GskGLCommandQueue  *self,
+                                           GdkTexture         *texture,
+                                           int                 min_filter,
+                                           int                 mag_filter,
+                                           guint              *out_buffer_id,
+                                           GLsync             *out_fence)
+{
+  G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;
+  GdkMemoryTexture *memtex;
+  GdkMemoryFormat data_format;
+  GLenum gl_internalformat;
+  GLenum gl_format;
+  GLenum gl_type;
+  const guchar *data;
+  gpointer mapped;
+  gsize stride;
+  gsize bpp;
+  GLuint buffer_id;
+  int texture_id;
+  int width, height;
+
+  g_assert (GSK_IS_GL_COMMAND_QUEUE (self));
+  g_assert (!GDK_IS_GL_TEXTURE (texture));
+  g_assert (out_buffer_id != NULL);
+  g_assert (out_fence != NULL);
+
+  /* Pixel buffer objects need GL 2.1 or GLES 3.0, and we use fences */
+  if (!gdk_gl_context_check_version (self->context, 3, 2, 3, 0))
+    return -1;
+
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+  if (width > self->max_texture_size || height > self->max_texture_size)
+    return -1;
+
+  data_format = get_upload_format (gdk_texture_get_format (texture),
+                                   gdk_gl_context_get_use_es (self->context),
+                                   &gl_internalformat,
+                                   &gl_format,
+                                   &gl_type);
+  bpp = gdk_memory_format_bytes_per_pixel (data_format);
+
+  memtex = gdk_memory_texture_from_texture (texture, data_format);
+  data = gdk_memory_texture_get_data (memtex);
+  stride = gdk_memory_texture_get_stride (memtex);
+
+  if (stride % bpp != 0)
+    {
+      g_object_unref (memtex);
+      return -1;
+    }
+
+  texture_id = gsk_gl_command_queue_create_texture (self, width, height, GL_RGBA8, min_filter, mag_filter);
+  if (texture_id == -1)
+    {
+      g_object_unref (memtex);
+      return -1;
+    }
+
+  self->n_uploads++;
+  self->n_upload_bytes += stride * height;
+
+  glGenBuffers (1, &buffer_id);
+  glBindBuffer (GL_PIXEL_UNPACK_BUFFER, buffer_id);
+  glBufferData (GL_PIXEL_UNPACK_BUFFER, stride * height, NULL, GL_STREAM_DRAW);
+  mapped = glMapBufferRange (GL_PIXEL_UNPACK_BUFFER, 0, stride * height,
+                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+  if (mapped == NULL)
+    {
+      glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+      glDeleteBuffers (1, &buffer_id);
+      glDeleteTextures (1, (GLuint *)&texture_id);
+      g_object_unref (memtex);
+      return -1;
+    }
+
+  memcpy (mapped, data, stride * height);
+  glUnmapBuffer (GL_PIXEL_UNPACK_BUFFER);
+
+  glActiveTexture (GL_TEXTURE0);
+  glBindTexture (GL_TEXTURE_2D, texture_id);
+
+  glPixelStorei (GL_UNPACK_ALIGNMENT, gdk_memory_format_alignment (data_format));
+  glPixelStorei (GL_UNPACK_ROW_LENGTH, stride / bpp);
+
+  /* With a pixel unpack buffer bound, the data pointer is an offset */
+  glTexImage2D (GL_TEXTURE_2D, 0, gl_internalformat, width, height, 0, gl_format, gl_type, NULL);
+
+  glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
+  glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
+  glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+
+  *out_fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  *out_buffer_id = buffer_id;
+
+  /* Restore previous texture state if any */
+  if (self->attachments->textures[0].id > 0)
+    glBindTexture (self->attachments->textures[0].target,
+                   self->attachments->textures[0].id);
+
+  g_object_unref (memtex);
+
+  if (gdk_profiler_is_running ())
+    gdk_profiler_add_markf (start_time, GDK_PROFILER_CURRENT_TIME-start_time,
+                            "Upload Texture (async)",
+                            "Size %dx%d", width, height);
+
+  return texture_id;
+}
+
+/**
+ * gsk_gl_command_queue_upload_texture_threaded:
+ * @self: a `GskGLCommandQueue`
+ * @texture: a `GdkTexture` that is not a `GdkGLTexture`
+ * @min_filter: GL_NEAREST or GL_LINEAR
+ * @mag_filter: GL_NEAREST or GL_LINEAR
+ * @out_fence: (out): location for a fence signaled when the upload is done
+ *
+ * Uploads @texture into a new texture using the GL context that is
+ * current in the calling thread, which must share objects with the
+ * context of @self.
+ *
+ * No state of @self is changed, so unlike the other upload functions
+ * this can be called from another thread.
+ *
+ * Returns: the texture identifier, or -1 if the texture is too large
+ */
+int
+gsk_gl_command_queue_upload_texture_threaded (GskGLCommandQueue *self,
+                                              GdkTexture        *texture,
+                                              int                min_filter,
+                                              int                mag_filter,
+                                              GLsync            *out_fence)
+{
+  G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;
+  GLuint texture_id = 0;
+  int width, height;
+
+  g_assert (GSK_IS_GL_COMMAND_QUEUE (self));
+  g_assert (!GDK_IS_GL_TEXTURE (texture));
+  g_assert (out_fence != NULL);
+
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+  if (width > self->max_texture_size || height > self->max_texture_size)
+    return -1;
+
+  glGenTextures (1, &texture_id);
+
+  glActiveTexture (GL_TEXTURE0);
+  glBindTexture (GL_TEXTURE_2D, texture_id);
+
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  gsk_gl_command_queue_do_upload_texture (self, texture);
+
+  glBindTexture (GL_TEXTURE_2D, 0);
+
+  *out_fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  /* Other contexts can only wait for the fence once it was flushed */
+  glFlush ();
+
+  if (gdk_profiler_is_running ())
+    gdk_profiler_add_markf (start_time, GDK_PROFILER_CURRENT_TIME-start_time,
+                            "Upload Texture (thread)",
+                            "Size %dx%d", width, height);
+
+  return (int)texture_id;
+}
+
+/**
+ * gsk_gl_command_queue_upload_texture_to:
+ * @self: a `GskGLCommandQueue`
+ * @texture_id: a texture previously created with
+ *   gsk_gl_command_queue_create_texture()
+ * @texture: a `GdkTexture` of the same size as @texture_id
+ *
+ * Uploads the contents of @texture into the existing texture @texture_id.
+ *
+ * This allows callers to reserve a texture identifier and reference it
+ * from batches before the pixel data is available, as long as the upload
+ * happens before the command queue is executed.
+ */
+void
+gsk_gl_command_queue_upload_texture_to (GskGLCommandQueue *self,
+                                        guint              texture_id,
+                                        GdkTexture        *texture)
+{
+  G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;
+
+  g_assert (GSK_IS_GL_COMMAND_QUEUE (self));
+  g_assert (!GDK_IS_GL_TEXTURE (texture));
+  g_assert (texture_id > 0);
+
+  self->n_uploads++;
+  self->n_upload_bytes += (gsize) gdk_texture_get_width (texture) * gdk_texture_get_height (texture) * 4;
+
+  glActiveTexture (GL_TEXTURE0);
+  glBindTexture (GL_TEXTURE_2D, texture_id);
+
+  gsk_gl_command_queue_do_upload_texture (self, texture);
+
+  /* Restore previous texture state if any */
+  if (self->attachments->textures[0].id > 0)
+    glBindTexture (self->attachments->textures[0].target,
+                   self->attachments->textures[0].id);
+
+  if (gdk_profiler_is_running ())
+    gdk_profiler_add_markf (start_time, GDK_PROFILER_CURRENT_TIME-start_time,
+                            "Upload Texture",
+                            "Size %dx%d",
+                            gdk_texture_get_width (texture),
+                            gdk_texture_get_height (texture));
+}
+
 void
 gsk_gl_command_queue_set_profiler (GskGLCommandQueue *self,
                                    GskProfiler       *profiler)
@@ -1479,18 +1994,25 @@ gsk_gl_command_queue_set_profiler (GskGLCommandQueue *self,
 
   if (g_set_object (&self->profiler, profiler))
     {
-      self->gl_profiler = gsk_gl_profiler_new (self->context);
+      if (self->gl_profiler == NULL)
+        self->gl_profiler = gsk_gl_profiler_new (self->context);
 
       self->metrics.n_frames = gsk_profiler_add_counter (profiler, "frames", "Frames", FALSE);
       self->metrics.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU Time", FALSE, TRUE);
       self->metrics.gpu_time = gsk_profiler_add_timer (profiler, "gpu-time", "GPU Time", FALSE, TRUE);
+      self->metrics.n_atlases = gsk_profiler_add_counter (profiler, "glyph-atlases", "Glyph atlases", FALSE);
+      self->metrics.atlas_bytes = gsk_profiler_add_counter (profiler, "glyph-atlas-bytes", "Glyph atlas bytes", FALSE);
+      self->metrics.n_removed_atlases = gsk_profiler_add_counter (profiler, "removed-glyph-atlases", "Removed glyph atlases", TRUE);
 
       self->metrics.n_binds = gdk_profiler_define_int_counter ("attachments", "Number of texture attachments");
       self->metrics.n_fbos = gdk_profiler_define_int_counter ("fbos", "Number of framebuffers attached");
       self->metrics.n_uniforms = gdk_profiler_define_int_counter ("uniforms", "Number of uniforms changed");
       self->metrics.n_uploads = gdk_profiler_define_int_counter ("uploads", "Number of texture uploads");
+      self->metrics.upload_bytes = gdk_profiler_define_int_counter ("upload-bytes", "Bytes of texture data uploaded");
       self->metrics.n_programs = gdk_profiler_define_int_counter ("programs", "Number of program changes");
       self->metrics.queue_depth = gdk_profiler_define_int_counter ("gl-queue-depth", "Depth of GL command batches");
+      self->metrics.n_draws = gdk_profiler_define_int_counter ("draws", "Number of draw batches");
+      self->metrics.n_draw_calls = gdk_profiler_define_int_counter ("draw-calls", "Number of GL draw calls after merging");
     }
 #endif
 }
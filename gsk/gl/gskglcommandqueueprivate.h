@@ -167,6 +167,12 @@ typedef union _GskGLCommandBatch
 
 G_STATIC_ASSERT (sizeof (GskGLCommandBatch) == 32);
 
+/* Batches are tagged with the type of the render node that created them
+ * so that GPU time can be attributed per node type while profiling. This
+ * bit is set for nodes that are rendered into an offscreen.
+ */
+#define GSK_GL_COMMAND_TAG_OFFSCREEN 0x80
+
 DEFINE_INLINE_ARRAY (GskGLCommandBatches, gsk_gl_command_batches, GskGLCommandBatch)
 DEFINE_INLINE_ARRAY (GskGLCommandBinds, gsk_gl_command_binds, GskGLCommandBind)
 DEFINE_INLINE_ARRAY (GskGLCommandUniforms, gsk_gl_command_uniforms, GskGLCommandUniform)
@@ -225,6 +231,12 @@ struct _GskGLCommandQueue
    */
   GskGLCommandUniforms batch_uniforms;
 
+  /* The tag of each batch, indexed like @batches. Only recorded while
+   * GPU timing is enabled, see gsk_gl_command_queue_set_tag().
+   */
+  GByteArray *batch_tags;
+  guint8 current_tag;
+
   /* Discovered max texture size when loading the command queue so that we
    * can either scale down or slice textures to fit within this size. Assumed
    * to be both height and width.
@@ -246,16 +258,28 @@ struct _GskGLCommandQueue
     GQuark n_frames;
     GQuark cpu_time;
     GQuark gpu_time;
+    GQuark n_atlases;
+    GQuark atlas_bytes;
+    GQuark n_removed_atlases;
     guint n_binds;
     guint n_fbos;
     guint n_uniforms;
     guint n_uploads;
+    guint upload_bytes;
     guint n_programs;
     guint queue_depth;
+    guint n_draws;
+    guint n_draw_calls;
+    guint *gpu_time_by_tag;
+    char **gpu_time_names;
   } metrics;
 
+  /* Spans collected from the GL profiler timestamps */
+  GArray *gpu_spans;
+
   /* Counter for uploads on the frame */
   guint n_uploads;
+  gsize n_upload_bytes;
 
   /* If we're inside a begin/end_frame pair */
   guint in_frame : 1;
@@ -265,6 +289,12 @@ struct _GskGLCommandQueue
 
   /* If we've warned about truncating batches */
   guint have_truncated : 1;
+
+  /* If glMultiDrawArrays() may be used to merge draws */
+  guint has_multi_draw : 1;
+
+  /* If batches are tagged and timed on the GPU for sysprof */
+  guint gpu_timing : 1;
 };
 
 GskGLCommandQueue *gsk_gl_command_queue_new                   (GdkGLContext         *context,
@@ -277,12 +307,27 @@ void                gsk_gl_command_queue_begin_frame          (GskGLCommandQueue
 void                gsk_gl_command_queue_end_frame            (GskGLCommandQueue    *self);
 void                gsk_gl_command_queue_execute              (GskGLCommandQueue    *self,
                                                                guint                 surface_height,
-                                                               guint                 scale_factor,
+                                                               float                 scale_factor,
+                                                               guint                 default_framebuffer,
                                                                const cairo_region_t *scissor);
 int                 gsk_gl_command_queue_upload_texture       (GskGLCommandQueue    *self,
                                                                GdkTexture           *texture,
                                                                int                   min_filter,
                                                                int                   mag_filter);
+int                 gsk_gl_command_queue_upload_texture_async (GskGLCommandQueue    *self,
+                                                               GdkTexture           *texture,
+                                                               int                   min_filter,
+                                                               int                   mag_filter,
+                                                               guint                *out_buffer_id,
+                                                               GLsync               *out_fence);
+int                 gsk_gl_command_queue_upload_texture_threaded (GskGLCommandQueue *self,
+                                                               GdkTexture           *texture,
+                                                               int                   min_filter,
+                                                               int                   mag_filter,
+                                                               GLsync               *out_fence);
+void                gsk_gl_command_queue_upload_texture_to    (GskGLCommandQueue    *self,
+                                                               guint                 texture_id,
+                                                               GdkTexture           *texture);
 int                 gsk_gl_command_queue_create_texture       (GskGLCommandQueue    *self,
                                                                int                   width,
                                                                int                   height,
@@ -344,6 +389,15 @@ gsk_gl_command_queue_retract_n_vertices (GskGLCommandQueue *self,
   gsk_gl_buffer_retract (&self->vertices, GSK_GL_N_VERTICES * count);
 }
 
+static inline guint
+gsk_gl_command_queue_set_tag (GskGLCommandQueue *self,
+                              guint              tag)
+{
+  guint ret = self->current_tag;
+  self->current_tag = tag;
+  return ret;
+}
+
 static inline guint
 gsk_gl_command_queue_bind_framebuffer (GskGLCommandQueue *self,
                                        guint              framebuffer)
@@ -20,8 +20,10 @@
 
 #include "config.h"
 
+#include <gdk/gdkglcontextprivate.h>
 #include <gsk/gskdebugprivate.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <string.h>
 
 #include "gskglcommandqueueprivate.h"
@@ -34,6 +36,8 @@
 #define SHADER_VERSION_GL3_LEGACY "130"
 #define SHADER_VERSION_GL3        "150"
 
+#define N_SHADER_SOURCES 10
+
 struct _GskGLCompiler
 {
   GObject parent_instance;
@@ -56,6 +60,8 @@ struct _GskGLCompiler
   guint gles : 1;
   guint legacy : 1;
   guint debug_shaders : 1;
+  guint has_program_binary : 1;
+  guint use_binary_cache : 1;
 };
 
 typedef struct _GskGLProgramAttrib
@@ -163,9 +169,41 @@ gsk_gl_compiler_new (GskGLDriver *driver,
 
   gsk_gl_command_queue_make_current (self->driver->shared_command_queue);
 
+  if (!self->debug_shaders &&
+      !GSK_DEBUG_CHECK (SHADERS) &&
+      (gdk_gl_context_check_version (context, 4, 1, 3, 0) ||
+       epoxy_has_gl_extension ("GL_ARB_get_program_binary")))
+    {
+      int n_formats = 0;
+
+      glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+      self->has_program_binary = n_formats > 0;
+    }
+
   return g_steal_pointer (&self);
 }
 
+/**
+ * gsk_gl_compiler_set_use_binary_cache:
+ * @self: a `GskGLCompiler`
+ * @use_binary_cache: if linked programs should be cached on disk
+ *
+ * Enables caching of linked program binaries in the user cache
+ * directory, so that later processes can skip compiling and linking.
+ *
+ * This is meant for the built-in programs, whose number is bounded.
+ * It has no effect if the GL implementation cannot retrieve program
+ * binaries or shader debugging is enabled.
+ */
+void
+gsk_gl_compiler_set_use_binary_cache (GskGLCompiler *self,
+                                      gboolean       use_binary_cache)
+{
+  g_return_if_fail (GSK_IS_GL_COMPILER (self));
+
+  self->use_binary_cache = !!use_binary_cache;
+}
+
 void
 gsk_gl_compiler_bind_attribute (GskGLCompiler *self,
                                 const char    *name,
@@ -532,6 +570,124 @@ get_shader_string (GBytes *bytes)
   return str ? str : "";
 }
 
+static char *
+get_binary_cache_path (const char * const *vertex_sources,
+                       const int          *vertex_lengths,
+                       const char * const *fragment_sources,
+                       const int          *fragment_lengths,
+                       GArray             *attrib_locations)
+{
+  const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+  GChecksum *checksum;
+  char *basename;
+  char *path;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+  /* Binaries are only valid for the implementation that created them */
+  for (guint i = 0; i < G_N_ELEMENTS (strings); i++)
+    {
+      const char *str = (const char *)glGetString (strings[i]);
+
+      g_checksum_update (checksum, (const guchar *)(str ? str : ""), -1);
+      g_checksum_update (checksum, (const guchar *)"\n", 1);
+    }
+
+  for (guint i = 0; i < N_SHADER_SOURCES; i++)
+    g_checksum_update (checksum, (const guchar *)vertex_sources[i], vertex_lengths[i]);
+
+  for (guint i = 0; i < N_SHADER_SOURCES; i++)
+    g_checksum_update (checksum, (const guchar *)fragment_sources[i], fragment_lengths[i]);
+
+  for (guint i = 0; i < attrib_locations->len; i++)
+    {
+      const GskGLProgramAttrib *attrib = &g_array_index (attrib_locations, GskGLProgramAttrib, i);
+
+      g_checksum_update (checksum, (const guchar *)attrib->name, -1);
+      g_checksum_update (checksum, (const guchar *)&attrib->location, sizeof attrib->location);
+    }
+
+  basename = g_strdup_printf ("%s.bin", g_checksum_get_string (checksum));
+  path = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "gl-programs", basename, NULL);
+
+  g_checksum_free (checksum);
+  g_free (basename);
+
+  return path;
+}
+
+static int
+load_program_binary (const char *path)
+{
+  char *contents = NULL;
+  gsize len = 0;
+  int program_id = 0;
+
+  if (!g_file_get_contents (path, &contents, &len, NULL))
+    return 0;
+
+  /* The file starts with the binary format, followed by the binary */
+  if (len > sizeof (guint32))
+    {
+      guint32 format;
+      int status = GL_FALSE;
+
+      memcpy (&format, contents, sizeof format);
+
+      program_id = glCreateProgram ();
+      glProgramBinary (program_id, format, contents + sizeof format, len - sizeof format);
+      glGetProgramiv (program_id, GL_LINK_STATUS, &status);
+
+      if (status == GL_FALSE)
+        {
+          glDeleteProgram (program_id);
+          program_id = 0;
+        }
+    }
+
+  /* Rejected binaries are removed so that they are replaced after
+   * compiling from source, e.g. after a driver update.
+   */
+  if (program_id == 0)
+    g_unlink (path);
+
+  g_free (contents);
+
+  return program_id;
+}
+
+static void
+save_program_binary (int         program_id,
+                     const char *path)
+{
+  GLenum format = 0;
+  char *contents;
+  char *dir;
+  int len = 0;
+
+  glGetProgramiv (program_id, GL_PROGRAM_BINARY_LENGTH, &len);
+
+  if (len <= 0)
+    return;
+
+  contents = g_malloc (sizeof (guint32) + len);
+  glGetProgramBinary (program_id, len, &len, &format, contents + sizeof (guint32));
+
+  if (len > 0)
+    {
+      guint32 format32 = format;
+
+      memcpy (contents, &format32, sizeof format32);
+
+      dir = g_path_get_dirname (path);
+      if (g_mkdir_with_parents (dir, 0755) == 0)
+        g_file_set_contents (path, contents, sizeof format32 + len, NULL);
+      g_free (dir);
+    }
+
+  g_free (contents);
+}
+
 GskGLProgram *
 gsk_gl_compiler_compile (GskGLCompiler  *self,
                          const char     *name,
@@ -543,6 +699,11 @@ gsk_gl_compiler_compile (GskGLCompiler  *self,
   const char *legacy = "";
   const char *gl3 = "";
   const char *gles = "";
+  const char *vertex_sources[N_SHADER_SOURCES];
+  const char *fragment_sources[N_SHADER_SOURCES];
+  int vertex_lengths[N_SHADER_SOURCES];
+  int fragment_lengths[N_SHADER_SOURCES];
+  char *cache_path = NULL;
   int program_id;
   int vertex_id;
   int fragment_id;
@@ -572,68 +733,66 @@ gsk_gl_compiler_compile (GskGLCompiler  *self,
   if (self->gl3)
     gl3 = "#define GSK_GL3 1\n";
 
+  vertex_sources[0] = fragment_sources[0] = version;
+  vertex_sources[1] = fragment_sources[1] = debug;
+  vertex_sources[2] = fragment_sources[2] = legacy;
+  vertex_sources[3] = fragment_sources[3] = gl3;
+  vertex_sources[4] = fragment_sources[4] = gles;
+  vertex_sources[5] = fragment_sources[5] = clip;
+  vertex_sources[6] = fragment_sources[6] = get_shader_string (self->all_preamble);
+  vertex_sources[7] = get_shader_string (self->vertex_preamble);
+  vertex_sources[8] = get_shader_string (self->vertex_source);
+  vertex_sources[9] = get_shader_string (self->vertex_suffix);
+  fragment_sources[7] = get_shader_string (self->fragment_preamble);
+  fragment_sources[8] = get_shader_string (self->fragment_source);
+  fragment_sources[9] = get_shader_string (self->fragment_suffix);
+
+  for (guint i = 0; i < 6; i++)
+    vertex_lengths[i] = fragment_lengths[i] = strlen (vertex_sources[i]);
+  vertex_lengths[6] = fragment_lengths[6] = g_bytes_get_size (self->all_preamble);
+  vertex_lengths[7] = g_bytes_get_size (self->vertex_preamble);
+  vertex_lengths[8] = g_bytes_get_size (self->vertex_source);
+  vertex_lengths[9] = g_bytes_get_size (self->vertex_suffix);
+  fragment_lengths[7] = g_bytes_get_size (self->fragment_preamble);
+  fragment_lengths[8] = g_bytes_get_size (self->fragment_source);
+  fragment_lengths[9] = g_bytes_get_size (self->fragment_suffix);
+
+  if (self->has_program_binary && self->use_binary_cache)
+    {
+      cache_path = get_binary_cache_path (vertex_sources, vertex_lengths,
+                                          fragment_sources, fragment_lengths,
+                                          self->attrib_locations);
+      program_id = load_program_binary (cache_path);
+
+      if (program_id > 0)
+        {
+          g_free (cache_path);
+          return gsk_gl_program_new (self->driver, name, program_id);
+        }
+    }
+
   vertex_id = glCreateShader (GL_VERTEX_SHADER);
-  glShaderSource (vertex_id,
-                  10,
-                  (const char *[]) {
-                    version, debug, legacy, gl3, gles,
-                    clip,
-                    get_shader_string (self->all_preamble),
-                    get_shader_string (self->vertex_preamble),
-                    get_shader_string (self->vertex_source),
-                    get_shader_string (self->vertex_suffix),
-                  },
-                  (int[]) {
-                    strlen (version),
-                    strlen (debug),
-                    strlen (legacy),
-                    strlen (gl3),
-                    strlen (gles),
-                    strlen (clip),
-                    g_bytes_get_size (self->all_preamble),
-                    g_bytes_get_size (self->vertex_preamble),
-                    g_bytes_get_size (self->vertex_source),
-                    g_bytes_get_size (self->vertex_suffix),
-                  });
+  glShaderSource (vertex_id, N_SHADER_SOURCES, vertex_sources, vertex_lengths);
   glCompileShader (vertex_id);
 
   if (!check_shader_error (vertex_id, error))
     {
       glDeleteShader (vertex_id);
+      g_free (cache_path);
       return NULL;
     }
 
   print_shader_info ("Vertex shader", vertex_id, name);
 
   fragment_id = glCreateShader (GL_FRAGMENT_SHADER);
-  glShaderSource (fragment_id,
-                  10,
-                  (const char *[]) {
-                    version, debug, legacy, gl3, gles,
-                    clip,
-                    get_shader_string (self->all_preamble),
-                    get_shader_string (self->fragment_preamble),
-                    get_shader_string (self->fragment_source),
-                    get_shader_string (self->fragment_suffix),
-                  },
-                  (int[]) {
-                    strlen (version),
-                    strlen (debug),
-                    strlen (legacy),
-                    strlen (gl3),
-                    strlen (gles),
-                    strlen (clip),
-                    g_bytes_get_size (self->all_preamble),
-                    g_bytes_get_size (self->fragment_preamble),
-                    g_bytes_get_size (self->fragment_source),
-                    g_bytes_get_size (self->fragment_suffix),
-                  });
+  glShaderSource (fragment_id, N_SHADER_SOURCES, fragment_sources, fragment_lengths);
   glCompileShader (fragment_id);
 
   if (!check_shader_error (fragment_id, error))
     {
       glDeleteShader (vertex_id);
       glDeleteShader (fragment_id);
+      g_free (cache_path);
       return NULL;
     }
 
@@ -651,6 +810,9 @@ gsk_gl_compiler_compile (GskGLCompiler  *self,
       glBindAttribLocation (program_id, attrib->location, attrib->name);
     }
 
+  if (cache_path != NULL)
+    glProgramParameteri (program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
   glLinkProgram (program_id);
 
   glGetProgramiv (program_id, GL_LINK_STATUS, &status);
@@ -685,11 +847,18 @@ gsk_gl_compiler_compile (GskGLCompiler  *self,
                    buffer ? buffer : "");
 
       g_free (buffer);
+      g_free (cache_path);
 
       glDeleteProgram (program_id);
 
       return NULL;
     }
 
+  if (cache_path != NULL)
+    {
+      save_program_binary (program_id, cache_path);
+      g_free (cache_path);
+    }
+
   return gsk_gl_program_new (self->driver, name, program_id);
 }
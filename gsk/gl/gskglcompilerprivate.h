@@ -60,6 +60,8 @@ void            gsk_gl_compiler_bind_attribute             (GskGLCompiler      *
                                                             const char         *name,
                                                             guint               location);
 void            gsk_gl_compiler_clear_attributes           (GskGLCompiler      *self);
+void            gsk_gl_compiler_set_use_binary_cache       (GskGLCompiler      *self,
+                                                            gboolean            use_binary_cache);
 GskGLProgram  * gsk_gl_compiler_compile                    (GskGLCompiler      *self,
                                                             const char         *name,
                                                             const char         *clip,
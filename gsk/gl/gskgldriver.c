@@ -27,25 +27,40 @@
 
 #include <gsk/gskdebugprivate.h>
 #include <gsk/gskglshaderprivate.h>
+#include <gsk/gskprivate.h>
 #include <gsk/gskrendererprivate.h>
+#include <gsk/gskrendernodeprivate.h>
 
 #include "gskglcommandqueueprivate.h"
 #include "gskglcompilerprivate.h"
 #include "gskglglyphlibraryprivate.h"
 #include "gskgliconlibraryprivate.h"
 #include "gskglprogramprivate.h"
+#include "gskglsdfglyphlibraryprivate.h"
 #include "gskglshadowlibraryprivate.h"
 #include "gskgltextureprivate.h"
 #include "fp16private.h"
 
 #include <gdk/gdkglcontextprivate.h>
 #include <gdk/gdkdisplayprivate.h>
+#include <gdk/gdkdmabuftextureprivate.h>
 #include <gdk/gdkmemorytextureprivate.h>
 #include <gdk/gdkprofilerprivate.h>
 #include <gdk/gdktextureprivate.h>
 
 #define ATLAS_SIZE 512
 #define MAX_OLD_RATIO 0.5
+#define MAX_ATLAS_MOVES_PER_FRAME 256
+#define ASYNC_UPLOAD_MIN_PIXELS (1024 * 1024)
+
+/* Textures get mipmaps after being drawn minified in this many frames */
+#define MIPMAP_MIN_FRAMES 3
+
+/* Cached offscreens are kept around for this many frames without
+ * being used, as long as they all fit into the byte budget.
+ */
+#define MAX_CACHED_TEXTURE_AGE 60
+#define MAX_CACHED_TEXTURE_BYTES (64 * 1024 * 1024)
 
 G_DEFINE_TYPE (GskGLDriver, gsk_gl_driver, G_TYPE_OBJECT)
 
@@ -83,6 +98,30 @@ texture_key_equal (gconstpointer v1,
          (!k1->pointer_is_child || memcmp (&k1->parent_rect, &k2->parent_rect, sizeof k1->parent_rect) == 0);
 }
 
+static void
+texture_key_free (gpointer data)
+{
+  GskTextureKey *key = data;
+
+  gsk_render_node_unref ((GskRenderNode *)key->pointer);
+  g_free (key);
+}
+
+static int
+compare_last_used (gconstpointer a,
+                   gconstpointer b)
+{
+  const GskGLTexture *ta = *(const GskGLTexture * const *)a;
+  const GskGLTexture *tb = *(const GskGLTexture * const *)b;
+
+  if (ta->last_used_in_frame < tb->last_used_in_frame)
+    return -1;
+  else if (ta->last_used_in_frame > tb->last_used_in_frame)
+    return 1;
+  else
+    return 0;
+}
+
 static void
 remove_texture_key_for_id (GskGLDriver *self,
                            guint        texture_id)
@@ -115,12 +154,34 @@ gsk_gl_driver_autorelease_texture (GskGLDriver *self,
   g_array_append_val (self->texture_pool, texture_id);
 }
 
+static void
+gsk_gl_driver_collect_texture (GskGLDriver  *self,
+                               GskGLTexture *t)
+{
+  g_assert (t->link.prev == NULL);
+  g_assert (t->link.next == NULL);
+  g_assert (t->link.data == t);
+
+  remove_texture_key_for_id (self, t->texture_id);
+  gsk_gl_driver_autorelease_texture (self, t->texture_id);
+  t->texture_id = 0;
+  gsk_gl_texture_free (t);
+}
+
+/* Textures last used in @watermark or earlier are released, except for
+ * cached offscreens which are kept until @cached_watermark. Of those,
+ * the least recently used ones are released until the remaining ones
+ * fit into MAX_CACHED_TEXTURE_BYTES.
+ */
 static guint
 gsk_gl_driver_collect_unused_textures (GskGLDriver *self,
-                                       gint64       watermark)
+                                       gint64       watermark,
+                                       gint64       cached_watermark)
 {
   GHashTableIter iter;
+  GPtrArray *evictable = NULL;
   gpointer k, v;
+  gsize cached_size = 0;
   guint old_size;
   guint collected;
 
@@ -132,23 +193,52 @@ gsk_gl_driver_collect_unused_textures (GskGLDriver *self,
   while (g_hash_table_iter_next (&iter, &k, &v))
     {
       GskGLTexture *t = v;
+      gboolean is_cached;
 
       if (t->user || t->permanent)
         continue;
 
-      if (t->last_used_in_frame <= watermark)
+      is_cached = g_hash_table_contains (self->texture_id_to_key, k);
+
+      if (t->last_used_in_frame <= (is_cached ? cached_watermark : watermark))
         {
           g_hash_table_iter_steal (&iter);
+          gsk_gl_driver_collect_texture (self, t);
+
+          if (is_cached)
+            self->n_evicted_offscreens++;
+          else
+            self->n_evicted_textures++;
+        }
+      else if (is_cached)
+        {
+          /* Approximate, high depth offscreens use twice as much */
+          cached_size += (gsize)t->width * (gsize)t->height * 4;
 
-          g_assert (t->link.prev == NULL);
-          g_assert (t->link.next == NULL);
-          g_assert (t->link.data == t);
+          if (t->last_used_in_frame <= watermark)
+            {
+              if (evictable == NULL)
+                evictable = g_ptr_array_new ();
+              g_ptr_array_add (evictable, t);
+            }
+        }
+    }
 
-          remove_texture_key_for_id (self, t->texture_id);
-          gsk_gl_driver_autorelease_texture (self, t->texture_id);
-          t->texture_id = 0;
-          gsk_gl_texture_free (t);
+  if (evictable != NULL)
+    {
+      g_ptr_array_sort (evictable, compare_last_used);
+
+      for (guint i = 0; i < evictable->len && cached_size > MAX_CACHED_TEXTURE_BYTES; i++)
+        {
+          GskGLTexture *t = g_ptr_array_index (evictable, i);
+
+          cached_size -= (gsize)t->width * (gsize)t->height * 4;
+          g_hash_table_steal (self->textures, GUINT_TO_POINTER (t->texture_id));
+          gsk_gl_driver_collect_texture (self, t);
+          self->n_evicted_offscreens++;
         }
+
+      g_ptr_array_unref (evictable);
     }
 
   collected = old_size - g_hash_table_size (self->textures);
@@ -165,6 +255,12 @@ gsk_gl_texture_atlas_free (GskGLTextureAtlas *atlas)
       atlas->texture_id = 0;
     }
 
+  if (atlas->framebuffer_id != 0)
+    {
+      glDeleteFramebuffers (1, &atlas->framebuffer_id);
+      atlas->framebuffer_id = 0;
+    }
+
   g_clear_pointer (&atlas->nodes, g_free);
   g_slice_free (GskGLTextureAtlas, atlas);
 }
@@ -226,6 +322,129 @@ gsk_gl_driver_shader_weak_cb (gpointer  data,
     g_hash_table_remove (self->shader_cache, where_object_was);
 }
 
+typedef struct _GskGLUpload
+{
+  GdkTexture *texture;
+  int min_filter;
+  int mag_filter;
+
+  /* Set by the upload thread */
+  GLuint texture_id;
+  GLsync fence;
+} GskGLUpload;
+
+static void
+gsk_gl_upload_free (GskGLUpload *upload)
+{
+  g_object_unref (upload->texture);
+  g_slice_free (GskGLUpload, upload);
+}
+
+static void
+gsk_gl_driver_upload_func (gpointer data,
+                           gpointer user_data)
+{
+  GskGLUpload *upload = data;
+  GskGLDriver *self = user_data;
+  int texture_id;
+
+  gdk_gl_context_make_current (self->upload_context);
+  texture_id = gsk_gl_command_queue_upload_texture_threaded (self->shared_command_queue,
+                                                             upload->texture,
+                                                             upload->min_filter,
+                                                             upload->mag_filter,
+                                                             &upload->fence);
+  upload->texture_id = MAX (texture_id, 0);
+  gdk_gl_context_clear_current ();
+
+  g_async_queue_push (self->finished_uploads, upload);
+}
+
+static gboolean
+gsk_gl_driver_ensure_upload_thread (GskGLDriver *self)
+{
+  GdkGLContext *context = self->command_queue->context;
+  GError *error = NULL;
+
+  if (self->upload_pool != NULL)
+    return TRUE;
+
+  if (self->upload_thread_failed)
+    return FALSE;
+
+  /* Using a context in another thread is only safe with EGL,
+   * and we need fences */
+  if (gdk_display_get_egl_display (gdk_gl_context_get_display (context)) == NULL ||
+      !gdk_gl_context_check_version (context, 3, 2, 3, 0))
+    {
+      self->upload_thread_failed = TRUE;
+      return FALSE;
+    }
+
+  self->upload_context = gdk_gl_context_create_shared (context, &error);
+
+  /* Realizing may have switched contexts */
+  gdk_gl_context_make_current (context);
+
+  if (self->upload_context == NULL)
+    {
+      GSK_NOTE (OPENGL, g_message ("Not uploading textures in a thread: %s", error->message));
+      g_clear_error (&error);
+      self->upload_thread_failed = TRUE;
+      return FALSE;
+    }
+
+  self->finished_uploads = g_async_queue_new ();
+  self->pending_uploads = g_hash_table_new (NULL, NULL);
+  self->upload_pool = g_thread_pool_new (gsk_gl_driver_upload_func, self, 1, FALSE, NULL);
+
+  return TRUE;
+}
+
+/* Picks up the textures that the upload thread finished. Their fences
+ * may not be signaled yet, gsk_gl_texture_is_uploaded() checks that.
+ */
+static void
+gsk_gl_driver_collect_uploads (GskGLDriver *self)
+{
+  GskGLUpload *upload;
+
+  if (self->finished_uploads == NULL)
+    return;
+
+  while ((upload = g_async_queue_try_pop (self->finished_uploads)))
+    {
+      g_hash_table_remove (self->pending_uploads, upload->texture);
+
+      if (upload->texture_id == 0)
+        {
+          /* Should not happen, but don't leave the texture out forever */
+          gsk_gl_driver_load_texture (self, upload->texture, upload->min_filter, upload->mag_filter);
+        }
+      else
+        {
+          GskGLTexture *t;
+
+          t = gsk_gl_texture_new (upload->texture_id,
+                                  gdk_texture_get_width (upload->texture),
+                                  gdk_texture_get_height (upload->texture),
+                                  GL_RGBA8, upload->min_filter, upload->mag_filter,
+                                  self->current_frame_id);
+          t->upload_fence = upload->fence;
+
+          g_hash_table_insert (self->textures, GUINT_TO_POINTER (t->texture_id), t);
+
+          if (gdk_texture_set_render_data (upload->texture, self, t, gsk_gl_texture_destroyed))
+            t->user = upload->texture;
+
+          gdk_gl_context_label_object_printf (self->command_queue->context, GL_TEXTURE, t->texture_id,
+                                              "GdkTexture<%p> %d", upload->texture, t->texture_id);
+        }
+
+      gsk_gl_upload_free (upload);
+    }
+}
+
 static void
 gsk_gl_driver_dispose (GObject *object)
 {
@@ -250,6 +469,7 @@ gsk_gl_driver_dispose (GObject *object)
 #undef GSK_GL_NO_UNIFORMS
 #undef GSK_GL_ADD_UNIFORM
 #undef GSK_GL_DEFINE_PROGRAM
+#undef GSK_GL_DELETE_PROGRAM
 
   if (self->shader_cache != NULL)
     {
@@ -269,10 +489,33 @@ gsk_gl_driver_dispose (GObject *object)
       g_clear_pointer (&self->shader_cache, g_hash_table_unref);
     }
 
+  if (self->upload_pool != NULL)
+    {
+      GskGLUpload *upload;
+
+      /* Wait for the upload thread, then drop what it produced */
+      g_thread_pool_free (self->upload_pool, FALSE, TRUE);
+      self->upload_pool = NULL;
+
+      gsk_gl_command_queue_make_current (self->shared_command_queue);
+      while ((upload = g_async_queue_try_pop (self->finished_uploads)))
+        {
+          if (upload->fence != NULL)
+            glDeleteSync (upload->fence);
+          if (upload->texture_id != 0)
+            glDeleteTextures (1, &upload->texture_id);
+          gsk_gl_upload_free (upload);
+        }
+
+      g_clear_pointer (&self->finished_uploads, g_async_queue_unref);
+      g_clear_pointer (&self->pending_uploads, g_hash_table_unref);
+      g_clear_object (&self->upload_context);
+    }
+
   if (self->command_queue != NULL)
     {
       gsk_gl_command_queue_make_current (self->command_queue);
-      gsk_gl_driver_collect_unused_textures (self, 0);
+      gsk_gl_driver_collect_unused_textures (self, 0, G_MAXINT64);
       g_clear_object (&self->command_queue);
     }
 
@@ -290,6 +533,7 @@ gsk_gl_driver_dispose (GObject *object)
   g_assert (!self->key_to_texture_id|| g_hash_table_size (self->key_to_texture_id) == 0);
 
   g_clear_object (&self->glyphs);
+  g_clear_object (&self->sdf_glyphs);
   g_clear_object (&self->icons);
   g_clear_object (&self->shadows);
 
@@ -325,7 +569,7 @@ gsk_gl_driver_init (GskGLDriver *self)
   self->texture_id_to_key = g_hash_table_new (NULL, NULL);
   self->key_to_texture_id = g_hash_table_new_full (texture_key_hash,
                                                    texture_key_equal,
-                                                   g_free,
+                                                   texture_key_free,
                                                    NULL);
   self->shader_cache = g_hash_table_new_full (NULL, NULL, NULL, remove_program);
   self->texture_pool = g_array_new (FALSE, FALSE, sizeof (guint));
@@ -333,18 +577,13 @@ gsk_gl_driver_init (GskGLDriver *self)
   self->atlases = g_ptr_array_new_with_free_func ((GDestroyNotify)gsk_gl_texture_atlas_free);
 }
 
-static gboolean
-gsk_gl_driver_load_programs (GskGLDriver  *self,
-                             GError      **error)
+static GskGLCompiler *
+gsk_gl_driver_create_compiler (GskGLDriver *self)
 {
   GskGLCompiler *compiler;
-  gboolean ret = FALSE;
-  G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;
-
-  g_assert (GSK_IS_GL_DRIVER (self));
-  g_assert (GSK_IS_GL_COMMAND_QUEUE (self->command_queue));
 
   compiler = gsk_gl_compiler_new (self, self->debug);
+  gsk_gl_compiler_set_use_binary_cache (compiler, TRUE);
 
   /* Setup preambles that are shared by all shaders */
   gsk_gl_compiler_set_preamble_from_resource (compiler,
@@ -363,15 +602,63 @@ gsk_gl_driver_load_programs (GskGLDriver  *self,
   gsk_gl_compiler_bind_attribute (compiler, "aColor", 2);
   gsk_gl_compiler_bind_attribute (compiler, "aColor2", 3);
 
-  /* Use XMacros to register all of our programs and their uniforms */
+  return compiler;
+}
+
+/* Use XMacros to define a function for each program that compiles
+ * its three clip variants and registers their uniforms. If one of the
+ * variants fails, the others are dropped again, so a program is either
+ * fully usable or not at all.
+ */
 #define GSK_GL_NO_UNIFORMS
 #define GSK_GL_ADD_UNIFORM(pos, KEY, name)                                                      \
   gsk_gl_program_add_uniform (program, #name, UNIFORM_##KEY);
 #define GSK_GL_DEFINE_PROGRAM(name, resource, uniforms)                                         \
-  gsk_gl_compiler_set_source_from_resource (compiler, GSK_GL_COMPILER_ALL, resource);           \
-  GSK_GL_COMPILE_PROGRAM(name ## _no_clip, uniforms, "#define NO_CLIP 1\n");                    \
-  GSK_GL_COMPILE_PROGRAM(name ## _rect_clip, uniforms, "#define RECT_CLIP 1\n");                \
-  GSK_GL_COMPILE_PROGRAM(name, uniforms, "");
+  static gboolean                                                                               \
+  gsk_gl_driver_compile_ ## name (GskGLDriver  *self,                                           \
+                                  GError      **error)                                          \
+  {                                                                                             \
+    GskGLCompiler *compiler;                                                                    \
+                                                                                                \
+    compiler = gsk_gl_driver_create_compiler (self);                                            \
+    gsk_gl_compiler_set_source_from_resource (compiler, GSK_GL_COMPILER_ALL, resource);         \
+    GSK_GL_COMPILE_PROGRAM(name ## _no_clip, uniforms, "#define NO_CLIP 1\n");                  \
+    GSK_GL_COMPILE_PROGRAM(name ## _rect_clip, uniforms, "#define RECT_CLIP 1\n");              \
+    GSK_GL_COMPILE_PROGRAM(name, uniforms, "");                                                 \
+    g_object_unref (compiler);                                                                  \
+                                                                                                \
+    return TRUE;                                                                                \
+                                                                                                \
+  failure:                                                                                      \
+    g_object_unref (compiler);                                                                  \
+    GSK_GL_DELETE_PROGRAM(name ## _no_clip);                                                    \
+    GSK_GL_DELETE_PROGRAM(name ## _rect_clip);                                                  \
+    GSK_GL_DELETE_PROGRAM(name);                                                                \
+                                                                                                \
+    return FALSE;                                                                               \
+  }                                                                                             \
+                                                                                                \
+  gboolean                                                                                      \
+  gsk_gl_driver_load_ ## name (GskGLDriver *self)                                               \
+  {                                                                                             \
+    G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;                                \
+    GError *error = NULL;                                                                       \
+                                                                                                \
+    if (self->name ## _failed)                                                                  \
+      return FALSE;                                                                             \
+                                                                                                \
+    if (!gsk_gl_driver_compile_ ## name (self, &error))                                         \
+      {                                                                                         \
+        g_warning ("Failed to compile the %s program, drawing its nodes with cairo: %s",        \
+                   #name, error->message);                                                      \
+        g_clear_error (&error);                                                                 \
+        self->name ## _failed = TRUE;                                                           \
+      }                                                                                         \
+                                                                                                \
+    gdk_profiler_end_mark (start_time, "compile program", #name);                               \
+                                                                                                \
+    return self->name != NULL;                                                                  \
+  }
 #define GSK_GL_COMPILE_PROGRAM(name, uniforms, clip)                                            \
   G_STMT_START {                                                                                \
     GskGLProgram *program;                                                                      \
@@ -394,19 +681,57 @@ gsk_gl_driver_load_programs (GskGLDriver  *self,
     if (have_alpha)                                                                             \
       gsk_gl_program_set_uniform1f (program, UNIFORM_SHARED_ALPHA, 0, 1.0f);                    \
                                                                                                 \
-    *(GskGLProgram **)(((guint8 *)self) + G_STRUCT_OFFSET (GskGLDriver, name)) =                \
-         g_steal_pointer (&program);                                                            \
+    self->name = g_steal_pointer (&program);                                                    \
   } G_STMT_END;
+#define GSK_GL_DELETE_PROGRAM(name)                                                             \
+  G_STMT_START {                                                                                \
+    if (self->name)                                                                             \
+      gsk_gl_program_delete (self->name);                                                       \
+    g_clear_object (&self->name);                                                               \
+  } G_STMT_END;
+# include "gskglprograms.defs"
+#undef GSK_GL_DELETE_PROGRAM
+#undef GSK_GL_COMPILE_PROGRAM
+#undef GSK_GL_DEFINE_PROGRAM
+#undef GSK_GL_ADD_UNIFORM
+#undef GSK_GL_NO_UNIFORMS
+
+static gboolean
+gsk_gl_driver_load_programs (GskGLDriver  *self,
+                             GError      **error)
+{
+  G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;
+  gboolean ret = FALSE;
+
+  g_assert (GSK_IS_GL_DRIVER (self));
+  g_assert (GSK_IS_GL_COMMAND_QUEUE (self->command_queue));
+
+  /* Only blit is compiled up front. Nearly every frame needs it, the
+   * cairo fallback for nodes whose program fails to compile needs it,
+   * and it tells us early whether the GL implementation can handle our
+   * shaders at all. The other programs are compiled on first use, see
+   * gsk_gl_driver_ensure_program(). When debugging shaders, compile
+   * everything so that errors show up right away.
+   */
+  if (!gsk_gl_driver_compile_blit (self, error))
+    goto failure;
+
+  if (self->debug)
+    {
+#define GSK_GL_NO_UNIFORMS
+#define GSK_GL_ADD_UNIFORM(pos, KEY, name)
+#define GSK_GL_DEFINE_PROGRAM(name, resource, uniforms)                                         \
+  if (self->name == NULL && !gsk_gl_driver_compile_ ## name (self, error))                      \
+    goto failure;
 # include "gskglprograms.defs"
-#undef GSK_GL_DEFINE_PROGRAM_CLIP
 #undef GSK_GL_DEFINE_PROGRAM
 #undef GSK_GL_ADD_UNIFORM
+#undef GSK_GL_NO_UNIFORMS
+    }
 
   ret = TRUE;
 
 failure:
-  g_clear_object (&compiler);
-
   gdk_profiler_end_mark (start_time, "load programs", NULL);
 
   return ret;
@@ -457,6 +782,8 @@ gsk_gl_driver_new (GskGLCommandQueue  *command_queue,
     }
 
   self->glyphs = gsk_gl_glyph_library_new (self);
+  if (gsk_check_debug_flags (GSK_DEBUG_SDF_GLYPHS))
+    self->sdf_glyphs = gsk_gl_sdf_glyph_library_new (self);
   self->icons = gsk_gl_icon_library_new (self);
   self->shadows = gsk_gl_shadow_library_new (self);
 
@@ -522,21 +849,92 @@ static GPtrArray *
 gsk_gl_driver_compact_atlases (GskGLDriver *self)
 {
   GPtrArray *removed = NULL;
+  gboolean evacuating = FALSE;
+  guint budget = MAX_ATLAS_MOVES_PER_FRAME;
+  gsize atlas_bytes = (gsize) self->atlases->len * ATLAS_SIZE * ATLAS_SIZE * 4;
 
   g_assert (GSK_IS_GL_DRIVER (self));
 
-  for (guint i = self->atlases->len; i > 0; i--)
+  /* Rather than dropping fragmented atlases at once and re-uploading
+   * everything they contained, their live entries are copied into
+   * other atlases on the GPU, a bounded number per frame.
+   */
+  for (guint i = 0; i < self->atlases->len; i++)
     {
-      GskGLTextureAtlas *atlas = g_ptr_array_index (self->atlases, i - 1);
+      GskGLTextureAtlas *atlas = g_ptr_array_index (self->atlases, i);
 
-      if (gsk_gl_texture_atlas_get_unused_ratio (atlas) > MAX_OLD_RATIO)
+      if (!atlas->evacuating &&
+          gsk_gl_texture_atlas_get_unused_ratio (atlas) > MAX_OLD_RATIO)
         {
           GSK_NOTE (GLYPH_CACHE,
-                    g_message ("Dropping atlas %d (%g.2%% old)", i,
+                    g_message ("Evacuating atlas %d (%.2f%% old)", i,
                                100.0 * gsk_gl_texture_atlas_get_unused_ratio (atlas)));
-          if (removed == NULL)
-            removed = g_ptr_array_new_with_free_func ((GDestroyNotify)gsk_gl_texture_atlas_free);
-          g_ptr_array_add (removed, g_ptr_array_steal_index (self->atlases, i - 1));
+
+          atlas->evacuating = TRUE;
+          atlas->framebuffer_id = gsk_gl_command_queue_create_framebuffer (self->command_queue);
+          glBindFramebuffer (GL_FRAMEBUFFER, atlas->framebuffer_id);
+          glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas->texture_id, 0);
+        }
+
+      if (atlas->evacuating)
+        {
+          atlas->n_live_entries = 0;
+          evacuating = TRUE;
+        }
+    }
+
+  /* Over the glyph cache budget, evacuate the atlas with the most
+   * entries that have not been used recently, even if it is below
+   * the usual threshold. Evacuating drops those entries.
+   */
+  if (!evacuating && atlas_bytes > gsk_get_glyph_cache_budget ())
+    {
+      GskGLTextureAtlas *victim = NULL;
+
+      for (guint i = 0; i < self->atlases->len; i++)
+        {
+          GskGLTextureAtlas *atlas = g_ptr_array_index (self->atlases, i);
+
+          if (atlas->unused_pixels > 0 &&
+              (victim == NULL || atlas->unused_pixels > victim->unused_pixels))
+            victim = atlas;
+        }
+
+      if (victim != NULL)
+        {
+          GSK_NOTE (GLYPH_CACHE,
+                    g_message ("Over budget, evacuating atlas (%.2f%% old)",
+                               100.0 * gsk_gl_texture_atlas_get_unused_ratio (victim)));
+
+          victim->evacuating = TRUE;
+          victim->framebuffer_id = gsk_gl_command_queue_create_framebuffer (self->command_queue);
+          glBindFramebuffer (GL_FRAMEBUFFER, victim->framebuffer_id);
+          glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, victim->texture_id, 0);
+          victim->n_live_entries = 0;
+          evacuating = TRUE;
+        }
+    }
+
+  if (evacuating)
+    {
+      budget -= gsk_gl_texture_library_compact (GSK_GL_TEXTURE_LIBRARY (self->glyphs), budget);
+      budget -= gsk_gl_texture_library_compact (GSK_GL_TEXTURE_LIBRARY (self->icons), budget);
+      if (self->sdf_glyphs != NULL)
+        gsk_gl_texture_library_compact (GSK_GL_TEXTURE_LIBRARY (self->sdf_glyphs), budget);
+
+      /* Atlases that are empty now can be released */
+      for (guint i = self->atlases->len; i > 0; i--)
+        {
+          GskGLTextureAtlas *atlas = g_ptr_array_index (self->atlases, i - 1);
+
+          if (atlas->evacuating && atlas->n_live_entries == 0)
+            {
+              GSK_NOTE (GLYPH_CACHE, g_message ("Dropping atlas %d", i));
+              if (removed == NULL)
+                removed = g_ptr_array_new_with_free_func ((GDestroyNotify)gsk_gl_texture_atlas_free);
+              g_ptr_array_add (removed, g_ptr_array_steal_index (self->atlases, i - 1));
+              self->n_evicted_atlases++;
+            }
         }
     }
 
@@ -546,6 +944,22 @@ gsk_gl_driver_compact_atlases (GskGLDriver *self)
       g_message ("%d atlases", self->atlases->len);
   });
 
+#ifdef G_ENABLE_DEBUG
+  if (self->command_queue->profiler != NULL)
+    {
+      gsk_profiler_counter_set (self->command_queue->profiler,
+                                self->command_queue->metrics.n_atlases,
+                                self->atlases->len);
+      gsk_profiler_counter_set (self->command_queue->profiler,
+                                self->command_queue->metrics.atlas_bytes,
+                                (gsize) self->atlases->len * ATLAS_SIZE * ATLAS_SIZE * 4);
+      if (removed != NULL)
+        gsk_profiler_counter_add (self->command_queue->profiler,
+                                  self->command_queue->metrics.n_removed_atlases,
+                                  removed->len);
+    }
+#endif
+
   return removed;
 }
 
@@ -574,8 +988,14 @@ gsk_gl_driver_begin_frame (GskGLDriver       *self,
   last_frame_id = self->current_frame_id;
 
   self->in_frame = TRUE;
+  self->has_pending_uploads = FALSE;
   self->current_frame_id++;
 
+  self->last_render_target_bytes = self->render_target_bytes;
+  self->last_n_render_targets = self->n_render_targets;
+  self->render_target_bytes = 0;
+  self->n_render_targets = 0;
+
   g_set_object (&self->command_queue, command_queue);
 
   gsk_gl_command_queue_begin_frame (self->command_queue);
@@ -590,16 +1010,24 @@ gsk_gl_driver_begin_frame (GskGLDriver       *self,
   gsk_gl_texture_library_begin_frame (GSK_GL_TEXTURE_LIBRARY (self->glyphs),
                                        self->current_frame_id,
                                        removed);
+  if (self->sdf_glyphs != NULL)
+    gsk_gl_texture_library_begin_frame (GSK_GL_TEXTURE_LIBRARY (self->sdf_glyphs),
+                                         self->current_frame_id,
+                                         removed);
 
   /* Cleanup old shadows */
   gsk_gl_shadow_library_begin_frame (self->shadows);
 
+  gsk_gl_driver_collect_uploads (self);
+
   /* Remove all textures that are from a previous frame or are no
    * longer used by linked GdkTexture. We do this at the beginning
    * of the following frame instead of the end so that we reduce chances
    * we block on any resources while delivering our frames.
    */
-  gsk_gl_driver_collect_unused_textures (self, last_frame_id - 1);
+  gsk_gl_driver_collect_unused_textures (self,
+                                         last_frame_id - 1,
+                                         last_frame_id - MAX_CACHED_TEXTURE_AGE);
 
   /* Now free atlas textures */
   g_clear_pointer (&removed, g_ptr_array_unref);
@@ -698,8 +1126,13 @@ gsk_gl_driver_get_context (GskGLDriver *self)
  * Textures can be looked up by @key after calling this function using
  * gsk_gl_driver_lookup_texture().
  *
- * Textures that have not been used within a number of frames will be
- * purged from the texture cache automatically.
+ * The key holds a reference on the render node in @key's pointer field
+ * so that the address cannot be reused by a different node while the
+ * texture is cached.
+ *
+ * Textures that have not been used within a number of frames, or that
+ * exceed the memory budget of the cache, will be purged from the texture
+ * cache automatically.
  */
 void
 gsk_gl_driver_cache_texture (GskGLDriver         *self,
@@ -714,6 +1147,7 @@ gsk_gl_driver_cache_texture (GskGLDriver         *self,
   g_assert (g_hash_table_contains (self->textures, GUINT_TO_POINTER (texture_id)));
 
   k = g_memdup (key, sizeof *key);
+  gsk_render_node_ref ((GskRenderNode *)k->pointer);
 
   g_hash_table_insert (self->key_to_texture_id, k, GUINT_TO_POINTER (texture_id));
   g_hash_table_insert (self->texture_id_to_key, GUINT_TO_POINTER (texture_id), k);
@@ -779,6 +1213,46 @@ gsk_gl_driver_load_texture (GskGLDriver *self,
           downloaded_texture = gdk_memory_texture_from_texture (texture, gdk_texture_get_format (texture));
         }
     }
+  else if (GDK_IS_DMABUF_TEXTURE (texture))
+    {
+      if ((t = gdk_texture_get_render_data (texture, self)))
+        {
+          if (t->min_filter == min_filter && t->mag_filter == mag_filter)
+            return t->texture_id;
+        }
+
+      /* Import the buffer as is, which avoids the copy through system
+       * memory. If the driver can't do that, fall back to a download.
+       */
+      glActiveTexture (GL_TEXTURE0);
+      texture_id = gdk_dmabuf_texture_import ((GdkDmabufTexture *) texture, context);
+      if (texture_id != 0)
+        {
+          glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+          glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
+
+          /* Restore previous texture state if any */
+          if (self->command_queue->attachments->textures[0].id > 0)
+            glBindTexture (self->command_queue->attachments->textures[0].target,
+                           self->command_queue->attachments->textures[0].id);
+
+          t = gsk_gl_texture_new (texture_id,
+                                  texture->width, texture->height, format, min_filter, mag_filter,
+                                  self->current_frame_id);
+
+          g_hash_table_insert (self->textures, GUINT_TO_POINTER (texture_id), t);
+
+          if (gdk_texture_set_render_data (texture, self, t, gsk_gl_texture_destroyed))
+            t->user = texture;
+
+          gdk_gl_context_label_object_printf (context, GL_TEXTURE, t->texture_id,
+                                              "GdkDmabufTexture<%p> %d", texture, t->texture_id);
+
+          return texture_id;
+        }
+
+      downloaded_texture = gdk_memory_texture_from_texture (texture, gdk_texture_get_format (texture));
+    }
   else
     {
       if ((t = gdk_texture_get_render_data (texture, self)))
@@ -818,6 +1292,179 @@ gsk_gl_driver_load_texture (GskGLDriver *self,
   return texture_id;
 }
 
+/**
+ * gsk_gl_driver_load_texture_async:
+ * @self: a `GskGLDriver`
+ * @texture: a `GdkTexture`
+ * @min_filter: GL_NEAREST or GL_LINEAR
+ * @mag_filter: GL_NEAREST or GL_LINEAR
+ *
+ * Like gsk_gl_driver_load_texture() but large textures are uploaded
+ * without blocking the frame on the transfer.
+ *
+ * While such an upload is in flight, 0 is returned and the caller is
+ * expected to draw a placeholder instead. #GskGLDriver.has_pending_uploads
+ * is set so that the renderer can schedule another frame.
+ *
+ * Returns: a texture identifier, or 0 if the texture is not ready yet
+ */
+guint
+gsk_gl_driver_load_texture_async (GskGLDriver *self,
+                                  GdkTexture  *texture,
+                                  int          min_filter,
+                                  int          mag_filter)
+{
+  GLsync fence = NULL;
+  GskGLTexture *t;
+  guint buffer_id = 0;
+  int texture_id;
+  int width;
+  int height;
+
+  g_return_val_if_fail (GSK_IS_GL_DRIVER (self), 0);
+  g_return_val_if_fail (GDK_IS_TEXTURE (texture), 0);
+
+  if (GDK_IS_GL_TEXTURE (texture) || GDK_IS_DMABUF_TEXTURE (texture))
+    return gsk_gl_driver_load_texture (self, texture, min_filter, mag_filter);
+
+  if ((t = gdk_texture_get_render_data (texture, self)) &&
+      t->min_filter == min_filter && t->mag_filter == mag_filter)
+    {
+      if (!gsk_gl_texture_is_uploaded (t))
+        {
+          self->has_pending_uploads = TRUE;
+          return 0;
+        }
+
+      return t->texture_id;
+    }
+
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+
+  if (width * height < ASYNC_UPLOAD_MIN_PIXELS)
+    return gsk_gl_driver_load_texture (self, texture, min_filter, mag_filter);
+
+  if (width <= self->command_queue->max_texture_size &&
+      height <= self->command_queue->max_texture_size &&
+      gsk_gl_driver_ensure_upload_thread (self))
+    {
+      /* Converting and uploading all happens in the upload thread */
+      if (!g_hash_table_contains (self->pending_uploads, texture))
+        {
+          GskGLUpload *upload;
+
+          upload = g_slice_new0 (GskGLUpload);
+          upload->texture = g_object_ref (texture);
+          upload->min_filter = min_filter;
+          upload->mag_filter = mag_filter;
+
+          g_hash_table_add (self->pending_uploads, texture);
+          g_thread_pool_push (self->upload_pool, upload, NULL);
+        }
+
+      self->has_pending_uploads = TRUE;
+      return 0;
+    }
+
+  texture_id = gsk_gl_command_queue_upload_texture_async (self->command_queue,
+                                                          texture,
+                                                          min_filter,
+                                                          mag_filter,
+                                                          &buffer_id,
+                                                          &fence);
+  if (texture_id <= 0)
+    return gsk_gl_driver_load_texture (self, texture, min_filter, mag_filter);
+
+  t = gsk_gl_texture_new (texture_id,
+                          width, height, GL_RGBA8, min_filter, mag_filter,
+                          self->current_frame_id);
+  t->upload_fence = fence;
+  t->upload_buffer_id = buffer_id;
+
+  g_hash_table_insert (self->textures, GUINT_TO_POINTER (texture_id), t);
+
+  if (gdk_texture_set_render_data (texture, self, t, gsk_gl_texture_destroyed))
+    t->user = texture;
+
+  gdk_gl_context_label_object_printf (self->command_queue->context, GL_TEXTURE, t->texture_id,
+                                      "GdkTexture<%p> %d", texture, t->texture_id);
+
+  self->has_pending_uploads = TRUE;
+
+  return 0;
+}
+
+/**
+ * gsk_gl_driver_note_minified:
+ * @self: a `GskGLDriver`
+ * @texture: a `GdkTexture` loaded with gsk_gl_driver_load_texture()
+ * @force: whether to generate mipmaps right away
+ *
+ * Records that @texture is drawn at less than half its size in the
+ * current frame.
+ *
+ * Linear filtering aliases badly at such scales, so once a texture
+ * has been drawn minified in MIPMAP_MIN_FRAMES frames, or when @force
+ * is set, mipmaps are generated for it. Since the texture is cached,
+ * this only happens once for its lifetime, and draws at full size
+ * are not affected.
+ */
+void
+gsk_gl_driver_note_minified (GskGLDriver *self,
+                             GdkTexture  *texture,
+                             gboolean     force)
+{
+  GskGLTexture *t;
+
+  g_return_if_fail (GSK_IS_GL_DRIVER (self));
+  g_return_if_fail (GDK_IS_TEXTURE (texture));
+
+  /* Imported dmabufs can't be modified */
+  if (GDK_IS_DMABUF_TEXTURE (texture))
+    return;
+
+  t = gdk_texture_get_render_data (texture, self);
+  if (t == NULL ||
+      t->has_mipmap ||
+      t->slices != NULL ||
+      t->min_filter != GL_LINEAR ||
+      !gsk_gl_texture_is_uploaded (t))
+    return;
+
+  if (t->last_minified_frame != self->current_frame_id)
+    {
+      t->last_minified_frame = self->current_frame_id;
+      t->n_minified_frames++;
+    }
+
+  if (!force && t->n_minified_frames < MIPMAP_MIN_FRAMES)
+    return;
+
+  /* GLES 2 only has mipmaps for power-of-two sizes */
+  if (gdk_gl_context_get_use_es (self->command_queue->context))
+    {
+      int major, minor;
+
+      gdk_gl_context_get_version (self->command_queue->context, &major, &minor);
+      if (major < 3 &&
+          ((t->width & (t->width - 1)) != 0 || (t->height & (t->height - 1)) != 0))
+        return;
+    }
+
+  glActiveTexture (GL_TEXTURE0);
+  glBindTexture (GL_TEXTURE_2D, t->texture_id);
+  glGenerateMipmap (GL_TEXTURE_2D);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+  /* Restore previous texture state if any */
+  if (self->command_queue->attachments->textures[0].id > 0)
+    glBindTexture (self->command_queue->attachments->textures[0].target,
+                   self->command_queue->attachments->textures[0].id);
+
+  t->has_mipmap = TRUE;
+}
+
 /**
  * gsk_gl_driver_create_texture:
  * @self: a `GskGLDriver`
@@ -975,6 +1622,10 @@ gsk_gl_driver_create_render_target (GskGLDriver        *self,
       render_target->framebuffer_id = framebuffer_id;
       render_target->texture_id = texture_id;
 
+      self->render_target_bytes += (gsize) width * (gsize) height *
+                                   gsk_gl_format_get_bytes_per_pixel (format);
+      self->n_render_targets++;
+
       *out_render_target = render_target;
 
       return TRUE;
@@ -1162,6 +1813,166 @@ gsk_gl_driver_lookup_shader (GskGLDriver  *self,
   return program;
 }
 
+static void
+add_memory_usage (GArray     *usage,
+                  const char *name,
+                  gsize       bytes,
+                  guint       n_items,
+                  guint64     n_evictions)
+{
+  GskRendererMemoryUsage u = { name, bytes, n_items, n_evictions };
+
+  g_array_append_val (usage, u);
+}
+
+static void
+add_library_memory_usage (GArray              *usage,
+                          const char          *name,
+                          GskGLTextureLibrary *library,
+                          gsize               *atlased_bytes)
+{
+  gsize bytes, atlased;
+  guint n_items;
+
+  gsk_gl_texture_library_get_memory_usage (library, &bytes, &atlased, &n_items);
+  add_memory_usage (usage, name, bytes, n_items, library->n_evictions);
+
+  *atlased_bytes += atlased;
+}
+
+static gsize
+get_program_size (GskGLProgram *program,
+                  gboolean      has_binary_length)
+{
+  int length = 0;
+
+  if (program == NULL || program->id <= 0 || !has_binary_length)
+    return 0;
+
+  glGetProgramiv (program->id, GL_PROGRAM_BINARY_LENGTH, &length);
+
+  return MAX (length, 0);
+}
+
+/**
+ * gsk_gl_driver_get_memory_usage:
+ * @self: a `GskGLDriver`
+ * @usage: (element-type GskRendererMemoryUsage): array to add to
+ *
+ * Adds up the GPU memory used by the caches of the driver. The
+ * entries don't overlap: atlases are split up between the libraries
+ * using them, and only the space that no library uses is counted
+ * as atlas space.
+ *
+ * Programs are measured by the size of their binaries if the GL
+ * implementation can tell, which is only an estimate of what the
+ * driver keeps around.
+ */
+void
+gsk_gl_driver_get_memory_usage (GskGLDriver *self,
+                                GArray      *usage)
+{
+  GdkGLContext *context;
+  GHashTableIter iter;
+  gpointer k, v;
+  gsize atlased_bytes = 0;
+  gsize atlas_bytes;
+  gsize shadow_bytes;
+  guint n_shadows;
+  guint64 n_evicted_shadows;
+  gsize texture_bytes = 0, offscreen_bytes = 0;
+  guint n_textures = 0, n_offscreens = 0;
+  gsize program_bytes = 0;
+  guint n_programs = 0;
+  gboolean has_binary_length;
+
+  g_return_if_fail (GSK_IS_GL_DRIVER (self));
+  g_return_if_fail (usage != NULL);
+
+  add_library_memory_usage (usage, "glyphs", GSK_GL_TEXTURE_LIBRARY (self->glyphs), &atlased_bytes);
+  add_library_memory_usage (usage, "icons", GSK_GL_TEXTURE_LIBRARY (self->icons), &atlased_bytes);
+  if (self->sdf_glyphs != NULL)
+    add_library_memory_usage (usage, "sdf glyphs", GSK_GL_TEXTURE_LIBRARY (self->sdf_glyphs), &atlased_bytes);
+
+  atlas_bytes = (gsize) self->atlases->len * ATLAS_SIZE * ATLAS_SIZE * 4;
+  add_memory_usage (usage, "unused atlas space",
+                    atlas_bytes > atlased_bytes ? atlas_bytes - atlased_bytes : 0,
+                    self->atlases->len,
+                    self->n_evicted_atlases);
+
+  gsk_gl_shadow_library_get_memory_usage (self->shadows, &shadow_bytes, &n_shadows, &n_evicted_shadows);
+  add_memory_usage (usage, "shadows", shadow_bytes, n_shadows, n_evicted_shadows);
+
+  /* Permanent textures belong to the libraries, and were counted above */
+  g_hash_table_iter_init (&iter, self->textures);
+  while (g_hash_table_iter_next (&iter, &k, &v))
+    {
+      GskGLTexture *t = v;
+
+      if (t->permanent)
+        continue;
+
+      if (g_hash_table_contains (self->texture_id_to_key, k))
+        {
+          offscreen_bytes += gsk_gl_texture_get_n_bytes (t);
+          n_offscreens++;
+        }
+      else if (t->user != NULL)
+        {
+          texture_bytes += gsk_gl_texture_get_n_bytes (t);
+          n_textures++;
+        }
+
+      /* The rest are offscreens of the last frames,
+       * and part of the render targets
+       */
+    }
+
+  add_memory_usage (usage, "textures", texture_bytes, n_textures, self->n_evicted_textures);
+  add_memory_usage (usage, "cached offscreens", offscreen_bytes, n_offscreens, self->n_evicted_offscreens);
+  add_memory_usage (usage, "render targets",
+                    self->last_render_target_bytes,
+                    self->last_n_render_targets,
+                    0);
+
+  context = gsk_gl_driver_get_context (self);
+  gdk_gl_context_make_current (context);
+  has_binary_length = gdk_gl_context_check_version (context, 4, 1, 3, 0) ||
+                      epoxy_has_gl_extension ("GL_ARB_get_program_binary");
+
+#define GSK_GL_NO_UNIFORMS
+#define GSK_GL_ADD_UNIFORM(pos, KEY, name)
+#define GSK_GL_DEFINE_PROGRAM(name, resource, uniforms) \
+  GSK_GL_COUNT_PROGRAM(name);                           \
+  GSK_GL_COUNT_PROGRAM(name ## _no_clip);               \
+  GSK_GL_COUNT_PROGRAM(name ## _rect_clip);
+#define GSK_GL_COUNT_PROGRAM(name)                                          \
+  G_STMT_START {                                                            \
+    if (self->name)                                                         \
+      {                                                                     \
+        program_bytes += get_program_size (self->name, has_binary_length);  \
+        n_programs++;                                                       \
+      }                                                                     \
+  } G_STMT_END;
+# include "gskglprograms.defs"
+#undef GSK_GL_NO_UNIFORMS
+#undef GSK_GL_ADD_UNIFORM
+#undef GSK_GL_DEFINE_PROGRAM
+#undef GSK_GL_COUNT_PROGRAM
+
+  g_hash_table_iter_init (&iter, self->shader_cache);
+  while (g_hash_table_iter_next (&iter, NULL, &v))
+    {
+      if (v != NULL)
+        {
+          program_bytes += get_program_size (v, has_binary_length);
+          n_programs++;
+        }
+    }
+
+  add_memory_usage (usage, "programs", program_bytes, n_programs, 0);
+}
+
 #ifdef G_ENABLE_DEBUG
 static void
 write_atlas_to_png (GskGLDriver       *driver,
@@ -58,7 +58,7 @@ enum {
 };
 
 typedef struct {
-  gconstpointer   pointer;
+  gconstpointer   pointer; /* A GskRenderNode */
   float           scale_x;
   float           scale_y;
   int             filter;
@@ -101,6 +101,7 @@ struct _GskGLDriver
   GskGLCommandQueue *command_queue;
 
   GskGLGlyphLibrary *glyphs;
+  GskGLSdfGlyphLibrary *sdf_glyphs;
   GskGLIconLibrary *icons;
   GskGLShadowLibrary *shadows;
 
@@ -125,6 +126,16 @@ struct _GskGLDriver
 # include "gskglprograms.defs"
 #undef GSK_GL_NO_UNIFORMS
 #undef GSK_GL_ADD_UNIFORM
+#undef GSK_GL_DEFINE_PROGRAM
+
+  /* Programs that failed to compile, their nodes are drawn with cairo */
+#define GSK_GL_NO_UNIFORMS
+#define GSK_GL_ADD_UNIFORM(pos, KEY, name)
+#define GSK_GL_DEFINE_PROGRAM(name, resource, uniforms) \
+  guint name ## _failed : 1;
+# include "gskglprograms.defs"
+#undef GSK_GL_NO_UNIFORMS
+#undef GSK_GL_ADD_UNIFORM
 #undef GSK_GL_DEFINE_PROGRAM
 
   gint64 current_frame_id;
@@ -134,8 +145,43 @@ struct _GskGLDriver
 
   guint debug : 1;
   guint in_frame : 1;
+
+  /* If a texture was skipped this frame because it was still uploading */
+  guint has_pending_uploads : 1;
+  guint upload_thread_failed : 1;
+
+  /* For gsk_gl_driver_get_memory_usage(), evictions are counted forever
+   * and render targets for the last completed frame.
+   */
+  guint64 n_evicted_atlases;
+  guint64 n_evicted_textures;
+  guint64 n_evicted_offscreens;
+  gsize render_target_bytes;
+  guint n_render_targets;
+  gsize last_render_target_bytes;
+  guint last_n_render_targets;
+
+  /* Uploads from a worker thread, see gsk_gl_driver_load_texture_async() */
+  GdkGLContext *upload_context;
+  GThreadPool *upload_pool;
+  GAsyncQueue *finished_uploads;
+  GHashTable *pending_uploads;
 };
 
+#define GSK_GL_NO_UNIFORMS
+#define GSK_GL_ADD_UNIFORM(pos, KEY, name)
+#define GSK_GL_DEFINE_PROGRAM(name, resource, uniforms) \
+  gboolean gsk_gl_driver_load_ ## name (GskGLDriver *self);
+# include "gskglprograms.defs"
+#undef GSK_GL_NO_UNIFORMS
+#undef GSK_GL_ADD_UNIFORM
+#undef GSK_GL_DEFINE_PROGRAM
+
+/* Returns whether the program called @name and its clip variants can
+ * be used, compiling them on first use */
+#define gsk_gl_driver_ensure_program(self, name) \
+  (G_LIKELY ((self)->name != NULL) || gsk_gl_driver_load_ ## name (self))
+
 GskGLDriver       * gsk_gl_driver_for_display            (GdkDisplay          *display,
                                                           gboolean             debug_shaders,
                                                           GError             **error);
@@ -165,6 +211,13 @@ guint               gsk_gl_driver_load_texture           (GskGLDriver         *s
                                                           GdkTexture          *texture,
                                                           int                  min_filter,
                                                           int                  mag_filter);
+guint               gsk_gl_driver_load_texture_async     (GskGLDriver         *self,
+                                                          GdkTexture          *texture,
+                                                          int                  min_filter,
+                                                          int                  mag_filter);
+void                gsk_gl_driver_note_minified          (GskGLDriver         *self,
+                                                          GdkTexture          *texture,
+                                                          gboolean             force);
 GskGLTexture      * gsk_gl_driver_create_texture         (GskGLDriver         *self,
                                                           float                width,
                                                           float                height,
@@ -186,6 +239,9 @@ GskGLProgram      * gsk_gl_driver_lookup_shader          (GskGLDriver         *s
                                                           GError             **error);
 GskGLTextureAtlas * gsk_gl_driver_create_atlas           (GskGLDriver         *self);
 
+void                gsk_gl_driver_get_memory_usage       (GskGLDriver         *self,
+                                                          GArray              *usage);
+
 #ifdef G_ENABLE_DEBUG
 void                gsk_gl_driver_save_atlases_to_png    (GskGLDriver         *self,
                                                           const char          *directory);
@@ -112,6 +112,7 @@ gsk_gl_glyph_library_class_init (GskGLGlyphLibraryClass *klass)
   object_class->finalize = gsk_gl_glyph_library_finalize;
 
   library_class->begin_frame = gsk_gl_glyph_library_begin_frame;
+  library_class->profiler_name = "glyph";
 }
 
 static void
@@ -79,6 +79,7 @@ gsk_gl_glyph_library_lookup_or_add (GskGLGlyphLibrary      *self,
   if (memcmp (key, &self->front[front_index], sizeof *key) == 0)
     {
       *out_value = self->front[front_index].value;
+      ((GskGLTextureLibrary *)self)->n_hits++;
     }
   else if (gsk_gl_texture_library_lookup ((GskGLTextureLibrary *)self, key, &entry))
     {
@@ -51,13 +51,43 @@ gsk_gl_icon_data_free (gpointer data)
 {
   GskGLIconData *icon_data = data;
 
-  g_clear_object (&icon_data->source_texture);
+  if (icon_data->owns_texture)
+    {
+      g_clear_object (&icon_data->source_texture);
+    }
+  else if (icon_data->source_texture)
+    {
+      GdkTexture *texture = g_steal_pointer (&icon_data->source_texture);
+
+      gdk_texture_clear_render_data (texture);
+    }
+
   g_slice_free (GskGLIconData, icon_data);
 }
 
+static void
+gsk_gl_icon_data_texture_destroyed (gpointer data)
+{
+  GskGLIconData *icon_data = data;
+  GdkTexture *texture;
+
+  /* Called from gsk_gl_icon_data_free() */
+  if (icon_data->source_texture == NULL)
+    return;
+
+  /* The texture is gone, so nobody can look up the entry anymore.
+   * Give its pixels back to the atlas right away. */
+  texture = g_steal_pointer (&icon_data->source_texture);
+  gsk_gl_texture_atlas_entry_mark_unused (&icon_data->entry);
+  g_hash_table_remove (icon_data->library->hash_table, texture);
+}
+
 static void
 gsk_gl_icon_library_class_init (GskGLIconLibraryClass *klass)
 {
+  GskGLTextureLibraryClass *library_class = GSK_GL_TEXTURE_LIBRARY_CLASS (klass);
+
+  library_class->profiler_name = "icon";
 }
 
 static void
@@ -103,7 +133,14 @@ gsk_gl_icon_library_add (GskGLIconLibrary     *self,
                                            sizeof (GskGLIconData),
                                            width, height, 1,
                                            &packed_x, &packed_y);
-  icon_data->source_texture = g_object_ref (key);
+  icon_data->library = tl;
+  icon_data->source_texture = key;
+  if (!gdk_texture_set_render_data (key, self, icon_data, gsk_gl_icon_data_texture_destroyed))
+    {
+      /* Somebody else is tracking the texture already */
+      g_object_ref (key);
+      icon_data->owns_texture = TRUE;
+    }
 
   /* actually upload the texture */
   surface = gdk_texture_download_surface (key);
@@ -32,7 +32,11 @@ G_BEGIN_DECLS
 typedef struct _GskGLIconData
 {
   GskGLTextureAtlasEntry entry;
+  GskGLTextureLibrary *library;
+  /* Not owned if tracked via render data, so the entry goes away
+   * together with the texture instead of keeping it alive */
   GdkTexture *source_texture;
+  guint owns_texture : 1;
 } GskGLIconData;
 
 G_DECLARE_FINAL_TYPE (GskGLIconLibrary, gsk_gl_icon_library, GSK, GL_ICON_LIBRARY, GskGLTextureLibrary)
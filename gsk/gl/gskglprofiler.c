@@ -2,10 +2,21 @@
 
 #include "gskglprofilerprivate.h"
 
+#include <gdk/gdkprofilerprivate.h>
 #include <epoxy/gl.h>
 
 #define N_QUERIES       4
 
+/* Timestamps of a single frame, resolved N_QUERIES frames later */
+typedef struct _GskGLTimestampFrame
+{
+  GArray *queries;
+  GArray *tags;
+  guint n_used;
+  gint64 cpu_base;
+  GLint64 gpu_base;
+} GskGLTimestampFrame;
+
 struct _GskGLProfiler
 {
   GObject parent_instance;
@@ -18,6 +29,9 @@ struct _GskGLProfiler
   GLuint gl_queries[N_QUERIES];
   GLuint active_query;
 
+  GskGLTimestampFrame timestamps[N_QUERIES];
+  guint active_timestamps;
+
   gboolean has_queries : 1;
   gboolean has_timer : 1;
   gboolean first_frame : 1;
@@ -41,6 +55,20 @@ gsk_gl_profiler_finalize (GObject *gobject)
   if (self->has_queries)
     glDeleteQueries (N_QUERIES, self->gl_queries);
 
+  for (guint i = 0; i < N_QUERIES; i++)
+    {
+      GskGLTimestampFrame *frame = &self->timestamps[i];
+
+      if (frame->queries == NULL)
+        continue;
+
+      if (frame->queries->len > 0)
+        glDeleteQueries (frame->queries->len, (GLuint *)(gpointer)frame->queries->data);
+
+      g_array_unref (frame->queries);
+      g_array_unref (frame->tags);
+    }
+
   g_clear_object (&self->gl_context);
 
   G_OBJECT_CLASS (gsk_gl_profiler_parent_class)->finalize (gobject);
@@ -179,3 +207,140 @@ gsk_gl_profiler_end_gpu_region (GskGLProfiler *profiler)
 
   return elapsed / 1000; /* Convert to usec to match other profiler APIs */
 }
+
+gboolean
+gsk_gl_profiler_has_timestamps (GskGLProfiler *profiler)
+{
+  g_return_val_if_fail (GSK_IS_GL_PROFILER (profiler), FALSE);
+
+  return profiler->has_timer && profiler->has_queries;
+}
+
+/**
+ * gsk_gl_profiler_begin_timestamps:
+ * @profiler: a `GskGLProfiler`
+ *
+ * Starts recording GPU timestamps for a frame. Each call to
+ * gsk_gl_profiler_add_timestamp() starts a span of GPU work that
+ * lasts until the next timestamp.
+ */
+void
+gsk_gl_profiler_begin_timestamps (GskGLProfiler *profiler)
+{
+  GskGLTimestampFrame *frame;
+
+  g_return_if_fail (GSK_IS_GL_PROFILER (profiler));
+
+  if (!gsk_gl_profiler_has_timestamps (profiler))
+    return;
+
+  frame = &profiler->timestamps[profiler->active_timestamps];
+
+  if (frame->queries == NULL)
+    {
+      frame->queries = g_array_new (FALSE, FALSE, sizeof (GLuint));
+      frame->tags = g_array_new (FALSE, FALSE, sizeof (guint));
+    }
+
+  /* Results that were never collected are dropped */
+  frame->n_used = 0;
+
+  /* Used to translate GPU timestamps into the profiler's clock */
+  glGetInteger64v (GL_TIMESTAMP, &frame->gpu_base);
+  frame->cpu_base = GDK_PROFILER_CURRENT_TIME;
+}
+
+void
+gsk_gl_profiler_add_timestamp (GskGLProfiler *profiler,
+                               guint          tag)
+{
+  GskGLTimestampFrame *frame;
+  GLuint query_id;
+
+  g_return_if_fail (GSK_IS_GL_PROFILER (profiler));
+
+  if (!gsk_gl_profiler_has_timestamps (profiler))
+    return;
+
+  frame = &profiler->timestamps[profiler->active_timestamps];
+
+  g_assert (frame->queries != NULL);
+
+  if (frame->n_used == frame->queries->len)
+    {
+      glGenQueries (1, &query_id);
+      g_array_append_val (frame->queries, query_id);
+      g_array_set_size (frame->tags, frame->queries->len);
+    }
+
+  query_id = g_array_index (frame->queries, GLuint, frame->n_used);
+  g_array_index (frame->tags, guint, frame->n_used) = tag;
+  frame->n_used++;
+
+  glQueryCounter (query_id, GL_TIMESTAMP);
+}
+
+/**
+ * gsk_gl_profiler_end_timestamps:
+ * @profiler: a `GskGLProfiler`
+ * @spans: an array of `GskGLProfilerSpan`
+ *
+ * Ends recording of the current frame's timestamps and collects the
+ * results of the oldest recorded frame, if the GPU has finished it.
+ *
+ * Returns: %TRUE if spans were appended to @spans
+ */
+gboolean
+gsk_gl_profiler_end_timestamps (GskGLProfiler *profiler,
+                                GArray        *spans)
+{
+  GskGLTimestampFrame *frame;
+  GLuint64 prev_time = 0;
+  GLint available = 0;
+
+  g_return_val_if_fail (GSK_IS_GL_PROFILER (profiler), FALSE);
+  g_return_val_if_fail (spans != NULL, FALSE);
+
+  if (!gsk_gl_profiler_has_timestamps (profiler))
+    return FALSE;
+
+  /* Close the last span */
+  gsk_gl_profiler_add_timestamp (profiler, 0);
+
+  profiler->active_timestamps = (profiler->active_timestamps + 1) % N_QUERIES;
+
+  /* The slot we will record into next holds the oldest frame */
+  frame = &profiler->timestamps[profiler->active_timestamps];
+
+  if (frame->queries == NULL || frame->n_used < 2)
+    return FALSE;
+
+  glGetQueryObjectiv (g_array_index (frame->queries, GLuint, frame->n_used - 1),
+                      GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available)
+    return FALSE;
+
+  for (guint i = 0; i < frame->n_used; i++)
+    {
+      GLuint64 time;
+
+      glGetQueryObjectui64v (g_array_index (frame->queries, GLuint, i), GL_QUERY_RESULT, &time);
+
+      if (i > 0)
+        {
+          GskGLProfilerSpan span;
+
+          span.tag = g_array_index (frame->tags, guint, i - 1);
+          span.begin_time = frame->cpu_base + ((gint64)prev_time - frame->gpu_base);
+          span.duration = time - prev_time;
+
+          g_array_append_val (spans, span);
+        }
+
+      prev_time = time;
+    }
+
+  frame->n_used = 0;
+
+  return TRUE;
+}
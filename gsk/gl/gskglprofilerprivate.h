@@ -13,6 +13,20 @@ GskGLProfiler * gsk_gl_profiler_new                     (GdkGLContext  *context)
 void            gsk_gl_profiler_begin_gpu_region        (GskGLProfiler *profiler);
 guint64         gsk_gl_profiler_end_gpu_region          (GskGLProfiler *profiler);
 
+typedef struct _GskGLProfilerSpan
+{
+  guint  tag;
+  gint64 begin_time; /* In GDK_PROFILER_CURRENT_TIME units */
+  gint64 duration;   /* In nanoseconds */
+} GskGLProfilerSpan;
+
+gboolean        gsk_gl_profiler_has_timestamps          (GskGLProfiler *profiler);
+void            gsk_gl_profiler_begin_timestamps        (GskGLProfiler *profiler);
+void            gsk_gl_profiler_add_timestamp           (GskGLProfiler *profiler,
+                                                         guint          tag);
+gboolean        gsk_gl_profiler_end_timestamps          (GskGLProfiler *profiler,
+                                                         GArray        *spans);
+
 G_END_DECLS
 
 #endif /* __GSK_GL_PROFILER_PRIVATE_H__ */
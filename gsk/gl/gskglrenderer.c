@@ -22,6 +22,7 @@
 
 #include <gdk/gdkprofilerprivate.h>
 #include <gdk/gdkdisplayprivate.h>
+#include <gdk/gdkframeclockprivate.h>
 #include <gdk/gdkglcontextprivate.h>
 #include <gdk/gdksurfaceprivate.h>
 #include <gsk/gskdebugprivate.h>
@@ -184,8 +185,10 @@ get_render_region (GdkSurface   *surface,
   if (gdk_rectangle_equal (&extents, &whole_surface))
     return NULL;
 
-  /* Draw clipped to the bounding-box of the region. */
-  return cairo_region_create_rectangle (&extents);
+  /* The render job decides whether to draw the rectangles of the
+   * region individually or clipped to its bounding box.
+   */
+  return cairo_region_copy (damage);
 }
 
 static void
@@ -198,18 +201,25 @@ gsk_gl_renderer_render (GskRenderer          *renderer,
   graphene_rect_t viewport;
   GskGLRenderJob *job;
   GdkSurface *surface;
+  GdkFrameClock *clock;
   float scale_factor;
+  int buffer_width, buffer_height;
+  gint64 before;
 
   g_assert (GSK_IS_GL_RENDERER (renderer));
   g_assert (root != NULL);
 
   surface = gdk_draw_context_get_surface (GDK_DRAW_CONTEXT (self->context));
-  scale_factor = gdk_surface_get_scale_factor (surface);
+  clock = gdk_surface_get_frame_clock (surface);
+  before = _gdk_frame_clock_begin_span (clock);
+
+  scale_factor = gdk_surface_get_scale (surface);
+  gdk_surface_get_buffer_size (surface, &buffer_width, &buffer_height);
 
   viewport.origin.x = 0;
   viewport.origin.y = 0;
-  viewport.size.width = gdk_surface_get_width (surface) * scale_factor;
-  viewport.size.height = gdk_surface_get_height (surface) * scale_factor;
+  viewport.size.width = buffer_width;
+  viewport.size.height = buffer_height;
 
   gdk_draw_context_begin_frame_full (GDK_DRAW_CONTEXT (self->context),
                                      gsk_render_node_prefers_high_depth (root),
@@ -221,46 +231,55 @@ gsk_gl_renderer_render (GskRenderer          *renderer,
   render_region = get_render_region (surface, self->context);
 
   gsk_gl_driver_begin_frame (self->driver, self->command_queue);
-  job = gsk_gl_render_job_new (self->driver, &viewport, scale_factor, render_region, 0);
+  job = gsk_gl_render_job_new (self->driver, &viewport, scale_factor, render_region,
+                               gdk_gl_context_get_default_framebuffer (self->context));
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (GSK_RENDERER (self), FALLBACK))
     gsk_gl_render_job_set_debug_fallback (job, TRUE);
 #endif
+  gsk_gl_render_job_set_async_uploads (job, TRUE);
   gsk_gl_render_job_render (job, root);
   gsk_gl_driver_end_frame (self->driver);
   gsk_gl_render_job_free (job);
 
+  _gdk_frame_clock_end_span (clock, GDK_FRAME_SPAN_RENDER, before);
+  before = _gdk_frame_clock_begin_span (clock);
+
   gdk_draw_context_end_frame (GDK_DRAW_CONTEXT (self->context));
 
+  _gdk_frame_clock_end_span (clock, GDK_FRAME_SPAN_SUBMIT, before);
+
+  /* Some textures were left out while uploading, so make sure
+   * that another frame follows to draw them.
+   */
+  if (self->driver->has_pending_uploads)
+    gdk_surface_invalidate_rect (surface, NULL);
+
   gsk_gl_driver_after_frame (self->driver);
 
   cairo_region_destroy (render_region);
 }
 
+/* Renders one texture in its own frame, but leaves the cleanup of
+ * gsk_gl_driver_after_frame() to the caller, so that it can be done
+ * once after a batch of textures.
+ */
 static GdkTexture *
-gsk_gl_renderer_render_texture (GskRenderer           *renderer,
-                                GskRenderNode         *root,
-                                const graphene_rect_t *viewport)
+gsk_gl_renderer_render_one_texture (GskGLRenderer         *self,
+                                    GskRenderNode         *root,
+                                    const graphene_rect_t *viewport,
+                                    int                    format)
 {
-  GskGLRenderer *self = (GskGLRenderer *)renderer;
   GskGLRenderTarget *render_target;
   GskGLRenderJob *job;
   GdkTexture *texture = NULL;
   guint texture_id;
   int width;
   int height;
-  int format;
-
-  g_assert (GSK_IS_GL_RENDERER (renderer));
-  g_assert (root != NULL);
 
   width = ceilf (viewport->size.width);
   height = ceilf (viewport->size.height);
 
-  format = gsk_render_node_prefers_high_depth (root) ? GL_RGBA32F : GL_RGBA8;
-
-  gdk_gl_context_make_current (self->context);
-
   if (gsk_gl_driver_create_render_target (self->driver,
                                           width, height,
                                           format,
@@ -278,13 +297,61 @@ gsk_gl_renderer_render_texture (GskRenderer           *renderer,
       texture = gsk_gl_driver_create_gdk_texture (self->driver, texture_id);
       gsk_gl_driver_end_frame (self->driver);
       gsk_gl_render_job_free (job);
-
-      gsk_gl_driver_after_frame (self->driver);
     }
 
   return g_steal_pointer (&texture);
 }
 
+static GdkTexture *
+gsk_gl_renderer_render_texture (GskRenderer           *renderer,
+                                GskRenderNode         *root,
+                                const graphene_rect_t *viewport)
+{
+  GskGLRenderer *self = (GskGLRenderer *)renderer;
+  GdkTexture *texture;
+  int format;
+
+  g_assert (GSK_IS_GL_RENDERER (renderer));
+  g_assert (root != NULL);
+
+  format = gsk_render_node_prefers_high_depth (root) ? GL_RGBA32F : GL_RGBA8;
+
+  gdk_gl_context_make_current (self->context);
+
+  texture = gsk_gl_renderer_render_one_texture (self, root, viewport, format);
+
+  gsk_gl_driver_after_frame (self->driver);
+
+  return texture;
+}
+
+static void
+gsk_gl_renderer_render_textures (GskRenderer           *renderer,
+                                 GskRenderNode         *root,
+                                 const graphene_rect_t *viewports,
+                                 guint                  n_viewports,
+                                 GdkTexture           **textures)
+{
+  GskGLRenderer *self = (GskGLRenderer *)renderer;
+  int format;
+  guint i;
+
+  g_assert (GSK_IS_GL_RENDERER (renderer));
+  g_assert (root != NULL);
+
+  format = gsk_render_node_prefers_high_depth (root) ? GL_RGBA32F : GL_RGBA8;
+
+  gdk_gl_context_make_current (self->context);
+
+  /* Glyphs, icons and textures uploaded for the first viewport stay
+   * in the driver caches for the following ones.
+   */
+  for (i = 0; i < n_viewports; i++)
+    textures[i] = gsk_gl_renderer_render_one_texture (self, root, &viewports[i], format);
+
+  gsk_gl_driver_after_frame (self->driver);
+}
+
 static void
 gsk_gl_renderer_dispose (GObject *object)
 {
@@ -297,6 +364,18 @@ gsk_gl_renderer_dispose (GObject *object)
   G_OBJECT_CLASS (gsk_gl_renderer_parent_class)->dispose (object);
 }
 
+static void
+gsk_gl_renderer_get_memory_usage (GskRenderer *renderer,
+                                  GArray      *usage)
+{
+  GskGLRenderer *self = (GskGLRenderer *)renderer;
+
+  g_assert (GSK_IS_GL_RENDERER (self));
+
+  if (self->driver != NULL)
+    gsk_gl_driver_get_memory_usage (self->driver, usage);
+}
+
 static void
 gsk_gl_renderer_class_init (GskGLRendererClass *klass)
 {
@@ -309,6 +388,8 @@ gsk_gl_renderer_class_init (GskGLRendererClass *klass)
   renderer_class->unrealize = gsk_gl_renderer_unrealize;
   renderer_class->render = gsk_gl_renderer_render;
   renderer_class->render_texture = gsk_gl_renderer_render_texture;
+  renderer_class->render_textures = gsk_gl_renderer_render_textures;
+  renderer_class->get_memory_usage = gsk_gl_renderer_get_memory_usage;
 }
 
 static void
@@ -40,6 +40,7 @@
 #include "gskgliconlibraryprivate.h"
 #include "gskglprogramprivate.h"
 #include "gskglrenderjobprivate.h"
+#include "gskglsdfglyphlibraryprivate.h"
 #include "gskglshadowlibraryprivate.h"
 
 #include "ninesliceprivate.h"
@@ -47,11 +48,16 @@
 
 #define ORTHO_NEAR_PLANE   -10000
 #define ORTHO_FAR_PLANE     10000
-#define MAX_GRADIENT_STOPS  6
+#define MAX_GRADIENT_STOPS  16
 #define SHADOW_EXTRA_SIZE   4
+#define MAX_DAMAGE_RECTS    4
 
-/* Make sure gradient stops fits in packed array_count */
-G_STATIC_ASSERT ((MAX_GRADIENT_STOPS * 5) < (1 << GSK_GL_UNIFORM_ARRAY_BITS));
+/* Make sure gradient stops fits in packed array_count, see
+ * gsk_gl_render_job_set_color_stops() for the layout.
+ */
+#define GRADIENT_STOPS_ARRAY_COUNT (MAX_GRADIENT_STOPS / 4 + MAX_GRADIENT_STOPS)
+G_STATIC_ASSERT (MAX_GRADIENT_STOPS % 4 == 0);
+G_STATIC_ASSERT (GRADIENT_STOPS_ARRAY_COUNT < (1 << GSK_GL_UNIFORM_ARRAY_BITS));
 
 #define rounded_rect_top_left(r)                                                        \
   (GRAPHENE_RECT_INIT(r->bounds.origin.x,                                               \
@@ -114,9 +120,22 @@ struct _GskGLRenderJob
    */
   GskGLCommandQueue *command_queue;
 
-  /* The region that we are clipping. Normalized to a single rectangle region. */
+  /* The region that we are clipping. Normalized to a single rectangle region,
+   * unless it consists of a few rectangles far apart from each other.
+   */
   cairo_region_t *region;
 
+  /* If @region has several rectangles, those in clip coordinates so that
+   * nodes in between them can be skipped.
+   */
+  graphene_rect_t damage_rects[MAX_DAMAGE_RECTS];
+  guint n_damage_rects;
+
+  /* Nesting of offscreen rendering, @damage_rects only apply to the
+   * target framebuffer.
+   */
+  guint offscreen_depth;
+
   /* The framebuffer to draw to in the @context GL context. So 0 would be the
    * default framebuffer of @context. This is important to note as many other
    * operations could be done using objects shared from the command queues
@@ -163,6 +182,22 @@ struct _GskGLRenderJob
   /* If we should be rendering red zones over fallback nodes */
   guint debug_fallback : 1;
 
+  /* If fallback nodes may be rasterized on worker threads */
+  guint threaded_fallbacks : 1;
+
+  /* If large textures may be skipped while they are uploading */
+  guint async_uploads : 1;
+
+  /* Fallback nodes which are being rasterized on worker threads. The
+   * texture identifiers are allocated up front so that batches can
+   * reference them, and the contents are uploaded before the command
+   * queue is executed.
+   */
+  GPtrArray *pending_fallbacks;
+  GMutex pending_mutex;
+  GCond pending_cond;
+  guint n_pending;
+
   /* Format we want to use for intermediate textures, determined by
    * looking at the format of the framebuffer we are rendering on.
    */
@@ -197,6 +232,19 @@ typedef struct _GskGLRenderOffscreen
   guint was_offscreen : 1;
 } GskGLRenderOffscreen;
 
+typedef struct _GskGLRenderFallback
+{
+  GskGLRenderJob  *job;
+  GskRenderNode   *node;
+  cairo_surface_t *surface;
+  float            scale_x;
+  float            scale_y;
+  int              width;
+  int              height;
+  guint            texture_id;
+  guint            debug_fallback : 1;
+} GskGLRenderFallback;
+
 static void     gsk_gl_render_job_visit_node                (GskGLRenderJob       *job,
                                                              const GskRenderNode  *node);
 static gboolean gsk_gl_render_job_visit_node_with_offscreen (GskGLRenderJob       *job,
@@ -907,6 +955,26 @@ interval_contains (float p1, float w1,
   return TRUE;
 }
 
+static inline gboolean
+gsk_gl_render_job_node_is_damaged (GskGLRenderJob        *job,
+                                   const graphene_rect_t *bounds)
+{
+  graphene_rect_t transformed_bounds;
+
+  if (job->n_damage_rects == 0 || job->offscreen_depth > 0)
+    return TRUE;
+
+  gsk_gl_render_job_transform_bounds (job, bounds, &transformed_bounds);
+
+  for (guint i = 0; i < job->n_damage_rects; i++)
+    {
+      if (rect_intersects (&job->damage_rects[i], &transformed_bounds))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 static inline gboolean
 gsk_gl_render_job_update_clip (GskGLRenderJob        *job,
                                const graphene_rect_t *bounds,
@@ -1153,6 +1221,10 @@ gsk_gl_render_job_begin_draw (GskGLRenderJob *job,
                               job->alpha);
 }
 
+/* Programs other than blit are compiled on first use. Before a node is
+ * visited, gsk_gl_render_job_ensure_programs() makes sure the programs
+ * its visitor chooses here are available.
+ */
 #define CHOOSE_PROGRAM(job,name) \
   (job->current_clip->is_fully_contained \
       ? job->driver->name ## _no_clip \
@@ -1174,43 +1246,17 @@ gsk_gl_render_job_end_draw (GskGLRenderJob *job)
   job->current_program = NULL;
 }
 
-static inline void
-gsk_gl_render_job_visit_as_fallback (GskGLRenderJob      *job,
-                                     const GskRenderNode *node)
+static cairo_surface_t *
+gsk_gl_render_job_rasterize_fallback (const GskRenderNode *node,
+                                      float                scale_x,
+                                      float                scale_y,
+                                      int                  surface_width,
+                                      int                  surface_height,
+                                      gboolean             debug_fallback)
 {
-  float scale_x = job->scale_x;
-  float scale_y = job->scale_y;
-  int surface_width = ceilf (node->bounds.size.width * scale_x);
-  int surface_height = ceilf (node->bounds.size.height * scale_y);
-  GdkTexture *texture;
   cairo_surface_t *surface;
   cairo_surface_t *rendered_surface;
   cairo_t *cr;
-  int cached_id;
-  int texture_id;
-  GskTextureKey key;
-
-  if (surface_width <= 0 || surface_height <= 0)
-    return;
-
-  key.pointer = node;
-  key.pointer_is_child = FALSE;
-  key.scale_x = scale_x;
-  key.scale_y = scale_y;
-  key.filter = GL_NEAREST;
-
-  cached_id = gsk_gl_driver_lookup_texture (job->driver, &key);
-
-  if (cached_id != 0)
-    {
-      gsk_gl_render_job_begin_draw (job, CHOOSE_PROGRAM (job, blit));
-      gsk_gl_program_set_uniform_texture (job->current_program,
-                                          UNIFORM_SHARED_SOURCE, 0,
-                                          GL_TEXTURE_2D, GL_TEXTURE0, cached_id);
-      gsk_gl_render_job_draw_offscreen_rect (job, &node->bounds);
-      gsk_gl_render_job_end_draw (job);
-      return;
-    }
 
   /* We first draw the recording surface on an image surface,
    * just because the scaleY(-1) later otherwise screws up the
@@ -1247,7 +1293,7 @@ gsk_gl_render_job_visit_as_fallback (GskGLRenderJob      *job,
   cairo_restore (cr);
 
 #ifdef G_ENABLE_DEBUG
-  if (job->debug_fallback)
+  if (debug_fallback)
     {
       cairo_move_to (cr, 0, 0);
       cairo_rectangle (cr, 0, 0, node->bounds.size.width, node->bounds.size.height);
@@ -1265,10 +1311,222 @@ gsk_gl_render_job_visit_as_fallback (GskGLRenderJob      *job,
 #endif
   cairo_destroy (cr);
 
-  /* Create texture to upload */
-  texture = gdk_texture_new_for_surface (surface);
-  texture_id = gsk_gl_driver_load_texture (job->driver, texture,
-                                           GL_NEAREST, GL_NEAREST);
+  cairo_surface_destroy (rendered_surface);
+
+  return surface;
+}
+
+static void
+gsk_gl_render_fallback_free (gpointer data)
+{
+  GskGLRenderFallback *fallback = data;
+
+  g_clear_pointer (&fallback->node, gsk_render_node_unref);
+  g_clear_pointer (&fallback->surface, cairo_surface_destroy);
+  g_slice_free (GskGLRenderFallback, fallback);
+}
+
+static void
+gsk_gl_render_fallback_worker (gpointer data,
+                               gpointer user_data)
+{
+  GskGLRenderFallback *fallback = data;
+  GskGLRenderJob *job = fallback->job;
+
+  fallback->surface = gsk_gl_render_job_rasterize_fallback (fallback->node,
+                                                            fallback->scale_x,
+                                                            fallback->scale_y,
+                                                            fallback->width,
+                                                            fallback->height,
+                                                            fallback->debug_fallback);
+
+  g_mutex_lock (&job->pending_mutex);
+  job->n_pending--;
+  g_cond_signal (&job->pending_cond);
+  g_mutex_unlock (&job->pending_mutex);
+}
+
+static GThreadPool *
+get_fallback_pool (void)
+{
+  static GThreadPool *fallback_pool;
+
+  if (g_once_init_enter (&fallback_pool))
+    {
+      GThreadPool *pool;
+
+      pool = g_thread_pool_new (gsk_gl_render_fallback_worker,
+                                NULL,
+                                CLAMP (g_get_num_processors () - 1, 1, 4),
+                                FALSE,
+                                NULL);
+      g_once_init_leave (&fallback_pool, pool);
+    }
+
+  return fallback_pool;
+}
+
+/* Only nodes which are guaranteed to never touch GL while drawing
+ * with cairo can be rasterized on a worker thread. Texture nodes,
+ * for example, may need to download from a GL context which can
+ * only happen on the main thread.
+ */
+static inline gboolean
+node_can_rasterize_off_thread (const GskRenderNode *node)
+{
+  switch ((int)gsk_render_node_get_node_type (node))
+    {
+    case GSK_CAIRO_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static void
+gsk_gl_render_job_upload_fallbacks (GskGLRenderJob *job)
+{
+  G_GNUC_UNUSED gint64 start_time;
+  guint n_fallbacks;
+
+  if (job->pending_fallbacks == NULL || job->pending_fallbacks->len == 0)
+    return;
+
+  start_time = GDK_PROFILER_CURRENT_TIME;
+  n_fallbacks = job->pending_fallbacks->len;
+
+  g_mutex_lock (&job->pending_mutex);
+  while (job->n_pending > 0)
+    g_cond_wait (&job->pending_cond, &job->pending_mutex);
+  g_mutex_unlock (&job->pending_mutex);
+
+  for (guint i = 0; i < job->pending_fallbacks->len; i++)
+    {
+      GskGLRenderFallback *fallback = g_ptr_array_index (job->pending_fallbacks, i);
+      GdkTexture *texture;
+
+      texture = gdk_texture_new_for_surface (fallback->surface);
+      gsk_gl_command_queue_upload_texture_to (job->command_queue,
+                                              fallback->texture_id,
+                                              texture);
+      g_object_unref (texture);
+    }
+
+  g_ptr_array_set_size (job->pending_fallbacks, 0);
+
+  gdk_profiler_add_markf (start_time, GDK_PROFILER_CURRENT_TIME-start_time,
+                          "Upload fallbacks",
+                          "%u nodes", n_fallbacks);
+}
+
+static gboolean
+gsk_gl_render_job_queue_fallback (GskGLRenderJob      *job,
+                                  const GskRenderNode *node,
+                                  int                  surface_width,
+                                  int                  surface_height,
+                                  guint               *out_texture_id)
+{
+  GskGLRenderFallback *fallback;
+  GskGLTexture *texture;
+
+  if (!job->threaded_fallbacks ||
+      !node_can_rasterize_off_thread (node) ||
+      surface_width > job->command_queue->max_texture_size ||
+      surface_height > job->command_queue->max_texture_size)
+    return FALSE;
+
+  texture = gsk_gl_driver_create_texture (job->driver,
+                                          surface_width, surface_height,
+                                          GL_RGBA8,
+                                          GL_NEAREST, GL_NEAREST);
+
+  fallback = g_slice_new0 (GskGLRenderFallback);
+  fallback->job = job;
+  fallback->node = gsk_render_node_ref ((GskRenderNode *)node);
+  fallback->scale_x = job->scale_x;
+  fallback->scale_y = job->scale_y;
+  fallback->width = surface_width;
+  fallback->height = surface_height;
+  fallback->texture_id = texture->texture_id;
+  fallback->debug_fallback = job->debug_fallback;
+
+  if (job->pending_fallbacks == NULL)
+    job->pending_fallbacks = g_ptr_array_new_with_free_func (gsk_gl_render_fallback_free);
+  g_ptr_array_add (job->pending_fallbacks, fallback);
+
+  g_mutex_lock (&job->pending_mutex);
+  job->n_pending++;
+  g_mutex_unlock (&job->pending_mutex);
+
+  g_thread_pool_push (get_fallback_pool (), fallback, NULL);
+
+  *out_texture_id = texture->texture_id;
+
+  return TRUE;
+}
+
+static inline void
+gsk_gl_render_job_visit_as_fallback (GskGLRenderJob      *job,
+                                     const GskRenderNode *node)
+{
+  float scale_x = job->scale_x;
+  float scale_y = job->scale_y;
+  int surface_width = ceilf (node->bounds.size.width * scale_x);
+  int surface_height = ceilf (node->bounds.size.height * scale_y);
+  GdkTexture *texture;
+  cairo_surface_t *surface;
+  int cached_id;
+  guint texture_id;
+  GskTextureKey key;
+
+  if (surface_width <= 0 || surface_height <= 0)
+    return;
+
+  key.pointer = node;
+  key.pointer_is_child = FALSE;
+  key.scale_x = scale_x;
+  key.scale_y = scale_y;
+  key.filter = GL_NEAREST;
+
+  cached_id = gsk_gl_driver_lookup_texture (job->driver, &key);
+
+  if (cached_id != 0)
+    {
+      gsk_gl_render_job_begin_draw (job, CHOOSE_PROGRAM (job, blit));
+      gsk_gl_program_set_uniform_texture (job->current_program,
+                                          UNIFORM_SHARED_SOURCE, 0,
+                                          GL_TEXTURE_2D, GL_TEXTURE0, cached_id);
+      gsk_gl_render_job_draw_offscreen_rect (job, &node->bounds);
+      gsk_gl_render_job_end_draw (job);
+      return;
+    }
+
+  /* Rasterizing with cairo is the expensive part of fallbacks, so when
+   * possible it happens on a worker thread while we continue to build
+   * the rest of the command queue. The texture contents are uploaded
+   * right before the queue is executed.
+   */
+  if (!gsk_gl_render_job_queue_fallback (job, node, surface_width, surface_height, &texture_id))
+    {
+      surface = gsk_gl_render_job_rasterize_fallback (node,
+                                                      scale_x, scale_y,
+                                                      surface_width, surface_height,
+                                                      job->debug_fallback);
+
+      /* Create texture to upload */
+      texture = gdk_texture_new_for_surface (surface);
+      texture_id = gsk_gl_driver_load_texture (job->driver, texture,
+                                               GL_NEAREST, GL_NEAREST);
+
+      g_object_unref (texture);
+      cairo_surface_destroy (surface);
+    }
 
   if (gdk_gl_context_has_debug (job->command_queue->context))
     gdk_gl_context_label_object_printf (job->command_queue->context, GL_TEXTURE, texture_id,
@@ -1276,10 +1534,6 @@ gsk_gl_render_job_visit_as_fallback (GskGLRenderJob      *job,
                                         g_type_name_from_instance ((GTypeInstance *) node),
                                         texture_id);
 
-  g_object_unref (texture);
-  cairo_surface_destroy (surface);
-  cairo_surface_destroy (rendered_surface);
-
   gsk_gl_driver_cache_texture (job->driver, &key, texture_id);
 
   gsk_gl_render_job_begin_draw (job, CHOOSE_PROGRAM (job, blit));
@@ -1517,6 +1771,36 @@ gsk_gl_render_job_visit_color_node (GskGLRenderJob      *job,
     }
 }
 
+/* The gradient programs take the stops as an array of vec4, with
+ * the offsets packed four to a vector first, followed by one color
+ * per stop. Five floats per stop would not fit into array_count.
+ */
+static inline void
+gsk_gl_render_job_set_color_stops (GskGLRenderJob     *job,
+                                   guint               key,
+                                   const GskColorStop *stops,
+                                   int                 n_color_stops)
+{
+  float values[GRADIENT_STOPS_ARRAY_COUNT * 4] = { 0, };
+  float *colors = values + MAX_GRADIENT_STOPS;
+  int i;
+
+  g_assert (n_color_stops <= MAX_GRADIENT_STOPS);
+
+  for (i = 0; i < n_color_stops; i++)
+    {
+      values[i] = stops[i].offset;
+      colors[4 * i + 0] = stops[i].color.red;
+      colors[4 * i + 1] = stops[i].color.green;
+      colors[4 * i + 2] = stops[i].color.blue;
+      colors[4 * i + 3] = stops[i].color.alpha;
+    }
+
+  gsk_gl_program_set_uniform4fv (job->current_program, key, 0,
+                                 MAX_GRADIENT_STOPS / 4 + n_color_stops,
+                                 values);
+}
+
 static inline void
 gsk_gl_render_job_visit_linear_gradient_node (GskGLRenderJob      *job,
                                               const GskRenderNode *node)
@@ -1531,16 +1815,15 @@ gsk_gl_render_job_visit_linear_gradient_node (GskGLRenderJob      *job,
   float y1 = job->offset_y + start->y;
   float y2 = job->offset_y + end->y;
 
-  g_assert (n_color_stops < MAX_GRADIENT_STOPS);
+  g_assert (n_color_stops <= MAX_GRADIENT_STOPS);
 
   gsk_gl_render_job_begin_draw (job, CHOOSE_PROGRAM (job, linear_gradient));
   gsk_gl_program_set_uniform1i (job->current_program,
                                 UNIFORM_LINEAR_GRADIENT_NUM_COLOR_STOPS, 0,
                                 n_color_stops);
-  gsk_gl_program_set_uniform1fv (job->current_program,
-                                 UNIFORM_LINEAR_GRADIENT_COLOR_STOPS, 0,
-                                 n_color_stops * 5,
-                                 (const float *)stops);
+  gsk_gl_render_job_set_color_stops (job,
+                                     UNIFORM_LINEAR_GRADIENT_COLOR_STOPS,
+                                     stops, n_color_stops);
   gsk_gl_program_set_uniform4f (job->current_program,
                                 UNIFORM_LINEAR_GRADIENT_POINTS, 0,
                                 x1, y1, x2 - x1, y2 - y1);
@@ -1563,16 +1846,15 @@ gsk_gl_render_job_visit_conic_gradient_node (GskGLRenderJob      *job,
   float angle = gsk_conic_gradient_node_get_angle (node);
   float bias = angle * scale + 2.0f;
 
-  g_assert (n_color_stops < MAX_GRADIENT_STOPS);
+  g_assert (n_color_stops <= MAX_GRADIENT_STOPS);
 
   gsk_gl_render_job_begin_draw (job, CHOOSE_PROGRAM (job, conic_gradient));
   gsk_gl_program_set_uniform1i (job->current_program,
                                 UNIFORM_CONIC_GRADIENT_NUM_COLOR_STOPS, 0,
                                 n_color_stops);
-  gsk_gl_program_set_uniform1fv (job->current_program,
-                                 UNIFORM_CONIC_GRADIENT_COLOR_STOPS, 0,
-                                 n_color_stops * 5,
-                                 (const float *)stops);
+  gsk_gl_render_job_set_color_stops (job,
+                                     UNIFORM_CONIC_GRADIENT_COLOR_STOPS,
+                                     stops, n_color_stops);
   gsk_gl_program_set_uniform4f (job->current_program,
                                 UNIFORM_CONIC_GRADIENT_GEOMETRY, 0,
                                 job->offset_x + center->x,
@@ -1598,16 +1880,15 @@ gsk_gl_render_job_visit_radial_gradient_node (GskGLRenderJob      *job,
   float scale = 1.0f / (end - start);
   float bias = -start * scale;
 
-  g_assert (n_color_stops < MAX_GRADIENT_STOPS);
+  g_assert (n_color_stops <= MAX_GRADIENT_STOPS);
 
   gsk_gl_render_job_begin_draw (job, CHOOSE_PROGRAM (job, radial_gradient));
   gsk_gl_program_set_uniform1i (job->current_program,
                                 UNIFORM_RADIAL_GRADIENT_NUM_COLOR_STOPS, 0,
                                 n_color_stops);
-  gsk_gl_program_set_uniform1fv (job->current_program,
-                                 UNIFORM_RADIAL_GRADIENT_COLOR_STOPS, 0,
-                                 n_color_stops * 5,
-                                 (const float *)stops);
+  gsk_gl_render_job_set_color_stops (job,
+                                     UNIFORM_RADIAL_GRADIENT_COLOR_STOPS,
+                                     stops, n_color_stops);
   gsk_gl_program_set_uniform1i (job->current_program,
                                 UNIFORM_RADIAL_GRADIENT_REPEAT, 0,
                                 repeat);
@@ -2977,6 +3258,111 @@ compute_phase_and_pos (float value, float *pos)
     }
 }
 
+static void
+gsk_gl_render_job_visit_sdf_text_node (GskGLRenderJob      *job,
+                                       const GskRenderNode *node,
+                                       const guint16        cc[4],
+                                       float                em_size)
+{
+  PangoFont *font = (PangoFont *)gsk_text_node_get_font (node);
+  const PangoGlyphInfo *glyphs = gsk_text_node_get_glyphs (node, NULL);
+  const graphene_point_t *offset = gsk_text_node_get_offset (node);
+  float text_scale = MAX (job->scale_x, job->scale_y);
+  guint num_glyphs = gsk_text_node_get_num_glyphs (node);
+  float x = offset->x + job->offset_x;
+  float y = offset->y + job->offset_y;
+  GskGLSdfGlyphLibrary *library = job->driver->sdf_glyphs;
+  GskGLCommandBatch *batch;
+  GskGLSdfGlyphKey lookup;
+  GskGLDrawVertex *vertices;
+  const PangoGlyphInfo *gi;
+  guint last_texture = 0;
+  int x_position = 0;
+  guint used = 0;
+  float smoothing;
+  guint i;
+
+  /* Half a device pixel, measured in distance field units */
+  smoothing = GSK_GL_SDF_GLYPH_SIZE / (4.0f * GSK_GL_SDF_GLYPH_SPREAD * em_size * text_scale);
+  smoothing = MIN (smoothing, 0.5f);
+
+  lookup.face = pango_font_get_face (font);
+
+  gsk_gl_render_job_begin_draw (job, CHOOSE_PROGRAM (job, sdf_text));
+  gsk_gl_program_set_uniform1f (job->current_program,
+                                UNIFORM_SDF_TEXT_SMOOTHING, 0,
+                                smoothing);
+
+  batch = gsk_gl_command_queue_get_batch (job->command_queue);
+  vertices = gsk_gl_command_queue_add_n_vertices (job->command_queue, num_glyphs);
+
+  for (i = 0, gi = glyphs; i < num_glyphs; i++, gi++)
+    {
+      const GskGLSdfGlyphValue *glyph;
+      float glyph_x, glyph_y, glyph_x2, glyph_y2;
+      float tx, ty, tx2, ty2;
+      guint texture_id;
+      float cx, cy;
+
+      lookup.glyph = gi->glyph;
+
+      cx = x + (float)(x_position + gi->geometry.x_offset) / PANGO_SCALE;
+      cy = y + (float)(gi->geometry.y_offset) / PANGO_SCALE;
+
+      x_position += gi->geometry.width;
+
+      texture_id = gsk_gl_sdf_glyph_library_lookup_or_add (library, &lookup, font, em_size, &glyph);
+      if G_UNLIKELY (texture_id == 0)
+        continue;
+
+      if G_UNLIKELY (last_texture != texture_id || batch->draw.vbo_count + GSK_GL_N_VERTICES > 0xffff)
+        {
+          if G_LIKELY (last_texture != 0)
+            {
+              guint vbo_offset = batch->draw.vbo_offset + batch->draw.vbo_count;
+
+              /* See gsk_gl_render_job_visit_text_node() */
+              gsk_gl_render_job_split_draw (job);
+              batch = gsk_gl_command_queue_get_batch (job->command_queue);
+              batch->draw.vbo_offset = vbo_offset;
+            }
+
+          gsk_gl_program_set_uniform_texture (job->current_program,
+                                              UNIFORM_SHARED_SOURCE, 0,
+                                              GL_TEXTURE_2D,
+                                              GL_TEXTURE0,
+                                              texture_id);
+          last_texture = texture_id;
+        }
+
+      tx = glyph->entry.area.x;
+      ty = glyph->entry.area.y;
+      tx2 = glyph->entry.area.x2;
+      ty2 = glyph->entry.area.y2;
+
+      glyph_x = cx + glyph->ink_rect.origin.x * em_size;
+      glyph_y = cy + glyph->ink_rect.origin.y * em_size;
+      glyph_x2 = glyph_x + glyph->ink_rect.size.width * em_size;
+      glyph_y2 = glyph_y + glyph->ink_rect.size.height * em_size;
+
+      *(vertices++) = (GskGLDrawVertex) { .position = { glyph_x,  glyph_y  }, .uv = { tx,  ty  }, .color = { cc[0], cc[1], cc[2], cc[3] } };
+      *(vertices++) = (GskGLDrawVertex) { .position = { glyph_x,  glyph_y2 }, .uv = { tx,  ty2 }, .color = { cc[0], cc[1], cc[2], cc[3] } };
+      *(vertices++) = (GskGLDrawVertex) { .position = { glyph_x2, glyph_y  }, .uv = { tx2, ty  }, .color = { cc[0], cc[1], cc[2], cc[3] } };
+
+      *(vertices++) = (GskGLDrawVertex) { .position = { glyph_x2, glyph_y2 }, .uv = { tx2, ty2 }, .color = { cc[0], cc[1], cc[2], cc[3] } };
+      *(vertices++) = (GskGLDrawVertex) { .position = { glyph_x,  glyph_y2 }, .uv = { tx,  ty2 }, .color = { cc[0], cc[1], cc[2], cc[3] } };
+      *(vertices++) = (GskGLDrawVertex) { .position = { glyph_x2, glyph_y  }, .uv = { tx2, ty  }, .color = { cc[0], cc[1], cc[2], cc[3] } };
+
+      batch->draw.vbo_count += GSK_GL_N_VERTICES;
+      used++;
+    }
+
+  if (used != num_glyphs)
+    gsk_gl_command_queue_retract_n_vertices (job->command_queue, num_glyphs - used);
+
+  gsk_gl_render_job_end_draw (job);
+}
+
 static inline void
 gsk_gl_render_job_visit_text_node (GskGLRenderJob      *job,
                                    const GskRenderNode *node,
@@ -3014,6 +3400,19 @@ gsk_gl_render_job_visit_text_node (GskGLRenderJob      *job,
 
   rgba_to_half (color, cc);
 
+  /* Color glyphs are bitmaps, so they can't come from distance fields */
+  if (job->driver->sdf_glyphs != NULL &&
+      (force_color || !gsk_text_node_has_color_glyphs (node)))
+    {
+      float em_size;
+
+      if (gsk_gl_sdf_glyph_library_get_em_size ((PangoFont *)font, &em_size))
+        {
+          gsk_gl_render_job_visit_sdf_text_node (job, node, cc, em_size);
+          return;
+        }
+    }
+
   lookup.font = (PangoFont *)font;
   lookup.scale = (guint) (text_scale * 1024);
 
@@ -3496,7 +3895,8 @@ gsk_gl_render_job_upload_texture (GskGLRenderJob       *job,
   if (gsk_gl_texture_library_can_cache ((GskGLTextureLibrary *)job->driver->icons,
                                         texture->width,
                                         texture->height) &&
-      !GDK_IS_GL_TEXTURE (texture))
+      !GDK_IS_GL_TEXTURE (texture) &&
+      !GDK_IS_DMABUF_TEXTURE (texture))
     {
       const GskGLIconData *icon_data;
 
@@ -3511,11 +3911,21 @@ gsk_gl_render_job_upload_texture (GskGLRenderJob       *job,
     }
 }
 
+static inline gboolean
+gsk_gl_render_job_texture_is_minified (GskGLRenderJob      *job,
+                                       const GskRenderNode *node,
+                                       GdkTexture          *texture)
+{
+  return fabsf (job->scale_x) * node->bounds.size.width * 2 <= texture->width &&
+         fabsf (job->scale_y) * node->bounds.size.height * 2 <= texture->height;
+}
+
 static inline void
 gsk_gl_render_job_visit_texture_node (GskGLRenderJob      *job,
                                       const GskRenderNode *node)
 {
   GdkTexture *texture = gsk_texture_node_get_texture (node);
+  GskScalingFilter filter = gsk_texture_node_get_filter (node);
   int max_texture_size = job->command_queue->max_texture_size;
 
   if G_LIKELY (texture->width <= max_texture_size &&
@@ -3523,11 +3933,42 @@ gsk_gl_render_job_visit_texture_node (GskGLRenderJob      *job,
     {
       GskGLRenderOffscreen offscreen = {0};
 
-      gsk_gl_render_job_upload_texture (job, texture, &offscreen);
+      if (filter != GSK_SCALING_FILTER_LINEAR)
+        {
+          /* The icon atlas is always sampled linearly and without mipmaps */
+          int gl_filter = filter == GSK_SCALING_FILTER_NEAREST ? GL_NEAREST : GL_LINEAR;
+
+          offscreen.texture_id = gsk_gl_driver_load_texture (job->driver, texture, gl_filter, gl_filter);
+          init_full_texture_region (&offscreen);
+        }
+      else if (job->async_uploads &&
+          !GDK_IS_GL_TEXTURE (texture) &&
+          !GDK_IS_DMABUF_TEXTURE (texture) &&
+          !gsk_gl_texture_library_can_cache ((GskGLTextureLibrary *)job->driver->icons,
+                                             texture->width,
+                                             texture->height))
+        {
+          offscreen.texture_id = gsk_gl_driver_load_texture_async (job->driver, texture, GL_LINEAR, GL_LINEAR);
+
+          /* Still uploading, leave the area empty for this frame */
+          if (offscreen.texture_id == 0)
+            return;
+
+          init_full_texture_region (&offscreen);
+        }
+      else
+        {
+          gsk_gl_render_job_upload_texture (job, texture, &offscreen);
+        }
 
       g_assert (offscreen.texture_id);
       g_assert (offscreen.was_offscreen == FALSE);
 
+      if (filter != GSK_SCALING_FILTER_NEAREST &&
+          gsk_gl_render_job_texture_is_minified (job, node, texture))
+        gsk_gl_driver_note_minified (job->driver, texture,
+                                     filter == GSK_SCALING_FILTER_TRILINEAR);
+
       gsk_gl_render_job_begin_draw (job, CHOOSE_PROGRAM (job, blit));
       gsk_gl_program_set_uniform_texture (job->current_program,
                                           UNIFORM_SHARED_SOURCE, 0,
@@ -3594,13 +4035,6 @@ gsk_gl_render_job_visit_repeat_node (GskGLRenderJob      *job,
   if (node_is_invisible (child))
     return;
 
-  if (!graphene_rect_equal (child_bounds, &child->bounds))
-    {
-      /* TODO: implement these repeat nodes. */
-      gsk_gl_render_job_visit_as_fallback (job, node);
-      return;
-    }
-
   /* If the size of the repeat node is smaller than the size of the
    * child node, we don't repeat at all and can just draw that part
    * of the child texture... */
@@ -3610,12 +4044,32 @@ gsk_gl_render_job_visit_repeat_node (GskGLRenderJob      *job,
       return;
     }
 
-  offscreen.bounds = &child->bounds;
+  /* The offscreen covers exactly one tile, which crops the child
+   * or pads it with transparency when the child bounds differ.
+   * A texture can still be sampled directly if the tile lies
+   * within it, we just use that part of the texture then.
+   */
+  offscreen.bounds = child_bounds;
   offscreen.reset_clip = TRUE;
+  if (gsk_render_node_get_node_type (child) == GSK_TEXTURE_NODE &&
+      !rect_contains_rect (&child->bounds, child_bounds))
+    offscreen.force_offscreen = TRUE;
 
   if (!gsk_gl_render_job_visit_node_with_offscreen (job, child, &offscreen))
     g_assert_not_reached ();
 
+  if (!offscreen.was_offscreen &&
+      !graphene_rect_equal (child_bounds, &child->bounds))
+    {
+      float tw = offscreen.area.x2 - offscreen.area.x;
+      float th = offscreen.area.y2 - offscreen.area.y;
+
+      offscreen.area.x += (child_bounds->origin.x - child->bounds.origin.x) / child->bounds.size.width * tw;
+      offscreen.area.y += (child_bounds->origin.y - child->bounds.origin.y) / child->bounds.size.height * th;
+      offscreen.area.x2 = offscreen.area.x + child_bounds->size.width / child->bounds.size.width * tw;
+      offscreen.area.y2 = offscreen.area.y + child_bounds->size.height / child->bounds.size.height * th;
+    }
+
   gsk_gl_render_job_begin_draw (job, CHOOSE_PROGRAM (job, repeat));
   gsk_gl_program_set_uniform_texture (job->current_program,
                                       UNIFORM_SHARED_SOURCE, 0,
@@ -3638,11 +4092,99 @@ gsk_gl_render_job_visit_repeat_node (GskGLRenderJob      *job,
   gsk_gl_render_job_end_draw (job);
 }
 
+/* Compiles the programs, besides blit, that the visitor for @node
+ * chooses directly. Returns FALSE if one of them failed to compile,
+ * in which case @node has to be drawn with cairo.
+ */
+static gboolean
+gsk_gl_render_job_ensure_programs (GskGLRenderJob      *job,
+                                   const GskRenderNode *node)
+{
+  GskGLDriver *driver = job->driver;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_BLEND_NODE:
+      return gsk_gl_driver_ensure_program (driver, blend);
+
+    case GSK_BLUR_NODE:
+      return gsk_gl_driver_ensure_program (driver, blur);
+
+    case GSK_BORDER_NODE:
+      return gsk_gl_driver_ensure_program (driver, color) &&
+             gsk_gl_driver_ensure_program (driver, border);
+
+    case GSK_COLOR_NODE:
+      return gsk_gl_driver_ensure_program (driver, color) &&
+             gsk_gl_driver_ensure_program (driver, coloring);
+
+    case GSK_COLOR_MATRIX_NODE:
+      return gsk_gl_driver_ensure_program (driver, color_matrix);
+
+    case GSK_CONIC_GRADIENT_NODE:
+      return gsk_gl_driver_ensure_program (driver, conic_gradient);
+
+    case GSK_CROSS_FADE_NODE:
+      return gsk_gl_driver_ensure_program (driver, cross_fade);
+
+    case GSK_GL_SHADER_NODE:
+      return gsk_gl_driver_ensure_program (driver, color);
+
+    case GSK_INSET_SHADOW_NODE:
+      return gsk_gl_driver_ensure_program (driver, inset_shadow) &&
+             gsk_gl_driver_ensure_program (driver, blur);
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      return gsk_gl_driver_ensure_program (driver, linear_gradient);
+
+    case GSK_OUTSET_SHADOW_NODE:
+      return gsk_gl_driver_ensure_program (driver, color) &&
+             gsk_gl_driver_ensure_program (driver, outset_shadow) &&
+             gsk_gl_driver_ensure_program (driver, unblurred_outset_shadow) &&
+             gsk_gl_driver_ensure_program (driver, blur);
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      return gsk_gl_driver_ensure_program (driver, radial_gradient);
+
+    case GSK_REPEAT_NODE:
+      return gsk_gl_driver_ensure_program (driver, repeat);
+
+    case GSK_SHADOW_NODE:
+      /* Text children are drawn directly with their shadow color */
+      return gsk_gl_driver_ensure_program (driver, coloring) &&
+             gsk_gl_driver_ensure_program (driver, sdf_text) &&
+             gsk_gl_driver_ensure_program (driver, blur);
+
+    case GSK_TEXT_NODE:
+      return gsk_gl_driver_ensure_program (driver, coloring) &&
+             gsk_gl_driver_ensure_program (driver, sdf_text);
+
+    case GSK_CAIRO_NODE:
+    case GSK_CLIP_NODE:
+    case GSK_CONTAINER_NODE:
+    case GSK_DEBUG_NODE:
+    case GSK_OPACITY_NODE:
+    case GSK_ROUNDED_CLIP_NODE:
+    case GSK_TEXTURE_NODE:
+    case GSK_TRANSFORM_NODE:
+      return TRUE;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
 static void
 gsk_gl_render_job_visit_node (GskGLRenderJob      *job,
                               const GskRenderNode *node)
 {
   gboolean has_clip;
+  guint prev_tag;
+  guint tag;
 
   g_assert (job != NULL);
   g_assert (node != NULL);
@@ -3652,9 +4194,26 @@ gsk_gl_render_job_visit_node (GskGLRenderJob      *job,
   if (node_is_invisible (node))
     return;
 
+  if (!gsk_gl_render_job_node_is_damaged (job, &node->bounds))
+    return;
+
   if (!gsk_gl_render_job_update_clip (job, &node->bounds, &has_clip))
     return;
 
+  /* Attribute the batches created for this node to its type. Children
+   * override this with their own type and restore it when done.
+   */
+  tag = gsk_render_node_get_node_type (node);
+  if (job->offscreen_depth > 0)
+    tag |= GSK_GL_COMMAND_TAG_OFFSCREEN;
+  prev_tag = gsk_gl_command_queue_set_tag (job->command_queue, tag);
+
+  if (!gsk_gl_render_job_ensure_programs (job, node))
+    {
+      gsk_gl_render_job_visit_as_fallback (job, node);
+      goto out;
+    }
+
   switch (gsk_render_node_get_node_type (node))
     {
     case GSK_BLEND_NODE:
@@ -3689,7 +4248,7 @@ gsk_gl_render_job_visit_node (GskGLRenderJob      *job,
     break;
 
     case GSK_CONIC_GRADIENT_NODE:
-      if (gsk_conic_gradient_node_get_n_color_stops (node) < MAX_GRADIENT_STOPS)
+      if (gsk_conic_gradient_node_get_n_color_stops (node) <= MAX_GRADIENT_STOPS)
         gsk_gl_render_job_visit_conic_gradient_node (job, node);
       else
         gsk_gl_render_job_visit_as_fallback (job, node);
@@ -3716,7 +4275,8 @@ gsk_gl_render_job_visit_node (GskGLRenderJob      *job,
                     gsk_render_node_get_node_type (child2) == GSK_BORDER_NODE &&
                     gsk_border_node_get_uniform_color (child2) &&
                     rounded_rect_equal (gsk_rounded_clip_node_get_clip (child),
-                                        gsk_border_node_get_outline (child2)))
+                                        gsk_border_node_get_outline (child2)) &&
+                    gsk_gl_driver_ensure_program (job->driver, filled_border))
                   {
                     gsk_gl_render_job_visit_css_background (job, child, child2);
                     i++; /* skip the border node */
@@ -3762,7 +4322,7 @@ gsk_gl_render_job_visit_node (GskGLRenderJob      *job,
 
     case GSK_LINEAR_GRADIENT_NODE:
     case GSK_REPEATING_LINEAR_GRADIENT_NODE:
-      if (gsk_linear_gradient_node_get_n_color_stops (node) < MAX_GRADIENT_STOPS)
+      if (gsk_linear_gradient_node_get_n_color_stops (node) <= MAX_GRADIENT_STOPS)
         gsk_gl_render_job_visit_linear_gradient_node (job, node);
       else
         gsk_gl_render_job_visit_as_fallback (job, node);
@@ -3781,7 +4341,7 @@ gsk_gl_render_job_visit_node (GskGLRenderJob      *job,
 
     case GSK_RADIAL_GRADIENT_NODE:
     case GSK_REPEATING_RADIAL_GRADIENT_NODE:
-      if (gsk_radial_gradient_node_get_n_color_stops (node) < MAX_GRADIENT_STOPS)
+      if (gsk_radial_gradient_node_get_n_color_stops (node) <= MAX_GRADIENT_STOPS)
         gsk_gl_render_job_visit_radial_gradient_node (job, node);
       else
         gsk_gl_render_job_visit_as_fallback (job, node);
@@ -3824,6 +4384,9 @@ gsk_gl_render_job_visit_node (GskGLRenderJob      *job,
     break;
     }
 
+out:
+  gsk_gl_command_queue_set_tag (job->command_queue, prev_tag);
+
   if (has_clip)
     gsk_gl_render_job_pop_clip (job);
 }
@@ -3970,7 +4533,9 @@ gsk_gl_render_job_visit_node_with_offscreen (GskGLRenderJob       *job,
   if (offscreen->reset_clip)
     gsk_gl_render_job_push_clip (job, &GSK_ROUNDED_RECT_INIT_FROM_RECT (job->viewport));
 
+  job->offscreen_depth++;
   gsk_gl_render_job_visit_node (job, node);
+  job->offscreen_depth--;
 
   if (offscreen->reset_clip)
     gsk_gl_render_job_pop_clip (job);
@@ -4037,6 +4602,7 @@ gsk_gl_render_job_render_flipped (GskGLRenderJob *job,
   /* Visit all nodes creating batches */
   gdk_gl_context_push_debug_group (job->command_queue->context, "Building command queue");
   gsk_gl_render_job_visit_node (job, root);
+  gsk_gl_render_job_upload_fallbacks (job);
   gdk_gl_context_pop_debug_group (job->command_queue->context);
 
   /* Now draw to our real destination, but flipped */
@@ -4053,7 +4619,7 @@ gsk_gl_render_job_render_flipped (GskGLRenderJob *job,
   gsk_gl_render_job_end_draw (job);
 
   gdk_gl_context_push_debug_group (job->command_queue->context, "Executing command queue");
-  gsk_gl_command_queue_execute (job->command_queue, surface_height, 1, NULL);
+  gsk_gl_command_queue_execute (job->command_queue, surface_height, 1, job->framebuffer, NULL);
   gdk_gl_context_pop_debug_group (job->command_queue->context);
 
   glDeleteFramebuffers (1, &framebuffer_id);
@@ -4065,7 +4631,7 @@ gsk_gl_render_job_render (GskGLRenderJob *job,
                           GskRenderNode  *root)
 {
   G_GNUC_UNUSED gint64 start_time;
-  guint scale_factor;
+  float scale_factor;
   guint surface_height;
 
   g_return_if_fail (job != NULL);
@@ -4085,6 +4651,7 @@ gsk_gl_render_job_render (GskGLRenderJob *job,
   gsk_gl_command_queue_bind_framebuffer (job->command_queue, job->framebuffer);
   gsk_gl_command_queue_clear (job->command_queue, 0, &job->viewport);
   gsk_gl_render_job_visit_node (job, root);
+  gsk_gl_render_job_upload_fallbacks (job);
   gdk_gl_context_pop_debug_group (job->command_queue->context);
   gdk_profiler_add_mark (start_time, GDK_PROFILER_CURRENT_TIME-start_time, "Build GL command queue", "");
 
@@ -4096,13 +4663,13 @@ gsk_gl_render_job_render (GskGLRenderJob *job,
 #endif
 
   /* But now for executing the command queue, we want to use the context
-   * that was provided to us when creating the render job as framebuffer 0
-   * is bound to that context.
+   * that was provided to us when creating the render job as the default
+   * framebuffer is bound to that context.
    */
   start_time = GDK_PROFILER_CURRENT_TIME;
   gsk_gl_command_queue_make_current (job->command_queue);
   gdk_gl_context_push_debug_group (job->command_queue->context, "Executing command queue");
-  gsk_gl_command_queue_execute (job->command_queue, surface_height, scale_factor, job->region);
+  gsk_gl_command_queue_execute (job->command_queue, surface_height, scale_factor, job->framebuffer, job->region);
   gdk_gl_context_pop_debug_group (job->command_queue->context);
   gdk_profiler_add_mark (start_time, GDK_PROFILER_CURRENT_TIME-start_time, "Execute GL command queue", "");
 }
@@ -4116,6 +4683,15 @@ gsk_gl_render_job_set_debug_fallback (GskGLRenderJob *job,
   job->debug_fallback = !!debug_fallback;
 }
 
+void
+gsk_gl_render_job_set_async_uploads (GskGLRenderJob *job,
+                                     gboolean        async_uploads)
+{
+  g_return_if_fail (job != NULL);
+
+  job->async_uploads = !!async_uploads;
+}
+
 static int
 get_framebuffer_format (GdkGLContext *context,
                         guint         framebuffer)
@@ -4140,6 +4716,30 @@ get_framebuffer_format (GdkGLContext *context,
     return GL_RGBA8;
 }
 
+/* Whether it is worth drawing the rectangles of @region separately
+ * rather than their bounding box.
+ */
+static gboolean
+region_is_sparse (const cairo_region_t        *region,
+                  const cairo_rectangle_int_t *extents)
+{
+  int n_rects = cairo_region_num_rectangles (region);
+  gint64 area = 0;
+
+  if (n_rects < 2 || n_rects > MAX_DAMAGE_RECTS)
+    return FALSE;
+
+  for (int i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (region, i, &rect);
+      area += (gint64)rect.width * rect.height;
+    }
+
+  return area * 2 < (gint64)extents->width * extents->height;
+}
+
 GskGLRenderJob *
 gsk_gl_render_job_new (GskGLDriver           *driver,
                        const graphene_rect_t *viewport,
@@ -4167,6 +4767,9 @@ gsk_gl_render_job_new (GskGLDriver           *driver,
   job->scale_y = scale_factor;
   job->viewport = *viewport;
   job->target_format = get_framebuffer_format (job->command_queue->context, framebuffer);
+  job->threaded_fallbacks = g_get_num_processors () > 1;
+  g_mutex_init (&job->pending_mutex);
+  g_cond_init (&job->pending_cond);
 
   gsk_gl_render_job_set_alpha (job, 1.0f);
   gsk_gl_render_job_set_projection_from_rect (job, viewport, NULL);
@@ -4174,7 +4777,8 @@ gsk_gl_render_job_new (GskGLDriver           *driver,
 
   /* Setup our initial clip. If region is NULL then we are drawing the
    * whole viewport. Otherwise, we need to convert the region to a
-   * bounding box and clip based on that.
+   * bounding box and clip based on that. If the region is made of a
+   * few small rectangles, those are drawn individually.
    */
 
   if (region != NULL)
@@ -4189,7 +4793,29 @@ gsk_gl_render_job_new (GskGLDriver           *driver,
                                                                extents.height),
                                           &transformed_extents);
       clip_rect = &transformed_extents;
-      job->region = cairo_region_create_rectangle (&extents);
+
+      if (region_is_sparse (region, &extents))
+        {
+          job->region = cairo_region_copy (region);
+          job->n_damage_rects = cairo_region_num_rectangles (region);
+
+          for (guint i = 0; i < job->n_damage_rects; i++)
+            {
+              cairo_rectangle_int_t rect;
+
+              cairo_region_get_rectangle (region, i, &rect);
+              gsk_gl_render_job_transform_bounds (job,
+                                                  &GRAPHENE_RECT_INIT (rect.x,
+                                                                       rect.y,
+                                                                       rect.width,
+                                                                       rect.height),
+                                                  &job->damage_rects[i]);
+            }
+        }
+      else
+        {
+          job->region = cairo_region_create_rectangle (&extents);
+        }
     }
 
   gsk_gl_render_job_push_clip (job,
@@ -4207,6 +4833,14 @@ gsk_gl_render_job_free (GskGLRenderJob *job)
   job->current_modelview = NULL;
   job->current_clip = NULL;
 
+  /* Make sure no worker thread is still referencing the job and that
+   * any texture we handed out has its contents.
+   */
+  gsk_gl_render_job_upload_fallbacks (job);
+  g_clear_pointer (&job->pending_fallbacks, g_ptr_array_unref);
+  g_mutex_clear (&job->pending_mutex);
+  g_cond_clear (&job->pending_cond);
+
   while (job->modelview->len > 0)
     {
       GskGLRenderModelview *modelview = &g_array_index (job->modelview, GskGLRenderModelview, job->modelview->len-1);
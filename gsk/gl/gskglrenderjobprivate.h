@@ -35,5 +35,7 @@ void            gsk_gl_render_job_render_flipped     (GskGLRenderJob        *job
                                                       GskRenderNode         *root);
 void            gsk_gl_render_job_set_debug_fallback (GskGLRenderJob        *job,
                                                       gboolean               debug_fallback);
+void            gsk_gl_render_job_set_async_uploads  (GskGLRenderJob        *job,
+                                                      gboolean               async_uploads);
 
 #endif /* __GSK_GL_RENDER_JOB_H__ */
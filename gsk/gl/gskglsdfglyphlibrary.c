@@ -0,0 +1,366 @@
+/* gskglsdfglyphlibrary.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <gdk/gdkglcontextprivate.h>
+#include <gdk/gdkprofilerprivate.h>
+#include <pango/pangocairo.h>
+#include <math.h>
+#include <string.h>
+
+#include "gskglcommandqueueprivate.h"
+#include "gskgldriverprivate.h"
+#include "gskglsdfglyphlibraryprivate.h"
+
+/* Distance fields are rendered once at GSK_GL_SDF_GLYPH_SIZE and then
+ * scaled by the text program to whatever size is needed, so unlike
+ * GskGLGlyphLibrary the cache is keyed only by face and glyph.
+ */
+
+#define MAX_SDF_GLYPH_SIZE 128
+
+G_DEFINE_TYPE (GskGLSdfGlyphLibrary, gsk_gl_sdf_glyph_library, GSK_TYPE_GL_TEXTURE_LIBRARY)
+
+GskGLSdfGlyphLibrary *
+gsk_gl_sdf_glyph_library_new (GskGLDriver *driver)
+{
+  g_return_val_if_fail (GSK_IS_GL_DRIVER (driver), NULL);
+
+  return g_object_new (GSK_TYPE_GL_SDF_GLYPH_LIBRARY,
+                       "driver", driver,
+                       NULL);
+}
+
+static guint
+gsk_gl_sdf_glyph_key_hash (gconstpointer data)
+{
+  const GskGLSdfGlyphKey *key = data;
+
+  return GPOINTER_TO_UINT (key->face) ^ key->glyph;
+}
+
+static gboolean
+gsk_gl_sdf_glyph_key_equal (gconstpointer v1,
+                            gconstpointer v2)
+{
+  const GskGLSdfGlyphKey *k1 = v1;
+  const GskGLSdfGlyphKey *k2 = v2;
+
+  return k1->face == k2->face && k1->glyph == k2->glyph;
+}
+
+static void
+gsk_gl_sdf_glyph_key_free (gpointer data)
+{
+  GskGLSdfGlyphKey *key = data;
+
+  g_clear_object (&key->face);
+  g_slice_free (GskGLSdfGlyphKey, key);
+}
+
+static void
+gsk_gl_sdf_glyph_value_free (gpointer data)
+{
+  g_slice_free (GskGLSdfGlyphValue, data);
+}
+
+static void
+gsk_gl_sdf_glyph_library_finalize (GObject *object)
+{
+  GskGLSdfGlyphLibrary *self = (GskGLSdfGlyphLibrary *)object;
+
+  g_clear_pointer (&self->coverage, g_free);
+  g_clear_pointer (&self->field, g_free);
+
+  G_OBJECT_CLASS (gsk_gl_sdf_glyph_library_parent_class)->finalize (object);
+}
+
+static void
+gsk_gl_sdf_glyph_library_class_init (GskGLSdfGlyphLibraryClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GskGLTextureLibraryClass *library_class = GSK_GL_TEXTURE_LIBRARY_CLASS (klass);
+
+  object_class->finalize = gsk_gl_sdf_glyph_library_finalize;
+
+  library_class->profiler_name = "sdf-glyph";
+}
+
+static void
+gsk_gl_sdf_glyph_library_init (GskGLSdfGlyphLibrary *self)
+{
+  GskGLTextureLibrary *tl = (GskGLTextureLibrary *)self;
+
+  tl->max_entry_size = MAX_SDF_GLYPH_SIZE;
+  gsk_gl_texture_library_set_funcs (tl,
+                                    gsk_gl_sdf_glyph_key_hash,
+                                    gsk_gl_sdf_glyph_key_equal,
+                                    gsk_gl_sdf_glyph_key_free,
+                                    gsk_gl_sdf_glyph_value_free);
+}
+
+/**
+ * gsk_gl_sdf_glyph_library_get_em_size:
+ * @font: a `PangoFont`
+ * @em_size: (out): location for the em size of @font in pixels
+ *
+ * Checks whether glyphs of @font can be drawn from distance fields
+ * shared by all fonts of the same face.
+ *
+ * Fonts with variations are not supported, since their outlines
+ * depend on more than the face.
+ *
+ * Returns: %TRUE if @font may be used with the library
+ */
+gboolean
+gsk_gl_sdf_glyph_library_get_em_size (PangoFont *font,
+                                      float     *em_size)
+{
+  PangoFontDescription *desc;
+  gboolean ret;
+
+  desc = pango_font_describe_with_absolute_size (font);
+  *em_size = pango_font_description_get_size (desc) / (float)PANGO_SCALE;
+  ret = *em_size > 0 &&
+        pango_font_description_get_variations (desc) == NULL &&
+        pango_font_get_face (font) != NULL;
+  pango_font_description_free (desc);
+
+  return ret;
+}
+
+static guint8 *
+ensure_buffer (guint8 **buffer,
+               gsize   *buffer_len,
+               gsize    n_bytes)
+{
+  if (n_bytes > *buffer_len)
+    {
+      *buffer = g_realloc (*buffer, n_bytes);
+      *buffer_len = n_bytes;
+    }
+
+  memset (*buffer, 0, n_bytes);
+
+  return *buffer;
+}
+
+/* Converts an 8-bit coverage mask into a signed distance field, using
+ * a brute force search for the nearest pixel on the other side of the
+ * outline. The search is bounded by the spread which keeps this cheap
+ * enough for the small bitmaps we deal with, as every glyph is only
+ * processed once.
+ */
+static void
+compute_distance_field (const guint8 *coverage,
+                        int           stride,
+                        int           width,
+                        int           height,
+                        guint8       *field)
+{
+  const int spread = GSK_GL_SDF_GLYPH_SPREAD;
+
+  for (int y = 0; y < height; y++)
+    {
+      for (int x = 0; x < width; x++)
+        {
+          gboolean inside = coverage[y * stride + x] >= 128;
+          int best = spread * spread;
+          float dist;
+          float value;
+
+          for (int dy = MAX (-spread, -y); dy <= MIN (spread, height - 1 - y); dy++)
+            {
+              for (int dx = MAX (-spread, -x); dx <= MIN (spread, width - 1 - x); dx++)
+                {
+                  int d2 = dx * dx + dy * dy;
+
+                  if (d2 >= best)
+                    continue;
+
+                  if ((coverage[(y + dy) * stride + x + dx] >= 128) != inside)
+                    best = d2;
+                }
+            }
+
+          /* Pixels outside of the search area count as inside or
+           * outside depending on what they are, which is only wrong
+           * for glyphs touching the edge, and we pad for that.
+           */
+          dist = sqrtf (best) - 0.5f;
+          if (!inside)
+            dist = -dist;
+
+          value = 0.5f + dist / (2.0f * spread);
+          value = CLAMP (value, 0.0f, 1.0f);
+
+          field[(y * width + x) * 4 + 0] =
+          field[(y * width + x) * 4 + 1] =
+          field[(y * width + x) * 4 + 2] =
+          field[(y * width + x) * 4 + 3] = (guint8) (value * 255.0f + 0.5f);
+        }
+    }
+}
+
+static void
+gsk_gl_sdf_glyph_library_upload_glyph (GskGLSdfGlyphLibrary     *self,
+                                       const GskGLSdfGlyphKey   *key,
+                                       PangoFont                *font,
+                                       const GskGLSdfGlyphValue *value,
+                                       const PangoRectangle     *ink_rect,
+                                       float                     scale,
+                                       int                       x,
+                                       int                       y,
+                                       int                       width,
+                                       int                       height)
+{
+  GskGLTextureLibrary *tl = (GskGLTextureLibrary *)self;
+  G_GNUC_UNUSED gint64 start_time = GDK_PROFILER_CURRENT_TIME;
+  PangoGlyphString glyph_string;
+  PangoGlyphInfo glyph_info = {0};
+  cairo_surface_t *surface;
+  guint8 *coverage;
+  guint8 *field;
+  cairo_t *cr;
+  guint texture_id;
+  int stride;
+
+  g_assert (GSK_IS_GL_SDF_GLYPH_LIBRARY (self));
+
+  gdk_gl_context_push_debug_group_printf (gdk_gl_context_get_current (),
+                                          "Uploading distance field for glyph %d",
+                                          key->glyph);
+
+  stride = cairo_format_stride_for_width (CAIRO_FORMAT_A8, width);
+  coverage = ensure_buffer (&self->coverage, &self->coverage_len, stride * height);
+  field = ensure_buffer (&self->field, &self->field_len, width * height * 4);
+
+  surface = cairo_image_surface_create_for_data (coverage, CAIRO_FORMAT_A8,
+                                                 width, height, stride);
+  cr = cairo_create (surface);
+
+  /* Place the top-left of the ink rectangle at the spread offset,
+   * then render the outline at the reference em size.
+   */
+  cairo_translate (cr,
+                   GSK_GL_SDF_GLYPH_SPREAD - ink_rect->x * scale / PANGO_SCALE,
+                   GSK_GL_SDF_GLYPH_SPREAD - ink_rect->y * scale / PANGO_SCALE);
+  cairo_scale (cr, scale, scale);
+  cairo_set_source_rgba (cr, 1, 1, 1, 1);
+
+  glyph_info.glyph = key->glyph;
+  glyph_string.num_glyphs = 1;
+  glyph_string.glyphs = &glyph_info;
+
+  pango_cairo_show_glyph_string (cr, font, &glyph_string);
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  compute_distance_field (coverage, stride, width, height, field);
+  cairo_surface_destroy (surface);
+
+  texture_id = GSK_GL_TEXTURE_ATLAS_ENTRY_TEXTURE (value);
+
+  g_assert (texture_id > 0);
+
+  glBindTexture (GL_TEXTURE_2D, texture_id);
+  glTexSubImage2D (GL_TEXTURE_2D, 0, x, y, width, height,
+                   GL_RGBA, GL_UNSIGNED_BYTE, field);
+
+  gdk_gl_context_pop_debug_group (gdk_gl_context_get_current ());
+
+  tl->driver->command_queue->n_uploads++;
+
+  if (gdk_profiler_is_running ())
+    gdk_profiler_add_markf (start_time, GDK_PROFILER_CURRENT_TIME-start_time,
+                            "Upload Glyph Distance Field",
+                            "Size %dx%d", width, height);
+}
+
+gboolean
+gsk_gl_sdf_glyph_library_add (GskGLSdfGlyphLibrary      *self,
+                              GskGLSdfGlyphKey          *key,
+                              PangoFont                 *font,
+                              float                      em_size,
+                              const GskGLSdfGlyphValue **out_value)
+{
+  GskGLTextureLibrary *tl = (GskGLTextureLibrary *)self;
+  const int spread = GSK_GL_SDF_GLYPH_SPREAD;
+  PangoRectangle ink_rect;
+  GskGLSdfGlyphValue *value;
+  float scale;
+  int width;
+  int height;
+  guint packed_x;
+  guint packed_y;
+
+  g_assert (GSK_IS_GL_SDF_GLYPH_LIBRARY (self));
+  g_assert (key != NULL);
+  g_assert (PANGO_IS_FONT (font));
+  g_assert (em_size > 0);
+  g_assert (out_value != NULL);
+
+  /* Everything is rendered at the reference size, so we need to
+   * scale from the size of whatever font requested the glyph.
+   */
+  scale = GSK_GL_SDF_GLYPH_SIZE / em_size;
+
+  pango_font_get_glyph_extents (font, key->glyph, &ink_rect, NULL);
+
+  if (ink_rect.width > 0 && ink_rect.height > 0)
+    {
+      width = (int) ceilf (ink_rect.width * scale / PANGO_SCALE) + 2 * spread;
+      height = (int) ceilf (ink_rect.height * scale / PANGO_SCALE) + 2 * spread;
+    }
+  else
+    {
+      width = 0;
+      height = 0;
+    }
+
+  value = gsk_gl_texture_library_pack (tl,
+                                       key,
+                                       sizeof *value,
+                                       width,
+                                       height,
+                                       1,
+                                       &packed_x, &packed_y);
+
+  graphene_rect_init (&value->ink_rect,
+                      (ink_rect.x * scale / PANGO_SCALE - spread) / GSK_GL_SDF_GLYPH_SIZE,
+                      (ink_rect.y * scale / PANGO_SCALE - spread) / GSK_GL_SDF_GLYPH_SIZE,
+                      width / (float) GSK_GL_SDF_GLYPH_SIZE,
+                      height / (float) GSK_GL_SDF_GLYPH_SIZE);
+
+  if (width > 0 && height > 0)
+    gsk_gl_sdf_glyph_library_upload_glyph (self,
+                                           key,
+                                           font,
+                                           value,
+                                           &ink_rect,
+                                           scale,
+                                           packed_x + 1,
+                                           packed_y + 1,
+                                           width,
+                                           height);
+
+  *out_value = value;
+
+  return GSK_GL_TEXTURE_ATLAS_ENTRY_TEXTURE (value) != 0;
+}
@@ -0,0 +1,99 @@
+/* gskglsdfglyphlibraryprivate.h
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#ifndef __GSK_GL_SDF_GLYPH_LIBRARY_PRIVATE_H__
+#define __GSK_GL_SDF_GLYPH_LIBRARY_PRIVATE_H__
+
+#include <pango/pango.h>
+#include <graphene.h>
+
+#include "gskgltexturelibraryprivate.h"
+
+G_BEGIN_DECLS
+
+#define GSK_TYPE_GL_SDF_GLYPH_LIBRARY (gsk_gl_sdf_glyph_library_get_type())
+
+/* The em size in pixels that distance fields are rendered at, and
+ * the distance in pixels (at that size) covered by the field on
+ * either side of the outline.
+ */
+#define GSK_GL_SDF_GLYPH_SIZE   48
+#define GSK_GL_SDF_GLYPH_SPREAD 6
+
+typedef struct _GskGLSdfGlyphKey
+{
+  PangoFontFace *face;
+  PangoGlyph glyph;
+} GskGLSdfGlyphKey;
+
+typedef struct _GskGLSdfGlyphValue
+{
+  GskGLTextureAtlasEntry entry;
+
+  /* The area covered by the distance field relative to the glyph
+   * origin, in units of the em size of the font.
+   */
+  graphene_rect_t ink_rect;
+} GskGLSdfGlyphValue;
+
+G_DECLARE_FINAL_TYPE (GskGLSdfGlyphLibrary, gsk_gl_sdf_glyph_library, GSK, GL_SDF_GLYPH_LIBRARY, GskGLTextureLibrary)
+
+struct _GskGLSdfGlyphLibrary
+{
+  GskGLTextureLibrary parent_instance;
+  guint8 *coverage;
+  gsize coverage_len;
+  guint8 *field;
+  gsize field_len;
+};
+
+GskGLSdfGlyphLibrary *gsk_gl_sdf_glyph_library_new          (GskGLDriver               *driver);
+gboolean              gsk_gl_sdf_glyph_library_get_em_size  (PangoFont                 *font,
+                                                             float                     *em_size);
+gboolean              gsk_gl_sdf_glyph_library_add          (GskGLSdfGlyphLibrary      *self,
+                                                             GskGLSdfGlyphKey          *key,
+                                                             PangoFont                 *font,
+                                                             float                      em_size,
+                                                             const GskGLSdfGlyphValue **out_value);
+
+static inline guint
+gsk_gl_sdf_glyph_library_lookup_or_add (GskGLSdfGlyphLibrary      *self,
+                                        const GskGLSdfGlyphKey    *key,
+                                        PangoFont                 *font,
+                                        float                      em_size,
+                                        const GskGLSdfGlyphValue **out_value)
+{
+  GskGLTextureAtlasEntry *entry;
+
+  if (gsk_gl_texture_library_lookup ((GskGLTextureLibrary *)self, key, &entry))
+    {
+      *out_value = (GskGLSdfGlyphValue *)entry;
+    }
+  else
+    {
+      GskGLSdfGlyphKey *k = g_slice_copy (sizeof *key, key);
+      g_object_ref (k->face);
+      gsk_gl_sdf_glyph_library_add (self, k, font, em_size, out_value);
+    }
+
+  return GSK_GL_TEXTURE_ATLAS_ENTRY_TEXTURE (*out_value);
+}
+
+G_END_DECLS
+
+#endif /* __GSK_GL_SDF_GLYPH_LIBRARY_PRIVATE_H__ */
@@ -22,6 +22,8 @@
 
 #include <string.h>
 
+#include <gdk/gdkprofilerprivate.h>
+
 #include "gskgldriverprivate.h"
 #include "gskglshadowlibraryprivate.h"
 
@@ -32,6 +34,13 @@ struct _GskGLShadowLibrary
   GObject        parent_instance;
   GskGLDriver *driver;
   GArray        *shadows;
+  guint64        n_evictions;
+
+  /* Lookups since the last frame, for the profiler */
+  guint          n_hits;
+  guint          n_misses;
+  guint          hits_counter;
+  guint          misses_counter;
 };
 
 typedef struct _Shadow
@@ -140,6 +149,9 @@ static void
 gsk_gl_shadow_library_init (GskGLShadowLibrary *self)
 {
   self->shadows = g_array_new (FALSE, FALSE, sizeof (Shadow));
+
+  self->hits_counter = gdk_profiler_define_int_counter ("shadow-cache-hits", "Blurred shadows reused from the cache");
+  self->misses_counter = gdk_profiler_define_int_counter ("shadow-cache-misses", "Blurred shadows rendered");
 }
 
 void
@@ -193,10 +205,15 @@ gsk_gl_shadow_library_lookup (GskGLShadowLibrary   *self,
     }
 
   if (ret == NULL)
-    return 0;
+    {
+      self->n_misses++;
+      return 0;
+    }
 
   g_assert (ret->texture_id != 0);
 
+  self->n_hits++;
+
   ret->last_used_in_frame = self->driver->current_frame_id;
 
   return ret->texture_id;
@@ -241,6 +258,11 @@ gsk_gl_shadow_library_begin_frame (GskGLShadowLibrary *self)
     }
 #endif
 
+  gdk_profiler_set_int_counter (self->hits_counter, self->n_hits);
+  gdk_profiler_set_int_counter (self->misses_counter, self->n_misses);
+  self->n_hits = 0;
+  self->n_misses = 0;
+
   watermark = self->driver->current_frame_id - MAX_UNUSED_FRAMES;
 
   for (i = 0, p = self->shadows->len; i < p; i++)
@@ -251,8 +273,32 @@ gsk_gl_shadow_library_begin_frame (GskGLShadowLibrary *self)
         {
           gsk_gl_driver_release_texture_by_id (self->driver, shadow->texture_id);
           g_array_remove_index_fast (self->shadows, i);
+          self->n_evictions++;
           p--;
           i--;
         }
     }
 }
+
+void
+gsk_gl_shadow_library_get_memory_usage (GskGLShadowLibrary *self,
+                                        gsize              *bytes,
+                                        guint              *n_items,
+                                        guint64            *n_evictions)
+{
+  g_return_if_fail (GSK_IS_GL_SHADOW_LIBRARY (self));
+
+  *bytes = 0;
+  *n_items = self->shadows->len;
+  *n_evictions = self->n_evictions;
+
+  for (guint i = 0; i < self->shadows->len; i++)
+    {
+      const Shadow *shadow = &g_array_index (self->shadows, Shadow, i);
+      GskGLTexture *texture;
+
+      texture = g_hash_table_lookup (self->driver->textures, GUINT_TO_POINTER (shadow->texture_id));
+      if (texture != NULL)
+        *bytes += gsk_gl_texture_get_n_bytes (texture);
+    }
+}
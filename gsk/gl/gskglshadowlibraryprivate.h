@@ -38,6 +38,11 @@ void                 gsk_gl_shadow_library_insert      (GskGLShadowLibrary   *se
                                                         const GskRoundedRect *outline,
                                                         float                 blur_radius,
                                                         guint                 texture_id);
+void                 gsk_gl_shadow_library_get_memory_usage
+                                                       (GskGLShadowLibrary   *self,
+                                                        gsize                *bytes,
+                                                        guint                *n_items,
+                                                        guint64              *n_evictions);
 
 G_END_DECLS
 
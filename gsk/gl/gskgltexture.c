@@ -36,6 +36,18 @@ gsk_gl_texture_free (GskGLTexture *texture)
       if (texture->user)
         g_clear_pointer (&texture->user, gdk_texture_clear_render_data);
 
+      if (texture->upload_fence != NULL)
+        {
+          glDeleteSync (texture->upload_fence);
+          texture->upload_fence = NULL;
+        }
+
+      if (texture->upload_buffer_id != 0)
+        {
+          glDeleteBuffers (1, &texture->upload_buffer_id);
+          texture->upload_buffer_id = 0;
+        }
+
       if (texture->texture_id != 0)
         {
           glDeleteTextures (1, &texture->texture_id);
@@ -99,3 +111,35 @@ gsk_gl_texture_get_nine_slice (GskGLTexture         *texture,
 
   return texture->nine_slice;
 }
+
+/**
+ * gsk_gl_texture_is_uploaded:
+ * @texture: a `GskGLTexture`
+ *
+ * Checks whether an asynchronous upload to @texture has completed,
+ * releasing the resources used for the transfer if so.
+ *
+ * This does not block on the GPU.
+ *
+ * Returns: %TRUE if the contents of @texture are available
+ */
+gboolean
+gsk_gl_texture_is_uploaded (GskGLTexture *texture)
+{
+  GLint status = GL_UNSIGNALED;
+
+  if (texture->upload_fence == NULL)
+    return TRUE;
+
+  glGetSynciv (texture->upload_fence, GL_SYNC_STATUS, 1, NULL, &status);
+  if (status != GL_SIGNALED)
+    return FALSE;
+
+  glDeleteSync (texture->upload_fence);
+  texture->upload_fence = NULL;
+
+  glDeleteBuffers (1, &texture->upload_buffer_id);
+  texture->upload_buffer_id = 0;
+
+  return TRUE;
+}
@@ -20,7 +20,10 @@
 
 #include "config.h"
 
+#include <math.h>
+
 #include <gdk/gdkglcontextprivate.h>
+#include <gdk/gdkprofilerprivate.h>
 #include <gsk/gskdebugprivate.h>
 
 #include "gskglcommandqueueprivate.h"
@@ -134,6 +137,41 @@ gsk_gl_texture_library_set_funcs (GskGLTextureLibrary *self,
                                             key_destroy, value_destroy);
 }
 
+/* Reports the lookups of the last frame as "glyph-cache-hits",
+ * "icon-cache-misses" and so on.
+ */
+static void
+gsk_gl_texture_library_report_stats (GskGLTextureLibrary *self)
+{
+  GskGLTextureLibraryClass *klass = GSK_GL_TEXTURE_LIBRARY_GET_CLASS (self);
+
+  if (GDK_PROFILER_IS_RUNNING && klass->profiler_name != NULL)
+    {
+      if (klass->hits_counter == 0)
+        {
+          char *name, *description;
+
+          name = g_strdup_printf ("%s-cache-hits", klass->profiler_name);
+          description = g_strdup_printf ("Lookups found in the %s atlas cache", klass->profiler_name);
+          klass->hits_counter = gdk_profiler_define_int_counter (name, description);
+          g_free (name);
+          g_free (description);
+
+          name = g_strdup_printf ("%s-cache-misses", klass->profiler_name);
+          description = g_strdup_printf ("Lookups missing from the %s atlas cache", klass->profiler_name);
+          klass->misses_counter = gdk_profiler_define_int_counter (name, description);
+          g_free (name);
+          g_free (description);
+        }
+
+      gdk_profiler_set_int_counter (klass->hits_counter, self->n_hits);
+      gdk_profiler_set_int_counter (klass->misses_counter, self->n_misses);
+    }
+
+  self->n_hits = 0;
+  self->n_misses = 0;
+}
+
 void
 gsk_gl_texture_library_begin_frame (GskGLTextureLibrary *self,
                                     gint64               frame_id,
@@ -143,6 +181,8 @@ gsk_gl_texture_library_begin_frame (GskGLTextureLibrary *self,
 
   g_return_if_fail (GSK_IS_GL_TEXTURE_LIBRARY (self));
 
+  gsk_gl_texture_library_report_stats (self);
+
   if (GSK_GL_TEXTURE_LIBRARY_GET_CLASS (self)->begin_frame)
     GSK_GL_TEXTURE_LIBRARY_GET_CLASS (self)->begin_frame (self, frame_id, removed_atlases);
 
@@ -170,6 +210,8 @@ gsk_gl_texture_library_begin_frame (GskGLTextureLibrary *self,
             }
         }
 
+      self->n_evictions += dropped;
+
       GSK_NOTE (GLYPH_CACHE,
                 if (dropped > 0)
                   g_message ("%s: Dropped %d items",
@@ -199,6 +241,8 @@ gsk_gl_texture_library_begin_frame (GskGLTextureLibrary *self,
             atlased++;
         }
 
+      self->n_evictions += dropped;
+
       GSK_NOTE (GLYPH_CACHE, g_message ("%s: Dropped %d individual items",
                                         G_OBJECT_TYPE_NAME (self),
                                         dropped);
@@ -317,7 +361,8 @@ gsk_gl_texture_atlases_pack (GskGLDriver        *driver,
     {
       atlas = g_ptr_array_index (driver->atlases, i);
 
-      if (gsk_gl_texture_atlas_pack (atlas, width, height, &x, &y))
+      if (!atlas->evacuating &&
+          gsk_gl_texture_atlas_pack (atlas, width, height, &x, &y))
         break;
 
       atlas = NULL;
@@ -340,6 +385,104 @@ gsk_gl_texture_atlases_pack (GskGLDriver        *driver,
   *out_y = y;
 }
 
+static void
+gsk_gl_texture_library_move_entry (GskGLTextureLibrary    *self,
+                                   GskGLTextureAtlasEntry *entry)
+{
+  GskGLTextureAtlas *old_atlas = entry->atlas;
+  GskGLTextureAtlas *atlas;
+  int padding = entry->padding;
+  int width, height;
+  int src_x, src_y;
+  int x, y;
+
+  g_assert (entry->is_atlased);
+  g_assert (old_atlas->evacuating);
+  g_assert (old_atlas->framebuffer_id != 0);
+
+  width = roundf ((entry->area.x2 - entry->area.x) * old_atlas->width);
+  height = roundf ((entry->area.y2 - entry->area.y) * old_atlas->height);
+  src_x = roundf (entry->area.x * old_atlas->width) - padding;
+  src_y = roundf (entry->area.y * old_atlas->height) - padding;
+
+  gsk_gl_texture_atlases_pack (self->driver,
+                               padding + width + padding,
+                               padding + height + padding,
+                               &atlas, &x, &y);
+
+  /* Copy on the GPU, including the padding, so nothing is re-rasterized */
+  glBindFramebuffer (GL_FRAMEBUFFER, old_atlas->framebuffer_id);
+  glBindTexture (GL_TEXTURE_2D, atlas->texture_id);
+  glCopyTexSubImage2D (GL_TEXTURE_2D, 0,
+                       x, y,
+                       src_x, src_y,
+                       padding + width + padding,
+                       padding + height + padding);
+
+  entry->atlas = atlas;
+  entry->area.x = (x + padding) / (float)atlas->width;
+  entry->area.y = (y + padding) / (float)atlas->height;
+  entry->area.x2 = (x + padding + width) / (float)atlas->width;
+  entry->area.y2 = (y + padding + height) / (float)atlas->height;
+}
+
+/**
+ * gsk_gl_texture_library_compact:
+ * @self: a `GskGLTextureLibrary`
+ * @max_moves: the maximum number of entries to move
+ *
+ * Moves up to @max_moves live entries out of atlases that are being
+ * evacuated into other atlases, and drops entries from them that have
+ * not been used recently.
+ *
+ * Entries left behind are counted in the atlas' n_live_entries so that
+ * the driver knows when an atlas can be released.
+ *
+ * Returns: the number of entries that were moved
+ */
+guint
+gsk_gl_texture_library_compact (GskGLTextureLibrary *self,
+                                guint                max_moves)
+{
+  GskGLTextureAtlasEntry *entry;
+  GHashTableIter iter;
+  guint dropped = 0;
+  guint moved = 0;
+
+  g_return_val_if_fail (GSK_IS_GL_TEXTURE_LIBRARY (self), 0);
+
+  g_hash_table_iter_init (&iter, self->hash_table);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&entry))
+    {
+      if (!entry->is_atlased || !entry->atlas->evacuating)
+        continue;
+
+      if (!entry->used)
+        {
+          g_hash_table_iter_remove (&iter);
+          dropped++;
+        }
+      else if (moved < max_moves)
+        {
+          gsk_gl_texture_library_move_entry (self, entry);
+          moved++;
+        }
+      else
+        {
+          entry->atlas->n_live_entries++;
+        }
+    }
+
+  self->n_evictions += dropped;
+
+  GSK_NOTE (GLYPH_CACHE,
+            if (moved > 0 || dropped > 0)
+              g_message ("%s: Moved %u items, dropped %u items",
+                         G_OBJECT_TYPE_NAME (self), moved, dropped));
+
+  return moved;
+}
+
 gpointer
 gsk_gl_texture_library_pack (GskGLTextureLibrary *self,
                              gpointer             key,
@@ -359,6 +502,8 @@ gsk_gl_texture_library_pack (GskGLTextureLibrary *self,
   g_assert (out_packed_x != NULL);
   g_assert (out_packed_y != NULL);
 
+  self->n_misses++;
+
   entry = g_slice_alloc0 (valuelen);
   entry->n_pixels = width * height;
   entry->accessed = TRUE;
@@ -394,6 +539,7 @@ gsk_gl_texture_library_pack (GskGLTextureLibrary *self,
 
       entry->atlas = atlas;
       entry->is_atlased = TRUE;
+      entry->padding = padding;
       entry->area.x = (packed_x + padding) / (float)atlas->width;
       entry->area.y = (packed_y + padding) / (float)atlas->height;
       entry->area.x2 = (packed_x + padding + width) / (float)atlas->width;
@@ -424,3 +570,42 @@ gsk_gl_texture_library_pack (GskGLTextureLibrary *self,
 
   return entry;
 }
+
+/**
+ * gsk_gl_texture_library_get_memory_usage:
+ * @self: a `GskGLTextureLibrary`
+ * @bytes: (out): return location for the bytes used by the entries
+ * @atlased_bytes: (out): return location for the part of @bytes
+ *   that is in atlases
+ * @n_items: (out): return location for the number of entries
+ *
+ * Adds up the memory used by the entries of the library. Entries
+ * in atlases only count the area they cover, entries that were too
+ * large for an atlas count their whole texture.
+ */
+void
+gsk_gl_texture_library_get_memory_usage (GskGLTextureLibrary *self,
+                                         gsize               *bytes,
+                                         gsize               *atlased_bytes,
+                                         guint               *n_items)
+{
+  GskGLTextureAtlasEntry *entry;
+  GHashTableIter iter;
+
+  g_return_if_fail (GSK_IS_GL_TEXTURE_LIBRARY (self));
+
+  *bytes = 0;
+  *atlased_bytes = 0;
+  *n_items = g_hash_table_size (self->hash_table);
+
+  g_hash_table_iter_init (&iter, self->hash_table);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&entry))
+    {
+      if (entry->is_atlased)
+        *atlased_bytes += (gsize) entry->n_pixels * 4;
+      else if (entry->texture != NULL)
+        *bytes += gsk_gl_texture_get_n_bytes (entry->texture);
+    }
+
+  *bytes += *atlased_bytes;
+}
@@ -50,6 +50,17 @@ typedef struct _GskGLTextureAtlas
    */
   int unused_pixels;
 
+  /* While evacuating, a framebuffer to copy entries out of the atlas,
+   * and the number of entries which are still left in it.
+   */
+  guint framebuffer_id;
+  guint n_live_entries;
+
+  /* Set once too much of the atlas is unused. No new entries are
+   * packed into it and live entries are moved to other atlases.
+   */
+  guint evacuating : 1;
+
   void *user_data;
 } GskGLTextureAtlas;
 
@@ -85,6 +96,9 @@ typedef struct _GskGLTextureAtlasEntry
 
   /* When true, backref is an atlas, otherwise texture */
   guint is_atlased : 1;
+
+  /* The padding around the area, copied along when moving the entry */
+  guint padding : 8;
 } GskGLTextureAtlasEntry;
 
 typedef struct _GskGLTextureLibrary
@@ -93,12 +107,24 @@ typedef struct _GskGLTextureLibrary
   GskGLDriver *driver;
   GHashTable    *hash_table;
   guint          max_entry_size;
+
+  /* Lookups since the last frame, for the profiler */
+  guint          n_hits;
+  guint          n_misses;
+
+  /* Entries that were dropped, ever */
+  guint64        n_evictions;
 } GskGLTextureLibrary;
 
 typedef struct _GskGLTextureLibraryClass
 {
   GObjectClass parent_class;
 
+  /* Prefix of the profiler counters, set by subclasses */
+  const char *profiler_name;
+  guint hits_counter;
+  guint misses_counter;
+
   void (*begin_frame) (GskGLTextureLibrary *library,
                        gint64               frame_id,
                        GPtrArray           *removed_atlases);
@@ -115,6 +141,8 @@ void     gsk_gl_texture_library_set_funcs   (GskGLTextureLibrary *self,
 void     gsk_gl_texture_library_begin_frame (GskGLTextureLibrary *self,
                                              gint64               frame_id,
                                              GPtrArray           *removed_atlases);
+guint    gsk_gl_texture_library_compact     (GskGLTextureLibrary *self,
+                                             guint                max_moves);
 gpointer gsk_gl_texture_library_pack        (GskGLTextureLibrary *self,
                                              gpointer             key,
                                              gsize                valuelen,
@@ -123,6 +151,11 @@ gpointer gsk_gl_texture_library_pack        (GskGLTextureLibrary *self,
                                              int                  padding,
                                              guint               *out_packed_x,
                                              guint               *out_packed_y);
+void     gsk_gl_texture_library_get_memory_usage
+                                            (GskGLTextureLibrary *self,
+                                             gsize               *bytes,
+                                             gsize               *atlased_bytes,
+                                             guint               *n_items);
 
 static inline void
 gsk_gl_texture_atlas_mark_unused (GskGLTextureAtlas *self,
@@ -162,6 +195,7 @@ gsk_gl_texture_library_lookup (GskGLTextureLibrary     *self,
 
   if G_LIKELY (entry != NULL && entry->accessed && entry->used)
     {
+      self->n_hits++;
       *out_entry = entry;
       return TRUE;
     }
@@ -170,6 +204,7 @@ gsk_gl_texture_library_lookup (GskGLTextureLibrary     *self,
     {
       gsk_gl_texture_atlas_entry_mark_used (entry);
       entry->accessed = TRUE;
+      self->n_hits++;
       *out_entry = entry;
       return TRUE;
     }
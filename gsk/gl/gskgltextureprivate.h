@@ -63,14 +63,26 @@ struct _GskGLTexture
   /* The actual GL texture identifier in some shared context */
   guint texture_id;
 
+  /* Pending asynchronous upload, see gsk_gl_texture_is_uploaded() */
+  GLsync upload_fence;
+  guint upload_buffer_id;
+
   int width;
   int height;
   int min_filter;
   int mag_filter;
   int format;
 
+  /* Frames in which the texture was drawn minified,
+   * see gsk_gl_driver_note_minified() */
+  gint64 last_minified_frame;
+  guint n_minified_frames;
+
   /* Set when used by an atlas so we don't drop the texture */
   guint              permanent : 1;
+
+  /* Set when mipmaps have been generated */
+  guint              has_mipmap : 1;
 };
 
 GskGLTexture                * gsk_gl_texture_new            (guint                 texture_id,
@@ -85,6 +97,40 @@ const GskGLTextureNineSlice * gsk_gl_texture_get_nine_slice (GskGLTexture
                                                              float                 extra_pixels_x,
                                                              float                 extra_pixels_y);
 void                          gsk_gl_texture_free           (GskGLTexture         *texture);
+gboolean                      gsk_gl_texture_is_uploaded    (GskGLTexture         *texture);
+
+static inline gsize
+gsk_gl_format_get_bytes_per_pixel (int format)
+{
+  switch (format)
+    {
+    case GL_RGBA16F:
+      return 8;
+    case GL_RGBA32F:
+      return 16;
+    default:
+      return 4;
+    }
+}
+
+/* An estimate, drivers may pad textures or keep copies of them */
+static inline gsize
+gsk_gl_texture_get_n_bytes (const GskGLTexture *texture)
+{
+  gsize n_bytes;
+
+  if (texture->slices != NULL)
+    return 0; /* The slices are separate textures */
+
+  n_bytes = (gsize) texture->width * (gsize) texture->height *
+            gsk_gl_format_get_bytes_per_pixel (texture->format);
+
+  /* A full mipmap chain adds a third */
+  if (texture->has_mipmap)
+    n_bytes += n_bytes / 3;
+
+  return n_bytes;
+}
 
 G_END_DECLS
 
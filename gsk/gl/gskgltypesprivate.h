@@ -40,6 +40,7 @@ typedef struct _GskGLGlyphLibrary GskGLGlyphLibrary;
 typedef struct _GskGLIconLibrary GskGLIconLibrary;
 typedef struct _GskGLProgram GskGLProgram;
 typedef struct _GskGLRenderJob GskGLRenderJob;
+typedef struct _GskGLSdfGlyphLibrary GskGLSdfGlyphLibrary;
 typedef struct _GskGLShadowLibrary GskGLShadowLibrary;
 typedef struct _GskGLTexture GskGLTexture;
 typedef struct _GskGLTextureSlice GskGLTextureSlice;
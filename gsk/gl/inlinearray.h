@@ -1,6 +1,8 @@
 #ifndef __INLINE_ARRAY_H__
 #define __INLINE_ARRAY_H__
 
+#include "gdk/gdkalloccountersprivate.h"
+
 #define DEFINE_INLINE_ARRAY(Type, prefix, ElementType)              \
   typedef struct _##Type {                                          \
     gsize len;                                                      \
@@ -15,6 +17,8 @@
     ar->len = 0;                                                    \
     ar->allocated = initial_size ? initial_size : 16;               \
     ar->items = g_new0 (ElementType, ar->allocated);                \
+    gdk_alloc_counters_add (GDK_ALLOC_GL_COMMANDS,                  \
+                            sizeof (ElementType) * ar->allocated);  \
   }                                                                 \
                                                                     \
   static inline void                                                \
@@ -44,6 +48,9 @@
       {                                                             \
         ar->allocated *= 2;                                         \
         ar->items = g_renew (ElementType, ar->items, ar->allocated);\
+        gdk_alloc_counters_add (GDK_ALLOC_GL_COMMANDS,              \
+                                sizeof (ElementType) *              \
+                                ar->allocated);                     \
       }                                                             \
                                                                     \
     ar->len++;                                                      \
@@ -60,6 +67,9 @@
         while ((ar->len + n) > ar->allocated)                       \
           ar->allocated *= 2;                                       \
         ar->items = g_renew (ElementType, ar->items, ar->allocated);\
+        gdk_alloc_counters_add (GDK_ALLOC_GL_COMMANDS,              \
+                                sizeof (ElementType) *              \
+                                ar->allocated);                     \
       }                                                             \
                                                                     \
     ar->len += n;                                                   \
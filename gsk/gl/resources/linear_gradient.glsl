@@ -42,7 +42,7 @@ void main() {
 // FRAGMENT_SHADER:
 // linear_gradient.glsl
 
-#define MAX_COLOR_STOPS 6
+#define MAX_COLOR_STOPS 16
 
 #ifdef GSK_LEGACY
 uniform int u_num_color_stops;
@@ -50,25 +50,22 @@ uniform int u_num_color_stops;
 uniform highp int u_num_color_stops; // Why? Because it works like this.
 #endif
 
-uniform float u_color_stops[MAX_COLOR_STOPS * 5];
+uniform vec4 u_color_stops[MAX_COLOR_STOPS / 4 + MAX_COLOR_STOPS];
 uniform bool u_repeat;
 
 _IN_ vec4 info;
 
+// The first MAX_COLOR_STOPS / 4 entries hold the offsets, packed
+// four to a vector, and the colors follow. This keeps the array
+// length small enough for the uniform state.
 float get_offset(int index) {
-  // u_color_stops[5 * index] makes Intel Windows driver crash.
-  // See https://gitlab.gnome.org/GNOME/gtk/-/issues/3783
-  int base = 5 * index;
-  return u_color_stops[base];
+  int base = index / 4;
+  vec4 offsets = u_color_stops[base];
+  return offsets[index - 4 * base];
 }
 
 vec4 get_color(int index) {
-  int base = 5 * index + 1;
-
-  return vec4(u_color_stops[base],
-              u_color_stops[base + 1],
-              u_color_stops[base + 2],
-              u_color_stops[base + 3]);
+  return u_color_stops[MAX_COLOR_STOPS / 4 + index];
 }
 
 void main() {
@@ -20,7 +20,7 @@ void main() {
 // FRAGMENT_SHADER:
 // radial_gradient.glsl
 
-#define MAX_COLOR_STOPS 6
+#define MAX_COLOR_STOPS 16
 
 #ifdef GSK_LEGACY
 uniform int u_num_color_stops;
@@ -30,24 +30,21 @@ uniform highp int u_num_color_stops;
 
 uniform bool u_repeat;
 uniform vec2 u_range;
-uniform float u_color_stops[MAX_COLOR_STOPS * 5];
+uniform vec4 u_color_stops[MAX_COLOR_STOPS / 4 + MAX_COLOR_STOPS];
 
 _IN_ vec2 coord;
 
+// The first MAX_COLOR_STOPS / 4 entries hold the offsets, packed
+// four to a vector, and the colors follow. This keeps the array
+// length small enough for the uniform state.
 float get_offset(int index) {
-  // u_color_stops[5 * index] makes Intel Windows driver crash.
-  // See https://gitlab.gnome.org/GNOME/gtk/-/issues/3783
-  int base = 5 * index;
-  return u_color_stops[base];
+  int base = index / 4;
+  vec4 offsets = u_color_stops[base];
+  return offsets[index - 4 * base];
 }
 
 vec4 get_color(int index) {
-  int base = 5 * index + 1;
-
-  return vec4(u_color_stops[base],
-              u_color_stops[base + 1],
-              u_color_stops[base + 2],
-              u_color_stops[base + 3]);
+  return u_color_stops[MAX_COLOR_STOPS / 4 + index];
 }
 
 void main() {
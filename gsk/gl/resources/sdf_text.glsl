@@ -0,0 +1,28 @@
+// VERTEX_SHADER:
+// sdf_text.glsl
+
+_OUT_ vec4 final_color;
+
+void main() {
+  gl_Position = u_projection * u_modelview * vec4(aPosition, 0.0, 1.0);
+
+  vUv = vec2(aUv.x, aUv.y);
+
+  final_color = gsk_scaled_premultiply(aColor, u_alpha);
+}
+
+// FRAGMENT_SHADER:
+// sdf_text.glsl
+
+uniform float u_smoothing;
+
+_IN_ vec4 final_color;
+
+void main() {
+  // The distance field is 0.5 on the outline of the glyph, and
+  // u_smoothing is half a device pixel in distance field units.
+  float dist = GskTexture(u_source, vUv).a;
+  float alpha = smoothstep(0.5 - u_smoothing, 0.5 + u_smoothing, dist);
+
+  gskSetOutputColor(final_color * alpha);
+}
@@ -25,6 +25,18 @@
 #include <math.h>
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_BLUR_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HAVE_BLUR_NEON 1
+#endif
+
+#if defined(HAVE_BLUR_SSE2) || defined(HAVE_BLUR_NEON)
+#define HAVE_BLUR_SIMD 1
+#endif
+
 /*
  * Gets the size for a single box blur.
  *
@@ -185,6 +197,519 @@ flip_buffer (guchar *dst_buffer,
 #undef BLOCK_SIZE
 }
 
+#ifdef HAVE_BLUR_SIMD
+
+/* The vectorized blur works on 16 rows or columns at once. They are
+ * laid out as a strip of 16-byte pixels, which turns the sliding
+ * window of blur_xspan() into a sliding window of vectors. Columns
+ * can be copied into a strip as they are, rows get there by
+ * transposing 16x16 blocks.
+ */
+#define STRIP_LANES 16
+
+/* The divisions are done in float with a precomputed reciprocal.
+ * That gives the same result as the integer division for all sums
+ * as long as the filter is not wider than this.
+ */
+#define MAX_SIMD_FILTER_SIZE 4096
+
+/* Surfaces with fewer pixels are not worth waking up other threads for */
+#define MIN_THREADED_PIXELS (512 * 512)
+
+#ifdef HAVE_BLUR_SSE2
+
+typedef __m128i BlurVector;
+typedef struct { __m128i v[4]; } BlurSum;
+typedef struct { __m128 bias; __m128 scale; } BlurDivisor;
+
+static inline BlurVector
+blur_vector_load (const guchar *p)
+{
+  return _mm_loadu_si128 ((const __m128i *) p);
+}
+
+static inline void
+blur_vector_store (guchar     *p,
+                   BlurVector  v)
+{
+  _mm_storeu_si128 ((__m128i *) p, v);
+}
+
+static inline void
+blur_vector_zip (BlurVector  a,
+                 BlurVector  b,
+                 BlurVector *lo,
+                 BlurVector *hi)
+{
+  *lo = _mm_unpacklo_epi8 (a, b);
+  *hi = _mm_unpackhi_epi8 (a, b);
+}
+
+static inline void
+blur_sum_init (BlurSum *sum)
+{
+  sum->v[0] = sum->v[1] = sum->v[2] = sum->v[3] = _mm_setzero_si128 ();
+}
+
+static inline void
+blur_vector_widen (const guchar *p,
+                   __m128i       w[4])
+{
+  __m128i zero = _mm_setzero_si128 ();
+  __m128i v = _mm_loadu_si128 ((const __m128i *) p);
+  __m128i lo = _mm_unpacklo_epi8 (v, zero);
+  __m128i hi = _mm_unpackhi_epi8 (v, zero);
+
+  w[0] = _mm_unpacklo_epi16 (lo, zero);
+  w[1] = _mm_unpackhi_epi16 (lo, zero);
+  w[2] = _mm_unpacklo_epi16 (hi, zero);
+  w[3] = _mm_unpackhi_epi16 (hi, zero);
+}
+
+static inline void
+blur_sum_add (BlurSum      *sum,
+              const guchar *p)
+{
+  __m128i w[4];
+  int i;
+
+  blur_vector_widen (p, w);
+  for (i = 0; i < 4; i++)
+    sum->v[i] = _mm_add_epi32 (sum->v[i], w[i]);
+}
+
+static inline void
+blur_sum_sub (BlurSum      *sum,
+              const guchar *p)
+{
+  __m128i w[4];
+  int i;
+
+  blur_vector_widen (p, w);
+  for (i = 0; i < 4; i++)
+    sum->v[i] = _mm_sub_epi32 (sum->v[i], w[i]);
+}
+
+static inline void
+blur_divisor_init (BlurDivisor *div,
+                   int          d)
+{
+  div->bias = _mm_set1_ps (d / 2 + 0.5f);
+  div->scale = _mm_set1_ps (1.0f / d);
+}
+
+static inline void
+blur_sum_store (const BlurSum     *sum,
+                const BlurDivisor *div,
+                guchar            *p)
+{
+  __m128i q[4];
+  int i;
+
+  for (i = 0; i < 4; i++)
+    q[i] = _mm_cvttps_epi32 (_mm_mul_ps (_mm_add_ps (_mm_cvtepi32_ps (sum->v[i]), div->bias), div->scale));
+
+  _mm_storeu_si128 ((__m128i *) p, _mm_packus_epi16 (_mm_packs_epi32 (q[0], q[1]),
+                                                     _mm_packs_epi32 (q[2], q[3])));
+}
+
+#else /* HAVE_BLUR_NEON */
+
+typedef uint8x16_t BlurVector;
+typedef struct { uint32x4_t v[4]; } BlurSum;
+typedef struct { float32x4_t bias; float32x4_t scale; } BlurDivisor;
+
+static inline BlurVector
+blur_vector_load (const guchar *p)
+{
+  return vld1q_u8 (p);
+}
+
+static inline void
+blur_vector_store (guchar     *p,
+                   BlurVector  v)
+{
+  vst1q_u8 (p, v);
+}
+
+static inline void
+blur_vector_zip (BlurVector  a,
+                 BlurVector  b,
+                 BlurVector *lo,
+                 BlurVector *hi)
+{
+  uint8x16x2_t z = vzipq_u8 (a, b);
+
+  *lo = z.val[0];
+  *hi = z.val[1];
+}
+
+static inline void
+blur_sum_init (BlurSum *sum)
+{
+  sum->v[0] = sum->v[1] = sum->v[2] = sum->v[3] = vdupq_n_u32 (0);
+}
+
+static inline void
+blur_vector_widen (const guchar *p,
+                   uint32x4_t    w[4])
+{
+  uint8x16_t v = vld1q_u8 (p);
+  uint16x8_t lo = vmovl_u8 (vget_low_u8 (v));
+  uint16x8_t hi = vmovl_u8 (vget_high_u8 (v));
+
+  w[0] = vmovl_u16 (vget_low_u16 (lo));
+  w[1] = vmovl_u16 (vget_high_u16 (lo));
+  w[2] = vmovl_u16 (vget_low_u16 (hi));
+  w[3] = vmovl_u16 (vget_high_u16 (hi));
+}
+
+static inline void
+blur_sum_add (BlurSum      *sum,
+              const guchar *p)
+{
+  uint32x4_t w[4];
+  int i;
+
+  blur_vector_widen (p, w);
+  for (i = 0; i < 4; i++)
+    sum->v[i] = vaddq_u32 (sum->v[i], w[i]);
+}
+
+static inline void
+blur_sum_sub (BlurSum      *sum,
+              const guchar *p)
+{
+  uint32x4_t w[4];
+  int i;
+
+  blur_vector_widen (p, w);
+  for (i = 0; i < 4; i++)
+    sum->v[i] = vsubq_u32 (sum->v[i], w[i]);
+}
+
+static inline void
+blur_divisor_init (BlurDivisor *div,
+                   int          d)
+{
+  div->bias = vdupq_n_f32 (d / 2 + 0.5f);
+  div->scale = vdupq_n_f32 (1.0f / d);
+}
+
+static inline void
+blur_sum_store (const BlurSum     *sum,
+                const BlurDivisor *div,
+                guchar            *p)
+{
+  uint16x4_t q[4];
+  int i;
+
+  for (i = 0; i < 4; i++)
+    q[i] = vmovn_u32 (vcvtq_u32_f32 (vmulq_f32 (vaddq_f32 (vcvtq_f32_u32 (sum->v[i]), div->bias), div->scale)));
+
+  vst1q_u8 (p, vcombine_u8 (vmovn_u16 (vcombine_u16 (q[0], q[1])),
+                            vmovn_u16 (vcombine_u16 (q[2], q[3]))));
+}
+
+#endif
+
+/* Transposes a 16x16 block of bytes. Interleaving the first half of
+ * the rows with the second half four times moves every byte to its
+ * transposed position.
+ */
+static void
+transpose_block (guchar       *dst,
+                 int           dst_stride,
+                 const guchar *src,
+                 int           src_stride)
+{
+  BlurVector a[STRIP_LANES], b[STRIP_LANES];
+  int i, stage;
+
+  for (i = 0; i < STRIP_LANES; i++)
+    a[i] = blur_vector_load (src + i * src_stride);
+
+  for (stage = 0; stage < 4; stage++)
+    {
+      for (i = 0; i < STRIP_LANES / 2; i++)
+        blur_vector_zip (a[i], a[i + STRIP_LANES / 2], &b[2 * i], &b[2 * i + 1]);
+      memcpy (a, b, sizeof (a));
+    }
+
+  for (i = 0; i < STRIP_LANES; i++)
+    blur_vector_store (dst + i * dst_stride, a[i]);
+}
+
+/* Same as blur_xspan(), for all lanes of a strip */
+static void
+blur_strip_span (guchar *strip,
+                 guchar *tmp_strip,
+                 int     length,
+                 int     d,
+                 int     shift)
+{
+  BlurDivisor div;
+  BlurSum sum;
+  int offset;
+  int i;
+
+  if (d % 2 == 1)
+    offset = d / 2;
+  else
+    offset = (d - shift) / 2;
+
+  blur_divisor_init (&div, d);
+  blur_sum_init (&sum);
+
+  for (i = -d + offset; i < length + offset; i++)
+    {
+      if (i >= 0 && i < length)
+        blur_sum_add (&sum, strip + i * STRIP_LANES);
+
+      if (i >= offset)
+        {
+          if (i >= d)
+            blur_sum_sub (&sum, strip + (i - d) * STRIP_LANES);
+
+          blur_sum_store (&sum, &div, tmp_strip + (i - offset) * STRIP_LANES);
+        }
+    }
+
+  memcpy (strip, tmp_strip, length * STRIP_LANES);
+}
+
+/* Same as one row of blur_rows() */
+static void
+blur_strip (guchar *strip,
+            guchar *tmp_strip,
+            int     length,
+            int     d)
+{
+  if (d % 2 == 1)
+    {
+      blur_strip_span (strip, tmp_strip, length, d, 0);
+      blur_strip_span (strip, tmp_strip, length, d, 0);
+      blur_strip_span (strip, tmp_strip, length, d, 0);
+    }
+  else
+    {
+      blur_strip_span (strip, tmp_strip, length, d, 1);
+      blur_strip_span (strip, tmp_strip, length, d, -1);
+      blur_strip_span (strip, tmp_strip, length, d + 1, 0);
+    }
+}
+
+/* Blurs the columns x0 .. x0 + 15 */
+static void
+blur_column_strip (guchar *buffer,
+                   guchar *strip,
+                   guchar *tmp_strip,
+                   int     width,
+                   int     height,
+                   int     x0,
+                   int     d)
+{
+  int n = MIN (STRIP_LANES, width - x0);
+  int y;
+
+  if (n < STRIP_LANES)
+    memset (strip, 0, height * STRIP_LANES);
+
+  for (y = 0; y < height; y++)
+    memcpy (strip + y * STRIP_LANES, buffer + y * width + x0, n);
+
+  blur_strip (strip, tmp_strip, height, d);
+
+  for (y = 0; y < height; y++)
+    memcpy (buffer + y * width + x0, strip + y * STRIP_LANES, n);
+}
+
+/* Blurs the rows y0 .. y0 + 15 */
+static void
+blur_row_strip (guchar *buffer,
+                guchar *strip,
+                guchar *tmp_strip,
+                int     width,
+                int     height,
+                int     y0,
+                int     d)
+{
+  guchar *rows = buffer + y0 * width;
+  int n = MIN (STRIP_LANES, height - y0);
+  int x0, x, y;
+
+  if (n < STRIP_LANES)
+    memset (strip, 0, width * STRIP_LANES);
+
+  for (x0 = 0; x0 < width; x0 += STRIP_LANES)
+    {
+      if (n == STRIP_LANES && x0 + STRIP_LANES <= width)
+        transpose_block (strip + x0 * STRIP_LANES, STRIP_LANES, rows + x0, width);
+      else
+        for (x = x0; x < MIN (x0 + STRIP_LANES, width); x++)
+          for (y = 0; y < n; y++)
+            strip[x * STRIP_LANES + y] = rows[y * width + x];
+    }
+
+  blur_strip (strip, tmp_strip, width, d);
+
+  for (x0 = 0; x0 < width; x0 += STRIP_LANES)
+    {
+      if (n == STRIP_LANES && x0 + STRIP_LANES <= width)
+        transpose_block (rows + x0, width, strip + x0 * STRIP_LANES, STRIP_LANES);
+      else
+        for (x = x0; x < MIN (x0 + STRIP_LANES, width); x++)
+          for (y = 0; y < n; y++)
+            rows[y * width + x] = strip[x * STRIP_LANES + y];
+    }
+}
+
+typedef struct
+{
+  guchar *buffer;
+  int width;
+  int height;
+  int d;
+  gboolean vertical;
+
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+} BlurTask;
+
+typedef struct
+{
+  BlurTask *task;
+  int first_strip;
+  int last_strip;
+} BlurJob;
+
+static void
+blur_job_run (BlurJob *job)
+{
+  BlurTask *task = job->task;
+  int length = task->vertical ? task->height : task->width;
+  guchar *strip, *tmp_strip;
+  int i;
+
+  strip = g_malloc (2 * length * STRIP_LANES);
+  tmp_strip = strip + length * STRIP_LANES;
+
+  for (i = job->first_strip; i < job->last_strip; i++)
+    {
+      if (task->vertical)
+        blur_column_strip (task->buffer, strip, tmp_strip,
+                           task->width, task->height, i * STRIP_LANES, task->d);
+      else
+        blur_row_strip (task->buffer, strip, tmp_strip,
+                        task->width, task->height, i * STRIP_LANES, task->d);
+    }
+
+  g_free (strip);
+}
+
+static void
+blur_job_thread (gpointer data,
+                 gpointer user_data)
+{
+  BlurJob *job = data;
+  BlurTask *task = job->task;
+
+  blur_job_run (job);
+
+  g_mutex_lock (&task->lock);
+  task->n_pending--;
+  if (task->n_pending == 0)
+    g_cond_signal (&task->cond);
+  g_mutex_unlock (&task->lock);
+}
+
+static guint
+get_n_blur_threads (void)
+{
+  static gsize n_threads;
+
+  if (g_once_init_enter (&n_threads))
+    g_once_init_leave (&n_threads, CLAMP (g_get_num_processors (), 1, 8));
+
+  return n_threads;
+}
+
+static GThreadPool *
+get_blur_pool (void)
+{
+  static GThreadPool *blur_pool;
+
+  if (g_once_init_enter (&blur_pool))
+    {
+      GThreadPool *pool;
+
+      pool = g_thread_pool_new (blur_job_thread,
+                                NULL,
+                                get_n_blur_threads () - 1,
+                                FALSE,
+                                NULL);
+      g_once_init_leave (&blur_pool, pool);
+    }
+
+  return blur_pool;
+}
+
+/* Blurs all columns or all rows. Large buffers are split into runs
+ * of strips that are blurred in parallel, with the calling thread
+ * taking the first run.
+ */
+static void
+blur_strips (guchar   *buffer,
+             int       width,
+             int       height,
+             int       d,
+             gboolean  vertical)
+{
+  BlurTask task = { buffer, width, height, d, vertical, };
+  BlurJob jobs[8];
+  int n_strips, n_jobs, i;
+
+  n_strips = ((vertical ? width : height) + STRIP_LANES - 1) / STRIP_LANES;
+
+  if (width * height >= MIN_THREADED_PIXELS)
+    n_jobs = MIN (get_n_blur_threads (), n_strips);
+  else
+    n_jobs = 1;
+
+  for (i = 0; i < n_jobs; i++)
+    {
+      jobs[i].task = &task;
+      jobs[i].first_strip = n_strips * i / n_jobs;
+      jobs[i].last_strip = n_strips * (i + 1) / n_jobs;
+    }
+
+  if (n_jobs == 1)
+    {
+      blur_job_run (&jobs[0]);
+      return;
+    }
+
+  g_mutex_init (&task.lock);
+  g_cond_init (&task.cond);
+  task.n_pending = n_jobs - 1;
+
+  for (i = 1; i < n_jobs; i++)
+    g_thread_pool_push (get_blur_pool (), &jobs[i], NULL);
+
+  blur_job_run (&jobs[0]);
+
+  g_mutex_lock (&task.lock);
+  while (task.n_pending > 0)
+    g_cond_wait (&task.cond, &task.lock);
+  g_mutex_unlock (&task.lock);
+
+  g_mutex_clear (&task.lock);
+  g_cond_clear (&task.cond);
+}
+
+#endif /* HAVE_BLUR_SIMD */
+
 static void
 _boxblur (guchar      *buffer,
           int          width,
@@ -195,6 +720,22 @@ _boxblur (guchar      *buffer,
   guchar *flipped_buffer;
   int d = get_box_filter_size (radius);
 
+#ifdef HAVE_BLUR_SIMD
+  /* The vectorized path blurs the columns in place and does not
+   * need the flipped copy of the buffer.
+   */
+  if (d + 1 <= MAX_SIMD_FILTER_SIZE)
+    {
+      if (flags & GSK_BLUR_Y)
+        blur_strips (buffer, width, height, d, TRUE);
+
+      if (flags & GSK_BLUR_X)
+        blur_strips (buffer, width, height, d, FALSE);
+
+      return;
+    }
+#endif
+
   flipped_buffer = g_malloc (width * height);
 
   if (flags & GSK_BLUR_Y)
@@ -27,6 +27,11 @@
 #include "gskrendernodeprivate.h"
 #include "gdk/gdktextureprivate.h"
 
+/* The size of the tiles, in the target's user space, that
+ * the frame gets split into when drawing with threads
+ */
+#define TILE_SIZE 256
+
 #ifdef G_ENABLE_DEBUG
 typedef struct {
   GQuark cpu_time;
@@ -40,11 +45,26 @@ struct _GskCairoRenderer
 
   GdkCairoContext *cairo_context;
 
+  GMutex tile_lock;
+  GCond tile_cond;
+  guint n_pending_tiles;
+
 #ifdef G_ENABLE_DEBUG
   ProfileTimers profile_timers;
 #endif
 };
 
+typedef struct
+{
+  GskCairoRenderer *self;
+  GskRenderNode *root;
+  cairo_matrix_t ctm;
+  double scale_x;
+  double scale_y;
+  cairo_rectangle_int_t area;
+  cairo_surface_t *surface;
+} Tile;
+
 struct _GskCairoRendererClass
 {
   GskRendererClass parent_class;
@@ -73,13 +93,265 @@ gsk_cairo_renderer_unrealize (GskRenderer *renderer)
   g_clear_object (&self->cairo_context);
 }
 
+static guint
+gsk_cairo_renderer_get_n_threads (void)
+{
+  static gsize n_threads;
+
+  if (g_once_init_enter (&n_threads))
+    {
+      const char *env = g_getenv ("GSK_CAIRO_THREADS");
+      gsize value = 1;
+
+      if (env != NULL)
+        value = CLAMP (g_ascii_strtoull (env, NULL, 10), 1, 64);
+
+      g_once_init_leave (&n_threads, value);
+    }
+
+  return n_threads;
+}
+
+/* Checks that every node in the tree can be drawn by several
+ * threads at once. Everything that is drawn from lazily created
+ * state is created here, on the main thread.
+ */
+static gboolean
+gsk_cairo_renderer_can_draw_threaded (GskRenderNode *node)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_COLOR_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+    case GSK_GL_SHADER_NODE:
+      return TRUE;
+
+    case GSK_TEXTURE_NODE:
+      /* Other textures may have to be downloaded from a GL context */
+      return GDK_IS_MEMORY_TEXTURE (gsk_texture_node_get_texture (node));
+
+    case GSK_CAIRO_NODE:
+      {
+        cairo_surface_t *surface = gsk_cairo_node_get_surface (node);
+
+        /* Recording surfaces build their replay index lazily */
+        return surface == NULL ||
+               cairo_surface_get_type (surface) != CAIRO_SURFACE_TYPE_RECORDING;
+      }
+
+    case GSK_TEXT_NODE:
+      {
+        PangoFont *font = gsk_text_node_get_font (node);
+        const PangoGlyphInfo *glyphs;
+        guint i, n_glyphs;
+
+        if (!PANGO_IS_CAIRO_FONT (font))
+          return FALSE;
+
+        /* Unknown glyphs are drawn as hex boxes, from lazily created data */
+        glyphs = gsk_text_node_get_glyphs (node, &n_glyphs);
+        for (i = 0; i < n_glyphs; i++)
+          {
+            if (glyphs[i].glyph & PANGO_GLYPH_UNKNOWN_FLAG)
+              return FALSE;
+          }
+
+        return pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font)) != NULL;
+      }
+
+    case GSK_CONTAINER_NODE:
+      {
+        guint i;
+
+        for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+          {
+            if (!gsk_cairo_renderer_can_draw_threaded (gsk_container_node_get_child (node, i)))
+              return FALSE;
+          }
+        return TRUE;
+      }
+
+    case GSK_TRANSFORM_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_transform_node_get_child (node));
+    case GSK_OPACITY_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_opacity_node_get_child (node));
+    case GSK_COLOR_MATRIX_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_color_matrix_node_get_child (node));
+    case GSK_REPEAT_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_repeat_node_get_child (node));
+    case GSK_CLIP_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_clip_node_get_child (node));
+    case GSK_ROUNDED_CLIP_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_rounded_clip_node_get_child (node));
+    case GSK_SHADOW_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_shadow_node_get_child (node));
+    case GSK_BLUR_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_blur_node_get_child (node));
+    case GSK_DEBUG_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_debug_node_get_child (node));
+
+    case GSK_BLEND_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_blend_node_get_bottom_child (node)) &&
+             gsk_cairo_renderer_can_draw_threaded (gsk_blend_node_get_top_child (node));
+    case GSK_CROSS_FADE_NODE:
+      return gsk_cairo_renderer_can_draw_threaded (gsk_cross_fade_node_get_start_child (node)) &&
+             gsk_cairo_renderer_can_draw_threaded (gsk_cross_fade_node_get_end_child (node));
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      return FALSE;
+    }
+}
+
 static void
-gsk_cairo_renderer_do_render (GskRenderer   *renderer,
-                              cairo_t       *cr,
-                              GskRenderNode *root)
+gsk_cairo_renderer_draw_tile (gpointer data,
+                              gpointer user_data)
+{
+  Tile *tile = data;
+  GskCairoRenderer *self = tile->self;
+  cairo_t *cr;
+
+  tile->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                              ceil (tile->area.width * tile->scale_x),
+                                              ceil (tile->area.height * tile->scale_y));
+  cairo_surface_set_device_scale (tile->surface, tile->scale_x, tile->scale_y);
+  cairo_surface_set_device_offset (tile->surface,
+                                   - tile->area.x * tile->scale_x,
+                                   - tile->area.y * tile->scale_y);
+
+  cr = cairo_create (tile->surface);
+  cairo_rectangle (cr, tile->area.x, tile->area.y, tile->area.width, tile->area.height);
+  cairo_clip (cr);
+  cairo_set_matrix (cr, &tile->ctm);
+
+  gsk_render_node_draw (tile->root, cr);
+
+  cairo_destroy (cr);
+
+  g_mutex_lock (&self->tile_lock);
+  self->n_pending_tiles--;
+  if (self->n_pending_tiles == 0)
+    g_cond_signal (&self->tile_cond);
+  g_mutex_unlock (&self->tile_lock);
+}
+
+static GThreadPool *
+get_tile_pool (void)
+{
+  static GThreadPool *tile_pool;
+
+  if (g_once_init_enter (&tile_pool))
+    {
+      GThreadPool *pool;
+
+      pool = g_thread_pool_new (gsk_cairo_renderer_draw_tile,
+                                NULL,
+                                gsk_cairo_renderer_get_n_threads (),
+                                FALSE,
+                                NULL);
+      g_once_init_leave (&tile_pool, pool);
+    }
+
+  return tile_pool;
+}
+
+/* Splits @region into tiles, draws them on the worker threads and
+ * paints the results into @cr. The tiles start out transparent, and
+ * as every node draws with OVER, painting them with OVER gives the
+ * same result as drawing into @cr directly.
+ */
+static gboolean
+gsk_cairo_renderer_draw_tiled (GskCairoRenderer     *self,
+                               cairo_t              *cr,
+                               GskRenderNode        *root,
+                               const cairo_region_t *region)
+{
+  GArray *tiles;
+  cairo_matrix_t ctm;
+  double scale_x, scale_y;
+  int i, n_rects;
+  guint j;
+
+  if (gsk_cairo_renderer_get_n_threads () < 2 ||
+      !gsk_cairo_renderer_can_draw_threaded (root))
+    return FALSE;
+
+  cairo_get_matrix (cr, &ctm);
+  cairo_surface_get_device_scale (cairo_get_target (cr), &scale_x, &scale_y);
+
+  tiles = g_array_new (FALSE, FALSE, sizeof (Tile));
+
+  n_rects = cairo_region_num_rectangles (region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+      int x, y;
+
+      cairo_region_get_rectangle (region, i, &rect);
+
+      for (y = rect.y; y < rect.y + rect.height; y += TILE_SIZE)
+        for (x = rect.x; x < rect.x + rect.width; x += TILE_SIZE)
+          {
+            Tile tile = { self, root, ctm, scale_x, scale_y, };
+
+            tile.area.x = x;
+            tile.area.y = y;
+            tile.area.width = MIN (TILE_SIZE, rect.x + rect.width - x);
+            tile.area.height = MIN (TILE_SIZE, rect.y + rect.height - y);
+            g_array_append_val (tiles, tile);
+          }
+    }
+
+  if (tiles->len < 2)
+    {
+      g_array_free (tiles, TRUE);
+      return FALSE;
+    }
+
+  self->n_pending_tiles = tiles->len;
+  for (j = 0; j < tiles->len; j++)
+    g_thread_pool_push (get_tile_pool (), &g_array_index (tiles, Tile, j), NULL);
+
+  g_mutex_lock (&self->tile_lock);
+  while (self->n_pending_tiles > 0)
+    g_cond_wait (&self->tile_cond, &self->tile_lock);
+  g_mutex_unlock (&self->tile_lock);
+
+  cairo_save (cr);
+  cairo_identity_matrix (cr);
+
+  for (j = 0; j < tiles->len; j++)
+    {
+      Tile *tile = &g_array_index (tiles, Tile, j);
+
+      cairo_set_source_surface (cr, tile->surface, 0, 0);
+      cairo_rectangle (cr, tile->area.x, tile->area.y, tile->area.width, tile->area.height);
+      cairo_fill (cr);
+      cairo_surface_destroy (tile->surface);
+    }
+
+  cairo_restore (cr);
+
+  g_array_free (tiles, TRUE);
+
+  return TRUE;
+}
+
+static void
+gsk_cairo_renderer_do_render (GskRenderer          *renderer,
+                              cairo_t              *cr,
+                              GskRenderNode        *root,
+                              const cairo_region_t *region)
 {
-#ifdef G_ENABLE_DEBUG
   GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
+#ifdef G_ENABLE_DEBUG
   GskProfiler *profiler;
   gint64 cpu_time;
 #endif
@@ -89,7 +361,8 @@ gsk_cairo_renderer_do_render (GskRenderer   *renderer,
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
-  gsk_render_node_draw (root, cr);
+  if (!gsk_cairo_renderer_draw_tiled (self, cr, root, region))
+    gsk_render_node_draw (root, cr);
 
 #ifdef G_ENABLE_DEBUG
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
@@ -106,14 +379,20 @@ gsk_cairo_renderer_render_texture (GskRenderer           *renderer,
 {
   GdkTexture *texture;
   cairo_surface_t *surface;
+  cairo_region_t *region;
   cairo_t *cr;
+  int width, height;
 
-  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, ceil (viewport->size.width), ceil (viewport->size.height));
+  width = ceil (viewport->size.width);
+  height = ceil (viewport->size.height);
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
   cr = cairo_create (surface);
 
   cairo_translate (cr, - viewport->origin.x, - viewport->origin.y);
 
-  gsk_cairo_renderer_do_render (renderer, cr, root);
+  region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { 0, 0, width, height });
+  gsk_cairo_renderer_do_render (renderer, cr, root, region);
+  cairo_region_destroy (region);
 
   cairo_destroy (cr);
 
@@ -153,17 +432,32 @@ gsk_cairo_renderer_render (GskRenderer          *renderer,
     }
 #endif
 
-  gsk_cairo_renderer_do_render (renderer, cr, root);
+  gsk_cairo_renderer_do_render (renderer, cr, root,
+                                gdk_draw_context_get_frame_region (GDK_DRAW_CONTEXT (self->cairo_context)));
 
   cairo_destroy (cr);
 
   gdk_draw_context_end_frame (GDK_DRAW_CONTEXT (self->cairo_context));
 }
 
+static void
+gsk_cairo_renderer_finalize (GObject *object)
+{
+  GskCairoRenderer *self = GSK_CAIRO_RENDERER (object);
+
+  g_mutex_clear (&self->tile_lock);
+  g_cond_clear (&self->tile_cond);
+
+  G_OBJECT_CLASS (gsk_cairo_renderer_parent_class)->finalize (object);
+}
+
 static void
 gsk_cairo_renderer_class_init (GskCairoRendererClass *klass)
 {
   GskRendererClass *renderer_class = GSK_RENDERER_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gsk_cairo_renderer_finalize;
 
   renderer_class->realize = gsk_cairo_renderer_realize;
   renderer_class->unrealize = gsk_cairo_renderer_unrealize;
@@ -174,6 +468,9 @@ gsk_cairo_renderer_class_init (GskCairoRendererClass *klass)
 static void
 gsk_cairo_renderer_init (GskCairoRenderer *self)
 {
+  g_mutex_init (&self->tile_lock);
+  g_cond_init (&self->tile_cond);
+
 #ifdef G_ENABLE_DEBUG
   GskProfiler *profiler = gsk_renderer_get_profiler (GSK_RENDERER (self));
 
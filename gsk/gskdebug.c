@@ -14,7 +14,10 @@ static const GdkDebugKey gsk_debug_keys[] = {
   { "full-redraw", GSK_DEBUG_FULL_REDRAW, "Force full redraws" },
   { "sync", GSK_DEBUG_SYNC, "Sync after each frame" },
   { "vulkan-staging-image", GSK_DEBUG_VULKAN_STAGING_IMAGE, "Use a staging image for Vulkan texture upload" },
-  { "vulkan-staging-buffer", GSK_DEBUG_VULKAN_STAGING_BUFFER, "Use a staging buffer for Vulkan texture upload" }
+  { "vulkan-staging-buffer", GSK_DEBUG_VULKAN_STAGING_BUFFER, "Use a staging buffer for Vulkan texture upload" },
+  { "sdf-glyphs", GSK_DEBUG_SDF_GLYPHS, "Render scalable text from glyph distance fields (GL)", TRUE },
+  { "no-culling", GSK_DEBUG_NO_CULLING, "Draw nodes that are hidden behind opaque content" },
+  { "no-optimize", GSK_DEBUG_NO_OPTIMIZE, "Render node trees without simplifying them" }
 };
 
 static guint gsk_debug_flags;
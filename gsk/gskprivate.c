@@ -1,6 +1,9 @@
 #include "gskresources.h"
 #include "gskprivate.h"
 
+/* Glyph atlases are 1 MiB each, so this is room for 32 of them */
+#define DEFAULT_GLYPH_CACHE_BUDGET (32 * 1024 * 1024)
+
 static gpointer
 register_resources (gpointer data)
 {
@@ -35,3 +38,34 @@ pango_glyph_string_num_glyphs (PangoGlyphString *glyphs)
   return count;
 }
 
+
+/*
+ * gsk_get_glyph_cache_budget:
+ *
+ * Returns the number of bytes of atlas memory that the glyph caches
+ * of the renderers try to stay below. Glyphs that have not been used
+ * recently are evicted once the budget is exceeded.
+ *
+ * The budget can be changed with GSK_GLYPH_CACHE_BUDGET, in megabytes.
+ */
+gsize
+gsk_get_glyph_cache_budget (void)
+{
+  static gsize budget = 0;
+
+  if (g_once_init_enter (&budget))
+    {
+      gsize value = DEFAULT_GLYPH_CACHE_BUDGET;
+
+      if (g_getenv ("GSK_GLYPH_CACHE_BUDGET"))
+        {
+          guint64 mb = g_ascii_strtoull (g_getenv ("GSK_GLYPH_CACHE_BUDGET"), NULL, 10);
+
+          value = CLAMP (mb, 1, 4096) * 1024 * 1024;
+        }
+
+      g_once_init_leave (&budget, value);
+    }
+
+  return budget;
+}
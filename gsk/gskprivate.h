@@ -10,6 +10,8 @@ void gsk_ensure_resources (void);
 
 int pango_glyph_string_num_glyphs (PangoGlyphString *glyphs) G_GNUC_PURE;
 
+gsize gsk_get_glyph_cache_budget (void);
+
 typedef struct _GskVulkanRender GskVulkanRender;
 typedef struct _GskVulkanRenderPass GskVulkanRenderPass;
 
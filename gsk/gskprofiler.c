@@ -378,6 +378,15 @@ gsk_profiler_timer_get_start (GskProfiler *profiler,
   return timer->start_time;
 }
 
+gboolean
+gsk_profiler_has_timer (GskProfiler *profiler,
+                        GQuark       timer_id)
+{
+  g_return_val_if_fail (GSK_IS_PROFILER (profiler), FALSE);
+
+  return gsk_profiler_get_timer (profiler, timer_id) != NULL;
+}
+
 void
 gsk_profiler_reset (GskProfiler *profiler)
 {
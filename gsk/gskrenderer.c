@@ -47,6 +47,7 @@
 #include <graphene-gobject.h>
 #include <cairo-gobject.h>
 #include <gdk/gdk.h>
+#include <gdk/gdkframeclockprivate.h>
 
 #ifdef GDK_WINDOWING_X11
 #include <gdk/x11/gdkx.h>
@@ -125,6 +126,19 @@ gsk_renderer_real_render_texture (GskRenderer           *self,
   return NULL;
 }
 
+static void
+gsk_renderer_real_render_textures (GskRenderer           *self,
+                                   GskRenderNode         *root,
+                                   const graphene_rect_t *viewports,
+                                   guint                  n_viewports,
+                                   GdkTexture           **textures)
+{
+  guint i;
+
+  for (i = 0; i < n_viewports; i++)
+    textures[i] = GSK_RENDERER_GET_CLASS (self)->render_texture (self, root, &viewports[i]);
+}
+
 static void
 gsk_renderer_real_render (GskRenderer          *self,
                           GskRenderNode        *root,
@@ -182,6 +196,7 @@ gsk_renderer_class_init (GskRendererClass *klass)
   klass->unrealize = gsk_renderer_real_unrealize;
   klass->render = gsk_renderer_real_render;
   klass->render_texture = gsk_renderer_real_render_texture;
+  klass->render_textures = gsk_renderer_real_render_textures;
 
   gobject_class->get_property = gsk_renderer_get_property;
   gobject_class->dispose = gsk_renderer_dispose;
@@ -343,6 +358,436 @@ gsk_renderer_unrealize (GskRenderer *renderer)
   priv->is_realized = FALSE;
 }
 
+typedef struct
+{
+  guint opacities;
+  guint clips;
+  guint transforms;
+  guint containers;
+  guint colors;
+} OptimizeStats;
+
+static GskRenderNode *  gsk_renderer_optimize_node      (GskRenderNode *node,
+                                                         OptimizeStats *stats);
+
+/* Two rectangles that share a full edge are the same as their union */
+static gboolean
+rects_merge (const graphene_rect_t *a,
+             const graphene_rect_t *b,
+             graphene_rect_t       *result)
+{
+  if ((a->origin.y == b->origin.y && a->size.height == b->size.height &&
+       (a->origin.x + a->size.width == b->origin.x || b->origin.x + b->size.width == a->origin.x)) ||
+      (a->origin.x == b->origin.x && a->size.width == b->size.width &&
+       (a->origin.y + a->size.height == b->origin.y || b->origin.y + b->size.height == a->origin.y)))
+    {
+      graphene_rect_union (a, b, result);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Adds an optimized child to @children, taking ownership of it.
+ * Nested containers are flattened and runs of color nodes that
+ * form a rectangle are merged into one.
+ */
+static void
+optimize_append_child (GPtrArray     *children,
+                       GskRenderNode *child,
+                       OptimizeStats *stats)
+{
+  if (gsk_render_node_get_node_type (child) == GSK_CONTAINER_NODE)
+    {
+      GskRenderNode **grandchildren;
+      guint n_grandchildren, i;
+
+      grandchildren = gsk_container_node_get_children (child, &n_grandchildren);
+      for (i = 0; i < n_grandchildren; i++)
+        optimize_append_child (children, gsk_render_node_ref (grandchildren[i]), stats);
+
+      gsk_render_node_unref (child);
+      stats->containers++;
+      return;
+    }
+
+  if (children->len > 0 &&
+      gsk_render_node_get_node_type (child) == GSK_COLOR_NODE)
+    {
+      GskRenderNode *last = g_ptr_array_index (children, children->len - 1);
+      graphene_rect_t merged;
+
+      if (gsk_render_node_get_node_type (last) == GSK_COLOR_NODE &&
+          gdk_rgba_equal (gsk_color_node_get_color (last), gsk_color_node_get_color (child)) &&
+          rects_merge (&last->bounds, &child->bounds, &merged))
+        {
+          g_ptr_array_index (children, children->len - 1) =
+              gsk_color_node_new (gsk_color_node_get_color (child), &merged);
+          gsk_render_node_unref (last);
+          gsk_render_node_unref (child);
+          stats->colors++;
+          return;
+        }
+    }
+
+  g_ptr_array_add (children, child);
+}
+
+static GskRenderNode *
+optimize_container_node (GskRenderNode *node,
+                         OptimizeStats *stats)
+{
+  GskRenderNode **children;
+  GskRenderNode *child, *result;
+  GPtrArray *optimized;
+  guint n_children, removed, i;
+  gboolean changed = FALSE;
+
+  children = gsk_container_node_get_children (node, &n_children);
+  optimized = g_ptr_array_new_full (n_children, (GDestroyNotify) gsk_render_node_unref);
+  removed = stats->containers + stats->colors;
+
+  for (i = 0; i < n_children; i++)
+    {
+      child = gsk_renderer_optimize_node (children[i], stats);
+      if (child != children[i])
+        changed = TRUE;
+
+      optimize_append_child (optimized, child, stats);
+    }
+
+  if (removed != stats->containers + stats->colors)
+    changed = TRUE;
+
+  if (optimized->len == 1)
+    {
+      result = gsk_render_node_ref (g_ptr_array_index (optimized, 0));
+      stats->containers++;
+    }
+  else if (changed && optimized->len > 0)
+    result = gsk_container_node_new ((GskRenderNode **) optimized->pdata, optimized->len);
+  else
+    result = gsk_render_node_ref (node);
+
+  g_ptr_array_unref (optimized);
+
+  return result;
+}
+
+/* Rewrites @node into a tree that renders the same, with the
+ * trivially redundant nodes removed. Only the node types that are
+ * common in widget snapshots are looked into; the subtrees of all
+ * other nodes are left alone.
+ *
+ * Returns: (transfer full): the optimized node, which may be @node
+ */
+static GskRenderNode *
+gsk_renderer_optimize_node (GskRenderNode *node,
+                            OptimizeStats *stats)
+{
+  GskRenderNode *child, *result;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      return optimize_container_node (node, stats);
+
+    case GSK_OPACITY_NODE:
+      child = gsk_renderer_optimize_node (gsk_opacity_node_get_child (node), stats);
+      if (gsk_opacity_node_get_opacity (node) >= 1.0)
+        {
+          stats->opacities++;
+          return child;
+        }
+      if (child == gsk_opacity_node_get_child (node))
+        result = gsk_render_node_ref (node);
+      else
+        result = gsk_opacity_node_new (child, gsk_opacity_node_get_opacity (node));
+      gsk_render_node_unref (child);
+      return result;
+
+    case GSK_CLIP_NODE:
+      {
+        graphene_rect_t clip = *gsk_clip_node_get_clip (node);
+
+        child = gsk_renderer_optimize_node (gsk_clip_node_get_child (node), stats);
+        if (graphene_rect_contains_rect (&clip, &child->bounds))
+          {
+            stats->clips++;
+            return child;
+          }
+        if (gsk_render_node_get_node_type (child) == GSK_CLIP_NODE)
+          {
+            /* Nested clips clip to their intersection */
+            GskRenderNode *grandchild = gsk_clip_node_get_child (child);
+
+            graphene_rect_intersection (&clip, gsk_clip_node_get_clip (child), &clip);
+            result = gsk_clip_node_new (grandchild, &clip);
+            stats->clips++;
+          }
+        else if (child == gsk_clip_node_get_child (node))
+          result = gsk_render_node_ref (node);
+        else
+          result = gsk_clip_node_new (child, &clip);
+        gsk_render_node_unref (child);
+        return result;
+      }
+
+    case GSK_ROUNDED_CLIP_NODE:
+      child = gsk_renderer_optimize_node (gsk_rounded_clip_node_get_child (node), stats);
+      if (gsk_rounded_rect_contains_rect (gsk_rounded_clip_node_get_clip (node), &child->bounds))
+        {
+          stats->clips++;
+          return child;
+        }
+      if (child == gsk_rounded_clip_node_get_child (node))
+        result = gsk_render_node_ref (node);
+      else
+        result = gsk_rounded_clip_node_new (child, gsk_rounded_clip_node_get_clip (node));
+      gsk_render_node_unref (child);
+      return result;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskTransform *transform = gsk_transform_node_get_transform (node);
+
+        child = gsk_renderer_optimize_node (gsk_transform_node_get_child (node), stats);
+        if (gsk_transform_get_category (transform) == GSK_TRANSFORM_CATEGORY_IDENTITY)
+          {
+            stats->transforms++;
+            return child;
+          }
+        if (gsk_render_node_get_node_type (child) == GSK_TRANSFORM_NODE)
+          {
+            GskTransform *combined;
+
+            combined = gsk_transform_transform (gsk_transform_ref (transform),
+                                                gsk_transform_node_get_transform (child));
+            if (gsk_transform_get_category (combined) == GSK_TRANSFORM_CATEGORY_IDENTITY)
+              result = gsk_render_node_ref (gsk_transform_node_get_child (child));
+            else
+              result = gsk_transform_node_new (gsk_transform_node_get_child (child), combined);
+            gsk_transform_unref (combined);
+            stats->transforms++;
+          }
+        else if (child == gsk_transform_node_get_child (node))
+          result = gsk_render_node_ref (node);
+        else
+          result = gsk_transform_node_new (child, transform);
+        gsk_render_node_unref (child);
+        return result;
+      }
+
+    case GSK_DEBUG_NODE:
+      child = gsk_renderer_optimize_node (gsk_debug_node_get_child (node), stats);
+      if (child == gsk_debug_node_get_child (node))
+        result = gsk_render_node_ref (node);
+      else
+        result = gsk_debug_node_new (child, g_strdup (gsk_debug_node_get_message (node)));
+      gsk_render_node_unref (child);
+      return result;
+
+    default:
+      return gsk_render_node_ref (node);
+    }
+}
+
+/* Drops the parts of @node that are hidden behind opaque content.
+ *
+ * @occluder is an opaque area that is drawn on top of @node, in the
+ * same coordinate system. Containers are walked front to back and
+ * their opaque children are added to it. Clips and debug nodes are
+ * walked through, as they draw their child in place; everything else
+ * may spread or mix its child's pixels and is kept as a whole.
+ *
+ * Returns: (transfer full) (nullable): the node to draw instead of
+ *   @node, or %NULL if nothing of it is visible
+ */
+static GskRenderNode *
+gsk_renderer_cull_node (GskRenderNode         *node,
+                        const graphene_rect_t *occluder,
+                        graphene_rect_t       *opaque,
+                        gboolean              *is_opaque)
+{
+  GskRenderNode *child, *culled;
+  graphene_rect_t child_opaque;
+  gboolean child_is_opaque;
+
+  if (graphene_rect_contains_rect (occluder, &node->bounds))
+    {
+      *is_opaque = FALSE;
+      return NULL;
+    }
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        GskRenderNode **children, **kept;
+        graphene_rect_t covered = *occluder;
+        float opaque_area = 0;
+        guint n_children, n_kept, i;
+        gboolean changed = FALSE;
+
+        *is_opaque = FALSE;
+        children = gsk_container_node_get_children (node, &n_children);
+        kept = g_new (GskRenderNode *, n_children);
+        n_kept = 0;
+
+        for (i = n_children; i-- > 0; )
+          {
+            culled = gsk_renderer_cull_node (children[i], &covered, &child_opaque, &child_is_opaque);
+            if (culled != children[i])
+              changed = TRUE;
+            if (culled == NULL)
+              continue;
+
+            /* Children are collected back to front */
+            kept[n_kept++] = culled;
+
+            if (!child_is_opaque)
+              continue;
+
+            if (child_opaque.size.width * child_opaque.size.height > opaque_area)
+              {
+                *opaque = child_opaque;
+                *is_opaque = TRUE;
+                opaque_area = child_opaque.size.width * child_opaque.size.height;
+              }
+
+            if (child_opaque.size.width * child_opaque.size.height >
+                covered.size.width * covered.size.height)
+              covered = child_opaque;
+          }
+
+        if (!changed)
+          culled = gsk_render_node_ref (node);
+        else if (n_kept == 0)
+          culled = NULL;
+        else
+          {
+            for (i = 0; i < n_kept / 2; i++)
+              {
+                child = kept[i];
+                kept[i] = kept[n_kept - 1 - i];
+                kept[n_kept - 1 - i] = child;
+              }
+            culled = gsk_container_node_new (kept, n_kept);
+          }
+
+        for (i = 0; i < n_kept; i++)
+          gsk_render_node_unref (kept[i]);
+        g_free (kept);
+
+        return culled;
+      }
+
+    case GSK_CLIP_NODE:
+      child = gsk_clip_node_get_child (node);
+      culled = gsk_renderer_cull_node (child, occluder, &child_opaque, &child_is_opaque);
+      *is_opaque = child_is_opaque &&
+                   graphene_rect_intersection (&child_opaque, gsk_clip_node_get_clip (node), opaque);
+
+      if (culled == child)
+        {
+          gsk_render_node_unref (culled);
+          return gsk_render_node_ref (node);
+        }
+      else if (culled == NULL)
+        return NULL;
+      else
+        {
+          GskRenderNode *result = gsk_clip_node_new (culled, gsk_clip_node_get_clip (node));
+          gsk_render_node_unref (culled);
+          return result;
+        }
+
+    case GSK_DEBUG_NODE:
+      child = gsk_debug_node_get_child (node);
+      culled = gsk_renderer_cull_node (child, occluder, opaque, is_opaque);
+
+      if (culled == child)
+        {
+          gsk_render_node_unref (culled);
+          return gsk_render_node_ref (node);
+        }
+      else if (culled == NULL)
+        return NULL;
+      else
+        {
+          GskRenderNode *result = gsk_debug_node_new (culled, g_strdup (gsk_debug_node_get_message (node)));
+          gsk_render_node_unref (culled);
+          return result;
+        }
+
+    default:
+      *is_opaque = gsk_render_node_get_opaque_rect (node, opaque);
+      return gsk_render_node_ref (node);
+    }
+}
+
+/* Runs gsk_renderer_optimize_node() and gsk_renderer_cull_node()
+ * on the whole tree, unless they are disabled for debugging.
+ */
+static GskRenderNode *
+gsk_renderer_prepare_node (GskRenderer   *renderer,
+                           GskRenderNode *root)
+{
+  GskRenderNode *node, *culled;
+  graphene_rect_t opaque;
+  gboolean is_opaque;
+
+  if (GSK_RENDERER_DEBUG_CHECK (renderer, NO_OPTIMIZE))
+    node = gsk_render_node_ref (root);
+  else
+    {
+      OptimizeStats stats = { 0, };
+
+      node = gsk_renderer_optimize_node (root, &stats);
+
+      GSK_RENDERER_NOTE (renderer, RENDERER,
+          if (node != root)
+            g_message ("Optimized away %u opacity, %u clip, %u transform, %u container and %u color nodes",
+                       stats.opacities, stats.clips, stats.transforms, stats.containers, stats.colors));
+    }
+
+  if (GSK_RENDERER_DEBUG_CHECK (renderer, NO_CULLING))
+    return node;
+
+  culled = gsk_renderer_cull_node (node, graphene_rect_zero (), &opaque, &is_opaque);
+
+  /* Only possible for roots with empty bounds */
+  if (culled == NULL)
+    culled = gsk_render_node_ref (node);
+
+  gsk_render_node_unref (node);
+
+  return culled;
+}
+
+static void
+gsk_renderer_print_texture_stats (GskRenderer *renderer)
+{
+#ifdef G_ENABLE_DEBUG
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+
+  if (GSK_RENDERER_DEBUG_CHECK (renderer, RENDERER))
+    {
+      GString *buf = g_string_new ("*** Texture stats ***\n\n");
+
+      gsk_profiler_append_counters (priv->profiler, buf);
+      g_string_append_c (buf, '\n');
+
+      gsk_profiler_append_timers (priv->profiler, buf);
+      g_string_append_c (buf, '\n');
+
+      g_print ("%s\n***\n\n", buf->str);
+
+      g_string_free (buf, TRUE);
+    }
+#endif
+}
+
 /**
  * gsk_renderer_render_texture:
  * @renderer: a realized `GskRenderer`
@@ -367,6 +812,7 @@ gsk_renderer_render_texture (GskRenderer           *renderer,
 {
   GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
   graphene_rect_t real_viewport;
+  GskRenderNode *culled;
   GdkTexture *texture;
 
   g_return_val_if_fail (GSK_IS_RENDERER (renderer), NULL);
@@ -382,28 +828,71 @@ gsk_renderer_render_texture (GskRenderer           *renderer,
       viewport = &real_viewport;
     }
 
-  texture = GSK_RENDERER_GET_CLASS (renderer)->render_texture (renderer, root, viewport);
+  culled = gsk_renderer_prepare_node (renderer, root);
+  texture = GSK_RENDERER_GET_CLASS (renderer)->render_texture (renderer, culled, viewport);
+  gsk_render_node_unref (culled);
 
-#ifdef G_ENABLE_DEBUG
-  if (GSK_RENDERER_DEBUG_CHECK (renderer, RENDERER))
-    {
-      GString *buf = g_string_new ("*** Texture stats ***\n\n");
+  gsk_renderer_print_texture_stats (renderer);
 
-      gsk_profiler_append_counters (priv->profiler, buf);
-      g_string_append_c (buf, '\n');
+  g_clear_pointer (&priv->root_node, gsk_render_node_unref);
 
-      gsk_profiler_append_timers (priv->profiler, buf);
-      g_string_append_c (buf, '\n');
+  return texture;
+}
 
-      g_print ("%s\n***\n\n", buf->str);
+/**
+ * gsk_renderer_render_textures:
+ * @renderer: a realized `GskRenderer`
+ * @root: a `GskRenderNode`
+ * @viewports: (array length=n_viewports): the sections to draw
+ * @n_viewports: the number of elements in @viewports
+ *
+ * Renders several sections of the scene graph, each to its own
+ * `GdkTexture`.
+ *
+ * This gives the same results as calling
+ * [method@Gsk.Renderer.render_texture] once for every viewport,
+ * but the node tree is only prepared once, and renderers can share
+ * their setup and caches between the sections. It is meant for
+ * rendering many small regions of one large tree, such as the
+ * thumbnails of a document.
+ *
+ * Returns: (transfer full) (array length=n_viewports): the rendered
+ *   contents of each of the @viewports. Free the array with g_free()
+ *   after unreffing its elements.
+ *
+ * Since: 4.6
+ */
+GdkTexture **
+gsk_renderer_render_textures (GskRenderer           *renderer,
+                              GskRenderNode         *root,
+                              const graphene_rect_t *viewports,
+                              guint                  n_viewports)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+  GskRenderNode *culled;
+  GdkTexture **textures;
 
-      g_string_free (buf, TRUE);
-    }
-#endif
+  g_return_val_if_fail (GSK_IS_RENDERER (renderer), NULL);
+  g_return_val_if_fail (priv->is_realized, NULL);
+  g_return_val_if_fail (GSK_IS_RENDER_NODE (root), NULL);
+  g_return_val_if_fail (viewports != NULL || n_viewports == 0, NULL);
+  g_return_val_if_fail (priv->root_node == NULL, NULL);
+
+  textures = g_new0 (GdkTexture *, n_viewports);
+  if (n_viewports == 0)
+    return textures;
+
+  priv->root_node = gsk_render_node_ref (root);
+
+  culled = gsk_renderer_prepare_node (renderer, root);
+  GSK_RENDERER_GET_CLASS (renderer)->render_textures (renderer, culled, viewports, n_viewports, textures);
+  gsk_render_node_unref (culled);
+
+  gsk_renderer_print_texture_stats (renderer);
 
   g_clear_pointer (&priv->root_node, gsk_render_node_unref);
 
-  return texture;
+  return textures;
 }
 
 /**
@@ -432,6 +921,7 @@ gsk_renderer_render (GskRenderer          *renderer,
                      const cairo_region_t *region)
 {
   GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+  GskRenderNode *culled;
   cairo_region_t *clip;
 
   g_return_if_fail (GSK_IS_RENDERER (renderer));
@@ -452,9 +942,14 @@ gsk_renderer_render (GskRenderer          *renderer,
     }
   else
     {
+      GdkFrameClock *clock = gdk_surface_get_frame_clock (priv->surface);
+      gint64 before = _gdk_frame_clock_begin_span (clock);
+
       clip = cairo_region_copy (region);
       gsk_render_node_diff (priv->prev_node, root, clip);
 
+      _gdk_frame_clock_end_span (clock, GDK_FRAME_SPAN_DIFF, before);
+
       if (cairo_region_is_empty (clip))
         {
           cairo_region_destroy (clip);
@@ -464,7 +959,10 @@ gsk_renderer_render (GskRenderer          *renderer,
 
   priv->root_node = gsk_render_node_ref (root);
 
-  GSK_RENDERER_GET_CLASS (renderer)->render (renderer, root, clip);
+  /* The damage was computed from the unchanged tree above */
+  culled = gsk_renderer_prepare_node (renderer, root);
+  GSK_RENDERER_GET_CLASS (renderer)->render (renderer, culled, clip);
+  gsk_render_node_unref (culled);
 
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (renderer, RENDERER))
@@ -507,6 +1005,39 @@ gsk_renderer_get_profiler (GskRenderer *renderer)
   return priv->profiler;
 }
 
+/*< private >
+ * gsk_renderer_get_memory_usage:
+ * @renderer: a realized `GskRenderer`
+ *
+ * Retrieves how much memory the caches and other resources of
+ * @renderer use on the GPU, with one `GskRendererMemoryUsage` for
+ * each kind of resource.
+ *
+ * The numbers of evictions only ever grow, so the rate at which
+ * a cache drops items can be calculated from two calls.
+ *
+ * Renderers may share resources with other renderers for the same
+ * display, which are then included for all of them.
+ *
+ * Returns: (transfer full) (element-type GskRendererMemoryUsage): the
+ *   memory usage, which is empty if the renderer can't tell
+ */
+GArray *
+gsk_renderer_get_memory_usage (GskRenderer *renderer)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+  GArray *usage;
+
+  g_return_val_if_fail (GSK_IS_RENDERER (renderer), NULL);
+
+  usage = g_array_new (FALSE, TRUE, sizeof (GskRendererMemoryUsage));
+
+  if (priv->is_realized && GSK_RENDERER_GET_CLASS (renderer)->get_memory_usage)
+    GSK_RENDERER_GET_CLASS (renderer)->get_memory_usage (renderer, usage);
+
+  return usage;
+}
+
 static GType
 get_renderer_for_name (const char *renderer_name)
 {
@@ -57,6 +57,11 @@ GDK_AVAILABLE_IN_ALL
 GdkTexture *            gsk_renderer_render_texture             (GskRenderer             *renderer,
                                                                  GskRenderNode           *root,
                                                                  const graphene_rect_t   *viewport);
+GDK_AVAILABLE_IN_4_6
+GdkTexture **           gsk_renderer_render_textures            (GskRenderer             *renderer,
+                                                                 GskRenderNode           *root,
+                                                                 const graphene_rect_t   *viewports,
+                                                                 guint                    n_viewports);
 
 GDK_AVAILABLE_IN_ALL
 void                    gsk_renderer_render                     (GskRenderer             *renderer,
@@ -34,6 +34,15 @@ struct _GskRenderer
   GObject parent_instance;
 };
 
+/* What a renderer keeps in GPU memory, see gsk_renderer_get_memory_usage() */
+typedef struct
+{
+  const char *name;
+  gsize bytes;
+  guint n_items;
+  guint64 n_evictions;
+} GskRendererMemoryUsage;
+
 struct _GskRendererClass
 {
   GObjectClass parent_class;
@@ -46,14 +55,23 @@ struct _GskRendererClass
   GdkTexture *         (* render_texture)                       (GskRenderer            *renderer,
                                                                  GskRenderNode          *root,
                                                                  const graphene_rect_t  *viewport);
+  void                 (* render_textures)                      (GskRenderer            *renderer,
+                                                                 GskRenderNode          *root,
+                                                                 const graphene_rect_t  *viewports,
+                                                                 guint                   n_viewports,
+                                                                 GdkTexture            **textures);
   void                 (* render)                               (GskRenderer            *renderer,
                                                                  GskRenderNode          *root,
                                                                  const cairo_region_t   *invalid);
+
+  void                 (* get_memory_usage)                     (GskRenderer            *renderer,
+                                                                 GArray                 *usage);
 };
 
 GskRenderNode *         gsk_renderer_get_root_node              (GskRenderer    *renderer);
 
 GskProfiler *           gsk_renderer_get_profiler               (GskRenderer    *renderer);
+GArray *                gsk_renderer_get_memory_usage           (GskRenderer    *renderer);
 
 GskDebugFlags           gsk_renderer_get_debug_flags            (GskRenderer    *renderer);
 void                    gsk_renderer_set_debug_flags            (GskRenderer    *renderer,
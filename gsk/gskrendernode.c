@@ -42,9 +42,12 @@
 #include "gskrendererprivate.h"
 #include "gskrendernodeparserprivate.h"
 
+#include "gdk/gdkalloccountersprivate.h"
+
 #include <graphene-gobject.h>
 
 #include <math.h>
+#include <string.h>
 
 #include <gobject/gvaluecollector.h>
 
@@ -132,10 +135,174 @@ value_render_node_lcopy_value (const GValue *value,
   return NULL;
 }
 
+/* Arenas
+ *
+ * Snapshots create thousands of short-lived nodes per frame. While an
+ * arena is current, nodes are bump-allocated from its chunks instead of
+ * being allocated one by one.
+ *
+ * Every chunk counts the nodes that live in it and is freed when the
+ * last of them is finalized. Nodes are usually retained beyond their
+ * frame, in the render node cache of their widget, and then keep their
+ * chunk alive. So arenas are only made current for the nodes a snapshot
+ * creates itself, and the chunks of an arena start small and grow with
+ * its use. That way a snapshot's chunks hold little more than the nodes
+ * it created.
+ */
+#define ARENA_MIN_CHUNK_SIZE 1024
+#define ARENA_MAX_CHUNK_SIZE (16 * 1024)
+#define ARENA_ALIGNMENT 16
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~(gsize) (ARENA_ALIGNMENT - 1))
+
+struct _GskRenderNodeChunk
+{
+  int n_live; /* atomic, nodes plus one while the arena allocates from it */
+  gsize size;
+  gsize used;
+};
+
+struct _GskRenderNodeArena
+{
+  GskRenderNodeChunk *chunk;
+};
+
+#define CHUNK_HEADER_SIZE ARENA_ALIGN (sizeof (GskRenderNodeChunk))
+
+static GPrivate current_arena = G_PRIVATE_INIT (NULL);
+
+/* Instance sizes, for the types that can be allocated from arenas */
+static gsize gsk_render_node_sizes[GSK_RENDER_NODE_TYPE_N_TYPES];
+
+static void
+gsk_render_node_chunk_release (GskRenderNodeChunk *chunk)
+{
+  if (g_atomic_int_dec_and_test (&chunk->n_live))
+    g_free (chunk);
+}
+
+static GskRenderNode *
+gsk_render_node_arena_alloc (GskRenderNodeArena *arena,
+                             GskRenderNodeType   node_type)
+{
+  GskRenderNodeChunk *chunk;
+  GskRenderNode *node;
+  GTypeClass *klass;
+  gsize size;
+
+  size = ARENA_ALIGN (gsk_render_node_sizes[node_type]);
+  if (size == 0 || size > (ARENA_MAX_CHUNK_SIZE - CHUNK_HEADER_SIZE) / 4)
+    return NULL;
+
+  klass = g_type_class_peek (gsk_render_node_types[node_type]);
+  if (klass == NULL)
+    return NULL;
+
+  if (arena->chunk == NULL || arena->chunk->used + size > arena->chunk->size)
+    {
+      gsize chunk_size;
+
+      if (arena->chunk)
+        {
+          chunk_size = MIN (arena->chunk->size * 2, ARENA_MAX_CHUNK_SIZE);
+          gsk_render_node_chunk_release (arena->chunk);
+        }
+      else
+        chunk_size = ARENA_MIN_CHUNK_SIZE;
+
+      while (chunk_size < CHUNK_HEADER_SIZE + size)
+        chunk_size *= 2;
+
+      arena->chunk = g_malloc (chunk_size);
+      arena->chunk->n_live = 1;
+      arena->chunk->size = chunk_size;
+      arena->chunk->used = CHUNK_HEADER_SIZE;
+    }
+
+  chunk = arena->chunk;
+  node = (GskRenderNode *) ((guchar *) chunk + chunk->used);
+  chunk->used += size;
+  g_atomic_int_inc (&chunk->n_live);
+
+  memset (node, 0, size);
+  node->parent_instance.g_class = klass;
+  node->chunk = chunk;
+  g_atomic_ref_count_init (&node->ref_count);
+
+  return node;
+}
+
+/*< private >
+ * gsk_render_node_arena_new:
+ *
+ * Creates a new arena to allocate nodes from while it is current.
+ *
+ * Returns: (transfer full): a new `GskRenderNodeArena`
+ */
+GskRenderNodeArena *
+gsk_render_node_arena_new (void)
+{
+  return g_new0 (GskRenderNodeArena, 1);
+}
+
+/*< private >
+ * gsk_render_node_arena_free:
+ * @arena: a `GskRenderNodeArena`
+ *
+ * Frees @arena, which must not be current. Nodes allocated from it
+ * stay valid, their memory is released when the last of them goes away.
+ */
+void
+gsk_render_node_arena_free (GskRenderNodeArena *arena)
+{
+  g_assert (g_private_get (&current_arena) != arena);
+
+  if (arena->chunk)
+    gsk_render_node_chunk_release (arena->chunk);
+
+  g_free (arena);
+}
+
+/*< private >
+ * gsk_render_node_arena_push:
+ * @arena: a `GskRenderNodeArena`
+ *
+ * Makes nodes created in this thread get allocated from @arena,
+ * until gsk_render_node_arena_pop() is called with the returned value.
+ *
+ * Keep the section short and only create nodes in it that belong
+ * to the owner of @arena.
+ *
+ * Returns: (nullable): the arena that was current before
+ */
+GskRenderNodeArena *
+gsk_render_node_arena_push (GskRenderNodeArena *arena)
+{
+  GskRenderNodeArena *previous = g_private_get (&current_arena);
+
+  g_private_set (&current_arena, arena);
+
+  return previous;
+}
+
+/*< private >
+ * gsk_render_node_arena_pop:
+ * @previous: (nullable): the value returned by gsk_render_node_arena_push()
+ *
+ * Makes @previous the current arena again.
+ */
+void
+gsk_render_node_arena_pop (GskRenderNodeArena *previous)
+{
+  g_private_set (&current_arena, previous);
+}
+
 static void
 gsk_render_node_finalize (GskRenderNode *self)
 {
-  g_type_free_instance ((GTypeInstance *) self);
+  if (self->chunk)
+    gsk_render_node_chunk_release (self->chunk);
+  else
+    g_type_free_instance ((GTypeInstance *) self);
 }
 
 static void
@@ -241,6 +408,12 @@ typedef struct
   void     (* diff)     (GskRenderNode        *node1,
                          GskRenderNode        *node2,
                          cairo_region_t       *region);
+  guint64  (* hash)     (GskRenderNode        *node,
+                         guint64               seed);
+  gboolean (* equal)    (GskRenderNode        *node1,
+                         GskRenderNode        *node2);
+  gboolean (* get_opaque_rect) (GskRenderNode   *node,
+                                graphene_rect_t *opaque);
 } RenderNodeClassData;
 
 static void
@@ -262,6 +435,9 @@ gsk_render_node_generic_class_init (gpointer g_class,
   /* Mandatory */
   node_class->draw = node_data->draw;
   node_class->diff = node_data->diff;
+  node_class->hash = node_data->hash;
+  node_class->equal = node_data->equal;
+  node_class->get_opaque_rect = node_data->get_opaque_rect;
 
   g_free (node_data);
 }
@@ -309,12 +485,19 @@ gsk_render_node_type_register_static (const char                  *node_name,
   ((RenderNodeClassData *) info.class_data)->diff = node_info->diff != NULL
                                                   ? node_info->diff
                                                   : gsk_render_node_diff_impossible;
+  ((RenderNodeClassData *) info.class_data)->hash = node_info->hash;
+  ((RenderNodeClassData *) info.class_data)->equal = node_info->equal;
+  ((RenderNodeClassData *) info.class_data)->get_opaque_rect = node_info->get_opaque_rect;
 
   info.instance_size = node_info->instance_size;
   info.n_preallocs = 0;
   info.instance_init = (GInstanceInitFunc) node_info->instance_init;
   info.value_table = NULL;
 
+  /* Arenas only do what gsk_render_node_init() does */
+  if (node_info->instance_init == NULL)
+    gsk_render_node_sizes[node_info->node_type] = node_info->instance_size;
+
   return g_type_register_static (GSK_TYPE_RENDER_NODE, node_name, &info, 0);
 }
 
@@ -329,10 +512,25 @@ gsk_render_node_type_register_static (const char                  *node_name,
 gpointer
 gsk_render_node_alloc (GskRenderNodeType node_type)
 {
+  GskRenderNodeArena *arena;
+
   g_return_val_if_fail (node_type > GSK_NOT_A_RENDER_NODE, NULL);
   g_return_val_if_fail (node_type < GSK_RENDER_NODE_TYPE_N_TYPES, NULL);
 
   g_assert (gsk_render_node_types[node_type] != G_TYPE_INVALID);
+
+  /* Counts nodes from arenas and from the heap alike */
+  gdk_alloc_counters_add (GDK_ALLOC_RENDER_NODES, gsk_render_node_sizes[node_type]);
+
+  arena = g_private_get (&current_arena);
+  if (arena != NULL)
+    {
+      GskRenderNode *node = gsk_render_node_arena_alloc (arena, node_type);
+
+      if (node != NULL)
+        return node;
+    }
+
   return g_type_create_instance (gsk_render_node_types[node_type]);
 }
 
@@ -545,9 +743,19 @@ gsk_render_node_diff (GskRenderNode  *node1,
                       GskRenderNode  *node2,
                       cairo_region_t *region)
 {
+  guint64 hash1;
+
   if (node1 == node2)
     return;
 
+  /* Identical subtrees that were created separately. The fingerprints
+   * can collide, so confirm the match before skipping the subtree.
+   */
+  hash1 = gsk_render_node_get_hash (node1);
+  if (hash1 != 0 && hash1 == gsk_render_node_get_hash (node2) &&
+      gsk_render_node_equal (node1, node2))
+    return;
+
   if (_gsk_render_node_get_node_type (node1) == _gsk_render_node_get_node_type (node2))
     GSK_RENDER_NODE_GET_CLASS (node1)->diff (node1, node2, region);
 
@@ -559,6 +767,110 @@ gsk_render_node_diff (GskRenderNode  *node1,
     gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+/*< private >
+ * gsk_render_node_get_hash:
+ * @node: a `GskRenderNode`
+ *
+ * Returns a fingerprint of the node's type, bounds and contents,
+ * including its children.
+ *
+ * Nodes that render the same produce the same fingerprint, so
+ * gsk_render_node_diff() can skip equal subtrees without walking
+ * them. Textures, surfaces, fonts and shaders are hashed by identity.
+ * The value is computed on first use and cached, as nodes are
+ * immutable.
+ *
+ * Returns: the fingerprint, or 0 if @node or one of its children
+ *   cannot be fingerprinted
+ */
+guint64
+gsk_render_node_get_hash (GskRenderNode *node)
+{
+  if (!node->hash_valid)
+    {
+      GskRenderNodeClass *node_class = GSK_RENDER_NODE_GET_CLASS (node);
+      guint64 hash = 0;
+
+      if (node_class->hash)
+        {
+          hash = gsk_hash_combine (G_GUINT64_CONSTANT (0xcbf29ce484222325), node_class->node_type);
+          hash = gsk_hash_data (hash, &node->bounds, sizeof (graphene_rect_t));
+          hash = node_class->hash (node, hash);
+        }
+
+      node->hash = hash;
+      node->hash_valid = TRUE;
+    }
+
+  return node->hash;
+}
+
+/*< private >
+ * gsk_render_node_equal:
+ * @node1: a `GskRenderNode`
+ * @node2: the `GskRenderNode` to compare with
+ *
+ * Checks whether the two nodes and their children have the same
+ * type, bounds and contents, in the same way as
+ * gsk_render_node_get_hash() fingerprints them.
+ *
+ * This is cheaper than gsk_render_node_diff(), as it only compares
+ * fields and stops at the first difference.
+ *
+ * Returns: %TRUE if the nodes are known to render the same
+ */
+gboolean
+gsk_render_node_equal (GskRenderNode *node1,
+                       GskRenderNode *node2)
+{
+  GskRenderNodeClass *node_class;
+
+  if (node1 == node2)
+    return TRUE;
+
+  if (_gsk_render_node_get_node_type (node1) != _gsk_render_node_get_node_type (node2))
+    return FALSE;
+
+  /* Only compare fingerprints that are already known */
+  if (node1->hash_valid && node2->hash_valid && node1->hash != node2->hash)
+    return FALSE;
+
+  if (memcmp (&node1->bounds, &node2->bounds, sizeof (graphene_rect_t)) != 0)
+    return FALSE;
+
+  node_class = GSK_RENDER_NODE_GET_CLASS (node1);
+  if (node_class->equal == NULL)
+    return FALSE;
+
+  return node_class->equal (node1, node2);
+}
+
+/*< private >
+ * gsk_render_node_get_opaque_rect:
+ * @node: a `GskRenderNode`
+ * @opaque: (out caller-allocates): return location for the opaque area
+ *
+ * Finds a rectangle inside @node's bounds that the node is known to
+ * cover with fully opaque pixels. Anything drawn below that area is
+ * hidden by @node.
+ *
+ * The rectangle is not necessarily the largest one; nodes only report
+ * what is cheap to find out.
+ *
+ * Returns: %TRUE if @opaque was set, %FALSE if no opaque area is known
+ */
+gboolean
+gsk_render_node_get_opaque_rect (GskRenderNode   *node,
+                                 graphene_rect_t *opaque)
+{
+  GskRenderNodeClass *node_class = GSK_RENDER_NODE_GET_CLASS (node);
+
+  if (node_class->get_opaque_rect == NULL)
+    return FALSE;
+
+  return node_class->get_opaque_rect (node, opaque);
+}
+
 /**
  * gsk_render_node_write_to_file:
  * @node: a `GskRenderNode`
@@ -607,6 +919,9 @@ gsk_render_node_write_to_file (GskRenderNode *node,
  *
  * For a discussion of the supported format, see that function.
  *
+ * This function also loads the more compact binary format that the
+ * GTK inspector can save recordings in.
+ *
  * Returns: (nullable) (transfer full): a new `GskRenderNode`
  */
 GskRenderNode *
@@ -616,7 +931,10 @@ gsk_render_node_deserialize (GBytes            *bytes,
 {
   GskRenderNode *node = NULL;
 
-  node = gsk_render_node_deserialize_from_bytes (bytes, error_func, user_data);
+  if (gsk_render_node_is_binary (bytes))
+    node = gsk_render_node_deserialize_binary (bytes, error_func, user_data);
+  else
+    node = gsk_render_node_deserialize_from_bytes (bytes, error_func, user_data);
 
   return node;
 }
@@ -0,0 +1,2024 @@
+/*
+ * Copyright © 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gskrendernodeparserprivate.h"
+
+#include "gskrendernodeprivate.h"
+#include "gsktransformprivate.h"
+
+#include "gdk/gdktextureprivate.h"
+
+#include <string.h>
+
+/* The binary node format
+ *
+ * All values are little-endian 32-bit integers or IEEE floats, all
+ * offsets are counted from the start of the data and all records are
+ * 4-byte aligned, so the data can be mapped and walked in place.
+ *
+ * The file starts with a header:
+ *
+ *   guint32 magic           "GSKB"
+ *   guint32 version         BINARY_VERSION
+ *   guint32 root            offset of the root node record
+ *   guint32 n_blobs
+ *   guint32 blobs           offset of n_blobs × { guint32 offset, guint32 size }
+ *
+ * Blobs hold the deduplicated strings (NUL-terminated) and PNG images
+ * that nodes refer to by index.
+ *
+ * Every node record starts with
+ *
+ *   guint32 type            the GskRenderNodeType
+ *   guint32 size            the size of the record, including this header
+ *   float   bounds[4]
+ *
+ * followed by the node specific data. Children are referenced by the
+ * offset of their record, and are always written before their parents,
+ * so loading can never recurse into a cycle. Nodes that appear more than
+ * once in the tree are only written once.
+ *
+ * Streams of frames use the same node records, in a file that starts with
+ *
+ *   guint32 magic           "GSKS"
+ *   guint32 version         BINARY_VERSION
+ *
+ * followed by one chunk per frame:
+ *
+ *   guint32 magic           "FRAM"
+ *   guint32 size            the size of the chunk after this header
+ *   guint32 trailer         offset of the trailer of the chunk
+ *
+ * The chunk holds the node records and blobs that were new in the frame,
+ * and ends with the trailer
+ *
+ *   n_blobs × { guint32 offset, guint32 size }
+ *   guint32 root            offset of the root node record
+ *   guint32 n_blobs
+ *
+ * Blob indices count the blobs of all chunks so far. Node records may
+ * refer to records of earlier chunks, which is how subtrees that did not
+ * change between frames are stored only once. A truncated last chunk is
+ * ignored, so a stream that was not closed properly can still be read.
+ */
+
+#define BINARY_MAGIC "GSKB"
+#define BINARY_VERSION 1
+
+#define HEADER_SIZE (5 * sizeof (guint32))
+#define NODE_HEADER_SIZE (6 * sizeof (guint32))
+
+#define STREAM_MAGIC "GSKS"
+#define CHUNK_MAGIC "FRAM"
+#define STREAM_HEADER_SIZE (2 * sizeof (guint32))
+#define CHUNK_HEADER_SIZE (3 * sizeof (guint32))
+
+#define NO_BLOB G_MAXUINT32
+
+typedef struct
+{
+  GByteArray *data;
+  guint32 base;          /* offset of data in the output */
+  GHashTable *nodes;     /* GskRenderNode => record offset */
+  GHashTable *objects;   /* GdkTexture, GskGLShader, PangoFont => blob index */
+  GHashTable *contents;  /* checksum => blob index */
+  GPtrArray *blobs;
+  guint32 blob_base;     /* index of the first blob in blobs */
+
+  /* The nodes and objects of the previous frame of a stream. They are
+   * kept alive, so their addresses can't be reused by new ones.
+   */
+  GHashTable *prev_nodes;
+  GHashTable *prev_objects;
+} Writer;
+
+static void
+writer_init (Writer *self)
+{
+  self->data = g_byte_array_new ();
+  self->base = 0;
+  self->nodes = g_hash_table_new_full (NULL, NULL, (GDestroyNotify) gsk_render_node_unref, NULL);
+  self->objects = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+  self->contents = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->blobs = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+  self->blob_base = 0;
+  self->prev_nodes = NULL;
+  self->prev_objects = NULL;
+}
+
+static void
+writer_clear (Writer *self)
+{
+  g_byte_array_unref (self->data);
+  g_hash_table_unref (self->nodes);
+  g_hash_table_unref (self->objects);
+  g_hash_table_unref (self->contents);
+  g_ptr_array_unref (self->blobs);
+  g_clear_pointer (&self->prev_nodes, g_hash_table_unref);
+  g_clear_pointer (&self->prev_objects, g_hash_table_unref);
+}
+
+static gboolean
+writer_lookup (GHashTable *table,
+               GHashTable *prev_table,
+               gpointer    key,
+               GBoxedCopyFunc ref_func,
+               guint32    *value)
+{
+  gpointer result;
+
+  if (g_hash_table_lookup_extended (table, key, NULL, &result))
+    {
+      *value = GPOINTER_TO_UINT (result);
+      return TRUE;
+    }
+
+  if (prev_table && g_hash_table_lookup_extended (prev_table, key, NULL, &result))
+    {
+      g_hash_table_insert (table, ref_func (key), result);
+      *value = GPOINTER_TO_UINT (result);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+lookup_object (Writer   *self,
+               gpointer  object,
+               guint32  *index)
+{
+  return writer_lookup (self->objects, self->prev_objects, object, g_object_ref, index);
+}
+
+static void
+remember_object (Writer   *self,
+                 gpointer  object,
+                 guint32   index)
+{
+  g_hash_table_insert (self->objects, g_object_ref (object), GUINT_TO_POINTER (index));
+}
+
+static void
+write_uint (Writer  *self,
+            guint32  value)
+{
+  value = GUINT32_TO_LE (value);
+  g_byte_array_append (self->data, (guint8 *) &value, sizeof (guint32));
+}
+
+static void
+write_float (Writer *self,
+             float   value)
+{
+  guint32 bits;
+
+  memcpy (&bits, &value, sizeof (guint32));
+  write_uint (self, bits);
+}
+
+static void
+write_floats (Writer      *self,
+              const float *values,
+              gsize        n_values)
+{
+  gsize i;
+
+  for (i = 0; i < n_values; i++)
+    write_float (self, values[i]);
+}
+
+static void
+write_point (Writer                 *self,
+             const graphene_point_t *point)
+{
+  write_float (self, point->x);
+  write_float (self, point->y);
+}
+
+static void
+write_rect (Writer                *self,
+            const graphene_rect_t *rect)
+{
+  write_float (self, rect->origin.x);
+  write_float (self, rect->origin.y);
+  write_float (self, rect->size.width);
+  write_float (self, rect->size.height);
+}
+
+static void
+write_rounded_rect (Writer               *self,
+                    const GskRoundedRect *rect)
+{
+  guint i;
+
+  write_rect (self, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      write_float (self, rect->corner[i].width);
+      write_float (self, rect->corner[i].height);
+    }
+}
+
+static void
+write_rgba (Writer        *self,
+            const GdkRGBA *rgba)
+{
+  write_float (self, rgba->red);
+  write_float (self, rgba->green);
+  write_float (self, rgba->blue);
+  write_float (self, rgba->alpha);
+}
+
+static void
+write_matrix (Writer                  *self,
+              const graphene_matrix_t *matrix)
+{
+  float values[16];
+
+  graphene_matrix_to_float (matrix, values);
+  write_floats (self, values, 16);
+}
+
+static void
+write_stops (Writer             *self,
+             const GskColorStop *stops,
+             gsize               n_stops)
+{
+  gsize i;
+
+  write_uint (self, n_stops);
+  for (i = 0; i < n_stops; i++)
+    {
+      write_float (self, stops[i].offset);
+      write_rgba (self, &stops[i].color);
+    }
+}
+
+/* Takes ownership of @bytes */
+static guint32
+add_blob (Writer *self,
+          GBytes *bytes)
+{
+  gpointer index;
+  char *checksum;
+
+  /* Streams outlive the blobs, so they are found by checksum */
+  checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes);
+  if (g_hash_table_lookup_extended (self->contents, checksum, NULL, &index))
+    {
+      g_free (checksum);
+      g_bytes_unref (bytes);
+      return GPOINTER_TO_UINT (index);
+    }
+
+  g_ptr_array_add (self->blobs, bytes);
+  index = GUINT_TO_POINTER (self->blob_base + self->blobs->len - 1);
+  g_hash_table_insert (self->contents, checksum, index);
+
+  return GPOINTER_TO_UINT (index);
+}
+
+static guint32
+add_string (Writer     *self,
+            const char *string)
+{
+  return add_blob (self, g_bytes_new (string, strlen (string) + 1));
+}
+
+static guint32
+add_texture (Writer     *self,
+             GdkTexture *texture)
+{
+  guint32 index;
+
+  if (!lookup_object (self, texture, &index))
+    {
+      index = add_blob (self, gdk_texture_save_to_png_bytes (texture));
+      remember_object (self, texture, index);
+    }
+
+  return index;
+}
+
+static guint32
+add_font (Writer    *self,
+          PangoFont *font)
+{
+  guint32 index;
+
+  if (!lookup_object (self, font, &index))
+    {
+      PangoFontDescription *desc;
+      char *font_name;
+
+      desc = pango_font_describe (font);
+      font_name = pango_font_description_to_string (desc);
+      index = add_string (self, font_name);
+      remember_object (self, font, index);
+
+      g_free (font_name);
+      pango_font_description_free (desc);
+    }
+
+  return index;
+}
+
+static cairo_status_t
+cairo_write_array (void                *closure,
+                   const unsigned char *data,
+                   unsigned int         length)
+{
+  g_byte_array_append (closure, data, length);
+
+  return CAIRO_STATUS_SUCCESS;
+}
+
+static guint32
+add_surface (Writer          *self,
+             cairo_surface_t *surface)
+{
+  GByteArray *array;
+
+  array = g_byte_array_new ();
+  cairo_surface_write_to_png_stream (surface, cairo_write_array, array);
+
+  return add_blob (self, g_byte_array_free_to_bytes (array));
+}
+
+static guint32
+write_node (Writer        *self,
+            GskRenderNode *node)
+{
+  guint32 *children = NULL;
+  guint32 start;
+  guint i, n_children = 0;
+
+  if (writer_lookup (self->nodes, self->prev_nodes, node,
+                     (GBoxedCopyFunc) gsk_render_node_ref, &start))
+    return start;
+
+  /* Children go first, so their offsets are known */
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      n_children = gsk_container_node_get_n_children (node);
+      children = g_new (guint32, n_children);
+      for (i = 0; i < n_children; i++)
+        children[i] = write_node (self, gsk_container_node_get_child (node, i));
+      break;
+
+    case GSK_GL_SHADER_NODE:
+      n_children = gsk_gl_shader_node_get_n_children (node);
+      children = g_new (guint32, n_children);
+      for (i = 0; i < n_children; i++)
+        children[i] = write_node (self, gsk_gl_shader_node_get_child (node, i));
+      break;
+
+    case GSK_BLEND_NODE:
+      n_children = 2;
+      children = g_new (guint32, 2);
+      children[0] = write_node (self, gsk_blend_node_get_bottom_child (node));
+      children[1] = write_node (self, gsk_blend_node_get_top_child (node));
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      n_children = 2;
+      children = g_new (guint32, 2);
+      children[0] = write_node (self, gsk_cross_fade_node_get_start_child (node));
+      children[1] = write_node (self, gsk_cross_fade_node_get_end_child (node));
+      break;
+
+#define SINGLE_CHILD(TYPE, getter) \
+    case TYPE: \
+      n_children = 1; \
+      children = g_new (guint32, 1); \
+      children[0] = write_node (self, getter (node)); \
+      break;
+
+    SINGLE_CHILD (GSK_TRANSFORM_NODE, gsk_transform_node_get_child)
+    SINGLE_CHILD (GSK_OPACITY_NODE, gsk_opacity_node_get_child)
+    SINGLE_CHILD (GSK_COLOR_MATRIX_NODE, gsk_color_matrix_node_get_child)
+    SINGLE_CHILD (GSK_REPEAT_NODE, gsk_repeat_node_get_child)
+    SINGLE_CHILD (GSK_CLIP_NODE, gsk_clip_node_get_child)
+    SINGLE_CHILD (GSK_ROUNDED_CLIP_NODE, gsk_rounded_clip_node_get_child)
+    SINGLE_CHILD (GSK_SHADOW_NODE, gsk_shadow_node_get_child)
+    SINGLE_CHILD (GSK_BLUR_NODE, gsk_blur_node_get_child)
+    SINGLE_CHILD (GSK_DEBUG_NODE, gsk_debug_node_get_child)
+
+#undef SINGLE_CHILD
+
+    case GSK_NOT_A_RENDER_NODE:
+      g_assert_not_reached ();
+      break;
+
+    case GSK_CAIRO_NODE:
+    case GSK_COLOR_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_TEXTURE_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+    case GSK_TEXT_NODE:
+    default:
+      break;
+    }
+
+  start = self->base + self->data->len;
+  write_uint (self, gsk_render_node_get_node_type (node));
+  write_uint (self, 0); /* size, patched below */
+  write_rect (self, &node->bounds);
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      write_uint (self, n_children);
+      for (i = 0; i < n_children; i++)
+        write_uint (self, children[i]);
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        cairo_surface_t *surface = gsk_cairo_node_get_surface (node);
+
+        write_uint (self, surface ? add_surface (self, surface) : NO_BLOB);
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      write_rgba (self, gsk_color_node_get_color (node));
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      write_point (self, gsk_linear_gradient_node_get_start (node));
+      write_point (self, gsk_linear_gradient_node_get_end (node));
+      write_stops (self,
+                   gsk_linear_gradient_node_get_color_stops (node, NULL),
+                   gsk_linear_gradient_node_get_n_color_stops (node));
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      write_point (self, gsk_radial_gradient_node_get_center (node));
+      write_float (self, gsk_radial_gradient_node_get_hradius (node));
+      write_float (self, gsk_radial_gradient_node_get_vradius (node));
+      write_float (self, gsk_radial_gradient_node_get_start (node));
+      write_float (self, gsk_radial_gradient_node_get_end (node));
+      write_stops (self,
+                   gsk_radial_gradient_node_get_color_stops (node, NULL),
+                   gsk_radial_gradient_node_get_n_color_stops (node));
+      break;
+
+    case GSK_CONIC_GRADIENT_NODE:
+      write_point (self, gsk_conic_gradient_node_get_center (node));
+      write_float (self, gsk_conic_gradient_node_get_rotation (node));
+      write_stops (self,
+                   gsk_conic_gradient_node_get_color_stops (node, NULL),
+                   gsk_conic_gradient_node_get_n_color_stops (node));
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        const GdkRGBA *colors = gsk_border_node_get_colors (node);
+
+        write_rounded_rect (self, gsk_border_node_get_outline (node));
+        write_floats (self, gsk_border_node_get_widths (node), 4);
+        for (i = 0; i < 4; i++)
+          write_rgba (self, &colors[i]);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      write_uint (self, add_texture (self, gsk_texture_node_get_texture (node)));
+      write_uint (self, gsk_texture_node_get_filter (node));
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+      write_rounded_rect (self, gsk_inset_shadow_node_get_outline (node));
+      write_rgba (self, gsk_inset_shadow_node_get_color (node));
+      write_float (self, gsk_inset_shadow_node_get_dx (node));
+      write_float (self, gsk_inset_shadow_node_get_dy (node));
+      write_float (self, gsk_inset_shadow_node_get_spread (node));
+      write_float (self, gsk_inset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_OUTSET_SHADOW_NODE:
+      write_rounded_rect (self, gsk_outset_shadow_node_get_outline (node));
+      write_rgba (self, gsk_outset_shadow_node_get_color (node));
+      write_float (self, gsk_outset_shadow_node_get_dx (node));
+      write_float (self, gsk_outset_shadow_node_get_dy (node));
+      write_float (self, gsk_outset_shadow_node_get_spread (node));
+      write_float (self, gsk_outset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        /* Keep the transform's structure, a matrix would lose its category */
+        char *string = gsk_transform_to_string (gsk_transform_node_get_transform (node));
+
+        write_uint (self, children[0]);
+        write_uint (self, add_string (self, string));
+        g_free (string);
+      }
+      break;
+
+    case GSK_OPACITY_NODE:
+      write_uint (self, children[0]);
+      write_float (self, gsk_opacity_node_get_opacity (node));
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        float offset[4];
+
+        graphene_vec4_to_float (gsk_color_matrix_node_get_color_offset (node), offset);
+        write_uint (self, children[0]);
+        write_matrix (self, gsk_color_matrix_node_get_color_matrix (node));
+        write_floats (self, offset, 4);
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      write_uint (self, children[0]);
+      write_rect (self, gsk_repeat_node_get_child_bounds (node));
+      break;
+
+    case GSK_CLIP_NODE:
+      write_uint (self, children[0]);
+      write_rect (self, gsk_clip_node_get_clip (node));
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      write_uint (self, children[0]);
+      write_rounded_rect (self, gsk_rounded_clip_node_get_clip (node));
+      break;
+
+    case GSK_SHADOW_NODE:
+      write_uint (self, children[0]);
+      write_uint (self, gsk_shadow_node_get_n_shadows (node));
+      for (i = 0; i < gsk_shadow_node_get_n_shadows (node); i++)
+        {
+          const GskShadow *shadow = gsk_shadow_node_get_shadow (node, i);
+
+          write_rgba (self, &shadow->color);
+          write_float (self, shadow->dx);
+          write_float (self, shadow->dy);
+          write_float (self, shadow->radius);
+        }
+      break;
+
+    case GSK_BLEND_NODE:
+      write_uint (self, children[0]);
+      write_uint (self, children[1]);
+      write_uint (self, gsk_blend_node_get_blend_mode (node));
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      write_uint (self, children[0]);
+      write_uint (self, children[1]);
+      write_float (self, gsk_cross_fade_node_get_progress (node));
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        const PangoGlyphInfo *glyphs;
+        guint n_glyphs;
+
+        glyphs = gsk_text_node_get_glyphs (node, &n_glyphs);
+        write_uint (self, add_font (self, gsk_text_node_get_font (node)));
+        write_rgba (self, gsk_text_node_get_color (node));
+        write_point (self, gsk_text_node_get_offset (node));
+        write_uint (self, n_glyphs);
+        for (i = 0; i < n_glyphs; i++)
+          {
+            write_uint (self, glyphs[i].glyph);
+            write_uint (self, glyphs[i].geometry.width);
+            write_uint (self, glyphs[i].geometry.x_offset);
+            write_uint (self, glyphs[i].geometry.y_offset);
+            write_uint (self, (glyphs[i].attr.is_cluster_start ? 1 : 0) |
+                              (glyphs[i].attr.is_color ? 2 : 0));
+          }
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      write_uint (self, children[0]);
+      write_float (self, gsk_blur_node_get_radius (node));
+      break;
+
+    case GSK_DEBUG_NODE:
+      {
+        const char *message = gsk_debug_node_get_message (node);
+
+        write_uint (self, children[0]);
+        write_uint (self, message ? add_string (self, message) : NO_BLOB);
+      }
+      break;
+
+    case GSK_GL_SHADER_NODE:
+      {
+        GskGLShader *shader = gsk_gl_shader_node_get_shader (node);
+        guint32 index;
+
+        if (!lookup_object (self, shader, &index))
+          {
+            index = add_blob (self, g_bytes_ref (gsk_gl_shader_get_source (shader)));
+            remember_object (self, shader, index);
+          }
+
+        write_uint (self, index);
+        write_uint (self, add_blob (self, g_bytes_ref (gsk_gl_shader_node_get_args (node))));
+        write_uint (self, n_children);
+        for (i = 0; i < n_children; i++)
+          write_uint (self, children[i]);
+      }
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  *(guint32 *) (self->data->data + start - self->base + sizeof (guint32)) =
+      GUINT32_TO_LE (self->base + self->data->len - start);
+
+  g_hash_table_insert (self->nodes, gsk_render_node_ref (node), GUINT_TO_POINTER (start));
+  g_free (children);
+
+  return start;
+}
+
+/* Appends the contents of the blobs collected so far, followed by
+ * their table, and returns the offset of the table.
+ */
+static guint32
+write_blobs (Writer *self)
+{
+  static const guint8 padding[4] = { 0, };
+  guint32 *offsets;
+  guint32 table;
+  guint i;
+
+  offsets = g_new (guint32, MAX (self->blobs->len, 1));
+  for (i = 0; i < self->blobs->len; i++)
+    {
+      GBytes *bytes = g_ptr_array_index (self->blobs, i);
+
+      offsets[i] = self->base + self->data->len;
+      g_byte_array_append (self->data,
+                           g_bytes_get_data (bytes, NULL),
+                           g_bytes_get_size (bytes));
+      g_byte_array_append (self->data, padding, -self->data->len & 3);
+    }
+
+  table = self->base + self->data->len;
+  for (i = 0; i < self->blobs->len; i++)
+    {
+      write_uint (self, offsets[i]);
+      write_uint (self, g_bytes_get_size (g_ptr_array_index (self->blobs, i)));
+    }
+
+  g_free (offsets);
+
+  return table;
+}
+
+/*< private >
+ * gsk_render_node_serialize_binary:
+ * @node: a `GskRenderNode`
+ *
+ * Serializes @node into the binary format.
+ *
+ * The result is much smaller and faster to load than the text format
+ * from gsk_render_node_serialize(), because images and strings are
+ * stored raw and only once. gsk_render_node_deserialize() accepts both.
+ *
+ * Cairo nodes are stored as images, so recording surfaces lose their
+ * script. Use the text format for tests.
+ *
+ * Returns: a `GBytes` representing the node.
+ */
+GBytes *
+gsk_render_node_serialize_binary (GskRenderNode *node)
+{
+  Writer writer;
+  guint32 root, blobs;
+  GBytes *result;
+
+  writer_init (&writer);
+
+  g_byte_array_append (writer.data, (const guint8 *) BINARY_MAGIC, 4);
+  write_uint (&writer, BINARY_VERSION);
+  write_uint (&writer, 0); /* root */
+  write_uint (&writer, 0); /* n_blobs */
+  write_uint (&writer, 0); /* blobs */
+
+  root = write_node (&writer, node);
+  blobs = write_blobs (&writer);
+
+  ((guint32 *) writer.data->data)[2] = GUINT32_TO_LE (root);
+  ((guint32 *) writer.data->data)[3] = GUINT32_TO_LE (writer.blobs->len);
+  ((guint32 *) writer.data->data)[4] = GUINT32_TO_LE (blobs);
+
+  result = g_byte_array_free_to_bytes (writer.data);
+  writer.data = g_byte_array_new ();
+  writer_clear (&writer);
+
+  return result;
+}
+
+typedef struct
+{
+  GBytes *bytes;
+  const guchar *data;
+  gsize size;
+
+  guint32 n_blobs;
+  guint32 blobs;
+  const guint32 *blob_table; /* for streams, n_blobs × { offset, size } */
+
+  GHashTable *nodes;     /* record offset => GskRenderNode */
+  GHashTable *textures;  /* blob index => GdkTexture */
+  GHashTable *fonts;     /* blob index => PangoFont */
+  GHashTable *shaders;   /* blob index => GskGLShader */
+
+  /* The record being read */
+  gsize start;
+  gsize pos;
+  gsize end;
+
+  GError *error;
+  gsize error_pos;
+} Reader;
+
+static void G_GNUC_PRINTF (2, 3)
+reader_error (Reader     *self,
+              const char *format,
+              ...)
+{
+  va_list args;
+
+  if (self->error)
+    return;
+
+  va_start (args, format);
+  self->error = g_error_new_valist (GSK_SERIALIZATION_ERROR,
+                                    GSK_SERIALIZATION_INVALID_DATA,
+                                    format, args);
+  va_end (args);
+
+  self->error_pos = self->start;
+}
+
+static guint32
+get_uint (Reader *self,
+          gsize   offset)
+{
+  guint32 value;
+
+  memcpy (&value, self->data + offset, sizeof (guint32));
+
+  return GUINT32_FROM_LE (value);
+}
+
+static guint32
+read_uint (Reader *self)
+{
+  guint32 value;
+
+  if (self->error)
+    return 0;
+
+  if (self->end - self->pos < sizeof (guint32))
+    {
+      reader_error (self, "Node data is truncated");
+      return 0;
+    }
+
+  value = get_uint (self, self->pos);
+  self->pos += sizeof (guint32);
+
+  return value;
+}
+
+static float
+read_float (Reader *self)
+{
+  guint32 bits = read_uint (self);
+  float value;
+
+  memcpy (&value, &bits, sizeof (float));
+
+  return value;
+}
+
+static void
+read_point (Reader           *self,
+            graphene_point_t *point)
+{
+  point->x = read_float (self);
+  point->y = read_float (self);
+}
+
+static void
+read_rect (Reader          *self,
+           graphene_rect_t *rect)
+{
+  rect->origin.x = read_float (self);
+  rect->origin.y = read_float (self);
+  rect->size.width = read_float (self);
+  rect->size.height = read_float (self);
+}
+
+static void
+read_rounded_rect (Reader         *self,
+                   GskRoundedRect *rect)
+{
+  guint i;
+
+  read_rect (self, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      rect->corner[i].width = read_float (self);
+      rect->corner[i].height = read_float (self);
+    }
+}
+
+static void
+read_rgba (Reader  *self,
+           GdkRGBA *rgba)
+{
+  rgba->red = read_float (self);
+  rgba->green = read_float (self);
+  rgba->blue = read_float (self);
+  rgba->alpha = read_float (self);
+}
+
+/* Reads a count of items of @item_size bytes that follow */
+static guint32
+read_count (Reader *self,
+            gsize   item_size)
+{
+  guint32 n = read_uint (self);
+
+  if (n > (self->end - self->pos) / item_size)
+    {
+      reader_error (self, "Node data is truncated");
+      return 0;
+    }
+
+  return n;
+}
+
+static GskColorStop *
+read_stops (Reader *self,
+            gsize  *n_stops)
+{
+  GskColorStop *stops;
+  gsize i, n;
+
+  n = read_count (self, 5 * sizeof (float));
+  if (n < 2)
+    {
+      reader_error (self, "Gradients need at least 2 color stops");
+      return NULL;
+    }
+
+  stops = g_new (GskColorStop, n);
+  for (i = 0; i < n; i++)
+    {
+      stops[i].offset = read_float (self);
+      read_rgba (self, &stops[i].color);
+
+      if (stops[i].offset < (i > 0 ? stops[i - 1].offset : 0) || stops[i].offset > 1)
+        reader_error (self, "Color stops must be increasing between 0 and 1");
+    }
+
+  if (self->error)
+    {
+      g_free (stops);
+      return NULL;
+    }
+
+  *n_stops = n;
+
+  return stops;
+}
+
+static const guchar *
+get_blob (Reader  *self,
+          guint32  index,
+          gsize   *size)
+{
+  guint32 offset, blob_size;
+
+  if (self->error)
+    return NULL;
+
+  if (index >= self->n_blobs)
+    {
+      reader_error (self, "Invalid data reference %u", index);
+      return NULL;
+    }
+
+  if (self->blob_table)
+    {
+      offset = self->blob_table[2 * index];
+      blob_size = self->blob_table[2 * index + 1];
+    }
+  else
+    {
+      offset = get_uint (self, self->blobs + 2 * sizeof (guint32) * index);
+      blob_size = get_uint (self, self->blobs + 2 * sizeof (guint32) * index + sizeof (guint32));
+    }
+  if (offset > self->size || blob_size > self->size - offset)
+    {
+      reader_error (self, "Invalid data reference %u", index);
+      return NULL;
+    }
+
+  *size = blob_size;
+
+  return self->data + offset;
+}
+
+static const char *
+read_string (Reader *self)
+{
+  const guchar *data;
+  gsize size;
+
+  data = get_blob (self, read_uint (self), &size);
+  if (data == NULL)
+    return NULL;
+
+  if (size == 0 || data[size - 1] != '\0')
+    {
+      reader_error (self, "Strings must be NUL-terminated");
+      return NULL;
+    }
+
+  return (const char *) data;
+}
+
+static GdkTexture *
+read_texture (Reader *self)
+{
+  GdkTexture *texture;
+  const guchar *data;
+  guint32 index;
+  gsize size;
+
+  index = read_uint (self);
+  texture = g_hash_table_lookup (self->textures, GUINT_TO_POINTER (index));
+  if (texture)
+    return texture;
+
+  data = get_blob (self, index, &size);
+  if (data == NULL)
+    return NULL;
+
+  {
+    GError *error = NULL;
+    GBytes *bytes;
+
+    /* Decode straight from the (possibly mapped) input */
+    bytes = g_bytes_new_from_bytes (self->bytes, data - self->data, size);
+    texture = gdk_texture_new_from_bytes (bytes, &error);
+    g_bytes_unref (bytes);
+
+    if (texture == NULL)
+      {
+        reader_error (self, "Could not load image: %s", error->message);
+        g_error_free (error);
+        return NULL;
+      }
+  }
+
+  g_hash_table_insert (self->textures, GUINT_TO_POINTER (index), texture);
+
+  return texture;
+}
+
+static PangoFont *
+read_font (Reader *self)
+{
+  PangoFontDescription *desc;
+  PangoFontMap *font_map;
+  PangoContext *context;
+  PangoFont *font;
+  const char *name;
+  gsize pos;
+
+  pos = self->pos;
+  font = g_hash_table_lookup (self->fonts, GUINT_TO_POINTER (read_uint (self)));
+  if (font)
+    return font;
+
+  self->pos = pos;
+  name = read_string (self);
+  if (name == NULL)
+    return NULL;
+
+  desc = pango_font_description_from_string (name);
+  font_map = pango_cairo_font_map_get_default ();
+  context = pango_font_map_create_context (font_map);
+  font = pango_font_map_load_font (font_map, context, desc);
+
+  pango_font_description_free (desc);
+  g_object_unref (context);
+
+  if (font == NULL)
+    {
+      reader_error (self, "The font \"%s\" does not exist", name);
+      return NULL;
+    }
+
+  g_hash_table_insert (self->fonts, GUINT_TO_POINTER (get_uint (self, pos)), font);
+
+  return font;
+}
+
+static GskGLShader *
+read_shader (Reader *self)
+{
+  GskGLShader *shader;
+  const guchar *data;
+  GBytes *bytes;
+  guint32 index;
+  gsize size;
+
+  index = read_uint (self);
+  shader = g_hash_table_lookup (self->shaders, GUINT_TO_POINTER (index));
+  if (shader)
+    return shader;
+
+  data = get_blob (self, index, &size);
+  if (data == NULL)
+    return NULL;
+
+  bytes = g_bytes_new_from_bytes (self->bytes, data - self->data, size);
+  shader = gsk_gl_shader_new_from_bytes (bytes);
+  g_bytes_unref (bytes);
+
+  g_hash_table_insert (self->shaders, GUINT_TO_POINTER (index), shader);
+
+  return shader;
+}
+
+static GskRenderNode * read_node_at (Reader  *self,
+                                     guint32  offset);
+
+/* Returns a borrowed reference */
+static GskRenderNode *
+read_child (Reader *self)
+{
+  guint32 offset = read_uint (self);
+
+  if (self->error)
+    return NULL;
+
+  /* Children precede their parents, which also rules out cycles */
+  if (offset >= self->start)
+    {
+      reader_error (self, "Invalid child reference %u", offset);
+      return NULL;
+    }
+
+  return read_node_at (self, offset);
+}
+
+static GskRenderNode **
+read_children (Reader *self,
+               guint  *n_children)
+{
+  GskRenderNode **children;
+  guint i, n;
+
+  n = read_count (self, sizeof (guint32));
+  children = g_new (GskRenderNode *, MAX (n, 1));
+  for (i = 0; i < n; i++)
+    children[i] = read_child (self);
+
+  *n_children = n;
+
+  return children;
+}
+
+static GskRenderNode *
+read_node_data (Reader                *self,
+                GskRenderNodeType      type,
+                const graphene_rect_t *bounds)
+{
+  GskRenderNode *node = NULL;
+
+  switch (type)
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        GskRenderNode **children;
+        guint n_children;
+
+        children = read_children (self, &n_children);
+        if (!self->error)
+          node = gsk_container_node_new (children, n_children);
+        g_free (children);
+      }
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        GdkTexture *pixels = NULL;
+        gsize pos = self->pos;
+
+        if (read_uint (self) != NO_BLOB)
+          {
+            self->pos = pos;
+            pixels = read_texture (self);
+          }
+
+        if (self->error)
+          break;
+
+        node = gsk_cairo_node_new (bounds);
+        if (pixels != NULL)
+          {
+            cairo_t *cr = gsk_cairo_node_get_draw_context (node);
+            cairo_surface_t *surface = gdk_texture_download_surface (pixels);
+
+            cairo_set_source_surface (cr, surface, 0, 0);
+            cairo_paint (cr);
+            cairo_destroy (cr);
+            cairo_surface_destroy (surface);
+          }
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      {
+        GdkRGBA color;
+
+        read_rgba (self, &color);
+        if (!self->error)
+          node = gsk_color_node_new (&color, bounds);
+      }
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        graphene_point_t start, end;
+        GskColorStop *stops;
+        gsize n_stops;
+
+        read_point (self, &start);
+        read_point (self, &end);
+        stops = read_stops (self, &n_stops);
+        if (self->error)
+          break;
+
+        if (type == GSK_LINEAR_GRADIENT_NODE)
+          node = gsk_linear_gradient_node_new (bounds, &start, &end, stops, n_stops);
+        else
+          node = gsk_repeating_linear_gradient_node_new (bounds, &start, &end, stops, n_stops);
+        g_free (stops);
+      }
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        graphene_point_t center;
+        float hradius, vradius, start, end;
+        GskColorStop *stops;
+        gsize n_stops;
+
+        read_point (self, &center);
+        hradius = read_float (self);
+        vradius = read_float (self);
+        start = read_float (self);
+        end = read_float (self);
+        if (!(hradius > 0 && vradius > 0 && start >= 0 && end > start))
+          reader_error (self, "Invalid radial gradient");
+        stops = read_stops (self, &n_stops);
+        if (self->error)
+          break;
+
+        if (type == GSK_RADIAL_GRADIENT_NODE)
+          node = gsk_radial_gradient_node_new (bounds, &center, hradius, vradius, start, end, stops, n_stops);
+        else
+          node = gsk_repeating_radial_gradient_node_new (bounds, &center, hradius, vradius, start, end, stops, n_stops);
+        g_free (stops);
+      }
+      break;
+
+    case GSK_CONIC_GRADIENT_NODE:
+      {
+        graphene_point_t center;
+        GskColorStop *stops;
+        gsize n_stops;
+        float rotation;
+
+        read_point (self, &center);
+        rotation = read_float (self);
+        stops = read_stops (self, &n_stops);
+        if (self->error)
+          break;
+
+        node = gsk_conic_gradient_node_new (bounds, &center, rotation, stops, n_stops);
+        g_free (stops);
+      }
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        GskRoundedRect outline;
+        float widths[4];
+        GdkRGBA colors[4];
+        guint i;
+
+        read_rounded_rect (self, &outline);
+        for (i = 0; i < 4; i++)
+          widths[i] = read_float (self);
+        for (i = 0; i < 4; i++)
+          read_rgba (self, &colors[i]);
+        if (!self->error)
+          node = gsk_border_node_new (&outline, widths, colors);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      {
+        GdkTexture *texture = read_texture (self);
+        guint filter = GSK_SCALING_FILTER_LINEAR;
+
+        /* Older data has no filter */
+        if (self->pos < self->end)
+          filter = read_uint (self);
+
+        if (!self->error && filter <= GSK_SCALING_FILTER_TRILINEAR)
+          node = gsk_texture_node_new_with_filter (texture, bounds, filter);
+      }
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      {
+        GskRoundedRect outline;
+        GdkRGBA color;
+        float dx, dy, spread, blur_radius;
+
+        read_rounded_rect (self, &outline);
+        read_rgba (self, &color);
+        dx = read_float (self);
+        dy = read_float (self);
+        spread = read_float (self);
+        blur_radius = read_float (self);
+        if (self->error)
+          break;
+
+        if (type == GSK_INSET_SHADOW_NODE)
+          node = gsk_inset_shadow_node_new (&outline, &color, dx, dy, spread, blur_radius);
+        else
+          node = gsk_outset_shadow_node_new (&outline, &color, dx, dy, spread, blur_radius);
+      }
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskRenderNode *child = read_child (self);
+        const char *string = read_string (self);
+        GskTransform *transform = NULL;
+
+        if (self->error)
+          break;
+
+        if (!gsk_transform_parse (string, &transform))
+          {
+            reader_error (self, "Invalid transform \"%s\"", string);
+            break;
+          }
+
+        node = gsk_transform_node_new (child, transform);
+        gsk_transform_unref (transform);
+      }
+      break;
+
+    case GSK_OPACITY_NODE:
+      {
+        GskRenderNode *child = read_child (self);
+        float opacity = read_float (self);
+
+        if (!self->error)
+          node = gsk_opacity_node_new (child, opacity);
+      }
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        GskRenderNode *child = read_child (self);
+        graphene_matrix_t matrix;
+        graphene_vec4_t offset;
+        float values[16];
+        guint i;
+
+        for (i = 0; i < 16; i++)
+          values[i] = read_float (self);
+        graphene_matrix_init_from_float (&matrix, values);
+        for (i = 0; i < 4; i++)
+          values[i] = read_float (self);
+        graphene_vec4_init_from_float (&offset, values);
+
+        if (!self->error)
+          node = gsk_color_matrix_node_new (child, &matrix, &offset);
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      {
+        GskRenderNode *child = read_child (self);
+        graphene_rect_t child_bounds;
+
+        read_rect (self, &child_bounds);
+        if (!self->error)
+          node = gsk_repeat_node_new (bounds, child, &child_bounds);
+      }
+      break;
+
+    case GSK_CLIP_NODE:
+      {
+        GskRenderNode *child = read_child (self);
+        graphene_rect_t clip;
+
+        read_rect (self, &clip);
+        if (!self->error)
+          node = gsk_clip_node_new (child, &clip);
+      }
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      {
+        GskRenderNode *child = read_child (self);
+        GskRoundedRect clip;
+
+        read_rounded_rect (self, &clip);
+        if (!self->error)
+          node = gsk_rounded_clip_node_new (child, &clip);
+      }
+      break;
+
+    case GSK_SHADOW_NODE:
+      {
+        GskRenderNode *child = read_child (self);
+        GskShadow *shadows;
+        guint i, n_shadows;
+
+        n_shadows = read_count (self, 7 * sizeof (float));
+        if (n_shadows == 0)
+          reader_error (self, "Shadow nodes need at least 1 shadow");
+        if (self->error)
+          break;
+
+        shadows = g_new (GskShadow, n_shadows);
+        for (i = 0; i < n_shadows; i++)
+          {
+            read_rgba (self, &shadows[i].color);
+            shadows[i].dx = read_float (self);
+            shadows[i].dy = read_float (self);
+            shadows[i].radius = read_float (self);
+          }
+
+        node = gsk_shadow_node_new (child, shadows, n_shadows);
+        g_free (shadows);
+      }
+      break;
+
+    case GSK_BLEND_NODE:
+      {
+        GskRenderNode *bottom = read_child (self);
+        GskRenderNode *top = read_child (self);
+        guint32 blend_mode = read_uint (self);
+
+        if (blend_mode > GSK_BLEND_MODE_LUMINOSITY)
+          reader_error (self, "Invalid blend mode %u", blend_mode);
+        if (!self->error)
+          node = gsk_blend_node_new (bottom, top, blend_mode);
+      }
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      {
+        GskRenderNode *start = read_child (self);
+        GskRenderNode *end = read_child (self);
+        float progress = read_float (self);
+
+        if (!self->error)
+          node = gsk_cross_fade_node_new (start, end, progress);
+      }
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        PangoFont *font = read_font (self);
+        PangoGlyphString *glyphs;
+        graphene_point_t offset;
+        GdkRGBA color;
+        guint i, n_glyphs;
+
+        read_rgba (self, &color);
+        read_point (self, &offset);
+        n_glyphs = read_count (self, 5 * sizeof (guint32));
+        if (self->error)
+          break;
+
+        glyphs = pango_glyph_string_new ();
+        pango_glyph_string_set_size (glyphs, n_glyphs);
+        for (i = 0; i < n_glyphs; i++)
+          {
+            PangoGlyphInfo *gi = &glyphs->glyphs[i];
+            guint32 flags;
+
+            gi->glyph = read_uint (self);
+            gi->geometry.width = (gint32) read_uint (self);
+            gi->geometry.x_offset = (gint32) read_uint (self);
+            gi->geometry.y_offset = (gint32) read_uint (self);
+            flags = read_uint (self);
+            gi->attr.is_cluster_start = (flags & 1) ? 1 : 0;
+            gi->attr.is_color = (flags & 2) ? 1 : 0;
+          }
+
+        node = gsk_text_node_new (font, glyphs, &color, &offset);
+        pango_glyph_string_free (glyphs);
+
+        /* Like the text format, don't fail on text without ink */
+        if (node == NULL)
+          node = gsk_container_node_new (NULL, 0);
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      {
+        GskRenderNode *child = read_child (self);
+        float radius = read_float (self);
+
+        if (!(radius >= 0))
+          reader_error (self, "Invalid blur radius");
+        if (!self->error)
+          node = gsk_blur_node_new (child, radius);
+      }
+      break;
+
+    case GSK_DEBUG_NODE:
+      {
+        GskRenderNode *child = read_child (self);
+        const char *message = NULL;
+        gsize pos = self->pos;
+
+        if (read_uint (self) != NO_BLOB)
+          {
+            self->pos = pos;
+            message = read_string (self);
+          }
+
+        if (!self->error)
+          node = gsk_debug_node_new (child, g_strdup (message));
+      }
+      break;
+
+    case GSK_GL_SHADER_NODE:
+      {
+        GskGLShader *shader = read_shader (self);
+        GskRenderNode **children;
+        const guchar *data;
+        GBytes *args = NULL;
+        guint n_children;
+        gsize size;
+
+        data = get_blob (self, read_uint (self), &size);
+        children = read_children (self, &n_children);
+
+        if (!self->error)
+          {
+            args = g_bytes_new_from_bytes (self->bytes, data - self->data, size);
+
+            if (size != gsk_gl_shader_get_args_size (shader) ||
+                n_children != gsk_gl_shader_get_n_textures (shader))
+              reader_error (self, "Arguments don't match the shader");
+          }
+
+        if (!self->error)
+          node = gsk_gl_shader_node_new (shader, bounds, args,
+                                         n_children ? children : NULL, n_children);
+
+        g_clear_pointer (&args, g_bytes_unref);
+        g_free (children);
+      }
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      reader_error (self, "Unknown node type %u", type);
+      break;
+    }
+
+  return node;
+}
+
+/* Returns a borrowed reference */
+static GskRenderNode *
+read_node_at (Reader  *self,
+              guint32  offset)
+{
+  GskRenderNode *node;
+  graphene_rect_t bounds;
+  gsize start, pos, end;
+  guint32 type, size;
+
+  node = g_hash_table_lookup (self->nodes, GUINT_TO_POINTER (offset));
+  if (node)
+    return node;
+
+  start = self->start;
+  pos = self->pos;
+  end = self->end;
+
+  self->start = offset;
+  if (offset < HEADER_SIZE || offset % 4 != 0 ||
+      self->size < NODE_HEADER_SIZE || offset > self->size - NODE_HEADER_SIZE)
+    {
+      reader_error (self, "Invalid node reference %u", offset);
+      goto out;
+    }
+
+  type = get_uint (self, offset);
+  size = get_uint (self, offset + sizeof (guint32));
+  if (size < NODE_HEADER_SIZE || size > self->size - offset)
+    {
+      reader_error (self, "Invalid node size %u", size);
+      goto out;
+    }
+
+  self->pos = offset + 2 * sizeof (guint32);
+  self->end = offset + size;
+  read_rect (self, &bounds);
+
+  node = read_node_data (self, type, &bounds);
+  if (node)
+    g_hash_table_insert (self->nodes, GUINT_TO_POINTER (offset), node);
+  else
+    reader_error (self, "Invalid node");
+
+out:
+  self->start = start;
+  self->pos = pos;
+  self->end = end;
+
+  return node;
+}
+
+static void
+reader_init (Reader *self,
+             GBytes *bytes)
+{
+  memset (self, 0, sizeof (Reader));
+
+  self->bytes = bytes;
+  self->data = g_bytes_get_data (bytes, &self->size);
+  self->nodes = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) gsk_render_node_unref);
+  self->textures = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+  self->fonts = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+  self->shaders = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+}
+
+static void
+reader_clear (Reader *self)
+{
+  g_hash_table_unref (self->nodes);
+  g_hash_table_unref (self->textures);
+  g_hash_table_unref (self->fonts);
+  g_hash_table_unref (self->shaders);
+}
+
+/*< private >
+ * gsk_render_node_is_binary:
+ * @bytes: serialized data
+ *
+ * Checks if @bytes were created by gsk_render_node_serialize_binary().
+ *
+ * Returns: %TRUE if @bytes are in the binary format
+ */
+gboolean
+gsk_render_node_is_binary (GBytes *bytes)
+{
+  gsize size;
+  const guchar *data = g_bytes_get_data (bytes, &size);
+
+  return size >= 4 && memcmp (data, BINARY_MAGIC, 4) == 0;
+}
+
+/*< private >
+ * gsk_render_node_deserialize_binary:
+ * @bytes: data created by gsk_render_node_serialize_binary()
+ * @error_func: (nullable) (scope call): Callback on parsing errors
+ * @user_data: (closure error_func): user_data for @error_func
+ *
+ * Loads a node from the binary format.
+ *
+ * Images in the data are decoded from @bytes directly, so @bytes
+ * can come from a mapped file. Unlike the text format, invalid data
+ * is not recovered from, and the error is reported at the byte offset
+ * of the offending node.
+ *
+ * Returns: (nullable) (transfer full): a new `GskRenderNode`
+ */
+GskRenderNode *
+gsk_render_node_deserialize_binary (GBytes            *bytes,
+                                    GskParseErrorFunc  error_func,
+                                    gpointer           user_data)
+{
+  GskRenderNode *root = NULL;
+  Reader reader;
+
+  reader_init (&reader, bytes);
+
+  if (reader.size < HEADER_SIZE || memcmp (reader.data, BINARY_MAGIC, 4) != 0)
+    {
+      reader.error = g_error_new_literal (GSK_SERIALIZATION_ERROR,
+                                          GSK_SERIALIZATION_UNSUPPORTED_FORMAT,
+                                          "Not a binary node file");
+    }
+  else if (get_uint (&reader, 4) != BINARY_VERSION)
+    {
+      reader.error = g_error_new (GSK_SERIALIZATION_ERROR,
+                                  GSK_SERIALIZATION_UNSUPPORTED_VERSION,
+                                  "Unsupported version %u", get_uint (&reader, 4));
+    }
+  else
+    {
+      reader.n_blobs = get_uint (&reader, 12);
+      reader.blobs = get_uint (&reader, 16);
+      reader.start = reader.size;
+
+      if (reader.blobs > reader.size ||
+          reader.n_blobs > (reader.size - reader.blobs) / (2 * sizeof (guint32)))
+        reader_error (&reader, "Invalid data table");
+      else
+        root = read_node_at (&reader, get_uint (&reader, 8));
+    }
+
+  if (reader.error)
+    {
+      GskParseLocation location = { 0, };
+
+      location.bytes = reader.error_pos;
+      location.chars = reader.error_pos;
+
+      if (error_func)
+        error_func (&location, &location, reader.error, user_data);
+
+      g_error_free (reader.error);
+      root = NULL;
+    }
+  else if (root)
+    {
+      gsk_render_node_ref (root);
+    }
+
+  reader_clear (&reader);
+
+  return root;
+}
+
+struct _GskRenderNodeWriter
+{
+  GOutputStream *stream;
+  guint64 offset;
+  Writer writer;
+};
+
+/*< private >
+ * gsk_render_node_writer_new:
+ * @stream: the stream to write to
+ *
+ * Creates a writer that appends frames to @stream in the
+ * binary stream format.
+ *
+ * Each frame only stores the nodes that were not part of the
+ * previous frame, so a recording of an animation only grows by
+ * the parts that changed. The nodes of the last frame are kept
+ * alive until the next one is added.
+ *
+ * Returns: (transfer full): a new `GskRenderNodeWriter`
+ */
+GskRenderNodeWriter *
+gsk_render_node_writer_new (GOutputStream *stream)
+{
+  GskRenderNodeWriter *self;
+
+  self = g_slice_new0 (GskRenderNodeWriter);
+  self->stream = g_object_ref (stream);
+  writer_init (&self->writer);
+
+  return self;
+}
+
+void
+gsk_render_node_writer_free (GskRenderNodeWriter *self)
+{
+  writer_clear (&self->writer);
+  g_object_unref (self->stream);
+
+  g_slice_free (GskRenderNodeWriter, self);
+}
+
+/*< private >
+ * gsk_render_node_writer_add_frame:
+ * @self: a `GskRenderNodeWriter`
+ * @node: the root node of the frame
+ * @error: return location for an error
+ *
+ * Writes a frame to the stream and flushes it, so that a
+ * `GskRenderNodeReader` can see it.
+ *
+ * Returns: the offset to load the frame from with
+ *   gsk_render_node_reader_load(), or 0 on error
+ */
+guint32
+gsk_render_node_writer_add_frame (GskRenderNodeWriter  *self,
+                                  GskRenderNode        *node,
+                                  GError              **error)
+{
+  Writer *writer = &self->writer;
+  guint32 header[3];
+  guint32 root, trailer;
+
+  if (self->offset == 0)
+    {
+      guint32 version = GUINT32_TO_LE (BINARY_VERSION);
+
+      if (!g_output_stream_write_all (self->stream, STREAM_MAGIC, 4, NULL, NULL, error) ||
+          !g_output_stream_write_all (self->stream, &version, sizeof (guint32), NULL, NULL, error))
+        return 0;
+
+      self->offset = STREAM_HEADER_SIZE;
+    }
+
+  g_byte_array_set_size (writer->data, 0);
+  writer->base = self->offset + CHUNK_HEADER_SIZE;
+
+  root = write_node (writer, node);
+  trailer = write_blobs (writer);
+  write_uint (writer, root);
+  write_uint (writer, writer->blobs->len);
+
+  if (self->offset + CHUNK_HEADER_SIZE + writer->data->len > G_MAXUINT32)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+                           "The recording is too large");
+      return 0;
+    }
+
+  memcpy (&header[0], CHUNK_MAGIC, 4);
+  header[1] = GUINT32_TO_LE (writer->data->len);
+  header[2] = GUINT32_TO_LE (trailer);
+
+  if (!g_output_stream_write_all (self->stream, header, sizeof (header), NULL, NULL, error) ||
+      !g_output_stream_write_all (self->stream, writer->data->data, writer->data->len, NULL, NULL, error) ||
+      !g_output_stream_flush (self->stream, NULL, error))
+    return 0;
+
+  self->offset += CHUNK_HEADER_SIZE + writer->data->len;
+
+  /* What this frame used is what the next one can refer to */
+  g_clear_pointer (&writer->prev_nodes, g_hash_table_unref);
+  writer->prev_nodes = writer->nodes;
+  writer->nodes = g_hash_table_new_full (NULL, NULL, (GDestroyNotify) gsk_render_node_unref, NULL);
+  g_clear_pointer (&writer->prev_objects, g_hash_table_unref);
+  writer->prev_objects = writer->objects;
+  writer->objects = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+
+  writer->blob_base += writer->blobs->len;
+  g_ptr_array_set_size (writer->blobs, 0);
+
+  return root;
+}
+
+struct _GskRenderNodeReader
+{
+  GBytes *bytes;
+  gsize size;
+  GArray *blobs;   /* guint32 pairs of offset and size */
+  GArray *frames;  /* guint32 root offsets */
+};
+
+static void
+gsk_render_node_reader_clear (gpointer data)
+{
+  GskRenderNodeReader *self = data;
+
+  g_bytes_unref (self->bytes);
+  g_array_unref (self->blobs);
+  g_array_unref (self->frames);
+}
+
+/*< private >
+ * gsk_render_node_reader_new:
+ * @bytes: the contents of a stream from `GskRenderNodeWriter`
+ * @error: return location for an error
+ *
+ * Reads the index of the frames in @bytes.
+ *
+ * Nodes are only loaded by gsk_render_node_reader_load(), so
+ * @bytes should come from a mapped file for large streams.
+ * Frames that were not completely written are ignored.
+ *
+ * Returns: (transfer full) (nullable): a new `GskRenderNodeReader`
+ */
+GskRenderNodeReader *
+gsk_render_node_reader_new (GBytes  *bytes,
+                            GError **error)
+{
+  GskRenderNodeReader *self;
+  const guchar *data;
+  gsize size, pos;
+  guint32 value;
+
+  data = g_bytes_get_data (bytes, &size);
+  if (size < STREAM_HEADER_SIZE || memcmp (data, STREAM_MAGIC, 4) != 0)
+    {
+      g_set_error_literal (error, GSK_SERIALIZATION_ERROR,
+                           GSK_SERIALIZATION_UNSUPPORTED_FORMAT,
+                           "Not a node stream");
+      return NULL;
+    }
+
+  memcpy (&value, data + 4, sizeof (guint32));
+  if (GUINT32_FROM_LE (value) != BINARY_VERSION)
+    {
+      g_set_error (error, GSK_SERIALIZATION_ERROR,
+                   GSK_SERIALIZATION_UNSUPPORTED_VERSION,
+                   "Unsupported version %u", GUINT32_FROM_LE (value));
+      return NULL;
+    }
+
+  self = g_rc_box_new0 (GskRenderNodeReader);
+  self->bytes = g_bytes_ref (bytes);
+  self->blobs = g_array_new (FALSE, FALSE, sizeof (guint32));
+  self->frames = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+  for (pos = STREAM_HEADER_SIZE; size - pos >= CHUNK_HEADER_SIZE; )
+    {
+      guint32 chunk[3], n_blobs, trailer, end;
+      const guint32 *table;
+      guint i;
+
+      memcpy (chunk, data + pos, sizeof (chunk));
+      if (memcmp (&chunk[0], CHUNK_MAGIC, 4) != 0)
+        break;
+
+      end = pos + CHUNK_HEADER_SIZE + GUINT32_FROM_LE (chunk[1]);
+      trailer = GUINT32_FROM_LE (chunk[2]);
+      if (end > size || end < pos + CHUNK_HEADER_SIZE + 2 * sizeof (guint32) ||
+          trailer < pos + CHUNK_HEADER_SIZE || trailer > end - 2 * sizeof (guint32) ||
+          trailer % 4 != 0)
+        break;
+
+      memcpy (&value, data + end - sizeof (guint32), sizeof (guint32));
+      n_blobs = GUINT32_FROM_LE (value);
+      if ((end - 2 * sizeof (guint32) - trailer) / (2 * sizeof (guint32)) != n_blobs ||
+          (end - 2 * sizeof (guint32) - trailer) % (2 * sizeof (guint32)) != 0)
+        break;
+
+      table = (const guint32 *) (data + trailer);
+      for (i = 0; i < 2 * n_blobs; i++)
+        {
+          value = GUINT32_FROM_LE (table[i]);
+          g_array_append_val (self->blobs, value);
+        }
+
+      memcpy (&value, data + end - 2 * sizeof (guint32), sizeof (guint32));
+      value = GUINT32_FROM_LE (value);
+      g_array_append_val (self->frames, value);
+
+      pos = end;
+    }
+
+  self->size = pos;
+
+  return self;
+}
+
+GskRenderNodeReader *
+gsk_render_node_reader_ref (GskRenderNodeReader *self)
+{
+  return g_rc_box_acquire (self);
+}
+
+void
+gsk_render_node_reader_unref (GskRenderNodeReader *self)
+{
+  g_rc_box_release_full (self, gsk_render_node_reader_clear);
+}
+
+/*< private >
+ * gsk_render_node_reader_get_size:
+ * @self: a `GskRenderNodeReader`
+ *
+ * Returns: the number of bytes covered by complete frames
+ */
+gsize
+gsk_render_node_reader_get_size (GskRenderNodeReader *self)
+{
+  return self->size;
+}
+
+guint
+gsk_render_node_reader_get_n_frames (GskRenderNodeReader *self)
+{
+  return self->frames->len;
+}
+
+/*< private >
+ * gsk_render_node_reader_get_frame:
+ * @self: a `GskRenderNodeReader`
+ * @position: the position of the frame in the stream
+ *
+ * Returns: the offset of the root node of the frame, for
+ *   gsk_render_node_reader_load()
+ */
+guint32
+gsk_render_node_reader_get_frame (GskRenderNodeReader *self,
+                                  guint                position)
+{
+  g_return_val_if_fail (position < self->frames->len, 0);
+
+  return g_array_index (self->frames, guint32, position);
+}
+
+/*< private >
+ * gsk_render_node_reader_load:
+ * @self: a `GskRenderNodeReader`
+ * @offset: the offset of a root node
+ * @error: return location for an error
+ *
+ * Loads the frame whose root node is at @offset. Offsets come from
+ * gsk_render_node_writer_add_frame() or gsk_render_node_reader_get_frame().
+ *
+ * Nothing is cached between loads, so only the frames that are in
+ * use take up memory.
+ *
+ * Returns: (transfer full) (nullable): the root node of the frame
+ */
+GskRenderNode *
+gsk_render_node_reader_load (GskRenderNodeReader  *self,
+                             guint32               offset,
+                             GError              **error)
+{
+  GskRenderNode *root;
+  Reader reader;
+
+  reader_init (&reader, self->bytes);
+  reader.size = self->size;
+  reader.blob_table = (const guint32 *) self->blobs->data;
+  reader.n_blobs = self->blobs->len / 2;
+  reader.start = reader.size;
+
+  root = read_node_at (&reader, offset);
+
+  if (reader.error)
+    {
+      g_prefix_error (&reader.error, "At offset %" G_GSIZE_FORMAT ": ", reader.error_pos);
+      g_propagate_error (error, reader.error);
+      root = NULL;
+    }
+  else if (root)
+    {
+      gsk_render_node_ref (root);
+    }
+
+  reader_clear (&reader);
+
+  return root;
+}
@@ -117,6 +117,40 @@ gsk_color_node_get_color (const GskRenderNode *node)
   return &self->color;
 }
 
+static guint64
+gsk_color_node_hash (GskRenderNode *node,
+                     guint64        hash)
+{
+  GskColorNode *self = (GskColorNode *) node;
+
+  hash = gsk_hash_data (hash, &self->color, sizeof (GdkRGBA));
+
+  return hash;
+}
+
+static gboolean
+gsk_color_node_equal (GskRenderNode *node1,
+                      GskRenderNode *node2)
+{
+  GskColorNode *self1 = (GskColorNode *) node1;
+  GskColorNode *self2 = (GskColorNode *) node2;
+
+  return memcmp (&self1->color, &self2->color, sizeof (GdkRGBA)) == 0;
+}
+
+static gboolean
+gsk_color_node_get_opaque_rect (GskRenderNode   *node,
+                                graphene_rect_t *opaque)
+{
+  GskColorNode *self = (GskColorNode *) node;
+
+  if (self->color.alpha < 1.0)
+    return FALSE;
+
+  *opaque = node->bounds;
+  return TRUE;
+}
+
 /**
  * gsk_color_node_new:
  * @rgba: a `GdkRGBA` specifying a color
@@ -245,6 +279,34 @@ gsk_linear_gradient_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint64
+gsk_linear_gradient_node_hash (GskRenderNode *node,
+                               guint64        hash)
+{
+  GskLinearGradientNode *self = (GskLinearGradientNode *) node;
+
+  hash = gsk_hash_data (hash, &self->start, sizeof (graphene_point_t));
+  hash = gsk_hash_data (hash, &self->end, sizeof (graphene_point_t));
+  hash = gsk_hash_data (hash, self->stops, sizeof (GskColorStop) * self->n_stops);
+
+  return hash;
+}
+
+static gboolean
+gsk_linear_gradient_node_equal (GskRenderNode *node1,
+                                GskRenderNode *node2)
+{
+  GskLinearGradientNode *self1 = (GskLinearGradientNode *) node1;
+  GskLinearGradientNode *self2 = (GskLinearGradientNode *) node2;
+
+  if (memcmp (&self1->start, &self2->start, sizeof (graphene_point_t)) != 0 ||
+      memcmp (&self1->end, &self2->end, sizeof (graphene_point_t)) != 0)
+    return FALSE;
+
+  return self1->n_stops == self2->n_stops &&
+         memcmp (self1->stops, self2->stops, sizeof (GskColorStop) * self1->n_stops) == 0;
+}
+
 /**
  * gsk_linear_gradient_node_new:
  * @bounds: the rectangle to render the linear gradient into
@@ -532,6 +594,40 @@ gsk_radial_gradient_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint64
+gsk_radial_gradient_node_hash (GskRenderNode *node,
+                               guint64        hash)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  hash = gsk_hash_data (hash, &self->center, sizeof (graphene_point_t));
+  hash = gsk_hash_data (hash, &self->hradius, sizeof (float));
+  hash = gsk_hash_data (hash, &self->vradius, sizeof (float));
+  hash = gsk_hash_data (hash, &self->start, sizeof (float));
+  hash = gsk_hash_data (hash, &self->end, sizeof (float));
+  hash = gsk_hash_data (hash, self->stops, sizeof (GskColorStop) * self->n_stops);
+
+  return hash;
+}
+
+static gboolean
+gsk_radial_gradient_node_equal (GskRenderNode *node1,
+                                GskRenderNode *node2)
+{
+  GskRadialGradientNode *self1 = (GskRadialGradientNode *) node1;
+  GskRadialGradientNode *self2 = (GskRadialGradientNode *) node2;
+
+  if (memcmp (&self1->center, &self2->center, sizeof (graphene_point_t)) != 0 ||
+      self1->hradius != self2->hradius ||
+      self1->vradius != self2->vradius ||
+      self1->start != self2->start ||
+      self1->end != self2->end)
+    return FALSE;
+
+  return self1->n_stops == self2->n_stops &&
+         memcmp (self1->stops, self2->stops, sizeof (GskColorStop) * self1->n_stops) == 0;
+}
+
 /**
  * gsk_radial_gradient_node_new:
  * @bounds: the bounds of the node
@@ -989,6 +1085,34 @@ gsk_conic_gradient_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint64
+gsk_conic_gradient_node_hash (GskRenderNode *node,
+                              guint64        hash)
+{
+  GskConicGradientNode *self = (GskConicGradientNode *) node;
+
+  hash = gsk_hash_data (hash, &self->center, sizeof (graphene_point_t));
+  hash = gsk_hash_data (hash, &self->rotation, sizeof (float));
+  hash = gsk_hash_data (hash, self->stops, sizeof (GskColorStop) * self->n_stops);
+
+  return hash;
+}
+
+static gboolean
+gsk_conic_gradient_node_equal (GskRenderNode *node1,
+                               GskRenderNode *node2)
+{
+  GskConicGradientNode *self1 = (GskConicGradientNode *) node1;
+  GskConicGradientNode *self2 = (GskConicGradientNode *) node2;
+
+  if (memcmp (&self1->center, &self2->center, sizeof (graphene_point_t)) != 0 ||
+      self1->rotation != self2->rotation)
+    return FALSE;
+
+  return self1->n_stops == self2->n_stops &&
+         memcmp (self1->stops, self2->stops, sizeof (GskColorStop) * self1->n_stops) == 0;
+}
+
 /**
  * gsk_conic_gradient_node_new:
  * @bounds: the bounds of the node
@@ -1384,6 +1508,31 @@ gsk_border_node_get_colors (const GskRenderNode *node)
   return self->border_color;
 }
 
+static guint64
+gsk_border_node_hash (GskRenderNode *node,
+                      guint64        hash)
+{
+  GskBorderNode *self = (GskBorderNode *) node;
+
+  hash = gsk_hash_data (hash, &self->outline, sizeof (GskRoundedRect));
+  hash = gsk_hash_data (hash, self->border_width, sizeof (self->border_width));
+  hash = gsk_hash_data (hash, self->border_color, sizeof (self->border_color));
+
+  return hash;
+}
+
+static gboolean
+gsk_border_node_equal (GskRenderNode *node1,
+                       GskRenderNode *node2)
+{
+  GskBorderNode *self1 = (GskBorderNode *) node1;
+  GskBorderNode *self2 = (GskBorderNode *) node2;
+
+  return memcmp (&self1->outline, &self2->outline, sizeof (GskRoundedRect)) == 0 &&
+         memcmp (self1->border_width, self2->border_width, sizeof (self1->border_width)) == 0 &&
+         memcmp (self1->border_color, self2->border_color, sizeof (self1->border_color)) == 0;
+}
+
 /**
  * gsk_border_node_new:
  * @outline: a `GskRoundedRect` describing the outline of the border
@@ -1464,6 +1613,7 @@ struct _GskTextureNode
   GskRenderNode render_node;
 
   GdkTexture *texture;
+  GskScalingFilter filter;
 };
 
 static void
@@ -1489,6 +1639,8 @@ gsk_texture_node_draw (GskRenderNode *node,
   surface = gdk_texture_download_surface (self->texture);
   pattern = cairo_pattern_create_for_surface (surface);
   cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
+  if (self->filter == GSK_SCALING_FILTER_NEAREST)
+    cairo_pattern_set_filter (pattern, CAIRO_FILTER_NEAREST);
 
   cairo_matrix_init_scale (&matrix,
                            gdk_texture_get_width (self->texture) / node->bounds.size.width,
@@ -1513,12 +1665,49 @@ gsk_texture_node_diff (GskRenderNode  *node1,
 {
   GskTextureNode *self1 = (GskTextureNode *) node1;
   GskTextureNode *self2 = (GskTextureNode *) node2;
+  cairo_region_t *sub;
+  int i, n;
 
-  if (graphene_rect_equal (&node1->bounds, &node2->bounds) &&
-      self1->texture == self2->texture)
+  if (!graphene_rect_equal (&node1->bounds, &node2->bounds) ||
+      self1->filter != self2->filter)
+    {
+      gsk_render_node_diff_impossible (node1, node2, region);
+      return;
+    }
+
+  if (self1->texture == self2->texture)
     return;
 
-  gsk_render_node_diff_impossible (node1, node2, region);
+  sub = cairo_region_create ();
+  if (!gdk_texture_diff (self1->texture, self2->texture, sub))
+    {
+      cairo_region_destroy (sub);
+      gsk_render_node_diff_impossible (node1, node2, region);
+      return;
+    }
+
+  /* Map the changed texels to the node bounds. Grow by a pixel,
+   * as filtering spreads each texel into its neighbours.
+   */
+  n = cairo_region_num_rectangles (sub);
+  for (i = 0; i < n; i++)
+    {
+      cairo_rectangle_int_t rect;
+      float scale_x = node1->bounds.size.width / gdk_texture_get_width (self1->texture);
+      float scale_y = node1->bounds.size.height / gdk_texture_get_height (self1->texture);
+      int x0, y0, x1, y1;
+
+      cairo_region_get_rectangle (sub, i, &rect);
+
+      x0 = floorf (node1->bounds.origin.x + rect.x * scale_x) - 1;
+      y0 = floorf (node1->bounds.origin.y + rect.y * scale_y) - 1;
+      x1 = ceilf (node1->bounds.origin.x + (rect.x + rect.width) * scale_x) + 1;
+      y1 = ceilf (node1->bounds.origin.y + (rect.y + rect.height) * scale_y) + 1;
+
+      cairo_region_union_rectangle (region, &(cairo_rectangle_int_t) { x0, y0, x1 - x0, y1 - y0 });
+    }
+
+  cairo_region_destroy (sub);
 }
 
 /**
@@ -1537,6 +1726,60 @@ gsk_texture_node_get_texture (const GskRenderNode *node)
   return self->texture;
 }
 
+/**
+ * gsk_texture_node_get_filter:
+ * @node: (type GskTextureNode): a `GskRenderNode` of type %GSK_TEXTURE_NODE
+ *
+ * Retrieves the filter that is used when scaling the texture.
+ *
+ * Returns: the `GskScalingFilter`
+ *
+ * Since: 4.6
+ */
+GskScalingFilter
+gsk_texture_node_get_filter (const GskRenderNode *node)
+{
+  const GskTextureNode *self = (const GskTextureNode *) node;
+
+  return self->filter;
+}
+
+static guint64
+gsk_texture_node_hash (GskRenderNode *node,
+                       guint64        hash)
+{
+  GskTextureNode *self = (GskTextureNode *) node;
+
+  hash = gsk_hash_combine (hash, GPOINTER_TO_SIZE (self->texture));
+  hash = gsk_hash_combine (hash, self->filter);
+
+  return hash;
+}
+
+static gboolean
+gsk_texture_node_equal (GskRenderNode *node1,
+                        GskRenderNode *node2)
+{
+  GskTextureNode *self1 = (GskTextureNode *) node1;
+  GskTextureNode *self2 = (GskTextureNode *) node2;
+
+  return self1->texture == self2->texture &&
+         self1->filter == self2->filter;
+}
+
+static gboolean
+gsk_texture_node_get_opaque_rect (GskRenderNode   *node,
+                                  graphene_rect_t *opaque)
+{
+  GskTextureNode *self = (GskTextureNode *) node;
+
+  if (gdk_memory_format_alpha (gdk_texture_get_format (self->texture)) != GDK_MEMORY_ALPHA_OPAQUE)
+    return FALSE;
+
+  *opaque = node->bounds;
+  return TRUE;
+}
+
 /**
  * gsk_texture_node_new:
  * @texture: the `GdkTexture`
@@ -1550,17 +1793,46 @@ gsk_texture_node_get_texture (const GskRenderNode *node)
 GskRenderNode *
 gsk_texture_node_new (GdkTexture            *texture,
                       const graphene_rect_t *bounds)
+{
+  return gsk_texture_node_new_with_filter (texture, bounds, GSK_SCALING_FILTER_LINEAR);
+}
+
+/**
+ * gsk_texture_node_new_with_filter:
+ * @texture: the `GdkTexture`
+ * @bounds: the rectangle to render the texture into
+ * @filter: the filter to use when scaling the texture
+ *
+ * Creates a `GskRenderNode` that will render the given
+ * @texture into the area given by @bounds, using @filter
+ * when the texture has to be scaled.
+ *
+ * Use %GSK_SCALING_FILTER_TRILINEAR for textures that are drawn
+ * much smaller than their size, such as thumbnails of photos, and
+ * %GSK_SCALING_FILTER_NEAREST for pixel art that is zoomed in.
+ * Renderers treat the filter as a hint.
+ *
+ * Returns: (transfer full) (type GskTextureNode): A new `GskRenderNode`
+ *
+ * Since: 4.6
+ */
+GskRenderNode *
+gsk_texture_node_new_with_filter (GdkTexture            *texture,
+                                  const graphene_rect_t *bounds,
+                                  GskScalingFilter       filter)
 {
   GskTextureNode *self;
   GskRenderNode *node;
 
   g_return_val_if_fail (GDK_IS_TEXTURE (texture), NULL);
   g_return_val_if_fail (bounds != NULL, NULL);
+  g_return_val_if_fail (filter <= GSK_SCALING_FILTER_TRILINEAR, NULL);
 
   self = gsk_render_node_alloc (GSK_TEXTURE_NODE);
   node = (GskRenderNode *) self;
 
   self->texture = g_object_ref (texture);
+  self->filter = filter;
   graphene_rect_init_from_rect (&node->bounds, bounds);
 
   node->prefers_high_depth = gdk_memory_format_prefers_high_depth (gdk_texture_get_format (texture));
@@ -1672,6 +1944,7 @@ draw_shadow_corner (cairo_t               *cr,
   cairo_matrix_t matrix;
   float sx, sy;
   static GHashTable *corner_mask_cache = NULL;
+  G_LOCK_DEFINE_STATIC (corner_mask_cache);
   float max_other;
   CornerMask key;
   gboolean overlapped;
@@ -1759,6 +2032,9 @@ draw_shadow_corner (cairo_t               *cr,
    * mask, so we cache rendered masks based on the blur radius and the
    * corner radius.
    */
+  /* The cairo renderer may draw from several threads */
+  G_LOCK (corner_mask_cache);
+
   if (corner_mask_cache == NULL)
     corner_mask_cache = g_hash_table_new_full ((GHashFunc)corner_mask_hash,
                                                (GEqualFunc)corner_mask_equal,
@@ -1783,6 +2059,9 @@ draw_shadow_corner (cairo_t               *cr,
       g_hash_table_insert (corner_mask_cache, g_memdup2 (&key, sizeof (key)), mask);
     }
 
+  /* Masks are never removed from the cache */
+  G_UNLOCK (corner_mask_cache);
+
   gdk_cairo_set_source_rgba (cr, color);
   pattern = cairo_pattern_create_for_surface (mask);
   cairo_matrix_init_identity (&matrix);
@@ -1984,6 +2263,31 @@ gsk_inset_shadow_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint64
+gsk_inset_shadow_node_hash (GskRenderNode *node,
+                            guint64        hash)
+{
+  GskInsetShadowNode *self = (GskInsetShadowNode *) node;
+
+  hash = gsk_hash_data (hash, &self->outline, sizeof (GskRoundedRect));
+  hash = gsk_hash_data (hash, &self->color, sizeof (GdkRGBA));
+  hash = gsk_hash_data (hash, &self->dx, sizeof (float) * 4);
+
+  return hash;
+}
+
+static gboolean
+gsk_inset_shadow_node_equal (GskRenderNode *node1,
+                             GskRenderNode *node2)
+{
+  GskInsetShadowNode *self1 = (GskInsetShadowNode *) node1;
+  GskInsetShadowNode *self2 = (GskInsetShadowNode *) node2;
+
+  return memcmp (&self1->outline, &self2->outline, sizeof (GskRoundedRect)) == 0 &&
+         memcmp (&self1->color, &self2->color, sizeof (GdkRGBA)) == 0 &&
+         memcmp (&self1->dx, &self2->dx, sizeof (float) * 4) == 0;
+}
+
 /**
  * gsk_inset_shadow_node_new:
  * @outline: outline of the region containing the shadow
@@ -2282,6 +2586,31 @@ gsk_outset_shadow_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint64
+gsk_outset_shadow_node_hash (GskRenderNode *node,
+                             guint64        hash)
+{
+  GskOutsetShadowNode *self = (GskOutsetShadowNode *) node;
+
+  hash = gsk_hash_data (hash, &self->outline, sizeof (GskRoundedRect));
+  hash = gsk_hash_data (hash, &self->color, sizeof (GdkRGBA));
+  hash = gsk_hash_data (hash, &self->dx, sizeof (float) * 4);
+
+  return hash;
+}
+
+static gboolean
+gsk_outset_shadow_node_equal (GskRenderNode *node1,
+                              GskRenderNode *node2)
+{
+  GskOutsetShadowNode *self1 = (GskOutsetShadowNode *) node1;
+  GskOutsetShadowNode *self2 = (GskOutsetShadowNode *) node2;
+
+  return memcmp (&self1->outline, &self2->outline, sizeof (GskRoundedRect)) == 0 &&
+         memcmp (&self1->color, &self2->color, sizeof (GdkRGBA)) == 0 &&
+         memcmp (&self1->dx, &self2->dx, sizeof (float) * 4) == 0;
+}
+
 /**
  * gsk_outset_shadow_node_new:
  * @outline: outline of the region surrounded by shadow
@@ -2485,6 +2814,27 @@ gsk_cairo_node_get_surface (GskRenderNode *node)
   return self->surface;
 }
 
+static guint64
+gsk_cairo_node_hash (GskRenderNode *node,
+                     guint64        hash)
+{
+  GskCairoNode *self = (GskCairoNode *) node;
+
+  hash = gsk_hash_combine (hash, GPOINTER_TO_SIZE (self->surface));
+
+  return hash;
+}
+
+static gboolean
+gsk_cairo_node_equal (GskRenderNode *node1,
+                      GskRenderNode *node2)
+{
+  GskCairoNode *self1 = (GskCairoNode *) node1;
+  GskCairoNode *self2 = (GskCairoNode *) node2;
+
+  return self1->surface == self2->surface;
+}
+
 /**
  * gsk_cairo_node_new:
  * @bounds: the rectangle to render to
@@ -2599,10 +2949,19 @@ gsk_container_node_draw (GskRenderNode *node,
                          cairo_t       *cr)
 {
   GskContainerNode *container = (GskContainerNode *) node;
+  graphene_rect_t clip;
+  double x1, y1, x2, y2;
   guint i;
 
+  /* Skip what is clipped away, this matters for tiled rendering */
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+  graphene_rect_init (&clip, x1, y1, x2 - x1, y2 - y1);
+
   for (i = 0; i < container->n_children; i++)
     {
+      if (!graphene_rect_intersection (&container->children[i]->bounds, &clip, NULL))
+        continue;
+
       gsk_render_node_draw (container->children[i], cr);
     }
 }
@@ -2703,6 +3062,75 @@ gsk_container_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint64
+gsk_container_node_hash (GskRenderNode *node,
+                         guint64        hash)
+{
+  GskContainerNode *self = (GskContainerNode *) node;
+  guint64 child_hash;
+  guint i;
+
+  for (i = 0; i < self->n_children; i++)
+    {
+      child_hash = gsk_render_node_get_hash (self->children[i]);
+      if (child_hash == 0)
+        return 0;
+      hash = gsk_hash_combine (hash, child_hash);
+    }
+
+  return hash;
+}
+
+static gboolean
+gsk_container_node_equal (GskRenderNode *node1,
+                          GskRenderNode *node2)
+{
+  GskContainerNode *self1 = (GskContainerNode *) node1;
+  GskContainerNode *self2 = (GskContainerNode *) node2;
+
+  guint i;
+
+  if (self1->n_children != self2->n_children)
+    return FALSE;
+
+  for (i = 0; i < self1->n_children; i++)
+    {
+      if (!gsk_render_node_equal (self1->children[i], self2->children[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Only keeps the largest opaque child, merging rectangles is not
+ * worth it for the layouts we see in practice.
+ */
+static gboolean
+gsk_container_node_get_opaque_rect (GskRenderNode   *node,
+                                    graphene_rect_t *opaque)
+{
+  GskContainerNode *self = (GskContainerNode *) node;
+  graphene_rect_t child_opaque;
+  gboolean result = FALSE;
+  float area = 0;
+  guint i;
+
+  for (i = 0; i < self->n_children; i++)
+    {
+      if (!gsk_render_node_get_opaque_rect (self->children[i], &child_opaque))
+        continue;
+
+      if (child_opaque.size.width * child_opaque.size.height > area)
+        {
+          *opaque = child_opaque;
+          area = child_opaque.size.width * child_opaque.size.height;
+          result = TRUE;
+        }
+    }
+
+  return result;
+}
+
 /**
  * gsk_container_node_new:
  * @children: (array length=n_children) (transfer none): The children of the node
@@ -2940,6 +3368,56 @@ gsk_transform_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint64
+gsk_transform_node_hash (GskRenderNode *node,
+                         guint64        hash)
+{
+  GskTransformNode *self = (GskTransformNode *) node;
+  graphene_matrix_t matrix;
+  float values[16];
+  guint64 child_hash;
+
+  child_hash = gsk_render_node_get_hash (self->child);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+
+  gsk_transform_to_matrix (self->transform, &matrix);
+  graphene_matrix_to_float (&matrix, values);
+  hash = gsk_hash_data (hash, values, sizeof (values));
+
+  return hash;
+}
+
+static gboolean
+gsk_transform_node_equal (GskRenderNode *node1,
+                          GskRenderNode *node2)
+{
+  GskTransformNode *self1 = (GskTransformNode *) node1;
+  GskTransformNode *self2 = (GskTransformNode *) node2;
+
+  return gsk_transform_equal (self1->transform, self2->transform) &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
+static gboolean
+gsk_transform_node_get_opaque_rect (GskRenderNode   *node,
+                                    graphene_rect_t *opaque)
+{
+  GskTransformNode *self = (GskTransformNode *) node;
+  graphene_rect_t child_opaque;
+
+  /* Anything else does not map rectangles to rectangles */
+  if (gsk_transform_get_category (self->transform) < GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+    return FALSE;
+
+  if (!gsk_render_node_get_opaque_rect (self->child, &child_opaque))
+    return FALSE;
+
+  gsk_transform_transform_bounds (self->transform, &child_opaque, opaque);
+  return TRUE;
+}
+
 /**
  * gsk_transform_node_new:
  * @child: The node to transform
@@ -3085,6 +3563,33 @@ gsk_opacity_node_diff (GskRenderNode  *node1,
     gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint64
+gsk_opacity_node_hash (GskRenderNode *node,
+                       guint64        hash)
+{
+  GskOpacityNode *self = (GskOpacityNode *) node;
+  guint64 child_hash;
+
+  child_hash = gsk_render_node_get_hash (self->child);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+  hash = gsk_hash_data (hash, &self->opacity, sizeof (float));
+
+  return hash;
+}
+
+static gboolean
+gsk_opacity_node_equal (GskRenderNode *node1,
+                        GskRenderNode *node2)
+{
+  GskOpacityNode *self1 = (GskOpacityNode *) node1;
+  GskOpacityNode *self2 = (GskOpacityNode *) node2;
+
+  return self1->opacity == self2->opacity &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 /**
  * gsk_opacity_node_new:
  * @child: The node to draw
@@ -3280,6 +3785,39 @@ nope:
   return;
 }
 
+static guint64
+gsk_color_matrix_node_hash (GskRenderNode *node,
+                            guint64        hash)
+{
+  GskColorMatrixNode *self = (GskColorMatrixNode *) node;
+  float values[16];
+  guint64 child_hash;
+
+  child_hash = gsk_render_node_get_hash (self->child);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+
+  graphene_matrix_to_float (&self->color_matrix, values);
+  hash = gsk_hash_data (hash, values, sizeof (values));
+  graphene_vec4_to_float (&self->color_offset, values);
+  hash = gsk_hash_data (hash, values, sizeof (float) * 4);
+
+  return hash;
+}
+
+static gboolean
+gsk_color_matrix_node_equal (GskRenderNode *node1,
+                             GskRenderNode *node2)
+{
+  GskColorMatrixNode *self1 = (GskColorMatrixNode *) node1;
+  GskColorMatrixNode *self2 = (GskColorMatrixNode *) node2;
+
+  return memcmp (&self1->color_matrix, &self2->color_matrix, sizeof (graphene_matrix_t)) == 0 &&
+         memcmp (&self1->color_offset, &self2->color_offset, sizeof (graphene_vec4_t)) == 0 &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 /**
  * gsk_color_matrix_node_new:
  * @child: The node to draw
@@ -3432,6 +3970,33 @@ gsk_repeat_node_draw (GskRenderNode *node,
   cairo_fill (cr);
 }
 
+static guint64
+gsk_repeat_node_hash (GskRenderNode *node,
+                      guint64        hash)
+{
+  GskRepeatNode *self = (GskRepeatNode *) node;
+  guint64 child_hash;
+
+  child_hash = gsk_render_node_get_hash (self->child);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+  hash = gsk_hash_data (hash, &self->child_bounds, sizeof (graphene_rect_t));
+
+  return hash;
+}
+
+static gboolean
+gsk_repeat_node_equal (GskRenderNode *node1,
+                       GskRenderNode *node2)
+{
+  GskRepeatNode *self1 = (GskRepeatNode *) node1;
+  GskRepeatNode *self2 = (GskRepeatNode *) node2;
+
+  return memcmp (&self1->child_bounds, &self2->child_bounds, sizeof (graphene_rect_t)) == 0 &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 /**
  * gsk_repeat_node_new:
  * @bounds: The bounds of the area to be painted
@@ -3572,6 +4137,46 @@ gsk_clip_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint64
+gsk_clip_node_hash (GskRenderNode *node,
+                    guint64        hash)
+{
+  GskClipNode *self = (GskClipNode *) node;
+  guint64 child_hash;
+
+  child_hash = gsk_render_node_get_hash (self->child);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+  hash = gsk_hash_data (hash, &self->clip, sizeof (graphene_rect_t));
+
+  return hash;
+}
+
+static gboolean
+gsk_clip_node_equal (GskRenderNode *node1,
+                     GskRenderNode *node2)
+{
+  GskClipNode *self1 = (GskClipNode *) node1;
+  GskClipNode *self2 = (GskClipNode *) node2;
+
+  return memcmp (&self1->clip, &self2->clip, sizeof (graphene_rect_t)) == 0 &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
+static gboolean
+gsk_clip_node_get_opaque_rect (GskRenderNode   *node,
+                               graphene_rect_t *opaque)
+{
+  GskClipNode *self = (GskClipNode *) node;
+  graphene_rect_t child_opaque;
+
+  if (!gsk_render_node_get_opaque_rect (self->child, &child_opaque))
+    return FALSE;
+
+  return graphene_rect_intersection (&child_opaque, &self->clip, opaque);
+}
+
 /**
  * gsk_clip_node_new:
  * @child: The node to draw
@@ -3705,6 +4310,62 @@ gsk_rounded_clip_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint64
+gsk_rounded_clip_node_hash (GskRenderNode *node,
+                            guint64        hash)
+{
+  GskRoundedClipNode *self = (GskRoundedClipNode *) node;
+  guint64 child_hash;
+
+  child_hash = gsk_render_node_get_hash (self->child);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+  hash = gsk_hash_data (hash, &self->clip, sizeof (GskRoundedRect));
+
+  return hash;
+}
+
+static gboolean
+gsk_rounded_clip_node_equal (GskRenderNode *node1,
+                             GskRenderNode *node2)
+{
+  GskRoundedClipNode *self1 = (GskRoundedClipNode *) node1;
+  GskRoundedClipNode *self2 = (GskRoundedClipNode *) node2;
+
+  return memcmp (&self1->clip, &self2->clip, sizeof (GskRoundedRect)) == 0 &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
+static gboolean
+gsk_rounded_clip_node_get_opaque_rect (GskRenderNode   *node,
+                                       graphene_rect_t *opaque)
+{
+  GskRoundedClipNode *self = (GskRoundedClipNode *) node;
+  const GskRoundedRect *clip = &self->clip;
+  graphene_rect_t child_opaque, inner;
+  float left, right, top, bottom;
+
+  if (!gsk_render_node_get_opaque_rect (self->child, &child_opaque))
+    return FALSE;
+
+  /* The part of the clip that is not affected by any corner */
+  left = MAX (clip->corner[GSK_CORNER_TOP_LEFT].width, clip->corner[GSK_CORNER_BOTTOM_LEFT].width);
+  right = MAX (clip->corner[GSK_CORNER_TOP_RIGHT].width, clip->corner[GSK_CORNER_BOTTOM_RIGHT].width);
+  top = MAX (clip->corner[GSK_CORNER_TOP_LEFT].height, clip->corner[GSK_CORNER_TOP_RIGHT].height);
+  bottom = MAX (clip->corner[GSK_CORNER_BOTTOM_LEFT].height, clip->corner[GSK_CORNER_BOTTOM_RIGHT].height);
+
+  graphene_rect_init (&inner,
+                      clip->bounds.origin.x + left,
+                      clip->bounds.origin.y + top,
+                      clip->bounds.size.width - left - right,
+                      clip->bounds.size.height - top - bottom);
+  if (inner.size.width <= 0 || inner.size.height <= 0)
+    return FALSE;
+
+  return graphene_rect_intersection (&child_opaque, &inner, opaque);
+}
+
 /**
  * gsk_rounded_clip_node_new:
  * @child: The node to draw
@@ -3921,6 +4582,44 @@ gsk_shadow_node_get_bounds (GskShadowNode *self,
   bounds->size.height += top + bottom;
 }
 
+static guint64
+gsk_shadow_node_hash (GskRenderNode *node,
+                      guint64        hash)
+{
+  GskShadowNode *self = (GskShadowNode *) node;
+  guint64 child_hash;
+
+  child_hash = gsk_render_node_get_hash (self->child);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+  hash = gsk_hash_data (hash, self->shadows, sizeof (GskShadow) * self->n_shadows);
+
+  return hash;
+}
+
+static gboolean
+gsk_shadow_node_equal (GskRenderNode *node1,
+                       GskRenderNode *node2)
+{
+  GskShadowNode *self1 = (GskShadowNode *) node1;
+  GskShadowNode *self2 = (GskShadowNode *) node2;
+
+  return self1->n_shadows == self2->n_shadows &&
+         memcmp (self1->shadows, self2->shadows, sizeof (GskShadow) * self1->n_shadows) == 0 &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
+static gboolean
+gsk_shadow_node_get_opaque_rect (GskRenderNode   *node,
+                                 graphene_rect_t *opaque)
+{
+  GskShadowNode *self = (GskShadowNode *) node;
+
+  /* The child is drawn on top of its shadows */
+  return gsk_render_node_get_opaque_rect (self->child, opaque);
+}
+
 /**
  * gsk_shadow_node_new:
  * @child: The node to draw
@@ -4118,6 +4817,38 @@ gsk_blend_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint64
+gsk_blend_node_hash (GskRenderNode *node,
+                     guint64        hash)
+{
+  GskBlendNode *self = (GskBlendNode *) node;
+  guint64 child_hash;
+
+  child_hash = gsk_render_node_get_hash (self->bottom);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+  child_hash = gsk_render_node_get_hash (self->top);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+  hash = gsk_hash_combine (hash, self->blend_mode);
+
+  return hash;
+}
+
+static gboolean
+gsk_blend_node_equal (GskRenderNode *node1,
+                      GskRenderNode *node2)
+{
+  GskBlendNode *self1 = (GskBlendNode *) node1;
+  GskBlendNode *self2 = (GskBlendNode *) node2;
+
+  return self1->blend_mode == self2->blend_mode &&
+         gsk_render_node_equal (self1->bottom, self2->bottom) &&
+         gsk_render_node_equal (self1->top, self2->top);
+}
+
 /**
  * gsk_blend_node_new:
  * @bottom: The bottom node to be drawn
@@ -4268,6 +4999,38 @@ gsk_cross_fade_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint64
+gsk_cross_fade_node_hash (GskRenderNode *node,
+                          guint64        hash)
+{
+  GskCrossFadeNode *self = (GskCrossFadeNode *) node;
+  guint64 child_hash;
+
+  child_hash = gsk_render_node_get_hash (self->start);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+  child_hash = gsk_render_node_get_hash (self->end);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+  hash = gsk_hash_data (hash, &self->progress, sizeof (float));
+
+  return hash;
+}
+
+static gboolean
+gsk_cross_fade_node_equal (GskRenderNode *node1,
+                           GskRenderNode *node2)
+{
+  GskCrossFadeNode *self1 = (GskCrossFadeNode *) node1;
+  GskCrossFadeNode *self2 = (GskCrossFadeNode *) node2;
+
+  return self1->progress == self2->progress &&
+         gsk_render_node_equal (self1->start, self2->start) &&
+         gsk_render_node_equal (self1->end, self2->end);
+}
+
 /**
  * gsk_cross_fade_node_new:
  * @start: The start node to be drawn
@@ -4443,6 +5206,63 @@ gsk_text_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+static guint64
+gsk_text_node_hash (GskRenderNode *node,
+                    guint64        hash)
+{
+  GskTextNode *self = (GskTextNode *) node;
+  guint i;
+
+  hash = gsk_hash_combine (hash, GPOINTER_TO_SIZE (self->font));
+  hash = gsk_hash_data (hash, &self->color, sizeof (GdkRGBA));
+  hash = gsk_hash_data (hash, &self->offset, sizeof (graphene_point_t));
+
+  for (i = 0; i < self->num_glyphs; i++)
+    {
+      const PangoGlyphInfo *info = &self->glyphs[i];
+
+      hash = gsk_hash_combine (hash, info->glyph);
+      hash = gsk_hash_combine (hash, (guint32) info->geometry.width);
+      hash = gsk_hash_combine (hash, (guint32) info->geometry.x_offset);
+      hash = gsk_hash_combine (hash, (guint32) info->geometry.y_offset);
+      hash = gsk_hash_combine (hash, (info->attr.is_cluster_start << 1) | info->attr.is_color);
+    }
+
+  return hash;
+}
+
+static gboolean
+gsk_text_node_equal (GskRenderNode *node1,
+                     GskRenderNode *node2)
+{
+  GskTextNode *self1 = (GskTextNode *) node1;
+  GskTextNode *self2 = (GskTextNode *) node2;
+
+  guint i;
+
+  if (self1->font != self2->font ||
+      memcmp (&self1->color, &self2->color, sizeof (GdkRGBA)) != 0 ||
+      memcmp (&self1->offset, &self2->offset, sizeof (graphene_point_t)) != 0 ||
+      self1->num_glyphs != self2->num_glyphs)
+    return FALSE;
+
+  for (i = 0; i < self1->num_glyphs; i++)
+    {
+      const PangoGlyphInfo *info1 = &self1->glyphs[i];
+      const PangoGlyphInfo *info2 = &self2->glyphs[i];
+
+      if (info1->glyph != info2->glyph ||
+          info1->geometry.width != info2->geometry.width ||
+          info1->geometry.x_offset != info2->geometry.x_offset ||
+          info1->geometry.y_offset != info2->geometry.y_offset ||
+          info1->attr.is_cluster_start != info2->attr.is_cluster_start ||
+          info1->attr.is_color != info2->attr.is_color)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 /**
  * gsk_text_node_new:
  * @font: the `PangoFont` containing the glyphs
@@ -4862,6 +5682,33 @@ gsk_blur_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint64
+gsk_blur_node_hash (GskRenderNode *node,
+                    guint64        hash)
+{
+  GskBlurNode *self = (GskBlurNode *) node;
+  guint64 child_hash;
+
+  child_hash = gsk_render_node_get_hash (self->child);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+  hash = gsk_hash_data (hash, &self->radius, sizeof (float));
+
+  return hash;
+}
+
+static gboolean
+gsk_blur_node_equal (GskRenderNode *node1,
+                     GskRenderNode *node2)
+{
+  GskBlurNode *self1 = (GskBlurNode *) node1;
+  GskBlurNode *self2 = (GskBlurNode *) node2;
+
+  return self1->radius == self2->radius &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 /**
  * gsk_blur_node_new:
  * @child: the child node to blur
@@ -4990,6 +5837,41 @@ gsk_debug_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff (self1->child, self2->child, region);
 }
 
+static guint64
+gsk_debug_node_hash (GskRenderNode *node,
+                     guint64        hash)
+{
+  GskDebugNode *self = (GskDebugNode *) node;
+  guint64 child_hash;
+
+  /* The message does not influence rendering */
+  child_hash = gsk_render_node_get_hash (self->child);
+  if (child_hash == 0)
+    return 0;
+  hash = gsk_hash_combine (hash, child_hash);
+
+  return hash;
+}
+
+static gboolean
+gsk_debug_node_equal (GskRenderNode *node1,
+                      GskRenderNode *node2)
+{
+  GskDebugNode *self1 = (GskDebugNode *) node1;
+  GskDebugNode *self2 = (GskDebugNode *) node2;
+
+  return gsk_render_node_equal (self1->child, self2->child);
+}
+
+static gboolean
+gsk_debug_node_get_opaque_rect (GskRenderNode   *node,
+                                graphene_rect_t *opaque)
+{
+  GskDebugNode *self = (GskDebugNode *) node;
+
+  return gsk_render_node_get_opaque_rect (self->child, opaque);
+}
+
 /**
  * gsk_debug_node_new:
  * @child: The child to add debug info for
@@ -5125,6 +6007,53 @@ gsk_gl_shader_node_diff (GskRenderNode  *node1,
     }
 }
 
+static guint64
+gsk_gl_shader_node_hash (GskRenderNode *node,
+                         guint64        hash)
+{
+  GskGLShaderNode *self = (GskGLShaderNode *) node;
+  guint64 child_hash;
+  guint i;
+
+  hash = gsk_hash_combine (hash, GPOINTER_TO_SIZE (self->shader));
+  hash = gsk_hash_data (hash,
+                        g_bytes_get_data (self->args, NULL),
+                        g_bytes_get_size (self->args));
+
+  for (i = 0; i < self->n_children; i++)
+    {
+      child_hash = gsk_render_node_get_hash (self->children[i]);
+      if (child_hash == 0)
+        return 0;
+      hash = gsk_hash_combine (hash, child_hash);
+    }
+
+  return hash;
+}
+
+static gboolean
+gsk_gl_shader_node_equal (GskRenderNode *node1,
+                          GskRenderNode *node2)
+{
+  GskGLShaderNode *self1 = (GskGLShaderNode *) node1;
+  GskGLShaderNode *self2 = (GskGLShaderNode *) node2;
+
+  guint i;
+
+  if (self1->shader != self2->shader ||
+      !g_bytes_equal (self1->args, self2->args) ||
+      self1->n_children != self2->n_children)
+    return FALSE;
+
+  for (i = 0; i < self1->n_children; i++)
+    {
+      if (!gsk_render_node_equal (self1->children[i], self2->children[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 /**
  * gsk_gl_shader_node_new:
  * @shader: the `GskGLShader`
@@ -5313,6 +6242,9 @@ gsk_render_node_init_types_once (void)
       gsk_container_node_draw,
       NULL,
       gsk_container_node_diff,
+      gsk_container_node_hash,
+      gsk_container_node_equal,
+      gsk_container_node_get_opaque_rect,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskContainerNode"), &node_info);
@@ -5329,6 +6261,8 @@ gsk_render_node_init_types_once (void)
       gsk_cairo_node_draw,
       NULL,
       NULL,
+      gsk_cairo_node_hash,
+      gsk_cairo_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskCairoNode"), &node_info);
@@ -5345,6 +6279,9 @@ gsk_render_node_init_types_once (void)
       gsk_color_node_draw,
       NULL,
       gsk_color_node_diff,
+      gsk_color_node_hash,
+      gsk_color_node_equal,
+      gsk_color_node_get_opaque_rect,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskColorNode"), &node_info);
@@ -5361,6 +6298,8 @@ gsk_render_node_init_types_once (void)
       gsk_linear_gradient_node_draw,
       NULL,
       gsk_linear_gradient_node_diff,
+      gsk_linear_gradient_node_hash,
+      gsk_linear_gradient_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskLinearGradientNode"), &node_info);
@@ -5377,6 +6316,8 @@ gsk_render_node_init_types_once (void)
       gsk_linear_gradient_node_draw,
       NULL,
       gsk_linear_gradient_node_diff,
+      gsk_linear_gradient_node_hash,
+      gsk_linear_gradient_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskRepeatingLinearGradientNode"), &node_info);
@@ -5393,6 +6334,8 @@ gsk_render_node_init_types_once (void)
       gsk_radial_gradient_node_draw,
       NULL,
       gsk_radial_gradient_node_diff,
+      gsk_radial_gradient_node_hash,
+      gsk_radial_gradient_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskRadialGradientNode"), &node_info);
@@ -5409,6 +6352,8 @@ gsk_render_node_init_types_once (void)
       gsk_radial_gradient_node_draw,
       NULL,
       gsk_radial_gradient_node_diff,
+      gsk_radial_gradient_node_hash,
+      gsk_radial_gradient_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskRepeatingRadialGradientNode"), &node_info);
@@ -5425,6 +6370,8 @@ gsk_render_node_init_types_once (void)
       gsk_conic_gradient_node_draw,
       NULL,
       gsk_conic_gradient_node_diff,
+      gsk_conic_gradient_node_hash,
+      gsk_conic_gradient_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskConicGradientNode"), &node_info);
@@ -5441,6 +6388,8 @@ gsk_render_node_init_types_once (void)
       gsk_border_node_draw,
       NULL,
       gsk_border_node_diff,
+      gsk_border_node_hash,
+      gsk_border_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskBorderNode"), &node_info);
@@ -5457,6 +6406,9 @@ gsk_render_node_init_types_once (void)
       gsk_texture_node_draw,
       NULL,
       gsk_texture_node_diff,
+      gsk_texture_node_hash,
+      gsk_texture_node_equal,
+      gsk_texture_node_get_opaque_rect,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskTextureNode"), &node_info);
@@ -5473,6 +6425,8 @@ gsk_render_node_init_types_once (void)
       gsk_inset_shadow_node_draw,
       NULL,
       gsk_inset_shadow_node_diff,
+      gsk_inset_shadow_node_hash,
+      gsk_inset_shadow_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskInsetShadowNode"), &node_info);
@@ -5489,6 +6443,8 @@ gsk_render_node_init_types_once (void)
       gsk_outset_shadow_node_draw,
       NULL,
       gsk_outset_shadow_node_diff,
+      gsk_outset_shadow_node_hash,
+      gsk_outset_shadow_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskOutsetShadowNode"), &node_info);
@@ -5505,6 +6461,9 @@ gsk_render_node_init_types_once (void)
       gsk_transform_node_draw,
       gsk_transform_node_can_diff,
       gsk_transform_node_diff,
+      gsk_transform_node_hash,
+      gsk_transform_node_equal,
+      gsk_transform_node_get_opaque_rect,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskTransformNode"), &node_info);
@@ -5521,6 +6480,8 @@ gsk_render_node_init_types_once (void)
       gsk_opacity_node_draw,
       NULL,
       gsk_opacity_node_diff,
+      gsk_opacity_node_hash,
+      gsk_opacity_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskOpacityNode"), &node_info);
@@ -5537,6 +6498,8 @@ gsk_render_node_init_types_once (void)
       gsk_color_matrix_node_draw,
       NULL,
       gsk_color_matrix_node_diff,
+      gsk_color_matrix_node_hash,
+      gsk_color_matrix_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskColorMatrixNode"), &node_info);
@@ -5553,6 +6516,8 @@ gsk_render_node_init_types_once (void)
       gsk_repeat_node_draw,
       NULL,
       NULL,
+      gsk_repeat_node_hash,
+      gsk_repeat_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskRepeatNode"), &node_info);
@@ -5569,6 +6534,9 @@ gsk_render_node_init_types_once (void)
       gsk_clip_node_draw,
       NULL,
       gsk_clip_node_diff,
+      gsk_clip_node_hash,
+      gsk_clip_node_equal,
+      gsk_clip_node_get_opaque_rect,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskClipNode"), &node_info);
@@ -5585,6 +6553,9 @@ gsk_render_node_init_types_once (void)
       gsk_rounded_clip_node_draw,
       NULL,
       gsk_rounded_clip_node_diff,
+      gsk_rounded_clip_node_hash,
+      gsk_rounded_clip_node_equal,
+      gsk_rounded_clip_node_get_opaque_rect,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskRoundedClipNode"), &node_info);
@@ -5601,6 +6572,9 @@ gsk_render_node_init_types_once (void)
       gsk_shadow_node_draw,
       NULL,
       gsk_shadow_node_diff,
+      gsk_shadow_node_hash,
+      gsk_shadow_node_equal,
+      gsk_shadow_node_get_opaque_rect,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskShadowNode"), &node_info);
@@ -5617,6 +6591,8 @@ gsk_render_node_init_types_once (void)
       gsk_blend_node_draw,
       NULL,
       gsk_blend_node_diff,
+      gsk_blend_node_hash,
+      gsk_blend_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskBlendNode"), &node_info);
@@ -5633,6 +6609,8 @@ gsk_render_node_init_types_once (void)
       gsk_cross_fade_node_draw,
       NULL,
       gsk_cross_fade_node_diff,
+      gsk_cross_fade_node_hash,
+      gsk_cross_fade_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskCrossFadeNode"), &node_info);
@@ -5649,6 +6627,8 @@ gsk_render_node_init_types_once (void)
       gsk_text_node_draw,
       NULL,
       gsk_text_node_diff,
+      gsk_text_node_hash,
+      gsk_text_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskTextNode"), &node_info);
@@ -5665,6 +6645,8 @@ gsk_render_node_init_types_once (void)
       gsk_blur_node_draw,
       NULL,
       gsk_blur_node_diff,
+      gsk_blur_node_hash,
+      gsk_blur_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskBlurNode"), &node_info);
@@ -5681,6 +6663,8 @@ gsk_render_node_init_types_once (void)
       gsk_gl_shader_node_draw,
       NULL,
       gsk_gl_shader_node_diff,
+      gsk_gl_shader_node_hash,
+      gsk_gl_shader_node_equal,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskGLShaderNode"), &node_info);
@@ -5697,6 +6681,9 @@ gsk_render_node_init_types_once (void)
       gsk_debug_node_draw,
       gsk_debug_node_can_diff,
       gsk_debug_node_diff,
+      gsk_debug_node_hash,
+      gsk_debug_node_equal,
+      gsk_debug_node_get_opaque_rect,
     };
 
     GType node_type = gsk_render_node_type_register_static (I_("GskDebugNode"), &node_info);
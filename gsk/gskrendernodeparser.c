@@ -606,6 +606,34 @@ static const struct
   { GSK_BLEND_MODE_LUMINOSITY, "luminosity" }
 };
 
+static const struct
+{
+  GskScalingFilter filter;
+  const char *name;
+} scaling_filters[] = {
+  { GSK_SCALING_FILTER_LINEAR, "linear" },
+  { GSK_SCALING_FILTER_NEAREST, "nearest" },
+  { GSK_SCALING_FILTER_TRILINEAR, "trilinear" },
+};
+
+static gboolean
+parse_scaling_filter (GtkCssParser *parser,
+                      gpointer      out_filter)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (scaling_filters); i++)
+    {
+      if (gtk_css_parser_try_ident (parser, scaling_filters[i].name))
+        {
+          *(GskScalingFilter *) out_filter = scaling_filters[i].filter;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
 static gboolean
 parse_blend_mode (GtkCssParser *parser,
                   gpointer      out_mode)
@@ -1355,9 +1383,11 @@ parse_texture_node (GtkCssParser *parser)
 {
   graphene_rect_t bounds = GRAPHENE_RECT_INIT (0, 0, 50, 50);
   GdkTexture *texture = NULL;
+  GskScalingFilter filter = GSK_SCALING_FILTER_LINEAR;
   const Declaration declarations[] = {
     { "bounds", parse_rect, NULL, &bounds },
-    { "texture", parse_texture, clear_texture, &texture }
+    { "texture", parse_texture, clear_texture, &texture },
+    { "filter", parse_scaling_filter, NULL, &filter }
   };
   GskRenderNode *node;
 
@@ -1366,7 +1396,7 @@ parse_texture_node (GtkCssParser *parser)
   if (texture == NULL)
     texture = create_default_texture ();
 
-  node = gsk_texture_node_new (texture, &bounds);
+  node = gsk_texture_node_new_with_filter (texture, &bounds, filter);
   g_object_unref (texture);
 
   return node;
@@ -2706,6 +2736,14 @@ render_node_print (Printer       *p,
         append_escaping_newlines (p->str, b64);
         g_free (b64);
         g_string_append (p->str, "\");\n");
+
+        if (gsk_texture_node_get_filter (node) != GSK_SCALING_FILTER_LINEAR)
+          {
+            _indent (p);
+            g_string_append_printf (p->str, "filter: %s;\n",
+                                    scaling_filters[gsk_texture_node_get_filter (node)].name);
+          }
+
         end_node (p);
 
         g_bytes_unref (bytes);
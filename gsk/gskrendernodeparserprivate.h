@@ -8,4 +8,35 @@ GskRenderNode * gsk_render_node_deserialize_from_bytes  (GBytes            *byte
                                                          GskParseErrorFunc  error_func,
                                                          gpointer           user_data);
 
+GBytes *        gsk_render_node_serialize_binary        (GskRenderNode     *node);
+gboolean        gsk_render_node_is_binary               (GBytes            *bytes);
+GskRenderNode * gsk_render_node_deserialize_binary      (GBytes            *bytes,
+                                                         GskParseErrorFunc  error_func,
+                                                         gpointer           user_data);
+
+typedef struct _GskRenderNodeWriter GskRenderNodeWriter;
+
+GskRenderNodeWriter *
+                gsk_render_node_writer_new              (GOutputStream     *stream);
+void            gsk_render_node_writer_free             (GskRenderNodeWriter *self);
+guint32         gsk_render_node_writer_add_frame        (GskRenderNodeWriter *self,
+                                                         GskRenderNode       *node,
+                                                         GError             **error);
+
+typedef struct _GskRenderNodeReader GskRenderNodeReader;
+
+GskRenderNodeReader *
+                gsk_render_node_reader_new              (GBytes            *bytes,
+                                                         GError           **error);
+GskRenderNodeReader *
+                gsk_render_node_reader_ref              (GskRenderNodeReader *self);
+void            gsk_render_node_reader_unref            (GskRenderNodeReader *self);
+gsize           gsk_render_node_reader_get_size         (GskRenderNodeReader *self);
+guint           gsk_render_node_reader_get_n_frames     (GskRenderNodeReader *self);
+guint32         gsk_render_node_reader_get_frame        (GskRenderNodeReader *self,
+                                                         guint                position);
+GskRenderNode * gsk_render_node_reader_load             (GskRenderNodeReader *self,
+                                                         guint32              offset,
+                                                         GError             **error);
+
 #endif
@@ -7,6 +7,8 @@
 G_BEGIN_DECLS
 
 typedef struct _GskRenderNodeClass GskRenderNodeClass;
+typedef struct _GskRenderNodeArena GskRenderNodeArena;
+typedef struct _GskRenderNodeChunk GskRenderNodeChunk;
 
 /* Keep this in sync with the GskRenderNodeType enumeration.
  *
@@ -28,7 +30,14 @@ struct _GskRenderNode
 
   graphene_rect_t bounds;
 
+  /* The arena chunk the node was allocated from, or %NULL */
+  GskRenderNodeChunk *chunk;
+
+  /* Content fingerprint, see gsk_render_node_get_hash() */
+  guint64 hash;
+
   guint prefers_high_depth : 1;
+  guint hash_valid : 1;
 };
 
 struct _GskRenderNodeClass
@@ -45,6 +54,12 @@ struct _GskRenderNodeClass
   void            (* diff)        (GskRenderNode  *node1,
                                    GskRenderNode  *node2,
                                    cairo_region_t *region);
+  guint64         (* hash)        (GskRenderNode  *node,
+                                   guint64         seed);
+  gboolean        (* equal)       (GskRenderNode  *node1,
+                                   GskRenderNode  *node2);
+  gboolean        (* get_opaque_rect) (GskRenderNode   *node,
+                                       graphene_rect_t *opaque);
 };
 
 /*< private >
@@ -59,6 +74,12 @@ struct _GskRenderNodeClass
  *   unset, gsk_render_node_can_diff_true() will be used
  * @diff: (nullable): the function called by gsk_render_node_diff(); if unset,
  *   gsk_render_node_diff_impossible() will be used
+ * @hash: (nullable): the function called by gsk_render_node_get_hash() to mix
+ *   the node's contents into the seed; if unset, the node has no fingerprint
+ * @equal: (nullable): the function called by gsk_render_node_equal() to compare
+ *   the contents of two nodes of this type; if unset, nodes are never equal
+ * @get_opaque_rect: (nullable): the function called by
+ *   gsk_render_node_get_opaque_rect(); if unset, the node is never opaque
  *
  * A struction that contains the type information for a `GskRenderNode` subclass,
  * to be used by gsk_render_node_type_register_static().
@@ -78,6 +99,12 @@ typedef struct
   void            (* diff)          (GskRenderNode        *node1,
                                      GskRenderNode        *node2,
                                      cairo_region_t       *region);
+  guint64         (* hash)          (GskRenderNode        *node,
+                                     guint64               seed);
+  gboolean        (* equal)         (GskRenderNode        *node1,
+                                     GskRenderNode        *node2);
+  gboolean        (* get_opaque_rect) (GskRenderNode      *node,
+                                       graphene_rect_t    *opaque);
 } GskRenderNodeTypeInfo;
 
 void            gsk_render_node_init_types              (void);
@@ -87,11 +114,23 @@ GType           gsk_render_node_type_register_static    (const char
 
 gpointer        gsk_render_node_alloc                   (GskRenderNodeType            node_type);
 
+GskRenderNodeArena *
+                gsk_render_node_arena_new               (void);
+void            gsk_render_node_arena_free              (GskRenderNodeArena          *arena);
+GskRenderNodeArena *
+                gsk_render_node_arena_push              (GskRenderNodeArena          *arena);
+void            gsk_render_node_arena_pop               (GskRenderNodeArena          *previous);
+
 gboolean        gsk_render_node_can_diff                (const GskRenderNode         *node1,
                                                          const GskRenderNode         *node2) G_GNUC_PURE;
 void            gsk_render_node_diff                    (GskRenderNode               *node1,
                                                          GskRenderNode               *node2,
                                                          cairo_region_t              *region);
+guint64         gsk_render_node_get_hash                (GskRenderNode               *node);
+gboolean        gsk_render_node_equal                   (GskRenderNode               *node1,
+                                                         GskRenderNode               *node2);
+gboolean        gsk_render_node_get_opaque_rect         (GskRenderNode               *node,
+                                                         graphene_rect_t             *opaque);
 void            gsk_render_node_diff_impossible         (GskRenderNode               *node1,
                                                          GskRenderNode               *node2,
                                                          cairo_region_t              *region);
@@ -113,6 +152,32 @@ void             gsk_transform_node_get_translate       (const GskRenderNode *no
                                                          float               *dy);
 gboolean       gsk_render_node_prefers_high_depth       (const GskRenderNode *node);
 
+/* Helpers for the hash vfunc */
+static inline guint64
+gsk_hash_combine (guint64 hash,
+                  guint64 value)
+{
+  return hash ^ (value + G_GUINT64_CONSTANT (0x9e3779b97f4a7c15) + (hash << 6) + (hash >> 2));
+}
+
+static inline guint64
+gsk_hash_data (guint64       hash,
+               gconstpointer data,
+               gsize         size)
+{
+  const guchar *bytes = data;
+  gsize i;
+
+  /* FNV-1a */
+  for (i = 0; i < size; i++)
+    {
+      hash ^= bytes[i];
+      hash *= G_GUINT64_CONSTANT (0x100000001b3);
+    }
+
+  return hash;
+}
+
 
 G_END_DECLS
 
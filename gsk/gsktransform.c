@@ -36,6 +36,8 @@
 
 #include "gsktransformprivate.h"
 
+#include <string.h>
+
 /* {{{ Boilerplate */
 
 struct _GskTransformClass
@@ -126,6 +128,9 @@ gsk_transform_finalize (GskTransform *self)
 {
   self->transform_class->finalize (self);
 
+  if (self->matrix)
+    graphene_matrix_free (self->matrix);
+
   gsk_transform_unref (self->next);
 }
 
@@ -1621,17 +1626,28 @@ void
 gsk_transform_to_matrix (GskTransform      *self,
                          graphene_matrix_t *out_matrix)
 {
-  graphene_matrix_t m;
-
   if (self == NULL)
     {
       graphene_matrix_init_identity (out_matrix);
       return;
     }
 
-  gsk_transform_to_matrix (self->next, out_matrix);
-  self->transform_class->to_matrix (self, &m);
-  graphene_matrix_multiply (&m, out_matrix, out_matrix);
+  /* Transforms are immutable, so the product of the chain is computed
+   * once and kept around.
+   */
+  if (g_once_init_enter (&self->matrix))
+    {
+      graphene_matrix_t *matrix = graphene_matrix_alloc ();
+      graphene_matrix_t m;
+
+      gsk_transform_to_matrix (self->next, matrix);
+      self->transform_class->to_matrix (self, &m);
+      graphene_matrix_multiply (&m, matrix, matrix);
+
+      g_once_init_leave (&self->matrix, matrix);
+    }
+
+  graphene_matrix_init_from_matrix (out_matrix, self->matrix);
 }
 
 /**
@@ -1789,6 +1805,29 @@ gsk_transform_to_2d_components (GskTransform *self,
     }
 }
 
+/* Flattens the chain of a 2D affine transform, once. The factors
+ * are computed in the same order as walking the chain would, so
+ * the result is identical.
+ */
+static void
+gsk_transform_ensure_affine (GskTransform *self)
+{
+  if (g_once_init_enter (&self->affine_valid))
+    {
+      float scale_x, scale_y, dx, dy;
+
+      gsk_transform_to_affine (self->next, &scale_x, &scale_y, &dx, &dy);
+      self->transform_class->apply_affine (self, &scale_x, &scale_y, &dx, &dy);
+
+      self->scale_x = scale_x;
+      self->scale_y = scale_y;
+      self->dx = dx;
+      self->dy = dy;
+
+      g_once_init_leave (&self->affine_valid, 1);
+    }
+}
+
 /**
  * gsk_transform_to_affine:
  * @self: a `GskTransform`
@@ -1840,13 +1879,12 @@ gsk_transform_to_affine (GskTransform *self,
       return;
     }
 
-  gsk_transform_to_affine (self->next,
-                           out_scale_x, out_scale_y,
-                           out_dx, out_dy);
+  gsk_transform_ensure_affine (self);
 
-  self->transform_class->apply_affine (self,
-                                       out_scale_x, out_scale_y,
-                                       out_dx, out_dy);
+  *out_scale_x = self->scale_x;
+  *out_scale_y = self->scale_y;
+  *out_dx = self->dx;
+  *out_dy = self->dy;
 }
 
 /**
@@ -1886,9 +1924,13 @@ gsk_transform_to_translate (GskTransform *self,
       return;
     }
 
-  gsk_transform_to_translate (self->next, out_dx, out_dy);
+  /* For translations the scale stays exactly 1, so the affine
+   * factors have the same offsets as adding up the translations.
+   */
+  gsk_transform_ensure_affine (self);
 
-  self->transform_class->apply_translate (self, out_dx, out_dy);
+  *out_dx = self->dx;
+  *out_dy = self->dy;
 }
 
 /**
@@ -2034,10 +2076,33 @@ gsk_transform_transform_bounds (GskTransform          *self,
                                 const graphene_rect_t *rect,
                                 graphene_rect_t       *out_rect)
 {
+  gsk_transform_transform_bounds_n (self, rect, out_rect, 1);
+}
+
+/*< private >
+ * gsk_transform_transform_bounds_n:
+ * @self: a `GskTransform`
+ * @rects: (array length=n_rects): the rectangles to transform
+ * @out_rects: (array length=n_rects): return locations for the bounds,
+ *   may be the same as @rects
+ * @n_rects: the number of rectangles
+ *
+ * Like gsk_transform_transform_bounds(), for many rectangles at once.
+ * The transform is only flattened once for all of them.
+ */
+void
+gsk_transform_transform_bounds_n (GskTransform          *self,
+                                  const graphene_rect_t *rects,
+                                  graphene_rect_t       *out_rects,
+                                  gsize                  n_rects)
+{
+  gsize i;
+
   switch (gsk_transform_get_category (self))
     {
     case GSK_TRANSFORM_CATEGORY_IDENTITY:
-      graphene_rect_init_from_rect (out_rect, rect);
+      if (out_rects != rects)
+        memcpy (out_rects, rects, sizeof (graphene_rect_t) * n_rects);
       break;
 
     case GSK_TRANSFORM_CATEGORY_2D_TRANSLATE:
@@ -2045,11 +2110,12 @@ gsk_transform_transform_bounds (GskTransform          *self,
         float dx, dy;
 
         gsk_transform_to_translate (self, &dx, &dy);
-        graphene_rect_init (out_rect,
-                            rect->origin.x + dx,
-                            rect->origin.y + dy,
-                            rect->size.width,
-                            rect->size.height);
+        for (i = 0; i < n_rects; i++)
+          graphene_rect_init (&out_rects[i],
+                              rects[i].origin.x + dx,
+                              rects[i].origin.y + dy,
+                              rects[i].size.width,
+                              rects[i].size.height);
       }
     break;
 
@@ -2059,11 +2125,12 @@ gsk_transform_transform_bounds (GskTransform          *self,
 
         gsk_transform_to_affine (self, &scale_x, &scale_y, &dx, &dy);
 
-        graphene_rect_init (out_rect,
-                            (rect->origin.x * scale_x) + dx,
-                            (rect->origin.y * scale_y) + dy,
-                            rect->size.width * scale_x,
-                            rect->size.height * scale_y);
+        for (i = 0; i < n_rects; i++)
+          graphene_rect_init (&out_rects[i],
+                              (rects[i].origin.x * scale_x) + dx,
+                              (rects[i].origin.y * scale_y) + dy,
+                              rects[i].size.width * scale_x,
+                              rects[i].size.height * scale_y);
       }
     break;
 
@@ -2076,7 +2143,8 @@ gsk_transform_transform_bounds (GskTransform          *self,
         graphene_matrix_t mat;
 
         gsk_transform_to_matrix (self, &mat);
-        gsk_matrix_transform_bounds (&mat, rect, out_rect);
+        for (i = 0; i < n_rects; i++)
+          gsk_matrix_transform_bounds (&mat, &rects[i], &out_rects[i]);
       }
       break;
     }
@@ -2096,10 +2164,33 @@ gsk_transform_transform_point (GskTransform           *self,
                                const graphene_point_t *point,
                                graphene_point_t       *out_point)
 {
+  gsk_transform_transform_points (self, point, out_point, 1);
+}
+
+/*< private >
+ * gsk_transform_transform_points:
+ * @self: a `GskTransform`
+ * @points: (array length=n_points): the points to transform
+ * @out_points: (array length=n_points): return locations for the
+ *   transformed points, may be the same as @points
+ * @n_points: the number of points
+ *
+ * Like gsk_transform_transform_point(), for many points at once.
+ * The transform is only flattened once for all of them.
+ */
+void
+gsk_transform_transform_points (GskTransform           *self,
+                                const graphene_point_t *points,
+                                graphene_point_t       *out_points,
+                                gsize                   n_points)
+{
+  gsize i;
+
   switch (gsk_transform_get_category (self))
     {
     case GSK_TRANSFORM_CATEGORY_IDENTITY:
-      *out_point = *point;
+      if (out_points != points)
+        memcpy (out_points, points, sizeof (graphene_point_t) * n_points);
       break;
 
     case GSK_TRANSFORM_CATEGORY_2D_TRANSLATE:
@@ -2107,8 +2198,11 @@ gsk_transform_transform_point (GskTransform           *self,
         float dx, dy;
 
         gsk_transform_to_translate (self, &dx, &dy);
-        out_point->x = point->x + dx;
-        out_point->y = point->y + dy;
+        for (i = 0; i < n_points; i++)
+          {
+            out_points[i].x = points[i].x + dx;
+            out_points[i].y = points[i].y + dy;
+          }
       }
     break;
 
@@ -2118,8 +2212,11 @@ gsk_transform_transform_point (GskTransform           *self,
 
         gsk_transform_to_affine (self, &scale_x, &scale_y, &dx, &dy);
 
-        out_point->x = (point->x * scale_x) + dx;
-        out_point->y = (point->y * scale_y) + dy;
+        for (i = 0; i < n_points; i++)
+          {
+            out_points[i].x = (points[i].x * scale_x) + dx;
+            out_points[i].y = (points[i].y * scale_y) + dy;
+          }
       }
     break;
 
@@ -2132,7 +2229,8 @@ gsk_transform_transform_point (GskTransform           *self,
         graphene_matrix_t mat;
 
         gsk_transform_to_matrix (self, &mat);
-        gsk_matrix_transform_point (&mat, point, out_point);
+        for (i = 0; i < n_points; i++)
+          gsk_matrix_transform_point (&mat, &points[i], &out_points[i]);
       }
       break;
     }
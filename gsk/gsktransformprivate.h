@@ -36,6 +36,11 @@ struct _GskTransform
 
   GskTransformCategory category;
   GskTransform *next;
+
+  /* The whole chain flattened, computed on first use */
+  gsize affine_valid;
+  float scale_x, scale_y, dx, dy;
+  graphene_matrix_t *matrix;
 };
 
 gboolean                gsk_transform_parser_parse              (GtkCssParser           *parser,
@@ -54,6 +59,15 @@ void gsk_matrix_transform_rect    (const graphene_matrix_t  *m,
                                    const graphene_rect_t    *r,
                                    graphene_quad_t          *res);
 
+void gsk_transform_transform_bounds_n (GskTransform           *self,
+                                       const graphene_rect_t  *rects,
+                                       graphene_rect_t        *out_rects,
+                                       gsize                   n_rects);
+void gsk_transform_transform_points   (GskTransform           *self,
+                                       const graphene_point_t *points,
+                                       graphene_point_t       *out_points,
+                                       gsize                   n_points);
+
 #define gsk_transform_get_category(t) ((t) ? (t)->category : GSK_TRANSFORM_CATEGORY_IDENTITY)
 
 G_END_DECLS
@@ -16,6 +16,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanBlendModePipeline, gsk_vulkan_blend_mode_pipeline
 
 GskVulkanPipeline * gsk_vulkan_blend_mode_pipeline_new                 (GdkVulkanContext           *context,
                                                                         VkPipelineLayout            layout,
+                                                                        VkPipelineCache             cache,
                                                                         const char                 *shader_name,
                                                                         VkRenderPass                render_pass);
 
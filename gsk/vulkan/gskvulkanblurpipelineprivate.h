@@ -15,6 +15,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanBlurPipeline, gsk_vulkan_blur_pipeline, GSK, VULK
 
 GskVulkanPipeline *     gsk_vulkan_blur_pipeline_new                   (GdkVulkanContext        *context,
                                                                         VkPipelineLayout         layout,
+                                                                        VkPipelineCache          cache,
                                                                         const char              *shader_name,
                                                                         VkRenderPass             render_pass);
 
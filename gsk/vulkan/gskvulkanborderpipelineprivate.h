@@ -16,6 +16,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanBorderPipeline, gsk_vulkan_border_pipeline, GSK,
 
 GskVulkanPipeline *     gsk_vulkan_border_pipeline_new                  (GdkVulkanContext               *context,
                                                                          VkPipelineLayout                layout,
+                                                                         VkPipelineCache                 cache,
                                                                          const char                     *shader_name,
                                                                          VkRenderPass                    render_pass);
 
@@ -16,6 +16,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanBoxShadowPipeline, gsk_vulkan_box_shadow_pipeline
 
 GskVulkanPipeline *     gsk_vulkan_box_shadow_pipeline_new              (GdkVulkanContext               *context,
                                                                          VkPipelineLayout                layout,
+                                                                         VkPipelineCache                 cache,
                                                                          const char                     *shader_name,
                                                                          VkRenderPass                    render_pass);
 
@@ -15,6 +15,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanColorPipeline, gsk_vulkan_color_pipeline, GSK, VU
 
 GskVulkanPipeline *     gsk_vulkan_color_pipeline_new                   (GdkVulkanContext               *context,
                                                                          VkPipelineLayout                layout,
+                                                                         VkPipelineCache                 cache,
                                                                          const char                     *shader_name,
                                                                          VkRenderPass                    render_pass);
 
@@ -78,10 +78,11 @@ gsk_vulkan_color_text_pipeline_init (GskVulkanColorTextPipeline *self)
 GskVulkanPipeline *
 gsk_vulkan_color_text_pipeline_new (GdkVulkanContext        *context,
                                     VkPipelineLayout         layout,
+                                    VkPipelineCache          cache,
                                     const char              *shader_name,
                                     VkRenderPass             render_pass)
 {
-  return gsk_vulkan_pipeline_new_full (GSK_TYPE_VULKAN_COLOR_TEXT_PIPELINE, context, layout, shader_name, render_pass,
+  return gsk_vulkan_pipeline_new_full (GSK_TYPE_VULKAN_COLOR_TEXT_PIPELINE, context, layout, cache, shader_name, render_pass,
                                        VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA);
 }
 
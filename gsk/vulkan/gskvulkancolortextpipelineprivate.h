@@ -16,6 +16,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanColorTextPipeline, gsk_vulkan_color_text_pipeline
 
 GskVulkanPipeline *     gsk_vulkan_color_text_pipeline_new                   (GdkVulkanContext               *context,
                                                                               VkPipelineLayout                layout,
+                                                                              VkPipelineCache                 cache,
                                                                               const char                     *shader_name,
                                                                               VkRenderPass                    render_pass);
 
@@ -3,27 +3,33 @@
 #include "gskvulkancommandpoolprivate.h"
 #include "gskvulkanpipelineprivate.h"
 
+#include "gdk/gdkvulkancontextprivate.h"
+
 struct _GskVulkanCommandPool
 {
   GdkVulkanContext *vulkan;
 
+  VkQueue vk_queue;
   VkCommandPool vk_command_pool;
   GPtrArray *buffers;
 };
 
-GskVulkanCommandPool *
-gsk_vulkan_command_pool_new (GdkVulkanContext *context)
+static GskVulkanCommandPool *
+gsk_vulkan_command_pool_new_for_queue (GdkVulkanContext *context,
+                                       VkQueue           queue,
+                                       uint32_t          queue_family_index)
 {
   GskVulkanCommandPool *self;
 
   self = g_slice_new0 (GskVulkanCommandPool);
 
   self->vulkan = g_object_ref (context);
+  self->vk_queue = queue;
 
   GSK_VK_CHECK (vkCreateCommandPool, gdk_vulkan_context_get_device (context),
                                      &(const VkCommandPoolCreateInfo) {
                                          .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-                                         .queueFamilyIndex = gdk_vulkan_context_get_queue_family_index (self->vulkan),
+                                         .queueFamilyIndex = queue_family_index,
                                          .flags = 0
                                      },
                                      NULL,
@@ -34,6 +40,35 @@ gsk_vulkan_command_pool_new (GdkVulkanContext *context)
   return self;
 }
 
+GskVulkanCommandPool *
+gsk_vulkan_command_pool_new (GdkVulkanContext *context)
+{
+  return gsk_vulkan_command_pool_new_for_queue (context,
+                                                gdk_vulkan_context_get_queue (context),
+                                                gdk_vulkan_context_get_queue_family_index (context));
+}
+
+/**
+ * gsk_vulkan_command_pool_new_transfer:
+ * @context: a `GdkVulkanContext`
+ *
+ * Creates a command pool for the transfer queue of @context, or
+ * %NULL if the device has no dedicated transfer queue.
+ *
+ * Returns: (nullable): a new `GskVulkanCommandPool`
+ */
+GskVulkanCommandPool *
+gsk_vulkan_command_pool_new_transfer (GdkVulkanContext *context)
+{
+  if (gdk_vulkan_context_get_transfer_queue_family_index (context) ==
+      gdk_vulkan_context_get_queue_family_index (context))
+    return NULL;
+
+  return gsk_vulkan_command_pool_new_for_queue (context,
+                                                gdk_vulkan_context_get_transfer_queue (context),
+                                                gdk_vulkan_context_get_transfer_queue_family_index (context));
+}
+
 static void
 gsk_vulkan_command_pool_free_buffers (GskVulkanCommandPool *self)
 {
@@ -112,7 +147,7 @@ gsk_vulkan_command_pool_submit_buffer (GskVulkanCommandPool *self,
         wait_semaphore_flags[i] = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     }
 
-  GSK_VK_CHECK (vkQueueSubmit, gdk_vulkan_context_get_queue (self->vulkan),
+  GSK_VK_CHECK (vkQueueSubmit, self->vk_queue,
                                1,
                                &(VkSubmitInfo) {
                                   .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
@@ -8,6 +8,7 @@ G_BEGIN_DECLS
 typedef struct _GskVulkanCommandPool GskVulkanCommandPool;
 
 GskVulkanCommandPool *  gsk_vulkan_command_pool_new                     (GdkVulkanContext       *context);
+GskVulkanCommandPool *  gsk_vulkan_command_pool_new_transfer            (GdkVulkanContext       *context);
 void                    gsk_vulkan_command_pool_free                    (GskVulkanCommandPool   *self);
 
 void                    gsk_vulkan_command_pool_reset                   (GskVulkanCommandPool   *self);
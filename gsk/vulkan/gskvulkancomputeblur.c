@@ -0,0 +1,447 @@
+#include "config.h"
+
+#include "gskvulkancomputeblurprivate.h"
+
+#include "gskvulkanpipelineprivate.h"
+#include "gskvulkanshaderprivate.h"
+
+/* Must match blur.comp */
+#define GROUP_SIZE 128
+#define MAX_SIGMA 8.0
+
+#define DESCRIPTOR_POOL_MAXSETS 32
+
+typedef struct _GskVulkanComputeBlurConstants GskVulkanComputeBlurConstants;
+
+struct _GskVulkanComputeBlurConstants
+{
+  float tex_scale[2];
+  gint32 size[2];
+  float sigma;
+  gint32 vertical;
+};
+
+struct _GskVulkanComputeBlur
+{
+  GdkVulkanContext *vulkan;
+
+  VkSampler sampler;
+  VkDescriptorSetLayout descriptor_set_layout;
+  VkPipelineLayout pipeline_layout;
+  VkPipeline pipeline;
+
+  GArray *descriptor_pools;
+  guint current_pool;
+  guint n_sets_in_current_pool;
+};
+
+/*<private>
+ * gsk_vulkan_compute_blur_new:
+ * @context: a `GdkVulkanContext`
+ * @cache: the pipeline cache to use
+ * @sampler: the sampler used to read the blurred images
+ *
+ * Creates the compute pipeline for blurring images in two separable
+ * passes.
+ *
+ * Returns: (nullable): the new `GskVulkanComputeBlur` or %NULL if
+ *   the compute shader is not available
+ */
+GskVulkanComputeBlur *
+gsk_vulkan_compute_blur_new (GdkVulkanContext *context,
+                             VkPipelineCache   cache,
+                             VkSampler         sampler)
+{
+  GskVulkanComputeBlur *self;
+  GskVulkanShader *shader;
+  VkDevice device;
+
+  shader = gsk_vulkan_shader_new_from_resource (context, GSK_VULKAN_SHADER_COMPUTE, "blur", NULL);
+  if (shader == NULL)
+    return NULL;
+
+  device = gdk_vulkan_context_get_device (context);
+
+  self = g_slice_new0 (GskVulkanComputeBlur);
+  self->vulkan = g_object_ref (context);
+  self->sampler = sampler;
+
+  GSK_VK_CHECK (vkCreateDescriptorSetLayout, device,
+                                             &(VkDescriptorSetLayoutCreateInfo) {
+                                                 .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                                                 .bindingCount = 2,
+                                                 .pBindings = (VkDescriptorSetLayoutBinding[2]) {
+                                                     {
+                                                         .binding = 0,
+                                                         .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                         .descriptorCount = 1,
+                                                         .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+                                                     },
+                                                     {
+                                                         .binding = 1,
+                                                         .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                                                         .descriptorCount = 1,
+                                                         .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+                                                     }
+                                                 }
+                                             },
+                                             NULL,
+                                             &self->descriptor_set_layout);
+
+  GSK_VK_CHECK (vkCreatePipelineLayout, device,
+                                        &(VkPipelineLayoutCreateInfo) {
+                                            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                                            .setLayoutCount = 1,
+                                            .pSetLayouts = &self->descriptor_set_layout,
+                                            .pushConstantRangeCount = 1,
+                                            .pPushConstantRanges = &(VkPushConstantRange) {
+                                                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                                                .offset = 0,
+                                                .size = sizeof (GskVulkanComputeBlurConstants)
+                                            }
+                                        },
+                                        NULL,
+                                        &self->pipeline_layout);
+
+  GSK_VK_CHECK (vkCreateComputePipelines, device,
+                                          cache,
+                                          1,
+                                          &(VkComputePipelineCreateInfo) {
+                                              .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+                                              .stage = GST_VULKAN_SHADER_STAGE_CREATE_INFO (shader),
+                                              .layout = self->pipeline_layout,
+                                              .basePipelineHandle = VK_NULL_HANDLE,
+                                              .basePipelineIndex = -1,
+                                          },
+                                          NULL,
+                                          &self->pipeline);
+
+  gsk_vulkan_shader_free (shader);
+
+  self->descriptor_pools = g_array_new (FALSE, FALSE, sizeof (VkDescriptorPool));
+
+  return self;
+}
+
+void
+gsk_vulkan_compute_blur_free (GskVulkanComputeBlur *self)
+{
+  VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+
+  for (guint i = 0; i < self->descriptor_pools->len; i++)
+    vkDestroyDescriptorPool (device,
+                             g_array_index (self->descriptor_pools, VkDescriptorPool, i),
+                             NULL);
+  g_array_unref (self->descriptor_pools);
+
+  vkDestroyPipeline (device, self->pipeline, NULL);
+  vkDestroyPipelineLayout (device, self->pipeline_layout, NULL);
+  vkDestroyDescriptorSetLayout (device, self->descriptor_set_layout, NULL);
+
+  g_object_unref (self->vulkan);
+
+  g_slice_free (GskVulkanComputeBlur, self);
+}
+
+/* Frees all descriptor sets, must only be called once the GPU is
+ * done with the frame.
+ */
+void
+gsk_vulkan_compute_blur_reset (GskVulkanComputeBlur *self)
+{
+  VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+
+  for (guint i = 0; i < self->descriptor_pools->len; i++)
+    GSK_VK_CHECK (vkResetDescriptorPool, device,
+                                         g_array_index (self->descriptor_pools, VkDescriptorPool, i),
+                                         0);
+
+  self->current_pool = 0;
+  self->n_sets_in_current_pool = 0;
+}
+
+/* Large blurs are done at a fraction of the size, so that the kernel
+ * never exceeds what fits into the shared memory of the shader.
+ */
+guint
+gsk_vulkan_compute_blur_get_scale (float radius)
+{
+  float sigma = radius / 2.0;
+  guint scale = 1;
+
+  while (sigma / scale > MAX_SIGMA && scale < 16)
+    scale *= 2;
+
+  return scale;
+}
+
+static VkDescriptorPool
+gsk_vulkan_compute_blur_get_descriptor_pool (GskVulkanComputeBlur *self,
+                                             guint                 n_sets)
+{
+  VkDescriptorPool pool;
+
+  if (self->current_pool < self->descriptor_pools->len &&
+      self->n_sets_in_current_pool + n_sets > DESCRIPTOR_POOL_MAXSETS)
+    {
+      self->current_pool++;
+      self->n_sets_in_current_pool = 0;
+    }
+
+  if (self->current_pool == self->descriptor_pools->len)
+    {
+      GSK_VK_CHECK (vkCreateDescriptorPool, gdk_vulkan_context_get_device (self->vulkan),
+                                            &(VkDescriptorPoolCreateInfo) {
+                                                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                                                .maxSets = DESCRIPTOR_POOL_MAXSETS,
+                                                .poolSizeCount = 2,
+                                                .pPoolSizes = (VkDescriptorPoolSize[2]) {
+                                                    {
+                                                        .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                        .descriptorCount = DESCRIPTOR_POOL_MAXSETS
+                                                    },
+                                                    {
+                                                        .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                                                        .descriptorCount = DESCRIPTOR_POOL_MAXSETS
+                                                    }
+                                                }
+                                            },
+                                            NULL,
+                                            &pool);
+      g_array_append_val (self->descriptor_pools, pool);
+    }
+
+  self->n_sets_in_current_pool += n_sets;
+
+  return g_array_index (self->descriptor_pools, VkDescriptorPool, self->current_pool);
+}
+
+static void
+gsk_vulkan_compute_blur_write_descriptor_set (GskVulkanComputeBlur *self,
+                                              VkDescriptorSet       descriptor_set,
+                                              GskVulkanImage       *source,
+                                              GskVulkanImage       *target)
+{
+  vkUpdateDescriptorSets (gdk_vulkan_context_get_device (self->vulkan),
+                          2,
+                          (VkWriteDescriptorSet[2]) {
+                              {
+                                  .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                                  .dstSet = descriptor_set,
+                                  .dstBinding = 0,
+                                  .dstArrayElement = 0,
+                                  .descriptorCount = 1,
+                                  .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                  .pImageInfo = &(VkDescriptorImageInfo) {
+                                      .sampler = self->sampler,
+                                      .imageView = gsk_vulkan_image_get_image_view (source),
+                                      .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                                  }
+                              },
+                              {
+                                  .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                                  .dstSet = descriptor_set,
+                                  .dstBinding = 1,
+                                  .dstArrayElement = 0,
+                                  .descriptorCount = 1,
+                                  .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                                  .pImageInfo = &(VkDescriptorImageInfo) {
+                                      .imageView = gsk_vulkan_image_get_image_view (target),
+                                      .imageLayout = VK_IMAGE_LAYOUT_GENERAL
+                                  }
+                              }
+                          },
+                          0, NULL);
+}
+
+/*<private>
+ * gsk_vulkan_compute_blur_prepare:
+ * @self: a `GskVulkanComputeBlur`
+ * @source: the image to blur
+ * @intermediate: the image receiving the horizontal pass
+ * @result: the image receiving the vertical pass
+ * @descriptor_sets: (out): return location for the descriptor sets
+ *   to pass to gsk_vulkan_compute_blur_record()
+ *
+ * Allocates the descriptor sets for a blur. This must be called from
+ * the thread that owns the render, recording can then happen anywhere.
+ */
+void
+gsk_vulkan_compute_blur_prepare (GskVulkanComputeBlur *self,
+                                 GskVulkanImage       *source,
+                                 GskVulkanImage       *intermediate,
+                                 GskVulkanImage       *result,
+                                 VkDescriptorSet       descriptor_sets[2])
+{
+  GSK_VK_CHECK (vkAllocateDescriptorSets, gdk_vulkan_context_get_device (self->vulkan),
+                                          &(VkDescriptorSetAllocateInfo) {
+                                              .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                                              .descriptorPool = gsk_vulkan_compute_blur_get_descriptor_pool (self, 2),
+                                              .descriptorSetCount = 2,
+                                              .pSetLayouts = (VkDescriptorSetLayout[2]) {
+                                                  self->descriptor_set_layout,
+                                                  self->descriptor_set_layout
+                                              }
+                                          },
+                                          descriptor_sets);
+
+  gsk_vulkan_compute_blur_write_descriptor_set (self, descriptor_sets[0], source, intermediate);
+  gsk_vulkan_compute_blur_write_descriptor_set (self, descriptor_sets[1], intermediate, result);
+}
+
+static inline VkImageMemoryBarrier
+image_barrier (GskVulkanImage *image,
+               VkAccessFlags   src_access,
+               VkAccessFlags   dst_access,
+               VkImageLayout   old_layout,
+               VkImageLayout   new_layout)
+{
+  return (VkImageMemoryBarrier) {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = src_access,
+    .dstAccessMask = dst_access,
+    .oldLayout = old_layout,
+    .newLayout = new_layout,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = gsk_vulkan_image_get_image (image),
+    .subresourceRange = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel = 0,
+      .levelCount = 1,
+      .baseArrayLayer = 0,
+      .layerCount = 1
+    }
+  };
+}
+
+static void
+gsk_vulkan_compute_blur_dispatch (GskVulkanComputeBlur *self,
+                                  VkCommandBuffer       command_buffer,
+                                  VkDescriptorSet       descriptor_set,
+                                  const GskVulkanComputeBlurConstants *constants)
+{
+  gsize length, across;
+
+  if (constants->vertical)
+    {
+      length = constants->size[1];
+      across = constants->size[0];
+    }
+  else
+    {
+      length = constants->size[0];
+      across = constants->size[1];
+    }
+
+  vkCmdBindDescriptorSets (command_buffer,
+                           VK_PIPELINE_BIND_POINT_COMPUTE,
+                           self->pipeline_layout,
+                           0,
+                           1,
+                           &descriptor_set,
+                           0,
+                           NULL);
+  vkCmdPushConstants (command_buffer,
+                      self->pipeline_layout,
+                      VK_SHADER_STAGE_COMPUTE_BIT,
+                      0,
+                      sizeof (GskVulkanComputeBlurConstants),
+                      constants);
+  vkCmdDispatch (command_buffer,
+                 (length + GROUP_SIZE - 1) / GROUP_SIZE,
+                 across,
+                 1);
+}
+
+/*<private>
+ * gsk_vulkan_compute_blur_record:
+ * @self: a `GskVulkanComputeBlur`
+ * @command_buffer: the command buffer to record into, outside of
+ *   a render pass
+ * @source: the image to blur, in shader read layout
+ * @intermediate: the image receiving the horizontal pass
+ * @result: the image receiving the blurred result
+ * @descriptor_sets: the sets from gsk_vulkan_compute_blur_prepare()
+ * @radius: the blur radius, in pixels of @source
+ *
+ * Records a blur of @source into @result. Both @intermediate and
+ * @result must be created with gsk_vulkan_image_new_for_storage(),
+ * scaled down by gsk_vulkan_compute_blur_get_scale().
+ *
+ * Afterwards, @result is ready to be sampled by fragment shaders.
+ */
+void
+gsk_vulkan_compute_blur_record (GskVulkanComputeBlur  *self,
+                                VkCommandBuffer        command_buffer,
+                                GskVulkanImage        *source,
+                                GskVulkanImage        *intermediate,
+                                GskVulkanImage        *result,
+                                const VkDescriptorSet  descriptor_sets[2],
+                                float                  radius)
+{
+  guint scale = gsk_vulkan_compute_blur_get_scale (radius);
+  gsize width = gsk_vulkan_image_get_width (result);
+  gsize height = gsk_vulkan_image_get_height (result);
+  GskVulkanComputeBlurConstants constants;
+
+  vkCmdPipelineBarrier (command_buffer,
+                        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        0,
+                        0, NULL,
+                        0, NULL,
+                        3, (VkImageMemoryBarrier[3]) {
+                            image_barrier (source,
+                                           VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+                            image_barrier (intermediate,
+                                           0, VK_ACCESS_SHADER_WRITE_BIT,
+                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL),
+                            image_barrier (result,
+                                           0, VK_ACCESS_SHADER_WRITE_BIT,
+                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL),
+                        });
+
+  vkCmdBindPipeline (command_buffer,
+                     VK_PIPELINE_BIND_POINT_COMPUTE,
+                     self->pipeline);
+
+  constants = (GskVulkanComputeBlurConstants) {
+    .tex_scale = { (float) scale / gsk_vulkan_image_get_width (source),
+                   (float) scale / gsk_vulkan_image_get_height (source) },
+    .size = { width, height },
+    .sigma = radius / 2.0 / scale,
+    .vertical = FALSE
+  };
+  gsk_vulkan_compute_blur_dispatch (self, command_buffer, descriptor_sets[0], &constants);
+
+  vkCmdPipelineBarrier (command_buffer,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        0,
+                        0, NULL,
+                        0, NULL,
+                        1, (VkImageMemoryBarrier[1]) {
+                            image_barrier (intermediate,
+                                           VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                           VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+                        });
+
+  constants.tex_scale[0] = 1.0 / width;
+  constants.tex_scale[1] = 1.0 / height;
+  constants.vertical = TRUE;
+  gsk_vulkan_compute_blur_dispatch (self, command_buffer, descriptor_sets[1], &constants);
+
+  vkCmdPipelineBarrier (command_buffer,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                        0,
+                        0, NULL,
+                        0, NULL,
+                        1, (VkImageMemoryBarrier[1]) {
+                            image_barrier (result,
+                                           VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                           VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+                        });
+}
@@ -0,0 +1,38 @@
+#ifndef __GSK_VULKAN_COMPUTE_BLUR_PRIVATE_H__
+#define __GSK_VULKAN_COMPUTE_BLUR_PRIVATE_H__
+
+#include <gdk/gdk.h>
+
+#include "gskvulkanimageprivate.h"
+
+G_BEGIN_DECLS
+
+/* Blurs with a smaller radius are cheap enough in the fragment shader */
+#define GSK_VULKAN_COMPUTE_BLUR_MIN_RADIUS 8.0
+
+typedef struct _GskVulkanComputeBlur GskVulkanComputeBlur;
+
+GskVulkanComputeBlur *  gsk_vulkan_compute_blur_new                     (GdkVulkanContext       *context,
+                                                                         VkPipelineCache         cache,
+                                                                         VkSampler               sampler);
+void                    gsk_vulkan_compute_blur_free                    (GskVulkanComputeBlur   *self);
+
+void                    gsk_vulkan_compute_blur_reset                   (GskVulkanComputeBlur   *self);
+
+guint                   gsk_vulkan_compute_blur_get_scale               (float                   radius);
+void                    gsk_vulkan_compute_blur_prepare                 (GskVulkanComputeBlur   *self,
+                                                                         GskVulkanImage         *source,
+                                                                         GskVulkanImage         *intermediate,
+                                                                         GskVulkanImage         *result,
+                                                                         VkDescriptorSet         descriptor_sets[2]);
+void                    gsk_vulkan_compute_blur_record                  (GskVulkanComputeBlur   *self,
+                                                                         VkCommandBuffer         command_buffer,
+                                                                         GskVulkanImage         *source,
+                                                                         GskVulkanImage         *intermediate,
+                                                                         GskVulkanImage         *result,
+                                                                         const VkDescriptorSet   descriptor_sets[2],
+                                                                         float                   radius);
+
+G_END_DECLS
+
+#endif /* __GSK_VULKAN_COMPUTE_BLUR_PRIVATE_H__ */
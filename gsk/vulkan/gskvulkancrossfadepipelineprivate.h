@@ -15,6 +15,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanCrossFadePipeline, gsk_vulkan_cross_fade_pipeline
 
 GskVulkanPipeline * gsk_vulkan_cross_fade_pipeline_new                 (GdkVulkanContext           *context,
                                                                         VkPipelineLayout            layout,
+                                                                        VkPipelineCache             cache,
                                                                         const char                 *shader_name,
                                                                         VkRenderPass                render_pass);
 
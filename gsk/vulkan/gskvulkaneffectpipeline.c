@@ -110,10 +110,11 @@ gsk_vulkan_effect_pipeline_init (GskVulkanEffectPipeline *self)
 GskVulkanPipeline *
 gsk_vulkan_effect_pipeline_new (GdkVulkanContext        *context,
                                 VkPipelineLayout         layout,
+                                VkPipelineCache          cache,
                                 const char              *shader_name,
                                 VkRenderPass             render_pass)
 {
-  return gsk_vulkan_pipeline_new (GSK_TYPE_VULKAN_EFFECT_PIPELINE, context, layout, shader_name, render_pass);
+  return gsk_vulkan_pipeline_new (GSK_TYPE_VULKAN_EFFECT_PIPELINE, context, layout, cache, shader_name, render_pass);
 }
 
 gsize
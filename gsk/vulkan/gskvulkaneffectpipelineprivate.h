@@ -15,6 +15,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanEffectPipeline, gsk_vulkan_effect_pipeline, GSK,
 
 GskVulkanPipeline *     gsk_vulkan_effect_pipeline_new                  (GdkVulkanContext               *context,
                                                                          VkPipelineLayout                layout,
+                                                                         VkPipelineCache                 cache,
                                                                          const char                     *shader_name,
                                                                          VkRenderPass                    render_pass);
 
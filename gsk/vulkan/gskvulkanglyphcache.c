@@ -6,6 +6,7 @@
 #include "gskdebugprivate.h"
 #include "gskprivate.h"
 #include "gskrendererprivate.h"
+#include "gskprofilerprivate.h"
 
 #include <graphene.h>
 
@@ -15,12 +16,24 @@
  * Glyphs that have not been used for the MAX_AGE frames are considered old. We keep
  * count of the pixels of each atlas that are taken up by old glyphs. We check the
  * fraction of old pixels every CHECK_INTERVAL frames, and if it is above MAX_OLD, then
- * we drop the atlas an all the glyphs contained in it from the cache.
+ * we drop all the glyphs contained in the atlas from the cache and start filling it
+ * from scratch.
+ *
+ * Additionally, the atlases try to stay within the glyph cache budget. When it is
+ * exceeded, the least recently used atlases are emptied, and when a glyph doesn't
+ * fit anywhere, the least recently used atlas is reused instead of creating a new
+ * one.
+ *
+ * Atlases keep their image when they are reused, unless a frame that is still in
+ * flight may be reading from it. Frames never keep more than REUSE_AGE frames in
+ * flight.
  */
 
+#define ATLAS_SIZE 512
 #define MAX_AGE 60
 #define CHECK_INTERVAL 10
 #define MAX_OLD 0.333
+#define REUSE_AGE 4
 
 
 typedef struct {
@@ -30,6 +43,7 @@ typedef struct {
   int num_glyphs;
   GList *dirty_glyphs;
   guint old_pixels;
+  guint64 last_used;
 } Atlas;
 
 struct _GskVulkanGlyphCache {
@@ -42,6 +56,17 @@ struct _GskVulkanGlyphCache {
   GPtrArray *atlases;
 
   guint64 timestamp;
+  gsize budget;
+
+#ifdef G_ENABLE_DEBUG
+  struct {
+    GQuark atlases;
+    GQuark atlas_bytes;
+    GQuark glyphs;
+    GQuark evicted_glyphs;
+    GQuark reused_atlases;
+  } profile_counters;
+#endif
 };
 
 struct _GskVulkanGlyphCacheClass {
@@ -63,18 +88,115 @@ create_atlas (GskVulkanGlyphCache *cache)
   Atlas *atlas;
 
   atlas = g_new0 (Atlas, 1);
-  atlas->width = 512;
-  atlas->height = 512;
+  atlas->width = ATLAS_SIZE;
+  atlas->height = ATLAS_SIZE;
   atlas->y0 = 1;
   atlas->y = 1;
   atlas->x = 1;
   atlas->image = NULL;
   atlas->num_glyphs = 0;
   atlas->dirty_glyphs = NULL;
+  atlas->last_used = cache->timestamp;
 
   return atlas;
 }
 
+static gsize
+get_atlas_bytes (Atlas *atlas)
+{
+  if (atlas->image == NULL && atlas->num_glyphs == 0)
+    return 0;
+
+  return (gsize) atlas->width * atlas->height * 4;
+}
+
+static gsize
+get_cache_bytes (GskVulkanGlyphCache *cache)
+{
+  gsize bytes = 0;
+  guint i;
+
+  for (i = 0; i < cache->atlases->len; i++)
+    bytes += get_atlas_bytes (g_ptr_array_index (cache->atlases, i));
+
+  return bytes;
+}
+
+/* Removes all glyphs of the atlas at @index from the cache. The atlas keeps
+ * its index, so the texture indices of the other glyphs stay valid.
+ */
+static void
+reset_atlas (GskVulkanGlyphCache *cache,
+             guint                index)
+{
+  Atlas *atlas = g_ptr_array_index (cache->atlases, index);
+  GHashTableIter iter;
+  GskVulkanCachedGlyph *value;
+  guint dropped = 0;
+
+  g_hash_table_iter_init (&iter, cache->hash_table);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&value))
+    {
+      if (value->texture_index == index && value->draw_width > 0 && value->draw_height > 0)
+        {
+          g_hash_table_iter_remove (&iter);
+          dropped++;
+        }
+    }
+
+  g_list_free_full (atlas->dirty_glyphs, dirty_glyph_free);
+  atlas->dirty_glyphs = NULL;
+  atlas->x = 1;
+  atlas->y = 1;
+  atlas->y0 = 1;
+  atlas->num_glyphs = 0;
+  atlas->old_pixels = 0;
+
+  /* Frames in flight may still be drawing from the image, so don't
+   * overwrite it. They keep their own reference.
+   */
+  if (atlas->last_used + REUSE_AGE > cache->timestamp)
+    g_clear_object (&atlas->image);
+
+  GSK_RENDERER_NOTE (cache->renderer, GLYPH_CACHE,
+                     g_message ("Emptied atlas %u, dropped %u glyphs (%s image)",
+                                index, dropped, atlas->image ? "kept" : "released"));
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_add (gsk_renderer_get_profiler (cache->renderer),
+                            cache->profile_counters.evicted_glyphs,
+                            dropped);
+#endif
+}
+
+/* Finds the least recently used atlas that has not been used in the
+ * current frame, so its glyphs can be dropped.
+ */
+static int
+find_lru_atlas (GskVulkanGlyphCache *cache)
+{
+  guint64 oldest = G_MAXUINT64;
+  int result = -1;
+  guint i;
+
+  for (i = 0; i < cache->atlases->len; i++)
+    {
+      Atlas *atlas = g_ptr_array_index (cache->atlases, i);
+
+      if (atlas->num_glyphs == 0 ||
+          atlas->last_used >= cache->timestamp)
+        continue;
+
+      if (atlas->last_used < oldest)
+        {
+          oldest = atlas->last_used;
+          result = i;
+        }
+    }
+
+  return result;
+}
+
 static void
 free_atlas (gpointer v)
 {
@@ -210,8 +332,27 @@ add_to_cache (GskVulkanGlyphCache  *cache,
 
   if (i == cache->atlases->len)
     {
-      atlas = create_atlas (cache);
-      g_ptr_array_add (cache->atlases, atlas);
+      int lru = -1;
+
+      if (get_cache_bytes (cache) + ATLAS_SIZE * ATLAS_SIZE * 4 > cache->budget)
+        lru = find_lru_atlas (cache);
+
+      if (lru >= 0)
+        {
+          reset_atlas (cache, lru);
+          i = lru;
+          atlas = g_ptr_array_index (cache->atlases, i);
+
+#ifdef G_ENABLE_DEBUG
+          gsk_profiler_counter_inc (gsk_renderer_get_profiler (cache->renderer),
+                                    cache->profile_counters.reused_atlases);
+#endif
+        }
+      else
+        {
+          atlas = create_atlas (cache);
+          g_ptr_array_add (cache->atlases, atlas);
+        }
     }
 
   value->tx = (float)atlas->x / atlas->width;
@@ -230,6 +371,7 @@ add_to_cache (GskVulkanGlyphCache  *cache,
   atlas->y = MAX (atlas->y, atlas->y0 + height + 1);
 
   atlas->num_glyphs++;
+  atlas->last_used = cache->timestamp;
 
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (cache->renderer, GLYPH_CACHE))
@@ -260,10 +402,14 @@ render_glyph (Atlas          *atlas,
   PangoGlyphString glyphs;
   PangoGlyphInfo gi;
 
+  /* Include the transparent pixel around the glyph, as reused atlases
+   * may contain leftovers from previous glyphs there.
+   */
   surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
-                                        value->draw_width * key->scale / 1024,
-                                        value->draw_height * key->scale / 1024);
+                                        value->draw_width * key->scale / 1024 + 2,
+                                        value->draw_height * key->scale / 1024 + 2);
   cairo_surface_set_device_scale (surface, key->scale / 1024.0, key->scale / 1024.0);
+  cairo_surface_set_device_offset (surface, 1, 1);
 
   cr = cairo_create (surface);
   cairo_set_source_rgba (cr, 1, 1, 1, 1);
@@ -289,8 +435,8 @@ render_glyph (Atlas          *atlas,
   region->width = cairo_image_surface_get_width (surface);
   region->height = cairo_image_surface_get_height (surface);
   region->stride = cairo_image_surface_get_stride (surface);
-  region->x = (gsize)(value->tx * atlas->width);
-  region->y = (gsize)(value->ty * atlas->height);
+  region->x = (gsize)(value->tx * atlas->width) - 1;
+  region->y = (gsize)(value->ty * atlas->height) - 1;
 }
 
 static void
@@ -327,8 +473,21 @@ gsk_vulkan_glyph_cache_new (GskRenderer      *renderer,
   cache = GSK_VULKAN_GLYPH_CACHE (g_object_new (GSK_TYPE_VULKAN_GLYPH_CACHE, NULL));
   cache->renderer = renderer;
   cache->vulkan = vulkan;
+  cache->budget = gsk_get_glyph_cache_budget ();
   g_ptr_array_add (cache->atlases, create_atlas (cache));
 
+#ifdef G_ENABLE_DEBUG
+  {
+    GskProfiler *profiler = gsk_renderer_get_profiler (renderer);
+
+    cache->profile_counters.atlases = gsk_profiler_add_counter (profiler, "glyph-atlases", "Glyph atlases", FALSE);
+    cache->profile_counters.atlas_bytes = gsk_profiler_add_counter (profiler, "glyph-atlas-bytes", "Glyph atlas bytes", FALSE);
+    cache->profile_counters.glyphs = gsk_profiler_add_counter (profiler, "cached-glyphs", "Cached glyphs", FALSE);
+    cache->profile_counters.evicted_glyphs = gsk_profiler_add_counter (profiler, "evicted-glyphs", "Evicted glyphs", TRUE);
+    cache->profile_counters.reused_atlases = gsk_profiler_add_counter (profiler, "reused-glyph-atlases", "Reused glyph atlases", TRUE);
+  }
+#endif
+
   return cache;
 }
 
@@ -359,15 +518,15 @@ gsk_vulkan_glyph_cache_lookup (GskVulkanGlyphCache *cache,
 
   value = g_hash_table_lookup (cache->hash_table, &lookup_key);
 
-  if (value)
+  if (value && value->draw_width > 0 && value->draw_height > 0)
     {
+      Atlas *atlas = g_ptr_array_index (cache->atlases, value->texture_index);
+
       if (cache->timestamp - value->timestamp >= MAX_AGE)
-        {
-          Atlas *atlas = g_ptr_array_index (cache->atlases, value->texture_index);
+        atlas->old_pixels -= value->draw_width * value->draw_height;
 
-          atlas->old_pixels -= value->draw_width * value->draw_height;
-          value->timestamp = cache->timestamp;
-        }
+      value->timestamp = cache->timestamp;
+      atlas->last_used = cache->timestamp;
     }
 
   if (create && value == NULL)
@@ -425,28 +584,26 @@ gsk_vulkan_glyph_cache_get_glyph_image (GskVulkanGlyphCache *cache,
 void
 gsk_vulkan_glyph_cache_begin_frame (GskVulkanGlyphCache *cache)
 {
-  int i, j;
-  guint *drops;
-  guint *shifts;
-  guint len;
   GHashTableIter iter;
   GlyphCacheKey *key;
   GskVulkanCachedGlyph *value;
-  guint dropped = 0;
+  gsize bytes;
+  int i;
 
   cache->timestamp++;
 
   if (cache->timestamp % CHECK_INTERVAL != 0)
     return;
 
-  len = cache->atlases->len;
-
   /* look for glyphs that have grown old since last time */
   g_hash_table_iter_init (&iter, cache->hash_table);
   while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&value))
     {
       guint age;
 
+      if (value->draw_width == 0 || value->draw_height == 0)
+        continue;
+
       age = cache->timestamp - value->timestamp;
       if (MAX_AGE <= age && age < MAX_AGE + CHECK_INTERVAL)
         {
@@ -455,17 +612,8 @@ gsk_vulkan_glyph_cache_begin_frame (GskVulkanGlyphCache *cache)
         }
     }
 
-  drops = g_alloca (sizeof (guint) * len);
-  shifts = g_alloca (sizeof (guint) * len);
-
-  for (i = 0; i < len; i++)
-    {
-      drops[i] = 0;
-      shifts[i] = i;
-    }
-
-  /* look for atlases to drop, and create a mapping of updated texture indices */
-  for (i = cache->atlases->len - 1; i >= 0; i--)
+  /* empty atlases that are mostly taken up by old glyphs */
+  for (i = 0; i < cache->atlases->len; i++)
     {
       Atlas *atlas = g_ptr_array_index (cache->atlases, i);
 
@@ -473,33 +621,43 @@ gsk_vulkan_glyph_cache_begin_frame (GskVulkanGlyphCache *cache)
         {
           GSK_RENDERER_NOTE(cache->renderer, GLYPH_CACHE,
                    g_message ("Dropping atlas %d (%g.2%% old)", i, 100.0 * (double)atlas->old_pixels / (double)(atlas->width * atlas->height)));
-          g_ptr_array_remove_index (cache->atlases, i);
-
-          drops[i] = 1;
-          for (j = i; j + 1 < len; j++)
-            shifts[j + 1] = shifts[j];
+          reset_atlas (cache, i);
         }
     }
 
-  /* no atlas dropped, we're done */
-  if (len == cache->atlases->len)
-    return;
+  /* and then the least recently used ones, until we are within budget */
+  bytes = get_cache_bytes (cache);
+  while (bytes > cache->budget)
+    {
+      gsize atlas_bytes;
 
-  /* purge glyphs and update texture indices */
-  g_hash_table_iter_init (&iter, cache->hash_table);
+      i = find_lru_atlas (cache);
+      if (i < 0)
+        break;
 
-  while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&value))
+      atlas_bytes = get_atlas_bytes (g_ptr_array_index (cache->atlases, i));
+      reset_atlas (cache, i);
+      bytes -= atlas_bytes - get_atlas_bytes (g_ptr_array_index (cache->atlases, i));
+    }
+
+  /* empty atlases at the end can go away completely */
+  while (cache->atlases->len > 1)
     {
-      if (drops[value->texture_index])
-        {
-          dropped++;
-          g_hash_table_iter_remove (&iter);
-        }
-      else
-        {
-          value->texture_index = shifts[value->texture_index];
-        }
+      Atlas *atlas = g_ptr_array_index (cache->atlases, cache->atlases->len - 1);
+
+      if (atlas->num_glyphs > 0)
+        break;
+
+      g_ptr_array_remove_index (cache->atlases, cache->atlases->len - 1);
     }
 
-  GSK_RENDERER_NOTE(cache->renderer, GLYPH_CACHE, g_message ("Dropped %d glyphs", dropped));
+#ifdef G_ENABLE_DEBUG
+  {
+    GskProfiler *profiler = gsk_renderer_get_profiler (cache->renderer);
+
+    gsk_profiler_counter_set (profiler, cache->profile_counters.atlases, cache->atlases->len);
+    gsk_profiler_counter_set (profiler, cache->profile_counters.atlas_bytes, get_cache_bytes (cache));
+    gsk_profiler_counter_set (profiler, cache->profile_counters.glyphs, g_hash_table_size (cache->hash_table));
+  }
+#endif
 }
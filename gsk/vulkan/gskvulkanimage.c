@@ -6,14 +6,34 @@
 #include "gskvulkanmemoryprivate.h"
 #include "gskvulkanpipelineprivate.h"
 
+#include "gdk/gdkvulkancontextprivate.h"
+
 #include <string.h>
 
+/* Images at least this big are copied on the transfer queue, if the
+ * device has one, so the copy can overlap with rendering.
+ */
+#define ASYNC_UPLOAD_MIN_SIZE (256 * 1024)
+#define STAGING_RING_SIZE (16 * 1024 * 1024)
+#define STAGING_ALIGNMENT 256
+
 struct _GskVulkanUploader
 {
   GdkVulkanContext *vulkan;
 
   GskVulkanCommandPool *command_pool;
 
+  /* NULL if there is no dedicated transfer queue */
+  GskVulkanCommandPool *transfer_pool;
+  VkCommandBuffer transfer_buffer;
+  VkSemaphore transfer_semaphore;
+  GArray *acquire_image_barriers;
+  gboolean transfer_submitted;
+
+  /* Staging memory for transfers, reused once the frame is done */
+  GskVulkanBuffer *staging_ring;
+  gsize staging_ring_offset;
+
   GArray *before_buffer_barriers;
   GArray *before_image_barriers;
   VkCommandBuffer copy_buffer;
@@ -60,6 +80,19 @@ gsk_vulkan_uploader_new (GdkVulkanContext     *context,
   self->before_image_barriers = g_array_new (FALSE, FALSE, sizeof (VkImageMemoryBarrier));
   self->after_image_barriers = g_array_new (FALSE, FALSE, sizeof (VkImageMemoryBarrier));
 
+  self->transfer_pool = gsk_vulkan_command_pool_new_transfer (context);
+  if (self->transfer_pool)
+    {
+      self->acquire_image_barriers = g_array_new (FALSE, FALSE, sizeof (VkImageMemoryBarrier));
+
+      GSK_VK_CHECK (vkCreateSemaphore, gdk_vulkan_context_get_device (context),
+                                       &(VkSemaphoreCreateInfo) {
+                                           .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+                                       },
+                                       NULL,
+                                       &self->transfer_semaphore);
+    }
+
   return self;
 }
 
@@ -73,6 +106,17 @@ gsk_vulkan_uploader_free (GskVulkanUploader *self)
   g_array_unref (self->after_image_barriers);
   g_array_unref (self->before_image_barriers);
 
+  if (self->transfer_pool)
+    {
+      vkDestroySemaphore (gdk_vulkan_context_get_device (self->vulkan),
+                          self->transfer_semaphore,
+                          NULL);
+      g_array_unref (self->acquire_image_barriers);
+      gsk_vulkan_command_pool_free (self->transfer_pool);
+    }
+
+  g_clear_pointer (&self->staging_ring, gsk_vulkan_buffer_free);
+
   g_object_unref (self->vulkan);
 
   g_slice_free (GskVulkanUploader, self);
@@ -139,11 +183,46 @@ gsk_vulkan_uploader_get_copy_buffer (GskVulkanUploader *self)
   return self->copy_buffer;
 }
 
+static void
+gsk_vulkan_uploader_submit_transfers (GskVulkanUploader *self)
+{
+  VkCommandBuffer command_buffer;
+
+  gsk_vulkan_command_pool_submit_buffer (self->transfer_pool,
+                                         self->transfer_buffer,
+                                         0, NULL,
+                                         1, &self->transfer_semaphore,
+                                         VK_NULL_HANDLE);
+  self->transfer_buffer = VK_NULL_HANDLE;
+  self->transfer_submitted = TRUE;
+
+  /* Rendering waits for the copies only where it samples the images,
+   * and takes over ownership of them from the transfer queue.
+   */
+  command_buffer = gsk_vulkan_command_pool_get_buffer (self->command_pool);
+  vkCmdPipelineBarrier (command_buffer,
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                        0,
+                        0, NULL,
+                        0, NULL,
+                        self->acquire_image_barriers->len, (VkImageMemoryBarrier *) self->acquire_image_barriers->data);
+  gsk_vulkan_command_pool_submit_buffer (self->command_pool,
+                                         command_buffer,
+                                         1, &self->transfer_semaphore,
+                                         0, NULL,
+                                         VK_NULL_HANDLE);
+  g_array_set_size (self->acquire_image_barriers, 0);
+}
+
 void
 gsk_vulkan_uploader_upload (GskVulkanUploader *self)
 {
   VkPipelineStageFlagBits host_and_transfer_bits = VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
 
+  if (self->transfer_buffer != VK_NULL_HANDLE)
+    gsk_vulkan_uploader_submit_transfers (self);
+
   if (self->before_buffer_barriers->len > 0 || self->before_image_barriers->len > 0)
     {
       VkCommandBuffer command_buffer;
@@ -190,6 +269,20 @@ gsk_vulkan_uploader_reset (GskVulkanUploader *self)
   self->copy_buffer = VK_NULL_HANDLE;
   g_array_set_size (self->after_image_barriers, 0);
 
+  if (self->transfer_pool)
+    {
+      /* The copies are done by the time the frame's fence signals, this
+       * only waits when resetting early, e.g. for downloads.
+       */
+      if (self->transfer_submitted)
+        GSK_VK_CHECK (vkQueueWaitIdle, gdk_vulkan_context_get_transfer_queue (self->vulkan));
+      self->transfer_submitted = FALSE;
+      self->transfer_buffer = VK_NULL_HANDLE;
+      g_array_set_size (self->acquire_image_barriers, 0);
+      gsk_vulkan_command_pool_reset (self->transfer_pool);
+    }
+  self->staging_ring_offset = 0;
+
   g_slist_free_full (self->staging_image_free_list, g_object_unref);
   self->staging_image_free_list = NULL;
   g_slist_free_full (self->staging_buffer_free_list, (GDestroyNotify) gsk_vulkan_buffer_free);
@@ -200,6 +293,7 @@ static GskVulkanImage *
 gsk_vulkan_image_new (GdkVulkanContext      *context,
                       gsize                  width,
                       gsize                  height,
+                      VkFormat               format,
                       VkImageTiling          tiling,
                       VkImageUsageFlags      usage,
                       VkImageLayout          layout,
@@ -223,7 +317,7 @@ gsk_vulkan_image_new (GdkVulkanContext      *context,
                                     .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
                                     .flags = 0,
                                     .imageType = VK_IMAGE_TYPE_2D,
-                                    .format = VK_FORMAT_B8G8R8A8_UNORM,
+                                    .format = format,
                                     .extent = { width, height, 1 },
                                     .mipLevels = 1,
                                     .arrayLayers = 1,
@@ -241,14 +335,14 @@ gsk_vulkan_image_new (GdkVulkanContext      *context,
                                 &requirements);
 
   self->memory = gsk_vulkan_memory_new (context,
-                                        requirements.memoryTypeBits,
+                                        &requirements,
                                         memory,
-                                        requirements.size);
+                                        tiling == VK_IMAGE_TILING_LINEAR);
 
   GSK_VK_CHECK (vkBindImageMemory, gdk_vulkan_context_get_device (context),
                                    self->vk_image,
                                    gsk_vulkan_memory_get_device_memory (self->memory),
-                                   0);
+                                   gsk_vulkan_memory_get_offset (self->memory));
   return self;
 }
 
@@ -363,6 +457,7 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
   self = gsk_vulkan_image_new (uploader->vulkan,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                                VK_IMAGE_USAGE_SAMPLED_BIT,
@@ -424,6 +519,7 @@ gsk_vulkan_image_new_from_data_via_staging_image (GskVulkanUploader *uploader,
   staging = gsk_vulkan_image_new (uploader->vulkan,
                                   width,
                                   height,
+                                  VK_FORMAT_B8G8R8A8_UNORM,
                                   VK_IMAGE_TILING_LINEAR,
                                   VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                                   VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
@@ -436,6 +532,7 @@ gsk_vulkan_image_new_from_data_via_staging_image (GskVulkanUploader *uploader,
   self = gsk_vulkan_image_new (uploader->vulkan,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                                VK_IMAGE_USAGE_SAMPLED_BIT,
@@ -508,6 +605,7 @@ gsk_vulkan_image_new_from_data_directly (GskVulkanUploader *uploader,
   self = gsk_vulkan_image_new (uploader->vulkan,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_LINEAR,
                                VK_IMAGE_USAGE_SAMPLED_BIT,
                                VK_IMAGE_LAYOUT_PREINITIALIZED,
@@ -527,6 +625,154 @@ gsk_vulkan_image_new_from_data_directly (GskVulkanUploader *uploader,
   return self;
 }
 
+static GskVulkanImage *
+gsk_vulkan_image_new_from_data_async (GskVulkanUploader *uploader,
+                                      guchar            *data,
+                                      gsize              width,
+                                      gsize              height,
+                                      gsize              stride)
+{
+  GskVulkanImage *self;
+  GskVulkanBuffer *staging;
+  gsize buffer_size = width * height * 4;
+  gsize offset;
+  guchar *mem;
+
+  if (uploader->staging_ring == NULL)
+    uploader->staging_ring = gsk_vulkan_buffer_new_staging (uploader->vulkan, STAGING_RING_SIZE);
+
+  offset = (uploader->staging_ring_offset + STAGING_ALIGNMENT - 1) & ~(gsize) (STAGING_ALIGNMENT - 1);
+  if (offset + buffer_size <= STAGING_RING_SIZE)
+    {
+      staging = uploader->staging_ring;
+      uploader->staging_ring_offset = offset + buffer_size;
+    }
+  else
+    {
+      staging = gsk_vulkan_buffer_new_staging (uploader->vulkan, buffer_size);
+      uploader->staging_buffer_free_list = g_slist_prepend (uploader->staging_buffer_free_list, staging);
+      offset = 0;
+    }
+
+  /* Host writes are made visible by the queue submission */
+  mem = gsk_vulkan_buffer_map (staging) + offset;
+
+  if (stride == width * 4)
+    {
+      memcpy (mem, data, stride * height);
+    }
+  else
+    {
+      for (gsize i = 0; i < height; i++)
+        {
+          memcpy (mem + i * width * 4, data + i * stride, width * 4);
+        }
+    }
+
+  gsk_vulkan_buffer_unmap (staging);
+
+  self = gsk_vulkan_image_new (uploader->vulkan,
+                               width,
+                               height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
+                               VK_IMAGE_TILING_OPTIMAL,
+                               VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                               VK_IMAGE_USAGE_SAMPLED_BIT,
+                               VK_IMAGE_LAYOUT_UNDEFINED,
+                               VK_ACCESS_TRANSFER_WRITE_BIT,
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+  if (uploader->transfer_buffer == VK_NULL_HANDLE)
+    uploader->transfer_buffer = gsk_vulkan_command_pool_get_buffer (uploader->transfer_pool);
+
+  vkCmdPipelineBarrier (uploader->transfer_buffer,
+                        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        0,
+                        0, NULL,
+                        0, NULL,
+                        1, &(VkImageMemoryBarrier) {
+                            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                            .srcAccessMask = 0,
+                            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                            .image = self->vk_image,
+                            .subresourceRange = {
+                              .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                              .baseMipLevel = 0,
+                              .levelCount = 1,
+                              .baseArrayLayer = 0,
+                              .layerCount = 1
+                            }
+                        });
+
+  vkCmdCopyBufferToImage (uploader->transfer_buffer,
+                          gsk_vulkan_buffer_get_buffer (staging),
+                          self->vk_image,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          1,
+                          (VkBufferImageCopy[1]) {
+                               {
+                                   .bufferOffset = offset,
+                                   .imageSubresource = {
+                                       .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                       .mipLevel = 0,
+                                       .baseArrayLayer = 0,
+                                       .layerCount = 1
+                                   },
+                                   .imageOffset = { 0, 0, 0 },
+                                   .imageExtent = {
+                                       .width = width,
+                                       .height = height,
+                                       .depth = 1
+                                   }
+                               }
+                          });
+
+  /* Hand the image over to the graphics queue. The same barrier is
+   * recorded on both queues, see gsk_vulkan_uploader_submit_transfers().
+   */
+  {
+    VkImageMemoryBarrier barrier = {
+      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+      .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+      .srcQueueFamilyIndex = gdk_vulkan_context_get_transfer_queue_family_index (uploader->vulkan),
+      .dstQueueFamilyIndex = gdk_vulkan_context_get_queue_family_index (uploader->vulkan),
+      .image = self->vk_image,
+      .subresourceRange = {
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1
+      }
+    };
+
+    vkCmdPipelineBarrier (uploader->transfer_buffer,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                          0,
+                          0, NULL,
+                          0, NULL,
+                          1, &barrier);
+
+    g_array_append_val (uploader->acquire_image_barriers, barrier);
+  }
+
+  self->vk_image_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  self->vk_access = VK_ACCESS_SHADER_READ_BIT;
+
+  gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
+
+  return self;
+}
+
 GskVulkanImage *
 gsk_vulkan_image_new_from_data (GskVulkanUploader *uploader,
                                 guchar            *data,
@@ -534,7 +780,12 @@ gsk_vulkan_image_new_from_data (GskVulkanUploader *uploader,
                                 gsize              height,
                                 gsize              stride)
 {
-  if (GSK_DEBUG_CHECK (VULKAN_STAGING_BUFFER))
+  if (uploader->transfer_pool != NULL &&
+      width * height * 4 >= ASYNC_UPLOAD_MIN_SIZE &&
+      !GSK_DEBUG_CHECK (VULKAN_STAGING_BUFFER) &&
+      !GSK_DEBUG_CHECK (VULKAN_STAGING_IMAGE))
+    return gsk_vulkan_image_new_from_data_async (uploader, data, width, height, stride);
+  else if (GSK_DEBUG_CHECK (VULKAN_STAGING_BUFFER))
     return gsk_vulkan_image_new_from_data_via_staging_buffer (uploader, data, width, height, stride);
   else if (GSK_DEBUG_CHECK (VULKAN_STAGING_IMAGE))
     return gsk_vulkan_image_new_from_data_via_staging_image (uploader, data, width, height, stride);
@@ -574,6 +825,7 @@ gsk_vulkan_image_new_for_framebuffer (GdkVulkanContext *context,
   self = gsk_vulkan_image_new (context,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
                                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
@@ -595,6 +847,7 @@ gsk_vulkan_image_new_for_atlas (GdkVulkanContext *context,
   self = gsk_vulkan_image_new (context,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                                VK_IMAGE_LAYOUT_UNDEFINED,
@@ -616,6 +869,7 @@ gsk_vulkan_image_new_for_texture (GdkVulkanContext *context,
   self = gsk_vulkan_image_new (context,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
                                VK_IMAGE_USAGE_SAMPLED_BIT |
@@ -629,6 +883,37 @@ gsk_vulkan_image_new_for_texture (GdkVulkanContext *context,
   return self;
 }
 
+/*<private>
+ * gsk_vulkan_image_new_for_storage:
+ *
+ * Creates an image that compute shaders can write to and that can
+ * afterwards be sampled. Its format is RGBA, as opposed to the BGRA
+ * of all other images, since that is what storage images support
+ * on all devices.
+ */
+GskVulkanImage *
+gsk_vulkan_image_new_for_storage (GdkVulkanContext *context,
+                                  gsize             width,
+                                  gsize             height)
+{
+  GskVulkanImage *self;
+
+  self = gsk_vulkan_image_new (context,
+                               width,
+                               height,
+                               VK_FORMAT_R8G8B8A8_UNORM,
+                               VK_IMAGE_TILING_OPTIMAL,
+                               VK_IMAGE_USAGE_STORAGE_BIT |
+                               VK_IMAGE_USAGE_SAMPLED_BIT,
+                               VK_IMAGE_LAYOUT_UNDEFINED,
+                               0,
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+  gsk_vulkan_image_ensure_view (self, VK_FORMAT_R8G8B8A8_UNORM);
+
+  return self;
+}
+
 GdkTexture *
 gsk_vulkan_image_download (GskVulkanImage    *self,
                            GskVulkanUploader *uploader)
@@ -53,6 +53,9 @@ GskVulkanImage *        gsk_vulkan_image_new_for_atlas                  (GdkVulk
 GskVulkanImage *        gsk_vulkan_image_new_for_texture                (GdkVulkanContext       *context,
                                                                          gsize                   width,
                                                                          gsize                   height);
+GskVulkanImage *        gsk_vulkan_image_new_for_storage                (GdkVulkanContext       *context,
+                                                                         gsize                   width,
+                                                                         gsize                   height);
 
 GdkTexture *            gsk_vulkan_image_download                       (GskVulkanImage         *self,
                                                                          GskVulkanUploader      *uploader);
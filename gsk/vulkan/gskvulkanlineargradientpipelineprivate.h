@@ -18,6 +18,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanLinearGradientPipeline, gsk_vulkan_linear_gradien
 
 GskVulkanPipeline *     gsk_vulkan_linear_gradient_pipeline_new         (GdkVulkanContext               *context,
                                                                          VkPipelineLayout                layout,
+                                                                         VkPipelineCache                 cache,
                                                                          const char                     *shader_name,
                                                                          VkRenderPass                    render_pass);
 
@@ -3,6 +3,39 @@
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanmemoryprivate.h"
 
+/* Allocations up to MAX_SUBALLOCATION_SIZE are carved out of blocks of
+ * BLOCK_SIZE bytes with a buddy allocator, so that we don't need one
+ * vkAllocateMemory() per buffer or image. Bigger ones get their own
+ * VkDeviceMemory.
+ */
+#define MIN_ORDER 8   /* 256 bytes */
+#define MAX_ORDER 24  /* 16 MiB */
+#define N_ORDERS (MAX_ORDER - MIN_ORDER + 1)
+#define BLOCK_SIZE ((VkDeviceSize) 1 << MAX_ORDER)
+#define MAX_SUBALLOCATION_SIZE (BLOCK_SIZE / 4)
+
+typedef struct _GskVulkanMemoryBlock GskVulkanMemoryBlock;
+typedef struct _GskVulkanAllocator GskVulkanAllocator;
+
+struct _GskVulkanMemoryBlock
+{
+  VkDeviceMemory vk_memory;
+  guchar *map;
+
+  /* Offsets of the free chunks of each order */
+  GArray *free_chunks[N_ORDERS];
+
+  gsize n_allocations;
+};
+
+struct _GskVulkanAllocator
+{
+  /* Linear and optimally tiled resources are kept in separate blocks,
+   * so that we don't have to care about bufferImageGranularity.
+   */
+  GPtrArray *blocks[VK_MAX_MEMORY_TYPES][2];
+};
+
 struct _GskVulkanMemory
 {
   GdkVulkanContext *vulkan;
@@ -10,13 +43,196 @@ struct _GskVulkanMemory
   gsize size;
 
   VkDeviceMemory vk_memory;
+
+  /* Set if this memory is part of a block */
+  GskVulkanMemoryBlock *block;
+  VkDeviceSize offset;
+  guint order;
+  guint memory_type : 5;
+  guint linear : 1;
 };
 
+static void
+gsk_vulkan_allocator_free (gpointer data)
+{
+  GskVulkanAllocator *allocator = data;
+
+  /* Blocks are released in gsk_vulkan_memory_trim(), while the device
+   * still exists.
+   */
+  for (guint i = 0; i < VK_MAX_MEMORY_TYPES; i++)
+    for (guint j = 0; j < 2; j++)
+      {
+        if (allocator->blocks[i][j] != NULL && allocator->blocks[i][j]->len > 0)
+          g_warning ("Leaking %u Vulkan memory blocks", allocator->blocks[i][j]->len);
+        g_clear_pointer (&allocator->blocks[i][j], g_ptr_array_unref);
+      }
+
+  g_slice_free (GskVulkanAllocator, allocator);
+}
+
+static GskVulkanAllocator *
+gsk_vulkan_allocator_get (GdkVulkanContext *context)
+{
+  GskVulkanAllocator *allocator;
+
+  allocator = g_object_get_data (G_OBJECT (context), "gsk-vulkan-allocator");
+  if (allocator == NULL)
+    {
+      allocator = g_slice_new0 (GskVulkanAllocator);
+      g_object_set_data_full (G_OBJECT (context), "gsk-vulkan-allocator",
+                              allocator, gsk_vulkan_allocator_free);
+    }
+
+  return allocator;
+}
+
+static guint
+get_order (VkDeviceSize size,
+           VkDeviceSize alignment)
+{
+  guint order = MIN_ORDER;
+
+  /* Chunks are aligned to their size, so this also takes care of
+   * the (power of two) alignment.
+   */
+  while (((VkDeviceSize) 1 << order) < MAX (size, alignment))
+    order++;
+
+  return order;
+}
+
+static GskVulkanMemoryBlock *
+gsk_vulkan_memory_block_new (GdkVulkanContext      *context,
+                             uint32_t               memory_type,
+                             VkMemoryPropertyFlags  flags)
+{
+  GskVulkanMemoryBlock *block;
+  guint32 offset = 0;
+
+  block = g_slice_new0 (GskVulkanMemoryBlock);
+
+  GSK_VK_CHECK (vkAllocateMemory, gdk_vulkan_context_get_device (context),
+                                  &(VkMemoryAllocateInfo) {
+                                      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                                      .allocationSize = BLOCK_SIZE,
+                                      .memoryTypeIndex = memory_type
+                                  },
+                                  NULL,
+                                  &block->vk_memory);
+
+  /* Memory can only be mapped once, so keep host visible blocks mapped
+   * for all of their allocations.
+   */
+  if (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    GSK_VK_CHECK (vkMapMemory, gdk_vulkan_context_get_device (context),
+                               block->vk_memory,
+                               0,
+                               VK_WHOLE_SIZE,
+                               0,
+                               (void **) &block->map);
+
+  for (guint i = 0; i < N_ORDERS; i++)
+    block->free_chunks[i] = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+  g_array_append_val (block->free_chunks[N_ORDERS - 1], offset);
+
+  return block;
+}
+
+static void
+gsk_vulkan_memory_block_free (GdkVulkanContext     *context,
+                              GskVulkanMemoryBlock *block)
+{
+  if (block->map)
+    vkUnmapMemory (gdk_vulkan_context_get_device (context), block->vk_memory);
+
+  vkFreeMemory (gdk_vulkan_context_get_device (context),
+                block->vk_memory,
+                NULL);
+
+  for (guint i = 0; i < N_ORDERS; i++)
+    g_array_unref (block->free_chunks[i]);
+
+  g_slice_free (GskVulkanMemoryBlock, block);
+}
+
+static gboolean
+gsk_vulkan_memory_block_alloc (GskVulkanMemoryBlock *block,
+                               guint                 order,
+                               VkDeviceSize         *offset)
+{
+  guint i;
+  guint32 chunk;
+
+  for (i = order; i <= MAX_ORDER; i++)
+    {
+      if (block->free_chunks[i - MIN_ORDER]->len > 0)
+        break;
+    }
+
+  if (i > MAX_ORDER)
+    return FALSE;
+
+  chunk = g_array_index (block->free_chunks[i - MIN_ORDER], guint32,
+                         block->free_chunks[i - MIN_ORDER]->len - 1);
+  g_array_set_size (block->free_chunks[i - MIN_ORDER],
+                    block->free_chunks[i - MIN_ORDER]->len - 1);
+
+  /* Split until we have a chunk of the right size, putting the
+   * upper halves on the free lists.
+   */
+  while (i > order)
+    {
+      guint32 buddy;
+
+      i--;
+      buddy = chunk + ((guint32) 1 << i);
+      g_array_append_val (block->free_chunks[i - MIN_ORDER], buddy);
+    }
+
+  block->n_allocations++;
+  *offset = chunk;
+
+  return TRUE;
+}
+
+static void
+gsk_vulkan_memory_block_release (GskVulkanMemoryBlock *block,
+                                 guint                 order,
+                                 guint32               chunk)
+{
+  /* Merge with the buddy as long as it is free */
+  while (order < MAX_ORDER)
+    {
+      GArray *free_chunks = block->free_chunks[order - MIN_ORDER];
+      guint32 buddy = chunk ^ ((guint32) 1 << order);
+      guint i;
+
+      for (i = 0; i < free_chunks->len; i++)
+        {
+          if (g_array_index (free_chunks, guint32, i) == buddy)
+            break;
+        }
+
+      if (i == free_chunks->len)
+        break;
+
+      g_array_remove_index_fast (free_chunks, i);
+      chunk = MIN (chunk, buddy);
+      order++;
+    }
+
+  g_array_append_val (block->free_chunks[order - MIN_ORDER], chunk);
+
+  block->n_allocations--;
+}
+
 GskVulkanMemory *
-gsk_vulkan_memory_new (GdkVulkanContext      *context,
-                       uint32_t               allowed_types,
-                       VkMemoryPropertyFlags  flags,
-                       gsize                  size)
+gsk_vulkan_memory_new (GdkVulkanContext           *context,
+                       const VkMemoryRequirements *requirements,
+                       VkMemoryPropertyFlags       flags,
+                       gboolean                    linear)
 {
   VkPhysicalDeviceMemoryProperties properties;
   GskVulkanMemory *self;
@@ -25,14 +241,15 @@ gsk_vulkan_memory_new (GdkVulkanContext      *context,
   self = g_slice_new0 (GskVulkanMemory);
 
   self->vulkan = g_object_ref (context);
-  self->size = size;
+  self->size = requirements->size;
+  self->linear = !!linear;
 
   vkGetPhysicalDeviceMemoryProperties (gdk_vulkan_context_get_physical_device (context),
                                        &properties);
 
   for (i = 0; i < properties.memoryTypeCount; i++)
     {
-      if (!(allowed_types & (1 << i)))
+      if (!(requirements->memoryTypeBits & (1 << i)))
         continue;
 
       if ((properties.memoryTypes[i].propertyFlags & flags) == flags)
@@ -41,10 +258,53 @@ gsk_vulkan_memory_new (GdkVulkanContext      *context,
 
   g_assert (i < properties.memoryTypeCount);
 
+  self->memory_type = i;
+
+  if (requirements->size <= MAX_SUBALLOCATION_SIZE &&
+      requirements->alignment <= MAX_SUBALLOCATION_SIZE)
+    {
+      GskVulkanAllocator *allocator = gsk_vulkan_allocator_get (context);
+      GPtrArray *blocks;
+      guint order = get_order (requirements->size, requirements->alignment);
+
+      if (allocator->blocks[i][self->linear] == NULL)
+        allocator->blocks[i][self->linear] = g_ptr_array_new ();
+      blocks = allocator->blocks[i][self->linear];
+
+      for (guint j = 0; j < blocks->len; j++)
+        {
+          GskVulkanMemoryBlock *block = g_ptr_array_index (blocks, j);
+
+          if (gsk_vulkan_memory_block_alloc (block, order, &self->offset))
+            {
+              self->block = block;
+              break;
+            }
+        }
+
+      if (self->block == NULL)
+        {
+          GskVulkanMemoryBlock *block;
+
+          block = gsk_vulkan_memory_block_new (context, i, properties.memoryTypes[i].propertyFlags);
+          g_ptr_array_add (blocks, block);
+
+          if (!gsk_vulkan_memory_block_alloc (block, order, &self->offset))
+            g_assert_not_reached ();
+
+          self->block = block;
+        }
+
+      self->order = order;
+      self->vk_memory = self->block->vk_memory;
+
+      return self;
+    }
+
   GSK_VK_CHECK (vkAllocateMemory, gdk_vulkan_context_get_device (context),
                                   &(VkMemoryAllocateInfo) {
                                       .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-                                      .allocationSize = size,
+                                      .allocationSize = requirements->size,
                                       .memoryTypeIndex = i
                                   },
                                   NULL,
@@ -56,26 +316,97 @@ gsk_vulkan_memory_new (GdkVulkanContext      *context,
 void
 gsk_vulkan_memory_free (GskVulkanMemory *self)
 {
-  vkFreeMemory (gdk_vulkan_context_get_device (self->vulkan),
-                self->vk_memory,
-                NULL);
+  if (self->block)
+    {
+      GskVulkanAllocator *allocator = gsk_vulkan_allocator_get (self->vulkan);
+      GPtrArray *blocks = allocator->blocks[self->memory_type][self->linear];
+
+      gsk_vulkan_memory_block_release (self->block, self->order, self->offset);
+
+      /* Keep the first block around when it becomes empty, as buffers
+       * are freed and allocated again every frame.
+       */
+      if (self->block->n_allocations == 0 &&
+          g_ptr_array_index (blocks, 0) != self->block)
+        {
+          g_ptr_array_remove_fast (blocks, self->block);
+          gsk_vulkan_memory_block_free (self->vulkan, self->block);
+        }
+    }
+  else
+    {
+      vkFreeMemory (gdk_vulkan_context_get_device (self->vulkan),
+                    self->vk_memory,
+                    NULL);
+    }
 
   g_object_unref (self->vulkan);
 
   g_slice_free (GskVulkanMemory, self);
 }
 
+/**
+ * gsk_vulkan_memory_trim:
+ * @context: a `GdkVulkanContext`
+ *
+ * Releases all memory blocks of @context that don't hold any allocations.
+ *
+ * This must be called before the last reference to @context is dropped.
+ */
+void
+gsk_vulkan_memory_trim (GdkVulkanContext *context)
+{
+  GskVulkanAllocator *allocator;
+
+  allocator = g_object_get_data (G_OBJECT (context), "gsk-vulkan-allocator");
+  if (allocator == NULL)
+    return;
+
+  for (guint i = 0; i < VK_MAX_MEMORY_TYPES; i++)
+    for (guint j = 0; j < 2; j++)
+      {
+        GPtrArray *blocks = allocator->blocks[i][j];
+
+        if (blocks == NULL)
+          continue;
+
+        for (guint k = blocks->len; k > 0; k--)
+          {
+            GskVulkanMemoryBlock *block = g_ptr_array_index (blocks, k - 1);
+
+            if (block->n_allocations > 0)
+              continue;
+
+            g_ptr_array_remove_index (blocks, k - 1);
+            gsk_vulkan_memory_block_free (context, block);
+          }
+      }
+}
+
 VkDeviceMemory
 gsk_vulkan_memory_get_device_memory (GskVulkanMemory *self)
 {
   return self->vk_memory;
 }
 
+VkDeviceSize
+gsk_vulkan_memory_get_offset (GskVulkanMemory *self)
+{
+  return self->offset;
+}
+
 guchar *
 gsk_vulkan_memory_map (GskVulkanMemory *self)
 {
   void *data;
 
+  if (self->block)
+    {
+      g_assert (self->block->map != NULL);
+
+      return self->block->map + self->offset;
+    }
+
   GSK_VK_CHECK (vkMapMemory, gdk_vulkan_context_get_device (self->vulkan),
                              self->vk_memory,
                              0,
@@ -89,6 +420,10 @@ gsk_vulkan_memory_map (GskVulkanMemory *self)
 void
 gsk_vulkan_memory_unmap (GskVulkanMemory *self)
 {
+  /* Blocks stay mapped */
+  if (self->block)
+    return;
+
   vkUnmapMemory (gdk_vulkan_context_get_device (self->vulkan),
                  self->vk_memory);
 }
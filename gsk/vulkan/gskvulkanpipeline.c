@@ -57,10 +57,11 @@ GskVulkanPipeline *
 gsk_vulkan_pipeline_new (GType                    pipeline_type,
                          GdkVulkanContext        *context,
                          VkPipelineLayout         layout,
+                         VkPipelineCache          cache,
                          const char              *shader_name,
                          VkRenderPass             render_pass)
 {
-  return gsk_vulkan_pipeline_new_full (pipeline_type, context, layout, shader_name, render_pass,
+  return gsk_vulkan_pipeline_new_full (pipeline_type, context, layout, cache, shader_name, render_pass,
                                        VK_BLEND_FACTOR_ONE,
                                        VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA);
 }
@@ -69,6 +70,7 @@ GskVulkanPipeline *
 gsk_vulkan_pipeline_new_full (GType                    pipeline_type,
                               GdkVulkanContext        *context,
                               VkPipelineLayout         layout,
+                              VkPipelineCache          cache,
                               const char              *shader_name,
                               VkRenderPass             render_pass,
                               VkBlendFactor            srcBlendFactor,
@@ -96,7 +98,7 @@ gsk_vulkan_pipeline_new_full (GType                    pipeline_type,
   priv->fragment_shader = gsk_vulkan_shader_new_from_resource (context, GSK_VULKAN_SHADER_FRAGMENT, shader_name, NULL);
 
   GSK_VK_CHECK (vkCreateGraphicsPipelines, device,
-                                           VK_NULL_HANDLE,
+                                           cache,
                                            1,
                                            &(VkGraphicsPipelineCreateInfo) {
                                                .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
@@ -35,11 +35,13 @@ gsk_vulkan_handle_result (VkResult    res,
 GskVulkanPipeline *     gsk_vulkan_pipeline_new                         (GType                           pipeline_type,
                                                                          GdkVulkanContext               *context,
                                                                          VkPipelineLayout                layout,
+                                                                         VkPipelineCache                 cache,
                                                                          const char                     *shader_name,
                                                                          VkRenderPass                    render_pass);
 GskVulkanPipeline *     gsk_vulkan_pipeline_new_full                    (GType                           pipeline_type,
                                                                          GdkVulkanContext               *context,
                                                                          VkPipelineLayout                layout,
+                                                                         VkPipelineCache                 cache,
                                                                          const char                     *shader_name,
                                                                          VkRenderPass                    render_pass,
                                                                          VkBlendFactor                   srcBlendFactor,
@@ -21,11 +21,36 @@
 #include "gskvulkanlineargradientpipelineprivate.h"
 #include "gskvulkantextpipelineprivate.h"
 #include "gskvulkantexturepipelineprivate.h"
+#include "gskvulkanuberpipelineprivate.h"
 #include "gskvulkanpushconstantsprivate.h"
 
+#include <string.h>
+
 #define DESCRIPTOR_POOL_MAXSETS 128
 #define DESCRIPTOR_POOL_MAXSETS_INCREASE 128
 
+/* Below this number of render passes, recording them on the main
+ * thread is faster than handing them to worker threads.
+ */
+#define MIN_PASSES_FOR_THREADS 4
+
+/* Everything needed to create pipelines. It is shared by all the
+ * renders of a renderer, so that frames in flight don't each build
+ * their own copy of every pipeline.
+ */
+struct _GskVulkanPipelines
+{
+  GdkVulkanContext *vulkan;
+
+  VkRenderPass render_pass;
+  VkDescriptorSetLayout descriptor_set_layout;
+  VkPipelineLayout pipeline_layout[3]; /* indexed by number of textures */
+  VkPipelineCache pipeline_cache;
+  char *pipeline_cache_path;
+  char *pipeline_cache_checksum; /* of the data that was loaded, or NULL */
+  GskVulkanPipeline *pipelines[GSK_VULKAN_N_PIPELINES];
+};
+
 struct _GskVulkanRender
 {
   GskRenderer *renderer;
@@ -37,10 +62,12 @@ struct _GskVulkanRender
 
   GHashTable *framebuffers;
   GskVulkanCommandPool *command_pool;
+  /* Command pools for recording render passes in worker threads,
+   * one per pass.
+   */
+  GPtrArray *pass_command_pools;
   VkFence fence;
-  VkRenderPass render_pass;
-  VkDescriptorSetLayout descriptor_set_layout;
-  VkPipelineLayout pipeline_layout[3]; /* indexed by number of textures */
+  GskVulkanPipelines *pipelines;
   GskVulkanUploader *uploader;
 
   GHashTable *descriptor_set_indexes;
@@ -48,7 +75,11 @@ struct _GskVulkanRender
   uint32_t descriptor_pool_maxsets;
   VkDescriptorSet *descriptor_sets;
   gsize n_descriptor_sets;
-  GskVulkanPipeline *pipelines[GSK_VULKAN_N_PIPELINES];
+  GskVulkanComputeBlur *compute_blur;
+  gboolean compute_blur_checked;
+  gboolean use_ubershader;
+  /* bound for ubershader ops that don't sample */
+  GskVulkanImage *dummy_image;
 
   GskVulkanImage *target;
 
@@ -60,8 +91,20 @@ struct _GskVulkanRender
 
   GQuark render_pass_counter;
   GQuark gpu_time_timer;
+
+  GMutex record_lock;
+  GCond record_cond;
+  guint n_pending_records;
 };
 
+typedef struct
+{
+  GskVulkanRender *render;
+  GskVulkanRenderPass *pass;
+  GskVulkanCommandPool *command_pool;
+  VkCommandBuffer command_buffer;
+} RecordJob;
+
 static void
 gsk_vulkan_render_setup (GskVulkanRender       *self,
                          GskVulkanImage        *target,
@@ -106,46 +149,142 @@ gsk_vulkan_render_setup (GskVulkanRender       *self,
 static guint desc_set_index_hash (gconstpointer v);
 static gboolean desc_set_index_equal (gconstpointer v1, gconstpointer v2);
 
-GskVulkanRender *
-gsk_vulkan_render_new (GskRenderer      *renderer,
-                       GdkVulkanContext *context)
+static char *
+get_pipeline_cache_path (const VkPhysicalDeviceProperties *props)
 {
-  GskVulkanRender *self;
-  VkDevice device;
+  GString *basename;
+  char *path;
 
-  self = g_slice_new0 (GskVulkanRender);
+  /* Cache data is only valid for the device and driver version
+   * that created it.
+   */
+  basename = g_string_new (NULL);
+  g_string_append_printf (basename, "%04x-%04x-%08x-",
+                          props->vendorID, props->deviceID, props->driverVersion);
+  for (guint i = 0; i < VK_UUID_SIZE; i++)
+    g_string_append_printf (basename, "%02x", props->pipelineCacheUUID[i]);
+  g_string_append (basename, ".bin");
 
-  self->vulkan = context;
-  self->renderer = renderer;
-  self->framebuffers = g_hash_table_new (g_direct_hash, g_direct_equal);
-  self->descriptor_set_indexes = g_hash_table_new_full (desc_set_index_hash, desc_set_index_equal, NULL, g_free);
+  path = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "vulkan-pipelines", basename->str, NULL);
 
-  device = gdk_vulkan_context_get_device (self->vulkan);
+  g_string_free (basename, TRUE);
 
-  self->command_pool = gsk_vulkan_command_pool_new (self->vulkan);
-  GSK_VK_CHECK (vkCreateFence, device,
-                               &(VkFenceCreateInfo) {
-                                   .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-                                   .flags = VK_FENCE_CREATE_SIGNALED_BIT
-                               },
-                               NULL,
-                               &self->fence);
+  return path;
+}
 
-  self->descriptor_pool_maxsets = DESCRIPTOR_POOL_MAXSETS;
-  GSK_VK_CHECK (vkCreateDescriptorPool, device,
-                                        &(VkDescriptorPoolCreateInfo) {
-                                            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-                                            .maxSets = self->descriptor_pool_maxsets,
-                                            .poolSizeCount = 1,
-                                            .pPoolSizes = (VkDescriptorPoolSize[1]) {
-                                                {
-                                                    .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                                                    .descriptorCount = self->descriptor_pool_maxsets
-                                                }
-                                            }
-                                        },
-                                        NULL,
-                                        &self->descriptor_pool);
+static gboolean
+pipeline_cache_data_is_valid (const guchar                     *data,
+                              gsize                             len,
+                              const VkPhysicalDeviceProperties *props)
+{
+  guint32 header[4];
+
+  /* Drivers are supposed to reject foreign data themselves, but better
+   * not rely on that. This is the VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+   * header: length, version, vendor and device, followed by the UUID.
+   */
+  if (len < sizeof header + VK_UUID_SIZE)
+    return FALSE;
+
+  memcpy (header, data, sizeof header);
+
+  return header[0] >= sizeof header + VK_UUID_SIZE &&
+         header[0] <= len &&
+         header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header[2] == props->vendorID &&
+         header[3] == props->deviceID &&
+         memcmp (data + sizeof header, props->pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+static void
+gsk_vulkan_pipelines_load_cache (GskVulkanPipelines *self)
+{
+  VkPhysicalDeviceProperties props;
+  char *contents = NULL;
+  gsize len = 0;
+
+  vkGetPhysicalDeviceProperties (gdk_vulkan_context_get_physical_device (self->vulkan), &props);
+
+  self->pipeline_cache_path = get_pipeline_cache_path (&props);
+
+  if (g_file_get_contents (self->pipeline_cache_path, &contents, &len, NULL) &&
+      !pipeline_cache_data_is_valid ((guchar *) contents, len, &props))
+    {
+      g_clear_pointer (&contents, g_free);
+      len = 0;
+    }
+
+  if (contents)
+    self->pipeline_cache_checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256, (guchar *) contents, len);
+
+  GSK_VK_CHECK (vkCreatePipelineCache, gdk_vulkan_context_get_device (self->vulkan),
+                                       &(VkPipelineCacheCreateInfo) {
+                                           .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+                                           .initialDataSize = len,
+                                           .pInitialData = contents,
+                                       },
+                                       NULL,
+                                       &self->pipeline_cache);
+
+  g_free (contents);
+}
+
+static void
+gsk_vulkan_pipelines_save_cache (GskVulkanPipelines *self)
+{
+  VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+  gsize len = 0;
+  char *contents;
+  char *checksum;
+  char *dir;
+
+  if (vkGetPipelineCacheData (device, self->pipeline_cache, &len, NULL) != VK_SUCCESS || len == 0)
+    return;
+
+  contents = g_malloc (len);
+
+  if (vkGetPipelineCacheData (device, self->pipeline_cache, &len, contents) != VK_SUCCESS)
+    {
+      g_free (contents);
+      return;
+    }
+
+  /* Creating pipelines that were found in the cache doesn't change
+   * its data, so only write it when the driver added something.
+   */
+  checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256, (guchar *) contents, len);
+  if (g_strcmp0 (checksum, self->pipeline_cache_checksum) != 0)
+    {
+      dir = g_path_get_dirname (self->pipeline_cache_path);
+      if (g_mkdir_with_parents (dir, 0755) == 0)
+        g_file_set_contents (self->pipeline_cache_path, contents, len, NULL);
+      g_free (dir);
+    }
+
+  g_free (checksum);
+  g_free (contents);
+}
+
+/*<private>
+ * gsk_vulkan_pipelines_new:
+ * @context: the `GdkVulkanContext` to create pipelines for
+ *
+ * Creates the render pass, layouts and pipeline cache that the
+ * renders of one renderer share. Pipelines are created on first use.
+ *
+ * Returns: (transfer full): a new `GskVulkanPipelines`
+ */
+GskVulkanPipelines *
+gsk_vulkan_pipelines_new (GdkVulkanContext *context)
+{
+  GskVulkanPipelines *self;
+  VkDevice device;
+
+  self = g_slice_new0 (GskVulkanPipelines);
+
+  self->vulkan = g_object_ref (context);
+
+  device = gdk_vulkan_context_get_device (self->vulkan);
 
   GSK_VK_CHECK (vkCreateRenderPass, gdk_vulkan_context_get_device (self->vulkan),
                                     &(VkRenderPassCreateInfo) {
@@ -223,6 +362,93 @@ gsk_vulkan_render_new (GskRenderer      *renderer,
                                             &self->pipeline_layout[i]);
     }
 
+  gsk_vulkan_pipelines_load_cache (self);
+
+  return self;
+}
+
+void
+gsk_vulkan_pipelines_free (GskVulkanPipelines *self)
+{
+  VkDevice device;
+  guint i;
+
+  device = gdk_vulkan_context_get_device (self->vulkan);
+
+  for (i = 0; i < GSK_VULKAN_N_PIPELINES; i++)
+    g_clear_object (&self->pipelines[i]);
+
+  gsk_vulkan_pipelines_save_cache (self);
+  vkDestroyPipelineCache (device,
+                          self->pipeline_cache,
+                          NULL);
+  g_free (self->pipeline_cache_path);
+  g_free (self->pipeline_cache_checksum);
+
+  for (i = 0; i < 3; i++)
+    vkDestroyPipelineLayout (device,
+                             self->pipeline_layout[i],
+                             NULL);
+
+  vkDestroyRenderPass (device,
+                       self->render_pass,
+                       NULL);
+
+  vkDestroyDescriptorSetLayout (device,
+                                self->descriptor_set_layout,
+                                NULL);
+
+  g_object_unref (self->vulkan);
+
+  g_slice_free (GskVulkanPipelines, self);
+}
+
+GskVulkanRender *
+gsk_vulkan_render_new (GskRenderer        *renderer,
+                       GdkVulkanContext   *context,
+                       GskVulkanPipelines *pipelines)
+{
+  GskVulkanRender *self;
+  VkDevice device;
+
+  self = g_slice_new0 (GskVulkanRender);
+
+  self->vulkan = context;
+  self->renderer = renderer;
+  self->pipelines = pipelines;
+  self->framebuffers = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->descriptor_set_indexes = g_hash_table_new_full (desc_set_index_hash, desc_set_index_equal, NULL, g_free);
+
+  device = gdk_vulkan_context_get_device (self->vulkan);
+
+  self->command_pool = gsk_vulkan_command_pool_new (self->vulkan);
+  self->pass_command_pools = g_ptr_array_new_with_free_func ((GDestroyNotify) gsk_vulkan_command_pool_free);
+  g_mutex_init (&self->record_lock);
+  g_cond_init (&self->record_cond);
+  GSK_VK_CHECK (vkCreateFence, device,
+                               &(VkFenceCreateInfo) {
+                                   .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+                                   .flags = VK_FENCE_CREATE_SIGNALED_BIT
+                               },
+                               NULL,
+                               &self->fence);
+
+  self->descriptor_pool_maxsets = DESCRIPTOR_POOL_MAXSETS;
+  GSK_VK_CHECK (vkCreateDescriptorPool, device,
+                                        &(VkDescriptorPoolCreateInfo) {
+                                            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                                            .maxSets = self->descriptor_pool_maxsets,
+                                            .poolSizeCount = 1,
+                                            .pPoolSizes = (VkDescriptorPoolSize[1]) {
+                                                {
+                                                    .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                    .descriptorCount = self->descriptor_pool_maxsets
+                                                }
+                                            }
+                                        },
+                                        NULL,
+                                        &self->descriptor_pool);
+
   GSK_VK_CHECK (vkCreateSampler, device,
                                  &(VkSamplerCreateInfo) {
                                      .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
@@ -255,6 +481,9 @@ gsk_vulkan_render_new (GskRenderer      *renderer,
 
   self->uploader = gsk_vulkan_uploader_new (self->vulkan, self->command_pool);
 
+  self->use_ubershader = g_getenv ("GSK_VULKAN_UBERSHADER") != NULL &&
+                         gsk_vulkan_uber_pipeline_is_available ();
+
 #ifdef G_ENABLE_DEBUG
   self->render_pass_counter = g_quark_from_static_string ("render-passes");
   self->gpu_time_timer = g_quark_from_static_string ("gpu-time");
@@ -298,7 +527,7 @@ gsk_vulkan_render_get_framebuffer (GskVulkanRender *self,
   GSK_VK_CHECK (vkCreateFramebuffer, gdk_vulkan_context_get_device (self->vulkan),
                                      &(VkFramebufferCreateInfo) {
                                          .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-                                         .renderPass = self->render_pass,
+                                         .renderPass = self->pipelines->render_pass,
                                          .attachmentCount = 1,
                                          .pAttachments = (VkImageView[1]) {
                                              gsk_vulkan_image_get_image_view (image)
@@ -380,7 +609,7 @@ gsk_vulkan_render_get_pipeline (GskVulkanRender       *self,
   static const struct {
     const char *name;
     guint num_textures;
-    GskVulkanPipeline * (* create_func) (GdkVulkanContext *context, VkPipelineLayout layout, const char *name, VkRenderPass render_pass);
+    GskVulkanPipeline * (* create_func) (GdkVulkanContext *context, VkPipelineLayout layout, VkPipelineCache cache, const char *name, VkRenderPass render_pass);
   } pipeline_info[GSK_VULKAN_N_PIPELINES] = {
     { "texture",                    1, gsk_vulkan_texture_pipeline_new },
     { "texture-clip",               1, gsk_vulkan_texture_pipeline_new },
@@ -418,17 +647,64 @@ gsk_vulkan_render_get_pipeline (GskVulkanRender       *self,
     { "blendmode",                  2, gsk_vulkan_blend_mode_pipeline_new },
     { "blendmode-clip",             2, gsk_vulkan_blend_mode_pipeline_new },
     { "blendmode-clip-rounded",     2, gsk_vulkan_blend_mode_pipeline_new },
+    { "uber",                       1, gsk_vulkan_uber_pipeline_new },
+    { "uber-clip",                  1, gsk_vulkan_uber_pipeline_new },
+    { "uber-clip-rounded",          1, gsk_vulkan_uber_pipeline_new },
   };
 
   g_return_val_if_fail (type < GSK_VULKAN_N_PIPELINES, NULL);
 
-  if (self->pipelines[type] == NULL)
-    self->pipelines[type] = pipeline_info[type].create_func (self->vulkan,
-                                                             self->pipeline_layout[pipeline_info[type].num_textures],
-                                                             pipeline_info[type].name,
-                                                             self->render_pass);
+  /* Pipelines are created on first use, and the cache makes that cheap
+   * for every pipeline that was used in an earlier run.
+   */
+  if (self->pipelines->pipelines[type] == NULL)
+    {
+      GskVulkanPipelines *pipelines = self->pipelines;
+
+      pipelines->pipelines[type] = pipeline_info[type].create_func (self->vulkan,
+                                                                    pipelines->pipeline_layout[pipeline_info[type].num_textures],
+                                                                    pipelines->pipeline_cache,
+                                                                    pipeline_info[type].name,
+                                                                    pipelines->render_pass);
+    }
+
+  return self->pipelines->pipelines[type];
+}
+
+/* Whether color, texture and color matrix ops all go through the
+ * uber pipelines, so they can be drawn in fewer calls.
+ */
+gboolean
+gsk_vulkan_render_uses_ubershader (GskVulkanRender *self)
+{
+  return self->use_ubershader;
+}
+
+GskVulkanImage *
+gsk_vulkan_render_get_dummy_image (GskVulkanRender   *self,
+                                   GskVulkanUploader *uploader)
+{
+  if (self->dummy_image == NULL)
+    self->dummy_image = gsk_vulkan_image_new_from_data (uploader,
+                                                        (guchar[4]) { 0, 0, 0, 0 },
+                                                        1, 1, 4);
+
+  return self->dummy_image;
+}
+
+/* Returns NULL if the compute shaders were not built */
+GskVulkanComputeBlur *
+gsk_vulkan_render_get_compute_blur (GskVulkanRender *self)
+{
+  if (!self->compute_blur_checked)
+    {
+      self->compute_blur = gsk_vulkan_compute_blur_new (self->vulkan,
+                                                        self->pipelines->pipeline_cache,
+                                                        self->sampler);
+      self->compute_blur_checked = TRUE;
+    }
 
-  return self->pipelines[type];
+  return self->compute_blur;
 }
 
 VkDescriptorSet
@@ -547,7 +823,7 @@ gsk_vulkan_render_prepare_descriptor_sets (GskVulkanRender *self)
 
   VkDescriptorSetLayout *layouts = g_newa (VkDescriptorSetLayout, needed_sets);
   for (i = 0; i < needed_sets; i++)
-    layouts[i] = self->descriptor_set_layout;
+    layouts[i] = self->pipelines->descriptor_set_layout;
 
   GSK_VK_CHECK (vkAllocateDescriptorSets, device,
                                           &(VkDescriptorSetAllocateInfo) {
@@ -587,10 +863,88 @@ gsk_vulkan_render_prepare_descriptor_sets (GskVulkanRender *self)
     }
 }
 
+static void
+gsk_vulkan_render_record_pass (gpointer data,
+                               gpointer user_data)
+{
+  RecordJob *job = data;
+  GskVulkanRender *self = job->render;
+
+  job->command_buffer = gsk_vulkan_command_pool_get_buffer (job->command_pool);
+  gsk_vulkan_render_pass_draw (job->pass, self, 3, self->pipelines->pipeline_layout, job->command_buffer);
+
+  g_mutex_lock (&self->record_lock);
+  self->n_pending_records--;
+  if (self->n_pending_records == 0)
+    g_cond_signal (&self->record_cond);
+  g_mutex_unlock (&self->record_lock);
+}
+
+/* Records all render passes into their own command buffers, spread
+ * over worker threads. They are still submitted in order, with the
+ * same semaphores, from the main thread.
+ */
+static RecordJob *
+gsk_vulkan_render_record_passes (GskVulkanRender *self,
+                                 guint            n_passes)
+{
+  static GThreadPool *thread_pool;
+  RecordJob *jobs;
+  GList *l;
+  guint i;
+
+  if (g_once_init_enter (&thread_pool))
+    {
+      GThreadPool *pool = g_thread_pool_new (gsk_vulkan_render_record_pass, NULL,
+                                             MIN (g_get_num_processors (), 8),
+                                             FALSE, NULL);
+      g_once_init_leave (&thread_pool, pool);
+    }
+
+  jobs = g_new0 (RecordJob, n_passes);
+
+  self->n_pending_records = 0;
+
+  for (l = self->render_passes, i = 0; l; l = l->next, i++)
+    {
+      /* Everything shared between the passes has to be created here,
+       * so the workers only read from the render.
+       */
+      gsk_vulkan_render_pass_prepare_draw (l->data, self);
+
+      if (i >= self->pass_command_pools->len)
+        g_ptr_array_add (self->pass_command_pools, gsk_vulkan_command_pool_new (self->vulkan));
+
+      jobs[i].render = self;
+      jobs[i].pass = l->data;
+      jobs[i].command_pool = g_ptr_array_index (self->pass_command_pools, i);
+
+      /* Merged passes are recorded with the pass they are merged into */
+      if (!gsk_vulkan_render_pass_is_merged (l->data))
+        self->n_pending_records++;
+    }
+
+  for (i = 0; i < n_passes; i++)
+    {
+      if (!gsk_vulkan_render_pass_is_merged (jobs[i].pass))
+        g_thread_pool_push (thread_pool, &jobs[i], NULL);
+    }
+
+  g_mutex_lock (&self->record_lock);
+  while (self->n_pending_records > 0)
+    g_cond_wait (&self->record_cond, &self->record_lock);
+  g_mutex_unlock (&self->record_lock);
+
+  return jobs;
+}
+
 void
 gsk_vulkan_render_draw (GskVulkanRender *self)
 {
+  RecordJob *jobs = NULL;
+  guint n_passes;
   GList *l;
+  guint i;
 
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (self->renderer, SYNC))
@@ -599,7 +953,11 @@ gsk_vulkan_render_draw (GskVulkanRender *self)
 
   gsk_vulkan_render_prepare_descriptor_sets (self);
 
-  for (l = self->render_passes; l; l = l->next)
+  n_passes = g_list_length (self->render_passes);
+  if (n_passes >= MIN_PASSES_FOR_THREADS)
+    jobs = gsk_vulkan_render_record_passes (self, n_passes);
+
+  for (l = self->render_passes, i = 0; l; l = l->next, i++)
     {
       GskVulkanRenderPass *pass = l->data;
       VkCommandBuffer command_buffer;
@@ -608,12 +966,24 @@ gsk_vulkan_render_draw (GskVulkanRender *self)
       VkSemaphore *wait_semaphores;
       VkSemaphore *signal_semaphores;
 
+      if (gsk_vulkan_render_pass_is_merged (pass))
+        continue;
+
+      if (jobs == NULL)
+        gsk_vulkan_render_pass_prepare_draw (pass, self);
+
       wait_semaphore_count = gsk_vulkan_render_pass_get_wait_semaphores (pass, &wait_semaphores);
       signal_semaphore_count = gsk_vulkan_render_pass_get_signal_semaphores (pass, &signal_semaphores);
 
-      command_buffer = gsk_vulkan_command_pool_get_buffer (self->command_pool);
-
-      gsk_vulkan_render_pass_draw (pass, self, 3, self->pipeline_layout, command_buffer);
+      if (jobs != NULL)
+        {
+          command_buffer = jobs[i].command_buffer;
+        }
+      else
+        {
+          command_buffer = gsk_vulkan_command_pool_get_buffer (self->command_pool);
+          gsk_vulkan_render_pass_draw (pass, self, 3, self->pipelines->pipeline_layout, command_buffer);
+        }
 
       gsk_vulkan_command_pool_submit_buffer (self->command_pool,
                                              command_buffer,
@@ -624,6 +994,8 @@ gsk_vulkan_render_draw (GskVulkanRender *self)
                                              l->next != NULL ? VK_NULL_HANDLE : self->fence);
     }
 
+  g_free (jobs);
+
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (self->renderer, SYNC))
     {
@@ -670,11 +1042,15 @@ gsk_vulkan_render_cleanup (GskVulkanRender *self)
   gsk_vulkan_uploader_reset (self->uploader);
 
   gsk_vulkan_command_pool_reset (self->command_pool);
+  for (guint i = 0; i < self->pass_command_pools->len; i++)
+    gsk_vulkan_command_pool_reset (g_ptr_array_index (self->pass_command_pools, i));
 
   g_hash_table_remove_all (self->descriptor_set_indexes);
   GSK_VK_CHECK (vkResetDescriptorPool, device,
                                        self->descriptor_pool,
                                        0);
+  if (self->compute_blur)
+    gsk_vulkan_compute_blur_reset (self->compute_blur);
 
   g_list_free_full (self->render_passes, (GDestroyNotify) gsk_vulkan_render_pass_free);
   self->render_passes = NULL;
@@ -691,7 +1067,6 @@ gsk_vulkan_render_free (GskVulkanRender *self)
   GHashTableIter iter;
   gpointer key, value;
   VkDevice device;
-  guint i;
   
   gsk_vulkan_render_cleanup (self);
 
@@ -711,30 +1086,17 @@ gsk_vulkan_render_free (GskVulkanRender *self)
     }
   g_hash_table_unref (self->framebuffers);
 
-  for (i = 0; i < GSK_VULKAN_N_PIPELINES; i++)
-    g_clear_object (&self->pipelines[i]);
+  g_clear_pointer (&self->compute_blur, gsk_vulkan_compute_blur_free);
+  g_clear_object (&self->dummy_image);
 
   g_clear_pointer (&self->uploader, gsk_vulkan_uploader_free);
 
-  for (i = 0; i < 3; i++)
-    vkDestroyPipelineLayout (device,
-                             self->pipeline_layout[i],
-                             NULL);
-
-  vkDestroyRenderPass (device,
-                       self->render_pass,
-                       NULL);
-
   vkDestroyDescriptorPool (device,
                            self->descriptor_pool,
                            NULL);
   g_free (self->descriptor_sets);
   g_hash_table_unref (self->descriptor_set_indexes);
 
-  vkDestroyDescriptorSetLayout (device,
-                                self->descriptor_set_layout,
-                                NULL);
-
   vkDestroyFence (device,
                   self->fence,
                   NULL);
@@ -748,6 +1110,9 @@ gsk_vulkan_render_free (GskVulkanRender *self)
                     NULL);
 
   gsk_vulkan_command_pool_free (self->command_pool);
+  g_ptr_array_unref (self->pass_command_pools);
+  g_mutex_clear (&self->record_lock);
+  g_cond_clear (&self->record_cond);
 
   g_slice_free (GskVulkanRender, self);
 }
@@ -8,11 +8,13 @@
 #include "gskrendernodeprivate.h"
 #include "gskvulkanbufferprivate.h"
 #include "gskvulkanimageprivate.h"
+#include "gskvulkanmemoryprivate.h"
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanrenderprivate.h"
 #include "gskvulkanglyphcacheprivate.h"
 
 #include "gdk/gdktextureprivate.h"
+#include "gdk/gdkframeclockprivate.h"
 #include "gdk/gdkprofilerprivate.h"
 
 #include <graphene.h>
@@ -42,6 +44,13 @@ static guint texture_pixels_counter;
 static guint fallback_pixels_counter;
 #endif
 
+/* Each frame in flight has its own GskVulkanRender, so that recording
+ * a frame doesn't have to wait for the GPU to finish the previous one.
+ * The number can be changed with GSK_VULKAN_FRAMES_IN_FLIGHT.
+ */
+#define DEFAULT_FRAMES_IN_FLIGHT 2
+#define MAX_FRAMES_IN_FLIGHT 3
+
 struct _GskVulkanRenderer
 {
   GskRenderer parent_instance;
@@ -51,7 +60,10 @@ struct _GskVulkanRenderer
   guint n_targets;
   GskVulkanImage **targets;
 
-  GskVulkanRender *render;
+  GskVulkanPipelines *pipelines;
+  GskVulkanRender *renders[MAX_FRAMES_IN_FLIGHT];
+  guint n_renders;
+  guint current_render;
 
   GSList *textures;
 
@@ -136,7 +148,18 @@ gsk_vulkan_renderer_realize (GskRenderer  *renderer,
                     self);
   gsk_vulkan_renderer_update_images_cb (self->vulkan, self);
 
-  self->render = gsk_vulkan_render_new (renderer, self->vulkan);
+  self->pipelines = gsk_vulkan_pipelines_new (self->vulkan);
+
+  self->n_renders = DEFAULT_FRAMES_IN_FLIGHT;
+  if (g_getenv ("GSK_VULKAN_FRAMES_IN_FLIGHT"))
+    {
+      guint64 n = g_ascii_strtoull (g_getenv ("GSK_VULKAN_FRAMES_IN_FLIGHT"), NULL, 10);
+
+      self->n_renders = CLAMP (n, 1, MAX_FRAMES_IN_FLIGHT);
+    }
+
+  /* The renders are created on first use */
+  self->current_render = 0;
 
   self->glyph_cache = gsk_vulkan_glyph_cache_new (renderer, self->vulkan);
 
@@ -160,13 +183,17 @@ gsk_vulkan_renderer_unrealize (GskRenderer *renderer)
     }
   g_clear_pointer (&self->textures, g_slist_free);
 
-  g_clear_pointer (&self->render, gsk_vulkan_render_free);
+  for (guint i = 0; i < G_N_ELEMENTS (self->renders); i++)
+    g_clear_pointer (&self->renders[i], gsk_vulkan_render_free);
+  g_clear_pointer (&self->pipelines, gsk_vulkan_pipelines_free);
 
   gsk_vulkan_renderer_free_targets (self);
   g_signal_handlers_disconnect_by_func(self->vulkan,
                                        gsk_vulkan_renderer_update_images_cb,
                                        self);
 
+  gsk_vulkan_memory_trim (self->vulkan);
+
   g_clear_object (&self->vulkan);
 }
 
@@ -193,7 +220,7 @@ gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
-  render = gsk_vulkan_render_new (renderer, self->vulkan);
+  render = gsk_vulkan_render_new (renderer, self->vulkan, self->pipelines);
 
   image = gsk_vulkan_image_new_for_framebuffer (self->vulkan,
                                                 ceil (viewport->size.width),
@@ -240,6 +267,8 @@ gsk_vulkan_renderer_render (GskRenderer          *renderer,
   GskVulkanRenderer *self = GSK_VULKAN_RENDERER (renderer);
   GskVulkanRender *render;
   const cairo_region_t *clip;
+  GdkFrameClock *clock;
+  gint64 before;
 #ifdef G_ENABLE_DEBUG
   GskProfiler *profiler;
   gint64 cpu_time;
@@ -253,8 +282,18 @@ gsk_vulkan_renderer_render (GskRenderer          *renderer,
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
+  clock = gdk_surface_get_frame_clock (gsk_renderer_get_surface (renderer));
+  before = _gdk_frame_clock_begin_span (clock);
+
   gdk_draw_context_begin_frame (GDK_DRAW_CONTEXT (self->vulkan), region);
-  render = self->render;
+
+  /* Take the render that was used the longest time ago. Resetting it
+   * waits for its fence, which has usually signaled by now.
+   */
+  self->current_render = (self->current_render + 1) % self->n_renders;
+  if (self->renders[self->current_render] == NULL)
+    self->renders[self->current_render] = gsk_vulkan_render_new (renderer, self->vulkan, self->pipelines);
+  render = self->renders[self->current_render];
 
   clip = gdk_draw_context_get_frame_region (GDK_DRAW_CONTEXT (self->vulkan));
   gsk_vulkan_render_reset (render, self->targets[gdk_vulkan_context_get_draw_index (self->vulkan)], NULL, clip);
@@ -263,6 +302,9 @@ gsk_vulkan_renderer_render (GskRenderer          *renderer,
 
   gsk_vulkan_render_upload (render);
 
+  _gdk_frame_clock_end_span (clock, GDK_FRAME_SPAN_RENDER, before);
+  before = _gdk_frame_clock_begin_span (clock);
+
   gsk_vulkan_render_draw (render);
 
 #ifdef G_ENABLE_DEBUG
@@ -275,6 +317,8 @@ gsk_vulkan_renderer_render (GskRenderer          *renderer,
 #endif
 
   gdk_draw_context_end_frame (GDK_DRAW_CONTEXT (self->vulkan));
+
+  _gdk_frame_clock_end_span (clock, GDK_FRAME_SPAN_SUBMIT, before);
 }
 
 static void
@@ -11,6 +11,7 @@
 #include "gsktransform.h"
 #include "gskvulkanblendmodepipelineprivate.h"
 #include "gskvulkanblurpipelineprivate.h"
+#include "gskvulkancomputeblurprivate.h"
 #include "gskvulkanborderpipelineprivate.h"
 #include "gskvulkanboxshadowpipelineprivate.h"
 #include "gskvulkanclipprivate.h"
@@ -21,6 +22,7 @@
 #include "gskvulkanlineargradientpipelineprivate.h"
 #include "gskvulkantextpipelineprivate.h"
 #include "gskvulkantexturepipelineprivate.h"
+#include "gskvulkanuberpipelineprivate.h"
 #include "gskvulkanimageprivate.h"
 #include "gskvulkanpushconstantsprivate.h"
 #include "gskvulkanrendererprivate.h"
@@ -29,10 +31,17 @@
 #define ORTHO_NEAR_PLANE        -10000
 #define ORTHO_FAR_PLANE          10000
 
+/* Offscreens up to this size that are needed by the same pass get
+ * packed into shared images and drawn in a single render pass.
+ */
+#define MAX_SHARED_OFFSCREEN_SIZE 256
+#define SHARED_OFFSCREEN_ATLAS_SIZE 1024
+
 typedef union _GskVulkanOp GskVulkanOp;
 typedef struct _GskVulkanOpRender GskVulkanOpRender;
 typedef struct _GskVulkanOpText GskVulkanOpText;
 typedef struct _GskVulkanOpPushConstants GskVulkanOpPushConstants;
+typedef struct _GskVulkanPendingOffscreen GskVulkanPendingOffscreen;
 
 typedef enum {
   /* GskVulkanOpRender */
@@ -44,6 +53,7 @@ typedef enum {
   GSK_VULKAN_OP_LINEAR_GRADIENT,
   GSK_VULKAN_OP_OPACITY,
   GSK_VULKAN_OP_BLUR,
+  GSK_VULKAN_OP_COMPUTE_BLUR,
   GSK_VULKAN_OP_COLOR_MATRIX,
   GSK_VULKAN_OP_BORDER,
   GSK_VULKAN_OP_INSET_SHADOW,
@@ -51,6 +61,7 @@ typedef enum {
   GSK_VULKAN_OP_REPEAT,
   GSK_VULKAN_OP_CROSS_FADE,
   GSK_VULKAN_OP_BLEND_MODE,
+  GSK_VULKAN_OP_UBER,
   /* GskVulkanOpText */
   GSK_VULKAN_OP_TEXT,
   GSK_VULKAN_OP_COLOR_TEXT,
@@ -98,6 +109,17 @@ struct _GskVulkanOpPushConstants
   GskVulkanPushConstants  constants; /* new constants to push */
 };
 
+/* An offscreen that gets its image once all offscreens of the pass are known */
+struct _GskVulkanPendingOffscreen
+{
+  GskVulkanRenderPass *pass;
+  graphene_rect_t     *tex_rect; /* source_rect or source2_rect of the op using it */
+  int                  width;
+  int                  height;
+  int                  x; /* position in the shared image */
+  int                  y;
+};
+
 union _GskVulkanOp
 {
   GskVulkanOpType          type;
@@ -124,6 +146,22 @@ struct _GskVulkanRenderPass
   GArray *wait_semaphores;
   GskVulkanBuffer *vertex_data;
 
+  /* Set if the target gets blurred by a compute shader after drawing */
+  GskVulkanComputeBlur *blur;
+  float blur_radius;
+  GskVulkanImage *blur_images[2];
+  VkDescriptorSet blur_descriptor_sets[2];
+
+  /* Position of the viewport in the target, when sharing it */
+  int target_x;
+  int target_y;
+  /* Set on the pass that draws a shared target: all passes drawing
+   * into it, in order. The others are set to be merged.
+   */
+  GPtrArray *merged_passes;
+  gboolean merged;
+  GArray *pending_offscreens;
+
   GQuark fallback_pixels;
   GQuark texture_pixels;
 };
@@ -144,7 +182,7 @@ gsk_vulkan_render_pass_new (GdkVulkanContext  *context,
   self->vulkan = g_object_ref (context);
   self->render_ops = g_array_new (FALSE, FALSE, sizeof (GskVulkanOp));
 
-  self->target = g_object_ref (target);
+  self->target = target ? g_object_ref (target) : NULL;
   self->scale_factor = scale_factor;
   self->clip = cairo_region_copy (clip);
   self->viewport = *viewport;
@@ -202,6 +240,7 @@ gsk_vulkan_render_pass_new (GdkVulkanContext  *context,
 
   self->signal_semaphore = signal_semaphore;
   self->wait_semaphores = g_array_new (FALSE, FALSE, sizeof (VkSemaphore));
+  self->pending_offscreens = g_array_new (FALSE, FALSE, sizeof (GskVulkanPendingOffscreen));
   self->vertex_data = NULL;
 
 #ifdef G_ENABLE_DEBUG
@@ -217,7 +256,7 @@ gsk_vulkan_render_pass_free (GskVulkanRenderPass *self)
 {
   g_array_unref (self->render_ops);
   g_object_unref (self->vulkan);
-  g_object_unref (self->target);
+  g_clear_object (&self->target);
   cairo_region_destroy (self->clip);
   vkDestroyRenderPass (gdk_vulkan_context_get_device (self->vulkan),
                        self->render_pass,
@@ -229,7 +268,8 @@ gsk_vulkan_render_pass_free (GskVulkanRenderPass *self)
                         self->signal_semaphore,
                         NULL);
   g_array_unref (self->wait_semaphores);
-
+  g_array_unref (self->pending_offscreens);
+  g_clear_pointer (&self->merged_passes, g_ptr_array_unref);
 
   g_slice_free (GskVulkanRenderPass, self);
 }
@@ -250,6 +290,35 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
   };
   GskVulkanPipelineType pipeline_type;
 
+  /* Simple nodes all share one pipeline, so runs of them can be drawn
+   * at once in the order they are painted.
+   */
+  if (gsk_vulkan_render_uses_ubershader (render))
+    {
+      switch ((guint) gsk_render_node_get_node_type (node))
+        {
+        case GSK_COLOR_NODE:
+        case GSK_TEXTURE_NODE:
+        case GSK_OPACITY_NODE:
+        case GSK_COLOR_MATRIX_NODE:
+          if (gsk_vulkan_clip_contains_rect (&constants->clip, &node->bounds))
+            pipeline_type = GSK_VULKAN_PIPELINE_UBER;
+          else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
+            pipeline_type = GSK_VULKAN_PIPELINE_UBER_CLIP;
+          else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+            pipeline_type = GSK_VULKAN_PIPELINE_UBER_CLIP_ROUNDED;
+          else
+            break;
+          op.type = GSK_VULKAN_OP_UBER;
+          op.render.pipeline = gsk_vulkan_render_get_pipeline (render, pipeline_type);
+          g_array_append_val (self->render_ops, op);
+          return;
+
+        default:
+          break;
+        }
+    }
+
   switch (gsk_render_node_get_node_type (node))
     {
     case GSK_NOT_A_RENDER_NODE:
@@ -488,6 +557,23 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
       return;
 
     case GSK_BLUR_NODE:
+      if (gsk_blur_node_get_radius (node) >= GSK_VULKAN_COMPUTE_BLUR_MIN_RADIUS &&
+          gsk_vulkan_render_get_compute_blur (render) != NULL)
+        {
+          if (gsk_vulkan_clip_contains_rect (&constants->clip, &node->bounds))
+            pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE;
+          else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
+            pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE_CLIP;
+          else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+            pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE_CLIP_ROUNDED;
+          else
+            FALLBACK ("Blur nodes can't deal with clip type %u", constants->clip.type);
+          op.type = GSK_VULKAN_OP_COMPUTE_BLUR;
+          op.render.pipeline = gsk_vulkan_render_get_pipeline (render, pipeline_type);
+          g_array_append_val (self->render_ops, op);
+          return;
+        }
+
       if (gsk_vulkan_clip_contains_rect (&constants->clip, &node->bounds))
         pipeline_type = GSK_VULKAN_PIPELINE_BLUR;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
@@ -651,6 +737,113 @@ gsk_vulkan_render_pass_add (GskVulkanRenderPass     *self,
   gsk_vulkan_render_pass_add_node (self, render, &op.constants.constants, node);
 }
 
+/* Renders @node into a new image covering @bounds (intersected with
+ * @current_clip) in a dependent render pass, and returns that pass.
+ *
+ * If @shareable is set and the image is small, the pass has no target yet.
+ * It gets packed with the other small offscreens of this pass once they
+ * are all known, and @tex_rect is adjusted to the position it ends up at.
+ * @tex_rect must be the source_rect or source2_rect of an op in this pass.
+ */
+static GskVulkanRenderPass *
+gsk_vulkan_render_pass_add_offscreen (GskVulkanRenderPass   *self,
+                                      GskVulkanRender       *render,
+                                      GskRenderNode         *node,
+                                      const graphene_rect_t *bounds,
+                                      GskVulkanClip         *current_clip,
+                                      gboolean               shareable,
+                                      graphene_rect_t       *tex_rect)
+{
+  VkSemaphore semaphore;
+  graphene_rect_t view;
+  cairo_region_t *clip;
+  GskVulkanRenderPass *pass;
+  GskVulkanImage *result;
+  graphene_rect_t clipped;
+
+  if (current_clip)
+    graphene_rect_intersection (&current_clip->rect.bounds, bounds, &clipped);
+  else
+    clipped = *bounds;
+
+  if (clipped.size.width == 0 || clipped.size.height == 0)
+    return NULL;
+
+  graphene_matrix_transform_bounds (&self->mv, &clipped, &view);
+  view.origin.x = floor (view.origin.x);
+  view.origin.y = floor (view.origin.y);
+  view.size.width = ceil (view.size.width);
+  view.size.height = ceil (view.size.height);
+
+  if (shareable &&
+      view.size.width <= MAX_SHARED_OFFSCREEN_SIZE &&
+      view.size.height <= MAX_SHARED_OFFSCREEN_SIZE)
+    result = NULL;
+  else
+    result = gsk_vulkan_image_new_for_texture (self->vulkan,
+                                               view.size.width,
+                                               view.size.height);
+
+#ifdef G_ENABLE_DEBUG
+  {
+    GskProfiler *profiler = gsk_renderer_get_profiler (gsk_vulkan_render_get_renderer (render));
+    gsk_profiler_counter_add (profiler,
+                              self->texture_pixels,
+                              view.size.width * view.size.height);
+  }
+#endif
+
+  vkCreateSemaphore (gdk_vulkan_context_get_device (self->vulkan),
+                     &(VkSemaphoreCreateInfo) {
+                       VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+                       NULL,
+                       0
+                     },
+                     NULL,
+                     &semaphore);
+
+  g_array_append_val (self->wait_semaphores, semaphore);
+
+  clip = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                                          0, 0,
+                                          view.size.width,
+                                          view.size.height
+                                        });
+
+  pass = gsk_vulkan_render_pass_new (self->vulkan,
+                                     result,
+                                     self->scale_factor,
+                                     &self->mv,
+                                     &view,
+                                     clip,
+                                     semaphore);
+
+  cairo_region_destroy (clip);
+
+  gsk_vulkan_render_add_render_pass (render, pass);
+  gsk_vulkan_render_pass_add (pass, render, node);
+  if (result)
+    {
+      gsk_vulkan_render_add_cleanup_image (render, result);
+    }
+  else
+    {
+      GskVulkanPendingOffscreen pending = { pass, tex_rect, view.size.width, view.size.height, 0, 0 };
+
+      g_array_append_val (self->pending_offscreens, pending);
+    }
+
+  /* assuming the unclipped bounds should go to texture coordinates 0..1,
+   * calculate the coordinates for the clipped texture size
+   */
+  tex_rect->origin.x = (bounds->origin.x - clipped.origin.x)/clipped.size.width;
+  tex_rect->origin.y = (bounds->origin.y - clipped.origin.y)/clipped.size.height;
+  tex_rect->size.width = bounds->size.width/clipped.size.width;
+  tex_rect->size.height = bounds->size.height/clipped.size.height;
+
+  return pass;
+}
+
 static GskVulkanImage *
 gsk_vulkan_render_pass_get_node_as_texture (GskVulkanRenderPass   *self,
                                             GskVulkanRender       *render,
@@ -687,79 +880,13 @@ gsk_vulkan_render_pass_get_node_as_texture (GskVulkanRenderPass   *self,
 
     default:
       {
-        VkSemaphore semaphore;
-        graphene_rect_t view;
-        cairo_region_t *clip;
         GskVulkanRenderPass *pass;
-        graphene_rect_t clipped;
 
-        if (current_clip)
-          graphene_rect_intersection (&current_clip->rect.bounds, bounds, &clipped);
-        else
-          clipped = *bounds;
-
-        if (clipped.size.width == 0 || clipped.size.height == 0)
+        pass = gsk_vulkan_render_pass_add_offscreen (self, render, node, bounds, current_clip, TRUE, tex_rect);
+        if (pass == NULL)
           return NULL;
 
-        graphene_matrix_transform_bounds (&self->mv, &clipped, &view);
-        view.origin.x = floor (view.origin.x);
-        view.origin.y = floor (view.origin.y);
-        view.size.width = ceil (view.size.width);
-        view.size.height = ceil (view.size.height);
-
-        result = gsk_vulkan_image_new_for_texture (self->vulkan,
-                                                   view.size.width,
-                                                   view.size.height);
-
-#ifdef G_ENABLE_DEBUG
-        {
-          GskProfiler *profiler = gsk_renderer_get_profiler (gsk_vulkan_render_get_renderer (render));
-          gsk_profiler_counter_add (profiler,
-                                    self->texture_pixels,
-                                    view.size.width * view.size.height);
-        }
-#endif
-
-        vkCreateSemaphore (gdk_vulkan_context_get_device (self->vulkan),
-                           &(VkSemaphoreCreateInfo) {
-                             VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-                             NULL,
-                             0
-                           },
-                           NULL,
-                           &semaphore);
-
-        g_array_append_val (self->wait_semaphores, semaphore);
-
-        clip = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
-                                                0, 0,
-                                                gsk_vulkan_image_get_width (result),
-                                                gsk_vulkan_image_get_height (result)
-                                              });
-
-        pass = gsk_vulkan_render_pass_new (self->vulkan,
-                                           result,
-                                           self->scale_factor,
-                                           &self->mv,
-                                           &view,
-                                           clip,
-                                           semaphore);
-
-        cairo_region_destroy (clip);
-
-        gsk_vulkan_render_add_render_pass (render, pass);
-        gsk_vulkan_render_pass_add (pass, render, node);
-        gsk_vulkan_render_add_cleanup_image (render, result);
-
-        /* assuming the unclipped bounds should go to texture coordinates 0..1,
-         * calculate the coordinates for the clipped texture size
-         */
-        tex_rect->origin.x = (bounds->origin.x - clipped.origin.x)/clipped.size.width;
-        tex_rect->origin.y = (bounds->origin.y - clipped.origin.y)/clipped.size.height;
-        tex_rect->size.width = bounds->size.width/clipped.size.width;
-        tex_rect->size.height = bounds->size.height/clipped.size.height;
-
-        return result;
+        return pass->target;
       }
    }
 
@@ -893,6 +1020,253 @@ gsk_vulkan_render_pass_upload_fallback (GskVulkanRenderPass  *self,
   gsk_vulkan_render_add_cleanup_image (render, op->source);
 }
 
+static void
+gsk_vulkan_render_pass_upload_compute_blur (GskVulkanRenderPass *self,
+                                            GskVulkanOpRender   *op,
+                                            GskVulkanRender     *render,
+                                            GskVulkanClip       *clip)
+{
+  GskRenderNode *child = gsk_blur_node_get_child (op->node);
+  float radius = gsk_blur_node_get_radius (op->node);
+  GskVulkanRenderPass *pass;
+  GskVulkanClip blur_clip;
+  gsize width, height, scale;
+  float scaled_width, scaled_height;
+
+  /* Content outside of the clip still blurs into it */
+  if (clip)
+    {
+      blur_clip = *clip;
+      graphene_rect_inset (&blur_clip.rect.bounds, - ceil (1.5 * radius), - ceil (1.5 * radius));
+    }
+
+  /* Render the child at the size of the blur node, so that the blurred
+   * edges fit into the image.
+   */
+  pass = gsk_vulkan_render_pass_add_offscreen (self,
+                                               render,
+                                               child,
+                                               &op->node->bounds,
+                                               clip ? &blur_clip : NULL,
+                                               FALSE,
+                                               &op->source_rect);
+  if (pass == NULL)
+    return;
+
+  width = gsk_vulkan_image_get_width (pass->target);
+  height = gsk_vulkan_image_get_height (pass->target);
+
+  /* The radius is in node coordinates, the shader works in pixels */
+  radius *= width * op->source_rect.size.width / op->node->bounds.size.width;
+
+  scale = gsk_vulkan_compute_blur_get_scale (radius);
+  scaled_width = (float) width / scale;
+  scaled_height = (float) height / scale;
+
+  pass->blur = gsk_vulkan_render_get_compute_blur (render);
+  pass->blur_radius = radius;
+  pass->blur_images[0] = gsk_vulkan_image_new_for_storage (self->vulkan, ceil (scaled_width), ceil (scaled_height));
+  pass->blur_images[1] = gsk_vulkan_image_new_for_storage (self->vulkan, ceil (scaled_width), ceil (scaled_height));
+  gsk_vulkan_render_add_cleanup_image (render, pass->blur_images[0]);
+  gsk_vulkan_render_add_cleanup_image (render, pass->blur_images[1]);
+
+  op->source = pass->blur_images[1];
+
+  /* Rounding up the size made the result cover a bit more */
+  op->source_rect.origin.x *= scaled_width / ceil (scaled_width);
+  op->source_rect.size.width *= scaled_width / ceil (scaled_width);
+  op->source_rect.origin.y *= scaled_height / ceil (scaled_height);
+  op->source_rect.size.height *= scaled_height / ceil (scaled_height);
+}
+
+static void
+gsk_vulkan_render_pass_upload_uber (GskVulkanRenderPass *self,
+                                    GskVulkanOpRender   *op,
+                                    GskVulkanRender     *render,
+                                    GskVulkanUploader   *uploader,
+                                    GskVulkanClip       *clip)
+{
+  GskRenderNode *child;
+
+  switch ((guint) gsk_render_node_get_node_type (op->node))
+    {
+    case GSK_COLOR_NODE:
+      /* The shader doesn't sample, but it needs a valid descriptor set */
+      op->source = gsk_vulkan_render_get_dummy_image (render, uploader);
+      break;
+
+    case GSK_TEXTURE_NODE:
+      op->source = gsk_vulkan_renderer_ref_texture_image (GSK_VULKAN_RENDERER (gsk_vulkan_render_get_renderer (render)),
+                                                          gsk_texture_node_get_texture (op->node),
+                                                          uploader);
+      op->source_rect = GRAPHENE_RECT_INIT(0, 0, 1, 1);
+      gsk_vulkan_render_add_cleanup_image (render, op->source);
+      break;
+
+    case GSK_OPACITY_NODE:
+    case GSK_COLOR_MATRIX_NODE:
+      if (gsk_render_node_get_node_type (op->node) == GSK_OPACITY_NODE)
+        child = gsk_opacity_node_get_child (op->node);
+      else
+        child = gsk_color_matrix_node_get_child (op->node);
+
+      op->source = gsk_vulkan_render_pass_get_node_as_texture (self,
+                                                               render,
+                                                               uploader,
+                                                               child,
+                                                               &child->bounds,
+                                                               clip,
+                                                               &op->source_rect);
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+gsk_vulkan_render_pass_set_offscreen_image (GskVulkanRenderPass       *self,
+                                            GskVulkanPendingOffscreen *pending,
+                                            GskVulkanImage            *image)
+{
+  GskVulkanRenderPass *pass = pending->pass;
+  graphene_rect_t *tex_rect = pending->tex_rect;
+  float width = gsk_vulkan_image_get_width (image);
+  float height = gsk_vulkan_image_get_height (image);
+  guint i;
+
+  pass->target = g_object_ref (image);
+  pass->target_x = pending->x;
+  pass->target_y = pending->y;
+
+  /* tex_rect is relative to the offscreen, make it relative to the image */
+  tex_rect->origin.x = (pending->x + tex_rect->origin.x * pending->width) / width;
+  tex_rect->origin.y = (pending->y + tex_rect->origin.y * pending->height) / height;
+  tex_rect->size.width = tex_rect->size.width * pending->width / width;
+  tex_rect->size.height = tex_rect->size.height * pending->height / height;
+
+  for (i = 0; i < self->render_ops->len; i++)
+    {
+      GskVulkanOp *op = &g_array_index (self->render_ops, GskVulkanOp, i);
+
+      if (tex_rect == &op->render.source_rect)
+        {
+          op->render.source = image;
+          return;
+        }
+      else if (tex_rect == &op->render.source2_rect)
+        {
+          op->render.source2 = image;
+          return;
+        }
+    }
+
+  g_assert_not_reached ();
+}
+
+/* Merges @pass into the render pass of @leader, so it doesn't signal
+ * a semaphore of its own.
+ */
+static void
+gsk_vulkan_render_pass_merge_offscreen (GskVulkanRenderPass *self,
+                                        GskVulkanRenderPass *leader,
+                                        GskVulkanRenderPass *pass)
+{
+  guint i;
+
+  if (leader->merged_passes == NULL)
+    {
+      leader->merged_passes = g_ptr_array_new ();
+      g_ptr_array_add (leader->merged_passes, leader);
+    }
+
+  g_ptr_array_add (leader->merged_passes, pass);
+  pass->merged = TRUE;
+
+  for (i = 0; i < self->wait_semaphores->len; i++)
+    {
+      if (g_array_index (self->wait_semaphores, VkSemaphore, i) == pass->signal_semaphore)
+        {
+          g_array_remove_index (self->wait_semaphores, i);
+          break;
+        }
+    }
+
+  vkDestroySemaphore (gdk_vulkan_context_get_device (self->vulkan),
+                      pass->signal_semaphore,
+                      NULL);
+  pass->signal_semaphore = VK_NULL_HANDLE;
+}
+
+/* The small offscreens of a pass don't depend on each other, as they
+ * draw separate subtrees. So they can be packed into shared images,
+ * each drawn with a single render pass, instead of a render pass,
+ * image and submission for each.
+ */
+static void
+gsk_vulkan_render_pass_pack_offscreens (GskVulkanRenderPass *self,
+                                        GskVulkanRender     *render)
+{
+  GskVulkanPendingOffscreen *pending;
+  guint first, i, j;
+  int x, y, row_height, width, height;
+
+  if (self->pending_offscreens->len == 0)
+    return;
+
+  first = 0;
+  while (first < self->pending_offscreens->len)
+    {
+      GskVulkanImage *image;
+
+      /* Shelf-pack as many as fit, with a transparent pixel between them
+       * so filtering at the edges matches separate images.
+       */
+      x = y = row_height = width = height = 0;
+      for (i = first; i < self->pending_offscreens->len; i++)
+        {
+          pending = &g_array_index (self->pending_offscreens, GskVulkanPendingOffscreen, i);
+
+          if (x + pending->width > SHARED_OFFSCREEN_ATLAS_SIZE)
+            {
+              x = 0;
+              y += row_height + 1;
+              row_height = 0;
+            }
+          if (y + pending->height > SHARED_OFFSCREEN_ATLAS_SIZE)
+            break;
+
+          pending->x = x;
+          pending->y = y;
+          x += pending->width + 1;
+          row_height = MAX (row_height, pending->height);
+          width = MAX (width, pending->x + pending->width);
+          height = MAX (height, pending->y + pending->height);
+        }
+
+      image = gsk_vulkan_image_new_for_texture (self->vulkan, width, height);
+      gsk_vulkan_render_add_cleanup_image (render, image);
+
+      for (j = first; j < i; j++)
+        {
+          pending = &g_array_index (self->pending_offscreens, GskVulkanPendingOffscreen, j);
+
+          gsk_vulkan_render_pass_set_offscreen_image (self, pending, image);
+          if (j > first)
+            gsk_vulkan_render_pass_merge_offscreen (self,
+                                                    g_array_index (self->pending_offscreens, GskVulkanPendingOffscreen, first).pass,
+                                                    pending->pass);
+        }
+
+      GSK_RENDERER_NOTE (gsk_vulkan_render_get_renderer (render), VULKAN,
+                         g_message ("Packed %u offscreens into a %dx%d image", i - first, width, height));
+
+      first = i;
+    }
+
+  g_array_set_size (self->pending_offscreens, 0);
+}
+
 void
 gsk_vulkan_render_pass_upload (GskVulkanRenderPass  *self,
                                GskVulkanRender      *render,
@@ -983,6 +1357,14 @@ gsk_vulkan_render_pass_upload (GskVulkanRenderPass  *self,
           }
           break;
 
+        case GSK_VULKAN_OP_COMPUTE_BLUR:
+          gsk_vulkan_render_pass_upload_compute_blur (self, &op->render, render, clip);
+          break;
+
+        case GSK_VULKAN_OP_UBER:
+          gsk_vulkan_render_pass_upload_uber (self, &op->render, render, uploader, clip);
+          break;
+
         case GSK_VULKAN_OP_COLOR_MATRIX:
           {
             GskRenderNode *child = gsk_color_matrix_node_get_child (op->render.node);
@@ -1075,6 +1457,8 @@ gsk_vulkan_render_pass_upload (GskVulkanRenderPass  *self,
           break;
         }
     }
+
+  gsk_vulkan_render_pass_pack_offscreens (self, render);
 }
 
 static gsize
@@ -1095,6 +1479,7 @@ gsk_vulkan_render_pass_count_vertex_data (GskVulkanRenderPass *self)
         case GSK_VULKAN_OP_FALLBACK_CLIP:
         case GSK_VULKAN_OP_FALLBACK_ROUNDED_CLIP:
         case GSK_VULKAN_OP_TEXTURE:
+        case GSK_VULKAN_OP_COMPUTE_BLUR:
         case GSK_VULKAN_OP_REPEAT:
           op->render.vertex_count = gsk_vulkan_texture_pipeline_count_vertex_data (GSK_VULKAN_TEXTURE_PIPELINE (op->render.pipeline));
           n_bytes += op->render.vertex_count;
@@ -1154,6 +1539,11 @@ gsk_vulkan_render_pass_count_vertex_data (GskVulkanRenderPass *self)
           n_bytes += op->render.vertex_count;
           break;
 
+        case GSK_VULKAN_OP_UBER:
+          op->render.vertex_count = gsk_vulkan_uber_pipeline_count_vertex_data (GSK_VULKAN_UBER_PIPELINE (op->render.pipeline));
+          n_bytes += op->render.vertex_count;
+          break;
+
         default:
           g_assert_not_reached ();
 
@@ -1187,6 +1577,7 @@ gsk_vulkan_render_pass_collect_vertex_data (GskVulkanRenderPass *self,
         case GSK_VULKAN_OP_FALLBACK_CLIP:
         case GSK_VULKAN_OP_FALLBACK_ROUNDED_CLIP:
         case GSK_VULKAN_OP_TEXTURE:
+        case GSK_VULKAN_OP_COMPUTE_BLUR:
           {
             op->render.vertex_offset = offset + n_bytes;
             gsk_vulkan_texture_pipeline_collect_vertex_data (GSK_VULKAN_TEXTURE_PIPELINE (op->render.pipeline),
@@ -1271,6 +1662,64 @@ gsk_vulkan_render_pass_collect_vertex_data (GskVulkanRenderPass *self,
           }
           break;
 
+        case GSK_VULKAN_OP_UBER:
+          {
+            GskVulkanUberPipeline *pipeline = GSK_VULKAN_UBER_PIPELINE (op->render.pipeline);
+            graphene_matrix_t color_matrix;
+            graphene_vec4_t color_offset;
+
+            op->render.vertex_offset = offset + n_bytes;
+
+            switch ((guint) gsk_render_node_get_node_type (op->render.node))
+              {
+              case GSK_COLOR_NODE:
+                gsk_vulkan_uber_pipeline_collect_color (pipeline,
+                                                        data + n_bytes + offset,
+                                                        &op->render.node->bounds,
+                                                        gsk_color_node_get_color (op->render.node));
+                break;
+
+              case GSK_TEXTURE_NODE:
+                gsk_vulkan_uber_pipeline_collect_texture (pipeline,
+                                                          data + n_bytes + offset,
+                                                          &op->render.node->bounds,
+                                                          &op->render.source_rect);
+                break;
+
+              case GSK_OPACITY_NODE:
+                graphene_matrix_init_from_float (&color_matrix,
+                                                 (float[16]) {
+                                                     1.0, 0.0, 0.0, 0.0,
+                                                     0.0, 1.0, 0.0, 0.0,
+                                                     0.0, 0.0, 1.0, 0.0,
+                                                     0.0, 0.0, 0.0, gsk_opacity_node_get_opacity (op->render.node)
+                                                 });
+                graphene_vec4_init (&color_offset, 0.0, 0.0, 0.0, 0.0);
+                gsk_vulkan_uber_pipeline_collect_color_matrix (pipeline,
+                                                               data + n_bytes + offset,
+                                                               &op->render.node->bounds,
+                                                               &op->render.source_rect,
+                                                               &color_matrix,
+                                                               &color_offset);
+                break;
+
+              case GSK_COLOR_MATRIX_NODE:
+                gsk_vulkan_uber_pipeline_collect_color_matrix (pipeline,
+                                                               data + n_bytes + offset,
+                                                               &op->render.node->bounds,
+                                                               &op->render.source_rect,
+                                                               gsk_color_matrix_node_get_color_matrix (op->render.node),
+                                                               gsk_color_matrix_node_get_color_offset (op->render.node));
+                break;
+
+              default:
+                g_assert_not_reached ();
+              }
+
+            n_bytes += op->render.vertex_count;
+          }
+          break;
+
         case GSK_VULKAN_OP_OPACITY:
           {
             graphene_matrix_t color_matrix;
@@ -1441,8 +1890,17 @@ gsk_vulkan_render_pass_reserve_descriptor_sets (GskVulkanRenderPass *self,
                                                 GskVulkanRender     *render)
 {
   GskVulkanOp *op;
+  gboolean have_uber_set = FALSE;
+  gsize uber_set = 0;
   guint i;
 
+  if (self->blur)
+    gsk_vulkan_compute_blur_prepare (self->blur,
+                                     self->target,
+                                     self->blur_images[0],
+                                     self->blur_images[1],
+                                     self->blur_descriptor_sets);
+
   for (i = 0; i < self->render_ops->len; i++)
     {
       op = &g_array_index (self->render_ops, GskVulkanOp, i);
@@ -1453,6 +1911,7 @@ gsk_vulkan_render_pass_reserve_descriptor_sets (GskVulkanRenderPass *self,
         case GSK_VULKAN_OP_FALLBACK_CLIP:
         case GSK_VULKAN_OP_FALLBACK_ROUNDED_CLIP:
         case GSK_VULKAN_OP_TEXTURE:
+        case GSK_VULKAN_OP_COMPUTE_BLUR:
         case GSK_VULKAN_OP_OPACITY:
         case GSK_VULKAN_OP_BLUR:
         case GSK_VULKAN_OP_COLOR_MATRIX:
@@ -1465,6 +1924,24 @@ gsk_vulkan_render_pass_reserve_descriptor_sets (GskVulkanRenderPass *self,
             op->render.descriptor_set_index = gsk_vulkan_render_reserve_descriptor_set (render, op->render.source, TRUE);
           break;
 
+        case GSK_VULKAN_OP_UBER:
+          if (op->render.source == NULL)
+            break;
+          /* Color ops don't care about the image, so they can join the
+           * draw call of the ops before them.
+           */
+          if (gsk_render_node_get_node_type (op->render.node) == GSK_COLOR_NODE && have_uber_set)
+            {
+              op->render.descriptor_set_index = uber_set;
+            }
+          else
+            {
+              op->render.descriptor_set_index = gsk_vulkan_render_reserve_descriptor_set (render, op->render.source, FALSE);
+              uber_set = op->render.descriptor_set_index;
+              have_uber_set = TRUE;
+            }
+          break;
+
         case GSK_VULKAN_OP_TEXT:
         case GSK_VULKAN_OP_COLOR_TEXT:
           op->text.descriptor_set_index = gsk_vulkan_render_reserve_descriptor_set (render, op->text.source, FALSE);
@@ -1493,6 +1970,36 @@ gsk_vulkan_render_pass_reserve_descriptor_sets (GskVulkanRenderPass *self,
     }
 }
 
+static inline void
+gsk_vulkan_render_pass_bind_descriptor_set (VkCommandBuffer     command_buffer,
+                                            GskVulkanPipeline  *pipeline,
+                                            VkDescriptorSet     descriptor_set,
+                                            VkPipelineLayout   *bound_layout,
+                                            VkDescriptorSet    *bound_set)
+{
+  VkPipelineLayout layout = gsk_vulkan_pipeline_get_pipeline_layout (pipeline);
+
+  /* Pipelines with the same number of textures share their layout, so
+   * a set stays bound when switching between them.
+   */
+  if (*bound_layout == layout && *bound_set == descriptor_set)
+    return;
+
+  vkCmdBindDescriptorSets (command_buffer,
+                           VK_PIPELINE_BIND_POINT_GRAPHICS,
+                           layout,
+                           0,
+                           1,
+                           (VkDescriptorSet[1]) {
+                               descriptor_set
+                           },
+                           0,
+                           NULL);
+
+  *bound_layout = layout;
+  *bound_set = descriptor_set;
+}
+
 static void
 gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
                                   GskVulkanRender         *render,
@@ -1501,6 +2008,8 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
                                   VkCommandBuffer          command_buffer)
 {
   GskVulkanPipeline *current_pipeline = NULL;
+  VkPipelineLayout bound_layout = VK_NULL_HANDLE;
+  VkDescriptorSet bound_set = VK_NULL_HANDLE;
   gsize current_draw_index = 0;
   GskVulkanOp *op;
   guint i, step;
@@ -1519,6 +2028,7 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
         case GSK_VULKAN_OP_FALLBACK_CLIP:
         case GSK_VULKAN_OP_FALLBACK_ROUNDED_CLIP:
         case GSK_VULKAN_OP_TEXTURE:
+        case GSK_VULKAN_OP_COMPUTE_BLUR:
         case GSK_VULKAN_OP_REPEAT:
           if (!op->render.source)
             continue;
@@ -1538,20 +2048,66 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   1,
-                                   (VkDescriptorSet[1]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_set (command_buffer,
+                                                      current_pipeline,
+                                                      gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index),
+                                                      &bound_layout,
+                                                      &bound_set);
 
+          /* Consecutive ops drawing the same image share their descriptor
+           * set, so draw them with a single call.
+           */
+          for (step = 1; step + i < self->render_ops->len; step++)
+            {
+              GskVulkanOp *cmp = &g_array_index (self->render_ops, GskVulkanOp, i + step);
+              if (cmp->type != op->type ||
+                  cmp->render.pipeline != current_pipeline ||
+                  cmp->render.source == NULL ||
+                  cmp->render.descriptor_set_index != op->render.descriptor_set_index)
+                break;
+            }
           current_draw_index += gsk_vulkan_texture_pipeline_draw (GSK_VULKAN_TEXTURE_PIPELINE (current_pipeline),
                                                                   command_buffer,
-                                                                  current_draw_index, 1);
+                                                                  current_draw_index, step);
+          break;
+
+        case GSK_VULKAN_OP_UBER:
+          if (!op->render.source)
+            continue;
+          if (current_pipeline != op->render.pipeline)
+            {
+              current_pipeline = op->render.pipeline;
+              vkCmdBindPipeline (command_buffer,
+                                 VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                 gsk_vulkan_pipeline_get_pipeline (current_pipeline));
+              vkCmdBindVertexBuffers (command_buffer,
+                                      0,
+                                      1,
+                                      (VkBuffer[1]) {
+                                          gsk_vulkan_buffer_get_buffer (vertex_buffer)
+                                      },
+                                      (VkDeviceSize[1]) { op->render.vertex_offset });
+              current_draw_index = 0;
+            }
+
+          gsk_vulkan_render_pass_bind_descriptor_set (command_buffer,
+                                                      current_pipeline,
+                                                      gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index),
+                                                      &bound_layout,
+                                                      &bound_set);
+
+          for (step = 1; step + i < self->render_ops->len; step++)
+            {
+              GskVulkanOp *cmp = &g_array_index (self->render_ops, GskVulkanOp, i + step);
+              if (cmp->type != GSK_VULKAN_OP_UBER ||
+                  cmp->render.pipeline != current_pipeline ||
+                  cmp->render.source == NULL ||
+                  cmp->render.descriptor_set_index != op->render.descriptor_set_index)
+                break;
+            }
+          current_draw_index += gsk_vulkan_uber_pipeline_draw (GSK_VULKAN_UBER_PIPELINE (current_pipeline),
+                                                               command_buffer,
+                                                               current_draw_index, step);
           break;
 
         case GSK_VULKAN_OP_TEXT:
@@ -1571,16 +2127,11 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   1,
-                                   (VkDescriptorSet[1]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->text.descriptor_set_index)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_set (command_buffer,
+                                                      current_pipeline,
+                                                      gsk_vulkan_render_get_descriptor_set (render, op->text.descriptor_set_index),
+                                                      &bound_layout,
+                                                      &bound_set);
 
           current_draw_index += gsk_vulkan_text_pipeline_draw (GSK_VULKAN_TEXT_PIPELINE (current_pipeline),
                                                                command_buffer,
@@ -1604,16 +2155,11 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   1,
-                                   (VkDescriptorSet[1]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->text.descriptor_set_index)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_set (command_buffer,
+                                                      current_pipeline,
+                                                      gsk_vulkan_render_get_descriptor_set (render, op->text.descriptor_set_index),
+                                                      &bound_layout,
+                                                      &bound_set);
 
           current_draw_index += gsk_vulkan_color_text_pipeline_draw (GSK_VULKAN_COLOR_TEXT_PIPELINE (current_pipeline),
                                                                      command_buffer,
@@ -1640,16 +2186,11 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   1,
-                                   (VkDescriptorSet[1]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_set (command_buffer,
+                                                      current_pipeline,
+                                                      gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index),
+                                                      &bound_layout,
+                                                      &bound_set);
 
           current_draw_index += gsk_vulkan_effect_pipeline_draw (GSK_VULKAN_EFFECT_PIPELINE (current_pipeline),
                                                                  command_buffer,
@@ -1675,16 +2216,11 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
               current_draw_index = 0;
             }
 
-          vkCmdBindDescriptorSets (command_buffer,
-                                   VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                   gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline),
-                                   0,
-                                   1,
-                                   (VkDescriptorSet[1]) {
-                                       gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index)
-                                   },
-                                   0,
-                                   NULL);
+          gsk_vulkan_render_pass_bind_descriptor_set (command_buffer,
+                                                      current_pipeline,
+                                                      gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index),
+                                                      &bound_layout,
+                                                      &bound_set);
 
           current_draw_index += gsk_vulkan_blur_pipeline_draw (GSK_VULKAN_BLUR_PIPELINE (current_pipeline),
                                                                command_buffer,
@@ -1821,6 +2357,8 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
                                    },
                                    0,
                                    NULL);
+          bound_layout = gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline);
+          bound_set = gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index);
 
           current_draw_index += gsk_vulkan_cross_fade_pipeline_draw (GSK_VULKAN_CROSS_FADE_PIPELINE (current_pipeline),
                                                                      command_buffer,
@@ -1857,6 +2395,8 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
                                    },
                                    0,
                                    NULL);
+          bound_layout = gsk_vulkan_pipeline_get_pipeline_layout (current_pipeline);
+          bound_set = gsk_vulkan_render_get_descriptor_set (render, op->render.descriptor_set_index);
 
           current_draw_index += gsk_vulkan_blend_mode_pipeline_draw (GSK_VULKAN_BLEND_MODE_PIPELINE (current_pipeline),
                                                                      command_buffer,
@@ -1870,6 +2410,102 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
     }
 }
 
+/**
+ * gsk_vulkan_render_pass_prepare_draw:
+ * @self: a `GskVulkanRenderPass`
+ * @render: the render that @self belongs to
+ *
+ * Creates everything that gsk_vulkan_render_pass_draw() needs from
+ * @render, so that the pass can afterwards be recorded from another
+ * thread.
+ */
+void
+gsk_vulkan_render_pass_prepare_draw (GskVulkanRenderPass *self,
+                                     GskVulkanRender     *render)
+{
+  guint i;
+
+  gsk_vulkan_render_pass_get_vertex_data (self, render);
+  gsk_vulkan_render_get_framebuffer (render, self->target);
+
+  /* The merged passes get submitted with this one, so it has to
+   * wait for everything they need, too.
+   */
+  if (self->merged_passes)
+    {
+      for (i = 1; i < self->merged_passes->len; i++)
+        {
+          GskVulkanRenderPass *pass = g_ptr_array_index (self->merged_passes, i);
+
+          g_array_append_vals (self->wait_semaphores,
+                               pass->wait_semaphores->data,
+                               pass->wait_semaphores->len);
+          g_array_set_size (pass->wait_semaphores, 0);
+        }
+    }
+}
+
+gboolean
+gsk_vulkan_render_pass_is_merged (GskVulkanRenderPass *self)
+{
+  return self->merged;
+}
+
+static void
+gsk_vulkan_render_pass_draw_merged (GskVulkanRenderPass     *self,
+                                    GskVulkanRender         *render,
+                                    guint                    layout_count,
+                                    VkPipelineLayout        *pipeline_layout,
+                                    VkCommandBuffer          command_buffer)
+{
+  guint i;
+
+  vkCmdBeginRenderPass (command_buffer,
+                        &(VkRenderPassBeginInfo) {
+                            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+                            .renderPass = self->render_pass,
+                            .framebuffer = gsk_vulkan_render_get_framebuffer (render, self->target),
+                            .renderArea = {
+                                { 0, 0 },
+                                { gsk_vulkan_image_get_width (self->target), gsk_vulkan_image_get_height (self->target) }
+                            },
+                            .clearValueCount = 1,
+                            .pClearValues = (VkClearValue [1]) {
+                                { .color = { .float32 = { 0.f, 0.f, 0.f, 0.f } } }
+                            }
+                        },
+                        VK_SUBPASS_CONTENTS_INLINE);
+
+  for (i = 0; i < self->merged_passes->len; i++)
+    {
+      GskVulkanRenderPass *pass = g_ptr_array_index (self->merged_passes, i);
+
+      vkCmdSetViewport (command_buffer,
+                        0,
+                        1,
+                        &(VkViewport) {
+                            .x = pass->target_x,
+                            .y = pass->target_y,
+                            .width = pass->viewport.size.width,
+                            .height = pass->viewport.size.height,
+                            .minDepth = 0,
+                            .maxDepth = 1
+                        });
+
+      vkCmdSetScissor (command_buffer,
+                       0,
+                       1,
+                       &(VkRect2D) {
+                          { pass->target_x, pass->target_y },
+                          { pass->viewport.size.width, pass->viewport.size.height }
+                       });
+
+      gsk_vulkan_render_pass_draw_rect (pass, render, layout_count, pipeline_layout, command_buffer);
+    }
+
+  vkCmdEndRenderPass (command_buffer);
+}
+
 void
 gsk_vulkan_render_pass_draw (GskVulkanRenderPass     *self,
                              GskVulkanRender         *render,
@@ -1879,6 +2515,12 @@ gsk_vulkan_render_pass_draw (GskVulkanRenderPass     *self,
 {
   guint i;
 
+  if (self->merged_passes)
+    {
+      gsk_vulkan_render_pass_draw_merged (self, render, layout_count, pipeline_layout, command_buffer);
+      return;
+    }
+
   vkCmdSetViewport (command_buffer,
                     0,
                     1,
@@ -1925,4 +2567,13 @@ gsk_vulkan_render_pass_draw (GskVulkanRenderPass     *self,
 
       vkCmdEndRenderPass (command_buffer);
     }
+
+  if (self->blur)
+    gsk_vulkan_compute_blur_record (self->blur,
+                                    command_buffer,
+                                    self->target,
+                                    self->blur_images[0],
+                                    self->blur_images[1],
+                                    self->blur_descriptor_sets,
+                                    self->blur_radius);
 }
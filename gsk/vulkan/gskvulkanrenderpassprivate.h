@@ -30,6 +30,9 @@ void                    gsk_vulkan_render_pass_upload                   (GskVulk
                                                                          GskVulkanUploader      *uploader);
 void                    gsk_vulkan_render_pass_reserve_descriptor_sets  (GskVulkanRenderPass    *self,
                                                                          GskVulkanRender        *render);
+void                    gsk_vulkan_render_pass_prepare_draw             (GskVulkanRenderPass    *self,
+                                                                         GskVulkanRender        *render);
+gboolean                gsk_vulkan_render_pass_is_merged                (GskVulkanRenderPass    *self);
 void                    gsk_vulkan_render_pass_draw                     (GskVulkanRenderPass    *self,
                                                                          GskVulkanRender        *render,
                                                                          guint                   layout_count,
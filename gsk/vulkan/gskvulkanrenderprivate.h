@@ -4,6 +4,7 @@
 #include <gdk/gdk.h>
 #include <gsk/gskrendernode.h>
 
+#include "gskvulkancomputeblurprivate.h"
 #include "gskvulkanimageprivate.h"
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanrenderpassprivate.h"
@@ -48,12 +49,21 @@ typedef enum {
   GSK_VULKAN_PIPELINE_BLEND_MODE,
   GSK_VULKAN_PIPELINE_BLEND_MODE_CLIP,
   GSK_VULKAN_PIPELINE_BLEND_MODE_CLIP_ROUNDED,
+  GSK_VULKAN_PIPELINE_UBER,
+  GSK_VULKAN_PIPELINE_UBER_CLIP,
+  GSK_VULKAN_PIPELINE_UBER_CLIP_ROUNDED,
   /* add more */
   GSK_VULKAN_N_PIPELINES
 } GskVulkanPipelineType;
 
+typedef struct _GskVulkanPipelines GskVulkanPipelines;
+
+GskVulkanPipelines *    gsk_vulkan_pipelines_new                        (GdkVulkanContext       *context);
+void                    gsk_vulkan_pipelines_free                       (GskVulkanPipelines     *self);
+
 GskVulkanRender *       gsk_vulkan_render_new                           (GskRenderer            *renderer,
-                                                                         GdkVulkanContext       *context);
+                                                                         GdkVulkanContext       *context,
+                                                                         GskVulkanPipelines     *pipelines);
 void                    gsk_vulkan_render_free                          (GskVulkanRender        *self);
 
 gboolean                gsk_vulkan_render_is_busy                       (GskVulkanRender        *self);
@@ -77,6 +87,10 @@ void                    gsk_vulkan_render_upload                        (GskVulk
 
 GskVulkanPipeline *     gsk_vulkan_render_get_pipeline                  (GskVulkanRender        *self,
                                                                          GskVulkanPipelineType   pipeline_type);
+GskVulkanComputeBlur *  gsk_vulkan_render_get_compute_blur              (GskVulkanRender        *self);
+gboolean                gsk_vulkan_render_uses_ubershader               (GskVulkanRender        *self);
+GskVulkanImage *        gsk_vulkan_render_get_dummy_image               (GskVulkanRender        *self,
+                                                                         GskVulkanUploader      *uploader);
 VkDescriptorSet         gsk_vulkan_render_get_descriptor_set            (GskVulkanRender        *self,
                                                                          gsize                   id);
 gsize                   gsk_vulkan_render_reserve_descriptor_set        (GskVulkanRender        *self,
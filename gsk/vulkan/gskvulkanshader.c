@@ -55,11 +55,28 @@ gsk_vulkan_shader_new_from_resource (GdkVulkanContext     *context,
   GskVulkanShader *self;
   GBytes *bytes;
   GError *local_error = NULL;
+  const char *suffix;
   char *path;
 
+  switch (type)
+    {
+    case GSK_VULKAN_SHADER_VERTEX:
+      suffix = ".vert.spv";
+      break;
+    case GSK_VULKAN_SHADER_FRAGMENT:
+      suffix = ".frag.spv";
+      break;
+    case GSK_VULKAN_SHADER_COMPUTE:
+      suffix = ".comp.spv";
+      break;
+    default:
+      g_assert_not_reached ();
+      return NULL;
+    }
+
   path = g_strconcat ("/org/gtk/libgsk/vulkan/",
                       resource_name, 
-                      type == GSK_VULKAN_SHADER_VERTEX ? ".vert.spv" : ".frag.spv",
+                      suffix,
                       NULL);
   bytes = g_resources_lookup_data (path, 0, &local_error);
   g_free (path);
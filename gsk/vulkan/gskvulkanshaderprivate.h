@@ -7,7 +7,8 @@ G_BEGIN_DECLS
 
 typedef enum {
   GSK_VULKAN_SHADER_VERTEX,
-  GSK_VULKAN_SHADER_FRAGMENT
+  GSK_VULKAN_SHADER_FRAGMENT,
+  GSK_VULKAN_SHADER_COMPUTE
 } GskVulkanShaderType;
 
 typedef struct _GskVulkanShader GskVulkanShader;
@@ -15,7 +16,9 @@ typedef struct _GskVulkanShader GskVulkanShader;
 #define GST_VULKAN_SHADER_STAGE_CREATE_INFO(shader) \
   (VkPipelineShaderStageCreateInfo) { \
   .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, \
-  .stage = gsk_vulkan_shader_get_type (shader) == GSK_VULKAN_SHADER_VERTEX ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT, \
+  .stage = gsk_vulkan_shader_get_type (shader) == GSK_VULKAN_SHADER_VERTEX ? VK_SHADER_STAGE_VERTEX_BIT : \
+           gsk_vulkan_shader_get_type (shader) == GSK_VULKAN_SHADER_FRAGMENT ? VK_SHADER_STAGE_FRAGMENT_BIT : \
+           VK_SHADER_STAGE_COMPUTE_BIT, \
   .module = gsk_vulkan_shader_get_module (shader), \
   .pName = "main", \
 }
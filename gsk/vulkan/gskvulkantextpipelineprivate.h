@@ -16,6 +16,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanTextPipeline, gsk_vulkan_text_pipeline, GSK, VULK
 
 GskVulkanPipeline *     gsk_vulkan_text_pipeline_new                   (GdkVulkanContext              *context,
                                                                         VkPipelineLayout               layout,
+                                                                        VkPipelineCache                cache,
                                                                         const char                    *shader_name,
                                                                         VkRenderPass                   render_pass);
 
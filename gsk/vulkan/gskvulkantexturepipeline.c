@@ -78,10 +78,11 @@ gsk_vulkan_texture_pipeline_init (GskVulkanTexturePipeline *self)
 GskVulkanPipeline *
 gsk_vulkan_texture_pipeline_new (GdkVulkanContext *context,
                                  VkPipelineLayout  layout,
+                                 VkPipelineCache   cache,
                                  const char       *shader_name,
                                  VkRenderPass      render_pass)
 {
-  return gsk_vulkan_pipeline_new (GSK_TYPE_VULKAN_TEXTURE_PIPELINE, context, layout, shader_name, render_pass);
+  return gsk_vulkan_pipeline_new (GSK_TYPE_VULKAN_TEXTURE_PIPELINE, context, layout, cache, shader_name, render_pass);
 }
 
 gsize
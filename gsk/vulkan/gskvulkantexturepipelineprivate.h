@@ -15,6 +15,7 @@ G_DECLARE_FINAL_TYPE (GskVulkanTexturePipeline, gsk_vulkan_texture_pipeline, GSK
 
 GskVulkanPipeline *     gsk_vulkan_texture_pipeline_new                 (GdkVulkanContext         *context,
                                                                          VkPipelineLayout          layout,
+                                                                         VkPipelineCache           cache,
                                                                          const char               *shader_name,
                                                                          VkRenderPass              render_pass);
 
@@ -0,0 +1,215 @@
+#include "config.h"
+
+#include "gskvulkanuberpipelineprivate.h"
+
+#include <string.h>
+
+struct _GskVulkanUberPipeline
+{
+  GObject parent_instance;
+};
+
+typedef struct _GskVulkanUberInstance GskVulkanUberInstance;
+
+struct _GskVulkanUberInstance
+{
+  float rect[4];
+  float tex_rect[4];
+  float color_matrix[16];
+  float color_offset[4];
+  guint32 op;
+};
+
+G_DEFINE_TYPE (GskVulkanUberPipeline, gsk_vulkan_uber_pipeline, GSK_TYPE_VULKAN_PIPELINE)
+
+static const VkPipelineVertexInputStateCreateInfo *
+gsk_vulkan_uber_pipeline_get_input_state_create_info (GskVulkanPipeline *self)
+{
+  static const VkVertexInputBindingDescription vertexBindingDescriptions[] = {
+      {
+          .binding = 0,
+          .stride = sizeof (GskVulkanUberInstance),
+          .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+      }
+  };
+  static const VkVertexInputAttributeDescription vertexInputAttributeDescription[] = {
+      {
+          .location = 0,
+          .binding = 0,
+          .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+          .offset = 0,
+      },
+      {
+          .location = 1,
+          .binding = 0,
+          .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+          .offset = G_STRUCT_OFFSET (GskVulkanUberInstance, tex_rect),
+      },
+      {
+          .location = 2,
+          .binding = 0,
+          .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+          .offset = G_STRUCT_OFFSET (GskVulkanUberInstance, color_matrix),
+      },
+      {
+          .location = 3,
+          .binding = 0,
+          .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+          .offset = G_STRUCT_OFFSET (GskVulkanUberInstance, color_matrix) + sizeof (float) * 4,
+      },
+      {
+          .location = 4,
+          .binding = 0,
+          .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+          .offset = G_STRUCT_OFFSET (GskVulkanUberInstance, color_matrix) + sizeof (float) * 8,
+      },
+      {
+          .location = 5,
+          .binding = 0,
+          .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+          .offset = G_STRUCT_OFFSET (GskVulkanUberInstance, color_matrix) + sizeof (float) * 12,
+      },
+      {
+          .location = 6,
+          .binding = 0,
+          .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+          .offset = G_STRUCT_OFFSET (GskVulkanUberInstance, color_offset),
+      },
+      {
+          .location = 7,
+          .binding = 0,
+          .format = VK_FORMAT_R32_UINT,
+          .offset = G_STRUCT_OFFSET (GskVulkanUberInstance, op),
+      }
+  };
+  static const VkPipelineVertexInputStateCreateInfo info = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+      .vertexBindingDescriptionCount = G_N_ELEMENTS (vertexBindingDescriptions),
+      .pVertexBindingDescriptions = vertexBindingDescriptions,
+      .vertexAttributeDescriptionCount = G_N_ELEMENTS (vertexInputAttributeDescription),
+      .pVertexAttributeDescriptions = vertexInputAttributeDescription
+  };
+
+  return &info;
+}
+
+static void
+gsk_vulkan_uber_pipeline_finalize (GObject *gobject)
+{
+  G_OBJECT_CLASS (gsk_vulkan_uber_pipeline_parent_class)->finalize (gobject);
+}
+
+static void
+gsk_vulkan_uber_pipeline_class_init (GskVulkanUberPipelineClass *klass)
+{
+  GskVulkanPipelineClass *pipeline_class = GSK_VULKAN_PIPELINE_CLASS (klass);
+
+  G_OBJECT_CLASS (klass)->finalize = gsk_vulkan_uber_pipeline_finalize;
+
+  pipeline_class->get_input_state_create_info = gsk_vulkan_uber_pipeline_get_input_state_create_info;
+}
+
+static void
+gsk_vulkan_uber_pipeline_init (GskVulkanUberPipeline *self)
+{
+}
+
+/* The shaders are only built when glslc is available */
+gboolean
+gsk_vulkan_uber_pipeline_is_available (void)
+{
+  return g_resources_get_info ("/org/gtk/libgsk/vulkan/uber.vert.spv", 0, NULL, NULL, NULL) &&
+         g_resources_get_info ("/org/gtk/libgsk/vulkan/uber.frag.spv", 0, NULL, NULL, NULL);
+}
+
+GskVulkanPipeline *
+gsk_vulkan_uber_pipeline_new (GdkVulkanContext        *context,
+                              VkPipelineLayout         layout,
+                              VkPipelineCache          cache,
+                              const char              *shader_name,
+                              VkRenderPass             render_pass)
+{
+  return gsk_vulkan_pipeline_new (GSK_TYPE_VULKAN_UBER_PIPELINE, context, layout, cache, shader_name, render_pass);
+}
+
+gsize
+gsk_vulkan_uber_pipeline_count_vertex_data (GskVulkanUberPipeline *pipeline)
+{
+  return sizeof (GskVulkanUberInstance);
+}
+
+static void
+gsk_vulkan_uber_instance_init (GskVulkanUberInstance *instance,
+                               GskVulkanUberOp        op,
+                               const graphene_rect_t *rect,
+                               const graphene_rect_t *tex_rect)
+{
+  memset (instance, 0, sizeof (GskVulkanUberInstance));
+
+  instance->rect[0] = rect->origin.x;
+  instance->rect[1] = rect->origin.y;
+  instance->rect[2] = rect->size.width;
+  instance->rect[3] = rect->size.height;
+  if (tex_rect)
+    {
+      instance->tex_rect[0] = tex_rect->origin.x;
+      instance->tex_rect[1] = tex_rect->origin.y;
+      instance->tex_rect[2] = tex_rect->size.width;
+      instance->tex_rect[3] = tex_rect->size.height;
+    }
+  instance->op = op;
+}
+
+void
+gsk_vulkan_uber_pipeline_collect_color (GskVulkanUberPipeline *pipeline,
+                                        guchar                *data,
+                                        const graphene_rect_t *rect,
+                                        const GdkRGBA         *color)
+{
+  GskVulkanUberInstance *instance = (GskVulkanUberInstance *) data;
+
+  gsk_vulkan_uber_instance_init (instance, GSK_VULKAN_UBER_OP_COLOR, rect, NULL);
+  instance->color_offset[0] = color->red;
+  instance->color_offset[1] = color->green;
+  instance->color_offset[2] = color->blue;
+  instance->color_offset[3] = color->alpha;
+}
+
+void
+gsk_vulkan_uber_pipeline_collect_texture (GskVulkanUberPipeline *pipeline,
+                                          guchar                *data,
+                                          const graphene_rect_t *rect,
+                                          const graphene_rect_t *tex_rect)
+{
+  GskVulkanUberInstance *instance = (GskVulkanUberInstance *) data;
+
+  gsk_vulkan_uber_instance_init (instance, GSK_VULKAN_UBER_OP_TEXTURE, rect, tex_rect);
+}
+
+void
+gsk_vulkan_uber_pipeline_collect_color_matrix (GskVulkanUberPipeline   *pipeline,
+                                               guchar                  *data,
+                                               const graphene_rect_t   *rect,
+                                               const graphene_rect_t   *tex_rect,
+                                               const graphene_matrix_t *color_matrix,
+                                               const graphene_vec4_t   *color_offset)
+{
+  GskVulkanUberInstance *instance = (GskVulkanUberInstance *) data;
+
+  gsk_vulkan_uber_instance_init (instance, GSK_VULKAN_UBER_OP_COLOR_MATRIX, rect, tex_rect);
+  graphene_matrix_to_float (color_matrix, instance->color_matrix);
+  graphene_vec4_to_float (color_offset, instance->color_offset);
+}
+
+gsize
+gsk_vulkan_uber_pipeline_draw (GskVulkanUberPipeline *pipeline,
+                               VkCommandBuffer        command_buffer,
+                               gsize                  offset,
+                               gsize                  n_commands)
+{
+  vkCmdDraw (command_buffer,
+             6, n_commands,
+             0, offset);
+
+  return n_commands;
+}
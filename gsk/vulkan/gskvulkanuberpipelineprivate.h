@@ -0,0 +1,51 @@
+#ifndef __GSK_VULKAN_UBER_PIPELINE_PRIVATE_H__
+#define __GSK_VULKAN_UBER_PIPELINE_PRIVATE_H__
+
+#include <graphene.h>
+
+#include "gskvulkanpipelineprivate.h"
+
+G_BEGIN_DECLS
+
+/* Must match uber.frag */
+typedef enum {
+  GSK_VULKAN_UBER_OP_COLOR,
+  GSK_VULKAN_UBER_OP_TEXTURE,
+  GSK_VULKAN_UBER_OP_COLOR_MATRIX
+} GskVulkanUberOp;
+
+#define GSK_TYPE_VULKAN_UBER_PIPELINE (gsk_vulkan_uber_pipeline_get_type ())
+
+G_DECLARE_FINAL_TYPE (GskVulkanUberPipeline, gsk_vulkan_uber_pipeline, GSK, VULKAN_UBER_PIPELINE, GskVulkanPipeline)
+
+gboolean                gsk_vulkan_uber_pipeline_is_available           (void);
+
+GskVulkanPipeline *     gsk_vulkan_uber_pipeline_new                    (GdkVulkanContext               *context,
+                                                                         VkPipelineLayout                layout,
+                                                                         VkPipelineCache                 cache,
+                                                                         const char                     *shader_name,
+                                                                         VkRenderPass                    render_pass);
+
+gsize                   gsk_vulkan_uber_pipeline_count_vertex_data      (GskVulkanUberPipeline          *pipeline);
+void                    gsk_vulkan_uber_pipeline_collect_color          (GskVulkanUberPipeline          *pipeline,
+                                                                         guchar                         *data,
+                                                                         const graphene_rect_t          *rect,
+                                                                         const GdkRGBA                  *color);
+void                    gsk_vulkan_uber_pipeline_collect_texture        (GskVulkanUberPipeline          *pipeline,
+                                                                         guchar                         *data,
+                                                                         const graphene_rect_t          *rect,
+                                                                         const graphene_rect_t          *tex_rect);
+void                    gsk_vulkan_uber_pipeline_collect_color_matrix   (GskVulkanUberPipeline          *pipeline,
+                                                                         guchar                         *data,
+                                                                         const graphene_rect_t          *rect,
+                                                                         const graphene_rect_t          *tex_rect,
+                                                                         const graphene_matrix_t        *color_matrix,
+                                                                         const graphene_vec4_t          *color_offset);
+gsize                   gsk_vulkan_uber_pipeline_draw                   (GskVulkanUberPipeline          *pipeline,
+                                                                         VkCommandBuffer                 command_buffer,
+                                                                         gsize                           offset,
+                                                                         gsize                           n_commands);
+
+G_END_DECLS
+
+#endif /* __GSK_VULKAN_UBER_PIPELINE_PRIVATE_H__ */
@@ -0,0 +1,48 @@
+#version 420 core
+
+#include "clip.frag.glsl"
+
+/* Must match GskVulkanUberOp */
+#define OP_COLOR 0u
+#define OP_TEXTURE 1u
+#define OP_COLOR_MATRIX 2u
+
+layout(location = 0) in vec2 inPos;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in flat mat4 inColorMatrix;
+layout(location = 6) in flat vec4 inColorOffset;
+layout(location = 7) in flat uint inOp;
+
+layout(set = 0, binding = 0) uniform sampler2D inTexture;
+
+layout(location = 0) out vec4 color;
+
+vec4
+color_matrix (vec4 color, mat4 color_matrix, vec4 color_offset)
+{
+  /* unpremultiply */
+  if (color.a != 0.0)
+    color.rgb /= color.a;
+
+  color = color_matrix * color + color_offset;
+  color = clamp(color, 0.0, 1.0);
+
+  /* premultiply */
+  color.rgb *= color.a;
+
+  return color;
+}
+
+void main()
+{
+  vec4 result;
+
+  if (inOp == OP_COLOR)
+    result = vec4(inColorOffset.rgb * inColorOffset.a, inColorOffset.a);
+  else if (inOp == OP_TEXTURE)
+    result = texture (inTexture, inTexCoord);
+  else
+    result = color_matrix (texture (inTexture, inTexCoord), inColorMatrix, inColorOffset);
+
+  color = clip (inPos, result);
+}
@@ -44,6 +44,8 @@
 #include "gtkdebug.h"
 #include "gtkeditable.h"
 #include "gtkentryprivate.h"
+#include "gtklistbaseprivate.h"
+#include "gtklistitemwidgetprivate.h"
 #include "gtkroot.h"
 #include "gtkstack.h"
 #include "gtktextview.h"
@@ -106,8 +108,40 @@ struct _GtkAtSpiContext
 
   guint registration_ids[20];
   guint n_registered_objects;
+
+  /* Changes are collected here and emitted once per frame, after
+   * layout, so that rebuilding a list doesn't flood the bus.
+   */
+  GArray *pending_states;
+  GArray *pending_properties;
+  GArray *pending_children;
+  guint pending_bounds : 1;
+
+  GdkFrameClock *flush_clock;
+  gulong flush_handler;
+  guint flush_idle;
 };
 
+typedef struct
+{
+  const char *name;
+  gboolean enabled;
+} PendingState;
+
+typedef struct
+{
+  const char *name;
+  GVariant *value;
+} PendingProperty;
+
+typedef struct
+{
+  char *child_path;
+  GVariant *child_ref;
+  int idx;
+  GtkAccessibleChildState state;
+} PendingChild;
+
 G_DEFINE_TYPE (GtkAtSpiContext, gtk_at_spi_context, GTK_TYPE_AT_CONTEXT)
 
 /* {{{ State handling */
@@ -490,6 +524,7 @@ handle_accessible_method (GDBusConnection       *connection,
   else if (g_strcmp0 (method_name, "GetAttributes") == 0)
     {
       GVariantBuilder builder = G_VARIANT_BUILDER_INIT (G_VARIANT_TYPE ("(a{ss})"));
+      GtkAccessible *accessible;
 
       g_variant_builder_open (&builder, G_VARIANT_TYPE ("a{ss}"));
       g_variant_builder_add (&builder, "{ss}", "toolkit", "GTK");
@@ -504,6 +539,30 @@ handle_accessible_method (GDBusConnection       *connection,
                                  "placeholder-text", gtk_string_accessible_value_get (value));
         }
 
+      /* Rows of list views only exist for the visible part of the
+       * model, so tell ATs where they are from the model instead.
+       */
+      accessible = gtk_at_context_get_accessible (GTK_AT_CONTEXT (self));
+      if (GTK_IS_LIST_ITEM_WIDGET (accessible) &&
+          GTK_IS_LIST_BASE (gtk_widget_get_parent (GTK_WIDGET (accessible))))
+        {
+          GtkWidget *list = gtk_widget_get_parent (GTK_WIDGET (accessible));
+          guint position = gtk_list_item_widget_get_position (GTK_LIST_ITEM_WIDGET (accessible));
+
+          if (position != GTK_INVALID_LIST_POSITION)
+            {
+              char *str;
+
+              str = g_strdup_printf ("%u", position + 1);
+              g_variant_builder_add (&builder, "{ss}", "posinset", str);
+              g_free (str);
+
+              str = g_strdup_printf ("%u", gtk_list_base_get_n_items (GTK_LIST_BASE (list)));
+              g_variant_builder_add (&builder, "{ss}", "setsize", str);
+              g_free (str);
+            }
+        }
+
       g_variant_builder_close (&builder);
 
       g_dbus_method_invocation_return_value (invocation, g_variant_builder_end (&builder));
@@ -698,6 +757,8 @@ static const GDBusInterfaceVTable accessible_vtable = {
 };
 /* }}} */
 /* {{{ Change notification */
+static void gtk_at_spi_context_flush_pending (GtkAtSpiContext *self);
+
 static void
 emit_text_changed (GtkAtSpiContext *self,
                    const char      *kind,
@@ -708,6 +769,8 @@ emit_text_changed (GtkAtSpiContext *self,
   if (self->connection == NULL)
     return;
 
+  gtk_at_spi_context_flush_pending (self);
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
@@ -726,6 +789,8 @@ emit_text_selection_changed (GtkAtSpiContext *self,
   if (self->connection == NULL)
     return;
 
+  gtk_at_spi_context_flush_pending (self);
+
   if (strcmp (kind, "text-caret-moved") == 0)
     g_dbus_connection_emit_signal (self->connection,
                                    NULL,
@@ -753,6 +818,8 @@ emit_selection_changed (GtkAtSpiContext *self,
   if (self->connection == NULL)
     return;
 
+  gtk_at_spi_context_flush_pending (self);
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
@@ -763,22 +830,97 @@ emit_selection_changed (GtkAtSpiContext *self,
                                  NULL);
 }
 
+static GtkWidget *
+get_frame_clock_widget (GtkAtSpiContext *self)
+{
+  GtkAccessible *accessible = gtk_at_context_get_accessible (GTK_AT_CONTEXT (self));
+
+  if (GTK_IS_WIDGET (accessible))
+    return GTK_WIDGET (accessible);
+  else if (GTK_IS_STACK_PAGE (accessible))
+    return gtk_stack_page_get_child (GTK_STACK_PAGE (accessible));
+
+  return NULL;
+}
+
+static gboolean
+flush_pending_idle (gpointer data)
+{
+  GtkAtSpiContext *self = data;
+
+  self->flush_idle = 0;
+  gtk_at_spi_context_flush_pending (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+unschedule_flush (GtkAtSpiContext *self)
+{
+  if (self->flush_clock)
+    {
+      g_clear_signal_handler (&self->flush_handler, self->flush_clock);
+      g_clear_object (&self->flush_clock);
+    }
+
+  g_clear_handle_id (&self->flush_idle, g_source_remove);
+}
+
+static void
+schedule_flush (GtkAtSpiContext *self)
+{
+  GtkWidget *widget;
+  GdkFrameClock *clock = NULL;
+
+  if (self->flush_clock != NULL || self->flush_idle != 0)
+    return;
+
+  widget = get_frame_clock_widget (self);
+  if (widget)
+    clock = gtk_widget_get_frame_clock (widget);
+
+  if (clock)
+    {
+      self->flush_clock = g_object_ref (clock);
+      self->flush_handler = g_signal_connect_swapped (clock, "after-paint",
+                                                      G_CALLBACK (gtk_at_spi_context_flush_pending),
+                                                      self);
+      gdk_frame_clock_request_phase (clock, GDK_FRAME_CLOCK_PHASE_AFTER_PAINT);
+    }
+  else
+    {
+      self->flush_idle = g_idle_add (flush_pending_idle, self);
+      gdk_source_set_static_name_by_id (self->flush_idle, "[gtk] AT-SPI flush");
+    }
+}
+
+/* Only the last value of a state in a frame is emitted */
 static void
 emit_state_changed (GtkAtSpiContext *self,
                     const char      *name,
                     gboolean         enabled)
 {
+  PendingState state;
+
   if (self->connection == NULL)
     return;
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "StateChanged",
-                                 g_variant_new ("(siiva{sv})",
-                                                name, enabled, 0, g_variant_new_string ("0"), NULL),
-                                 NULL);
+  for (guint i = 0; i < self->pending_states->len; i++)
+    {
+      PendingState *pending = &g_array_index (self->pending_states, PendingState, i);
+
+      if (strcmp (pending->name, name) == 0)
+        {
+          pending->enabled = enabled;
+          return;
+        }
+    }
+
+  state.name = name;
+  state.enabled = enabled;
+  g_array_append_val (self->pending_states, state);
+
+  schedule_flush (self);
 }
 
 static void
@@ -796,63 +938,192 @@ emit_defunct (GtkAtSpiContext *self)
                                  NULL);
 }
 
+/* Only the last value of a property in a frame is emitted */
 static void
 emit_property_changed (GtkAtSpiContext *self,
                        const char      *name,
                        GVariant        *value)
 {
+  PendingProperty property;
+
   if (self->connection == NULL)
-    return;
+    {
+      g_variant_unref (g_variant_ref_sink (value));
+      return;
+    }
 
-  g_dbus_connection_emit_signal (self->connection,
-                                 NULL,
-                                 self->context_path,
-                                 "org.a11y.atspi.Event.Object",
-                                 "PropertyChange",
-                                 g_variant_new ("(siiva{sv})",
-                                                name, 0, 0, value, NULL),
-                                 NULL);
+  for (guint i = 0; i < self->pending_properties->len; i++)
+    {
+      PendingProperty *pending = &g_array_index (self->pending_properties, PendingProperty, i);
+
+      if (strcmp (pending->name, name) == 0)
+        {
+          g_variant_unref (pending->value);
+          pending->value = g_variant_ref_sink (value);
+          return;
+        }
+    }
+
+  property.name = name;
+  property.value = g_variant_ref_sink (value);
+  g_array_append_val (self->pending_properties, property);
+
+  schedule_flush (self);
 }
 
 static void
-emit_bounds_changed (GtkAtSpiContext *self,
-                     int              x,
-                     int              y,
-                     int              width,
-                     int              height)
+emit_bounds_changed (GtkAtSpiContext *self)
 {
-  if (self->connection == NULL)
+  GtkAccessible *accessible = gtk_at_context_get_accessible (GTK_AT_CONTEXT (self));
+  GtkWidget *widget;
+  GtkWidget *parent;
+  double x, y;
+  int width, height;
+
+  if (!GTK_IS_WIDGET (accessible))
     return;
 
+  widget = GTK_WIDGET (accessible);
+  if (!gtk_widget_get_realized (widget))
+    return;
+
+  parent = gtk_widget_get_parent (widget);
+
+  if (parent)
+    gtk_widget_translate_coordinates (widget, parent, 0., 0., &x, &y);
+  else
+    x = y = 0.;
+
+  width = gtk_widget_get_width (widget);
+  height = gtk_widget_get_height (widget);
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
                                  "org.a11y.atspi.Event.Object",
                                  "BoundsChanged",
                                  g_variant_new ("(siiva{sv})",
-                                                "", 0, 0, g_variant_new ("(iiii)", x, y, width, height), NULL),
+                                                "", 0, 0, g_variant_new ("(iiii)", (int) x, (int) y, width, height), NULL),
                                  NULL);
 }
 
+/* A child that is added and removed again in the same frame is
+ * never announced.
+ */
 static void
 emit_children_changed (GtkAtSpiContext         *self,
                        GtkAtSpiContext         *child_context,
                        int                      idx,
                        GtkAccessibleChildState  state)
 {
+  PendingChild child;
+
   /* If we don't have a connection on either contexts, we cannot emit a signal */
   if (self->connection == NULL || child_context->connection == NULL)
     return;
 
-  GVariant *context_ref = gtk_at_spi_context_to_ref (self);
-  GVariant *child_ref = gtk_at_spi_context_to_ref (child_context);
+  if (state == GTK_ACCESSIBLE_CHILD_STATE_REMOVED)
+    {
+      for (guint i = self->pending_children->len; i > 0; i--)
+        {
+          PendingChild *pending = &g_array_index (self->pending_children, PendingChild, i - 1);
+
+          if (strcmp (pending->child_path, child_context->context_path) == 0)
+            {
+              if (pending->state == GTK_ACCESSIBLE_CHILD_STATE_ADDED)
+                {
+                  g_array_remove_index (self->pending_children, i - 1);
+                  return;
+                }
+
+              break;
+            }
+        }
+    }
+
+  /* The child may be gone by the time the signal is emitted */
+  child.child_path = g_strdup (child_context->context_path);
+  child.child_ref = g_variant_ref_sink (gtk_at_spi_context_to_ref (child_context));
+  child.idx = idx;
+  child.state = state;
+  g_array_append_val (self->pending_children, child);
 
-  gtk_at_spi_emit_children_changed (self->connection,
-                                    self->context_path,
-                                    state,
-                                    idx,
-                                    child_ref,
-                                    context_ref);
+  schedule_flush (self);
+}
+
+static void
+pending_property_clear (gpointer data)
+{
+  PendingProperty *property = data;
+
+  g_variant_unref (property->value);
+}
+
+static void
+pending_child_clear (gpointer data)
+{
+  PendingChild *child = data;
+
+  g_free (child->child_path);
+  g_variant_unref (child->child_ref);
+}
+
+static void
+gtk_at_spi_context_flush_pending (GtkAtSpiContext *self)
+{
+  unschedule_flush (self);
+
+  if (self->connection == NULL)
+    goto out;
+
+  for (guint i = 0; i < self->pending_children->len; i++)
+    {
+      PendingChild *child = &g_array_index (self->pending_children, PendingChild, i);
+
+      gtk_at_spi_emit_children_changed (self->connection,
+                                        self->context_path,
+                                        child->state,
+                                        child->idx,
+                                        child->child_ref,
+                                        gtk_at_spi_context_to_ref (self));
+    }
+
+  for (guint i = 0; i < self->pending_properties->len; i++)
+    {
+      PendingProperty *property = &g_array_index (self->pending_properties, PendingProperty, i);
+
+      g_dbus_connection_emit_signal (self->connection,
+                                     NULL,
+                                     self->context_path,
+                                     "org.a11y.atspi.Event.Object",
+                                     "PropertyChange",
+                                     g_variant_new ("(siiva{sv})",
+                                                    property->name, 0, 0, property->value, NULL),
+                                     NULL);
+    }
+
+  for (guint i = 0; i < self->pending_states->len; i++)
+    {
+      PendingState *state = &g_array_index (self->pending_states, PendingState, i);
+
+      g_dbus_connection_emit_signal (self->connection,
+                                     NULL,
+                                     self->context_path,
+                                     "org.a11y.atspi.Event.Object",
+                                     "StateChanged",
+                                     g_variant_new ("(siiva{sv})",
+                                                    state->name, state->enabled, 0, g_variant_new_string ("0"), NULL),
+                                     NULL);
+    }
+
+  if (self->pending_bounds)
+    emit_bounds_changed (self);
+
+out:
+  g_array_set_size (self->pending_children, 0);
+  g_array_set_size (self->pending_properties, 0);
+  g_array_set_size (self->pending_states, 0);
+  self->pending_bounds = FALSE;
 }
 
 static void
@@ -862,6 +1133,8 @@ emit_focus (GtkAtSpiContext *self,
   if (self->connection == NULL)
     return;
 
+  gtk_at_spi_context_flush_pending (self);
+
   if (focus_in)
     g_dbus_connection_emit_signal (self->connection,
                                    NULL,
@@ -880,6 +1153,8 @@ emit_window_event (GtkAtSpiContext *self,
   if (self->connection == NULL)
     return;
 
+  gtk_at_spi_context_flush_pending (self);
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
@@ -1146,29 +1421,17 @@ gtk_at_spi_context_bounds_change (GtkATContext *ctx)
 {
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (ctx);
   GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
-  GtkWidget *widget;
-  GtkWidget *parent;
-  double x, y;
-  int width, height;
 
   if (!GTK_IS_WIDGET (accessible))
     return;
 
-  widget = GTK_WIDGET (accessible);
-  if (!gtk_widget_get_realized (widget))
+  if (!gtk_widget_get_realized (GTK_WIDGET (accessible)) ||
+      self->connection == NULL)
     return;
 
-  parent = gtk_widget_get_parent (widget);
-
-  if (parent)
-    gtk_widget_translate_coordinates (widget, parent, 0., 0., &x, &y);
-  else
-    x = y = 0.;
-
-  width = gtk_widget_get_width (widget);
-  height = gtk_widget_get_height (widget);
-
-  emit_bounds_changed (self, (int)x, (int)y, width, height);
+  /* The bounds are read when the change is emitted */
+  self->pending_bounds = TRUE;
+  schedule_flush (self);
 }
 
 static void
@@ -1424,6 +1687,11 @@ gtk_at_spi_context_finalize (GObject *gobject)
 {
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (gobject);
 
+  unschedule_flush (self);
+  g_array_unref (self->pending_states);
+  g_array_unref (self->pending_properties);
+  g_array_unref (self->pending_children);
+
   gtk_at_spi_context_unregister_object (self);
 
   g_clear_object (&self->root);
@@ -1527,6 +1795,7 @@ gtk_at_spi_context_unrealize (GtkATContext *context)
                              G_OBJECT_TYPE_NAME (accessible)));
 
   /* Notify ATs that the accessible object is going away */
+  gtk_at_spi_context_flush_pending (self);
   emit_defunct (self);
   gtk_at_spi_root_unregister (self->root, self);
 
@@ -1558,6 +1827,13 @@ gtk_at_spi_context_class_init (GtkAtSpiContextClass *klass)
 static void
 gtk_at_spi_context_init (GtkAtSpiContext *self)
 {
+  self->pending_states = g_array_new (FALSE, FALSE, sizeof (PendingState));
+
+  self->pending_properties = g_array_new (FALSE, FALSE, sizeof (PendingProperty));
+  g_array_set_clear_func (self->pending_properties, pending_property_clear);
+
+  self->pending_children = g_array_new (FALSE, FALSE, sizeof (PendingChild));
+  g_array_set_clear_func (self->pending_children, pending_child_clear);
 }
 /* }}} */
 /* {{{ Bus address discovery */
@@ -825,12 +825,67 @@ gtk_css_tokenizer_consume_char (GtkCssTokenizer *tokenizer,
     }
 }
 
+/* The following functions find runs of ASCII characters that can be
+ * consumed in one go, without decoding UTF-8 and updating the location
+ * for every character. None of them includes newlines in the run.
+ */
+static inline gsize
+gtk_css_tokenizer_count_blanks (GtkCssTokenizer *tokenizer)
+{
+  const char *data;
+
+  for (data = tokenizer->data; data < tokenizer->end; data++)
+    {
+      if (*data != ' ' && *data != '\t')
+        break;
+    }
+
+  return data - tokenizer->data;
+}
+
+static inline gsize
+gtk_css_tokenizer_count_ascii_name (GtkCssTokenizer *tokenizer)
+{
+  const char *data;
+
+  for (data = tokenizer->data; data < tokenizer->end; data++)
+    {
+      if (!g_ascii_isalnum (*data) && *data != '-' && *data != '_')
+        break;
+    }
+
+  return data - tokenizer->data;
+}
+
+/* Counts printable ASCII characters and tabs, excluding @stop1 and @stop2 */
+static inline gsize
+gtk_css_tokenizer_count_ascii_until (GtkCssTokenizer *tokenizer,
+                                     char             stop1,
+                                     char             stop2)
+{
+  const char *data;
+
+  for (data = tokenizer->data; data < tokenizer->end; data++)
+    {
+      if ((*data < ' ' && *data != '\t') || is_multibyte (*data) ||
+          *data == stop1 || *data == stop2)
+        break;
+    }
+
+  return data - tokenizer->data;
+}
+
 static void
 gtk_css_tokenizer_read_whitespace (GtkCssTokenizer *tokenizer,
                                    GtkCssToken     *token)
 {
   do {
-    gtk_css_tokenizer_consume_whitespace (tokenizer);
+    gsize n = gtk_css_tokenizer_count_blanks (tokenizer);
+
+    if (n > 0)
+      gtk_css_tokenizer_consume (tokenizer, n, n);
+    else
+      gtk_css_tokenizer_consume_whitespace (tokenizer);
   } while (tokenizer->data != tokenizer->end &&
            is_whitespace (*tokenizer->data));
 
@@ -901,10 +956,17 @@ gtk_css_tokenizer_read_name (GtkCssTokenizer *tokenizer)
               gtk_css_tokenizer_consume_char (tokenizer, tokenizer->name_buffer);
             }
         }
-      else if (is_name (*tokenizer->data))
+      else if (is_multibyte (*tokenizer->data))
         {
           gtk_css_tokenizer_consume_char (tokenizer, tokenizer->name_buffer);
         }
+      else if (is_name (*tokenizer->data))
+        {
+          gsize n = gtk_css_tokenizer_count_ascii_name (tokenizer);
+
+          g_string_append_len (tokenizer->name_buffer, tokenizer->data, n);
+          gtk_css_tokenizer_consume (tokenizer, n, n);
+        }
       else
         {
           break;
@@ -1203,6 +1265,15 @@ gtk_css_tokenizer_read_string (GtkCssTokenizer  *tokenizer,
 
   while (tokenizer->data < tokenizer->end)
     {
+      gsize n = gtk_css_tokenizer_count_ascii_until (tokenizer, end, '\\');
+
+      if (n > 0)
+        {
+          g_string_append_len (string, tokenizer->data, n);
+          gtk_css_tokenizer_consume (tokenizer, n, n);
+          continue;
+        }
+
       if (*tokenizer->data == end)
         {
           gtk_css_tokenizer_consume_ascii (tokenizer);
@@ -1252,6 +1323,14 @@ gtk_css_tokenizer_read_comment (GtkCssTokenizer  *tokenizer,
 
   while (tokenizer->data < tokenizer->end)
     {
+      gsize n = gtk_css_tokenizer_count_ascii_until (tokenizer, '*', '*');
+
+      if (n > 0)
+        {
+          gtk_css_tokenizer_consume (tokenizer, n, n);
+          continue;
+        }
+
       if (gtk_css_tokenizer_remaining (tokenizer) > 1 &&
           tokenizer->data[0] == '*' && tokenizer->data[1] == '/')
         {
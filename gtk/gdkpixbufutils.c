@@ -325,6 +325,7 @@ gtk_make_symbolic_pixbuf_from_data (const char  *file_data,
 {
   const char *r_string = "rgb(255,0,0)";
   const char *g_string = "rgb(0,255,0)";
+  const char *plane_classes[3] = { "success", "warning", "error" };
   char *icon_width_str;
   char *icon_height_str;
   GdkPixbuf *loaded;
@@ -370,7 +371,15 @@ gtk_make_symbolic_pixbuf_from_data (const char  *file_data,
        * opaque part of the color. We store these as the rgb
        * channels, with the color of the fg being implicitly
        * the "rest", as all color fractions should add up to 1.
+       *
+       * Most icons only use the fg color, so skip the renderings
+       * for classes the icon doesn't mention; their planes stay 0.
+       * The first rendering is always needed for the alpha channel.
        */
+      if (plane > 0 && pixbuf != NULL &&
+          g_strstr_len (file_data, file_len, plane_classes[plane]) == NULL)
+        continue;
+
       loaded = load_symbolic_svg (escaped_file_data, width, height,
                                   icon_width_str,
                                   icon_height_str,
@@ -575,22 +584,34 @@ on_loader_size_prepared (GdkPixbufLoader *loader,
                               height * loader_data->scale_factor);
 }
 
+/* @width and @height are the size in device pixels that the image
+ * will be shown at, or -1 if that isn't known. Loaders may use them
+ * to decode a smaller image, which gets wrapped in a GtkScaler so
+ * that the intrinsic size is unchanged.
+ */
 GdkPaintable *
 gdk_paintable_new_from_bytes_scaled (GBytes *bytes,
-                                     int     scale_factor)
+                                     int     scale_factor,
+                                     int     width,
+                                     int     height)
 {
   LoaderData loader_data;
   GdkTexture *texture;
   GdkPaintable *paintable;
+  double scale;
 
   loader_data.scale_factor = scale_factor;
 
   if (gdk_texture_can_load (bytes))
     {
+      int downscale;
+
       /* We know these formats can't be scaled */
-      texture = gdk_texture_new_from_bytes (bytes, NULL);
+      texture = gdk_texture_new_from_bytes_at_size (bytes, width, height, &downscale, NULL);
       if (texture == NULL)
         return NULL;
+
+      scale = (double) scale_factor / downscale;
     }
   else
     {
@@ -610,10 +631,12 @@ gdk_paintable_new_from_bytes_scaled (GBytes *bytes,
 
       texture = gdk_texture_new_for_pixbuf (gdk_pixbuf_loader_get_pixbuf (loader));
       g_object_unref (loader);
+
+      scale = loader_data.scale_factor;
     }
 
-  if (loader_data.scale_factor != 1)
-    paintable = gtk_scaler_new (GDK_PAINTABLE (texture), loader_data.scale_factor);
+  if (scale != 1.0)
+    paintable = gtk_scaler_new (GDK_PAINTABLE (texture), scale);
   else
     paintable = g_object_ref ((GdkPaintable *)texture);
 
@@ -624,19 +647,21 @@ gdk_paintable_new_from_bytes_scaled (GBytes *bytes,
 
 GdkPaintable *
 gdk_paintable_new_from_path_scaled (const char *path,
-                                    int         scale_factor)
+                                    int         scale_factor,
+                                    int         width,
+                                    int         height)
 {
-  char *contents;
-  gsize length;
+  GFile *file;
   GBytes *bytes;
   GdkPaintable *paintable;
 
-  if (!g_file_get_contents (path, &contents, &length, NULL))
+  file = g_file_new_for_path (path);
+  bytes = gdk_texture_load_file_bytes (file, NULL);
+  g_object_unref (file);
+  if (!bytes)
     return NULL;
 
-  bytes = g_bytes_new_take (contents, length);
-
-  paintable = gdk_paintable_new_from_bytes_scaled (bytes, scale_factor);
+  paintable = gdk_paintable_new_from_bytes_scaled (bytes, scale_factor, width, height);
 
   g_bytes_unref (bytes);
 
@@ -645,7 +670,9 @@ gdk_paintable_new_from_path_scaled (const char *path,
 
 GdkPaintable *
 gdk_paintable_new_from_resource_scaled (const char *path,
-                                        int         scale_factor)
+                                        int         scale_factor,
+                                        int         width,
+                                        int         height)
 {
   GBytes *bytes;
   GdkPaintable *paintable;
@@ -654,7 +681,7 @@ gdk_paintable_new_from_resource_scaled (const char *path,
   if (!bytes)
     return NULL;
 
-  paintable = gdk_paintable_new_from_bytes_scaled (bytes, scale_factor);
+  paintable = gdk_paintable_new_from_bytes_scaled (bytes, scale_factor, width, height);
   g_bytes_unref (bytes);
 
   return paintable;
@@ -662,18 +689,91 @@ gdk_paintable_new_from_resource_scaled (const char *path,
 
 GdkPaintable *
 gdk_paintable_new_from_file_scaled (GFile *file,
-                                    int    scale_factor)
+                                    int    scale_factor,
+                                    int    width,
+                                    int    height)
 {
   GBytes *bytes;
   GdkPaintable *paintable;
 
-  bytes = g_file_load_bytes (file, NULL, NULL, NULL);
+  bytes = gdk_texture_load_file_bytes (file, NULL);
   if (!bytes)
     return NULL;
 
-  paintable = gdk_paintable_new_from_bytes_scaled (bytes, scale_factor);
+  paintable = gdk_paintable_new_from_bytes_scaled (bytes, scale_factor, width, height);
 
   g_bytes_unref (bytes);
 
   return paintable;
 }
+
+typedef struct {
+  GFile *file;
+  int scale_factor;
+  int width;
+  int height;
+} PaintableLoadData;
+
+static void
+paintable_load_data_free (gpointer data)
+{
+  PaintableLoadData *load_data = data;
+
+  g_object_unref (load_data->file);
+  g_free (load_data);
+}
+
+static void
+paintable_load_thread (GTask        *task,
+                       gpointer      source_object,
+                       gpointer      task_data,
+                       GCancellable *cancellable)
+{
+  PaintableLoadData *load_data = task_data;
+  GdkPaintable *paintable;
+
+  paintable = gdk_paintable_new_from_file_scaled (load_data->file,
+                                                  load_data->scale_factor,
+                                                  load_data->width,
+                                                  load_data->height);
+
+  g_task_return_pointer (task, paintable, g_object_unref);
+}
+
+/* Like gdk_paintable_new_from_file_scaled(), but reads and decodes
+ * the file in a thread. The result may be %NULL without an error,
+ * just like for the synchronous version.
+ */
+void
+gdk_paintable_new_from_file_scaled_async (GFile               *file,
+                                          int                  scale_factor,
+                                          int                  width,
+                                          int                  height,
+                                          GCancellable        *cancellable,
+                                          GAsyncReadyCallback  callback,
+                                          gpointer             user_data)
+{
+  PaintableLoadData *load_data;
+  GTask *task;
+
+  load_data = g_new (PaintableLoadData, 1);
+  load_data->file = g_object_ref (file);
+  load_data->scale_factor = scale_factor;
+  load_data->width = width;
+  load_data->height = height;
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gdk_paintable_new_from_file_scaled_async);
+  g_task_set_task_data (task, load_data, paintable_load_data_free);
+  g_task_run_in_thread (task, paintable_load_thread);
+  g_object_unref (task);
+}
+
+GdkPaintable *
+gdk_paintable_new_from_file_scaled_finish (GAsyncResult  *result,
+                                           GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
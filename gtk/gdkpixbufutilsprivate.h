@@ -82,13 +82,30 @@ GdkTexture *gtk_make_symbolic_texture_from_resource (const char    *path,
                                                      GError       **error);
 
 GdkPaintable *gdk_paintable_new_from_bytes_scaled    (GBytes        *bytes,
-                                                      int            scale_factor);
+                                                      int            scale_factor,
+                                                      int            width,
+                                                      int            height);
 GdkPaintable *gdk_paintable_new_from_path_scaled     (const char    *path,
-                                                      int            scale_factor);
+                                                      int            scale_factor,
+                                                      int            width,
+                                                      int            height);
 GdkPaintable *gdk_paintable_new_from_resource_scaled (const char    *path,
-                                                      int            scale_factor);
+                                                      int            scale_factor,
+                                                      int            width,
+                                                      int            height);
 GdkPaintable *gdk_paintable_new_from_file_scaled     (GFile         *file,
-                                                      int            scale_factor);
+                                                      int            scale_factor,
+                                                      int            width,
+                                                      int            height);
+void          gdk_paintable_new_from_file_scaled_async  (GFile               *file,
+                                                         int                  scale_factor,
+                                                         int                  width,
+                                                         int                  height,
+                                                         GCancellable        *cancellable,
+                                                         GAsyncReadyCallback  callback,
+                                                         gpointer             user_data);
+GdkPaintable *gdk_paintable_new_from_file_scaled_finish (GAsyncResult        *result,
+                                                         GError             **error);
 
 G_END_DECLS
 
@@ -159,6 +159,7 @@ struct _GtkActionMuxer
 
   GHashTable *observed_actions;
   GHashTable *groups;
+  GHashTable *resolved_actions;
   GtkAccels primary_accels;
 
   GtkBitmask *widget_actions_disabled;
@@ -193,6 +194,18 @@ typedef struct
   gulong        handler_ids[4];
 } Group;
 
+/* Where a full action name points to in one muxer: a class action of
+ * the widget, or the group with the matching prefix. The group is only
+ * a candidate, whether it has the action is still up to the group.
+ * Entries stay valid until a group is inserted or removed.
+ */
+typedef struct
+{
+  GtkWidgetAction *widget_action;
+  Group           *group;
+  const char      *unprefixed_name;
+} ResolvedAction;
+
 static inline guint
 get_action_position (GtkWidgetAction *action)
 {
@@ -268,36 +281,91 @@ gtk_action_muxer_list_actions (GtkActionMuxer *muxer,
   return (char **)keys;
 }
 
+static void
+gtk_action_muxer_free_resolved (gpointer data)
+{
+  g_slice_free (ResolvedAction, data);
+}
+
+static const ResolvedAction *
+gtk_action_muxer_resolve (GtkActionMuxer *muxer,
+                          const char     *full_name)
+{
+  ResolvedAction *resolved;
+  char *key;
+
+  if (!muxer->resolved_actions)
+    muxer->resolved_actions = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                     g_free, gtk_action_muxer_free_resolved);
+
+  resolved = g_hash_table_lookup (muxer->resolved_actions, full_name);
+  if (resolved)
+    return resolved;
+
+  key = g_strdup (full_name);
+  resolved = g_slice_new0 (ResolvedAction);
+
+  if (muxer->widget)
+    {
+      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
+      GtkWidgetClassPrivate *priv = klass->priv;
+      GtkWidgetAction *action;
+
+      for (action = priv->actions; action; action = action->next)
+        {
+          if (strcmp (action->name, full_name) == 0)
+            {
+              resolved->widget_action = action;
+              break;
+            }
+        }
+    }
+
+  if (!resolved->widget_action && muxer->groups)
+    {
+      char *dot = strchr (key, '.');
+
+      if (dot)
+        {
+          *dot = '\0';
+          resolved->group = g_hash_table_lookup (muxer->groups, key);
+          *dot = '.';
+          resolved->unprefixed_name = dot + 1;
+        }
+    }
+
+  g_hash_table_insert (muxer->resolved_actions, key, resolved);
+
+  return resolved;
+}
+
+static void
+gtk_action_muxer_invalidate_resolved (GtkActionMuxer *muxer)
+{
+  if (muxer->resolved_actions)
+    g_hash_table_remove_all (muxer->resolved_actions);
+}
+
 static Group *
 gtk_action_muxer_find_group (GtkActionMuxer  *muxer,
                              const char      *full_name,
                              const char     **action_name)
 {
-  const char *dot;
-  char *prefix;
-  const char *name;
-  Group *group;
+  const ResolvedAction *resolved;
 
   if (!muxer->groups)
     return NULL;
 
-  dot = strchr (full_name, '.');
-
-  if (!dot)
-    return NULL;
-
-  name = dot + 1;
-
-  prefix = g_strndup (full_name, dot - full_name);
-  group = g_hash_table_lookup (muxer->groups, prefix);
-  g_free (prefix);
+  resolved = gtk_action_muxer_resolve (muxer, full_name);
 
-  if (action_name)
-    *action_name = name;
+  if (resolved->group &&
+      g_action_group_has_action (resolved->group->group, resolved->unprefixed_name))
+    {
+      if (action_name)
+        *action_name = resolved->unprefixed_name;
 
-  if (group &&
-      g_action_group_has_action (group->group, name))
-    return group;
+      return resolved->group;
+    }
 
   return NULL;
 }
@@ -344,24 +412,18 @@ gtk_action_muxer_action_enabled_changed (GtkActionMuxer *muxer,
                                          const char     *action_name,
                                          gboolean        enabled)
 {
-  GtkWidgetAction *iter;
   Action *action;
   GSList *node;
 
   if (muxer->widget)
     {
-      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
-      GtkWidgetClassPrivate *priv = klass->priv;
+      const ResolvedAction *resolved = gtk_action_muxer_resolve (muxer, action_name);
 
-      for (iter = priv->actions; iter; iter = iter->next)
+      if (resolved->widget_action)
         {
-          if (strcmp (action_name, iter->name) == 0)
-            {
-              guint position = get_action_position (iter);
-              muxer->widget_actions_disabled =
-                _gtk_bitmask_set (muxer->widget_actions_disabled, position, !enabled);
-              break;
-            }
+          guint position = get_action_position (resolved->widget_action);
+          muxer->widget_actions_disabled =
+            _gtk_bitmask_set (muxer->widget_actions_disabled, position, !enabled);
         }
     }
 
@@ -526,13 +588,13 @@ gtk_action_muxer_action_added_to_group (GActionGroup *action_group,
 
   fullname = g_strconcat (group->prefix, ".", action_name, NULL);
 
-   if (muxer->parent)
-     gtk_action_observable_unregister_observer (GTK_ACTION_OBSERVABLE (muxer->parent),
-                                                fullname,
-                                                GTK_ACTION_OBSERVER (muxer));
-
   action = find_observers (muxer, fullname);
 
+  if (action && action->watchers && muxer->parent)
+    gtk_action_observable_unregister_observer (GTK_ACTION_OBSERVABLE (muxer->parent),
+                                               fullname,
+                                               GTK_ACTION_OBSERVER (muxer));
+
   if (action && action->watchers &&
       g_action_group_query_action (action_group, action_name,
                                    &enabled, &parameter_type, NULL, NULL, &state))
@@ -570,19 +632,19 @@ gtk_action_muxer_action_removed_from_group (GActionGroup *action_group,
 
   fullname = g_strconcat (group->prefix, ".", action_name, NULL);
   gtk_action_muxer_action_removed (muxer, fullname);
-  g_free (fullname);
 
-  action = find_observers (muxer, action_name);
+  /* The group may still report the action as present while the
+   * signal is emitted, so only look for other local providers.
+   */
+  action = find_observers (muxer, fullname);
 
-  if (action && action->watchers &&
-      !action_muxer_query_action (muxer, action_name,
-                                  NULL, NULL, NULL, NULL, NULL, FALSE))
-    {
-      if (muxer->parent)
-         gtk_action_observable_register_observer (GTK_ACTION_OBSERVABLE (muxer->parent),
-                                                  action_name,
-                                                  GTK_ACTION_OBSERVER (muxer));
-    }
+  if (action && action->watchers && muxer->parent &&
+      !gtk_action_muxer_resolve (muxer, fullname)->widget_action)
+    gtk_action_observable_register_observer (GTK_ACTION_OBSERVABLE (muxer->parent),
+                                             fullname,
+                                             GTK_ACTION_OBSERVER (muxer));
+
+  g_free (fullname);
 }
 
 static void
@@ -744,22 +806,20 @@ action_muxer_query_action (GtkActionMuxer      *muxer,
                            GVariant           **state,
                            gboolean             recurse)
 {
+  const ResolvedAction *resolved;
   GtkWidgetAction *action;
   Group *group;
   const char *unprefixed_name;
 
   if (muxer->widget)
     {
-      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
-      GtkWidgetClassPrivate *priv = klass->priv;
+      resolved = gtk_action_muxer_resolve (muxer, action_name);
+      action = resolved->widget_action;
 
-      for (action = priv->actions; action; action = action->next)
+      if (action)
         {
           guint position;
 
-          if (strcmp (action->name, action_name) != 0)
-            continue;
-
           position = get_action_position (action);
 
           if (enabled)
@@ -834,26 +894,22 @@ gtk_action_muxer_activate_action (GtkActionMuxer *muxer,
 
   if (muxer->widget)
     {
-      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
-      GtkWidgetClassPrivate *priv = klass->priv;
       GtkWidgetAction *action;
 
-      for (action = priv->actions; action; action = action->next)
+      action = gtk_action_muxer_resolve (muxer, action_name)->widget_action;
+      if (action)
         {
-          if (strcmp (action->name, action_name) == 0)
-            {
-              guint position = get_action_position (action);
+          guint position = get_action_position (action);
 
-              if (!_gtk_bitmask_get (muxer->widget_actions_disabled, position))
-                {
-                  if (action->activate)
-                    action->activate (muxer->widget, action->name, parameter);
-                  else if (action->pspec)
-                    prop_action_activate (muxer->widget, action, parameter);
-                }
-
-              return;
+          if (!_gtk_bitmask_get (muxer->widget_actions_disabled, position))
+            {
+              if (action->activate)
+                action->activate (muxer->widget, action->name, parameter);
+              else if (action->pspec)
+                prop_action_activate (muxer->widget, action, parameter);
             }
+
+          return;
         }
     }
 
@@ -876,18 +932,13 @@ gtk_action_muxer_change_action_state (GtkActionMuxer *muxer,
 
   if (muxer->widget)
     {
-      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
-      GtkWidgetClassPrivate *priv = klass->priv;
-
-      for (action = priv->actions; action; action = action->next)
+      action = gtk_action_muxer_resolve (muxer, action_name)->widget_action;
+      if (action)
         {
-          if (strcmp (action->name, action_name) == 0)
-            {
-              if (action->pspec)
-                prop_action_set_state (muxer->widget, action, state);
+          if (action->pspec)
+            prop_action_set_state (muxer->widget, action, state);
 
-              return;
-            }
+          return;
         }
     }
 
@@ -945,6 +996,7 @@ gtk_action_muxer_register_observer (GtkActionObservable *observable,
   gboolean enabled;
   const GVariantType *parameter_type;
   GVariant *state;
+  gboolean is_first;
   gboolean is_duplicate;
 
   if (!muxer->observed_actions)
@@ -962,27 +1014,35 @@ gtk_action_muxer_register_observer (GtkActionObservable *observable,
       g_hash_table_insert (muxer->observed_actions, action->fullname, action);
     }
 
-  is_duplicate = g_slist_find (action->watchers, observer) != NULL;
+  is_first = action->watchers == NULL;
+  is_duplicate = !is_first && g_slist_find (action->watchers, observer) != NULL;
   action->watchers = g_slist_prepend (action->watchers, observer);
   g_object_weak_ref (G_OBJECT (observer), gtk_action_muxer_weak_notify, action);
 
-  if (!is_duplicate)
-    {
-      if (action_muxer_query_action (muxer, name,
-                                     &enabled, &parameter_type,
-                                     NULL, NULL, &state, TRUE))
-        {
-          gtk_action_muxer_action_added (muxer, name, parameter_type, enabled, state);
-          g_clear_pointer (&state, g_variant_unref);
-        }
+  if (is_duplicate)
+    return;
 
-      if (muxer->parent)
-        {
-          gtk_action_observable_register_observer (GTK_ACTION_OBSERVABLE (muxer->parent),
-                                                   name,
-                                                   GTK_ACTION_OBSERVER (muxer));
-        }
+  /* The other watchers have been told about the action already,
+   * so only the new one needs to hear about it. Building a menu
+   * registers many observers on the same muxer, and notifying
+   * all of them each time made that quadratic.
+   */
+  if (action_muxer_query_action (muxer, name,
+                                 &enabled, &parameter_type,
+                                 NULL, NULL, &state, TRUE))
+    {
+      gtk_action_observer_action_added (observer, observable,
+                                        name, parameter_type, enabled, state);
+      g_clear_pointer (&state, g_variant_unref);
     }
+
+  /* The muxer forwards changes from its parent to all of its
+   * watchers, so it needs to be registered with the parent once.
+   */
+  if (is_first && muxer->parent)
+    gtk_action_observable_register_observer (GTK_ACTION_OBSERVABLE (muxer->parent),
+                                             name,
+                                             GTK_ACTION_OBSERVER (muxer));
 }
 
 static void
@@ -1044,6 +1104,8 @@ gtk_action_muxer_finalize (GObject *object)
     }
   if (muxer->groups)
     g_hash_table_unref (muxer->groups);
+  if (muxer->resolved_actions)
+    g_hash_table_unref (muxer->resolved_actions);
 
   gtk_accels_clear (&muxer->primary_accels);
 
@@ -1061,6 +1123,7 @@ gtk_action_muxer_dispose (GObject *object)
   if (muxer->observed_actions)
     g_hash_table_remove_all (muxer->observed_actions);
 
+  gtk_action_muxer_invalidate_resolved (muxer);
   muxer->widget = NULL;
 
   G_OBJECT_CLASS (gtk_action_muxer_parent_class)->dispose (object);
@@ -1275,6 +1338,7 @@ gtk_action_muxer_insert (GtkActionMuxer *muxer,
   group->prefix = g_strdup (prefix);
 
   g_hash_table_insert (muxer->groups, group->prefix, group);
+  gtk_action_muxer_invalidate_resolved (muxer);
 
   actions = g_action_group_list_actions (group->group);
   for (i = 0; actions[i]; i++)
@@ -1318,6 +1382,7 @@ gtk_action_muxer_remove (GtkActionMuxer *muxer,
       int i;
 
       g_hash_table_steal (muxer->groups, prefix);
+      gtk_action_muxer_invalidate_resolved (muxer);
 
       actions = g_action_group_list_actions (group->group);
       for (i = 0; actions[i]; i++)
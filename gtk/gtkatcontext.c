@@ -1165,7 +1165,27 @@ void
 gtk_at_context_platform_changed (GtkATContext                *self,
                                  GtkAccessiblePlatformChange  change)
 {
-  gtk_at_context_realize (self);
+  /* Don't realize contexts just because they became focusable, or
+   * lost the focus; lists create and recycle lots of focusable rows.
+   * ATs get to them when they walk the tree. Focus and activation
+   * need to be announced, though.
+   */
+  if (!self->realized)
+    {
+      GtkAccessiblePlatformState state;
+
+      if (change & GTK_ACCESSIBLE_PLATFORM_CHANGE_FOCUSED)
+        state = GTK_ACCESSIBLE_PLATFORM_STATE_FOCUSED;
+      else if (change & GTK_ACCESSIBLE_PLATFORM_CHANGE_ACTIVE)
+        state = GTK_ACCESSIBLE_PLATFORM_STATE_ACTIVE;
+      else
+        return;
+
+      if (!gtk_accessible_get_platform_state (self->accessible, state))
+        return;
+
+      gtk_at_context_realize (self);
+    }
 
   GTK_AT_CONTEXT_GET_CLASS (self)->platform_change (self, change);
 }
@@ -636,6 +636,129 @@ gtk_bitset_difference (GtkBitset       *self,
   roaring_bitmap_xor_inplace (&self->roaring, &other->roaring);
 }
 
+typedef void (* GtkBitsetRangeFunc) (guint    first,
+                                     guint    last,
+                                     gpointer data);
+
+/* Calls @func for all ranges of consecutive values in @self.
+ *
+ * This looks at the containers directly, so runs are handled as a
+ * whole and bitset containers a word at a time. A range may be split
+ * in two where it crosses from one container into the next.
+ */
+static void
+gtk_bitset_foreach_range (const GtkBitset    *self,
+                          GtkBitsetRangeFunc  func,
+                          gpointer            data)
+{
+  const roaring_array_t *ra = &self->roaring.high_low_container;
+  int32_t i, j;
+
+  for (i = 0; i < ra->size; i++)
+    {
+      guint base = (guint) ra->keys[i] << 16;
+      uint8_t type = ra->typecodes[i];
+      const void *container = container_unwrap_shared (ra->containers[i], &type);
+
+      switch (type)
+        {
+        case RUN_CONTAINER_TYPE_CODE:
+          {
+            const run_container_t *run = container;
+
+            for (j = 0; j < run->n_runs; j++)
+              func (base + run->runs[j].value,
+                    base + run->runs[j].value + run->runs[j].length,
+                    data);
+          }
+          break;
+
+        case ARRAY_CONTAINER_TYPE_CODE:
+          {
+            const array_container_t *array = container;
+            int32_t start;
+
+            for (start = 0, j = 1; j <= array->cardinality; j++)
+              {
+                if (j < array->cardinality &&
+                    array->array[j] == array->array[j - 1] + 1)
+                  continue;
+
+                func (base + array->array[start], base + array->array[j - 1], data);
+                start = j;
+              }
+          }
+          break;
+
+        case BITSET_CONTAINER_TYPE_CODE:
+          {
+            const bitset_container_t *bitset = container;
+            guint run_start = 0;
+            gboolean in_run = FALSE;
+
+            for (j = 0; j < BITSET_CONTAINER_SIZE_IN_WORDS; j++)
+              {
+                uint64_t word = bitset->array[j];
+                guint offset = 0;
+
+                while (offset < 64)
+                  {
+                    /* find the next bit that ends or starts a run */
+                    uint64_t rest = (in_run ? ~word : word) >> offset;
+
+                    if (rest == 0)
+                      break;
+
+                    offset += __builtin_ctzll (rest);
+                    if (in_run)
+                      func (base + run_start, base + j * 64 + offset - 1, data);
+                    else
+                      run_start = j * 64 + offset;
+                    in_run = !in_run;
+                  }
+              }
+
+            if (in_run)
+              func (base + run_start, base + 0xFFFF, data);
+          }
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+    }
+}
+
+static void
+gtk_bitset_add_range_shifted_left (guint    first,
+                                   guint    last,
+                                   gpointer data)
+{
+  gpointer *args = data;
+  GtkBitset *self = args[0];
+  guint amount = GPOINTER_TO_UINT (args[1]);
+
+  if (last < amount)
+    return;
+
+  roaring_bitmap_add_range_closed (&self->roaring, MAX (first, amount) - amount, last - amount);
+}
+
+static void
+gtk_bitset_add_range_shifted_right (guint    first,
+                                    guint    last,
+                                    gpointer data)
+{
+  gpointer *args = data;
+  GtkBitset *self = args[0];
+  guint amount = GPOINTER_TO_UINT (args[1]);
+
+  if (first > G_MAXUINT - amount)
+    return;
+
+  roaring_bitmap_add_range_closed (&self->roaring, first + amount, MIN (last, G_MAXUINT - amount) + amount);
+}
+
 /**
  * gtk_bitset_shift_left:
  * @self: a `GtkBitset`
@@ -650,9 +773,7 @@ gtk_bitset_shift_left (GtkBitset *self,
                        guint      amount)
 {
   GtkBitset *original;
-  GtkBitsetIter iter;
-  guint value;
-  gboolean loop;
+  gpointer args[2];
 
   g_return_if_fail (self != NULL);
 
@@ -662,12 +783,9 @@ gtk_bitset_shift_left (GtkBitset *self,
   original = gtk_bitset_copy (self);
   gtk_bitset_remove_all (self);
 
-  for (loop = gtk_bitset_iter_init_at (&iter, original, amount, &value);
-       loop;
-       loop = gtk_bitset_iter_next (&iter, &value))
-    {
-      gtk_bitset_add (self, value - amount);
-    }
+  args[0] = self;
+  args[1] = GUINT_TO_POINTER (amount);
+  gtk_bitset_foreach_range (original, gtk_bitset_add_range_shifted_left, args);
 
   gtk_bitset_unref (original);
 }
@@ -686,9 +804,7 @@ gtk_bitset_shift_right (GtkBitset *self,
                         guint      amount)
 {
   GtkBitset *original;
-  GtkBitsetIter iter;
-  guint value;
-  gboolean loop;
+  gpointer args[2];
 
   g_return_if_fail (self != NULL);
 
@@ -698,12 +814,9 @@ gtk_bitset_shift_right (GtkBitset *self,
   original = gtk_bitset_copy (self);
   gtk_bitset_remove_all (self);
 
-  for (loop = gtk_bitset_iter_init_first (&iter, original, &value);
-       loop && value <= G_MAXUINT - amount;
-       loop = gtk_bitset_iter_next (&iter, &value))
-    {
-      gtk_bitset_add (self, value + amount);
-    }
+  args[0] = self;
+  args[1] = GUINT_TO_POINTER (amount);
+  gtk_bitset_foreach_range (original, gtk_bitset_add_range_shifted_right, args);
 
   gtk_bitset_unref (original);
 }
@@ -215,9 +215,11 @@
 #include "gtkbuilderscopeprivate.h"
 #include "gtkdebug.h"
 #include "gtkexpression.h"
+#include "gdkprofilerprivate.h"
 #include "gtkmain.h"
 #include "gtkicontheme.h"
 #include "gtkintl.h"
+#include "gtklazywidgetprivate.h"
 #include "gtkprivate.h"
 #include "gtkshortcutactionprivate.h"
 #include "gtkshortcuttrigger.h"
@@ -270,6 +272,8 @@ typedef struct
   GType template_type;
   GObject *current_object;
   GtkBuilderScope *scope;
+  GtkBuilderProfileFunc profile_func;
+  gpointer profile_data;
 } GtkBuilderPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkBuilder, gtk_builder, G_TYPE_OBJECT)
@@ -754,6 +758,7 @@ _gtk_builder_construct (GtkBuilder  *builder,
   GObject *obj;
   int i;
   GParamFlags param_filter_flags;
+  gint64 start_time = 0, construct_start = 0, construct_end = 0;
 
   g_assert (info->type != G_TYPE_INVALID);
 
@@ -789,6 +794,9 @@ _gtk_builder_construct (GtkBuilder  *builder,
   else
     param_filter_flags = G_PARAM_CONSTRUCT | G_PARAM_CONSTRUCT_ONLY;
 
+  if (priv->profile_func)
+    start_time = gdk_profiler_get_current_time ();
+
   object_properties_init (&parameters);
   object_properties_init (&construct_parameters);
 
@@ -799,6 +807,9 @@ _gtk_builder_construct (GtkBuilder  *builder,
                               &parameters,
                               &construct_parameters);
 
+  if (priv->profile_func)
+    construct_start = gdk_profiler_get_current_time ();
+
   if (info->constructor)
     {
       GObject *constructor;
@@ -868,6 +879,9 @@ _gtk_builder_construct (GtkBuilder  *builder,
     }
   object_properties_destroy (&construct_parameters);
 
+  if (priv->profile_func)
+    construct_end = gdk_profiler_get_current_time ();
+
   if (parameters.names)
     {
       GtkBuildableIface *iface = NULL;
@@ -930,9 +944,40 @@ _gtk_builder_construct (GtkBuilder  *builder,
   /* we already own a reference to obj. */
   g_object_unref (obj);
 
+  if (priv->profile_func)
+    {
+      gint64 construct_time = construct_end - construct_start;
+
+      priv->profile_func (builder, info->type,
+                          construct_time,
+                          gdk_profiler_get_current_time () - start_time - construct_time,
+                          priv->profile_data);
+    }
+
   return obj;
 }
 
+/*<private>
+ * gtk_builder_set_profile_func:
+ * @builder: a `GtkBuilder`
+ * @func: (nullable): function to call for every constructed object
+ * @user_data: data to pass to @func
+ *
+ * Makes @builder report how long it took to construct each object,
+ * and how long to parse and set its properties. This is used by
+ * gtk4-builder-tool to profile ui files.
+ */
+void
+gtk_builder_set_profile_func (GtkBuilder            *builder,
+                              GtkBuilderProfileFunc  func,
+                              gpointer               user_data)
+{
+  GtkBuilderPrivate *priv = gtk_builder_get_instance_private (builder);
+
+  priv->profile_func = func;
+  priv->profile_data = user_data;
+}
+
 void
 _gtk_builder_apply_properties (GtkBuilder  *builder,
                                ObjectInfo  *info,
@@ -2558,6 +2603,90 @@ gtk_builder_value_from_string_type (GtkBuilder   *builder,
   return ret;
 }
 
+/* Templates are instantiated over and over with the same
+ * symbolic enum and flags values, so remember what the names
+ * resolved to instead of searching the class values each time.
+ */
+typedef struct {
+  GType type;
+  char *string;
+  guint value;
+} SymbolicValue;
+
+static guint
+symbolic_value_hash (gconstpointer data)
+{
+  const SymbolicValue *sv = data;
+
+  return g_str_hash (sv->string) ^ (guint) sv->type;
+}
+
+static gboolean
+symbolic_value_equal (gconstpointer a,
+                      gconstpointer b)
+{
+  const SymbolicValue *sva = a;
+  const SymbolicValue *svb = b;
+
+  return sva->type == svb->type &&
+         strcmp (sva->string, svb->string) == 0;
+}
+
+static void
+symbolic_value_free (gpointer data)
+{
+  SymbolicValue *sv = data;
+
+  g_free (sv->string);
+  g_slice_free (SymbolicValue, sv);
+}
+
+#define MAX_SYMBOLIC_VALUES 1024
+
+static GHashTable *symbolic_values;
+
+static gboolean
+lookup_symbolic_value (GType       type,
+                       const char *string,
+                       guint      *value)
+{
+  SymbolicValue key = { type, (char *) string, 0 };
+  SymbolicValue *sv;
+
+  if (symbolic_values == NULL)
+    return FALSE;
+
+  sv = g_hash_table_lookup (symbolic_values, &key);
+  if (sv == NULL)
+    return FALSE;
+
+  *value = sv->value;
+  return TRUE;
+}
+
+static void
+remember_symbolic_value (GType       type,
+                         const char *string,
+                         guint       value)
+{
+  SymbolicValue *sv;
+
+  if (symbolic_values == NULL)
+    symbolic_values = g_hash_table_new_full (symbolic_value_hash,
+                                             symbolic_value_equal,
+                                             symbolic_value_free,
+                                             NULL);
+  else if (g_hash_table_size (symbolic_values) >= MAX_SYMBOLIC_VALUES)
+    g_hash_table_remove_all (symbolic_values);
+
+  sv = g_slice_new (SymbolicValue);
+  sv->type = type;
+  sv->string = g_strdup (string);
+  sv->value = value;
+
+  g_hash_table_add (symbolic_values, sv);
+}
+
 gboolean
 _gtk_builder_enum_from_string (GType         type,
                                const char   *string,
@@ -2568,6 +2697,7 @@ _gtk_builder_enum_from_string (GType         type,
   GEnumValue *ev;
   char *endptr;
   int value;
+  guint cached;
   gboolean ret;
 
   g_return_val_if_fail (G_TYPE_IS_ENUM (type), FALSE);
@@ -2580,6 +2710,8 @@ _gtk_builder_enum_from_string (GType         type,
   value = g_ascii_strtoull (string, &endptr, 0);
   if (errno == 0 && endptr != string) /* parsed a number */
     *enum_value = value;
+  else if (lookup_symbolic_value (type, string, &cached))
+    *enum_value = (int) cached;
   else
     {
       eclass = g_type_class_ref (type);
@@ -2588,7 +2720,10 @@ _gtk_builder_enum_from_string (GType         type,
         ev = g_enum_get_value_by_name (eclass, string);
 
       if (ev)
-        *enum_value = ev->value;
+        {
+          *enum_value = ev->value;
+          remember_symbolic_value (type, string, (guint) ev->value);
+        }
       else
         {
           g_set_error (error,
@@ -2630,6 +2765,8 @@ _gtk_builder_flags_from_string (GType         type,
   value = g_ascii_strtoull (string, &endptr, 0);
   if (errno == 0 && endptr != string) /* parsed a number */
     *flags_value = value;
+  else if (lookup_symbolic_value (type, string, &value))
+    *flags_value = value;
   else
     {
       fclass = g_type_class_ref (type);
@@ -2699,6 +2836,7 @@ _gtk_builder_flags_from_string (GType         type,
           if (eos)
             {
               *flags_value = value;
+              remember_symbolic_value (type, string, value);
               break;
             }
         }
@@ -3109,3 +3247,184 @@ _gtk_builder_lookup_failed (GtkBuilder  *builder,
 
   return FALSE;
 }
+
+typedef struct {
+  GtkBuilder *builder;
+  GString *text;
+  int depth;
+  char *object_id;
+} LazyParserData;
+
+static void
+lazy_start_element (GtkBuildableParseContext  *context,
+                    const char                *element_name,
+                    const char               **names,
+                    const char               **values,
+                    gpointer                   user_data,
+                    GError                   **error)
+{
+  LazyParserData *data = user_data;
+  gboolean has_id = FALSE;
+  int i;
+
+  data->depth++;
+
+  /* The <lazy> element itself */
+  if (data->depth == 1)
+    return;
+
+  if (data->depth == 2)
+    {
+      if (strcmp (element_name, "object") != 0 || data->object_id != NULL)
+        {
+          g_set_error (error,
+                       GTK_BUILDER_ERROR,
+                       GTK_BUILDER_ERROR_INVALID_TAG,
+                       "<lazy> must contain exactly one <object>, not <%s>",
+                       element_name);
+          _gtk_builder_prefix_error (data->builder, context, error);
+          return;
+        }
+
+      for (i = 0; names[i]; i++)
+        {
+          if (strcmp (names[i], "id") == 0)
+            {
+              data->object_id = g_strdup (values[i]);
+              has_id = TRUE;
+            }
+        }
+
+      if (!has_id)
+        data->object_id = g_strdup ("___lazy_object___");
+    }
+
+  g_string_append_c (data->text, '<');
+  g_string_append (data->text, element_name);
+  for (i = 0; names[i]; i++)
+    {
+      char *escaped = g_markup_escape_text (values[i], -1);
+      g_string_append_printf (data->text, " %s=\"%s\"", names[i], escaped);
+      g_free (escaped);
+    }
+  if (data->depth == 2 && !has_id)
+    g_string_append_printf (data->text, " id=\"%s\"", data->object_id);
+  g_string_append_c (data->text, '>');
+}
+
+static void
+lazy_end_element (GtkBuildableParseContext  *context,
+                  const char                *element_name,
+                  gpointer                   user_data,
+                  GError                   **error)
+{
+  LazyParserData *data = user_data;
+
+  if (data->depth > 1)
+    g_string_append_printf (data->text, "</%s>", element_name);
+
+  data->depth--;
+}
+
+static void
+lazy_text (GtkBuildableParseContext  *context,
+           const char                *text,
+           gsize                      text_len,
+           gpointer                   user_data,
+           GError                   **error)
+{
+  LazyParserData *data = user_data;
+  char *escaped;
+
+  if (data->depth < 2)
+    return;
+
+  escaped = g_markup_escape_text (text, text_len);
+  g_string_append (data->text, escaped);
+  g_free (escaped);
+}
+
+static const GtkBuildableParser lazy_parser =
+  {
+    lazy_start_element,
+    lazy_end_element,
+    lazy_text,
+  };
+
+/*< private >
+ * _gtk_builder_lazy_tag_start:
+ * @builder: a `GtkBuilder`
+ * @parser: (out): a `GtkBuildableParser` to fill in
+ * @parser_data: (out): return location for the parser data
+ *
+ * Sets up @parser to record the `<object>` inside a `<lazy>`
+ * element instead of building it. Buildables that support lazy
+ * children call this from their custom_tag_start implementation
+ * and pass @parser_data to _gtk_builder_lazy_tag_end() when the
+ * element ends.
+ */
+void
+_gtk_builder_lazy_tag_start (GtkBuilder          *builder,
+                             GtkBuildableParser  *parser,
+                             gpointer            *parser_data)
+{
+  LazyParserData *data;
+
+  data = g_slice_new0 (LazyParserData);
+  data->builder = builder;
+  data->text = g_string_new ("<interface>");
+
+  *parser = lazy_parser;
+  *parser_data = data;
+}
+
+/*< private >
+ * _gtk_builder_lazy_tag_end:
+ * @builder: a `GtkBuilder`
+ * @parser_data: the data returned by _gtk_builder_lazy_tag_start()
+ *
+ * Finishes recording a `<lazy>` element.
+ *
+ * Returns: (transfer full) (nullable): a `GtkLazyWidget` that
+ *   builds the recorded object when it is first needed, or %NULL
+ *   if the element was empty
+ */
+GtkWidget *
+_gtk_builder_lazy_tag_end (GtkBuilder *builder,
+                           gpointer    parser_data)
+{
+  LazyParserData *data = parser_data;
+  GtkWidget *widget = NULL;
+  GBytes *bytes;
+  GError *error = NULL;
+
+  if (data->object_id != NULL)
+    {
+      g_string_append (data->text, "</interface>");
+
+      /* Pay for parsing the markup once, not on every instantiation */
+      bytes = _gtk_buildable_parser_precompile (data->text->str, data->text->len, &error);
+      if (bytes == NULL)
+        {
+          g_warning ("Failed to precompile lazy child: %s", error->message);
+          g_clear_error (&error);
+          bytes = g_bytes_new (data->text->str, data->text->len);
+        }
+
+      widget = gtk_lazy_widget_new (bytes,
+                                    data->object_id,
+                                    gtk_builder_get_scope (builder),
+                                    gtk_builder_get_translation_domain (builder),
+                                    gtk_builder_get_current_object (builder));
+      g_object_ref_sink (widget);
+      g_bytes_unref (bytes);
+    }
+  else
+    g_warning ("<lazy> element without an <object>");
+
+  g_string_free (data->text, TRUE);
+  g_free (data->object_id);
+  g_slice_free (LazyParserData, data);
+
+  return widget;
+}
@@ -290,4 +290,21 @@ GObject *_gtk_builder_lookup_object       (GtkBuilder                *builder,
 gboolean _gtk_builder_lookup_failed       (GtkBuilder                *builder,
                                            GError                   **error);
 
+void       _gtk_builder_lazy_tag_start    (GtkBuilder                *builder,
+                                           GtkBuildableParser        *parser,
+                                           gpointer                  *parser_data);
+GtkWidget *_gtk_builder_lazy_tag_end      (GtkBuilder                *builder,
+                                           gpointer                   parser_data);
+
+/* Times are in nanoseconds */
+typedef void (* GtkBuilderProfileFunc)    (GtkBuilder                *builder,
+                                           GType                      type,
+                                           gint64                     construct_time,
+                                           gint64                     properties_time,
+                                           gpointer                   user_data);
+
+void       gtk_builder_set_profile_func   (GtkBuilder                *builder,
+                                           GtkBuilderProfileFunc      func,
+                                           gpointer                   user_data);
+
 #endif /* __GTK_BUILDER_PRIVATE_H__ */
@@ -166,6 +166,11 @@ struct _GtkCellRendererTextPrivate
 {
   GtkWidget *entry;
 
+  /* Reused by get_layout(), the renderer is usually asked
+   * for the layout of a different row each time.
+   */
+  PangoLayout *cached_layout;
+
   PangoAttrList        *extra_attrs;
   GdkRGBA               foreground;
   GdkRGBA               background;
@@ -660,6 +665,7 @@ gtk_cell_renderer_text_finalize (GObject *object)
     g_object_unref (priv->language);
 
   g_clear_object (&priv->entry);
+  g_clear_object (&priv->cached_layout);
 
   G_OBJECT_CLASS (gtk_cell_renderer_text_parent_class)->finalize (object);
 }
@@ -1435,9 +1441,22 @@ get_layout (GtkCellRendererText *celltext,
   PangoUnderline uline;
   int xpad;
   gboolean placeholder_layout = show_placeholder_text (celltext);
+  const char *text = placeholder_layout ? priv->placeholder_text : priv->text;
 
-  layout = gtk_widget_create_pango_layout (widget, placeholder_layout ?
-                                           priv->placeholder_text : priv->text);
+  /* All the layout properties are set below, so a layout
+   * for the same widget can be reused for any text.
+   */
+  if (priv->cached_layout &&
+      pango_layout_get_context (priv->cached_layout) == gtk_widget_get_pango_context (widget))
+    {
+      layout = g_steal_pointer (&priv->cached_layout);
+      pango_layout_set_text (layout, text ? text : "", -1);
+    }
+  else
+    {
+      g_clear_object (&priv->cached_layout);
+      layout = gtk_widget_create_pango_layout (widget, text);
+    }
 
   gtk_cell_renderer_get_padding (GTK_CELL_RENDERER (celltext), &xpad, NULL);
 
@@ -1597,6 +1616,22 @@ get_layout (GtkCellRendererText *celltext,
 }
 
 
+/* Gives a layout from get_layout() back. It is kept for reuse,
+ * unless another one is already, which happens when layouts
+ * are requested while another one is in use.
+ */
+static void
+release_layout (GtkCellRendererText *celltext,
+                PangoLayout         *layout)
+{
+  GtkCellRendererTextPrivate *priv = gtk_cell_renderer_text_get_instance_private (celltext);
+
+  if (priv->cached_layout == NULL)
+    priv->cached_layout = layout;
+  else
+    g_object_unref (layout);
+}
+
 static void
 get_size (GtkCellRenderer    *cell,
 	  GtkWidget          *widget,
@@ -1741,7 +1776,7 @@ gtk_cell_renderer_text_snapshot (GtkCellRenderer      *cell,
 
   gtk_snapshot_pop (snapshot);
 
-  g_object_unref (layout);
+  release_layout (celltext, layout);
 }
 
 static void
@@ -1923,7 +1958,7 @@ gtk_cell_renderer_text_get_preferred_width (GtkCellRenderer *cell,
   char_width = pango_font_metrics_get_approximate_char_width (metrics);
 
   pango_font_metrics_unref (metrics);
-  g_object_unref (layout);
+  release_layout (celltext, layout);
 
   /* enforce minimum width for ellipsized labels at ~3 chars */
   if (priv->ellipsize_set && priv->ellipsize != PANGO_ELLIPSIZE_NONE)
@@ -1988,7 +2023,7 @@ gtk_cell_renderer_text_get_preferred_height_for_width (GtkCellRenderer *cell,
   if (natural_height)
     *natural_height = text_height + ypad * 2;
 
-  g_object_unref (layout);
+  release_layout (celltext, layout);
 }
 
 static void
@@ -2030,5 +2065,5 @@ gtk_cell_renderer_text_get_aligned_area (GtkCellRenderer       *cell,
   aligned_area->x = cell_area->x + x_offset;
   aligned_area->y = cell_area->y + y_offset;
 
-  g_object_unref (layout);
+  release_layout (celltext, layout);
 }
@@ -410,6 +410,35 @@ gtk_column_view_allocate_columns (GtkColumnView *self,
   return x;
 }
 
+/* Only create cells for columns that are visible or within half the
+ * width of the view of being scrolled in.
+ */
+static void
+gtk_column_view_update_columns_in_view (GtkColumnView *self,
+                                        int            x,
+                                        int            width)
+{
+  guint i, n;
+  int start, end;
+
+  start = x - width / 2;
+  end = x + width + width / 2;
+
+  n = g_list_model_get_n_items (G_LIST_MODEL (self->columns));
+  for (i = 0; i < n; i++)
+    {
+      GtkColumnViewColumn *column;
+      int col_x, col_width;
+
+      column = g_list_model_get_item (G_LIST_MODEL (self->columns), i);
+      gtk_column_view_column_get_allocation (column, &col_x, &col_width);
+      gtk_column_view_column_set_in_view (column,
+                                          gtk_column_view_column_get_visible (column) &&
+                                          col_x + col_width > start && col_x < end);
+      g_object_unref (column);
+    }
+}
+
 static void
 gtk_column_view_allocate (GtkWidget *widget,
                           int        width,
@@ -421,6 +450,7 @@ gtk_column_view_allocate (GtkWidget *widget,
 
   x = gtk_adjustment_get_value (self->hadjustment);
   full_width = gtk_column_view_allocate_columns (self, width);
+  gtk_column_view_update_columns_in_view (self, x, width);
 
   gtk_widget_measure (self->header, GTK_ORIENTATION_VERTICAL, full_width, &min, &nat, NULL, NULL);
   if (gtk_scrollable_get_vscroll_policy (GTK_SCROLLABLE (self->listview)) == GTK_SCROLL_MINIMUM)
@@ -74,6 +74,7 @@ struct _GtkColumnViewColumn
   guint visible     : 1;
   guint resizable   : 1;
   guint expand      : 1;
+  guint in_view     : 1; /* if rows have cells for this column */
 
   GMenuModel *menu;
 
@@ -352,6 +353,7 @@ gtk_column_view_column_init (GtkColumnViewColumn *self)
   self->resizable = FALSE;
   self->expand = FALSE;
   self->fixed_width = -1;
+  self->in_view = TRUE;
 }
 
 /**
@@ -505,15 +507,44 @@ gtk_column_view_column_get_allocation (GtkColumnViewColumn *self,
     *size = self->allocation_size;
 }
 
+/* Rows only have cells for the columns in view, so the position of
+ * our cells in a row is the number of such columns before us.
+ */
+static guint
+gtk_column_view_column_get_cell_position (GtkColumnViewColumn *self)
+{
+  GListModel *columns;
+  guint i, n, result;
+
+  columns = gtk_column_view_get_columns (self->view);
+  n = g_list_model_get_n_items (columns);
+  result = 0;
+
+  for (i = 0; i < n; i++)
+    {
+      GtkColumnViewColumn *column = g_list_model_get_item (columns, i);
+
+      g_object_unref (column);
+      if (column == self)
+        break;
+      if (column->in_view)
+        result++;
+    }
+
+  return result;
+}
+
 static void
 gtk_column_view_column_create_cells (GtkColumnViewColumn *self)
 {
   GtkListView *list;
   GtkWidget *row;
+  guint position;
 
   if (self->first_cell)
     return;
 
+  position = gtk_column_view_column_get_cell_position (self);
   list = gtk_column_view_get_list_view (GTK_COLUMN_VIEW (self->view));
   for (row = gtk_widget_get_first_child (GTK_WIDGET (list));
        row != NULL;
@@ -528,6 +559,7 @@ gtk_column_view_column_create_cells (GtkColumnViewColumn *self)
       list_item = GTK_LIST_ITEM_WIDGET (row);
       cell = gtk_column_view_cell_new (self);
       gtk_list_item_widget_add_child (list_item, cell);
+      gtk_list_item_widget_reorder_child (list_item, cell, position);
       gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (cell),
                                    gtk_list_item_widget_get_position (list_item),
                                    gtk_list_item_widget_get_item (list_item),
@@ -570,7 +602,7 @@ gtk_column_view_column_remove_header (GtkColumnViewColumn *self)
 static void
 gtk_column_view_column_ensure_cells (GtkColumnViewColumn *self)
 {
-  if (self->view && gtk_widget_get_root (GTK_WIDGET (self->view)))
+  if (self->view && self->in_view && gtk_widget_get_root (GTK_WIDGET (self->view)))
     gtk_column_view_column_create_cells (self);
   else
     gtk_column_view_column_remove_cells (self);
@@ -581,6 +613,40 @@ gtk_column_view_column_ensure_cells (GtkColumnViewColumn *self)
     gtk_column_view_column_remove_header (self);
 }
 
+/*<private>
+ * gtk_column_view_column_set_in_view:
+ * @self: a `GtkColumnViewColumn`
+ * @in_view: whether the column is close enough to the visible area
+ *   to need cells
+ *
+ * Columns that are scrolled far out of view don't need cells in the
+ * rows. Their cells are removed then, and created again once they
+ * come close to the visible area.
+ *
+ * This is only possible for columns with a fixed width, others need
+ * cells to measure their width.
+ */
+void
+gtk_column_view_column_set_in_view (GtkColumnViewColumn *self,
+                                    gboolean             in_view)
+{
+  if (self->fixed_width < 0)
+    in_view = TRUE;
+
+  if (self->in_view == in_view)
+    return;
+
+  self->in_view = in_view;
+
+  gtk_column_view_column_ensure_cells (self);
+}
+
+gboolean
+gtk_column_view_column_get_in_view (GtkColumnViewColumn *self)
+{
+  return self->in_view;
+}
+
 /**
  * gtk_column_view_column_get_column_view: (attributes org.gtk.Method.get_property=column-view)
  * @self: a `GtkColumnViewColumn`
@@ -621,17 +687,23 @@ gtk_column_view_column_set_position (GtkColumnViewColumn *self,
                                      guint                position)
 {
   GtkColumnViewCell *cell;
+  guint cell_position;
 
   gtk_list_item_widget_reorder_child (gtk_column_view_get_header_widget (self->view),
                                       self->header,
                                       position);
 
+  if (self->first_cell == NULL)
+    return;
+
+  cell_position = gtk_column_view_column_get_cell_position (self);
+
   for (cell = self->first_cell; cell; cell = gtk_column_view_cell_get_next (cell))
     {
       GtkListItemWidget *list_item;
 
       list_item = GTK_LIST_ITEM_WIDGET (gtk_widget_get_parent (GTK_WIDGET (cell)));
-      gtk_list_item_widget_reorder_child (list_item, GTK_WIDGET (cell), position);
+      gtk_list_item_widget_reorder_child (list_item, GTK_WIDGET (cell), cell_position);
     }
 }
 
@@ -989,6 +1061,10 @@ gtk_column_view_column_set_fixed_width (GtkColumnViewColumn *self,
 
   self->fixed_width = fixed_width;
 
+  /* Without a fixed width, we need the cells to know our width */
+  if (fixed_width < 0)
+    gtk_column_view_column_set_in_view (self, TRUE);
+
   gtk_column_view_column_queue_resize (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FIXED_WIDTH]);
@@ -31,6 +31,10 @@ void                    gtk_column_view_column_set_column_view          (GtkColu
 void                    gtk_column_view_column_set_position             (GtkColumnViewColumn    *self,
                                                                          guint                   position);
 
+void                    gtk_column_view_column_set_in_view              (GtkColumnViewColumn    *self,
+                                                                         gboolean                in_view);
+gboolean                gtk_column_view_column_get_in_view              (GtkColumnViewColumn    *self);
+
 void                    gtk_column_view_column_add_cell                 (GtkColumnViewColumn    *self,
                                                                          GtkColumnViewCell      *cell);
 void                    gtk_column_view_column_remove_cell              (GtkColumnViewColumn    *self,
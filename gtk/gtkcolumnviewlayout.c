@@ -46,13 +46,15 @@ gtk_column_view_layout_measure_along (GtkColumnViewLayout *self,
                                       int                 *natural_baseline)
 {
   GtkOrientation orientation = GTK_ORIENTATION_VERTICAL;
+  GListModel *columns;
   GtkWidget *child;
   guint i, n;
   GtkRequestedSize *sizes = NULL;
 
+  columns = gtk_column_view_get_columns (self->view);
+  n = g_list_model_get_n_items (columns);
   if (for_size > -1)
     {
-      n = g_list_model_get_n_items (gtk_column_view_get_columns (self->view));
       sizes = g_newa (GtkRequestedSize, n);
       gtk_column_view_distribute_width (self->view, for_size, sizes);
     }
@@ -66,6 +68,29 @@ gtk_column_view_layout_measure_along (GtkColumnViewLayout *self,
       int child_min_baseline = -1;
       int child_nat_baseline = -1;
 
+      if (for_size > -1)
+        {
+          GtkColumnViewColumn *column;
+
+          if (GTK_IS_COLUMN_VIEW_CELL (child))
+            column = gtk_column_view_cell_get_column (GTK_COLUMN_VIEW_CELL (child));
+          else
+            column = gtk_column_view_title_get_column (GTK_COLUMN_VIEW_TITLE (child));
+
+          /* Rows skip the cells of columns out of view, so find
+           * the size for the column of this child */
+          for (; i < n; i++)
+            {
+              GtkColumnViewColumn *item = g_list_model_get_item (columns, i);
+
+              g_object_unref (item);
+              if (item == column)
+                break;
+            }
+          if (i >= n)
+            break;
+        }
+
       if (!gtk_widget_should_layout (child))
         continue;
 
@@ -23,6 +23,8 @@
 
 #include "gtkcolumnviewcolumnprivate.h"
 #include "gtkintl.h"
+#include "gtkmultisorterprivate.h"
+#include "gtksorterprivate.h"
 #include "gtktypebuiltins.h"
 
 typedef struct
@@ -152,10 +154,40 @@ gtk_column_view_sorter_new (void)
   return g_object_new (GTK_TYPE_COLUMN_VIEW_SORTER, NULL);
 }
 
+/* Combine the keys of all columns, so sorting doesn't need to
+ * go through gtk_column_view_sorter_compare() for every comparison.
+ */
+static void
+gtk_column_view_sorter_changed (GtkColumnViewSorter *self)
+{
+  GSequenceIter *iter;
+  GtkSorter **sorters;
+  gboolean *inverted;
+  gsize i, n_sorters;
+
+  n_sorters = g_sequence_get_length (self->sorters);
+  sorters = g_newa (GtkSorter *, MAX (n_sorters, 1));
+  inverted = g_newa (gboolean, MAX (n_sorters, 1));
+
+  for (iter = g_sequence_get_begin_iter (self->sorters), i = 0;
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter), i++)
+    {
+      Sorter *s = g_sequence_get (iter);
+
+      sorters[i] = s->sorter;
+      inverted[i] = s->inverted;
+    }
+
+  gtk_sorter_changed_with_keys (GTK_SORTER (self),
+                                GTK_SORTER_CHANGE_DIFFERENT,
+                                gtk_multi_sort_keys_new_for_sorters (sorters, inverted, n_sorters));
+}
+
 static void
 gtk_column_view_sorter_changed_cb (GtkSorter *sorter, int change, gpointer data)
 {
-  gtk_sorter_changed (GTK_SORTER (data), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_column_view_sorter_changed (GTK_COLUMN_VIEW_SORTER (data));
 }
 
 static gboolean
@@ -223,7 +255,7 @@ gtk_column_view_sorter_add_column (GtkColumnViewSorter *self,
     gtk_column_view_column_notify_sort (first->column);
 
 out:
-  gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_column_view_sorter_changed (self);
 
   gtk_column_view_column_notify_sort (column);
 
@@ -239,7 +271,7 @@ gtk_column_view_sorter_remove_column (GtkColumnViewSorter *self,
 
   if (remove_column (self, column))
     {
-      gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+      gtk_column_view_sorter_changed (self);
       gtk_column_view_column_notify_sort (column);
       return TRUE;
     }
@@ -275,7 +307,7 @@ gtk_column_view_sorter_set_column (GtkColumnViewSorter *self,
  
   g_sequence_prepend (self->sorters, s);
 
-  gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_column_view_sorter_changed (self);
 
   gtk_column_view_column_notify_sort (column);
 
@@ -303,7 +335,7 @@ gtk_column_view_sorter_clear (GtkColumnViewSorter *self)
 
   g_sequence_remove_range (iter, g_sequence_get_end_iter (self->sorters));
 
-  gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_column_view_sorter_changed (self);
 
   gtk_column_view_column_notify_sort (column);
 
@@ -229,6 +229,13 @@ struct _GtkConstraintLayoutChild
   int values[LAST_VALUE];
   GtkConstraintRef *constraints[LAST_VALUE];
 
+  /* The allocation computed when the layout was last solved; it
+   * is only valid if allocation_serial matches the layout's one
+   */
+  GtkAllocation allocation;
+  int baseline;
+  guint allocation_serial;
+
   /* HashTable<static string, Variable>; a hash table of variables,
    * one for each attribute; we use these to query and suggest the
    * values for the solver. The string is static and does not need
@@ -264,6 +271,15 @@ struct _GtkConstraintLayout
 
   GListStore *constraints_observer;
   GListStore *guides_observer;
+
+  /* The state of the solver and the size the children were last
+   * allocated for; if neither has changed, the allocation of the
+   * children can be reused without solving the system again
+   */
+  guint solved_generation;
+  guint solved_serial;
+  int solved_width;
+  int solved_height;
 };
 
 G_DEFINE_TYPE (GtkConstraintLayoutChild, gtk_constraint_layout_child, GTK_TYPE_LAYOUT_CHILD)
@@ -1012,6 +1028,40 @@ gtk_constraint_layout_measure (GtkLayoutManager *manager,
     *natural = nat_value;
 }
 
+static gboolean
+allocate_from_last_solution (GtkConstraintLayout *self,
+                             GtkWidget           *widget)
+{
+  GtkLayoutManager *manager = GTK_LAYOUT_MANAGER (self);
+  GtkConstraintLayoutChild *info;
+  GtkWidget *child;
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      if (!gtk_widget_should_layout (child))
+        continue;
+
+      info = GTK_CONSTRAINT_LAYOUT_CHILD (gtk_layout_manager_get_layout_child (manager, child));
+      if (info->allocation_serial != self->solved_serial)
+        return FALSE;
+    }
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      if (!gtk_widget_should_layout (child))
+        continue;
+
+      info = GTK_CONSTRAINT_LAYOUT_CHILD (gtk_layout_manager_get_layout_child (manager, child));
+      gtk_widget_size_allocate (child, &info->allocation, info->baseline);
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_constraint_layout_allocate (GtkLayoutManager *manager,
                                 GtkWidget        *widget,
@@ -1030,6 +1080,21 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
   if (solver == NULL)
     return;
 
+  /* Children often queue a resize without their size actually changing,
+   * for instance when a label gets a new text of the same size. Then
+   * the constraints, and so the solution, are still the same.
+   */
+  if (self->solved_serial != 0 &&
+      self->solved_generation == gtk_constraint_solver_get_generation (solver) &&
+      self->solved_width == width &&
+      self->solved_height == height &&
+      allocate_from_last_solution (self, widget))
+    return;
+
+  self->solved_serial += 1;
+  if (self->solved_serial == 0)
+    self->solved_serial = 1;
+
   /* We add required stay constraints to ensure that the layout remains
    * within the bounds of the allocation
    */
@@ -1068,6 +1133,7 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
     {
       GtkConstraintVariable *var_top, *var_left, *var_width, *var_height;
       GtkConstraintVariable *var_baseline;
+      GtkConstraintLayoutChild *info;
       GtkAllocation child_alloc;
       int child_baseline = -1;
 
@@ -1098,6 +1164,11 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
       if (gtk_constraint_variable_get_value (var_baseline) > 0)
         child_baseline = floor (gtk_constraint_variable_get_value (var_baseline));
 
+      info = GTK_CONSTRAINT_LAYOUT_CHILD (gtk_layout_manager_get_layout_child (manager, child));
+      info->allocation = child_alloc;
+      info->baseline = child_baseline;
+      info->allocation_serial = self->solved_serial;
+
       gtk_widget_size_allocate (GTK_WIDGET (child),
                                 &child_alloc,
                                 child_baseline);
@@ -1132,6 +1203,10 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
   gtk_constraint_solver_remove_constraint (solver, stay_h);
   gtk_constraint_solver_remove_constraint (solver, stay_t);
   gtk_constraint_solver_remove_constraint (solver, stay_l);
+
+  self->solved_generation = gtk_constraint_solver_get_generation (solver);
+  self->solved_width = width;
+  self->solved_height = height;
 }
 
 static void
@@ -1190,6 +1265,7 @@ gtk_constraint_layout_unroot (GtkLayoutManager *manager)
     }
 
   self->solver = NULL;
+  self->solved_width = -1;
 }
 
 static void
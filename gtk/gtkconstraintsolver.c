@@ -250,6 +250,10 @@ struct _GtkConstraintSolver
   int optimize_count;
   int freeze_count;
 
+  /* Bumped whenever a constraint that is not an edit constraint is
+   * added or removed; edit constraints are only ever temporary */
+  guint generation;
+
   /* Bitfields; keep at the end */
   guint auto_solve : 1;
   guint needs_solving : 1;
@@ -1348,6 +1352,9 @@ gtk_constraint_solver_add_constraint_internal (GtkConstraintSolver *self,
   if (!gtk_constraint_solver_try_adding_directly (self, expr))
     gtk_constraint_solver_add_with_artificial_variable (self, expr);
 
+  if (!constraint->is_edit)
+    self->generation += 1;
+
   gtk_constraint_expression_unref (expr);
 
   self->needs_solving = TRUE;
@@ -1763,6 +1770,9 @@ gtk_constraint_solver_remove_constraint (GtkConstraintSolver *self,
 
   self->needs_solving = TRUE;
 
+  if (!constraint->is_edit)
+    self->generation += 1;
+
   gtk_constraint_solver_reset_stay_constants (self);
 
   z_row = g_hash_table_lookup (self->rows, self->objective);
@@ -2118,6 +2128,29 @@ gtk_constraint_solver_clear (GtkConstraintSolver *solver)
 
   solver->needs_solving = FALSE;
   solver->auto_solve = TRUE;
+
+  solver->generation += 1;
+}
+
+/*< private >
+ * gtk_constraint_solver_get_generation:
+ * @solver: a `GtkConstraintSolver`
+ *
+ * Retrieves a number that changes whenever constraints other than
+ * edit constraints are added to or removed from @solver.
+ *
+ * If the generation is the same as when the solution was last
+ * queried, and the edit constraints used then have been removed,
+ * the same solution is still valid.
+ *
+ * Returns: the generation of the constraints in the solver
+ */
+guint
+gtk_constraint_solver_get_generation (GtkConstraintSolver *solver)
+{
+  g_return_val_if_fail (GTK_IS_CONSTRAINT_SOLVER (solver), 0);
+
+  return solver->generation;
 }
 
 char *
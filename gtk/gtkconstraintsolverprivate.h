@@ -108,6 +108,9 @@ gtk_constraint_solver_note_removed_variable (GtkConstraintSolver *self,
 void
 gtk_constraint_solver_clear (GtkConstraintSolver *solver);
 
+guint
+gtk_constraint_solver_get_generation (GtkConstraintSolver *solver);
+
 char *
 gtk_constraint_solver_to_string (GtkConstraintSolver *solver);
 
@@ -30,6 +30,7 @@
 #include "gtkcssnumbervalueprivate.h"
 #include "gtkcssshorthandpropertyprivate.h"
 #include "gtkcssstaticstyleprivate.h"
+#include "gtkcssstatisticsprivate.h"
 #include "gtkcssstringvalueprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkcsstransitionprivate.h"
@@ -731,6 +732,7 @@ gtk_css_animated_style_create_css_transitions (GPtrArray   *animations,
                                 gtk_css_style_get_value (base_style, i)))
         continue;
 
+      gtk_css_statistics_add (GTK_CSS_STAT_TRANSITIONS, 1);
       animation = _gtk_css_transition_new (i,
                                            gtk_css_style_get_value (source, i),
                                            _gtk_css_array_value_get_nth (timing_functions, i),
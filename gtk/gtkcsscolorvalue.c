@@ -283,6 +283,18 @@ gtk_css_value_color_print (const GtkCssValue *value,
     }
 }
 
+/* Only literal colors are ever computed, so only they are interned */
+static guint
+gtk_css_value_color_hash (const GtkCssValue *value)
+{
+  g_assert (value->type == COLOR_TYPE_LITERAL);
+
+  return gtk_css_value_hash_double (value->sym_col.rgba.red) ^
+         gtk_css_value_hash_double (value->sym_col.rgba.green) << 1 ^
+         gtk_css_value_hash_double (value->sym_col.rgba.blue) << 2 ^
+         gtk_css_value_hash_double (value->sym_col.rgba.alpha) << 3;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_COLOR = {
   "GtkCssColorValue",
   gtk_css_value_color_free,
@@ -291,7 +303,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_COLOR = {
   gtk_css_value_color_transition,
   NULL,
   NULL,
-  gtk_css_value_color_print
+  gtk_css_value_color_print,
+  gtk_css_value_color_hash
 };
 
 static void
@@ -37,6 +37,7 @@ typedef struct {
 
 struct _GtkCssLookup {
   GtkBitmask *set_values;
+  guint64 ancestor_classes; /* classes on ancestors that may change the lookup, set along with the change */
   GtkCssLookupValue  values[GTK_CSS_PROPERTY_N_PROPERTIES];
 };
 
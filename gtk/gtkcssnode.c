@@ -21,6 +21,8 @@
 
 #include "gtkcssstaticstyleprivate.h"
 #include "gtkcssanimatedstyleprivate.h"
+#include "gtkcsslookupprivate.h"
+#include "gtkcssstatisticsprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
@@ -86,7 +88,9 @@
  */
 
 /* When these change we do a full restyling. Otherwise we try to figure out
- * if we need to change things. */
+ * if we need to change things. For parent classes, we only restyle if the
+ * style refers to one of the classes that changed, see
+ * gtk_css_style_needs_recreation(). */
 #define GTK_CSS_RADICAL_CHANGE (GTK_CSS_CHANGE_ID | GTK_CSS_CHANGE_NAME | GTK_CSS_CHANGE_CLASS | \
                                 GTK_CSS_CHANGE_PARENT_ID | GTK_CSS_CHANGE_PARENT_NAME | GTK_CSS_CHANGE_PARENT_CLASS | \
                                 GTK_CSS_CHANGE_SOURCE | GTK_CSS_CHANGE_PARENT_STYLE)
@@ -98,6 +102,10 @@
 
 G_DEFINE_TYPE (GtkCssNode, gtk_css_node, G_TYPE_OBJECT)
 
+static void gtk_css_node_invalidate_classes (GtkCssNode   *cssnode,
+                                             GtkCssChange  change,
+                                             guint64       classes);
+
 enum {
   NODE_ADDED,
   NODE_REMOVED,
@@ -124,11 +132,6 @@ gtk_css_node_get_style_provider_or_null (GtkCssNode *cssnode)
   return GTK_CSS_NODE_GET_CLASS (cssnode)->get_style_provider (cssnode);
 }
 
-static int invalidated_nodes;
-static int created_styles;
-static guint invalidated_nodes_counter;
-static guint created_styles_counter;
-
 static void
 gtk_css_node_set_invalid (GtkCssNode *node,
                           gboolean    invalid)
@@ -139,7 +142,7 @@ gtk_css_node_set_invalid (GtkCssNode *node,
   node->invalid = invalid;
 
   if (invalid)
-    invalidated_nodes++;
+    gtk_css_statistics_add (GTK_CSS_STAT_INVALIDATED_NODES, 1);
 
   if (node->visible)
     {
@@ -245,11 +248,30 @@ gtk_css_node_dispose (GObject *object)
   G_OBJECT_CLASS (gtk_css_node_parent_class)->dispose (object);
 }
 
+struct _GtkCssNodePrefetch
+{
+  GtkStyleProvider *provider;
+  GtkCssLookup lookup;
+  GtkCssChange change;
+};
+
+static void
+gtk_css_node_clear_prefetch (GtkCssNode *cssnode)
+{
+  if (cssnode->prefetch == NULL)
+    return;
+
+  _gtk_css_lookup_destroy (&cssnode->prefetch->lookup);
+  g_free (cssnode->prefetch);
+  cssnode->prefetch = NULL;
+}
+
 static void
 gtk_css_node_finalize (GObject *object)
 {
   GtkCssNode *cssnode = GTK_CSS_NODE (object);
 
+  gtk_css_node_clear_prefetch (cssnode);
   if (cssnode->style)
     g_object_unref (cssnode->style);
   gtk_css_node_declaration_unref (cssnode->decl);
@@ -321,12 +343,15 @@ lookup_in_global_parent_cache (GtkCssNode                  *node,
 
   g_assert (node->cache == NULL);
   node->cache = gtk_css_node_style_cache_lookup (parent->cache,
+                                                 node,
                                                  decl,
                                                  gtk_css_node_is_first_child (node),
                                                  gtk_css_node_is_last_child (node));
   if (node->cache == NULL)
     return NULL;
 
+  gtk_css_statistics_add (GTK_CSS_STAT_CACHE_HITS, 1);
+
   return gtk_css_node_style_cache_get_style (node->cache);
 }
 
@@ -349,6 +374,7 @@ store_in_global_parent_cache (GtkCssNode                  *node,
     parent->cache = gtk_css_node_style_cache_new (parent->style);
 
   node->cache = gtk_css_node_style_cache_insert (parent->cache,
+                                                 node,
                                                  (GtkCssNodeDeclaration *) decl,
                                                  gtk_css_node_is_first_child (node),
                                                  gtk_css_node_is_last_child (node),
@@ -363,6 +389,7 @@ gtk_css_node_create_style (GtkCssNode                   *cssnode,
   const GtkCssNodeDeclaration *decl;
   GtkCssStyle *style;
   GtkCssChange style_change;
+  guint64 ancestor_classes;
 
   decl = gtk_css_node_get_declaration (cssnode);
 
@@ -370,22 +397,43 @@ gtk_css_node_create_style (GtkCssNode                   *cssnode,
   if (style)
     return g_object_ref (style);
 
-  created_styles++;
+  gtk_css_statistics_add (GTK_CSS_STAT_CREATED_STYLES, 1);
 
   if (change & GTK_CSS_CHANGE_NEEDS_RECOMPUTE)
     {
       /* Need to recompute the change flags */
       style_change = 0;
+      ancestor_classes = 0;
     }
   else
     {
       style_change = gtk_css_static_style_get_change (gtk_css_style_get_static_style (cssnode->style));
+      ancestor_classes = gtk_css_static_style_get_ancestor_classes (gtk_css_style_get_static_style (cssnode->style));
     }
 
-  style = gtk_css_static_style_new_compute (gtk_css_node_get_style_provider (cssnode),
-                                            filter,
-                                            cssnode,
-                                            style_change);
+  if (cssnode->prefetch &&
+      cssnode->prefetch->provider == gtk_css_node_get_style_provider (cssnode))
+    {
+      if (style_change == 0)
+        {
+          style_change = cssnode->prefetch->change;
+          ancestor_classes = cssnode->prefetch->lookup.ancestor_classes;
+        }
+
+      style = gtk_css_static_style_new_from_lookup (cssnode->prefetch->provider,
+                                                    cssnode,
+                                                    &cssnode->prefetch->lookup,
+                                                    style_change,
+                                                    ancestor_classes);
+    }
+  else
+    {
+      style = gtk_css_static_style_new_compute (gtk_css_node_get_style_provider (cssnode),
+                                                filter,
+                                                cssnode,
+                                                style_change,
+                                                ancestor_classes);
+    }
 
   store_in_global_parent_cache (cssnode, decl, style);
 
@@ -400,13 +448,21 @@ should_create_transitions (GtkCssChange change)
 
 static gboolean
 gtk_css_style_needs_recreation (GtkCssStyle  *style,
-                                GtkCssChange  change)
+                                GtkCssChange  change,
+                                guint64       pending_classes)
 {
   gtk_internal_return_val_if_fail (GTK_IS_CSS_STATIC_STYLE (style), TRUE);
 
   /* Try to avoid invalidating if we can */
   if (change & GTK_CSS_RADICAL_CHANGE)
-    return TRUE;
+    {
+      /* Classes of ancestors only matter if a rule refers to them */
+      if ((change & GTK_CSS_RADICAL_CHANGE) != GTK_CSS_CHANGE_PARENT_CLASS ||
+          (gtk_css_static_style_get_ancestor_classes (GTK_CSS_STATIC_STYLE (style)) & pending_classes) != 0)
+        return TRUE;
+
+      change &= ~GTK_CSS_CHANGE_PARENT_CLASS;
+    }
 
   if (gtk_css_static_style_get_change (GTK_CSS_STATIC_STYLE (style)) & change)
     return TRUE;
@@ -425,7 +481,7 @@ gtk_css_node_real_update_style (GtkCssNode                   *cssnode,
 
   static_style = GTK_CSS_STYLE (gtk_css_style_get_static_style (style));
 
-  if (gtk_css_style_needs_recreation (static_style, change))
+  if (gtk_css_style_needs_recreation (static_style, change, cssnode->pending_classes))
     new_static_style = gtk_css_node_create_style (cssnode, filter, change);
   else
     new_static_style = g_object_ref (static_style);
@@ -477,6 +533,12 @@ gtk_css_node_real_validate (GtkCssNode *node)
 {
 }
 
+static gboolean
+gtk_css_node_real_can_defer_validate (GtkCssNode *node)
+{
+  return FALSE;
+}
+
 static GtkStyleProvider *
 gtk_css_node_real_get_style_provider (GtkCssNode *cssnode)
 {
@@ -553,6 +615,7 @@ gtk_css_node_class_init (GtkCssNodeClass *klass)
 
   klass->update_style = gtk_css_node_real_update_style;
   klass->validate = gtk_css_node_real_validate;
+  klass->can_defer_validate = gtk_css_node_real_can_defer_validate;
   klass->queue_validate = gtk_css_node_real_queue_validate;
   klass->dequeue_validate = gtk_css_node_real_dequeue_validate;
   klass->get_style_provider = gtk_css_node_real_get_style_provider;
@@ -626,12 +689,6 @@ gtk_css_node_class_init (GtkCssNodeClass *klass)
                           | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, NUM_PROPERTIES, cssnode_properties);
-
-  if (invalidated_nodes_counter == 0)
-    {
-      invalidated_nodes_counter = gdk_profiler_define_int_counter ("invalidated-nodes", "CSS Node Invalidations");
-      created_styles_counter = gdk_profiler_define_int_counter ("created-styles", "CSS Style Creations");
-    }
 }
 
 static void
@@ -695,6 +752,9 @@ gtk_css_node_parent_will_be_set (GtkCssNode *node)
 static void
 gtk_css_node_invalidate_style (GtkCssNode *cssnode)
 {
+  /* Whatever changed may change what the node matches */
+  gtk_css_node_clear_prefetch (cssnode);
+
   if (cssnode->style_is_invalid)
     return;
 
@@ -920,6 +980,7 @@ gtk_css_node_propagate_pending_changes (GtkCssNode *cssnode,
                                         gboolean    style_changed)
 {
   GtkCssChange change, child_change;
+  guint64 classes, child_classes;
   GtkCssNode *child;
 
   change = _gtk_css_change_for_child (cssnode->pending_changes);
@@ -929,14 +990,22 @@ gtk_css_node_propagate_pending_changes (GtkCssNode *cssnode,
   if (!cssnode->needs_propagation && change == 0)
     return;
 
+  classes = cssnode->pending_classes;
+
   for (child = gtk_css_node_get_first_child (cssnode);
        child;
        child = gtk_css_node_get_next_sibling (child))
     {
       child_change = child->pending_changes;
-      gtk_css_node_invalidate (child, change);
+      child_classes = child->pending_classes;
+      gtk_css_node_invalidate_classes (child,
+                                       change,
+                                       change & GTK_CSS_CHANGE_PARENT_CLASS ? classes : 0);
       if (child->visible)
-        change |= _gtk_css_change_for_sibling (child_change);
+        {
+          change |= _gtk_css_change_for_sibling (child_change);
+          classes |= child_classes;
+        }
     }
 
   cssnode->needs_propagation = FALSE;
@@ -976,8 +1045,10 @@ gtk_css_node_do_ensure_style (GtkCssNode                   *cssnode,
     }
 
   gtk_css_node_propagate_pending_changes (cssnode, style_changed);
+  gtk_css_node_clear_prefetch (cssnode);
 
   cssnode->pending_changes = 0;
+  cssnode->pending_classes = 0;
   cssnode->style_is_invalid = FALSE;
 }
 
@@ -1166,9 +1237,17 @@ gtk_css_node_get_state (GtkCssNode *cssnode)
 static void
 gtk_css_node_clear_classes (GtkCssNode *cssnode)
 {
+  const GQuark *classes;
+  guint64 changed = 0;
+  guint i, n_classes;
+
+  classes = gtk_css_node_declaration_get_classes (cssnode->decl, &n_classes);
+  for (i = 0; i < n_classes; i++)
+    changed |= gtk_css_class_mask_bit (classes[i]);
+
   if (gtk_css_node_declaration_clear_classes (&cssnode->decl))
     {
-      gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
+      gtk_css_node_invalidate_classes (cssnode, GTK_CSS_CHANGE_CLASS, changed);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
 }
@@ -1219,7 +1298,7 @@ gtk_css_node_add_class (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_add_class (&cssnode->decl, style_class))
     {
-      gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
+      gtk_css_node_invalidate_classes (cssnode, GTK_CSS_CHANGE_CLASS, gtk_css_class_mask_bit (style_class));
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
 }
@@ -1230,7 +1309,7 @@ gtk_css_node_remove_class (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_remove_class (&cssnode->decl, style_class))
     {
-      gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
+      gtk_css_node_invalidate_classes (cssnode, GTK_CSS_CHANGE_CLASS, gtk_css_class_mask_bit (style_class));
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
 }
@@ -1302,9 +1381,14 @@ gtk_css_node_invalidate_frame_clock (GtkCssNode *cssnode,
     gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_ANIMATIONS);
 }
 
-void
-gtk_css_node_invalidate (GtkCssNode   *cssnode,
-                         GtkCssChange  change)
+/* Like gtk_css_node_invalidate(), but with the classes that changed for
+ * GTK_CSS_CHANGE_CLASS and GTK_CSS_CHANGE_PARENT_CLASS, so that only
+ * descendants with rules referring to them get restyled.
+ */
+static void
+gtk_css_node_invalidate_classes (GtkCssNode   *cssnode,
+                                 GtkCssChange  change,
+                                 guint64       classes)
 {
   if (!cssnode->invalid)
     change &= ~GTK_CSS_CHANGE_TIMESTAMP;
@@ -1313,19 +1397,181 @@ gtk_css_node_invalidate (GtkCssNode   *cssnode,
     return;
 
   cssnode->pending_changes |= change;
+  cssnode->pending_classes |= classes;
 
   if (cssnode->parent)
     cssnode->parent->needs_propagation = TRUE;
   gtk_css_node_invalidate_style (cssnode);
 }
 
+void
+gtk_css_node_invalidate (GtkCssNode   *cssnode,
+                         GtkCssChange  change)
+{
+  /* We don't know which classes changed */
+  gtk_css_node_invalidate_classes (cssnode,
+                                   change,
+                                   change & (GTK_CSS_CHANGE_CLASS | GTK_CSS_CHANGE_PARENT_CLASS) ? G_MAXUINT64 : 0);
+}
+
+/* Number of children that need their selectors matched before the
+ * matching is spread over worker threads. Below that, starting the
+ * threads costs more than it saves.
+ */
+#define GTK_CSS_NODE_PREFETCH_THRESHOLD 32
+
+typedef struct {
+  const GtkCountingBloomFilter *filter;
+  GtkCssNode **nodes;
+  guint n_nodes;
+  int next;                     /* atomic */
+  guint running;                /* protected by mutex */
+  GMutex mutex;
+  GCond cond;
+} GtkCssNodePrefetchJob;
+
+static void
+gtk_css_node_prefetch_run (GtkCssNodePrefetchJob *job)
+{
+  for (;;)
+    {
+      guint i = (guint) g_atomic_int_add (&job->next, 1);
+      GtkCssNode *node;
+
+      if (i >= job->n_nodes)
+        break;
+
+      /* Selector matching only reads the node tree and the style
+       * sheets, and neither changes while the main thread waits.
+       */
+      node = job->nodes[i];
+      gtk_style_provider_lookup (node->prefetch->provider,
+                                 job->filter,
+                                 node,
+                                 &node->prefetch->lookup,
+                                 &node->prefetch->change);
+    }
+}
+
+static void
+gtk_css_node_prefetch_thread (gpointer data,
+                              gpointer user_data)
+{
+  GtkCssNodePrefetchJob *job = data;
+
+  gtk_css_node_prefetch_run (job);
+
+  g_mutex_lock (&job->mutex);
+  job->running--;
+  g_cond_signal (&job->cond);
+  g_mutex_unlock (&job->mutex);
+}
+
+/* Matches the selectors for the children of @cssnode that will need a
+ * new style on worker threads. Computing the values from the matches
+ * still happens on the main thread, when the children are validated,
+ * as values are not thread-safe.
+ *
+ * @filter must already contain the hashes of @cssnode.
+ */
+static void
+gtk_css_node_prefetch_children (GtkCssNode                   *cssnode,
+                                const GtkCountingBloomFilter *filter)
+{
+  static GThreadPool *pool = NULL;
+  GtkCssNodePrefetchJob job;
+  GHashTable *seen;
+  GPtrArray *nodes;
+  GtkCssNode *child;
+  guint i, n_threads;
+
+  n_threads = g_get_num_processors ();
+  if (n_threads < 2)
+    return;
+
+  nodes = g_ptr_array_new ();
+  seen = g_hash_table_new (gtk_css_node_declaration_hash, gtk_css_node_declaration_equal);
+
+  for (child = gtk_css_node_get_first_child (cssnode);
+       child;
+       child = gtk_css_node_get_next_sibling (child))
+    {
+      if (!child->visible || !child->style_is_invalid || child->prefetch != NULL)
+        continue;
+
+      if (GTK_CSS_NODE_GET_CLASS (child)->update_style != gtk_css_node_real_update_style)
+        continue;
+
+      if (!gtk_css_style_needs_recreation (GTK_CSS_STYLE (gtk_css_style_get_static_style (child->style)),
+                                           child->pending_changes,
+                                           child->pending_classes))
+        continue;
+
+      /* Siblings like this one will find its style in the parent's cache */
+      if (may_use_global_parent_cache (child) &&
+          !g_hash_table_add (seen, child->decl))
+        continue;
+
+      g_ptr_array_add (nodes, child);
+    }
+
+  g_hash_table_unref (seen);
+
+  if (nodes->len < GTK_CSS_NODE_PREFETCH_THRESHOLD)
+    {
+      g_ptr_array_unref (nodes);
+      return;
+    }
+
+  for (i = 0; i < nodes->len; i++)
+    {
+      child = g_ptr_array_index (nodes, i);
+
+      child->prefetch = g_new0 (GtkCssNodePrefetch, 1);
+      child->prefetch->provider = gtk_css_node_get_style_provider (child);
+      _gtk_css_lookup_init (&child->prefetch->lookup);
+    }
+
+  if (pool == NULL)
+    pool = g_thread_pool_new (gtk_css_node_prefetch_thread, NULL, n_threads - 1, FALSE, NULL);
+
+  job.filter = filter;
+  job.nodes = (GtkCssNode **) nodes->pdata;
+  job.n_nodes = nodes->len;
+  job.next = 0;
+  job.running = n_threads - 1;
+  g_mutex_init (&job.mutex);
+  g_cond_init (&job.cond);
+
+  for (i = 0; i < n_threads - 1; i++)
+    g_thread_pool_push (pool, &job, NULL);
+
+  gtk_css_node_prefetch_run (&job);
+
+  g_mutex_lock (&job.mutex);
+  while (job.running > 0)
+    g_cond_wait (&job.cond, &job.mutex);
+  g_mutex_unlock (&job.mutex);
+
+  g_mutex_clear (&job.mutex);
+  g_cond_clear (&job.cond);
+  g_ptr_array_unref (nodes);
+}
+
+/* Time a single validation may take before subtrees that can wait,
+ * like those of unmapped widgets, are left for the next frame.
+ */
+#define GTK_CSS_NODE_VALIDATE_BUDGET (4 * G_TIME_SPAN_MILLISECOND)
+
 static void
 gtk_css_node_validate_internal (GtkCssNode             *cssnode,
                                 GtkCountingBloomFilter *filter,
-                                gint64                  timestamp)
+                                gint64                  timestamp,
+                                gint64                  deadline)
 {
   GtkCssNode *child;
   gboolean bloomed = FALSE;
+  gboolean deferred = FALSE;
 
   if (!cssnode->invalid)
     return;
@@ -1343,20 +1589,36 @@ gtk_css_node_validate_internal (GtkCssNode             *cssnode,
        child;
        child = gtk_css_node_get_next_sibling (child))
     {
-      if (!child->visible)
+      if (!child->visible || !child->invalid)
         continue;
 
+      /* Leave the child invalid, so it gets picked up by a later
+       * validation. Its own style may still get computed when a
+       * later sibling needs it, but not the one of its subtree.
+       */
+      if (GTK_CSS_NODE_GET_CLASS (child)->can_defer_validate (child) &&
+          g_get_monotonic_time () > deadline)
+        {
+          deferred = TRUE;
+          continue;
+        }
+
       if (!bloomed)
         {
           gtk_css_node_declaration_add_bloom_hashes (cssnode->decl, filter);
+          gtk_css_node_prefetch_children (cssnode, filter);
           bloomed = TRUE;
         }
 
-      gtk_css_node_validate_internal (child, filter, timestamp);
+      gtk_css_node_validate_internal (child, filter, timestamp, deadline);
     }
 
   if (bloomed)
     gtk_css_node_declaration_remove_bloom_hashes (cssnode->decl, filter);
+
+  /* chains up to the root and queues another validation */
+  if (deferred)
+    gtk_css_node_set_invalid (cssnode, TRUE);
 }
 
 void
@@ -1364,6 +1626,7 @@ gtk_css_node_validate (GtkCssNode *cssnode)
 {
   GtkCountingBloomFilter filter = GTK_COUNTING_BLOOM_FILTER_INIT;
   gint64 timestamp;
+  gint64 start;
   gint64 before G_GNUC_UNUSED;
 
   before = GDK_PROFILER_CURRENT_TIME;
@@ -1371,17 +1634,15 @@ gtk_css_node_validate (GtkCssNode *cssnode)
   g_assert (cssnode->parent == NULL);
 
   timestamp = gtk_css_node_get_timestamp (cssnode);
+  start = g_get_monotonic_time ();
 
-  gtk_css_node_validate_internal (cssnode, &filter, timestamp);
+  gtk_css_node_validate_internal (cssnode, &filter, timestamp,
+                                  start + GTK_CSS_NODE_VALIDATE_BUDGET);
 
   if (GDK_PROFILER_IS_RUNNING)
-    {
-      gdk_profiler_end_mark (before,  "css validation", "");
-      gdk_profiler_set_int_counter (invalidated_nodes_counter, invalidated_nodes);
-      gdk_profiler_set_int_counter (created_styles_counter, created_styles);
-      invalidated_nodes = 0;
-      created_styles = 0;
-    }
+    gdk_profiler_end_mark (before,  "css validation", "");
+
+  gtk_css_statistics_end_frame (g_get_monotonic_time () - start);
 }
 
 GtkStyleProvider *
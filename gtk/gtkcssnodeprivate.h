@@ -36,6 +36,7 @@ G_BEGIN_DECLS
 #define GTK_CSS_NODE_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GTK_TYPE_CSS_NODE, GtkCssNodeClass))
 
 typedef struct _GtkCssNodeClass         GtkCssNodeClass;
+typedef struct _GtkCssNodePrefetch      GtkCssNodePrefetch;
 
 struct _GtkCssNode
 {
@@ -50,8 +51,10 @@ struct _GtkCssNode
   GtkCssNodeDeclaration *decl;
   GtkCssStyle           *style;
   GtkCssNodeStyleCache  *cache;                 /* cache for children to look up styles */
+  GtkCssNodePrefetch    *prefetch;              /* lookup matched ahead of time, valid until the node is invalidated */
 
   GtkCssChange           pending_changes;       /* changes that accumulated since the style was last computed */
+  guint64                pending_classes;       /* classes that changed on the node or its ancestors, see gtk_css_class_mask_bit() */
 
   guint                  visible :1;            /* node will be skipped when validating or computing styles */
   guint                  invalid :1;            /* node or a child needs to be validated (even if just for animation) */
@@ -90,6 +93,8 @@ struct _GtkCssNodeClass
   void                  (* queue_validate)              (GtkCssNode            *node);
   void                  (* dequeue_validate)            (GtkCssNode            *node);
   void                  (* validate)                    (GtkCssNode            *node);
+  /* TRUE if validating the node's subtree may be postponed to a later frame */
+  gboolean              (* can_defer_validate)          (GtkCssNode            *node);
 };
 
 GType                   gtk_css_node_get_type           (void) G_GNUC_CONST;
@@ -20,14 +20,26 @@
 #include "gtkcssnodestylecacheprivate.h"
 
 #include "gtkdebug.h"
+#include "gtkcssnodeprivate.h"
 #include "gtkcssstaticstyleprivate.h"
 
+/* Styles that depend on the position among the siblings are stored in
+ * a bucket without a style of its own. The bucket then contains one
+ * entry per relevant position, so that the children of all parents
+ * sharing the cache still share the style when at the same position.
+ */
 struct _GtkCssNodeStyleCache {
   guint        ref_count;
   GtkCssStyle *style;
   GHashTable  *children;
+
+  GtkCssChange position_change;
+  GHashTable  *positions;
 };
 
+#define POSITION_CHANGE (GTK_CSS_CHANGE_NTH_CHILD | GTK_CSS_CHANGE_NTH_LAST_CHILD)
+#define MAX_POSITION 0xFFFF
+
 #define UNPACK_DECLARATION(packed) ((GtkCssNodeDeclaration *) (GPOINTER_TO_SIZE (packed) & ~0x3))
 #define UNPACK_FLAGS(packed) (GPOINTER_TO_SIZE (packed) & 0x3)
 #define PACK(decl, first_child, last_child) GSIZE_TO_POINTER (GPOINTER_TO_SIZE (decl) | ((first_child) ? 0x2 : 0) | ((last_child) ? 0x1 : 0))
@@ -61,9 +73,11 @@ gtk_css_node_style_cache_unref (GtkCssNodeStyleCache *cache)
   if (cache->ref_count > 0)
     return;
 
-  g_object_unref (cache->style);
+  g_clear_object (&cache->style);
   if (cache->children)
     g_hash_table_unref (cache->children);
+  if (cache->positions)
+    g_hash_table_unref (cache->positions);
 
   g_slice_free (GtkCssNodeStyleCache, cache);
 }
@@ -98,16 +112,54 @@ may_be_stored_in_cache (GtkCssStyle *style)
 
   /* The cache is shared between all children of the parent, so if a
    * style depends on a sibling it is not independent of the child.
+   *
+   * Styles that depend on the position of the child are fine, they
+   * are stored per position, see get_position_key().
    */
   if (change & GTK_CSS_CHANGE_ANY_SIBLING)
     return FALSE;
 
-  /* Again, the cache is shared between all children of the parent.
-   * If the position is relevant, no child has the same style.
-   */
-  if (change & (GTK_CSS_CHANGE_NTH_CHILD | GTK_CSS_CHANGE_NTH_LAST_CHILD))
+  return TRUE;
+}
+
+static guint
+count_visible_siblings (GtkCssNode *node,
+                        gboolean    forward)
+{
+  GtkCssNode *iter;
+  guint n = 0;
+
+  for (iter = forward ? gtk_css_node_get_next_sibling (node) : gtk_css_node_get_previous_sibling (node);
+       iter != NULL && n <= MAX_POSITION;
+       iter = forward ? gtk_css_node_get_next_sibling (iter) : gtk_css_node_get_previous_sibling (iter))
+    {
+      if (gtk_css_node_get_visible (iter))
+        n++;
+    }
+
+  return n;
+}
+
+/* Packs the positions of @node that @position_change cares about.
+ * Returns %FALSE if the node is too far into its parent to cache it.
+ */
+static gboolean
+get_position_key (GtkCssNode   *node,
+                  GtkCssChange  position_change,
+                  gpointer     *key)
+{
+  guint nth_child = 0, nth_last_child = 0;
+
+  if (position_change & GTK_CSS_CHANGE_NTH_CHILD)
+    nth_child = count_visible_siblings (node, FALSE);
+  if (position_change & GTK_CSS_CHANGE_NTH_LAST_CHILD)
+    nth_last_child = count_visible_siblings (node, TRUE);
+
+  if (nth_child > MAX_POSITION || nth_last_child > MAX_POSITION)
     return FALSE;
 
+  *key = GUINT_TO_POINTER (nth_child << 16 | nth_last_child);
+
   return TRUE;
 }
 
@@ -135,14 +187,60 @@ gtk_css_node_style_cache_decl_free (gpointer item)
   gtk_css_node_declaration_unref (UNPACK_DECLARATION (item));
 }
 
+static GtkCssNodeStyleCache *
+gtk_css_node_style_cache_insert_positioned (GtkCssNodeStyleCache  *parent,
+                                            GtkCssNode            *node,
+                                            GtkCssNodeDeclaration *decl,
+                                            gboolean               is_first,
+                                            gboolean               is_last,
+                                            GtkCssStyle           *style,
+                                            GtkCssChange           position_change)
+{
+  GtkCssNodeStyleCache *bucket, *result;
+  gpointer key;
+
+  bucket = g_hash_table_lookup (parent->children, PACK (decl, is_first, is_last));
+  if (bucket == NULL)
+    {
+      bucket = g_slice_new0 (GtkCssNodeStyleCache);
+      bucket->ref_count = 1;
+      bucket->position_change = position_change;
+      bucket->positions = g_hash_table_new_full (NULL, NULL,
+                                                 NULL,
+                                                 (GDestroyNotify) gtk_css_node_style_cache_unref);
+
+      g_hash_table_insert (parent->children,
+                           PACK (gtk_css_node_declaration_ref (decl), is_first, is_last),
+                           bucket);
+    }
+  else if (bucket->position_change != position_change)
+    {
+      /* All styles for a declaration should depend on the same positions,
+       * but don't take chances with ones that don't.
+       */
+      return NULL;
+    }
+
+  if (!get_position_key (node, position_change, &key))
+    return NULL;
+
+  result = gtk_css_node_style_cache_new (style);
+
+  g_hash_table_insert (bucket->positions, key, gtk_css_node_style_cache_ref (result));
+
+  return result;
+}
+
 GtkCssNodeStyleCache *
 gtk_css_node_style_cache_insert (GtkCssNodeStyleCache   *parent,
+                                 GtkCssNode             *node,
                                  GtkCssNodeDeclaration  *decl,
                                  gboolean                is_first,
                                  gboolean                is_last,
                                  GtkCssStyle            *style)
 {
   GtkCssNodeStyleCache *result;
+  GtkCssChange position_change;
 
   if (!may_be_stored_in_cache (style))
     return NULL;
@@ -153,6 +251,12 @@ gtk_css_node_style_cache_insert (GtkCssNodeStyleCache   *parent,
                                               gtk_css_node_style_cache_decl_free,
                                               (GDestroyNotify) gtk_css_node_style_cache_unref);
 
+  position_change = gtk_css_static_style_get_change (GTK_CSS_STATIC_STYLE (style)) & POSITION_CHANGE;
+  if (position_change)
+    return gtk_css_node_style_cache_insert_positioned (parent, node, decl,
+                                                       is_first, is_last,
+                                                       style, position_change);
+
   result = gtk_css_node_style_cache_new (style);
 
   g_hash_table_insert (parent->children,
@@ -164,11 +268,13 @@ gtk_css_node_style_cache_insert (GtkCssNodeStyleCache   *parent,
 
 GtkCssNodeStyleCache *
 gtk_css_node_style_cache_lookup (GtkCssNodeStyleCache        *parent,
+                                 GtkCssNode                  *node,
                                  const GtkCssNodeDeclaration *decl,
                                  gboolean                     is_first,
                                  gboolean                     is_last)
 {
   GtkCssNodeStyleCache *result;
+  gpointer key;
 
   if (parent->children == NULL)
     return NULL;
@@ -177,6 +283,16 @@ gtk_css_node_style_cache_lookup (GtkCssNodeStyleCache        *parent,
   if (result == NULL)
     return NULL;
 
+  if (result->positions != NULL)
+    {
+      if (!get_position_key (node, result->position_change, &key))
+        return NULL;
+
+      result = g_hash_table_lookup (result->positions, key);
+      if (result == NULL)
+        return NULL;
+    }
+
   return gtk_css_node_style_cache_ref (result);
 }
 
@@ -20,6 +20,7 @@
 
 #include "gtkcssnodedeclarationprivate.h"
 #include "gtkcssstyleprivate.h"
+#include "gtkcsstypesprivate.h"
 
 G_BEGIN_DECLS
 
@@ -32,11 +33,13 @@ void                    gtk_css_node_style_cache_unref          (GtkCssNodeStyle
 GtkCssStyle *           gtk_css_node_style_cache_get_style      (GtkCssNodeStyleCache   *cache);
 
 GtkCssNodeStyleCache *  gtk_css_node_style_cache_insert         (GtkCssNodeStyleCache   *parent,
+                                                                 GtkCssNode             *node,
                                                                  GtkCssNodeDeclaration  *decl,
                                                                  gboolean                is_first,
                                                                  gboolean                is_last,
                                                                  GtkCssStyle            *style);
 GtkCssNodeStyleCache *  gtk_css_node_style_cache_lookup         (GtkCssNodeStyleCache        *parent,
+                                                                 GtkCssNode                  *node,
                                                                  const GtkCssNodeDeclaration *decl,
                                                                  gboolean                     is_first,
                                                                  gboolean                     is_last);
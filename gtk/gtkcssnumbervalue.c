@@ -233,6 +233,21 @@ gtk_css_value_number_equal (const GtkCssValue *val1,
   return TRUE;
 }
 
+static guint
+gtk_css_value_number_hash (const GtkCssValue *value)
+{
+  guint i, hash;
+
+  if (G_LIKELY (value->type == TYPE_DIMENSION))
+    return gtk_css_value_hash_double (value->dimension.value) * 31 + value->dimension.unit;
+
+  hash = value->calc.n_terms;
+  for (i = 0; i < value->calc.n_terms; i++)
+    hash = hash * 31 + gtk_css_value_hash (value->calc.terms[i]);
+
+  return hash;
+}
+
 static void
 gtk_css_value_number_print (const GtkCssValue *value,
                             GString           *string)
@@ -329,7 +344,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_NUMBER = {
   gtk_css_value_number_transition,
   NULL,
   NULL,
-  gtk_css_value_number_print
+  gtk_css_value_number_print,
+  gtk_css_value_number_hash
 };
 
 static gsize
@@ -28,6 +28,7 @@
 #include "gtkcsskeyframesprivate.h"
 #include "gtkcssselectorprivate.h"
 #include "gtkcssshorthandpropertyprivate.h"
+#include "gtkcssstatisticsprivate.h"
 #include "gtksettingsprivate.h"
 #include "gtkstyleprovider.h"
 #include "gtkstylepropertyprivate.h"
@@ -86,6 +87,24 @@
 
 #define MAX_SELECTOR_LIST_LENGTH 64
 
+/* Compiled style sheets, as written by gtk4-css-tool, are a header
+ * followed by the canonical form of the provider, see
+ * gtk_css_provider_to_string(). That form has all imports inlined,
+ * comments removed and shorthands expanded, so it is much faster to
+ * parse than the style sheet it was generated from.
+ */
+#define GTK_CSS_COMPILED_MAGIC "GTKCSSC"
+#define GTK_CSS_COMPILED_VERSION 1
+#define GTK_CSS_COMPILED_SUFFIX ".compiled"
+
+typedef struct {
+  char    magic[8];
+  guint32 format_version;
+  guint32 gtk_version;
+  guint32 source_size;
+  guint32 source_hash;
+} GtkCssCompiledHeader;
+
 struct _GtkCssProviderClass
 {
   GObjectClass parent_class;
@@ -270,7 +289,10 @@ gtk_css_ruleset_clear (GtkCssRuleset *ruleset)
       g_free (ruleset->styles);
     }
   if (ruleset->selector)
-    _gtk_css_selector_free (ruleset->selector);
+    {
+      gtk_css_statistics_forget_selector (ruleset->selector);
+      _gtk_css_selector_free (ruleset->selector);
+    }
 
   memset (ruleset, 0, sizeof (GtkCssRuleset));
 }
@@ -480,14 +502,21 @@ gtk_css_style_provider_lookup (GtkStyleProvider             *provider,
   gtk_css_selector_matches_init (&tree_rules);
   _gtk_css_selector_tree_match_all (priv->tree, filter, node, &tree_rules);
 
+  gtk_css_statistics_add (GTK_CSS_STAT_LOOKUPS, 1);
+
   if (!gtk_css_selector_matches_is_empty (&tree_rules))
     {
       verify_tree_match_results (css_provider, node, &tree_rules);
 
+      gtk_css_statistics_add (GTK_CSS_STAT_MATCHED_RULES, gtk_css_selector_matches_get_size (&tree_rules));
+
       for (i = gtk_css_selector_matches_get_size (&tree_rules) - 1; i >= 0; i--)
         {
           ruleset = gtk_css_selector_matches_get (&tree_rules, i);
 
+          if (gtk_css_statistics_get_record_selectors ())
+            gtk_css_statistics_add_selector_match (ruleset->selector);
+
           if (ruleset->styles == NULL)
             continue;
 
@@ -509,7 +538,7 @@ gtk_css_style_provider_lookup (GtkStyleProvider             *provider,
   gtk_css_selector_matches_clear (&tree_rules);
 
   if (change)
-    *change = gtk_css_selector_tree_get_change_all (priv->tree, filter, node);
+    *change = gtk_css_selector_tree_get_change_all (priv->tree, filter, node, &lookup->ancestor_classes);
 }
 
 static void
@@ -1168,6 +1197,110 @@ gtk_css_provider_load_from_path (GtkCssProvider  *css_provider,
   g_object_unref (file);
 }
 
+static guint32
+gtk_css_compiled_hash (GBytes *bytes)
+{
+  const guchar *data;
+  gsize i, size;
+  guint32 hash = 2166136261u;
+
+  data = g_bytes_get_data (bytes, &size);
+  for (i = 0; i < size; i++)
+    {
+      hash ^= data[i];
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+/*<private>
+ * gtk_css_provider_compile:
+ * @provider: a `GtkCssProvider`
+ * @source: the style sheet that @provider was loaded from
+ *
+ * Creates the compiled form of @provider, to be stored next to
+ * @source in a resource bundle.
+ *
+ * Returns: the compiled style sheet
+ */
+GBytes *
+gtk_css_provider_compile (GtkCssProvider *provider,
+                          GBytes         *source)
+{
+  GtkCssCompiledHeader header = { GTK_CSS_COMPILED_MAGIC, };
+  GByteArray *array;
+  char *css;
+
+  g_return_val_if_fail (GTK_IS_CSS_PROVIDER (provider), NULL);
+  g_return_val_if_fail (source != NULL, NULL);
+  g_return_val_if_fail (g_bytes_get_size (source) <= G_MAXUINT32, NULL);
+
+  header.format_version = GUINT32_TO_LE (GTK_CSS_COMPILED_VERSION);
+  header.gtk_version = GUINT32_TO_LE (GTK_MAJOR_VERSION << 16 | GTK_MINOR_VERSION);
+  header.source_size = GUINT32_TO_LE (g_bytes_get_size (source));
+  header.source_hash = GUINT32_TO_LE (gtk_css_compiled_hash (source));
+
+  css = gtk_css_provider_to_string (provider);
+
+  array = g_byte_array_new ();
+  g_byte_array_append (array, (const guint8 *) &header, sizeof (header));
+  g_byte_array_append (array, (const guint8 *) css, strlen (css));
+
+  g_free (css);
+
+  return g_byte_array_free_to_bytes (array);
+}
+
+/* Returns the compiled form of the style sheet at @resource_path,
+ * if there is one next to it and it is still up to date.
+ */
+static GBytes *
+gtk_css_provider_lookup_compiled (const char *resource_path)
+{
+  const GtkCssCompiledHeader *header;
+  GBytes *source, *compiled, *result;
+  char *compiled_path;
+
+  if (gtk_keep_css_sections)
+    return NULL;
+
+  compiled_path = g_strconcat (resource_path, GTK_CSS_COMPILED_SUFFIX, NULL);
+  compiled = g_resources_lookup_data (compiled_path, 0, NULL);
+  g_free (compiled_path);
+  if (compiled == NULL)
+    return NULL;
+
+  source = g_resources_lookup_data (resource_path, 0, NULL);
+  if (source == NULL)
+    {
+      g_bytes_unref (compiled);
+      return NULL;
+    }
+
+  header = g_bytes_get_data (compiled, NULL);
+  if (g_bytes_get_size (compiled) < sizeof (GtkCssCompiledHeader) ||
+      memcmp (header->magic, GTK_CSS_COMPILED_MAGIC, sizeof (header->magic)) != 0 ||
+      GUINT32_FROM_LE (header->format_version) != GTK_CSS_COMPILED_VERSION ||
+      GUINT32_FROM_LE (header->gtk_version) != (GTK_MAJOR_VERSION << 16 | GTK_MINOR_VERSION) ||
+      GUINT32_FROM_LE (header->source_size) != g_bytes_get_size (source) ||
+      GUINT32_FROM_LE (header->source_hash) != gtk_css_compiled_hash (source))
+    {
+      result = NULL;
+    }
+  else
+    {
+      result = g_bytes_new_from_bytes (compiled,
+                                       sizeof (GtkCssCompiledHeader),
+                                       g_bytes_get_size (compiled) - sizeof (GtkCssCompiledHeader));
+    }
+
+  g_bytes_unref (source);
+  g_bytes_unref (compiled);
+
+  return result;
+}
+
 /**
  * gtk_css_provider_load_from_resource:
  * @css_provider: a `GtkCssProvider`
@@ -1176,6 +1309,10 @@ gtk_css_provider_load_from_path (GtkCssProvider  *css_provider,
  * Loads the data contained in the resource at @resource_path into
  * the @css_provider.
  *
+ * If the resource bundle contains an up-to-date compiled form of the
+ * style sheet at @resource_path with a `.compiled` suffix, as created
+ * by gtk4-css-tool, it is loaded instead of the style sheet.
+ *
  * This clears any previously loaded information.
  */
 void
@@ -1183,6 +1320,7 @@ gtk_css_provider_load_from_resource (GtkCssProvider *css_provider,
 			             const char     *resource_path)
 {
   GFile *file;
+  GBytes *compiled;
   char *uri, *escaped;
 
   g_return_if_fail (GTK_IS_CSS_PROVIDER (css_provider));
@@ -1196,7 +1334,17 @@ gtk_css_provider_load_from_resource (GtkCssProvider *css_provider,
   file = g_file_new_for_uri (uri);
   g_free (uri);
 
-  gtk_css_provider_load_from_file (css_provider, file);
+  compiled = gtk_css_provider_lookup_compiled (resource_path);
+  if (compiled)
+    {
+      gtk_css_provider_reset (css_provider);
+      gtk_css_provider_load_internal (css_provider, NULL, file, compiled);
+      gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
+    }
+  else
+    {
+      gtk_css_provider_load_from_file (css_provider, file);
+    }
 
   g_object_unref (file);
 }
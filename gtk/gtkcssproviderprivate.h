@@ -28,6 +28,9 @@ const char *_gtk_css_provider_get_theme_dir (GtkCssProvider *provider);
 
 void   gtk_css_provider_set_keep_css_sections (void);
 
+GBytes *gtk_css_provider_compile             (GtkCssProvider *provider,
+                                              GBytes         *source);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_PROVIDER_PRIVATE_H__ */
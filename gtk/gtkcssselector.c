@@ -124,8 +124,12 @@ struct _GtkCssSelectorTree
   gint32 previous_offset;
   gint32 sibling_offset;
   gint32 matches_offset; /* pointers that we return as matches if selector matches */
+  gint32 ancestor_hashes_offset; /* classes and bloom hashes that previous selectors need in ancestors */
 };
 
+/* The maximum number of ancestor hashes stored per tree node */
+#define GTK_CSS_SELECTOR_TREE_MAX_ANCESTOR_HASHES 4
+
 static gboolean
 gtk_css_selector_equal (const GtkCssSelector *a,
 			const GtkCssSelector *b)
@@ -150,6 +154,58 @@ gtk_css_selector_tree_get_matches (const GtkCssSelectorTree *tree)
   return (gpointer *) ((guint8 *)tree + tree->matches_offset);
 }
 
+/* The ancestor data is a class mask, see gtk_css_class_mask_bit(),
+ * followed by a 0-terminated array of bloom hashes.
+ */
+static inline const guint16 *
+gtk_css_selector_tree_get_ancestor_hashes (const GtkCssSelectorTree *tree)
+{
+  if (tree->ancestor_hashes_offset == GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET)
+    return NULL;
+
+  return (const guint16 *) ((guint8 *)tree + tree->ancestor_hashes_offset + sizeof (guint64));
+}
+
+static inline guint64
+gtk_css_selector_tree_get_ancestor_classes (const GtkCssSelectorTree *tree)
+{
+  guint64 classes;
+
+  if (tree->ancestor_hashes_offset == GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET)
+    return 0;
+
+  /* The data is only aligned to pointer size */
+  memcpy (&classes, (guint8 *)tree + tree->ancestor_hashes_offset, sizeof (guint64));
+
+  return classes;
+}
+
+/* Checks whether the ancestors in @filter can satisfy the selectors
+ * preceding the combinator @tree, without walking up the node tree.
+ */
+static inline gboolean
+gtk_css_selector_tree_may_match_ancestors (const GtkCssSelectorTree     *tree,
+                                           const GtkCountingBloomFilter *filter)
+{
+  const guint16 *hashes;
+  guint i;
+
+  if (filter == NULL)
+    return TRUE;
+
+  hashes = gtk_css_selector_tree_get_ancestor_hashes (tree);
+  if (hashes == NULL)
+    return TRUE;
+
+  for (i = 0; hashes[i] != 0; i++)
+    {
+      if (!gtk_counting_bloom_filter_may_contain (filter, hashes[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_css_selector_matches_insert_sorted (GtkCssSelectorMatches *matches,
                                         gpointer               data)
@@ -1823,7 +1879,8 @@ static GtkCssChange
 gtk_css_selector_tree_get_change (const GtkCssSelectorTree     *tree,
                                   const GtkCountingBloomFilter *filter,
 				  GtkCssNode                   *node,
-                                  gboolean                      skipping)
+                                  gboolean                      skipping,
+                                  guint64                      *ancestor_classes)
 {
   GtkCssChange change = 0;
   const GtkCssSelectorTree *prev;
@@ -1848,6 +1905,11 @@ gtk_css_selector_tree_get_change (const GtkCssSelectorTree     *tree,
           }
         break;
       case GTK_CSS_SELECTOR_CATEGORY_PARENT:
+        /* Collect the classes before the filter rejects anything, they
+         * are the ones that can make these rules match later. */
+        *ancestor_classes |= gtk_css_selector_tree_get_ancestor_classes (tree);
+        if (!gtk_css_selector_tree_may_match_ancestors (tree, filter))
+          return 0;
         skipping = FALSE;
         node = NULL;
         break;
@@ -1863,7 +1925,7 @@ gtk_css_selector_tree_get_change (const GtkCssSelectorTree     *tree,
   for (prev = gtk_css_selector_tree_get_previous (tree);
        prev != NULL;
        prev = gtk_css_selector_tree_get_sibling (prev))
-    change |= gtk_css_selector_tree_get_change (prev, filter, node, skipping);
+    change |= gtk_css_selector_tree_get_change (prev, filter, node, skipping, ancestor_classes);
 
   if (change || gtk_css_selector_tree_get_matches (tree))
     change = tree->selector.class->get_change (&tree->selector, change & ~GTK_CSS_CHANGE_GOT_MATCH) | GTK_CSS_CHANGE_GOT_MATCH;
@@ -1906,7 +1968,13 @@ gtk_css_selector_tree_match (const GtkCssSelectorTree      *tree,
   gtk_css_selector_tree_found_match (tree, results);
 
   if (filter && !gtk_css_selector_is_simple (&tree->selector))
-    match_filter = tree->selector.class->category == GTK_CSS_SELECTOR_CATEGORY_PARENT;
+    {
+      match_filter = tree->selector.class->category == GTK_CSS_SELECTOR_CATEGORY_PARENT;
+
+      /* None of the rules further down can match if an ancestor they need is missing */
+      if (match_filter && !gtk_css_selector_tree_may_match_ancestors (tree, filter))
+        return TRUE;
+    }
 
   for (prev = gtk_css_selector_tree_get_previous (tree);
        prev != NULL;
@@ -1949,13 +2017,14 @@ _gtk_css_selector_tree_is_empty (const GtkCssSelectorTree *tree)
 GtkCssChange
 gtk_css_selector_tree_get_change_all (const GtkCssSelectorTree     *tree,
                                       const GtkCountingBloomFilter *filter,
-				      GtkCssNode                   *node)
+				      GtkCssNode                   *node,
+                                      guint64                      *ancestor_classes)
 {
   GtkCssChange change = 0;
 
   for (; tree != NULL;
        tree = gtk_css_selector_tree_get_sibling (tree))
-    change |= gtk_css_selector_tree_get_change (tree, filter, node, FALSE);
+    change |= gtk_css_selector_tree_get_change (tree, filter, node, FALSE, ancestor_classes);
 
   /* Never return reserved bit set */
   return change & ~GTK_CSS_CHANGE_RESERVED_BIT;
@@ -2096,6 +2165,122 @@ alloc_tree (GByteArray *array, gint32 *offset)
   return get_tree (array, *offset);
 }
 
+/* Collects the hashes of the names, ids and classes that @selector and
+ * the selectors preceding it require to be present on ancestors, where
+ * @selector is preceded by a descendant or child combinator.
+ */
+static guint
+gtk_css_selectors_get_ancestor_hashes (const GtkCssSelector *selector,
+                                       guint16              *hashes,
+                                       guint                 max_hashes)
+{
+  gboolean is_ancestor = TRUE;
+  guint n_hashes = 0;
+
+  for (; selector && n_hashes < max_hashes; selector = gtk_css_selector_previous (selector))
+    {
+      switch (selector->class->category)
+        {
+        case GTK_CSS_SELECTOR_CATEGORY_SIMPLE:
+          break;
+        case GTK_CSS_SELECTOR_CATEGORY_SIMPLE_RADICAL:
+          if (is_ancestor)
+            {
+              guint16 hash = gtk_css_selector_hash_one (selector);
+
+              if (hash != 0)
+                hashes[n_hashes++] = hash;
+            }
+          break;
+        case GTK_CSS_SELECTOR_CATEGORY_PARENT:
+          is_ancestor = TRUE;
+          break;
+        case GTK_CSS_SELECTOR_CATEGORY_SIBLING:
+          is_ancestor = FALSE;
+          break;
+        default:
+          g_assert_not_reached ();
+          break;
+        }
+    }
+
+  return n_hashes;
+}
+
+/* Collects the classes that @selector and the selectors preceding it
+ * refer to, including negated ones and ones on siblings of ancestors.
+ */
+static guint64
+gtk_css_selectors_get_ancestor_classes (const GtkCssSelector *selector)
+{
+  guint64 classes = 0;
+
+  for (; selector; selector = gtk_css_selector_previous (selector))
+    {
+      if (selector->class == &GTK_CSS_SELECTOR_CLASS ||
+          selector->class == &GTK_CSS_SELECTOR_NOT_CLASS)
+        classes |= gtk_css_class_mask_bit (selector->style_class.style_class);
+    }
+
+  return classes;
+}
+
+/* Stores the classes that any of @infos refer to and the ancestor
+ * hashes that all of them have in common. Returns the offset of the
+ * data, padded to keep the following trees aligned.
+ */
+static gint32
+add_ancestor_hashes (GByteArray                 *array,
+                     GtkCssSelectorRuleSetInfo **infos,
+                     guint                       n_infos)
+{
+  guint16 common[4 * GTK_CSS_SELECTOR_TREE_MAX_ANCESTOR_HASHES];
+  guint16 hashes[4 * GTK_CSS_SELECTOR_TREE_MAX_ANCESTOR_HASHES];
+  guint n_common, n_hashes, n_kept, n_stored;
+  guint64 classes;
+  guint i, j, k;
+  gint32 offset;
+
+  classes = 0;
+  for (i = 0; i < n_infos; i++)
+    classes |= gtk_css_selectors_get_ancestor_classes (infos[i]->current_selector);
+
+  n_common = gtk_css_selectors_get_ancestor_hashes (infos[0]->current_selector,
+                                                    common, G_N_ELEMENTS (common));
+
+  for (i = 1; i < n_infos && n_common > 0; i++)
+    {
+      n_hashes = gtk_css_selectors_get_ancestor_hashes (infos[i]->current_selector,
+                                                        hashes, G_N_ELEMENTS (hashes));
+
+      for (j = 0, n_kept = 0; j < n_common; j++)
+        {
+          for (k = 0; k < n_hashes; k++)
+            {
+              if (hashes[k] == common[j])
+                {
+                  common[n_kept++] = common[j];
+                  break;
+                }
+            }
+        }
+      n_common = n_kept;
+    }
+
+  n_stored = MIN (n_common, GTK_CSS_SELECTOR_TREE_MAX_ANCESTOR_HASHES);
+
+  offset = array->len;
+  g_byte_array_append (array, (guint8 *) &classes, sizeof (guint64));
+  g_byte_array_append (array, (guint8 *) common, n_stored * sizeof (guint16));
+
+  /* 0-terminate and pad */
+  do
+    g_byte_array_append (array, (guint8 *) &(guint16) { 0 }, sizeof (guint16));
+  while (array->len % sizeof (gpointer) != 0);
+
+  return offset;
+}
+
 static gint32
 subdivide_infos (GByteArray                 *array,
                  GtkCssSelectorRuleSetInfo **infos,
@@ -2149,6 +2334,7 @@ subdivide_infos (GByteArray                 *array,
   tree = alloc_tree (array, &tree_offset);
   tree->parent_offset = parent_offset;
   tree->selector = max_selector;
+  tree->ancestor_hashes_offset = GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET;
 
   /* Allocate maximum for both of them */
   /* TODO: Potentially dangerous? */
@@ -2195,6 +2381,12 @@ subdivide_infos (GByteArray                 *array,
   gtk_css_selector_matches_clear (&exact_matches);
   get_tree (array, tree_offset)->matches_offset = res;
 
+  if (n_matched > 0 && max_selector.class->category == GTK_CSS_SELECTOR_CATEGORY_PARENT)
+    {
+      res = add_ancestor_hashes (array, matched_infos, n_matched);
+      get_tree (array, tree_offset)->ancestor_hashes_offset = res;
+    }
+
   res = subdivide_infos (array, matched_infos, n_matched, tree_offset);
   get_tree (array, tree_offset)->previous_offset = res;
 
@@ -2260,6 +2452,9 @@ fixup_offsets (GtkCssSelectorTree *tree, guint8 *data)
       if (tree->matches_offset != GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET)
 	tree->matches_offset -= ((guint8 *)tree - data);
 
+      if (tree->ancestor_hashes_offset != GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET)
+	tree->ancestor_hashes_offset -= ((guint8 *)tree - data);
+
       fixup_offsets ((GtkCssSelectorTree *)gtk_css_selector_tree_get_previous (tree), data);
 
       tree = (GtkCssSelectorTree *)gtk_css_selector_tree_get_sibling (tree);
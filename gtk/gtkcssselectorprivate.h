@@ -56,7 +56,8 @@ void         _gtk_css_selector_tree_match_all        (const GtkCssSelectorTree *
                                                       GtkCssSelectorMatches    *out_tree_rules);
 GtkCssChange gtk_css_selector_tree_get_change_all    (const GtkCssSelectorTree *tree,
                                                       const GtkCountingBloomFilter *filter,
-						      GtkCssNode               *node);
+						      GtkCssNode               *node,
+                                                      guint64                  *ancestor_classes);
 void         _gtk_css_selector_tree_match_print      (const GtkCssSelectorTree *tree,
 						      GString                  *str);
 gboolean     _gtk_css_selector_tree_is_empty         (const GtkCssSelectorTree *tree) G_GNUC_CONST;
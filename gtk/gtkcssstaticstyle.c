@@ -712,7 +712,7 @@ gtk_css_static_style_get_default (void)
       default_style = gtk_css_static_style_new_compute (GTK_STYLE_PROVIDER (settings),
                                                         &filter,
                                                         NULL,
-                                                        0);
+                                                        0, 0);
       g_object_set_data_full (G_OBJECT (settings), I_("gtk-default-style"),
                               default_style, clear_default_style);
     }
@@ -1000,37 +1000,73 @@ GtkCssStyle *
 gtk_css_static_style_new_compute (GtkStyleProvider             *provider,
                                   const GtkCountingBloomFilter *filter,
                                   GtkCssNode                   *node,
-                                  GtkCssChange                  change)
+                                  GtkCssChange                  change,
+                                  guint64                       ancestor_classes)
 {
-  GtkCssStaticStyle *result;
+  GtkCssStyle *result;
   GtkCssLookup lookup;
-  GtkCssNode *parent;
 
   _gtk_css_lookup_init (&lookup);
 
   if (node)
-    gtk_style_provider_lookup (provider,
-                               filter,
-                               node,
-                               &lookup,
-                               change == 0 ? &change : NULL);
+    {
+      gboolean compute_change = change == 0;
+
+      gtk_style_provider_lookup (provider,
+                                 filter,
+                                 node,
+                                 &lookup,
+                                 compute_change ? &change : NULL);
+
+      if (compute_change)
+        ancestor_classes = lookup.ancestor_classes;
+    }
+
+  result = gtk_css_static_style_new_from_lookup (provider, node, &lookup, change, ancestor_classes);
+
+  _gtk_css_lookup_destroy (&lookup);
+
+  return result;
+}
+
+/*<private>
+ * gtk_css_static_style_new_from_lookup:
+ * @provider: the provider the @lookup was done with
+ * @node: (nullable): the node the @lookup was done for
+ * @lookup: the matched values
+ * @change: the change the @lookup returned
+ * @ancestor_classes: the ancestor classes the @lookup returned
+ *
+ * Like gtk_css_static_style_new_compute(), but for a lookup that
+ * was already done. The lookup is not consumed.
+ *
+ * Returns: (transfer full): the new style
+ */
+GtkCssStyle *
+gtk_css_static_style_new_from_lookup (GtkStyleProvider *provider,
+                                      GtkCssNode       *node,
+                                      GtkCssLookup     *lookup,
+                                      GtkCssChange      change,
+                                      guint64           ancestor_classes)
+{
+  GtkCssStaticStyle *result;
+  GtkCssNode *parent;
 
   result = g_object_new (GTK_TYPE_CSS_STATIC_STYLE, NULL);
 
   result->change = change;
+  result->ancestor_classes = ancestor_classes;
 
   if (node)
     parent = gtk_css_node_get_parent (node);
   else
     parent = NULL;
 
-  gtk_css_lookup_resolve (&lookup,
+  gtk_css_lookup_resolve (lookup,
                           provider,
                           result,
                           parent ? gtk_css_node_get_style (parent) : NULL);
 
-  _gtk_css_lookup_destroy (&lookup);
-
   return GTK_CSS_STYLE (result);
 }
 
@@ -1108,3 +1144,19 @@ gtk_css_static_style_get_change (GtkCssStaticStyle *style)
 
   return style->change;
 }
+
+/*<private>
+ * gtk_css_static_style_get_ancestor_classes:
+ * @style: a `GtkCssStaticStyle`
+ *
+ * Returns the classes that rules which may apply to @style refer to on
+ * ancestors, as a mask of gtk_css_class_mask_bit(). Changes of other
+ * classes on ancestors cannot change @style.
+ *
+ * Returns: the ancestor classes of @style
+ */
+guint64
+gtk_css_static_style_get_ancestor_classes (GtkCssStaticStyle *style)
+{
+  return style->ancestor_classes;
+}
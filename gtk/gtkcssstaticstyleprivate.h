@@ -43,6 +43,7 @@ struct _GtkCssStaticStyle
   GPtrArray             *sections;             /* sections the values are defined in */
 
   GtkCssChange           change;               /* change as returned by value lookup */
+  guint64                ancestor_classes;     /* classes of ancestors that may change the style */
 };
 
 struct _GtkCssStaticStyleClass
@@ -56,8 +57,15 @@ GtkCssStyle *           gtk_css_static_style_get_default        (void);
 GtkCssStyle *           gtk_css_static_style_new_compute        (GtkStyleProvider               *provider,
                                                                  const GtkCountingBloomFilter   *filter,
                                                                  GtkCssNode                     *node,
-                                                                 GtkCssChange                    change);
+                                                                 GtkCssChange                    change,
+                                                                 guint64                         ancestor_classes);
+GtkCssStyle *           gtk_css_static_style_new_from_lookup    (GtkStyleProvider               *provider,
+                                                                 GtkCssNode                     *node,
+                                                                 struct _GtkCssLookup           *lookup,
+                                                                 GtkCssChange                    change,
+                                                                 guint64                         ancestor_classes);
 GtkCssChange            gtk_css_static_style_get_change         (GtkCssStaticStyle              *style);
+guint64                 gtk_css_static_style_get_ancestor_classes (GtkCssStaticStyle            *style);
 
 G_END_DECLS
 
@@ -0,0 +1,250 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkcssstatisticsprivate.h"
+
+#include "gdkprofilerprivate.h"
+
+/* Counters for the work done by the CSS machinery. They are always
+ * collected, as they are cheap, and reported per frame, both to the
+ * profiler and to the inspector.
+ *
+ * Lookups may run on worker threads, see gtk_css_node_validate(),
+ * so all counters are updated atomically.
+ */
+
+static const struct {
+  const char *profiler_name;
+  const char *description;
+} stat_names[GTK_CSS_N_STATS] = {
+  [GTK_CSS_STAT_INVALIDATED_NODES] = { "invalidated-nodes", "CSS Node Invalidations" },
+  [GTK_CSS_STAT_CREATED_STYLES] = { "created-styles", "CSS Style Creations" },
+  [GTK_CSS_STAT_CACHE_HITS] = { "css-cache-hits", "CSS Style Cache Hits" },
+  [GTK_CSS_STAT_LOOKUPS] = { "css-lookups", "CSS Selector Lookups" },
+  [GTK_CSS_STAT_MATCHED_RULES] = { "css-matched-rules", "CSS Matched Rules" },
+  [GTK_CSS_STAT_TRANSITIONS] = { "css-transitions", "CSS Transitions Started" },
+};
+
+static int frame_counts[GTK_CSS_N_STATS];
+static GtkCssFrameStatistics last_frame;
+static GtkCssFrameStatistics total;
+static guint profiler_counters[GTK_CSS_N_STATS];
+
+static gboolean record_selectors;
+static GHashTable *selector_matches;    /* GtkCssSelector => number of matches */
+static GMutex selector_mutex;
+
+void
+gtk_css_statistics_add (GtkCssStat stat,
+                        guint      n)
+{
+  g_atomic_int_add (&frame_counts[stat], n);
+}
+
+/*<private>
+ * gtk_css_statistics_end_frame:
+ * @duration: the time the validation took, in µs
+ *
+ * Called at the end of every validation of a CSS node tree to
+ * report the numbers collected since the last call.
+ */
+void
+gtk_css_statistics_end_frame (gint64 duration)
+{
+  guint i;
+
+  if (GDK_PROFILER_IS_RUNNING && profiler_counters[0] == 0)
+    {
+      for (i = 0; i < GTK_CSS_N_STATS; i++)
+        profiler_counters[i] = gdk_profiler_define_int_counter (stat_names[i].profiler_name,
+                                                                stat_names[i].description);
+    }
+
+  for (i = 0; i < GTK_CSS_N_STATS; i++)
+    {
+      last_frame.counts[i] = g_atomic_int_and (&frame_counts[i], 0);
+      total.counts[i] += last_frame.counts[i];
+
+      if (GDK_PROFILER_IS_RUNNING)
+        gdk_profiler_set_int_counter (profiler_counters[i], last_frame.counts[i]);
+    }
+
+  last_frame.duration = duration;
+  total.duration += duration;
+}
+
+/*<private>
+ * gtk_css_statistics_get_frame:
+ * @last_frame: (out) (optional): the numbers for the last validation
+ * @total: (out) (optional): the numbers since the program started
+ *
+ * Gets the collected statistics.
+ */
+void
+gtk_css_statistics_get_frame (GtkCssFrameStatistics *out_last_frame,
+                              GtkCssFrameStatistics *out_total)
+{
+  if (out_last_frame)
+    *out_last_frame = last_frame;
+  if (out_total)
+    *out_total = total;
+}
+
+/*<private>
+ * gtk_css_statistics_set_record_selectors:
+ * @record: %TRUE to count matches per selector
+ *
+ * Counting matches per selector is too expensive to do all the
+ * time, so it needs to be turned on explicitly. Turning it off
+ * drops the numbers collected so far.
+ */
+void
+gtk_css_statistics_set_record_selectors (gboolean record)
+{
+  g_mutex_lock (&selector_mutex);
+
+  record_selectors = record;
+
+  if (record && selector_matches == NULL)
+    selector_matches = g_hash_table_new (NULL, NULL);
+  else if (!record)
+    g_clear_pointer (&selector_matches, g_hash_table_unref);
+
+  g_mutex_unlock (&selector_mutex);
+}
+
+gboolean
+gtk_css_statistics_get_record_selectors (void)
+{
+  return record_selectors;
+}
+
+void
+gtk_css_statistics_add_selector_match (const GtkCssSelector *selector)
+{
+  gpointer matches;
+
+  g_mutex_lock (&selector_mutex);
+
+  if (selector_matches)
+    {
+      matches = g_hash_table_lookup (selector_matches, selector);
+      g_hash_table_insert (selector_matches,
+                           (gpointer) selector,
+                           GUINT_TO_POINTER (GPOINTER_TO_UINT (matches) + 1));
+    }
+
+  g_mutex_unlock (&selector_mutex);
+}
+
+/* Must be called before @selector is freed */
+void
+gtk_css_statistics_forget_selector (const GtkCssSelector *selector)
+{
+  if (!record_selectors)
+    return;
+
+  g_mutex_lock (&selector_mutex);
+
+  if (selector_matches)
+    g_hash_table_remove (selector_matches, selector);
+
+  g_mutex_unlock (&selector_mutex);
+}
+
+typedef struct {
+  const GtkCssSelector *selector;
+  guint matches;
+} SelectorMatches;
+
+static int
+compare_matches (gconstpointer a,
+                 gconstpointer b)
+{
+  const SelectorMatches *sa = a;
+  const SelectorMatches *sb = b;
+
+  if (sa->matches != sb->matches)
+    return sa->matches < sb->matches ? 1 : -1;
+
+  return 0;
+}
+
+static void
+clear_selector_statistics (gpointer data)
+{
+  GtkCssSelectorStatistics *stats = data;
+
+  g_free (stats->selector);
+}
+
+/*<private>
+ * gtk_css_statistics_get_selectors:
+ * @max_selectors: the maximum number of selectors to return
+ *
+ * Gets the selectors that matched most often since recording
+ * was turned on, most frequent first.
+ *
+ * Returns: (transfer full) (element-type GtkCssSelectorStatistics):
+ *   the selectors
+ */
+GArray *
+gtk_css_statistics_get_selectors (guint max_selectors)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  GArray *matches, *result;
+  guint i;
+
+  matches = g_array_new (FALSE, FALSE, sizeof (SelectorMatches));
+  result = g_array_new (FALSE, FALSE, sizeof (GtkCssSelectorStatistics));
+  g_array_set_clear_func (result, clear_selector_statistics);
+
+  g_mutex_lock (&selector_mutex);
+
+  if (selector_matches)
+    {
+      g_hash_table_iter_init (&iter, selector_matches);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          SelectorMatches m = { key, GPOINTER_TO_UINT (value) };
+
+          g_array_append_val (matches, m);
+        }
+    }
+
+  g_array_sort (matches, compare_matches);
+
+  /* Print while holding the lock, so the selectors can't go away */
+  for (i = 0; i < MIN (matches->len, max_selectors); i++)
+    {
+      SelectorMatches *m = &g_array_index (matches, SelectorMatches, i);
+      GtkCssSelectorStatistics stats;
+
+      stats.selector = _gtk_css_selector_to_string (m->selector);
+      stats.matches = m->matches;
+      g_array_append_val (result, stats);
+    }
+
+  g_mutex_unlock (&selector_mutex);
+
+  g_array_unref (matches);
+
+  return result;
+}
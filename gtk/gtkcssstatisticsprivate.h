@@ -0,0 +1,60 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_CSS_STATISTICS_PRIVATE_H__
+#define __GTK_CSS_STATISTICS_PRIVATE_H__
+
+#include "gtkcssselectorprivate.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+  GTK_CSS_STAT_INVALIDATED_NODES,
+  GTK_CSS_STAT_CREATED_STYLES,
+  GTK_CSS_STAT_CACHE_HITS,
+  GTK_CSS_STAT_LOOKUPS,
+  GTK_CSS_STAT_MATCHED_RULES,
+  GTK_CSS_STAT_TRANSITIONS,
+  /* < private > */
+  GTK_CSS_N_STATS
+} GtkCssStat;
+
+typedef struct {
+  guint  counts[GTK_CSS_N_STATS];
+  gint64 duration;                      /* time spent in validation, in µs */
+} GtkCssFrameStatistics;
+
+typedef struct {
+  char  *selector;
+  guint  matches;
+} GtkCssSelectorStatistics;
+
+void                    gtk_css_statistics_add                  (GtkCssStat                      stat,
+                                                                 guint                           n);
+void                    gtk_css_statistics_end_frame            (gint64                          duration);
+void                    gtk_css_statistics_get_frame            (GtkCssFrameStatistics          *last_frame,
+                                                                 GtkCssFrameStatistics          *total);
+
+void                    gtk_css_statistics_set_record_selectors (gboolean                        record);
+gboolean                gtk_css_statistics_get_record_selectors (void);
+void                    gtk_css_statistics_add_selector_match   (const GtkCssSelector           *selector);
+void                    gtk_css_statistics_forget_selector      (const GtkCssSelector           *selector);
+GArray *                gtk_css_statistics_get_selectors        (guint                           max_selectors);
+
+G_END_DECLS
+
+#endif /* __GTK_CSS_STATISTICS_PRIVATE_H__ */
@@ -514,6 +514,15 @@ _gtk_css_change_for_child (GtkCssChange match)
 #undef KEEP_STATES
 }
 
+/* Returns the bit for @style_class in a mask of classes. Like a bloom
+ * filter, different classes may share a bit.
+ */
+static inline guint64
+gtk_css_class_mask_bit (GQuark style_class)
+{
+  return G_GUINT64_CONSTANT (1) << (((guint32) style_class * 2654435761u) >> 26);
+}
+
 GtkCssDimension         gtk_css_unit_get_dimension               (GtkCssUnit         unit) G_GNUC_CONST;
 
 char *                  gtk_css_change_to_string                 (GtkCssChange       change) G_GNUC_MALLOC;
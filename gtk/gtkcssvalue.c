@@ -23,12 +23,20 @@
 #include "gtkcssstyleprivate.h"
 #include "gtkstyleproviderprivate.h"
 
+#include "gdk/gdkalloccountersprivate.h"
+
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
 };
 
 G_DEFINE_BOXED_TYPE (GtkCssValue, _gtk_css_value, _gtk_css_value_ref, _gtk_css_value_unref)
 
+/* Computed values of classes that implement hash(), keyed by themselves.
+ * The table does not hold a reference, values remove themselves when
+ * they are freed.
+ */
+static GHashTable *interned_values;
+
 #undef CSS_VALUE_ACCOUNTING
 
 #ifdef CSS_VALUE_ACCOUNTING
@@ -143,6 +151,7 @@ _gtk_css_value_alloc (const GtkCssValueClass *klass,
   GtkCssValue *value;
 
   value = g_slice_alloc0 (size);
+  gdk_alloc_counters_add (GDK_ALLOC_CSS_VALUES, size);
 
   value->class = klass;
   value->ref_count = 1;
@@ -189,9 +198,64 @@ gtk_css_value_unref (GtkCssValue *value)
   }
 #endif
 
+  if (value->class->hash && value->is_computed && interned_values &&
+      g_hash_table_lookup (interned_values, value) == value)
+    g_hash_table_remove (interned_values, value);
+
   value->class->free (value);
 }
 
+static gboolean
+gtk_css_value_equal_func (gconstpointer value1,
+                          gconstpointer value2)
+{
+  return _gtk_css_value_equal (value1, value2);
+}
+
+/**
+ * gtk_css_value_intern:
+ * @value: (transfer full): a value
+ *
+ * Returns a value equal to @value that is shared with all other equal
+ * values, so that equal computed values end up as the same pointer.
+ *
+ * Values are only interned if they are computed and their class
+ * implements hash(). Other values are returned as-is.
+ *
+ * Returns: (transfer full): the interned value
+ */
+GtkCssValue *
+gtk_css_value_intern (GtkCssValue *value)
+{
+  GtkCssValue *interned;
+
+  if (value->class->hash == NULL || !value->is_computed)
+    return value;
+
+  /* NaNs would never be found again to be removed */
+  if (!value->class->equal (value, value))
+    return value;
+
+  if (G_UNLIKELY (interned_values == NULL))
+    interned_values = g_hash_table_new ((GHashFunc) gtk_css_value_hash,
+                                        gtk_css_value_equal_func);
+
+  interned = g_hash_table_lookup (interned_values, value);
+  if (interned == value)
+    return value;
+
+  if (interned)
+    {
+      _gtk_css_value_ref (interned);
+      _gtk_css_value_unref (value);
+      return interned;
+    }
+
+  g_hash_table_add (interned_values, value);
+
+  return value;
+}
+
 /**
  * _gtk_css_value_compute:
  * @value: the value to compute from
@@ -221,7 +285,7 @@ _gtk_css_value_compute (GtkCssValue      *value,
   get_accounting_data (value->class->type_name)->computed++;
 #endif
 
-  return value->class->compute (value, property_id, provider, style, parent_style);
+  return gtk_css_value_intern (value->class->compute (value, property_id, provider, style, parent_style));
 }
 
 gboolean
@@ -254,6 +318,31 @@ _gtk_css_value_equal0 (const GtkCssValue *value1,
   return _gtk_css_value_equal (value1, value2);
 }
 
+/*<private>
+ * gtk_css_value_hash:
+ * @value: a value whose class implements hash()
+ *
+ * Returns: a hash value for @value, consistent with _gtk_css_value_equal()
+ */
+guint
+gtk_css_value_hash (const GtkCssValue *value)
+{
+  return GPOINTER_TO_UINT (value->class) ^ value->class->hash (value);
+}
+
+/* Hashes @d so that values that compare equal hash the same, in
+ * particular 0.0 and -0.0.
+ */
+guint
+gtk_css_value_hash_double (double d)
+{
+  union { double d; guint64 i; } u;
+
+  u.d = d == 0 ? 0 : d;
+
+  return (guint) (u.i ^ (u.i >> 32));
+}
+
 GtkCssValue *
 _gtk_css_value_transition (GtkCssValue *start,
                            GtkCssValue *end,
@@ -49,6 +49,13 @@
  * This means you do not need access to the `GtkDirectoryList`, but can access
  * the `GFile` directly from the `GFileInfo` when operating with a `GtkListView`
  * or similar.
+ *
+ * Some attributes, like thumbnails or content types, are expensive to query
+ * and often only needed for the files that are actually shown. Such attributes
+ * can be set as [property@Gtk.DirectoryList:lazy-attributes] instead. They are
+ * not queried during enumeration, but only when requested for a single file
+ * with [method@Gtk.DirectoryList.query_lazy_attributes], typically from the
+ * bind handler of a list item factory.
  */
 
 /* random number that everyone else seems to use, too */
@@ -60,6 +67,7 @@ enum {
   PROP_ERROR,
   PROP_FILE,
   PROP_IO_PRIORITY,
+  PROP_LAZY_ATTRIBUTES,
   PROP_LOADING,
   PROP_MONITORED,
   NUM_PROPERTIES
@@ -89,6 +97,7 @@ struct _GtkDirectoryList
   GObject parent_instance;
 
   char *attributes;
+  char *lazy_attributes;
   GFile *file;
   GFileMonitor *monitor;
   gboolean monitored;
@@ -97,9 +106,22 @@ struct _GtkDirectoryList
   GCancellable *cancellable;
   GError *error; /* Error while loading */
   GSequence *items; /* Use GPtrArray or GListStore here? */
+  GHashTable *items_by_file; /* GFile => GSequenceIter */
   GQueue events;
+  guint n_pending_appends; /* appended by events, not yet announced */
+
+  GCancellable *lazy_cancellable;
+};
+
+/* The state of the lazy attributes of an item */
+enum {
+  LAZY_NONE,
+  LAZY_PENDING,
+  LAZY_DONE
 };
 
+static GQuark lazy_quark;
+
 struct _GtkDirectoryListClass
 {
   GObjectClass parent_class;
@@ -168,6 +190,10 @@ gtk_directory_list_set_property (GObject      *object,
       gtk_directory_list_set_io_priority (self, g_value_get_int (value));
       break;
 
+    case PROP_LAZY_ATTRIBUTES:
+      gtk_directory_list_set_lazy_attributes (self, g_value_get_string (value));
+      break;
+
     case PROP_MONITORED:
       gtk_directory_list_set_monitored (self, g_value_get_boolean (value));
       break;
@@ -204,6 +230,10 @@ gtk_directory_list_get_property (GObject     *object,
       g_value_set_int (value, self->io_priority);
       break;
 
+    case PROP_LAZY_ATTRIBUTES:
+      g_value_set_string (value, self->lazy_attributes);
+      break;
+
     case PROP_LOADING:
       g_value_set_boolean (value, gtk_directory_list_is_loading (self));
       break;
@@ -251,10 +281,16 @@ gtk_directory_list_dispose (GObject *object)
   gtk_directory_list_stop_loading (self);
   gtk_directory_list_stop_monitoring (self);
 
+  if (self->lazy_cancellable)
+    g_cancellable_cancel (self->lazy_cancellable);
+  g_clear_object (&self->lazy_cancellable);
+
   g_clear_object (&self->file);
   g_clear_pointer (&self->attributes, g_free);
+  g_clear_pointer (&self->lazy_attributes, g_free);
 
   g_clear_error (&self->error);
+  g_clear_pointer (&self->items_by_file, g_hash_table_unref);
   g_clear_pointer (&self->items, g_sequence_free);
 
   g_queue_foreach (&self->events, (GFunc) free_queued_event, NULL);
@@ -320,6 +356,22 @@ gtk_directory_list_class_init (GtkDirectoryListClass *class)
                         -G_MAXINT, G_MAXINT, G_PRIORITY_DEFAULT,
                         GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkDirectoryList:lazy-attributes: (attributes org.gtk.Property.get=gtk_directory_list_get_lazy_attributes org.gtk.Property.set=gtk_directory_list_set_lazy_attributes)
+   *
+   * Attributes to query only when requested for a file.
+   *
+   * See [method@Gtk.DirectoryList.query_lazy_attributes].
+   *
+   * Since: 4.6
+   */
+  properties[PROP_LAZY_ATTRIBUTES] =
+      g_param_spec_string ("lazy-attributes",
+                           P_("Lazy attributes"),
+                           P_("Attributes to query only when requested"),
+                           NULL,
+                           GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkDirectoryList:loading: (attributes org.gtk.Property.get=gtk_directory_list_is_loading)
    *
@@ -345,12 +397,16 @@ gtk_directory_list_class_init (GtkDirectoryListClass *class)
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
+
+  lazy_quark = g_quark_from_static_string ("gtk-directory-list-lazy");
 }
 
 static void
 gtk_directory_list_init (GtkDirectoryList *self)
 {
   self->items = g_sequence_new (g_object_unref);
+  self->items_by_file = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                               g_object_unref, NULL);
   self->io_priority = G_PRIORITY_DEFAULT;
   self->monitored = TRUE;
   g_queue_init (&self->events);
@@ -385,9 +441,12 @@ gtk_directory_list_clear_items (GtkDirectoryList *self)
 {
   guint n_items;
 
+  self->n_pending_appends = 0;
+
   n_items = g_sequence_get_length (self->items);
   if (n_items > 0)
     {
+      g_hash_table_remove_all (self->items_by_file);
       g_sequence_remove_range (g_sequence_get_begin_iter (self->items),
                                g_sequence_get_end_iter (self->items));
 
@@ -401,6 +460,19 @@ gtk_directory_list_clear_items (GtkDirectoryList *self)
     }
 }
 
+static GSequenceIter *
+append_item (GtkDirectoryList *self,
+             GFile            *file,
+             GFileInfo        *info)
+{
+  GSequenceIter *iter;
+
+  iter = g_sequence_append (self->items, info);
+  g_hash_table_insert (self->items_by_file, g_object_ref (file), iter);
+
+  return iter;
+}
+
 static void
 gtk_directory_list_enumerator_closed_cb (GObject      *source,
                                          GAsyncResult *res,
@@ -460,8 +532,8 @@ gtk_directory_list_got_files_cb (GObject      *source,
       info = l->data;
       file = g_file_enumerator_get_child (enumerator, info);
       g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
+      append_item (self, file, info);
       g_object_unref (file);
-      g_sequence_append (self->items, info);
       n++;
     }
   g_list_free (files);
@@ -529,6 +601,10 @@ gtk_directory_list_start_loading (GtkDirectoryList *self)
       return;
     }
 
+  if (self->lazy_cancellable)
+    g_cancellable_cancel (self->lazy_cancellable);
+  g_clear_object (&self->lazy_cancellable);
+
   self->cancellable = g_cancellable_new ();
   g_file_enumerate_children_async (self->file,
                                    self->attributes,
@@ -543,23 +619,25 @@ gtk_directory_list_start_loading (GtkDirectoryList *self)
 }
 
 static GSequenceIter *
-find_file (GSequence *sequence,
-           GFile     *file)
+find_file (GtkDirectoryList *self,
+           GFile            *file)
 {
-  GSequenceIter *iter;
+  return g_hash_table_lookup (self->items_by_file, file);
+}
 
-  for (iter = g_sequence_get_begin_iter (sequence);
-       !g_sequence_iter_is_end (iter);
-       iter = g_sequence_iter_next (iter))
-    {
-      GFileInfo *item = G_FILE_INFO (g_sequence_get (iter));
-      GFile *f = G_FILE (g_file_info_get_attribute_object (item, "standard::file"));
+/* Appends from monitor events are collected and announced in one
+ * go, before any other change and once the queue has been handled.
+ */
+static void
+flush_pending_appends (GtkDirectoryList *self)
+{
+  guint n = self->n_pending_appends;
 
-      if (g_file_equal (f, file))
-        return iter;
-    }
+  if (n == 0)
+    return;
 
-  return NULL;
+  self->n_pending_appends = 0;
+  g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_get_length (self->items) - n, 0, n);
 }
 
 static gboolean
@@ -580,27 +658,29 @@ handle_event (QueuedEvent *event)
 
       g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
 
-      iter = find_file (self->items, file);
+      iter = find_file (self, file);
       if (iter)
         {
+          flush_pending_appends (self);
           position = g_sequence_iter_get_position (iter);
           g_sequence_set (iter, g_object_ref (info));
           g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
         }
       else
         {
-          position = g_sequence_get_length (self->items);
-          g_sequence_append (self->items, g_object_ref (info));
-          g_list_model_items_changed (G_LIST_MODEL (self), position, 0, 1);
+          append_item (self, file, g_object_ref (info));
+          self->n_pending_appends++;
         }
       break;
 
     case G_FILE_MONITOR_EVENT_MOVED_OUT:
     case G_FILE_MONITOR_EVENT_DELETED:
-      iter = find_file (self->items, file);
+      iter = find_file (self, file);
       if (iter)
         {
+          flush_pending_appends (self);
           position = g_sequence_iter_get_position (iter);
+          g_hash_table_remove (self->items_by_file, file);
           g_sequence_remove (iter);
           g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 0);
         }
@@ -612,9 +692,10 @@ handle_event (QueuedEvent *event)
 
       g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
 
-      iter = find_file (self->items, file);
+      iter = find_file (self, file);
       if (iter)
         {
+          flush_pending_appends (self);
           position = g_sequence_iter_get_position (iter);
           g_sequence_set (iter, g_object_ref (info));
           g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
@@ -637,15 +718,17 @@ handle_events (GtkDirectoryList *self)
     {
       event = g_queue_peek_tail (&self->events);
       if (!event)
-        return;
+        break;
 
       if (!handle_event (event))
-        return;
+        break;
 
       event = g_queue_pop_tail (&self->events);
       free_queued_event (event);
     }
   while (TRUE);
+
+  flush_pending_appends (self);
 }
 
 static void
@@ -873,6 +956,163 @@ gtk_directory_list_get_attributes (GtkDirectoryList *self)
   return self->attributes;
 }
 
+/**
+ * gtk_directory_list_set_lazy_attributes: (attributes org.gtk.Method.set_property=lazy-attributes)
+ * @self: a `GtkDirectoryList`
+ * @attributes: (nullable): the attributes to query on demand
+ *
+ * Sets the attributes that are only queried for files when
+ * requested with [method@Gtk.DirectoryList.query_lazy_attributes].
+ *
+ * Changing the lazy attributes does not restart the enumeration,
+ * but files have to be requested again to get the new attributes.
+ *
+ * Since: 4.6
+ */
+void
+gtk_directory_list_set_lazy_attributes (GtkDirectoryList *self,
+                                        const char       *attributes)
+{
+  GSequenceIter *iter;
+
+  g_return_if_fail (GTK_IS_DIRECTORY_LIST (self));
+
+  if (g_strcmp0 (self->lazy_attributes, attributes) == 0)
+    return;
+
+  g_free (self->lazy_attributes);
+  self->lazy_attributes = g_strdup (attributes);
+
+  if (self->lazy_cancellable)
+    g_cancellable_cancel (self->lazy_cancellable);
+  g_clear_object (&self->lazy_cancellable);
+
+  for (iter = g_sequence_get_begin_iter (self->items);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter))
+    g_object_set_qdata (g_sequence_get (iter), lazy_quark, GUINT_TO_POINTER (LAZY_NONE));
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LAZY_ATTRIBUTES]);
+}
+
+/**
+ * gtk_directory_list_get_lazy_attributes: (attributes org.gtk.Method.get_property=lazy-attributes)
+ * @self: a `GtkDirectoryList`
+ *
+ * Gets the attributes that are queried on demand.
+ *
+ * Returns: (nullable) (transfer none): The lazy attributes
+ *
+ * Since: 4.6
+ */
+const char *
+gtk_directory_list_get_lazy_attributes (GtkDirectoryList *self)
+{
+  g_return_val_if_fail (GTK_IS_DIRECTORY_LIST (self), NULL);
+
+  return self->lazy_attributes;
+}
+
+static void
+got_lazy_attributes_cb (GObject      *source,
+                        GAsyncResult *res,
+                        gpointer      data)
+{
+  GtkDirectoryList *self = data; /* invalid if cancelled */
+  GFile *file = G_FILE (source);
+  GFileInfo *lazy_info, *info;
+  GSequenceIter *iter;
+  GError *error = NULL;
+  char **attributes;
+  guint i;
+
+  lazy_info = g_file_query_info_finish (file, res, &error);
+  if (lazy_info == NULL)
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          g_clear_error (&error);
+          return;
+        }
+      g_clear_error (&error);
+    }
+
+  iter = find_file (self, file);
+  if (iter == NULL)
+    {
+      g_clear_object (&lazy_info);
+      return;
+    }
+
+  info = g_sequence_get (iter);
+  g_object_set_qdata (G_OBJECT (info), lazy_quark, GUINT_TO_POINTER (LAZY_DONE));
+
+  if (lazy_info == NULL)
+    return;
+
+  attributes = g_file_info_list_attributes (lazy_info, NULL);
+  for (i = 0; attributes[i]; i++)
+    {
+      GFileAttributeType type;
+      gpointer value;
+
+      if (g_file_info_get_attribute_data (lazy_info, attributes[i], &type, &value, NULL))
+        g_file_info_set_attribute (info, attributes[i], type, value);
+    }
+  g_strfreev (attributes);
+  g_object_unref (lazy_info);
+
+  flush_pending_appends (self);
+  g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_iter_get_position (iter), 1, 1);
+}
+
+/**
+ * gtk_directory_list_query_lazy_attributes:
+ * @self: a `GtkDirectoryList`
+ * @info: a `GFileInfo` from @self
+ *
+ * Starts querying the [property@Gtk.DirectoryList:lazy-attributes]
+ * for the file described by @info.
+ *
+ * When the query finishes, the attributes are added to @info and
+ * the item is reported as changed, so that widgets showing it are
+ * updated. Calling this function again for the same item does nothing,
+ * so it is fine to call it every time the item is bound to a widget.
+ *
+ * Since: 4.6
+ */
+void
+gtk_directory_list_query_lazy_attributes (GtkDirectoryList *self,
+                                          GFileInfo        *info)
+{
+  GFile *file;
+
+  g_return_if_fail (GTK_IS_DIRECTORY_LIST (self));
+  g_return_if_fail (G_IS_FILE_INFO (info));
+
+  if (self->lazy_attributes == NULL)
+    return;
+
+  if (GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (info), lazy_quark)) != LAZY_NONE)
+    return;
+
+  file = G_FILE (g_file_info_get_attribute_object (info, "standard::file"));
+  if (file == NULL || find_file (self, file) == NULL)
+    return;
+
+  if (self->lazy_cancellable == NULL)
+    self->lazy_cancellable = g_cancellable_new ();
+
+  g_object_set_qdata (G_OBJECT (info), lazy_quark, GUINT_TO_POINTER (LAZY_PENDING));
+  g_file_query_info_async (file,
+                           self->lazy_attributes,
+                           G_FILE_QUERY_INFO_NONE,
+                           self->io_priority,
+                           self->lazy_cancellable,
+                           got_lazy_attributes_cb,
+                           self);
+}
+
 /**
  * gtk_directory_list_set_io_priority: (attributes org.gtk.Method.set_property=io-priority)
  * @self: a `GtkDirectoryList`
@@ -30,6 +30,8 @@
 #include "gtksnapshot.h"
 #include "gtkwidgetprivate.h"
 
+#include "gdk/gdkmemorytexture.h"
+
 typedef struct _GtkDrawingAreaPrivate GtkDrawingAreaPrivate;
 
 struct _GtkDrawingAreaPrivate {
@@ -39,12 +41,19 @@ struct _GtkDrawingAreaPrivate {
   GtkDrawingAreaDrawFunc draw_func;
   gpointer draw_func_target;
   GDestroyNotify draw_func_target_destroy_notify;
+
+  /* retained mode */
+  cairo_surface_t *surface;
+  GdkTexture *texture;
+  cairo_region_t *dirty; /* in widget coordinates, NULL means everything */
+  guint retained : 1;
 };
 
 enum {
   PROP_0,
   PROP_CONTENT_WIDTH,
   PROP_CONTENT_HEIGHT,
+  PROP_RETAINED,
   LAST_PROP
 };
 
@@ -141,6 +150,17 @@ static guint signals[LAST_SIGNAL] = { 0, };
  *
  * If you need more complex control over your widget, you should consider
  * creating your own `GtkWidget` subclass.
+ *
+ * ## Retained drawing
+ *
+ * By default, the draw function is asked to draw the full contents of the
+ * drawing area every time it is redrawn. For contents that change only in
+ * small parts at a time, such as a canvas that is being painted on, this
+ * can be wasteful. Setting [property@Gtk.DrawingArea:retained] makes the
+ * drawing area keep its contents in a backing surface between frames.
+ * Changed parts are then marked with [method@Gtk.DrawingArea.queue_draw_area],
+ * and the draw function is called with the cairo context clipped to just
+ * those parts.
  */
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkDrawingArea, gtk_drawing_area, GTK_TYPE_WIDGET)
@@ -163,6 +183,10 @@ gtk_drawing_area_set_property (GObject      *gobject,
       gtk_drawing_area_set_content_height (self, g_value_get_int (value));
       break;
 
+    case PROP_RETAINED:
+      gtk_drawing_area_set_retained (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -187,11 +211,33 @@ gtk_drawing_area_get_property (GObject    *gobject,
       g_value_set_int (value, priv->content_height);
       break;
 
+    case PROP_RETAINED:
+      g_value_set_boolean (value, priv->retained);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
 }
 
+static void
+gtk_drawing_area_invalidate (GtkDrawingArea *self)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+
+  g_clear_pointer (&priv->dirty, cairo_region_destroy);
+}
+
+static void
+gtk_drawing_area_clear_backing (GtkDrawingArea *self)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+
+  g_clear_pointer (&priv->surface, cairo_surface_destroy);
+  g_clear_object (&priv->texture);
+  gtk_drawing_area_invalidate (self);
+}
+
 static void
 gtk_drawing_area_dispose (GObject *object)
 {
@@ -205,6 +251,8 @@ gtk_drawing_area_dispose (GObject *object)
   priv->draw_func_target = NULL;
   priv->draw_func_target_destroy_notify = NULL;
 
+  gtk_drawing_area_clear_backing (self);
+
   G_OBJECT_CLASS (gtk_drawing_area_parent_class)->dispose (object);
 }
 
@@ -239,6 +287,126 @@ gtk_drawing_area_size_allocate (GtkWidget *widget,
   g_signal_emit (widget, signals[RESIZE], 0, width, height);
 }
 
+static void
+gtk_drawing_area_unrealize (GtkWidget *widget)
+{
+  gtk_drawing_area_clear_backing (GTK_DRAWING_AREA (widget));
+
+  GTK_WIDGET_CLASS (gtk_drawing_area_parent_class)->unrealize (widget);
+}
+
+static void
+gtk_drawing_area_css_changed (GtkWidget         *widget,
+                              GtkCssStyleChange *change)
+{
+  GTK_WIDGET_CLASS (gtk_drawing_area_parent_class)->css_changed (widget, change);
+
+  /* The draw function is likely to use style information,
+   * so retained contents have to be redrawn as a whole.
+   */
+  gtk_drawing_area_invalidate (GTK_DRAWING_AREA (widget));
+}
+
+static cairo_region_t *
+scale_region (const cairo_region_t *region,
+              int                   scale)
+{
+  cairo_region_t *scaled;
+  cairo_rectangle_int_t rect;
+  int i;
+
+  scaled = cairo_region_create ();
+  for (i = 0; i < cairo_region_num_rectangles (region); i++)
+    {
+      cairo_region_get_rectangle (region, i, &rect);
+      rect.x *= scale;
+      rect.y *= scale;
+      rect.width *= scale;
+      rect.height *= scale;
+      cairo_region_union_rectangle (scaled, &rect);
+    }
+
+  return scaled;
+}
+
+static void
+gtk_drawing_area_snapshot_retained (GtkDrawingArea *self,
+                                    GtkSnapshot    *snapshot,
+                                    int             width,
+                                    int             height)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+  int scale;
+  cairo_region_t *update;
+  GdkTexture *texture;
+  GBytes *bytes;
+  cairo_t *cr;
+
+  scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+
+  if (priv->surface == NULL ||
+      cairo_image_surface_get_width (priv->surface) != width * scale ||
+      cairo_image_surface_get_height (priv->surface) != height * scale)
+    {
+      gtk_drawing_area_clear_backing (self);
+      priv->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                                  width * scale,
+                                                  height * scale);
+      cairo_surface_set_device_scale (priv->surface, scale, scale);
+    }
+
+  if (priv->dirty == NULL)
+    priv->dirty = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { 0, 0, width, height });
+  else
+    cairo_region_intersect_rectangle (priv->dirty, &(cairo_rectangle_int_t) { 0, 0, width, height });
+
+  if (!cairo_region_is_empty (priv->dirty) || priv->texture == NULL)
+    {
+      cr = cairo_create (priv->surface);
+      gdk_cairo_region (cr, priv->dirty);
+      cairo_clip (cr);
+
+      cairo_save (cr);
+      cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+      cairo_paint (cr);
+      cairo_restore (cr);
+
+      priv->draw_func (self,
+                       cr,
+                       width, height,
+                       priv->draw_func_target);
+      cairo_destroy (cr);
+
+      cairo_surface_flush (priv->surface);
+
+      /* The new texture tells the renderer which pixels changed
+       * relative to the previous one, so that unchanged parts of
+       * the drawing area are not considered damaged.
+       */
+      bytes = g_bytes_new (cairo_image_surface_get_data (priv->surface),
+                           cairo_image_surface_get_stride (priv->surface) * height * scale);
+      update = scale_region (priv->dirty, scale);
+      texture = gdk_memory_texture_new_with_update (width * scale, height * scale,
+                                                    GDK_MEMORY_DEFAULT,
+                                                    bytes,
+                                                    cairo_image_surface_get_stride (priv->surface),
+                                                    priv->texture,
+                                                    update);
+      cairo_region_destroy (update);
+      g_bytes_unref (bytes);
+
+      g_set_object (&priv->texture, texture);
+      g_object_unref (texture);
+    }
+
+  cairo_region_destroy (priv->dirty);
+  priv->dirty = cairo_region_create ();
+
+  gtk_snapshot_append_texture (snapshot,
+                               priv->texture,
+                               &GRAPHENE_RECT_INIT (0, 0, width, height));
+}
+
 static void
 gtk_drawing_area_snapshot (GtkWidget   *widget,
                            GtkSnapshot *snapshot)
@@ -254,6 +422,12 @@ gtk_drawing_area_snapshot (GtkWidget   *widget,
   width = gtk_widget_get_width (widget);
   height = gtk_widget_get_height (widget);
 
+  if (priv->retained)
+    {
+      if (width > 0 && height > 0)
+        gtk_drawing_area_snapshot_retained (self, snapshot, width, height);
+      return;
+    }
 
   cr = gtk_snapshot_append_cairo (snapshot,
                                   &GRAPHENE_RECT_INIT (
@@ -280,6 +454,8 @@ gtk_drawing_area_class_init (GtkDrawingAreaClass *class)
   widget_class->measure = gtk_drawing_area_measure;
   widget_class->size_allocate = gtk_drawing_area_size_allocate;
   widget_class->snapshot = gtk_drawing_area_snapshot;
+  widget_class->unrealize = gtk_drawing_area_unrealize;
+  widget_class->css_changed = gtk_drawing_area_css_changed;
 
   /**
    * GtkDrawingArea:content-width: (attributes org.gtk.Property.get=gtk_drawing_area_get_content_width org.gtk.Property.set=gtk_drawing_area_set_content_width)
@@ -305,6 +481,22 @@ gtk_drawing_area_class_init (GtkDrawingAreaClass *class)
                       0, G_MAXINT, 0,
                       GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkDrawingArea:retained: (attributes org.gtk.Property.get=gtk_drawing_area_get_retained org.gtk.Property.set=gtk_drawing_area_set_retained)
+   *
+   * Whether the contents are kept between redraws.
+   *
+   * See [method@Gtk.DrawingArea.set_retained].
+   *
+   * Since: 4.6
+   */
+  props[PROP_RETAINED] =
+    g_param_spec_boolean ("retained",
+                          P_("Retained"),
+                          P_("Whether the contents are kept between redraws"),
+                          FALSE,
+                          GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, LAST_PROP, props);
 
   /**
@@ -473,6 +665,8 @@ gtk_drawing_area_get_content_height (GtkDrawingArea *self)
  *
  * If what you are drawing does change, call [method@Gtk.Widget.queue_draw]
  * on the drawing area. This will cause a redraw and will call @draw_func again.
+ * For a retained drawing area, use [method@Gtk.DrawingArea.queue_draw_area]
+ * instead.
  */
 void
 gtk_drawing_area_set_draw_func (GtkDrawingArea         *self,
@@ -491,5 +685,98 @@ gtk_drawing_area_set_draw_func (GtkDrawingArea         *self,
   priv->draw_func_target = user_data;
   priv->draw_func_target_destroy_notify = destroy;
 
+  gtk_drawing_area_invalidate (self);
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+}
+
+/**
+ * gtk_drawing_area_set_retained: (attributes org.gtk.Method.set_property=retained)
+ * @self: a `GtkDrawingArea`
+ * @retained: %TRUE to keep the contents between redraws
+ *
+ * Sets whether the drawing area keeps its contents between redraws.
+ *
+ * A retained drawing area renders into a backing surface that is kept
+ * until the widget changes size or scale, its style changes, or it is
+ * unrealized. In-between, only the parts marked with
+ * [method@Gtk.DrawingArea.queue_draw_area] are cleared and redrawn,
+ * and the draw function is called with the cairo context clipped to
+ * them. Calling [method@Gtk.Widget.queue_draw] on its own does not
+ * cause any contents to be redrawn.
+ *
+ * Since: 4.6
+ */
+void
+gtk_drawing_area_set_retained (GtkDrawingArea *self,
+                               gboolean        retained)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+
+  g_return_if_fail (GTK_IS_DRAWING_AREA (self));
+
+  retained = !!retained;
+
+  if (priv->retained == retained)
+    return;
+
+  priv->retained = retained;
+
+  gtk_drawing_area_clear_backing (self);
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_RETAINED]);
+}
+
+/**
+ * gtk_drawing_area_get_retained: (attributes org.gtk.Method.get_property=retained)
+ * @self: a `GtkDrawingArea`
+ *
+ * Returns whether the drawing area keeps its contents between redraws.
+ *
+ * Returns: %TRUE if the drawing area is retained
+ *
+ * Since: 4.6
+ */
+gboolean
+gtk_drawing_area_get_retained (GtkDrawingArea *self)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+
+  g_return_val_if_fail (GTK_IS_DRAWING_AREA (self), FALSE);
+
+  return priv->retained;
+}
+
+/**
+ * gtk_drawing_area_queue_draw_area:
+ * @self: a `GtkDrawingArea`
+ * @x: x coordinate of the area to redraw
+ * @y: y coordinate of the area to redraw
+ * @width: width of the area to redraw
+ * @height: height of the area to redraw
+ *
+ * Marks an area of the drawing area as changed.
+ *
+ * For a retained drawing area, the area will be cleared and the draw
+ * function will be called with the cairo context clipped to all areas
+ * that were marked since the last redraw. For other drawing areas, this
+ * is equivalent to [method@Gtk.Widget.queue_draw].
+ *
+ * Since: 4.6
+ */
+void
+gtk_drawing_area_queue_draw_area (GtkDrawingArea *self,
+                                  int             x,
+                                  int             y,
+                                  int             width,
+                                  int             height)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+
+  g_return_if_fail (GTK_IS_DRAWING_AREA (self));
+  g_return_if_fail (width >= 0 && height >= 0);
+
+  if (priv->retained && priv->dirty != NULL)
+    cairo_region_union_rectangle (priv->dirty, &(cairo_rectangle_int_t) { x, y, width, height });
+
   gtk_widget_queue_draw (GTK_WIDGET (self));
 }
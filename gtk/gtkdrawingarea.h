@@ -105,6 +105,17 @@ void            gtk_drawing_area_set_draw_func          (GtkDrawingArea
                                                          GtkDrawingAreaDrawFunc  draw_func,
                                                          gpointer                user_data,
                                                          GDestroyNotify          destroy);
+GDK_AVAILABLE_IN_4_6
+void            gtk_drawing_area_set_retained           (GtkDrawingArea         *self,
+                                                         gboolean                retained);
+GDK_AVAILABLE_IN_4_6
+gboolean        gtk_drawing_area_get_retained           (GtkDrawingArea         *self);
+GDK_AVAILABLE_IN_4_6
+void            gtk_drawing_area_queue_draw_area        (GtkDrawingArea         *self,
+                                                         int                     x,
+                                                         int                     y,
+                                                         int                     width,
+                                                         int                     height);
 
 G_END_DECLS
 
@@ -205,6 +205,7 @@ gtk_drop_controller_motion_class_init (GtkDropControllerMotionClass *klass)
   object_class->get_property = gtk_drop_controller_motion_get_property;
 
   controller_class->handle_event = gtk_drop_controller_motion_handle_event;
+  controller_class->event_types = GTK_EVENT_TYPE_BIT (GDK_DRAG_MOTION);
   controller_class->handle_crossing = gtk_drop_controller_motion_handle_crossing;
 
   /**
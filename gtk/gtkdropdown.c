@@ -31,7 +31,7 @@
 #include "gtkprivate.h"
 #include "gtksingleselection.h"
 #include "gtkfilterlistmodel.h"
-#include "gtkstringfilter.h"
+#include "gtkcustomfilter.h"
 #include "gtkmultifilter.h"
 #include "gtkwidgetprivate.h"
 #include "gtknative.h"
@@ -102,6 +102,15 @@ struct _GtkDropDown
 
   GtkExpression *expression;
 
+  /* The search index is built on the first search and kept until the
+   * model, the expression or the string of an item change, so it is
+   * shared by all openings of the popup.
+   */
+  char *search;
+  GArray *search_index;
+  GHashTable *search_matches;
+  guint search_index_changed_id;
+
   guint enable_search : 1;
   guint show_arrow : 1;
 };
@@ -137,6 +146,9 @@ G_DEFINE_TYPE (GtkDropDown, gtk_drop_down, GTK_TYPE_WIDGET)
 static GParamSpec *properties[N_PROPS] = { NULL, };
 static guint signals[LAST_SIGNAL] = { 0 };
 
+static void gtk_drop_down_set_search (GtkDropDown *self,
+                                      const char  *text);
+
 static void
 button_toggled (GtkWidget *widget,
                 gpointer   data)
@@ -165,15 +177,12 @@ row_activated (GtkListView *listview,
                gpointer     data)
 {
   GtkDropDown *self = data;
-  GtkFilter *filter;
 
   gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (self->button), FALSE);
   gtk_popover_popdown (GTK_POPOVER (self->popup));
 
   /* reset the filter so positions are 1-1 */
-  filter = gtk_filter_list_model_get_filter (GTK_FILTER_LIST_MODEL (self->filter_model));
-  if (GTK_IS_STRING_FILTER (filter))
-    gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "");
+  gtk_drop_down_set_search (self, NULL);
   gtk_drop_down_set_selected (self, gtk_single_selection_get_selected (GTK_SINGLE_SELECTION (self->popup_selection)));
 }
 
@@ -185,7 +194,6 @@ selection_changed (GtkSingleSelection *selection,
   GtkDropDown *self = data;
   guint selected;
   gpointer item;
-  GtkFilter *filter;
 
   selected = gtk_single_selection_get_selected (GTK_SINGLE_SELECTION (self->selection));
   item = gtk_single_selection_get_selected_item (GTK_SINGLE_SELECTION (self->selection));
@@ -201,9 +209,7 @@ selection_changed (GtkSingleSelection *selection,
     }
 
   /* reset the filter so positions are 1-1 */
-  filter = gtk_filter_list_model_get_filter (GTK_FILTER_LIST_MODEL (self->filter_model));
-  if (GTK_IS_STRING_FILTER (filter))
-    gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "");
+  gtk_drop_down_set_search (self, NULL);
   gtk_single_selection_set_selected (GTK_SINGLE_SELECTION (self->popup_selection), selected);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SELECTED]);
@@ -216,18 +222,261 @@ gtk_drop_down_activate (GtkDropDown *self)
   gtk_widget_activate (self->button);
 }
 
+typedef struct {
+  char *prepared;
+  gpointer item;
+  GtkExpressionWatch *watch;
+} SearchIndexEntry;
+
+static void
+search_index_entry_clear (gpointer data)
+{
+  SearchIndexEntry *entry = data;
+
+  gtk_expression_watch_unwatch (entry->watch);
+  g_free (entry->prepared);
+  g_object_unref (entry->item);
+}
+
+static int
+search_index_entry_compare (gconstpointer a,
+                            gconstpointer b)
+{
+  const SearchIndexEntry *ea = a;
+  const SearchIndexEntry *eb = b;
+
+  return strcmp (ea->prepared, eb->prepared);
+}
+
+/* Matches the case-insensitive prefix search of GtkStringFilter */
+static char *
+prepare_search_string (const char *s)
+{
+  char *tmp;
+  char *result;
+
+  if (s == NULL || s[0] == '\0')
+    return NULL;
+
+  tmp = g_utf8_normalize (s, -1, G_NORMALIZE_ALL);
+  result = g_utf8_casefold (tmp, -1);
+  g_free (tmp);
+
+  return result;
+}
+
+static void
+clear_search_index (GtkDropDown *self)
+{
+  g_clear_handle_id (&self->search_index_changed_id, g_source_remove);
+  g_clear_pointer (&self->search_matches, g_hash_table_unref);
+  g_clear_pointer (&self->search_index, g_array_unref);
+}
+
+static gboolean
+search_index_changed_cb (gpointer data)
+{
+  GtkDropDown *self = data;
+  GtkFilter *filter;
+
+  self->search_index_changed_id = 0;
+
+  clear_search_index (self);
+
+  if (self->search == NULL || self->filter_model == NULL)
+    return G_SOURCE_REMOVE;
+
+  filter = gtk_filter_list_model_get_filter (GTK_FILTER_LIST_MODEL (self->filter_model));
+  if (GTK_IS_CUSTOM_FILTER (filter))
+    gtk_filter_changed (filter, GTK_FILTER_CHANGE_DIFFERENT);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+search_item_changed (gpointer data)
+{
+  GtkDropDown *self = data;
+
+  /* The watches can't be removed from their own notification,
+   * so drop the index from an idle.
+   */
+  if (self->search_index_changed_id == 0)
+    {
+      self->search_index_changed_id = g_idle_add (search_index_changed_cb, self);
+      gdk_source_set_static_name_by_id (self->search_index_changed_id, "[gtk] search_index_changed_cb");
+    }
+}
+
+static void
+build_search_index (GtkDropDown *self)
+{
+  guint i, n_items;
+
+  n_items = g_list_model_get_n_items (self->model);
+
+  self->search_index = g_array_sized_new (FALSE, FALSE, sizeof (SearchIndexEntry), n_items);
+  g_array_set_clear_func (self->search_index, search_index_entry_clear);
+
+  for (i = 0; i < n_items; i++)
+    {
+      GValue value = G_VALUE_INIT;
+      SearchIndexEntry entry;
+      gpointer item;
+
+      item = g_list_model_get_item (self->model, i);
+
+      if (!gtk_expression_evaluate (self->expression, item, &value))
+        {
+          g_object_unref (item);
+          continue;
+        }
+
+      entry.prepared = prepare_search_string (g_value_get_string (&value));
+      g_value_unset (&value);
+
+      if (entry.prepared == NULL)
+        {
+          g_object_unref (item);
+          continue;
+        }
+
+      entry.item = item;
+      entry.watch = gtk_expression_watch (self->expression, item, search_item_changed, self, NULL);
+      g_array_append_val (self->search_index, entry);
+    }
+
+  /* Strings with a common prefix sort next to each other */
+  g_array_sort (self->search_index, search_index_entry_compare);
+}
+
+static void
+build_search_matches (GtkDropDown *self)
+{
+  SearchIndexEntry *entries;
+  guint lo, hi, i;
+
+  if (self->search_index == NULL)
+    build_search_index (self);
+
+  self->search_matches = g_hash_table_new (NULL, NULL);
+
+  entries = (SearchIndexEntry *) self->search_index->data;
+
+  /* Find the first string that is not smaller than the search */
+  lo = 0;
+  hi = self->search_index->len;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (strcmp (entries[mid].prepared, self->search) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  for (i = lo; i < self->search_index->len; i++)
+    {
+      if (!g_str_has_prefix (entries[i].prepared, self->search))
+        break;
+
+      g_hash_table_add (self->search_matches, entries[i].item);
+    }
+}
+
+static gboolean
+search_filter_func (gpointer item,
+                    gpointer data)
+{
+  GtkDropDown *self = data;
+
+  if (self->search_matches == NULL)
+    build_search_matches (self);
+
+  return g_hash_table_contains (self->search_matches, item);
+}
+
+static void
+model_items_changed (GListModel  *model,
+                     guint        position,
+                     guint        removed,
+                     guint        added,
+                     GtkDropDown *self)
+{
+  /* This runs before the filter model sees the change, so
+   * it filters the new items against a fresh index.
+   */
+  clear_search_index (self);
+}
+
+static void
+gtk_drop_down_set_search (GtkDropDown *self,
+                          const char  *text)
+{
+  GtkFilter *filter;
+  GtkFilterChange change;
+  char *prepared;
+  char *old_search;
+
+  prepared = prepare_search_string (text);
+  if (g_strcmp0 (prepared, self->search) == 0)
+    {
+      g_free (prepared);
+      return;
+    }
+
+  old_search = self->search;
+  self->search = prepared;
+  g_clear_pointer (&self->search_matches, g_hash_table_unref);
+
+  if (self->filter_model == NULL)
+    {
+      g_free (old_search);
+      return;
+    }
+
+  filter = gtk_filter_list_model_get_filter (GTK_FILTER_LIST_MODEL (self->filter_model));
+  if (!GTK_IS_CUSTOM_FILTER (filter))
+    {
+      g_free (old_search);
+      return;
+    }
+
+  /* Without a search, the filter has no function and matches everything,
+   * which the filter model applies right away.
+   */
+  if (prepared == NULL)
+    gtk_custom_filter_set_filter_func (GTK_CUSTOM_FILTER (filter), NULL, NULL, NULL);
+  else if (old_search == NULL)
+    gtk_custom_filter_set_filter_func (GTK_CUSTOM_FILTER (filter), search_filter_func, self, NULL);
+  else
+    {
+      if (g_str_has_prefix (prepared, old_search))
+        change = GTK_FILTER_CHANGE_MORE_STRICT;
+      else if (g_str_has_prefix (old_search, prepared))
+        change = GTK_FILTER_CHANGE_LESS_STRICT;
+      else
+        change = GTK_FILTER_CHANGE_DIFFERENT;
+
+      gtk_filter_changed (filter, change);
+    }
+
+  g_free (old_search);
+}
+
 static void
 update_filter (GtkDropDown *self)
 {
+  g_clear_pointer (&self->search, g_free);
+  clear_search_index (self);
+
   if (self->filter_model)
     {
       GtkFilter *filter;
 
       if (self->expression)
-        {
-          filter = GTK_FILTER (gtk_string_filter_new (gtk_expression_ref (self->expression)));
-          gtk_string_filter_set_match_mode (GTK_STRING_FILTER (filter), GTK_STRING_FILTER_MATCH_MODE_PREFIX);
-        }
+        filter = GTK_FILTER (gtk_custom_filter_new (NULL, NULL, NULL));
       else
         filter = GTK_FILTER (gtk_every_filter_new ());
       gtk_filter_list_model_set_filter (GTK_FILTER_LIST_MODEL (self->filter_model), filter);
@@ -240,29 +489,21 @@ search_changed (GtkSearchEntry *entry, gpointer data)
 {
   GtkDropDown *self = data;
   const char *text;
-  GtkFilter *filter;
 
   text  = gtk_editable_get_text (GTK_EDITABLE (entry));
 
-  filter = gtk_filter_list_model_get_filter (GTK_FILTER_LIST_MODEL (self->filter_model));
-  if (GTK_IS_STRING_FILTER (filter))
-    gtk_string_filter_set_search (GTK_STRING_FILTER (filter), text);
+  gtk_drop_down_set_search (self, text);
 }
 
 static void
 search_stop (GtkSearchEntry *entry, gpointer data)
 {
   GtkDropDown *self = data;
-  GtkFilter *filter;
 
-  filter = gtk_filter_list_model_get_filter (GTK_FILTER_LIST_MODEL (self->filter_model));
-  if (GTK_IS_STRING_FILTER (filter))
-    {
-      if (gtk_string_filter_get_search (GTK_STRING_FILTER (filter)))
-        gtk_string_filter_set_search (GTK_STRING_FILTER (filter), NULL);
-      else
-        gtk_popover_popdown (GTK_POPOVER (self->popup));
-    }
+  if (self->search)
+    gtk_drop_down_set_search (self, NULL);
+  else
+    gtk_popover_popdown (GTK_POPOVER (self->popup));
 }
 
 static void
@@ -273,11 +514,15 @@ gtk_drop_down_dispose (GObject *object)
   g_clear_pointer (&self->popup, gtk_widget_unparent);
   g_clear_pointer (&self->button, gtk_widget_unparent);
 
+  if (self->model)
+    g_signal_handlers_disconnect_by_func (self->model, model_items_changed, self);
   g_clear_object (&self->model);
   if (self->selection)
     g_signal_handlers_disconnect_by_func (self->selection, selection_changed, self);
   g_clear_object (&self->filter_model);
   g_clear_pointer (&self->expression, gtk_expression_unref);
+  g_clear_pointer (&self->search, g_free);
+  clear_search_index (self);
   g_clear_object (&self->selection);
   g_clear_object (&self->popup_selection);
   g_clear_object (&self->factory);
@@ -799,9 +1044,14 @@ gtk_drop_down_set_model (GtkDropDown *self,
   g_return_if_fail (GTK_IS_DROP_DOWN (self));
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
 
-  if (!g_set_object (&self->model, model))
+  if (self->model == model)
     return;
 
+  if (self->model)
+    g_signal_handlers_disconnect_by_func (self->model, model_items_changed, self);
+
+  g_set_object (&self->model, model);
+
   if (model == NULL)
     {
       gtk_list_view_set_model (GTK_LIST_VIEW (self->popup_list), NULL);
@@ -812,13 +1062,24 @@ gtk_drop_down_set_model (GtkDropDown *self,
       g_clear_object (&self->selection);
       g_clear_object (&self->filter_model);
       g_clear_object (&self->popup_selection);
+
+      g_clear_pointer (&self->search, g_free);
+      clear_search_index (self);
     }
   else
     {
       GListModel *filter_model;
       GtkSelectionModel *selection;
 
+      /* Connect before the filter model does, see model_items_changed() */
+      g_signal_connect (model, "items-changed", G_CALLBACK (model_items_changed), self);
+
       filter_model = G_LIST_MODEL (gtk_filter_list_model_new (g_object_ref (model), NULL));
+      /* Keep typing in the search entry responsive for large models.
+       * Without a search, the filter matches everything and there is
+       * no filtering to do, so positions stay the same as in @model.
+       */
+      gtk_filter_list_model_set_incremental (GTK_FILTER_LIST_MODEL (filter_model), TRUE);
       g_set_object (&self->filter_model, filter_model);
 
       update_filter (self);
@@ -32,6 +32,7 @@
 #include "gtkmarshalers.h"
 #include "gtknative.h"
 #include "gtkprivate.h"
+#include "gtkprogressinputstreamprivate.h"
 #include "gtktypebuiltins.h"
 
 
@@ -102,6 +103,12 @@
  * over an ongoing drop, the [class@Gtk.DropTargetAsync] object gives you
  * this ability.
  *
+ * Big transfers can take a while. The [property@Gtk.DropTarget:bytes-received]
+ * property is updated while the data is loading and can be used to show
+ * progress. To process the data in chunks as it arrives, use
+ * [class@Gtk.DropTargetAsync] and read the stream returned by
+ * [method@Gdk.Drop.read_async].
+ *
  * While a pointer is dragged over the drop target's widget and the drop
  * has not been rejected, that widget will receive the
  * %GTK_STATE_FLAG_DROP_ACTIVE state, which can be used to style the widget.
@@ -123,6 +130,9 @@ struct _GtkDropTarget
   graphene_point_t coords;
   GdkDrop *drop;
   GCancellable *cancellable; /* NULL unless doing a read of value */
+  GType load_type;
+  guint64 bytes_received;
+  guint64 bytes_notified;
   GValue value;
 };
 
@@ -154,6 +164,7 @@ enum {
   PROP_FORMATS,
   PROP_PRELOAD,
   PROP_VALUE,
+  PROP_BYTES_RECEIVED,
   NUM_PROPERTIES
 };
 
@@ -202,6 +213,13 @@ gtk_drop_target_end_drop (GtkDropTarget *self)
       g_clear_object (&self->cancellable);
     }
 
+  if (self->bytes_received != 0)
+    {
+      self->bytes_received = 0;
+      self->bytes_notified = 0;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BYTES_RECEIVED]);
+    }
+
   gtk_widget_unset_state_flags (gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (self)),
                                 GTK_STATE_FLAG_DROP_ACTIVE);
 
@@ -228,40 +246,129 @@ gtk_drop_target_do_drop (GtkDropTarget *self)
   gtk_drop_target_end_drop (self);
 }
 
+static void
+gtk_drop_target_load_failed (GtkDropTarget *self,
+                             GError        *error)
+{
+  g_clear_object (&self->cancellable);
+  /* XXX: Should this be a warning? */
+  g_warning ("Failed to receive drop data: %s", error->message);
+  g_error_free (error);
+  gtk_drop_target_end_drop (self);
+}
+
 static void
 gtk_drop_target_load_done (GObject      *source,
                            GAsyncResult *res,
                            gpointer      data)
 {
   GtkDropTarget *self = data;
-  const GValue *value;
+  GValue value = G_VALUE_INIT;
   GError *error = NULL;
 
-  value = gdk_drop_read_value_finish (GDK_DROP (source), res, &error);
-  if (value == NULL)
+  g_value_init (&value, self->load_type);
+  if (!gdk_content_deserialize_finish (res, &value, &error))
     {
-      /* If this happens, data/self is invalid */
+      g_value_unset (&value);
+
+      /* The drop was ended while loading */
       if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        {
-          g_clear_error (&error);
-          return;
-        }
+        g_clear_error (&error);
+      else
+        gtk_drop_target_load_failed (self, error);
 
-      g_clear_object (&self->cancellable);
-      /* XXX: Should this be a warning? */
-      g_warning ("Failed to receive drop data: %s", error->message);
-      g_clear_error (&error);
-      gtk_drop_target_end_drop (self);
+      g_object_unref (self);
       return;
     }
 
   g_clear_object (&self->cancellable);
-  g_value_init (&self->value, G_VALUE_TYPE (value));
-  g_value_copy (value, &self->value);
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  self->value = value;
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_VALUE]);
 
+  if (self->bytes_notified != self->bytes_received)
+    {
+      self->bytes_notified = self->bytes_received;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BYTES_RECEIVED]);
+    }
+
+  g_object_thaw_notify (G_OBJECT (self));
+
   if (self->dropping)
     gtk_drop_target_do_drop (self);
+
+  g_object_unref (self);
+}
+
+/* Notifying for every chunk would be a lot of signal
+ * emissions for big transfers
+ */
+#define BYTES_RECEIVED_NOTIFY_STEP (64 * 1024)
+
+static void
+gtk_drop_target_load_progress (guint64  bytes_read,
+                               gpointer data)
+{
+  GtkDropTarget *self = data;
+
+  /* The drop was ended while loading */
+  if (self->cancellable == NULL)
+    return;
+
+  self->bytes_received = bytes_read;
+  if (self->bytes_received - self->bytes_notified >= BYTES_RECEIVED_NOTIFY_STEP)
+    {
+      self->bytes_notified = self->bytes_received;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BYTES_RECEIVED]);
+    }
+}
+
+static void
+gtk_drop_target_load_got_stream (GObject      *source,
+                                 GAsyncResult *res,
+                                 gpointer      data)
+{
+  GtkDropTarget *self = data;
+  GInputStream *stream, *progress;
+  const char *mime_type;
+  GError *error = NULL;
+
+  stream = gdk_drop_read_finish (GDK_DROP (source), res, &mime_type, &error);
+  if (stream == NULL)
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_clear_error (&error);
+      else
+        gtk_drop_target_load_failed (self, error);
+
+      g_object_unref (self);
+      return;
+    }
+
+  /* The drop was ended before the stream arrived */
+  if (self->cancellable == NULL)
+    {
+      g_object_unref (stream);
+      g_object_unref (self);
+      return;
+    }
+
+  progress = gtk_progress_input_stream_new (stream,
+                                            gtk_drop_target_load_progress,
+                                            g_object_ref (self),
+                                            g_object_unref);
+  g_object_unref (stream);
+
+  gdk_content_deserialize_async (progress,
+                                 mime_type,
+                                 self->load_type,
+                                 G_PRIORITY_DEFAULT,
+                                 self->cancellable,
+                                 gtk_drop_target_load_done,
+                                 self);
+  g_object_unref (progress);
 }
 
 static gboolean
@@ -287,6 +394,8 @@ gtk_drop_target_load_local (GtkDropTarget *self,
 static gboolean
 gtk_drop_target_load (GtkDropTarget *self)
 {
+  GdkContentFormatsBuilder *builder;
+  GdkContentFormats *formats;
   GType type;
 
   g_assert (self->drop);
@@ -303,13 +412,25 @@ gtk_drop_target_load (GtkDropTarget *self)
     return TRUE;
 
   self->cancellable = g_cancellable_new ();
+  self->load_type = type;
+
+  /* Read the stream ourselves instead of using
+   * gdk_drop_read_value_async(), so we can report progress
+   */
+  builder = gdk_content_formats_builder_new ();
+  gdk_content_formats_builder_add_gtype (builder, type);
+  formats = gdk_content_formats_builder_free_to_formats (builder);
+  formats = gdk_content_formats_union_deserialize_mime_types (formats);
+
+  gdk_drop_read_async (self->drop,
+                       gdk_content_formats_get_mime_types (formats, NULL),
+                       G_PRIORITY_DEFAULT,
+                       self->cancellable,
+                       gtk_drop_target_load_got_stream,
+                       g_object_ref (self));
+
+  gdk_content_formats_unref (formats);
 
-  gdk_drop_read_value_async (self->drop,
-                             type,
-                             G_PRIORITY_DEFAULT,
-                             self->cancellable,
-                             gtk_drop_target_load_done,
-                             g_object_ref (self));
   return FALSE;
 }
 
@@ -594,6 +715,10 @@ gtk_drop_target_get_property (GObject    *object,
         g_value_set_boxed (value, NULL);
       break;
 
+    case PROP_BYTES_RECEIVED:
+      g_value_set_uint64 (value, self->bytes_received);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -611,6 +736,10 @@ gtk_drop_target_class_init (GtkDropTargetClass *class)
 
   controller_class->handle_event = gtk_drop_target_handle_event;
   controller_class->filter_event = gtk_drop_target_filter_event;
+  controller_class->event_types = GTK_EVENT_TYPE_BIT (GDK_DRAG_ENTER) |
+                                  GTK_EVENT_TYPE_BIT (GDK_DRAG_LEAVE) |
+                                  GTK_EVENT_TYPE_BIT (GDK_DRAG_MOTION) |
+                                  GTK_EVENT_TYPE_BIT (GDK_DROP_START);
   controller_class->handle_crossing = gtk_drop_target_handle_crossing;
 
   class->accept = gtk_drop_target_accept;
@@ -719,6 +848,24 @@ gtk_drop_target_class_init (GtkDropTargetClass *class)
                            G_TYPE_VALUE,
                            GTK_PARAM_READABLE);
 
+  /**
+   * GtkDropTarget:bytes-received: (attributes org.gtk.Property.get=gtk_drop_target_get_bytes_received)
+   *
+   * The number of bytes of drop data that have been received so far.
+   *
+   * This is updated while the data is loading, so it can be used to
+   * show progress for big transfers. The total size is usually not
+   * known in advance.
+   *
+   * Since: 4.6
+   */
+  properties[PROP_BYTES_RECEIVED] =
+       g_param_spec_uint64 ("bytes-received",
+                            P_("Bytes received"),
+                            P_("The amount of drop data received so far"),
+                            0, G_MAXUINT64, 0,
+                            GTK_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, NUM_PROPERTIES, properties);
 
  /**
@@ -1092,6 +1239,25 @@ gtk_drop_target_get_value (GtkDropTarget *self)
   return &self->value;
 }
 
+/**
+ * gtk_drop_target_get_bytes_received: (attributes org.gtk.Method.get_property=bytes-received)
+ * @self: a `GtkDropTarget`
+ *
+ * Gets the number of bytes of drop data that have been received
+ * so far.
+ *
+ * Returns: the number of bytes received
+ *
+ * Since: 4.6
+ */
+guint64
+gtk_drop_target_get_bytes_received (GtkDropTarget *self)
+{
+  g_return_val_if_fail (GTK_IS_DROP_TARGET (self), 0);
+
+  return self->bytes_received;
+}
+
 /**
  * gtk_drop_target_reject:
  * @self: a `GtkDropTarget`
@@ -80,6 +80,10 @@ GdkDrop *               gtk_drop_target_get_current_drop (GtkDropTarget
 GDK_AVAILABLE_IN_ALL
 const GValue *          gtk_drop_target_get_value        (GtkDropTarget         *self);
 
+GDK_AVAILABLE_IN_4_6
+guint64                 gtk_drop_target_get_bytes_received
+                                                         (GtkDropTarget         *self);
+
 GDK_AVAILABLE_IN_ALL
 void                    gtk_drop_target_reject           (GtkDropTarget         *self);
 
@@ -218,6 +218,8 @@ struct _GtkEmojiChooser
   GtkWidget *box;
   GVariantIter *iter;
   guint populate_idle;
+  EmojiSection *scroll_section;
+  guint scroll_tick;
 
   GSettings *settings;
 };
@@ -243,12 +245,43 @@ gtk_emoji_chooser_finalize (GObject *object)
   if (chooser->populate_idle)
     g_source_remove (chooser->populate_idle);
 
+  if (chooser->iter)
+    g_variant_iter_free (chooser->iter);
+
   g_clear_pointer (&chooser->data, g_variant_unref);
   g_clear_object (&chooser->settings);
 
   G_OBJECT_CLASS (gtk_emoji_chooser_parent_class)->finalize (object);
 }
 
+static gboolean populate_emoji_chooser_until (GtkEmojiChooser *chooser,
+                                              EmojiSection    *section,
+                                              gint64           deadline);
+
+static gboolean
+scroll_to_section_tick (GtkWidget     *widget,
+                        GdkFrameClock *frame_clock,
+                        gpointer       data)
+{
+  GtkEmojiChooser *chooser = GTK_EMOJI_CHOOSER (widget);
+  GtkAdjustment *adj;
+  GtkAllocation alloc = { 0, 0, 0, 0 };
+
+  /* Wait for the sections that were just populated to be allocated */
+  if (gtk_widget_needs_allocate (chooser->scrolled_window))
+    return G_SOURCE_CONTINUE;
+
+  adj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (chooser->scrolled_window));
+  if (chooser->scroll_section->heading)
+    gtk_widget_get_allocation (chooser->scroll_section->heading, &alloc);
+  gtk_adjustment_animate_to_value (adj, alloc.y - BOX_SPACE);
+
+  chooser->scroll_section = NULL;
+  chooser->scroll_tick = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 scroll_to_section (EmojiSection *section)
 {
@@ -258,6 +291,23 @@ scroll_to_section (EmojiSection *section)
 
   chooser = GTK_EMOJI_CHOOSER (gtk_widget_get_ancestor (section->box, GTK_TYPE_EMOJI_CHOOSER));
 
+  /* Sections are filled in the background, in order. If the one we
+   * want to go to isn't there yet, fill everything up to it now and
+   * scroll once it has been laid out.
+   */
+  if (chooser->populate_idle != 0 && section != &chooser->recent)
+    {
+      if (populate_emoji_chooser_until (chooser, section, G_MAXINT64))
+        g_clear_handle_id (&chooser->populate_idle, g_source_remove);
+
+      chooser->scroll_section = section;
+      if (chooser->scroll_tick == 0)
+        chooser->scroll_tick = gtk_widget_add_tick_callback (GTK_WIDGET (chooser),
+                                                             scroll_to_section_tick,
+                                                             NULL, NULL);
+      return;
+    }
+
   adj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (chooser->scrolled_window));
   if (section->heading)
     gtk_widget_get_allocation (section->heading, &alloc);
@@ -690,25 +740,40 @@ get_emoji_data (void)
   return bytes;
 }
 
-static gboolean
-populate_emoji_chooser (gpointer data)
+/* Emoji data is loaded once and shared between all choosers
+ * and completion popups.
+ */
+GVariant *
+get_emoji_variant (void)
 {
-  GtkEmojiChooser *chooser = data;
-  GVariant *item;
-  gint64 start, now;
+  static GVariant *data = NULL;
 
-  start = g_get_monotonic_time ();
-
-  if (!chooser->data)
+  if (data == NULL)
     {
       GBytes *bytes;
 
       bytes = get_emoji_data ();
-
-      chooser->data = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("a(ausasu)"), bytes, TRUE));
+      data = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("a(ausasu)"), bytes, TRUE));
       g_bytes_unref (bytes);
     }
 
+  return g_variant_ref (data);
+}
+
+/* Adds emoji until @deadline has passed, or all of @section has been
+ * added if @section is not %NULL. Returns %TRUE when there are no
+ * more emoji to add.
+ */
+static gboolean
+populate_emoji_chooser_until (GtkEmojiChooser *chooser,
+                              EmojiSection    *section,
+                              gint64           deadline)
+{
+  GVariant *item;
+
+  if (!chooser->data)
+    chooser->data = get_emoji_variant ();
+
   if (!chooser->iter)
     {
       chooser->iter = g_variant_iter_new (chooser->data);
@@ -743,17 +808,38 @@ populate_emoji_chooser (gpointer data)
       add_emoji (chooser->box, FALSE, item, 0, chooser);
       g_variant_unref (item);
 
-      now = g_get_monotonic_time ();
-      if (now > start + 200) /* 2 ms */
-        {
-          gdk_profiler_add_mark (start * 1000, (now - start) * 1000, "emojichooser", "populate");
-          return G_SOURCE_CONTINUE;
-        }
+      /* The data is sorted by group, so once we see an emoji
+       * past the section, the section is complete.
+       */
+      if (section != NULL && (int) group > section->group)
+        return FALSE;
+
+      if (g_get_monotonic_time () > deadline)
+        return FALSE;
     }
 
   g_variant_iter_free (chooser->iter);
   chooser->iter = NULL;
   chooser->box = NULL;
+
+  return TRUE;
+}
+
+static gboolean
+populate_emoji_chooser (gpointer data)
+{
+  GtkEmojiChooser *chooser = data;
+  gint64 start, now;
+
+  start = g_get_monotonic_time ();
+
+  if (!populate_emoji_chooser_until (chooser, NULL, start + 200)) /* 2 ms */
+    {
+      now = g_get_monotonic_time ();
+      gdk_profiler_add_mark (start * 1000, (now - start) * 1000, "emojichooser", "populate");
+      return G_SOURCE_CONTINUE;
+    }
+
   chooser->populate_idle = 0;
 
   gdk_profiler_end_mark (start, "emojichooser", "populate (finish)");
@@ -866,16 +952,25 @@ filter_func (GtkFlowBoxChild *child,
     goto out;
 
   term_tokens = g_str_tokenize_and_fold (text, "en", NULL);
-  
-  g_variant_get_child (emoji_data, 1, "&s", &name);
-  name_tokens = g_str_tokenize_and_fold (name, "en", NULL);
+
+  /* Tokenizing the name is the expensive part of matching,
+   * so only do it once per emoji.
+   */
+  name_tokens = g_object_get_data (G_OBJECT (child), "name-tokens");
+  if (!name_tokens)
+    {
+      g_variant_get_child (emoji_data, 1, "&s", &name);
+      name_tokens = g_str_tokenize_and_fold (name, "en", NULL);
+      g_object_set_data_full (G_OBJECT (child), "name-tokens",
+                              name_tokens, (GDestroyNotify) g_strfreev);
+    }
   g_variant_get_child (emoji_data, 2, "^a&s", &keywords);
 
   res = match_tokens ((const char **)term_tokens, (const char **)name_tokens) ||
         match_tokens ((const char **)term_tokens, keywords);
 
   g_strfreev (term_tokens);
-  g_strfreev (name_tokens);
+  g_free (keywords);
 
 out:
   if (res)
@@ -1014,9 +1109,6 @@ gtk_emoji_chooser_init (GtkEmojiChooser *chooser)
   setup_section (chooser, &chooser->flags, 9, "emoji-flags-symbolic");
 
   populate_recent_section (chooser);
-
-  chooser->populate_idle = g_idle_add (populate_emoji_chooser, chooser);
-  gdk_source_set_static_name_by_id (chooser->populate_idle, "[gtk] populate_emoji_chooser");
 }
 
 static void
@@ -1193,6 +1285,15 @@ gtk_emoji_chooser_map (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_emoji_chooser_parent_class)->map (widget);
 
+  /* Choosers are often created long before they are shown, if ever,
+   * so don't spend time on the emoji sections until then.
+   */
+  if (chooser->data == NULL && chooser->populate_idle == 0)
+    {
+      chooser->populate_idle = g_idle_add (populate_emoji_chooser, chooser);
+      gdk_source_set_static_name_by_id (chooser->populate_idle, "[gtk] populate_emoji_chooser");
+    }
+
   gtk_widget_grab_focus (chooser->search_entry);
 }
 
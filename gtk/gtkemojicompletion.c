@@ -65,6 +65,11 @@ static int populate_completion (GtkEmojiCompletion *completion,
 
 #define MAX_ROWS 5
 
+typedef struct {
+  const char *name;
+  guint position;
+} EmojiName;
+
 G_DEFINE_TYPE (GtkEmojiCompletion, gtk_emoji_completion, GTK_TYPE_POPOVER)
 
 static void
@@ -544,6 +549,64 @@ add_emoji (GtkWidget          *list,
   gtk_list_box_insert (GTK_LIST_BOX (list), child, -1);
 }
 
+static int
+compare_emoji_names (gconstpointer a,
+                     gconstpointer b)
+{
+  const EmojiName *na = a;
+  const EmojiName *nb = b;
+
+  return strcmp (na->name, nb->name);
+}
+
+static int
+compare_positions (gconstpointer a,
+                   gconstpointer b)
+{
+  guint pa = *(const guint *) a;
+  guint pb = *(const guint *) b;
+
+  return pa < pb ? -1 : (pa > pb ? 1 : 0);
+}
+
+/* Emoji names sorted for prefix lookups. The names point into the
+ * shared emoji data, which is never freed, so the index is built
+ * once and kept for all completions.
+ */
+static GArray *
+get_name_index (void)
+{
+  static GArray *index = NULL;
+  GVariant *data;
+  GVariantIter iter;
+  GVariant *item;
+  guint position;
+
+  if (index != NULL)
+    return index;
+
+  data = get_emoji_variant ();
+
+  index = g_array_sized_new (FALSE, FALSE, sizeof (EmojiName), g_variant_n_children (data));
+  position = 0;
+  g_variant_iter_init (&iter, data);
+  while ((item = g_variant_iter_next_value (&iter)))
+    {
+      EmojiName name;
+
+      g_variant_get_child (item, 1, "&s", &name.name);
+      name.position = position++;
+      g_array_append_val (index, name);
+      g_variant_unref (item);
+    }
+
+  g_array_sort (index, compare_emoji_names);
+
+  g_variant_unref (data);
+
+  return index;
+}
+
 static int
 populate_completion (GtkEmojiCompletion *completion,
                      const char         *text,
@@ -551,7 +614,10 @@ populate_completion (GtkEmojiCompletion *completion,
 {
   guint n_matches;
   guint n_added;
-  GVariantIter iter;
+  GArray *index;
+  GArray *matches;
+  const char *prefix;
+  guint lo, hi, i;
   GVariant *item;
   GtkWidget *child;
 
@@ -568,27 +634,50 @@ populate_completion (GtkEmojiCompletion *completion,
 
   completion->active = NULL;
 
-  n_matches = 0;
-  n_added = 0;
-  g_variant_iter_init (&iter, completion->data);
-  while ((item = g_variant_iter_next_value (&iter)))
+  index = get_name_index ();
+  prefix = text + 1;
+
+  /* Find the first name that is not smaller than the prefix.
+   * All names starting with the prefix follow it.
+   */
+  lo = 0;
+  hi = index->len;
+  while (lo < hi)
     {
-      const char *name;
+      guint mid = (lo + hi) / 2;
 
-      g_variant_get_child (item, 1, "&s", &name);
+      if (strcmp (g_array_index (index, EmojiName, mid).name, prefix) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
 
-      if (g_str_has_prefix (name, text + 1))
-        {
-          n_matches++;
+  matches = g_array_new (FALSE, FALSE, sizeof (guint));
+  for (i = lo; i < index->len; i++)
+    {
+      EmojiName *name = &g_array_index (index, EmojiName, i);
 
-          if (n_matches > offset && n_added < MAX_ROWS)
-            {
-              add_emoji (completion->list, item, completion);
-              n_added++;
-            }
-        }
+      if (!g_str_has_prefix (name->name, prefix))
+        break;
+
+      g_array_append_val (matches, name->position);
+    }
+
+  /* Present matches in the order of the emoji data */
+  g_array_sort (matches, compare_positions);
+
+  n_matches = matches->len;
+  n_added = 0;
+  for (i = offset; i < matches->len && n_added < MAX_ROWS; i++)
+    {
+      item = g_variant_get_child_value (completion->data, g_array_index (matches, guint, i));
+      add_emoji (completion->list, item, completion);
+      g_variant_unref (item);
+      n_added++;
     }
 
+  g_array_unref (matches);
+
   completion->n_matches = n_matches;
 
   if (n_added > 0)
@@ -619,15 +708,11 @@ long_pressed_cb (GtkGesture *gesture,
 static void
 gtk_emoji_completion_init (GtkEmojiCompletion *completion)
 {
-  GBytes *bytes = NULL;
   GtkGesture *long_press;
 
   gtk_widget_init_template (GTK_WIDGET (completion));
 
-  bytes = get_emoji_data ();
-  completion->data = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("a(ausasu)"), bytes, TRUE));
-
-  g_bytes_unref (bytes);
+  completion->data = get_emoji_variant ();
 
   long_press = gtk_gesture_long_press_new ();
   g_signal_connect (long_press, "pressed", G_CALLBACK (long_pressed_cb), completion);
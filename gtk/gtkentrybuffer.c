@@ -110,6 +110,27 @@ gtk_entry_buffer_normal_get_text (GtkEntryBuffer *buffer,
   return priv->normal_text;
 }
 
+/* Like g_utf8_offset_to_pointer(), but gives up once more than
+ * @max_bytes have been walked. Text that does not fit into the
+ * buffer is dropped anyway, so there is no point in scanning a
+ * huge paste to its end.
+ */
+static gsize
+utf8_offset_to_bytes_bounded (const char *chars,
+                              guint       n_chars,
+                              gsize       max_bytes)
+{
+  const char *p = chars;
+
+  while (n_chars > 0 && (gsize) (p - chars) <= max_bytes)
+    {
+      p = g_utf8_next_char (p);
+      n_chars--;
+    }
+
+  return p - chars;
+}
+
 static guint
 gtk_entry_buffer_normal_get_length (GtkEntryBuffer *buffer)
 {
@@ -129,7 +150,7 @@ gtk_entry_buffer_normal_insert_text (GtkEntryBuffer *buffer,
   gsize n_bytes;
   gsize at;
 
-  n_bytes = g_utf8_offset_to_pointer (chars, n_chars) - chars;
+  n_bytes = utf8_offset_to_bytes_bounded (chars, n_chars, GTK_ENTRY_BUFFER_MAX_SIZE);
 
   /* Need more memory */
   if (n_bytes + pv->normal_text_bytes + 1 > pv->normal_text_size)
@@ -189,6 +189,7 @@ gtk_event_controller_class_init (GtkEventControllerClass *klass)
   klass->filter_event = gtk_event_controller_filter_event_default;
   klass->handle_event = gtk_event_controller_handle_event_default;
   klass->handle_crossing = gtk_event_controller_handle_crossing_default;
+  klass->event_types = G_MAXUINT;
 
   object_class->finalize = gtk_event_controller_finalize;
   object_class->set_property = gtk_event_controller_set_property;
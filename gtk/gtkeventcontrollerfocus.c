@@ -185,6 +185,7 @@ gtk_event_controller_focus_class_init (GtkEventControllerFocusClass *klass)
   object_class->finalize = gtk_event_controller_focus_finalize;
   object_class->get_property = gtk_event_controller_focus_get_property;
   controller_class->handle_crossing = gtk_event_controller_focus_handle_crossing;
+  controller_class->event_types = 0;
 
   /**
    * GtkEventControllerFocus:is-focus: (attributes org.gtk.Property.get=gtk_event_controller_focus_is_focus)
@@ -192,6 +192,7 @@ gtk_event_controller_motion_class_init (GtkEventControllerMotionClass *klass)
   object_class->get_property = gtk_event_controller_motion_get_property;
 
   controller_class->handle_event = gtk_event_controller_motion_handle_event;
+  controller_class->event_types = GTK_EVENT_TYPE_BIT (GDK_MOTION_NOTIFY);
   controller_class->handle_crossing = gtk_event_controller_motion_handle_crossing;
 
   /**
@@ -114,11 +114,27 @@ struct _GtkEventControllerClass
   gboolean (* filter_event) (GtkEventController *controller,
                              GdkEvent           *event);
 
+  /* The event types that handle_event may do anything with, as
+   * GTK_EVENT_TYPE_BIT()s. Other events are not passed to the
+   * controller at all.
+   */
+  guint event_types;
+
   gpointer padding[10];
 };
 
+#define GTK_EVENT_TYPE_BIT(type) (1u << (type))
+
+G_STATIC_ASSERT (GDK_EVENT_LAST <= 32);
+
 GtkWidget * gtk_event_controller_get_target (GtkEventController *controller);
 
+static inline guint
+gtk_event_controller_get_event_types (GtkEventController *controller)
+{
+  return GTK_EVENT_CONTROLLER_GET_CLASS (controller)->event_types;
+}
+
 
 gboolean   gtk_event_controller_handle_event   (GtkEventController *controller,
                                                 GdkEvent           *event,
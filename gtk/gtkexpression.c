@@ -1070,8 +1070,12 @@ struct _GtkPropertyExpression
   GtkExpression *expr;
 
   GParamSpec *pspec;
+  /* Looked up once so watches don't need to */
+  GQuark pspec_quark;
 };
 
+static guint notify_signal_id;
+
 static void
 gtk_property_expression_finalize (GtkExpression *expr)
 {
@@ -1153,6 +1157,8 @@ struct _GtkPropertyExpressionWatch
   GtkPropertyExpression *expr;
   gpointer               this;
   GClosure              *closure;
+  gpointer               object; /* not a reference, only valid while handler_id is connected */
+  gulong                 handler_id;
   guchar                 sub[0];
 };
 
@@ -1165,6 +1171,8 @@ gtk_property_expression_watch_destroy_closure (GtkPropertyExpressionWatch *pwatc
   g_closure_invalidate (pwatch->closure);
   g_closure_unref (pwatch->closure);
   pwatch->closure = NULL;
+  pwatch->object = NULL;
+  pwatch->handler_id = 0;
 }
 
 static void
@@ -1176,23 +1184,39 @@ gtk_property_expression_watch_notify_cb (GObject                    *object,
 }
 
 static void
-gtk_property_expression_watch_create_closure (GtkPropertyExpressionWatch *pwatch)
+gtk_property_expression_watch_update_closure (GtkPropertyExpressionWatch *pwatch)
 {
   GObject *object;
 
   object = gtk_property_expression_get_object (pwatch->expr, pwatch->this);
+
+  /* The object expression often notifies without the object actually
+   * changing, for example when a list item gets rebound to an item of
+   * the same row. Keep the handler then.
+   * Handler ids are never reused, so if the old object is gone and its
+   * memory is used by the new one, the check still fails as it should.
+   */
+  if (object != NULL &&
+      object == pwatch->object &&
+      g_signal_handler_is_connected (object, pwatch->handler_id))
+    {
+      g_object_unref (object);
+      return;
+    }
+
+  gtk_property_expression_watch_destroy_closure (pwatch);
+
   if (object == NULL)
     return;
 
   pwatch->closure = g_cclosure_new (G_CALLBACK (gtk_property_expression_watch_notify_cb), pwatch, NULL);
-  if (!g_signal_connect_closure_by_id (object,
-                                       g_signal_lookup ("notify", G_OBJECT_TYPE (object)),
-                                       g_quark_from_string (pwatch->expr->pspec->name),
-                                       g_closure_ref (pwatch->closure),
-                                       FALSE))
-    {
-      g_assert_not_reached ();
-    }
+  pwatch->handler_id = g_signal_connect_closure_by_id (object,
+                                                       notify_signal_id,
+                                                       pwatch->expr->pspec_quark,
+                                                       g_closure_ref (pwatch->closure),
+                                                       FALSE);
+  g_assert (pwatch->handler_id != 0);
+  pwatch->object = object;
 
   g_object_unref (object);
 }
@@ -1202,8 +1226,7 @@ gtk_property_expression_watch_expr_notify_cb (gpointer data)
 {
   GtkPropertyExpressionWatch *pwatch = data;
 
-  gtk_property_expression_watch_destroy_closure (pwatch);
-  gtk_property_expression_watch_create_closure (pwatch);
+  gtk_property_expression_watch_update_closure (pwatch);
   pwatch->notify (pwatch->user_data);
 }
 
@@ -1243,7 +1266,7 @@ gtk_property_expression_watch (GtkExpression         *expr,
                                     pwatch);
     }
 
-  gtk_property_expression_watch_create_closure (pwatch);
+  gtk_property_expression_watch_update_closure (pwatch);
 }
 
 static void
@@ -1359,8 +1382,12 @@ gtk_property_expression_new_for_pspec (GtkExpression *expression,
   self = (GtkPropertyExpression *) result;
 
   self->pspec = pspec;
+  self->pspec_quark = g_param_spec_get_name_quark (pspec);
   self->expr = expression;
 
+  if (G_UNLIKELY (notify_signal_id == 0))
+    notify_signal_id = g_signal_lookup ("notify", G_TYPE_OBJECT);
+
   return result;
 }
 
@@ -220,6 +220,10 @@ struct _GtkFileChooserWidget
   GtkQuery *search_query;
   GtkFileSystemModel *search_model;
   GtkFileSystemModel *model_for_search;
+  GPtrArray *search_pending_hits; /* GtkSearchHits not yet in search_model */
+  guint search_flush_id;
+  guint n_search_results;
+  guint search_results_limit;
 
   /* OPERATION_MODE_RECENT */
   GtkRecentManager *recent_manager;
@@ -383,6 +387,17 @@ enum {
 
 #define ICON_SIZE 16
 
+/* Icon and thumbnail queries that may run at the same time per model */
+#define MAX_THUMBNAIL_QUERIES 8
+
+/* Decoded thumbnails kept around for reuse */
+#define MAX_CACHED_THUMBNAILS 256
+
+/* Search results shown at first, and added each time the user
+ * scrolls to the end of the list
+ */
+#define SEARCH_RESULTS_PAGE 1000
+
 static void gtk_file_chooser_widget_iface_init       (GtkFileChooserIface        *iface);
 
 static void     gtk_file_chooser_widget_constructed  (GObject               *object);
@@ -517,6 +532,7 @@ static void     search_stop_searching        (GtkFileChooserWidget *impl,
 static void     search_clear_model           (GtkFileChooserWidget *impl, 
                                               gboolean               remove_from_treeview);
 static void     search_entry_activate_cb     (GtkFileChooserWidget *impl);
+static void     search_entry_changed_cb      (GtkFileChooserWidget *impl);
 static void     search_entry_stop_cb         (GtkFileChooserWidget *impl);
 static void     settings_load                (GtkFileChooserWidget *impl);
 
@@ -605,6 +621,7 @@ gtk_file_chooser_widget_finalize (GObject *object)
   search_clear_model (impl, FALSE);
   recent_clear_model (impl, FALSE);
   g_clear_object (&impl->model_for_search);
+  g_clear_pointer (&impl->search_pending_hits, g_ptr_array_unref);
 
   /* stopping the load above should have cleared this */
   g_assert (impl->load_timeout_id == 0);
@@ -4258,6 +4275,174 @@ copy_attribute (GFileInfo   *to,
     g_file_info_set_attribute (to, attribute, type, value);
 }
 
+/* Icons and thumbnails are queried for visible rows only, with at
+ * most MAX_THUMBNAIL_QUERIES of them in flight per model. Further
+ * requests wait in a queue, newest first since those are the rows
+ * the user is looking at, and are dropped if their row has been
+ * scrolled out of view by the time they would start.
+ */
+typedef struct {
+  GWeakRef impl;
+  GQueue pending; /* GFiles */
+  guint n_running;
+} ThumbnailQueue;
+
+typedef struct {
+  GFile *file;
+  GFileInfo *queried;
+  char *path;
+  char *cache_key;
+  int size;
+} ThumbnailRequest;
+
+static GHashTable *thumbnail_cache; /* cache key => GdkPixbuf */
+static GQueue thumbnail_cache_keys = G_QUEUE_INIT;
+
+static void thumbnail_queue_run (GtkFileSystemModel *model);
+
+static void
+thumbnail_queue_free (gpointer data)
+{
+  ThumbnailQueue *queue = data;
+
+  g_weak_ref_clear (&queue->impl);
+  g_queue_clear_full (&queue->pending, g_object_unref);
+  g_free (queue);
+}
+
+static ThumbnailQueue *
+get_thumbnail_queue (GtkFileChooserWidget *impl,
+                     GtkFileSystemModel   *model)
+{
+  ThumbnailQueue *queue;
+
+  queue = g_object_get_data (G_OBJECT (model), "filechooser-thumbnail-queue");
+  if (queue == NULL && impl != NULL)
+    {
+      queue = g_new0 (ThumbnailQueue, 1);
+      g_weak_ref_init (&queue->impl, impl);
+      g_queue_init (&queue->pending);
+      g_object_set_data_full (G_OBJECT (model), "filechooser-thumbnail-queue",
+                              queue, thumbnail_queue_free);
+    }
+
+  return queue;
+}
+
+static void
+thumbnail_request_free (ThumbnailRequest *request)
+{
+  g_object_unref (request->file);
+  g_object_unref (request->queried);
+  g_free (request->path);
+  g_free (request->cache_key);
+  g_free (request);
+}
+
+static GdkPixbuf *
+lookup_cached_thumbnail (const char *cache_key)
+{
+  if (thumbnail_cache == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (thumbnail_cache, cache_key);
+}
+
+static void
+cache_thumbnail (const char *cache_key,
+                 GdkPixbuf  *pixbuf)
+{
+  char *key;
+
+  if (thumbnail_cache == NULL)
+    thumbnail_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+
+  if (g_hash_table_contains (thumbnail_cache, cache_key))
+    return;
+
+  if (g_queue_get_length (&thumbnail_cache_keys) >= MAX_CACHED_THUMBNAILS)
+    g_hash_table_remove (thumbnail_cache, g_queue_pop_tail (&thumbnail_cache_keys));
+
+  key = g_strdup (cache_key);
+  g_hash_table_insert (thumbnail_cache, key, g_object_ref (pixbuf));
+  g_queue_push_head (&thumbnail_cache_keys, key);
+}
+
+static void
+thumbnail_query_done (GtkFileSystemModel *model,
+                      GFile              *file,
+                      GFileInfo          *queried,
+                      GdkPixbuf          *thumbnail)
+{
+  ThumbnailQueue *queue;
+  GFileInfo *info;
+  GtkTreeIter iter;
+
+  queue = get_thumbnail_queue (NULL, model);
+  if (queue)
+    queue->n_running--;
+
+  /* file was deleted */
+  if (queried != NULL &&
+      _gtk_file_system_model_get_iter_for_file (model, &iter, file))
+    {
+      info = g_file_info_dup (_gtk_file_system_model_get_info (model, &iter));
+
+      copy_attribute (info, queried, G_FILE_ATTRIBUTE_THUMBNAILING_FAILED);
+      copy_attribute (info, queried, G_FILE_ATTRIBUTE_STANDARD_ICON);
+      if (thumbnail)
+        g_file_info_set_attribute_object (info, "filechooser::thumbnail", G_OBJECT (thumbnail));
+
+      _gtk_file_system_model_update_file (model, file, info);
+
+      g_object_unref (info);
+    }
+
+  thumbnail_queue_run (model);
+}
+
+static void
+decode_thumbnail_thread (GTask        *task,
+                         gpointer      source_object,
+                         gpointer      task_data,
+                         GCancellable *cancellable)
+{
+  ThumbnailRequest *request = task_data;
+  GdkPixbuf *pixbuf;
+
+  pixbuf = gdk_pixbuf_new_from_file_at_size (request->path,
+                                             request->size, request->size,
+                                             NULL);
+
+  g_task_return_pointer (task, pixbuf, g_object_unref);
+}
+
+static void
+file_system_model_decoded_thumbnail (GObject      *object,
+                                     GAsyncResult *res,
+                                     gpointer      data)
+{
+  GtkFileSystemModel *model = GTK_FILE_SYSTEM_MODEL (object);
+  ThumbnailRequest *request = g_task_get_task_data (G_TASK (res));
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+
+  pixbuf = g_task_propagate_pointer (G_TASK (res), &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_error_free (error);
+      return;
+    }
+  g_clear_error (&error);
+
+  if (pixbuf)
+    cache_thumbnail (request->cache_key, pixbuf);
+
+  thumbnail_query_done (model, request->file, request->queried, pixbuf);
+
+  g_clear_object (&pixbuf);
+}
+
 static void
 file_system_model_got_thumbnail (GObject      *object,
                                  GAsyncResult *res,
@@ -4265,32 +4450,170 @@ file_system_model_got_thumbnail (GObject      *object,
 {
   GtkFileSystemModel *model = data; /* might be unreffed if operation was cancelled */
   GFile *file = G_FILE (object);
-  GFileInfo *queried, *info;
-  GtkTreeIter iter;
+  GtkFileChooserWidget *impl;
+  ThumbnailQueue *queue;
+  GFileInfo *queried;
+  GError *error = NULL;
+  const char *path;
 
-  queried = g_file_query_info_finish (file, res, NULL);
-  if (queried == NULL)
-    return;
+  queried = g_file_query_info_finish (file, res, &error);
+  if (queried == NULL &&
+      g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_error_free (error);
+      return;
+    }
+  g_clear_error (&error);
 
   /* now we know model is valid */
 
-  /* file was deleted */
+  queue = get_thumbnail_queue (NULL, model);
+  impl = queue ? g_weak_ref_get (&queue->impl) : NULL;
+
+  path = queried ? g_file_info_get_attribute_byte_string (queried, G_FILE_ATTRIBUTE_THUMBNAIL_PATH) : NULL;
+  if (path != NULL && impl != NULL)
+    {
+      ThumbnailRequest *request;
+      GdkPixbuf *pixbuf;
+      GTask *task;
+
+      request = g_new0 (ThumbnailRequest, 1);
+      request->size = ICON_SIZE * gtk_widget_get_scale_factor (GTK_WIDGET (impl));
+      request->cache_key = g_strdup_printf ("%d:%s", request->size, path);
+
+      pixbuf = lookup_cached_thumbnail (request->cache_key);
+      if (pixbuf)
+        {
+          thumbnail_query_done (model, file, queried, pixbuf);
+          g_free (request->cache_key);
+          g_free (request);
+        }
+      else
+        {
+          /* Decoding even small thumbnails takes long enough to
+           * stutter scrolling, so it's done in a thread.
+           */
+          request->file = g_object_ref (file);
+          request->queried = g_object_ref (queried);
+          request->path = g_strdup (path);
+
+          task = g_task_new (model,
+                             _gtk_file_system_model_get_cancellable (model),
+                             file_system_model_decoded_thumbnail,
+                             NULL);
+          g_task_set_source_tag (task, file_system_model_got_thumbnail);
+          g_task_set_task_data (task, request, (GDestroyNotify) thumbnail_request_free);
+          g_task_run_in_thread (task, decode_thumbnail_thread);
+          g_object_unref (task);
+        }
+    }
+  else
+    thumbnail_query_done (model, file, queried, NULL);
+
+  g_clear_object (&impl);
+  g_clear_object (&queried);
+}
+
+static gboolean
+file_is_visible (GtkFileChooserWidget *impl,
+                 GtkFileSystemModel   *model,
+                 GFile                *file)
+{
+  GtkTreeModel *tree_model;
+  GtkTreePath *start, *end;
+  GtkTreeIter iter;
+  gboolean visible;
+
+  tree_model = gtk_tree_view_get_model (GTK_TREE_VIEW (impl->browse_files_tree_view));
+  if (tree_model != GTK_TREE_MODEL (model))
+    return FALSE;
+
   if (!_gtk_file_system_model_get_iter_for_file (model, &iter, file))
+    return FALSE;
+
+  if (gtk_tree_view_get_visible_range (GTK_TREE_VIEW (impl->browse_files_tree_view), &start, &end))
     {
-      g_object_unref (queried);
-      return;
+      GtkTreePath *path;
+
+      gtk_tree_path_prev (start);
+      gtk_tree_path_next (end);
+      path = gtk_tree_model_get_path (tree_model, &iter);
+      visible = gtk_tree_path_compare (start, path) != 1 &&
+                gtk_tree_path_compare (path, end) != 1;
+      gtk_tree_path_free (path);
+      gtk_tree_path_free (start);
+      gtk_tree_path_free (end);
     }
+  else
+    visible = TRUE;
 
-  info = g_file_info_dup (_gtk_file_system_model_get_info (model, &iter));
+  return visible;
+}
 
-  copy_attribute (info, queried, G_FILE_ATTRIBUTE_THUMBNAIL_PATH);
-  copy_attribute (info, queried, G_FILE_ATTRIBUTE_THUMBNAILING_FAILED);
-  copy_attribute (info, queried, G_FILE_ATTRIBUTE_STANDARD_ICON);
+static void
+thumbnail_query_start (GtkFileSystemModel *model,
+                       ThumbnailQueue     *queue,
+                       GFile              *file)
+{
+  queue->n_running++;
+  g_file_query_info_async (file,
+                           G_FILE_ATTRIBUTE_THUMBNAIL_PATH ","
+                           G_FILE_ATTRIBUTE_THUMBNAILING_FAILED ","
+                           G_FILE_ATTRIBUTE_STANDARD_ICON,
+                           G_FILE_QUERY_INFO_NONE,
+                           G_PRIORITY_DEFAULT,
+                           _gtk_file_system_model_get_cancellable (model),
+                           file_system_model_got_thumbnail,
+                           model);
+}
 
-  _gtk_file_system_model_update_file (model, file, info);
+static void
+thumbnail_queue_run (GtkFileSystemModel *model)
+{
+  GtkFileChooserWidget *impl;
+  ThumbnailQueue *queue;
+  GtkTreeIter iter;
+  GFile *file;
+
+  queue = get_thumbnail_queue (NULL, model);
+  if (queue == NULL)
+    return;
+
+  impl = g_weak_ref_get (&queue->impl);
+  if (impl == NULL)
+    return;
+
+  while (queue->n_running < MAX_THUMBNAIL_QUERIES &&
+         (file = g_queue_pop_head (&queue->pending)))
+    {
+      if (file_is_visible (impl, model, file))
+        thumbnail_query_start (model, queue, file);
+      else if (_gtk_file_system_model_get_iter_for_file (model, &iter, file))
+        {
+          /* Ask again once the row is shown again */
+          GFileInfo *info = _gtk_file_system_model_get_info (model, &iter);
+          g_file_info_remove_attribute (info, "filechooser::queried");
+        }
 
-  g_object_unref (info);
-  g_object_unref (queried);
+      g_object_unref (file);
+    }
+
+  g_object_unref (impl);
+}
+
+static void
+thumbnail_queue_push (GtkFileChooserWidget *impl,
+                      GtkFileSystemModel   *model,
+                      GFile                *file)
+{
+  ThumbnailQueue *queue;
+
+  queue = get_thumbnail_queue (impl, model);
+
+  if (queue->n_running < MAX_THUMBNAIL_QUERIES)
+    thumbnail_query_start (model, queue, file);
+  else
+    g_queue_push_head (&queue->pending, g_object_ref (file));
 }
 
 /* Copied from src/nautilus_file.c:get_description() */
@@ -4445,7 +4768,11 @@ file_system_model_set (GtkFileSystemModel *model,
     case MODEL_COL_ICON:
       if (info)
         {
-          if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ICON))
+          if (g_file_info_has_attribute (info, "filechooser::thumbnail"))
+            {
+              g_value_set_object (value, g_file_info_get_attribute_object (info, "filechooser::thumbnail"));
+            }
+          else if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ICON))
             {
               int scale;
               GtkIconTheme *icon_theme;
@@ -4457,49 +4784,14 @@ file_system_model_set (GtkFileSystemModel *model,
             }
           else
             {
-              GtkTreeModel *tree_model;
-              GtkTreePath *start, *end;
-              GtkTreeIter iter;
-              gboolean visible;
-
               if (impl->browse_files_tree_view == NULL ||
                   g_file_info_has_attribute (info, "filechooser::queried"))
                 return FALSE;
 
-              tree_model = gtk_tree_view_get_model (GTK_TREE_VIEW (impl->browse_files_tree_view));
-              if (tree_model != GTK_TREE_MODEL (model))
-                return FALSE;
-
-              if (!_gtk_file_system_model_get_iter_for_file (model, &iter, file))
-                g_assert_not_reached ();
-
-              if (gtk_tree_view_get_visible_range (GTK_TREE_VIEW (impl->browse_files_tree_view), &start, &end))
-                {
-                  GtkTreePath *path;
-
-                  gtk_tree_path_prev (start);
-                  gtk_tree_path_next (end);
-                  path = gtk_tree_model_get_path (tree_model, &iter);
-                  visible = gtk_tree_path_compare (start, path) != 1 &&
-                            gtk_tree_path_compare (path, end) != 1;
-                  gtk_tree_path_free (path);
-                  gtk_tree_path_free (start);
-                  gtk_tree_path_free (end);
-                }
-              else
-                visible = TRUE;
-              if (visible)
+              if (file_is_visible (impl, model, file))
                 {
                   g_file_info_set_attribute_boolean (info, "filechooser::queried", TRUE);
-                  g_file_query_info_async (file,
-                                           G_FILE_ATTRIBUTE_THUMBNAIL_PATH ","
-                                           G_FILE_ATTRIBUTE_THUMBNAILING_FAILED ","
-                                           G_FILE_ATTRIBUTE_STANDARD_ICON,
-                                           G_FILE_QUERY_INFO_NONE,
-                                           G_PRIORITY_DEFAULT,
-                                           _gtk_file_system_model_get_cancellable (model),
-                                           file_system_model_got_thumbnail,
-                                           model);
+                  thumbnail_queue_push (impl, model, file);
                 }
               return FALSE;
             }
@@ -6461,21 +6753,33 @@ get_selected_infos (GtkFileChooserWidget *impl)
   return result;
 }
 
-/* Callback used from GtkSearchEngine when we get new hits */
+/* Moves pending hits into the search model, up to the limit of
+ * results currently shown. Every batch causes a resort of the model,
+ * so all hits that arrived during a frame are added in one go.
+ */
 static void
-search_engine_hits_added_cb (GtkSearchEngine      *engine,
-                             GList                *hits,
-                             GtkFileChooserWidget *impl)
+search_flush_hits (GtkFileChooserWidget *impl)
 {
-  GList *l, *files, *files_with_info, *infos;
+  GList *files, *files_with_info, *infos;
   GFile *file;
+  guint i, n;
+
+  if (impl->search_model == NULL ||
+      impl->search_pending_hits == NULL ||
+      impl->n_search_results >= impl->search_results_limit)
+    return;
+
+  n = MIN (impl->search_pending_hits->len,
+           impl->search_results_limit - impl->n_search_results);
+  if (n == 0)
+    return;
 
   files = NULL;
   files_with_info = NULL;
   infos = NULL;
-  for (l = hits; l; l = l->next)
+  for (i = 0; i < n; i++)
     {
-      GtkSearchHit *hit = (GtkSearchHit *)l->data;
+      GtkSearchHit *hit = g_ptr_array_index (impl->search_pending_hits, i);
       file = g_object_ref (hit->file);
       if (hit->info)
         {
@@ -6495,9 +6799,84 @@ search_engine_hits_added_cb (GtkSearchEngine      *engine,
   g_list_free_full (files_with_info, g_object_unref);
   g_list_free_full (infos, g_object_unref);
 
+  g_ptr_array_remove_range (impl->search_pending_hits, 0, n);
+  impl->n_search_results += n;
+
   gtk_stack_set_visible_child_name (GTK_STACK (impl->browse_files_stack), "list");
 }
 
+static gboolean
+search_flush_hits_tick (GtkWidget     *widget,
+                        GdkFrameClock *frame_clock,
+                        gpointer       data)
+{
+  GtkFileChooserWidget *impl = GTK_FILE_CHOOSER_WIDGET (widget);
+
+  impl->search_flush_id = 0;
+  search_flush_hits (impl);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+search_queue_flush_hits (GtkFileChooserWidget *impl)
+{
+  if (impl->search_flush_id != 0)
+    return;
+
+  impl->search_flush_id = gtk_widget_add_tick_callback (GTK_WIDGET (impl),
+                                                        search_flush_hits_tick,
+                                                        NULL, NULL);
+}
+
+static void
+search_clear_pending_hits (GtkFileChooserWidget *impl)
+{
+  if (impl->search_flush_id != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (impl), impl->search_flush_id);
+      impl->search_flush_id = 0;
+    }
+
+  if (impl->search_pending_hits)
+    g_ptr_array_set_size (impl->search_pending_hits, 0);
+}
+
+/* Shows the next page of results once the user scrolls to the end */
+static void
+search_adjustment_value_changed_cb (GtkAdjustment        *adjustment,
+                                    GtkFileChooserWidget *impl)
+{
+  if (impl->search_pending_hits == NULL ||
+      impl->search_pending_hits->len == 0 ||
+      impl->n_search_results < impl->search_results_limit)
+    return;
+
+  if (gtk_adjustment_get_value (adjustment) + 2 * gtk_adjustment_get_page_size (adjustment) <
+      gtk_adjustment_get_upper (adjustment))
+    return;
+
+  impl->search_results_limit += SEARCH_RESULTS_PAGE;
+  search_queue_flush_hits (impl);
+}
+
+/* Callback used from GtkSearchEngine when we get new hits */
+static void
+search_engine_hits_added_cb (GtkSearchEngine      *engine,
+                             GList                *hits,
+                             GtkFileChooserWidget *impl)
+{
+  GList *l;
+
+  if (impl->search_pending_hits == NULL)
+    impl->search_pending_hits = g_ptr_array_new_with_free_func ((GDestroyNotify) _gtk_search_hit_free);
+
+  for (l = hits; l; l = l->next)
+    g_ptr_array_add (impl->search_pending_hits, _gtk_search_hit_dup (l->data));
+
+  search_queue_flush_hits (impl);
+}
+
 /* Callback used from GtkSearchEngine when the query is done running */
 static void
 search_engine_finished_cb (GtkSearchEngine *engine,
@@ -6545,6 +6924,13 @@ search_clear_model (GtkFileChooserWidget *impl,
       gtk_tree_view_get_model (GTK_TREE_VIEW (impl->browse_files_tree_view)) == GTK_TREE_MODEL (impl->search_model))
     gtk_tree_view_set_model (GTK_TREE_VIEW (impl->browse_files_tree_view), NULL);
 
+  search_clear_pending_hits (impl);
+  impl->n_search_results = 0;
+
+  if (impl->browse_files_tree_view)
+    g_signal_handlers_disconnect_by_func (gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (impl->browse_files_tree_view)),
+                                          search_adjustment_value_changed_cb, impl);
+
   g_clear_object (&impl->search_model);
 }
 
@@ -6558,6 +6944,9 @@ search_stop_searching (GtkFileChooserWidget *impl,
       gtk_editable_set_text (GTK_EDITABLE (impl->search_entry), "");
     }
 
+  /* Hits that weren't shown yet belong to the query being stopped */
+  search_clear_pending_hits (impl);
+
   if (impl->search_engine)
     {
       _gtk_search_engine_stop (impl->search_engine);
@@ -6595,6 +6984,12 @@ search_setup_model (GtkFileChooserWidget *impl)
   gtk_tree_view_set_model (GTK_TREE_VIEW (impl->browse_files_tree_view),
                            GTK_TREE_MODEL (impl->search_model));
 
+  impl->n_search_results = 0;
+  impl->search_results_limit = SEARCH_RESULTS_PAGE;
+  g_signal_connect (gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (impl->browse_files_tree_view)),
+                    "value-changed",
+                    G_CALLBACK (search_adjustment_value_changed_cb), impl);
+
   gtk_tree_view_column_set_sort_column_id (impl->list_name_column, -1);
   gtk_tree_view_column_set_sort_column_id (impl->list_time_column, -1);
   gtk_tree_view_column_set_sort_column_id (impl->list_size_column, -1);
@@ -6699,6 +7094,17 @@ search_entry_activate_cb (GtkFileChooserWidget *impl)
     search_stop_searching (impl, FALSE);
 }
 
+/* The entry only reports a search change after a short delay.
+ * Stop the running query right away, so its hits stop arriving
+ * while the user is still typing.
+ */
+static void
+search_entry_changed_cb (GtkFileChooserWidget *impl)
+{
+  if (impl->search_engine)
+    search_stop_searching (impl, FALSE);
+}
+
 static void
 search_entry_stop_cb (GtkFileChooserWidget *impl)
 {
@@ -7698,6 +8104,7 @@ gtk_file_chooser_widget_class_init (GtkFileChooserWidgetClass *class)
   gtk_widget_class_bind_template_callback (widget_class, places_sidebar_show_error_message_cb);
   gtk_widget_class_bind_template_callback (widget_class, places_sidebar_show_other_locations_with_flags_cb);
   gtk_widget_class_bind_template_callback (widget_class, search_entry_activate_cb);
+  gtk_widget_class_bind_template_callback (widget_class, search_entry_changed_cb);
   gtk_widget_class_bind_template_callback (widget_class, search_entry_stop_cb);
   gtk_widget_class_bind_template_callback (widget_class, new_folder_popover_active);
   gtk_widget_class_bind_template_callback (widget_class, new_folder_name_changed);
@@ -22,8 +22,21 @@
 #include "gtkfilterlistmodel.h"
 
 #include "gtkbitset.h"
+#include "gtkboolfilter.h"
 #include "gtkintl.h"
+#include "gtkmultifilter.h"
 #include "gtkprivate.h"
+#include "gtkstringfilter.h"
+#include "gtkstringlist.h"
+
+/* Number of items each task on a worker thread filters */
+#define GTK_FILTER_PARALLEL_CHUNK_SIZE (1024)
+
+/* Minimum number of items in a filter step for running it on worker threads
+ *
+ * Below this, evaluating the filter is faster than waking up the threads.
+ */
+#define GTK_FILTER_PARALLEL_MIN_ITEMS (2 * GTK_FILTER_PARALLEL_CHUNK_SIZE)
 
 /**
  * GtkFilterListModel:
@@ -37,6 +50,11 @@
  * The model can be set up to do incremental searching, so that
  * filtering long lists doesn't block the UI. See
  * [method@Gtk.FilterListModel.set_incremental] for details.
+ *
+ * When filtering a `GtkStringList` with a `GtkStringFilter` or
+ * `GtkBoolFilter` whose expressions only look up properties of
+ * the `GtkStringObject` items, or `GtkAnyFilter` and `GtkEveryFilter`
+ * combinations of them, large lists are filtered on multiple threads.
  */
 
 enum {
@@ -154,6 +172,196 @@ gtk_filter_list_model_run_filter_on_item (GtkFilterListModel *self,
   return visible;
 }
 
+static gboolean
+gtk_filter_list_model_expression_is_thread_safe (GtkExpression *expression)
+{
+  if (expression == NULL)
+    return TRUE;
+
+  if (G_TYPE_CHECK_INSTANCE_TYPE (expression, GTK_TYPE_CONSTANT_EXPRESSION))
+    return TRUE;
+
+  /* The getters of GtkStringObject only read, other classes may
+   * compute their properties in ways we know nothing about.
+   */
+  if (G_TYPE_CHECK_INSTANCE_TYPE (expression, GTK_TYPE_PROPERTY_EXPRESSION))
+    return gtk_property_expression_get_pspec (expression)->owner_type == GTK_TYPE_STRING_OBJECT &&
+           gtk_filter_list_model_expression_is_thread_safe (gtk_property_expression_get_expression (expression));
+
+  return FALSE;
+}
+
+static gboolean
+gtk_filter_list_model_filter_is_thread_safe (GtkFilter *filter)
+{
+  GType type = G_OBJECT_TYPE (filter);
+
+  if (type == GTK_TYPE_STRING_FILTER)
+    return gtk_filter_list_model_expression_is_thread_safe (gtk_string_filter_get_expression (GTK_STRING_FILTER (filter)));
+
+  if (type == GTK_TYPE_BOOL_FILTER)
+    return gtk_filter_list_model_expression_is_thread_safe (gtk_bool_filter_get_expression (GTK_BOOL_FILTER (filter)));
+
+  if (type == GTK_TYPE_ANY_FILTER || type == GTK_TYPE_EVERY_FILTER)
+    {
+      guint i, n = g_list_model_get_n_items (G_LIST_MODEL (filter));
+      gboolean result = TRUE;
+
+      for (i = 0; i < n && result; i++)
+        {
+          GtkFilter *child = g_list_model_get_item (G_LIST_MODEL (filter), i);
+          result = gtk_filter_list_model_filter_is_thread_safe (child);
+          g_object_unref (child);
+        }
+
+      return result;
+    }
+
+  return FALSE;
+}
+
+/* Whether the filter can be evaluated on worker threads.
+ *
+ * This needs both the filter and the model to only read while matching,
+ * which we only know for a few builtin types. Subclasses and custom
+ * filters are always run on the main thread.
+ */
+static gboolean
+gtk_filter_list_model_can_filter_parallel (GtkFilterListModel *self)
+{
+  return g_get_num_processors () > 1 &&
+         G_OBJECT_TYPE (self->model) == GTK_TYPE_STRING_LIST &&
+         gtk_filter_list_model_filter_is_thread_safe (self->filter);
+}
+
+/* A parallel filter step splits the pending items into chunks and
+ * filters each of them into its own bitset on the worker threads.
+ * The main thread takes chunks, too, and waits for the rest before
+ * merging the bitsets, so the model and the filter can't change
+ * while the threads look at them.
+ */
+typedef struct {
+  GtkFilterListModel *self;
+  guint n_items;                /* number of pending items to filter */
+  guint n_chunks;
+  GtkBitset **chunks;           /* matches of each chunk */
+
+  int next_chunk;               /* atomic, next chunk to filter */
+
+  GMutex mutex;
+  GCond cond;
+  guint n_done;                 /* number of chunks done, protected by mutex */
+  guint n_tasks;                /* tasks queued or running, protected by mutex */
+} GtkFilterParallel;
+
+static GThreadPool *filter_pool = NULL;
+
+static void
+gtk_filter_parallel_run_chunk (GtkFilterParallel *parallel,
+                               guint              chunk)
+{
+  GtkFilterListModel *self = parallel->self;
+  GtkBitset *matches;
+  GtkBitsetIter iter;
+  guint i, n, pos;
+  gboolean more;
+
+  matches = gtk_bitset_new_empty ();
+  n = MIN (GTK_FILTER_PARALLEL_CHUNK_SIZE, parallel->n_items - chunk * GTK_FILTER_PARALLEL_CHUNK_SIZE);
+
+  for (i = 0, more = gtk_bitset_iter_init_at (&iter,
+                                              self->pending,
+                                              gtk_bitset_get_nth (self->pending, chunk * GTK_FILTER_PARALLEL_CHUNK_SIZE),
+                                              &pos);
+       i < n && more;
+       i++, more = gtk_bitset_iter_next (&iter, &pos))
+    {
+      if (gtk_filter_list_model_run_filter_on_item (self, pos))
+        gtk_bitset_add (matches, pos);
+    }
+
+  parallel->chunks[chunk] = matches;
+
+  g_mutex_lock (&parallel->mutex);
+  parallel->n_done++;
+  if (parallel->n_done == parallel->n_chunks)
+    g_cond_broadcast (&parallel->cond);
+  g_mutex_unlock (&parallel->mutex);
+}
+
+static gboolean
+gtk_filter_parallel_run_next (GtkFilterParallel *parallel)
+{
+  guint chunk = g_atomic_int_add (&parallel->next_chunk, 1);
+
+  if (chunk >= parallel->n_chunks)
+    return FALSE;
+
+  gtk_filter_parallel_run_chunk (parallel, chunk);
+  return TRUE;
+}
+
+static void
+gtk_filter_parallel_run_task (gpointer data,
+                              gpointer unused)
+{
+  GtkFilterParallel *parallel = data;
+
+  while (gtk_filter_parallel_run_next (parallel))
+    ;
+
+  g_mutex_lock (&parallel->mutex);
+  parallel->n_tasks--;
+  if (parallel->n_tasks == 0)
+    g_cond_signal (&parallel->cond);
+  g_mutex_unlock (&parallel->mutex);
+}
+
+static void
+gtk_filter_list_model_run_filter_parallel (GtkFilterListModel *self,
+                                           guint               n_items)
+{
+  GtkFilterParallel parallel;
+  guint i, n_threads;
+
+  n_threads = g_get_num_processors ();
+  if (filter_pool == NULL)
+    filter_pool = g_thread_pool_new (gtk_filter_parallel_run_task, NULL, n_threads, FALSE, NULL);
+
+  parallel.self = self;
+  parallel.n_items = n_items;
+  parallel.n_chunks = (n_items + GTK_FILTER_PARALLEL_CHUNK_SIZE - 1) / GTK_FILTER_PARALLEL_CHUNK_SIZE;
+  parallel.chunks = g_new0 (GtkBitset *, parallel.n_chunks);
+  parallel.next_chunk = 0;
+  parallel.n_done = 0;
+  parallel.n_tasks = MIN (n_threads, parallel.n_chunks) - 1;
+  g_mutex_init (&parallel.mutex);
+  g_cond_init (&parallel.cond);
+
+  /* The main thread does one share itself */
+  for (i = 0; i < parallel.n_tasks; i++)
+    g_thread_pool_push (filter_pool, &parallel, NULL);
+
+  while (gtk_filter_parallel_run_next (&parallel))
+    ;
+
+  /* Wait for the tasks, too, they still look at parallel when done */
+  g_mutex_lock (&parallel.mutex);
+  while (parallel.n_done < parallel.n_chunks || parallel.n_tasks > 0)
+    g_cond_wait (&parallel.cond, &parallel.mutex);
+  g_mutex_unlock (&parallel.mutex);
+
+  for (i = 0; i < parallel.n_chunks; i++)
+    {
+      gtk_bitset_union (self->matches, parallel.chunks[i]);
+      gtk_bitset_unref (parallel.chunks[i]);
+    }
+
+  g_free (parallel.chunks);
+  g_mutex_clear (&parallel.mutex);
+  g_cond_clear (&parallel.cond);
+}
+
 static void
 gtk_filter_list_model_run_filter (GtkFilterListModel *self,
                                   guint               n_steps)
@@ -167,6 +375,28 @@ gtk_filter_list_model_run_filter (GtkFilterListModel *self,
   if (self->pending == NULL)
     return;
 
+  if (n_steps >= GTK_FILTER_PARALLEL_MIN_ITEMS &&
+      gtk_bitset_get_size (self->pending) >= GTK_FILTER_PARALLEL_MIN_ITEMS &&
+      gtk_filter_list_model_can_filter_parallel (self))
+    {
+      guint64 size = gtk_bitset_get_size (self->pending);
+
+      if (n_steps < size)
+        {
+          gtk_filter_list_model_run_filter_parallel (self, n_steps);
+          pos = gtk_bitset_get_nth (self->pending, n_steps);
+          gtk_bitset_remove_range_closed (self->pending, 0, pos - 1);
+        }
+      else
+        {
+          gtk_filter_list_model_run_filter_parallel (self, size);
+          g_clear_pointer (&self->pending, gtk_bitset_unref);
+        }
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+
+      return;
+    }
+
   for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
        i < n_steps && more;
        i++, more = gtk_bitset_iter_next (&iter, &pos))
@@ -226,7 +456,11 @@ gtk_filter_list_model_run_filter_cb (gpointer data)
   GtkBitset *old;
 
   old = gtk_bitset_copy (self->matches);
-  gtk_filter_list_model_run_filter (self, 512);
+  /* With threads, give every thread a chunk per step */
+  if (gtk_filter_list_model_can_filter_parallel (self))
+    gtk_filter_list_model_run_filter (self, GTK_FILTER_PARALLEL_CHUNK_SIZE * g_get_num_processors ());
+  else
+    gtk_filter_list_model_run_filter (self, 512);
 
   if (self->pending == NULL)
     gtk_filter_list_model_stop_filtering (self);
@@ -69,6 +69,8 @@
 #include "gtkprivate.h"
 #include "gtkwidgetprivate.h"
 
+#include "gsk/gsktransformprivate.h"
+
 #include <graphene-gobject.h>
 
 struct _GtkFixedLayout
@@ -245,7 +247,7 @@ gtk_fixed_layout_measure (GtkLayoutManager *layout_manager,
     {
       int child_min = 0, child_nat = 0;
       int child_min_opp = 0, child_nat_opp = 0;
-      graphene_rect_t min_rect, nat_rect;
+      graphene_rect_t rects[2]; /* minimum and natural */
 
       if (!gtk_widget_should_layout (child))
         continue;
@@ -259,35 +261,34 @@ gtk_fixed_layout_measure (GtkLayoutManager *layout_manager,
                           &child_min_opp, &child_nat_opp,
                           NULL, NULL);
 
-      min_rect.origin.x = min_rect.origin.y = 0;
-      nat_rect.origin.x = nat_rect.origin.y = 0;
+      rects[0].origin.x = rects[0].origin.y = 0;
+      rects[1].origin.x = rects[1].origin.y = 0;
       if (orientation == GTK_ORIENTATION_HORIZONTAL)
         {
-          min_rect.size.width = child_min;
-          min_rect.size.height = child_min_opp;
-          nat_rect.size.width = child_nat;
-          nat_rect.size.height = child_nat_opp;
+          rects[0].size.width = child_min;
+          rects[0].size.height = child_min_opp;
+          rects[1].size.width = child_nat;
+          rects[1].size.height = child_nat_opp;
         }
       else
        {
-          min_rect.size.width = child_min_opp;
-          min_rect.size.height = child_min;
-          nat_rect.size.width = child_nat_opp;
-          nat_rect.size.height = child_nat;
+          rects[0].size.width = child_min_opp;
+          rects[0].size.height = child_min;
+          rects[1].size.width = child_nat_opp;
+          rects[1].size.height = child_nat;
        }
 
-      gsk_transform_transform_bounds (child_info->transform, &min_rect, &min_rect);
-      gsk_transform_transform_bounds (child_info->transform, &nat_rect, &nat_rect);
+      gsk_transform_transform_bounds_n (child_info->transform, rects, rects, 2);
 
       if (orientation == GTK_ORIENTATION_HORIZONTAL)
         {
-          minimum_size = MAX (minimum_size, min_rect.origin.x + min_rect.size.width);
-          natural_size = MAX (natural_size, nat_rect.origin.x + nat_rect.size.width);
+          minimum_size = MAX (minimum_size, rects[0].origin.x + rects[0].size.width);
+          natural_size = MAX (natural_size, rects[1].origin.x + rects[1].size.width);
         }
       else
         {
-          minimum_size = MAX (minimum_size, min_rect.origin.y + min_rect.size.height);
-          natural_size = MAX (natural_size, nat_rect.origin.y + nat_rect.size.height);
+          minimum_size = MAX (minimum_size, rects[0].origin.y + rects[0].size.height);
+          natural_size = MAX (natural_size, rects[1].origin.y + rects[1].size.height);
         }
     }
 
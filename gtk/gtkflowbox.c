@@ -3979,6 +3979,7 @@ gtk_flow_box_bound_model_changed (GListModel *list,
 {
   GtkFlowBox *box = user_data;
   GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  gboolean append;
   int i;
 
   while (removed--)
@@ -3989,6 +3990,11 @@ gtk_flow_box_bound_model_changed (GListModel *list,
       gtk_flow_box_remove (box, GTK_WIDGET (child));
     }
 
+  /* Models are mostly filled by appending, avoid looking up
+   * the position in the children sequence for every row then.
+   */
+  append = position + added == g_list_model_get_n_items (list);
+
   for (i = 0; i < added; i++)
     {
       GObject *item;
@@ -4009,7 +4015,11 @@ gtk_flow_box_bound_model_changed (GListModel *list,
         g_object_ref_sink (widget);
 
       gtk_widget_show (widget);
-      gtk_flow_box_insert (box, widget, position + i);
+
+      if (append)
+        gtk_flow_box_insert (box, widget, -1);
+      else
+        gtk_flow_box_insert (box, widget, position + i);
 
       g_object_unref (widget);
       g_object_unref (item);
@@ -45,6 +45,7 @@
 #include "gtkmarshalers.h"
 #include "gtkdragsourceprivate.h"
 #include "gtkprivate.h"
+#include "gtksettingsprivate.h"
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
 
@@ -141,9 +142,7 @@ gtk_gesture_long_press_begin (GtkGesture       *gesture,
     return;
 
   widget = gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (gesture));
-  g_object_get (gtk_widget_get_settings (widget),
-                "gtk-long-press-time", &delay,
-                NULL);
+  delay = gtk_settings_get_long_press_time (gtk_widget_get_settings (widget));
 
   delay = (int)(priv->delay_factor * delay);
 
@@ -45,6 +45,13 @@
 
 #define CAPTURE_THRESHOLD_MS 150
 
+/* Enough for the capture threshold at the event rates of
+ * common input devices. With faster devices, the oldest
+ * events are overwritten and velocity is computed over a
+ * slightly shorter span.
+ */
+#define MAX_EVENTS 64
+
 typedef struct _GtkGestureSwipePrivate GtkGestureSwipePrivate;
 typedef struct _EventData EventData;
 
@@ -57,7 +64,9 @@ struct _EventData
 
 struct _GtkGestureSwipePrivate
 {
-  GArray *events;
+  EventData events[MAX_EVENTS];
+  guint first;
+  guint n_events;
 };
 
 enum {
@@ -69,17 +78,6 @@ static guint signals[N_SIGNALS] = { 0 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkGestureSwipe, gtk_gesture_swipe, GTK_TYPE_GESTURE_SINGLE)
 
-static void
-gtk_gesture_swipe_finalize (GObject *object)
-{
-  GtkGestureSwipePrivate *priv;
-
-  priv = gtk_gesture_swipe_get_instance_private (GTK_GESTURE_SWIPE (object));
-  g_array_free (priv->events, TRUE);
-
-  G_OBJECT_CLASS (gtk_gesture_swipe_parent_class)->finalize (object);
-}
-
 static gboolean
 gtk_gesture_swipe_filter_event (GtkEventController *controller,
                                 GdkEvent           *event)
@@ -104,30 +102,30 @@ gtk_gesture_swipe_filter_event (GtkEventController *controller,
   return GTK_EVENT_CONTROLLER_CLASS (gtk_gesture_swipe_parent_class)->filter_event (controller, event);
 }
 
+static inline EventData *
+get_event (GtkGestureSwipePrivate *priv,
+           guint                   i)
+{
+  return &priv->events[(priv->first + i) % MAX_EVENTS];
+}
+
+/* Drops the events that are too old to matter, keeping
+ * the newest of those as the starting point.
+ */
 static void
 _gtk_gesture_swipe_clear_backlog (GtkGestureSwipe *gesture,
                                   guint32          evtime)
 {
   GtkGestureSwipePrivate *priv;
-  int i, length = 0;
 
   priv = gtk_gesture_swipe_get_instance_private (gesture);
 
-  for (i = 0; i < (int) priv->events->len; i++)
+  while (priv->n_events > 1 &&
+         get_event (priv, 1)->evtime < evtime - CAPTURE_THRESHOLD_MS)
     {
-      EventData *data;
-
-      data = &g_array_index (priv->events, EventData, i);
-
-      if (data->evtime >= evtime - CAPTURE_THRESHOLD_MS)
-        {
-          length = i - 1;
-          break;
-        }
+      priv->first = (priv->first + 1) % MAX_EVENTS;
+      priv->n_events--;
     }
-
-  if (length > 0)
-    g_array_remove_range (priv->events, 0, length);
 }
 
 static void
@@ -146,7 +144,15 @@ gtk_gesture_swipe_append_event (GtkGestureSwipe  *swipe,
   new.y = y;
 
   _gtk_gesture_swipe_clear_backlog (swipe, new.evtime);
-  g_array_append_val (priv->events, new);
+
+  if (priv->n_events == MAX_EVENTS)
+    {
+      priv->first = (priv->first + 1) % MAX_EVENTS;
+      priv->n_events--;
+    }
+
+  *get_event (priv, priv->n_events) = new;
+  priv->n_events++;
 }
 
 static void
@@ -176,11 +182,11 @@ _gtk_gesture_swipe_calculate_velocity (GtkGestureSwipe *gesture,
   _gtk_gesture_get_last_update_time (GTK_GESTURE (gesture), sequence, &evtime);
   _gtk_gesture_swipe_clear_backlog (gesture, evtime);
 
-  if (priv->events->len == 0)
+  if (priv->n_events == 0)
     return;
 
-  start = &g_array_index (priv->events, EventData, 0);
-  end = &g_array_index (priv->events, EventData, priv->events->len - 1);
+  start = get_event (priv, 0);
+  end = get_event (priv, priv->n_events - 1);
 
   diff_time = end->evtime - start->evtime;
   diff_x = end->x - start->x;
@@ -217,8 +223,8 @@ gtk_gesture_swipe_end (GtkGesture       *gesture,
   _gtk_gesture_swipe_calculate_velocity (swipe, &velocity_x, &velocity_y);
   g_signal_emit (gesture, signals[SWIPE], 0, velocity_x, velocity_y);
 
-  if (priv->events->len > 0)
-    g_array_remove_range (priv->events, 0, priv->events->len);
+  priv->first = 0;
+  priv->n_events = 0;
 }
 
 static void
@@ -226,9 +232,6 @@ gtk_gesture_swipe_class_init (GtkGestureSwipeClass *klass)
 {
   GtkGestureClass *gesture_class = GTK_GESTURE_CLASS (klass);
   GtkEventControllerClass *event_controller_class = GTK_EVENT_CONTROLLER_CLASS (klass);
-  GObjectClass *object_class = G_OBJECT_CLASS (klass);
-
-  object_class->finalize = gtk_gesture_swipe_finalize;
 
   event_controller_class->filter_event = gtk_gesture_swipe_filter_event;
 
@@ -261,10 +264,6 @@ gtk_gesture_swipe_class_init (GtkGestureSwipeClass *klass)
 static void
 gtk_gesture_swipe_init (GtkGestureSwipe *gesture)
 {
-  GtkGestureSwipePrivate *priv;
-
-  priv = gtk_gesture_swipe_get_instance_private (gesture);
-  priv->events = g_array_new (FALSE, FALSE, sizeof (EventData));
 }
 
 /**
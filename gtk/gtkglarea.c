@@ -31,6 +31,8 @@
 #include "gtknative.h"
 #include "gtkwidgetprivate.h"
 
+#include "gdk/gdkglcontextprivate.h"
+
 #include <epoxy/gl.h>
 
 /**
@@ -145,6 +147,11 @@ typedef struct {
   int width;
   int height;
   GdkTexture *holder;
+
+  /* Signaled once the renderer is done sampling the texture */
+  GdkGLContext *context;
+  GLsync sync;
+  gboolean use_sync;
 } Texture;
 
 typedef struct {
@@ -159,6 +166,7 @@ typedef struct {
   guint depth_stencil_buffer;
   Texture *texture;
   GList *textures;
+  guint n_buffers;
 
   gboolean has_depth_buffer;
   gboolean has_stencil_buffer;
@@ -178,6 +186,7 @@ enum {
   PROP_USE_ES,
 
   PROP_AUTO_RENDER,
+  PROP_BUFFER_COUNT,
 
   LAST_PROP
 };
@@ -225,6 +234,10 @@ gtk_gl_area_set_property (GObject      *gobject,
       gtk_gl_area_set_use_es (self, g_value_get_boolean (value));
       break;
 
+    case PROP_BUFFER_COUNT:
+      gtk_gl_area_set_buffer_count (self, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -256,6 +269,10 @@ gtk_gl_area_get_property (GObject    *gobject,
       g_value_set_object (value, priv->context);
       break;
 
+    case PROP_BUFFER_COUNT:
+      g_value_set_uint (value, priv->n_buffers);
+      break;
+
     case PROP_USE_ES:
       g_value_set_boolean (value, priv->use_es);
       break;
@@ -386,6 +403,12 @@ delete_one_texture (gpointer data)
   if (texture->holder)
     gdk_gl_texture_release (GDK_GL_TEXTURE (texture->holder));
 
+  if (texture->sync)
+    {
+      glDeleteSync (texture->sync);
+      texture->sync = NULL;
+    }
+
   if (texture->id != 0)
     {
       glDeleteTextures (1, &texture->id);
@@ -408,8 +431,31 @@ gtk_gl_area_ensure_texture (GtkGLArea *area)
 
   if (priv->texture == NULL)
     {
-      GList *l, *link;
+      GList *l, *link, *free_link = NULL;
+      guint n_kept;
+
+      /* Textures are prepended when handed out, so the last free one
+       * is the one that was released longest ago, and the one whose
+       * fence is most likely to be signaled already.
+       */
+      for (l = priv->textures; l; l = l->next)
+        {
+          Texture *texture = l->data;
+
+          if (texture->holder == NULL)
+            free_link = l;
+        }
+
+      if (free_link)
+        {
+          priv->texture = free_link->data;
+          priv->textures = g_list_delete_link (priv->textures, free_link);
+        }
 
+      /* Textures still in use by the renderer are never taken away,
+       * but free ones beyond the configured count are dropped.
+       */
+      n_kept = 1;
       l = priv->textures;
       while (l)
         {
@@ -417,15 +463,14 @@ gtk_gl_area_ensure_texture (GtkGLArea *area)
           link = l;
           l = l->next;
 
-          if (texture->holder)
-            continue;
+          if (texture->holder || n_kept < priv->n_buffers)
+            {
+              n_kept++;
+              continue;
+            }
 
           priv->textures = g_list_delete_link (priv->textures, link);
-
-          if (priv->texture == NULL)
-            priv->texture = texture;
-          else
-            delete_one_texture (texture);
+          delete_one_texture (texture);
         }
     }
 
@@ -436,10 +481,24 @@ gtk_gl_area_ensure_texture (GtkGLArea *area)
       priv->texture->width = 0;
       priv->texture->height = 0;
       priv->texture->holder = NULL;
+      priv->texture->context = priv->context;
+      priv->texture->sync = NULL;
+      priv->texture->use_sync = gdk_gl_context_check_version (priv->context, 3, 2, 3, 0);
 
       glGenTextures (1, &priv->texture->id);
     }
 
+  if (priv->texture->sync)
+    {
+      /* Make the GPU wait for the renderer to finish sampling the
+       * previous contents before we draw over them, without blocking
+       * the CPU.
+       */
+      glWaitSync (priv->texture->sync, 0, GL_TIMEOUT_IGNORED);
+      glDeleteSync (priv->texture->sync);
+      priv->texture->sync = NULL;
+    }
+
   gtk_gl_area_allocate_texture (area);
 }
 
@@ -672,7 +731,27 @@ static void
 release_texture (gpointer data)
 {
   Texture *texture = data;
+  GdkGLContext *current;
+
   texture->holder = NULL;
+
+  /* The texture is released when the renderer drops its last
+   * reference, which happens on the renderer's context once its
+   * commands using the texture have been issued. A fence in that
+   * command stream tells us when the sampling is actually done.
+   * Commands in our own context are already ordered.
+   */
+  current = gdk_gl_context_get_current ();
+  if (texture->use_sync &&
+      current != NULL &&
+      current != texture->context &&
+      gdk_gl_context_is_shared (current, texture->context))
+    {
+      if (texture->sync)
+        glDeleteSync (texture->sync);
+      texture->sync = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      glFlush ();
+    }
 }
 
 static void
@@ -828,6 +907,24 @@ gtk_gl_area_class_init (GtkGLAreaClass *klass)
                           G_PARAM_STATIC_STRINGS |
                           G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkGLArea:buffer-count: (attributes org.gtk.Property.get=gtk_gl_area_get_buffer_count org.gtk.Property.set=gtk_gl_area_set_buffer_count)
+   *
+   * The number of textures the area keeps around to render into.
+   *
+   * See [method@Gtk.GLArea.set_buffer_count].
+   *
+   * Since: 4.6
+   */
+  obj_props[PROP_BUFFER_COUNT] =
+    g_param_spec_uint ("buffer-count",
+                       P_("Buffer count"),
+                       P_("The number of textures kept for rendering"),
+                       2, 3, 2,
+                       GTK_PARAM_READWRITE |
+                       G_PARAM_STATIC_STRINGS |
+                       G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkGLArea:has-depth-buffer: (attributes org.gtk.Property.get=gtk_gl_area_get_has_depth_buffer org.gtk.Property.set=gtk_gl_area_set_has_depth_buffer)
    *
@@ -977,6 +1074,7 @@ gtk_gl_area_init (GtkGLArea *area)
 
   priv->auto_render = TRUE;
   priv->needs_render = TRUE;
+  priv->n_buffers = 2;
   priv->required_gl_version = 0;
 }
 
@@ -1315,6 +1413,62 @@ gtk_gl_area_set_auto_render (GtkGLArea *area,
     }
 }
 
+/**
+ * gtk_gl_area_get_buffer_count: (attributes org.gtk.Method.get_property=buffer-count)
+ * @area: a `GtkGLArea`
+ *
+ * Returns the number of textures @area keeps to render into.
+ *
+ * Returns: the buffer count
+ *
+ * Since: 4.6
+ */
+guint
+gtk_gl_area_get_buffer_count (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+
+  g_return_val_if_fail (GTK_IS_GL_AREA (area), 2);
+
+  return priv->n_buffers;
+}
+
+/**
+ * gtk_gl_area_set_buffer_count: (attributes org.gtk.Method.set_property=buffer-count)
+ * @area: a `GtkGLArea`
+ * @n_buffers: the number of textures, 2 or 3
+ *
+ * Sets the number of textures @area keeps to render into.
+ *
+ * Each frame is rendered into a texture that is then handed to the
+ * renderer, so while a frame is being displayed the next one has to
+ * go into a different texture. With 2 buffers, the area alternates
+ * between two textures. With 3, it can render a new frame while the
+ * renderer is still using an older one, at the cost of more memory.
+ *
+ * The area never draws into a texture that the renderer has not
+ * released yet. When supported, the GPU waits on a fence for the
+ * renderer to finish sampling before the texture is reused.
+ *
+ * Since: 4.6
+ */
+void
+gtk_gl_area_set_buffer_count (GtkGLArea *area,
+                              guint      n_buffers)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+
+  g_return_if_fail (GTK_IS_GL_AREA (area));
+  g_return_if_fail (n_buffers >= 2 && n_buffers <= 3);
+
+  if (priv->n_buffers == n_buffers)
+    return;
+
+  priv->n_buffers = n_buffers;
+
+  g_object_notify_by_pspec (G_OBJECT (area), obj_props[PROP_BUFFER_COUNT]);
+}
+
 /**
  * gtk_gl_area_get_context:
  * @area: a `GtkGLArea`
@@ -106,6 +106,11 @@ void            gtk_gl_area_set_auto_render             (GtkGLArea    *area,
                                                          gboolean      auto_render);
 GDK_AVAILABLE_IN_ALL
 void           gtk_gl_area_queue_render                 (GtkGLArea    *area);
+GDK_AVAILABLE_IN_4_6
+guint           gtk_gl_area_get_buffer_count            (GtkGLArea    *area);
+GDK_AVAILABLE_IN_4_6
+void            gtk_gl_area_set_buffer_count            (GtkGLArea    *area,
+                                                         guint         n_buffers);
 
 
 GDK_AVAILABLE_IN_ALL
@@ -280,8 +280,13 @@ typedef enum
 #define DEBUG_CACHE(args)
 #endif
 
-#define LRU_CACHE_SIZE 100
-#define MAX_LRU_TEXTURE_SIZE 128
+/* The LRU cache keeps recently used icons alive. It is limited both
+ * in the number of icons and in the memory their textures need, so
+ * that a few large icons can't push out all the small ones.
+ */
+#define LRU_CACHE_SIZE 256
+#define LRU_CACHE_MAX_BYTES (8 * 1024 * 1024)
+#define MAX_LRU_TEXTURE_BYTES (LRU_CACHE_MAX_BYTES / 16)
 
 typedef struct _GtkIconPaintableClass GtkIconPaintableClass;
 typedef struct _GtkIconThemeClass     GtkIconThemeClass;
@@ -304,8 +309,9 @@ struct _GtkIconTheme
 
   GHashTable *icon_cache;                       /* Protected by icon_cache lock */
 
-  GtkIconPaintable *lru_cache[LRU_CACHE_SIZE];  /* Protected by icon_cache lock */
-  int lru_cache_current;                        /* Protected by icon_cache lock */
+  GQueue lru_cache;                             /* Protected by icon_cache lock */
+  gsize lru_cache_bytes;                        /* Protected by icon_cache lock */
+  guint lru_cache_evictions;                    /* Protected by icon_cache lock */
 
   char *current_theme;
   char **search_path;
@@ -322,6 +328,11 @@ struct _GtkIconTheme
   GList *themes;
   GHashTable *unthemed_icons;
 
+  /* What lookups resolved to, as long as the themes stay valid.
+   * Unlike icon_cache, this outlives the paintables.
+   */
+  GHashTable *resolved_icons;
+
   /* GdkDisplay for the icon theme (may be NULL) */
   GdkDisplay *display;
   GtkSettings *display_settings;
@@ -349,6 +360,18 @@ typedef struct {
   GtkIconLookupFlags flags;
 } IconKey;
 
+/* The result of resolving an IconKey against the theme chain */
+typedef struct {
+  IconKey key;
+  char *icon_name;
+  char *filename;
+  guint is_svg      : 1;
+  guint is_resource : 1;
+  guint is_symbolic : 1;
+} ResolvedIcon;
+
+#define MAX_RESOLVED_ICONS 4096
+
 struct _GtkIconPaintableClass
 {
   GObjectClass parent_class;
@@ -373,6 +396,7 @@ struct _GtkIconPaintable
    */
   IconKey key;
   GtkIconTheme *in_cache; /* Protected by icon_cache lock */
+  GList lru_link;         /* Protected by icon_cache lock */
 
   char *icon_name;
   char *filename;
@@ -629,6 +653,15 @@ icon_key_equal (gconstpointer _a,
   return a->icon_names[i] == NULL && b->icon_names[i] == NULL;
 }
 
+static void
+resolved_icon_free (ResolvedIcon *resolved)
+{
+  g_strfreev (resolved->key.icon_names);
+  g_free (resolved->icon_name);
+  g_free (resolved->filename);
+  g_slice_free (ResolvedIcon, resolved);
+}
+
 /****************** Icon cache ***********************
  *
  * The icon cache, this spans both GtkIconTheme and GtkIcon, so the locking is
@@ -637,37 +670,71 @@ icon_key_equal (gconstpointer _a,
  * because that will take the lock when removing from the icon cache.
  */
 
+/* An estimate of the memory the texture of the icon needs. We can't
+ * look at the texture itself, as that would need the texture_lock.
+ */
+static gsize
+_icon_cache_texture_bytes (GtkIconPaintable *icon)
+{
+  gsize size = (gsize) icon->desired_size * icon->desired_scale;
+
+  return size * size * 4;
+}
+
 /* This is called with icon_cache lock held so must not take any locks */
 static gboolean
 _icon_cache_should_lru_cache (GtkIconPaintable *icon)
 {
-  return icon->desired_size <= MAX_LRU_TEXTURE_SIZE;
+  return _icon_cache_texture_bytes (icon) <= MAX_LRU_TEXTURE_BYTES;
 }
 
-/* This returns the old lru element because we can't unref it with
- * the lock held */
-static GtkIconPaintable *
+/* This returns the evicted lru elements because we can't unref them
+ * with the lock held */
+static GSList *
 _icon_cache_add_to_lru_cache (GtkIconTheme     *theme,
                               GtkIconPaintable *icon)
 {
-  GtkIconPaintable *old_icon = NULL;
+  GSList *old_icons = NULL;
+
+  if (icon->lru_link.data != NULL)
+    {
+      /* Already cached, move it to the front */
+      if (theme->lru_cache.head != &icon->lru_link)
+        {
+          g_queue_unlink (&theme->lru_cache, &icon->lru_link);
+          g_queue_push_head_link (&theme->lru_cache, &icon->lru_link);
+        }
+
+      return NULL;
+    }
 
-  /* Avoid storing the same info multiple times in a row */
-  if (theme->lru_cache[theme->lru_cache_current] != icon)
+  icon->lru_link.data = g_object_ref (icon);
+  g_queue_push_head_link (&theme->lru_cache, &icon->lru_link);
+  theme->lru_cache_bytes += _icon_cache_texture_bytes (icon);
+
+  /* This never evicts the icon we just added, since it is
+   * much smaller than the budget.
+   */
+  while (theme->lru_cache.length > LRU_CACHE_SIZE ||
+         theme->lru_cache_bytes > LRU_CACHE_MAX_BYTES)
     {
-      theme->lru_cache_current = (theme->lru_cache_current + 1) % LRU_CACHE_SIZE;
-      old_icon = theme->lru_cache[theme->lru_cache_current];
-      theme->lru_cache[theme->lru_cache_current] = g_object_ref (icon);
+      GList *link = g_queue_pop_tail_link (&theme->lru_cache);
+      GtkIconPaintable *old_icon = link->data;
+
+      link->data = NULL;
+      theme->lru_cache_bytes -= _icon_cache_texture_bytes (old_icon);
+      theme->lru_cache_evictions++;
+      old_icons = g_slist_prepend (old_icons, old_icon);
     }
 
-  return old_icon;
+  return old_icons;
 }
 
 static GtkIconPaintable *
 icon_cache_lookup (GtkIconTheme *theme,
                    IconKey      *key)
 {
-  GtkIconPaintable *old_icon = NULL;
+  GSList *old_icons = NULL;
   GtkIconPaintable *icon;
 
   G_LOCK (icon_cache);
@@ -685,14 +752,13 @@ icon_cache_lookup (GtkIconTheme *theme,
 
       /* Move item to front in LRU cache */
       if (_icon_cache_should_lru_cache (icon))
-        old_icon = _icon_cache_add_to_lru_cache (theme, icon);
+        old_icons = _icon_cache_add_to_lru_cache (theme, icon);
     }
 
   G_UNLOCK (icon_cache);
 
-  /* Call potential finalizer outside the lock */
-  if (old_icon)
-    g_object_unref (old_icon);
+  /* Call potential finalizers outside the lock */
+  g_slist_free_full (old_icons, g_object_unref);
 
   return icon;
 }
@@ -716,33 +782,32 @@ icon_uncached_cb (GtkIconPaintable *icon)
 static void
 icon_cache_mark_used_if_cached (GtkIconPaintable *icon)
 {
-  GtkIconPaintable *old_icon = NULL;
+  GSList *old_icons = NULL;
 
   if (!_icon_cache_should_lru_cache (icon))
     return;
 
   G_LOCK (icon_cache);
   if (icon->in_cache)
-    old_icon = _icon_cache_add_to_lru_cache (icon->in_cache, icon);
+    old_icons = _icon_cache_add_to_lru_cache (icon->in_cache, icon);
   G_UNLOCK (icon_cache);
 
   /* Call potential finalizers outside the lock */
-  if (old_icon)
-    g_object_unref (old_icon);
+  g_slist_free_full (old_icons, g_object_unref);
 }
 
 static void
 icon_cache_add (GtkIconTheme     *theme,
                 GtkIconPaintable *icon)
 {
-  GtkIconPaintable *old_icon = NULL;
+  GSList *old_icons = NULL;
 
   G_LOCK (icon_cache);
   icon->in_cache = theme;
   g_hash_table_insert (theme->icon_cache, &icon->key, icon);
 
   if (_icon_cache_should_lru_cache (icon))
-    old_icon = _icon_cache_add_to_lru_cache (theme, icon);
+    old_icons = _icon_cache_add_to_lru_cache (theme, icon);
   DEBUG_CACHE (("adding %p (%s %d 0x%x) to cache (cache size %d)\n",
                 icon,
                 g_strjoinv (",", icon->key.icon_names),
@@ -750,9 +815,8 @@ icon_cache_add (GtkIconTheme     *theme,
                 g_hash_table_size (theme->icon_cache)));
   G_UNLOCK (icon_cache);
 
-  /* Call potential finalizer outside the lock */
-  if (old_icon)
-    g_object_unref (old_icon);
+  /* Call potential finalizers outside the lock */
+  g_slist_free_full (old_icons, g_object_unref);
 }
 
 static void
@@ -767,24 +831,43 @@ icon_cache_remove (GtkIconPaintable *icon)
 static void
 icon_cache_clear (GtkIconTheme *theme)
 {
-  int i;
-  GtkIconPaintable *old_icons[LRU_CACHE_SIZE];
+  GSList *old_icons = NULL;
+  GList *link;
 
   G_LOCK (icon_cache);
   g_hash_table_remove_all (theme->icon_cache);
-  for (i = 0; i < LRU_CACHE_SIZE; i ++)
+  while ((link = g_queue_pop_head_link (&theme->lru_cache)))
     {
-      old_icons[i] = theme->lru_cache[i];
-      theme->lru_cache[i] = NULL;
+      old_icons = g_slist_prepend (old_icons, link->data);
+      link->data = NULL;
     }
+  theme->lru_cache_bytes = 0;
   G_UNLOCK (icon_cache);
 
   /* Call potential finalizers outside the lock */
-  for (i = 0; i < LRU_CACHE_SIZE; i ++)
-    {
-      if (old_icons[i] != NULL)
-        g_object_unref (old_icons[i]);
-    }
+  g_slist_free_full (old_icons, g_object_unref);
+}
+
+/*< private >
+ * gtk_icon_theme_get_cache_statistics:
+ * @self: a `GtkIconTheme`
+ * @n_icons: (out): the number of icons kept alive by the cache
+ * @n_bytes: (out): the estimated texture memory of those icons
+ * @n_evictions: (out): how many icons were dropped to stay in budget
+ *
+ * Gets numbers about the LRU cache, for the inspector.
+ */
+void
+gtk_icon_theme_get_cache_statistics (GtkIconTheme *self,
+                                     guint        *n_icons,
+                                     gsize        *n_bytes,
+                                     guint        *n_evictions)
+{
+  G_LOCK (icon_cache);
+  *n_icons = self->lru_cache.length;
+  *n_bytes = self->lru_cache_bytes;
+  *n_evictions = self->lru_cache_evictions;
+  G_UNLOCK (icon_cache);
 }
 
 /****************** End of icon cache ***********************/
@@ -1261,6 +1344,8 @@ gtk_icon_theme_init (GtkIconTheme *self)
 
   self->icon_cache = g_hash_table_new_full (icon_key_hash, icon_key_equal, NULL,
                                             (GDestroyNotify)icon_uncached_cb);
+  self->resolved_icons = g_hash_table_new_full (icon_key_hash, icon_key_equal, NULL,
+                                                (GDestroyNotify)resolved_icon_free);
 
   self->custom_theme = FALSE;
   self->dir_mtimes = g_array_new (FALSE, TRUE, sizeof (IconThemeDirMtime));
@@ -1375,6 +1460,8 @@ blow_themes (GtkIconTheme *self)
   self->unthemed_icons = NULL;
   self->themes_valid = FALSE;
   self->serial++;
+
+  g_hash_table_remove_all (self->resolved_icons);
 }
 
 int
@@ -1427,6 +1514,7 @@ gtk_icon_theme_finalize (GObject *object)
 
   blow_themes (self);
   g_array_free (self->dir_mtimes, TRUE);
+  g_hash_table_destroy (self->resolved_icons);
 
   gtk_icon_theme_ref_unref (self->ref);
 
@@ -2156,6 +2244,7 @@ real_choose_icon (GtkIconTheme      *self,
   UnthemedIcon *unthemed_icon = NULL;
   const char *icon_name = NULL;
   IconTheme *theme = NULL;
+  ResolvedIcon *resolved;
   int i;
   IconKey key;
 
@@ -2176,6 +2265,17 @@ real_choose_icon (GtkIconTheme      *self,
   if (icon)
     return icon;
 
+  resolved = g_hash_table_lookup (self->resolved_icons, &key);
+  if (resolved)
+    {
+      icon = icon_paintable_new (resolved->icon_name, size, scale);
+      icon->filename = g_strdup (resolved->filename);
+      icon->is_svg = resolved->is_svg;
+      icon->is_resource = resolved->is_resource;
+      icon->is_symbolic = resolved->is_symbolic;
+      goto cache;
+    }
+
   /* For symbolic icons, do a search in all registered themes first;
    * a theme that inherits them from a parent theme might provide
    * an alternative full-color version, but still expect the symbolic icon
@@ -2282,6 +2382,27 @@ real_choose_icon (GtkIconTheme      *self,
  out:
   g_assert (icon != NULL);
 
+#ifdef G_OS_WIN32
+  if (icon->win32_icon == NULL)
+#endif
+    {
+      if (g_hash_table_size (self->resolved_icons) >= MAX_RESOLVED_ICONS)
+        g_hash_table_remove_all (self->resolved_icons);
+
+      resolved = g_slice_new (ResolvedIcon);
+      resolved->key.icon_names = g_strdupv ((char **)icon_names);
+      resolved->key.size = size;
+      resolved->key.scale = scale;
+      resolved->key.flags = flags;
+      resolved->icon_name = g_strdup (icon->icon_name);
+      resolved->filename = g_strdup (icon->filename);
+      resolved->is_svg = icon->is_svg;
+      resolved->is_resource = icon->is_resource;
+      resolved->is_symbolic = icon->is_symbolic;
+      g_hash_table_insert (self->resolved_icons, &resolved->key, resolved);
+    }
+
+ cache:
   icon->key.icon_names = g_strdupv ((char **)icon_names);
   icon->key.size = size;
   icon->key.scale = scale;
@@ -32,4 +32,9 @@ void gtk_icon_theme_lookup_symbolic_colors   (GtkCssStyle      *style,
 
 int gtk_icon_theme_get_serial (GtkIconTheme *self);
 
+void gtk_icon_theme_get_cache_statistics     (GtkIconTheme     *self,
+                                              guint            *n_icons,
+                                              gsize            *n_bytes,
+                                              guint            *n_evictions);
+
 #endif /* __GTK_ICON_THEME_PRIVATE_H__ */
@@ -3089,6 +3089,7 @@ _gtk_icon_view_unselect_item (GtkIconView      *icon_view,
   gtk_icon_view_queue_draw_item (icon_view, item);
 }
 
+#ifdef G_ENABLE_CONSISTENCY_CHECKS
 static void
 verify_items (GtkIconView *icon_view)
 {
@@ -3106,6 +3107,12 @@ verify_items (GtkIconView *icon_view)
       i++;
     }
 }
+#else
+/* Walking all items on every model change makes filling
+ * large models quadratic.
+ */
+#define verify_items(icon_view)
+#endif /* G_ENABLE_CONSISTENCY_CHECKS */
 
 static void
 gtk_icon_view_row_changed (GtkTreeModel *model,
@@ -3166,17 +3173,20 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
      we can store a tail pointer and use that when
      appending (which is a rather common operation)
   */
-  icon_view->priv->items = g_list_insert (icon_view->priv->items,
-					 item, index);
-  
-  list = g_list_nth (icon_view->priv->items, index + 1);
+  list = g_list_nth (icon_view->priv->items, index);
+  icon_view->priv->items = g_list_insert_before (icon_view->priv->items,
+                                                 list, item);
+
+  /* Only walk the list once to find the insertion point
+   * and to update the indices of the following items.
+   */
   for (; list; list = list->next)
     {
       item = list->data;
 
       item->index++;
     }
-    
+
   verify_items (icon_view);
 
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
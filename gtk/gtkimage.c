@@ -581,6 +581,24 @@ gtk_image_new_from_gicon (GIcon *icon)
   return GTK_WIDGET (image);
 }
 
+/* The size in device pixels that a loaded image will be shown at,
+ * so that loaders can decode a smaller image. We only know this
+ * ahead of time if the pixel size is set; the CSS icon size can
+ * change with the style.
+ */
+static int
+gtk_image_get_load_size (GtkImage *image,
+                         int       scale_factor)
+{
+  int pixel_size;
+
+  pixel_size = _gtk_icon_helper_get_pixel_size (image->icon_helper);
+  if (pixel_size == -1)
+    return -1;
+
+  return pixel_size * scale_factor;
+}
+
 /**
  * gtk_image_set_from_file: (attributes org.gtk.Method.set_property=file)
  * @image: a `GtkImage`
@@ -594,7 +612,7 @@ void
 gtk_image_set_from_file (GtkImage    *image,
                          const char *filename)
 {
-  int scale_factor;
+  int scale_factor, size;
   GdkPaintable *paintable;
 
   g_return_if_fail (GTK_IS_IMAGE (image));
@@ -611,7 +629,8 @@ gtk_image_set_from_file (GtkImage    *image,
     }
 
   scale_factor = gtk_widget_get_scale_factor (GTK_WIDGET (image));
-  paintable = gdk_paintable_new_from_path_scaled (filename, scale_factor);
+  size = gtk_image_get_load_size (image, scale_factor);
+  paintable = gdk_paintable_new_from_path_scaled (filename, scale_factor, size, size);
 
   if (paintable == NULL)
     {
@@ -672,7 +691,7 @@ void
 gtk_image_set_from_resource (GtkImage   *image,
                              const char *resource_path)
 {
-  int scale_factor;
+  int scale_factor, size;
   GdkPaintable *paintable;
 
   g_return_if_fail (GTK_IS_IMAGE (image));
@@ -695,7 +714,8 @@ gtk_image_set_from_resource (GtkImage   *image,
   else
     {
       scale_factor = gtk_widget_get_scale_factor (GTK_WIDGET (image));
-      paintable = gdk_paintable_new_from_resource_scaled (resource_path, scale_factor);
+      size = gtk_image_get_load_size (image, scale_factor);
+      paintable = gdk_paintable_new_from_resource_scaled (resource_path, scale_factor, size, size);
     }
 
   if (paintable == NULL)
@@ -1218,10 +1238,30 @@ void
 gtk_image_set_pixel_size (GtkImage *image,
 			  int       pixel_size)
 {
+  int old_pixel_size;
+
   g_return_if_fail (GTK_IS_IMAGE (image));
 
+  old_pixel_size = _gtk_icon_helper_get_pixel_size (image->icon_helper);
+
   if (_gtk_icon_helper_set_pixel_size (image->icon_helper, pixel_size))
     {
+      /* Images from files may have been loaded at reduced size */
+      if ((image->filename || image->resource_path) &&
+          (pixel_size == -1 || pixel_size > old_pixel_size))
+        {
+          char *filename = g_strdup (image->filename);
+          char *resource_path = g_strdup (image->resource_path);
+
+          if (filename)
+            gtk_image_set_from_file (image, filename);
+          else
+            gtk_image_set_from_resource (image, resource_path);
+
+          g_free (filename);
+          g_free (resource_path);
+        }
+
       if (gtk_widget_get_visible (GTK_WIDGET (image)))
         gtk_widget_queue_resize (GTK_WIDGET (image));
       g_object_notify_by_pspec (G_OBJECT (image), image_props[PROP_PIXEL_SIZE]);
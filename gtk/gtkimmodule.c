@@ -38,6 +38,7 @@
 #include "gtksettings.h"
 #include "gtkprivate.h"
 #include "gtkintl.h"
+#include "gdk/gdkprofilerprivate.h"
 
 #ifdef GDK_WINDOWING_X11
 #include "x11/gdkx.h"
@@ -91,6 +92,8 @@ _gtk_im_module_create (const char *context_id)
   if (strcmp (context_id, NONE_ID) == 0)
     return NULL;
 
+  gtk_im_modules_init ();
+
   ep = g_io_extension_point_lookup (GTK_IM_MODULE_EXTENSION_POINT_NAME);
   ext = g_io_extension_point_get_extension_by_name (ep, context_id);
   if (ext)
@@ -190,6 +193,8 @@ _gtk_im_module_get_default_context_id (GdkDisplay *display)
   GList *l;
   char *tmp;
 
+  gtk_im_modules_init ();
+
   envvar = g_getenv ("GTK_IM_MODULE");
   if (envvar)
     {
@@ -251,12 +256,25 @@ gtk_im_module_ensure_extension_point (void)
   registered = TRUE;
 }
 
+/* Scanning the module directories is done on demand, when
+ * the first input context is created. Most applications create
+ * one early, but those that don't avoid the cost entirely.
+ */
 void
 gtk_im_modules_init (void)
 {
+  static gboolean initialized = FALSE;
   GIOModuleScope *scope;
   char **paths;
   int i;
+  gint64 before G_GNUC_UNUSED;
+
+  if (initialized)
+    return;
+
+  initialized = TRUE;
+
+  before = GDK_PROFILER_CURRENT_TIME;
 
   gtk_im_module_ensure_extension_point ();
 
@@ -302,4 +320,6 @@ gtk_im_modules_init (void)
                    g_type_name (g_io_extension_get_type (ext)));
         }
     }
+
+  gdk_profiler_end_mark (before, "init im modules", NULL);
 }
@@ -37,11 +37,12 @@
 #include "gtknotebook.h"
 #include "gtkpango.h"
 #include "gtkprivate.h"
+#include "gtksettingsprivate.h"
 #include "gtkshortcut.h"
 #include "gtkshortcutcontroller.h"
 #include "gtkshortcuttrigger.h"
 #include "gtkshow.h"
-#include "gtksnapshot.h"
+#include "gtksnapshotprivate.h"
 #include "gtkstylecontextprivate.h"
 #include "gtktextutil.h"
 #include "gtktooltip.h"
@@ -256,6 +257,7 @@ struct _GtkLabel
   PangoAttrList *attrs;
   PangoAttrList *markup_attrs;
   PangoLayout   *layout;
+  GtkSnapshotLayoutCache layout_cache;
 
   GtkWidget *popup_menu;
   GMenuModel *extra_menu;
@@ -1079,13 +1081,74 @@ get_default_widths (GtkLabel    *self,
     }
 }
 
+/* Labels that don't wrap measure the same for any size, so identical
+ * labels - think of the same strings repeated in every row of a list -
+ * can share their measurements instead of laying out the text again.
+ */
+#define MEASURE_CACHE_SIZE 1024
+
+typedef struct
+{
+  int minimum;
+  int natural;
+  int minimum_baseline;
+  int natural_baseline;
+} GtkLabelMeasurement;
+
+static GHashTable *measure_cache;
+
+static char *
+gtk_label_get_measure_key (GtkLabel       *self,
+                           GtkOrientation  orientation)
+{
+  PangoContext *context;
+  PangoFontMap *fontmap;
+  PangoAttrList *attr_list;
+  const cairo_font_options_t *options;
+  char *font;
+  char *attrs;
+  char *key;
+
+  gtk_label_ensure_layout (self);
+
+  context = pango_layout_get_context (self->layout);
+  fontmap = pango_context_get_font_map (context);
+  options = pango_cairo_context_get_font_options (context);
+  font = pango_font_description_to_string (pango_context_get_font_description (context));
+  attr_list = pango_layout_get_attributes (self->layout);
+  attrs = attr_list ? pango_attr_list_to_string (attr_list) : g_strdup ("");
+
+  /* The strings are length-prefixed, and the text goes last,
+   * so that no two different labels can produce the same key.
+   */
+  key = g_strdup_printf ("%p %u %lu %g %d %d %d %d %d %d %zu:%s %zu:%s %s",
+                         fontmap,
+                         pango_font_map_get_serial (fontmap),
+                         options ? cairo_font_options_hash (options) : 0,
+                         pango_cairo_context_get_resolution (context),
+                         orientation,
+                         self->ellipsize,
+                         self->width_chars,
+                         self->max_width_chars,
+                         self->single_line_mode,
+                         self->lines,
+                         strlen (font), font,
+                         strlen (attrs), attrs,
+                         self->text);
+
+  g_free (font);
+  g_free (attrs);
+
+  return key;
+}
+
 static void
-get_static_size (GtkLabel       *self,
-                 GtkOrientation  orientation,
-                 int            *minimum,
-                 int            *natural,
-                 int            *minimum_baseline,
-                 int            *natural_baseline)
+compute_static_size (GtkLabel       *self,
+                     GtkOrientation  orientation,
+                     int            *minimum,
+                     int            *natural,
+                     int            *minimum_baseline,
+                     int            *natural_baseline)
 {
   int minimum_default, natural_default;
   PangoLayout *layout;
@@ -1123,6 +1186,53 @@ get_static_size (GtkLabel       *self,
   g_object_unref (layout);
 }
 
+static void
+get_static_size (GtkLabel       *self,
+                 GtkOrientation  orientation,
+                 int            *minimum,
+                 int            *natural,
+                 int            *minimum_baseline,
+                 int            *natural_baseline)
+{
+  GtkLabelMeasurement *measurement;
+  char *key;
+
+  if (measure_cache == NULL)
+    measure_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  key = gtk_label_get_measure_key (self, orientation);
+  measurement = g_hash_table_lookup (measure_cache, key);
+
+  if (measurement == NULL)
+    {
+      compute_static_size (self, orientation,
+                           minimum, natural,
+                           minimum_baseline, natural_baseline);
+
+      /* Dropping everything at once is crude, but cheap, and the
+       * labels that are actually on screen will refill it quickly.
+       */
+      if (g_hash_table_size (measure_cache) >= MEASURE_CACHE_SIZE)
+        g_hash_table_remove_all (measure_cache);
+
+      measurement = g_new (GtkLabelMeasurement, 1);
+      measurement->minimum = *minimum;
+      measurement->natural = *natural;
+      measurement->minimum_baseline = *minimum_baseline;
+      measurement->natural_baseline = *natural_baseline;
+      g_hash_table_insert (measure_cache, g_steal_pointer (&key), measurement);
+    }
+  else
+    {
+      *minimum = measurement->minimum;
+      *natural = measurement->natural;
+      *minimum_baseline = measurement->minimum_baseline;
+      *natural_baseline = measurement->natural_baseline;
+    }
+
+  g_free (key);
+}
+
 static void
 get_height_for_width (GtkLabel *self,
                       int       width,
@@ -1381,7 +1491,7 @@ gtk_label_snapshot (GtkWidget   *widget,
   context = _gtk_widget_get_style_context (widget);
   get_layout_location (self, &lx, &ly);
 
-  gtk_snapshot_render_layout (snapshot, context, lx, ly, self->layout);
+  gtk_snapshot_render_layout_cached (snapshot, context, lx, ly, self->layout, &self->layout_cache);
 
   info = self->select_info;
   if (!info)
@@ -1537,6 +1647,7 @@ gtk_label_finalize (GObject *object)
   g_free (self->text);
 
   g_clear_object (&self->layout);
+  gtk_snapshot_layout_cache_clear (&self->layout_cache);
   g_clear_pointer (&self->attrs, pango_attr_list_unref);
   g_clear_pointer (&self->markup_attrs, pango_attr_list_unref);
 
@@ -1648,10 +1759,7 @@ gtk_label_grab_focus (GtkWidget *widget)
 
   if (self->select_info->selectable)
     {
-      g_object_get (gtk_widget_get_settings (widget),
-                    "gtk-label-select-on-focus",
-                    &select_on_focus,
-                    NULL);
+      select_on_focus = gtk_settings_get_label_select_on_focus (gtk_widget_get_settings (widget));
 
       if (select_on_focus && !self->in_click &&
           !(prev_focus && gtk_widget_is_ancestor (prev_focus, widget)))
@@ -3631,11 +3739,98 @@ gtk_label_ensure_has_tooltip (GtkLabel *self)
   gtk_widget_set_has_tooltip (GTK_WIDGET (self), has_tooltip);
 }
 
+/* Labels bound to models often get the same markup set over and over
+ * again, so keep the result of parsing the most recently used markup
+ * around. Markup with links is not cached, the links need per-label
+ * CSS nodes.
+ */
+#define MARKUP_CACHE_SIZE 64
+
+typedef struct
+{
+  GList link;
+  char *key;
+  char *text;
+  PangoAttrList *attrs;
+  gunichar accel_keyval;
+} MarkupCacheEntry;
+
+static GHashTable *markup_cache;
+static GQueue markup_cache_lru = G_QUEUE_INIT;
+
+static void
+markup_cache_entry_free (gpointer data)
+{
+  MarkupCacheEntry *entry = data;
+
+  g_queue_unlink (&markup_cache_lru, &entry->link);
+  g_free (entry->key);
+  g_free (entry->text);
+  g_clear_pointer (&entry->attrs, pango_attr_list_unref);
+  g_free (entry);
+}
+
+static char *
+markup_cache_key (const char *str,
+                  gboolean    strip_ulines,
+                  gboolean    use_ulines)
+{
+  return g_strdup_printf ("%d%d%s", strip_ulines, use_ulines, str);
+}
+
+static MarkupCacheEntry *
+markup_cache_lookup (const char *key)
+{
+  MarkupCacheEntry *entry;
+
+  if (markup_cache == NULL)
+    return NULL;
+
+  entry = g_hash_table_lookup (markup_cache, key);
+  if (entry)
+    {
+      g_queue_unlink (&markup_cache_lru, &entry->link);
+      g_queue_push_head_link (&markup_cache_lru, &entry->link);
+    }
+
+  return entry;
+}
+
+static void
+markup_cache_insert (char          *key,
+                     const char    *text,
+                     PangoAttrList *attrs,
+                     gunichar       accel_keyval)
+{
+  MarkupCacheEntry *entry;
+
+  if (markup_cache == NULL)
+    markup_cache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, markup_cache_entry_free);
+
+  if (g_hash_table_size (markup_cache) >= MARKUP_CACHE_SIZE)
+    {
+      entry = g_queue_peek_tail (&markup_cache_lru);
+      g_hash_table_remove (markup_cache, entry->key);
+    }
+
+  entry = g_new0 (MarkupCacheEntry, 1);
+  entry->link.data = entry;
+  entry->key = key;
+  entry->text = g_strdup (text);
+  entry->attrs = attrs ? pango_attr_list_copy (attrs) : NULL;
+  entry->accel_keyval = accel_keyval;
+
+  g_queue_push_head_link (&markup_cache_lru, &entry->link);
+  g_hash_table_insert (markup_cache, entry->key, entry);
+}
+
 static void
 gtk_label_set_markup_internal (GtkLabel   *self,
                                const char *str,
                                gboolean    with_uline)
 {
+  MarkupCacheEntry *entry;
+  char *key;
   char *text = NULL;
   GError *error = NULL;
   PangoAttrList *attrs = NULL;
@@ -3649,6 +3844,23 @@ gtk_label_set_markup_internal (GtkLabel   *self,
                  gtk_widget_is_sensitive (GTK_WIDGET (self)) &&
                  (!self->mnemonic_widget || gtk_widget_is_sensitive (self->mnemonic_widget));
 
+  key = markup_cache_key (str, with_uline && !do_mnemonics, with_uline && do_mnemonics);
+  entry = markup_cache_lookup (key);
+  if (entry)
+    {
+      g_free (key);
+
+      if (entry->text)
+        gtk_label_set_text_internal (self, g_strdup (entry->text));
+
+      g_clear_pointer (&self->markup_attrs, pango_attr_list_unref);
+      self->markup_attrs = entry->attrs ? pango_attr_list_copy (entry->attrs) : NULL;
+
+      self->mnemonic_keyval = entry->accel_keyval;
+
+      return;
+    }
+
   if (!parse_uri_markup (self, str,
                          with_uline && !do_mnemonics,
                          &accel_keyval,
@@ -3675,6 +3887,11 @@ gtk_label_set_markup_internal (GtkLabel   *self,
 
   g_free (str_for_display);
 
+  if (n_links == 0)
+    markup_cache_insert (g_steal_pointer (&key), text, attrs, accel_keyval);
+  else
+    g_free (key);
+
   if (text)
     gtk_label_set_text_internal (self, text);
 
@@ -3689,6 +3906,7 @@ error_set:
   g_warning ("Failed to set text '%s' from markup due to error parsing markup: %s",
              str, error->message);
   g_error_free (error);
+  g_free (key);
 
 }
 
@@ -4129,6 +4347,7 @@ static void
 gtk_label_clear_layout (GtkLabel *self)
 {
   g_clear_object (&self->layout);
+  gtk_snapshot_layout_cache_clear (&self->layout_cache);
 }
 
 static void
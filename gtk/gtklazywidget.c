@@ -0,0 +1,190 @@
+/*
+ * Copyright © 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtklazywidgetprivate.h"
+
+#include "gtkbinlayout.h"
+#include "gtkbuilder.h"
+#include "gtkwidgetprivate.h"
+
+/*< private >
+ * GtkLazyWidget:
+ *
+ * A placeholder for a child that was declared inside a `<lazy>`
+ * element in a UI file.
+ *
+ * The recorded UI definition is only turned into widgets when the
+ * child is first needed: when a `GtkStack` makes the page visible,
+ * or when the placeholder gets mapped. Until then, it has no size.
+ */
+
+struct _GtkLazyWidget
+{
+  GtkWidget parent_instance;
+
+  GBytes *data;
+  char *object_id;
+  GtkBuilderScope *scope;
+  char *domain;
+  GObject *current_object;
+
+  GtkWidget *child;
+};
+
+G_DEFINE_TYPE (GtkLazyWidget, gtk_lazy_widget, GTK_TYPE_WIDGET)
+
+static void
+gtk_lazy_widget_clear_data (GtkLazyWidget *self)
+{
+  g_clear_pointer (&self->data, g_bytes_unref);
+  g_clear_pointer (&self->object_id, g_free);
+  g_clear_object (&self->scope);
+  g_clear_pointer (&self->domain, g_free);
+  g_clear_weak_pointer (&self->current_object);
+}
+
+static void
+gtk_lazy_widget_map (GtkWidget *widget)
+{
+  gtk_lazy_widget_ensure_child (GTK_LAZY_WIDGET (widget));
+
+  GTK_WIDGET_CLASS (gtk_lazy_widget_parent_class)->map (widget);
+}
+
+static void
+gtk_lazy_widget_dispose (GObject *object)
+{
+  GtkLazyWidget *self = GTK_LAZY_WIDGET (object);
+
+  g_clear_pointer (&self->child, gtk_widget_unparent);
+  gtk_lazy_widget_clear_data (self);
+
+  G_OBJECT_CLASS (gtk_lazy_widget_parent_class)->dispose (object);
+}
+
+static void
+gtk_lazy_widget_class_init (GtkLazyWidgetClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->dispose = gtk_lazy_widget_dispose;
+
+  widget_class->map = gtk_lazy_widget_map;
+  widget_class->focus = gtk_widget_focus_child;
+  widget_class->grab_focus = gtk_widget_grab_focus_child;
+
+  gtk_widget_class_set_layout_manager_type (widget_class, GTK_TYPE_BIN_LAYOUT);
+}
+
+static void
+gtk_lazy_widget_init (GtkLazyWidget *self)
+{
+}
+
+GtkWidget *
+gtk_lazy_widget_new (GBytes          *data,
+                     const char      *object_id,
+                     GtkBuilderScope *scope,
+                     const char      *domain,
+                     GObject         *current_object)
+{
+  GtkLazyWidget *self;
+
+  g_return_val_if_fail (data != NULL, NULL);
+  g_return_val_if_fail (object_id != NULL, NULL);
+
+  self = g_object_new (GTK_TYPE_LAZY_WIDGET, NULL);
+
+  self->data = g_bytes_ref (data);
+  self->object_id = g_strdup (object_id);
+  if (scope)
+    self->scope = g_object_ref (scope);
+  self->domain = g_strdup (domain);
+  /* The current object usually owns us, don't keep it alive */
+  g_set_weak_pointer (&self->current_object, current_object);
+
+  return GTK_WIDGET (self);
+}
+
+/*< private >
+ * gtk_lazy_widget_ensure_child:
+ * @self: a `GtkLazyWidget`
+ *
+ * Builds the child from the recorded UI definition, if that
+ * hasn't happened yet.
+ */
+void
+gtk_lazy_widget_ensure_child (GtkLazyWidget *self)
+{
+  GtkBuilder *builder;
+  GObject *object;
+  GError *error = NULL;
+
+  g_return_if_fail (GTK_IS_LAZY_WIDGET (self));
+
+  if (self->data == NULL)
+    return;
+
+  builder = gtk_builder_new ();
+  if (self->scope)
+    gtk_builder_set_scope (builder, self->scope);
+  gtk_builder_set_translation_domain (builder, self->domain);
+  if (self->current_object)
+    gtk_builder_set_current_object (builder, self->current_object);
+
+  if (!gtk_builder_add_from_string (builder,
+                                    g_bytes_get_data (self->data, NULL),
+                                    g_bytes_get_size (self->data),
+                                    &error))
+    {
+      g_critical ("Failed to build lazy child: %s", error->message);
+      g_error_free (error);
+    }
+  else
+    {
+      object = gtk_builder_get_object (builder, self->object_id);
+      if (GTK_IS_WIDGET (object))
+        {
+          self->child = GTK_WIDGET (object);
+          gtk_widget_set_parent (self->child, GTK_WIDGET (self));
+        }
+      else
+        g_critical ("Lazy child %s is not a widget", self->object_id);
+    }
+
+  g_object_unref (builder);
+
+  gtk_lazy_widget_clear_data (self);
+}
+
+/*< private >
+ * gtk_lazy_widget_get_child:
+ * @self: a `GtkLazyWidget`
+ *
+ * Returns: (transfer none) (nullable): the child, if it
+ *   has been built
+ */
+GtkWidget *
+gtk_lazy_widget_get_child (GtkLazyWidget *self)
+{
+  g_return_val_if_fail (GTK_IS_LAZY_WIDGET (self), NULL);
+
+  return self->child;
+}
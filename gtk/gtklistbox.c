@@ -3634,6 +3634,7 @@ gtk_list_box_bound_model_changed (GListModel *list,
                                   gpointer    user_data)
 {
   GtkListBox *box = user_data;
+  gboolean append;
   guint i;
 
   while (removed--)
@@ -3644,6 +3645,11 @@ gtk_list_box_bound_model_changed (GListModel *list,
       gtk_list_box_remove (box, GTK_WIDGET (row));
     }
 
+  /* Models are mostly filled by appending, avoid looking up
+   * the position in the children sequence for every row then.
+   */
+  append = position + added == g_list_model_get_n_items (list);
+
   for (i = 0; i < added; i++)
     {
       GObject *item;
@@ -3663,7 +3669,11 @@ gtk_list_box_bound_model_changed (GListModel *list,
         g_object_ref_sink (widget);
 
       gtk_widget_show (widget);
-      gtk_list_box_insert (box, widget, position + i);
+
+      if (append)
+        gtk_list_box_insert (box, widget, -1);
+      else
+        gtk_list_box_insert (box, widget, position + i);
 
       g_object_unref (widget);
       g_object_unref (item);
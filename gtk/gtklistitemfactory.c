@@ -23,6 +23,8 @@
 
 #include "gtklistitemprivate.h"
 
+#include "gdkprofilerprivate.h"
+
 /**
  * GtkListItemFactory:
  *
@@ -78,6 +80,10 @@
 
 G_DEFINE_TYPE (GtkListItemFactory, gtk_list_item_factory, G_TYPE_OBJECT)
 
+/* Work done by all factories since the last frame, for the profiler */
+static guint n_setups;
+static guint n_binds;
+
 static void
 gtk_list_item_factory_default_setup (GtkListItemFactory *self,
                                      GtkListItemWidget  *widget,
@@ -129,6 +135,7 @@ gtk_list_item_factory_setup (GtkListItemFactory *self,
   g_return_if_fail (GTK_IS_LIST_ITEM_FACTORY (self));
 
   list_item = gtk_list_item_new ();
+  n_setups++;
 
   GTK_LIST_ITEM_FACTORY_GET_CLASS (self)->setup (self, widget, list_item);
 }
@@ -161,6 +168,8 @@ gtk_list_item_factory_update (GtkListItemFactory *self,
   g_return_if_fail (GTK_IS_LIST_ITEM_WIDGET (widget));
 
   list_item = gtk_list_item_widget_get_list_item (widget);
+  if (item != gtk_list_item_get_item (list_item))
+    n_binds++;
 
   g_object_freeze_notify (G_OBJECT (list_item));
 
@@ -168,3 +177,33 @@ gtk_list_item_factory_update (GtkListItemFactory *self,
 
   g_object_thaw_notify (G_OBJECT (list_item));
 }
+
+/*<private>
+ * gtk_list_item_factory_report_stats:
+ *
+ * Reports the number of list items that were set up and bound
+ * to a new item since the last call to the profiler.
+ */
+void
+gtk_list_item_factory_report_stats (void)
+{
+  static guint setups_counter;
+  static guint binds_counter;
+
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      if (setups_counter == 0)
+        {
+          setups_counter = gdk_profiler_define_int_counter ("list-item-setups",
+                                                            "List items created by factories");
+          binds_counter = gdk_profiler_define_int_counter ("list-item-binds",
+                                                           "List items bound to a new item");
+        }
+
+      gdk_profiler_set_int_counter (setups_counter, n_setups);
+      gdk_profiler_set_int_counter (binds_counter, n_binds);
+    }
+
+  n_setups = 0;
+  n_binds = 0;
+}
@@ -65,6 +65,7 @@ void                    gtk_list_item_factory_update            (GtkListItemFact
                                                                  gpointer                item,
                                                                  gboolean                selected);
 
+void                    gtk_list_item_factory_report_stats      (void);
 
 G_END_DECLS
 
@@ -21,11 +21,22 @@
 
 #include "gtklistitemmanagerprivate.h"
 
+#include "gtkcolumnlistitemfactoryprivate.h"
 #include "gtklistitemwidgetprivate.h"
+#include "gtkprivate.h"
 #include "gtkwidgetprivate.h"
 
 #define GTK_LIST_VIEW_MAX_LIST_ITEMS 200
 
+/* How long recycled list items are kept around unused */
+#define GTK_LIST_ITEM_POOL_TIMEOUT_S 5
+
+/* How many list items we set up ahead of time when idle */
+#define GTK_LIST_ITEM_POOL_PREFETCH 16
+
+/* How much time per frame we spend binding items while scrolling */
+#define GTK_LIST_ITEM_BIND_BUDGET_US 4000
+
 struct _GtkListItemManager
 {
   GObject parent_instance;
@@ -39,6 +50,12 @@ struct _GtkListItemManager
 
   GtkRbTree *items;
   GSList *trackers;
+
+  guint prefetch_id;
+
+  gint64 bind_deadline; /* 0 if all items should be bound right away */
+  int bind_direction; /* direction of the last scroll, for the order of deferred binds */
+  guint bind_tick_id;
 };
 
 struct _GtkListItemManagerClass
@@ -101,6 +118,111 @@ gtk_list_item_manager_augment_node (GtkRbTree *tree,
     }
 }
 
+/* The pool keeps list items that views released while still set up,
+ * so that views using the same factory - or the same view after a
+ * model change - can reuse them without running the factory's setup.
+ *
+ * It lives on the factory and the list items keep a reference to the
+ * factory, so it is emptied after a timeout to not keep both alive.
+ */
+typedef struct {
+  GPtrArray *widgets;
+  guint flush_id;
+} GtkListItemPool;
+
+static GQuark pool_quark;
+
+static void
+gtk_list_item_pool_free (gpointer data)
+{
+  GtkListItemPool *pool = data;
+
+  g_assert (pool->widgets->len == 0);
+
+  g_ptr_array_unref (pool->widgets);
+  g_clear_handle_id (&pool->flush_id, g_source_remove);
+  g_free (pool);
+}
+
+static GtkListItemPool *
+gtk_list_item_pool_get (GtkListItemFactory *factory)
+{
+  GtkListItemPool *pool;
+
+  pool = g_object_get_qdata (G_OBJECT (factory), pool_quark);
+  if (pool == NULL)
+    {
+      pool = g_new0 (GtkListItemPool, 1);
+      pool->widgets = g_ptr_array_new ();
+      g_object_set_qdata_full (G_OBJECT (factory), pool_quark, pool, gtk_list_item_pool_free);
+    }
+
+  return pool;
+}
+
+static gboolean
+gtk_list_item_pool_flush_cb (gpointer data)
+{
+  GtkListItemPool *pool = data;
+  GPtrArray *widgets;
+  guint i;
+
+  /* The last widget may take the factory and with it the pool */
+  widgets = pool->widgets;
+  pool->widgets = g_ptr_array_new ();
+  pool->flush_id = 0;
+
+  for (i = 0; i < widgets->len; i++)
+    {
+      GtkWidget *widget = g_ptr_array_index (widgets, i);
+
+      gtk_list_item_widget_set_recycled (GTK_LIST_ITEM_WIDGET (widget), FALSE);
+      g_object_unref (widget);
+    }
+  g_ptr_array_unref (widgets);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_list_item_pool_add (GtkListItemPool *pool,
+                        GtkWidget       *widget)
+{
+  g_ptr_array_add (pool->widgets, widget);
+
+  g_clear_handle_id (&pool->flush_id, g_source_remove);
+  pool->flush_id = g_timeout_add_seconds (GTK_LIST_ITEM_POOL_TIMEOUT_S, gtk_list_item_pool_flush_cb, pool);
+  gdk_source_set_static_name_by_id (pool->flush_id, "[gtk] gtk_list_item_pool_flush_cb");
+}
+
+static GtkWidget *
+gtk_list_item_pool_take (GtkListItemPool *pool,
+                         const char      *css_name,
+                         GtkAccessibleRole role)
+{
+  guint i;
+
+  for (i = pool->widgets->len; i-- > 0; )
+    {
+      GtkWidget *widget = g_ptr_array_index (pool->widgets, i);
+
+      if (strcmp (gtk_widget_get_css_name (widget), css_name) == 0 &&
+          gtk_accessible_get_accessible_role (GTK_ACCESSIBLE (widget)) == role)
+        return g_ptr_array_steal_index_fast (pool->widgets, i);
+    }
+
+  return NULL;
+}
+
+/* Rows of a column view have cells for the columns in view at the
+ * time they were set up, so they can't be kept around unparented */
+static gboolean
+gtk_list_item_manager_can_recycle (GtkListItemManager *self)
+{
+  return self->factory != NULL &&
+         !GTK_IS_COLUMN_LIST_ITEM_FACTORY (self->factory);
+}
+
 static void
 gtk_list_item_manager_clear_node (gpointer _item)
 {
@@ -475,6 +597,47 @@ gtk_list_item_manager_release_items (GtkListItemManager *self,
     }
 }
 
+static gboolean
+gtk_list_item_manager_prefetch_cb (gpointer data)
+{
+  GtkListItemManager *self = data;
+  GtkListItemPool *pool;
+  GtkWidget *widget;
+
+  pool = gtk_list_item_pool_get (self->factory);
+  if (pool->widgets->len >= GTK_LIST_ITEM_POOL_PREFETCH)
+    {
+      self->prefetch_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  /* One at a time, so we don't block the main loop for long */
+  widget = gtk_list_item_widget_new (self->factory,
+                                     self->item_css_name,
+                                     self->item_role);
+  g_object_ref_sink (widget);
+  gtk_list_item_widget_set_recycled (GTK_LIST_ITEM_WIDGET (widget), TRUE);
+  gtk_list_item_pool_add (pool, widget);
+
+  return G_SOURCE_CONTINUE;
+}
+
+/* Sets up list items in idle time, so when scrolling brings new
+ * items into view or the view gets a new model, they are ready.
+ */
+static void
+gtk_list_item_manager_queue_prefetch (GtkListItemManager *self)
+{
+  if (self->prefetch_id != 0 || !gtk_list_item_manager_can_recycle (self))
+    return;
+
+  if (gtk_list_item_pool_get (self->factory)->widgets->len >= GTK_LIST_ITEM_POOL_PREFETCH)
+    return;
+
+  self->prefetch_id = g_idle_add (gtk_list_item_manager_prefetch_cb, self);
+  gdk_source_set_static_name_by_id (self->prefetch_id, "[gtk] gtk_list_item_manager_prefetch_cb");
+}
+
 static void
 gtk_list_item_manager_ensure_items (GtkListItemManager *self,
                                     GHashTable         *change,
@@ -573,6 +736,8 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
 
   while ((widget = g_queue_pop_head (&released)))
     gtk_list_item_manager_release_list_item (self, NULL, widget);
+
+  gtk_list_item_manager_queue_prefetch (self);
 }
 
 static void
@@ -795,6 +960,13 @@ gtk_list_item_manager_dispose (GObject *object)
 {
   GtkListItemManager *self = GTK_LIST_ITEM_MANAGER (object);
 
+  g_clear_handle_id (&self->prefetch_id, g_source_remove);
+  if (self->bind_tick_id)
+    {
+      gtk_widget_remove_tick_callback (self->widget, self->bind_tick_id);
+      self->bind_tick_id = 0;
+    }
+
   gtk_list_item_manager_clear_model (self);
 
   g_clear_object (&self->factory);
@@ -810,6 +982,8 @@ gtk_list_item_manager_class_init (GtkListItemManagerClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->dispose = gtk_list_item_manager_dispose;
+
+  pool_quark = g_quark_from_static_string ("gtk-list-item-pool");
 }
 
 static void
@@ -833,6 +1007,7 @@ gtk_list_item_manager_set_factory (GtkListItemManager *self,
   n_items = self->model ? g_list_model_get_n_items (G_LIST_MODEL (self->model)) : 0;
   gtk_list_item_manager_remove_items (self, NULL, 0, n_items);
 
+  g_clear_handle_id (&self->prefetch_id, g_source_remove);
   g_set_object (&self->factory, factory);
 
   gtk_list_item_manager_add_items (self, 0, n_items);
@@ -898,6 +1073,87 @@ gtk_list_item_manager_get_model (GtkListItemManager *self)
   return self->model;
 }
 
+static gboolean
+gtk_list_item_manager_bind_tick_cb (GtkWidget     *widget,
+                                    GdkFrameClock *clock,
+                                    gpointer       data)
+{
+  GtkListItemManager *self = data;
+  GtkListItemManagerItem *item;
+  gint64 deadline;
+
+  deadline = g_get_monotonic_time () + GTK_LIST_ITEM_BIND_BUDGET_US;
+
+  /* Bind in the order the items scrolled into view */
+  for (item = self->bind_direction < 0 ? gtk_rb_tree_get_last (self->items) : gtk_rb_tree_get_first (self->items);
+       item != NULL;
+       item = self->bind_direction < 0 ? gtk_rb_tree_node_get_previous (item) : gtk_rb_tree_node_get_next (item))
+    {
+      GtkListItemWidget *list_item;
+      guint position;
+      gpointer model_item;
+
+      if (item->widget == NULL)
+        continue;
+
+      list_item = GTK_LIST_ITEM_WIDGET (item->widget);
+      position = gtk_list_item_widget_get_position (list_item);
+      if (gtk_list_item_widget_get_item (list_item) != NULL ||
+          position == GTK_INVALID_LIST_POSITION)
+        continue;
+
+      if (g_get_monotonic_time () >= deadline)
+        return G_SOURCE_CONTINUE;
+
+      model_item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
+      gtk_list_item_widget_update (list_item,
+                                   position,
+                                   model_item,
+                                   gtk_selection_model_is_selected (self->model, position));
+      g_object_unref (model_item);
+    }
+
+  self->bind_tick_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * gtk_list_item_manager_bind_list_item:
+ * @self: a `GtkListItemManager`
+ * @widget: a list item widget
+ * @position: the row in the model to bind @widget to
+ *
+ * Binds @widget to the item at @position.
+ *
+ * While scrolling, binding happens within a time budget per frame.
+ * After that, @widget is only unbound and shows as an empty
+ * placeholder until it gets bound on one of the next frames.
+ **/
+static void
+gtk_list_item_manager_bind_list_item (GtkListItemManager *self,
+                                      GtkWidget          *widget,
+                                      guint               position)
+{
+  gpointer item;
+  gboolean selected;
+
+  selected = gtk_selection_model_is_selected (self->model, position);
+
+  if (self->bind_deadline != 0 && g_get_monotonic_time () >= self->bind_deadline)
+    {
+      gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (widget), position, NULL, selected);
+      if (self->bind_tick_id == 0)
+        self->bind_tick_id = gtk_widget_add_tick_callback (self->widget,
+                                                           gtk_list_item_manager_bind_tick_cb,
+                                                           self, NULL);
+      return;
+    }
+
+  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
+  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (widget), position, item, selected);
+  g_object_unref (item);
+}
+
 /*
  * gtk_list_item_manager_acquire_list_item:
  * @self: a `GtkListItemManager`
@@ -922,23 +1178,32 @@ gtk_list_item_manager_acquire_list_item (GtkListItemManager *self,
                                          GtkWidget          *prev_sibling)
 {
   GtkWidget *result;
-  gpointer item;
-  gboolean selected;
+  gboolean recycled;
 
   g_return_val_if_fail (GTK_IS_LIST_ITEM_MANAGER (self), NULL);
   g_return_val_if_fail (prev_sibling == NULL || GTK_IS_WIDGET (prev_sibling), NULL);
 
-  result = gtk_list_item_widget_new (self->factory,
-                                     self->item_css_name,
-                                     self->item_role);
+  result = NULL;
+  if (gtk_list_item_manager_can_recycle (self))
+    result = gtk_list_item_pool_take (gtk_list_item_pool_get (self->factory),
+                                      self->item_css_name,
+                                      self->item_role);
+  recycled = result != NULL;
+  if (!recycled)
+    result = gtk_list_item_widget_new (self->factory,
+                                       self->item_css_name,
+                                       self->item_role);
 
   gtk_list_item_widget_set_single_click_activate (GTK_LIST_ITEM_WIDGET (result), self->single_click_activate);
 
-  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
-  selected = gtk_selection_model_is_selected (self->model, position);
-  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (result), position, item, selected);
-  g_object_unref (item);
+  gtk_list_item_manager_bind_list_item (self, result, position);
   gtk_widget_insert_after (result, self->widget, prev_sibling);
+  if (recycled)
+    {
+      /* drop the pool's reference */
+      gtk_list_item_widget_set_recycled (GTK_LIST_ITEM_WIDGET (result), FALSE);
+      g_object_unref (result);
+    }
 
   return GTK_WIDGET (result);
 }
@@ -1011,17 +1276,8 @@ gtk_list_item_manager_move_list_item (GtkListItemManager     *self,
                                       guint                   position,
                                       GtkWidget              *prev_sibling)
 {
-  gpointer item;
-  gboolean selected;
-
-  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
-  selected = gtk_selection_model_is_selected (self->model, position);
-  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (list_item),
-                               position,
-                               item,
-                               selected);
+  gtk_list_item_manager_bind_list_item (self, list_item, position);
   gtk_widget_insert_after (list_item, _gtk_widget_get_parent (list_item), prev_sibling);
-  g_object_unref (item);
 }
 
 /**
@@ -1070,7 +1326,9 @@ gtk_list_item_manager_release_list_item (GtkListItemManager *self,
   g_return_if_fail (GTK_IS_LIST_ITEM_MANAGER (self));
   g_return_if_fail (GTK_IS_LIST_ITEM_WIDGET (item));
 
-  if (change != NULL)
+  /* Unbound placeholders have nothing to be found by */
+  if (change != NULL &&
+      gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (item)) != NULL)
     {
       if (!g_hash_table_replace (change, gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (item)), item))
         {
@@ -1080,6 +1338,17 @@ gtk_list_item_manager_release_list_item (GtkListItemManager *self,
       return;
     }
 
+  if (gtk_list_item_manager_can_recycle (self))
+    {
+      GtkListItemPool *pool = gtk_list_item_pool_get (self->factory);
+
+      if (pool->widgets->len < GTK_LIST_VIEW_MAX_LIST_ITEMS)
+        {
+          gtk_list_item_widget_set_recycled (GTK_LIST_ITEM_WIDGET (item), TRUE);
+          gtk_list_item_pool_add (pool, g_object_ref (item));
+        }
+    }
+
   gtk_widget_unparent (item);
 }
 
@@ -1149,8 +1418,9 @@ gtk_list_item_tracker_set_position (GtkListItemManager *self,
                                     guint               n_after)
 {
   GtkListItemManagerItem *item;
-  guint n_items;
+  guint n_items, old_position;
 
+  old_position = tracker->position;
   gtk_list_item_tracker_unset_position (self, tracker);
 
   if (self->model == NULL)
@@ -1164,7 +1434,14 @@ gtk_list_item_tracker_set_position (GtkListItemManager *self,
   tracker->n_before = n_before;
   tracker->n_after = n_after;
 
+  /* Moving a tracker is scrolling, so limit the time spent binding */
+  if (old_position != GTK_INVALID_LIST_POSITION && old_position != position)
+    {
+      self->bind_direction = position > old_position ? 1 : -1;
+      self->bind_deadline = g_get_monotonic_time () + GTK_LIST_ITEM_BIND_BUDGET_US;
+    }
   gtk_list_item_manager_ensure_items (self, NULL, G_MAXUINT);
+  self->bind_deadline = 0;
 
   item = gtk_list_item_manager_get_nth (self, position, NULL);
   if (item)
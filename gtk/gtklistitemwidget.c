@@ -44,6 +44,7 @@ struct _GtkListItemWidgetPrivate
   guint position;
   gboolean selected;
   gboolean single_click_activate;
+  gboolean recycled;
 };
 
 enum {
@@ -148,7 +149,8 @@ gtk_list_item_widget_root (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_list_item_widget_parent_class)->root (widget);
 
-  if (priv->factory)
+  /* recycled widgets are still set up */
+  if (priv->factory && priv->list_item == NULL)
     gtk_list_item_factory_setup (priv->factory, self);
 }
 
@@ -160,7 +162,7 @@ gtk_list_item_widget_unroot (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_list_item_widget_parent_class)->unroot (widget);
 
-  if (priv->list_item)
+  if (priv->list_item && !priv->recycled)
       gtk_list_item_factory_teardown (priv->factory, self);
 }
 
@@ -606,6 +608,41 @@ gtk_list_item_widget_set_factory (GtkListItemWidget  *self,
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FACTORY]);
 }
 
+/*<private>
+ * gtk_list_item_widget_set_recycled:
+ * @self: a `GtkListItemWidget`
+ * @recycled: %TRUE to keep the widget set up while it has no parent
+ *
+ * Recycled widgets are unbound from their item, but keep what the
+ * factory set up when they are unparented, so they can be reused
+ * without running the factory's setup again. If the widget wasn't
+ * set up yet, it is set up now.
+ *
+ * Unsetting @recycled on a widget without a parent tears it down.
+ */
+void
+gtk_list_item_widget_set_recycled (GtkListItemWidget *self,
+                                   gboolean           recycled)
+{
+  GtkListItemWidgetPrivate *priv = gtk_list_item_widget_get_instance_private (self);
+
+  if (priv->recycled == recycled)
+    return;
+
+  priv->recycled = recycled;
+
+  if (recycled)
+    {
+      if (priv->factory && priv->list_item == NULL)
+        gtk_list_item_factory_setup (priv->factory, self);
+      gtk_list_item_widget_update (self, GTK_INVALID_LIST_POSITION, NULL, FALSE);
+    }
+  else if (priv->list_item && gtk_widget_get_root (GTK_WIDGET (self)) == NULL)
+    {
+      gtk_list_item_factory_teardown (priv->factory, self);
+    }
+}
+
 void
 gtk_list_item_widget_set_single_click_activate (GtkListItemWidget *self,
                                                 gboolean           single_click_activate)
@@ -71,6 +71,8 @@ void                    gtk_list_item_widget_default_update     (GtkListItemWidg
 
 void                    gtk_list_item_widget_set_factory        (GtkListItemWidget      *self,
                                                                  GtkListItemFactory     *factory);
+void                    gtk_list_item_widget_set_recycled       (GtkListItemWidget      *self,
+                                                                 gboolean                recycled);
 void                    gtk_list_item_widget_set_single_click_activate
                                                                 (GtkListItemWidget     *self,
                                                                  gboolean               single_click_activate);
@@ -631,7 +631,7 @@ gtk_list_store_get_iter (GtkTreeModel *tree_model,
 
   i = gtk_tree_path_get_indices (path)[0];
 
-  if (i >= g_sequence_get_length (seq))
+  if (i >= priv->length)
     {
       iter->stamp = 0;
       return FALSE;
@@ -770,7 +770,7 @@ gtk_list_store_iter_n_children (GtkTreeModel *tree_model,
   GtkListStorePrivate *priv = list_store->priv;
 
   if (iter == NULL)
-    return g_sequence_get_length (priv->seq);
+    return priv->length;
 
   g_return_val_if_fail (priv->stamp == iter->stamp, -1);
 
@@ -1229,6 +1229,37 @@ gtk_list_store_remove (GtkListStore *list_store,
     }
 }
 
+/* Adds an empty row without emitting any signal. Finding the position
+ * in the sequence is the expensive part, so appending, which is by far
+ * the most common case when filling a store, avoids it.
+ */
+static void
+gtk_list_store_insert_row (GtkListStore *list_store,
+                           GtkTreeIter  *iter,
+                           int          *position)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+  GSequenceIter *ptr;
+
+  priv->columns_dirty = TRUE;
+
+  if (*position > priv->length || *position < 0)
+    *position = priv->length;
+
+  if (*position == priv->length)
+    ptr = g_sequence_get_end_iter (priv->seq);
+  else
+    ptr = g_sequence_get_iter_at_pos (priv->seq, *position);
+  ptr = g_sequence_insert_before (ptr, NULL);
+
+  iter->stamp = priv->stamp;
+  iter->user_data = ptr;
+
+  g_assert (iter_is_valid (iter, list_store));
+
+  priv->length++;
+}
+
 /**
  * gtk_list_store_insert:
  * @list_store: A `GtkListStore`
@@ -1247,35 +1278,13 @@ gtk_list_store_insert (GtkListStore *list_store,
 		       GtkTreeIter  *iter,
 		       int           position)
 {
-  GtkListStorePrivate *priv;
   GtkTreePath *path;
-  GSequence *seq;
-  GSequenceIter *ptr;
-  int length;
 
   g_return_if_fail (GTK_IS_LIST_STORE (list_store));
   g_return_if_fail (iter != NULL);
 
-  priv = list_store->priv;
-
-  priv->columns_dirty = TRUE;
-
-  seq = priv->seq;
-
-  length = g_sequence_get_length (seq);
-  if (position > length || position < 0)
-    position = length;
-
-  ptr = g_sequence_get_iter_at_pos (seq, position);
-  ptr = g_sequence_insert_before (ptr, NULL);
+  gtk_list_store_insert_row (list_store, iter, &position);
 
-  iter->stamp = priv->stamp;
-  iter->user_data = ptr;
-
-  g_assert (iter_is_valid (iter, list_store));
-
-  priv->length++;
-  
   path = gtk_tree_path_new ();
   gtk_tree_path_append_index (path, position);
   gtk_tree_model_row_inserted (GTK_TREE_MODEL (list_store), path, iter);
@@ -1423,7 +1432,7 @@ gtk_list_store_clear (GtkListStore *list_store)
 
   priv = list_store->priv;
 
-  while (g_sequence_get_length (priv->seq) > 0)
+  while (priv->length > 0)
     {
       iter.stamp = priv->stamp;
       iter.user_data = g_sequence_get_begin_iter (priv->seq);
@@ -1706,8 +1715,8 @@ gtk_list_store_reorder (GtkListStore *store,
 
   priv = store->priv;
 
-  order = g_new (int, g_sequence_get_length (priv->seq));
-  for (i = 0; i < g_sequence_get_length (priv->seq); i++)
+  order = g_new (int, priv->length);
+  for (i = 0; i < priv->length; i++)
     order[new_order[i]] = i;
   
   new_positions = g_hash_table_new (g_direct_hash, g_direct_equal);
@@ -2193,12 +2202,8 @@ gtk_list_store_insert_with_values (GtkListStore *list_store,
 				   int           position,
 				   ...)
 {
-  GtkListStorePrivate *priv;
   GtkTreePath *path;
-  GSequence *seq;
-  GSequenceIter *ptr;
   GtkTreeIter tmp_iter;
-  int length;
   gboolean changed = FALSE;
   gboolean maybe_need_sort = FALSE;
   va_list var_args;
@@ -2206,28 +2211,10 @@ gtk_list_store_insert_with_values (GtkListStore *list_store,
   /* FIXME: refactor to reduce overlap with gtk_list_store_set() */
   g_return_if_fail (GTK_IS_LIST_STORE (list_store));
 
-  priv = list_store->priv;
-
   if (!iter)
     iter = &tmp_iter;
 
-  priv->columns_dirty = TRUE;
-
-  seq = priv->seq;
-
-  length = g_sequence_get_length (seq);
-  if (position > length || position < 0)
-    position = length;
-
-  ptr = g_sequence_get_iter_at_pos (seq, position);
-  ptr = g_sequence_insert_before (ptr, NULL);
-
-  iter->stamp = priv->stamp;
-  iter->user_data = ptr;
-
-  g_assert (iter_is_valid (iter, list_store));
-
-  priv->length++;
+  gtk_list_store_insert_row (list_store, iter, &position);
 
   va_start (var_args, position);
   gtk_list_store_set_valist_internal (list_store, iter, 
@@ -2237,12 +2224,15 @@ gtk_list_store_insert_with_values (GtkListStore *list_store,
 
   /* Don't emit rows_reordered here */
   if (maybe_need_sort && GTK_LIST_STORE_IS_SORTED (list_store))
-    g_sequence_sort_changed_iter (iter->user_data,
-				  gtk_list_store_compare_func,
-				  list_store);
+    {
+      g_sequence_sort_changed_iter (iter->user_data,
+                                    gtk_list_store_compare_func,
+                                    list_store);
+      position = g_sequence_iter_get_position (iter->user_data);
+    }
 
   /* Just emit row_inserted */
-  path = gtk_list_store_get_path (GTK_TREE_MODEL (list_store), iter);
+  path = gtk_tree_path_new_from_indices (position, -1);
   gtk_tree_model_row_inserted (GTK_TREE_MODEL (list_store), path, iter);
   gtk_tree_path_free (path);
 }
@@ -2271,12 +2261,8 @@ gtk_list_store_insert_with_valuesv (GtkListStore *list_store,
 				    GValue       *values,
 				    int           n_values)
 {
-  GtkListStorePrivate *priv;
   GtkTreePath *path;
-  GSequence *seq;
-  GSequenceIter *ptr;
   GtkTreeIter tmp_iter;
-  int length;
   gboolean changed = FALSE;
   gboolean maybe_need_sort = FALSE;
 
@@ -2285,28 +2271,10 @@ gtk_list_store_insert_with_valuesv (GtkListStore *list_store,
    */
   g_return_if_fail (GTK_IS_LIST_STORE (list_store));
 
-  priv = list_store->priv;
-
   if (!iter)
     iter = &tmp_iter;
 
-  priv->columns_dirty = TRUE;
-
-  seq = priv->seq;
-
-  length = g_sequence_get_length (seq);
-  if (position > length || position < 0)
-    position = length;
-
-  ptr = g_sequence_get_iter_at_pos (seq, position);
-  ptr = g_sequence_insert_before (ptr, NULL);
-
-  iter->stamp = priv->stamp;
-  iter->user_data = ptr;
-
-  g_assert (iter_is_valid (iter, list_store));
-
-  priv->length++;  
+  gtk_list_store_insert_row (list_store, iter, &position);
 
   gtk_list_store_set_vector_internal (list_store, iter,
 				      &changed, &maybe_need_sort,
@@ -2314,12 +2282,15 @@ gtk_list_store_insert_with_valuesv (GtkListStore *list_store,
 
   /* Don't emit rows_reordered here */
   if (maybe_need_sort && GTK_LIST_STORE_IS_SORTED (list_store))
-    g_sequence_sort_changed_iter (iter->user_data,
-				  gtk_list_store_compare_func,
-				  list_store);
+    {
+      g_sequence_sort_changed_iter (iter->user_data,
+                                    gtk_list_store_compare_func,
+                                    list_store);
+      position = g_sequence_iter_get_position (iter->user_data);
+    }
 
   /* Just emit row_inserted */
-  path = gtk_list_store_get_path (GTK_TREE_MODEL (list_store), iter);
+  path = gtk_tree_path_new_from_indices (position, -1);
   gtk_tree_model_row_inserted (GTK_TREE_MODEL (list_store), path, iter);
   gtk_tree_path_free (path);
 }
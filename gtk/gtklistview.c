@@ -148,7 +148,7 @@ typedef struct _ListRowAugment ListRowAugment;
 struct _ListRow
 {
   GtkListItemManagerItem parent;
-  guint height; /* per row */
+  guint height; /* total, for all items in the row */
 };
 
 struct _ListRowAugment
@@ -213,7 +213,7 @@ list_row_augment (GtkRbTree *tree,
 
   gtk_list_item_manager_augment_node (tree, node_augment, node, left, right);
 
-  aug->height = row->height * row->parent.n_items;
+  aug->height = row->height;
 
   if (left)
     {
@@ -253,9 +253,9 @@ gtk_list_view_get_row_at_y (GtkListView *self,
           y -= aug->height;
         }
 
-      if (y < row->height * row->parent.n_items)
+      if (y < row->height)
         break;
-      y -= row->height * row->parent.n_items;
+      y -= row->height;
 
       row = gtk_rb_tree_node_get_right (row);
     }
@@ -295,7 +295,7 @@ list_row_get_y (GtkListView *self,
               ListRowAugment *aug = gtk_list_item_manager_get_item_augment (self->item_manager, left);
               y += aug->height;
             }
-          y += parent->height * parent->parent.n_items;
+          y += parent->height;
         }
 
       row = parent;
@@ -304,6 +304,32 @@ list_row_get_y (GtkListView *self,
   return y ;
 }
 
+/* Rows without a widget can stand for many items of different
+ * estimated heights, so only their total height is known. Items
+ * inside such a row are spread evenly over it.
+ */
+static int
+list_row_get_item_offset (ListRow *row,
+                          guint    idx)
+{
+  return (guint64) idx * row->height / row->parent.n_items;
+}
+
+static guint
+list_row_get_item_at_offset (ListRow *row,
+                             int      offset)
+{
+  guint idx;
+
+  idx = (guint64) offset * row->parent.n_items / row->height;
+  /* rounding may leave us one item short */
+  while (idx + 1 < row->parent.n_items &&
+         list_row_get_item_offset (row, idx + 1) <= offset)
+    idx++;
+
+  return idx;
+}
+
 static int
 gtk_list_view_get_list_height (GtkListView *self)
 {
@@ -340,12 +366,12 @@ gtk_list_view_get_allocation_along (GtkListBase *base,
     }
 
   y = list_row_get_y (self, row);
-  y += skip * row->height;
+  y += list_row_get_item_offset (row, skip);
 
   if (offset)
     *offset = y;
   if (size)
-    *size = row->height;
+    *size = list_row_get_item_offset (row, skip + 1) - list_row_get_item_offset (row, skip);
 
   return TRUE;
 }
@@ -421,6 +447,7 @@ gtk_list_view_get_position_from_allocation (GtkListBase           *base,
   GtkListView *self = GTK_LIST_VIEW (base);
   ListRow *row;
   int remaining;
+  guint skip;
 
   if (across >= self->list_width)
     return FALSE;
@@ -430,15 +457,16 @@ gtk_list_view_get_position_from_allocation (GtkListBase           *base,
     return FALSE;
 
   *pos = gtk_list_item_manager_get_item_position (self->item_manager, row);
-  g_assert (remaining < row->height * row->parent.n_items);
-  *pos += remaining / row->height;
+  g_assert (remaining < row->height);
+  skip = list_row_get_item_at_offset (row, remaining);
+  *pos += skip;
 
   if (area)
     {
       area->x = 0;
       area->width = self->list_width;
-      area->y = along - remaining % row->height;
-      area->height = row->height;
+      area->y = along - remaining + list_row_get_item_offset (row, skip);
+      area->height = list_row_get_item_offset (row, skip + 1) - list_row_get_item_offset (row, skip);
     }
 
   return TRUE;
@@ -520,6 +548,39 @@ gtk_list_view_measure_list (GtkWidget      *widget,
   GArray *min_heights, *nat_heights;
   guint n_unknown;
 
+  if (self->estimate_func)
+    {
+      guint pos = 0;
+
+      min = 0;
+      nat = 0;
+      for (row = gtk_list_item_manager_get_first (self->item_manager);
+           row != NULL;
+           row = gtk_rb_tree_node_get_next (row))
+        {
+          if (row->parent.widget)
+            {
+              gtk_widget_measure (row->parent.widget,
+                                  orientation, for_size,
+                                  &child_min, &child_nat, NULL, NULL);
+              min += child_min;
+              nat += child_nat;
+            }
+          else if (row->parent.n_items)
+            {
+              int estimate = self->estimate_func (self, pos, row->parent.n_items, for_size, self->estimate_data);
+
+              min += MAX (estimate, 0);
+              nat += MAX (estimate, 0);
+            }
+          pos += row->parent.n_items;
+        }
+
+      *minimum = min;
+      *natural = nat;
+      return;
+    }
+
   min_heights = g_array_new (FALSE, FALSE, sizeof (int));
   nat_heights = g_array_new (FALSE, FALSE, sizeof (int));
   n_unknown = 0;
@@ -585,6 +646,7 @@ gtk_list_view_size_allocate (GtkWidget *widget,
   ListRow *row;
   GArray *heights;
   int min, nat, row_height;
+  guint pos;
   int x, y;
   GtkOrientation orientation, opposite_orientation;
   GtkScrollablePolicy scroll_policy, opposite_scroll_policy;
@@ -634,19 +696,35 @@ gtk_list_view_size_allocate (GtkWidget *widget,
     }
 
   /* step 3: determine height of unknown items */
-  row_height = gtk_list_view_get_unknown_row_height (self, heights);
+  if (heights->len > 0)
+    row_height = gtk_list_view_get_unknown_row_height (self, heights);
+  else
+    row_height = 0;
   g_array_free (heights, TRUE);
 
+  pos = 0;
   for (row = gtk_list_item_manager_get_first (self->item_manager);
        row != NULL;
        row = gtk_rb_tree_node_get_next (row))
     {
+      guint estimate;
+
+      pos += row->parent.n_items;
       if (row->parent.widget)
         continue;
 
-      if (row->height != row_height)
+      if (self->estimate_func && row->parent.n_items)
+        estimate = MAX (0, self->estimate_func (self,
+                                                pos - row->parent.n_items,
+                                                row->parent.n_items,
+                                                self->list_width,
+                                                self->estimate_data));
+      else
+        estimate = row_height * row->parent.n_items;
+
+      if (row->height != estimate)
         {
-          row->height = row_height;
+          row->height = estimate;
           gtk_rb_tree_node_mark_dirty (row);
         }
     }
@@ -677,7 +755,7 @@ gtk_list_view_size_allocate (GtkWidget *widget,
                                              row->height);
         }
 
-      y += row->height * row->parent.n_items;
+      y += row->height;
     }
 
   gtk_list_base_allocate_rubberband (GTK_LIST_BASE (self));
@@ -690,6 +768,12 @@ gtk_list_view_dispose (GObject *object)
 
   self->item_manager = NULL;
 
+  if (self->estimate_destroy)
+    self->estimate_destroy (self->estimate_data);
+  self->estimate_func = NULL;
+  self->estimate_data = NULL;
+  self->estimate_destroy = NULL;
+
   G_OBJECT_CLASS (gtk_list_view_parent_class)->dispose (object);
 }
 
@@ -1161,3 +1245,46 @@ gtk_list_view_get_enable_rubberband (GtkListView *self)
 
   return gtk_list_base_get_enable_rubberband (GTK_LIST_BASE (self));
 }
+
+/**
+ * gtk_list_view_set_height_estimate_func:
+ * @self: a `GtkListView`
+ * @func: (nullable): function to estimate the height of items
+ * @user_data: (closure): user data for @func
+ * @destroy: destroy notifier for @user_data
+ *
+ * Sets a function to estimate the size of items that currently
+ * have no row widget.
+ *
+ * By default, @self assumes that all those items are as tall as the
+ * median of the rows it has created. For lists with rows of very
+ * different sizes, like chat histories, this makes the scrollbar
+ * change size whenever new rows come into view.
+ *
+ * @func is called with consecutive ranges of such items and should
+ * return the total size of all items in the range, in the direction
+ * of the list's orientation and for the given size in the opposite
+ * direction. It is called often, so it should be cheap; ideally it
+ * looks up precomputed sums instead of iterating the range.
+ *
+ * Call this function again whenever the result of @func changes.
+ *
+ * Since: 4.6
+ */
+void
+gtk_list_view_set_height_estimate_func (GtkListView             *self,
+                                        GtkListViewEstimateFunc  func,
+                                        gpointer                 user_data,
+                                        GDestroyNotify           destroy)
+{
+  g_return_if_fail (GTK_IS_LIST_VIEW (self));
+
+  if (self->estimate_destroy)
+    self->estimate_destroy (self->estimate_data);
+
+  self->estimate_func = func;
+  self->estimate_data = user_data;
+  self->estimate_destroy = destroy;
+
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+}
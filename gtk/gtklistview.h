@@ -38,6 +38,26 @@ G_BEGIN_DECLS
 typedef struct _GtkListView GtkListView;
 typedef struct _GtkListViewClass GtkListViewClass;
 
+/**
+ * GtkListViewEstimateFunc:
+ * @self: the `GtkListView`
+ * @position: the first item to estimate
+ * @n_items: the number of items to estimate
+ * @for_size: the size of the list in the opposite orientation
+ * @user_data: user data passed to gtk_list_view_set_height_estimate_func()
+ *
+ * Estimates the total size of @n_items items starting at @position.
+ *
+ * Returns: the estimated size, in pixels
+ *
+ * Since: 4.6
+ */
+typedef int (* GtkListViewEstimateFunc) (GtkListView *self,
+                                         guint        position,
+                                         guint        n_items,
+                                         int          for_size,
+                                         gpointer     user_data);
+
 GDK_AVAILABLE_IN_ALL
 GType           gtk_list_view_get_type                          (void) G_GNUC_CONST;
 
@@ -76,6 +96,12 @@ void            gtk_list_view_set_enable_rubberband             (GtkListView
 GDK_AVAILABLE_IN_ALL
 gboolean        gtk_list_view_get_enable_rubberband             (GtkListView            *self);
 
+GDK_AVAILABLE_IN_4_6
+void            gtk_list_view_set_height_estimate_func          (GtkListView            *self,
+                                                                 GtkListViewEstimateFunc func,
+                                                                 gpointer                user_data,
+                                                                 GDestroyNotify          destroy);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GtkListView, g_object_unref)
 
 G_END_DECLS
@@ -33,6 +33,10 @@ struct _GtkListView
   gboolean show_separators;
 
   int list_width;
+
+  GtkListViewEstimateFunc estimate_func;
+  gpointer estimate_data;
+  GDestroyNotify estimate_destroy;
 };
 
 struct _GtkListViewClass
@@ -53,7 +53,6 @@
 #include "gtkdebug.h"
 #include "gtkdropprivate.h"
 #include "gtkmain.h"
-#include "gtkmediafileprivate.h"
 #include "gtkmodulesprivate.h"
 #include "gtkprivate.h"
 #include "gtkrecentmanager.h"
@@ -62,8 +61,6 @@
 #include "gtkwidgetprivate.h"
 #include "gtkwindowprivate.h"
 #include "gtkwindowgroup.h"
-#include "gtkprintbackendprivate.h"
-#include "gtkimmoduleprivate.h"
 #include "gtkroot.h"
 #include "gtknative.h"
 #include "gtkpopcountprivate.h"
@@ -550,13 +547,9 @@ do_post_parse_initialization (void)
 
   gtk_initialized = TRUE;
 
-  before = GDK_PROFILER_CURRENT_TIME;
-#ifdef G_OS_UNIX
-  gtk_print_backends_init ();
-#endif
-  gtk_im_modules_init ();
-  gtk_media_file_extension_init ();
-  gdk_profiler_end_mark (before, "init modules", NULL);
+  /* IM, print and media modules are scanned on first use,
+   * see gtk_im_modules_init() and friends.
+   */
 
   before = GDK_PROFILER_CURRENT_TIME;
   display_manager = gdk_display_manager_get ();
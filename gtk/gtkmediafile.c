@@ -23,6 +23,7 @@
 
 #include "gtkdebug.h"
 #include "gtkintl.h"
+#include "gdk/gdkprofilerprivate.h"
 #include "gtkmodulesprivate.h"
 #include "gtknomediafileprivate.h"
 
@@ -192,6 +193,8 @@ gtk_media_file_get_extension (void)
 
   GTK_NOTE (MODULES, g_print ("Looking up MediaFile extension\n"));
 
+  gtk_media_file_extension_init ();
+
   ep = g_io_extension_point_lookup (GTK_MEDIA_FILE_EXTENSION_POINT_NAME);
   e = NULL;
 
@@ -608,10 +611,19 @@ gtk_media_file_get_input_stream (GtkMediaFile *self)
 void
 gtk_media_file_extension_init (void)
 {
+  static gboolean initialized = FALSE;
   GIOExtensionPoint *ep;
   GIOModuleScope *scope;
   char **paths;
   int i;
+  gint64 before G_GNUC_UNUSED;
+
+  if (initialized)
+    return;
+
+  initialized = TRUE;
+
+  before = GDK_PROFILER_CURRENT_TIME;
 
   GTK_NOTE (MODULES,
             g_print ("Registering extension point %s\n", GTK_MEDIA_FILE_EXTENSION_POINT_NAME));
@@ -647,4 +659,6 @@ gtk_media_file_extension_init (void)
                    g_type_name (g_io_extension_get_type (ext)));
         }
     }
+
+  gdk_profiler_end_mark (before, "init media modules", NULL);
 }
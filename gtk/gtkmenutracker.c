@@ -368,22 +368,25 @@ gtk_menu_tracker_add_items (GtkMenuTracker         *tracker,
            * anything other than lookups and for dropped the ref and
            * disconnecting the signal when we destroy the menu, and we
            * need to do exactly those things in this case as well.
+           * We also use it to update the item in place when the model
+           * changes, see gtk_menu_tracker_reuse_items().
            *
            * The only other thing that '->model' is used for is in the
            * case that we want to show a separator, but we will never do
            * that because separators are not shown for this fake section.
            */
+          GtkMenuTrackerSection *fake_section;
+
+          fake_section = g_slice_new0 (GtkMenuTrackerSection);
+          fake_section->is_fake = TRUE;
+          fake_section->model = g_object_ref (item);
+          *change_point = g_slist_prepend (*change_point, fake_section);
+
           if (gtk_menu_tracker_item_may_disappear (item))
             {
-              GtkMenuTrackerSection *fake_section;
-
-              fake_section = g_slice_new0 (GtkMenuTrackerSection);
-              fake_section->is_fake = TRUE;
-              fake_section->model = g_object_ref (item);
               fake_section->handler = g_signal_connect (item, "notify::is-visible",
                                                         G_CALLBACK (gtk_menu_tracker_item_visibility_changed),
                                                         tracker);
-              *change_point = g_slist_prepend (*change_point, fake_section);
 
               if (gtk_menu_tracker_item_get_is_visible (item))
                 {
@@ -393,12 +396,12 @@ gtk_menu_tracker_add_items (GtkMenuTracker         *tracker,
             }
           else
             {
-              /* In the normal case, we store NULL in the linked list.
-               * The measurement and lookup code count NULL always as
-               * exactly 1: an item that will always be there.
+              /* In the normal case, the item is always there. We still
+               * keep the fake section around, so that we can find the
+               * item again when the model changes and update it in place.
                */
               (* tracker->insert_func) (item, offset, tracker->user_data);
-              *change_point = g_slist_prepend (*change_point, NULL);
+              fake_section->items = g_slist_prepend (NULL, NULL);
             }
 
           g_object_unref (item);
@@ -406,6 +409,75 @@ gtk_menu_tracker_add_items (GtkMenuTracker         *tracker,
     }
 }
 
+static gboolean
+gtk_menu_tracker_reuse_item (GtkMenuTracker        *tracker,
+                             GtkMenuTrackerSection *subsection,
+                             GMenuModel            *model,
+                             int                    position)
+{
+  if (subsection == NULL || !subsection->is_fake)
+    return FALSE;
+
+  if (tracker->merge_sections)
+    {
+      GMenuModel *section;
+
+      section = g_menu_model_get_item_link (model, position, G_MENU_LINK_SECTION);
+      if (section != NULL)
+        {
+          g_object_unref (section);
+          return FALSE;
+        }
+    }
+
+  return _gtk_menu_tracker_item_update (subsection->model, model, position);
+}
+
+/* Models often replace items instead of changing them, for example
+ * when a label changes. Update the items at the start and end of the
+ * replaced range in place when we can, so that the consumer can keep
+ * the widgets for them, and shrink the range accordingly.
+ */
+static void
+gtk_menu_tracker_reuse_items (GtkMenuTracker   *tracker,
+                              GSList         ***change_point,
+                              int              *offset,
+                              GMenuModel       *model,
+                              int              *position,
+                              int              *removed,
+                              int              *added)
+{
+  GtkMenuTrackerSection **old;
+  GSList *l;
+  int i;
+
+  while (*removed > 0 && *added > 0 &&
+         gtk_menu_tracker_reuse_item (tracker, (**change_point)->data, model, *position))
+    {
+      *offset += gtk_menu_tracker_section_measure ((**change_point)->data);
+      *change_point = &(**change_point)->next;
+      (*position)++;
+      (*removed)--;
+      (*added)--;
+    }
+
+  if (*removed == 0 || *added == 0)
+    return;
+
+  old = g_new (GtkMenuTrackerSection *, *removed);
+  for (i = 0, l = **change_point; i < *removed; i++, l = l->next)
+    old[i] = l->data;
+
+  while (*removed > 0 && *added > 0 &&
+         gtk_menu_tracker_reuse_item (tracker, old[*removed - 1], model, *position + *added - 1))
+    {
+      (*removed)--;
+      (*added)--;
+    }
+
+  g_free (old);
+}
+
 static void
 gtk_menu_tracker_model_changed (GMenuModel *model,
                                 int         position,
@@ -437,6 +509,8 @@ gtk_menu_tracker_model_changed (GMenuModel *model,
       change_point = &(*change_point)->next;
     }
 
+  gtk_menu_tracker_reuse_items (tracker, &change_point, &offset, model, &position, &removed, &added);
+
   /* We remove items in order and add items in reverse order.  This
    * means that the offset used for all inserts and removes caused by a
    * single change will be the same.
@@ -463,7 +537,8 @@ gtk_menu_tracker_section_free (GtkMenuTrackerSection *section)
   if (section == NULL)
     return;
 
-  g_signal_handler_disconnect (section->model, section->handler);
+  if (section->handler)
+    g_signal_handler_disconnect (section->model, section->handler);
   g_slist_free_full (section->items, (GDestroyNotify) gtk_menu_tracker_section_free);
   g_free (section->action_namespace);
   g_object_unref (section->model);
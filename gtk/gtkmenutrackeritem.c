@@ -598,6 +598,124 @@ _gtk_menu_tracker_item_new (GtkActionObservable *observable,
   return self;
 }
 
+static gboolean
+attribute_equal (GMenuItem  *a,
+                 GMenuItem  *b,
+                 const char *attribute)
+{
+  GVariant *va, *vb;
+  gboolean equal;
+
+  va = g_menu_item_get_attribute_value (a, attribute, NULL);
+  vb = g_menu_item_get_attribute_value (b, attribute, NULL);
+
+  if (va == NULL || vb == NULL)
+    equal = va == vb;
+  else
+    equal = g_variant_equal (va, vb);
+
+  g_clear_pointer (&va, g_variant_unref);
+  g_clear_pointer (&vb, g_variant_unref);
+
+  return equal;
+}
+
+static gboolean
+link_equal (GMenuItem  *a,
+            GMenuItem  *b,
+            const char *link)
+{
+  GMenuModel *la, *lb;
+
+  la = g_menu_item_get_link (a, link);
+  lb = g_menu_item_get_link (b, link);
+
+  g_clear_object (&la);
+  g_clear_object (&lb);
+
+  return la == lb;
+}
+
+/* Attributes that can change without a new item being needed,
+ * together with the property that shows them
+ */
+static const struct {
+  const char *attribute;
+  guint prop;
+} mutable_attributes[] = {
+  { G_MENU_ATTRIBUTE_LABEL, PROP_LABEL },
+  { "use-markup", PROP_USE_MARKUP },
+  { G_MENU_ATTRIBUTE_ICON, PROP_ICON },
+  { "verb-icon", PROP_VERB_ICON },
+  { "accel", PROP_ACCEL },
+};
+
+/*< private >
+ * _gtk_menu_tracker_item_update:
+ * @self: a `GtkMenuTrackerItem`
+ * @model: the model that now contains the item
+ * @item_index: the index of the item in @model
+ *
+ * Tries to update @self in place to represent the item at @item_index
+ * in @model, notifying the properties that changed.
+ *
+ * This is only possible if the new item only differs in its label,
+ * icons or accelerator. Everything else, such as the action, target or
+ * links, requires a new item.
+ *
+ * Returns: %TRUE if @self was updated
+ */
+gboolean
+_gtk_menu_tracker_item_update (GtkMenuTrackerItem *self,
+                               GMenuModel         *model,
+                               int                 item_index)
+{
+  static const char * const fixed_attributes[] = {
+    G_MENU_ATTRIBUTE_ACTION,
+    G_MENU_ATTRIBUTE_TARGET,
+    G_MENU_ATTRIBUTE_ACTION_NAMESPACE,
+    "hidden-when",
+    "submenu-action",
+    "custom",
+    "display-hint",
+    "text-direction",
+    "x-gtk-private-special",
+  };
+  GMenuItem *item;
+  guint i;
+
+  item = g_menu_item_new_from_model (model, item_index);
+
+  if (!link_equal (self->item, item, G_MENU_LINK_SUBMENU) ||
+      !link_equal (self->item, item, G_MENU_LINK_SECTION))
+    goto out;
+
+  for (i = 0; i < G_N_ELEMENTS (fixed_attributes); i++)
+    {
+      if (!attribute_equal (self->item, item, fixed_attributes[i]))
+        goto out;
+    }
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  for (i = 0; i < G_N_ELEMENTS (mutable_attributes); i++)
+    {
+      if (!attribute_equal (self->item, item, mutable_attributes[i].attribute))
+        g_object_notify_by_pspec (G_OBJECT (self), gtk_menu_tracker_item_pspecs[mutable_attributes[i].prop]);
+    }
+
+  g_object_unref (self->item);
+  self->item = item;
+
+  g_object_thaw_notify (G_OBJECT (self));
+
+  return TRUE;
+
+out:
+  g_object_unref (item);
+  return FALSE;
+}
+
 GtkActionObservable *
 _gtk_menu_tracker_item_get_observable (GtkMenuTrackerItem *self)
 {
@@ -49,6 +49,10 @@ GtkMenuTrackerItem *   _gtk_menu_tracker_item_new                       (GtkActi
                                                                          const char          *action_namespace,
                                                                          gboolean             is_separator);
 
+gboolean               _gtk_menu_tracker_item_update                    (GtkMenuTrackerItem  *self,
+                                                                         GMenuModel          *model,
+                                                                         int                  item_index);
+
 const char *           gtk_menu_tracker_item_get_special               (GtkMenuTrackerItem *self);
 
 const char *           gtk_menu_tracker_item_get_custom                (GtkMenuTrackerItem *self);
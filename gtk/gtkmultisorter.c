@@ -19,7 +19,7 @@
 
 #include "config.h"
 
-#include "gtkmultisorter.h"
+#include "gtkmultisorterprivate.h"
 
 #include "gtkbuildable.h"
 #include "gtkintl.h"
@@ -33,6 +33,8 @@
 
 #include "gdk/gdkarrayimpl.c"
 
+#include <string.h>
+
 /**
  * GtkMultiSorter:
  *
@@ -56,12 +58,19 @@ struct _GtkMultiSortKey
 {
   gsize offset;
   GtkSortKeys *keys;
+  gboolean inverted;
 };
 
+/* If all keys can be packed, the key memory holds the packed keys
+ * one after another and is compared with a single memcmp().
+ * Otherwise it holds the keys themselves, properly aligned, and
+ * they are compared in turn.
+ */
 struct _GtkMultiSortKeys
 {
   GtkSortKeys parent_keys;
 
+  gsize max_key_size; /* largest key, for packing */
   guint n_keys;
   GtkMultiSortKey keys[];
 };
@@ -92,7 +101,7 @@ gtk_multi_sort_keys_compare (gconstpointer a,
                                                   ((const char *) a) + self->keys[i].offset,
                                                   ((const char *) b) + self->keys[i].offset);
       if (result != GTK_ORDERING_EQUAL)
-        return result;
+        return self->keys[i].inverted ? - result : result;
     }
 
   return GTK_ORDERING_EQUAL;
@@ -114,7 +123,8 @@ gtk_multi_sort_keys_is_compatible (GtkSortKeys *keys,
 
   for (i = 0; i < self->n_keys; i++)
     {
-      if (!gtk_sort_keys_is_compatible (self->keys[i].keys, compare->keys[i].keys))
+      if (self->keys[i].inverted != compare->keys[i].inverted ||
+          !gtk_sort_keys_is_compatible (self->keys[i].keys, compare->keys[i].keys))
         return FALSE;
     }
 
@@ -146,6 +156,21 @@ gtk_multi_sort_keys_clear_key (GtkSortKeys *keys,
     gtk_sort_keys_clear_key (self->keys[i].keys, key + self->keys[i].offset);
 }
 
+static gboolean
+gtk_multi_sort_keys_is_thread_safe (GtkSortKeys *keys)
+{
+  GtkMultiSortKeys *self = (GtkMultiSortKeys *) keys;
+  gsize i;
+
+  for (i = 0; i < self->n_keys; i++)
+    {
+      if (!gtk_sort_keys_is_thread_safe (self->keys[i].keys))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static const GtkSortKeysClass GTK_MULTI_SORT_KEYS_CLASS =
 {
   gtk_multi_sort_keys_free,
@@ -153,37 +178,156 @@ static const GtkSortKeysClass GTK_MULTI_SORT_KEYS_CLASS =
   gtk_multi_sort_keys_is_compatible,
   gtk_multi_sort_keys_init_key,
   gtk_multi_sort_keys_clear_key,
+  gtk_multi_sort_keys_is_thread_safe,
 };
 
-static GtkSortKeys *
-gtk_multi_sort_keys_new (GtkMultiSorter *self)
+static int
+gtk_packed_multi_sort_keys_compare (gconstpointer a,
+                                    gconstpointer b,
+                                    gpointer      data)
+{
+  GtkSortKeys *keys = data;
+  int result;
+
+  result = memcmp (a, b, keys->key_size);
+  if (result < 0)
+    return GTK_ORDERING_SMALLER;
+  else if (result > 0)
+    return GTK_ORDERING_LARGER;
+  else
+    return GTK_ORDERING_EQUAL;
+}
+
+static void
+gtk_multi_sort_keys_pack_part (GtkMultiSortKey *part,
+                               gconstpointer    key_memory,
+                               guchar          *packed)
+{
+  gsize i;
+
+  gtk_sort_keys_pack_key (part->keys, key_memory, packed);
+
+  if (part->inverted)
+    {
+      for (i = 0; i < gtk_sort_keys_get_key_size (part->keys); i++)
+        packed[i] = ~packed[i];
+    }
+}
+
+static void
+gtk_packed_multi_sort_keys_init_key (GtkSortKeys *keys,
+                                     gpointer     item,
+                                     gpointer     key_memory)
+{
+  GtkMultiSortKeys *self = (GtkMultiSortKeys *) keys;
+  guchar *packed = key_memory;
+  gpointer tmp;
+  gsize i;
+
+  /* g_alloca() memory is aligned for any key */
+  tmp = g_alloca (MAX (self->max_key_size, 1));
+
+  for (i = 0; i < self->n_keys; i++)
+    {
+      gtk_sort_keys_init_key (self->keys[i].keys, item, tmp);
+      gtk_multi_sort_keys_pack_part (&self->keys[i], tmp, packed + self->keys[i].offset);
+      gtk_sort_keys_clear_key (self->keys[i].keys, tmp);
+    }
+}
+
+static void
+gtk_packed_multi_sort_keys_pack_key (GtkSortKeys   *keys,
+                                     gconstpointer  key_memory,
+                                     guchar        *packed)
+{
+  memcpy (packed, key_memory, keys->key_size);
+}
+
+static const GtkSortKeysClass GTK_PACKED_MULTI_SORT_KEYS_CLASS =
+{
+  gtk_multi_sort_keys_free,
+  gtk_packed_multi_sort_keys_compare,
+  gtk_multi_sort_keys_is_compatible,
+  gtk_packed_multi_sort_keys_init_key,
+  NULL,
+  gtk_sort_keys_always_thread_safe,
+  gtk_packed_multi_sort_keys_pack_key
+};
+
+/*<private>
+ * gtk_multi_sort_keys_new_for_sorters:
+ * @sorters: (array length=n_sorters): the sorters to combine
+ * @inverted: (array length=n_sorters) (nullable): which sorters
+ *   to sort in reverse
+ * @n_sorters: the number of sorters
+ *
+ * Creates sort keys that sort like the given sorters tried in turn.
+ *
+ * If all sorters provide keys that can be packed, the combined key
+ * is a single byte string that is compared with memcmp().
+ *
+ * Returns: (transfer full): the new sort keys
+ */
+GtkSortKeys *
+gtk_multi_sort_keys_new_for_sorters (GtkSorter      **sorters,
+                                     const gboolean  *inverted,
+                                     gsize            n_sorters)
 {
   GtkMultiSortKeys *result;
   GtkSortKeys *keys;
+  gboolean packed;
   gsize i;
 
-  if (gtk_sorters_get_size (&self->sorters) == 0)
+  if (n_sorters == 0)
     return gtk_sort_keys_new_equal ();
-  else if (gtk_sorters_get_size (&self->sorters) == 1)
-    return gtk_sorter_get_keys (gtk_sorters_get (&self->sorters, 0));
+  else if (n_sorters == 1 && (inverted == NULL || !inverted[0]))
+    return gtk_sorter_get_keys (sorters[0]);
 
   keys = gtk_sort_keys_alloc (&GTK_MULTI_SORT_KEYS_CLASS,
-                              sizeof (GtkMultiSortKeys) + gtk_sorters_get_size (&self->sorters) * sizeof (GtkMultiSortKey),
+                              sizeof (GtkMultiSortKeys) + n_sorters * sizeof (GtkMultiSortKey),
                               0, 1);
   result = (GtkMultiSortKeys *) keys;
 
-  result->n_keys = gtk_sorters_get_size (&self->sorters);
+  result->n_keys = n_sorters;
+  packed = TRUE;
   for (i = 0; i < result->n_keys; i++)
     {
-      result->keys[i].keys = gtk_sorter_get_keys (gtk_sorters_get (&self->sorters, i));
-      result->keys[i].offset = GTK_SORT_KEYS_ALIGN (keys->key_size, gtk_sort_keys_get_key_align (result->keys[i].keys));
-      keys->key_size = result->keys[i].offset + gtk_sort_keys_get_key_size (result->keys[i].keys);
-      keys->key_align = MAX (keys->key_align, gtk_sort_keys_get_key_align (result->keys[i].keys));
+      result->keys[i].keys = gtk_sorter_get_keys (sorters[i]);
+      result->keys[i].inverted = inverted ? inverted[i] : FALSE;
+      result->max_key_size = MAX (result->max_key_size, gtk_sort_keys_get_key_size (result->keys[i].keys));
+      packed &= gtk_sort_keys_can_pack (result->keys[i].keys);
+    }
+
+  if (packed)
+    {
+      keys->klass = &GTK_PACKED_MULTI_SORT_KEYS_CLASS;
+      for (i = 0; i < result->n_keys; i++)
+        {
+          result->keys[i].offset = keys->key_size;
+          keys->key_size += gtk_sort_keys_get_key_size (result->keys[i].keys);
+        }
+    }
+  else
+    {
+      for (i = 0; i < result->n_keys; i++)
+        {
+          result->keys[i].offset = GTK_SORT_KEYS_ALIGN (keys->key_size, gtk_sort_keys_get_key_align (result->keys[i].keys));
+          keys->key_size = result->keys[i].offset + gtk_sort_keys_get_key_size (result->keys[i].keys);
+          keys->key_align = MAX (keys->key_align, gtk_sort_keys_get_key_align (result->keys[i].keys));
+        }
     }
 
   return keys;
 }
 
+static GtkSortKeys *
+gtk_multi_sort_keys_new (GtkMultiSorter *self)
+{
+  return gtk_multi_sort_keys_new_for_sorters (gtk_sorters_get_data (&self->sorters),
+                                              NULL,
+                                              gtk_sorters_get_size (&self->sorters));
+}
+
 static GType
 gtk_multi_sorter_get_item_type (GListModel *list)
 {
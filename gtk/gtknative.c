@@ -24,6 +24,7 @@
 #include "gtkintl.h"
 #include "gtkcssnodeprivate.h"
 
+#include "gdk/gdkframeclockprivate.h"
 #include "gdk/gdksurfaceprivate.h"
 
 typedef struct _GtkNativePrivate
@@ -94,7 +95,13 @@ frame_clock_update_cb (GdkFrameClock *clock,
                        GtkNative     *native)
 {
   if (GTK_IS_ROOT (native))
-    gtk_css_node_validate (gtk_widget_get_css_node (GTK_WIDGET (native)));
+    {
+      gint64 before = _gdk_frame_clock_begin_span (clock);
+
+      gtk_css_node_validate (gtk_widget_get_css_node (GTK_WIDGET (native)));
+
+      _gdk_frame_clock_end_span (clock, GDK_FRAME_SPAN_STYLE, before);
+    }
 }
 
 static void
@@ -111,8 +118,13 @@ surface_layout_cb (GdkSurface *surface,
                    int         height,
                    GtkNative  *native)
 {
+  GdkFrameClock *clock = gdk_surface_get_frame_clock (surface);
+  gint64 before = _gdk_frame_clock_begin_span (clock);
+
   gtk_native_layout (native, width, height);
 
+  _gdk_frame_clock_end_span (clock, GDK_FRAME_SPAN_LAYOUT, before);
+
   if (gtk_widget_needs_allocate (GTK_WIDGET (native)))
     gtk_native_queue_relayout (native);
 }
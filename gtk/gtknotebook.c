@@ -30,6 +30,7 @@
 #include "gtkbox.h"
 #include "gtkboxlayout.h"
 #include "gtkbuildable.h"
+#include "gtkbuilderprivate.h"
 #include "gtkbutton.h"
 #include "gtkdroptarget.h"
 #include "gtkdragicon.h"
@@ -47,6 +48,7 @@
 #include "gtksizerequest.h"
 #include "gtkstylecontextprivate.h"
 #include "gtkprivate.h"
+#include "gtksettingsprivate.h"
 #include "gtkstack.h"
 #include "gtktypebuiltins.h"
 #include "gtkwidgetprivate.h"
@@ -104,6 +106,21 @@
  * </object>
  * ```
  *
+ * A `GtkNotebookPage` can wrap its child in a `<lazy>` element
+ * instead of setting the child property. The child is then only
+ * built when the page is first switched to:
+ *
+ * ```xml
+ * <object class="GtkNotebookPage">
+ *   <property name="tab-label">Rarely used</property>
+ *   <lazy>
+ *     <object class="GtkLabel">
+ *       <property name="label">Content</property>
+ *     </object>
+ *   </lazy>
+ * </object>
+ * ```
+ *
  * # CSS nodes
  *
  * ```
@@ -390,7 +407,59 @@ struct _GtkNotebookPageClass
   GObjectClass parent_class;
 };
 
-G_DEFINE_TYPE (GtkNotebookPage, gtk_notebook_page, G_TYPE_OBJECT)
+static gboolean
+gtk_notebook_page_buildable_custom_tag_start (GtkBuildable       *buildable,
+                                              GtkBuilder         *builder,
+                                              GObject            *child,
+                                              const char         *tagname,
+                                              GtkBuildableParser *parser,
+                                              gpointer           *parser_data)
+{
+  if (strcmp (tagname, "lazy") == 0)
+    {
+      _gtk_builder_lazy_tag_start (builder, parser, parser_data);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+gtk_notebook_page_buildable_custom_tag_end (GtkBuildable *buildable,
+                                            GtkBuilder   *builder,
+                                            GObject      *child,
+                                            const char   *tagname,
+                                            gpointer      parser_data)
+{
+  GtkNotebookPage *page = GTK_NOTEBOOK_PAGE (buildable);
+  GtkWidget *widget;
+
+  if (strcmp (tagname, "lazy") != 0)
+    return;
+
+  widget = _gtk_builder_lazy_tag_end (builder, parser_data);
+  if (widget == NULL)
+    return;
+
+  if (page->child == NULL)
+    page->child = widget;
+  else
+    {
+      g_warning ("GtkNotebookPage already has a child, ignoring <lazy>");
+      g_object_unref (widget);
+    }
+}
+
+static void
+gtk_notebook_page_buildable_init (GtkBuildableIface *iface)
+{
+  iface->custom_tag_start = gtk_notebook_page_buildable_custom_tag_start;
+  iface->custom_tag_end = gtk_notebook_page_buildable_custom_tag_end;
+}
+
+G_DEFINE_TYPE_WITH_CODE (GtkNotebookPage, gtk_notebook_page, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE,
+                                                gtk_notebook_page_buildable_init))
 
 static void
 gtk_notebook_page_init (GtkNotebookPage *page)
@@ -2946,7 +3015,7 @@ check_threshold (GtkNotebook *notebook,
   GtkSettings *settings;
 
   settings = gtk_widget_get_settings (GTK_WIDGET (notebook));
-  g_object_get (G_OBJECT (settings), "gtk-dnd-drag-threshold", &dnd_threshold, NULL);
+  dnd_threshold = gtk_settings_get_dnd_drag_threshold (settings);
 
   /* we want a large threshold */
   dnd_threshold *= DND_THRESHOLD_MULTIPLIER;
@@ -5492,8 +5561,12 @@ gtk_notebook_real_switch_page (GtkNotebook     *notebook,
 
   update_arrow_state (notebook);
 
-  gtk_widget_queue_resize (GTK_WIDGET (notebook));
-  gtk_widget_queue_resize (notebook->tabs_widget);
+  /* Switching pages does not change the size of any tab, and the
+   * stack takes care of its own size request. Only the tab strip
+   * needs a new layout to scroll the current tab into view, so
+   * avoid remeasuring all tabs of notebooks with many pages.
+   */
+  gtk_widget_queue_allocate (notebook->tabs_widget);
   g_object_notify_by_pspec (G_OBJECT (notebook), properties[PROP_PAGE]);
 }
 
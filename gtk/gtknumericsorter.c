@@ -26,6 +26,7 @@
 #include "gtktypebuiltins.h"
 
 #include <math.h>
+#include <string.h>
 
 /**
  * GtkNumericSorter:
@@ -131,6 +132,67 @@ gtk_ ## type ## _sort_keys_compare_ ## name (gconstpointer a, \
   FLOAT_COMPARE_FUNC(type, ascending, a, b) \
   FLOAT_COMPARE_FUNC(type, descending, b, a)
 
+/* Packed keys are big endian with the sign bit flipped, so memcmp()
+ * sorts them like the numbers. Descending keys are inverted.
+ */
+static inline void
+gtk_numeric_sort_keys_pack (guint64  value,
+                            gsize    size,
+                            guchar  *packed)
+{
+  gsize i;
+
+  for (i = 0; i < size; i++)
+    packed[i] = value >> ((size - 1 - i) * 8);
+}
+
+#define PACK_FUNC(type, name, is_signed, invert) \
+static void \
+gtk_ ## type ## _sort_keys_pack_ ## name (GtkSortKeys   *keys, \
+                                          gconstpointer  key_memory, \
+                                          guchar        *packed) \
+{ \
+  guint64 value = (guint64) *(const type *) key_memory; \
+\
+  if (is_signed) \
+    value ^= G_GUINT64_CONSTANT (1) << (sizeof (type) * 8 - 1); \
+\
+  gtk_numeric_sort_keys_pack (invert ? ~value : value, sizeof (type), packed); \
+}
+#define PACK_FUNCS(type, is_signed) \
+  PACK_FUNC(type, ascending, is_signed, FALSE) \
+  PACK_FUNC(type, descending, is_signed, TRUE)
+
+/* Floats get all bits flipped when negative and only the sign bit
+ * flipped otherwise. NaNs are made equal and sort last, like in the
+ * compare functions, and -0.0 is made equal to 0.0.
+ */
+#define FLOAT_PACK_FUNC(type, bits_type, nan_bits, name, invert) \
+static void \
+gtk_ ## type ## _sort_keys_pack_ ## name (GtkSortKeys   *keys, \
+                                          gconstpointer  key_memory, \
+                                          guchar        *packed) \
+{ \
+  type num = *(const type *) key_memory; \
+  bits_type bits; \
+\
+  if (num == 0) \
+    num = 0; \
+  memcpy (&bits, &num, sizeof (type)); \
+  if (isnan (num)) \
+    bits = nan_bits; \
+\
+  if (bits >> (sizeof (type) * 8 - 1)) \
+    bits = ~bits; \
+  else \
+    bits |= (bits_type) 1 << (sizeof (type) * 8 - 1); \
+\
+  gtk_numeric_sort_keys_pack (invert ? ~(guint64) bits : bits, sizeof (type), packed); \
+}
+#define FLOAT_PACK_FUNCS(type, bits_type, nan_bits) \
+  FLOAT_PACK_FUNC(type, bits_type, nan_bits, ascending, FALSE) \
+  FLOAT_PACK_FUNC(type, bits_type, nan_bits, descending, TRUE)
+
 COMPARE_FUNCS(char)
 COMPARE_FUNCS(guchar)
 COMPARE_FUNCS(int)
@@ -142,6 +204,17 @@ COMPARE_FUNCS(gulong)
 COMPARE_FUNCS(gint64)
 COMPARE_FUNCS(guint64)
 
+PACK_FUNCS(char, CHAR_MIN < 0)
+PACK_FUNCS(guchar, FALSE)
+PACK_FUNCS(int, TRUE)
+PACK_FUNCS(guint, FALSE)
+FLOAT_PACK_FUNCS(float, guint32, 0x7fc00000)
+FLOAT_PACK_FUNCS(double, guint64, G_GUINT64_CONSTANT (0x7ff8000000000000))
+PACK_FUNCS(long, TRUE)
+PACK_FUNCS(gulong, FALSE)
+PACK_FUNCS(gint64, TRUE)
+PACK_FUNCS(guint64, FALSE)
+
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 
 #define NUMERIC_SORT_KEYS(TYPE, key_type, type, default_value) \
@@ -172,7 +245,9 @@ static const GtkSortKeysClass GTK_ASCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
   gtk_ ## key_type ## _sort_keys_compare_ascending, \
   gtk_ ## type ## _sort_keys_is_compatible, \
   gtk_ ## type ## _sort_keys_init_key, \
-  NULL \
+  NULL, \
+  gtk_sort_keys_always_thread_safe, \
+  gtk_ ## key_type ## _sort_keys_pack_ascending \
 }; \
 \
 static const GtkSortKeysClass GTK_DESCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
@@ -181,7 +256,9 @@ static const GtkSortKeysClass GTK_DESCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
   gtk_ ## key_type ## _sort_keys_compare_descending, \
   gtk_ ## type ## _sort_keys_is_compatible, \
   gtk_ ## type ## _sort_keys_init_key, \
-  NULL \
+  NULL, \
+  gtk_sort_keys_always_thread_safe, \
+  gtk_ ## key_type ## _sort_keys_pack_descending \
 }; \
 \
 static gboolean \
@@ -361,6 +361,11 @@ gtk_pad_controller_class_init (GtkPadControllerClass *klass)
 
   controller_class->filter_event = gtk_pad_controller_filter_event;
   controller_class->handle_event = gtk_pad_controller_handle_event;
+  controller_class->event_types = GTK_EVENT_TYPE_BIT (GDK_PAD_BUTTON_PRESS) |
+                                  GTK_EVENT_TYPE_BIT (GDK_PAD_BUTTON_RELEASE) |
+                                  GTK_EVENT_TYPE_BIT (GDK_PAD_RING) |
+                                  GTK_EVENT_TYPE_BIT (GDK_PAD_STRIP) |
+                                  GTK_EVENT_TYPE_BIT (GDK_PAD_GROUP_MODE);
 
   object_class->set_property = gtk_pad_controller_set_property;
   object_class->get_property = gtk_pad_controller_get_property;
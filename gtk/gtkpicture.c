@@ -57,6 +57,10 @@
  * In this case, [ctor@Gtk.Picture.new_for_resource] and
  * [method@Gtk.Picture.set_resource] should be used.
  *
+ * Decoding large images can take a while. When showing many of them, for
+ * example in a grid of thumbnails, set [property@Gtk.Picture:load-async]
+ * so that files are decoded in a thread instead of blocking the main loop.
+ *
  * `GtkPicture` displays an image at its natural size. See [class@Gtk.Image]
  * if you want to display a fixed-size image, such as an icon.
  *
@@ -89,6 +93,7 @@ enum
   PROP_ALTERNATIVE_TEXT,
   PROP_KEEP_ASPECT_RATIO,
   PROP_CAN_SHRINK,
+  PROP_LOAD_ASYNC,
   NUM_PROPERTIES
 };
 
@@ -98,10 +103,21 @@ struct _GtkPicture
 
   GdkPaintable *paintable;
   GFile *file;
+  /* The size in device pixels that @file was loaded for,
+   * or 0 if it was loaded at full size */
+  int load_width;
+  int load_height;
+  guint reload_id;
+  /* Set while @file is being loaded in a thread */
+  GCancellable *cancellable;
 
   char *alternative_text;
   guint keep_aspect_ratio : 1;
   guint can_shrink : 1;
+  guint load_async : 1;
+  /* @file still needs loading once we're mapped */
+  guint load_pending : 1;
+  guint load_pending_at_size : 1;
 };
 
 struct _GtkPictureClass
@@ -223,6 +239,194 @@ gtk_picture_measure (GtkWidget      *widget,
     }
 }
 
+static void
+gtk_picture_cancel_load (GtkPicture *self)
+{
+  self->load_pending = FALSE;
+
+  if (self->cancellable)
+    {
+      g_cancellable_cancel (self->cancellable);
+      g_clear_object (&self->cancellable);
+    }
+}
+
+static void
+gtk_picture_load_done (GObject      *source,
+                       GAsyncResult *result,
+                       gpointer      data)
+{
+  GtkPicture *self = data;
+  GdkPaintable *paintable;
+  GError *error = NULL;
+
+  paintable = gdk_paintable_new_from_file_scaled_finish (result, &error);
+
+  /* A cancelled load has been replaced or will be restarted */
+  if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_clear_object (&self->cancellable);
+      gtk_picture_set_paintable (self, paintable);
+    }
+
+  g_clear_error (&error);
+  g_clear_object (&paintable);
+  g_object_unref (self);
+}
+
+static void
+gtk_picture_load_file (GtkPicture *self,
+                       gboolean    at_size)
+{
+  GtkWidget *widget = GTK_WIDGET (self);
+  GdkPaintable *paintable;
+  int scale;
+
+  g_clear_handle_id (&self->reload_id, g_source_remove);
+  gtk_picture_cancel_load (self);
+  self->load_width = 0;
+  self->load_height = 0;
+
+  if (self->file == NULL)
+    {
+      gtk_picture_set_paintable (self, NULL);
+      return;
+    }
+
+  scale = gtk_widget_get_scale_factor (widget);
+
+  /* If we already know our size, let the loader decode a smaller
+   * image. This is the common case for thumbnails in a grid.
+   */
+  if (at_size && gtk_widget_get_width (widget) > 0 && gtk_widget_get_height (widget) > 0)
+    {
+      self->load_width = gtk_widget_get_width (widget) * scale;
+      self->load_height = gtk_widget_get_height (widget) * scale;
+    }
+
+  if (self->load_async)
+    {
+      /* Show a placeholder of the right size for a new file.
+       * When reloading at a bigger size, keep showing the old
+       * paintable until the new one is ready.
+       */
+      if (at_size)
+        {
+          if (self->load_width)
+            paintable = gdk_paintable_new_empty (self->load_width / scale,
+                                                 self->load_height / scale);
+          else
+            paintable = NULL;
+
+          gtk_picture_set_paintable (self, paintable);
+          g_clear_object (&paintable);
+        }
+
+      /* Don't load pictures nobody can see, and wait for
+       * the size so we can decode a smaller image.
+       */
+      if (!gtk_widget_get_mapped (widget) ||
+          (at_size && self->load_width == 0))
+        {
+          self->load_pending = TRUE;
+          self->load_pending_at_size = at_size;
+          return;
+        }
+
+      self->cancellable = g_cancellable_new ();
+      gdk_paintable_new_from_file_scaled_async (self->file, scale,
+                                                self->load_width ? self->load_width : -1,
+                                                self->load_height ? self->load_height : -1,
+                                                self->cancellable,
+                                                gtk_picture_load_done,
+                                                g_object_ref (self));
+      return;
+    }
+
+  paintable = gdk_paintable_new_from_file_scaled (self->file, scale,
+                                                  self->load_width ? self->load_width : -1,
+                                                  self->load_height ? self->load_height : -1);
+
+  gtk_picture_set_paintable (self, paintable);
+  g_clear_object (&paintable);
+}
+
+static void
+gtk_picture_load_pending (GtkPicture *self)
+{
+  if (!self->load_pending)
+    return;
+
+  gtk_picture_load_file (self, self->load_pending_at_size);
+}
+
+static gboolean
+gtk_picture_reload (gpointer data)
+{
+  GtkPicture *self = data;
+
+  self->reload_id = 0;
+
+  /* Load at full size, so we only ever do this once */
+  gtk_picture_load_file (self, FALSE);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_picture_size_allocate (GtkWidget *widget,
+                           int        width,
+                           int        height,
+                           int        baseline)
+{
+  GtkPicture *self = GTK_PICTURE (widget);
+  int scale;
+
+  if (self->load_pending && gtk_widget_get_mapped (widget))
+    {
+      gtk_picture_load_pending (self);
+      return;
+    }
+
+  if (self->load_width == 0 || self->reload_id != 0)
+    return;
+
+  /* The file was loaded at reduced size, and we've grown since */
+  scale = gtk_widget_get_scale_factor (widget);
+  if (width * scale > self->load_width || height * scale > self->load_height)
+    self->reload_id = g_idle_add (gtk_picture_reload, self);
+}
+
+static void
+gtk_picture_map (GtkWidget *widget)
+{
+  GtkPicture *self = GTK_PICTURE (widget);
+
+  GTK_WIDGET_CLASS (gtk_picture_parent_class)->map (widget);
+
+  /* Without a size, wait for size_allocate() */
+  if (gtk_widget_get_width (widget) > 0 && gtk_widget_get_height (widget) > 0)
+    gtk_picture_load_pending (self);
+}
+
+static void
+gtk_picture_unmap (GtkWidget *widget)
+{
+  GtkPicture *self = GTK_PICTURE (widget);
+
+  /* Restart the load when we get mapped again */
+  if (self->cancellable)
+    {
+      gboolean at_size = self->load_width != 0;
+
+      gtk_picture_cancel_load (self);
+      self->load_pending = TRUE;
+      self->load_pending_at_size = at_size;
+    }
+
+  GTK_WIDGET_CLASS (gtk_picture_parent_class)->unmap (widget);
+}
+
 static void
 gtk_picture_set_property (GObject      *object,
                           guint         prop_id,
@@ -253,6 +457,10 @@ gtk_picture_set_property (GObject      *object,
       gtk_picture_set_can_shrink (self, g_value_get_boolean (value));
       break;
 
+    case PROP_LOAD_ASYNC:
+      gtk_picture_set_load_async (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -289,6 +497,10 @@ gtk_picture_get_property (GObject     *object,
       g_value_set_boolean (value, self->can_shrink);
       break;
 
+    case PROP_LOAD_ASYNC:
+      g_value_set_boolean (value, self->load_async);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -302,6 +514,7 @@ gtk_picture_dispose (GObject *object)
 
   gtk_picture_set_paintable (self, NULL);
 
+  g_clear_handle_id (&self->reload_id, g_source_remove);
   g_clear_object (&self->file);
   g_clear_pointer (&self->alternative_text, g_free);
 
@@ -321,6 +534,9 @@ gtk_picture_class_init (GtkPictureClass *class)
   widget_class->snapshot = gtk_picture_snapshot;
   widget_class->get_request_mode = gtk_picture_get_request_mode;
   widget_class->measure = gtk_picture_measure;
+  widget_class->size_allocate = gtk_picture_size_allocate;
+  widget_class->map = gtk_picture_map;
+  widget_class->unmap = gtk_picture_unmap;
 
   /**
    * GtkPicture:paintable: (attributes org.gtk.Property.get=gtk_picture_get_paintable org.gtk.Property.set=gtk_picture_set_paintable)
@@ -383,6 +599,20 @@ gtk_picture_class_init (GtkPictureClass *class)
                             TRUE,
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkPicture:load-async: (attributes org.gtk.Property.get=gtk_picture_get_load_async org.gtk.Property.set=gtk_picture_set_load_async)
+   *
+   * Whether files are decoded in a thread.
+   *
+   * Since: 4.6
+   */
+  properties[PROP_LOAD_ASYNC] =
+      g_param_spec_boolean ("load-async",
+                            P_("Load async"),
+                            P_("Whether to decode files in a thread"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 
   gtk_widget_class_set_css_name (widget_class, I_("picture"));
@@ -574,8 +804,6 @@ void
 gtk_picture_set_file (GtkPicture *self,
                       GFile      *file)
 {
-  GdkPaintable *paintable;
-
   g_return_if_fail (GTK_IS_PICTURE (self));
   g_return_if_fail (file == NULL || G_IS_FILE (file));
 
@@ -587,13 +815,7 @@ gtk_picture_set_file (GtkPicture *self,
   g_set_object (&self->file, file);
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FILE]);
 
-  if (file)
-    paintable = gdk_paintable_new_from_file_scaled (file, gtk_widget_get_scale_factor (GTK_WIDGET (self)));
-  else
-    paintable = NULL;
-
-  gtk_picture_set_paintable (self, paintable);
-  g_clear_object (&paintable);
+  gtk_picture_load_file (self, TRUE);
 
   g_object_thaw_notify (G_OBJECT (self));
 }
@@ -749,6 +971,9 @@ gtk_picture_set_paintable (GtkPicture   *self,
   g_return_if_fail (GTK_IS_PICTURE (self));
   g_return_if_fail (paintable == NULL || GDK_IS_PAINTABLE (paintable));
 
+  /* An explicitly set paintable replaces whatever we were loading */
+  gtk_picture_cancel_load (self);
+
   if (self->paintable == paintable)
     return;
 
@@ -910,6 +1135,58 @@ gtk_picture_get_can_shrink (GtkPicture *self)
   return self->can_shrink;
 }
 
+/**
+ * gtk_picture_set_load_async: (attributes org.gtk.Method.set_property=load-async)
+ * @self: a `GtkPicture`
+ * @load_async: whether to decode files in a thread
+ *
+ * If set to %TRUE, files set with [method@Gtk.Picture.set_file] are
+ * read and decoded in a thread.
+ *
+ * Until the file is decoded, an empty placeholder of the size of the
+ * picture is displayed. Files are only loaded while the picture is
+ * mapped; unmapping it stops loading.
+ *
+ * Since: 4.6
+ */
+void
+gtk_picture_set_load_async (GtkPicture *self,
+                            gboolean    load_async)
+{
+  g_return_if_fail (GTK_IS_PICTURE (self));
+
+  load_async = !!load_async;
+
+  if (self->load_async == load_async)
+    return;
+
+  self->load_async = load_async;
+
+  /* Finish a pending load synchronously */
+  if (!load_async && (self->load_pending || self->cancellable))
+    gtk_picture_load_file (self, TRUE);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOAD_ASYNC]);
+}
+
+/**
+ * gtk_picture_get_load_async: (attributes org.gtk.Method.get_property=load-async)
+ * @self: a `GtkPicture`
+ *
+ * Returns whether files are decoded in a thread.
+ *
+ * Returns: %TRUE if files are loaded asynchronously
+ *
+ * Since: 4.6
+ */
+gboolean
+gtk_picture_get_load_async (GtkPicture *self)
+{
+  g_return_val_if_fail (GTK_IS_PICTURE (self), FALSE);
+
+  return self->load_async;
+}
+
 /**
  * gtk_picture_set_alternative_text: (attributes org.gtk.Method.set_property=alternative-text)
  * @self: a `GtkPicture`
@@ -934,6 +934,124 @@ gtk_popover_init (GtkPopover *popover)
   add_actions (popover);
 }
 
+/* Creating a popup surface and realizing a renderer for it is
+ * expensive, and context menus are often created for every time they
+ * are shown and destroyed afterwards. So we keep a few unused popup
+ * surfaces with their renderers around per parent surface, for the
+ * next popover to pick up.
+ */
+#define MAX_POOLED_SURFACES 2
+
+typedef struct {
+  GdkSurface *surface;
+  GskRenderer *renderer;
+} PooledSurface;
+
+typedef struct {
+  GQueue surfaces;
+} SurfacePool;
+
+static GQuark quark_surface_pool;
+
+static void
+pooled_surface_free (gpointer data)
+{
+  PooledSurface *pooled = data;
+
+  gsk_renderer_unrealize (pooled->renderer);
+  g_object_unref (pooled->renderer);
+  gdk_surface_destroy (pooled->surface);
+  g_free (pooled);
+}
+
+static void
+surface_pool_free (gpointer  data,
+                   GObject  *parent_surface)
+{
+  SurfacePool *pool = data;
+
+  g_queue_clear_full (&pool->surfaces, pooled_surface_free);
+  g_free (pool);
+}
+
+static SurfacePool *
+surface_pool_get (GdkSurface *parent_surface,
+                  gboolean    create)
+{
+  SurfacePool *pool;
+
+  if (G_UNLIKELY (quark_surface_pool == 0))
+    quark_surface_pool = g_quark_from_static_string ("gtk-popover-surface-pool");
+
+  pool = g_object_get_qdata (G_OBJECT (parent_surface), quark_surface_pool);
+  if (pool == NULL && create)
+    {
+      pool = g_new0 (SurfacePool, 1);
+      g_queue_init (&pool->surfaces);
+      g_object_set_qdata (G_OBJECT (parent_surface), quark_surface_pool, pool);
+      /* Weak refs are notified in dispose, while the surface is still intact */
+      g_object_weak_ref (G_OBJECT (parent_surface), surface_pool_free, pool);
+    }
+
+  return pool;
+}
+
+static gboolean
+surface_pool_take (GdkSurface   *parent_surface,
+                   gboolean      autohide,
+                   GdkSurface  **surface,
+                   GskRenderer **renderer)
+{
+  SurfacePool *pool;
+  GList *l;
+
+  pool = surface_pool_get (parent_surface, FALSE);
+  if (pool == NULL)
+    return FALSE;
+
+  for (l = pool->surfaces.head; l; l = l->next)
+    {
+      PooledSurface *pooled = l->data;
+
+      if (gdk_popup_get_autohide (GDK_POPUP (pooled->surface)) != autohide)
+        continue;
+
+      *surface = pooled->surface;
+      *renderer = pooled->renderer;
+      g_queue_delete_link (&pool->surfaces, l);
+      g_free (pooled);
+
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+surface_pool_return (GdkSurface  *parent_surface,
+                     GdkSurface  *surface,
+                     GskRenderer *renderer)
+{
+  SurfacePool *pool;
+  PooledSurface *pooled;
+
+  if (gdk_surface_is_destroyed (parent_surface) ||
+      gdk_surface_is_destroyed (surface) ||
+      gdk_surface_get_mapped (surface))
+    return FALSE;
+
+  pool = surface_pool_get (parent_surface, TRUE);
+  if (g_queue_get_length (&pool->surfaces) >= MAX_POOLED_SURFACES)
+    return FALSE;
+
+  pooled = g_new (PooledSurface, 1);
+  pooled->surface = surface;
+  pooled->renderer = renderer;
+  g_queue_push_tail (&pool->surfaces, pooled);
+
+  return TRUE;
+}
+
 static void
 gtk_popover_realize (GtkWidget *widget)
 {
@@ -941,10 +1059,13 @@ gtk_popover_realize (GtkWidget *widget)
   GtkPopoverPrivate *priv = gtk_popover_get_instance_private (popover);
   GdkSurface *parent_surface;
   GtkWidget *parent;
+  gboolean pooled;
 
   parent = gtk_widget_get_parent (widget);
   parent_surface = gtk_native_get_surface (gtk_widget_get_native (parent));
-  priv->surface = gdk_surface_new_popup (parent_surface, priv->autohide);
+  pooled = surface_pool_take (parent_surface, priv->autohide, &priv->surface, &priv->renderer);
+  if (!pooled)
+    priv->surface = gdk_surface_new_popup (parent_surface, priv->autohide);
 
   gdk_surface_set_widget (priv->surface, widget);
 
@@ -954,7 +1075,8 @@ gtk_popover_realize (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_popover_parent_class)->realize (widget);
 
-  priv->renderer = gsk_renderer_new_for_surface (priv->surface);
+  if (!pooled)
+    priv->renderer = gsk_renderer_new_for_surface (priv->surface);
 
   gtk_native_realize (GTK_NATIVE (popover));
 }
@@ -969,13 +1091,24 @@ gtk_popover_unrealize (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_popover_parent_class)->unrealize (widget);
 
-  gsk_renderer_unrealize (priv->renderer);
-  g_clear_object (&priv->renderer);
-
   g_signal_handlers_disconnect_by_func (priv->surface, surface_mapped_changed, widget);
   g_signal_handlers_disconnect_by_func (priv->surface, surface_render, widget);
   g_signal_handlers_disconnect_by_func (priv->surface, surface_event, widget);
   gdk_surface_set_widget (priv->surface, NULL);
+
+  if (surface_pool_return (gdk_popup_get_parent (GDK_POPUP (priv->surface)),
+                           priv->surface,
+                           priv->renderer))
+    {
+      /* The pool owns them now */
+      priv->surface = NULL;
+      priv->renderer = NULL;
+      return;
+    }
+
+  gsk_renderer_unrealize (priv->renderer);
+  g_clear_object (&priv->renderer);
+
   gdk_surface_destroy (priv->surface);
   g_clear_object (&priv->surface);
 }
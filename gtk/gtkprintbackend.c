@@ -22,6 +22,7 @@
 #include <gmodule.h>
 
 #include "gtkintl.h"
+#include "gdk/gdkprofilerprivate.h"
 #include "gtkdebug.h"
 #include "gtkmodulesprivate.h"
 #include "gtkmarshalers.h"
@@ -83,10 +84,19 @@ gtk_print_backend_error_quark (void)
 void
 gtk_print_backends_init (void)
 {
+  static gboolean initialized = FALSE;
   GIOExtensionPoint *ep;
   GIOModuleScope *scope;
   char **paths;
   int i;
+  gint64 before G_GNUC_UNUSED;
+
+  if (initialized)
+    return;
+
+  initialized = TRUE;
+
+  before = GDK_PROFILER_CURRENT_TIME;
 
   GTK_NOTE (MODULES,
             g_print ("Registering extension point %s\n", GTK_PRINT_BACKEND_EXTENSION_POINT_NAME));
@@ -120,6 +130,8 @@ gtk_print_backends_init (void)
                    g_type_name (g_io_extension_get_type (ext)));
         }
     }
+
+  gdk_profiler_end_mark (before, "init print backends", NULL);
 }
 
 /**
@@ -140,6 +152,8 @@ gtk_print_backend_load_modules (void)
 
   result = NULL;
 
+  gtk_print_backends_init ();
+
   ep = g_io_extension_point_lookup (GTK_PRINT_BACKEND_EXTENSION_POINT_NAME);
 
   settings = gtk_settings_get_default ();
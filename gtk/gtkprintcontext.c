@@ -175,6 +175,33 @@ _gtk_print_context_new (GtkPrintOperation *op)
   return context;
 }
 
+/* Creates a context that draws into @cr with the same page setup,
+ * resolution and hard margins as @context, for drawing pages in
+ * a thread.
+ */
+GtkPrintContext *
+_gtk_print_context_new_for_recording (GtkPrintContext *context,
+                                      GtkPageSetup    *page_setup,
+                                      cairo_t         *cr)
+{
+  GtkPrintContext *copy;
+
+  copy = _gtk_print_context_new (context->op);
+
+  gtk_print_context_set_cairo_context (copy, cr,
+                                       context->surface_dpi_x,
+                                       context->surface_dpi_y);
+  _gtk_print_context_set_page_setup (copy, page_setup);
+
+  copy->has_hard_margins = context->has_hard_margins;
+  copy->hard_margin_top = context->hard_margin_top;
+  copy->hard_margin_bottom = context->hard_margin_bottom;
+  copy->hard_margin_left = context->hard_margin_left;
+  copy->hard_margin_right = context->hard_margin_right;
+
+  return copy;
+}
+
 static PangoFontMap *
 _gtk_print_context_get_fontmap (GtkPrintContext *context)
 {
@@ -55,6 +55,7 @@ struct _GtkPrintOperationPrivate
   guint support_selection  : 1;
   guint has_selection      : 1;
   guint embed_page_setup   : 1;
+  guint threaded_drawing   : 1;
 
   GtkPageDrawingState      page_drawing_state;
 
@@ -134,6 +135,9 @@ void _gtk_print_operation_set_status (GtkPrintOperation *op,
 /* GtkPrintContext private functions: */
 
 GtkPrintContext *_gtk_print_context_new                             (GtkPrintOperation *op);
+GtkPrintContext *_gtk_print_context_new_for_recording               (GtkPrintContext   *context,
+                                                                     GtkPageSetup      *page_setup,
+                                                                     cairo_t           *cr);
 void             _gtk_print_context_set_page_setup                  (GtkPrintContext   *context,
 								     GtkPageSetup      *page_setup);
 void             _gtk_print_context_translate_into_margin           (GtkPrintContext   *context);
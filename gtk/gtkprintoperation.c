@@ -139,7 +139,8 @@ enum
   PROP_EMBED_PAGE_SETUP,
   PROP_HAS_SELECTION,
   PROP_SUPPORT_SELECTION,
-  PROP_N_PAGES_TO_PRINT
+  PROP_N_PAGES_TO_PRINT,
+  PROP_THREADED_DRAWING
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
@@ -418,6 +419,9 @@ gtk_print_operation_set_property (GObject      *object,
     case PROP_SUPPORT_SELECTION:
       gtk_print_operation_set_support_selection (op, g_value_get_boolean (value));
       break;
+    case PROP_THREADED_DRAWING:
+      gtk_print_operation_set_threaded_drawing (op, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -489,6 +493,9 @@ gtk_print_operation_get_property (GObject    *object,
     case PROP_N_PAGES_TO_PRINT:
       g_value_set_int (value, priv->nr_of_pages_to_print);
       break;
+    case PROP_THREADED_DRAWING:
+      g_value_set_boolean (value, priv->threaded_drawing);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -513,6 +520,12 @@ struct _PrintPagesData
   int num_of_sheets;
   int *pages;
 
+  /* pages drawn in threads, in printing order */
+  GQueue rendered;
+  GCancellable *cancellable;
+  guint max_rendering;
+  int replayed;
+
   GtkWidget *progress;
  
   gboolean initialized;
@@ -911,6 +924,10 @@ gtk_print_operation_class_init (GtkPrintOperationClass *class)
    * [method@Gtk.PrintOperation.set_unit] before starting the print
    * operation to set up the transformation of the cairo context
    * according to your needs.
+   *
+   * If [property@Gtk.PrintOperation:threaded-drawing] is set, this
+   * signal is emitted in worker threads while printing, with a
+   * separate print context for each page.
    */
   signals[DRAW_PAGE] =
     g_signal_new (I_("draw-page"),
@@ -1400,6 +1417,23 @@ gtk_print_operation_class_init (GtkPrintOperationClass *class)
 						     G_MAXINT,
 						     -1,
 						     GTK_PARAM_READABLE|G_PARAM_EXPLICIT_NOTIFY));
+
+  /**
+   * GtkPrintOperation:threaded-drawing: (attributes org.gtk.Property.get=gtk_print_operation_get_threaded_drawing org.gtk.Property.set=gtk_print_operation_set_threaded_drawing)
+   *
+   * Whether pages may be drawn in worker threads while printing.
+   *
+   * See [method@Gtk.PrintOperation.set_threaded_drawing].
+   *
+   * Since: 4.6
+   */
+  g_object_class_install_property (gobject_class,
+				   PROP_THREADED_DRAWING,
+				   g_param_spec_boolean ("threaded-drawing",
+							 P_("Threaded drawing"),
+							 P_("TRUE if pages may be drawn in threads"),
+							 FALSE,
+							 GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY));
 }
 
 /**
@@ -1875,6 +1909,67 @@ gtk_print_operation_set_allow_async (GtkPrintOperation  *op,
 }
 
 
+/**
+ * gtk_print_operation_set_threaded_drawing: (attributes org.gtk.Method.set_property=threaded-drawing)
+ * @op: a `GtkPrintOperation`
+ * @threaded_drawing: %TRUE to draw pages in threads
+ *
+ * Sets whether pages may be drawn in worker threads while printing.
+ *
+ * When this is enabled, several [signal@Gtk.PrintOperation::draw-page]
+ * signals are emitted at the same time from worker threads, each with
+ * its own `GtkPrintContext` whose cairo context records the drawing.
+ * The recorded pages are sent to the printer in order on the main
+ * thread, so the user interface stays responsive and the progress
+ * dialog can cancel the operation.
+ *
+ * Handlers of ::draw-page must then be thread-safe: they must not
+ * use widgets, or data that is changed elsewhere without locking,
+ * and must not call [method@Gtk.PrintOperation.set_defer_drawing].
+ * All other signals are still emitted on the main thread.
+ *
+ * Previews are always drawn on the main thread.
+ *
+ * Since: 4.6
+ */
+void
+gtk_print_operation_set_threaded_drawing (GtkPrintOperation *op,
+                                          gboolean           threaded_drawing)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (op);
+
+  g_return_if_fail (GTK_IS_PRINT_OPERATION (op));
+
+  threaded_drawing = threaded_drawing != FALSE;
+
+  if (priv->threaded_drawing != threaded_drawing)
+    {
+      priv->threaded_drawing = threaded_drawing;
+
+      g_object_notify (G_OBJECT (op), "threaded-drawing");
+    }
+}
+
+/**
+ * gtk_print_operation_get_threaded_drawing: (attributes org.gtk.Method.get_property=threaded-drawing)
+ * @op: a `GtkPrintOperation`
+ *
+ * Gets whether pages may be drawn in worker threads.
+ *
+ * Returns: whether pages are drawn in threads
+ *
+ * Since: 4.6
+ */
+gboolean
+gtk_print_operation_get_threaded_drawing (GtkPrintOperation *op)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (op);
+
+  g_return_val_if_fail (GTK_IS_PRINT_OPERATION (op), FALSE);
+
+  return priv->threaded_drawing;
+}
+
 /**
  * gtk_print_operation_set_custom_tab_label: (attributes org.gtk.Method.set_property=custom-tab-label)
  * @op: a `GtkPrintOperation`
@@ -2217,6 +2312,33 @@ increment_page_sequence (PrintPagesData *data)
   data->total++;
 }
 
+typedef struct
+{
+  int page_nr;
+  int page_position;
+  GtkPageSetup *page_setup;
+  GtkPrintContext *print_context;
+  cairo_surface_t *surface;
+  cairo_matrix_t matrix;
+  gboolean finished;
+} RenderedPage;
+
+static void
+rendered_page_clear (gpointer data)
+{
+  RenderedPage *page = data;
+
+  g_clear_object (&page->page_setup);
+  g_clear_object (&page->print_context);
+  g_clear_pointer (&page->surface, cairo_surface_destroy);
+}
+
+static void
+rendered_page_release (gpointer data)
+{
+  g_rc_box_release_full (data, rendered_page_clear);
+}
+
 static void
 print_pages_idle_done (gpointer user_data)
 {
@@ -2251,6 +2373,13 @@ print_pages_idle_done (gpointer user_data)
       g_signal_emit (data->op, signals[DONE], 0, result);
     }
   
+  if (data->cancellable)
+    {
+      g_cancellable_cancel (data->cancellable);
+      g_object_unref (data->cancellable);
+    }
+  g_queue_clear_full (&data->rendered, rendered_page_release);
+
   g_object_unref (data->op);
   g_free (data->pages);
   g_free (data);
@@ -2272,7 +2401,8 @@ update_progress (PrintPagesData *data)
 	    text = g_strdup (_("Preparing"));
 	}
       else if (priv->status == GTK_PRINT_STATUS_GENERATING_DATA)
-	text = g_strdup_printf (_("Printing %d"), data->total);
+	text = g_strdup_printf (_("Printing %d"),
+                                data->cancellable ? data->replayed : data->total);
       
       if (text)
 	{
@@ -2380,22 +2510,20 @@ gtk_print_operation_draw_page_finish (GtkPrintOperation *op)
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_READY;
 }
 
+/* Starts a page and sets up its transformation, taking over the
+ * reference on @page_setup that gtk_print_operation_draw_page_finish()
+ * drops.
+ */
 static void
-common_render_page (GtkPrintOperation *op,
-		    int                page_nr)
+begin_render_page (GtkPrintOperation *op,
+                   GtkPageSetup      *page_setup)
 {
   GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (op);
-  GtkPageSetup *page_setup;
   GtkPrintContext *print_context;
   cairo_t *cr;
 
   print_context = priv->print_context;
-  
-  page_setup = create_page_setup (op);
-  
-  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0, 
-		 print_context, page_nr, page_setup);
-  
+
   _gtk_print_context_set_page_setup (print_context, page_setup);
   
   priv->start_page (op, print_context, page_setup);
@@ -2597,6 +2725,24 @@ common_render_page (GtkPrintOperation *op,
           cairo_rotate (cr, - G_PI / 2);
         }
     }
+}
+
+static void
+common_render_page (GtkPrintOperation *op,
+		    int                page_nr)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (op);
+  GtkPageSetup *page_setup;
+  GtkPrintContext *print_context;
+
+  print_context = priv->print_context;
+  
+  page_setup = create_page_setup (op);
+  
+  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0, 
+		 print_context, page_nr, page_setup);
+
+  begin_render_page (op, page_setup);
   
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_DRAWING;
 
@@ -2774,6 +2920,133 @@ prepare_data (PrintPagesData *data)
                                    NULL);
 }
 
+static void
+draw_page_thread (GTask        *task,
+                  gpointer      source_object,
+                  gpointer      task_data,
+                  GCancellable *cancellable)
+{
+  GtkPrintOperation *op = source_object;
+  RenderedPage *page = task_data;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  g_signal_emit (op, signals[DRAW_PAGE], 0,
+                 page->print_context, page->page_nr);
+
+  /* Drop the cairo context, so the recording is complete */
+  g_clear_object (&page->print_context);
+  cairo_surface_flush (page->surface);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+draw_page_done (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  RenderedPage *page = g_task_get_task_data (G_TASK (result));
+
+  if (g_task_propagate_boolean (G_TASK (result), NULL))
+    page->finished = TRUE;
+}
+
+static void
+queue_render_page (PrintPagesData *data)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (data->op);
+  RenderedPage *page;
+  GTask *task;
+  cairo_t *cr;
+
+  page = g_rc_box_new0 (RenderedPage);
+  page->page_nr = data->page;
+  page->page_position = priv->page_position;
+
+  page->page_setup = create_page_setup (data->op);
+  g_signal_emit (data->op, signals[REQUEST_PAGE_SETUP], 0,
+                 priv->print_context, page->page_nr, page->page_setup);
+
+  /* Recording keeps the output in vector form; it is replayed
+   * under the transformation that the page gets when printed.
+   */
+  page->surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+  cr = cairo_create (page->surface);
+  page->print_context = _gtk_print_context_new_for_recording (priv->print_context,
+                                                              page->page_setup,
+                                                              cr);
+  cairo_get_matrix (cr, &page->matrix);
+  cairo_destroy (cr);
+
+  g_queue_push_tail (&data->rendered, page);
+
+  task = g_task_new (data->op, data->cancellable, draw_page_done, NULL);
+  g_task_set_source_tag (task, queue_render_page);
+  g_task_set_task_data (task, g_rc_box_acquire (page), rendered_page_release);
+  g_task_run_in_thread (task, draw_page_thread);
+  g_object_unref (task);
+}
+
+static void
+replay_page (PrintPagesData *data,
+             RenderedPage   *page)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (data->op);
+  cairo_pattern_t *pattern;
+  cairo_t *cr;
+
+  priv->page_position = page->page_position;
+  begin_render_page (data->op, g_object_ref (page->page_setup));
+
+  cr = gtk_print_context_get_cairo_context (priv->print_context);
+
+  pattern = cairo_pattern_create_for_surface (page->surface);
+  cairo_pattern_set_matrix (pattern, &page->matrix);
+  cairo_set_source (cr, pattern);
+  cairo_paint (cr);
+  cairo_pattern_destroy (pattern);
+
+  gtk_print_operation_draw_page_finish (data->op);
+}
+
+/* Keeps up to max_rendering pages drawing in threads, and sends the
+ * next finished one to the printer. Returns whether all pages are done.
+ */
+static gboolean
+print_pages_threaded (PrintPagesData *data)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (data->op);
+  RenderedPage *page;
+
+  if (data->cancellable == NULL)
+    {
+      data->cancellable = g_cancellable_new ();
+      data->max_rendering = 2 * MAX (1, g_get_num_processors ());
+    }
+
+  while (!data->done && !priv->cancelled &&
+         g_queue_get_length (&data->rendered) < data->max_rendering)
+    {
+      increment_page_sequence (data);
+
+      if (!data->done)
+        queue_render_page (data);
+    }
+
+  page = g_queue_peek_head (&data->rendered);
+  if (page != NULL && page->finished)
+    {
+      g_queue_pop_head (&data->rendered);
+      replay_page (data, page);
+      rendered_page_release (page);
+      data->replayed++;
+    }
+
+  return data->done && g_queue_is_empty (&data->rendered);
+}
+
 static gboolean
 print_pages_idle (gpointer user_data)
 {
@@ -2797,6 +3070,13 @@ print_pages_idle (gpointer user_data)
           goto out;
         }
 
+      if (priv->threaded_drawing)
+        {
+          if (!priv->cancelled)
+            done = print_pages_threaded (data);
+          goto out;
+        }
+
       increment_page_sequence (data);
 
       if (!data->done)
@@ -2808,6 +3088,9 @@ print_pages_idle (gpointer user_data)
 
       if (priv->cancelled)
         {
+          if (data->cancellable)
+            g_cancellable_cancel (data->cancellable);
+
           _gtk_print_operation_set_status (data->op, GTK_PRINT_STATUS_FINISHED_ABORTED, NULL);
 
           data->is_preview = FALSE;
@@ -132,6 +132,7 @@ guint gtk_get_display_debug_flags (GdkDisplay *display);
 gboolean gtk_get_any_display_debug_flag_set (void);
 
 GBytes *get_emoji_data (void);
+GVariant *get_emoji_variant (void);
 
 #ifdef G_ENABLE_DEBUG
 
@@ -0,0 +1,184 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkprogressinputstreamprivate.h"
+
+/* A filter stream that counts the bytes passing through it and
+ * reports them from the async read path, so that whoever consumes
+ * the stream (usually a GdkContentDeserializer) does not need to
+ * know about it.
+ *
+ * The callback is only invoked for async reads, which happen on the
+ * thread that started them. Sync reads may happen in a worker thread,
+ * so they are only counted.
+ */
+
+struct _GtkProgressInputStream
+{
+  GFilterInputStream parent_instance;
+
+  guint64 bytes_read;
+
+  GtkProgressInputStreamFunc func;
+  gpointer user_data;
+  GDestroyNotify destroy;
+};
+
+G_DEFINE_TYPE (GtkProgressInputStream, gtk_progress_input_stream, G_TYPE_FILTER_INPUT_STREAM)
+
+static gssize
+gtk_progress_input_stream_read (GInputStream  *stream,
+                                void          *buffer,
+                                gsize          count,
+                                GCancellable  *cancellable,
+                                GError       **error)
+{
+  GtkProgressInputStream *self = GTK_PROGRESS_INPUT_STREAM (stream);
+  GInputStream *base = g_filter_input_stream_get_base_stream (G_FILTER_INPUT_STREAM (stream));
+  gssize res;
+
+  res = g_input_stream_read (base, buffer, count, cancellable, error);
+  if (res > 0)
+    self->bytes_read += res;
+
+  return res;
+}
+
+static void
+gtk_progress_input_stream_read_done (GObject      *source,
+                                     GAsyncResult *result,
+                                     gpointer      data)
+{
+  GTask *task = data;
+  GtkProgressInputStream *self = g_task_get_source_object (task);
+  GError *error = NULL;
+  gssize res;
+
+  res = g_input_stream_read_finish (G_INPUT_STREAM (source), result, &error);
+  if (res < 0)
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  if (res > 0)
+    {
+      self->bytes_read += res;
+      if (self->func)
+        self->func (self->bytes_read, self->user_data);
+    }
+
+  g_task_return_int (task, res);
+  g_object_unref (task);
+}
+
+static void
+gtk_progress_input_stream_read_async (GInputStream        *stream,
+                                      void                *buffer,
+                                      gsize                count,
+                                      int                  io_priority,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  GInputStream *base = g_filter_input_stream_get_base_stream (G_FILTER_INPUT_STREAM (stream));
+  GTask *task;
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_progress_input_stream_read_async);
+  g_task_set_priority (task, io_priority);
+
+  g_input_stream_read_async (base,
+                             buffer,
+                             count,
+                             io_priority,
+                             cancellable,
+                             gtk_progress_input_stream_read_done,
+                             task);
+}
+
+static gssize
+gtk_progress_input_stream_read_finish (GInputStream  *stream,
+                                       GAsyncResult  *result,
+                                       GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gtk_progress_input_stream_read_async, -1);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+
+static void
+gtk_progress_input_stream_finalize (GObject *object)
+{
+  GtkProgressInputStream *self = GTK_PROGRESS_INPUT_STREAM (object);
+
+  if (self->destroy)
+    self->destroy (self->user_data);
+
+  G_OBJECT_CLASS (gtk_progress_input_stream_parent_class)->finalize (object);
+}
+
+static void
+gtk_progress_input_stream_class_init (GtkProgressInputStreamClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GInputStreamClass *stream_class = G_INPUT_STREAM_CLASS (klass);
+
+  object_class->finalize = gtk_progress_input_stream_finalize;
+
+  stream_class->read_fn = gtk_progress_input_stream_read;
+  stream_class->read_async = gtk_progress_input_stream_read_async;
+  stream_class->read_finish = gtk_progress_input_stream_read_finish;
+}
+
+static void
+gtk_progress_input_stream_init (GtkProgressInputStream *self)
+{
+}
+
+GInputStream *
+gtk_progress_input_stream_new (GInputStream               *base_stream,
+                               GtkProgressInputStreamFunc  func,
+                               gpointer                    user_data,
+                               GDestroyNotify              destroy)
+{
+  GtkProgressInputStream *self;
+
+  g_return_val_if_fail (G_IS_INPUT_STREAM (base_stream), NULL);
+
+  self = g_object_new (GTK_TYPE_PROGRESS_INPUT_STREAM,
+                       "base-stream", base_stream,
+                       NULL);
+
+  self->func = func;
+  self->user_data = user_data;
+  self->destroy = destroy;
+
+  return G_INPUT_STREAM (self);
+}
+
+guint64
+gtk_progress_input_stream_get_bytes_read (GtkProgressInputStream *self)
+{
+  g_return_val_if_fail (GTK_IS_PROGRESS_INPUT_STREAM (self), 0);
+
+  return self->bytes_read;
+}
@@ -0,0 +1,41 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_PROGRESS_INPUT_STREAM_PRIVATE_H__
+#define __GTK_PROGRESS_INPUT_STREAM_PRIVATE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GTK_TYPE_PROGRESS_INPUT_STREAM (gtk_progress_input_stream_get_type ())
+
+G_DECLARE_FINAL_TYPE (GtkProgressInputStream, gtk_progress_input_stream, GTK, PROGRESS_INPUT_STREAM, GFilterInputStream)
+
+typedef void (* GtkProgressInputStreamFunc) (guint64  bytes_read,
+                                             gpointer user_data);
+
+GInputStream *  gtk_progress_input_stream_new            (GInputStream               *base_stream,
+                                                          GtkProgressInputStreamFunc  func,
+                                                          gpointer                    user_data,
+                                                          GDestroyNotify              destroy);
+
+guint64         gtk_progress_input_stream_get_bytes_read (GtkProgressInputStream     *self);
+
+G_END_DECLS
+
+#endif /* __GTK_PROGRESS_INPUT_STREAM_PRIVATE_H__ */
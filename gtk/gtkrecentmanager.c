@@ -152,6 +152,13 @@ struct _GtkRecentInfo
   int ref_count;
 };
 
+typedef struct
+{
+  guint64 inode;
+  gint64 mtime;
+  goffset size;
+} FileStamp;
+
 struct _GtkRecentManagerPrivate
 {
   char *filename;
@@ -166,6 +173,13 @@ struct _GtkRecentManagerPrivate
 
   guint changed_timeout;
   guint changed_age;
+
+  /* set when the file was changed by someone else */
+  guint needs_reload : 1;
+  GCancellable *reload_cancellable;
+
+  /* the state of the file when we last read or wrote it */
+  FileStamp stamp;
 };
 
 enum
@@ -216,6 +230,9 @@ static void           gtk_recent_info_free (GtkRecentInfo *recent_info);
 
 static guint signal_changed = 0;
 
+static void get_file_stamp (const char *filename,
+                            FileStamp  *stamp);
+
 static GtkRecentManager *recent_manager_singleton = NULL;
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkRecentManager, gtk_recent_manager, G_TYPE_OBJECT)
@@ -387,6 +404,12 @@ gtk_recent_manager_dispose (GObject *gobject)
   GtkRecentManager *manager = GTK_RECENT_MANAGER (gobject);
   GtkRecentManagerPrivate *priv = manager->priv;
 
+  if (priv->reload_cancellable)
+    {
+      g_cancellable_cancel (priv->reload_cancellable);
+      g_clear_object (&priv->reload_cancellable);
+    }
+
   if (priv->monitor != NULL)
     {
       g_signal_handlers_disconnect_by_func (priv->monitor,
@@ -490,6 +513,9 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
               g_error_free (write_error);
             }
 
+          /* so that we don't read back what we just wrote */
+          get_file_stamp (priv->filename, &priv->stamp);
+
           if (g_chmod (priv->filename, 0600) < 0)
             {
               char *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
@@ -507,9 +533,11 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
     {
       /* we are not marked as dirty, so we have been called
        * because the recently used resources file has been
-       * changed (and not from us).
+       * changed (and not from us). Usually, it has been reloaded
+       * in the background before the signal got emitted.
        */
-      build_recent_items_list (manager);
+      if (priv->needs_reload)
+        build_recent_items_list (manager);
     }
 
   g_object_thaw_notify (G_OBJECT (manager));
@@ -529,6 +557,7 @@ gtk_recent_manager_monitor_changed (GFileMonitor      *monitor,
     case G_FILE_MONITOR_EVENT_CHANGED:
     case G_FILE_MONITOR_EVENT_CREATED:
     case G_FILE_MONITOR_EVENT_DELETED:
+      manager->priv->needs_reload = TRUE;
       gtk_recent_manager_changed (manager);
       break;
 
@@ -639,6 +668,212 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
   build_recent_items_list (manager);
 }
 
+static void
+get_file_stamp (const char *filename,
+                FileStamp  *stamp)
+{
+  GStatBuf buf;
+
+  if (filename == NULL || g_stat (filename, &buf) != 0)
+    {
+      memset (stamp, 0, sizeof (FileStamp));
+      return;
+    }
+
+  /* The file is replaced atomically on every write, so the
+   * inode tells writes apart even within the mtime granularity.
+   */
+  stamp->inode = buf.st_ino;
+  stamp->mtime = buf.st_mtime;
+  stamp->size = buf.st_size;
+}
+
+static gboolean
+file_stamp_equal (const FileStamp *a,
+                  const FileStamp *b)
+{
+  return a->inode == b->inode &&
+         a->mtime == b->mtime &&
+         a->size == b->size;
+}
+
+/* Whether two lists have the same items, modified at the same time.
+ * Other processes rewrite the file for changes that don't concern us,
+ * like touching an item that is not there anymore after clamping.
+ */
+static gboolean
+recent_items_equal (GBookmarkFile *a,
+                    GBookmarkFile *b)
+{
+  char **uris;
+  gsize n_uris, i;
+  gboolean equal = TRUE;
+
+  if (a == NULL || b == NULL)
+    return a == b;
+
+  if (g_bookmark_file_get_size (a) != g_bookmark_file_get_size (b))
+    return FALSE;
+
+  uris = g_bookmark_file_get_uris (b, &n_uris);
+  for (i = 0; i < n_uris && equal; i++)
+    {
+      GDateTime *ma, *mb;
+
+      if (!g_bookmark_file_has_item (a, uris[i]))
+        {
+          equal = FALSE;
+          break;
+        }
+
+      ma = g_bookmark_file_get_modified_date_time (a, uris[i], NULL);
+      mb = g_bookmark_file_get_modified_date_time (b, uris[i], NULL);
+      if (ma == NULL || mb == NULL)
+        equal = ma == mb;
+      else
+        equal = g_date_time_equal (ma, mb);
+    }
+  g_strfreev (uris);
+
+  return equal;
+}
+
+typedef struct
+{
+  GBookmarkFile *items;
+  FileStamp stamp;
+} ReloadResult;
+
+static void
+reload_result_free (gpointer data)
+{
+  ReloadResult *result = data;
+
+  if (result->items)
+    g_bookmark_file_free (result->items);
+  g_free (result);
+}
+
+static void
+reload_thread (GTask        *task,
+               gpointer      source_object,
+               gpointer      task_data,
+               GCancellable *cancellable)
+{
+  const char *filename = task_data;
+  ReloadResult *result;
+  GError *error = NULL;
+
+  result = g_new0 (ReloadResult, 1);
+  get_file_stamp (filename, &result->stamp);
+
+  result->items = g_bookmark_file_new ();
+  if (!g_bookmark_file_load_from_file (result->items, filename, &error))
+    {
+      g_bookmark_file_free (result->items);
+      result->items = NULL;
+
+      /* a missing file is an empty list */
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        {
+          reload_result_free (result);
+          g_task_return_error (task, error);
+          return;
+        }
+
+      g_clear_error (&error);
+    }
+
+  g_task_return_pointer (task, result, reload_result_free);
+}
+
+static void
+reload_done (GObject      *source,
+             GAsyncResult *res,
+             gpointer      data)
+{
+  GtkRecentManager *manager = GTK_RECENT_MANAGER (source);
+  GtkRecentManagerPrivate *priv = manager->priv;
+  ReloadResult *result;
+  GError *error = NULL;
+  gboolean changed;
+  int size;
+
+  result = g_task_propagate_pointer (G_TASK (res), &error);
+  if (result == NULL)
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          char *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
+          g_warning ("Attempting to read the recently used resources "
+                     "file at '%s', but the parser failed: %s.",
+                     utf8 ? utf8 : "(invalid filename)",
+                     error->message);
+          g_free (utf8);
+        }
+
+      g_error_free (error);
+      return;
+    }
+
+  g_clear_object (&priv->reload_cancellable);
+
+  /* Our own changes got in while we were reading; they will be
+   * written out shortly and win, just like they would have before.
+   */
+  if (priv->is_dirty)
+    {
+      reload_result_free (result);
+      return;
+    }
+
+  priv->stamp = result->stamp;
+  changed = !recent_items_equal (priv->recent_items, result->items);
+
+  if (priv->recent_items)
+    g_bookmark_file_free (priv->recent_items);
+  priv->recent_items = g_steal_pointer (&result->items);
+  reload_result_free (result);
+
+  size = priv->recent_items ? g_bookmark_file_get_size (priv->recent_items) : 0;
+  if (priv->size != size)
+    {
+      priv->size = size;
+      g_object_notify (G_OBJECT (manager), "size");
+    }
+
+  if (changed)
+    g_signal_emit (manager, signal_changed, 0);
+
+  /* Someone else let the list grow past our limit; trim it, which
+   * happens through a regular, coalesced write.
+   */
+  if (size > MAX_LIST_SIZE)
+    {
+      priv->is_dirty = TRUE;
+      gtk_recent_manager_changed (manager);
+    }
+}
+
+static void
+gtk_recent_manager_reload (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GTask *task;
+
+  if (priv->reload_cancellable)
+    g_cancellable_cancel (priv->reload_cancellable);
+  g_clear_object (&priv->reload_cancellable);
+
+  priv->reload_cancellable = g_cancellable_new ();
+
+  task = g_task_new (manager, priv->reload_cancellable, reload_done, NULL);
+  g_task_set_source_tag (task, gtk_recent_manager_reload);
+  g_task_set_task_data (task, g_strdup (priv->filename), g_free);
+  g_task_run_in_thread (task, reload_thread);
+  g_object_unref (task);
+}
+
 /* reads the recently used resources file and builds the items list.
  * we keep the items list inside the parser object, and build the
  * RecentInfo object only on user’s demand to avoid useless replication.
@@ -698,9 +933,12 @@ build_recent_items_list (GtkRecentManager *manager)
               g_object_notify (G_OBJECT (manager), "size");
             }
         }
+
+      get_file_stamp (priv->filename, &priv->stamp);
     }
 
   priv->is_dirty = FALSE;
+  priv->needs_reload = FALSE;
 }
 
 
@@ -1367,10 +1605,28 @@ static gboolean
 emit_manager_changed (gpointer data)
 {
   GtkRecentManager *manager = data;
+  GtkRecentManagerPrivate *priv = manager->priv;
+  FileStamp stamp;
+
+  priv->changed_age = 0;
+  priv->changed_timeout = 0;
 
-  manager->priv->changed_age = 0;
-  manager->priv->changed_timeout = 0;
+  /* Changes to the file by others are read in a thread, and only
+   * announced once they have been read and turned out to matter.
+   * Our own pending changes get written over them, as before.
+   */
+  if (priv->needs_reload && !priv->is_dirty && priv->filename != NULL)
+    {
+      priv->needs_reload = FALSE;
 
+      get_file_stamp (priv->filename, &stamp);
+      if (!file_stamp_equal (&stamp, &priv->stamp))
+        gtk_recent_manager_reload (manager);
+
+      return FALSE;
+    }
+
+  priv->needs_reload = FALSE;
   g_signal_emit (manager, signal_changed, 0);
 
   return FALSE;
@@ -1397,10 +1653,7 @@ gtk_recent_manager_changed (GtkRecentManager *manager)
       if (manager->priv->changed_age > 250)
         {
           g_source_remove (manager->priv->changed_timeout);
-          g_signal_emit (manager, signal_changed, 0);
-
-          manager->priv->changed_age = 0;
-          manager->priv->changed_timeout = 0;
+          emit_manager_changed (manager);
         }
     }
 }
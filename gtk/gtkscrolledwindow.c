@@ -274,6 +274,11 @@ typedef struct
 
   guint scroll_events_overshoot_id;
 
+  /* Smooth scroll deltas waiting for the next frame */
+  guint  scroll_tick_id;
+  double pending_scroll_dx;
+  double pending_scroll_dy;
+
   /* Kinetic scrolling */
   GtkGesture *long_press_gesture;
   GtkGesture *swipe_gesture;
@@ -1364,30 +1369,15 @@ stop_kinetic_scrolling_cb (GtkEventControllerScroll *scroll,
 }
 
 static void
-scrolled_window_scroll (GtkScrolledWindow        *scrolled_window,
-                        double                    delta_x,
-                        double                    delta_y,
-                        GtkEventControllerScroll *scroll)
+scrolled_window_apply_scroll (GtkScrolledWindow *scrolled_window,
+                              double             delta_x,
+                              double             delta_y)
 {
   GtkScrolledWindowPrivate *priv =
     gtk_scrolled_window_get_instance_private (scrolled_window);
-  gboolean shifted;
-  GdkModifierType state;
-
-  state = gtk_event_controller_get_current_event_state (GTK_EVENT_CONTROLLER (scroll));
-  shifted = (state & GDK_SHIFT_MASK) != 0;
 
   gtk_scrolled_window_invalidate_overshoot (scrolled_window);
 
-  if (shifted)
-    {
-      double delta;
-
-      delta = delta_x;
-      delta_x = delta_y;
-      delta_y = delta;
-    }
-
   if (delta_x != 0.0 &&
       may_hscroll (scrolled_window))
     {
@@ -1417,6 +1407,86 @@ scrolled_window_scroll (GtkScrolledWindow        *scrolled_window,
       _gtk_scrolled_window_set_adjustment_value (scrolled_window, adj,
                                                  new_value);
     }
+}
+
+static void
+gtk_scrolled_window_flush_scroll (GtkScrolledWindow *scrolled_window)
+{
+  GtkScrolledWindowPrivate *priv =
+    gtk_scrolled_window_get_instance_private (scrolled_window);
+  double delta_x, delta_y;
+
+  if (priv->scroll_tick_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (scrolled_window),
+                                       priv->scroll_tick_id);
+      priv->scroll_tick_id = 0;
+    }
+
+  delta_x = priv->pending_scroll_dx;
+  delta_y = priv->pending_scroll_dy;
+  priv->pending_scroll_dx = priv->pending_scroll_dy = 0;
+
+  if (delta_x != 0.0 || delta_y != 0.0)
+    scrolled_window_apply_scroll (scrolled_window, delta_x, delta_y);
+}
+
+static gboolean
+scroll_tick_cb (GtkWidget     *widget,
+                GdkFrameClock *frame_clock,
+                gpointer       user_data)
+{
+  GtkScrolledWindow *scrolled_window = GTK_SCROLLED_WINDOW (widget);
+  GtkScrolledWindowPrivate *priv =
+    gtk_scrolled_window_get_instance_private (scrolled_window);
+
+  priv->scroll_tick_id = 0;
+  gtk_scrolled_window_flush_scroll (scrolled_window);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+scrolled_window_scroll (GtkScrolledWindow        *scrolled_window,
+                        double                    delta_x,
+                        double                    delta_y,
+                        GtkEventControllerScroll *scroll)
+{
+  GtkScrolledWindowPrivate *priv =
+    gtk_scrolled_window_get_instance_private (scrolled_window);
+  gboolean shifted;
+  GdkModifierType state;
+
+  state = gtk_event_controller_get_current_event_state (GTK_EVENT_CONTROLLER (scroll));
+  shifted = (state & GDK_SHIFT_MASK) != 0;
+
+  if (shifted)
+    {
+      double delta;
+
+      delta = delta_x;
+      delta_x = delta_y;
+      delta_y = delta;
+    }
+
+  /* Touchpads may deliver events at a rate that is unrelated to
+   * the refresh rate, which makes the amount scrolled per frame
+   * uneven. Sum up the deltas and apply them once per frame.
+   */
+  if (priv->smooth_scroll && gtk_widget_get_mapped (GTK_WIDGET (scrolled_window)))
+    {
+      priv->pending_scroll_dx += delta_x;
+      priv->pending_scroll_dy += delta_y;
+
+      if (priv->scroll_tick_id == 0)
+        priv->scroll_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (scrolled_window),
+                                                             scroll_tick_cb, NULL, NULL);
+    }
+  else
+    {
+      gtk_scrolled_window_flush_scroll (scrolled_window);
+      scrolled_window_apply_scroll (scrolled_window, delta_x, delta_y);
+    }
 
   g_clear_handle_id (&priv->scroll_events_overshoot_id, g_source_remove);
 
@@ -1451,6 +1521,7 @@ scroll_controller_scroll_end (GtkEventControllerScroll *scroll,
 {
   GtkScrolledWindowPrivate *priv = gtk_scrolled_window_get_instance_private (scrolled_window);
 
+  gtk_scrolled_window_flush_scroll (scrolled_window);
   priv->smooth_scroll = FALSE;
 }
 
@@ -1464,6 +1535,8 @@ scroll_controller_decelerate (GtkEventControllerScroll *scroll,
   gboolean shifted;
   GdkModifierType state;
 
+  /* Deceleration starts from the current position */
+  gtk_scrolled_window_flush_scroll (scrolled_window);
 
   state = gtk_event_controller_get_current_event_state (GTK_EVENT_CONTROLLER (scroll));
 
@@ -2648,6 +2721,12 @@ gtk_scrolled_window_dispose (GObject *object)
       priv->deceleration_id = 0;
     }
 
+  if (priv->scroll_tick_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->scroll_tick_id);
+      priv->scroll_tick_id = 0;
+    }
+
   g_clear_pointer (&priv->hscrolling, gtk_kinetic_scrolling_free);
   g_clear_pointer (&priv->vscrolling, gtk_kinetic_scrolling_free);
   g_clear_handle_id (&priv->scroll_events_overshoot_id, g_source_remove);
@@ -3631,6 +3710,8 @@ gtk_scrolled_window_unmap (GtkWidget *widget)
   GtkScrolledWindow *scrolled_window = GTK_SCROLLED_WINDOW (widget);
   GtkScrolledWindowPrivate *priv = gtk_scrolled_window_get_instance_private (scrolled_window);
 
+  gtk_scrolled_window_flush_scroll (scrolled_window);
+
   GTK_WIDGET_CLASS (gtk_scrolled_window_parent_class)->unmap (widget);
 
   gtk_scrolled_window_update_animating (scrolled_window);
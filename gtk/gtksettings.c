@@ -146,6 +146,10 @@ struct _GtkSettingsPropertyValue
 {
   GValue value;
   GtkSettingsSource source;
+  /* whether the display has been asked for this setting; it
+   * tells us about changes with ::setting-changed afterwards
+   */
+  guint xsetting_checked : 1;
 };
 
 enum {
@@ -2076,6 +2080,11 @@ settings_update_xsetting (GtkSettings *settings,
   GType fundamental_type;
   gboolean retval = FALSE;
 
+  if (settings->property_values[pspec->param_id - 1].xsetting_checked && !force)
+    return FALSE;
+
+  settings->property_values[pspec->param_id - 1].xsetting_checked = TRUE;
+
   if (settings->property_values[pspec->param_id - 1].source == GTK_SETTINGS_SOURCE_APPLICATION)
     return FALSE;
 
@@ -2183,56 +2192,110 @@ gtk_settings_reset_property (GtkSettings *settings,
     g_param_value_set_default (pspec, &settings->property_values[pspec->param_id - 1].value);
 
   settings->property_values[pspec->param_id - 1].source = GTK_SETTINGS_SOURCE_DEFAULT;
+  settings->property_values[pspec->param_id - 1].xsetting_checked = FALSE;
   g_object_notify_by_pspec (G_OBJECT (settings), pspec);
 }
 
-gboolean
-gtk_settings_get_enable_animations (GtkSettings *settings)
+/* Reads a setting without going through g_object_get(). This is
+ * meant for settings that are looked up in event handlers and other
+ * hot paths; the display is only asked for the value once.
+ */
+static const GValue *
+settings_get_value (GtkSettings *settings,
+                    guint        property_id,
+                    const char  *name)
 {
-  GtkSettingsPropertyValue *svalue = &settings->property_values[PROP_ENABLE_ANIMATIONS - 1];
+  GtkSettingsPropertyValue *svalue = &settings->property_values[property_id - 1];
 
-  if (svalue->source < GTK_SETTINGS_SOURCE_XSETTING)
+  if (!svalue->xsetting_checked &&
+      svalue->source < GTK_SETTINGS_SOURCE_XSETTING)
     {
       GParamSpec *pspec;
 
-      pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (settings), "gtk-enable-animations");
+      pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (settings), name);
       if (settings_update_xsetting (settings, pspec, FALSE))
         g_object_notify_by_pspec (G_OBJECT (settings), pspec);
     }
 
-  return g_value_get_boolean (&svalue->value);
+  return &svalue->value;
+}
+
+gboolean
+gtk_settings_get_enable_animations (GtkSettings *settings)
+{
+  return g_value_get_boolean (settings_get_value (settings, PROP_ENABLE_ANIMATIONS, "gtk-enable-animations"));
 }
 
 int
 gtk_settings_get_dnd_drag_threshold (GtkSettings *settings)
 {
-  GtkSettingsPropertyValue *svalue = &settings->property_values[PROP_DND_DRAG_THRESHOLD - 1];
+  return g_value_get_int (settings_get_value (settings, PROP_DND_DRAG_THRESHOLD, "gtk-dnd-drag-threshold"));
+}
 
-  if (svalue->source < GTK_SETTINGS_SOURCE_XSETTING)
-    {
-      GParamSpec *pspec;
+int
+gtk_settings_get_double_click_time (GtkSettings *settings)
+{
+  return g_value_get_int (settings_get_value (settings, PROP_DOUBLE_CLICK_TIME, "gtk-double-click-time"));
+}
 
-      pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (settings), "gtk-dnd-drag-threshold");
-      if (settings_update_xsetting (settings, pspec, FALSE))
-        g_object_notify_by_pspec (G_OBJECT (settings), pspec);
-    }
+int
+gtk_settings_get_double_click_distance (GtkSettings *settings)
+{
+  return g_value_get_int (settings_get_value (settings, PROP_DOUBLE_CLICK_DISTANCE, "gtk-double-click-distance"));
+}
 
-  return g_value_get_int (&svalue->value);
+int
+gtk_settings_get_long_press_time (GtkSettings *settings)
+{
+  return g_value_get_int (settings_get_value (settings, PROP_LONG_PRESS_TIME, "gtk-long-press-time"));
 }
 
-static void
-settings_update_font_name (GtkSettings *settings)
+gboolean
+gtk_settings_get_cursor_blink (GtkSettings *settings)
 {
-  GtkSettingsPropertyValue *svalue = &settings->property_values[PROP_FONT_NAME - 1];
+  return g_value_get_boolean (settings_get_value (settings, PROP_CURSOR_BLINK, "gtk-cursor-blink"));
+}
 
-  if (svalue->source < GTK_SETTINGS_SOURCE_XSETTING)
-    {
-      GParamSpec *pspec;
+int
+gtk_settings_get_cursor_blink_time (GtkSettings *settings)
+{
+  return g_value_get_int (settings_get_value (settings, PROP_CURSOR_BLINK_TIME, "gtk-cursor-blink-time"));
+}
 
-      pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (settings), "gtk-font-name");
-      if (settings_update_xsetting (settings, pspec, FALSE))
-        g_object_notify_by_pspec (G_OBJECT (settings), pspec);
-    }
+int
+gtk_settings_get_cursor_blink_timeout (GtkSettings *settings)
+{
+  return g_value_get_int (settings_get_value (settings, PROP_CURSOR_BLINK_TIMEOUT, "gtk-cursor-blink-timeout"));
+}
+
+gboolean
+gtk_settings_get_enable_primary_paste (GtkSettings *settings)
+{
+  return g_value_get_boolean (settings_get_value (settings, PROP_ENABLE_PRIMARY_PASTE, "gtk-enable-primary-paste"));
+}
+
+gboolean
+gtk_settings_get_entry_select_on_focus (GtkSettings *settings)
+{
+  return g_value_get_boolean (settings_get_value (settings, PROP_ENTRY_SELECT_ON_FOCUS, "gtk-entry-select-on-focus"));
+}
+
+gboolean
+gtk_settings_get_label_select_on_focus (GtkSettings *settings)
+{
+  return g_value_get_boolean (settings_get_value (settings, PROP_LABEL_SELECT_ON_FOCUS, "gtk-label-select-on-focus"));
+}
+
+gboolean
+gtk_settings_get_keynav_use_caret (GtkSettings *settings)
+{
+  return g_value_get_boolean (settings_get_value (settings, PROP_KEYNAV_USE_CARET, "gtk-keynav-use-caret"));
+}
+
+static void
+settings_update_font_name (GtkSettings *settings)
+{
+  settings_get_value (settings, PROP_FONT_NAME, "gtk-font-name");
 }
 
 const char *
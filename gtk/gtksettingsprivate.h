@@ -45,6 +45,16 @@ GtkSettingsSource  _gtk_settings_get_setting_source (GtkSettings *settings,
 
 gboolean gtk_settings_get_enable_animations  (GtkSettings *settings);
 int      gtk_settings_get_dnd_drag_threshold (GtkSettings *settings);
+int      gtk_settings_get_double_click_time  (GtkSettings *settings);
+int      gtk_settings_get_double_click_distance (GtkSettings *settings);
+int      gtk_settings_get_long_press_time    (GtkSettings *settings);
+gboolean gtk_settings_get_cursor_blink       (GtkSettings *settings);
+int      gtk_settings_get_cursor_blink_time  (GtkSettings *settings);
+int      gtk_settings_get_cursor_blink_timeout (GtkSettings *settings);
+gboolean gtk_settings_get_enable_primary_paste (GtkSettings *settings);
+gboolean gtk_settings_get_entry_select_on_focus (GtkSettings *settings);
+gboolean gtk_settings_get_label_select_on_focus (GtkSettings *settings);
+gboolean gtk_settings_get_keynav_use_caret   (GtkSettings *settings);
 const char *gtk_settings_get_font_family    (GtkSettings *settings);
 int          gtk_settings_get_font_size      (GtkSettings *settings);
 gboolean     gtk_settings_get_font_size_is_absolute (GtkSettings *settings);
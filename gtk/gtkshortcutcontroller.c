@@ -94,6 +94,16 @@ struct _GtkShortcutController
   guint custom_shortcuts : 1;
 
   guint last_activated;
+
+  /* Built on demand, so key events only need to look at the
+   * shortcuts whose triggers can match their keyval.
+   * keyval => GArray of positions in shortcuts
+   */
+  GHashTable *trigger_index;
+  /* Positions of shortcuts with triggers that can't be indexed */
+  GArray *unindexed;
+  /* The shortcuts whose trigger changes we watch */
+  GPtrArray *indexed_shortcuts;
 };
 
 struct _GtkShortcutControllerClass
@@ -175,6 +185,210 @@ G_DEFINE_TYPE_WITH_CODE (GtkShortcutController, gtk_shortcut_controller,
                          G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_shortcut_controller_list_model_init)
                          G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE, gtk_shortcut_controller_buildable_init))
 
+static void
+gtk_shortcut_controller_invalidate_index (GtkShortcutController *self)
+{
+  guint i;
+
+  if (self->indexed_shortcuts)
+    {
+      for (i = 0; i < self->indexed_shortcuts->len; i++)
+        g_signal_handlers_disconnect_by_func (g_ptr_array_index (self->indexed_shortcuts, i),
+                                              gtk_shortcut_controller_invalidate_index,
+                                              self);
+      g_clear_pointer (&self->indexed_shortcuts, g_ptr_array_unref);
+    }
+
+  g_clear_pointer (&self->trigger_index, g_hash_table_unref);
+  g_clear_pointer (&self->unindexed, g_array_unref);
+}
+
+static void
+gtk_shortcut_controller_shortcuts_changed (GListModel            *model,
+                                           guint                  position,
+                                           guint                  removed,
+                                           guint                  added,
+                                           GtkShortcutController *self)
+{
+  gtk_shortcut_controller_invalidate_index (self);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
+}
+
+/* Shift and Caps Lock change the case of the event's keyval,
+ * so the index ignores it.
+ */
+static guint
+normalize_keyval (guint keyval)
+{
+  if (keyval == GDK_KEY_ISO_Left_Tab)
+    return GDK_KEY_Tab;
+
+  return gdk_keyval_to_lower (keyval);
+}
+
+static void
+add_position (GArray *positions,
+              guint   position)
+{
+  /* Alternatives may list the same key twice */
+  if (positions->len > 0 &&
+      g_array_index (positions, guint, positions->len - 1) == position)
+    return;
+
+  g_array_append_val (positions, position);
+}
+
+static void
+gtk_shortcut_controller_index_trigger (GtkShortcutController *self,
+                                       GtkShortcutTrigger    *trigger,
+                                       guint                  position)
+{
+  guint keyval;
+  GArray *positions;
+
+  if (GTK_IS_KEYVAL_TRIGGER (trigger))
+    {
+      keyval = gtk_keyval_trigger_get_keyval (GTK_KEYVAL_TRIGGER (trigger));
+    }
+  else if (GTK_IS_MNEMONIC_TRIGGER (trigger))
+    {
+      keyval = gtk_mnemonic_trigger_get_keyval (GTK_MNEMONIC_TRIGGER (trigger));
+    }
+  else if (GTK_IS_ALTERNATIVE_TRIGGER (trigger))
+    {
+      GtkAlternativeTrigger *alternative = GTK_ALTERNATIVE_TRIGGER (trigger);
+
+      gtk_shortcut_controller_index_trigger (self, gtk_alternative_trigger_get_first (alternative), position);
+      gtk_shortcut_controller_index_trigger (self, gtk_alternative_trigger_get_second (alternative), position);
+      return;
+    }
+  else if (GTK_IS_NEVER_TRIGGER (trigger))
+    {
+      return;
+    }
+  else
+    {
+      add_position (self->unindexed, position);
+      return;
+    }
+
+  keyval = normalize_keyval (keyval);
+  positions = g_hash_table_lookup (self->trigger_index, GUINT_TO_POINTER (keyval));
+  if (positions == NULL)
+    {
+      positions = g_array_new (FALSE, FALSE, sizeof (guint));
+      g_hash_table_insert (self->trigger_index, GUINT_TO_POINTER (keyval), positions);
+    }
+
+  add_position (positions, position);
+}
+
+static void
+gtk_shortcut_controller_build_index (GtkShortcutController *self)
+{
+  guint i, n;
+
+  self->trigger_index = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_array_unref);
+  self->unindexed = g_array_new (FALSE, FALSE, sizeof (guint));
+  self->indexed_shortcuts = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (i = 0, n = g_list_model_get_n_items (self->shortcuts); i < n; i++)
+    {
+      gpointer item = g_list_model_get_item (self->shortcuts, i);
+
+      if (!GTK_IS_SHORTCUT (item))
+        {
+          g_object_unref (item);
+          continue;
+        }
+
+      gtk_shortcut_controller_index_trigger (self, gtk_shortcut_get_trigger (item), i);
+
+      g_signal_connect_swapped (item, "notify::trigger",
+                                G_CALLBACK (gtk_shortcut_controller_invalidate_index), self);
+      g_ptr_array_add (self->indexed_shortcuts, item);
+    }
+}
+
+static void
+add_positions (GArray *candidates,
+               GArray *positions)
+{
+  if (positions)
+    g_array_append_vals (candidates, positions->data, positions->len);
+}
+
+static int
+compare_positions (gconstpointer a,
+                   gconstpointer b,
+                   gpointer      data)
+{
+  guint start = GPOINTER_TO_UINT (data);
+  guint pa = *(const guint *) a;
+  guint pb = *(const guint *) b;
+
+  /* Positions before start come after all others */
+  if ((pa < start) != (pb < start))
+    return pa < start ? 1 : -1;
+
+  return pa < pb ? -1 : (pa > pb ? 1 : 0);
+}
+
+/* Returns the positions of all shortcuts whose triggers may match
+ * @event, in the order they should be tried in, starting at @start.
+ *
+ * Besides the event's keyval, triggers can match by keycode in
+ * another layout, see gdk_key_event_matches(), so the keyvals of
+ * the event's keycode are looked up, too.
+ */
+static GArray *
+gtk_shortcut_controller_get_candidates (GtkShortcutController *self,
+                                        GdkEvent              *event,
+                                        guint                  start)
+{
+  GArray *candidates;
+  guint *keyvals;
+  int n_keyvals;
+  guint i, j;
+
+  if (self->trigger_index == NULL)
+    gtk_shortcut_controller_build_index (self);
+
+  candidates = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  add_positions (candidates,
+                 g_hash_table_lookup (self->trigger_index,
+                                      GUINT_TO_POINTER (normalize_keyval (gdk_key_event_get_keyval (event)))));
+
+  if (gdk_display_map_keycode (gdk_event_get_display (event),
+                               gdk_key_event_get_keycode (event),
+                               NULL, &keyvals, &n_keyvals))
+    {
+      for (i = 0; i < (guint) n_keyvals; i++)
+        add_positions (candidates,
+                       g_hash_table_lookup (self->trigger_index,
+                                            GUINT_TO_POINTER (normalize_keyval (keyvals[i]))));
+      g_free (keyvals);
+    }
+
+  add_positions (candidates, self->unindexed);
+
+  g_array_sort_with_data (candidates, compare_positions, GUINT_TO_POINTER (start));
+
+  /* Drop duplicates */
+  for (i = 0, j = 0; i < candidates->len; i++)
+    {
+      if (j > 0 && g_array_index (candidates, guint, j - 1) == g_array_index (candidates, guint, i))
+        continue;
+
+      g_array_index (candidates, guint, j++) = g_array_index (candidates, guint, i);
+    }
+  g_array_set_size (candidates, j);
+
+  return candidates;
+}
+
 static gboolean
 gtk_shortcut_controller_is_rooted (GtkShortcutController *self)
 {
@@ -214,10 +428,10 @@ gtk_shortcut_controller_set_property (GObject      *object,
             self->custom_shortcuts = FALSE;
           }
 
-        self->shortcuts_changed_id =  g_signal_connect_swapped (self->shortcuts,
-                                                                "items-changed",
-                                                                G_CALLBACK (g_list_model_items_changed),
-                                                                self);
+        self->shortcuts_changed_id = g_signal_connect (self->shortcuts,
+                                                       "items-changed",
+                                                       G_CALLBACK (gtk_shortcut_controller_shortcuts_changed),
+                                                       self);
       }
       break;
 
@@ -269,6 +483,7 @@ gtk_shortcut_controller_finalize (GObject *object)
 {
   GtkShortcutController *self = GTK_SHORTCUT_CONTROLLER (object);
 
+  gtk_shortcut_controller_invalidate_index (self);
   g_clear_signal_handler (&self->shortcuts_changed_id, self->shortcuts);
   g_clear_object (&self->shortcuts);
 
@@ -298,11 +513,24 @@ gtk_shortcut_controller_run_controllers (GtkEventController *controller,
 {
   GtkShortcutController *self = GTK_SHORTCUT_CONTROLLER (controller);
   int i, p;
+  GArray *candidates;
   GArray *shortcuts = NULL;
   gboolean has_exact = FALSE;
   gboolean retval = FALSE;
+  guint start;
+
+  /* This is not entirely right, but we only want to do round-robin cycling
+   * for mnemonics.
+   */
+  p = g_list_model_get_n_items (self->shortcuts);
+  if (enable_mnemonics && p > 0)
+    start = (self->last_activated + 1) % p;
+  else
+    start = 0;
+
+  candidates = gtk_shortcut_controller_get_candidates (self, event, start);
 
-  for (i = 0, p = g_list_model_get_n_items (self->shortcuts); i < p; i++)
+  for (i = 0; i < candidates->len; i++)
     {
       GtkShortcut *shortcut;
       ShortcutData *data;
@@ -310,13 +538,7 @@ gtk_shortcut_controller_run_controllers (GtkEventController *controller,
       GtkWidget *widget;
       GtkNative *native;
 
-      /* This is not entirely right, but we only want to do round-robin cycling
-       * for mnemonics.
-       */
-      if (enable_mnemonics)
-        index = (self->last_activated + 1 + i) % g_list_model_get_n_items (self->shortcuts);
-      else
-        index = i;
+      index = g_array_index (candidates, guint, i);
 
       shortcut = g_list_model_get_item (self->shortcuts, index);
       if (!GTK_IS_SHORTCUT (shortcut))
@@ -398,6 +620,8 @@ gtk_shortcut_controller_run_controllers (GtkEventController *controller,
     }
 #endif
 
+  g_array_unref (candidates);
+
   if (!shortcuts)
     return retval;
 
@@ -559,6 +783,8 @@ gtk_shortcut_controller_class_init (GtkShortcutControllerClass *klass)
   object_class->get_property = gtk_shortcut_controller_get_property;
 
   controller_class->handle_event = gtk_shortcut_controller_handle_event;
+  controller_class->event_types = GTK_EVENT_TYPE_BIT (GDK_KEY_PRESS) |
+                                  GTK_EVENT_TYPE_BIT (GDK_KEY_RELEASE);
   controller_class->set_widget = gtk_shortcut_controller_set_widget;
   controller_class->unset_widget = gtk_shortcut_controller_unset_widget;
 
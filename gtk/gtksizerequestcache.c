@@ -23,8 +23,20 @@
 
 #include "gtksizerequestcacheprivate.h"
 
+#include "gdk/gdkprofilerprivate.h"
+
 #include <string.h>
 
+/* Entries for different for_sizes are replaced least recently used
+ * first, so that the sizes a resize keeps going back and forth over
+ * stay cached. The clock is shared by all caches, which is fine as
+ * it only needs to order the entries of a single cache.
+ */
+static guint use_clock;
+
+static guint n_hits;
+static guint n_misses;
+
 void
 _gtk_size_request_cache_init (SizeRequestCache *cache)
 {
@@ -125,6 +137,7 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 	    {
 	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
 	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      cached_sizes[i]->last_use = ++use_clock;
 	      return;
 	    }
 	}
@@ -139,8 +152,15 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 	}
       else
 	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
+          guint lru = 0;
+
+          for (i = 1; i < n_sizes; i++)
+            {
+              if (cached_sizes[i]->last_use < cached_sizes[lru]->last_use)
+                lru = i;
+            }
+
+	  cache->flags[orientation].last_cached_request = lru;
 	}
 
       if (cache->requests_x == NULL)
@@ -152,6 +172,7 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
       cached_size = cache->requests_x[cache->flags[orientation].last_cached_request];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
+      cached_size->last_use = ++use_clock;
       cached_size->cached_size.minimum_size = minimum_size;
       cached_size->cached_size.natural_size = natural_size;
     }
@@ -169,6 +190,7 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 	    {
 	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
 	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      cached_sizes[i]->last_use = ++use_clock;
 	      return;
 	    }
 	}
@@ -183,8 +205,15 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 	}
       else
 	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
+          guint lru = 0;
+
+          for (i = 1; i < n_sizes; i++)
+            {
+              if (cached_sizes[i]->last_use < cached_sizes[lru]->last_use)
+                lru = i;
+            }
+
+	  cache->flags[orientation].last_cached_request = lru;
 	}
 
       if (cache->requests_y == NULL)
@@ -196,6 +225,7 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
       cached_size = cache->requests_y[cache->flags[orientation].last_cached_request];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
+      cached_size->last_use = ++use_clock;
       cached_size->cached_size.minimum_size = minimum_size;
       cached_size->cached_size.natural_size = natural_size;
       cached_size->cached_size.minimum_baseline = minimum_baseline;
@@ -209,7 +239,7 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
  * the Clutter toolkit but has evolved for other GTK requirements.
  */
 gboolean
-_gtk_size_request_cache_lookup (const SizeRequestCache *cache,
+_gtk_size_request_cache_lookup (SizeRequestCache       *cache,
                                 GtkOrientation          orientation,
                                 int                     for_size,
                                 int                    *minimum,
@@ -239,7 +269,7 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
 	  /* Search for an already cached size */
           for (i = 0, p = cache->flags[GTK_ORIENTATION_HORIZONTAL].n_cached_requests; i < p; i++)
             {
-              const SizeRequestX *cur = cache->requests_x[i];
+              SizeRequestX *cur = cache->requests_x[i];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -249,10 +279,13 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
                   *minimum = result->minimum_size;
                   *natural = result->natural_size;
 
+                  cur->last_use = ++use_clock;
+                  n_hits++;
                   return TRUE;
                 }
             }
 
+          n_misses++;
           return FALSE;
 	}
     }
@@ -278,7 +311,7 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
 	  /* Search for an already cached size */
           for (i = 0, p = cache->flags[GTK_ORIENTATION_VERTICAL].n_cached_requests; i < p; i++)
             {
-              const SizeRequestY *cur = cache->requests_y[i];
+              SizeRequestY *cur = cache->requests_y[i];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -289,12 +322,46 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
                   *natural = result->natural_size;
                   *minimum_baseline = result->minimum_baseline;
                   *natural_baseline = result->natural_baseline;
+
+                  cur->last_use = ++use_clock;
+                  n_hits++;
                   return TRUE;
                 }
             }
 
+          n_misses++;
           return FALSE;
         }
     }
 }
 
+
+/*<private>
+ * _gtk_size_request_cache_report_stats:
+ *
+ * Reports the hits and misses of height-for-width and width-for-height
+ * lookups since the last call to the profiler.
+ */
+void
+_gtk_size_request_cache_report_stats (void)
+{
+  static guint hits_counter;
+  static guint misses_counter;
+
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      if (hits_counter == 0)
+        {
+          hits_counter = gdk_profiler_define_int_counter ("size-cache-hits",
+                                                          "Size request cache hits for a given size");
+          misses_counter = gdk_profiler_define_int_counter ("size-cache-misses",
+                                                            "Size request cache misses for a given size");
+        }
+
+      gdk_profiler_set_int_counter (hits_counter, n_hits);
+      gdk_profiler_set_int_counter (misses_counter, n_misses);
+    }
+
+  n_hits = 0;
+  n_misses = 0;
+}
@@ -54,6 +54,7 @@ typedef struct
 {
   int        lower_for_size; /* The minimum for_size with the same result */
   int        upper_for_size; /* The maximum for_size with the same result */
+  guint      last_use;       /* When the entry was last looked up or committed */
   CachedSizeX cached_size;
 } SizeRequestX;
 
@@ -61,6 +62,7 @@ typedef struct
 {
   int        lower_for_size; /* The minimum for_size with the same result */
   int        upper_for_size; /* The maximum for_size with the same result */
+  guint      last_use;       /* When the entry was last looked up or committed */
   CachedSizeY cached_size;
 } SizeRequestY;
 
@@ -91,7 +93,7 @@ void            _gtk_size_request_cache_commit                  (SizeRequestCach
                                                                  int                     natural_size,
                                                                  int                     minimum_baseline,
                                                                  int                     natural_baseline);
-gboolean        _gtk_size_request_cache_lookup                  (const SizeRequestCache *cache,
+gboolean        _gtk_size_request_cache_lookup                  (SizeRequestCache       *cache,
                                                                  GtkOrientation          orientation,
                                                                  int                     for_size,
                                                                  int                    *minimum,
@@ -99,6 +101,8 @@ gboolean        _gtk_size_request_cache_lookup                  (const SizeReque
                                                                  int                    *minimum_baseline,
                                                                  int                    *natural_baseline);
 
+void            _gtk_size_request_cache_report_stats            (void);
+
 G_END_DECLS
 
 #endif /* __GTK_SIZE_REQUEST_CACHE_PRIVATE_H__ */
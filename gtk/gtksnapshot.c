@@ -149,6 +149,9 @@ struct _GdkSnapshot {
 
   GtkSnapshotStates      state_stack;
   GtkSnapshotNodes       nodes;
+
+  /* The nodes created by the snapshot itself are allocated from this */
+  GskRenderNodeArena    *arena;
 };
 
 struct _GtkSnapshotClass {
@@ -287,6 +290,8 @@ gtk_snapshot_new (void)
   gtk_snapshot_states_init (&snapshot->state_stack);
   gtk_snapshot_nodes_init (&snapshot->nodes);
 
+  snapshot->arena = gsk_render_node_arena_new ();
+
   gtk_snapshot_push_state (snapshot,
                            NULL,
                            gtk_snapshot_collect_default,
@@ -1373,10 +1378,14 @@ gtk_snapshot_pop_one (GtkSnapshot *snapshot)
 
   if (state->collect_func)
     {
+      GskRenderNodeArena *previous_arena;
+
+      previous_arena = gsk_render_node_arena_push (snapshot->arena);
       node = state->collect_func (snapshot,
                                   state,
                                   (GskRenderNode **) gtk_snapshot_nodes_index (&snapshot->nodes, state->start_node_index),
                                   state->n_nodes);
+      gsk_render_node_arena_pop (previous_arena);
 
       /* The collect func may not modify the state stack... */
       g_assert (state_index == gtk_snapshot_states_get_size (&snapshot->state_stack) - 1);
@@ -1516,6 +1525,8 @@ gtk_snapshot_to_node (GtkSnapshot *snapshot)
   gtk_snapshot_states_clear (&snapshot->state_stack);
   gtk_snapshot_nodes_clear (&snapshot->nodes);
 
+  g_clear_pointer (&snapshot->arena, gsk_render_node_arena_free);
+
   return result;
 }
 
@@ -1892,6 +1903,7 @@ cairo_t *
 gtk_snapshot_append_cairo (GtkSnapshot           *snapshot,
                            const graphene_rect_t *bounds)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   graphene_rect_t real_bounds;
   float scale_x, scale_y, dx, dy;
@@ -1903,7 +1915,9 @@ gtk_snapshot_append_cairo (GtkSnapshot           *snapshot,
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
   gtk_graphene_rect_scale_affine (bounds, scale_x, scale_y, dx, dy, &real_bounds);
 
+  previous_arena = gsk_render_node_arena_push (snapshot->arena);
   node = gsk_cairo_node_new (&real_bounds);
+  gsk_render_node_arena_pop (previous_arena);
 
   gtk_snapshot_append_node_internal (snapshot, node);
 
@@ -1930,6 +1944,7 @@ gtk_snapshot_append_texture (GtkSnapshot           *snapshot,
                              GdkTexture            *texture,
                              const graphene_rect_t *bounds)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   graphene_rect_t real_bounds;
   float scale_x, scale_y, dx, dy;
@@ -1940,7 +1955,50 @@ gtk_snapshot_append_texture (GtkSnapshot           *snapshot,
 
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
   gtk_graphene_rect_scale_affine (bounds, scale_x, scale_y, dx, dy, &real_bounds);
+  previous_arena = gsk_render_node_arena_push (snapshot->arena);
   node = gsk_texture_node_new (texture, &real_bounds);
+  gsk_render_node_arena_pop (previous_arena);
+
+  gtk_snapshot_append_node_internal (snapshot, node);
+}
+
+/**
+ * gtk_snapshot_append_scaled_texture:
+ * @snapshot: a `GtkSnapshot`
+ * @texture: the texture to render
+ * @filter: the filter to use
+ * @bounds: the bounds for the new node
+ *
+ * Creates a new render node drawing the @texture
+ * into the given @bounds and appends it to the
+ * current render node of @snapshot.
+ *
+ * In contrast to [method@Gtk.Snapshot.append_texture],
+ * this function allows to choose the filter that is
+ * used when scaling the texture.
+ *
+ * Since: 4.6
+ */
+void
+gtk_snapshot_append_scaled_texture (GtkSnapshot           *snapshot,
+                                    GdkTexture            *texture,
+                                    GskScalingFilter       filter,
+                                    const graphene_rect_t *bounds)
+{
+  GskRenderNodeArena *previous_arena;
+  GskRenderNode *node;
+  graphene_rect_t real_bounds;
+  float scale_x, scale_y, dx, dy;
+
+  g_return_if_fail (snapshot != NULL);
+  g_return_if_fail (GDK_IS_TEXTURE (texture));
+  g_return_if_fail (bounds != NULL);
+
+  gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
+  gtk_graphene_rect_scale_affine (bounds, scale_x, scale_y, dx, dy, &real_bounds);
+  previous_arena = gsk_render_node_arena_push (snapshot->arena);
+  node = gsk_texture_node_new_with_filter (texture, &real_bounds, filter);
+  gsk_render_node_arena_pop (previous_arena);
 
   gtk_snapshot_append_node_internal (snapshot, node);
 }
@@ -1963,6 +2021,7 @@ gtk_snapshot_append_color (GtkSnapshot           *snapshot,
                            const GdkRGBA         *color,
                            const graphene_rect_t *bounds)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   graphene_rect_t real_bounds;
   float scale_x, scale_y, dx, dy;
@@ -1974,7 +2033,9 @@ gtk_snapshot_append_color (GtkSnapshot           *snapshot,
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
   gtk_graphene_rect_scale_affine (bounds, scale_x, scale_y, dx, dy, &real_bounds);
 
+  previous_arena = gsk_render_node_arena_push (snapshot->arena);
   node = gsk_color_node_new (color, &real_bounds);
+  gsk_render_node_arena_pop (previous_arena);
 
   gtk_snapshot_append_node_internal (snapshot, node);
 }
@@ -2093,16 +2154,69 @@ gtk_snapshot_render_layout (GtkSnapshot     *snapshot,
                             double           x,
                             double           y,
                             PangoLayout     *layout)
+{
+  g_return_if_fail (snapshot != NULL);
+  g_return_if_fail (GTK_IS_STYLE_CONTEXT (context));
+  g_return_if_fail (PANGO_IS_LAYOUT (layout));
+
+  gtk_snapshot_render_layout_cached (snapshot, context, x, y, layout, NULL);
+}
+
+static void
+gtk_snapshot_append_layout_cached (GtkSnapshot            *snapshot,
+                                   PangoLayout            *layout,
+                                   const GdkRGBA          *color,
+                                   GtkSnapshotLayoutCache *cache)
+{
+  if (cache->layout != layout ||
+      cache->serial != pango_layout_get_serial (layout) ||
+      !gdk_rgba_equal (&cache->color, color))
+    {
+      GtkSnapshot *child;
+
+      child = gtk_snapshot_new ();
+      gtk_snapshot_append_layout (child, layout, color);
+
+      g_clear_pointer (&cache->node, gsk_render_node_unref);
+      cache->node = gtk_snapshot_free_to_node (child);
+      g_set_object (&cache->layout, layout);
+      cache->serial = pango_layout_get_serial (layout);
+      cache->color = *color;
+    }
+
+  if (cache->node)
+    gtk_snapshot_append_node (snapshot, cache->node);
+}
+
+/*<private>
+ * gtk_snapshot_render_layout_cached:
+ * @snapshot: a `GtkSnapshot`
+ * @context: the style context that defines the text
+ * @x: X origin of the rectangle
+ * @y: Y origin of the rectangle
+ * @layout: the `PangoLayout` to render
+ * @cache: (nullable): where to keep the nodes for @layout
+ *
+ * Like gtk_snapshot_render_layout(), but keeps the nodes created
+ * for @layout in @cache and reuses them for as long as neither
+ * the layout nor the text color changes.
+ *
+ * Widgets that draw the same layout in every frame should use this
+ * and call gtk_snapshot_layout_cache_clear() when disposed.
+ */
+void
+gtk_snapshot_render_layout_cached (GtkSnapshot            *snapshot,
+                                   GtkStyleContext        *context,
+                                   double                  x,
+                                   double                  y,
+                                   PangoLayout            *layout,
+                                   GtkSnapshotLayoutCache *cache)
 {
   const bool needs_translate = (x != 0 || y != 0);
   const GdkRGBA *fg_color;
   GtkCssValue *shadows_value;
   gboolean has_shadow;
 
-  g_return_if_fail (snapshot != NULL);
-  g_return_if_fail (GTK_IS_STYLE_CONTEXT (context));
-  g_return_if_fail (PANGO_IS_LAYOUT (layout));
-
   if (needs_translate)
     {
       gtk_snapshot_save (snapshot);
@@ -2114,7 +2228,10 @@ gtk_snapshot_render_layout (GtkSnapshot     *snapshot,
   shadows_value = _gtk_style_context_peek_property (context, GTK_CSS_PROPERTY_TEXT_SHADOW);
   has_shadow = gtk_css_shadow_value_push_snapshot (shadows_value, snapshot);
 
-  gtk_snapshot_append_layout (snapshot, layout, fg_color);
+  if (cache)
+    gtk_snapshot_append_layout_cached (snapshot, layout, fg_color, cache);
+  else
+    gtk_snapshot_append_layout (snapshot, layout, fg_color);
 
   if (has_shadow)
     gtk_snapshot_pop (snapshot);
@@ -2123,6 +2240,14 @@ gtk_snapshot_render_layout (GtkSnapshot     *snapshot,
     gtk_snapshot_restore (snapshot);
 }
 
+void
+gtk_snapshot_layout_cache_clear (GtkSnapshotLayoutCache *cache)
+{
+  g_clear_pointer (&cache->node, gsk_render_node_unref);
+  g_clear_object (&cache->layout);
+  cache->serial = 0;
+}
+
 void
 gtk_snapshot_append_text (GtkSnapshot           *snapshot,
                           PangoFont             *font,
@@ -2131,15 +2256,18 @@ gtk_snapshot_append_text (GtkSnapshot           *snapshot,
                           float                  x,
                           float                  y)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   float dx, dy;
 
   gtk_snapshot_ensure_translate (snapshot, &dx, &dy);
 
+  previous_arena = gsk_render_node_arena_push (snapshot->arena);
   node = gsk_text_node_new (font,
                             glyphs,
                             color,
                             &GRAPHENE_POINT_INIT (x + dx, y + dy));
+  gsk_render_node_arena_pop (previous_arena);
   if (node == NULL)
     return;
 
@@ -2165,6 +2293,7 @@ gtk_snapshot_append_linear_gradient (GtkSnapshot            *snapshot,
                                      const GskColorStop     *stops,
                                      gsize                   n_stops)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   graphene_rect_t real_bounds;
   float scale_x, scale_y, dx, dy;
@@ -2199,15 +2328,19 @@ gtk_snapshot_append_linear_gradient (GtkSnapshot            *snapshot,
       real_end_point.x = scale_x * end_point->x + dx;
       real_end_point.y = scale_y * end_point->y + dy;
 
+      previous_arena = gsk_render_node_arena_push (snapshot->arena);
       node = gsk_linear_gradient_node_new (&real_bounds,
                                            &real_start_point,
                                            &real_end_point,
                                            stops,
                                            n_stops);
+      gsk_render_node_arena_pop (previous_arena);
     }
   else
     {
+      previous_arena = gsk_render_node_arena_push (snapshot->arena);
       node = gsk_color_node_new (first_color, &real_bounds);
+      gsk_render_node_arena_pop (previous_arena);
     }
 
   gtk_snapshot_append_node_internal (snapshot, node);
@@ -2232,6 +2365,7 @@ gtk_snapshot_append_repeating_linear_gradient (GtkSnapshot            *snapshot,
                                                const GskColorStop     *stops,
                                                gsize                   n_stops)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   graphene_rect_t real_bounds;
   float scale_x, scale_y, dx, dy;
@@ -2266,15 +2400,19 @@ gtk_snapshot_append_repeating_linear_gradient (GtkSnapshot            *snapshot,
       real_end_point.x = scale_x * end_point->x + dx;
       real_end_point.y = scale_y * end_point->y + dy;
 
+      previous_arena = gsk_render_node_arena_push (snapshot->arena);
       node = gsk_repeating_linear_gradient_node_new (&real_bounds,
                                                      &real_start_point,
                                                      &real_end_point,
                                                      stops,
                                                      n_stops);
+      gsk_render_node_arena_pop (previous_arena);
     }
   else
     {
+      previous_arena = gsk_render_node_arena_push (snapshot->arena);
       node = gsk_color_node_new (first_color, &real_bounds);
+      gsk_render_node_arena_pop (previous_arena);
     }
 
   gtk_snapshot_append_node_internal (snapshot, node);
@@ -2300,6 +2438,7 @@ gtk_snapshot_append_conic_gradient (GtkSnapshot            *snapshot,
                                     const GskColorStop     *stops,
                                     gsize                   n_stops)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   graphene_rect_t real_bounds;
   float dx, dy;
@@ -2325,6 +2464,7 @@ gtk_snapshot_append_conic_gradient (GtkSnapshot            *snapshot,
         }
     }
 
+  previous_arena = gsk_render_node_arena_push (snapshot->arena);
   if (need_gradient)
     node = gsk_conic_gradient_node_new (&real_bounds,
                                         &GRAPHENE_POINT_INIT(
@@ -2336,6 +2476,7 @@ gtk_snapshot_append_conic_gradient (GtkSnapshot            *snapshot,
                                         n_stops);
   else
     node = gsk_color_node_new (first_color, &real_bounds);
+  gsk_render_node_arena_pop (previous_arena);
 
   gtk_snapshot_append_node_internal (snapshot, node);
 }
@@ -2365,6 +2506,7 @@ gtk_snapshot_append_radial_gradient (GtkSnapshot            *snapshot,
                                      const GskColorStop     *stops,
                                      gsize                   n_stops)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   graphene_rect_t real_bounds;
   float scale_x, scale_y, dx, dy;
@@ -2396,6 +2538,7 @@ gtk_snapshot_append_radial_gradient (GtkSnapshot            *snapshot,
       real_center.x = scale_x * center->x + dx;
       real_center.y = scale_y * center->y + dy;
 
+      previous_arena = gsk_render_node_arena_push (snapshot->arena);
       node = gsk_radial_gradient_node_new (&real_bounds,
                                            &real_center,
                                            hradius * scale_x,
@@ -2404,10 +2547,13 @@ gtk_snapshot_append_radial_gradient (GtkSnapshot            *snapshot,
                                            end,
                                            stops,
                                            n_stops);
+      gsk_render_node_arena_pop (previous_arena);
     }
   else
     {
+      previous_arena = gsk_render_node_arena_push (snapshot->arena);
       node = gsk_color_node_new (first_color, &real_bounds);
+      gsk_render_node_arena_pop (previous_arena);
     }
 
   gtk_snapshot_append_node_internal (snapshot, node);
@@ -2438,6 +2584,7 @@ gtk_snapshot_append_repeating_radial_gradient (GtkSnapshot            *snapshot,
                                                const GskColorStop     *stops,
                                                gsize                   n_stops)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   graphene_rect_t real_bounds;
   float scale_x, scale_y, dx, dy;
@@ -2468,6 +2615,7 @@ gtk_snapshot_append_repeating_radial_gradient (GtkSnapshot            *snapshot,
 
       real_center.x = scale_x * center->x + dx;
       real_center.y = scale_y * center->y + dy;
+      previous_arena = gsk_render_node_arena_push (snapshot->arena);
       node = gsk_repeating_radial_gradient_node_new (&real_bounds,
                                                      &real_center,
                                                      hradius * scale_x,
@@ -2476,10 +2624,13 @@ gtk_snapshot_append_repeating_radial_gradient (GtkSnapshot            *snapshot,
                                                      end,
                                                      stops,
                                                      n_stops);
+      gsk_render_node_arena_pop (previous_arena);
     }
   else
     {
+      previous_arena = gsk_render_node_arena_push (snapshot->arena);
       node = gsk_color_node_new (first_color, &real_bounds);
+      gsk_render_node_arena_pop (previous_arena);
     }
 
   gtk_snapshot_append_node_internal (snapshot, node);
@@ -2504,6 +2655,7 @@ gtk_snapshot_append_border (GtkSnapshot          *snapshot,
                             const float           border_width[4],
                             const GdkRGBA         border_color[4])
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   GskRoundedRect real_outline;
   float scale_x, scale_y, dx, dy;
@@ -2516,6 +2668,7 @@ gtk_snapshot_append_border (GtkSnapshot          *snapshot,
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &dx, &dy);
   gsk_rounded_rect_scale_affine (&real_outline, outline, scale_x, scale_y, dx, dy);
 
+  previous_arena = gsk_render_node_arena_push (snapshot->arena);
   node = gsk_border_node_new (&real_outline,
                               (float[4]) { 
                                 border_width[0] * scale_y,
@@ -2524,6 +2677,7 @@ gtk_snapshot_append_border (GtkSnapshot          *snapshot,
                                 border_width[3] * scale_x,
                               },
                               border_color);
+  gsk_render_node_arena_pop (previous_arena);
 
   gtk_snapshot_append_node_internal (snapshot, node);
 }
@@ -2549,6 +2703,7 @@ gtk_snapshot_append_inset_shadow (GtkSnapshot          *snapshot,
                                   float                 spread,
                                   float                 blur_radius)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   GskRoundedRect real_outline;
   float scale_x, scale_y, x, y;
@@ -2560,12 +2715,14 @@ gtk_snapshot_append_inset_shadow (GtkSnapshot          *snapshot,
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &x, &y);
   gsk_rounded_rect_scale_affine (&real_outline, outline, scale_x, scale_y, x, y);
 
+  previous_arena = gsk_render_node_arena_push (snapshot->arena);
   node = gsk_inset_shadow_node_new (&real_outline,
                                     color,
                                     scale_x * dx,
                                     scale_y * dy,
                                     spread,
                                     blur_radius);
+  gsk_render_node_arena_pop (previous_arena);
 
   gtk_snapshot_append_node_internal (snapshot, node);
 }
@@ -2591,6 +2748,7 @@ gtk_snapshot_append_outset_shadow (GtkSnapshot          *snapshot,
                                    float                 spread,
                                    float                 blur_radius)
 {
+  GskRenderNodeArena *previous_arena;
   GskRenderNode *node;
   GskRoundedRect real_outline;
   float scale_x, scale_y, x, y;
@@ -2602,12 +2760,14 @@ gtk_snapshot_append_outset_shadow (GtkSnapshot          *snapshot,
   gtk_snapshot_ensure_affine (snapshot, &scale_x, &scale_y, &x, &y);
   gsk_rounded_rect_scale_affine (&real_outline, outline, scale_x, scale_y, x, y);
 
+  previous_arena = gsk_render_node_arena_push (snapshot->arena);
   node = gsk_outset_shadow_node_new (&real_outline,
                                      color,
                                      scale_x * dx,
                                      scale_y * dy,
                                      spread,
                                      blur_radius);
+  gsk_render_node_arena_pop (previous_arena);
 
 
   gtk_snapshot_append_node_internal (snapshot, node);
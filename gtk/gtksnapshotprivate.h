@@ -24,6 +24,22 @@
 
 G_BEGIN_DECLS
 
+typedef struct
+{
+  PangoLayout   *layout;
+  guint          serial;
+  GdkRGBA        color;
+  GskRenderNode *node;
+} GtkSnapshotLayoutCache;
+
+void                    gtk_snapshot_render_layout_cached       (GtkSnapshot            *snapshot,
+                                                                 GtkStyleContext        *context,
+                                                                 double                  x,
+                                                                 double                  y,
+                                                                 PangoLayout            *layout,
+                                                                 GtkSnapshotLayoutCache *cache);
+void                    gtk_snapshot_layout_cache_clear         (GtkSnapshotLayoutCache *cache);
+
 void                    gtk_snapshot_append_text                (GtkSnapshot            *snapshot,
                                                                  PangoFont              *font,
                                                                  PangoGlyphString       *glyphs,
@@ -95,6 +95,48 @@ gtk_sort_keys_needs_clear_key (GtkSortKeys *self)
   return self->klass->clear_key != NULL;
 }
 
+/*<private>
+ * gtk_sort_keys_is_thread_safe:
+ * @self: a `GtkSortKeys`
+ *
+ * Checks if keys can be compared from other threads than the one
+ * they were created in, once they have been initialized.
+ *
+ * Returns: %TRUE if comparing keys is thread-safe
+ */
+gboolean
+gtk_sort_keys_is_thread_safe (GtkSortKeys *self)
+{
+  return self->klass->is_thread_safe != NULL &&
+         self->klass->is_thread_safe (self);
+}
+
+/* For keys whose key_compare only looks at the key memory */
+gboolean
+gtk_sort_keys_always_thread_safe (GtkSortKeys *self)
+{
+  return TRUE;
+}
+
+/*<private>
+ * gtk_sort_keys_can_pack:
+ * @self: a `GtkSortKeys`
+ *
+ * Checks if keys can be converted into a byte string that sorts
+ * the same when compared with memcmp().
+ *
+ * Such keys can be concatenated into a single key, so combined
+ * sorters can compare them with a single memcmp() instead of
+ * comparing every part on its own.
+ *
+ * Returns: %TRUE if gtk_sort_keys_pack_key() can be used
+ */
+gboolean
+gtk_sort_keys_can_pack (GtkSortKeys *self)
+{
+  return self->klass->pack_key != NULL;
+}
+
 static void
 gtk_equal_sort_keys_free (GtkSortKeys *keys)
 {
@@ -123,13 +165,22 @@ gtk_equal_sort_keys_init_key (GtkSortKeys *keys,
 {
 }
 
+static void
+gtk_equal_sort_keys_pack_key (GtkSortKeys   *keys,
+                              gconstpointer  key_memory,
+                              guchar        *packed)
+{
+}
+
 static const GtkSortKeysClass GTK_EQUAL_SORT_KEYS_CLASS =
 {
   gtk_equal_sort_keys_free,
   gtk_equal_sort_keys_compare,
   gtk_equal_sort_keys_is_compatible,
   gtk_equal_sort_keys_init_key,
-  NULL
+  NULL,
+  gtk_sort_keys_always_thread_safe,
+  gtk_equal_sort_keys_pack_key
 };
 
 /*<private>
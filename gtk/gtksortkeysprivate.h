@@ -48,6 +48,13 @@ struct _GtkSortKeysClass
                                                                  gpointer                key_memory);
   void                  (* clear_key)                           (GtkSortKeys            *self,
                                                                  gpointer                key_memory);
+  /* TRUE if key_compare may be called from other threads. NULL means FALSE. */
+  gboolean              (* is_thread_safe)                      (GtkSortKeys            *self);
+  /* Writes key_size bytes that sort with memcmp() like key_compare
+   * sorts the key. NULL if the keys can't be packed like that. */
+  void                  (* pack_key)                            (GtkSortKeys            *self,
+                                                                 gconstpointer           key_memory,
+                                                                 guchar                 *packed);
 };
 
 GtkSortKeys *           gtk_sort_keys_alloc                     (const GtkSortKeysClass *klass,
@@ -67,6 +74,9 @@ GCompareDataFunc        gtk_sort_keys_get_key_compare_func      (GtkSortKeys
 gboolean                gtk_sort_keys_is_compatible             (GtkSortKeys            *self,
                                                                  GtkSortKeys            *other);
 gboolean                gtk_sort_keys_needs_clear_key           (GtkSortKeys            *self);
+gboolean                gtk_sort_keys_is_thread_safe            (GtkSortKeys            *self);
+gboolean                gtk_sort_keys_always_thread_safe        (GtkSortKeys            *self);
+gboolean                gtk_sort_keys_can_pack                  (GtkSortKeys            *self);
 
 #define GTK_SORT_KEYS_ALIGN(_size,_align) (((_size) + (_align) - 1) & ~((_align) - 1))
 static inline int
@@ -93,5 +103,13 @@ gtk_sort_keys_clear_key (GtkSortKeys *self,
     self->klass->clear_key (self, key_memory);
 }
 
+static inline void
+gtk_sort_keys_pack_key (GtkSortKeys   *self,
+                        gconstpointer  key_memory,
+                        guchar        *packed)
+{
+  self->klass->pack_key (self, key_memory, packed);
+}
+
 #endif /* __GTK_SORT_KEYS_PRIVATE_H__ */
 
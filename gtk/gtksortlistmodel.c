@@ -52,6 +52,20 @@
  */
 #define GTK_SORT_STEP_TIME_US (1000) /* 1 millisecond */
 
+/* Minimum number of items for sorting on worker threads
+ *
+ * Below this, incremental sorting finishes quickly enough that starting
+ * threads and copying the items is not worth it.
+ */
+#define GTK_SORT_PARALLEL_MIN_ITEMS (50000)
+
+/* How often we check on the worker threads and update the pending property */
+#define GTK_SORT_PARALLEL_POLL_MS (16)
+
+/* How many items a merge on a worker thread handles between checks for
+ * cancellation */
+#define GTK_SORT_PARALLEL_CANCEL_CHECK (4096)
+
 /**
  * GtkSortListModel:
  *
@@ -85,6 +99,8 @@ enum {
   NUM_PROPERTIES
 };
 
+typedef struct _GtkSortParallel GtkSortParallel;
+
 struct _GtkSortListModel
 {
   GObject parent_instance;
@@ -95,6 +111,7 @@ struct _GtkSortListModel
 
   GtkTimSort sort; /* ongoing sort operation */
   guint sort_cb; /* 0 or current ongoing sort callback */
+  GtkSortParallel *parallel; /* sort running on worker threads, replaces the incremental sort */
 
   guint n_items;
   GtkSortKeys *sort_keys;
@@ -176,6 +193,241 @@ gtk_sort_list_model_model_init (GListModelInterface *iface)
 G_DEFINE_TYPE_WITH_CODE (GtkSortListModel, gtk_sort_list_model, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_sort_list_model_model_init))
 
+static int
+sort_func (gconstpointer a,
+           gconstpointer b,
+           gpointer      data)
+{
+  gpointer *sa = (gpointer *) a;
+  gpointer *sb = (gpointer *) b;
+  int result;
+
+  result = gtk_sort_keys_compare (data, *sa, *sb);
+  if (result)
+    return result;
+
+  return *sa < *sb ? -1 : 1;
+}
+
+/* A parallel sort works on a copy of the positions, so the model keeps
+ * working while it runs. The copy is split into one chunk per thread,
+ * and each chunk is sorted. Then neighbouring runs are merged in rounds,
+ * each round merging on as many threads as there are pairs, until only
+ * one run remains.
+ *
+ * The keys are only read, and all changes to them first stop the sort
+ * with gtk_sort_list_model_stop_sorting(), which waits for the threads.
+ */
+struct _GtkSortParallel
+{
+  GtkSortKeys *sort_keys;
+  gsize n_items;
+
+  gpointer *src;                /* runs to sort or merge in the current round */
+  gpointer *dest;               /* where the merged runs go */
+  gsize run_size;               /* size of the runs in src */
+  gsize total_work;             /* progress when done */
+
+  int progress;                 /* atomic, items sorted or merged so far */
+  int cancelled;                /* atomic */
+
+  GMutex mutex;
+  GCond cond;
+  guint n_tasks;                /* tasks queued or running in this round, protected by mutex */
+  gboolean done;                /* protected by mutex */
+};
+
+typedef struct {
+  GtkSortParallel *parallel;
+  gsize start;
+} GtkSortParallelTask;
+
+static GThreadPool *sort_pool = NULL;
+
+static void
+gtk_sort_parallel_merge (GtkSortParallel *parallel,
+                         gsize            start)
+{
+  gsize mid, end, i, j, k;
+
+  mid = MIN (start + parallel->run_size, parallel->n_items);
+  end = MIN (start + 2 * parallel->run_size, parallel->n_items);
+
+  i = start;
+  j = mid;
+  k = start;
+
+  while (i < mid && j < end)
+    {
+      if (sort_func (&parallel->src[i], &parallel->src[j], parallel->sort_keys) < 0)
+        parallel->dest[k++] = parallel->src[i++];
+      else
+        parallel->dest[k++] = parallel->src[j++];
+
+      if ((k & (GTK_SORT_PARALLEL_CANCEL_CHECK - 1)) == 0 &&
+          g_atomic_int_get (&parallel->cancelled))
+        return;
+    }
+
+  memcpy (&parallel->dest[k], &parallel->src[i], (mid - i) * sizeof (gpointer));
+  k += mid - i;
+  memcpy (&parallel->dest[k], &parallel->src[j], (end - j) * sizeof (gpointer));
+
+  g_atomic_int_add (&parallel->progress, end - start);
+}
+
+/* Must be called with the mutex held */
+static void
+gtk_sort_parallel_queue_round (GtkSortParallel *parallel,
+                               gsize            step)
+{
+  gsize start;
+
+  for (start = 0; start < parallel->n_items; start += step)
+    {
+      GtkSortParallelTask *task = g_new (GtkSortParallelTask, 1);
+
+      task->parallel = parallel;
+      task->start = start;
+      parallel->n_tasks++;
+      g_thread_pool_push (sort_pool, task, NULL);
+    }
+}
+
+static void
+gtk_sort_parallel_run_task (gpointer data,
+                            gpointer unused)
+{
+  GtkSortParallelTask *task = data;
+  GtkSortParallel *parallel = task->parallel;
+  gsize start = task->start;
+
+  g_free (task);
+
+  if (!g_atomic_int_get (&parallel->cancelled))
+    {
+      if (parallel->dest == NULL)
+        {
+          gsize len = MIN (parallel->run_size, parallel->n_items - start);
+
+          gtk_tim_sort (&parallel->src[start], len, sizeof (gpointer), sort_func, parallel->sort_keys);
+          g_atomic_int_add (&parallel->progress, len);
+        }
+      else
+        {
+          gtk_sort_parallel_merge (parallel, start);
+        }
+    }
+
+  g_mutex_lock (&parallel->mutex);
+
+  parallel->n_tasks--;
+  if (parallel->n_tasks == 0)
+    {
+      /* The last task of a round starts the next one */
+      if (parallel->dest != NULL)
+        {
+          gpointer *tmp = parallel->src;
+          parallel->src = parallel->dest;
+          parallel->dest = tmp;
+          parallel->run_size *= 2;
+        }
+      else
+        {
+          parallel->dest = g_new (gpointer, parallel->n_items);
+        }
+
+      if (parallel->run_size >= parallel->n_items ||
+          g_atomic_int_get (&parallel->cancelled))
+        {
+          parallel->done = TRUE;
+          g_cond_signal (&parallel->cond);
+        }
+      else
+        {
+          gtk_sort_parallel_queue_round (parallel, 2 * parallel->run_size);
+        }
+    }
+
+  g_mutex_unlock (&parallel->mutex);
+}
+
+static GtkSortParallel *
+gtk_sort_parallel_new (GtkSortKeys *sort_keys,
+                       gpointer    *positions,
+                       gsize        n_items)
+{
+  GtkSortParallel *parallel;
+  guint n_threads, n_rounds;
+
+  n_threads = g_get_num_processors ();
+  if (sort_pool == NULL)
+    sort_pool = g_thread_pool_new (gtk_sort_parallel_run_task, NULL, n_threads, FALSE, NULL);
+
+  parallel = g_new0 (GtkSortParallel, 1);
+  parallel->sort_keys = gtk_sort_keys_ref (sort_keys);
+  parallel->n_items = n_items;
+  parallel->src = g_memdup2 (positions, n_items * sizeof (gpointer));
+  parallel->run_size = (n_items + n_threads - 1) / n_threads;
+
+  n_rounds = 0;
+  while ((parallel->run_size << n_rounds) < n_items)
+    n_rounds++;
+  parallel->total_work = n_items * (n_rounds + 1);
+
+  g_mutex_init (&parallel->mutex);
+  g_cond_init (&parallel->cond);
+
+  g_mutex_lock (&parallel->mutex);
+  gtk_sort_parallel_queue_round (parallel, parallel->run_size);
+  g_mutex_unlock (&parallel->mutex);
+
+  return parallel;
+}
+
+static gboolean
+gtk_sort_parallel_is_done (GtkSortParallel *parallel)
+{
+  gboolean done;
+
+  g_mutex_lock (&parallel->mutex);
+  done = parallel->done;
+  g_mutex_unlock (&parallel->mutex);
+
+  return done;
+}
+
+static void
+gtk_sort_parallel_wait (GtkSortParallel *parallel)
+{
+  g_mutex_lock (&parallel->mutex);
+  while (!parallel->done)
+    g_cond_wait (&parallel->cond, &parallel->mutex);
+  g_mutex_unlock (&parallel->mutex);
+}
+
+static guint
+gtk_sort_parallel_get_pending (GtkSortParallel *parallel)
+{
+  gsize progress = g_atomic_int_get (&parallel->progress);
+
+  return parallel->n_items - (guint) ((double) parallel->n_items * progress / parallel->total_work);
+}
+
+static void
+gtk_sort_parallel_free (GtkSortParallel *parallel)
+{
+  g_atomic_int_set (&parallel->cancelled, TRUE);
+  gtk_sort_parallel_wait (parallel);
+
+  g_mutex_clear (&parallel->mutex);
+  g_cond_clear (&parallel->cond);
+  gtk_sort_keys_unref (parallel->sort_keys);
+  g_free (parallel->src);
+  g_free (parallel->dest);
+  g_free (parallel);
+}
+
 static gboolean
 gtk_sort_list_model_is_sorting (GtkSortListModel *self)
 {
@@ -196,6 +448,8 @@ gtk_sort_list_model_stop_sorting (GtkSortListModel *self,
       return;
     }
 
+  g_clear_pointer (&self->parallel, gtk_sort_parallel_free);
+
   if (runs)
     gtk_tim_sort_get_runs (&self->sort, runs);
   gtk_tim_sort_finish (&self->sort);
@@ -272,38 +526,88 @@ gtk_sort_list_model_sort_step (GtkSortListModel *self,
   return result;
 }
 
+/* Takes over the result of a finished parallel sort */
+static void
+gtk_sort_list_model_finish_parallel (GtkSortListModel *self,
+                                     guint            *out_position,
+                                     guint            *out_n_items)
+{
+  gpointer *sorted = self->parallel->src;
+  guint start, end;
+
+  for (start = 0; start < self->n_items; start++)
+    {
+      if (self->positions[start] != sorted[start])
+        break;
+    }
+  for (end = self->n_items; end > start; end--)
+    {
+      if (self->positions[end - 1] != sorted[end - 1])
+        break;
+    }
+
+  memcpy (self->positions, sorted, self->n_items * sizeof (gpointer));
+  g_clear_pointer (&self->parallel, gtk_sort_parallel_free);
+
+  *out_position = end > start ? start : 0;
+  *out_n_items = end - start;
+}
+
 static gboolean
-gtk_sort_list_model_sort_cb (gpointer data)
+gtk_sort_list_model_parallel_cb (gpointer data)
 {
   GtkSortListModel *self = data;
   guint pos, n_items;
 
-  if (gtk_sort_list_model_sort_step (self, FALSE, &pos, &n_items))
+  if (!gtk_sort_parallel_is_done (self->parallel))
     {
-      if (n_items)
-        g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
       return G_SOURCE_CONTINUE;
     }
 
+  gtk_sort_list_model_finish_parallel (self, &pos, &n_items);
   gtk_sort_list_model_stop_sorting (self, NULL);
+
+  if (n_items)
+    g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
+
   return G_SOURCE_REMOVE;
 }
 
-static int
-sort_func (gconstpointer a,
-           gconstpointer b,
-           gpointer      data)
+static gboolean
+gtk_sort_list_model_should_sort_parallel (GtkSortListModel *self)
 {
-  gpointer *sa = (gpointer *) a;
-  gpointer *sb = (gpointer *) b;
-  int result;
+  return self->n_items >= GTK_SORT_PARALLEL_MIN_ITEMS &&
+         gtk_bitset_is_empty (self->missing_keys) &&
+         g_get_num_processors () > 1 &&
+         gtk_sort_keys_is_thread_safe (self->sort_keys);
+}
 
-  result = gtk_sort_keys_compare (data, *sa, *sb);
-  if (result)
-    return result;
+static gboolean
+gtk_sort_list_model_sort_cb (gpointer data)
+{
+  GtkSortListModel *self = data;
+  guint pos, n_items;
 
-  return *sa < *sb ? -1 : 1;
+  /* Once all keys exist, the rest can be done on other threads */
+  if (gtk_sort_list_model_should_sort_parallel (self))
+    {
+      self->parallel = gtk_sort_parallel_new (self->sort_keys, self->positions, self->n_items);
+      self->sort_cb = g_timeout_add (GTK_SORT_PARALLEL_POLL_MS, gtk_sort_list_model_parallel_cb, self);
+      gdk_source_set_static_name_by_id (self->sort_cb, "[gtk] gtk_sort_list_model_parallel_cb");
+      return G_SOURCE_REMOVE;
+    }
+
+  if (gtk_sort_list_model_sort_step (self, FALSE, &pos, &n_items))
+    {
+      if (n_items)
+        g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+      return G_SOURCE_CONTINUE;
+    }
+
+  gtk_sort_list_model_stop_sorting (self, NULL);
+  return G_SOURCE_REMOVE;
 }
 
 static gboolean
@@ -336,6 +640,14 @@ gtk_sort_list_model_finish_sorting (GtkSortListModel *self,
                                     guint            *pos,
                                     guint            *n_items)
 {
+  if (self->parallel)
+    {
+      gtk_sort_parallel_wait (self->parallel);
+      gtk_sort_list_model_finish_parallel (self, pos, n_items);
+      gtk_sort_list_model_stop_sorting (self, NULL);
+      return;
+    }
+
   gtk_tim_sort_set_max_merge_size (&self->sort, 0);
 
   gtk_sort_list_model_sort_step (self, TRUE, pos, n_items);
@@ -986,6 +1298,12 @@ gtk_sort_list_model_get_sorter (GtkSortListModel *self)
  * turning this on. Depending on your model and sorters, this may become
  * interesting around 10,000 to 100,000 items.
  *
+ * For large models, once the sort keys have been created, sorters
+ * that compare their keys without looking at the items, like
+ * `GtkStringSorter`, `GtkNumericSorter` and `GtkMultiSorter`s made
+ * of them, do the actual sorting on worker threads. In that case the
+ * items appear in their sorted order in one step when sorting is done.
+ *
  * By default, incremental sorting is disabled.
  *
  * See [method@Gtk.SortListModel.get_pending] for progress information
@@ -1064,6 +1382,10 @@ gtk_sort_list_model_get_pending (GtkSortListModel *self)
   if (self->sort_cb == 0)
     return 0;
 
+  /* Keys are complete when a parallel sort starts */
+  if (self->parallel)
+    return gtk_sort_parallel_get_pending (self->parallel) / 2;
+
   /* We do a random guess that 50% of time is spent generating keys
    * and the other 50% is spent actually sorting.
    *
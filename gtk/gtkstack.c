@@ -28,6 +28,8 @@
 #include "gtkatcontextprivate.h"
 #include "gtkprivate.h"
 #include "gtkintl.h"
+#include "gtkbuilderprivate.h"
+#include "gtklazywidgetprivate.h"
 #include "gtkprogresstrackerprivate.h"
 #include "gtksettingsprivate.h"
 #include "gtksnapshot.h"
@@ -79,6 +81,22 @@
  *     </child>
  * ```
  *
+ * Pages that are rarely shown can wrap their child in a `<lazy>`
+ * element instead. The child is then only built when the page
+ * first becomes the visible child. Until then, the page has no
+ * size, and objects inside it can not be looked up on the builder:
+ *
+ * ```xml
+ *   <object class="GtkStackPage">
+ *     <property name="name">page2</property>
+ *     <lazy>
+ *       <object class="GtkLabel">
+ *         <property name="label">It was light</property>
+ *       </object>
+ *     </lazy>
+ *   </object>
+ * ```
+ *
  * # CSS nodes
  *
  * `GtkStack` has a single CSS node named stack.
@@ -150,6 +168,7 @@ typedef struct {
   guint transition_duration;
 
   GtkStackPage *last_visible_child;
+  GskRenderNode *last_visible_node;
   guint tick_id;
   GtkProgressTracker tracker;
   gboolean first_frame_skipped;
@@ -261,9 +280,61 @@ gtk_stack_page_accessible_init (GtkAccessibleInterface *iface)
   iface->get_platform_state = gtk_stack_page_accessible_get_platform_state;
 }
 
+static gboolean
+gtk_stack_page_buildable_custom_tag_start (GtkBuildable       *buildable,
+                                           GtkBuilder         *builder,
+                                           GObject            *child,
+                                           const char         *tagname,
+                                           GtkBuildableParser *parser,
+                                           gpointer           *parser_data)
+{
+  if (strcmp (tagname, "lazy") == 0)
+    {
+      _gtk_builder_lazy_tag_start (builder, parser, parser_data);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+gtk_stack_page_buildable_custom_tag_end (GtkBuildable *buildable,
+                                         GtkBuilder   *builder,
+                                         GObject      *child,
+                                         const char   *tagname,
+                                         gpointer      parser_data)
+{
+  GtkStackPage *page = GTK_STACK_PAGE (buildable);
+  GtkWidget *widget;
+
+  if (strcmp (tagname, "lazy") != 0)
+    return;
+
+  widget = _gtk_builder_lazy_tag_end (builder, parser_data);
+  if (widget == NULL)
+    return;
+
+  if (page->widget == NULL)
+    page->widget = widget;
+  else
+    {
+      g_warning ("GtkStackPage already has a child, ignoring <lazy>");
+      g_object_unref (widget);
+    }
+}
+
+static void
+gtk_stack_page_buildable_init (GtkBuildableIface *iface)
+{
+  iface->custom_tag_start = gtk_stack_page_buildable_custom_tag_start;
+  iface->custom_tag_end = gtk_stack_page_buildable_custom_tag_end;
+}
+
 G_DEFINE_TYPE_WITH_CODE (GtkStackPage, gtk_stack_page, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (GTK_TYPE_ACCESSIBLE,
-                                                gtk_stack_page_accessible_init))
+                                                gtk_stack_page_accessible_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE,
+                                                gtk_stack_page_buildable_init))
 
 static void
 gtk_stack_page_init (GtkStackPage *page)
@@ -711,6 +782,8 @@ gtk_stack_finalize (GObject *obj)
 
   gtk_stack_unschedule_ticks (stack);
 
+  g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
+
   G_OBJECT_CLASS (gtk_stack_parent_class)->finalize (obj);
 }
 
@@ -1095,6 +1168,7 @@ gtk_stack_progress_updated (GtkStack *stack)
     {
       gtk_widget_set_child_visible (priv->last_visible_child->widget, FALSE);
       priv->last_visible_child = NULL;
+      g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
     }
 }
 
@@ -1204,6 +1278,44 @@ effective_transition_type (GtkStack               *stack,
     }
 }
 
+/* The outgoing page is not going to change in any way that matters
+ * during the transition, so we render it once when the transition
+ * starts and use that node for every frame, instead of allocating
+ * and snapshotting it again.
+ *
+ * The node is in the coordinates of the child, which matches how
+ * the child would be allocated at 0,0 during the transition.
+ */
+static void
+gtk_stack_capture_last_child (GtkStack *stack)
+{
+  GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
+  GtkWidget *child = priv->last_visible_child->widget;
+  GtkSnapshot *snapshot;
+
+  g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
+
+  if (!gtk_widget_is_drawable (child) || gtk_widget_needs_allocate (child))
+    return;
+
+  snapshot = gtk_snapshot_new ();
+  gtk_widget_snapshot (child, snapshot);
+  priv->last_visible_node = gtk_snapshot_free_to_node (snapshot);
+}
+
+static void
+gtk_stack_snapshot_last_child (GtkWidget   *widget,
+                               GtkSnapshot *snapshot)
+{
+  GtkStack *stack = GTK_STACK (widget);
+  GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
+
+  if (priv->last_visible_node)
+    gtk_snapshot_append_node (snapshot, priv->last_visible_node);
+  else
+    gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+}
+
 static void
 gtk_stack_start_transition (GtkStack               *stack,
                             GtkStackTransitionType  transition_type,
@@ -1220,6 +1332,7 @@ gtk_stack_start_transition (GtkStack               *stack,
     {
       priv->active_transition_type = effective_transition_type (stack, transition_type);
       priv->first_frame_skipped = FALSE;
+      gtk_stack_capture_last_child (stack);
       gtk_stack_schedule_ticks (stack);
       gtk_progress_tracker_start (&priv->tracker,
                                   priv->transition_duration * 1000,
@@ -1274,6 +1387,10 @@ set_visible_child (GtkStack               *stack,
   if (child_info == priv->visible_child)
     return;
 
+  /* Build lazy children before anything measures them */
+  if (child_info && GTK_IS_LAZY_WIDGET (child_info->widget))
+    gtk_lazy_widget_ensure_child (GTK_LAZY_WIDGET (child_info->widget));
+
   if (priv->pages)
     {
       guint position;
@@ -1309,6 +1426,7 @@ set_visible_child (GtkStack               *stack,
   if (priv->last_visible_child)
     gtk_widget_set_child_visible (priv->last_visible_child->widget, FALSE);
   priv->last_visible_child = NULL;
+  g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
 
   if (priv->visible_child && priv->visible_child->widget)
     {
@@ -1405,6 +1523,7 @@ update_child_visible (GtkStack     *stack,
     {
       gtk_widget_set_child_visible (priv->last_visible_child->widget, FALSE);
       priv->last_visible_child = NULL;
+      g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
     }
 
   gtk_accessible_update_state (GTK_ACCESSIBLE (child_info),
@@ -1585,7 +1704,10 @@ stack_remove (GtkStack  *stack,
     priv->visible_child = NULL;
 
   if (priv->last_visible_child == child_info)
-    priv->last_visible_child = NULL;
+    {
+      priv->last_visible_child = NULL;
+      g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
+    }
 
   gtk_widget_unparent (child);
 
@@ -2195,9 +2317,7 @@ gtk_stack_snapshot_crossfade (GtkWidget   *widget,
 
   if (priv->last_visible_child)
     {
-      gtk_widget_snapshot_child (widget,
-                                 priv->last_visible_child->widget,
-                                 snapshot);
+      gtk_stack_snapshot_last_child (widget, snapshot);
     }
   gtk_snapshot_pop (snapshot);
 
@@ -2261,7 +2381,7 @@ gtk_stack_snapshot_under (GtkWidget   *widget,
     {
       gtk_snapshot_save (snapshot);
       gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (pos_x, pos_y));
-      gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+      gtk_stack_snapshot_last_child (widget, snapshot);
       gtk_snapshot_restore (snapshot);
     }
 }
@@ -2297,7 +2417,7 @@ gtk_stack_snapshot_cube (GtkWidget   *widget,
                                  - gtk_widget_get_height (widget) / 2.f,
                                  gtk_widget_get_width (widget) / 2.f));
       if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_ROTATE_LEFT)
-        gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+        gtk_stack_snapshot_last_child (widget, snapshot);
       else
         gtk_widget_snapshot_child (widget, priv->visible_child->widget, snapshot);
       gtk_snapshot_restore (snapshot);
@@ -2321,7 +2441,7 @@ gtk_stack_snapshot_cube (GtkWidget   *widget,
   if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_ROTATE_LEFT)
     gtk_widget_snapshot_child (widget, priv->visible_child->widget, snapshot);
   else if (priv->last_visible_child)
-    gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+    gtk_stack_snapshot_last_child (widget, snapshot);
   gtk_snapshot_restore (snapshot);
 
   if (priv->last_visible_child && progress <= 0.5)
@@ -2341,7 +2461,7 @@ gtk_stack_snapshot_cube (GtkWidget   *widget,
                                  - gtk_widget_get_height (widget) / 2.f,
                                  gtk_widget_get_width (widget) / 2.f));
       if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_ROTATE_LEFT)
-        gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+        gtk_stack_snapshot_last_child (widget, snapshot);
       else
         gtk_widget_snapshot_child (widget, priv->visible_child->widget, snapshot);
       gtk_snapshot_restore (snapshot);
@@ -2404,7 +2524,7 @@ gtk_stack_snapshot_slide (GtkWidget   *widget,
 
       gtk_snapshot_save (snapshot);
       gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (x, y));
-      gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+      gtk_stack_snapshot_last_child (widget, snapshot);
       gtk_snapshot_restore (snapshot);
      }
 
@@ -2487,7 +2607,8 @@ gtk_stack_size_allocate (GtkWidget *widget,
   GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
   GtkAllocation child_allocation;
 
-  if (priv->last_visible_child)
+  /* No need to allocate the outgoing page if we're using a capture of it */
+  if (priv->last_visible_child && priv->last_visible_node == NULL)
     {
       int child_width, child_height;
       int min, nat;
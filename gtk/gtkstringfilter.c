@@ -68,6 +68,41 @@ G_DEFINE_TYPE (GtkStringFilter, gtk_string_filter, GTK_TYPE_FILTER)
 
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
 
+/* Items remember their prepared strings, so when searching the same
+ * list again after the search changes - like on every key press in a
+ * search entry - they don't need to be normalized and casefolded again.
+ * The source string is kept to notice when the item changed.
+ */
+typedef struct {
+  char *source;
+  char *prepared;
+} GtkStringFilterCache;
+
+static GQuark normalized_quark;
+static GQuark casefolded_quark;
+
+static void
+gtk_string_filter_cache_free (gpointer data)
+{
+  GtkStringFilterCache *cache = data;
+
+  g_free (cache->source);
+  g_free (cache->prepared);
+  g_free (cache);
+}
+
+static gboolean
+gtk_string_is_ascii (const char *s)
+{
+  for (; *s; s++)
+    {
+      if (*s & 0x80)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static char *
 gtk_string_filter_prepare (GtkStringFilter *self,
                            const char      *s)
@@ -78,6 +113,10 @@ gtk_string_filter_prepare (GtkStringFilter *self,
   if (s == NULL || s[0] == '\0')
     return NULL;
 
+  /* ASCII is unchanged by normalization, and casefolds like this */
+  if (gtk_string_is_ascii (s))
+    return self->ignore_case ? g_ascii_strdown (s, -1) : g_strdup (s);
+
   tmp = g_utf8_normalize (s, -1, G_NORMALIZE_ALL);
 
   if (!self->ignore_case)
@@ -98,13 +137,39 @@ gtk_string_filter_has_search (GtkStringFilter *self)
   return self->search_prepared != NULL;
 }
 
+/* Returns the prepared string for @s from @item, which is owned
+ * by the item's cache */
+static const char *
+gtk_string_filter_prepare_cached (GtkStringFilter *self,
+                                  gpointer         item,
+                                  const char      *s)
+{
+  GtkStringFilterCache *cache;
+  GQuark quark;
+
+  if (s == NULL || s[0] == '\0' || !G_IS_OBJECT (item))
+    return NULL;
+
+  quark = self->ignore_case ? casefolded_quark : normalized_quark;
+  cache = g_object_get_qdata (item, quark);
+  if (cache == NULL || strcmp (cache->source, s) != 0)
+    {
+      cache = g_new (GtkStringFilterCache, 1);
+      cache->source = g_strdup (s);
+      cache->prepared = gtk_string_filter_prepare (self, s);
+      g_object_set_qdata_full (item, quark, cache, gtk_string_filter_cache_free);
+    }
+
+  return cache->prepared;
+}
+
 static gboolean
 gtk_string_filter_match (GtkFilter *filter,
                          gpointer   item)
 {
   GtkStringFilter *self = GTK_STRING_FILTER (filter);
   GValue value = G_VALUE_INIT;
-  char *prepared;
+  const char *prepared;
   const char *s;
   gboolean result;
 
@@ -115,9 +180,12 @@ gtk_string_filter_match (GtkFilter *filter,
       !gtk_expression_evaluate (self->expression, item, &value))
     return FALSE;
   s = g_value_get_string (&value);
-  prepared = gtk_string_filter_prepare (self, s);
+  prepared = gtk_string_filter_prepare_cached (self, item, s);
   if (prepared == NULL)
-    return FALSE;
+    {
+      g_value_unset (&value);
+      return FALSE;
+    }
 
   switch (self->match_mode)
     {
@@ -138,7 +206,6 @@ gtk_string_filter_match (GtkFilter *filter,
   g_print ("%s (%s) %s %s (%s)\n", s, prepared, result ? "==" : "!=", self->search, self->search_prepared);
 #endif
 
-  g_free (prepared);
   g_value_unset (&value);
 
   return result;
@@ -247,6 +314,9 @@ gtk_string_filter_class_init (GtkStringFilterClass *class)
   object_class->set_property = gtk_string_filter_set_property;
   object_class->dispose = gtk_string_filter_dispose;
 
+  normalized_quark = g_quark_from_static_string ("gtk-string-filter-normalized");
+  casefolded_quark = g_quark_from_static_string ("gtk-string-filter-casefolded");
+
   /**
    * GtkStringFilter:expression: (type GtkExpression) (attributes org.gtk.Property.get=gtk_string_filter_get_expression org.gtk.Property.set=gtk_string_filter_set_expression)
    *
@@ -374,6 +444,12 @@ gtk_string_filter_set_search (GtkStringFilter *self,
     change = GTK_FILTER_CHANGE_MORE_STRICT;
   else if (g_str_has_prefix (self->search, search))
     change = GTK_FILTER_CHANGE_LESS_STRICT;
+  else if (self->match_mode == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING &&
+           strstr (search, self->search) != NULL)
+    change = GTK_FILTER_CHANGE_MORE_STRICT;
+  else if (self->match_mode == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING &&
+           strstr (self->search, search) != NULL)
+    change = GTK_FILTER_CHANGE_LESS_STRICT;
   else
     change = GTK_FILTER_CHANGE_DIFFERENT;
 
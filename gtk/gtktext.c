@@ -52,8 +52,8 @@
 #include "gtkpango.h"
 #include "gtkpopovermenu.h"
 #include "gtkprivate.h"
-#include "gtksettings.h"
-#include "gtksnapshot.h"
+#include "gtksettingsprivate.h"
+#include "gtksnapshotprivate.h"
 #include "gtkstylecontextprivate.h"
 #include "gtktexthandleprivate.h"
 #include "gtktexthistoryprivate.h"
@@ -162,6 +162,7 @@ struct _GtkTextPrivate
   int             text_baseline;
 
   PangoLayout    *cached_layout;
+  GtkSnapshotLayoutCache layout_cache;
   PangoAttrList  *attrs;
   PangoTabArray  *tabs;
 
@@ -2031,6 +2032,7 @@ gtk_text_finalize (GObject *object)
 
   g_clear_object (&priv->history);
   g_clear_object (&priv->cached_layout);
+  gtk_snapshot_layout_cache_clear (&priv->layout_cache);
   g_clear_object (&priv->im_context);
   g_free (priv->im_module);
 
@@ -3299,10 +3301,7 @@ gtk_text_grab_focus (GtkWidget *widget)
 
   if (priv->editable && !priv->in_click && !prev_focus_was_child)
     {
-      g_object_get (gtk_widget_get_settings (widget),
-                    "gtk-entry-select-on-focus",
-                    &select_on_focus,
-                    NULL);
+      select_on_focus = gtk_settings_get_entry_select_on_focus (gtk_widget_get_settings (widget));
 
       if (select_on_focus)
         gtk_text_set_selection_bounds (self, 0, -1);
@@ -4433,6 +4432,8 @@ gtk_text_reset_layout (GtkText *self)
       g_object_unref (priv->cached_layout);
       priv->cached_layout = NULL;
     }
+
+  gtk_snapshot_layout_cache_clear (&priv->layout_cache);
 }
 
 static void
@@ -4637,7 +4638,7 @@ gtk_text_draw_text (GtkText     *self,
 
   gtk_text_get_layout_offsets (self, &x, &y);
 
-  gtk_snapshot_render_layout (snapshot, context, x, y, layout);
+  gtk_snapshot_render_layout_cached (snapshot, context, x, y, layout, &priv->layout_cache);
 
   if (priv->selection_bound != priv->current_pos)
     {
@@ -4814,7 +4815,7 @@ gtk_text_handle_drag_finished (GtkTextHandle *handle,
       guint double_click_time;
 
       settings = gtk_widget_get_settings (GTK_WIDGET (self));
-      g_object_get (settings, "gtk-double-click-time", &double_click_time, NULL);
+      double_click_time = gtk_settings_get_double_click_time (settings);
       if (g_get_monotonic_time() - priv->handle_place_time < double_click_time * 1000)
         {
           gtk_text_select_word (self);
@@ -6434,7 +6435,7 @@ cursor_blinks (GtkText *self)
       gboolean blink;
 
       settings = gtk_widget_get_settings (GTK_WIDGET (self));
-      g_object_get (settings, "gtk-cursor-blink", &blink, NULL);
+      blink = gtk_settings_get_cursor_blink (settings);
 
       return blink;
     }
@@ -6449,7 +6450,7 @@ get_middle_click_paste (GtkText *self)
   gboolean paste;
 
   settings = gtk_widget_get_settings (GTK_WIDGET (self));
-  g_object_get (settings, "gtk-enable-primary-paste", &paste, NULL);
+  paste = gtk_settings_get_enable_primary_paste (settings);
 
   return paste;
 }
@@ -6460,7 +6461,7 @@ get_cursor_time (GtkText *self)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (self));
   int time;
 
-  g_object_get (settings, "gtk-cursor-blink-time", &time, NULL);
+  time = gtk_settings_get_cursor_blink_time (settings);
 
   return time;
 }
@@ -6471,7 +6472,7 @@ get_cursor_blink_timeout (GtkText *self)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (self));
   int timeout;
 
-  g_object_get (settings, "gtk-cursor-blink-timeout", &timeout, NULL);
+  timeout = gtk_settings_get_cursor_blink_timeout (settings);
 
   return timeout;
 }
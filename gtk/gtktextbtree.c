@@ -74,16 +74,6 @@
  */
 
 
-/*
- * The structure below is used to pass information between
- * _gtk_text_btree_get_tags and inc_count:
- */
-
-typedef struct TagInfo {
-  GPtrArray *tags;
-  GArray *counts;
-} TagInfo;
-
 
 /*
  * This is used to store per-view width/height info at the tree nodes.
@@ -307,9 +297,6 @@ static void tag_changed_cb        (GtkTextTagTable  *table,
 static void cleanup_line          (GtkTextLine      *line);
 static void recompute_node_counts (GtkTextBTree     *tree,
                                    GtkTextBTreeNode *node);
-static void inc_count             (GtkTextTag       *tag,
-                                   int               inc,
-                                   TagInfo          *tagInfoPtr);
 
 static void summary_destroy       (Summary          *summary);
 
@@ -1105,6 +1092,8 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   int char_count_delta;                /* change to number of chars */
   GtkTextBTree *tree;
   int start_byte_index;
+  int end_byte_index;                  /* byte index of the end of the
+                                        * inserted text in @line */
   GtkTextLine *start_line;
 
   g_return_if_fail (text != NULL);
@@ -1119,6 +1108,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
 
   start_line = line;
   start_byte_index = gtk_text_iter_get_line_index (iter);
+  end_byte_index = start_byte_index;
 
   /* Get our insertion segment split. Note this assumes line allows
    * char insertions, which isn't true of the "last" line. But iter
@@ -1183,6 +1173,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
         {
           /* chunk didn't end with a paragraph separator */
           g_assert (eol == len);
+          end_byte_index += chunk_len;
           break;
         }
 
@@ -1199,6 +1190,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
       seg->next = NULL;
       line = newline;
       cur_seg = NULL;
+      end_byte_index = 0;
       line_count_delta++;
     }
 
@@ -1226,12 +1218,13 @@ _gtk_text_btree_insert (GtkTextIter *iter,
                                       &start,
                                       start_line,
                                       start_byte_index);
-    end = start;
-
-    /* We could almost certainly be more efficient here
-       by saving the information from the insertion loop
-       above. FIXME */
-    gtk_text_iter_forward_chars (&end, char_count_delta);
+    /* The insertion loop tracked where the text ends, so there is
+     * no need to count characters through all the new lines.
+     */
+    _gtk_text_btree_get_iter_at_line (tree,
+                                      &end,
+                                      line,
+                                      end_byte_index);
 
     DV (g_print ("invalidating due to inserting some text (%s)\n", G_STRLOC));
     _gtk_text_btree_invalidate_region (tree, &start, &end, FALSE);
@@ -2199,18 +2192,49 @@ _gtk_text_btree_get_tags (const GtkTextIter *iter)
   GtkTextBTreeNode *node;
   GtkTextLine *siblingline;
   GtkTextLineSegment *seg;
-  int src, dst, index;
-  TagInfo tagInfo;
+  int index;
   GtkTextLine *line;
+  GtkTextBTree *tree;
   int byte_index;
+  GtkTextTag **tags;
+  int *counts;
+  int i, num_tags, min_priority, max_priority;
+  GPtrArray *result;
 
-#define NUM_TAG_INFOS 10
-
+  tree = _gtk_text_iter_get_btree (iter);
   line = _gtk_text_iter_get_text_line (iter);
   byte_index = gtk_text_iter_get_line_index (iter);
 
-  tagInfo.tags = g_ptr_array_sized_new (NUM_TAG_INFOS);
-  tagInfo.counts = g_array_new (FALSE, FALSE, sizeof (int));
+  /* Count toggles by tag priority, like _gtk_text_btree_char_is_invisible()
+   * does. That avoids searching for the tag on every toggle, and the tags
+   * come out sorted by priority.
+   */
+  num_tags = gtk_text_tag_table_get_size (tree->table);
+  if (num_tags == 0)
+    return NULL;
+
+  if (num_tags <= 256)
+    {
+      counts = g_newa (int, num_tags);
+      tags = g_newa (GtkTextTag *, num_tags);
+    }
+  else
+    {
+      counts = g_new (int, num_tags);
+      tags = g_new (GtkTextTag *, num_tags);
+    }
+  memset (counts, 0, sizeof (int) * num_tags);
+  min_priority = num_tags;
+  max_priority = -1;
+
+#define COUNT_TOGGLES(_tag, _n) G_STMT_START { \
+  GtkTextTag *tag_ = (_tag); \
+  int priority_ = tag_->priv->priority; \
+  tags[priority_] = tag_; \
+  counts[priority_] += (_n); \
+  min_priority = MIN (min_priority, priority_); \
+  max_priority = MAX (max_priority, priority_); \
+} G_STMT_END
 
   /*
    * Record tag toggles within the line of indexPtr but preceding
@@ -2225,7 +2249,7 @@ _gtk_text_btree_get_tags (const GtkTextIter *iter)
       if ((seg->type == &gtk_text_toggle_on_type)
           || (seg->type == &gtk_text_toggle_off_type))
         {
-          inc_count (seg->body.toggle.info->tag, 1, &tagInfo);
+          COUNT_TOGGLES (seg->body.toggle.info->tag, 1);
         }
     }
 
@@ -2244,7 +2268,7 @@ _gtk_text_btree_get_tags (const GtkTextIter *iter)
           if ((seg->type == &gtk_text_toggle_on_type)
               || (seg->type == &gtk_text_toggle_off_type))
             {
-              inc_count (seg->body.toggle.info->tag, 1, &tagInfo);
+              COUNT_TOGGLES (seg->body.toggle.info->tag, 1);
             }
         }
     }
@@ -2268,41 +2292,39 @@ _gtk_text_btree_get_tags (const GtkTextIter *iter)
             {
               if (summary->toggle_count & 1)
                 {
-                  inc_count (summary->info->tag, summary->toggle_count,
-                             &tagInfo);
+                  COUNT_TOGGLES (summary->info->tag, summary->toggle_count);
                 }
             }
         }
     }
 
+#undef COUNT_TOGGLES
+
   /*
-   * Go through the tag information and squash out all of the tags
-   * that have even toggle counts (these tags exist before the point
-   * of interest, but not at the desired character itself).
+   * Collect the tags with odd toggle counts, in ascending order
+   * of priority. Tags with even counts exist before the point of
+   * interest, but not at the desired character itself.
    */
 
-  for (src = 0, dst = 0; src < tagInfo.tags->len; src++)
+  result = NULL;
+  for (i = min_priority; i <= max_priority; i++)
     {
-      if (g_array_index (tagInfo.counts, int, src) & 1)
+      if (counts[i] & 1)
         {
-          g_assert (GTK_IS_TEXT_TAG (g_ptr_array_index (tagInfo.tags, src)));
-          g_ptr_array_index (tagInfo.tags, dst) = g_ptr_array_index (tagInfo.tags, src);
-          dst++;
+          g_assert (GTK_IS_TEXT_TAG (tags[i]));
+          if (result == NULL)
+            result = g_ptr_array_sized_new (10);
+          g_ptr_array_add (result, tags[i]);
         }
     }
 
-  g_ptr_array_set_size (tagInfo.tags, dst);
-  g_array_unref (tagInfo.counts);
-  if (dst == 0)
+  if (num_tags > 256)
     {
-      g_ptr_array_unref (tagInfo.tags);
-      return NULL;
+      g_free (counts);
+      g_free (tags);
     }
 
-  /* Sort tags in ascending order of priority */
-  _gtk_text_tag_array_sort (tagInfo.tags);
-
-  return tagInfo.tags;
+  return result;
 }
 
 static void
@@ -6443,48 +6465,6 @@ _gtk_change_node_toggle_count (GtkTextBTreeNode *node,
     }
 }
 
-/*
- *----------------------------------------------------------------------
- *
- * inc_count --
- *
- *      This is a utility procedure used by _gtk_text_btree_get_tags.  It
- *      increments the count for a particular tag, adding a new
- *      entry for that tag if there wasn’t one previously.
- *
- * Results:
- *      None.
- *
- * Side effects:
- *      The information at *tagInfoPtr may be modified, and the arrays
- *      may be reallocated to make them larger.
- *
- *----------------------------------------------------------------------
- */
-
-static void
-inc_count (GtkTextTag *tag, int inc, TagInfo *tagInfoPtr)
-{
-  for (int i = 0; i < tagInfoPtr->tags->len; i++)
-    {
-      GtkTextTag *t = g_ptr_array_index (tagInfoPtr->tags, i);
-      if (t == tag)
-        {
-          g_array_index (tagInfoPtr->counts, int, i) += inc;
-          return;
-        }
-    }
-
-  /*
-   * There isn’t currently an entry for this tag, so we have to
-   * make a new one.  If the arrays are full, then enlarge the
-   * arrays first.
-   */
-
-  g_ptr_array_add (tagInfoPtr->tags, tag);
-  g_array_append_val (tagInfoPtr->counts, inc);
-}
-
 static void
 gtk_text_btree_link_segment (GtkTextLineSegment *seg,
                              const GtkTextIter *iter)
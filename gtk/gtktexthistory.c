@@ -98,6 +98,8 @@ struct _GtkTextHistory
   guint               irreversible;
   guint               in_user;
   guint               max_undo_levels;
+  gsize               max_n_bytes;
+  gsize               n_bytes;
 
   guint               can_undo : 1;
   guint               can_redo : 1;
@@ -180,6 +182,41 @@ action_free (Action *action)
   g_slice_free (Action, action);
 }
 
+/*<private>
+ * action_get_n_bytes:
+ *
+ * Returns the number of bytes of text retained by @action, including
+ * all of its children when it is a group. Chaining two actions adds
+ * their strings together, so this stays additive across action_chain().
+ */
+static gsize
+action_get_n_bytes (const Action *action)
+{
+  const GList *iter;
+  gsize n_bytes = 0;
+
+  switch (action->kind)
+    {
+    case ACTION_KIND_INSERT:
+      return action->u.insert.istr.n_bytes;
+
+    case ACTION_KIND_DELETE_BACKSPACE:
+    case ACTION_KIND_DELETE_KEY:
+    case ACTION_KIND_DELETE_PROGRAMMATIC:
+    case ACTION_KIND_DELETE_SELECTION:
+      return action->u.delete.istr.n_bytes;
+
+    case ACTION_KIND_GROUP:
+      for (iter = action->u.group.actions.head; iter; iter = iter->next)
+        n_bytes += action_get_n_bytes (iter->data);
+      return n_bytes;
+
+    case ACTION_KIND_BARRIER:
+    default:
+      return 0;
+    }
+}
+
 static gboolean
 action_group_is_empty (const Action *action)
 {
@@ -406,21 +443,31 @@ gtk_text_history_do_select (GtkTextHistory *self,
   self->funcs.select (self->funcs_data, selection_insert, selection_bound);
 }
 
+static void
+gtk_text_history_drop (GtkTextHistory *self,
+                       GQueue         *queue,
+                       Action         *action)
+{
+  g_queue_unlink (queue, &action->link);
+  self->n_bytes -= action_get_n_bytes (action);
+  action_free (action);
+}
+
+static void
+gtk_text_history_clear (GtkTextHistory *self)
+{
+  clear_action_queue (&self->undo_queue);
+  clear_action_queue (&self->redo_queue);
+  self->n_bytes = 0;
+}
+
 static void
 gtk_text_history_truncate_one (GtkTextHistory *self)
 {
   if (self->undo_queue.length > 0)
-    {
-      Action *action = g_queue_peek_head (&self->undo_queue);
-      g_queue_unlink (&self->undo_queue, &action->link);
-      action_free (action);
-    }
+    gtk_text_history_drop (self, &self->undo_queue, g_queue_peek_head (&self->undo_queue));
   else if (self->redo_queue.length > 0)
-    {
-      Action *action = g_queue_peek_tail (&self->redo_queue);
-      g_queue_unlink (&self->redo_queue, &action->link);
-      action_free (action);
-    }
+    gtk_text_history_drop (self, &self->redo_queue, g_queue_peek_tail (&self->redo_queue));
   else
     {
       g_assert_not_reached ();
@@ -432,11 +479,27 @@ gtk_text_history_truncate (GtkTextHistory *self)
 {
   g_assert (GTK_IS_TEXT_HISTORY (self));
 
-  if (self->max_undo_levels == 0)
-    return;
+  if (self->max_undo_levels > 0)
+    {
+      while (self->undo_queue.length + self->redo_queue.length > self->max_undo_levels)
+        gtk_text_history_truncate_one (self);
+    }
 
-  while (self->undo_queue.length + self->redo_queue.length > self->max_undo_levels)
-    gtk_text_history_truncate_one (self);
+  /* The most recent undo action is never dropped for the byte budget,
+   * it may be a group that is still being filled by a user action and
+   * a single oversized edit should remain undoable.
+   */
+  if (self->max_n_bytes > 0)
+    {
+      while (self->n_bytes > self->max_n_bytes &&
+             self->undo_queue.length + self->redo_queue.length > 1)
+        {
+          if (self->redo_queue.length > 0)
+            gtk_text_history_drop (self, &self->redo_queue, g_queue_peek_tail (&self->redo_queue));
+          else
+            gtk_text_history_drop (self, &self->undo_queue, g_queue_peek_head (&self->undo_queue));
+        }
+    }
 }
 
 static void
@@ -444,8 +507,7 @@ gtk_text_history_finalize (GObject *object)
 {
   GtkTextHistory *self = (GtkTextHistory *)object;
 
-  clear_action_queue (&self->undo_queue);
-  clear_action_queue (&self->redo_queue);
+  gtk_text_history_clear (self);
 
   G_OBJECT_CLASS (gtk_text_history_parent_class)->finalize (object);
 }
@@ -523,15 +585,13 @@ gtk_text_history_push (GtkTextHistory *self,
   g_assert (action != NULL);
 
   while (self->redo_queue.length > 0)
-    {
-      peek = g_queue_peek_head (&self->redo_queue);
-      g_queue_unlink (&self->redo_queue, &peek->link);
-      action_free (peek);
-    }
+    gtk_text_history_drop (self, &self->redo_queue, g_queue_peek_head (&self->redo_queue));
 
   peek = g_queue_peek_tail (&self->undo_queue);
   in_user_action = self->in_user > 0;
 
+  self->n_bytes += action_get_n_bytes (action);
+
   if (peek == NULL || !action_chain (peek, action, in_user_action))
     g_queue_push_tail_link (&self->undo_queue, &action->link);
 
@@ -815,7 +875,8 @@ gtk_text_history_end_user_action (GtkTextHistory *self)
   return_if_applying (self);
   return_if_irreversible (self);
 
-  clear_action_queue (&self->redo_queue);
+  while (self->redo_queue.length > 0)
+    gtk_text_history_drop (self, &self->redo_queue, g_queue_peek_head (&self->redo_queue));
 
   peek = g_queue_peek_tail (&self->undo_queue);
 
@@ -857,6 +918,9 @@ gtk_text_history_end_user_action (GtkTextHistory *self)
       g_queue_unlink (&self->undo_queue, &peek->link);
       action_free (peek);
 
+      /* Accounted for again when pushed */
+      self->n_bytes -= action_get_n_bytes (replaced);
+
       gtk_text_history_push (self, replaced);
 
       goto update_state;
@@ -887,8 +951,7 @@ gtk_text_history_begin_irreversible_action (GtkTextHistory *self)
 
   self->irreversible++;
 
-  clear_action_queue (&self->undo_queue);
-  clear_action_queue (&self->redo_queue);
+  gtk_text_history_clear (self);
 
   gtk_text_history_update_state (self);
 }
@@ -909,8 +972,7 @@ gtk_text_history_end_irreversible_action (GtkTextHistory *self)
 
   self->irreversible--;
 
-  clear_action_queue (&self->undo_queue);
-  clear_action_queue (&self->redo_queue);
+  gtk_text_history_clear (self);
 
   gtk_text_history_update_state (self);
 }
@@ -1074,8 +1136,7 @@ gtk_text_history_set_enabled (GtkTextHistory *self,
         {
           self->irreversible = 0;
           self->in_user = 0;
-          clear_action_queue (&self->undo_queue);
-          clear_action_queue (&self->redo_queue);
+          gtk_text_history_clear (self);
         }
 
       gtk_text_history_update_state (self);
@@ -1102,3 +1163,34 @@ gtk_text_history_set_max_undo_levels (GtkTextHistory *self,
       gtk_text_history_truncate (self);
     }
 }
+
+gsize
+gtk_text_history_get_max_n_bytes (GtkTextHistory *self)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_HISTORY (self), 0);
+
+  return self->max_n_bytes;
+}
+
+/*<private>
+ * gtk_text_history_set_max_n_bytes:
+ * @self: a `GtkTextHistory`
+ * @max_n_bytes: the maximum amount of text to retain, or 0 for no limit
+ *
+ * Limits the amount of inserted and deleted text kept for undo and
+ * redo. When the limit is exceeded, the oldest actions are dropped
+ * just like when exceeding the maximum number of undo levels.
+ */
+void
+gtk_text_history_set_max_n_bytes (GtkTextHistory *self,
+                                  gsize           max_n_bytes)
+{
+  g_return_if_fail (GTK_IS_TEXT_HISTORY (self));
+
+  if (self->max_n_bytes != max_n_bytes)
+    {
+      self->max_n_bytes = max_n_bytes;
+      gtk_text_history_truncate (self);
+      gtk_text_history_update_state (self);
+    }
+}
@@ -4577,6 +4577,14 @@ pointer_from_offset_skipping_decomp (const char *str,
 
   while (offset > 0)
     {
+      /* ASCII casefolds to a single character */
+      if ((guchar) *p < 0x80)
+        {
+          offset--;
+          p++;
+          continue;
+        }
+
       q = g_utf8_next_char (p);
       casefold = g_utf8_casefold (p, q - p);
       normal = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFD);
@@ -4616,52 +4624,38 @@ utf8_strcasestr (const char *haystack,
                  const char *needle)
 {
   gsize needle_len;
-  gsize haystack_len;
   const char *ret = NULL;
   char *p;
   char *casefold;
   char *caseless_haystack;
-  int i;
 
   g_return_val_if_fail (haystack != NULL, NULL);
   g_return_val_if_fail (needle != NULL, NULL);
 
+  needle_len = strlen (needle);
+  if (needle_len == 0)
+    return haystack;
+
   casefold = g_utf8_casefold (haystack, -1);
   caseless_haystack = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFD);
   g_free (casefold);
 
-  needle_len = g_utf8_strlen (needle, -1);
-  haystack_len = g_utf8_strlen (caseless_haystack, -1);
-
-  if (needle_len == 0)
-    {
-      ret = (char *)haystack;
-      goto finally;
-    }
-
-  if (haystack_len < needle_len)
-    {
-      ret = NULL;
-      goto finally;
-    }
-
-  p = (char *)caseless_haystack;
-  needle_len = strlen (needle);
-  i = 0;
-
-  while (*p)
+  /* Let strstr() skip ahead to candidates instead of comparing
+   * at every character. Matches always start at a character
+   * boundary, as needle is valid UTF-8.
+   */
+  for (p = strstr (caseless_haystack, needle);
+       p != NULL;
+       p = strstr (g_utf8_next_char (p), needle))
     {
       if (exact_prefix_cmp (p, needle, needle_len))
         {
-          ret = pointer_from_offset_skipping_decomp (haystack, i);
-          goto finally;
+          ret = pointer_from_offset_skipping_decomp (haystack,
+                                                     g_utf8_strlen (caseless_haystack, p - caseless_haystack));
+          break;
         }
-
-      p = g_utf8_next_char (p);
-      i++;
     }
 
-finally:
   g_free (caseless_haystack);
 
   return ret;
@@ -4672,55 +4666,38 @@ utf8_strrcasestr (const char *haystack,
                   const char *needle)
 {
   gsize needle_len;
-  gsize haystack_len;
   const char *ret = NULL;
+  const char *last = NULL;
   char *p;
   char *casefold;
   char *caseless_haystack;
-  int i;
 
   g_return_val_if_fail (haystack != NULL, NULL);
   g_return_val_if_fail (needle != NULL, NULL);
 
+  needle_len = strlen (needle);
+  if (needle_len == 0)
+    return haystack;
+
   casefold = g_utf8_casefold (haystack, -1);
   caseless_haystack = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFD);
   g_free (casefold);
 
-  needle_len = g_utf8_strlen (needle, -1);
-  haystack_len = g_utf8_strlen (caseless_haystack, -1);
-
-  if (needle_len == 0)
-    {
-      ret = (char *)haystack;
-      goto finally;
-    }
-
-  if (haystack_len < needle_len)
-    {
-      ret = NULL;
-      goto finally;
-    }
-
-  i = haystack_len - needle_len;
-  p = g_utf8_offset_to_pointer (caseless_haystack, i);
-  needle_len = strlen (needle);
-
-  while (TRUE)
+  /* Walking forward with strstr() is cheaper than trying every
+   * character from the end.
+   */
+  for (p = strstr (caseless_haystack, needle);
+       p != NULL;
+       p = strstr (g_utf8_next_char (p), needle))
     {
       if (exact_prefix_cmp (p, needle, needle_len))
-        {
-          ret = pointer_from_offset_skipping_decomp (haystack, i);
-          break;
-        }
-
-      if (p == caseless_haystack)
-        break;
-
-      p = g_utf8_prev_char (p);
-      i--;
+        last = p;
     }
 
-finally:
+  if (last)
+    ret = pointer_from_offset_skipping_decomp (haystack,
+                                               g_utf8_strlen (caseless_haystack, last - caseless_haystack));
+
   g_free (caseless_haystack);
 
   return ret;
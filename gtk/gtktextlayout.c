@@ -4305,6 +4305,7 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
 
   /* Only update eviction source once per snapshot */
   gtk_text_line_display_cache_delay_eviction (priv->cache);
+  gtk_text_line_display_cache_report_stats (priv->cache);
 
   gsk_pango_renderer_release (crenderer);
 }
@@ -25,6 +25,8 @@
 #include "gtktextlinedisplaycacheprivate.h"
 #include "gtkprivate.h"
 
+#include "gdkprofilerprivate.h"
+
 #define DEFAULT_MRU_SIZE         250
 #define BLOW_CACHE_TIMEOUT_SEC   20
 #define DEBUG_LINE_DISPLAY_CACHE 0
@@ -38,6 +40,10 @@ struct _GtkTextLineDisplayCache
   GSource     *evict_source;
   guint        mru_size;
 
+  /* since the last gtk_text_line_display_cache_report_stats() */
+  guint        frame_hits;
+  guint        frame_misses;
+
 #if DEBUG_LINE_DISPLAY_CACHE
   guint       log_source;
   int         hits;
@@ -291,6 +297,7 @@ gtk_text_line_display_cache_get (GtkTextLineDisplayCache *cache,
       if (size_only || !display->size_only)
         {
           STAT_INC (cache->hits);
+          cache->frame_hits++;
 
           if (!size_only && display->line == cache->cursor_line)
             gtk_text_layout_update_display_cursors (layout, display->line, display);
@@ -313,6 +320,7 @@ gtk_text_line_display_cache_get (GtkTextLineDisplayCache *cache,
     }
 
   STAT_INC (cache->misses);
+  cache->frame_misses++;
 
   g_assert (!g_hash_table_lookup (cache->line_to_display, line));
 
@@ -762,3 +770,37 @@ gtk_text_line_display_cache_set_mru_size (GtkTextLineDisplayCache *cache,
         }
     }
 }
+
+/*<private>
+ * gtk_text_line_display_cache_report_stats:
+ * @cache: a `GtkTextLineDisplayCache`
+ *
+ * Reports the hits and misses since the last call to the profiler,
+ * so a cache that is too small for the view shows up as misses
+ * while scrolling.
+ */
+void
+gtk_text_line_display_cache_report_stats (GtkTextLineDisplayCache *cache)
+{
+  static guint hits_counter;
+  static guint misses_counter;
+
+  g_assert (cache != NULL);
+
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      if (hits_counter == 0)
+        {
+          hits_counter = gdk_profiler_define_int_counter ("textview-display-hits",
+                                                          "Text line display cache hits");
+          misses_counter = gdk_profiler_define_int_counter ("textview-display-misses",
+                                                            "Text line display cache misses");
+        }
+
+      gdk_profiler_set_int_counter (hits_counter, cache->frame_hits);
+      gdk_profiler_set_int_counter (misses_counter, cache->frame_misses);
+    }
+
+  cache->frame_hits = 0;
+  cache->frame_misses = 0;
+}
@@ -38,7 +38,7 @@
 #include "gtkmain.h"
 #include "gtkmarshalers.h"
 #include "gtkrenderbackgroundprivate.h"
-#include "gtksettings.h"
+#include "gtksettingsprivate.h"
 #include "gtktextiterprivate.h"
 #include "gtkimmulticontext.h"
 #include "gtkprivate.h"
@@ -150,6 +150,13 @@
 
 #define SPACE_FOR_CURSOR 1
 
+/* How long the incremental validation may run per idle, in µs.
+ * Validating a fixed number of pixels per idle made large buffers
+ * take very many main loop iterations to get their final height.
+ */
+#define INCREMENTAL_VALIDATE_BUDGET 4000
+#define INCREMENTAL_VALIDATE_PIXELS 2000
+
 typedef struct _GtkTextWindow GtkTextWindow;
 typedef struct _GtkTextPendingScroll GtkTextPendingScroll;
 
@@ -230,6 +237,10 @@ struct _GtkTextViewPrivate
 
   guint first_validate_idle;        /* Idle to revalidate onscreen portion, runs before resize */
   guint incremental_validate_idle;  /* Idle to revalidate offscreen portions, runs after redraw */
+  guint prefill_idle;               /* Idle to create displays for lines we are scrolling towards */
+
+  int line_height;                  /* Height of a line in the default font, for sizing the display cache */
+  int scroll_dy;                    /* Last vertical scroll step */
 
   /* Mark for drop target */
   GtkTextMark *dnd_mark;
@@ -568,6 +579,7 @@ static gboolean gtk_text_view_flush_scroll         (GtkTextView *text_view);
 static void     gtk_text_view_update_adjustments   (GtkTextView *text_view);
 static void     gtk_text_view_invalidate           (GtkTextView *text_view);
 static void     gtk_text_view_flush_first_validate (GtkTextView *text_view);
+static void     gtk_text_view_update_mru_size      (GtkTextView *text_view);
 
 static void     gtk_text_view_set_hadjustment        (GtkTextView   *text_view,
                                                       GtkAdjustment *adjustment);
@@ -3898,6 +3910,8 @@ gtk_text_view_remove_validate_idles (GtkTextView *text_view)
       g_source_remove (priv->incremental_validate_idle);
       priv->incremental_validate_idle = 0;
     }
+
+  g_clear_handle_id (&priv->prefill_idle, g_source_remove);
 }
 
 static void
@@ -4574,7 +4588,6 @@ gtk_text_view_size_allocate (GtkWidget *widget,
   GdkRectangle bottom_rect;
   GtkWidget *chooser;
   PangoLayout *layout;
-  guint mru_size;
 
   text_view = GTK_TEXT_VIEW (widget);
   priv = text_view->priv;
@@ -4662,11 +4675,8 @@ gtk_text_view_size_allocate (GtkWidget *widget,
   /* Optimize display cache size */
   layout = gtk_widget_create_pango_layout (widget, "X");
   pango_layout_get_pixel_size (layout, &width, &height);
-  if (height > 0)
-    {
-      mru_size = SCREEN_HEIGHT (widget) / height * 3;
-      gtk_text_layout_set_mru_size (priv->layout, mru_size);
-    }
+  priv->line_height = height;
+  gtk_text_view_update_mru_size (text_view);
   g_object_unref (layout);
 
   /* The GTK resize loop processes all the pending exposes right
@@ -4811,10 +4821,16 @@ incremental_validate_callback (gpointer data)
 {
   GtkTextView *text_view = data;
   gboolean result = TRUE;
+  gint64 end_time;
 
   DV(g_print(G_STRLOC"\n"));
 
-  gtk_text_layout_validate (text_view->priv->layout, 2000);
+  end_time = g_get_monotonic_time () + INCREMENTAL_VALIDATE_BUDGET;
+
+  do
+    gtk_text_layout_validate (text_view->priv->layout, INCREMENTAL_VALIDATE_PIXELS);
+  while (!gtk_text_layout_is_valid (text_view->priv->layout) &&
+         g_get_monotonic_time () < end_time);
 
   gtk_text_view_update_adjustments (text_view);
 
@@ -4827,6 +4843,94 @@ incremental_validate_callback (gpointer data)
   return result;
 }
 
+/* The display cache holds enough lines for the screen, plus a margin
+ * for the lines that the current scroll speed brings into view within
+ * the next few frames, and at least another screen in either direction.
+ */
+#define PREFILL_FRAMES 4
+#define PREFILL_BUDGET 2000
+
+static guint
+gtk_text_view_get_prefill_lines (GtkTextView *text_view)
+{
+  GtkTextViewPrivate *priv = text_view->priv;
+
+  return ABS (priv->scroll_dy) * PREFILL_FRAMES / priv->line_height;
+}
+
+static void
+gtk_text_view_update_mru_size (GtkTextView *text_view)
+{
+  GtkTextViewPrivate *priv = text_view->priv;
+  guint visible;
+
+  if (priv->layout == NULL || priv->line_height <= 0)
+    return;
+
+  visible = SCREEN_HEIGHT (text_view) / priv->line_height + 1;
+
+  gtk_text_layout_set_mru_size (priv->layout,
+                                2 * visible + MAX (visible, gtk_text_view_get_prefill_lines (text_view)));
+}
+
+static gboolean
+prefill_callback (gpointer data)
+{
+  GtkTextView *text_view = data;
+  GtkTextViewPrivate *priv = text_view->priv;
+  GtkTextIter iter;
+  gint64 end_time;
+  guint n_lines;
+  int line_top;
+
+  priv->prefill_idle = 0;
+
+  if (priv->layout == NULL || priv->line_height <= 0 || priv->scroll_dy == 0)
+    return G_SOURCE_REMOVE;
+
+  end_time = g_get_monotonic_time () + PREFILL_BUDGET;
+  n_lines = MAX (gtk_text_view_get_prefill_lines (text_view),
+                 SCREEN_HEIGHT (text_view) / priv->line_height / 2);
+
+  /* A negative step means the view is scrolling down */
+  if (priv->scroll_dy < 0)
+    gtk_text_layout_get_line_at_y (priv->layout, &iter, priv->yoffset + SCREEN_HEIGHT (text_view), &line_top);
+  else
+    gtk_text_layout_get_line_at_y (priv->layout, &iter, MAX (priv->yoffset, 1) - 1, &line_top);
+
+  while (n_lines-- > 0 && g_get_monotonic_time () < end_time)
+    {
+      GtkTextLineDisplay *display;
+
+      display = gtk_text_layout_get_line_display (priv->layout,
+                                                  _gtk_text_iter_get_text_line (&iter),
+                                                  FALSE);
+      gtk_text_line_display_unref (display);
+
+      if (priv->scroll_dy < 0 ? !gtk_text_iter_forward_line (&iter)
+                              : !gtk_text_iter_backward_line (&iter))
+        break;
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_text_view_prefill (GtkTextView *text_view,
+                       int          dy)
+{
+  GtkTextViewPrivate *priv = text_view->priv;
+
+  priv->scroll_dy = dy;
+  gtk_text_view_update_mru_size (text_view);
+
+  if (dy != 0 && priv->prefill_idle == 0)
+    {
+      priv->prefill_idle = g_idle_add_full (GTK_TEXT_VIEW_PRIORITY_VALIDATE + 1, prefill_callback, text_view, NULL);
+      gdk_source_set_static_name_by_id (priv->prefill_idle, "[gtk] prefill_callback");
+    }
+}
+
 static void
 gtk_text_view_invalidate (GtkTextView *text_view)
 {
@@ -5365,7 +5469,7 @@ gtk_text_view_handle_drag_finished (GtkTextHandle *handle,
       guint double_click_time;
 
       settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
-      g_object_get (settings, "gtk-double-click-time", &double_click_time, NULL);
+      double_click_time = gtk_settings_get_double_click_time (settings);
       if (g_get_monotonic_time() - priv->handle_place_time < double_click_time * 1000)
         {
           buffer = get_buffer (text_view);
@@ -6004,7 +6108,7 @@ cursor_blinks (GtkTextView *text_view)
   return FALSE;
 #endif
 
-  g_object_get (settings, "gtk-cursor-blink", &blink, NULL);
+  blink = gtk_settings_get_cursor_blink (settings);
 
   if (!blink)
     return FALSE;
@@ -6030,7 +6134,7 @@ cursor_visible (GtkTextView *text_view)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
   gboolean use_caret;
 
-  g_object_get (settings, "gtk-keynav-use-caret", &use_caret, NULL);
+  use_caret = gtk_settings_get_keynav_use_caret (settings);
 
    return use_caret || text_view->priv->cursor_visible;
 }
@@ -6042,7 +6146,7 @@ get_middle_click_paste (GtkTextView *text_view)
   gboolean paste;
 
   settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
-  g_object_get (settings, "gtk-enable-primary-paste", &paste, NULL);
+  paste = gtk_settings_get_enable_primary_paste (settings);
 
   return paste;
 }
@@ -6053,7 +6157,7 @@ get_cursor_time (GtkTextView *text_view)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
   int time;
 
-  g_object_get (settings, "gtk-cursor-blink-time", &time, NULL);
+  time = gtk_settings_get_cursor_blink_time (settings);
 
   return time;
 }
@@ -6064,7 +6168,7 @@ get_cursor_blink_timeout (GtkTextView *text_view)
   GtkSettings *settings = gtk_widget_get_settings (GTK_WIDGET (text_view));
   int time;
 
-  g_object_get (settings, "gtk-cursor-blink-timeout", &time, NULL);
+  time = gtk_settings_get_cursor_blink_timeout (settings);
 
   return time;
 }
@@ -8403,6 +8507,8 @@ gtk_text_view_value_changed (GtkAdjustment *adjustment,
 
           priv->first_para_pixels = gtk_adjustment_get_value (adjustment) - line_top;
         }
+
+      gtk_text_view_prefill (text_view, dy);
     }
 
   if (dx != 0 || dy != 0)
@@ -1392,3 +1392,196 @@ gtk_tree_list_row_get_child_row (GtkTreeListRow *self,
 
   return tree_node_get_row (child);
 }
+
+/* Expands all descendants of the expanded @node. Sets @first and
+ * @last to the first and last node in tree order that got expanded
+ * and collects the rows of expanded nodes into @rows.
+ */
+static void
+gtk_tree_list_model_expand_descendants (GtkTreeListModel  *self,
+                                        TreeNode          *node,
+                                        TreeNode         **first,
+                                        TreeNode         **last,
+                                        GPtrArray         *rows)
+{
+  TreeNode *child;
+
+  for (child = gtk_rb_tree_get_first (node->children);
+       child != NULL;
+       child = gtk_rb_tree_node_get_next (child))
+    {
+      if (child->model == NULL)
+        {
+          gtk_tree_list_model_expand_node (self, child);
+          if (child->model == NULL)
+            continue;
+
+          if (*first == NULL)
+            *first = child;
+          *last = child;
+          if (child->row)
+            g_ptr_array_add (rows, g_object_ref (child->row));
+        }
+
+      gtk_tree_list_model_expand_descendants (self, child, first, last, rows);
+    }
+}
+
+/* Emits a single items-changed covering all changes to the nodes
+ * from @first to @last, and then notifies the changed @rows.
+ */
+static void
+gtk_tree_list_model_emit_expanded (GtkTreeListModel *self,
+                                   guint             old_n_items,
+                                   TreeNode         *first,
+                                   TreeNode         *last,
+                                   GPtrArray        *rows)
+{
+  guint i, n_items, start, end;
+
+  if (first != NULL)
+    {
+      n_items = tree_node_get_n_children (&self->root_node);
+      /* nothing before @first and after the children of @last changed */
+      start = tree_node_get_position (first) + 1;
+      end = tree_node_get_position (last) + 1 + tree_node_get_n_children (last);
+
+      if (old_n_items != n_items)
+        g_list_model_items_changed (G_LIST_MODEL (self),
+                                    start,
+                                    old_n_items - (n_items - end) - start,
+                                    end - start);
+    }
+
+  for (i = 0; i < rows->len; i++)
+    {
+      GtkTreeListRow *row = g_ptr_array_index (rows, i);
+
+      g_object_notify_by_pspec (G_OBJECT (row), row_properties[ROW_PROP_EXPANDED]);
+      g_object_notify_by_pspec (G_OBJECT (row), row_properties[ROW_PROP_CHILDREN]);
+    }
+
+  g_ptr_array_unref (rows);
+}
+
+/**
+ * gtk_tree_list_model_expand_all:
+ * @self: a `GtkTreeListModel`
+ *
+ * Expands all rows of the model, recursively.
+ *
+ * This is the same as calling [method@Gtk.TreeListRow.set_expanded]
+ * on every row, but the model only emits a single
+ * [signal@Gio.ListModel::items-changed] signal.
+ *
+ * Since: 4.6
+ */
+void
+gtk_tree_list_model_expand_all (GtkTreeListModel *self)
+{
+  TreeNode *first = NULL, *last = NULL;
+  GPtrArray *rows;
+  guint n_items;
+
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  n_items = tree_node_get_n_children (&self->root_node);
+  rows = g_ptr_array_new_with_free_func (g_object_unref);
+
+  gtk_tree_list_model_expand_descendants (self, &self->root_node, &first, &last, rows);
+
+  gtk_tree_list_model_emit_expanded (self, n_items, first, last, rows);
+}
+
+/**
+ * gtk_tree_list_model_collapse_all:
+ * @self: a `GtkTreeListModel`
+ *
+ * Collapses all rows of the model.
+ *
+ * This is the same as calling [method@Gtk.TreeListRow.set_expanded]
+ * on every row, but the model only emits a single
+ * [signal@Gio.ListModel::items-changed] signal.
+ *
+ * Since: 4.6
+ */
+void
+gtk_tree_list_model_collapse_all (GtkTreeListModel *self)
+{
+  TreeNode *node, *first = NULL, *last = NULL;
+  GPtrArray *rows;
+  guint n_items;
+
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  n_items = tree_node_get_n_children (&self->root_node);
+  rows = g_ptr_array_new_with_free_func (g_object_unref);
+
+  /* Collapsing a row drops all its descendants, too */
+  for (node = gtk_rb_tree_get_first (self->root_node.children);
+       node != NULL;
+       node = gtk_rb_tree_node_get_next (node))
+    {
+      if (node->model == NULL)
+        continue;
+
+      gtk_tree_list_model_collapse_node (self, node);
+
+      if (first == NULL)
+        first = node;
+      last = node;
+      if (node->row)
+        g_ptr_array_add (rows, g_object_ref (node->row));
+    }
+
+  gtk_tree_list_model_emit_expanded (self, n_items, first, last, rows);
+}
+
+/**
+ * gtk_tree_list_row_expand_all:
+ * @self: a `GtkTreeListRow`
+ *
+ * Expands a row and all rows below it, recursively.
+ *
+ * This is the same as calling [method@Gtk.TreeListRow.set_expanded]
+ * on the row and all its descendants, but the model only emits a
+ * single [signal@Gio.ListModel::items-changed] signal.
+ *
+ * If the row is not expandable, this function does nothing.
+ *
+ * Since: 4.6
+ */
+void
+gtk_tree_list_row_expand_all (GtkTreeListRow *self)
+{
+  TreeNode *first = NULL, *last = NULL;
+  GtkTreeListModel *list;
+  GPtrArray *rows;
+  guint n_items;
+
+  g_return_if_fail (GTK_IS_TREE_LIST_ROW (self));
+
+  if (self->node == NULL)
+    return;
+
+  list = tree_node_get_tree_list_model (self->node);
+  n_items = tree_node_get_n_children (&list->root_node);
+  rows = g_ptr_array_new_with_free_func (g_object_unref);
+
+  if (self->node->model == NULL)
+    {
+      gtk_tree_list_model_expand_node (list, self->node);
+      if (self->node->model == NULL)
+        {
+          g_ptr_array_unref (rows);
+          return;
+        }
+
+      first = last = self->node;
+      g_ptr_array_add (rows, g_object_ref (self));
+    }
+
+  gtk_tree_list_model_expand_descendants (list, self->node, &first, &last, rows);
+
+  gtk_tree_list_model_emit_expanded (list, n_items, first, last, rows);
+}
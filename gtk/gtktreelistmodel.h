@@ -75,6 +75,11 @@ void                    gtk_tree_list_model_set_autoexpand      (GtkTreeListMode
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_tree_list_model_get_autoexpand      (GtkTreeListModel       *self);
 
+GDK_AVAILABLE_IN_4_6
+void                    gtk_tree_list_model_expand_all          (GtkTreeListModel       *self);
+GDK_AVAILABLE_IN_4_6
+void                    gtk_tree_list_model_collapse_all        (GtkTreeListModel       *self);
+
 GDK_AVAILABLE_IN_ALL
 GtkTreeListRow *        gtk_tree_list_model_get_child_row       (GtkTreeListModel       *self,
                                                                  guint                   position);
@@ -87,6 +92,8 @@ gpointer                gtk_tree_list_row_get_item              (GtkTreeListRow
 GDK_AVAILABLE_IN_ALL
 void                    gtk_tree_list_row_set_expanded          (GtkTreeListRow         *self,
                                                                  gboolean                expanded);
+GDK_AVAILABLE_IN_4_6
+void                    gtk_tree_list_row_expand_all            (GtkTreeListRow         *self);
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_tree_list_row_get_expanded          (GtkTreeListRow         *self);
 GDK_AVAILABLE_IN_ALL
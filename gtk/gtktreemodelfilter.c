@@ -4232,12 +4232,22 @@ gtk_tree_model_filter_refilter_helper (GtkTreeModel *model,
  *
  * Emits ::row_changed for each row in the child model, which causes
  * the filter to re-evaluate whether a row is visible or not.
+ *
+ * If no rows of @filter have been accessed yet, there is nothing to
+ * update and the visibility of rows is only evaluated once they are.
  */
 void
 gtk_tree_model_filter_refilter (GtkTreeModelFilter *filter)
 {
   g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
 
+  /* Nobody has looked at the filter yet, so nobody can have
+   * outdated state either. The root level will be built with
+   * the current visibility when it is first needed.
+   */
+  if (filter->priv->root == NULL)
+    return;
+
   /* S L O W */
   gtk_tree_model_foreach (filter->priv->child_model,
                           gtk_tree_model_filter_refilter_helper,
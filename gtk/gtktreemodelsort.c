@@ -26,6 +26,7 @@
 #include "gtkintl.h"
 #include "gtkprivate.h"
 #include "gtktreednd.h"
+#include "timsort/gtktimsortprivate.h"
 
 
 /**
@@ -215,6 +216,7 @@
 typedef struct _SortElt SortElt;
 typedef struct _SortLevel SortLevel;
 typedef struct _SortData SortData;
+typedef struct _SortItem SortItem;
 
 struct _SortElt
 {
@@ -246,6 +248,15 @@ struct _SortData
   int parent_path_depth;
 };
 
+/* Used to sort a whole level at once, with the child
+ * iter of each row looked up only once.
+ */
+struct _SortItem
+{
+  SortElt     *elt;
+  GtkTreeIter  iter;
+};
+
 /* Properties */
 enum {
   PROP_0,
@@ -1883,6 +1894,44 @@ gtk_tree_model_sort_offset_compare_func (gconstpointer a,
   return retval;
 }
 
+static int
+gtk_tree_model_sort_item_compare_func (gconstpointer a,
+                                       gconstpointer b,
+                                       gpointer      user_data)
+{
+  SortData *data = (SortData *)user_data;
+  GtkTreeModelSortPrivate *priv = data->tree_model_sort->priv;
+  const SortItem *ia = a;
+  const SortItem *ib = b;
+  int retval;
+
+  retval = (* data->sort_func) (GTK_TREE_MODEL (priv->child_model),
+                                (GtkTreeIter *) &ia->iter,
+                                (GtkTreeIter *) &ib->iter,
+                                data->sort_data);
+
+  if (priv->order == GTK_SORT_DESCENDING)
+    {
+      if (retval > 0)
+        retval = -1;
+      else if (retval < 0)
+        retval = 1;
+    }
+
+  return retval;
+}
+
+static int
+gtk_tree_model_sort_item_offset_compare_func (gconstpointer a,
+                                              gconstpointer b,
+                                              gpointer      user_data)
+{
+  const SortItem *ia = a;
+  const SortItem *ib = b;
+
+  return gtk_tree_model_sort_offset_compare_func (ia->elt, ib->elt, user_data);
+}
+
 static void
 gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
 				SortLevel        *level,
@@ -1890,9 +1939,10 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
 				gboolean          emit_reordered)
 {
   GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
-  int i;
+  int i, length;
   GSequenceIter *begin_siter, *end_siter, *siter;
   SortElt *begin_elt;
+  SortItem *items;
   int *new_order;
 
   GtkTreeIter iter;
@@ -1914,6 +1964,15 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
 
   gtk_tree_model_sort_ref_node (GTK_TREE_MODEL (tree_model_sort), &iter);
 
+  fill_sort_data (&data, tree_model_sort, level);
+
+  /* Sort an array of the rows instead of the sequence itself, so that
+   * already sorted runs are found by the timsort. The child iters are
+   * looked up once per row here instead of twice per comparison.
+   */
+  length = g_sequence_get_length (level->seq);
+  items = g_new (SortItem, length);
+
   i = 0;
   end_siter = g_sequence_get_end_iter (level->seq);
   for (siter = g_sequence_get_begin_iter (level->seq);
@@ -1923,32 +1982,47 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
       SortElt *elt = g_sequence_get (siter);
 
       elt->old_index = i;
+      items[i].elt = elt;
+
+      if (data.sort_func != NO_SORT_FUNC)
+        {
+          if (GTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (tree_model_sort))
+            items[i].iter = elt->iter;
+          else
+            {
+              data.parent_path_indices[data.parent_path_depth - 1] = elt->offset;
+              gtk_tree_model_get_iter (GTK_TREE_MODEL (priv->child_model),
+                                       &items[i].iter, data.parent_path);
+            }
+        }
+
       i++;
     }
 
-  fill_sort_data (&data, tree_model_sort, level);
-
   if (data.sort_func == NO_SORT_FUNC)
-    g_sequence_sort (level->seq, gtk_tree_model_sort_offset_compare_func,
-                     &data);
+    gtk_tim_sort (items, length, sizeof (SortItem),
+                  gtk_tree_model_sort_item_offset_compare_func, &data);
   else
-    g_sequence_sort (level->seq, gtk_tree_model_sort_compare_func, &data);
+    gtk_tim_sort (items, length, sizeof (SortItem),
+                  gtk_tree_model_sort_item_compare_func, &data);
 
   free_sort_data (&data);
 
-  new_order = g_new (int, g_sequence_get_length (level->seq));
+  new_order = g_new (int, length);
 
-  i = 0;
-  end_siter = g_sequence_get_end_iter (level->seq);
-  for (siter = g_sequence_get_begin_iter (level->seq);
-       siter != end_siter;
-       siter = g_sequence_iter_next (siter))
+  /* Moving every row to the end in sorted order leaves the
+   * sequence sorted, without comparing anything again.
+   */
+  for (i = 0; i < length; i++)
     {
-      SortElt *elt = g_sequence_get (siter);
+      SortElt *elt = items[i].elt;
 
-      new_order[i++] = elt->old_index;
+      new_order[i] = elt->old_index;
+      g_sequence_move (elt->siter, end_siter);
     }
 
+  g_free (items);
+
   if (emit_reordered)
     {
       gtk_tree_model_sort_increment_stamp (tree_model_sort);
@@ -5566,57 +5566,73 @@ get_separator_height (GtkTreeView *tree_view)
 
 /* Returns TRUE if it updated the size
  */
-static gboolean
-validate_row (GtkTreeView   *tree_view,
-	      GtkTreeRBTree *tree,
-	      GtkTreeRBNode *node,
-	      GtkTreeIter   *iter,
-	      GtkTreePath *path)
+/* The parts of row validation that are the same for all rows.
+ * Idle validation goes through many rows in one go, so it sets
+ * this up, and the "cell" style, only once per batch.
+ */
+typedef struct
 {
-  GtkTreeViewPrivate *priv = gtk_tree_view_get_instance_private (tree_view);
-  GtkTreeViewColumn *column;
-  GtkStyleContext *context;
-  GList *list, *first_column, *last_column;
-  int height = 0;
-  int depth = gtk_tree_path_get_depth (path);
-  gboolean retval = FALSE;
-  gboolean is_separator = FALSE;
-  gboolean draw_vgrid_lines, draw_hgrid_lines;
+  GList *first_column;
+  GList *last_column;
+  gboolean draw_vgrid_lines;
+  gboolean draw_hgrid_lines;
   int expander_size;
   int separator_height;
+} ValidateRowData;
 
-  /* double check the row needs validating */
-  if (! GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_INVALID) &&
-      ! GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_COLUMN_INVALID))
-    return FALSE;
-
-  is_separator = row_is_separator (tree_view, iter, NULL);
+static void
+validate_row_data_init (GtkTreeView     *tree_view,
+                        ValidateRowData *data)
+{
+  GtkTreeViewPrivate *priv = gtk_tree_view_get_instance_private (tree_view);
 
-  draw_vgrid_lines =
+  data->draw_vgrid_lines =
     priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_VERTICAL
     || priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_BOTH;
-  draw_hgrid_lines =
+  data->draw_hgrid_lines =
     priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_HORIZONTAL
     || priv->grid_lines == GTK_TREE_VIEW_GRID_LINES_BOTH;
-  expander_size = gtk_tree_view_get_expander_size (tree_view);
+  data->expander_size = gtk_tree_view_get_expander_size (tree_view);
 
-  for (last_column = g_list_last (priv->columns);
-       last_column &&
-       !(gtk_tree_view_column_get_visible (GTK_TREE_VIEW_COLUMN (last_column->data)));
-       last_column = last_column->prev)
+  for (data->last_column = g_list_last (priv->columns);
+       data->last_column &&
+       !(gtk_tree_view_column_get_visible (GTK_TREE_VIEW_COLUMN (data->last_column->data)));
+       data->last_column = data->last_column->prev)
     ;
 
-  for (first_column = g_list_first (priv->columns);
-       first_column &&
-       !(gtk_tree_view_column_get_visible (GTK_TREE_VIEW_COLUMN (first_column->data)));
-       first_column = first_column->next)
+  for (data->first_column = g_list_first (priv->columns);
+       data->first_column &&
+       !(gtk_tree_view_column_get_visible (GTK_TREE_VIEW_COLUMN (data->first_column->data)));
+       data->first_column = data->first_column->next)
     ;
 
-  separator_height = get_separator_height (tree_view);
+  data->separator_height = get_separator_height (tree_view);
+}
 
-  context = gtk_widget_get_style_context (GTK_WIDGET (tree_view));
-  gtk_style_context_save (context);
-  gtk_style_context_add_class (context, "cell");
+/* Must be called with the "cell" style class applied */
+static gboolean
+validate_row_with_data (GtkTreeView     *tree_view,
+                        ValidateRowData *data,
+                        GtkTreeRBTree   *tree,
+                        GtkTreeRBNode   *node,
+                        GtkTreeIter     *iter,
+                        GtkTreePath     *path)
+{
+  GtkTreeViewPrivate *priv = gtk_tree_view_get_instance_private (tree_view);
+  GtkTreeViewColumn *column;
+  GList *list;
+  int height = 0;
+  int depth;
+  gboolean retval = FALSE;
+  gboolean is_separator = FALSE;
+
+  /* double check the row needs validating */
+  if (! GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_INVALID) &&
+      ! GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_COLUMN_INVALID))
+    return FALSE;
+
+  depth = gtk_tree_path_get_depth (path);
+  is_separator = row_is_separator (tree_view, iter, NULL);
 
   for (list = priv->columns; list; list = list->next)
     {
@@ -5645,14 +5661,14 @@ validate_row (GtkTreeView   *tree_view,
 
       if (is_separator)
         {
-          height = separator_height;
+          height = data->separator_height;
           /* gtk_tree_view_get_row_height() assumes separator nodes are > 0 */
           height = MAX (height, 1);
         }
       else
         {
           height = MAX (height, row_height);
-          height = MAX (height, expander_size);
+          height = MAX (height, data->expander_size);
         }
 
       if (gtk_tree_view_is_expander_column (tree_view, column))
@@ -5660,14 +5676,14 @@ validate_row (GtkTreeView   *tree_view,
 	  padding += _TREE_VIEW_HORIZONTAL_SEPARATOR + (depth - 1) * priv->level_indentation;
 
 	  if (gtk_tree_view_draw_expanders (tree_view))
-	    padding += depth * expander_size;
+	    padding += depth * data->expander_size;
 	}
       else
         padding += _TREE_VIEW_HORIZONTAL_SEPARATOR;
 
-      if (draw_vgrid_lines)
+      if (data->draw_vgrid_lines)
         {
-	  if (list->data == first_column || list->data == last_column)
+	  if (list == data->first_column || list == data->last_column)
 	    padding += _TREE_VIEW_GRID_LINE_WIDTH / 2.0;
 	  else
 	    padding += _TREE_VIEW_GRID_LINE_WIDTH;
@@ -5681,9 +5697,7 @@ validate_row (GtkTreeView   *tree_view,
 	retval = TRUE;
     }
 
-  gtk_style_context_restore (context);
-
-  if (draw_hgrid_lines)
+  if (data->draw_hgrid_lines)
     height += _TREE_VIEW_GRID_LINE_WIDTH;
 
   if (height != GTK_TREE_RBNODE_GET_HEIGHT (node))
@@ -5696,6 +5710,35 @@ validate_row (GtkTreeView   *tree_view,
   return retval;
 }
 
+static gboolean
+validate_row (GtkTreeView   *tree_view,
+	      GtkTreeRBTree *tree,
+	      GtkTreeRBNode *node,
+	      GtkTreeIter   *iter,
+	      GtkTreePath *path)
+{
+  GtkStyleContext *context;
+  ValidateRowData data;
+  gboolean retval;
+
+  /* double check the row needs validating */
+  if (! GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_INVALID) &&
+      ! GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_COLUMN_INVALID))
+    return FALSE;
+
+  validate_row_data_init (tree_view, &data);
+
+  context = gtk_widget_get_style_context (GTK_WIDGET (tree_view));
+  gtk_style_context_save (context);
+  gtk_style_context_add_class (context, "cell");
+
+  retval = validate_row_with_data (tree_view, &data, tree, node, iter, path);
+
+  gtk_style_context_restore (context);
+
+  return retval;
+}
+
 
 static void
 validate_visible_area (GtkTreeView *tree_view)
@@ -6117,6 +6160,8 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
   int retval = TRUE;
   GtkTreePath *path = NULL;
   GtkTreeIter iter;
+  GtkStyleContext *context;
+  ValidateRowData data;
   GTimer *timer;
   int i = 0;
 
@@ -6144,6 +6189,12 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
   timer = g_timer_new ();
   g_timer_start (timer);
 
+  validate_row_data_init (tree_view, &data);
+
+  context = gtk_widget_get_style_context (GTK_WIDGET (tree_view));
+  gtk_style_context_save (context);
+  gtk_style_context_add_class (context, "cell");
+
   do
     {
       gboolean changed = FALSE;
@@ -6159,7 +6210,11 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
 	  node = gtk_tree_rbtree_next (tree, node);
 	  if (node != NULL)
 	    {
-	      TREE_VIEW_INTERNAL_ASSERT (gtk_tree_model_iter_next (priv->model, &iter), FALSE);
+	      gboolean has_next = gtk_tree_model_iter_next (priv->model, &iter);
+
+	      if (!has_next)
+	        gtk_style_context_restore (context);
+	      TREE_VIEW_INTERNAL_ASSERT (has_next, FALSE);
 	      gtk_tree_path_next (path);
 	    }
 	  else
@@ -6207,7 +6262,7 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
 	  gtk_tree_model_get_iter (priv->model, &iter, path);
 	}
 
-      changed = validate_row (tree_view, tree, node, &iter, path);
+      changed = validate_row_with_data (tree_view, &data, tree, node, &iter, path);
       validated_area = changed || validated_area;
 
       if (changed)
@@ -6242,6 +6297,8 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
    }
   
  done:
+  gtk_style_context_restore (context);
+
   if (validated_area)
     {
       GtkRequisition requisition;
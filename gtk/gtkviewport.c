@@ -71,6 +71,12 @@ struct _GtkViewport
   GtkScrollablePolicy scroll_policy[2];
   guint scroll_to_focus : 1;
 
+  /* The child size from the last allocation, reused when only
+   * the adjustment values changed since then */
+  guint child_size_valid : 1;
+  int child_size[2];
+  int allocated_size[2];
+
   gulong focus_handler;
 };
 
@@ -186,6 +192,8 @@ gtk_viewport_measure (GtkWidget      *widget,
 {
   GtkViewport *viewport = GTK_VIEWPORT (widget);
 
+  viewport->child_size_valid = FALSE;
+
   if (viewport->child)
     gtk_widget_measure (viewport->child,
                         orientation,
@@ -358,6 +366,7 @@ gtk_viewport_set_property (GObject         *object,
       if (viewport->scroll_policy[GTK_ORIENTATION_HORIZONTAL] != g_value_get_enum (value))
         {
           viewport->scroll_policy[GTK_ORIENTATION_HORIZONTAL] = g_value_get_enum (value);
+          viewport->child_size_valid = FALSE;
           gtk_widget_queue_resize (GTK_WIDGET (viewport));
           g_object_notify_by_pspec (object, pspec);
         }
@@ -366,6 +375,7 @@ gtk_viewport_set_property (GObject         *object,
       if (viewport->scroll_policy[GTK_ORIENTATION_VERTICAL] != g_value_get_enum (value))
         {
           viewport->scroll_policy[GTK_ORIENTATION_VERTICAL] = g_value_get_enum (value);
+          viewport->child_size_valid = FALSE;
           gtk_widget_queue_resize (GTK_WIDGET (viewport));
           g_object_notify_by_pspec (object, pspec);
         }
@@ -496,7 +506,21 @@ gtk_viewport_size_allocate (GtkWidget *widget,
   child_size[GTK_ORIENTATION_HORIZONTAL] = width;
   child_size[GTK_ORIENTATION_VERTICAL] = height;
 
-  if (viewport->child && gtk_widget_get_visible (viewport->child))
+  /* When we are only being reallocated because we scrolled, the
+   * child keeps its size and just moves, so don't measure it again.
+   * With the child's allocation skipped, that leaves scrolling as
+   * a change of the child's transform, and its render node is reused.
+   */
+  if (viewport->child && gtk_widget_get_visible (viewport->child) &&
+      viewport->child_size_valid &&
+      viewport->allocated_size[GTK_ORIENTATION_HORIZONTAL] == width &&
+      viewport->allocated_size[GTK_ORIENTATION_VERTICAL] == height &&
+      !_gtk_widget_get_alloc_needed (viewport->child))
+    {
+      child_size[GTK_ORIENTATION_HORIZONTAL] = viewport->child_size[GTK_ORIENTATION_HORIZONTAL];
+      child_size[GTK_ORIENTATION_VERTICAL] = viewport->child_size[GTK_ORIENTATION_VERTICAL];
+    }
+  else if (viewport->child && gtk_widget_get_visible (viewport->child))
     {
       GtkOrientation orientation, opposite;
       int min, nat;
@@ -524,6 +548,12 @@ gtk_viewport_size_allocate (GtkWidget *widget,
         child_size[opposite] = MAX (child_size[opposite], min);
       else
         child_size[opposite] = MAX (child_size[opposite], nat);
+
+      viewport->child_size[GTK_ORIENTATION_HORIZONTAL] = child_size[GTK_ORIENTATION_HORIZONTAL];
+      viewport->child_size[GTK_ORIENTATION_VERTICAL] = child_size[GTK_ORIENTATION_VERTICAL];
+      viewport->allocated_size[GTK_ORIENTATION_HORIZONTAL] = width;
+      viewport->allocated_size[GTK_ORIENTATION_VERTICAL] = height;
+      viewport->child_size_valid = TRUE;
     }
 
   viewport_set_adjustment_values (viewport, GTK_ORIENTATION_HORIZONTAL, width, child_size[GTK_ORIENTATION_HORIZONTAL]);
@@ -691,6 +721,7 @@ gtk_viewport_set_child (GtkViewport *viewport,
     return;
 
   g_clear_pointer (&viewport->child, gtk_widget_unparent);
+  viewport->child_size_valid = FALSE;
 
   if (child)
     {
@@ -48,6 +48,7 @@
 #include "gtkgestureprivate.h"
 #include "gtkintl.h"
 #include "gtklayoutmanagerprivate.h"
+#include "gtklistitemfactoryprivate.h"
 #include "gtkmain.h"
 #include "gtkmarshalers.h"
 #include "gtknative.h"
@@ -79,6 +80,7 @@
 #include "inspector/window.h"
 
 #include "gdk/gdkeventsprivate.h"
+#include "gdk/gdkframeclockprivate.h"
 #include "gdk/gdkprofilerprivate.h"
 #include "gsk/gskdebugprivate.h"
 #include "gsk/gskrendererprivate.h"
@@ -747,6 +749,49 @@ gtk_widget_real_contains (GtkWidget *widget,
                                           &GRAPHENE_POINT_INIT (x, y));
 }
 
+/* Widgets with at least this many children keep a grid of where
+ * their children are, so that picking does not have to transform
+ * the point into every one of them.
+ */
+#define PICK_INDEX_MIN_CHILDREN 64
+#define PICK_INDEX_MAX_CELLS 64
+
+struct _GtkPickIndex
+{
+  guint n_children;
+  GtkWidget **children;        /* in stacking order */
+  graphene_rect_t *bounds;     /* in parent coordinates */
+
+  /* Children that may be picked outside of their bounds */
+  GArray *unbounded;
+
+  graphene_rect_t extents;
+  guint cols, rows;
+  float cell_width, cell_height;
+  GArray **cells;              /* child indexes, ascending */
+};
+
+static void
+gtk_pick_index_free (GtkPickIndex *index)
+{
+  guint i;
+
+  for (i = 0; i < index->cols * index->rows; i++)
+    g_array_unref (index->cells[i]);
+  g_free (index->cells);
+  g_array_unref (index->unbounded);
+  g_free (index->bounds);
+  g_free (index->children);
+  g_slice_free (GtkPickIndex, index);
+}
+
+static inline void
+gtk_widget_invalidate_pick_index (GtkWidget *widget)
+{
+  if (widget)
+    g_clear_pointer (&widget->priv->pick_index, gtk_pick_index_free);
+}
+
 static void
 gtk_widget_real_root (GtkWidget *widget)
 {
@@ -2622,6 +2667,10 @@ gtk_widget_unparent (GtkWidget *widget)
   priv->prev_sibling = NULL;
   priv->next_sibling = NULL;
 
+  /* The grandparent too, as the parent may have lost its last child */
+  gtk_widget_invalidate_pick_index (old_parent);
+  gtk_widget_invalidate_pick_index (old_parent->priv->parent);
+
   /* parent may no longer expand if the removed
    * child was expand=TRUE and could therefore
    * be forcing it to.
@@ -3532,8 +3581,17 @@ gtk_widget_get_surface_allocation (GtkWidget     *widget,
 void
 gtk_widget_queue_draw (GtkWidget *widget)
 {
+  GtkWidgetPrivate *widget_priv;
+
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
+  /* Only the widget itself may have changed its background or border,
+   * its ancestors just need to pick up the new render node. This is
+   * done even for unmapped widgets, as they may change their style
+   * while unmapped. */
+  widget_priv = gtk_widget_get_instance_private (widget);
+  g_clear_pointer (&widget_priv->boxes_node, gsk_render_node_unref);
+
   /* Just return if the widget isn't mapped */
   if (!_gtk_widget_get_mapped (widget))
     return;
@@ -3542,16 +3600,47 @@ gtk_widget_queue_draw (GtkWidget *widget)
     {
       GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
 
-      if (priv->draw_needed)
+      /* A widget that only needs its effects redrawn still has
+       * its content, so the loop must go on to get rid of it */
+      if (priv->draw_needed && priv->content_node == NULL)
         break;
 
       priv->draw_needed = TRUE;
       g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+      g_clear_pointer (&priv->content_node, gsk_render_node_unref);
       if (GTK_IS_NATIVE (widget) && _gtk_widget_get_realized (widget))
         gdk_surface_queue_render (gtk_native_get_surface (GTK_NATIVE (widget)));
     }
 }
 
+/*
+ * gtk_widget_queue_draw_effects:
+ * @widget: a `GtkWidget`
+ *
+ * Like gtk_widget_queue_draw(), but only the opacity and filters
+ * of @widget have changed. The content of @widget is kept and
+ * wrapped in the new effects, without calling the snapshot vfunc.
+ */
+static void
+gtk_widget_queue_draw_effects (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  if (!_gtk_widget_get_mapped (widget))
+    return;
+
+  if (priv->draw_needed)
+    return;
+
+  priv->draw_needed = TRUE;
+  g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+
+  if (priv->parent)
+    gtk_widget_queue_draw (priv->parent);
+  else if (GTK_IS_NATIVE (widget) && _gtk_widget_get_realized (widget))
+    gdk_surface_queue_render (gtk_native_get_surface (GTK_NATIVE (widget)));
+}
+
 static void
 gtk_widget_set_alloc_needed (GtkWidget *widget);
 
@@ -3894,6 +3983,39 @@ gtk_widget_adjust_size_allocation (GtkWidget     *widget,
     }
 }
 
+/* Allocating widgets whose allocation did not change is skipped,
+ * these count how often that happens, for the profiler.
+ */
+static guint n_allocations;
+static guint n_skipped_allocations;
+
+static void
+gtk_widget_report_allocations (void)
+{
+  static guint allocations_counter;
+  static guint skipped_counter;
+
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      if (allocations_counter == 0)
+        {
+          allocations_counter = gdk_profiler_define_int_counter ("allocations",
+                                                                 "Widgets allocated");
+          skipped_counter = gdk_profiler_define_int_counter ("skipped-allocations",
+                                                             "Widget allocations skipped as unchanged");
+        }
+
+      gdk_profiler_set_int_counter (allocations_counter, n_allocations);
+      gdk_profiler_set_int_counter (skipped_counter, n_skipped_allocations);
+    }
+
+  n_allocations = 0;
+  n_skipped_allocations = 0;
+
+  _gtk_size_request_cache_report_stats ();
+  gtk_list_item_factory_report_stats ();
+}
+
 /**
  * gtk_widget_allocate:
  * @widget: A `GtkWidget`
@@ -3979,6 +4101,21 @@ gtk_widget_allocate (GtkWidget    *widget,
   baseline_changed = priv->allocated_size_baseline != baseline;
   transform_changed = !gsk_transform_equal (priv->allocated_transform, transform);
 
+  /* Nothing changed for this widget or any of its children, so
+   * there is no need to descend into the subtree at all.
+   */
+  if (!alloc_needed && !priv->alloc_needed_on_child && !priv->transform_needed &&
+      !baseline_changed && !transform_changed &&
+      priv->allocated_width == width && priv->allocated_height == height)
+    {
+      gsk_transform_unref (transform);
+      n_skipped_allocations++;
+      goto out;
+    }
+
+  n_allocations++;
+  priv->transform_needed = FALSE;
+
   gsk_transform_unref (priv->allocated_transform);
   priv->allocated_transform = gsk_transform_ref (transform);
   priv->allocated_width = width;
@@ -4048,6 +4185,8 @@ gtk_widget_allocate (GtkWidget    *widget,
   gsk_transform_unref (priv->transform);
   priv->transform = transform;
 
+  gtk_widget_invalidate_pick_index (priv->parent);
+
   if (priv->surface_transform_data)
     sync_widget_surface_transform (widget);
 
@@ -4110,6 +4249,9 @@ out:
   if (priv->alloc_needed_on_child)
     gtk_widget_ensure_allocate (widget);
 
+  if (GTK_IS_NATIVE (widget))
+    gtk_widget_report_allocations ();
+
   gtk_widget_pop_verify_invariants (widget);
 }
 
@@ -4530,8 +4672,16 @@ gtk_widget_run_controllers (GtkWidget           *widget,
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GtkEventController *controller;
   gboolean handled = FALSE;
+  guint event_type_bit;
   GList *l;
 
+  /* Don't bother when none of the controllers looks at this kind
+   * of event, which is the common case for motion events.
+   */
+  event_type_bit = GTK_EVENT_TYPE_BIT (gdk_event_get_event_type (event));
+  if ((priv->controller_event_types & event_type_bit) == 0)
+    return FALSE;
+
   g_object_ref (widget);
 
   l = priv->event_controllers;
@@ -4554,7 +4704,8 @@ gtk_widget_run_controllers (GtkWidget           *widget,
 
           controller_phase = gtk_event_controller_get_propagation_phase (controller);
 
-          if (controller_phase == phase)
+          if (controller_phase == phase &&
+              (gtk_event_controller_get_event_types (controller) & event_type_bit) != 0)
             {
               gboolean this_handled;
               gboolean is_gesture;
@@ -4974,14 +5125,32 @@ gtk_widget_real_css_changed (GtkWidget         *widget,
           else if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TRANSFORM) &&
                    priv->parent)
             {
-              gtk_widget_queue_allocate (priv->parent);
+              /* Only the transform changed, so the allocation is the
+               * same. Recompute the transform without relayouting the
+               * parent and keep the render node of the widget. */
+              if (!priv->alloc_needed && !priv->resize_needed && priv->mapped)
+                {
+                  priv->transform_needed = TRUE;
+                  gtk_widget_allocate (widget,
+                                       priv->allocated_width,
+                                       priv->allocated_height,
+                                       priv->allocated_size_baseline,
+                                       gsk_transform_ref (priv->allocated_transform));
+                  gtk_widget_queue_draw (priv->parent);
+                }
+              else
+                gtk_widget_queue_allocate (priv->parent);
             }
 
-          if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_REDRAW) ||
+          if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_REDRAW & ~GTK_CSS_AFFECTS_POSTEFFECT) ||
               (has_text && gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TEXT_CONTENT)))
             {
               gtk_widget_queue_draw (widget);
             }
+          else if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_POSTEFFECT))
+            {
+              gtk_widget_queue_draw_effects (widget);
+            }
         }
     }
   else
@@ -5991,6 +6160,9 @@ gtk_widget_reposition_after (GtkWidget *widget,
 
   priv->parent = parent;
 
+  gtk_widget_invalidate_pick_index (parent);
+  gtk_widget_invalidate_pick_index (parent->priv->parent);
+
   if (previous_sibling)
     {
       if (previous_sibling->priv->next_sibling)
@@ -7598,6 +7770,10 @@ gtk_widget_finalize (GObject *object)
 
   g_clear_pointer (&priv->transform, gsk_transform_unref);
   g_clear_pointer (&priv->allocated_transform, gsk_transform_unref);
+  g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+  g_clear_pointer (&priv->content_node, gsk_render_node_unref);
+  g_clear_pointer (&priv->boxes_node, gsk_render_node_unref);
+  g_clear_pointer (&priv->pick_index, gtk_pick_index_free);
 
   gtk_css_widget_node_widget_destroyed (GTK_CSS_WIDGET_NODE (priv->cssnode));
   g_object_unref (priv->cssnode);
@@ -10044,6 +10220,209 @@ gtk_widget_can_be_picked (GtkWidget    *widget,
   return TRUE;
 }
 
+static GtkWidget *gtk_widget_do_pick (GtkWidget    *widget,
+                                      double        x,
+                                      double        y,
+                                      GtkPickFlags  flags);
+
+static GtkWidget *
+gtk_widget_pick_child (GtkWidget    *child,
+                       double        x,
+                       double        y,
+                       GtkPickFlags  flags)
+{
+  GtkWidgetPrivate *child_priv = gtk_widget_get_instance_private (child);
+  graphene_point3d_t res;
+
+  if (!gtk_widget_can_be_picked (child, flags))
+    return NULL;
+
+  if (GTK_IS_NATIVE (child))
+    return NULL;
+
+  if (child_priv->transform)
+    {
+      if (gsk_transform_get_category (child_priv->transform) >= GSK_TRANSFORM_CATEGORY_2D_TRANSLATE)
+        {
+          graphene_point_t transformed_p;
+
+          gsk_transform_transform_point (child_priv->transform,
+                                         &(graphene_point_t) { 0, 0 },
+                                         &transformed_p);
+
+          graphene_point3d_init (&res, x - transformed_p.x, y - transformed_p.y, 0.);
+        }
+      else
+        {
+          GskTransform *transform;
+          graphene_matrix_t inv;
+          graphene_point3d_t p0, p1;
+
+          transform = gsk_transform_invert (gsk_transform_ref (child_priv->transform));
+          if (transform == NULL)
+            return NULL;
+
+          gsk_transform_to_matrix (transform, &inv);
+          gsk_transform_unref (transform);
+          graphene_point3d_init (&p0, x, y, 0);
+          graphene_point3d_init (&p1, x, y, 1);
+          graphene_matrix_transform_point3d (&inv, &p0, &p0);
+          graphene_matrix_transform_point3d (&inv, &p1, &p1);
+          if (fabs (p0.z - p1.z) < 1.f / 4096)
+            return NULL;
+
+          graphene_point3d_interpolate (&p0, &p1, p0.z / (p0.z - p1.z), &res);
+        }
+    }
+  else
+    {
+      graphene_point3d_init (&res, x, y, 0);
+    }
+
+  return gtk_widget_do_pick (child, res.x, res.y, flags);
+}
+
+/* Whether picking @child can only ever find something inside
+ * its border box, and where that box is in parent coordinates.
+ */
+static gboolean
+gtk_widget_get_pick_bounds (GtkWidget       *child,
+                            graphene_rect_t *bounds)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (child);
+  GtkCssBoxes boxes;
+
+  if (GTK_WIDGET_GET_CLASS (child)->contains != gtk_widget_real_contains)
+    return FALSE;
+
+  if (priv->first_child != NULL && priv->overflow != GTK_OVERFLOW_HIDDEN)
+    return FALSE;
+
+  if (priv->transform &&
+      gsk_transform_get_category (priv->transform) < GSK_TRANSFORM_CATEGORY_2D)
+    return FALSE;
+
+  gtk_css_boxes_init (&boxes, child);
+  gsk_transform_transform_bounds (priv->transform,
+                                  gtk_css_boxes_get_border_rect (&boxes),
+                                  bounds);
+  graphene_rect_normalize (bounds);
+
+  return TRUE;
+}
+
+static GtkPickIndex *
+gtk_pick_index_new (GtkWidget *widget,
+                    guint      n_children)
+{
+  GtkPickIndex *index;
+  GtkWidget *child;
+  guint i, n_bounded, side;
+  gboolean *bounded;
+  int col, row, col0, row0, col1, row1;
+
+  index = g_slice_new0 (GtkPickIndex);
+  index->n_children = n_children;
+  index->children = g_new (GtkWidget *, n_children);
+  index->bounds = g_new (graphene_rect_t, n_children);
+  index->unbounded = g_array_new (FALSE, FALSE, sizeof (guint));
+  bounded = g_new (gboolean, n_children);
+
+  n_bounded = 0;
+  for (child = _gtk_widget_get_first_child (widget), i = 0;
+       child;
+       child = _gtk_widget_get_next_sibling (child), i++)
+    {
+      index->children[i] = child;
+      bounded[i] = gtk_widget_get_pick_bounds (child, &index->bounds[i]);
+      if (!bounded[i])
+        {
+          g_array_append_val (index->unbounded, i);
+          continue;
+        }
+
+      if (n_bounded == 0)
+        index->extents = index->bounds[i];
+      else
+        graphene_rect_union (&index->extents, &index->bounds[i], &index->extents);
+      n_bounded++;
+    }
+
+  /* Aim for a handful of children per cell */
+  side = CLAMP ((guint) ceil (sqrt (n_bounded / 4.0)), 1, PICK_INDEX_MAX_CELLS);
+  index->cols = index->rows = side;
+  index->cell_width = MAX (index->extents.size.width / side, 1);
+  index->cell_height = MAX (index->extents.size.height / side, 1);
+  index->cells = g_new (GArray *, side * side);
+  for (i = 0; i < side * side; i++)
+    index->cells[i] = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (i = 0; i < n_children; i++)
+    {
+      const graphene_rect_t *b = &index->bounds[i];
+
+      if (!bounded[i])
+        continue;
+
+      col0 = CLAMP ((b->origin.x - index->extents.origin.x) / index->cell_width, 0, side - 1);
+      row0 = CLAMP ((b->origin.y - index->extents.origin.y) / index->cell_height, 0, side - 1);
+      col1 = CLAMP ((b->origin.x + b->size.width - index->extents.origin.x) / index->cell_width, 0, side - 1);
+      row1 = CLAMP ((b->origin.y + b->size.height - index->extents.origin.y) / index->cell_height, 0, side - 1);
+
+      for (row = row0; row <= row1; row++)
+        for (col = col0; col <= col1; col++)
+          g_array_append_val (index->cells[row * side + col], i);
+    }
+
+  g_free (bounded);
+
+  return index;
+}
+
+static GtkWidget *
+gtk_pick_index_pick (GtkPickIndex *index,
+                     double        x,
+                     double        y,
+                     GtkPickFlags  flags)
+{
+  const graphene_point_t p = GRAPHENE_POINT_INIT (x, y);
+  GArray *cell = NULL;
+  guint c, u;
+
+  if (graphene_rect_contains_point (&index->extents, &p))
+    {
+      int col = CLAMP ((x - index->extents.origin.x) / index->cell_width, 0, index->cols - 1);
+      int row = CLAMP ((y - index->extents.origin.y) / index->cell_height, 0, index->rows - 1);
+
+      cell = index->cells[row * index->cols + col];
+    }
+
+  /* Merge the cell with the unbounded children, topmost first */
+  c = cell ? cell->len : 0;
+  u = index->unbounded->len;
+  while (c > 0 || u > 0)
+    {
+      GtkWidget *picked;
+      guint i;
+
+      if (u == 0 ||
+          (c > 0 && g_array_index (cell, guint, c - 1) > g_array_index (index->unbounded, guint, u - 1)))
+        {
+          i = g_array_index (cell, guint, --c);
+          if (!graphene_rect_contains_point (&index->bounds[i], &p))
+            continue;
+        }
+      else
+        i = g_array_index (index->unbounded, guint, --u);
+
+      picked = gtk_widget_pick_child (index->children[i], x, y, flags);
+      if (picked)
+        return picked;
+    }
+
+  return NULL;
+}
+
 static GtkWidget *
 gtk_widget_do_pick (GtkWidget    *widget,
                     double        x,
@@ -10052,6 +10431,7 @@ gtk_widget_do_pick (GtkWidget    *widget,
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GtkWidget *child;
+  guint n_children;
 
   if (priv->overflow == GTK_OVERFLOW_HIDDEN)
     {
@@ -10064,63 +10444,44 @@ gtk_widget_do_pick (GtkWidget    *widget,
         return NULL;
     }
 
-  for (child = _gtk_widget_get_last_child (widget);
-       child;
-       child = _gtk_widget_get_prev_sibling (child))
+  if (priv->pick_index == NULL)
     {
-      GtkWidgetPrivate *child_priv = gtk_widget_get_instance_private (child);
-      GtkWidget *picked;
-      graphene_point3d_t res;
-
-      if (!gtk_widget_can_be_picked (child, flags))
-        continue;
-
-      if (GTK_IS_NATIVE (child))
-        continue;
+      n_children = 0;
+      for (child = _gtk_widget_get_first_child (widget);
+           child && n_children < PICK_INDEX_MIN_CHILDREN;
+           child = _gtk_widget_get_next_sibling (child))
+        n_children++;
 
-      if (child_priv->transform)
+      if (n_children == PICK_INDEX_MIN_CHILDREN)
         {
-          if (gsk_transform_get_category (child_priv->transform) >= GSK_TRANSFORM_CATEGORY_2D_TRANSLATE)
-            {
-              graphene_point_t transformed_p;
-
-              gsk_transform_transform_point (child_priv->transform,
-                                             &(graphene_point_t) { 0, 0 },
-                                             &transformed_p);
+          for (; child; child = _gtk_widget_get_next_sibling (child))
+            n_children++;
 
-              graphene_point3d_init (&res, x - transformed_p.x, y - transformed_p.y, 0.);
-            }
-          else
-            {
-              GskTransform *transform;
-              graphene_matrix_t inv;
-              graphene_point3d_t p0, p1;
-
-              transform = gsk_transform_invert (gsk_transform_ref (child_priv->transform));
-              if (transform == NULL)
-                continue;
-
-              gsk_transform_to_matrix (transform, &inv);
-              gsk_transform_unref (transform);
-              graphene_point3d_init (&p0, x, y, 0);
-              graphene_point3d_init (&p1, x, y, 1);
-              graphene_matrix_transform_point3d (&inv, &p0, &p0);
-              graphene_matrix_transform_point3d (&inv, &p1, &p1);
-              if (fabs (p0.z - p1.z) < 1.f / 4096)
-                continue;
-
-              graphene_point3d_interpolate (&p0, &p1, p0.z / (p0.z - p1.z), &res);
-            }
-        }
-      else
-        {
-          graphene_point3d_init (&res, x, y, 0);
+          priv->pick_index = gtk_pick_index_new (widget, n_children);
         }
+    }
 
-      picked = gtk_widget_do_pick (child, res.x, res.y, flags);
+  if (priv->pick_index)
+    {
+      GtkWidget *picked;
+
+      picked = gtk_pick_index_pick (priv->pick_index, x, y, flags);
       if (picked)
         return picked;
     }
+  else
+    {
+      for (child = _gtk_widget_get_last_child (widget);
+           child;
+           child = _gtk_widget_get_prev_sibling (child))
+        {
+          GtkWidget *picked;
+
+          picked = gtk_widget_pick_child (child, x, y, flags);
+          if (picked)
+            return picked;
+        }
+    }
 
   if (!GTK_WIDGET_GET_CLASS (widget)->contains (widget, x, y))
     return NULL;
@@ -10410,7 +10771,7 @@ gtk_widget_set_opacity (GtkWidget *widget,
 
   priv->user_alpha = alpha;
 
-  gtk_widget_queue_draw (widget);
+  gtk_widget_queue_draw_effects (widget);
 
   g_object_notify_by_pspec (G_OBJECT (widget), widget_props[PROP_OPACITY]);
 }
@@ -10463,6 +10824,9 @@ gtk_widget_set_overflow (GtkWidget   *widget,
 
   priv->overflow = overflow;
 
+  /* Whether children can be picked outside our box changed */
+  gtk_widget_invalidate_pick_index (priv->parent);
+
   gtk_widget_queue_draw (widget);
 
   g_object_notify_by_pspec (G_OBJECT (widget), widget_props[PROP_OVERFLOW]);
@@ -11459,6 +11823,7 @@ gtk_widget_add_controller (GtkWidget          *widget,
   GTK_EVENT_CONTROLLER_GET_CLASS (controller)->set_widget (controller, widget);
 
   priv->event_controllers = g_list_prepend (priv->event_controllers, controller);
+  priv->controller_event_types |= gtk_event_controller_get_event_types (controller);
 
   if (priv->controller_observer)
     gtk_list_list_model_item_added_at (priv->controller_observer, 0);
@@ -11495,6 +11860,13 @@ gtk_widget_remove_controller (GtkWidget          *widget,
   priv->event_controllers = g_list_delete_link (priv->event_controllers, list);
   g_object_unref (controller);
 
+  priv->controller_event_types = 0;
+  for (list = priv->event_controllers; list; list = list->next)
+    {
+      if (list->data)
+        priv->controller_event_types |= gtk_event_controller_get_event_types (list->data);
+    }
+
   if (priv->controller_observer)
     gtk_list_list_model_item_removed (priv->controller_observer, before);
 }
@@ -11573,21 +11945,39 @@ gtk_widget_create_render_node (GtkWidget   *widget,
   if (opacity < 1.0)
     gtk_snapshot_push_opacity (snapshot, opacity);
 
-  gtk_css_style_snapshot_background (&boxes, snapshot);
-  gtk_css_style_snapshot_border (&boxes, snapshot);
-
-  if (priv->overflow == GTK_OVERFLOW_HIDDEN)
-    {
-      gtk_snapshot_push_rounded_clip (snapshot, gtk_css_boxes_get_padding_box (&boxes));
-      klass->snapshot (widget, snapshot);
-      gtk_snapshot_pop (snapshot);
-    }
-  else
+  if (priv->content_node == NULL)
     {
-      klass->snapshot (widget, snapshot);
+      gtk_snapshot_push_collect (snapshot);
+
+      if (priv->boxes_node == NULL)
+        {
+          gtk_snapshot_push_collect (snapshot);
+          gtk_css_style_snapshot_background (&boxes, snapshot);
+          gtk_css_style_snapshot_border (&boxes, snapshot);
+          priv->boxes_node = gtk_snapshot_pop_collect (snapshot);
+        }
+
+      if (priv->boxes_node)
+        gtk_snapshot_append_node (snapshot, priv->boxes_node);
+
+      if (priv->overflow == GTK_OVERFLOW_HIDDEN)
+        {
+          gtk_snapshot_push_rounded_clip (snapshot, gtk_css_boxes_get_padding_box (&boxes));
+          klass->snapshot (widget, snapshot);
+          gtk_snapshot_pop (snapshot);
+        }
+      else
+        {
+          klass->snapshot (widget, snapshot);
+        }
+
+      gtk_css_style_snapshot_outline (&boxes, snapshot);
+
+      priv->content_node = gtk_snapshot_pop_collect (snapshot);
     }
 
-  gtk_css_style_snapshot_outline (&boxes, snapshot);
+  if (priv->content_node)
+    gtk_snapshot_append_node (snapshot, priv->content_node);
 
   if (opacity < 1.0)
     gtk_snapshot_pop (snapshot);
@@ -11656,9 +12046,11 @@ gtk_widget_render (GtkWidget            *widget,
   GtkSnapshot *snapshot;
   GskRenderer *renderer;
   GskRenderNode *root;
+  GdkFrameClock *clock;
   double x, y;
   gint64 before_snapshot G_GNUC_UNUSED;
   gint64 before_render G_GNUC_UNUSED;
+  gint64 span_start;
 
   before_snapshot = GDK_PROFILER_CURRENT_TIME;
   before_render = 0;
@@ -11670,12 +12062,17 @@ gtk_widget_render (GtkWidget            *widget,
   if (renderer == NULL)
     return;
 
+  clock = gdk_surface_get_frame_clock (surface);
+  span_start = _gdk_frame_clock_begin_span (clock);
+
   snapshot = gtk_snapshot_new ();
   gtk_native_get_surface_transform (GTK_NATIVE (widget), &x, &y);
   gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (x, y));
   gtk_widget_snapshot (widget, snapshot);
   root = gtk_snapshot_free_to_node (snapshot);
 
+  _gdk_frame_clock_end_span (clock, GDK_FRAME_SPAN_SNAPSHOT, span_start);
+
   if (GDK_PROFILER_IS_RUNNING)
     {
       before_render = GDK_PROFILER_CURRENT_TIME;
@@ -47,6 +47,8 @@ typedef gboolean (*GtkSurfaceTransformChangedCallback) (GtkWidget
 
 #define GTK_STATE_FLAGS_BITS 15
 
+typedef struct _GtkPickIndex GtkPickIndex;
+
 typedef struct _GtkWidgetSurfaceTransformData
 {
   GtkWidget *tracked_parent;
@@ -86,6 +88,7 @@ struct _GtkWidgetPrivate
   guint resize_needed         : 1; /* queue_resize() has been called but no get_preferred_size() yet */
   guint alloc_needed          : 1; /* this widget needs a size_allocate() call */
   guint alloc_needed_on_child : 1; /* 0 or more children - or this widget - need a size_allocate() call */
+  guint transform_needed      : 1; /* the CSS transform changed, even if the allocation did not */
 
   /* Queue-draw related flags */
   guint draw_needed           : 1;
@@ -115,32 +118,29 @@ struct _GtkWidgetPrivate
   guint8 verifying_invariants_count;
 #endif
 
-  int width_request;
-  int height_request;
-
-  /* Animations and other things to update on clock ticks */
-  guint clock_tick_id;
-  guint8 n_active;
-  GList *tick_callbacks;
+  /* The fields up to the requested sizes are the ones that tree
+   * walks like snapshot, pick, allocation and event propagation
+   * touch on every widget. Keep them together at the start so
+   * that visiting a widget costs as few cache lines as possible.
+   */
 
-  void (* resize_func) (GtkWidget *);
-  GtkBorder margin;
+  /* The union of the event types the controllers handle */
+  guint controller_event_types;
 
-  /* Surface relative transform updates callbacks */
-  GtkWidgetSurfaceTransformData *surface_transform_data;
+  /* Widget tree */
+  GtkWidget *parent;
+  GtkWidget *prev_sibling;
+  GtkWidget *next_sibling;
+  GtkWidget *first_child;
+  GtkWidget *last_child;
 
-  /* The widget's name. If the widget does not have a name
-   * (the name is NULL), then its name (as returned by
-   * "gtk_widget_get_name") is its class's name.
-   * Among other things, the widget name is used to determine
-   * the style to use for a widget.
-   */
-  char *name;
+  int width;
+  int height;
+  int baseline;
+  GskTransform *transform;
 
-  /* The root this widget belongs to or %NULL if widget is not
-   * rooted or is a GtkRoot itself.
-   */
-  GtkRoot *root;
+  /* The render node we draw or %NULL if not yet created.*/
+  GskRenderNode *render_node;
 
   /* The style for the widget. The style contains the
    * colors the widget should be drawn in for each state
@@ -148,7 +148,20 @@ struct _GtkWidgetPrivate
    * the font to use for text.
    */
   GtkCssNode *cssnode;
-  GtkStyleContext *context;
+
+  /* The root this widget belongs to or %NULL if widget is not
+   * rooted or is a GtkRoot itself.
+   */
+  GtkRoot *root;
+
+  GList *event_controllers;
+
+  /* Where the children are, for picking among many of them,
+   * or %NULL if not built or out of date */
+  GtkPickIndex *pick_index;
+
+  /* The layout manager, or %NULL */
+  GtkLayoutManager *layout_manager;
 
   /* The widget's allocated size */
   GskTransform *allocated_transform;
@@ -156,30 +169,43 @@ struct _GtkWidgetPrivate
   int allocated_height;
   int allocated_size_baseline;
 
-  int width;
-  int height;
-  int baseline;
-  GskTransform *transform;
+  GtkBorder margin;
 
   /* The widget's requested sizes */
   SizeRequestCache requests;
 
-  /* The render node we draw or %NULL if not yet created.*/
-  GskRenderNode *render_node;
+  int width_request;
+  int height_request;
 
-  /* The layout manager, or %NULL */
-  GtkLayoutManager *layout_manager;
+  /* Animations and other things to update on clock ticks */
+  guint clock_tick_id;
+  guint8 n_active;
+  GList *tick_callbacks;
 
-  GSList *paintables;
+  void (* resize_func) (GtkWidget *);
 
-  GList *event_controllers;
+  /* Surface relative transform updates callbacks */
+  GtkWidgetSurfaceTransformData *surface_transform_data;
 
-  /* Widget tree */
-  GtkWidget *parent;
-  GtkWidget *prev_sibling;
-  GtkWidget *next_sibling;
-  GtkWidget *first_child;
-  GtkWidget *last_child;
+  /* The widget's name. If the widget does not have a name
+   * (the name is NULL), then its name (as returned by
+   * "gtk_widget_get_name") is its class's name.
+   * Among other things, the widget name is used to determine
+   * the style to use for a widget.
+   */
+  char *name;
+
+  GtkStyleContext *context;
+
+  /* The part of render_node inside opacity and filters, kept when
+   * only those change so that the widget need not be snapshot again */
+  GskRenderNode *content_node;
+  /* The CSS background and border of content_node. They only depend
+   * on the widget's own style and size, so they are kept when the
+   * widget is redrawn because one of its descendants changed */
+  GskRenderNode *boxes_node;
+
+  GSList *paintables;
 
   /* only created on-demand */
   GtkListListModel *children_observer;
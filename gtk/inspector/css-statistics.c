@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <glib/gi18n-lib.h>
+
+#include "css-statistics.h"
+
+#include "gtkbinlayout.h"
+#include "gtkbox.h"
+#include "gtkcssstatisticsprivate.h"
+#include "gtklabel.h"
+#include "gtklistbox.h"
+#include "gtktogglebutton.h"
+
+/* How many selectors to show */
+#define MAX_SELECTORS 50
+
+enum
+{
+  PROP_0,
+  PROP_BUTTON
+};
+
+struct _GtkInspectorCssStatistics
+{
+  GtkWidget parent;
+
+  GtkWidget *swin;
+  GtkWidget *counters;
+  GtkWidget *selectors_label;
+  GtkWidget *selectors;
+  GtkWidget *button;
+
+  GtkWidget *last_frame_labels[GTK_CSS_N_STATS + 1];
+  GtkWidget *total_labels[GTK_CSS_N_STATS + 1];
+
+  guint update_source_id;
+};
+
+typedef struct _GtkInspectorCssStatisticsClass
+{
+  GtkWidgetClass parent_class;
+} GtkInspectorCssStatisticsClass;
+
+G_DEFINE_TYPE (GtkInspectorCssStatistics, gtk_inspector_css_statistics, GTK_TYPE_WIDGET)
+
+static const char *stat_names[GTK_CSS_N_STATS] = {
+  [GTK_CSS_STAT_INVALIDATED_NODES] = N_("Invalidated nodes"),
+  [GTK_CSS_STAT_CREATED_STYLES] = N_("Computed styles"),
+  [GTK_CSS_STAT_CACHE_HITS] = N_("Style cache hits"),
+  [GTK_CSS_STAT_LOOKUPS] = N_("Selector lookups"),
+  [GTK_CSS_STAT_MATCHED_RULES] = N_("Matched rules"),
+  [GTK_CSS_STAT_TRANSITIONS] = N_("Started transitions"),
+};
+
+static GtkWidget *
+add_row (GtkWidget  *list,
+         const char *name,
+         GtkWidget **value1,
+         GtkWidget **value2)
+{
+  GtkWidget *row, *box, *label;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 40);
+
+  label = gtk_label_new (name);
+  gtk_widget_set_hexpand (label, TRUE);
+  gtk_label_set_xalign (GTK_LABEL (label), 0.0);
+  gtk_label_set_ellipsize (GTK_LABEL (label), PANGO_ELLIPSIZE_END);
+  gtk_box_append (GTK_BOX (box), label);
+
+  *value1 = gtk_label_new (NULL);
+  gtk_label_set_width_chars (GTK_LABEL (*value1), 12);
+  gtk_label_set_xalign (GTK_LABEL (*value1), 1.0);
+  gtk_box_append (GTK_BOX (box), *value1);
+
+  if (value2)
+    {
+      *value2 = gtk_label_new (NULL);
+      gtk_label_set_width_chars (GTK_LABEL (*value2), 12);
+      gtk_label_set_xalign (GTK_LABEL (*value2), 1.0);
+      gtk_box_append (GTK_BOX (box), *value2);
+    }
+
+  row = gtk_list_box_row_new ();
+  gtk_list_box_row_set_activatable (GTK_LIST_BOX_ROW (row), FALSE);
+  gtk_list_box_row_set_child (GTK_LIST_BOX_ROW (row), box);
+  gtk_list_box_insert (GTK_LIST_BOX (list), row, -1);
+
+  return row;
+}
+
+static void
+set_count (GtkWidget *label,
+           guint      count)
+{
+  char *text;
+
+  text = g_strdup_printf ("%u", count);
+  gtk_label_set_text (GTK_LABEL (label), text);
+  g_free (text);
+}
+
+static void
+set_duration (GtkWidget *label,
+              gint64     duration)
+{
+  char *text;
+
+  text = g_strdup_printf ("%.2f ms", duration / 1000.0);
+  gtk_label_set_text (GTK_LABEL (label), text);
+  g_free (text);
+}
+
+static void
+update_selectors (GtkInspectorCssStatistics *self)
+{
+  GtkWidget *child, *value;
+  GArray *selectors;
+  guint i;
+
+  while ((child = gtk_widget_get_first_child (self->selectors)))
+    gtk_list_box_remove (GTK_LIST_BOX (self->selectors), child);
+
+  if (!gtk_css_statistics_get_record_selectors ())
+    return;
+
+  selectors = gtk_css_statistics_get_selectors (MAX_SELECTORS);
+
+  for (i = 0; i < selectors->len; i++)
+    {
+      GtkCssSelectorStatistics *stats = &g_array_index (selectors, GtkCssSelectorStatistics, i);
+
+      add_row (self->selectors, stats->selector, &value, NULL);
+      set_count (value, stats->matches);
+    }
+
+  g_array_unref (selectors);
+}
+
+static gboolean
+update_statistics (gpointer data)
+{
+  GtkInspectorCssStatistics *self = data;
+  GtkCssFrameStatistics last_frame, total;
+  guint i;
+
+  gtk_css_statistics_get_frame (&last_frame, &total);
+
+  for (i = 0; i < GTK_CSS_N_STATS; i++)
+    {
+      set_count (self->last_frame_labels[i], last_frame.counts[i]);
+      set_count (self->total_labels[i], total.counts[i]);
+    }
+
+  set_duration (self->last_frame_labels[GTK_CSS_N_STATS], last_frame.duration);
+  set_duration (self->total_labels[GTK_CSS_N_STATS], total.duration);
+
+  update_selectors (self);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+toggle_record (GtkToggleButton           *button,
+               GtkInspectorCssStatistics *self)
+{
+  if (gtk_toggle_button_get_active (button) == (self->update_source_id != 0))
+    return;
+
+  if (gtk_toggle_button_get_active (button))
+    {
+      gtk_css_statistics_set_record_selectors (TRUE);
+      gtk_label_set_text (GTK_LABEL (self->selectors_label), _("Matches by selector"));
+      self->update_source_id = g_timeout_add_seconds (1, update_statistics, self);
+    }
+  else
+    {
+      g_clear_handle_id (&self->update_source_id, g_source_remove);
+      gtk_css_statistics_set_record_selectors (FALSE);
+      gtk_label_set_text (GTK_LABEL (self->selectors_label), _("Record to count matches by selector"));
+    }
+
+  update_statistics (self);
+}
+
+static void
+gtk_inspector_css_statistics_init (GtkInspectorCssStatistics *self)
+{
+  guint i;
+
+  gtk_widget_init_template (GTK_WIDGET (self));
+
+  for (i = 0; i < GTK_CSS_N_STATS; i++)
+    add_row (self->counters, _(stat_names[i]), &self->last_frame_labels[i], &self->total_labels[i]);
+  add_row (self->counters, _("Validation time"),
+           &self->last_frame_labels[GTK_CSS_N_STATS], &self->total_labels[GTK_CSS_N_STATS]);
+
+  update_statistics (self);
+}
+
+static void
+gtk_inspector_css_statistics_constructed (GObject *object)
+{
+  GtkInspectorCssStatistics *self = GTK_INSPECTOR_CSS_STATISTICS (object);
+
+  G_OBJECT_CLASS (gtk_inspector_css_statistics_parent_class)->constructed (object);
+
+  g_signal_connect (self->button, "toggled",
+                    G_CALLBACK (toggle_record), self);
+}
+
+static void
+gtk_inspector_css_statistics_dispose (GObject *object)
+{
+  GtkInspectorCssStatistics *self = GTK_INSPECTOR_CSS_STATISTICS (object);
+
+  if (self->update_source_id)
+    {
+      g_clear_handle_id (&self->update_source_id, g_source_remove);
+      gtk_css_statistics_set_record_selectors (FALSE);
+    }
+
+  g_clear_pointer (&self->swin, gtk_widget_unparent);
+
+  G_OBJECT_CLASS (gtk_inspector_css_statistics_parent_class)->dispose (object);
+}
+
+static void
+gtk_inspector_css_statistics_get_property (GObject    *object,
+                                           guint       param_id,
+                                           GValue     *value,
+                                           GParamSpec *pspec)
+{
+  GtkInspectorCssStatistics *self = GTK_INSPECTOR_CSS_STATISTICS (object);
+
+  switch (param_id)
+    {
+    case PROP_BUTTON:
+      g_value_set_object (value, self->button);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_inspector_css_statistics_set_property (GObject      *object,
+                                           guint         param_id,
+                                           const GValue *value,
+                                           GParamSpec   *pspec)
+{
+  GtkInspectorCssStatistics *self = GTK_INSPECTOR_CSS_STATISTICS (object);
+
+  switch (param_id)
+    {
+    case PROP_BUTTON:
+      self->button = g_value_get_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_inspector_css_statistics_class_init (GtkInspectorCssStatisticsClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->constructed = gtk_inspector_css_statistics_constructed;
+  object_class->dispose = gtk_inspector_css_statistics_dispose;
+  object_class->get_property = gtk_inspector_css_statistics_get_property;
+  object_class->set_property = gtk_inspector_css_statistics_set_property;
+
+  g_object_class_install_property (object_class, PROP_BUTTON,
+      g_param_spec_object ("button", NULL, NULL,
+                           GTK_TYPE_WIDGET, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  gtk_widget_class_set_template_from_resource (widget_class, "/org/gtk/libgtk/inspector/css-statistics.ui");
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorCssStatistics, swin);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorCssStatistics, counters);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorCssStatistics, selectors_label);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorCssStatistics, selectors);
+
+  gtk_widget_class_set_layout_manager_type (widget_class, GTK_TYPE_BIN_LAYOUT);
+}
+
+// vim: set et sw=2 ts=2:
@@ -26,16 +26,48 @@
 #include "gtkwindow.h"
 #include "gtknative.h"
 
+#include "gdk/gdkframeclockprivate.h"
+
+#include <string.h>
+
 /* duration before we start fading in us */
 #define GDK_FPS_OVERLAY_LINGER_DURATION (1000 * 1000)
 /* duration when fade is finished in us */
 #define GDK_FPS_OVERLAY_FADE_DURATION (500 * 1000)
 
+/* number of frames shown in the timeline */
+#define GDK_FPS_OVERLAY_N_SAMPLES 60
+/* size of a frame in the timeline, in pixels */
+#define GDK_FPS_OVERLAY_BAR_WIDTH 3
+#define GDK_FPS_OVERLAY_CHART_HEIGHT 60
+
+typedef struct {
+  gint64 spans[GDK_FRAME_N_SPANS];
+  gint64 present_wait;
+  gint64 budget;
+} GtkFpsSample;
+
 typedef struct _GtkFpsInfo {
   gint64 last_frame;
   GskRenderNode *last_node;
+
+  gint64 last_sampled;
+  guint n_samples;
+  guint next_sample;
+  GtkFpsSample samples[GDK_FPS_OVERLAY_N_SAMPLES];
 } GtkFpsInfo;
 
+static const GdkRGBA span_colors[GDK_FRAME_N_SPANS + 1] = {
+  [GDK_FRAME_SPAN_STYLE] = { 0.45, 0.62, 0.81, 1 },
+  [GDK_FRAME_SPAN_LAYOUT] = { 0.20, 0.40, 0.64, 1 },
+  [GDK_FRAME_SPAN_SNAPSHOT] = { 0.45, 0.82, 0.09, 1 },
+  [GDK_FRAME_SPAN_DIFF] = { 0.96, 0.47, 0.00, 1 },
+  [GDK_FRAME_SPAN_RENDER] = { 0.93, 0.83, 0.00, 1 },
+  [GDK_FRAME_SPAN_SUBMIT] = { 0.80, 0.00, 0.00, 1 },
+  /* waiting for the presentation */
+  [GDK_FRAME_N_SPANS] = { 0.53, 0.54, 0.52, 1 },
+};
+
 struct _GtkFpsOverlay
 {
   GtkInspectorOverlay parent_instance;
@@ -72,6 +104,129 @@ gtk_fps_overlay_get_fps (GtkWidget *widget)
   return gdk_frame_clock_get_fps (frame_clock);
 }
 
+/* Adds the frames that finished since the last call to the timeline.
+ * Frames whose presentation is not known yet are waited for, but only
+ * for a few frames, as not all backends report it.
+ */
+static void
+gtk_fps_info_collect_samples (GtkFpsInfo    *info,
+                              GdkFrameClock *frame_clock)
+{
+  gint64 counter, frame;
+
+  counter = gdk_frame_clock_get_frame_counter (frame_clock);
+  frame = MAX (info->last_sampled + 1, gdk_frame_clock_get_history_start (frame_clock));
+
+  for (; frame < counter; frame++)
+    {
+      GdkFrameTimings *timings;
+      GtkFpsSample *sample;
+
+      timings = gdk_frame_clock_get_timings (frame_clock, frame);
+      if (timings == NULL)
+        continue;
+
+      if (!timings->complete && counter - frame < 4)
+        break;
+
+      sample = &info->samples[info->next_sample];
+      memcpy (sample->spans, timings->spans, sizeof (sample->spans));
+      if (timings->presentation_time != 0 && timings->drawn_time != 0)
+        sample->present_wait = MAX (0, timings->presentation_time - timings->drawn_time);
+      else
+        sample->present_wait = 0;
+      sample->budget = timings->refresh_interval ? timings->refresh_interval : G_USEC_PER_SEC / 60;
+
+      info->next_sample = (info->next_sample + 1) % GDK_FPS_OVERLAY_N_SAMPLES;
+      info->n_samples = MIN (info->n_samples + 1, GDK_FPS_OVERLAY_N_SAMPLES);
+      info->last_sampled = frame;
+    }
+}
+
+static gint64
+gtk_fps_info_get_worst (GtkFpsInfo *info)
+{
+  gint64 worst = 0;
+  guint i, j;
+
+  for (i = 0; i < info->n_samples; i++)
+    {
+      gint64 total = 0;
+
+      for (j = 0; j < GDK_FRAME_N_SPANS; j++)
+        total += info->samples[i].spans[j];
+
+      worst = MAX (worst, total);
+    }
+
+  return worst;
+}
+
+/* Draws the timeline of the last frames as stacked bars, one color
+ * per span. The line marks the refresh interval of the last frame, and
+ * the chart fits twice that. Frames that took longer are clipped and
+ * get a red mark on top.
+ */
+static void
+gtk_fps_info_snapshot_timeline (GtkFpsInfo  *info,
+                                GtkSnapshot *snapshot)
+{
+  const GtkFpsSample *last;
+  double scale;
+  guint i, j;
+
+  if (info->n_samples == 0)
+    return;
+
+  last = &info->samples[(info->next_sample + GDK_FPS_OVERLAY_N_SAMPLES - 1) % GDK_FPS_OVERLAY_N_SAMPLES];
+  scale = (double) GDK_FPS_OVERLAY_CHART_HEIGHT / (2 * last->budget);
+
+  gtk_snapshot_append_color (snapshot,
+                             &(GdkRGBA) { 0, 0, 0, 0.5 },
+                             &GRAPHENE_RECT_INIT (-1, -1,
+                                                  GDK_FPS_OVERLAY_N_SAMPLES * GDK_FPS_OVERLAY_BAR_WIDTH + 2,
+                                                  GDK_FPS_OVERLAY_CHART_HEIGHT + 2));
+
+  for (i = 0; i < info->n_samples; i++)
+    {
+      const GtkFpsSample *sample;
+      double x, y;
+      gint64 total = 0;
+
+      sample = &info->samples[(info->next_sample + GDK_FPS_OVERLAY_N_SAMPLES - info->n_samples + i) % GDK_FPS_OVERLAY_N_SAMPLES];
+      x = (GDK_FPS_OVERLAY_N_SAMPLES - info->n_samples + i) * GDK_FPS_OVERLAY_BAR_WIDTH;
+      y = GDK_FPS_OVERLAY_CHART_HEIGHT;
+
+      for (j = 0; j <= GDK_FRAME_N_SPANS && y > 0; j++)
+        {
+          gint64 duration = j < GDK_FRAME_N_SPANS ? sample->spans[j] : sample->present_wait;
+          double height;
+
+          if (duration == 0)
+            continue;
+
+          if (j < GDK_FRAME_N_SPANS)
+            total += duration;
+
+          height = MIN (y, duration * scale);
+          y -= height;
+          gtk_snapshot_append_color (snapshot,
+                                     &span_colors[j],
+                                     &GRAPHENE_RECT_INIT (x, y, GDK_FPS_OVERLAY_BAR_WIDTH, height));
+        }
+
+      if (total > sample->budget)
+        gtk_snapshot_append_color (snapshot,
+                                   &(GdkRGBA) { 1, 0, 0, 1 },
+                                   &GRAPHENE_RECT_INIT (x, 0, GDK_FPS_OVERLAY_BAR_WIDTH, 2));
+    }
+
+  gtk_snapshot_append_color (snapshot,
+                             &(GdkRGBA) { 1, 1, 1, 0.8 },
+                             &GRAPHENE_RECT_INIT (0, GDK_FPS_OVERLAY_CHART_HEIGHT / 2,
+                                                  GDK_FPS_OVERLAY_N_SAMPLES * GDK_FPS_OVERLAY_BAR_WIDTH, 1));
+}
+
 static gboolean
 gtk_fps_overlay_force_redraw (GtkWidget     *widget,
                               GdkFrameClock *clock,
@@ -90,23 +245,29 @@ gtk_fps_overlay_snapshot (GtkInspectorOverlay *overlay,
 {
   GtkFpsOverlay *self = GTK_FPS_OVERLAY (overlay);
   GtkFpsInfo *info;
+  GdkFrameClock *frame_clock;
   PangoLayout *layout;
   PangoAttrList *attrs;
   gint64 now;
+  gint64 worst;
   double fps;
   char *fps_string;
   graphene_rect_t bounds;
   gboolean has_bounds;
   int width, height;
+  int chart_width, overlay_width;
   double overlay_opacity;
 
-  now = gdk_frame_clock_get_frame_time (gtk_widget_get_frame_clock (widget));
+  frame_clock = gtk_widget_get_frame_clock (widget);
+  now = gdk_frame_clock_get_frame_time (frame_clock);
   info = g_hash_table_lookup (self->infos, widget);
   if (info == NULL)
     {
       info = g_slice_new0 (GtkFpsInfo);
+      info->last_sampled = gdk_frame_clock_get_frame_counter (frame_clock) - 1;
       g_hash_table_insert (self->infos, widget, info);
     }
+  gtk_fps_info_collect_samples (info, frame_clock);
   if (info->last_node != node)
     {
       g_clear_pointer (&info->last_node, gsk_render_node_unref);
@@ -133,10 +294,13 @@ gtk_fps_overlay_snapshot (GtkInspectorOverlay *overlay,
     }
 
   fps = gtk_fps_overlay_get_fps (widget);
+  worst = gtk_fps_info_get_worst (info);
   if (fps == 0.0)
     fps_string = g_strdup ("--- fps");
-  else
+  else if (worst == 0)
     fps_string = g_strdup_printf ("%.2f fps", fps);
+  else
+    fps_string = g_strdup_printf ("%.2f fps, worst %.1f ms", fps, worst / 1000.0);
 
   if (GTK_IS_WINDOW (widget))
     {
@@ -158,12 +322,21 @@ gtk_fps_overlay_snapshot (GtkInspectorOverlay *overlay,
   pango_layout_set_attributes (layout, attrs);
   pango_attr_list_unref (attrs);
   pango_layout_get_pixel_size (layout, &width, &height);
+  chart_width = GDK_FPS_OVERLAY_N_SAMPLES * GDK_FPS_OVERLAY_BAR_WIDTH;
+  overlay_width = MAX (width, chart_width);
 
   gtk_snapshot_save (snapshot);
   if (has_bounds)
-    gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (bounds.origin.x + bounds.size.width - width, bounds.origin.y));
+    gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (bounds.origin.x + bounds.size.width - overlay_width, bounds.origin.y));
   if (overlay_opacity < 1.0)
     gtk_snapshot_push_opacity (snapshot, overlay_opacity);
+
+  gtk_snapshot_save (snapshot);
+  gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (overlay_width - chart_width, height + 2));
+  gtk_fps_info_snapshot_timeline (info, snapshot);
+  gtk_snapshot_restore (snapshot);
+
+  gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (overlay_width - width, 0));
   gtk_snapshot_append_color (snapshot,
                              &(GdkRGBA) { 0, 0, 0, 0.5 },
                              &GRAPHENE_RECT_INIT (-1, -1, width + 2, height + 2));
@@ -200,6 +373,14 @@ gtk_fps_overlay_dispose (GObject *object)
   G_OBJECT_CLASS (gtk_fps_overlay_parent_class)->dispose (object);
 }
 
+static void
+gtk_fps_overlay_finalize (GObject *object)
+{
+  _gdk_frame_clock_enable_spans (FALSE);
+
+  G_OBJECT_CLASS (gtk_fps_overlay_parent_class)->finalize (object);
+}
+
 static void
 gtk_fps_overlay_class_init (GtkFpsOverlayClass *klass)
 {
@@ -210,12 +391,15 @@ gtk_fps_overlay_class_init (GtkFpsOverlayClass *klass)
   overlay_class->queue_draw = gtk_fps_overlay_queue_draw;
 
   gobject_class->dispose = gtk_fps_overlay_dispose;
+  gobject_class->finalize = gtk_fps_overlay_finalize;
 }
 
 static void
 gtk_fps_overlay_init (GtkFpsOverlay *self)
 {
   self->infos = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, gtk_fps_info_free);
+
+  _gdk_frame_clock_enable_spans (TRUE);
 }
 
 GtkInspectorOverlay *
@@ -34,6 +34,7 @@
 #include "gtkbinlayout.h"
 #include "gtkmediafileprivate.h"
 #include "gtkimmoduleprivate.h"
+#include "gtkiconthemeprivate.h"
 
 #include "gdk/gdkdebug.h"
 
@@ -562,6 +563,27 @@ translate_subpixel_layout (GdkSubpixelLayout subpixel)
     }
 }
 
+static void
+add_icon_cache_rows (GtkInspectorGeneral *gen,
+                     GtkListBox          *list)
+{
+  GtkIconTheme *icon_theme;
+  guint n_icons, n_evictions;
+  gsize n_bytes;
+  char *value;
+
+  icon_theme = gtk_icon_theme_get_for_display (gen->display);
+  gtk_icon_theme_get_cache_statistics (icon_theme, &n_icons, &n_bytes, &n_evictions);
+
+  value = g_strdup_printf ("%u icons, %.1f MB", n_icons, n_bytes / (1024.0 * 1024.0));
+  add_label_row (gen, list, "Icon cache", value, 0);
+  g_free (value);
+
+  value = g_strdup_printf ("%u", n_evictions);
+  add_label_row (gen, list, "Evictions", value, 10);
+  g_free (value);
+}
+
 static void
 populate_display (GdkDisplay *display, GtkInspectorGeneral *gen)
 {
@@ -597,6 +619,8 @@ populate_display (GdkDisplay *display, GtkInspectorGeneral *gen)
                           gdk_display_is_rgba (display));
   gtk_widget_set_visible (gen->display_composited,
                           gdk_display_is_composited (display));
+
+  add_icon_cache_rows (gen, list);
 }
 
 static void
@@ -1059,6 +1083,18 @@ gtk_inspector_general_constructed (GObject *object)
    g_signal_connect (gen->device_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
 }
 
+static void
+gtk_inspector_general_map (GtkWidget *widget)
+{
+  GtkInspectorGeneral *gen = GTK_INSPECTOR_GENERAL (widget);
+
+  GTK_WIDGET_CLASS (gtk_inspector_general_parent_class)->map (widget);
+
+  /* The icon cache numbers change all the time */
+  if (gen->display)
+    populate_display (gen->display, gen);
+}
+
 static void
 gtk_inspector_general_dispose (GObject *object)
 {
@@ -1089,6 +1125,8 @@ gtk_inspector_general_class_init (GtkInspectorGeneralClass *klass)
   object_class->constructed = gtk_inspector_general_constructed;
   object_class->dispose = gtk_inspector_general_dispose;
 
+  widget_class->map = gtk_inspector_general_map;
+
   gtk_widget_class_set_template_from_resource (widget_class, "/org/gtk/libgtk/inspector/general.ui");
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorGeneral, swin);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorGeneral, box);
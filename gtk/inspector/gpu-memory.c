@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <glib/gi18n-lib.h>
+
+#include "gpu-memory.h"
+
+#include "gtkbinlayout.h"
+#include "gtkbox.h"
+#include "gtklabel.h"
+#include "gtklistbox.h"
+#include "gtknative.h"
+#include "gtkwindow.h"
+#include "gskrendererprivate.h"
+
+struct _GtkInspectorGpuMemory
+{
+  GtkWidget parent;
+
+  GtkWidget *swin;
+  GtkWidget *usage;
+  GtkWidget *renderer_label;
+
+  GdkDisplay *display;
+
+  /* name -> number of evictions at the last update */
+  GHashTable *evictions;
+  gint64 last_update;
+
+  guint update_source_id;
+};
+
+typedef struct _GtkInspectorGpuMemoryClass
+{
+  GtkWidgetClass parent_class;
+} GtkInspectorGpuMemoryClass;
+
+G_DEFINE_TYPE (GtkInspectorGpuMemory, gtk_inspector_gpu_memory, GTK_TYPE_WIDGET)
+
+static void
+add_label (GtkWidget  *box,
+           const char *text,
+           gboolean    expand)
+{
+  GtkWidget *label;
+
+  label = gtk_label_new (text);
+  if (expand)
+    {
+      gtk_widget_set_hexpand (label, TRUE);
+      gtk_label_set_xalign (GTK_LABEL (label), 0.0);
+      gtk_label_set_ellipsize (GTK_LABEL (label), PANGO_ELLIPSIZE_END);
+    }
+  else
+    {
+      gtk_label_set_width_chars (GTK_LABEL (label), 12);
+      gtk_label_set_xalign (GTK_LABEL (label), 1.0);
+    }
+  gtk_box_append (GTK_BOX (box), label);
+}
+
+static void
+add_row (GtkWidget  *list,
+         const char *name,
+         gsize       bytes,
+         guint       n_items,
+         double      evictions_per_second)
+{
+  GtkWidget *row, *box;
+  char *text;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 40);
+
+  add_label (box, name, TRUE);
+
+  text = g_format_size (bytes);
+  add_label (box, text, FALSE);
+  g_free (text);
+
+  text = g_strdup_printf ("%u", n_items);
+  add_label (box, text, FALSE);
+  g_free (text);
+
+  if (evictions_per_second >= 0)
+    text = g_strdup_printf ("%.1f", evictions_per_second);
+  else
+    text = g_strdup ("");
+  add_label (box, text, FALSE);
+  g_free (text);
+
+  row = gtk_list_box_row_new ();
+  gtk_list_box_row_set_activatable (GTK_LIST_BOX_ROW (row), FALSE);
+  gtk_list_box_row_set_child (GTK_LIST_BOX_ROW (row), box);
+  gtk_list_box_insert (GTK_LIST_BOX (list), row, -1);
+}
+
+/* The GL renderer shares its caches between all surfaces of a
+ * display, so asking one renderer is enough. Renderers that
+ * can't tell return nothing, so we keep looking.
+ */
+static GArray *
+get_memory_usage (GtkInspectorGpuMemory  *self,
+                  GskRenderer           **out_renderer)
+{
+  GList *toplevels, *l;
+  GArray *usage = NULL;
+
+  *out_renderer = NULL;
+
+  if (self->display == NULL)
+    return NULL;
+
+  toplevels = gtk_window_list_toplevels ();
+  for (l = toplevels; l; l = l->next)
+    {
+      GtkWidget *toplevel = l->data;
+      GskRenderer *renderer;
+
+      if (gtk_root_get_display (GTK_ROOT (toplevel)) != self->display)
+        continue;
+
+      renderer = gtk_native_get_renderer (GTK_NATIVE (toplevel));
+      if (renderer == NULL)
+        continue;
+
+      *out_renderer = renderer;
+      usage = gsk_renderer_get_memory_usage (renderer);
+      if (usage->len > 0)
+        break;
+
+      g_clear_pointer (&usage, g_array_unref);
+    }
+  g_list_free (toplevels);
+
+  return usage;
+}
+
+static gboolean
+update_usage (gpointer data)
+{
+  GtkInspectorGpuMemory *self = data;
+  GtkWidget *child;
+  GskRenderer *renderer;
+  GArray *usage;
+  gint64 now;
+  double elapsed;
+  gsize total_bytes = 0;
+  guint total_items = 0;
+  guint i;
+
+  while ((child = gtk_widget_get_first_child (self->usage)))
+    gtk_list_box_remove (GTK_LIST_BOX (self->usage), child);
+
+  usage = get_memory_usage (self, &renderer);
+  if (usage == NULL)
+    {
+      if (renderer)
+        gtk_label_set_text (GTK_LABEL (self->renderer_label),
+                            _("The renderer does not report its memory usage"));
+      else
+        gtk_label_set_text (GTK_LABEL (self->renderer_label), _("No renderer"));
+      g_hash_table_remove_all (self->evictions);
+      return G_SOURCE_CONTINUE;
+    }
+
+  gtk_label_set_text (GTK_LABEL (self->renderer_label), G_OBJECT_TYPE_NAME (renderer));
+
+  now = g_get_monotonic_time ();
+  elapsed = (now - self->last_update) / (double) G_USEC_PER_SEC;
+
+  for (i = 0; i < usage->len; i++)
+    {
+      const GskRendererMemoryUsage *u = &g_array_index (usage, GskRendererMemoryUsage, i);
+      gpointer last;
+      double rate = -1;
+
+      if (g_hash_table_lookup_extended (self->evictions, u->name, NULL, &last) && elapsed > 0)
+        rate = (u->n_evictions - *(guint64 *) last) / elapsed;
+
+      g_hash_table_insert (self->evictions, g_strdup (u->name), g_memdup2 (&u->n_evictions, sizeof (guint64)));
+
+      add_row (self->usage, u->name, u->bytes, u->n_items, rate);
+
+      total_bytes += u->bytes;
+      total_items += u->n_items;
+    }
+
+  add_row (self->usage, _("Total"), total_bytes, total_items, -1);
+
+  self->last_update = now;
+  g_array_unref (usage);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+gtk_inspector_gpu_memory_map (GtkWidget *widget)
+{
+  GtkInspectorGpuMemory *self = GTK_INSPECTOR_GPU_MEMORY (widget);
+
+  GTK_WIDGET_CLASS (gtk_inspector_gpu_memory_parent_class)->map (widget);
+
+  /* Only spend time on this while someone is looking */
+  update_usage (self);
+  self->update_source_id = g_timeout_add_seconds (1, update_usage, self);
+}
+
+static void
+gtk_inspector_gpu_memory_unmap (GtkWidget *widget)
+{
+  GtkInspectorGpuMemory *self = GTK_INSPECTOR_GPU_MEMORY (widget);
+
+  g_clear_handle_id (&self->update_source_id, g_source_remove);
+  g_hash_table_remove_all (self->evictions);
+
+  GTK_WIDGET_CLASS (gtk_inspector_gpu_memory_parent_class)->unmap (widget);
+}
+
+static void
+gtk_inspector_gpu_memory_init (GtkInspectorGpuMemory *self)
+{
+  gtk_widget_init_template (GTK_WIDGET (self));
+
+  self->evictions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+}
+
+static void
+gtk_inspector_gpu_memory_dispose (GObject *object)
+{
+  GtkInspectorGpuMemory *self = GTK_INSPECTOR_GPU_MEMORY (object);
+
+  g_clear_handle_id (&self->update_source_id, g_source_remove);
+  g_clear_pointer (&self->evictions, g_hash_table_unref);
+  g_clear_pointer (&self->swin, gtk_widget_unparent);
+
+  G_OBJECT_CLASS (gtk_inspector_gpu_memory_parent_class)->dispose (object);
+}
+
+static void
+gtk_inspector_gpu_memory_class_init (GtkInspectorGpuMemoryClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->dispose = gtk_inspector_gpu_memory_dispose;
+
+  widget_class->map = gtk_inspector_gpu_memory_map;
+  widget_class->unmap = gtk_inspector_gpu_memory_unmap;
+
+  gtk_widget_class_set_template_from_resource (widget_class, "/org/gtk/libgtk/inspector/gpu-memory.ui");
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorGpuMemory, swin);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorGpuMemory, usage);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorGpuMemory, renderer_label);
+
+  gtk_widget_class_set_layout_manager_type (widget_class, GTK_TYPE_BIN_LAYOUT);
+}
+
+void
+gtk_inspector_gpu_memory_set_display (GtkInspectorGpuMemory *self,
+                                      GdkDisplay            *display)
+{
+  self->display = display;
+}
+
+// vim: set et sw=2 ts=2:
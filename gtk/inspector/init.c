@@ -31,7 +31,9 @@
 #include "controllers.h"
 #include "css-editor.h"
 #include "css-node-tree.h"
+#include "css-statistics.h"
 #include "general.h"
+#include "gpu-memory.h"
 #include "graphdata.h"
 #include "list-data.h"
 #include "logs.h"
@@ -74,7 +76,9 @@ gtk_inspector_init (void)
   g_type_ensure (GTK_TYPE_INSPECTOR_CONTROLLERS);
   g_type_ensure (GTK_TYPE_INSPECTOR_CSS_EDITOR);
   g_type_ensure (GTK_TYPE_INSPECTOR_CSS_NODE_TREE);
+  g_type_ensure (GTK_TYPE_INSPECTOR_CSS_STATISTICS);
   g_type_ensure (GTK_TYPE_INSPECTOR_GENERAL);
+  g_type_ensure (GTK_TYPE_INSPECTOR_GPU_MEMORY);
   g_type_ensure (GTK_TYPE_INSPECTOR_LIST_DATA);
   g_type_ensure (GTK_TYPE_INSPECTOR_LOGS);
   g_type_ensure (GTK_TYPE_MAGNIFIER);
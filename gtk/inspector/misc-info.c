@@ -80,6 +80,12 @@ struct _GtkInspectorMiscInfo
   GtkWidget *framerate;
   GtkWidget *framecount_row;
   GtkWidget *framecount;
+  GtkWidget *frame_times_row;
+  GtkWidget *frame_times;
+  GtkWidget *input_latency_row;
+  GtkWidget *input_latency;
+  GtkWidget *missed_frames_row;
+  GtkWidget *missed_frames;
   GtkWidget *mapped_row;
   GtkWidget *mapped;
   GtkWidget *realized_row;
@@ -306,6 +312,60 @@ update_frame_clock (GtkInspectorMiscInfo *sl)
     }
 }
 
+static void
+update_frame_statistics (GtkInspectorMiscInfo *sl)
+{
+  GdkSurface *surface = NULL;
+  GdkFrameStatistics *stats;
+  char *tmp;
+
+  if (GTK_IS_NATIVE (sl->object))
+    surface = gtk_native_get_surface (GTK_NATIVE (sl->object));
+
+  if (surface == NULL)
+    {
+      gtk_widget_hide (sl->frame_times_row);
+      gtk_widget_hide (sl->input_latency_row);
+      gtk_widget_hide (sl->missed_frames_row);
+      return;
+    }
+
+  gtk_widget_show (sl->frame_times_row);
+  gtk_widget_show (sl->input_latency_row);
+  gtk_widget_show (sl->missed_frames_row);
+
+  /* This starts collecting the first time a surface is shown */
+  stats = gdk_surface_get_frame_statistics (surface);
+
+  if (gdk_frame_statistics_get_n_frames (stats) > 0)
+    {
+      tmp = g_strdup_printf ("%.1f ms (p50) ⁄ %.1f ms (p99)",
+                             gdk_frame_statistics_get_frame_time_percentile (stats, 0.5) / 1000.,
+                             gdk_frame_statistics_get_frame_time_percentile (stats, 0.99) / 1000.);
+      gtk_label_set_label (GTK_LABEL (sl->frame_times), tmp);
+      g_free (tmp);
+
+      tmp = g_strdup_printf ("%.1f ms (p50) ⁄ %.1f ms (p99)",
+                             gdk_frame_statistics_get_latency_percentile (stats, 0.5) / 1000.,
+                             gdk_frame_statistics_get_latency_percentile (stats, 0.99) / 1000.);
+      gtk_label_set_label (GTK_LABEL (sl->input_latency), tmp);
+      g_free (tmp);
+
+      tmp = g_strdup_printf ("%u of %u, jitter %.2f ms",
+                             gdk_frame_statistics_get_n_missed_frames (stats),
+                             gdk_frame_statistics_get_n_frames (stats),
+                             gdk_frame_statistics_get_jitter (stats) / 1000.);
+      gtk_label_set_label (GTK_LABEL (sl->missed_frames), tmp);
+      g_free (tmp);
+    }
+  else
+    {
+      gtk_label_set_label (GTK_LABEL (sl->frame_times), "—");
+      gtk_label_set_label (GTK_LABEL (sl->input_latency), "—");
+      gtk_label_set_label (GTK_LABEL (sl->missed_frames), "—");
+    }
+}
+
 static void
 update_direction (GtkInspectorMiscInfo *sl)
 {
@@ -385,6 +445,7 @@ update_info (gpointer data)
   update_surface (sl);
   update_renderer (sl);
   update_frame_clock (sl);
+  update_frame_statistics (sl);
 
   if (GTK_IS_BUILDABLE (sl->object))
     {
@@ -651,6 +712,12 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framecount);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framerate_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framerate);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, frame_times_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, frame_times);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, input_latency_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, input_latency);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, missed_frames_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, missed_frames);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, mapped_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, mapped);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, realized_row);
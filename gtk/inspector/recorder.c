@@ -41,11 +41,13 @@
 #include <gtk/gtktreeview.h>
 #include <gtk/gtkstack.h>
 #include <gsk/gskrendererprivate.h>
+#include <gsk/gskrendernodeparserprivate.h>
 #include <gsk/gskrendernodeprivate.h>
 #include <gsk/gskroundedrectprivate.h>
 #include <gsk/gsktransformprivate.h>
 
 #include <glib/gi18n-lib.h>
+#include <gdk/gdkframeclockprivate.h>
 #include <gdk/gdktextureprivate.h>
 #include "gtk/gtkdebug.h"
 #include "gtk/gtkbuiltiniconprivate.h"
@@ -82,12 +84,33 @@ struct _GtkInspectorRecorder
   GtkInspectorRecording *recording; /* start recording if recording or NULL if not */
   gint64 start_time;
 
+  /* Recorded frames are written to a temporary file, so long
+   * recordings don't keep all their nodes in memory.
+   */
+  GFile *stream_file;
+  GskRenderNodeWriter *stream_writer;
+  GFileIOStream *stream_io;
+  gboolean stream_failed;
+  GskRenderNodeReader *stream_reader;
+  GskRenderNode *loaded_node;
+
   gboolean debug_nodes;
   gboolean highlight_sequences;
+  gboolean capture_slow_frames;
+
+  /* frames that get added if they turn out slow */
+  GQueue slow_frame_candidates;
 
   GdkEventSequence *selected_sequence;
 };
 
+typedef struct
+{
+  GdkFrameClock *frame_clock;
+  gint64 frame_counter;
+  GtkInspectorRecording *recording;
+} SlowFrameCandidate;
+
 typedef struct _GtkInspectorRecorderClass
 {
   GtkWidgetClass parent;
@@ -100,6 +123,7 @@ enum
   PROP_RECORDING,
   PROP_DEBUG_NODES,
   PROP_HIGHLIGHT_SEQUENCES,
+  PROP_CAPTURE_SLOW_FRAMES,
   PROP_SELECTED_SEQUENCE,
   LAST_PROP
 };
@@ -244,11 +268,132 @@ create_list_model_for_render_node_paintable (gpointer paintable,
   return create_list_model_for_render_node (node);
 }
 
+static void
+gtk_inspector_recorder_clear_stream (GtkInspectorRecorder *recorder)
+{
+  g_clear_pointer (&recorder->loaded_node, gsk_render_node_unref);
+  g_clear_pointer (&recorder->stream_reader, gsk_render_node_reader_unref);
+  g_clear_pointer (&recorder->stream_writer, gsk_render_node_writer_free);
+  g_clear_object (&recorder->stream_io);
+
+  if (recorder->stream_file)
+    {
+      g_file_delete (recorder->stream_file, NULL, NULL);
+      g_clear_object (&recorder->stream_file);
+    }
+
+  recorder->stream_failed = FALSE;
+}
+
 static void
 recordings_clear_all (GtkButton            *button,
                       GtkInspectorRecorder *recorder)
 {
   g_list_store_remove_all (G_LIST_STORE (recorder->recordings));
+  gtk_inspector_recorder_clear_stream (recorder);
+}
+
+/* Returns a borrowed reference, that is valid until the
+ * next call, or NULL if the node could not be loaded.
+ */
+static GskRenderNode *
+get_recording_node (GtkInspectorRecorder        *recorder,
+                    GtkInspectorRenderRecording *recording)
+{
+  GskRenderNode *node;
+  guint32 offset;
+  GError *error = NULL;
+
+  node = gtk_inspector_render_recording_get_node (recording);
+  if (node)
+    return node;
+
+  g_clear_pointer (&recorder->loaded_node, gsk_render_node_unref);
+
+  if (recorder->stream_file == NULL)
+    return NULL;
+
+  offset = gtk_inspector_render_recording_get_stream_offset (recording);
+
+  /* The file grows while recording, so map it again if the frame
+   * was written after the last time
+   */
+  if (recorder->stream_reader == NULL ||
+      offset >= gsk_render_node_reader_get_size (recorder->stream_reader))
+    {
+      GMappedFile *mapped;
+      GBytes *bytes;
+      char *path;
+
+      g_clear_pointer (&recorder->stream_reader, gsk_render_node_reader_unref);
+
+      path = g_file_get_path (recorder->stream_file);
+      mapped = g_mapped_file_new (path, FALSE, &error);
+      g_free (path);
+      if (mapped == NULL)
+        {
+          g_warning ("Failed to load recorded frame: %s", error->message);
+          g_error_free (error);
+          return NULL;
+        }
+
+      bytes = g_mapped_file_get_bytes (mapped);
+      g_mapped_file_unref (mapped);
+
+      recorder->stream_reader = gsk_render_node_reader_new (bytes, &error);
+      g_bytes_unref (bytes);
+      if (recorder->stream_reader == NULL)
+        {
+          g_warning ("Failed to load recorded frame: %s", error->message);
+          g_error_free (error);
+          return NULL;
+        }
+    }
+
+  recorder->loaded_node = gsk_render_node_reader_load (recorder->stream_reader, offset, &error);
+  if (recorder->loaded_node == NULL)
+    {
+      g_warning ("Failed to load recorded frame: %s", error->message);
+      g_error_free (error);
+    }
+
+  return recorder->loaded_node;
+}
+
+/* Writes @node to the stream, and returns its offset there,
+ * or 0 if the node has to be kept in memory.
+ */
+static guint32
+gtk_inspector_recorder_write_node (GtkInspectorRecorder *recorder,
+                                   GskRenderNode        *node)
+{
+  GError *error = NULL;
+  guint32 offset;
+
+  if (recorder->stream_failed)
+    return 0;
+
+  if (recorder->stream_writer == NULL)
+    {
+      recorder->stream_file = g_file_new_tmp ("gtk-inspector-XXXXXX.gsks", &recorder->stream_io, &error);
+      if (recorder->stream_file == NULL)
+        goto fail;
+
+      recorder->stream_writer = gsk_render_node_writer_new (g_io_stream_get_output_stream (G_IO_STREAM (recorder->stream_io)));
+    }
+
+  offset = gsk_render_node_writer_add_frame (recorder->stream_writer, node, &error);
+  if (offset == 0)
+    goto fail;
+
+  return offset;
+
+fail:
+  g_warning ("Failed to write recording, keeping it in memory: %s", error->message);
+  g_error_free (error);
+  recorder->stream_failed = TRUE;
+
+  return 0;
 }
 
 static const char *
@@ -528,8 +673,11 @@ recording_selected (GtkSingleSelection   *selection,
 
       gtk_stack_set_visible_child_name (GTK_STACK (recorder->recording_data_stack), "frame_data");
 
-      node = gtk_inspector_render_recording_get_node (GTK_INSPECTOR_RENDER_RECORDING (recording));
-      show_render_node (recorder, node);
+      node = get_recording_node (recorder, GTK_INSPECTOR_RENDER_RECORDING (recording));
+      if (node)
+        show_render_node (recorder, node);
+      else
+        gtk_stack_set_visible_child_name (GTK_STACK (recorder->recording_data_stack), "no_data");
     }
   else if (GTK_INSPECTOR_IS_EVENT_RECORDING (recording))
     {
@@ -548,8 +696,9 @@ recording_selected (GtkSingleSelection   *selection,
             {
               GskRenderNode *node;
 
-              node = gtk_inspector_render_recording_get_node (GTK_INSPECTOR_RENDER_RECORDING (item));
-              show_event (recorder, node, event);
+              node = get_recording_node (recorder, GTK_INSPECTOR_RENDER_RECORDING (item));
+              if (node)
+                show_event (recorder, node, event);
               break;
             }
         }
@@ -1655,9 +1804,15 @@ render_node_save_response (GtkWidget     *dialog,
 
   if (response == GTK_RESPONSE_ACCEPT)
     {
-      GBytes *bytes = gsk_render_node_serialize (node);
+      const char *format = gtk_file_chooser_get_choice (GTK_FILE_CHOOSER (dialog), "format");
+      GBytes *bytes;
       GError *error = NULL;
 
+      if (g_strcmp0 (format, "binary") == 0)
+        bytes = gsk_render_node_serialize_binary (node);
+      else
+        bytes = gsk_render_node_serialize (node);
+
       if (!g_file_replace_contents (gtk_file_chooser_get_file (GTK_FILE_CHOOSER (dialog)),
                                     g_bytes_get_data (bytes, NULL),
                                     g_bytes_get_size (bytes),
@@ -1711,6 +1866,10 @@ render_node_save (GtkButton            *button,
   g_free (nodename);
   gtk_file_chooser_set_current_name (GTK_FILE_CHOOSER (dialog), filename);
   g_free (filename);
+  gtk_file_chooser_add_choice (GTK_FILE_CHOOSER (dialog), "format", _("Format"),
+                               (const char *[]) { "text", "binary", NULL },
+                               (const char *[]) { _("Text"), _("Binary"), NULL });
+  gtk_file_chooser_set_choice (GTK_FILE_CHOOSER (dialog), "format", "text");
   gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_ACCEPT);
   gtk_window_set_modal (GTK_WINDOW (dialog), TRUE);
   g_signal_connect (dialog, "response", G_CALLBACK (render_node_save_response), node);
@@ -1873,6 +2032,8 @@ bind_widget_for_recording (GtkListItemFactory *factory,
   label = gtk_widget_get_first_child (box);
   label2 = gtk_widget_get_next_sibling (label);
 
+  gtk_widget_set_tooltip_text (row, NULL);
+
   g_object_set (row, "sequence", NULL, NULL);
   g_object_bind_property (recorder, "selected-sequence", row, "match-sequence", G_BINDING_SYNC_CREATE);
 
@@ -1880,7 +2041,16 @@ bind_widget_for_recording (GtkListItemFactory *factory,
 
   if (GTK_INSPECTOR_IS_RENDER_RECORDING (recording))
     {
-      gtk_label_set_label (GTK_LABEL (label), "Frame");
+      const char *timings_info;
+
+      timings_info = gtk_inspector_render_recording_get_timings_info (GTK_INSPECTOR_RENDER_RECORDING (recording));
+      if (timings_info)
+        {
+          gtk_label_set_label (GTK_LABEL (label), "Slow Frame");
+          gtk_widget_set_tooltip_text (row, timings_info);
+        }
+      else
+        gtk_label_set_label (GTK_LABEL (label), "Frame");
       gtk_label_set_use_markup (GTK_LABEL (label), FALSE);
 
       text = g_strdup_printf ("%.3f", gtk_inspector_recording_get_timestamp (recording) / 1000.0);
@@ -1972,6 +2142,10 @@ gtk_inspector_recorder_get_property (GObject    *object,
       g_value_set_boolean (value, recorder->highlight_sequences);
       break;
 
+    case PROP_CAPTURE_SLOW_FRAMES:
+      g_value_set_boolean (value, recorder->capture_slow_frames);
+      break;
+
     case PROP_SELECTED_SEQUENCE:
       g_value_set_pointer (value, recorder->selected_sequence);
       break;
@@ -2004,6 +2178,10 @@ gtk_inspector_recorder_set_property (GObject      *object,
       gtk_inspector_recorder_set_highlight_sequences (recorder, g_value_get_boolean (value));
       break;
 
+    case PROP_CAPTURE_SLOW_FRAMES:
+      gtk_inspector_recorder_set_capture_slow_frames (recorder, g_value_get_boolean (value));
+      break;
+
     case PROP_SELECTED_SEQUENCE:
       recorder->selected_sequence = g_value_get_pointer (value);
       break;
@@ -2024,6 +2202,9 @@ gtk_inspector_recorder_dispose (GObject *object)
   g_clear_object (&recorder->render_node_root_model);
   g_clear_object (&recorder->render_node_selection);
 
+  gtk_inspector_recorder_set_capture_slow_frames (recorder, FALSE);
+  gtk_inspector_recorder_clear_stream (recorder);
+
   G_OBJECT_CLASS (gtk_inspector_recorder_parent_class)->dispose (object);
 }
 
@@ -2051,6 +2232,7 @@ gtk_inspector_recorder_class_init (GtkInspectorRecorderClass *klass)
                           G_PARAM_READWRITE);
 
   props[PROP_HIGHLIGHT_SEQUENCES] = g_param_spec_boolean ("highlight-sequences", "", "", FALSE, G_PARAM_READWRITE);
+  props[PROP_CAPTURE_SLOW_FRAMES] = g_param_spec_boolean ("capture-slow-frames", "", "", FALSE, G_PARAM_READWRITE);
   props[PROP_SELECTED_SEQUENCE] = g_param_spec_pointer ("selected-sequence", "", "", G_PARAM_READWRITE);
 
   g_object_class_install_properties (object_class, LAST_PROP, props);
@@ -2153,6 +2335,89 @@ gtk_inspector_recorder_is_recording (GtkInspectorRecorder *recorder)
   return recorder->recording != NULL;
 }
 
+static void
+slow_frame_candidate_free (gpointer data)
+{
+  SlowFrameCandidate *candidate = data;
+
+  g_object_unref (candidate->frame_clock);
+  g_object_unref (candidate->recording);
+
+  g_slice_free (SlowFrameCandidate, candidate);
+}
+
+/* A frame is slow if the work for it did not fit into a refresh
+ * interval. We can only tell once the frame is done, so the render
+ * of each frame is kept until the next frame of its frame clock.
+ */
+static char *
+get_slow_frame_info (GdkFrameTimings *timings)
+{
+  GString *string;
+  gint64 budget, busy;
+  int i;
+
+  budget = timings->refresh_interval ? timings->refresh_interval : G_USEC_PER_SEC / 60;
+  busy = _gdk_frame_timings_get_busy_time (timings);
+  if (busy <= budget)
+    return NULL;
+
+  string = g_string_new (NULL);
+  g_string_append_printf (string, "%.1f ms of %.1f ms", busy / 1000.0, budget / 1000.0);
+  for (i = 0; i < GDK_FRAME_N_SPANS; i++)
+    g_string_append_printf (string, "\n%s: %.1f ms",
+                            _gdk_frame_span_get_name (i),
+                            timings->spans[i] / 1000.0);
+
+  return g_string_free (string, FALSE);
+}
+
+static void
+gtk_inspector_recorder_check_slow_frames (GtkInspectorRecorder *recorder)
+{
+  GList *l, *next;
+
+  for (l = recorder->slow_frame_candidates.head; l; l = next)
+    {
+      SlowFrameCandidate *candidate = l->data;
+      GdkFrameTimings *timings;
+      char *info;
+
+      next = l->next;
+
+      if (candidate->frame_counter >= gdk_frame_clock_get_frame_counter (candidate->frame_clock))
+        continue;
+
+      timings = gdk_frame_clock_get_timings (candidate->frame_clock, candidate->frame_counter);
+      info = timings ? get_slow_frame_info (timings) : NULL;
+      if (info)
+        {
+          gtk_inspector_render_recording_set_timings_info (GTK_INSPECTOR_RENDER_RECORDING (candidate->recording), info);
+          gtk_inspector_recorder_add_recording (recorder, candidate->recording);
+          g_free (info);
+        }
+
+      g_queue_delete_link (&recorder->slow_frame_candidates, l);
+      slow_frame_candidate_free (candidate);
+    }
+}
+
+void
+gtk_inspector_recorder_set_capture_slow_frames (GtkInspectorRecorder *recorder,
+                                                gboolean              capture)
+{
+  if (recorder->capture_slow_frames == capture)
+    return;
+
+  recorder->capture_slow_frames = capture;
+
+  _gdk_frame_clock_enable_spans (capture);
+  if (!capture)
+    g_queue_clear_full (&recorder->slow_frame_candidates, slow_frame_candidate_free);
+
+  g_object_notify_by_pspec (G_OBJECT (recorder), props[PROP_CAPTURE_SLOW_FRAMES]);
+}
+
 void
 gtk_inspector_recorder_record_render (GtkInspectorRecorder *recorder,
                                       GtkWidget            *widget,
@@ -2165,7 +2430,11 @@ gtk_inspector_recorder_record_render (GtkInspectorRecorder *recorder,
   GdkFrameClock *frame_clock;
   gint64 frame_time;
 
-  if (!gtk_inspector_recorder_is_recording (recorder))
+  if (recorder->capture_slow_frames)
+    gtk_inspector_recorder_check_slow_frames (recorder);
+
+  if (!gtk_inspector_recorder_is_recording (recorder) &&
+      !recorder->capture_slow_frames)
     return;
 
   frame_clock = gtk_widget_get_frame_clock (widget);
@@ -2181,15 +2450,45 @@ gtk_inspector_recorder_record_render (GtkInspectorRecorder *recorder,
       frame_time = frame_time - recorder->start_time;
     }
 
-  recording = gtk_inspector_render_recording_new (frame_time,
-                                                  gsk_renderer_get_profiler (renderer),
-                                                  &(GdkRectangle) { 0, 0,
-                                                    gdk_surface_get_width (surface),
-                                                    gdk_surface_get_height (surface) },
-                                                  region,
-                                                  node);
-  gtk_inspector_recorder_add_recording (recorder, recording);
-  g_object_unref (recording);
+  if (gtk_inspector_recorder_is_recording (recorder))
+    {
+      GdkRectangle area = { 0, 0, gdk_surface_get_width (surface), gdk_surface_get_height (surface) };
+      guint32 offset;
+
+      offset = gtk_inspector_recorder_write_node (recorder, node);
+      if (offset != 0)
+        recording = gtk_inspector_render_recording_new_for_stream (frame_time,
+                                                                   gsk_renderer_get_profiler (renderer),
+                                                                   &area,
+                                                                   region,
+                                                                   offset);
+      else
+        recording = gtk_inspector_render_recording_new (frame_time,
+                                                        gsk_renderer_get_profiler (renderer),
+                                                        &area,
+                                                        region,
+                                                        node);
+      gtk_inspector_recorder_add_recording (recorder, recording);
+      g_object_unref (recording);
+    }
+  else
+    {
+      SlowFrameCandidate *candidate;
+
+      recording = gtk_inspector_render_recording_new (frame_time,
+                                                      gsk_renderer_get_profiler (renderer),
+                                                      &(GdkRectangle) { 0, 0,
+                                                        gdk_surface_get_width (surface),
+                                                        gdk_surface_get_height (surface) },
+                                                      region,
+                                                      node);
+
+      candidate = g_slice_new (SlowFrameCandidate);
+      candidate->frame_clock = g_object_ref (frame_clock);
+      candidate->frame_counter = gdk_frame_clock_get_frame_counter (frame_clock);
+      candidate->recording = recording;
+      g_queue_push_tail (&recorder->slow_frame_candidates, candidate);
+    }
 }
 
 void
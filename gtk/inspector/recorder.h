@@ -40,6 +40,9 @@ void            gtk_inspector_recorder_set_debug_nodes          (GtkInspectorRec
 void            gtk_inspector_recorder_set_highlight_sequences  (GtkInspectorRecorder   *recorder,
                                                                  gboolean                highlight_sequences);
 
+void            gtk_inspector_recorder_set_capture_slow_frames  (GtkInspectorRecorder   *recorder,
+                                                                 gboolean                capture);
+
 void            gtk_inspector_recorder_set_selected_sequence    (GtkInspectorRecorder   *recorder,
                                                                  GdkEventSequence       *sequence);
 
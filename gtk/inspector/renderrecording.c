@@ -30,6 +30,7 @@ gtk_inspector_render_recording_finalize (GObject *object)
   g_clear_pointer (&recording->clip_region, cairo_region_destroy);
   g_clear_pointer (&recording->node, gsk_render_node_unref);
   g_clear_pointer (&recording->profiler_info, g_free);
+  g_clear_pointer (&recording->timings_info, g_free);
 
   G_OBJECT_CLASS (gtk_inspector_render_recording_parent_class)->finalize (object);
 }
@@ -80,12 +81,43 @@ gtk_inspector_render_recording_new (gint64                timestamp,
   return GTK_INSPECTOR_RECORDING (recording);
 }
 
+/* The node of the recording is written to a stream by the recorder,
+ * which loads it back when it is needed.
+ */
+GtkInspectorRecording *
+gtk_inspector_render_recording_new_for_stream (gint64                timestamp,
+                                               GskProfiler          *profiler,
+                                               const GdkRectangle   *area,
+                                               const cairo_region_t *clip_region,
+                                               guint32               stream_offset)
+{
+  GtkInspectorRenderRecording *recording;
+
+  recording = g_object_new (GTK_TYPE_INSPECTOR_RENDER_RECORDING,
+                            "timestamp", timestamp,
+                            NULL);
+
+  collect_profiler_info (recording, profiler);
+  recording->area = *area;
+  recording->clip_region = cairo_region_copy (clip_region);
+  recording->stream_offset = stream_offset;
+
+  return GTK_INSPECTOR_RECORDING (recording);
+}
+
+/* Returns NULL for recordings that are in the recorder's stream */
 GskRenderNode *
 gtk_inspector_render_recording_get_node (GtkInspectorRenderRecording *recording)
 {
   return recording->node;
 }
 
+guint32
+gtk_inspector_render_recording_get_stream_offset (GtkInspectorRenderRecording *recording)
+{
+  return recording->stream_offset;
+}
+
 const cairo_region_t *
 gtk_inspector_render_recording_get_clip_region (GtkInspectorRenderRecording *recording)
 {
@@ -104,4 +136,18 @@ gtk_inspector_render_recording_get_profiler_info (GtkInspectorRenderRecording *r
   return recording->profiler_info;
 }
 
+void
+gtk_inspector_render_recording_set_timings_info (GtkInspectorRenderRecording *recording,
+                                                 const char                  *info)
+{
+  g_free (recording->timings_info);
+  recording->timings_info = g_strdup (info);
+}
+
+const char *
+gtk_inspector_render_recording_get_timings_info (GtkInspectorRenderRecording *recording)
+{
+  return recording->timings_info;
+}
+
 // vim: set et sw=2 ts=2:
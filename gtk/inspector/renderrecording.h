@@ -43,7 +43,9 @@ typedef struct _GtkInspectorRenderRecording
   GdkRectangle area;
   cairo_region_t *clip_region;
   GskRenderNode *node;
+  guint32 stream_offset;
   char *profiler_info;
+  char *timings_info;
 } GtkInspectorRenderRecording;
 
 typedef struct _GtkInspectorRenderRecordingClass
@@ -59,14 +61,27 @@ GtkInspectorRecording *
                                                               const GdkRectangle                *area,
                                                               const cairo_region_t              *clip_region,
                                                               GskRenderNode                     *node);
+GtkInspectorRecording *
+                gtk_inspector_render_recording_new_for_stream (gint64                            timestamp,
+                                                              GskProfiler                       *profiler,
+                                                              const GdkRectangle                *area,
+                                                              const cairo_region_t              *clip_region,
+                                                              guint32                            stream_offset);
 
 GskRenderNode * gtk_inspector_render_recording_get_node      (GtkInspectorRenderRecording       *recording);
+guint32         gtk_inspector_render_recording_get_stream_offset
+                                                             (GtkInspectorRenderRecording       *recording);
 const cairo_region_t *
                 gtk_inspector_render_recording_get_clip_region (GtkInspectorRenderRecording     *recording);
 const cairo_rectangle_int_t *
                 gtk_inspector_render_recording_get_area      (GtkInspectorRenderRecording       *recording);
 const char *    gtk_inspector_render_recording_get_profiler_info
                                                              (GtkInspectorRenderRecording       *recording);
+void            gtk_inspector_render_recording_set_timings_info
+                                                             (GtkInspectorRenderRecording       *recording,
+                                                              const char                        *info);
+const char *    gtk_inspector_render_recording_get_timings_info
+                                                             (GtkInspectorRenderRecording       *recording);
 
 
 G_END_DECLS
@@ -48,6 +48,7 @@
 #include "visual.h"
 #include "general.h"
 #include "logs.h"
+#include "gpu-memory.h"
 
 #include "gdkdebug.h"
 #include "gdkmarshalers.h"
@@ -301,6 +302,7 @@ gtk_inspector_window_constructed (GObject *object)
   gtk_inspector_general_set_display (GTK_INSPECTOR_GENERAL (iw->general), iw->inspected_display);
   gtk_inspector_clipboard_set_display (GTK_INSPECTOR_CLIPBOARD (iw->clipboard), iw->inspected_display);
   gtk_inspector_logs_set_display (GTK_INSPECTOR_LOGS (iw->logs), iw->inspected_display);
+  gtk_inspector_gpu_memory_set_display (GTK_INSPECTOR_GPU_MEMORY (iw->gpu_memory), iw->inspected_display);
   gtk_inspector_css_node_tree_set_display (GTK_INSPECTOR_CSS_NODE_TREE (iw->widget_css_node_tree), iw->inspected_display);
 }
 
@@ -656,6 +658,7 @@ gtk_inspector_window_class_init (GtkInspectorWindowClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, general);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, clipboard);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, logs);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, gpu_memory);
 
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, go_up_button);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorWindow, go_down_button);
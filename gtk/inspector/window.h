@@ -79,6 +79,7 @@ typedef struct
   GtkWidget *clipboard;
   GtkWidget *general;
   GtkWidget *logs;
+  GtkWidget *gpu_memory;
 
   GtkWidget *go_up_button;
   GtkWidget *go_down_button;
@@ -327,6 +327,26 @@ gtk_gst_media_file_realize (GtkMediaStream *stream,
   GtkGstMediaFile *self = GTK_GST_MEDIA_FILE (stream);
 
   gtk_gst_paintable_realize (GTK_GST_PAINTABLE (self->paintable), surface);
+
+  /* The file was opened before we had a GL context, so the sink
+   * copies every frame through memory. Start over with a GL sink,
+   * and continue where we were.
+   */
+  if (self->player != NULL &&
+      gtk_media_stream_get_error (stream) == NULL &&
+      gtk_gst_paintable_wants_gl_sink (GTK_GST_PAINTABLE (self->paintable)))
+    {
+      gint64 timestamp = gtk_media_stream_get_timestamp (stream);
+      gboolean playing = gtk_media_stream_get_playing (stream);
+
+      gtk_gst_media_file_destroy_player (self);
+      gtk_gst_media_file_open (GTK_MEDIA_FILE (self));
+
+      if (timestamp > 0)
+        gst_player_seek (self->player, TO_GST_TIME (timestamp));
+      if (playing)
+        gst_player_play (self->player);
+    }
 }
 
 static void
@@ -27,6 +27,16 @@
 
 #include <math.h>
 
+/* How many decoded frames we keep around waiting for their
+ * presentation time */
+#define MAX_QUEUED_FRAMES 3
+
+typedef struct {
+  GdkTexture *texture;
+  double pixel_aspect_ratio;
+  gint64 presentation_time;
+} QueuedFrame;
+
 struct _GtkGstPaintable
 {
   GObject parent_instance;
@@ -35,6 +45,15 @@ struct _GtkGstPaintable
   double pixel_aspect_ratio;
 
   GdkGLContext *context;
+  /* Set from the player thread when it created a sink that
+   * maps frames into memory, atomic */
+  int has_memory_sink;
+  guint gl_failed : 1;
+
+  /* Frames waiting for the frame clock, see
+   * gtk_gst_paintable_queue_set_texture() */
+  GQueue frames;
+  GdkFrameClock *frame_clock;
 };
 
 struct _GtkGstPaintableClass
@@ -133,13 +152,18 @@ gtk_gst_paintable_video_renderer_create_video_sink (GstPlayerVideoRenderer *rend
       g_object_set (glsinkbin, "sink", sink, NULL);
       g_object_unref (ctx);
 
+      g_atomic_int_set (&self->has_memory_sink, FALSE);
+
       return glsinkbin;
     }
   else
     {
+      g_atomic_int_set (&self->has_memory_sink, TRUE);
+
       if (self->context != NULL)
         {
           g_warning ("GstGL context creation failed, falling back to non-GL playback");
+          self->gl_failed = TRUE;
 
           g_object_unref (sink);
           sink = g_object_new (GTK_TYPE_GST_SINK,
@@ -163,11 +187,25 @@ G_DEFINE_TYPE_WITH_CODE (GtkGstPaintable, gtk_gst_paintable, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (GST_TYPE_PLAYER_VIDEO_RENDERER,
                                                 gtk_gst_paintable_video_renderer_init));
 
+static void queued_frame_free               (QueuedFrame     *frame);
+static void gtk_gst_paintable_update        (GdkFrameClock   *frame_clock,
+                                             GtkGstPaintable *self);
+static void gtk_gst_paintable_set_paintable (GtkGstPaintable *self,
+                                             GdkPaintable    *paintable,
+                                             double           pixel_aspect_ratio);
+
 static void
 gtk_gst_paintable_dispose (GObject *object)
 {
   GtkGstPaintable *self = GTK_GST_PAINTABLE (object);
-  
+
+  if (self->frame_clock)
+    {
+      g_signal_handlers_disconnect_by_func (self->frame_clock, gtk_gst_paintable_update, self);
+      g_clear_object (&self->frame_clock);
+    }
+  g_queue_clear_full (&self->frames, (GDestroyNotify) queued_frame_free);
+
   g_clear_object (&self->image);
 
   G_OBJECT_CLASS (gtk_gst_paintable_parent_class)->dispose (object);
@@ -198,6 +236,13 @@ gtk_gst_paintable_realize (GtkGstPaintable *self,
 {
   GError *error = NULL;
 
+  if (self->frame_clock == NULL)
+    {
+      self->frame_clock = g_object_ref (gdk_surface_get_frame_clock (surface));
+      g_signal_connect (self->frame_clock, "update",
+                        G_CALLBACK (gtk_gst_paintable_update), self);
+    }
+
   if (self->context)
     return;
 
@@ -218,6 +263,23 @@ gtk_gst_paintable_realize (GtkGstPaintable *self,
     }
 }
 
+/*
+ * gtk_gst_paintable_wants_gl_sink:
+ * @self: a `GtkGstPaintable`
+ *
+ * Returns whether a sink was created without GL, but GL would
+ * work now, because the paintable got realized since. In that
+ * case every frame goes through system memory and creating a
+ * new sink is worth it.
+ */
+gboolean
+gtk_gst_paintable_wants_gl_sink (GtkGstPaintable *self)
+{
+  return self->context != NULL &&
+         !self->gl_failed &&
+         g_atomic_int_get (&self->has_memory_sink);
+}
+
 void
 gtk_gst_paintable_unrealize (GtkGstPaintable *self,
                              GdkSurface      *surface)
@@ -226,6 +288,25 @@ gtk_gst_paintable_unrealize (GtkGstPaintable *self,
    * - track how often we were realized with that surface
    * - track alternate surfaces
    */
+  if (self->frame_clock == gdk_surface_get_frame_clock (surface))
+    {
+      QueuedFrame *frame;
+
+      g_signal_handlers_disconnect_by_func (self->frame_clock, gtk_gst_paintable_update, self);
+      g_clear_object (&self->frame_clock);
+
+      /* Without a frame clock, frames are shown right away */
+      frame = g_queue_pop_tail (&self->frames);
+      if (frame)
+        {
+          gtk_gst_paintable_set_paintable (self,
+                                           GDK_PAINTABLE (frame->texture),
+                                           frame->pixel_aspect_ratio);
+          queued_frame_free (frame);
+        }
+      g_queue_clear_full (&self->frames, (GDestroyNotify) queued_frame_free);
+    }
+
   if (self->context == NULL)
     return;
 
@@ -261,12 +342,95 @@ gtk_gst_paintable_set_paintable (GtkGstPaintable *self,
   gdk_paintable_invalidate_contents (GDK_PAINTABLE (self));
 }
 
+static void
+queued_frame_free (QueuedFrame *frame)
+{
+  g_object_unref (frame->texture);
+  g_slice_free (QueuedFrame, frame);
+}
+
+static void
+gtk_gst_paintable_update (GdkFrameClock   *frame_clock,
+                          GtkGstPaintable *self)
+{
+  GdkFrameTimings *timings;
+  QueuedFrame *frame, *next;
+  gint64 presentation_time = 0;
+
+  timings = gdk_frame_clock_get_current_timings (frame_clock);
+  if (timings)
+    presentation_time = gdk_frame_timings_get_predicted_presentation_time (timings);
+  if (presentation_time == 0)
+    presentation_time = gdk_frame_clock_get_frame_time (frame_clock);
+
+  /* Pick the last frame that is due when this frame will be on
+   * screen. Frames before it are late and never get shown.
+   */
+  frame = NULL;
+  while ((next = g_queue_peek_head (&self->frames)) &&
+         next->presentation_time <= presentation_time)
+    {
+      if (frame)
+        {
+          GST_DEBUG ("dropping late frame, %" G_GINT64_FORMAT " us late",
+                     presentation_time - frame->presentation_time);
+          queued_frame_free (frame);
+        }
+      frame = g_queue_pop_head (&self->frames);
+    }
+
+  if (frame)
+    {
+      gtk_gst_paintable_set_paintable (self,
+                                       GDK_PAINTABLE (frame->texture),
+                                       frame->pixel_aspect_ratio);
+      queued_frame_free (frame);
+    }
+
+  if (!g_queue_is_empty (&self->frames))
+    gdk_frame_clock_request_phase (frame_clock, GDK_FRAME_CLOCK_PHASE_UPDATE);
+}
+
+static void
+gtk_gst_paintable_queue_frame (GtkGstPaintable *self,
+                               GdkTexture      *texture,
+                               double           pixel_aspect_ratio,
+                               gint64           presentation_time)
+{
+  QueuedFrame *frame, *last;
+
+  if (self->frame_clock == NULL || presentation_time == 0)
+    {
+      g_queue_clear_full (&self->frames, (GDestroyNotify) queued_frame_free);
+      gtk_gst_paintable_set_paintable (self, GDK_PAINTABLE (texture), pixel_aspect_ratio);
+      return;
+    }
+
+  /* Time went backwards, probably a seek. Forget the old frames. */
+  last = g_queue_peek_tail (&self->frames);
+  if (last && last->presentation_time > presentation_time)
+    g_queue_clear_full (&self->frames, (GDestroyNotify) queued_frame_free);
+
+  frame = g_slice_new (QueuedFrame);
+  frame->texture = g_object_ref (texture);
+  frame->pixel_aspect_ratio = pixel_aspect_ratio;
+  frame->presentation_time = presentation_time;
+  g_queue_push_tail (&self->frames, frame);
+
+  /* Nobody is painting us, don't hold on to frames forever */
+  while (self->frames.length > MAX_QUEUED_FRAMES)
+    queued_frame_free (g_queue_pop_head (&self->frames));
+
+  gdk_frame_clock_request_phase (self->frame_clock, GDK_FRAME_CLOCK_PHASE_UPDATE);
+}
+
 typedef struct _SetTextureInvocation SetTextureInvocation;
 
 struct _SetTextureInvocation {
   GtkGstPaintable *paintable;
   GdkTexture      *texture;
   double           pixel_aspect_ratio;
+  gint64           presentation_time;
 };
 
 static void
@@ -283,17 +447,31 @@ gtk_gst_paintable_set_texture_invoke (gpointer data)
 {
   SetTextureInvocation *invoke = data;
 
-  gtk_gst_paintable_set_paintable (invoke->paintable,
-                                   GDK_PAINTABLE (invoke->texture),
-                                   invoke->pixel_aspect_ratio);
+  gtk_gst_paintable_queue_frame (invoke->paintable,
+                                 invoke->texture,
+                                 invoke->pixel_aspect_ratio,
+                                 invoke->presentation_time);
 
   return G_SOURCE_REMOVE;
 }
 
+/*
+ * gtk_gst_paintable_queue_set_texture:
+ * @self: a `GtkGstPaintable`
+ * @texture: the decoded frame
+ * @pixel_aspect_ratio: the pixel aspect ratio of @texture
+ * @presentation_time: when @texture should be on screen, in
+ *   g_get_monotonic_time() units, or 0 to show it as soon as possible
+ *
+ * Called from the streaming thread. Once realized, frames are
+ * queued and shown on the first frame the frame clock predicts
+ * to be presented at or after @presentation_time.
+ */
 void
 gtk_gst_paintable_queue_set_texture (GtkGstPaintable *self,
                                      GdkTexture      *texture,
-                                     double           pixel_aspect_ratio)
+                                     double           pixel_aspect_ratio,
+                                     gint64           presentation_time)
 {
   SetTextureInvocation *invoke;
 
@@ -301,6 +479,7 @@ gtk_gst_paintable_queue_set_texture (GtkGstPaintable *self,
   invoke->paintable = g_object_ref (self);
   invoke->texture = g_object_ref (texture);
   invoke->pixel_aspect_ratio = pixel_aspect_ratio;
+  invoke->presentation_time = presentation_time;
 
   g_main_context_invoke_full (NULL,
                               G_PRIORITY_DEFAULT,
@@ -34,9 +34,11 @@ void            gtk_gst_paintable_realize               (GtkGstPaintable
                                                          GdkSurface             *surface);
 void            gtk_gst_paintable_unrealize             (GtkGstPaintable        *self,
                                                          GdkSurface             *surface);
+gboolean        gtk_gst_paintable_wants_gl_sink         (GtkGstPaintable        *self);
 void            gtk_gst_paintable_queue_set_texture     (GtkGstPaintable        *self,
                                                          GdkTexture             *texture,
-                                                         double                  pixel_aspect_ratio);
+                                                         double                  pixel_aspect_ratio,
+                                                         gint64                  presentation_time);
 
 G_END_DECLS
 
@@ -65,6 +65,10 @@ GST_DEBUG_CATEGORY (gtk_debug_gst_sink);
 
 #define NOGL_CAPS GST_VIDEO_CAPS_MAKE (FORMATS)
 
+/* How much earlier than their presentation time frames are handed
+ * to the paintable, see gtk_gst_paintable_queue_set_texture() */
+#define PRESENT_AHEAD (20 * GST_MSECOND)
+
 static GstStaticPadTemplate gtk_gst_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -286,11 +290,17 @@ gtk_gst_sink_texture_from_buffer (GtkGstSink *self,
     {
       GstGLSyncMeta *sync_meta;
 
+      /* Waiting in our own context would not order anything against
+       * the GDK context that draws the texture, and GDK can't wait on
+       * the fence itself. So make sure the frame is complete before
+       * handing it over; this only blocks the streaming thread.
+       */
       sync_meta = gst_buffer_get_gl_sync_meta (buffer);
-      if (sync_meta) {
-        gst_gl_sync_meta_set_sync_point (sync_meta, self->gst_context);
-        gst_gl_sync_meta_wait (sync_meta, self->gst_context);
-      }
+      if (sync_meta)
+        {
+          gst_gl_sync_meta_set_sync_point (sync_meta, self->gst_context);
+          gst_gl_sync_meta_wait_cpu (sync_meta, self->gst_context);
+        }
 
       texture = gdk_gl_texture_new (self->gdk_context,
                                     *(guint *) frame->data[0],
@@ -328,6 +338,45 @@ gtk_gst_sink_texture_from_buffer (GtkGstSink *self,
   return texture;
 }
 
+/* Translates the time the buffer should be displayed at into
+ * g_get_monotonic_time() units, so the paintable can match it
+ * against the frame clock. Returns 0 if that is not known.
+ */
+static gint64
+gtk_gst_sink_get_presentation_time (GtkGstSink *self,
+                                    GstBuffer  *buf)
+{
+  GstBaseSink *bsink = GST_BASE_SINK (self);
+  GstClockTime running_time, target;
+  GstClock *clock;
+  gint64 result;
+
+  /* Prerolled frames while paused should show up right away */
+  if (GST_STATE (self) != GST_STATE_PLAYING ||
+      !GST_BUFFER_PTS_IS_VALID (buf))
+    return 0;
+
+  running_time = gst_segment_to_running_time (&bsink->segment, GST_FORMAT_TIME,
+                                              GST_BUFFER_PTS (buf));
+  if (!GST_CLOCK_TIME_IS_VALID (running_time))
+    return 0;
+
+  clock = gst_element_get_clock (GST_ELEMENT (self));
+  if (clock == NULL)
+    return 0;
+
+  target = running_time +
+           gst_element_get_base_time (GST_ELEMENT (self)) +
+           gst_base_sink_get_latency (bsink);
+
+  result = g_get_monotonic_time () +
+           GST_CLOCK_DIFF (gst_clock_get_time (clock), target) / GST_USECOND;
+
+  gst_object_unref (clock);
+
+  return MAX (result, 1);
+}
+
 static GstFlowReturn
 gtk_gst_sink_show_frame (GstVideoSink *vsink,
                          GstBuffer    *buf)
@@ -335,17 +384,22 @@ gtk_gst_sink_show_frame (GstVideoSink *vsink,
   GtkGstSink *self;
   GdkTexture *texture;
   double pixel_aspect_ratio;
+  gint64 presentation_time;
 
   GST_TRACE ("rendering buffer:%p", buf);
 
   self = GTK_GST_SINK (vsink);
 
+  /* This takes the object lock */
+  presentation_time = gtk_gst_sink_get_presentation_time (self, buf);
+
   GST_OBJECT_LOCK (self);
 
   texture = gtk_gst_sink_texture_from_buffer (self, buf, &pixel_aspect_ratio);
   if (texture)
     {
-      gtk_gst_paintable_queue_set_texture (self->paintable, texture, pixel_aspect_ratio);
+      gtk_gst_paintable_queue_set_texture (self->paintable, texture,
+                                           pixel_aspect_ratio, presentation_time);
       g_object_unref (texture);
     }
 
@@ -716,5 +770,8 @@ gtk_gst_sink_class_init (GtkGstSinkClass * klass)
 static void
 gtk_gst_sink_init (GtkGstSink * gtk_sink)
 {
+  /* Deliver frames a bit early, so the paintable can queue them
+   * and show them in the frame they are meant for. */
+  gst_base_sink_set_ts_offset (GST_BASE_SINK (gtk_sink), - (GstClockTimeDiff) PRESENT_AHEAD);
 }
 
@@ -24,6 +24,8 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 #include <time.h>
+#include <fcntl.h>
+#include <utime.h>
 
 /* Cups 1.6 deprecates ppdFindAttr(), ppdFindCustomOption(),
  * ppdFirstCustomParam(), and ppdNextCustomParam() among others.
@@ -161,6 +163,10 @@ struct _GtkPrintBackendCups
 
   GList *temporary_queues_in_construction;
   GList *temporary_queues_removed;
+
+  /* kept open across printer list polls */
+  http_t  *list_http;
+  gboolean list_http_failed;
 };
 
 static GObjectClass *backend_parent_class;
@@ -950,6 +956,8 @@ gtk_print_backend_cups_finalize (GObject *object)
   g_list_free_full (backend_cups->temporary_queues_removed, g_free);
   backend_cups->temporary_queues_removed = NULL;
 
+  g_clear_pointer (&backend_cups->list_http, httpClose);
+
   backend_parent_class->finalize (object);
 }
 
@@ -1946,7 +1954,8 @@ static const char * const printer_attrs[] =
     "copies-supported",
     "number-up-supported",
     "device-uri",
-    "printer-is-temporary"
+    "printer-is-temporary",
+    "printer-config-change-time"
   };
 
 /* Attributes we're interested in for printers without PPD */
@@ -2044,6 +2053,7 @@ typedef struct
   GList    *output_bin_supported;
   char     *original_device_uri;
   gboolean  is_temporary;
+  int       config_change_time;
 } PrinterSetupInfo;
 
 static void
@@ -2436,6 +2446,10 @@ cups_printer_handle_attribute (GtkPrintBackendCups *cups_backend,
       else
         info->is_temporary = FALSE;
     }
+  else if (strcmp (ippGetName (attr), "printer-config-change-time") == 0)
+    {
+      info->config_change_time = ippGetInteger (attr, 0);
+    }
   else
     {
       GTK_NOTE (PRINTING,
@@ -3703,6 +3717,11 @@ cups_request_printer_list_cb (GtkPrintBackendCups *cups_backend,
           cups_backend->list_printers_attempts = 0;
         }
 
+      /* The request is still using the connection; drop it before
+       * the next poll.
+       */
+      cups_backend->list_http_failed = TRUE;
+
       goto done;
     }
 
@@ -3834,6 +3853,7 @@ cups_request_printer_list_cb (GtkPrintBackendCups *cups_backend,
       g_clear_pointer (&(GTK_PRINTER_CUPS (printer)->covers), g_strfreev);
       GTK_PRINTER_CUPS (printer)->covers = g_strdupv (info->covers);
       GTK_PRINTER_CUPS (printer)->is_temporary = info->is_temporary;
+      GTK_PRINTER_CUPS (printer)->config_change_time = info->config_change_time;
       status_changed = gtk_printer_set_job_count (printer, info->job_count);
       status_changed |= gtk_printer_set_location (printer, info->location);
       status_changed |= gtk_printer_set_description (printer,
@@ -3939,7 +3959,26 @@ cups_request_printer_list (GtkPrintBackendCups *cups_backend)
 
   cups_backend->list_printers_pending = TRUE;
 
-  request = gtk_cups_request_new_with_username (NULL,
+  /* The list is polled several times a second while a print dialog
+   * is open; don't set up a new connection to the server every time.
+   */
+  if (cups_backend->list_http_failed)
+    {
+      g_clear_pointer (&cups_backend->list_http, httpClose);
+      cups_backend->list_http_failed = FALSE;
+    }
+
+  if (cups_backend->list_http == NULL)
+    {
+      cups_backend->list_http = httpConnect2 (cupsServer (), ippPort (),
+                                              NULL, AF_UNSPEC,
+                                              cupsEncryption (),
+                                              1, 30000, NULL);
+      if (cups_backend->list_http)
+        httpBlocking (cups_backend->list_http, 0);
+    }
+
+  request = gtk_cups_request_new_with_username (cups_backend->list_http,
                                                 GTK_CUPS_POST,
                                                 CUPS_GET_PRINTERS,
                                                 NULL,
@@ -3988,6 +4027,135 @@ typedef struct {
   http_t *http;
 } GetPPDData;
 
+/* PPDs of CUPS queues are cached in the user cache directory, with
+ * the printer-config-change-time of the queue as modification time,
+ * so they only get downloaded again when the queue was reconfigured.
+ */
+static char *
+get_ppd_cache_filename (GtkPrinterCups *cups_printer)
+{
+  char *key, *checksum, *basename, *filename;
+
+  if (cups_printer->config_change_time <= 0 ||
+      cups_printer->avahi_browsed ||
+      cups_printer->is_temporary ||
+      cups_printer->request_original_uri)
+    return NULL;
+
+  key = g_strdup_printf ("%s:%d/%s",
+                         cups_printer->hostname ? cups_printer->hostname : cupsServer (),
+                         cups_printer->port,
+                         gtk_printer_cups_get_ppd_name (cups_printer));
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+  basename = g_strconcat (checksum, ".ppd", NULL);
+  filename = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "cups", basename, NULL);
+
+  g_free (basename);
+  g_free (checksum);
+  g_free (key);
+
+  return filename;
+}
+
+static void
+save_cached_ppd (GtkPrinterCups *cups_printer,
+                 GIOChannel     *ppd_io)
+{
+  char *filename, *dirname;
+  char *contents = NULL;
+  gsize length;
+  GStatBuf buf;
+  struct utimbuf times;
+
+  filename = get_ppd_cache_filename (cups_printer);
+  if (filename == NULL)
+    return;
+
+  g_io_channel_seek_position (ppd_io, 0, G_SEEK_SET, NULL);
+  if (g_io_channel_read_to_end (ppd_io, &contents, &length, NULL) != G_IO_STATUS_NORMAL ||
+      length == 0)
+    goto out;
+
+  dirname = g_path_get_dirname (filename);
+  g_mkdir_with_parents (dirname, 0700);
+  g_free (dirname);
+
+  if (!g_file_set_contents (filename, contents, length, NULL))
+    goto out;
+
+  if (g_stat (filename, &buf) == 0)
+    {
+      times.actime = buf.st_atime;
+      times.modtime = cups_printer->config_change_time;
+      g_utime (filename, &times);
+    }
+
+out:
+  g_free (contents);
+  g_free (filename);
+}
+
+static gboolean
+cached_ppd_loaded (gpointer user_data)
+{
+  GtkPrinter *printer = user_data;
+
+  gtk_printer_set_has_details (printer, TRUE);
+  g_signal_emit_by_name (printer, "details-acquired", TRUE);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+load_cached_ppd (GtkPrinterCups *cups_printer)
+{
+  char *filename;
+  GStatBuf buf;
+  int fd;
+
+  filename = get_ppd_cache_filename (cups_printer);
+  if (filename == NULL)
+    return FALSE;
+
+  if (g_stat (filename, &buf) != 0 ||
+      buf.st_mtime != cups_printer->config_change_time ||
+      buf.st_size == 0)
+    {
+      g_free (filename);
+      return FALSE;
+    }
+
+  fd = g_open (filename, O_RDONLY, 0);
+  g_free (filename);
+  if (fd < 0)
+    return FALSE;
+
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+
+  /* ppdOpenFd takes over the ownership of the open file */
+  cups_printer->ppd_file = ppdOpenFd (fd);
+
+  if (cups_printer->ppd_file == NULL)
+    return FALSE;
+
+  ppdLocalize (cups_printer->ppd_file);
+  ppdMarkDefaults (cups_printer->ppd_file);
+
+  G_GNUC_END_IGNORE_DEPRECATIONS
+
+  GTK_NOTE (PRINTING,
+            g_print ("CUPS Backend: Using cached PPD for %s\n",
+                     gtk_printer_get_name (GTK_PRINTER (cups_printer))));
+
+  /* Callers connect to ::details-acquired after requesting details */
+  g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+                   cached_ppd_loaded,
+                   g_object_ref (cups_printer),
+                   g_object_unref);
+
+  return TRUE;
+}
+
 static void
 get_ppd_data_free (GetPPDData *data)
 {
@@ -4016,6 +4184,9 @@ cups_request_ppd_cb (GtkPrintBackendCups *print_backend,
 
   if (!gtk_cups_result_is_error (result))
     {
+      if (!data->printer->avahi_browsed)
+        save_cached_ppd (data->printer, data->ppd_io);
+
       G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 
       /* let ppdOpenFd take over the ownership of the open file */
@@ -4530,6 +4701,9 @@ cups_printer_request_details (GtkPrinter *printer)
   else if (!cups_printer->reading_ppd &&
            gtk_printer_cups_get_ppd (cups_printer) == NULL)
     {
+      if (load_cached_ppd (cups_printer))
+        return;
+
       if (cups_printer->remote && !cups_printer->avahi_browsed)
         {
           if (cups_printer->get_remote_ppd_poll == 0)
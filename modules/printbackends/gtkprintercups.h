@@ -61,6 +61,7 @@ struct _GtkPrinterCups
   gchar *temporary_queue_device_uri; /* Device uri of temporary queue for this printer */
 
   ipp_pstate_t state;
+  int config_change_time;            /* printer-config-change-time, 0 if unknown */
   gboolean reading_ppd;
   char       *ppd_name;
   ppd_file_t *ppd_file;
@@ -11,6 +11,7 @@ typedef struct FrameStats FrameStats;
 struct FrameStats
 {
   GdkFrameClock *frame_clock;
+  GdkFrameStatistics *statistics;
 
   int num_stats;
   double last_print_time;
@@ -85,7 +86,7 @@ on_frame_clock_after_paint (GdkFrameClock *frame_clock,
         {
           if (frame_stats->num_stats == 0 && machine_readable)
             {
-              g_print ("# load_factor frame_rate latency\n");
+              g_print ("# load_factor frame_rate latency frame_time_p50 frame_time_p99 missed_frames\n");
             }
 
           frame_stats->num_stats++;
@@ -95,6 +96,17 @@ on_frame_clock_after_paint (GdkFrameClock *frame_clock,
 
           print_variable ("Latency", &frame_stats->latency);
 
+          if (frame_stats->statistics)
+            {
+              print_double ("Frame time p50",
+                            gdk_frame_statistics_get_frame_time_percentile (frame_stats->statistics, 0.5) / 1000.);
+              print_double ("Frame time p99",
+                            gdk_frame_statistics_get_frame_time_percentile (frame_stats->statistics, 0.99) / 1000.);
+              print_double ("Missed frames",
+                            gdk_frame_statistics_get_n_missed_frames (frame_stats->statistics));
+              gdk_frame_statistics_reset (frame_stats->statistics);
+            }
+
           g_print ("\n");
         }
 
@@ -135,6 +147,7 @@ on_window_realize (GtkWidget  *window,
                    FrameStats *frame_stats)
 {
   frame_stats->frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (window));
+  frame_stats->statistics = gdk_surface_get_frame_statistics (gtk_native_get_surface (GTK_NATIVE (window)));
   g_signal_connect (frame_stats->frame_clock, "after-paint",
                     G_CALLBACK (on_frame_clock_after_paint), frame_stats);
 }
@@ -147,6 +160,7 @@ on_window_unrealize (GtkWidget  *window,
                                         (gpointer) on_frame_clock_after_paint,
                                         frame_stats);
   frame_stats->frame_clock = NULL;
+  frame_stats->statistics = NULL;
 }
 
 static void
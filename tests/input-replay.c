@@ -0,0 +1,963 @@
+/* Replays input events into a test window at their original timing
+ * and reports input latency and missed frames, so that different
+ * GTK versions can be compared on identical input.
+ *
+ * Each scenario has a built-in synthetic event sequence. Use
+ * --record FILE to record real events sent to the window of a
+ * scenario, and --replay FILE to replay them instead.
+ *
+ * The file format has one event per line: the time in milliseconds,
+ * the event type and its arguments, e.g.
+ *
+ *   0 motion 120.5 80
+ *   8 press 1 120.5 80
+ *   24 scroll 0 1.5
+ *   40 scroll-stop
+ *   56 key-press a
+ *
+ * Positions are in surface coordinates.
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdk/gdkdisplayprivate.h"
+#include "gdk/gdkeventsprivate.h"
+
+static char *scenario_name = NULL;
+static char *record_file = NULL;
+static char *replay_file = NULL;
+static int runs = 3;
+
+static GOptionEntry options[] = {
+  { "scenario", 's', 0, G_OPTION_ARG_STRING, &scenario_name, "Only run this scenario: list, text or drag", "NAME" },
+  { "record", 0, 0, G_OPTION_ARG_FILENAME, &record_file, "Record the events of the scenario to FILE", "FILE" },
+  { "replay", 0, 0, G_OPTION_ARG_FILENAME, &replay_file, "Replay the events in FILE", "FILE" },
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Replay the events N times", "N" },
+  { NULL }
+};
+
+typedef enum {
+  REPLAY_MOTION,
+  REPLAY_PRESS,
+  REPLAY_RELEASE,
+  REPLAY_SCROLL,
+  REPLAY_SCROLL_STOP,
+  REPLAY_KEY_PRESS,
+  REPLAY_KEY_RELEASE,
+} ReplayEventType;
+
+static const char *event_type_names[] = {
+  [REPLAY_MOTION] = "motion",
+  [REPLAY_PRESS] = "press",
+  [REPLAY_RELEASE] = "release",
+  [REPLAY_SCROLL] = "scroll",
+  [REPLAY_SCROLL_STOP] = "scroll-stop",
+  [REPLAY_KEY_PRESS] = "key-press",
+  [REPLAY_KEY_RELEASE] = "key-release",
+};
+
+typedef struct {
+  gint64 time; /* in ms */
+  ReplayEventType type;
+  double x, y; /* the position, or the deltas for scroll events */
+  guint value; /* the button or keyval */
+} ReplayEvent;
+
+/* {{{ Event files */
+
+static gboolean
+parse_line (const char   *line,
+            ReplayEvent  *event,
+            GError      **error)
+{
+  char **tokens;
+  guint n_tokens, n_args, i;
+  gboolean result = FALSE;
+
+  tokens = g_strsplit_set (line, " \t", -1);
+  n_tokens = g_strv_length (tokens);
+  if (n_tokens < 2)
+    goto out;
+
+  memset (event, 0, sizeof (ReplayEvent));
+  event->time = g_ascii_strtoll (tokens[0], NULL, 10);
+
+  for (i = 0; i < G_N_ELEMENTS (event_type_names); i++)
+    {
+      if (strcmp (tokens[1], event_type_names[i]) == 0)
+        break;
+    }
+  if (i == G_N_ELEMENTS (event_type_names))
+    goto out;
+
+  event->type = i;
+  n_args = n_tokens - 2;
+
+  switch (event->type)
+    {
+    case REPLAY_MOTION:
+    case REPLAY_SCROLL:
+      if (n_args != 2)
+        goto out;
+      event->x = g_ascii_strtod (tokens[2], NULL);
+      event->y = g_ascii_strtod (tokens[3], NULL);
+      break;
+
+    case REPLAY_PRESS:
+    case REPLAY_RELEASE:
+      if (n_args != 3)
+        goto out;
+      event->value = g_ascii_strtoull (tokens[2], NULL, 10);
+      event->x = g_ascii_strtod (tokens[3], NULL);
+      event->y = g_ascii_strtod (tokens[4], NULL);
+      break;
+
+    case REPLAY_SCROLL_STOP:
+      if (n_args != 0)
+        goto out;
+      break;
+
+    case REPLAY_KEY_PRESS:
+    case REPLAY_KEY_RELEASE:
+      if (n_args != 1)
+        goto out;
+      event->value = gdk_keyval_from_name (tokens[2]);
+      if (event->value == GDK_KEY_VoidSymbol)
+        goto out;
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  result = TRUE;
+
+out:
+  if (!result)
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "Invalid event “%s”", line);
+
+  g_strfreev (tokens);
+
+  return result;
+}
+
+static GArray *
+load_events (const char  *filename,
+             GError     **error)
+{
+  GArray *events;
+  char *contents;
+  char **lines;
+  guint i;
+
+  if (!g_file_get_contents (filename, &contents, NULL, error))
+    return NULL;
+
+  events = g_array_new (FALSE, FALSE, sizeof (ReplayEvent));
+
+  lines = g_strsplit (contents, "\n", -1);
+  for (i = 0; lines[i]; i++)
+    {
+      char *line = g_strstrip (lines[i]);
+      ReplayEvent event;
+
+      if (line[0] == '\0' || line[0] == '#')
+        continue;
+
+      if (!parse_line (line, &event, error))
+        {
+          g_prefix_error (error, "%s:%u: ", filename, i + 1);
+          g_clear_pointer (&events, g_array_unref);
+          break;
+        }
+
+      g_array_append_val (events, event);
+    }
+
+  g_strfreev (lines);
+  g_free (contents);
+
+  return events;
+}
+
+static gboolean
+save_events (GArray      *events,
+             const char  *filename,
+             GError     **error)
+{
+  GString *string;
+  gboolean result;
+  char x[G_ASCII_DTOSTR_BUF_SIZE], y[G_ASCII_DTOSTR_BUF_SIZE];
+  guint i;
+
+  string = g_string_new (NULL);
+
+  for (i = 0; i < events->len; i++)
+    {
+      const ReplayEvent *event = &g_array_index (events, ReplayEvent, i);
+
+      g_string_append_printf (string, "%" G_GINT64_FORMAT " %s",
+                              event->time, event_type_names[event->type]);
+
+      g_ascii_formatd (x, sizeof x, "%g", event->x);
+      g_ascii_formatd (y, sizeof y, "%g", event->y);
+
+      switch (event->type)
+        {
+        case REPLAY_MOTION:
+        case REPLAY_SCROLL:
+          g_string_append_printf (string, " %s %s", x, y);
+          break;
+
+        case REPLAY_PRESS:
+        case REPLAY_RELEASE:
+          g_string_append_printf (string, " %u %s %s", event->value, x, y);
+          break;
+
+        case REPLAY_SCROLL_STOP:
+          break;
+
+        case REPLAY_KEY_PRESS:
+        case REPLAY_KEY_RELEASE:
+          g_string_append_printf (string, " %s", gdk_keyval_name (event->value));
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+
+      g_string_append_c (string, '\n');
+    }
+
+  result = g_file_set_contents (filename, string->str, string->len, error);
+
+  g_string_free (string, TRUE);
+
+  return result;
+}
+
+/* }}} */
+/* {{{ Scenarios */
+
+static void
+add_event (GArray          *events,
+           gint64           time,
+           ReplayEventType  type,
+           double           x,
+           double           y,
+           guint            value)
+{
+  ReplayEvent event = { time, type, x, y, value };
+
+  g_array_append_val (events, event);
+}
+
+static const char *factory_ui =
+"<interface>\n"
+"  <template class='GtkListItem'>\n"
+"    <property name='child'>\n"
+"      <object class='GtkLabel'>\n"
+"        <property name='xalign'>0</property>\n"
+"        <binding name='label'>\n"
+"          <lookup name='string' type='GtkStringObject'>\n"
+"            <lookup name='item'>GtkListItem</lookup>\n"
+"          </lookup>\n"
+"        </binding>\n"
+"      </object>\n"
+"    </property>\n"
+"  </template>\n"
+"</interface>\n";
+
+static GtkWidget *
+create_list (GtkWidget **target)
+{
+  GtkWidget *window, *sw, *list;
+  GtkStringList *strings;
+  GtkListItemFactory *factory;
+  GBytes *bytes;
+  char buffer[64];
+  guint i;
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 600, 800);
+
+  strings = gtk_string_list_new (NULL);
+  for (i = 0; i < 100000; i++)
+    {
+      g_snprintf (buffer, sizeof buffer, "Item %u", i);
+      gtk_string_list_append (strings, buffer);
+    }
+
+  bytes = g_bytes_new_static (factory_ui, strlen (factory_ui));
+  factory = gtk_builder_list_item_factory_new_from_bytes (NULL, bytes);
+  g_bytes_unref (bytes);
+
+  list = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (strings))), factory);
+  sw = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), list);
+  gtk_window_set_child (GTK_WINDOW (window), sw);
+
+  *target = sw;
+
+  return window;
+}
+
+/* Scroll down and back up again, at 125 events per second */
+static void
+generate_list (GtkWidget *target,
+               GArray    *events)
+{
+  double x = gtk_widget_get_width (target) / 2.;
+  double y = gtk_widget_get_height (target) / 2.;
+  gint64 t = 0;
+  int i;
+
+  add_event (events, t, REPLAY_MOTION, x, y, 0);
+
+  for (i = 0; i < 250; i++)
+    add_event (events, t += 8, REPLAY_SCROLL, 0, 1, 0);
+  add_event (events, t += 8, REPLAY_SCROLL_STOP, 0, 0, 0);
+
+  for (i = 0; i < 250; i++)
+    add_event (events, t += 8, REPLAY_SCROLL, 0, -1, 0);
+  add_event (events, t += 8, REPLAY_SCROLL_STOP, 0, 0, 0);
+}
+
+static GtkWidget *
+create_text (GtkWidget **target)
+{
+  GtkWidget *window, *sw, *view;
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 600, 800);
+
+  view = gtk_text_view_new ();
+  gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (view), GTK_WRAP_WORD_CHAR);
+  sw = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), view);
+  gtk_window_set_child (GTK_WINDOW (window), sw);
+
+  *target = view;
+
+  return window;
+}
+
+/* Click into the text and type at about 16 keys per second */
+static void
+generate_text (GtkWidget *target,
+               GArray    *events)
+{
+  const char *text = "The quick brown fox jumps over the lazy dog. "
+                     "Pack my box with five dozen liquor jugs. "
+                     "How vexingly quick daft zebras jump!\n";
+  double x = gtk_widget_get_width (target) / 2.;
+  double y = gtk_widget_get_height (target) / 2.;
+  gint64 t = 0;
+  const char *p;
+  int i;
+
+  add_event (events, t, REPLAY_MOTION, x, y, 0);
+  add_event (events, t += 50, REPLAY_PRESS, x, y, GDK_BUTTON_PRIMARY);
+  add_event (events, t += 50, REPLAY_RELEASE, x, y, GDK_BUTTON_PRIMARY);
+
+  for (i = 0; i < 3; i++)
+    {
+      for (p = text; *p; p++)
+        {
+          guint keyval = *p == '\n' ? GDK_KEY_Return : gdk_unicode_to_keyval (*p);
+
+          add_event (events, t += 60, REPLAY_KEY_PRESS, 0, 0, keyval);
+          add_event (events, t + 30, REPLAY_KEY_RELEASE, 0, 0, keyval);
+        }
+    }
+}
+
+static GtkWidget *
+create_drag (GtkWidget **target)
+{
+  GtkWidget *window, *paned, *label, *start, *end;
+  GString *text;
+  int i;
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 800, 600);
+
+  text = g_string_new (NULL);
+  for (i = 0; i < 50; i++)
+    g_string_append (text, "Lorem ipsum dolor sit amet, consectetur adipiscing elit. ");
+
+  /* Wrapping labels on both sides, so dragging relayouts text */
+  label = gtk_label_new (text->str);
+  gtk_label_set_wrap (GTK_LABEL (label), TRUE);
+  start = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (start), label);
+
+  label = gtk_label_new (text->str);
+  gtk_label_set_wrap (GTK_LABEL (label), TRUE);
+  end = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (end), label);
+
+  g_string_free (text, TRUE);
+
+  paned = gtk_paned_new (GTK_ORIENTATION_HORIZONTAL);
+  gtk_paned_set_start_child (GTK_PANED (paned), start);
+  gtk_paned_set_end_child (GTK_PANED (paned), end);
+  gtk_paned_set_position (GTK_PANED (paned), 200);
+
+  gtk_window_set_child (GTK_WINDOW (window), paned);
+
+  *target = paned;
+
+  return window;
+}
+
+/* Drag the handle to the right and back, at 125 events per second */
+static void
+generate_drag (GtkWidget *target,
+               GArray    *events)
+{
+  double start = gtk_paned_get_position (GTK_PANED (target)) + 0.5;
+  double end = gtk_widget_get_width (target) - 200;
+  double y = gtk_widget_get_height (target) / 2.;
+  gint64 t = 0;
+  int i;
+
+  add_event (events, t, REPLAY_MOTION, start, y, 0);
+  add_event (events, t += 50, REPLAY_PRESS, start, y, GDK_BUTTON_PRIMARY);
+
+  for (i = 1; i <= 250; i++)
+    add_event (events, t += 8, REPLAY_MOTION, start + (end - start) * i / 250., y, 0);
+  for (i = 249; i >= 0; i--)
+    add_event (events, t += 8, REPLAY_MOTION, start + (end - start) * i / 250., y, 0);
+
+  add_event (events, t += 50, REPLAY_RELEASE, start, y, GDK_BUTTON_PRIMARY);
+}
+
+static const struct {
+  const char *name;
+  GtkWidget * (* create) (GtkWidget **target);
+  /* Positions are relative to the target */
+  void (* generate) (GtkWidget *target, GArray *events);
+} scenarios[] = {
+  { "list", create_list, generate_list },
+  { "text", create_text, generate_text },
+  { "drag", create_drag, generate_drag },
+};
+
+/* }}} */
+/* {{{ Replaying */
+
+typedef struct {
+  guint scenario;
+  GtkWidget *window;
+  GtkWidget *target;
+  GdkSurface *surface;
+  GdkDevice *pointer;
+  GdkDevice *keyboard;
+  GArray *events;
+  gint64 duration; /* of one run, in ms */
+
+  int run;
+  guint next;
+  gint64 start;
+  guint32 start_time;
+  GdkModifierType state;
+  gboolean entered;
+
+  gboolean done;
+} Replay;
+
+static void
+inject_event (GdkEvent *event)
+{
+  GdkDisplay *display = gdk_event_get_display (event);
+  GList *node;
+
+  /* Like the backends do, so the events go through the
+   * event queue and get compressed like real ones
+   */
+  node = _gdk_event_queue_append (display, event);
+  _gdk_windowing_got_event (display, node, event, _gdk_display_get_next_serial (display));
+}
+
+static GdkModifierType
+button_mask (guint button)
+{
+  return button >= 1 && button <= 5 ? GDK_BUTTON1_MASK << (button - 1) : 0;
+}
+
+static void
+replay_event (Replay            *replay,
+              const ReplayEvent *event,
+              guint32            time)
+{
+  GdkEvent *e;
+
+  if (!replay->entered &&
+      (event->type == REPLAY_MOTION || event->type == REPLAY_PRESS || event->type == REPLAY_RELEASE))
+    {
+      inject_event (gdk_crossing_event_new (GDK_ENTER_NOTIFY, replay->surface, replay->pointer,
+                                            time, replay->state, event->x, event->y,
+                                            GDK_CROSSING_NORMAL, GDK_NOTIFY_NONLINEAR));
+      replay->entered = TRUE;
+    }
+
+  switch (event->type)
+    {
+    case REPLAY_MOTION:
+      e = gdk_motion_event_new (replay->surface, replay->pointer, NULL, time,
+                                replay->state, event->x, event->y, NULL);
+      break;
+
+    case REPLAY_PRESS:
+      e = gdk_button_event_new (GDK_BUTTON_PRESS, replay->surface, replay->pointer, NULL, time,
+                                replay->state, event->value, event->x, event->y, NULL);
+      replay->state |= button_mask (event->value);
+      break;
+
+    case REPLAY_RELEASE:
+      e = gdk_button_event_new (GDK_BUTTON_RELEASE, replay->surface, replay->pointer, NULL, time,
+                                replay->state, event->value, event->x, event->y, NULL);
+      replay->state &= ~button_mask (event->value);
+      break;
+
+    case REPLAY_SCROLL:
+    case REPLAY_SCROLL_STOP:
+      e = gdk_scroll_event_new (replay->surface, replay->pointer, NULL, time, replay->state,
+                                event->x, event->y, event->type == REPLAY_SCROLL_STOP);
+      break;
+
+    case REPLAY_KEY_PRESS:
+    case REPLAY_KEY_RELEASE:
+      {
+        GdkKeymapKey *keys;
+        GdkTranslatedKey translated = { event->value, 0, 0, 0 };
+        guint keycode = 0;
+        int n_keys;
+
+        if (gdk_display_map_keyval (gdk_surface_get_display (replay->surface),
+                                    event->value, &keys, &n_keys))
+          {
+            keycode = keys[0].keycode;
+            translated.layout = keys[0].group;
+            translated.level = keys[0].level;
+            g_free (keys);
+          }
+
+        e = gdk_key_event_new (event->type == REPLAY_KEY_PRESS ? GDK_KEY_PRESS : GDK_KEY_RELEASE,
+                               replay->surface, replay->keyboard, time, keycode,
+                               replay->state, FALSE, &translated, &translated);
+      }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  inject_event (e);
+}
+
+static gboolean replay_events (gpointer data);
+
+static gint64
+event_due_time (Replay *replay)
+{
+  const ReplayEvent *event = &g_array_index (replay->events, ReplayEvent, replay->next);
+
+  return replay->start + (replay->run * replay->duration + event->time) * 1000;
+}
+
+static void
+schedule_next (Replay *replay)
+{
+  gint64 delay;
+
+  if (replay->next == replay->events->len)
+    {
+      replay->next = 0;
+      replay->run++;
+    }
+
+  if (replay->run == runs)
+    {
+      replay->done = TRUE;
+      g_main_context_wakeup (NULL);
+      return;
+    }
+
+  delay = event_due_time (replay) - g_get_monotonic_time ();
+  g_timeout_add (MAX (delay, 0) / 1000, replay_events, replay);
+}
+
+static gboolean
+replay_events (gpointer data)
+{
+  Replay *replay = data;
+  gint64 now = g_get_monotonic_time ();
+
+  /* Catch up on everything that is due, in case we are late */
+  while (replay->next < replay->events->len && event_due_time (replay) <= now)
+    {
+      const ReplayEvent *event = &g_array_index (replay->events, ReplayEvent, replay->next);
+
+      replay_event (replay, event, replay->start_time + replay->run * replay->duration + event->time);
+      replay->next++;
+    }
+
+  schedule_next (replay);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+translate_events (GArray    *events,
+                  GtkWidget *target)
+{
+  GtkNative *native = gtk_widget_get_native (target);
+  graphene_point_t p;
+  double sx, sy;
+  guint i;
+
+  if (!gtk_widget_compute_point (target, GTK_WIDGET (native), &GRAPHENE_POINT_INIT (0, 0), &p))
+    return;
+
+  gtk_native_get_surface_transform (native, &sx, &sy);
+
+  for (i = 0; i < events->len; i++)
+    {
+      ReplayEvent *event = &g_array_index (events, ReplayEvent, i);
+
+      if (event->type == REPLAY_MOTION ||
+          event->type == REPLAY_PRESS ||
+          event->type == REPLAY_RELEASE)
+        {
+          event->x += p.x + sx;
+          event->y += p.y + sy;
+        }
+    }
+}
+
+static void
+start_replay (Replay *replay)
+{
+  GdkSeat *seat = gdk_display_get_default_seat (gtk_widget_get_display (replay->window));
+  const ReplayEvent *last;
+
+  /* Now the target has its final size */
+  if (replay->events->len == 0)
+    {
+      scenarios[replay->scenario].generate (replay->target, replay->events);
+      translate_events (replay->events, replay->target);
+    }
+
+  replay->surface = gtk_native_get_surface (GTK_NATIVE (replay->window));
+  replay->pointer = gdk_seat_get_pointer (seat);
+  replay->keyboard = gdk_seat_get_keyboard (seat);
+
+  /* Leave some time after each run for the last frames */
+  last = &g_array_index (replay->events, ReplayEvent, replay->events->len - 1);
+  replay->duration = last->time + 500;
+
+  inject_event (gdk_focus_event_new (replay->surface, replay->keyboard, TRUE));
+
+  gdk_frame_statistics_reset (gdk_surface_get_frame_statistics (replay->surface));
+
+  replay->start = g_get_monotonic_time ();
+  replay->start_time = replay->start / 1000;
+  schedule_next (replay);
+}
+
+/* Wait for the window to settle, so its first frames
+ * don't end up in the statistics
+ */
+static gboolean
+wait_for_window (GtkWidget     *widget,
+                 GdkFrameClock *frame_clock,
+                 gpointer       data)
+{
+  Replay *replay = data;
+  static int n_frames = 0;
+
+  if (++n_frames < 10)
+    return G_SOURCE_CONTINUE;
+
+  n_frames = 0;
+  start_replay (replay);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* }}} */
+/* {{{ Recording */
+
+typedef struct {
+  GArray *events;
+  guint32 first_time;
+} Recording;
+
+static gboolean
+record_event (GtkEventControllerLegacy *controller,
+              GdkEvent                 *event,
+              Recording                *recording)
+{
+  ReplayEvent e = { 0, };
+  double x = 0, y = 0;
+
+  gdk_event_get_position (event, &x, &y);
+
+  switch ((int) gdk_event_get_event_type (event))
+    {
+    case GDK_MOTION_NOTIFY:
+      e.type = REPLAY_MOTION;
+      e.x = x;
+      e.y = y;
+      break;
+
+    case GDK_BUTTON_PRESS:
+    case GDK_BUTTON_RELEASE:
+      e.type = gdk_event_get_event_type (event) == GDK_BUTTON_PRESS ? REPLAY_PRESS : REPLAY_RELEASE;
+      e.value = gdk_button_event_get_button (event);
+      e.x = x;
+      e.y = y;
+      break;
+
+    case GDK_SCROLL:
+      if (gdk_scroll_event_is_stop (event))
+        {
+          e.type = REPLAY_SCROLL_STOP;
+        }
+      else
+        {
+          e.type = REPLAY_SCROLL;
+          if (gdk_scroll_event_get_direction (event) == GDK_SCROLL_SMOOTH)
+            gdk_scroll_event_get_deltas (event, &e.x, &e.y);
+          else if (gdk_scroll_event_get_direction (event) == GDK_SCROLL_UP)
+            e.y = -1;
+          else if (gdk_scroll_event_get_direction (event) == GDK_SCROLL_DOWN)
+            e.y = 1;
+          else if (gdk_scroll_event_get_direction (event) == GDK_SCROLL_LEFT)
+            e.x = -1;
+          else
+            e.x = 1;
+        }
+      break;
+
+    case GDK_KEY_PRESS:
+    case GDK_KEY_RELEASE:
+      e.type = gdk_event_get_event_type (event) == GDK_KEY_PRESS ? REPLAY_KEY_PRESS : REPLAY_KEY_RELEASE;
+      e.value = gdk_key_event_get_keyval (event);
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  if (recording->events->len == 0)
+    recording->first_time = gdk_event_get_time (event);
+
+  e.time = gdk_event_get_time (event) - recording->first_time;
+  g_array_append_val (recording->events, e);
+
+  return FALSE;
+}
+
+static void
+quit_cb (GtkWidget *widget,
+         gpointer   data)
+{
+  gboolean *done = data;
+
+  *done = TRUE;
+  g_main_context_wakeup (NULL);
+}
+
+static int
+record_scenario (guint scenario)
+{
+  GtkWidget *window, *target;
+  GtkEventController *controller;
+  Recording recording;
+  GError *error = NULL;
+  gboolean done = FALSE;
+
+  recording.events = g_array_new (FALSE, FALSE, sizeof (ReplayEvent));
+
+  window = scenarios[scenario].create (&target);
+  controller = gtk_event_controller_legacy_new ();
+  gtk_event_controller_set_propagation_phase (controller, GTK_PHASE_CAPTURE);
+  g_signal_connect (controller, "event", G_CALLBACK (record_event), &recording);
+  gtk_widget_add_controller (window, controller);
+  g_signal_connect (window, "destroy", G_CALLBACK (quit_cb), &done);
+
+  g_print ("Recording events for the %s scenario, close the window to stop\n",
+           scenarios[scenario].name);
+
+  gtk_window_present (GTK_WINDOW (window));
+
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  if (!save_events (recording.events, record_file, &error))
+    {
+      g_printerr ("Could not save events: %s\n", error->message);
+      g_error_free (error);
+      g_array_unref (recording.events);
+      return 1;
+    }
+
+  g_print ("Recorded %u events\n", recording.events->len);
+  g_array_unref (recording.events);
+
+  return 0;
+}
+
+/* }}} */
+
+static void
+print_results (const char         *name,
+               GArray             *events,
+               GdkFrameStatistics *statistics)
+{
+  guint n_frames = gdk_frame_statistics_get_n_frames (statistics);
+  guint n_missed = gdk_frame_statistics_get_n_missed_frames (statistics);
+
+  /* The score is the share of frames that were on time,
+   * which is what users notice as stutter.
+   */
+  g_print ("%-8s %7u %7u %7u %8.2fms %8.2fms %8.2fms %8.2fms %6.1f\n",
+           name,
+           events->len * runs,
+           n_frames,
+           n_missed,
+           gdk_frame_statistics_get_latency_percentile (statistics, 0.5) / 1000.,
+           gdk_frame_statistics_get_latency_percentile (statistics, 0.99) / 1000.,
+           gdk_frame_statistics_get_frame_time_percentile (statistics, 0.5) / 1000.,
+           gdk_frame_statistics_get_frame_time_percentile (statistics, 0.99) / 1000.,
+           n_frames > 0 ? 100. * (n_frames - MIN (n_missed, n_frames)) / n_frames : 0.);
+}
+
+static gboolean
+run_scenario (guint scenario)
+{
+  Replay replay = { 0, };
+  GError *error = NULL;
+
+  if (replay_file)
+    {
+      replay.events = load_events (replay_file, &error);
+      if (replay.events == NULL)
+        {
+          g_printerr ("Could not load events: %s\n", error->message);
+          g_error_free (error);
+          return FALSE;
+        }
+
+      if (replay.events->len == 0)
+        {
+          g_printerr ("No events in %s\n", replay_file);
+          g_array_unref (replay.events);
+          return FALSE;
+        }
+    }
+  else
+    {
+      /* Generated once the window has its size */
+      replay.events = g_array_new (FALSE, FALSE, sizeof (ReplayEvent));
+    }
+
+  replay.scenario = scenario;
+  replay.window = scenarios[scenario].create (&replay.target);
+  gtk_window_present (GTK_WINDOW (replay.window));
+
+  /* Collect statistics from the first frame on */
+  gdk_surface_get_frame_statistics (gtk_native_get_surface (GTK_NATIVE (replay.window)));
+
+  gtk_widget_add_tick_callback (replay.window, wait_for_window, &replay, NULL);
+
+  while (!replay.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  print_results (scenarios[scenario].name,
+                 replay.events,
+                 gdk_surface_get_frame_statistics (gtk_native_get_surface (GTK_NATIVE (replay.window))));
+
+  g_array_unref (replay.events);
+  gtk_window_destroy (GTK_WINDOW (replay.window));
+
+  return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  guint i;
+  int result = 0;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (runs < 1)
+    {
+      g_printerr ("Need at least one run.\n");
+      return 1;
+    }
+
+  if (scenario_name)
+    {
+      for (i = 0; i < G_N_ELEMENTS (scenarios); i++)
+        {
+          if (strcmp (scenario_name, scenarios[i].name) == 0)
+            break;
+        }
+
+      if (i == G_N_ELEMENTS (scenarios))
+        {
+          g_printerr ("No scenario named “%s”\n", scenario_name);
+          return 1;
+        }
+    }
+  else if (record_file || replay_file)
+    {
+      g_printerr ("Recording and replaying need a --scenario.\n");
+      return 1;
+    }
+
+  gtk_init ();
+
+  if (record_file)
+    {
+      for (i = 0; strcmp (scenario_name, scenarios[i].name) != 0; i++)
+        ;
+
+      return record_scenario (i);
+    }
+
+  g_print ("%-8s %7s %7s %7s %10s %10s %10s %10s %6s\n",
+           "Scenario", "Events", "Frames", "Missed",
+           "Lat p50", "Lat p99", "Frame p50", "Frame p99", "Score");
+
+  for (i = 0; i < G_N_ELEMENTS (scenarios); i++)
+    {
+      if (scenario_name && strcmp (scenario_name, scenarios[i].name) != 0)
+        continue;
+
+      if (!run_scenario (i))
+        result = 1;
+    }
+
+  return result;
+}
+
+/* vim:set foldmethod=marker: */
@@ -0,0 +1,388 @@
+/* Renders node files many times with all available renderers
+ * and reports how long it took, for tracking regressions.
+ *
+ * Without arguments, the files in rendernode-benchmark/ are used.
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+#include <epoxy/gl.h>
+#include <string.h>
+
+#include "gsk/gskprofilerprivate.h"
+#include "gsk/gskrendererprivate.h"
+#include "gsk/gl/gskglrenderer.h"
+#ifdef GDK_RENDERING_VULKAN
+#include "gsk/vulkan/gskvulkanrenderer.h"
+#endif
+
+static int runs = 20;
+static int warmup = 2;
+static char **renderer_names = NULL;
+static char *json_file = NULL;
+
+static GOptionEntry options[] = {
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Render each file N times", "N" },
+  { "warmup", 'w', 0, G_OPTION_ARG_INT, &warmup, "Render N times before measuring", "N" },
+  { "renderer", '\0', 0, G_OPTION_ARG_STRING_ARRAY, &renderer_names, "Only use this renderer, can be repeated", "NAME" },
+  { "json", 'j', 0, G_OPTION_ARG_FILENAME, &json_file, "Write results as JSON to FILE, - for stdout", "FILE" },
+  { NULL }
+};
+
+static const struct {
+  const char *name;
+  GskRenderer * (* create) (void);
+} renderer_types[] = {
+  { "cairo", gsk_cairo_renderer_new },
+  { "ngl", gsk_gl_renderer_new },
+#ifdef GDK_RENDERING_VULKAN
+  { "vulkan", gsk_vulkan_renderer_new },
+#endif
+};
+
+/* All times are in µs */
+typedef struct {
+  gint64 min;
+  gint64 median;
+  gint64 mean;
+  gint64 gpu_mean; /* -1 if the renderer can't measure it */
+} Timings;
+
+static int
+compare_times (gconstpointer a,
+               gconstpointer b)
+{
+  gint64 ta = *(const gint64 *) a;
+  gint64 tb = *(const gint64 *) b;
+
+  return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+/* The CPU time is taken until the texture was downloaded, so it
+ * includes waiting for the GPU. The GPU time is what the renderer
+ * measured itself, which the GL renderer does in debug builds.
+ */
+static void
+benchmark_node (GskRenderer   *renderer,
+                GskRenderNode *node,
+                Timings       *timings)
+{
+  GskProfiler *profiler = gsk_renderer_get_profiler (renderer);
+  GQuark gpu_timer = g_quark_from_static_string ("gpu-time");
+  gboolean has_gpu_timer;
+  gint64 *times;
+  gint64 total = 0, gpu_total = 0;
+  int n_gpu = 0;
+  int i;
+
+  has_gpu_timer = gsk_profiler_has_timer (profiler, gpu_timer);
+  times = g_new (gint64, runs);
+
+  for (i = -warmup; i < runs; i++)
+    {
+      GdkTexture *texture;
+      gint64 start;
+
+      start = g_get_monotonic_time ();
+      texture = gsk_renderer_render_texture (renderer, node, NULL);
+      if (i >= 0)
+        times[i] = g_get_monotonic_time () - start;
+      g_object_unref (texture);
+
+      if (i < 0)
+        continue;
+
+      total += times[i];
+
+      /* GL queries return results of earlier frames, and nothing
+       * when they are not ready yet.
+       */
+      if (has_gpu_timer)
+        {
+          gint64 gpu_time = gsk_profiler_timer_get (profiler, gpu_timer);
+
+          if (gpu_time > 0)
+            {
+              gpu_total += gpu_time;
+              n_gpu++;
+            }
+        }
+    }
+
+  qsort (times, runs, sizeof (gint64), compare_times);
+
+  timings->min = times[0];
+  timings->median = times[runs / 2];
+  timings->mean = total / runs;
+  timings->gpu_mean = n_gpu > 0 ? gpu_total / n_gpu : -1;
+
+  g_free (times);
+}
+
+static void
+append_json_string (GString    *string,
+                    const char *s)
+{
+  if (s == NULL)
+    {
+      g_string_append (string, "null");
+      return;
+    }
+
+  g_string_append_c (string, '"');
+  for (; *s; s++)
+    {
+      if (*s == '"' || *s == '\\')
+        g_string_append_printf (string, "\\%c", *s);
+      else if ((guchar) *s < 0x20)
+        g_string_append_printf (string, "\\u%04x", (guchar) *s);
+      else
+        g_string_append_c (string, *s);
+    }
+  g_string_append_c (string, '"');
+}
+
+static int
+compare_names (gconstpointer a,
+               gconstpointer b)
+{
+  return strcmp (*(const char **) a, *(const char **) b);
+}
+
+static void
+add_files (GPtrArray  *files,
+           const char *path)
+{
+  GDir *dir;
+  GPtrArray *names;
+  const char *name;
+
+  if (!g_file_test (path, G_FILE_TEST_IS_DIR))
+    {
+      g_ptr_array_add (files, g_strdup (path));
+      return;
+    }
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  names = g_ptr_array_new ();
+  while ((name = g_dir_read_name (dir)))
+    {
+      if (g_str_has_suffix (name, ".node"))
+        g_ptr_array_add (names, g_build_filename (path, name, NULL));
+    }
+  g_dir_close (dir);
+
+  /* Keep the output stable between runs */
+  g_ptr_array_sort (names, compare_names);
+  g_ptr_array_extend_and_steal (files, names);
+}
+
+static void
+append_gl_info (GString    *json,
+                GdkDisplay *display)
+{
+  GdkGLContext *context;
+
+  context = gdk_display_create_gl_context (display, NULL);
+  if (context == NULL || !gdk_gl_context_realize (context, NULL))
+    {
+      g_string_append (json, "  \"gl-vendor\": null,\n"
+                             "  \"gl-renderer\": null,\n"
+                             "  \"gl-version\": null,\n");
+      g_clear_object (&context);
+      return;
+    }
+
+  gdk_gl_context_make_current (context);
+
+  g_string_append (json, "  \"gl-vendor\": ");
+  append_json_string (json, (const char *) glGetString (GL_VENDOR));
+  g_string_append (json, ",\n  \"gl-renderer\": ");
+  append_json_string (json, (const char *) glGetString (GL_RENDERER));
+  g_string_append (json, ",\n  \"gl-version\": ");
+  append_json_string (json, (const char *) glGetString (GL_VERSION));
+  g_string_append (json, ",\n");
+
+  gdk_gl_context_clear_current ();
+  g_object_unref (context);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GdkSurface *surface;
+  GPtrArray *files;
+  GPtrArray *renderers;
+  GPtrArray *names;
+  GString *json;
+  gboolean first_result = TRUE;
+  guint i, j;
+
+  context = g_option_context_new ("[NODE-FILE|DIRECTORY…]");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+
+  if (runs < 1 || warmup < 0)
+    {
+      g_printerr ("Need at least one run and no negative number of warmup runs.\n");
+      return 1;
+    }
+
+  gtk_init ();
+
+  files = g_ptr_array_new_with_free_func (g_free);
+  if (argc > 1)
+    {
+      for (i = 1; i < (guint) argc; i++)
+        add_files (files, argv[i]);
+    }
+  else
+    {
+      char *dir = g_build_filename (GTK_SRCDIR, "rendernode-benchmark", NULL);
+      add_files (files, dir);
+      g_free (dir);
+    }
+
+  surface = gdk_surface_new_toplevel (gdk_display_get_default ());
+
+  renderers = g_ptr_array_new_with_free_func (g_object_unref);
+  names = g_ptr_array_new ();
+  for (i = 0; i < G_N_ELEMENTS (renderer_types); i++)
+    {
+      GskRenderer *renderer;
+
+      if (renderer_names &&
+          !g_strv_contains ((const char * const *) renderer_names, renderer_types[i].name))
+        continue;
+
+      renderer = renderer_types[i].create ();
+      if (!gsk_renderer_realize (renderer, surface, &error))
+        {
+          g_printerr ("Skipping %s renderer: %s\n", renderer_types[i].name, error->message);
+          g_clear_error (&error);
+          g_object_unref (renderer);
+          continue;
+        }
+
+      g_ptr_array_add (renderers, renderer);
+      g_ptr_array_add (names, (gpointer) renderer_types[i].name);
+    }
+
+  json = g_string_new ("{\n");
+  g_string_append_printf (json, "  \"gtk-version\": \"%u.%u.%u\",\n",
+                          gtk_get_major_version (),
+                          gtk_get_minor_version (),
+                          gtk_get_micro_version ());
+  append_gl_info (json, gdk_display_get_default ());
+  g_string_append_printf (json, "  \"runs\": %d,\n  \"warmup\": %d,\n", runs, warmup);
+  g_string_append (json, "  \"results\": [");
+
+  if (json_file == NULL || !g_str_equal (json_file, "-"))
+    g_print ("%-32s %-8s %10s %10s %10s %10s\n",
+             "File", "Renderer", "Min", "Median", "Mean", "GPU");
+
+  for (i = 0; i < files->len; i++)
+    {
+      const char *filename = g_ptr_array_index (files, i);
+      GskRenderNode *node;
+      GBytes *bytes;
+      char *basename;
+      char *contents;
+      gsize len;
+
+      if (!g_file_get_contents (filename, &contents, &len, &error))
+        {
+          g_printerr ("Could not open node file: %s\n", error->message);
+          g_clear_error (&error);
+          continue;
+        }
+
+      bytes = g_bytes_new_take (contents, len);
+
+      node = gsk_render_node_deserialize (bytes, NULL, NULL);
+      g_bytes_unref (bytes);
+      if (node == NULL)
+        {
+          g_printerr ("Could not parse %s\n", filename);
+          continue;
+        }
+
+      basename = g_path_get_basename (filename);
+
+      for (j = 0; j < renderers->len; j++)
+        {
+          GskRenderer *renderer = g_ptr_array_index (renderers, j);
+          const char *name = g_ptr_array_index (names, j);
+          Timings timings;
+
+          benchmark_node (renderer, node, &timings);
+
+          if (json_file == NULL || !g_str_equal (json_file, "-"))
+            {
+              char *gpu = timings.gpu_mean >= 0
+                          ? g_strdup_printf ("%.3fms", timings.gpu_mean / 1000.)
+                          : g_strdup ("-");
+
+              g_print ("%-32s %-8s %8.3fms %8.3fms %8.3fms %10s\n",
+                       basename, name,
+                       timings.min / 1000., timings.median / 1000., timings.mean / 1000.,
+                       gpu);
+              g_free (gpu);
+            }
+
+          g_string_append (json, first_result ? "\n    {" : ",\n    {");
+          first_result = FALSE;
+          g_string_append (json, " \"file\": ");
+          append_json_string (json, basename);
+          g_string_append (json, ", \"renderer\": ");
+          append_json_string (json, name);
+          g_string_append_printf (json,
+                                  ", \"cpu-min-us\": %" G_GINT64_FORMAT
+                                  ", \"cpu-median-us\": %" G_GINT64_FORMAT
+                                  ", \"cpu-mean-us\": %" G_GINT64_FORMAT,
+                                  timings.min, timings.median, timings.mean);
+          if (timings.gpu_mean >= 0)
+            g_string_append_printf (json, ", \"gpu-mean-us\": %" G_GINT64_FORMAT " }", timings.gpu_mean);
+          else
+            g_string_append (json, ", \"gpu-mean-us\": null }");
+        }
+
+      g_free (basename);
+      gsk_render_node_unref (node);
+    }
+
+  g_string_append (json, "\n  ]\n}\n");
+
+  if (json_file != NULL)
+    {
+      if (g_str_equal (json_file, "-"))
+        g_print ("%s", json->str);
+      else if (!g_file_set_contents (json_file, json->str, json->len, &error))
+        {
+          g_printerr ("Could not write %s: %s\n", json_file, error->message);
+          g_clear_error (&error);
+        }
+    }
+
+  g_string_free (json, TRUE);
+
+  for (j = 0; j < renderers->len; j++)
+    gsk_renderer_unrealize (g_ptr_array_index (renderers, j));
+  g_ptr_array_unref (renderers);
+  g_ptr_array_unref (names);
+  g_ptr_array_unref (files);
+  g_object_unref (surface);
+  g_option_context_free (context);
+
+  return 0;
+}
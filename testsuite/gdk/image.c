@@ -2,6 +2,8 @@
 #include "gdk/loaders/gdkpngprivate.h"
 #include "gdk/loaders/gdktiffprivate.h"
 #include "gdk/loaders/gdkjpegprivate.h"
+#include "gdk/loaders/gdkrawprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
 
 static void
 assert_texture_equal (GdkTexture *t1,
@@ -67,6 +69,151 @@ test_load_image (gconstpointer data)
   g_free (path);
 }
 
+static void
+test_load_png_progressive (void)
+{
+  GdkPngLoader *loader;
+  GdkTexture *texture, *partial, *reference;
+  const guchar *data;
+  gsize size, i;
+  char *path;
+  GFile *file;
+  GBytes *bytes;
+  GError *error = NULL;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", "image.png", NULL);
+  file = g_file_new_for_path (path);
+  bytes = g_file_load_bytes (file, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  reference = gdk_load_png (bytes, &error);
+  g_assert_no_error (error);
+
+  data = g_bytes_get_data (bytes, &size);
+  loader = gdk_png_loader_new ();
+  partial = NULL;
+
+  /* Feed the data in small pieces, and check that we get
+   * a partial texture before everything has arrived
+   */
+  for (i = 0; i < size; i += 7)
+    {
+      g_assert_false (gdk_png_loader_is_done (loader));
+      g_assert_true (gdk_png_loader_feed (loader, data + i, MIN (7, size - i), &error));
+      g_assert_no_error (error);
+
+      if (partial == NULL && !gdk_png_loader_is_done (loader))
+        partial = gdk_png_loader_get_texture (loader);
+    }
+
+  g_assert_true (gdk_png_loader_is_done (loader));
+  g_assert_nonnull (partial);
+  g_assert_cmpint (gdk_texture_get_width (partial), ==, 32);
+  g_assert_cmpint (gdk_texture_get_height (partial), ==, 32);
+
+  texture = gdk_png_loader_get_texture (loader);
+  assert_texture_equal (texture, reference);
+
+  g_object_unref (texture);
+  g_object_unref (partial);
+  gdk_png_loader_free (loader);
+  g_object_unref (reference);
+  g_bytes_unref (bytes);
+  g_object_unref (file);
+  g_free (path);
+}
+
+static void
+test_load_jpeg_at_size (void)
+{
+  struct {
+    int width, height;
+    int downscale;
+  } sizes[] = {
+    { -1, -1, 1 },
+    { 32, 32, 1 },
+    { 20, 10, 1 },
+    { 16, 16, 2 },
+    { 5, 10, 2 },
+    { 8, 8, 4 },
+    { 1, 1, 8 },
+  };
+  char *path;
+  GFile *file;
+  GBytes *bytes;
+  GError *error = NULL;
+  guint i;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", "image.jpeg", NULL);
+  file = g_file_new_for_path (path);
+  bytes = g_file_load_bytes (file, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      GdkTexture *texture;
+      int downscale;
+
+      texture = gdk_load_jpeg_at_size (bytes, sizes[i].width, sizes[i].height, &downscale, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (downscale, ==, sizes[i].downscale);
+      g_assert_cmpint (gdk_texture_get_width (texture), ==, 32 / downscale);
+      g_assert_cmpint (gdk_texture_get_height (texture), ==, 32 / downscale);
+      g_object_unref (texture);
+    }
+
+  g_bytes_unref (bytes);
+  g_object_unref (file);
+  g_free (path);
+}
+
+static void
+test_load_raw (void)
+{
+  GdkTexture *texture, *loaded;
+  GBytes *bytes;
+  const guchar *data;
+  gsize size;
+  char *path;
+  GFile *file;
+  GError *error = NULL;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", "image.png", NULL);
+  file = g_file_new_for_path (path);
+  texture = gdk_texture_new_from_file (file, &error);
+  g_assert_no_error (error);
+
+  bytes = gdk_save_raw (texture, GDK_MEMORY_R8G8B8);
+  g_assert_true (gdk_is_raw (bytes));
+
+  loaded = gdk_load_raw (bytes, &error);
+  g_assert_no_error (error);
+  assert_texture_equal (texture, loaded);
+
+  /* The pixels must not be copied */
+  data = g_bytes_get_data (bytes, &size);
+  g_assert_true (gdk_memory_texture_get_data (GDK_MEMORY_TEXTURE (loaded)) > data);
+  g_assert_true (gdk_memory_texture_get_data (GDK_MEMORY_TEXTURE (loaded)) < data + size);
+
+  g_object_unref (loaded);
+
+  /* Truncated data is refused */
+  {
+    GBytes *truncated = g_bytes_new_from_bytes (bytes, 0, size - 1);
+
+    loaded = gdk_load_raw (truncated, &error);
+    g_assert_error (error, GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE);
+    g_assert_null (loaded);
+    g_clear_error (&error);
+    g_bytes_unref (truncated);
+  }
+
+  g_bytes_unref (bytes);
+  g_object_unref (texture);
+  g_object_unref (file);
+  g_free (path);
+}
+
 static void
 test_save_image (gconstpointer test_data)
 {
@@ -114,6 +261,42 @@ test_save_image (gconstpointer test_data)
   g_free (path);
 }
 
+static void
+test_save_png_stream (void)
+{
+  char *path;
+  GFile *file;
+  GdkTexture *texture;
+  GdkTexture *texture2;
+  GOutputStream *stream;
+  GBytes *bytes;
+  GError *error = NULL;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", "image.png", NULL);
+  file = g_file_new_for_path (path);
+  texture = gdk_texture_new_from_file (file, &error);
+  g_assert_no_error (error);
+
+  stream = g_memory_output_stream_new_resizable ();
+  g_assert_true (gdk_save_png_to_stream (texture, stream, 2, NULL, &error));
+  g_assert_no_error (error);
+  g_output_stream_close (stream, NULL, &error);
+  g_assert_no_error (error);
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (stream));
+  texture2 = gdk_load_png (bytes, &error);
+  g_assert_no_error (error);
+
+  assert_texture_equal (texture, texture2);
+
+  g_bytes_unref (bytes);
+  g_object_unref (stream);
+  g_object_unref (texture2);
+  g_object_unref (texture);
+  g_object_unref (file);
+  g_free (path);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -122,8 +305,12 @@ main (int argc, char *argv[])
   g_test_add_data_func ("/image/load/png", "image.png", test_load_image);
   g_test_add_data_func ("/image/load/tiff", "image.tiff", test_load_image);
   g_test_add_data_func ("/image/load/jpeg", "image.jpeg", test_load_image);
+  g_test_add_func ("/image/load/png-progressive", test_load_png_progressive);
+  g_test_add_func ("/image/load/jpeg-at-size", test_load_jpeg_at_size);
+  g_test_add_func ("/image/load/raw", test_load_raw);
   g_test_add_data_func ("/image/save/png", "image.png", test_save_image);
   g_test_add_data_func ("/image/save/tiff", "image.tiff", test_save_image);
+  g_test_add_func ("/image/save/png-stream", test_save_png_stream);
 
   return g_test_run ();
 }
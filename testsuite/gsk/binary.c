@@ -0,0 +1,272 @@
+/*
+ * Copyright © 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+#include "gsk/gskrendernodeparserprivate.h"
+
+static GdkTexture *
+create_texture (void)
+{
+  static const guchar pixels[] = {
+    255, 0, 0, 255,    0, 255, 0, 255,
+    0, 0, 255, 255,    255, 255, 255, 255,
+  };
+  GdkTexture *texture;
+  GBytes *bytes;
+
+  bytes = g_bytes_new_static (pixels, sizeof (pixels));
+  texture = gdk_memory_texture_new (2, 2, GDK_MEMORY_R8G8B8A8, bytes, 8);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static GskRenderNode *
+create_tree (GdkTexture *texture)
+{
+  GskRenderNode *nodes[5];
+  GskRenderNode *child, *container;
+  GskColorStop stops[] = {
+    { 0.0, { 1, 0, 0, 1 } },
+    { 0.5, { 0, 1, 0, 0.5 } },
+    { 1.0, { 0, 0, 1, 1 } },
+  };
+  GskTransform *transform;
+  guint i;
+
+  nodes[0] = gsk_color_node_new (&(GdkRGBA) { 0.2, 0.4, 0.6, 0.8 }, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  nodes[1] = gsk_texture_node_new_with_filter (texture, &GRAPHENE_RECT_INIT (10, 0, 20, 20), GSK_SCALING_FILTER_NEAREST);
+  nodes[2] = gsk_linear_gradient_node_new (&GRAPHENE_RECT_INIT (0, 20, 30, 10),
+                                           &GRAPHENE_POINT_INIT (0, 20),
+                                           &GRAPHENE_POINT_INIT (30, 20),
+                                           stops, G_N_ELEMENTS (stops));
+
+  child = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, 5, 5));
+  transform = gsk_transform_rotate (gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (40, 0)), 45);
+  nodes[3] = gsk_transform_node_new (child, transform);
+  gsk_transform_unref (transform);
+  gsk_render_node_unref (child);
+
+  /* The same node twice */
+  nodes[4] = gsk_clip_node_new (nodes[0], &GRAPHENE_RECT_INIT (2, 2, 4, 4));
+
+  container = gsk_container_node_new (nodes, G_N_ELEMENTS (nodes));
+  for (i = 0; i < G_N_ELEMENTS (nodes); i++)
+    gsk_render_node_unref (nodes[i]);
+
+  return container;
+}
+
+static void
+test_roundtrip (void)
+{
+  GskRenderNode *node, *loaded;
+  GdkTexture *texture;
+  GBytes *binary, *text1, *text2;
+
+  texture = create_texture ();
+  node = create_tree (texture);
+
+  binary = gsk_render_node_serialize_binary (node);
+  g_assert_true (gsk_render_node_is_binary (binary));
+
+  loaded = gsk_render_node_deserialize (binary, NULL, NULL);
+  g_assert_nonnull (loaded);
+
+  text1 = gsk_render_node_serialize (node);
+  text2 = gsk_render_node_serialize (loaded);
+  g_assert_cmpmem (g_bytes_get_data (text1, NULL), g_bytes_get_size (text1),
+                   g_bytes_get_data (text2, NULL), g_bytes_get_size (text2));
+
+  g_bytes_unref (text1);
+  g_bytes_unref (text2);
+  g_bytes_unref (binary);
+  gsk_render_node_unref (loaded);
+  gsk_render_node_unref (node);
+  g_object_unref (texture);
+}
+
+static void
+test_dedup (void)
+{
+  GskRenderNode *nodes[2];
+  GskRenderNode *single, *twice;
+  GdkTexture *texture;
+  GBytes *bytes1, *bytes2, *png;
+
+  texture = create_texture ();
+  png = gdk_texture_save_to_png_bytes (texture);
+
+  nodes[0] = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  nodes[1] = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (10, 0, 10, 10));
+  single = gsk_container_node_new (nodes, 1);
+  twice = gsk_container_node_new (nodes, 2);
+
+  bytes1 = gsk_render_node_serialize_binary (single);
+  bytes2 = gsk_render_node_serialize_binary (twice);
+
+  /* The second node must not store the image again */
+  g_assert_cmpuint (g_bytes_get_size (bytes2) - g_bytes_get_size (bytes1), <, g_bytes_get_size (png));
+
+  g_bytes_unref (bytes1);
+  g_bytes_unref (bytes2);
+  g_bytes_unref (png);
+  gsk_render_node_unref (nodes[0]);
+  gsk_render_node_unref (nodes[1]);
+  gsk_render_node_unref (single);
+  gsk_render_node_unref (twice);
+  g_object_unref (texture);
+}
+
+static void
+count_errors (const GskParseLocation *start,
+              const GskParseLocation *end,
+              const GError           *error,
+              gpointer                user_data)
+{
+  guint *n_errors = user_data;
+
+  g_assert_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_INVALID_DATA);
+  (*n_errors)++;
+}
+
+static void
+test_truncated (void)
+{
+  GskRenderNode *node, *loaded;
+  GdkTexture *texture;
+  GBytes *bytes, *truncated;
+  guint n_errors = 0;
+
+  texture = create_texture ();
+  node = create_tree (texture);
+  bytes = gsk_render_node_serialize_binary (node);
+
+  /* Cut off the data table */
+  truncated = g_bytes_new_from_bytes (bytes, 0, g_bytes_get_size (bytes) - 4);
+  loaded = gsk_render_node_deserialize (truncated, count_errors, &n_errors);
+  g_assert_null (loaded);
+  g_assert_cmpuint (n_errors, ==, 1);
+
+  g_bytes_unref (truncated);
+  g_bytes_unref (bytes);
+  gsk_render_node_unref (node);
+  g_object_unref (texture);
+}
+
+static void
+assert_same_node (GskRenderNode *node1,
+                  GskRenderNode *node2)
+{
+  GBytes *text1, *text2;
+
+  text1 = gsk_render_node_serialize (node1);
+  text2 = gsk_render_node_serialize (node2);
+  g_assert_cmpmem (g_bytes_get_data (text1, NULL), g_bytes_get_size (text1),
+                   g_bytes_get_data (text2, NULL), g_bytes_get_size (text2));
+
+  g_bytes_unref (text1);
+  g_bytes_unref (text2);
+}
+
+static void
+test_stream (void)
+{
+  GskRenderNode *frames[2], *nodes[2], *tree, *loaded;
+  GskRenderNodeWriter *writer;
+  GskRenderNodeReader *reader;
+  GOutputStream *stream;
+  GdkTexture *texture;
+  GBytes *bytes, *truncated;
+  guint32 offsets[2];
+  gsize first_size;
+  GError *error = NULL;
+  guint i;
+
+  texture = create_texture ();
+  tree = create_tree (texture);
+
+  /* The second frame shares the tree with the first one */
+  nodes[0] = tree;
+  nodes[1] = gsk_color_node_new (&(GdkRGBA) { 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 5, 5));
+  frames[0] = gsk_render_node_ref (tree);
+  frames[1] = gsk_container_node_new (nodes, 2);
+  gsk_render_node_unref (nodes[1]);
+
+  stream = g_memory_output_stream_new_resizable ();
+  writer = gsk_render_node_writer_new (stream);
+
+  offsets[0] = gsk_render_node_writer_add_frame (writer, frames[0], &error);
+  g_assert_no_error (error);
+  first_size = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (stream));
+
+  offsets[1] = gsk_render_node_writer_add_frame (writer, frames[1], &error);
+  g_assert_no_error (error);
+
+  /* The shared tree and its image must not be stored again */
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (stream)) - first_size, <, first_size / 2);
+
+  gsk_render_node_writer_free (writer);
+  g_output_stream_close (stream, NULL, NULL);
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (stream));
+
+  reader = gsk_render_node_reader_new (bytes, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (gsk_render_node_reader_get_n_frames (reader), ==, 2);
+
+  for (i = 0; i < 2; i++)
+    {
+      g_assert_cmpuint (gsk_render_node_reader_get_frame (reader, i), ==, offsets[i]);
+
+      loaded = gsk_render_node_reader_load (reader, offsets[i], &error);
+      g_assert_no_error (error);
+      assert_same_node (frames[i], loaded);
+      gsk_render_node_unref (loaded);
+    }
+
+  gsk_render_node_reader_unref (reader);
+
+  /* An unfinished last frame is skipped */
+  truncated = g_bytes_new_from_bytes (bytes, 0, g_bytes_get_size (bytes) - 4);
+  reader = gsk_render_node_reader_new (truncated, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (gsk_render_node_reader_get_n_frames (reader), ==, 1);
+  g_assert_cmpuint (gsk_render_node_reader_get_size (reader), ==, first_size);
+  gsk_render_node_reader_unref (reader);
+
+  g_bytes_unref (truncated);
+  g_bytes_unref (bytes);
+  g_object_unref (stream);
+  gsk_render_node_unref (frames[0]);
+  gsk_render_node_unref (frames[1]);
+  gsk_render_node_unref (tree);
+  g_object_unref (texture);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/node/binary/roundtrip", test_roundtrip);
+  g_test_add_func ("/node/binary/dedup", test_dedup);
+  g_test_add_func ("/node/binary/truncated", test_truncated);
+  g_test_add_func ("/node/binary/stream", test_stream);
+
+  return g_test_run ();
+}
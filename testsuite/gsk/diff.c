@@ -86,6 +86,55 @@ test_can_diff_transform (void)
   gsk_transform_unref (t2);
 }
 
+static void
+test_diff_texture_update (void)
+{
+  GdkTexture *texture1, *texture2, *texture3;
+  GskRenderNode *node1, *node2, *node3;
+  cairo_region_t *update, *region;
+  cairo_rectangle_int_t extents;
+  GBytes *bytes;
+
+  bytes = g_bytes_new_take (g_malloc0 (100 * 100 * 4), 100 * 100 * 4);
+  texture1 = gdk_memory_texture_new (100, 100, GDK_MEMORY_DEFAULT, bytes, 400);
+  update = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { 10, 10, 5, 5 });
+  texture2 = gdk_memory_texture_new_with_update (100, 100, GDK_MEMORY_DEFAULT, bytes, 400,
+                                                 texture1, update);
+  texture3 = gdk_memory_texture_new (100, 100, GDK_MEMORY_DEFAULT, bytes, 400);
+
+  node1 = gsk_texture_node_new (texture1, &GRAPHENE_RECT_INIT (0, 0, 200, 200));
+  node2 = gsk_texture_node_new (texture2, &GRAPHENE_RECT_INIT (0, 0, 200, 200));
+  node3 = gsk_texture_node_new (texture3, &GRAPHENE_RECT_INIT (0, 0, 200, 200));
+
+  /* Only the updated area, scaled to the node, is damaged */
+  region = cairo_region_create ();
+  gsk_render_node_diff (node1, node2, region);
+  cairo_region_get_extents (region, &extents);
+  g_assert_cmpint (extents.x, <=, 20);
+  g_assert_cmpint (extents.y, <=, 20);
+  g_assert_cmpint (extents.x + extents.width, >=, 30);
+  g_assert_cmpint (extents.y + extents.height, >=, 30);
+  g_assert_cmpint (extents.width, <, 200);
+  cairo_region_destroy (region);
+
+  /* Unrelated textures damage everything */
+  region = cairo_region_create ();
+  gsk_render_node_diff (node2, node3, region);
+  cairo_region_get_extents (region, &extents);
+  g_assert_cmpint (extents.width, ==, 200);
+  g_assert_cmpint (extents.height, ==, 200);
+  cairo_region_destroy (region);
+
+  gsk_render_node_unref (node1);
+  gsk_render_node_unref (node2);
+  gsk_render_node_unref (node3);
+  g_object_unref (texture1);
+  g_object_unref (texture2);
+  g_object_unref (texture3);
+  cairo_region_destroy (update);
+  g_bytes_unref (bytes);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -94,6 +143,7 @@ main (int   argc,
 
   g_test_add_func ("/node/can-diff/basic", test_can_diff_basic);
   g_test_add_func ("/node/can-diff/transform", test_can_diff_transform);
+  g_test_add_func ("/node/diff/texture-update", test_diff_texture_update);
 
   return g_test_run ();
 }
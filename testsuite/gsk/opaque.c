@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+#include "gsk/gskrendernodeprivate.h"
+
+static void
+assert_opaque_rect (GskRenderNode   *node,
+                    float            x,
+                    float            y,
+                    float            width,
+                    float            height)
+{
+  graphene_rect_t opaque;
+
+  g_assert_true (gsk_render_node_get_opaque_rect (node, &opaque));
+  g_assert_cmpfloat (opaque.origin.x, ==, x);
+  g_assert_cmpfloat (opaque.origin.y, ==, y);
+  g_assert_cmpfloat (opaque.size.width, ==, width);
+  g_assert_cmpfloat (opaque.size.height, ==, height);
+}
+
+static void
+test_color (void)
+{
+  GskRenderNode *node;
+  graphene_rect_t opaque;
+
+  node = gsk_color_node_new (&(GdkRGBA) { 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (10, 20, 30, 40));
+  assert_opaque_rect (node, 10, 20, 30, 40);
+  gsk_render_node_unref (node);
+
+  node = gsk_color_node_new (&(GdkRGBA) { 1, 0, 0, 0.5 }, &GRAPHENE_RECT_INIT (10, 20, 30, 40));
+  g_assert_false (gsk_render_node_get_opaque_rect (node, &opaque));
+  gsk_render_node_unref (node);
+}
+
+static void
+test_texture (void)
+{
+  static const guchar pixels[] = {
+    255, 0, 0, 255,    0, 255, 0, 255,
+    0, 0, 255, 255,    255, 255, 255, 255,
+  };
+  GskRenderNode *node;
+  GdkTexture *texture;
+  graphene_rect_t opaque;
+  GBytes *bytes;
+
+  bytes = g_bytes_new_static (pixels, sizeof (pixels));
+
+  texture = gdk_memory_texture_new (2, 2, GDK_MEMORY_R8G8B8, bytes, 8);
+  node = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  assert_opaque_rect (node, 0, 0, 10, 10);
+  gsk_render_node_unref (node);
+  g_object_unref (texture);
+
+  /* Formats with alpha are not checked pixel by pixel */
+  texture = gdk_memory_texture_new (2, 2, GDK_MEMORY_R8G8B8A8, bytes, 8);
+  node = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  g_assert_false (gsk_render_node_get_opaque_rect (node, &opaque));
+  gsk_render_node_unref (node);
+  g_object_unref (texture);
+
+  g_bytes_unref (bytes);
+}
+
+static void
+test_container (void)
+{
+  GskRenderNode *nodes[3];
+  GskRenderNode *container;
+  guint i;
+
+  nodes[0] = gsk_color_node_new (&(GdkRGBA) { 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+  nodes[1] = gsk_color_node_new (&(GdkRGBA) { 0, 1, 0, 1 }, &GRAPHENE_RECT_INIT (20, 0, 50, 50));
+  nodes[2] = gsk_color_node_new (&(GdkRGBA) { 0, 0, 1, 0.5 }, &GRAPHENE_RECT_INIT (0, 0, 100, 100));
+  container = gsk_container_node_new (nodes, G_N_ELEMENTS (nodes));
+
+  /* The largest opaque child wins */
+  assert_opaque_rect (container, 20, 0, 50, 50);
+
+  gsk_render_node_unref (container);
+  for (i = 0; i < G_N_ELEMENTS (nodes); i++)
+    gsk_render_node_unref (nodes[i]);
+}
+
+static void
+test_clip (void)
+{
+  GskRenderNode *child, *node;
+  GskRoundedRect rounded;
+
+  child = gsk_color_node_new (&(GdkRGBA) { 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 100, 100));
+
+  node = gsk_clip_node_new (child, &GRAPHENE_RECT_INIT (50, 50, 100, 100));
+  assert_opaque_rect (node, 50, 50, 50, 50);
+  gsk_render_node_unref (node);
+
+  gsk_rounded_rect_init_from_rect (&rounded, &GRAPHENE_RECT_INIT (0, 0, 100, 100), 10);
+  node = gsk_rounded_clip_node_new (child, &rounded);
+  assert_opaque_rect (node, 10, 10, 80, 80);
+  gsk_render_node_unref (node);
+
+  gsk_render_node_unref (child);
+}
+
+static void
+test_transform (void)
+{
+  GskRenderNode *child, *node;
+  GskTransform *transform;
+  graphene_rect_t opaque;
+
+  child = gsk_color_node_new (&(GdkRGBA) { 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 10, 10));
+
+  transform = gsk_transform_scale (gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (5, 5)), 2, 3);
+  node = gsk_transform_node_new (child, transform);
+  assert_opaque_rect (node, 5, 5, 20, 30);
+  gsk_render_node_unref (node);
+  gsk_transform_unref (transform);
+
+  transform = gsk_transform_rotate (NULL, 45);
+  node = gsk_transform_node_new (child, transform);
+  g_assert_false (gsk_render_node_get_opaque_rect (node, &opaque));
+  gsk_render_node_unref (node);
+  gsk_transform_unref (transform);
+
+  gsk_render_node_unref (child);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/node/opaque/color", test_color);
+  g_test_add_func ("/node/opaque/texture", test_texture);
+  g_test_add_func ("/node/opaque/container", test_container);
+  g_test_add_func ("/node/opaque/clip", test_clip);
+  g_test_add_func ("/node/opaque/transform", test_transform);
+
+  return g_test_run ();
+}
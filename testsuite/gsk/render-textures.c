@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+static GskRenderNode *
+create_tree (void)
+{
+  GskRenderNode *nodes[3];
+  GskRenderNode *container;
+  guint i;
+
+  nodes[0] = gsk_color_node_new (&(GdkRGBA) { 1, 0, 0, 1 }, &GRAPHENE_RECT_INIT (0, 0, 100, 100));
+  nodes[1] = gsk_color_node_new (&(GdkRGBA) { 0, 1, 0, 0.5 }, &GRAPHENE_RECT_INIT (20, 20, 50, 50));
+  nodes[2] = gsk_color_node_new (&(GdkRGBA) { 0, 0, 1, 1 }, &GRAPHENE_RECT_INIT (60, 10, 30, 80));
+
+  container = gsk_container_node_new (nodes, G_N_ELEMENTS (nodes));
+  for (i = 0; i < G_N_ELEMENTS (nodes); i++)
+    gsk_render_node_unref (nodes[i]);
+
+  return container;
+}
+
+static void
+assert_textures_equal (GdkTexture *texture1,
+                       GdkTexture *texture2)
+{
+  int width, height;
+  guchar *data1, *data2;
+
+  width = gdk_texture_get_width (texture1);
+  height = gdk_texture_get_height (texture1);
+  g_assert_cmpint (width, ==, gdk_texture_get_width (texture2));
+  g_assert_cmpint (height, ==, gdk_texture_get_height (texture2));
+
+  data1 = g_malloc (width * height * 4);
+  data2 = g_malloc (width * height * 4);
+  gdk_texture_download (texture1, data1, width * 4);
+  gdk_texture_download (texture2, data2, width * 4);
+
+  g_assert_cmpmem (data1, width * height * 4, data2, width * height * 4);
+
+  g_free (data1);
+  g_free (data2);
+}
+
+static void
+test_render_textures (void)
+{
+  const graphene_rect_t viewports[] = {
+    GRAPHENE_RECT_INIT (0, 0, 100, 100),
+    GRAPHENE_RECT_INIT (10, 10, 20, 20),
+    GRAPHENE_RECT_INIT (55, 5, 40.5, 30),
+    GRAPHENE_RECT_INIT (200, 200, 10, 10),
+  };
+  GskRenderer *renderer;
+  GskRenderNode *node;
+  GdkTexture **textures;
+  GError *error = NULL;
+  guint i;
+
+  renderer = gsk_cairo_renderer_new ();
+  gsk_renderer_realize (renderer, NULL, &error);
+  g_assert_no_error (error);
+
+  node = create_tree ();
+
+  textures = gsk_renderer_render_textures (renderer, node, viewports, G_N_ELEMENTS (viewports));
+  g_assert_nonnull (textures);
+
+  for (i = 0; i < G_N_ELEMENTS (viewports); i++)
+    {
+      GdkTexture *texture;
+
+      texture = gsk_renderer_render_texture (renderer, node, &viewports[i]);
+      assert_textures_equal (textures[i], texture);
+
+      g_object_unref (texture);
+      g_object_unref (textures[i]);
+    }
+
+  g_free (textures);
+  gsk_render_node_unref (node);
+  gsk_renderer_unrealize (renderer);
+  g_object_unref (renderer);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/renderer/render-textures", test_render_textures);
+
+  return g_test_run ();
+}
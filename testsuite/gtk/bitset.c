@@ -71,6 +71,23 @@ create_large_rectangle (void)
   return set;
 }
 
+/* dense enough to use bitset containers, with runs crossing words */
+static GtkBitset *
+create_dense_pattern (void)
+{
+  GtkBitset *set;
+  guint i;
+
+  set = gtk_bitset_new_empty ();
+  for (i = 1000; i < 201000; i++)
+    {
+      if (i % 3)
+        gtk_bitset_add (set, i);
+    }
+
+  return set;
+}
+
 static struct {
   GtkBitset * (* create) (void);
   guint n_elements;
@@ -82,7 +99,8 @@ static struct {
   { create_powers_of_10, 7, 1, LARGE_VALUE },
   { create_powers_of_10_ranges, 42, 9, LARGE_VALUE + 5, },
   { create_large_range, LARGE_VALUE, 0, LARGE_VALUE - 1 },
-  { create_large_rectangle, 900 * 900, 0, 899899 }
+  { create_large_rectangle, 900 * 900, 0, 899899 },
+  { create_dense_pattern, 133334, 1000, 200999 }
 };
 
 /* UTILITIES */
@@ -750,6 +750,59 @@ test_spin_button (void)
   g_object_unref (builder);
 }
 
+static void
+test_lazy_stack_page (void)
+{
+  GtkBuilder *builder;
+  const char buffer[] =
+    "<interface>"
+    "  <object class=\"GtkStack\" id=\"stack1\">"
+    "    <child>"
+    "      <object class=\"GtkStackPage\">"
+    "        <property name=\"name\">page1</property>"
+    "        <property name=\"child\">"
+    "          <object class=\"GtkLabel\" id=\"label1\">"
+    "            <property name=\"label\">label1</property>"
+    "          </object>"
+    "        </property>"
+    "      </object>"
+    "    </child>"
+    "    <child>"
+    "      <object class=\"GtkStackPage\" id=\"page2\">"
+    "        <property name=\"name\">page2</property>"
+    "        <lazy>"
+    "          <object class=\"GtkLabel\" id=\"label2\">"
+    "            <property name=\"label\">label &amp; 2</property>"
+    "          </object>"
+    "        </lazy>"
+    "      </object>"
+    "    </child>"
+    "  </object>"
+    "</interface>";
+  GObject *stack;
+  GtkStackPage *page;
+  GtkWidget *child;
+
+  builder = builder_new_from_string (buffer, -1, NULL);
+  stack = gtk_builder_get_object (builder, "stack1");
+  g_assert_nonnull (stack);
+  g_assert_cmpstr (gtk_stack_get_visible_child_name (GTK_STACK (stack)), ==, "page1");
+
+  /* The lazy page is not built yet */
+  g_assert_null (gtk_builder_get_object (builder, "label2"));
+  page = GTK_STACK_PAGE (gtk_builder_get_object (builder, "page2"));
+  child = gtk_stack_page_get_child (page);
+  g_assert_nonnull (child);
+  g_assert_null (gtk_widget_get_first_child (child));
+
+  gtk_stack_set_visible_child_name (GTK_STACK (stack), "page2");
+  child = gtk_widget_get_first_child (gtk_stack_page_get_child (page));
+  g_assert_true (GTK_IS_LABEL (child));
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (child)), ==, "label & 2");
+
+  g_object_unref (builder);
+}
+
 static void
 test_notebook (void)
 {
@@ -2497,6 +2550,7 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/Layout Properties", test_layout_properties);
   g_test_add_func ("/Builder/Object Properties", test_object_properties);
   g_test_add_func ("/Builder/Notebook", test_notebook);
+  g_test_add_func ("/Builder/Lazy Stack Page", test_lazy_stack_page);
   g_test_add_func ("/Builder/Domain", test_domain);
   g_test_add_func ("/Builder/Signal Autoconnect", test_connect_signals);
   g_test_add_func ("/Builder/Spin Button", test_spin_button);
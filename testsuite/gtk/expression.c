@@ -385,6 +385,57 @@ test_nested_this_destroyed (void)
   gtk_expression_unref (expr);
 }
 
+/* Checks that the watch keeps working when the inner
+ * expression notifies but still evaluates to the same object.
+ */
+static void
+test_nested_same_object (void)
+{
+  GtkExpression *list_expr;
+  GtkExpression *filter_expr;
+  GtkExpression *expr;
+  GtkStringFilter *filter;
+  GListModel *list;
+  GtkFilterListModel *filtered;
+  GtkExpressionWatch *watch;
+  guint counter = 0;
+
+  filter = gtk_string_filter_new (NULL);
+  list = G_LIST_MODEL (g_list_store_new (G_TYPE_OBJECT));
+  filtered = gtk_filter_list_model_new (list, g_object_ref (GTK_FILTER (filter)));
+
+  list_expr = gtk_object_expression_new (G_OBJECT (filtered));
+  filter_expr = gtk_property_expression_new (GTK_TYPE_FILTER_LIST_MODEL, list_expr, "filter");
+  expr = gtk_property_expression_new (GTK_TYPE_STRING_FILTER, filter_expr, "search");
+
+  watch = gtk_expression_watch (expr, NULL, inc_counter, &counter, NULL);
+
+  g_object_notify (G_OBJECT (filtered), "filter");
+  g_assert_cmpint (counter, ==, 1);
+  counter = 0;
+
+  gtk_string_filter_set_search (filter, "salad");
+  g_assert_cmpint (counter, ==, 1);
+  counter = 0;
+
+  g_object_notify (G_OBJECT (filtered), "filter");
+  g_object_notify (G_OBJECT (filtered), "filter");
+  g_assert_cmpint (counter, ==, 2);
+  counter = 0;
+
+  gtk_string_filter_set_search (filter, "bar");
+  g_assert_cmpint (counter, ==, 1);
+  counter = 0;
+
+  gtk_expression_watch_unwatch (watch);
+  gtk_string_filter_set_search (filter, "word");
+  g_assert_cmpint (counter, ==, 0);
+
+  g_object_unref (filter);
+  g_object_unref (filtered);
+  gtk_expression_unref (expr);
+}
+
 /* Test that property expressions fail to evaluate if the
  * expression evaluates to an object of the wrong type
  */
@@ -793,6 +844,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/expression/constant-watch-this-destroyed", test_constant_watch_this_destroyed);
   g_test_add_func ("/expression/object", test_object);
   g_test_add_func ("/expression/nested", test_nested);
+  g_test_add_func ("/expression/nested-same-object", test_nested_same_object);
   g_test_add_func ("/expression/nested-this-destroyed", test_nested_this_destroyed);
   g_test_add_func ("/expression/type-mismatch", test_type_mismatch);
   g_test_add_func ("/expression/this", test_this);
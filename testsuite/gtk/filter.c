@@ -324,6 +324,39 @@ test_string_properties (void)
   g_object_unref (filter);
 }
 
+static void
+test_string_refine (void)
+{
+  GtkFilterListModel *model;
+  GtkFilter *filter;
+
+  filter = GTK_FILTER (gtk_string_filter_new (gtk_cclosure_expression_new (G_TYPE_STRING,
+                                                                           NULL,
+                                                                           0, NULL,
+                                                                           G_CALLBACK (get_spelled_out),
+                                                                           NULL, NULL)));
+  model = new_model (100, filter);
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "teen");
+  assert_model (model, "13 14 15 16 17 18 19");
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "ghteen");
+  assert_model (model, "18");
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "IGHTEEN");
+  assert_model (model, "18");
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "teen");
+  assert_model (model, "13 14 15 16 17 18 19");
+
+  gtk_string_filter_set_ignore_case (GTK_STRING_FILTER (filter), FALSE);
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "Eigh");
+  assert_model (model, "8 18 80 81 82 83 84 85 86 87 88 89");
+
+  g_object_unref (model);
+  g_object_unref (filter);
+}
+
 static void
 test_bool_simple (void)
 {
@@ -405,6 +438,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/filter/any/simple", test_any_simple);
   g_test_add_func ("/filter/string/simple", test_string_simple);
   g_test_add_func ("/filter/string/properties", test_string_properties);
+  g_test_add_func ("/filter/string/refine", test_string_refine);
   g_test_add_func ("/filter/bool/simple", test_bool_simple);
   g_test_add_func ("/filter/every/dispose", test_every_dispose);
 
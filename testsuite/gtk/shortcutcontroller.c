@@ -0,0 +1,157 @@
+/*
+ * Copyright © 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#define GTK_COMPILATION
+#include "gdk/gdkeventsprivate.h"
+#include "gtk/gtkeventcontrollerprivate.h"
+
+static gboolean
+count_activations (GtkWidget *widget,
+                   GVariant  *args,
+                   gpointer   user_data)
+{
+  int *count = user_data;
+
+  *count += 1;
+
+  return TRUE;
+}
+
+static gboolean
+send_key (GtkEventController *controller,
+          guint               keyval,
+          GdkModifierType     state)
+{
+  GtkWidget *widget = gtk_event_controller_get_widget (controller);
+  GdkDisplay *display = gtk_widget_get_display (widget);
+  GdkSurface *surface = gtk_native_get_surface (gtk_widget_get_native (widget));
+  GdkDevice *device = gdk_seat_get_keyboard (gdk_display_get_default_seat (display));
+  GdkTranslatedKey translated = { keyval, 0, 0, 0 };
+  GdkKeymapKey *keys;
+  guint keycode = 0;
+  int n_keys;
+  GdkEvent *event;
+  gboolean handled;
+
+  if (gdk_display_map_keyval (display, keyval, &keys, &n_keys))
+    {
+      keycode = keys[0].keycode;
+      translated.layout = keys[0].group;
+      translated.level = keys[0].level;
+      g_free (keys);
+    }
+
+  event = gdk_key_event_new (GDK_KEY_PRESS, surface, device, GDK_CURRENT_TIME,
+                             keycode, state, FALSE, &translated, &translated);
+  handled = gtk_event_controller_handle_event (controller, event, widget, 0, 0);
+  gdk_event_unref (event);
+
+  return handled;
+}
+
+static GtkShortcut *
+add_shortcut (GtkEventController *controller,
+              const char         *trigger,
+              int                *count)
+{
+  GtkShortcut *shortcut;
+
+  shortcut = gtk_shortcut_new (gtk_shortcut_trigger_parse_string (trigger),
+                               gtk_callback_action_new (count_activations, count, NULL));
+  gtk_shortcut_controller_add_shortcut (GTK_SHORTCUT_CONTROLLER (controller),
+                                        g_object_ref (shortcut));
+
+  return shortcut;
+}
+
+/* The controller only looks at shortcuts whose triggers can
+ * match the key, check that it still finds the right ones
+ * when shortcuts or their triggers change.
+ */
+static void
+test_controller_index (void)
+{
+  GtkWidget *window, *label;
+  GtkEventController *controller;
+  GtkShortcut *shortcut;
+  int filler = 0, alternative = 0, changed = 0, added = 0;
+  char *trigger;
+  guint i;
+
+  window = gtk_window_new ();
+  label = gtk_label_new ("");
+  gtk_window_set_child (GTK_WINDOW (window), label);
+
+  controller = gtk_shortcut_controller_new ();
+  gtk_widget_add_controller (label, controller);
+
+  for (i = 0; i < 100; i++)
+    {
+      trigger = g_strdup_printf ("<Control><Alt>F%u", i % 12 + 1);
+      g_object_unref (add_shortcut (controller, trigger, &filler));
+      g_free (trigger);
+    }
+
+  g_object_unref (add_shortcut (controller, "<Control>a|<Control>b", &alternative));
+  shortcut = add_shortcut (controller, "<Control>x", &changed);
+
+  gtk_window_present (GTK_WINDOW (window));
+  for (i = 0; i < 100 && !gtk_widget_get_mapped (label); i++)
+    g_main_context_iteration (NULL, TRUE);
+
+  if (!gtk_widget_get_mapped (label) ||
+      !gdk_surface_get_mapped (gtk_native_get_surface (GTK_NATIVE (window))))
+    {
+      g_test_skip ("Window did not get mapped");
+      goto out;
+    }
+
+  g_assert_true (send_key (controller, GDK_KEY_a, GDK_CONTROL_MASK));
+  g_assert_true (send_key (controller, GDK_KEY_b, GDK_CONTROL_MASK));
+  g_assert_cmpint (alternative, ==, 2);
+
+  g_assert_true (send_key (controller, GDK_KEY_x, GDK_CONTROL_MASK));
+  g_assert_cmpint (changed, ==, 1);
+
+  gtk_shortcut_set_trigger (shortcut, gtk_shortcut_trigger_parse_string ("<Control>y"));
+  g_assert_false (send_key (controller, GDK_KEY_x, GDK_CONTROL_MASK));
+  g_assert_true (send_key (controller, GDK_KEY_y, GDK_CONTROL_MASK));
+  g_assert_cmpint (changed, ==, 2);
+
+  g_object_unref (add_shortcut (controller, "<Control>z", &added));
+  g_assert_true (send_key (controller, GDK_KEY_z, GDK_CONTROL_MASK));
+  g_assert_cmpint (added, ==, 1);
+
+  g_assert_false (send_key (controller, GDK_KEY_q, GDK_CONTROL_MASK));
+  g_assert_cmpint (filler, ==, 0);
+
+out:
+  g_object_unref (shortcut);
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/shortcutcontroller/index", test_controller_index);
+
+  return g_test_run ();
+}
@@ -54,6 +54,12 @@ get_number_mod_5 (GObject *object)
   return get_number (object) % 5;
 }
 
+static double
+get_number_reversed (GObject *object)
+{
+  return 10.5 - get_number (object);
+}
+
 static void
 append_digit (GString *s,
               guint    digit)
@@ -447,6 +453,35 @@ test_multi (void)
   g_object_unref (sorter);
 }
 
+/* numeric sorters get combined into a single packed key */
+static void
+test_multi_numeric (void)
+{
+  GtkSortListModel *model;
+  GtkSorter *sorter;
+  GtkSorter *sorter1;
+  GtkSorter *sorter2;
+
+  model = new_model (20, NULL);
+
+  sorter = GTK_SORTER (gtk_multi_sorter_new ());
+  sorter1 = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT, NULL, 0, NULL, (GCallback)get_number_mod_5, NULL, NULL)));
+  gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter1), GTK_SORT_DESCENDING);
+  gtk_multi_sorter_append (GTK_MULTI_SORTER (sorter), sorter1);
+  sorter2 = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_DOUBLE, NULL, 0, NULL, (GCallback)get_number_reversed, NULL, NULL)));
+  gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter2), GTK_SORT_DESCENDING);
+  gtk_multi_sorter_append (GTK_MULTI_SORTER (sorter), sorter2);
+  gtk_sort_list_model_set_sorter (model, sorter);
+
+  assert_model (model, "4 9 14 19 3 8 13 18 2 7 12 17 1 6 11 16 5 10 15 20");
+
+  gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter2), GTK_SORT_ASCENDING);
+  assert_model (model, "19 14 9 4 18 13 8 3 17 12 7 2 16 11 6 1 20 15 10 5");
+
+  g_object_unref (model);
+  g_object_unref (sorter);
+}
+
 /* Check that the multi sorter properly disconnects its changed signal */
 static void
 test_multi_destruct (void)
@@ -672,6 +707,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/sorter/change", test_change);
   g_test_add_func ("/sorter/numeric", test_numeric);
   g_test_add_func ("/sorter/multi", test_multi);
+  g_test_add_func ("/sorter/multi-numeric", test_multi_numeric);
   g_test_add_func ("/sorter/multi-destruct", test_multi_destruct);
   g_test_add_func ("/sorter/multi-changes", test_multi_changes);
   g_test_add_func ("/sorter/stable", test_stable);
@@ -44,6 +44,7 @@ enum {
   SELECT,
   CHECK_SELECT,
   SET_MAX_UNDO,
+  SET_MAX_BYTES,
 };
 
 typedef struct
@@ -310,6 +311,10 @@ run_test (const Command *commands,
           gtk_text_history_set_max_undo_levels (text->history, cmd->location);
           break;
 
+        case SET_MAX_BYTES:
+          gtk_text_history_set_max_n_bytes (text->history, cmd->location);
+          break;
+
         default:
           break;
         }
@@ -602,6 +607,24 @@ test14 (void)
   g_free (fill_after_2);
 }
 
+static void
+test15 (void)
+{
+  static const Command commands[] = {
+    { INSERT, 0, -1, "aaaa\n", "aaaa\n", SET, UNSET, UNSET },
+    { INSERT, 5, -1, "bbbb\n", "aaaa\nbbbb\n", SET, UNSET, UNSET },
+    { INSERT, 10, -1, "cccc\n", "aaaa\nbbbb\ncccc\n", SET, UNSET, UNSET },
+    { SET_MAX_BYTES, 10, -1, NULL, "aaaa\nbbbb\ncccc\n", SET, UNSET, UNSET },
+    { UNDO, -1, -1, NULL, "aaaa\nbbbb\n", SET, SET, UNSET },
+    { UNDO, -1, -1, NULL, "aaaa\n", UNSET, SET, UNSET },
+    { REDO, -1, -1, NULL, "aaaa\nbbbb\n", SET, SET, UNSET },
+    { INSERT, 10, -1, "dddddddddddddddd", "aaaa\nbbbb\ndddddddddddddddd", SET, UNSET, UNSET },
+    { UNDO, -1, -1, NULL, "aaaa\nbbbb\n", UNSET, SET, UNSET },
+  };
+
+  run_test (commands, G_N_ELEMENTS (commands), 0);
+}
+
 static void
 test_issue_4276 (void)
 {
@@ -655,6 +678,7 @@ main (int   argc,
   g_test_add_func ("/Gtk/TextHistory/test12", test12);
   g_test_add_func ("/Gtk/TextHistory/test13", test13);
   g_test_add_func ("/Gtk/TextHistory/test14", test14);
+  g_test_add_func ("/Gtk/TextHistory/test15", test15);
   g_test_add_func ("/Gtk/TextHistory/issue_4276", test_issue_4276);
   g_test_add_func ("/Gtk/TextHistory/issue_4575", test_issue_4575);
 
@@ -0,0 +1,94 @@
+/* Loads a large text into a text view, for test-performance.
+ *
+ * The time from setting the text until its end has been
+ * scrolled to and shown is measured by the "textview load" mark.
+ */
+
+#include <gtk/gtk.h>
+
+#define N_LINES 20000
+
+static gboolean done;
+static gint64 start_time;
+
+static void
+after_paint_cb (GdkFrameClock *frame_clock,
+                GtkTextView   *text_view)
+{
+  GtkTextBuffer *buffer = gtk_text_view_get_buffer (text_view);
+  GtkTextIter end;
+  GdkRectangle visible, location;
+
+  /* Done once the scroll to the last line has been drawn */
+  gtk_text_buffer_get_end_iter (buffer, &end);
+  gtk_text_view_get_visible_rect (text_view, &visible);
+  gtk_text_view_get_iter_location (text_view, &end, &location);
+  if (!gdk_rectangle_intersect (&visible, &location, NULL))
+    return;
+
+  gdk_profiler_end_mark (start_time, "textview load", NULL);
+
+  g_signal_handlers_disconnect_by_func (frame_clock, after_paint_cb, text_view);
+  done = TRUE;
+  g_main_context_wakeup (NULL);
+}
+
+static void
+realize_cb (GtkWidget *widget)
+{
+  g_signal_connect (gtk_widget_get_frame_clock (widget), "after-paint",
+                    G_CALLBACK (after_paint_cb), widget);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GtkWidget *window, *sw, *text_view;
+  GtkTextBuffer *buffer;
+  GtkTextIter end;
+  GString *text;
+  guint i;
+
+  gtk_init ();
+
+  text = g_string_new (NULL);
+  for (i = 0; i < N_LINES; i++)
+    g_string_append_printf (text,
+                            "%u: Lorem ipsum dolor sit amet, consectetur adipiscing elit, "
+                            "sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.\n",
+                            i);
+
+  text_view = gtk_text_view_new ();
+  gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (text_view), GTK_WRAP_WORD_CHAR);
+  g_signal_connect (text_view, "realize", G_CALLBACK (realize_cb), NULL);
+
+  sw = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), text_view);
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 600, 800);
+  gtk_window_set_child (GTK_WINDOW (window), sw);
+
+  start_time = gdk_profiler_get_current_time ();
+
+  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (text_view));
+  gtk_text_buffer_set_text (buffer, text->str, text->len);
+  gtk_text_buffer_get_end_iter (buffer, &end);
+  gtk_text_buffer_place_cursor (buffer, &end);
+
+  /* This waits for the lines to be validated */
+  gtk_text_view_scroll_to_mark (GTK_TEXT_VIEW (text_view),
+                                gtk_text_buffer_get_insert (buffer),
+                                0, FALSE, 0, 0);
+
+  gtk_window_present (GTK_WINDOW (window));
+
+  g_string_free (text, TRUE);
+
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+
+  return 0;
+}
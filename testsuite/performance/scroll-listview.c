@@ -0,0 +1,101 @@
+/* Scrolls through a long list view, for test-performance.
+ *
+ * The whole scrolling is measured by the "listview scroll" mark.
+ */
+
+#include <gtk/gtk.h>
+
+#define N_ITEMS 100000
+#define N_FRAMES 300
+
+static gboolean done;
+static int n_frames;
+static gint64 start_time;
+
+static void
+setup_cb (GtkSignalListItemFactory *factory,
+          GtkListItem              *item)
+{
+  GtkWidget *label = gtk_label_new (NULL);
+
+  gtk_label_set_xalign (GTK_LABEL (label), 0);
+  gtk_list_item_set_child (item, label);
+}
+
+static void
+bind_cb (GtkSignalListItemFactory *factory,
+         GtkListItem              *item)
+{
+  GtkStringObject *string = gtk_list_item_get_item (item);
+
+  gtk_label_set_label (GTK_LABEL (gtk_list_item_get_child (item)),
+                       gtk_string_object_get_string (string));
+}
+
+static gboolean
+scroll_cb (GtkWidget     *widget,
+           GdkFrameClock *frame_clock,
+           gpointer       data)
+{
+  GtkAdjustment *adjustment = data;
+
+  if (n_frames == 0)
+    start_time = gdk_profiler_get_current_time ();
+
+  gtk_adjustment_set_value (adjustment, gtk_adjustment_get_value (adjustment) + 40);
+
+  if (++n_frames < N_FRAMES)
+    return G_SOURCE_CONTINUE;
+
+  gdk_profiler_end_mark (start_time, "listview scroll", NULL);
+
+  done = TRUE;
+  g_main_context_wakeup (NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GtkWidget *window, *sw, *list;
+  GtkStringList *strings;
+  GtkListItemFactory *factory;
+  char buffer[64];
+  guint i;
+
+  gtk_init ();
+
+  strings = gtk_string_list_new (NULL);
+  for (i = 0; i < N_ITEMS; i++)
+    {
+      g_snprintf (buffer, sizeof (buffer), "Item %u", i);
+      gtk_string_list_append (strings, buffer);
+    }
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_cb), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_cb), NULL);
+
+  list = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (strings))),
+                            factory);
+
+  sw = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), list);
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 400, 600);
+  gtk_window_set_child (GTK_WINDOW (window), sw);
+  gtk_window_present (GTK_WINDOW (window));
+
+  gtk_widget_add_tick_callback (sw, scroll_cb,
+                                gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (sw)),
+                                NULL);
+
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+
+  return 0;
+}
@@ -1,18 +1,29 @@
 #include <errno.h>
+#include <math.h>
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <sysprof.h>
 #include <gio/gio.h>
 
+/* The measurements of one mark, one value per run */
 typedef struct {
   const char *mark;
+  gint64 *values;
+} Metric;
+
+typedef struct {
+  Metric *metrics;
+  int n_metrics;
+  int run;
+  int n_found;
   const char *detail;
   gboolean do_start;
   gint64 start_time;
-  gint64 value;
+  GArray *frame_times;
 } Data;
 
 static bool
@@ -20,43 +31,68 @@ callback (const SysprofCaptureFrame *frame,
           gpointer                   user_data)
 {
   Data *data = user_data;
+  SysprofCaptureMark *mark;
+  int i;
+
+  if (frame->type != SYSPROF_CAPTURE_FRAME_MARK)
+    return TRUE;
+
+  mark = (SysprofCaptureMark *)frame;
+  if (strcmp (mark->group, "gtk") != 0)
+    return TRUE;
 
-  if (frame->type == SYSPROF_CAPTURE_FRAME_MARK)
+  if (data->frame_times && strcmp (mark->name, "frameclock cycle") == 0)
+    g_array_append_val (data->frame_times, mark->duration);
+
+  for (i = 0; i < data->n_metrics; i++)
     {
-      SysprofCaptureMark *mark = (SysprofCaptureMark *)frame;
-      if (strcmp (mark->group, "gtk") == 0 &&
-          strcmp (mark->name, data->mark) == 0 &&
+      Metric *metric = &data->metrics[i];
+
+      /* Only the first occurrence of each mark is measured */
+      if (metric->values[data->run] >= 0)
+        continue;
+
+      if (strcmp (mark->name, metric->mark) == 0 &&
           (data->detail == NULL || strcmp (mark->message, data->detail) == 0))
         {
           if (data->do_start)
-            data->value = frame->time - data->start_time;
+            metric->values[data->run] = frame->time - data->start_time;
           else
-            data->value = mark->duration;
-          return FALSE;
+            metric->values[data->run] = mark->duration;
+          data->n_found++;
         }
     }
 
-  return TRUE;
+  /* Frame times are collected until the end */
+  return data->frame_times != NULL || data->n_found < data->n_metrics;
 }
 
 #define MILLISECONDS(v) ((v) / (1000.0 * G_TIME_SPAN_MILLISECOND))
 
 static int opt_rep = 10;
-static char *opt_mark;
+static char **opt_marks;
 static char *opt_detail;
 static char *opt_name;
 static char *opt_output;
+static char *opt_baseline;
+static double opt_tolerance = 10;
+static gboolean opt_update_baseline;
+static gboolean opt_frames;
 static gboolean opt_start_time;
 static GMainLoop *main_loop;
 static GError *failure;
 
 static GOptionEntry options[] = {
-  { "mark", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_mark, "Name of the mark", "NAME" },
-  { "detail", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_detail, "Detail of the mark", "DETAIL" },
+  { "mark", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING_ARRAY, &opt_marks, "Name of a mark, can be repeated", "NAME" },
+  { "detail", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_detail, "Detail of the marks", "DETAIL" },
   { "start", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &opt_start_time, "Measure the start time", NULL },
+  { "frames", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &opt_frames, "Show a histogram of frame times", NULL },
   { "runs", '0', G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_rep, "Number of runs", "COUNT" },
   { "name", '0', G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_name, "Name of this test", "NAME" },
   { "output", '0', G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_output, "Directory to save syscap files", "DIRECTORY" },
+  { "baseline", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_baseline, "Compare with the results stored in FILE", "FILE" },
+  { "tolerance", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_DOUBLE, &opt_tolerance, "Allowed regression against the baseline, in percent", "PERCENT" },
+  { "update-baseline", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &opt_update_baseline, "Store the results as new baseline", NULL },
   { NULL, }
 };
 
@@ -83,6 +119,97 @@ on_stopped_cb (SysprofProfiler *profiler)
   g_main_loop_quit (main_loop);
 }
 
+static int
+compare_values (gconstpointer a,
+                gconstpointer b)
+{
+  gint64 va = *(const gint64 *) a;
+  gint64 vb = *(const gint64 *) b;
+
+  return va < vb ? -1 : (va > vb ? 1 : 0);
+}
+
+/* Nearest rank, for a sorted array */
+static gint64
+percentile (const gint64 *values,
+            int           n_values,
+            double        p)
+{
+  int rank = ceil (p / 100. * n_values);
+
+  return values[CLAMP (rank, 1, n_values) - 1];
+}
+
+static void
+print_frame_histogram (GArray *frame_times)
+{
+  /* Buckets in ms, around the usual refresh rates */
+  const double limits[] = { 4, 8, 12, 16.7, 33.3, 50, 100 };
+  guint counts[G_N_ELEMENTS (limits) + 1] = { 0, };
+  gint64 *values = (gint64 *) frame_times->data;
+  guint i, j;
+
+  if (frame_times->len == 0)
+    {
+      g_print ("no frames\n");
+      return;
+    }
+
+  for (i = 0; i < frame_times->len; i++)
+    {
+      for (j = 0; j < G_N_ELEMENTS (limits); j++)
+        {
+          if (MILLISECONDS (values[i]) < limits[j])
+            break;
+        }
+      counts[j]++;
+    }
+
+  g_array_sort (frame_times, compare_values);
+
+  g_print ("%u frames, p50 %g, p90 %g, p99 %g, max %g\n",
+           frame_times->len,
+           MILLISECONDS (percentile (values, frame_times->len, 50)),
+           MILLISECONDS (percentile (values, frame_times->len, 90)),
+           MILLISECONDS (percentile (values, frame_times->len, 99)),
+           MILLISECONDS (values[frame_times->len - 1]));
+
+  for (j = 0; j <= G_N_ELEMENTS (limits); j++)
+    {
+      char *bar = g_strnfill (counts[j] * 50 / frame_times->len, '#');
+
+      if (j < G_N_ELEMENTS (limits))
+        g_print ("  < %5g ms %6u %s\n", limits[j], counts[j], bar);
+      else
+        g_print ("  >= %4g ms %6u %s\n", limits[j - 1], counts[j], bar);
+
+      g_free (bar);
+    }
+}
+
+/* Returns FALSE if @value regressed by more than the tolerance */
+static gboolean
+check_baseline (GKeyFile   *baseline,
+                const char *key,
+                double      value,
+                const char *unit)
+{
+  double expected;
+
+  if (!g_key_file_has_key (baseline, opt_name, key, NULL))
+    return TRUE;
+
+  expected = g_key_file_get_double (baseline, opt_name, key, NULL);
+  if (value <= expected * (1 + opt_tolerance / 100))
+    return TRUE;
+
+  g_print ("%s regressed: %g %s, baseline %g %s (%+.1f%%, tolerance %g%%)\n",
+           key, value, unit, expected, unit,
+           (value - expected) / expected * 100, opt_tolerance);
+
+  return FALSE;
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -90,13 +217,18 @@ main (int argc, char *argv[])
   GError *error = NULL;
   Data data;
   SysprofCaptureFrameType type;
-  gint64 *values;
-  gint64 min, max, total;
-  int count;
+  Metric *metrics;
+  int n_metrics;
+  const char *default_marks[] = { "css validation", NULL };
+  GArray *frame_times = NULL;
+  GKeyFile *baseline = NULL;
+  gboolean has_baseline = FALSE;
+  gboolean passed = TRUE;
+  struct rusage usage;
   char *output_dir = NULL;
   char **spawn_env;
   char *workdir;
-  int i, j;
+  int i, j, m;
 
   context = g_option_context_new ("COMMANDLINE");
   g_option_context_add_main_entries (context, options, NULL);
@@ -112,6 +244,12 @@ main (int argc, char *argv[])
   if (opt_rep < 1)
     g_error ("COUNT must be a positive number");
 
+  if (opt_baseline && !opt_name)
+    g_error ("Comparing with a baseline needs a name for the test");
+
+  if (opt_marks == NULL)
+    opt_marks = g_strdupv ((char **) default_marks);
+
   main_loop = g_main_loop_new (NULL, FALSE);
   workdir = g_get_current_dir ();
 
@@ -146,7 +284,16 @@ main (int argc, char *argv[])
 
   opt_rep++;
 
-  values = g_new (gint64, opt_rep);
+  n_metrics = g_strv_length (opt_marks);
+  metrics = g_new (Metric, n_metrics);
+  for (m = 0; m < n_metrics; m++)
+    {
+      metrics[m].mark = opt_marks[m];
+      metrics[m].values = g_new (gint64, opt_rep);
+    }
+
+  if (opt_frames)
+    frame_times = g_array_new (FALSE, FALSE, sizeof (gint64));
 
   for (i = 0; i < opt_rep; i++)
     {
@@ -198,11 +345,18 @@ main (int argc, char *argv[])
 
       sysprof_capture_writer_unref (writer);
 
-      data.mark = opt_mark ? opt_mark : "css validation";
+      for (m = 0; m < n_metrics; m++)
+        metrics[m].values[i] = -1;
+
+      data.metrics = metrics;
+      data.n_metrics = n_metrics;
+      data.run = i;
+      data.n_found = 0;
       data.detail = opt_detail ? opt_detail : NULL;
       data.do_start = opt_start_time;
       data.start_time = sysprof_capture_reader_get_start_time (reader);
-      data.value = 0;
+      /* Ignore the frames of the first run, like its marks */
+      data.frame_times = i > 0 ? frame_times : NULL;
 
       cursor = sysprof_capture_cursor_new (reader);
 
@@ -212,7 +366,14 @@ main (int argc, char *argv[])
 
       sysprof_capture_cursor_foreach (cursor, callback, &data);
 
-      values[i] = data.value;
+      for (m = 0; m < n_metrics; m++)
+        {
+          if (metrics[m].values[i] < 0)
+            {
+              g_print ("Run %d has no '%s' mark\n", i, metrics[m].mark);
+              metrics[m].values[i] = 0;
+            }
+        }
 
       sysprof_capture_cursor_unref (cursor);
       sysprof_capture_reader_unref (reader);
@@ -244,25 +405,83 @@ main (int argc, char *argv[])
 
   g_free (workdir);
 
-  min = G_MAXINT64;
-  max = 0;
-  count = 0;
-  total = 0;
+  if (opt_baseline)
+    {
+      baseline = g_key_file_new ();
+      if (g_key_file_load_from_file (baseline, opt_baseline, G_KEY_FILE_KEEP_COMMENTS, &error))
+        has_baseline = g_key_file_has_group (baseline, opt_name);
+      else if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        g_error ("Loading baseline: %s", error->message);
+      g_clear_error (&error);
+    }
 
-  /* Ignore the first run, to avoid cache effects */
-  for (i = 1; i < opt_rep; i++)
+  for (m = 0; m < n_metrics; m++)
     {
-      if (min > values[i])
-        min = values[i];
-      if (max < values[i])
-        max = values[i];
-      count++;
-      total += values[i];
+      /* Ignore the first run, to avoid cache effects */
+      gint64 *values = metrics[m].values + 1;
+      int count = opt_rep - 1;
+      gint64 total = 0;
+      gint64 median;
+
+      for (i = 0; i < count; i++)
+        total += values[i];
+
+      qsort (values, count, sizeof (gint64), compare_values);
+      median = percentile (values, count, 50);
+
+      g_print ("%s: %d runs, min %g, p50 %g, p90 %g, p99 %g, max %g, avg %g\n",
+               metrics[m].mark,
+               count,
+               MILLISECONDS (values[0]),
+               MILLISECONDS (median),
+               MILLISECONDS (percentile (values, count, 90)),
+               MILLISECONDS (percentile (values, count, 99)),
+               MILLISECONDS (values[count - 1]),
+               MILLISECONDS (total / count));
+
+      if (baseline)
+        {
+          if (has_baseline && !opt_update_baseline)
+            passed &= check_baseline (baseline, metrics[m].mark, MILLISECONDS (median), "ms");
+          else
+            g_key_file_set_double (baseline, opt_name, metrics[m].mark, MILLISECONDS (median));
+        }
     }
 
-  g_print ("%d runs, min %g, max %g, avg %g\n",
-           count,
-           MILLISECONDS (min),
-           MILLISECONDS (max),
-           MILLISECONDS (total / count));
+  if (frame_times)
+    print_frame_histogram (frame_times);
+
+  /* The runs are our children, so this is the largest of them.
+   * Linux reports it in kB.
+   */
+  if (getrusage (RUSAGE_CHILDREN, &usage) == 0)
+    {
+      g_print ("peak RSS: %ld kB\n", usage.ru_maxrss);
+
+      if (baseline)
+        {
+          if (has_baseline && !opt_update_baseline)
+            passed &= check_baseline (baseline, "peak-rss", usage.ru_maxrss, "kB");
+          else
+            g_key_file_set_double (baseline, opt_name, "peak-rss", usage.ru_maxrss);
+        }
+    }
+
+  /* The first results for a test, or an explicit update,
+   * become the baseline for the next run.
+   */
+  if (baseline && (!has_baseline || opt_update_baseline))
+    {
+      if (!g_key_file_save_to_file (baseline, opt_baseline, &error))
+        g_error ("Saving baseline: %s", error->message);
+      g_print ("Saved baseline for %s\n", opt_name);
+    }
+
+  g_clear_pointer (&baseline, g_key_file_free);
+  g_clear_pointer (&frame_times, g_array_unref);
+  for (m = 0; m < n_metrics; m++)
+    g_free (metrics[m].values);
+  g_free (metrics);
+
+  return passed ? 0 : 1;
 }
@@ -0,0 +1,370 @@
+/*  Copyright 2022 Red Hat, Inc.
+ *
+ * GTK+ is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * GLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GTK+; see the file COPYING.  If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <glib/gi18n.h>
+#include <glib/gprintf.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include "gtkbuilderprivate.h"
+#include "gtkcssnodeprivate.h"
+#include "gtkwidgetprivate.h"
+#include "gtk-builder-tool.h"
+
+/* All times are in nanoseconds, summed over all runs */
+typedef struct {
+  GType type;
+  guint count;
+  gint64 construct;
+  gint64 properties;
+  gint64 measure;
+} TypeProfile;
+
+typedef struct {
+  GHashTable *types; /* GType -> TypeProfile */
+  gint64 build;
+  gint64 construct;
+  gint64 properties;
+  gint64 css;
+  gint64 measure;
+} Profile;
+
+static TypeProfile *
+get_type_profile (Profile *profile,
+                  GType    type)
+{
+  TypeProfile *tp;
+
+  tp = g_hash_table_lookup (profile->types, GSIZE_TO_POINTER (type));
+  if (tp == NULL)
+    {
+      tp = g_new0 (TypeProfile, 1);
+      tp->type = type;
+      g_hash_table_insert (profile->types, GSIZE_TO_POINTER (type), tp);
+    }
+
+  return tp;
+}
+
+static void
+object_constructed (GtkBuilder *builder,
+                    GType       type,
+                    gint64      construct_time,
+                    gint64      properties_time,
+                    gpointer    user_data)
+{
+  Profile *profile = user_data;
+  TypeProfile *tp = get_type_profile (profile, type);
+
+  tp->count++;
+  tp->construct += construct_time;
+  tp->properties += properties_time;
+  profile->construct += construct_time;
+  profile->properties += properties_time;
+}
+
+/* Children are measured before their parent, so the measure caches
+ * of the children are already filled and the time of each widget is
+ * mostly its own.
+ */
+static void
+measure_widget (Profile   *profile,
+                GtkWidget *widget)
+{
+  GtkWidget *child;
+  gint64 start;
+  TypeProfile *tp;
+
+  for (child = gtk_widget_get_first_child (widget);
+       child;
+       child = gtk_widget_get_next_sibling (child))
+    measure_widget (profile, child);
+
+  start = gdk_profiler_get_current_time ();
+  gtk_widget_measure (widget, GTK_ORIENTATION_HORIZONTAL, -1, NULL, NULL, NULL, NULL);
+  gtk_widget_measure (widget, GTK_ORIENTATION_VERTICAL, -1, NULL, NULL, NULL, NULL);
+
+  tp = get_type_profile (profile, G_OBJECT_TYPE (widget));
+  tp->measure += gdk_profiler_get_current_time () - start;
+}
+
+static GtkWidget *
+find_toplevel (GtkBuilder *builder,
+               const char *id)
+{
+  GObject *object = NULL;
+
+  if (id)
+    {
+      object = gtk_builder_get_object (builder, id);
+    }
+  else
+    {
+      GSList *objects, *l;
+
+      objects = gtk_builder_get_objects (builder);
+      for (l = objects; l; l = l->next)
+        {
+          GObject *obj = l->data;
+
+          if (GTK_IS_WINDOW (obj))
+            {
+              object = obj;
+              break;
+            }
+          else if (GTK_IS_WIDGET (obj) &&
+                   gtk_widget_get_parent (GTK_WIDGET (obj)) == NULL)
+            {
+              if (object == NULL)
+                object = obj;
+            }
+        }
+      g_slist_free (objects);
+    }
+
+  if (object == NULL || !GTK_IS_WIDGET (object))
+    return NULL;
+
+  return GTK_WIDGET (object);
+}
+
+static gboolean
+profile_once (Profile    *profile,
+              const char *filename,
+              const char *contents,
+              gsize       length,
+              const char *id)
+{
+  GtkBuilder *builder;
+  GError *error = NULL;
+  GtkWidget *widget, *top, *root;
+  GtkCssNode *node;
+  gint64 start;
+  int i;
+
+  builder = gtk_builder_new ();
+  gtk_builder_set_profile_func (builder, object_constructed, profile);
+
+  start = gdk_profiler_get_current_time ();
+  if (!gtk_builder_add_from_string (builder, contents, length, &error))
+    {
+      g_printerr (_("Can’t load “%s”: %s\n"), filename, error->message);
+      g_error_free (error);
+      g_object_unref (builder);
+      return FALSE;
+    }
+  profile->build += gdk_profiler_get_current_time () - start;
+
+  widget = find_toplevel (builder, id);
+  if (widget == NULL)
+    {
+      /* Only construction and properties are interesting then */
+      g_object_unref (builder);
+      return TRUE;
+    }
+
+  /* Styles can only be computed for a complete tree */
+  top = widget;
+  while (gtk_widget_get_parent (top))
+    top = gtk_widget_get_parent (top);
+
+  if (GTK_IS_ROOT (top))
+    root = top;
+  else
+    {
+      root = gtk_window_new ();
+      gtk_window_set_child (GTK_WINDOW (root), top);
+    }
+
+  /* Validation may be spread over several frames for big trees,
+   * give it a few rounds to finish.
+   */
+  node = gtk_widget_get_css_node (root);
+  start = gdk_profiler_get_current_time ();
+  for (i = 0; i < 100 && node->invalid; i++)
+    gtk_css_node_validate (node);
+  profile->css += gdk_profiler_get_current_time () - start;
+
+  start = gdk_profiler_get_current_time ();
+  measure_widget (profile, widget);
+  profile->measure += gdk_profiler_get_current_time () - start;
+
+  if (GTK_IS_WINDOW (root))
+    gtk_window_destroy (GTK_WINDOW (root));
+  g_object_unref (builder);
+
+  return TRUE;
+}
+
+static int
+compare_type_profiles (gconstpointer a,
+                       gconstpointer b)
+{
+  const TypeProfile *tpa = *(const TypeProfile **) a;
+  const TypeProfile *tpb = *(const TypeProfile **) b;
+  gint64 ta = tpa->construct + tpa->properties + tpa->measure;
+  gint64 tb = tpb->construct + tpb->properties + tpb->measure;
+
+  return ta > tb ? -1 : (ta < tb ? 1 : 0);
+}
+
+static void
+print_profile (Profile *profile,
+               int      runs)
+{
+  GPtrArray *types;
+  GHashTableIter iter;
+  gpointer value;
+  gint64 parse;
+  double total;
+  guint i;
+
+#define MS(t) ((t) / (1000000. * runs))
+
+  types = g_ptr_array_new ();
+  g_hash_table_iter_init (&iter, profile->types);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    g_ptr_array_add (types, value);
+  g_ptr_array_sort (types, compare_type_profiles);
+
+  g_print ("%-32s %7s %11s %11s %11s %11s\n",
+           "Type", "Count", "Construct", "Properties", "Measure", "Total");
+  for (i = 0; i < types->len; i++)
+    {
+      TypeProfile *tp = g_ptr_array_index (types, i);
+
+      g_print ("%-32s %7u %9.3fms %9.3fms %9.3fms %9.3fms\n",
+               g_type_name (tp->type),
+               tp->count / runs,
+               MS (tp->construct),
+               MS (tp->properties),
+               MS (tp->measure),
+               MS (tp->construct + tp->properties + tp->measure));
+    }
+  g_ptr_array_unref (types);
+
+  /* Whatever the builder did besides constructing
+   * objects and setting properties
+   */
+  parse = MAX (0, profile->build - profile->construct - profile->properties);
+  total = MS (profile->build + profile->css + profile->measure);
+
+  g_print ("\n");
+  g_print ("%-20s %9.3fms %5.1f%%\n", "Parsing", MS (parse), 100 * MS (parse) / total);
+  g_print ("%-20s %9.3fms %5.1f%%\n", "Construction", MS (profile->construct), 100 * MS (profile->construct) / total);
+  g_print ("%-20s %9.3fms %5.1f%%\n", "Properties", MS (profile->properties), 100 * MS (profile->properties) / total);
+  g_print ("%-20s %9.3fms %5.1f%%\n", "CSS validation", MS (profile->css), 100 * MS (profile->css) / total);
+  g_print ("%-20s %9.3fms %5.1f%%\n", "First measure", MS (profile->measure), 100 * MS (profile->measure) / total);
+  g_print ("%-20s %9.3fms\n", "Total", total);
+
+#undef MS
+}
+
+static void
+profile_file (const char *filename,
+              const char *id,
+              int         runs)
+{
+  Profile profile = { 0, };
+  GError *error = NULL;
+  char *contents;
+  gsize length;
+  int i;
+
+  if (!g_file_get_contents (filename, &contents, &length, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      exit (1);
+    }
+
+  profile.types = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  /* The first run initializes classes and loads the theme,
+   * which is not what we want to see here.
+   */
+  if (!profile_once (&profile, filename, contents, length, id))
+    exit (1);
+  g_hash_table_remove_all (profile.types);
+  profile.build = profile.construct = profile.properties = profile.css = profile.measure = 0;
+
+  for (i = 0; i < runs; i++)
+    {
+      if (!profile_once (&profile, filename, contents, length, id))
+        exit (1);
+    }
+
+  print_profile (&profile, runs);
+
+  g_hash_table_unref (profile.types);
+  g_free (contents);
+}
+
+void
+do_profile (int          *argc,
+            const char ***argv)
+{
+  GOptionContext *context;
+  char *id = NULL;
+  int runs = 10;
+  char **filenames = NULL;
+  const GOptionEntry entries[] = {
+    { "id", 0, 0, G_OPTION_ARG_STRING, &id, NULL, NULL },
+    { "runs", 0, 0, G_OPTION_ARG_INT, &runs, NULL, NULL },
+    { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL, NULL },
+    { NULL, }
+  };
+  GError *error = NULL;
+
+  context = g_option_context_new (NULL);
+  g_option_context_set_help_enabled (context, FALSE);
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (!g_option_context_parse (context, argc, (char ***)argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      exit (1);
+    }
+
+  g_option_context_free (context);
+
+  if (filenames == NULL)
+    {
+      g_printerr ("No .ui file specified\n");
+      exit (1);
+    }
+
+  if (g_strv_length (filenames) > 1)
+    {
+      g_printerr ("Can only profile a single .ui file\n");
+      exit (1);
+    }
+
+  if (runs < 1)
+    {
+      g_printerr ("Need at least one run\n");
+      exit (1);
+    }
+
+  profile_file (filenames[0], id, runs);
+
+  g_strfreev (filenames);
+  g_free (id);
+}
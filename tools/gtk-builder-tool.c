@@ -39,6 +39,7 @@ usage (void)
              "  simplify     Simplify the file\n"
              "  enumerate    List all named objects\n"
              "  preview      Preview the file\n"
+             "  profile      Show how long it takes to create the file\n"
              "\n"
              "Simplify Options:\n"
              "  --replace    Replace the file\n"
@@ -48,6 +49,10 @@ usage (void)
              "  --id=ID      Preview only the named object\n"
              "  --css=FILE   Use style from CSS file\n"
              "\n"
+             "Profile Options:\n"
+             "  --id=ID      Measure only the named object\n"
+             "  --runs=N     Create the file N times\n"
+             "\n"
              "Perform various tasks on GtkBuilder .ui files.\n"));
   exit (1);
 }
@@ -134,6 +139,8 @@ main (int argc, const char *argv[])
     do_enumerate (&argc, &argv);
   else if (strcmp (argv[0], "preview") == 0)
     do_preview (&argc, &argv);
+  else if (strcmp (argv[0], "profile") == 0)
+    do_profile (&argc, &argv);
   else
     usage ();
 
@@ -0,0 +1,121 @@
+/* gtk-css-tool.c
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+
+#include <stdlib.h>
+#include <locale.h>
+
+#include "gtk/gtkcssproviderprivate.h"
+
+static void
+parsing_error_cb (GtkCssProvider *provider,
+                  GtkCssSection  *section,
+                  const GError   *error,
+                  gpointer        user_data)
+{
+  gboolean *failed = user_data;
+  char *location;
+
+  location = gtk_css_section_to_string (section);
+  g_printerr ("%s: %s\n", location, error->message);
+  g_free (location);
+
+  *failed = TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GtkCssProvider *provider;
+  GBytes *source, *compiled;
+  GError *error = NULL;
+  gboolean failed = FALSE;
+  GFile *file;
+
+  setlocale (LC_ALL, "");
+
+#ifdef ENABLE_NLS
+  bindtextdomain (GETTEXT_PACKAGE, GTK_LOCALEDIR);
+#ifdef HAVE_BIND_TEXTDOMAIN_CODESET
+  bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+#endif
+#endif
+
+  g_set_prgname ("gtk4-css-tool");
+
+  context = g_option_context_new ("[OPTION…] INPUT OUTPUT");
+  g_option_context_set_summary (context,
+                                _("Compile a style sheet into a form that GTK\n"
+                                  "loads faster from resources."));
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return 1;
+    }
+
+  if (argc != 3)
+    {
+      g_printerr ("%s\n", g_option_context_get_help (context, FALSE, NULL));
+      return 1;
+    }
+
+  file = g_file_new_for_commandline_arg (argv[1]);
+  source = g_file_load_bytes (file, NULL, NULL, &error);
+  if (source == NULL)
+    {
+      g_printerr (_("Can’t load file: %s\n"), error->message);
+      return 1;
+    }
+
+  provider = gtk_css_provider_new ();
+  g_signal_connect (provider, "parsing-error", G_CALLBACK (parsing_error_cb), &failed);
+  gtk_css_provider_load_from_file (provider, file);
+  g_object_unref (file);
+
+  /* The compiled form drops everything that failed to parse,
+   * so the errors would never be seen again at runtime.
+   */
+  if (failed)
+    return 1;
+
+  compiled = gtk_css_provider_compile (provider, source);
+
+  file = g_file_new_for_commandline_arg (argv[2]);
+  if (!g_file_replace_contents (file,
+                                g_bytes_get_data (compiled, NULL),
+                                g_bytes_get_size (compiled),
+                                NULL, FALSE,
+                                G_FILE_CREATE_REPLACE_DESTINATION,
+                                NULL, NULL, &error))
+    {
+      g_printerr (_("Can’t save file: %s\n"), error->message);
+      return 1;
+    }
+
+  g_object_unref (file);
+  g_bytes_unref (compiled);
+  g_bytes_unref (source);
+  g_object_unref (provider);
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+/* gtk-texture-tool.c
+ * Copyright (C) 2022 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <gdk/gdk.h>
+#include <glib/gi18n.h>
+
+#include <stdlib.h>
+#include <locale.h>
+
+#include "gdk/gdktextureprivate.h"
+#include "gdk/loaders/gdkrawprivate.h"
+
+static char *format_name = NULL;
+
+static GOptionEntry args[] = {
+  { "format", 'f', 0, G_OPTION_ARG_STRING, &format_name, N_("Store pixels in this memory format"), N_("FORMAT") },
+  { NULL }
+};
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GdkTexture *texture;
+  GdkMemoryFormat format;
+  GError *error = NULL;
+  GBytes *bytes;
+  GFile *file;
+
+  setlocale (LC_ALL, "");
+
+#ifdef ENABLE_NLS
+  bindtextdomain (GETTEXT_PACKAGE, GTK_LOCALEDIR);
+#ifdef HAVE_BIND_TEXTDOMAIN_CODESET
+  bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+#endif
+#endif
+
+  g_set_prgname ("gtk4-texture-tool");
+
+  context = g_option_context_new ("[OPTION…] INPUT OUTPUT");
+  g_option_context_set_summary (context,
+                                _("Convert an image into a file that GTK can map into memory\n"
+                                  "and use without decoding."));
+  g_option_context_add_main_entries (context, args, GETTEXT_PACKAGE);
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return 1;
+    }
+
+  if (argc != 3)
+    {
+      g_printerr ("%s\n", g_option_context_get_help (context, FALSE, NULL));
+      return 1;
+    }
+
+  file = g_file_new_for_commandline_arg (argv[1]);
+  texture = gdk_texture_new_from_file (file, &error);
+  g_object_unref (file);
+  if (texture == NULL)
+    {
+      g_printerr (_("Can’t load file: %s\n"), error->message);
+      return 1;
+    }
+
+  if (format_name)
+    {
+      GEnumClass *enum_class = g_type_class_ref (GDK_TYPE_MEMORY_FORMAT);
+      GEnumValue *value = g_enum_get_value_by_nick (enum_class, format_name);
+
+      if (value == NULL || value->value == GDK_MEMORY_N_FORMATS)
+        {
+          g_printerr (_("Unknown memory format %s\n"), format_name);
+          return 1;
+        }
+
+      format = value->value;
+      g_type_class_unref (enum_class);
+    }
+  else
+    {
+      format = gdk_texture_get_format (texture);
+    }
+
+  bytes = gdk_save_raw (texture, format);
+
+  file = g_file_new_for_commandline_arg (argv[2]);
+  if (!g_file_replace_contents (file,
+                                g_bytes_get_data (bytes, NULL),
+                                g_bytes_get_size (bytes),
+                                NULL, FALSE,
+                                G_FILE_CREATE_REPLACE_DESTINATION,
+                                NULL, NULL, &error))
+    {
+      g_printerr (_("Can’t save file: %s\n"), error->message);
+      return 1;
+    }
+
+  g_object_unref (file);
+  g_bytes_unref (bytes);
+  g_object_unref (texture);
+
+  return 0;
+}